@@ -0,0 +1,435 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/* Reproducible scaling harness.
+ *
+ * The harness sweeps a grid of configurations - initial refinement level
+ * (and thereby element count), adapt churn rate and ghost algorithm - and
+ * drives rounds of seeded pseudo-random adapt churn followed by a
+ * partition with ghost creation for each of them, like a time step loop
+ * of an adaptive application would. The adapt decisions hash the global
+ * identity of an element, so the mesh sequence of a configuration is
+ * identical on any number of processes and on any machine.
+ *
+ * For every round of every configuration one JSON object is written as a
+ * single line to the output file (JSON lines, schema "t8_bench_scaling-1"),
+ * containing the sweep coordinates and the t8_profile statistics of the
+ * round: phase runtimes reduced with max over the processes and the
+ * partition/ghost traffic counters summed over the processes. The fixed
+ * key order makes the files directly diffable release-to-release.
+ * With --mpi-profile the recorded per-peer communication matrices of each
+ * configuration are additionally dumped through t8_mpi_profile_dump.
+ */
+
+#include <t8.h>
+#include <t8_forest/t8_forest.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_forest/t8_forest_profiling.h>
+#include <t8_mpi_profile.h>
+#include <t8_eclass.h>
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <sc_options.h>
+#include <stdint.h>
+
+/* The version of the emitted result schema. Bump it whenever keys are
+ * added, removed or change their meaning. */
+#define T8_BENCH_SCALING_SCHEMA "t8_bench_scaling-1"
+
+/* The parameters of the churn decisions, passed to the adapt callback as
+ * user data. */
+typedef struct
+{
+  uint64_t            seed;     /* The seed of the pseudo-random sequence */
+  int                 round;    /* The current churn round */
+  int                 level_min;        /* Do not coarsen below this level */
+  int                 level_max;        /* Do not refine beyond this level */
+  double              churn;    /* Refine and coarsen probability */
+} t8_bench_scaling_ctx_t;
+
+/* Finalization step of the splitmix64 generator, used to turn the global
+ * identity of an element into a reproducible random value. */
+static uint64_t
+t8_bench_scaling_hash (uint64_t x)
+{
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+/* Compute a uniform value in [0, 1) from the global identity of an
+ * element in a given round. The value only depends on the function
+ * arguments, never on the partition or the process count. */
+static double
+t8_bench_scaling_uniform (const t8_bench_scaling_ctx_t *ctx,
+                          t8_gloidx_t gtreeid, t8_linearidx_t linear_id,
+                          int level, uint64_t salt)
+{
+  uint64_t            h;
+
+  h = t8_bench_scaling_hash (ctx->seed ^ ((uint64_t) ctx->round << 32));
+  h = t8_bench_scaling_hash (h ^ (uint64_t) gtreeid);
+  h = t8_bench_scaling_hash (h ^ (uint64_t) linear_id);
+  h = t8_bench_scaling_hash (h ^ ((uint64_t) level << 8) ^ salt);
+  /* Use the upper 53 bits as the mantissa of a double in [0, 1) */
+  return (double) (h >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* Adapt callback implementing the seeded churn. The refine and coarsen
+ * probabilities are equal, so the element count stays roughly stable
+ * over the rounds while the given fraction of the mesh changes. */
+static int
+t8_bench_scaling_adapt (t8_forest_t forest,
+                        t8_forest_t forest_from,
+                        t8_locidx_t which_tree,
+                        t8_locidx_t lelement_id,
+                        t8_eclass_scheme_c *ts,
+                        const int is_family,
+                        const int num_elements, t8_element_t *elements[])
+{
+  const t8_bench_scaling_ctx_t *ctx =
+    (const t8_bench_scaling_ctx_t *) t8_forest_get_user_data (forest);
+  const int           level = ts->t8_element_level (elements[0]);
+  const t8_gloidx_t   gtreeid =
+    t8_forest_global_tree_id (forest_from, which_tree);
+  t8_linearidx_t      linear_id;
+
+  if (is_family && level > ctx->level_min) {
+    /* Decide the coarsening from the id of the parent, so the decision
+     * is the same for every member of the family. */
+    linear_id = ts->t8_element_get_linear_id (elements[0], level - 1);
+    if (t8_bench_scaling_uniform (ctx, gtreeid, linear_id, level - 1, 1)
+        < ctx->churn) {
+      return -1;
+    }
+  }
+  if (level < ctx->level_max) {
+    linear_id = ts->t8_element_get_linear_id (elements[0], level);
+    if (t8_bench_scaling_uniform (ctx, gtreeid, linear_id, level, 0)
+        < ctx->churn) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* The per round metrics of one configuration, before the reduction. The
+ * order of the entries matches the reduction arrays below. */
+typedef struct
+{
+  double              adapt_time;       /* Reduced with max */
+  double              partition_time;   /* Reduced with max */
+  double              ghost_time;       /* Reduced with max */
+  double              ghost_waittime;   /* Reduced with max */
+  double              commit_time;      /* Reduced with max, sum of both commits */
+  double              partition_bytes_sent;     /* Reduced with sum */
+  double              partition_elements_shipped;       /* Reduced with sum */
+  double              partition_procs_sent;     /* Reduced with sum */
+  double              ghosts_shipped;   /* Reduced with sum */
+  double              ghosts_received;  /* Reduced with sum */
+  double              ghost_remotes;    /* Reduced with sum */
+} t8_bench_scaling_metrics_t;
+
+/* Accumulate the profile counters of a committed forest into the
+ * metrics of the current round. */
+static void
+t8_bench_scaling_collect (const t8_forest_t forest,
+                          t8_bench_scaling_metrics_t *metrics)
+{
+  const t8_profile_t *profile = forest->profile;
+
+  T8_ASSERT (profile != NULL);
+  metrics->adapt_time += profile->adapt_runtime;
+  metrics->partition_time += profile->partition_runtime;
+  metrics->ghost_time += profile->ghost_runtime;
+  metrics->ghost_waittime += profile->ghost_waittime;
+  metrics->commit_time += profile->commit_runtime;
+  metrics->partition_bytes_sent += (double) profile->partition_bytes_sent;
+  metrics->partition_elements_shipped +=
+    (double) profile->partition_elements_shipped;
+  metrics->partition_procs_sent += (double) profile->partition_procs_sent;
+  metrics->ghosts_shipped += (double) profile->ghosts_shipped;
+  metrics->ghosts_received += (double) profile->ghosts_received;
+  metrics->ghost_remotes += (double) profile->ghosts_remotes;
+}
+
+/* Reduce the metrics of a round over all processes and write them as one
+ * JSON line on the first process. \a json is NULL on all others. */
+static void
+t8_bench_scaling_report (FILE *json, t8_eclass_t eclass, int level,
+                         double churn, int ghost_algorithm, int iround,
+                         t8_gloidx_t num_elements, int ghost_algorithm_used,
+                         const t8_bench_scaling_metrics_t *metrics)
+{
+  double              max_values[5], sum_values[6];
+  int                 mpiret, mpisize;
+
+  mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &mpisize);
+  SC_CHECK_MPI (mpiret);
+
+  max_values[0] = metrics->adapt_time;
+  max_values[1] = metrics->partition_time;
+  max_values[2] = metrics->ghost_time;
+  max_values[3] = metrics->ghost_waittime;
+  max_values[4] = metrics->commit_time;
+  mpiret = sc_MPI_Allreduce (sc_MPI_IN_PLACE, max_values, 5, sc_MPI_DOUBLE,
+                             sc_MPI_MAX, sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  sum_values[0] = metrics->partition_bytes_sent;
+  sum_values[1] = metrics->partition_elements_shipped;
+  sum_values[2] = metrics->partition_procs_sent;
+  sum_values[3] = metrics->ghosts_shipped;
+  sum_values[4] = metrics->ghosts_received;
+  sum_values[5] = metrics->ghost_remotes;
+  mpiret = sc_MPI_Allreduce (sc_MPI_IN_PLACE, sum_values, 6, sc_MPI_DOUBLE,
+                             sc_MPI_SUM, sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+
+  if (json == NULL) {
+    return;
+  }
+  fprintf (json,
+           "{\"schema\":\"%s\",\"mpisize\":%i,"
+           "\"eclass\":\"%s\",\"initial_level\":%i,\"churn\":%g,"
+           "\"ghost_algorithm\":%i,\"round\":%i,"
+           "\"global_num_elements\":%lli,"
+           "\"ghost_algorithm_used\":%i,"
+           "\"adapt_time\":%.6e,\"partition_time\":%.6e,"
+           "\"ghost_time\":%.6e,\"ghost_waittime\":%.6e,"
+           "\"commit_time\":%.6e,"
+           "\"partition_bytes_sent\":%.0f,"
+           "\"partition_elements_shipped\":%.0f,"
+           "\"partition_procs_sent\":%.0f,"
+           "\"ghosts_shipped\":%.0f,\"ghosts_received\":%.0f,"
+           "\"ghost_remotes\":%.0f}\n",
+           T8_BENCH_SCALING_SCHEMA, mpisize,
+           t8_eclass_to_string[eclass], level, churn,
+           ghost_algorithm, iround, (long long) num_elements,
+           ghost_algorithm_used,
+           max_values[0], max_values[1], max_values[2], max_values[3],
+           max_values[4], sum_values[0], sum_values[1], sum_values[2],
+           sum_values[3], sum_values[4], sum_values[5]);
+}
+
+/* Run the churn rounds of one configuration of the sweep. */
+static void
+t8_bench_scaling_run (FILE *json, t8_eclass_t eclass, int level,
+                      int level_max, double churn, int ghost_algorithm,
+                      int rounds, uint64_t seed, int mpi_profile)
+{
+  t8_bench_scaling_ctx_t ctx;
+  t8_bench_scaling_metrics_t metrics;
+  t8_cmesh_t          cmesh;
+  t8_forest_t         forest, forest_new;
+  int                 iround;
+  int                 ghost_algorithm_used;
+
+  ctx.seed = seed;
+  ctx.round = 0;
+  ctx.level_min = level;
+  ctx.level_max = level_max;
+  ctx.churn = churn;
+
+  t8_global_productionf ("t8_bench_scaling: eclass=%s level=%i churn=%g "
+                         "ghost_algorithm=%i\n",
+                         t8_eclass_to_string[eclass], level, churn,
+                         ghost_algorithm);
+
+  cmesh = t8_cmesh_new_hypercube (eclass, sc_MPI_COMM_WORLD, 0, 0, 0);
+  forest =
+    t8_forest_new_uniform (cmesh, t8_scheme_new_default_cxx (), level, 0,
+                           sc_MPI_COMM_WORLD);
+
+  if (mpi_profile) {
+    /* Record the communication matrices of this configuration */
+    t8_mpi_profile_reset ();
+    t8_mpi_profile_enable ();
+  }
+
+  for (iround = 0; iround < rounds; iround++) {
+    ctx.round = iround;
+    memset (&metrics, 0, sizeof (metrics));
+
+    /* Adapt with the seeded churn callback */
+    t8_forest_init (&forest_new);
+    t8_forest_set_profiling (forest_new, 1);
+    t8_forest_set_user_data (forest_new, &ctx);
+    t8_forest_set_adapt (forest_new, forest, t8_bench_scaling_adapt, 0);
+    t8_forest_commit (forest_new);
+    t8_bench_scaling_collect (forest_new, &metrics);
+    forest = forest_new;
+
+    /* Repartition and build the ghost layer */
+    t8_forest_init (&forest_new);
+    t8_forest_set_profiling (forest_new, 1);
+    t8_forest_set_partition (forest_new, forest, 0);
+    t8_forest_set_ghost_ext (forest_new, 1, T8_GHOST_FACES,
+                             ghost_algorithm, 1);
+    t8_forest_commit (forest_new);
+    t8_bench_scaling_collect (forest_new, &metrics);
+    ghost_algorithm_used = forest_new->profile->ghost_algorithm_used;
+    forest = forest_new;
+
+    t8_bench_scaling_report (json, eclass, level, churn, ghost_algorithm,
+                             iround,
+                             t8_forest_get_global_num_elements (forest),
+                             ghost_algorithm_used, &metrics);
+  }
+
+  if (mpi_profile) {
+    t8_mpi_profile_disable ();
+    t8_mpi_profile_dump ();
+  }
+
+  t8_forest_unref (&forest);
+}
+
+/* Sweep the configuration grid. */
+static void
+t8_bench_scaling_sweep (const char *output, t8_eclass_t eclass,
+                        int level_min, int level_max, int depth,
+                        double churn, int ghost_algorithm, int rounds,
+                        uint64_t seed, int mpi_profile)
+{
+  FILE               *json = NULL;
+  int                 mpiret, mpirank;
+  int                 level, ialgorithm;
+  double              churn_rate;
+
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  if (mpirank == 0) {
+    json = fopen (output, "w");
+    SC_CHECK_ABORTF (json != NULL, "Could not open output file %s", output);
+  }
+
+  for (level = level_min; level <= level_max; level++) {
+    /* Sweep the churn rate in halving steps down from the given rate, so
+     * one run covers heavy and light adaptation. */
+    for (churn_rate = churn; churn_rate >= churn / 4 - 1e-14;
+         churn_rate /= 2) {
+      for (ialgorithm = 1; ialgorithm <= 3; ialgorithm++) {
+        if (ghost_algorithm != 0 && ialgorithm != ghost_algorithm) {
+          continue;
+        }
+        t8_bench_scaling_run (json, eclass, level, level + depth,
+                              churn_rate, ialgorithm, rounds, seed,
+                              mpi_profile);
+      }
+    }
+  }
+
+  if (json != NULL) {
+    fclose (json);
+  }
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  sc_options_t       *opt;
+  int                 helpme = 0;
+  int                 eclass_int;
+  int                 level_min, level_max, depth;
+  int                 ghost_algorithm;
+  int                 rounds;
+  int                 seed;
+  double              churn;
+  int                 mpi_profile = 0;
+  const char         *output;
+  int                 parsed;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_switch (opt, 'h', "help", &helpme,
+                         "Display a short help message.");
+  sc_options_add_int (opt, 'e', "elements", &eclass_int, 4,
+                      "The type of elements to use.\n"
+                      "\t\t\t\t\t2 - quadrilateral\n"
+                      "\t\t\t\t\t3 - triangle\n"
+                      "\t\t\t\t\t4 - hexahedron (default)\n"
+                      "\t\t\t\t\t5 - tetrahedron\n"
+                      "\t\t\t\t\t6 - prism\n" "\t\t\t\t\t7 - pyramid");
+  sc_options_add_int (opt, 'u', "min-level", &level_min, 2,
+                      "Smallest initial uniform level of the sweep.");
+  sc_options_add_int (opt, 'f', "max-level", &level_max, 4,
+                      "Largest initial uniform level of the sweep. The "
+                      "element count grows by 2^dim per level.");
+  sc_options_add_int (opt, 'd', "depth", &depth, 2,
+                      "Number of levels the churn may refine below the "
+                      "initial level.");
+  sc_options_add_double (opt, 'c', "churn", &churn, 0.25,
+                         "Largest churn rate of the sweep. The sweep "
+                         "halves the rate twice, covering [churn/4, churn].");
+  sc_options_add_int (opt, 'g', "ghost-algorithm", &ghost_algorithm, 0,
+                      "Fix the ghost algorithm (1, 2, or 3). "
+                      "0 sweeps all three (default).");
+  sc_options_add_int (opt, 'r', "rounds", &rounds, 3,
+                      "Number of adapt/partition/ghost rounds per "
+                      "configuration.");
+  sc_options_add_int (opt, 's', "seed", &seed, 0,
+                      "Seed of the pseudo-random churn. Equal seeds give "
+                      "equal mesh sequences on any number of processes.");
+  sc_options_add_switch (opt, 'm', "mpi-profile", &mpi_profile,
+                         "Record and dump the per-peer communication "
+                         "matrices of each configuration.");
+  sc_options_add_string (opt, 'o', "output", &output,
+                         "t8_bench_scaling.json",
+                         "The output file. One JSON object per round is "
+                         "written per line.");
+
+  parsed = sc_options_parse (t8_get_package_id (), SC_LP_ERROR, opt,
+                             argc, argv);
+  if (helpme) {
+    t8_global_productionf
+      ("Sweep element counts, churn rates and ghost algorithms and "
+       "emit the profile statistics of every round as JSON lines.\n");
+    sc_options_print_usage (t8_get_package_id (), SC_LP_ERROR, opt, NULL);
+  }
+  else if (parsed >= 0 && eclass_int > 1 && eclass_int < 8
+           && 0 <= level_min && level_min <= level_max && depth >= 0
+           && (0 <= ghost_algorithm && ghost_algorithm <= 3)
+           && rounds > 0 && seed >= 0 && 0 < churn && churn <= 1) {
+    t8_bench_scaling_sweep (output, (t8_eclass_t) eclass_int, level_min,
+                            level_max, depth, churn, ghost_algorithm,
+                            rounds, (uint64_t) seed, mpi_profile);
+  }
+  else {
+    t8_global_productionf ("\n\t ERROR: Wrong usage.\n\n");
+    sc_options_print_usage (t8_get_package_id (), SC_LP_ERROR, opt, NULL);
+  }
+
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+  return 0;
+}
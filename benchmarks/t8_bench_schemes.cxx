@@ -0,0 +1,232 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/* Microbenchmark for the element scheme operations.
+ *
+ * In contrast to the other benchmarks in this directory, which time whole
+ * algorithms (adapt, partition, ...), this program isolates the per-element
+ * operations of the t8_eclass_scheme_c vtable: child, parent,
+ * face_neighbor_inside, get_linear_id and compare. Each operation is timed
+ * over a pool of pseudo-random elements and the result is printed as one
+ * machine-readable line per (eclass, operation) pair of the form
+ *
+ *   t8_bench_schemes: eclass=tet op=child ns_per_op=42.17 num_ops=5000000
+ *
+ * so that the numbers can be tracked as baselines across releases.
+ */
+
+#include <t8.h>
+#include <t8_eclass.h>
+#include <t8_element_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <sc_options.h>
+
+/* The elements are drawn uniformly from the levels 1 to
+ * T8_BENCH_SCHEMES_LEVEL of a uniform refinement. Level 0 is excluded so
+ * that every element has a parent. */
+#define T8_BENCH_SCHEMES_LEVEL 6
+
+/* Print one result line. The format is fixed, scripts parse it. */
+static void
+t8_bench_schemes_report (t8_eclass_t eclass, const char *op,
+                         double seconds, long long num_ops)
+{
+  t8_global_productionf ("t8_bench_schemes: eclass=%s op=%s "
+                         "ns_per_op=%.2f num_ops=%lld\n",
+                         t8_eclass_to_string[eclass], op,
+                         1e9 * seconds / (double) num_ops, num_ops);
+}
+
+/* Time the scheme operations of one eclass over \a num_elements
+ * pseudo-random elements, repeating the element pool \a rounds times. */
+static void
+t8_bench_schemes_eclass (t8_eclass_scheme_c *ts, t8_eclass_t eclass,
+                         int num_elements, int rounds)
+{
+  t8_element_t      **elements;
+  t8_element_t       *scratch;
+  int                *rand_ints;
+  int                 ielem, iround, level, num_faces;
+  t8_linearidx_t      id, num_leafs, id_sum = 0;
+  int                 int_sum = 0;
+  double              time;
+  const long long     num_ops = (long long) num_elements * rounds;
+
+  /* Build the element pool. The levels and linear ids are pseudo-random
+   * with a fixed seed, such that repeated runs time the same elements. */
+  srand (42 + (int) eclass);
+  elements = T8_ALLOC (t8_element_t *, num_elements);
+  ts->t8_element_new (num_elements, elements);
+  ts->t8_element_new (1, &scratch);
+  /* One random integer per element, drawn outside of the timed loops and
+   * used to pick child numbers and faces. */
+  rand_ints = T8_ALLOC (int, num_elements);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    level = 1 + rand () % T8_BENCH_SCHEMES_LEVEL;
+    num_leafs = ts->t8_element_count_leafs_from_root (level);
+    id = ((t8_linearidx_t) rand () << 31 ^ (t8_linearidx_t) rand ())
+      % num_leafs;
+    ts->t8_element_set_linear_id (elements[ielem], level, id);
+    rand_ints[ielem] = rand ();
+  }
+
+  /* child */
+  time = -sc_MPI_Wtime ();
+  for (iround = 0; iround < rounds; iround++) {
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      ts->t8_element_child (elements[ielem],
+                            rand_ints[ielem] %
+                            ts->t8_element_num_children (elements[ielem]),
+                            scratch);
+    }
+  }
+  time += sc_MPI_Wtime ();
+  t8_bench_schemes_report (eclass, "child", time, num_ops);
+
+  /* parent */
+  time = -sc_MPI_Wtime ();
+  for (iround = 0; iround < rounds; iround++) {
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      ts->t8_element_parent (elements[ielem], scratch);
+    }
+  }
+  time += sc_MPI_Wtime ();
+  t8_bench_schemes_report (eclass, "parent", time, num_ops);
+
+  /* face_neighbor_inside. Vertex elements do not have faces, in this
+   * case the operation is skipped. */
+  num_faces = ts->t8_element_num_faces (elements[0]);
+  if (num_faces > 0) {
+    int                 neigh_face;
+    time = -sc_MPI_Wtime ();
+    for (iround = 0; iround < rounds; iround++) {
+      for (ielem = 0; ielem < num_elements; ielem++) {
+        int_sum +=
+          ts->t8_element_face_neighbor_inside (elements[ielem], scratch,
+                                               rand_ints[ielem] %
+                                               ts->t8_element_num_faces
+                                               (elements[ielem]),
+                                               &neigh_face);
+      }
+    }
+    time += sc_MPI_Wtime ();
+    t8_bench_schemes_report (eclass, "face_neighbor_inside", time, num_ops);
+  }
+
+  /* get_linear_id */
+  time = -sc_MPI_Wtime ();
+  for (iround = 0; iround < rounds; iround++) {
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      id_sum +=
+        ts->t8_element_get_linear_id (elements[ielem],
+                                      T8_BENCH_SCHEMES_LEVEL);
+    }
+  }
+  time += sc_MPI_Wtime ();
+  t8_bench_schemes_report (eclass, "get_linear_id", time, num_ops);
+
+  /* compare. Each element is compared with its successor in the pool. */
+  time = -sc_MPI_Wtime ();
+  for (iround = 0; iround < rounds; iround++) {
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      int_sum +=
+        ts->t8_element_compare (elements[ielem],
+                                elements[(ielem + 1) % num_elements]);
+    }
+  }
+  time += sc_MPI_Wtime ();
+  t8_bench_schemes_report (eclass, "compare", time, num_ops);
+
+  /* Report the accumulated return values, so that the compiler cannot
+   * discard the timed calls. */
+  t8_debugf ("t8_bench_schemes checksums: %i %lli\n", int_sum,
+             (long long) id_sum);
+
+  ts->t8_element_destroy (1, &scratch);
+  ts->t8_element_destroy (num_elements, elements);
+  T8_FREE (elements);
+  T8_FREE (rand_ints);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  sc_options_t       *opt;
+  int                 helpme;
+  int                 eclass_int;
+  int                 num_elements;
+  int                 rounds;
+  int                 parsed;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_switch (opt, 'h', "help", &helpme,
+                         "Display a short help message.");
+  sc_options_add_int (opt, 'e', "elements", &eclass_int, -1,
+                      "The eclass to benchmark as in t8_eclass_t.\n"
+                      "\t\t\t\t\t-1 - all eclasses (default)");
+  sc_options_add_int (opt, 'n', "num-elements", &num_elements, 1000000,
+                      "The number of pseudo-random elements in the pool. "
+                      "The default is 1000000.");
+  sc_options_add_int (opt, 'r', "rounds", &rounds, 5,
+                      "The number of times each operation is applied to "
+                      "every element of the pool. The default is 5.");
+
+  parsed = sc_options_parse (t8_get_package_id (), SC_LP_ERROR, opt,
+                             argc, argv);
+  if (helpme) {
+    t8_global_productionf
+      ("Benchmark the element scheme operations of the default scheme.\n");
+    sc_options_print_usage (t8_get_package_id (), SC_LP_ERROR, opt, NULL);
+  }
+  else if (parsed >= 0 && eclass_int >= -1 && eclass_int < T8_ECLASS_COUNT
+           && num_elements > 0 && rounds > 0) {
+    t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+    int                 ieclass;
+
+    for (ieclass = T8_ECLASS_ZERO; ieclass < T8_ECLASS_COUNT; ieclass++) {
+      if (eclass_int == -1 || eclass_int == ieclass) {
+        t8_bench_schemes_eclass (scheme->eclass_schemes[ieclass],
+                                 (t8_eclass_t) ieclass, num_elements,
+                                 rounds);
+      }
+    }
+    t8_scheme_cxx_unref (&scheme);
+  }
+  else {
+    t8_global_productionf ("\n\t ERROR: Wrong usage.\n\n");
+    sc_options_print_usage (t8_get_package_id (), SC_LP_ERROR, opt, NULL);
+  }
+
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+  return 0;
+}
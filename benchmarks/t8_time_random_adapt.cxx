@@ -0,0 +1,394 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/* Deterministic pseudo-random adapt benchmark.
+ *
+ * The benchmark drives rounds of refine/coarsen churn whose decisions are
+ * computed by hashing the global identity of an element (global tree id,
+ * linear id, level) together with a seed and the round number. The
+ * sequence of meshes is therefore reproducible from the seed and does not
+ * depend on the number of processes or the partition, so runs on
+ * different machines, process counts and t8code releases can be compared
+ * against each other. The refine probability decays with the depth below
+ * the initial level, which shapes the level distribution, and the
+ * coarsen probability controls the churn of whole families.
+ *
+ * Per round the benchmark adapts (optionally balances), partitions and
+ * optionally builds a ghost layer, accumulating the phase timings from
+ * the t8_profile counters together with the bytes partition moved and the
+ * elements adapt processed. The final summary reports per-phase times,
+ * elements per second and a roofline-style pairing of the achieved
+ * element rate with the achieved network bandwidth.
+ */
+
+#include <t8.h>
+#include <t8_forest/t8_forest.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_forest/t8_forest_profiling.h>
+#include <t8_eclass.h>
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <sc_statistics.h>
+#include <sc_options.h>
+#include <stdint.h>
+
+/* The parameters of the random adapt decisions, passed to the adapt
+ * callback as user data. */
+typedef struct
+{
+  uint64_t            seed;     /* The seed of the pseudo-random sequence */
+  int                 round;    /* The current churn round */
+  int                 level_min;        /* Do not coarsen below this level */
+  int                 level_max;        /* Do not refine beyond this level */
+  double              p_refine; /* Refine probability at level_min */
+  double              p_coarsen;        /* Coarsen probability of a family */
+  double              depth_bias;       /* Factor on p_refine per level below
+                                           level_min, in (0, 1] */
+} t8_random_adapt_ctx_t;
+
+/* Finalization step of the splitmix64 generator. Used as a hash to turn
+ * the global identity of an element into a reproducible random value. */
+static uint64_t
+t8_random_adapt_hash (uint64_t x)
+{
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+/* Compute a uniform value in [0, 1) from the global identity of an
+ * element in a given round. The value only depends on the function
+ * arguments, never on the partition or the process count. */
+static double
+t8_random_adapt_uniform (const t8_random_adapt_ctx_t *ctx,
+                         t8_gloidx_t gtreeid, t8_linearidx_t linear_id,
+                         int level, uint64_t salt)
+{
+  uint64_t            h;
+
+  h = t8_random_adapt_hash (ctx->seed ^ ((uint64_t) ctx->round << 32));
+  h = t8_random_adapt_hash (h ^ (uint64_t) gtreeid);
+  h = t8_random_adapt_hash (h ^ (uint64_t) linear_id);
+  h = t8_random_adapt_hash (h ^ ((uint64_t) level << 8) ^ salt);
+  /* Use the upper 53 bits as the mantissa of a double in [0, 1) */
+  return (double) (h >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* Adapt callback implementing the seeded refine/coarsen churn. */
+static int
+t8_random_adapt_callback (t8_forest_t forest,
+                          t8_forest_t forest_from,
+                          t8_locidx_t which_tree,
+                          t8_locidx_t lelement_id,
+                          t8_eclass_scheme_c *ts,
+                          const int is_family,
+                          const int num_elements, t8_element_t *elements[])
+{
+  const t8_random_adapt_ctx_t *ctx =
+    (const t8_random_adapt_ctx_t *) t8_forest_get_user_data (forest);
+  const int           level = ts->t8_element_level (elements[0]);
+  const t8_gloidx_t   gtreeid =
+    t8_forest_global_tree_id (forest_from, which_tree);
+  t8_linearidx_t      linear_id;
+  double              u, p;
+
+  if (is_family && level > ctx->level_min) {
+    /* Decide the coarsening from the id of the parent, so the decision is
+     * the same for every member of the family and in particular does not
+     * depend on where the family lies in the partition. */
+    linear_id = ts->t8_element_get_linear_id (elements[0], level - 1);
+    u = t8_random_adapt_uniform (ctx, gtreeid, linear_id, level - 1, 1);
+    if (u < ctx->p_coarsen) {
+      return -1;
+    }
+  }
+  if (level < ctx->level_max) {
+    /* The refine probability decays with the depth below the initial
+     * level, biasing the level distribution towards shallow elements. */
+    p = ctx->p_refine;
+    if (ctx->depth_bias < 1) {
+      p *= pow (ctx->depth_bias, (double) (level - ctx->level_min));
+    }
+    linear_id = ts->t8_element_get_linear_id (elements[0], level);
+    u = t8_random_adapt_uniform (ctx, gtreeid, linear_id, level, 0);
+    if (u < p) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* Run the churn rounds and print the per-phase and roofline summary. */
+static void
+t8_time_random_adapt (uint64_t seed, int level, int level_max, int rounds,
+                      double p_refine, double p_coarsen, double depth_bias,
+                      int trees, t8_eclass_t eclass, int do_ghost,
+                      int do_balance)
+{
+  t8_random_adapt_ctx_t ctx;
+  t8_cmesh_t          cmesh;
+  t8_forest_t         forest, forest_new;
+  sc_statinfo_t       times[4];
+  double              adapt_time = 0, balance_time = 0;
+  double              partition_time = 0, ghost_time = 0;
+  double              elements_processed = 0, bytes_moved = 0;
+  double              local_counters[2], global_counters[2];
+  double              total_time, max_times[4];
+  t8_locidx_t         ghosts_sent;
+  int                 iround, procs_sent, balance_rounds;
+  int                 mpiret;
+
+  ctx.seed = seed;
+  ctx.round = 0;
+  ctx.level_min = level;
+  ctx.level_max = level_max;
+  ctx.p_refine = p_refine;
+  ctx.p_coarsen = p_coarsen;
+  ctx.depth_bias = depth_bias;
+
+  sc_stats_init (&times[0], "adapt");
+  sc_stats_init (&times[1], "balance");
+  sc_stats_init (&times[2], "partition");
+  sc_stats_init (&times[3], "ghost");
+
+  if (trees > 1) {
+    cmesh = t8_cmesh_new_bigmesh (eclass, trees, sc_MPI_COMM_WORLD);
+  }
+  else {
+    cmesh = t8_cmesh_new_hypercube (eclass, sc_MPI_COMM_WORLD, 0, 0, 0);
+  }
+  forest =
+    t8_forest_new_uniform (cmesh, t8_scheme_new_default_cxx (), level, 0,
+                           sc_MPI_COMM_WORLD);
+
+  for (iround = 0; iround < rounds; iround++) {
+    ctx.round = iround;
+    /* Count the elements entering this adapt round */
+    elements_processed +=
+      (double) t8_forest_get_global_num_elements (forest);
+
+    /* Adapt (and optionally balance) with the seeded callback */
+    t8_forest_init (&forest_new);
+    t8_forest_set_profiling (forest_new, 1);
+    t8_forest_set_user_data (forest_new, &ctx);
+    t8_forest_set_adapt (forest_new, forest, t8_random_adapt_callback, 0);
+    if (do_balance) {
+      t8_forest_set_balance (forest_new, NULL, 0);
+    }
+    t8_forest_commit (forest_new);
+    adapt_time += t8_forest_profile_get_adapt_time (forest_new);
+    if (do_balance) {
+      balance_time +=
+        t8_forest_profile_get_balance_time (forest_new, &balance_rounds);
+    }
+    forest = forest_new;
+
+    /* Repartition (and optionally build the ghost layer) */
+    t8_forest_init (&forest_new);
+    t8_forest_set_profiling (forest_new, 1);
+    t8_forest_set_partition (forest_new, forest, 0);
+    if (do_ghost) {
+      t8_forest_set_ghost (forest_new, 1, T8_GHOST_FACES);
+    }
+    t8_forest_commit (forest_new);
+    partition_time +=
+      t8_forest_profile_get_partition_time (forest_new, &procs_sent);
+    if (do_ghost) {
+      ghost_time += t8_forest_profile_get_ghost_time (forest_new,
+                                                      &ghosts_sent);
+    }
+    if (forest_new->profile != NULL) {
+      bytes_moved += (double) forest_new->profile->partition_bytes_sent;
+    }
+    forest = forest_new;
+  }
+
+  /* Print the per-phase timing statistics over all processes */
+  sc_stats_accumulate (&times[0], adapt_time);
+  sc_stats_accumulate (&times[1], balance_time);
+  sc_stats_accumulate (&times[2], partition_time);
+  sc_stats_accumulate (&times[3], ghost_time);
+  sc_stats_compute (sc_MPI_COMM_WORLD, 4, times);
+  sc_stats_print (t8_get_package_id (), SC_LP_ESSENTIAL, 4, times, 1, 1);
+
+  /* Reduce the counters and the phase times for the summary. The summary
+   * rates use the maximum time over all processes, since the slowest
+   * process determines the achieved throughput. */
+  local_counters[0] = elements_processed;
+  local_counters[1] = bytes_moved;
+  mpiret = sc_MPI_Allreduce (local_counters, global_counters, 2,
+                             sc_MPI_DOUBLE, sc_MPI_SUM, sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  max_times[0] = adapt_time;
+  max_times[1] = balance_time;
+  max_times[2] = partition_time;
+  max_times[3] = ghost_time;
+  mpiret = sc_MPI_Allreduce (sc_MPI_IN_PLACE, max_times, 4, sc_MPI_DOUBLE,
+                             sc_MPI_MAX, sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  total_time = max_times[0] + max_times[1] + max_times[2] + max_times[3];
+
+  t8_global_productionf ("Random adapt summary (seed %llu, %i rounds):\n",
+                         (unsigned long long) seed, rounds);
+  t8_global_productionf (" final elements:     %lli\n", (long long)
+                         t8_forest_get_global_num_elements (forest));
+  t8_global_productionf (" elements processed: %.3e\n", global_counters[0]);
+  t8_global_productionf (" bytes partitioned:  %.3e\n", global_counters[1]);
+  t8_global_productionf (" adapt:     %10.4f s  %.3e elements/s\n",
+                         max_times[0], max_times[0] > 0 ?
+                         global_counters[0] / max_times[0] : 0);
+  if (do_balance) {
+    t8_global_productionf (" balance:   %10.4f s\n", max_times[1]);
+  }
+  t8_global_productionf (" partition: %10.4f s  %.3e bytes/s\n",
+                         max_times[2], max_times[2] > 0 ?
+                         global_counters[1] / max_times[2] : 0);
+  if (do_ghost) {
+    t8_global_productionf (" ghost:     %10.4f s\n", max_times[3]);
+  }
+  /* The roofline pairing: the achieved element rate over the whole churn
+   * against the achieved data movement rate. The intensity states how
+   * many elements are processed per byte moved; runs with a high
+   * intensity are compute bound in adapt, runs with a low intensity are
+   * bound by the partition data movement. */
+  if (total_time > 0 && global_counters[1] > 0) {
+    t8_global_productionf
+      (" roofline:  %.3e elements/s at %.3e bytes/s,"
+       " intensity %.3e elements/byte\n",
+       global_counters[0] / total_time, global_counters[1] / total_time,
+       global_counters[0] / global_counters[1]);
+  }
+
+  t8_forest_unref (&forest);
+}
+
+int
+main (int argc, char **argv)
+{
+  char                usage[BUFSIZ];
+  /* brief help message */
+  int                 sreturnA = snprintf (usage, BUFSIZ,
+                                           "Usage:\t%s <OPTIONS>\n\t%s -h\t"
+                                           "for a brief overview of all options.",
+                                           basename (argv[0]),
+                                           basename (argv[0]));
+
+  char                help[BUFSIZ];
+  /* long help message */
+  int                 sreturnB = snprintf (help, BUFSIZ,
+                                           "This program benchmarks rounds of seeded, reproducible\n"
+                                           "pseudo-random refine/coarsen churn with repartitioning.\n\n%s\n",
+                                           usage);
+
+  if (sreturnA > BUFSIZ || sreturnB > BUFSIZ) {
+    /* The usage string or help message was truncated */
+    /* Note: gcc >= 7.1 prints a warning if we
+     * do not check the return value of snprintf. */
+    t8_debugf
+      ("Warning: Truncated usage string and help message to '%s' and '%s'\n",
+       usage, help);
+  }
+
+  int                 mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  int                 seed = 0;
+  int                 level = -1;
+  int                 level_max = -1;
+  int                 rounds = -1;
+  int                 trees = 1;
+  int                 eclass_int = -1;
+  int                 do_ghost = 0;
+  int                 do_balance = 0;
+  int                 helpme = 0;
+  double              p_refine = 0.25;
+  double              p_coarsen = 0.25;
+  double              depth_bias = 1;
+
+  /* initialize command line argument parser */
+  sc_options_t       *opt = sc_options_new (argv[0]);
+  sc_options_add_switch (opt, 'h', "help", &helpme,
+                         "Display a short help message.");
+  sc_options_add_int (opt, 's', "seed", &seed, 0,
+                      "Seed of the pseudo-random adapt sequence. "
+                      "Equal seeds give equal mesh sequences on any number of processes.");
+  sc_options_add_int (opt, 'u', "uniform_level", &level, 3,
+                      "Initial uniform refinement level. Elements are never coarsened below it.");
+  sc_options_add_int (opt, 'f', "final_level", &level_max, 7,
+                      "Maximum refinement level of the churn.");
+  sc_options_add_int (opt, 'r', "rounds", &rounds, 10,
+                      "Number of adapt/partition rounds.");
+  sc_options_add_double (opt, 'p', "refine-probability", &p_refine, 0.25,
+                         "Probability to refine an element at the initial level.");
+  sc_options_add_double (opt, 'c', "coarsen-probability", &p_coarsen, 0.25,
+                         "Probability to coarsen a complete family.");
+  sc_options_add_double (opt, 'd', "depth-bias", &depth_bias, 1,
+                         "Factor on the refine probability per level below the\n"
+                         "\t\t\t\t     initial level, in (0,1]. Smaller values keep the mesh shallow.");
+  sc_options_add_int (opt, 'e', "elements", &eclass_int, 4,
+                      "Specify the type of elements to use.\n"
+                      "\t\t\t\t\t2 - quadrilateral\n"
+                      "\t\t\t\t\t3 - triangle\n"
+                      "\t\t\t\t\t4 - hexahedron (default)\n"
+                      "\t\t\t\t\t5 - tetrahedron\n"
+                      "\t\t\t\t\t6 - prism\n" "\t\t\t\t\t7 - pyramid");
+  sc_options_add_int (opt, 't', "trees", &trees, 1,
+                      "Number of trees the forest will contain. The default is 1.");
+  sc_options_add_switch (opt, 'g', "ghost", &do_ghost,
+                         "Build a face ghost layer in each round.");
+  sc_options_add_switch (opt, 'b', "balance", &do_balance,
+                         "2:1 balance the forest in each round.");
+
+  int                 parsed =
+    sc_options_parse (t8_get_package_id (), SC_LP_ERROR, opt, argc, argv);
+  if (helpme) {
+    /* display help message and usage */
+    t8_global_productionf ("%s\n", help);
+    sc_options_print_usage (t8_get_package_id (), SC_LP_ERROR, opt, NULL);
+  }
+  else if (parsed >= 0 && seed >= 0 && level >= 0 && level <= level_max
+           && rounds > 0 && trees > 0 && 0 <= p_refine && p_refine <= 1
+           && 0 <= p_coarsen && p_coarsen <= 1 && 0 < depth_bias
+           && depth_bias <= 1 && eclass_int > 1 && eclass_int < 8) {
+    t8_time_random_adapt ((uint64_t) seed, level, level_max, rounds,
+                          p_refine, p_coarsen, depth_bias, trees,
+                          (t8_eclass_t) eclass_int, do_ghost, do_balance);
+  }
+  else {
+    /* wrong usage */
+    t8_global_productionf ("\n\t ERROR: Wrong usage.\n\n");
+    sc_options_print_usage (t8_get_package_id (), SC_LP_ERROR, opt, NULL);
+  }
+
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -206,7 +206,8 @@ t8_test_ghost_refine_and_partition (t8_cmesh_t cmesh, const int level,
   /* Set the forest for partitioning */
   t8_forest_set_partition (forest_ghost, forest, 0);
   /* Activate ghost creation */
-  t8_forest_set_ghost_ext (forest_ghost, 1, T8_GHOST_FACES, ghost_version);
+  t8_forest_set_ghost_ext (forest_ghost, 1, T8_GHOST_FACES, ghost_version,
+                           1);
   /* Activate timers */
   t8_forest_set_profiling (forest_ghost, 1);
 
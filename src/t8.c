@@ -22,6 +22,8 @@
 
 #include <t8.h>
 #include <t8_version.h>
+#include <t8_cpuid.h>
+#include <t8_geometry/t8_geometry_helpers.h>
 
 static int          t8_package_id = -1;
 
@@ -146,19 +148,34 @@ t8_init (int log_threshold)
 {
   int                 w;
 
-  t8_package_id = sc_package_register (NULL, log_threshold,
-                                       "t8", "Adaptive discretizations");
-
-  w = 24;
-  t8_global_essentialf ("This is %s\n", t8_get_package_string ());
-  t8_global_productionf ("%-*s %s\n", w, "CPP", T8_CPP);
-  t8_global_productionf ("%-*s %s\n", w, "CPPFLAGS", T8_CPPFLAGS);
-  t8_global_productionf ("%-*s %s\n", w, "CC", T8_CC);
-  t8_global_productionf ("%-*s %s\n", w, "CFLAGS", T8_CFLAGS);
-  t8_global_productionf ("%-*s %s\n", w, "LDFLAGS", T8_LDFLAGS);
-  t8_global_productionf ("%-*s %s\n", w, "LIBS", T8_LIBS);
+  /* Registration is guarded so that independent pipelines may call
+   * t8_init repeatedly and, with OpenMP enabled, from different threads.
+   * The package id is written exactly once and only read afterwards. */
+#ifdef T8_ENABLE_OPENMP
+#pragma omp critical (t8_init_register)
+#endif
+  if (t8_package_id < 0) {
+    t8_package_id = sc_package_register (NULL, log_threshold,
+                                         "t8", "Adaptive discretizations");
+
+    w = 24;
+    t8_global_essentialf ("This is %s\n", t8_get_package_string ());
+    t8_global_productionf ("%-*s %s\n", w, "CPP", T8_CPP);
+    t8_global_productionf ("%-*s %s\n", w, "CPPFLAGS", T8_CPPFLAGS);
+    t8_global_productionf ("%-*s %s\n", w, "CC", T8_CC);
+    t8_global_productionf ("%-*s %s\n", w, "CFLAGS", T8_CFLAGS);
+    t8_global_productionf ("%-*s %s\n", w, "LDFLAGS", T8_LDFLAGS);
+    t8_global_productionf ("%-*s %s\n", w, "LIBS", T8_LIBS);
+
+    /* Select the vector instruction set variants of the hot kernels for
+     * the CPU this process actually runs on, so that one binary can be
+     * deployed across partitions with different vector widths. */
+    t8_geom_batch_kernels_init ();
+    t8_global_productionf ("%-*s %s\n", w, "SIMD", t8_cpuid_isa_name ());
+  }
 }
 
+#ifndef T8_ENABLE_FAST
 void               *
 t8_sc_array_index_locidx (sc_array_t *array, t8_locidx_t it)
 {
@@ -166,3 +183,4 @@ t8_sc_array_index_locidx (sc_array_t *array, t8_locidx_t it)
 
   return array->array + array->elem_size * (size_t) it;
 }
+#endif
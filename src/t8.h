@@ -132,6 +132,9 @@ typedef enum
   T8_MPI_PARTITION_FOREST,  /**< Used for forest partitioning */
   T8_MPI_GHOST_FOREST,  /**< Used for for ghost layer creation */
   T8_MPI_GHOST_EXC_FOREST,  /**< Used for ghost data exchange */
+  T8_MPI_VALIDATE_FOREST,  /**< Used for the rank handshake of forest validation */
+  T8_MPI_MIGRATE_FOREST,  /**< Used for migrating a forest to another communicator */
+  T8_MPI_PROGRESS,  /**< Never sent; probed by the async progress engine */
   T8_MPI_TAG_LAST
 }
 t8_MPI_tag_t;
@@ -257,8 +260,16 @@ void                t8_init (int log_threshold);
  * \param [in] index needs to be in [0]..[elem_count-1].
  * \return           A void * pointing to entry \a it in \a array.
  */
+#ifndef T8_ENABLE_FAST
 void               *t8_sc_array_index_locidx (sc_array_t *array,
                                               t8_locidx_t it);
+#else
+/* In fast mode (--enable-fast) we replace the bounds checking accessor
+ * by raw pointer arithmetic, so that internal hot loops do not pay for a
+ * function call per element access. */
+#define t8_sc_array_index_locidx(array,it) \
+  ((void *) ((array)->array + (array)->elem_size * (size_t) (it)))
+#endif
 
 /* call this at the end of a header file to match T8_EXTERN_C_BEGIN (). */
 T8_EXTERN_C_END ();
@@ -291,6 +291,64 @@ void                t8_cmesh_set_attribute_string (t8_cmesh_t cmesh,
                                                    int package_id, int key,
                                                    const char *string);
 
+/** Enable lazy attribute loading for a cmesh.
+ * Normally \ref t8_cmesh_commit copies the payloads of all tree attributes
+ * into the trees structure. With lazy attributes, commit only records the
+ * attribute extents (sizes, keys and offsets) and defers the payload
+ * copies; the payloads of a tree are copied from the stash on its first
+ * attribute access (for example via \ref t8_cmesh_get_tree_vertices).
+ * If a forest only ever touches a fraction of the trees per process, the
+ * memory pages of the untouched attribute payloads are never written.
+ * Lazy attributes are only supported for replicated cmeshes that are
+ * committed from a stash; the setting is ignored otherwise.
+ * \param [in,out] cmesh        The cmesh to be updated. Must not be committed.
+ * \see t8_cmesh_prefetch_attributes
+ */
+void                t8_cmesh_set_lazy_attributes (t8_cmesh_t cmesh);
+
+/** Store the trees and attribute data of a replicated cmesh only once
+ * per compute node.
+ * If enabled, \ref t8_cmesh_commit moves the trees structure's data --
+ * the tree and ghost records, the face neighbor encodings and all
+ * attribute payloads -- into an MPI-3 shared memory window on the
+ * intranode communicator. One rank per node writes the data and all
+ * other ranks of the node access it read-only, so a replicated cmesh is
+ * held once per node instead of once per rank.
+ * The setting requires MPI window support and attached node
+ * communicators (\ref t8_shmem_init is called on demand); without them
+ * it is silently ignored. It is also ignored for partitioned cmeshes
+ * and for cmeshes with lazy attributes, whose payloads are written
+ * after commit.
+ * \param [in,out] cmesh        The cmesh to be updated. Must not be committed.
+ * \note Destroying the cmesh frees the shared window collectively, so all
+ * ranks of a node must destroy it.
+ */
+void                t8_cmesh_set_shared_node_memory (t8_cmesh_t cmesh,
+                                                     int set_node_shared);
+
+/** Renumber the trees of a cmesh for locality at commit.
+ * Mesh generators and CAD front ends deliver the trees in an order in
+ * which face-neighboring trees can lie arbitrarily far apart, so the
+ * space-filling curve traversal of a forest built on top hops wildly
+ * through the per-tree data of the cmesh. If enabled,
+ * \ref t8_cmesh_commit renumbers the trees along a breadth-first
+ * traversal of the face-neighbor graph before the trees structure is
+ * built, giving neighboring trees nearby ids; the face-connections and
+ * attributes are relabeled accordingly. Every downstream per-tree lookup
+ * then touches nearby memory for trees that are close along the curve.
+ * The renumbering changes the global tree ids, so do not enable it if
+ * tree ids need to match the input ordering (for example to correlate
+ * with the source file of the mesh).
+ * Reordering is only supported for replicated cmeshes that are committed
+ * from a stash; the setting is ignored otherwise.
+ * \param [in,out] cmesh             The cmesh to be updated. Must not be
+ *                                   committed.
+ * \param [in]     set_reorder_trees If nonzero, reorder the trees at
+ *                                   commit.
+ */
+void                t8_cmesh_set_reorder_trees (t8_cmesh_t cmesh,
+                                                int set_reorder_trees);
+
 /** Insert a face-connection between two trees in a cmesh.
  * \param [in,out] cmesh        The cmesh to be updated.
  * \param [in]     tree1        The tree id of the first of the two trees.
@@ -306,6 +364,80 @@ void                t8_cmesh_set_join (t8_cmesh_t cmesh, t8_gloidx_t gtree1,
                                        t8_gloidx_t gtree2, int face1,
                                        int face2, int orientation);
 
+/** Preallocate the trees structure of a replicated cmesh, so that tree
+ * classes, face-connections and attributes are written directly into
+ * their final layout instead of through the stash.
+ * \ref t8_cmesh_set_tree_class and \ref t8_cmesh_set_join funnel all
+ * input through the stash, which \ref t8_cmesh_commit then sorts and
+ * copies into the trees structure - pure overhead for mesh generators
+ * that already know the complete ordered tree list. After this call the
+ * trees structure is allocated with its final sizes, all faces are
+ * boundary faces and the connections and attributes are filled in with
+ * \ref t8_cmesh_direct_set_join and \ref t8_cmesh_direct_set_attribute;
+ * the commit reduces to a validation pass.
+ * A direct build must not be combined with the stash setters, with
+ * \ref t8_cmesh_set_derive, nor with partitioning, refining or tree
+ * reordering at commit.
+ * \param [in,out] cmesh        The cmesh. Must be initialized, not committed
+ *                              and without previously inserted trees.
+ * \param [in] num_trees        The total number of trees.
+ * \param [in] tree_classes     The element class of each tree, an array of
+ *                              length \a num_trees indexed by tree id.
+ *                              All classes must be of the same dimension.
+ * \param [in] num_attributes   If not NULL, the number of attributes each
+ *                              tree will receive.
+ *                              NULL if no tree has attributes.
+ * \param [in] attr_bytes       If not NULL, the total number of bytes of
+ *                              all attributes of each tree.
+ *                              Must be NULL if and only if
+ *                              \a num_attributes is NULL.
+ */
+void                t8_cmesh_set_direct_build (t8_cmesh_t cmesh,
+                                               t8_locidx_t num_trees,
+                                               const t8_eclass_t
+                                               *tree_classes,
+                                               const size_t *num_attributes,
+                                               const size_t *attr_bytes);
+
+/** Insert a face-connection between two trees of a direct build.
+ * The connection is written straight into the preallocated trees
+ * structure, \see t8_cmesh_set_direct_build. Unlike
+ * \ref t8_cmesh_set_join the same connection must not be inserted twice.
+ * \param [in,out] cmesh        The cmesh. A direct build must have been
+ *                              started with \ref t8_cmesh_set_direct_build.
+ * \param [in]     ltree1       The tree id of the first of the two trees.
+ * \param [in]     ltree2       The tree id of the second of the two trees.
+ * \param [in]     face1        The face number of the first tree.
+ * \param [in]     face2        The face number of the second tree.
+ * \param [in]     orientation  The orientation of the two faces to each
+ *                              other, \see t8_cmesh_set_join.
+ */
+void                t8_cmesh_direct_set_join (t8_cmesh_t cmesh,
+                                              t8_locidx_t ltree1,
+                                              t8_locidx_t ltree2, int face1,
+                                              int face2, int orientation);
+
+/** Store an attribute at a tree of a direct build.
+ * The payload is copied straight into the preallocated trees structure,
+ * \see t8_cmesh_set_direct_build. The attributes of a tree must be
+ * inserted consecutively in ascending order of their tree id and, per
+ * tree, of their (package id, key) pair; each tree must receive exactly
+ * the number of attributes and total bytes declared upfront.
+ * \param [in,out] cmesh        The cmesh. A direct build must have been
+ *                              started with \ref t8_cmesh_set_direct_build.
+ * \param [in]     ltree_id     The tree id of the tree.
+ * \param [in]     package_id   Unique identifier of a valid software package. \see sc_package_register
+ * \param [in]     key          An integer key used to identify this attribute under all
+ *                              attributes with the same package_id.
+ * \param [in]     data         A pointer to the attribute data. The data is copied.
+ * \param [in]     data_size    The number of bytes of the attribute.
+ */
+void                t8_cmesh_direct_set_attribute (t8_cmesh_t cmesh,
+                                                   t8_locidx_t ltree_id,
+                                                   int package_id, int key,
+                                                   const void *data,
+                                                   size_t data_size);
+
 /** Enable or disable profiling for a cmesh. If profiling is enabled, runtimes
  * and statistics are collected during cmesh_commit.
  * \param [in,out] cmesh        The cmesh to be updated.
@@ -404,6 +536,32 @@ int                 t8_cmesh_save (t8_cmesh_t cmesh, const char *fileprefix);
 /* TODO: Document */
 t8_cmesh_t          t8_cmesh_load (const char *filename, sc_MPI_Comm comm);
 
+/** Save a cmesh in the binary file format.
+ * In contrast to \ref t8_cmesh_save the trees, their face neighbors and
+ * attributes are written in their in-memory layout, preceded by a header
+ * of offsets, so that \ref t8_cmesh_load_binary can map the file instead
+ * of parsing it.
+ * Currently, it is only legal to save cmeshes that use the linear geometry.
+ * \param [in] cmesh      A committed cmesh.
+ * \param [in] fileprefix The saved file will be fileprefix_RANK.bcmesh.
+ * \return                True on success, false if an error occurred.
+ */
+int                 t8_cmesh_save_binary (t8_cmesh_t cmesh,
+                                          const char *fileprefix);
+
+/** Load a cmesh from a binary file that was written with
+ * \ref t8_cmesh_save_binary.
+ * If possible the tree data is mapped into memory via mmap, such that
+ * trees and attributes are paged in on demand and loading does not read
+ * the whole file upfront. Otherwise the data is read with a single read.
+ * \param [in] filename   The file to load.
+ * \param [in] comm       The MPI communicator to use.
+ * \return                A committed cmesh on success, NULL if an error
+ *                        occurred.
+ */
+t8_cmesh_t          t8_cmesh_load_binary (const char *filename,
+                                          sc_MPI_Comm comm);
+
 /* TODO: Document */
 /* procs_per_node is only relevant in mode==JUQUEEN.
  *  num_files = 1 => replicated cmesh is constructed */
@@ -615,6 +773,33 @@ t8_locidx_t         t8_cmesh_get_face_neighbor (const t8_cmesh_t cmesh,
                                                 int *dual_face,
                                                 int *orientation);
 
+/** Build the flat face neighbor table of a committed cmesh.
+ * The table stores (neighbor, dual face, orientation) for every face of
+ * every local tree and ghost in flat arrays, so that
+ * \ref t8_cmesh_get_face_neighbor answers from two loads instead of
+ * decoding the per tree neighbor records on every query.
+ * It is built automatically at the end of \ref t8_cmesh_commit; this
+ * function only has an effect on cmeshes that were committed by other
+ * means. Calling it again is a no-op.
+ * \param [in,out]  cmesh     The cmesh. Must be committed.
+ */
+void                t8_cmesh_build_face_table (t8_cmesh_t cmesh);
+
+/** Index a fixed (package, key) attribute of a committed cmesh.
+ * The table stores for every local tree a direct pointer to the payload
+ * of that attribute, so that \ref t8_cmesh_get_attribute answers the
+ * indexed pair with a single load instead of searching the per tree
+ * attribute info records. \ref t8_cmesh_commit indexes the tree
+ * vertices, which the geometry code queries once per element; calling
+ * this function with a different pair replaces the table.
+ * Calling it again with the indexed pair is a no-op.
+ * \param [in,out]  cmesh       The cmesh. Must be committed.
+ * \param [in]      package_id  The package identifier of the attribute to index.
+ * \param [in]      key         The key of the attribute to index.
+ */
+void                t8_cmesh_build_attribute_table (t8_cmesh_t cmesh,
+                                                    int package_id, int key);
+
 /** Print the collected statistics from a cmesh profile.
  * \param [in]    cmesh         The cmesh.
  *
@@ -623,6 +808,32 @@ t8_locidx_t         t8_cmesh_get_face_neighbor (const t8_cmesh_t cmesh,
  */
 void                t8_cmesh_print_profile (t8_cmesh_t cmesh);
 
+/** Memory usage of a committed cmesh, split by component.
+ * \see t8_cmesh_get_memory_footprint */
+typedef struct t8_cmesh_mem_footprint
+{
+  size_t              trees_bytes; /**< The tree parts, holding the tree and
+                                        ghost records, their face connectivity
+                                        and the attribute payloads.
+                                        \see t8_cmesh_trees_size */
+  size_t              offsets_bytes; /**< The partition offset shared memory
+                                         array, if constructed. */
+  size_t              struct_bytes; /**< The cmesh struct itself. */
+  size_t              total_bytes; /**< The sum of all components. */
+} t8_cmesh_mem_footprint_t;
+
+/** Compute the number of bytes of heap memory that a committed cmesh
+ * occupies on this process, split by component.
+ * The offset array lives in MPI shared memory and is counted with its full
+ * length, even though it exists only once per compute node.
+ * \param [in]  cmesh     The cmesh. Must be committed.
+ * \param [out] footprint The byte counts are stored here.
+ * \see t8_forest_get_memory_footprint
+ */
+void                t8_cmesh_get_memory_footprint (t8_cmesh_t cmesh,
+                                                   t8_cmesh_mem_footprint_t
+                                                   *footprint);
+
 /** Return a pointer to the vertex coordinates of a tree.
  * \param [in]    cmesh         The cmesh.
  * \param [in]    ltreeid       The id of a local tree.
@@ -632,6 +843,25 @@ void                t8_cmesh_print_profile (t8_cmesh_t cmesh);
 double             *t8_cmesh_get_tree_vertices (t8_cmesh_t cmesh,
                                                 t8_locidx_t ltreeid);
 
+/** Return the vertex coordinate pointers of a range of local trees.
+ * The range version of \ref t8_cmesh_get_tree_vertices, resolving the
+ * whole range in a single walk over the tree storage instead of one
+ * part lookup and attribute search per tree.
+ * \param [in]    cmesh         The cmesh.
+ * \param [in]    first_ltree   The first local tree of the range.
+ * \param [in]    num_trees     The number of trees in the range.
+ * \param [out]   vertices      An array of \a num_trees entries provided
+ *                              by the caller. On output entry i points to
+ *                              the vertex coordinates of tree
+ *                              \a first_ltree + i, or is NULL if no
+ *                              coordinates are stored for that tree.
+ * \a cmesh must be committed before calling this function.
+ */
+void                t8_cmesh_get_tree_vertices_range (t8_cmesh_t cmesh,
+                                                      t8_locidx_t first_ltree,
+                                                      t8_locidx_t num_trees,
+                                                      double **vertices);
+
 /** Return the attribute pointer of a tree.
  * \param [in]     cmesh        The cmesh.
  * \param [in]     package_id   The identifier of a valid software package. \see sc_package_register
@@ -647,6 +877,45 @@ void               *t8_cmesh_get_attribute (t8_cmesh_t cmesh,
                                             int package_id, int key,
                                             t8_locidx_t ltree_id);
 
+/** Return the same attribute of each tree in a range of local trees.
+ * The range version of \ref t8_cmesh_get_attribute. The attribute of
+ * every tree in the range is resolved in one walk over the tree storage,
+ * amortizing the per tree part lookup and attribute search; lazy
+ * attribute payloads of the range are materialized in bulk up front.
+ * \param [in]     cmesh        The cmesh.
+ * \param [in]     package_id   The identifier of a valid software package. \see sc_package_register
+ * \param [in]     key          A key used to identify the attribute under all
+ *                              attributes of a tree with the same \a package_id.
+ * \param [in]     first_ltree  The first local tree of the range.
+ * \param [in]     num_trees    The number of trees in the range.
+ * \param [out]    attributes   An array of \a num_trees entries provided by
+ *                              the caller. On output entry i points to the
+ *                              attribute of tree \a first_ltree + i, or is
+ *                              NULL if that tree does not store the attribute.
+ * In contrast to \ref t8_cmesh_get_attribute the range may not contain
+ * ghost trees.
+ * \a cmesh must be committed before calling this function.
+ * \see t8_cmesh_get_tree_vertices_range
+ */
+void                t8_cmesh_get_attribute_range (t8_cmesh_t cmesh,
+                                                  int package_id, int key,
+                                                  t8_locidx_t first_ltree,
+                                                  t8_locidx_t num_trees,
+                                                  void **attributes);
+
+/** Materialize the attribute payloads of a range of local trees in bulk.
+ * Only has an effect if the cmesh was committed with lazy attributes
+ * (\ref t8_cmesh_set_lazy_attributes); it then copies the payloads of all
+ * trees in the range that were not accessed yet, so that later accesses
+ * do not fault them in one tree at a time.
+ * \param [in,out]  cmesh       The cmesh. Must be committed.
+ * \param [in]      first_ltree The first local tree of the range.
+ * \param [in]      num_trees   The number of trees in the range.
+ */
+void                t8_cmesh_prefetch_attributes (t8_cmesh_t cmesh,
+                                                  t8_locidx_t first_ltree,
+                                                  t8_locidx_t num_trees);
+
 /** Return the shared memory array storing the partition table of
  * a partitioned cmesh.
  * \param [in]      cmesh       The cmesh.
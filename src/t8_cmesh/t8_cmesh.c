@@ -372,6 +372,8 @@ t8_cmesh_set_attribute (t8_cmesh_t cmesh, t8_gloidx_t gtree_id,
   T8_ASSERT (cmesh != NULL);
   T8_ASSERT (!cmesh->committed);
 
+  T8_ASSERT (!cmesh->direct_build);
+
   t8_stash_add_attribute (cmesh->stash, gtree_id, package_id, key, data_size,
                           data, !data_persists);
 }
@@ -390,6 +392,102 @@ t8_cmesh_set_attribute_string (t8_cmesh_t cmesh, t8_gloidx_t gtree_id,
                           size, 0);
 }
 
+void
+t8_cmesh_set_lazy_attributes (t8_cmesh_t cmesh)
+{
+  T8_ASSERT (t8_cmesh_is_initialized (cmesh));
+  T8_ASSERT (!cmesh->committed);
+
+  cmesh->set_lazy_attributes = 1;
+}
+
+void
+t8_cmesh_set_shared_node_memory (t8_cmesh_t cmesh, int set_node_shared)
+{
+  T8_ASSERT (t8_cmesh_is_initialized (cmesh));
+  T8_ASSERT (!cmesh->committed);
+
+  cmesh->set_node_shared = set_node_shared;
+}
+
+void
+t8_cmesh_set_reorder_trees (t8_cmesh_t cmesh, int set_reorder_trees)
+{
+  T8_ASSERT (t8_cmesh_is_initialized (cmesh));
+  T8_ASSERT (!cmesh->committed);
+
+  cmesh->set_reorder_trees = set_reorder_trees;
+}
+
+/* Copy the attribute payloads of one local tree from the stash into the
+ * trees structure. Only called for cmeshes with lazy attributes, for which
+ * the stash is kept alive after commit. */
+static void
+t8_cmesh_materialize_tree_attributes (t8_cmesh_t cmesh, t8_locidx_t ltree_id)
+{
+  t8_stash_attribute_struct_t *attr;
+  sc_array_t         *attributes;
+  t8_gloidx_t         gtree_id;
+  size_t              low, high, guess, index;
+
+  T8_ASSERT (cmesh->lazy_attr_resident != NULL);
+  T8_ASSERT (cmesh->stash != NULL);
+  T8_ASSERT (0 <= ltree_id && ltree_id < cmesh->num_local_trees);
+  T8_ASSERT (!cmesh->lazy_attr_resident[ltree_id]);
+
+  attributes = &cmesh->stash->attributes;
+  gtree_id = cmesh->first_tree + ltree_id;
+  /* Find the first stash entry of this tree. The stash attributes were
+   * sorted by tree id during commit and the entries of one tree are
+   * consecutive. */
+  low = 0;
+  high = attributes->elem_count;
+  while (low < high) {
+    guess = (low + high) / 2;
+    attr = (t8_stash_attribute_struct_t *) sc_array_index (attributes,
+                                                           guess);
+    if (attr->id < gtree_id) {
+      low = guess + 1;
+    }
+    else {
+      high = guess;
+    }
+  }
+  /* Copy the payloads of all attributes of this tree. The index within the
+   * tree's attribute block equals the position within the run of stash
+   * entries, matching the order in which the attribute infos were set up
+   * at commit. */
+  for (index = 0; low < attributes->elem_count; low++, index++) {
+    attr = (t8_stash_attribute_struct_t *) sc_array_index (attributes, low);
+    if (attr->id != gtree_id) {
+      break;
+    }
+    t8_cmesh_trees_copy_attribute_data (cmesh->trees, 0, attr, ltree_id,
+                                        index);
+  }
+  cmesh->lazy_attr_resident[ltree_id] = 1;
+}
+
+void
+t8_cmesh_prefetch_attributes (t8_cmesh_t cmesh, t8_locidx_t first_ltree,
+                              t8_locidx_t num_trees)
+{
+  t8_locidx_t         itree;
+
+  T8_ASSERT (t8_cmesh_is_committed (cmesh));
+  if (cmesh->lazy_attr_resident == NULL) {
+    /* The attributes are not lazy, nothing to materialize */
+    return;
+  }
+  T8_ASSERT (0 <= first_ltree
+             && first_ltree + num_trees <= cmesh->num_local_trees);
+  for (itree = first_ltree; itree < first_ltree + num_trees; itree++) {
+    if (!cmesh->lazy_attr_resident[itree]) {
+      t8_cmesh_materialize_tree_attributes (cmesh, itree);
+    }
+  }
+}
+
 double             *
 t8_cmesh_get_tree_vertices (t8_cmesh_t cmesh, t8_locidx_t ltreeid)
 {
@@ -415,10 +513,59 @@ t8_cmesh_get_attribute (t8_cmesh_t cmesh, int package_id, int key,
   if (is_ghost) {
     ltree_id = t8_cmesh_ltreeid_to_ghostid (cmesh, ltree_id);
   }
+  else if (cmesh->lazy_attr_resident != NULL
+           && !cmesh->lazy_attr_resident[ltree_id]) {
+    /* The attributes are lazy and this tree's payloads were not yet
+     * copied from the stash. Fault them in now. */
+    t8_cmesh_materialize_tree_attributes (cmesh, ltree_id);
+  }
+  if (!is_ghost && cmesh->attr_table != NULL
+      && package_id == cmesh->attr_table_package_id
+      && key == cmesh->attr_table_key) {
+    /* The attribute is indexed, answer with a single load. */
+    return cmesh->attr_table[ltree_id];
+  }
   return t8_cmesh_trees_get_attribute (cmesh->trees, ltree_id, package_id,
                                        key, NULL, is_ghost);
 }
 
+void
+t8_cmesh_get_attribute_range (t8_cmesh_t cmesh, int package_id, int key,
+                              t8_locidx_t first_ltree, t8_locidx_t num_trees,
+                              void **attributes)
+{
+  T8_ASSERT (cmesh->committed);
+  T8_ASSERT (num_trees >= 0);
+  T8_ASSERT (num_trees == 0
+             || (t8_cmesh_treeid_is_local_tree (cmesh, first_ltree)
+                 && t8_cmesh_treeid_is_local_tree (cmesh,
+                                                   first_ltree + num_trees -
+                                                   1)));
+
+  /* Fault in all lazy payloads of the range at once */
+  t8_cmesh_prefetch_attributes (cmesh, first_ltree, num_trees);
+  if (cmesh->attr_table != NULL && package_id == cmesh->attr_table_package_id
+      && key == cmesh->attr_table_key) {
+    /* The attribute is indexed; the answer is a slice of the table. */
+    memcpy (attributes, cmesh->attr_table + first_ltree,
+            num_trees * sizeof (void *));
+    return;
+  }
+  t8_cmesh_trees_get_attribute_range (cmesh->trees, first_ltree, num_trees,
+                                      package_id, key, attributes);
+}
+
+void
+t8_cmesh_get_tree_vertices_range (t8_cmesh_t cmesh, t8_locidx_t first_ltree,
+                                  t8_locidx_t num_trees, double **vertices)
+{
+  T8_ASSERT (t8_cmesh_is_committed (cmesh));
+
+  t8_cmesh_get_attribute_range (cmesh, t8_get_package_id (),
+                                T8_CMESH_VERTICES_ATTRIBUTE_KEY, first_ltree,
+                                num_trees, (void **) vertices);
+}
+
 t8_shmem_array_t
 t8_cmesh_get_partition_table (t8_cmesh_t cmesh)
 {
@@ -447,6 +594,7 @@ t8_cmesh_set_tree_class (t8_cmesh_t cmesh, t8_gloidx_t gtree_id,
 {
   T8_ASSERT (t8_cmesh_is_initialized (cmesh));
   T8_ASSERT (gtree_id >= 0);
+  T8_ASSERT (!cmesh->direct_build);
 
   /* If we insert the first tree, set the dimension of the cmesh
    * to this tree's dimension. Otherwise check whether the dimension
@@ -590,11 +738,139 @@ t8_cmesh_set_join (t8_cmesh_t cmesh, t8_gloidx_t gtree1, t8_gloidx_t gtree2,
                    int face1, int face2, int orientation)
 {
   T8_ASSERT (0 <= orientation);
+  T8_ASSERT (!cmesh->direct_build);
 
   t8_stash_add_facejoin (cmesh->stash, gtree1, gtree2, face1, face2,
                          orientation);
 }
 
+void
+t8_cmesh_set_direct_build (t8_cmesh_t cmesh, t8_locidx_t num_trees,
+                           const t8_eclass_t *tree_classes,
+                           const size_t *num_attributes,
+                           const size_t *attr_bytes)
+{
+  t8_locidx_t         itree;
+
+  T8_ASSERT (t8_cmesh_is_initialized (cmesh));
+  T8_ASSERT (!cmesh->committed);
+  T8_ASSERT (num_trees > 0);
+  T8_ASSERT (tree_classes != NULL);
+  T8_ASSERT ((num_attributes == NULL) == (attr_bytes == NULL));
+  /* The stash setters must not have been used before and a direct build
+   * cannot be combined with a derived cmesh. */
+  T8_ASSERT (cmesh->stash->classes.elem_count == 0);
+  T8_ASSERT (cmesh->stash->joinfaces.elem_count == 0);
+  T8_ASSERT (cmesh->stash->attributes.elem_count == 0);
+  T8_ASSERT (cmesh->set_from == NULL);
+  T8_ASSERT (cmesh->trees == NULL);
+
+  cmesh->dimension = t8_eclass_to_dimension[tree_classes[0]];
+
+  /* Allocate the trees structure in its final layout. This mirrors the
+   * replicated commit from a stash, except that the classes and
+   * attribute extents come from the caller's arrays instead of the
+   * sorted stash entries. */
+  t8_cmesh_trees_init (&cmesh->trees, 1, num_trees, 0);
+  t8_cmesh_trees_start_part (cmesh->trees, 0, 0, num_trees, 0, 0, 1);
+  for (itree = 0; itree < num_trees; itree++) {
+    T8_ASSERT (t8_eclass_to_dimension[tree_classes[itree]]
+               == cmesh->dimension);
+    t8_cmesh_trees_add_tree (cmesh->trees, itree, 0, tree_classes[itree]);
+    cmesh->num_trees_per_eclass[tree_classes[itree]]++;
+    cmesh->num_local_trees_per_eclass[tree_classes[itree]]++;
+    if (num_attributes != NULL) {
+      t8_cmesh_trees_init_attributes (cmesh->trees, itree,
+                                      num_attributes[itree],
+                                      attr_bytes[itree]);
+    }
+  }
+  (void) t8_cmesh_trees_finish_part (cmesh->trees, 0);
+  cmesh->num_trees = cmesh->num_local_trees = num_trees;
+  cmesh->first_tree = 0;
+  cmesh->first_tree_shared = 0;
+  /* Every face is a boundary face until a connection is inserted */
+  t8_cmesh_trees_set_all_boundary (cmesh, cmesh->trees);
+
+  cmesh->direct_build = 1;
+  cmesh->direct_attr_tree = 0;
+  cmesh->direct_attr_index = 0;
+#ifdef T8_ENABLE_DEBUG
+  cmesh->inserted_trees = num_trees;
+#endif
+}
+
+void
+t8_cmesh_direct_set_join (t8_cmesh_t cmesh, t8_locidx_t ltree1,
+                          t8_locidx_t ltree2, int face1, int face2,
+                          int orientation)
+{
+  t8_locidx_t        *face_neigh, *face_neigh2;
+  int8_t             *ttf, *ttf2;
+
+  T8_ASSERT (cmesh->direct_build);
+  T8_ASSERT (!cmesh->committed);
+  T8_ASSERT (0 <= ltree1 && ltree1 < cmesh->num_local_trees);
+  T8_ASSERT (0 <= ltree2 && ltree2 < cmesh->num_local_trees);
+  T8_ASSERT (0 <= orientation);
+  T8_ASSERT (0 <= face1 && face1 < t8_eclass_num_faces
+             [t8_cmesh_trees_get_tree (cmesh->trees, ltree1)->eclass]);
+  T8_ASSERT (0 <= face2 && face2 < t8_eclass_num_faces
+             [t8_cmesh_trees_get_tree (cmesh->trees, ltree2)->eclass]);
+
+  (void) t8_cmesh_trees_get_tree_ext (cmesh->trees, ltree1, &face_neigh,
+                                      &ttf);
+  (void) t8_cmesh_trees_get_tree_ext (cmesh->trees, ltree2, &face_neigh2,
+                                      &ttf2);
+  face_neigh[face1] = ltree2;
+  ttf[face1] = t8_cmesh_tree_to_face_encode (cmesh->dimension,
+                                             (t8_locidx_t) face2,
+                                             orientation);
+  face_neigh2[face2] = ltree1;
+  ttf2[face2] = t8_cmesh_tree_to_face_encode (cmesh->dimension,
+                                              (t8_locidx_t) face1,
+                                              orientation);
+}
+
+void
+t8_cmesh_direct_set_attribute (t8_cmesh_t cmesh, t8_locidx_t ltree_id,
+                               int package_id, int key, const void *data,
+                               size_t data_size)
+{
+  t8_stash_attribute_struct_t attr;
+
+  T8_ASSERT (cmesh->direct_build);
+  T8_ASSERT (!cmesh->committed);
+  T8_ASSERT (0 <= ltree_id && ltree_id < cmesh->num_local_trees);
+  T8_ASSERT (data != NULL || data_size == 0);
+
+  if (ltree_id != cmesh->direct_attr_tree) {
+    /* Enter a new tree. The offset chaining of
+     * t8_cmesh_trees_add_attribute requires the ascending insertion
+     * order and that the previous tree received all of its declared
+     * attributes. */
+    T8_ASSERT (ltree_id > cmesh->direct_attr_tree);
+    T8_ASSERT (cmesh->direct_attr_index == (size_t)
+               t8_cmesh_trees_get_tree (cmesh->trees,
+                                        cmesh->direct_attr_tree)->
+               num_attributes);
+    cmesh->direct_attr_tree = ltree_id;
+    cmesh->direct_attr_index = 0;
+  }
+  T8_ASSERT (cmesh->direct_attr_index < (size_t)
+             t8_cmesh_trees_get_tree (cmesh->trees,
+                                      ltree_id)->num_attributes);
+
+  attr.id = ltree_id;
+  attr.attr_size = data_size;
+  attr.attr_data = (void *) data;
+  attr.is_owned = 0;
+  attr.package_id = package_id;
+  attr.key = key;
+  t8_cmesh_trees_add_attribute (cmesh->trees, 0, &attr, ltree_id,
+                                cmesh->direct_attr_index++);
+}
+
 /* Allocate a cmesh profile if not yet present and set default
  * values. */
 static void
@@ -1121,6 +1397,27 @@ t8_cmesh_get_face_neighbor (const t8_cmesh_t cmesh, const t8_locidx_t ltreeid,
   t8_locidx_t         face_neigh;
   int                 dual_face_temp, orientation_temp;
 
+  if (cmesh->face_neigh_table != NULL) {
+    /* The flat face table was built at commit; the whole query is two
+     * loads instead of decoding the per tree neighbor records. */
+    const t8_locidx_t   face_index =
+      cmesh->face_neigh_offsets[ltreeid] + face;
+
+    T8_ASSERT (face_index < cmesh->face_neigh_offsets[ltreeid + 1]);
+    face_neigh = cmesh->face_neigh_table[face_index];
+    if (face_neigh < 0) {
+      /* A domain boundary or a neighbor that is neither local nor ghost */
+      return -1;
+    }
+    if (dual_face != NULL) {
+      *dual_face = cmesh->face_neigh_dual[face_index];
+    }
+    if (orientation != NULL) {
+      *orientation = cmesh->face_neigh_orient[face_index];
+    }
+    return face_neigh;
+  }
+
   /* If this is a domain boundary, return -1 */
   if (t8_cmesh_tree_face_is_boundary (cmesh, ltreeid, face)) {
     return -1;
@@ -1184,6 +1481,98 @@ t8_cmesh_get_face_neighbor (const t8_cmesh_t cmesh, const t8_locidx_t ltreeid,
   return face_neigh;
 }
 
+void
+t8_cmesh_build_face_table (t8_cmesh_t cmesh)
+{
+  t8_locidx_t        *offsets, *neighbors;
+  int8_t             *duals, *orients;
+  t8_locidx_t         num_local_trees, num_entries, num_faces;
+  t8_locidx_t         ientry, face_index;
+  t8_eclass_t         eclass;
+  int                 iface;
+  int                 dual_face, orientation;
+
+  T8_ASSERT (t8_cmesh_is_committed (cmesh));
+  if (cmesh->face_neigh_table != NULL) {
+    /* The table was already built */
+    return;
+  }
+
+  num_local_trees = cmesh->num_local_trees;
+  num_entries = num_local_trees + cmesh->num_ghosts;
+  /* The faces of each tree and ghost occupy a contiguous range whose
+   * length follows the eclass, so mixed meshes waste no slots. */
+  offsets = T8_ALLOC (t8_locidx_t, num_entries + 1);
+  offsets[0] = 0;
+  for (ientry = 0; ientry < num_entries; ientry++) {
+    eclass = ientry < num_local_trees ?
+      t8_cmesh_get_tree_class (cmesh, ientry) :
+      t8_cmesh_get_ghost_class (cmesh, ientry - num_local_trees);
+    offsets[ientry + 1] = offsets[ientry] + t8_eclass_num_faces[eclass];
+  }
+  neighbors = T8_ALLOC (t8_locidx_t, offsets[num_entries]);
+  duals = T8_ALLOC (int8_t, offsets[num_entries]);
+  orients = T8_ALLOC (int8_t, offsets[num_entries]);
+  for (ientry = 0; ientry < num_entries; ientry++) {
+    num_faces = offsets[ientry + 1] - offsets[ientry];
+    for (iface = 0; iface < num_faces; iface++) {
+      face_index = offsets[ientry] + iface;
+      /* This decodes the per tree neighbor records for the last time;
+       * cmesh->face_neigh_table is still NULL here, so the query takes
+       * the record based path. */
+      neighbors[face_index] =
+        t8_cmesh_get_face_neighbor (cmesh, ientry, iface, &dual_face,
+                                    &orientation);
+      if (neighbors[face_index] >= 0) {
+        duals[face_index] = (int8_t) dual_face;
+        orients[face_index] = (int8_t) orientation;
+      }
+      else {
+        duals[face_index] = -1;
+        orients[face_index] = -1;
+      }
+    }
+  }
+  /* Publish the table only now that it is completely filled, since a
+   * non NULL table activates the fast path of the query. */
+  cmesh->face_neigh_offsets = offsets;
+  cmesh->face_neigh_dual = duals;
+  cmesh->face_neigh_orient = orients;
+  cmesh->face_neigh_table = neighbors;
+}
+
+void
+t8_cmesh_build_attribute_table (t8_cmesh_t cmesh, int package_id, int key)
+{
+  void              **table;
+  t8_locidx_t         itree;
+
+  T8_ASSERT (t8_cmesh_is_committed (cmesh));
+  if (cmesh->attr_table != NULL) {
+    if (cmesh->attr_table_package_id == package_id
+        && cmesh->attr_table_key == key) {
+      /* The table was already built for this attribute */
+      return;
+    }
+    /* A different attribute was indexed before, replace its table. */
+    T8_FREE (cmesh->attr_table);
+    cmesh->attr_table = NULL;
+  }
+  table = T8_ALLOC (void *, cmesh->num_local_trees);
+  for (itree = 0; itree < cmesh->num_local_trees; itree++) {
+    /* This searches the per tree info records for the last time. Trees
+     * that do not carry the attribute keep a NULL entry. With lazy
+     * attributes the payload pointer is valid even before the payload
+     * is copied, since the extents are recorded at commit. */
+    table[itree] =
+      t8_cmesh_trees_get_attribute (cmesh->trees, itree, package_id, key,
+                                    NULL, 0);
+  }
+  cmesh->attr_table = table;
+  cmesh->attr_table_package_id = package_id;
+  cmesh->attr_table_key = key;
+}
+
 void
 t8_cmesh_print_profile (t8_cmesh_t cmesh)
 {
@@ -1226,6 +1615,25 @@ t8_cmesh_print_profile (t8_cmesh_t cmesh)
   }
 }
 
+void
+t8_cmesh_get_memory_footprint (t8_cmesh_t cmesh,
+                               t8_cmesh_mem_footprint_t *footprint)
+{
+  T8_ASSERT (t8_cmesh_is_committed (cmesh));
+  T8_ASSERT (footprint != NULL);
+
+  footprint->trees_bytes = t8_cmesh_trees_size (cmesh->trees);
+  footprint->offsets_bytes = 0;
+  if (cmesh->tree_offsets != NULL) {
+    footprint->offsets_bytes +=
+      t8_shmem_array_get_elem_count (cmesh->tree_offsets)
+      * t8_shmem_array_get_elem_size (cmesh->tree_offsets);
+  }
+  footprint->struct_bytes = sizeof (t8_cmesh_struct_t);
+  footprint->total_bytes = footprint->trees_bytes
+    + footprint->offsets_bytes + footprint->struct_bytes;
+}
+
 static void
 t8_cmesh_reset (t8_cmesh_t *pcmesh)
 {
@@ -1260,8 +1668,15 @@ t8_cmesh_reset (t8_cmesh_t *pcmesh)
     if (cmesh->trees != NULL) {
       t8_cmesh_trees_destroy (&cmesh->trees);
     }
+    if (cmesh->stash != NULL) {
+      /* With lazy attributes the stash was kept alive after commit */
+      t8_stash_destroy (&cmesh->stash);
+    }
     T8_ASSERT (cmesh->set_from == NULL);
   }
+  if (cmesh->lazy_attr_resident != NULL) {
+    T8_FREE (cmesh->lazy_attr_resident);
+  }
   if (cmesh->profile != NULL) {
     T8_FREE (cmesh->profile);
   }
@@ -1281,6 +1696,20 @@ t8_cmesh_reset (t8_cmesh_t *pcmesh)
     t8_geom_handler_unref (&cmesh->geometry_handler);
   }
 
+  /* Free the flat face neighbor table */
+  T8_FREE (cmesh->face_neigh_offsets);
+  T8_FREE (cmesh->face_neigh_table);
+  T8_FREE (cmesh->face_neigh_dual);
+  T8_FREE (cmesh->face_neigh_orient);
+
+  /* Free the attribute pointer table */
+  T8_FREE (cmesh->attr_table);
+
+  /* Free the cached uniform bounds */
+  if (cmesh->uniform_bounds_cache != NULL) {
+    sc_array_destroy (cmesh->uniform_bounds_cache);
+  }
+
   T8_FREE (cmesh);
   *pcmesh = NULL;
 }
@@ -36,6 +36,10 @@
 #include <t8_cmesh/t8_cmesh_refine.h>
 #include <t8_cmesh/t8_cmesh_copy.h>
 #include <t8_cmesh/t8_cmesh_geometry.h>
+#if T8_ENABLE_OPENMP
+#include <omp.h>
+#include <t8_thread_pool.h>
+#endif
 
 typedef struct ghost_facejoins_struct
 {
@@ -91,6 +95,14 @@ t8_cmesh_add_attributes (t8_cmesh_t cmesh, sc_hash_t * ghost_ids,
   t8_locidx_t         ltree;
   size_t              si, sj;
   t8_ghost_facejoin_t *temp_facejoin, **facejoin_pp;    /* used to lookup global ghost ids in the hash */
+#if T8_ENABLE_OPENMP
+  size_t             *tree_attr_index;
+
+  /* Record for each stash entry that belongs to a local tree its index
+   * in the tree's attribute array, so that the payload copies below can
+   * be carried out by threads. (size_t) -1 marks the other entries. */
+  tree_attr_index = T8_ALLOC (size_t, stash->attributes.elem_count);
+#endif
 
   temp_facejoin = T8_ALLOC_ZERO (t8_ghost_facejoin_t, 1);
 
@@ -109,10 +121,35 @@ t8_cmesh_add_attributes (t8_cmesh_t cmesh, sc_hash_t * ghost_ids,
        * Should not cause problems, since mesh is replicated */
       T8_ASSERT (attribute->id - cmesh->first_tree ==
                  (t8_locidx_t) attribute->id - cmesh->first_tree);
-      t8_cmesh_trees_add_attribute (cmesh->trees, 0, attribute,
-                                    attribute->id - cmesh->first_tree, sj);
+      if (cmesh->set_lazy_attributes) {
+        /* Lazy attributes: we only record the extents here. The payload
+         * is copied from the stash on the tree's first attribute access. */
+        t8_cmesh_trees_add_attribute_info (cmesh->trees, 0, attribute,
+                                           attribute->id - cmesh->first_tree,
+                                           sj);
+#if T8_ENABLE_OPENMP
+        tree_attr_index[si] = (size_t) -1;
+#endif
+      }
+      else {
+#if T8_ENABLE_OPENMP
+        /* Only chain up the attribute info offsets here. The offsets depend
+         * on each other serially, while the payload copies do not and are
+         * done concurrently after this loop. */
+        t8_cmesh_trees_add_attribute_info (cmesh->trees, 0, attribute,
+                                           attribute->id - cmesh->first_tree,
+                                           sj);
+        tree_attr_index[si] = sj;
+#else
+        t8_cmesh_trees_add_attribute (cmesh->trees, 0, attribute,
+                                      attribute->id - cmesh->first_tree, sj);
+#endif
+      }
     }
     else {
+#if T8_ENABLE_OPENMP
+      tree_attr_index[si] = (size_t) -1;
+#endif
       T8_ASSERT (ghost_ids != NULL);
       temp_facejoin->ghost_id = attribute->id;
       if (sc_hash_lookup (ghost_ids, temp_facejoin, (void ***) &facejoin_pp)) {
@@ -123,7 +160,159 @@ t8_cmesh_add_attributes (t8_cmesh_t cmesh, sc_hash_t * ghost_ids,
       }
     }
   }
+#if T8_ENABLE_OPENMP
+  /* All attribute infos are set up, copy the tree attribute payloads with
+   * threads. Each entry writes to a disjoint byte range of the part. The
+   * thread count is clamped to the process-wide limit of
+   * t8_thread_pool_set_num_threads. */
+#pragma omp parallel for schedule (static) \
+  num_threads (t8_thread_pool_clamp_num_threads (omp_get_max_threads ()))
+  for (si = 0; si < stash->attributes.elem_count; si++) {
+    if (tree_attr_index[si] != (size_t) -1) {
+      t8_stash_attribute_struct_t *tree_attribute =
+        (t8_stash_attribute_struct_t *)
+        sc_array_index (&stash->attributes, si);
+      t8_cmesh_trees_copy_attribute_data (cmesh->trees, 0, tree_attribute,
+                                          tree_attribute->id -
+                                          cmesh->first_tree,
+                                          tree_attr_index[si]);
+    }
+  }
+  T8_FREE (tree_attr_index);
+#endif
   T8_FREE (temp_facejoin);
+
+  if (cmesh->set_lazy_attributes) {
+    /* Track per tree whether its payloads were materialized yet */
+    T8_ASSERT (cmesh->lazy_attr_resident == NULL);
+    cmesh->lazy_attr_resident =
+      T8_ALLOC_ZERO (int8_t, cmesh->num_local_trees);
+  }
+}
+
+/* Renumber the trees of a stash along a breadth-first traversal of the
+ * face-neighbor graph, so that face-neighboring trees get nearby ids.
+ * We build the adjacency of the trees from the joinfaces, assign new ids
+ * in breadth-first visit order (restarting at the smallest unvisited id
+ * for each connected component) and relabel the class, joinface and
+ * attribute entries of the stash in place. The commit then builds the
+ * trees structure in the new order without further changes, since it
+ * reads all tree ids from the stash.
+ * Only valid for a replicated stash whose tree ids are exactly
+ * 0, ..., num_trees - 1. */
+static void
+t8_cmesh_reorder_stash (t8_cmesh_t cmesh)
+{
+  t8_stash_t          stash = cmesh->stash;
+  t8_stash_class_struct_t *entry;
+  t8_stash_joinface_struct_t *joinface;
+  t8_stash_attribute_struct_t *attribute;
+  t8_locidx_t        *new_id, *queue, *neigh_offset, *neigh_fill, *neighbors;
+  t8_locidx_t         num_trees, itree, ineigh, next_id;
+  t8_locidx_t         queue_begin, queue_end;
+  t8_locidx_t         id1, id2;
+  size_t              si;
+
+  num_trees = (t8_locidx_t) stash->classes.elem_count;
+  if (num_trees <= 1) {
+    return;
+  }
+
+  /* Build the adjacency lists of the face-neighbor graph. Boundary faces
+   * do not appear in the joinfaces and periodic self-joins do not leave
+   * their tree, so both are skipped. */
+  neigh_offset = T8_ALLOC_ZERO (t8_locidx_t, num_trees + 1);
+  for (si = 0; si < stash->joinfaces.elem_count; si++) {
+    joinface = (t8_stash_joinface_struct_t *)
+      sc_array_index (&stash->joinfaces, si);
+    T8_ASSERT (0 <= joinface->id1 && joinface->id1 < num_trees);
+    T8_ASSERT (0 <= joinface->id2 && joinface->id2 < num_trees);
+    if (joinface->id1 != joinface->id2) {
+      neigh_offset[joinface->id1 + 1]++;
+      neigh_offset[joinface->id2 + 1]++;
+    }
+  }
+  for (itree = 0; itree < num_trees; itree++) {
+    neigh_offset[itree + 1] += neigh_offset[itree];
+  }
+  neighbors = T8_ALLOC (t8_locidx_t, neigh_offset[num_trees]);
+  neigh_fill = T8_ALLOC (t8_locidx_t, num_trees);
+  memcpy (neigh_fill, neigh_offset, num_trees * sizeof (t8_locidx_t));
+  for (si = 0; si < stash->joinfaces.elem_count; si++) {
+    joinface = (t8_stash_joinface_struct_t *)
+      sc_array_index (&stash->joinfaces, si);
+    if (joinface->id1 != joinface->id2) {
+      neighbors[neigh_fill[joinface->id1]++] = (t8_locidx_t) joinface->id2;
+      neighbors[neigh_fill[joinface->id2]++] = (t8_locidx_t) joinface->id1;
+    }
+  }
+  T8_FREE (neigh_fill);
+
+  /* Assign the new ids in breadth-first visit order */
+  new_id = T8_ALLOC (t8_locidx_t, num_trees);
+  queue = T8_ALLOC (t8_locidx_t, num_trees);
+  for (itree = 0; itree < num_trees; itree++) {
+    new_id[itree] = -1;
+  }
+  next_id = 0;
+  for (itree = 0; itree < num_trees; itree++) {
+    if (new_id[itree] >= 0) {
+      continue;
+    }
+    /* itree is the smallest unvisited id of its connected component */
+    queue_begin = queue_end = 0;
+    new_id[itree] = next_id++;
+    queue[queue_end++] = itree;
+    while (queue_begin < queue_end) {
+      const t8_locidx_t   current = queue[queue_begin++];
+
+      for (ineigh = neigh_offset[current];
+           ineigh < neigh_offset[current + 1]; ineigh++) {
+        if (new_id[neighbors[ineigh]] < 0) {
+          new_id[neighbors[ineigh]] = next_id++;
+          queue[queue_end++] = neighbors[ineigh];
+        }
+      }
+    }
+  }
+  T8_ASSERT (next_id == num_trees);
+  T8_FREE (queue);
+  T8_FREE (neighbors);
+  T8_FREE (neigh_offset);
+
+  /* Relabel the stash entries. The attributes are sorted by the commit
+   * after this, so their order does not need fixing here. */
+  for (si = 0; si < stash->classes.elem_count; si++) {
+    entry = (t8_stash_class_struct_t *) sc_array_index (&stash->classes, si);
+    T8_ASSERT (0 <= entry->id && entry->id < num_trees);
+    entry->id = new_id[entry->id];
+  }
+  for (si = 0; si < stash->joinfaces.elem_count; si++) {
+    joinface = (t8_stash_joinface_struct_t *)
+      sc_array_index (&stash->joinfaces, si);
+    id1 = new_id[joinface->id1];
+    id2 = new_id[joinface->id2];
+    /* Keep the invariant id1 <= id2 of t8_stash_add_facejoin */
+    if (id1 <= id2) {
+      joinface->id1 = id1;
+      joinface->id2 = id2;
+    }
+    else {
+      const int           face1 = joinface->face1;
+
+      joinface->id1 = id2;
+      joinface->id2 = id1;
+      joinface->face1 = joinface->face2;
+      joinface->face2 = face1;
+    }
+  }
+  for (si = 0; si < stash->attributes.elem_count; si++) {
+    attribute = (t8_stash_attribute_struct_t *)
+      sc_array_index (&stash->attributes, si);
+    T8_ASSERT (0 <= attribute->id && attribute->id < num_trees);
+    attribute->id = new_id[attribute->id];
+  }
+  T8_FREE (new_id);
 }
 
 static void
@@ -142,6 +331,11 @@ t8_cmesh_commit_replicated_new (t8_cmesh_t cmesh)
     t8_stash_class_struct_t *entry;
     t8_locidx_t         num_trees = class_entries->elem_count, ltree;
 
+    if (cmesh->set_reorder_trees) {
+      /* Renumber the trees for face-neighbor locality before the trees
+       * structure is built from the stash */
+      t8_cmesh_reorder_stash (cmesh);
+    }
     t8_cmesh_trees_init (&cmesh->trees, 1, num_trees, 0);
     t8_cmesh_trees_start_part (cmesh->trees, 0, 0, num_trees, 0, 0, 1);
     /* set tree classes */
@@ -724,6 +918,29 @@ t8_cmesh_commit (t8_cmesh_t cmesh, sc_MPI_Comm comm)
       t8_cmesh_commit_refine (cmesh, comm);
     }
   }                             /* End set_from != NULL */
+  else if (cmesh->direct_build) {
+    /* The trees structure was already filled directly by the
+     * application, \see t8_cmesh_set_direct_build. The commit reduces
+     * to a validation pass over the preallocated layout. */
+    T8_ASSERT (!cmesh->set_partition);
+    T8_ASSERT (cmesh->set_refine_level == 0);
+    T8_ASSERT (!cmesh->set_reorder_trees);
+#ifdef T8_ENABLE_DEBUG
+    /* The attribute cursor tree must have received all of its declared
+     * attributes; earlier trees were checked when the cursor advanced. */
+    T8_ASSERT (cmesh->direct_attr_index == (size_t)
+               t8_cmesh_trees_get_tree (cmesh->trees,
+                                        cmesh->direct_attr_tree)->
+               num_attributes);
+    T8_ASSERT (t8_cmesh_trees_is_face_consistend (cmesh, cmesh->trees));
+#endif
+    if (cmesh->geometry_handler == NULL) {
+      t8_geom_handler_init (&cmesh->geometry_handler);
+    }
+    /* The geometry handler was not taken over from another cmesh, so it
+     * must be committed here. */
+    commit_geom_handler = 1;
+  }
   else {
     /* cmesh is constructed from a stash */
     if (cmesh->set_refine_level > 0) {
@@ -781,6 +998,26 @@ t8_cmesh_commit (t8_cmesh_t cmesh, sc_MPI_Comm comm)
   }
   T8_ASSERT (cmesh->set_partition || cmesh->tree_offsets == NULL);
 
+  /* Build the flat face neighbor table, so that later face queries do
+   * not decode the per tree neighbor records. */
+  t8_cmesh_build_face_table (cmesh);
+
+  if (cmesh->set_node_shared && !cmesh->set_partition
+      && cmesh->lazy_attr_resident == NULL) {
+    /* Move the replicated trees and attribute data into a node shared
+     * window, so that it is stored once per compute node. Lazy
+     * attributes are excluded since their payloads are written into the
+     * part data after commit. */
+    t8_cmesh_trees_share_node_memory (cmesh->trees, comm);
+  }
+
+  /* Index the tree vertices attribute, so that the per element vertex
+   * queries of the geometry code skip the info record search. This must
+   * happen after a possible move into node shared memory, since the
+   * table stores direct payload pointers. */
+  t8_cmesh_build_attribute_table (cmesh, t8_get_package_id (),
+                                  T8_CMESH_VERTICES_ATTRIBUTE_KEY);
+
 #if T8_ENABLE_DEBUG
   t8_debugf ("Cmesh is %spartitioned.\n", cmesh->set_partition ? "" : "not ");
   if (cmesh->set_partition) {
@@ -794,9 +1031,11 @@ t8_cmesh_commit (t8_cmesh_t cmesh, sc_MPI_Comm comm)
     t8_cmesh_unref (&cmesh->set_from);
     cmesh->set_from = NULL;
   }
-  if (cmesh->stash != NULL) {
+  if (cmesh->stash != NULL && cmesh->lazy_attr_resident == NULL) {
     t8_stash_destroy (&cmesh->stash);
   }
+  /* With lazy attributes the stash backs the unmaterialized payloads and
+   * is kept until the cmesh is destroyed. */
 
   t8_debugf ("Commited cmesh with %li local and %lli global trees and"
              " %li ghosts.\n", (long) cmesh->num_local_trees,
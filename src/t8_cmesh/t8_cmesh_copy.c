@@ -42,6 +42,13 @@ t8_cmesh_copy (t8_cmesh_t cmesh, t8_cmesh_t cmesh_from, sc_MPI_Comm comm)
   T8_ASSERT (!cmesh->committed);
   T8_ASSERT (t8_cmesh_is_committed (cmesh_from));
 
+  if (cmesh_from->lazy_attr_resident != NULL) {
+    /* The source cmesh has lazy attributes. The copy duplicates the trees
+     * structure byte wise, so all payloads must be resident. */
+    t8_cmesh_prefetch_attributes (cmesh_from, 0,
+                                  cmesh_from->num_local_trees);
+  }
+
   /* Copy all variables */
   cmesh->dimension = cmesh_from->dimension;
   cmesh->face_knowledge = cmesh_from->face_knowledge;
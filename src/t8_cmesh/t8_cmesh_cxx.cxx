@@ -31,66 +31,74 @@
  * TODO: document this file
  */
 
-void
-t8_cmesh_uniform_bounds (t8_cmesh_t cmesh, int level,
-                         t8_scheme_cxx_t *ts,
-                         t8_gloidx_t *first_local_tree,
-                         t8_gloidx_t *child_in_tree_begin,
-                         t8_gloidx_t *last_local_tree,
-                         t8_gloidx_t *child_in_tree_end,
-                         int8_t *first_tree_shared)
+/** A cached result of \ref t8_cmesh_uniform_bounds. The bounds depend
+ * only on the committed cmesh, the scheme and the level, so they are
+ * computed once per (scheme, level) pair and reused for every further
+ * forest construction from the same cmesh. */
+typedef struct t8_cmesh_uniform_bounds_entry
 {
-  int                 is_empty;
+  const t8_scheme_cxx_t *scheme; /**< The scheme the bounds were computed with. */
+  int                 level;    /**< The level of the uniform refinement. */
+  t8_gloidx_t         first_local_tree; /**< The first tree of this process. */
+  t8_gloidx_t         child_in_tree_begin; /**< The first child in the first tree. */
+  t8_gloidx_t         last_local_tree; /**< The last tree of this process. */
+  t8_gloidx_t         child_in_tree_end; /**< One past the last child in the last tree. */
+  int8_t              first_tree_shared; /**< True if the first tree is shared with a smaller rank. */
+} t8_cmesh_uniform_bounds_entry_t;
 
-  T8_ASSERT (cmesh != NULL);
-  T8_ASSERT (cmesh->committed);
-  T8_ASSERT (level >= 0);
-  T8_ASSERT (ts != NULL);
-
-  *first_local_tree = 0;
-  if (child_in_tree_begin != NULL) {
-    *child_in_tree_begin = 0;
-  }
-  *last_local_tree = 0;
-  if (child_in_tree_end != NULL) {
-    *child_in_tree_end = 0;
-  }
+/* Compute the uniform bounds of a cmesh for a given scheme and level
+ * and store them in an entry of the cmesh's bounds cache.
+ * See t8_cmesh_uniform_bounds for the semantics of the fields. */
+static void
+t8_cmesh_uniform_bounds_compute (t8_cmesh_t cmesh, int level,
+                                 t8_scheme_cxx_t *ts,
+                                 t8_cmesh_uniform_bounds_entry_t *entry)
+{
+  int                 is_empty;
 
   t8_gloidx_t         global_num_children;
   t8_gloidx_t         first_global_child;
-  t8_gloidx_t         child_in_tree_begin_temp;
   t8_gloidx_t         last_global_child;
   t8_gloidx_t         children_per_tree = 0;
+  t8_gloidx_t         leafs_per_class[T8_ECLASS_COUNT];
 #ifdef T8_ENABLE_DEBUG
   t8_gloidx_t         prev_last_tree = -1;
 #endif
   int                 tree_class;
+  int                 num_classes;
   t8_eclass_scheme_c *tree_scheme;
 
+  entry->first_local_tree = 0;
+  entry->child_in_tree_begin = 0;
+  entry->last_local_tree = 0;
+  entry->child_in_tree_end = 0;
+  entry->first_tree_shared = 0;
+
   /* Compute the number of children on level in each tree */
   global_num_children = 0;
+  num_classes = 0;
   for (tree_class = T8_ECLASS_ZERO; tree_class < T8_ECLASS_COUNT;
        ++tree_class) {
     /* We iterate over each element class and get the number of children for this
      * tree class.
      */
+    leafs_per_class[tree_class] = 0;
     if (cmesh->num_trees_per_eclass[tree_class] > 0) {
       tree_scheme = ts->eclass_schemes[tree_class];
       T8_ASSERT (tree_scheme != NULL);
       children_per_tree =
         tree_scheme->t8_element_count_leafs_from_root (level);
       T8_ASSERT (children_per_tree >= 0);
+      leafs_per_class[tree_class] = children_per_tree;
       global_num_children +=
         cmesh->num_trees_per_eclass[tree_class] * children_per_tree;
+      num_classes++;
     }
   }
   T8_ASSERT (children_per_tree != 0);
 
   if (cmesh->mpirank == 0) {
     first_global_child = 0;
-    if (child_in_tree_begin != NULL) {
-      *child_in_tree_begin = 0;
-    }
   }
   else {
     /* The first global child of processor p
@@ -116,54 +124,176 @@ t8_cmesh_uniform_bounds (t8_cmesh_t cmesh, int level,
   T8_ASSERT (0 <= last_global_child
              && last_global_child <= global_num_children);
 
-  *first_local_tree = first_global_child / children_per_tree;
-  child_in_tree_begin_temp =
-    first_global_child - *first_local_tree * children_per_tree;
-  if (child_in_tree_begin != NULL) {
-    *child_in_tree_begin = child_in_tree_begin_temp;
+  if (num_classes > 1 && !cmesh->set_partition) {
+    /* Hybrid mesh on a replicated cmesh. The trees do not share a common
+     * child count, so the tree containing a given global child cannot be
+     * computed by a division. Since every process stores all trees, we
+     * locate the first and the last global child in a single scan over
+     * the trees instead. The result is cached by the caller, so the scan
+     * is performed only once per scheme and level. */
+    t8_gloidx_t         itree, cum, tree_children;
+    t8_gloidx_t         first_tree = 0, first_offset = 0;
+    t8_gloidx_t         end_tree = 0, end_offset = 0;
+    int                 found_first = 0, found_end = 0;
+
+    T8_ASSERT ((t8_gloidx_t) cmesh->num_local_trees == cmesh->num_trees);
+    cum = 0;
+    for (itree = 0; itree < cmesh->num_trees && !(found_first && found_end);
+         itree++) {
+      tree_children =
+        leafs_per_class[t8_cmesh_get_tree_class
+                        (cmesh, (t8_locidx_t) itree)];
+      if (!found_first && first_global_child < cum + tree_children) {
+        first_tree = itree;
+        first_offset = first_global_child - cum;
+        found_first = 1;
+      }
+      if (!found_end && last_global_child < cum + tree_children) {
+        end_tree = itree;
+        end_offset = last_global_child - cum;
+        found_end = 1;
+      }
+      cum += tree_children;
+    }
+    if (!found_first) {
+      /* first_global_child == global_num_children (an empty last rank) */
+      first_tree = cmesh->num_trees;
+      first_offset = 0;
+    }
+    if (!found_end) {
+      /* last_global_child == global_num_children */
+      end_tree = cmesh->num_trees;
+      end_offset = 0;
+    }
+    is_empty = first_global_child >= last_global_child;
+    if (!is_empty) {
+      entry->first_local_tree = first_tree;
+      entry->child_in_tree_begin = first_offset;
+      if (end_offset == 0) {
+        /* last_global_child is the first child of end_tree, so the last
+         * local element lies in the previous tree, of which it is the
+         * last child. */
+        entry->last_local_tree = end_tree - 1;
+        entry->child_in_tree_end =
+          leafs_per_class[t8_cmesh_get_tree_class
+                          (cmesh, (t8_locidx_t) (end_tree - 1))];
+      }
+      else {
+        entry->last_local_tree = end_tree;
+        entry->child_in_tree_end = end_offset;
+      }
+      entry->first_tree_shared = cmesh->mpirank > 0 && first_offset > 0;
+    }
+    else {
+      /* This process is empty. Set the first local tree to the first
+       * local tree of the next nonempty rank and the last local tree to
+       * first - 1, as in the single class case below. */
+      entry->first_local_tree =
+        first_offset == 0 ? first_tree : first_tree + 1;
+      entry->last_local_tree = entry->first_local_tree - 1;
+    }
+    return;
   }
+  /* All trees share the same child count, either because only one class
+   * is present or because we keep the established uniform treatment for
+   * partitioned cmeshes, where the tree classes of remote trees are not
+   * available for a scan. */
+
+  entry->first_local_tree = first_global_child / children_per_tree;
+  entry->child_in_tree_begin =
+    first_global_child - entry->first_local_tree * children_per_tree;
 
-  *last_local_tree = (last_global_child - 1) / children_per_tree;
+  entry->last_local_tree = (last_global_child - 1) / children_per_tree;
 
-  is_empty = *first_local_tree >= *last_local_tree
+  is_empty = entry->first_local_tree >= entry->last_local_tree
     && first_global_child >= last_global_child;
-  if (first_tree_shared != NULL) {
 #ifdef T8_ENABLE_DEBUG
-    prev_last_tree = (first_global_child - 1) / children_per_tree;
-    T8_ASSERT (cmesh->mpirank > 0 || prev_last_tree <= 0);
+  prev_last_tree = (first_global_child - 1) / children_per_tree;
+  T8_ASSERT (cmesh->mpirank > 0 || prev_last_tree <= 0);
 #endif
-    if (!is_empty && cmesh->mpirank > 0 && child_in_tree_begin_temp > 0) {
-      /* We exclude empty partitions here, by def their first_tree_shared flag is zero */
-      /* We also exclude that the previous partition was empty at the beginning of the
-       * partitions array */
-      /* We also exclude the case that we have the first global element but
-       * are not rank 0. */
-      *first_tree_shared = 1;
-    }
-    else {
-      *first_tree_shared = 0;
-    }
+  if (!is_empty && cmesh->mpirank > 0 && entry->child_in_tree_begin > 0) {
+    /* We exclude empty partitions here, by def their first_tree_shared flag is zero */
+    /* We also exclude that the previous partition was empty at the beginning of the
+     * partitions array */
+    /* We also exclude the case that we have the first global element but
+     * are not rank 0. */
+    entry->first_tree_shared = 1;
   }
-  if (child_in_tree_end != NULL) {
-    if (*last_local_tree > 0) {
-      *child_in_tree_end =
-        last_global_child - *last_local_tree * children_per_tree;
-    }
-    else {
-      *child_in_tree_end = last_global_child;
-    }
+  else {
+    entry->first_tree_shared = 0;
+  }
+  if (entry->last_local_tree > 0) {
+    entry->child_in_tree_end =
+      last_global_child - entry->last_local_tree * children_per_tree;
+  }
+  else {
+    entry->child_in_tree_end = last_global_child;
   }
   if (is_empty) {
     /* This process is empty */
     /* We now set the first local tree to the first local tree on the
      * next nonempty rank, and the last local tree to first - 1 */
-    *first_local_tree = last_global_child / children_per_tree;
+    entry->first_local_tree = last_global_child / children_per_tree;
     if (first_global_child % children_per_tree != 0) {
       /* The next nonempty process shares this tree. */
-      (*first_local_tree)++;
+      entry->first_local_tree++;
     }
 
-    *last_local_tree = *first_local_tree - 1;
+    entry->last_local_tree = entry->first_local_tree - 1;
   }
+}
 
+void
+t8_cmesh_uniform_bounds (t8_cmesh_t cmesh, int level,
+                         t8_scheme_cxx_t *ts,
+                         t8_gloidx_t *first_local_tree,
+                         t8_gloidx_t *child_in_tree_begin,
+                         t8_gloidx_t *last_local_tree,
+                         t8_gloidx_t *child_in_tree_end,
+                         int8_t *first_tree_shared)
+{
+  t8_cmesh_uniform_bounds_entry_t *entry = NULL;
+  size_t              ientry;
+
+  T8_ASSERT (cmesh != NULL);
+  T8_ASSERT (cmesh->committed);
+  T8_ASSERT (level >= 0);
+  T8_ASSERT (ts != NULL);
+
+  /* Look the bounds up in the cache of the cmesh. A committed cmesh is
+   * immutable, so cached bounds stay valid for its lifetime. */
+  if (cmesh->uniform_bounds_cache == NULL) {
+    cmesh->uniform_bounds_cache =
+      sc_array_new (sizeof (t8_cmesh_uniform_bounds_entry_t));
+  }
+  for (ientry = 0; ientry < cmesh->uniform_bounds_cache->elem_count;
+       ientry++) {
+    t8_cmesh_uniform_bounds_entry_t *cached =
+      (t8_cmesh_uniform_bounds_entry_t *)
+      sc_array_index (cmesh->uniform_bounds_cache, ientry);
+    if (cached->scheme == ts && cached->level == level) {
+      entry = cached;
+      break;
+    }
+  }
+  if (entry == NULL) {
+    /* Not cached yet, compute the bounds and store them */
+    entry = (t8_cmesh_uniform_bounds_entry_t *)
+      sc_array_push (cmesh->uniform_bounds_cache);
+    entry->scheme = ts;
+    entry->level = level;
+    t8_cmesh_uniform_bounds_compute (cmesh, level, ts, entry);
+  }
+
+  *first_local_tree = entry->first_local_tree;
+  if (child_in_tree_begin != NULL) {
+    *child_in_tree_begin = entry->child_in_tree_begin;
+  }
+  *last_local_tree = entry->last_local_tree;
+  if (child_in_tree_end != NULL) {
+    *child_in_tree_end = entry->child_in_tree_end;
+  }
+  if (first_tree_shared != NULL) {
+    *first_tree_shared = entry->first_tree_shared;
+  }
 }
@@ -24,6 +24,7 @@
 #include <t8_cmesh/t8_cmesh_examples.h>
 #include <t8_cmesh/t8_cmesh_geometry.h>
 #include <t8_geometry/t8_geometry_implementations/t8_geometry_linear.h>
+#include <t8_geometry/t8_geometry_implementations/t8_geometry_p4est.h>
 #include <t8_cmesh_vtk_writer.h>
 #include <t8_vec.h>
 #include <t8_eclass.h>
@@ -165,6 +166,119 @@ t8_cmesh_new_from_p8est (p8est_connectivity_t * conn,
   return t8_cmesh_new_from_p4est_ext (conn, 3, comm, do_partition, 0);
 }
 
+/* The zero-copy variant of \ref t8_cmesh_new_from_p4est_ext. Instead of
+ * expanding the connectivity's vertices into per tree vertex attributes
+ * (which stores every shared vertex once per adjoining tree, first in the
+ * stash and then again in the committed cmesh), the cmesh is given a
+ * \ref t8_geometry_p4est that reads the connectivity's vertices and
+ * tree_to_vertex arrays in place. Only the face connections pass through
+ * the stash; the vertex data exists exactly once in memory. */
+static t8_cmesh_t
+t8_cmesh_new_from_p4est_shared_ext (void *conn, int dim, sc_MPI_Comm comm,
+                                    int do_partition, int own_connectivity)
+{
+#define _T8_CMESH_P48_CONN(_ENTRY) \
+  (dim == 2 ? ((p4est_connectivity_t *) conn)->_ENTRY \
+            : ((p8est_connectivity_t *) conn)->_ENTRY)
+  t8_cmesh_t          cmesh;
+  t8_gloidx_t         ltree;
+  int                 num_faces;
+  int                 iface;
+  int8_t              ttf;
+  p4est_topidx_t      ttt;
+  t8_geometry_c      *conn_geom;
+
+  /* Make sure that p4est is properly initialized. If not, do it here
+   * and raise a warning. */
+  if (!sc_package_is_registered (p4est_package_id)) {
+    t8_global_errorf
+      ("WARNING: p4est is not yet initialized. Doing it now for you.\n");
+    p4est_init (NULL, SC_LP_ESSENTIAL);
+  }
+
+  T8_ASSERT (dim == 2 || dim == 3);
+  T8_ASSERT (dim == 3
+             ||
+             p4est_connectivity_is_valid ((p4est_connectivity_t *) (conn)));
+  T8_ASSERT (dim == 2
+             ||
+             p8est_connectivity_is_valid ((p8est_connectivity_t *) (conn)));
+  SC_CHECK_ABORT (_T8_CMESH_P48_CONN (vertices) != NULL
+                  && _T8_CMESH_P48_CONN (tree_to_vertex) != NULL,
+                  "The zero-copy p4est bridge requires a connectivity "
+                  "with vertex information.\n");
+
+  num_faces = dim == 2 ? 4 : 6;
+  t8_cmesh_init (&cmesh);
+  /* The geometry references conn in place; if own_connectivity is set it
+   * destroys conn together with the cmesh */
+  if (dim == 2) {
+    conn_geom =
+      t8_geometry_from_p4est_new ((p4est_connectivity_t *) conn,
+                                  own_connectivity);
+  }
+  else {
+    conn_geom =
+      t8_geometry_from_p8est_new ((p8est_connectivity_t *) conn,
+                                  own_connectivity);
+  }
+  t8_cmesh_register_geometry (cmesh, conn_geom);
+  /* Set the tree classes. No vertex attributes are stored. */
+  for (ltree = 0; ltree < _T8_CMESH_P48_CONN (num_trees); ltree++) {
+    t8_cmesh_set_tree_class (cmesh, ltree,
+                             dim == 2 ? T8_ECLASS_QUAD : T8_ECLASS_HEX);
+  }
+  /* get face neighbor information from conn and join faces in cmesh */
+  for (ltree = 0; ltree < _T8_CMESH_P48_CONN (num_trees); ltree++) {
+    for (iface = 0; iface < num_faces; iface++) {
+      ttf = _T8_CMESH_P48_CONN (tree_to_face[num_faces * ltree + iface]);
+      ttt = _T8_CMESH_P48_CONN (tree_to_tree[num_faces * ltree + iface]);
+      /* insert the face only if we did not insert it before */
+      if (ltree < ttt || (ltree == ttt && iface < ttf % num_faces)) {
+        t8_cmesh_set_join (cmesh, ltree, ttt, iface, ttf % num_faces,
+                           ttf / num_faces);
+      }
+    }
+  }
+  if (do_partition) {
+    int                 mpirank, mpisize, mpiret;
+    t8_gloidx_t         first_tree, last_tree, num_trees;
+
+    mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+    SC_CHECK_MPI (mpiret);
+    mpiret = sc_MPI_Comm_size (comm, &mpisize);
+    SC_CHECK_MPI (mpiret);
+    /* First tree and last tree according to uniform level 0 partitioning.
+     * Each process still references the full connectivity, only the cmesh
+     * metadata is partitioned. */
+    num_trees = _T8_CMESH_P48_CONN (num_trees);
+    first_tree = (mpirank * num_trees) / mpisize;
+    last_tree = ((mpirank + 1) * num_trees) / mpisize - 1;
+    t8_cmesh_set_partition_range (cmesh, 3, first_tree, last_tree);
+  }
+  t8_cmesh_commit (cmesh, comm);
+  return cmesh;
+#undef _T8_CMESH_P48_CONN
+}
+
+t8_cmesh_t
+t8_cmesh_new_from_p4est_shared (p4est_connectivity_t * conn,
+                                sc_MPI_Comm comm, int do_partition,
+                                int own_connectivity)
+{
+  return t8_cmesh_new_from_p4est_shared_ext (conn, 2, comm, do_partition,
+                                             own_connectivity);
+}
+
+t8_cmesh_t
+t8_cmesh_new_from_p8est_shared (p8est_connectivity_t * conn,
+                                sc_MPI_Comm comm, int do_partition,
+                                int own_connectivity)
+{
+  return t8_cmesh_new_from_p4est_shared_ext (conn, 3, comm, do_partition,
+                                             own_connectivity);
+}
+
 static t8_cmesh_t
 t8_cmesh_new_vertex (sc_MPI_Comm comm)
 {
@@ -2037,6 +2151,199 @@ t8_cmesh_new_disjoint_bricks (t8_gloidx_t num_x, t8_gloidx_t num_y,
   return cmesh;
 }
 
+/* qsort/bsearch comparison function for global tree ids. */
+static int
+t8_cmesh_gloidx_compare (const void *v1, const void *v2)
+{
+  const t8_gloidx_t   id1 = *(const t8_gloidx_t *) v1;
+  const t8_gloidx_t   id2 = *(const t8_gloidx_t *) v2;
+
+  return id1 < id2 ? -1 : id1 != id2;
+}
+
+/* Compute the global id of the face neighbor of the brick tree
+ * (ix, iy, iz) across face \a face in a num_x by num_y (by num_z) brick.
+ * The trees are numbered in x-y-z order, thus
+ * id = (iz * num_y + iy) * num_x + ix.
+ * Returns -1 if the face is a domain boundary. */
+static t8_gloidx_t
+t8_cmesh_brick_neighbor (t8_gloidx_t ix, t8_gloidx_t iy, t8_gloidx_t iz,
+                         int face, t8_gloidx_t num_x, t8_gloidx_t num_y,
+                         t8_gloidx_t num_z, int x_periodic, int y_periodic,
+                         int z_periodic)
+{
+  switch (face) {
+  case 0:
+    if (ix == 0 && !x_periodic) {
+      return -1;
+    }
+    ix = ix == 0 ? num_x - 1 : ix - 1;
+    break;
+  case 1:
+    if (ix == num_x - 1 && !x_periodic) {
+      return -1;
+    }
+    ix = ix == num_x - 1 ? 0 : ix + 1;
+    break;
+  case 2:
+    if (iy == 0 && !y_periodic) {
+      return -1;
+    }
+    iy = iy == 0 ? num_y - 1 : iy - 1;
+    break;
+  case 3:
+    if (iy == num_y - 1 && !y_periodic) {
+      return -1;
+    }
+    iy = iy == num_y - 1 ? 0 : iy + 1;
+    break;
+  case 4:
+    if (iz == 0 && !z_periodic) {
+      return -1;
+    }
+    iz = iz == 0 ? num_z - 1 : iz - 1;
+    break;
+  case 5:
+    if (iz == num_z - 1 && !z_periodic) {
+      return -1;
+    }
+    iz = iz == num_z - 1 ? 0 : iz + 1;
+    break;
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+  return (iz * num_y + iy) * num_x + ix;
+}
+
+/* Create a num_x by num_y (by num_z) brick cmesh that is partitioned
+ * from birth. In contrast to t8_cmesh_new_disjoint_bricks the extents
+ * are global and the resulting mesh is face connected. Each process
+ * computes its contiguous range of trees in the uniform level 0
+ * partition and only inserts these trees plus the class, vertex and
+ * face information of their ghost neighbors into the stash. Thus, time
+ * and memory per process scale with num_trees / mpisize and the full
+ * tree list is never built on any process. */
+t8_cmesh_t
+t8_cmesh_new_brick_partitioned (t8_gloidx_t num_x, t8_gloidx_t num_y,
+                                t8_gloidx_t num_z, int x_periodic,
+                                int y_periodic, int z_periodic,
+                                sc_MPI_Comm comm)
+{
+  t8_cmesh_t          cmesh;
+  t8_eclass_t         eclass;
+  t8_gloidx_t         num_trees, num_local_trees, num_unique;
+  t8_gloidx_t         first_tree, last_tree, itree, ineighbor, list_it;
+  t8_gloidx_t         ix, iy, iz;
+  sc_array_t         *ghost_trees;
+  double              vertices[24];    /* Only 4 * 3 = 12 used in 2d */
+  size_t              ighost;
+  int                 dim, num_faces, num_vertices, iface, nface, icorner;
+  int                 is_ghost_list, neighbor_known;
+  int                 mpirank, mpisize, mpiret;
+  t8_geometry_c      *linear_geom;
+
+  T8_ASSERT (num_x > 0 && num_y > 0 && num_z >= 0);
+  /* Set the dimension to 3 if num_z > 0 and 2 otherwise. */
+  dim = num_z > 0 ? 3 : 2;
+  eclass = dim == 2 ? T8_ECLASS_QUAD : T8_ECLASS_HEX;
+  num_faces = 2 * dim;
+  num_vertices = 1 << dim;
+  num_trees = num_x * num_y;
+  if (dim == 3) {
+    num_trees *= num_z;
+  }
+  mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  /* First tree and last tree according to uniform level 0 partitioning */
+  first_tree = (mpirank * num_trees) / mpisize;
+  last_tree = ((mpirank + 1) * num_trees) / mpisize - 1;
+  num_local_trees = last_tree - first_tree + 1;
+
+  /* Collect the global ids of all ghost neighbors of the local trees in
+   * a sorted array without duplicates. */
+  ghost_trees = sc_array_new (sizeof (t8_gloidx_t));
+  for (itree = first_tree; itree <= last_tree; itree++) {
+    ix = itree % num_x;
+    iy = (itree / num_x) % num_y;
+    iz = dim == 3 ? itree / (num_x * num_y) : 0;
+    for (iface = 0; iface < num_faces; iface++) {
+      ineighbor =
+        t8_cmesh_brick_neighbor (ix, iy, iz, iface, num_x, num_y, num_z,
+                                 x_periodic, y_periodic, z_periodic);
+      if (ineighbor >= 0 && (ineighbor < first_tree
+                             || ineighbor > last_tree)) {
+        *(t8_gloidx_t *) sc_array_push (ghost_trees) = ineighbor;
+      }
+    }
+  }
+  sc_array_sort (ghost_trees, t8_cmesh_gloidx_compare);
+  num_unique = 0;
+  for (ighost = 0; ighost < ghost_trees->elem_count; ighost++) {
+    ineighbor = *(t8_gloidx_t *) sc_array_index (ghost_trees, ighost);
+    if (num_unique == 0
+        || ineighbor != *(t8_gloidx_t *) sc_array_index (ghost_trees,
+                                                         num_unique - 1)) {
+      *(t8_gloidx_t *) sc_array_index (ghost_trees, num_unique) = ineighbor;
+      num_unique++;
+    }
+  }
+  sc_array_resize (ghost_trees, num_unique);
+
+  t8_cmesh_init (&cmesh);
+  /* We use linear geometry */
+  linear_geom = t8_geometry_linear_new (dim);
+  t8_cmesh_register_geometry (cmesh, linear_geom);
+
+  /* Insert class, vertices and face connections for the local trees and
+   * their ghosts. We iterate over the local range first and over the
+   * sorted ghost ids afterwards. */
+  for (list_it = 0; list_it < num_local_trees + num_unique; list_it++) {
+    is_ghost_list = list_it >= num_local_trees;
+    itree = !is_ghost_list ? first_tree + list_it
+      : *(t8_gloidx_t *) sc_array_index (ghost_trees,
+                                         list_it - num_local_trees);
+    ix = itree % num_x;
+    iy = (itree / num_x) % num_y;
+    iz = dim == 3 ? itree / (num_x * num_y) : 0;
+    t8_cmesh_set_tree_class (cmesh, itree, eclass);
+    for (icorner = 0; icorner < num_vertices; icorner++) {
+      vertices[3 * icorner] = (double) (ix + (icorner & 1));
+      vertices[3 * icorner + 1] = (double) (iy + ((icorner >> 1) & 1));
+      vertices[3 * icorner + 2] =
+        dim == 3 ? (double) (iz + ((icorner >> 2) & 1)) : 0;
+    }
+    t8_cmesh_set_tree_vertices (cmesh, itree, vertices, num_vertices);
+    for (iface = 0; iface < num_faces; iface++) {
+      ineighbor =
+        t8_cmesh_brick_neighbor (ix, iy, iz, iface, num_x, num_y, num_z,
+                                 x_periodic, y_periodic, z_periodic);
+      if (ineighbor < 0) {
+        /* The face is a domain boundary */
+        continue;
+      }
+      /* The brick is axis aligned, so the neighbor face is the opposite
+       * face and the orientation is zero. */
+      nface = iface ^ 1;
+      /* Insert each face connection exactly once. A connection is
+       * inserted by its smaller member if that member is a local tree
+       * or a ghost and by the larger member otherwise. */
+      neighbor_known = (first_tree <= ineighbor && ineighbor <= last_tree)
+        || sc_array_bsearch (ghost_trees, &ineighbor,
+                             t8_cmesh_gloidx_compare) >= 0;
+      if (itree < ineighbor || (itree == ineighbor && iface < nface)
+          || (itree > ineighbor && !neighbor_known)) {
+        t8_cmesh_set_join (cmesh, itree, ineighbor, iface, nface, 0);
+      }
+    }
+  }
+  sc_array_destroy (ghost_trees);
+  t8_cmesh_set_partition_range (cmesh, 3, first_tree, last_tree);
+  t8_cmesh_commit (cmesh, comm);
+  return cmesh;
+}
+
 /* Construct a tetrahedral cmesh that has all possible face to face
  * connections and orientations. */
 t8_cmesh_t
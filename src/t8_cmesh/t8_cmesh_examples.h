@@ -62,6 +62,52 @@ t8_cmesh_t          t8_cmesh_new_from_p8est (p8est_connectivity_t * conn,
                                              sc_MPI_Comm comm,
                                              int do_partition);
 
+/** Constructs a cmesh from a p4est_connectivity structure without copying
+ * the vertex data. The cmesh references the connectivity's vertices and
+ * tree_to_vertex arrays in place through a \ref t8_geometry_p4est and
+ * stores no per tree vertex attributes, skipping the stash round-trip of
+ * \ref t8_cmesh_new_from_p4est. \a conn must stay valid and unchanged for
+ * the lifetime of the cmesh (and of all cmeshes and forests derived from
+ * it).
+ * \param[in]       conn       The p4est connectivity. Must provide vertex
+ *                             information.
+ * \param[in]       comm       mpi communicator to be used with the new cmesh.
+ * \param[in]       do_partition Flag whether the cmesh should be partitioned
+ *                             or not. Each process still references the
+ *                             full connectivity.
+ * \param[in]       own_connectivity If true, the cmesh takes ownership of
+ *                             \a conn and destroys it when the cmesh is
+ *                             destroyed.
+ * \return          A t8_cmesh structure that holds the same connectivity
+ *                  information as \a conn.
+ * \note Since the trees carry no vertex attribute,
+ * \ref t8_cmesh_get_tree_vertices returns NULL for this cmesh; coordinates
+ * are obtained through the geometry, \ref t8_geometry_evaluate.
+ * \note This function requires that p4est is initialized, as
+ * \ref t8_cmesh_new_from_p4est.
+ */
+t8_cmesh_t          t8_cmesh_new_from_p4est_shared (p4est_connectivity_t *
+                                                    conn, sc_MPI_Comm comm,
+                                                    int do_partition,
+                                                    int own_connectivity);
+
+/** Constructs a cmesh from a p8est_connectivity structure without copying
+ * the vertex data, \see t8_cmesh_new_from_p4est_shared.
+ * \param[in]       conn       The p8est connectivity. Must provide vertex
+ *                             information.
+ * \param[in]       comm       mpi communicator to be used with the new cmesh.
+ * \param[in]       do_partition Flag whether the cmesh should be partitioned
+ *                             or not.
+ * \param[in]       own_connectivity If true, the cmesh takes ownership of
+ *                             \a conn.
+ * \return          A t8_cmesh structure that holds the same connectivity
+ *                  information as \a conn.
+ */
+t8_cmesh_t          t8_cmesh_new_from_p8est_shared (p8est_connectivity_t *
+                                                    conn, sc_MPI_Comm comm,
+                                                    int do_partition,
+                                                    int own_connectivity);
+
 /* TODO: it could possibly be a problem that we do not set the dimension of
  * the cmesh. This could i.e. be difficult when we combine an empty cmesh with
  * a non-empty one. */
@@ -254,6 +300,35 @@ t8_cmesh_t          t8_cmesh_new_disjoint_bricks (t8_gloidx_t num_x,
                                                   int z_periodic,
                                                   sc_MPI_Comm comm);
 
+/** Create a partitioned cmesh of quads or hexes forming a global
+ * num_x by num_y (by num_z) brick of unit squares or cubes.
+ * In contrast to \ref t8_cmesh_new_disjoint_bricks the extents are
+ * global and the bricks of the processes are face connected.
+ * The cmesh is partitioned from birth: each process computes its
+ * contiguous range of trees in the uniform level 0 partition and only
+ * instantiates these trees plus the ghost records of their neighbors.
+ * Time and memory per process thus scale with num_trees / mpisize and
+ * the full tree list is never built on any single process.
+ * \param [in] num_x       The global number of trees in x direction. Must be > 0.
+ * \param [in] num_y       The global number of trees in y direction. Must be > 0.
+ * \param [in] num_z       The global number of trees in z direction. Must be >= 0.
+ *                         If nonzero, the cmesh is 3 dimensional.
+ * \param [in] x_periodic  If nonzero, the brick is periodic in x direction.
+ * \param [in] y_periodic  If nonzero, the brick is periodic in y direction.
+ * \param [in] z_periodic  If nonzero and \a num_z > 0, the brick is periodic in z direction.
+ * \param [in] comm        The MPI communicator used to commit the cmesh.
+ * \return                 A committed and partitioned cmesh with
+ *                         num_x * num_y (* num_z) global trees that are
+ *                         uniformly distributed among the processes.
+ */
+t8_cmesh_t          t8_cmesh_new_brick_partitioned (t8_gloidx_t num_x,
+                                                    t8_gloidx_t num_y,
+                                                    t8_gloidx_t num_z,
+                                                    int x_periodic,
+                                                    int y_periodic,
+                                                    int z_periodic,
+                                                    sc_MPI_Comm comm);
+
 /** Construct a tetrahedral cmesh that has all possible face to face
  * connections and orientations.
  * This cmesh is used for testing and debugging.
@@ -32,14 +32,32 @@ These functions write a file in the netCDF-format which represents the given 2D-
 #define ERRCODE 2
 #define ERR(e) {t8_global_productionf("Error: %s\n", nc_strerror(e)); exit(ERRCODE);}
 #endif
+#ifndef NC_CONTIGUOUS
+#define NC_CONTIGUOUS 1
+#endif
 #if T8_WITH_NETCDF_PAR
 #include <netcdf_par.h>
+#else
+/* Macros usually defined in 'netcdf_par.h' */
+#ifndef NC_INDEPENDENT
+#define NC_INDEPENDENT 0
+#endif
+#ifndef NC_COLLECTIVE
+#define NC_COLLECTIVE 1
+#endif
 #endif
 #include <t8_element_shape.h>
 #include <t8_cmesh_netcdf.h>
 #include <t8_cmesh.h>
 #include <t8_cmesh/t8_cmesh_types.h>
 
+/* Number of trees whose records are staged per nc_put_vara call. The
+ * writer streams the connectivity in bounded batches of this size
+ * directly from the tree structures instead of materializing arrays
+ * over all local trees. All processes agree on the number of batches,
+ * so the variable data can be written with collective access. */
+#define T8_CMESH_NETCDF_BATCH 4096
+
 /* Contains all Variables used in order to work with the NetCDF-File */
 typedef struct
 {
@@ -73,6 +91,17 @@ typedef struct
   int                 netcdf_mpi_access;
   /* Stores the old NetCDF-FillMode if it gets changed */
   int                 old_fill_mode;
+  /* The tree range this process writes: on a partitioned cmesh the
+   * local trees, on a replicated cmesh written into one shared file an
+   * even split of the global range (every process holds every tree). */
+  t8_locidx_t         first_write_tree;
+  t8_locidx_t         num_write_trees;
+  t8_gloidx_t         write_offset;
+  /* The number of write batches, equal on all processes so that the
+   * collective puts match up. */
+  int                 num_write_batches;
+  /* The global node index of the first node written by this process. */
+  t8_gloidx_t         node_write_offset;
 
 } t8_cmesh_netcdf_context_t;
 
@@ -669,7 +698,11 @@ t8_cmesh_write_user_netcdf_vars (t8_cmesh_netcdf_context_t * context,
 #endif
 }
 
-/* Write NetCDF-coordinate data */
+/* Write NetCDF-coordinate data.
+ * The node coordinates and the element-node connectivity are streamed
+ * from the tree structures in batches of \ref T8_CMESH_NETCDF_BATCH
+ * trees. Every process issues the same number of puts, so the variables
+ * can be written with collective access. */
 static void
 t8_cmesh_write_netcdf_coordinate_data (t8_cmesh_t cmesh,
                                        t8_cmesh_netcdf_context_t * context,
@@ -678,116 +711,105 @@ t8_cmesh_write_netcdf_coordinate_data (t8_cmesh_t cmesh,
 #if T8_WITH_NETCDF
   double             *vertices;
   t8_eclass_t         tree_class;
-  t8_locidx_t         num_local_trees;
-  t8_locidx_t         ltree_id = 0;
-  t8_gloidx_t         local_tree_offset;
-  t8_gloidx_t         num_it = 0;
+  t8_locidx_t         ltree_id;
+  t8_locidx_t         batch_first, batch_count, it;
+  t8_gloidx_t         node_it;
+  size_t              batch_nodes;
+  int                 ibatch;
   int                 retval;
-  int                 mpirank, mpisize;
-  size_t              num_elements;
-  size_t              num_max_nodes_per_elem;
-  size_t              num_nodes;
   t8_nc_int64_t      *Mesh_elem_nodes;
   double             *Mesh_node_x;
   double             *Mesh_node_y;
   double             *Mesh_node_z;
   size_t              start_ptr;
   size_t              count_ptr;
-  int                 i, j;
+  int                 i;
+
+  /* Allocate the bounded batch scratch. A tree contributes at most
+   * nMaxMesh_elem_nodes nodes. */
+  Mesh_elem_nodes = T8_ALLOC (t8_nc_int64_t, (size_t) T8_CMESH_NETCDF_BATCH
+                              * context->nMaxMesh_elem_nodes);
+  Mesh_node_x = T8_ALLOC (double, (size_t) T8_CMESH_NETCDF_BATCH
+                          * context->nMaxMesh_elem_nodes);
+  Mesh_node_y = T8_ALLOC (double, (size_t) T8_CMESH_NETCDF_BATCH
+                          * context->nMaxMesh_elem_nodes);
+  Mesh_node_z = T8_ALLOC (double, (size_t) T8_CMESH_NETCDF_BATCH
+                          * context->nMaxMesh_elem_nodes);
+
+  /* The global index of the next node this process writes */
+  node_it = context->node_write_offset;
+  for (ibatch = 0; ibatch < context->num_write_batches; ibatch++) {
+    batch_first = (t8_locidx_t) ibatch * T8_CMESH_NETCDF_BATCH;
+    batch_count = context->num_write_trees - batch_first;
+    batch_count = SC_MAX (SC_MIN (batch_count, T8_CMESH_NETCDF_BATCH), 0);
+    batch_nodes = 0;
+    /* Iterate over the trees of this batch. */
+    /* Corners should be stored in the same order as in a vtk-file (read that somewehere on a netcdf page). */
+    for (it = 0; it < batch_count; it++) {
+      ltree_id = context->first_write_tree + batch_first + it;
+      tree_class = t8_cmesh_get_tree_class (cmesh, ltree_id);
+      vertices = t8_cmesh_get_tree_vertices (cmesh, ltree_id);
+      i = 0;
+      for (; i < t8_eclass_num_vertices[tree_class]; i++) {
+        /* Stores the x-, y- and z- coordinate of the nodes */
+        Mesh_node_x[batch_nodes] =
+          vertices[3 * (t8_eclass_t8_to_vtk_corner_number[tree_class][i])];
+        Mesh_node_y[batch_nodes] =
+          vertices[3 * (t8_eclass_t8_to_vtk_corner_number[tree_class][i]) +
+                   1];
+        Mesh_node_z[batch_nodes] =
+          vertices[3 * (t8_eclass_t8_to_vtk_corner_number[tree_class][i]) +
+                   2];
+        /* Stores the the nodes which correspond to this element. */
+        Mesh_elem_nodes[it * context->nMaxMesh_elem_nodes + i] =
+          node_it + (t8_gloidx_t) batch_nodes;
+        batch_nodes++;
+      }
+      for (; i < context->nMaxMesh_elem_nodes; i++) {
+        /* Pre-fills the the elements corresponding nodes, if it is an element having less than nMaxMesh_elem_nodes. */
+        Mesh_elem_nodes[it * context->nMaxMesh_elem_nodes + i] = -1;
+      }
+    }
 
-  retval = sc_MPI_Comm_size (comm, &mpisize);
-  SC_CHECK_MPI (retval);
-  retval = sc_MPI_Comm_rank (comm, &mpirank);
-  SC_CHECK_MPI (retval);
+    /* Fill the 'Mesh_elem_node'-variable. */
+    /* Define a (2D) NetCDF-Hyperslab for filling the variable */
+    {
+      const size_t        start_ptr_var[2] =
+        { batch_count > 0 ? (size_t) (context->write_offset + batch_first)
+        : 0, 0
+      };
+      const size_t        count_ptr_var[2] =
+        { (size_t) batch_count, (size_t) context->nMaxMesh_elem_nodes };
+      if ((retval =
+           nc_put_vara_long (context->ncid, context->var_elem_nodes_id,
+                             start_ptr_var, count_ptr_var,
+                             &Mesh_elem_nodes[0]))) {
+        ERR (retval);
+      }
+    }
 
-  /* Get number of local trees. */
-  num_local_trees = t8_cmesh_get_num_local_trees (cmesh);
-
-  /* Allocate the Variable-data that will be put out in the NetCDF variables */
-  num_elements = (size_t) num_local_trees;
-  num_max_nodes_per_elem = (size_t) (context->nMaxMesh_elem_nodes);
-  num_nodes = (size_t) (context->nMesh_local_node);
-  Mesh_elem_nodes =
-    T8_ALLOC (t8_nc_int64_t, num_elements * num_max_nodes_per_elem);
-  Mesh_node_x = T8_ALLOC (double, num_nodes);
-  Mesh_node_y = T8_ALLOC (double, num_nodes);
-  Mesh_node_z = T8_ALLOC (double, num_nodes);
-
-  /* Check if pointers are not NULL. */
-  T8_ASSERT (Mesh_node_x != NULL && Mesh_node_y != NULL
-             && Mesh_node_z != NULL && Mesh_elem_nodes != NULL);
-
-  /* Iterate over all local trees. */
-  /* Corners should be stored in the same order as in a vtk-file (read that somewehere on a netcdf page). */
-  local_tree_offset = t8_cmesh_get_first_treeid (cmesh);
-  for (ltree_id = 0; ltree_id < num_local_trees; ++ltree_id) {
-    tree_class = t8_cmesh_get_tree_class (cmesh, ltree_id);
-    vertices = t8_cmesh_get_tree_vertices (cmesh, ltree_id);
-    i = 0;
-    for (; i < t8_eclass_num_vertices[tree_class]; i++) {
-      /* Stores the x-, y- and z- coordinate of the nodes */
-      Mesh_node_x[num_it] =
-        vertices[3 * (t8_eclass_t8_to_vtk_corner_number[tree_class][i])];
-      Mesh_node_y[num_it] =
-        vertices[3 * (t8_eclass_t8_to_vtk_corner_number[tree_class][i]) + 1];
-      Mesh_node_z[num_it] =
-        vertices[3 * (t8_eclass_t8_to_vtk_corner_number[tree_class][i]) + 2];
-      /* Stores the the nodes which correspond to this element. */
-      Mesh_elem_nodes[(ltree_id) * context->nMaxMesh_elem_nodes + i] =
-        local_tree_offset + num_it;
-      num_it++;
+    /* Write the coordinates of the nodes of this batch. */
+    start_ptr = batch_nodes > 0 ? (size_t) node_it : 0;
+    count_ptr = batch_nodes;
+    /* Write the x-coordinate data */
+    if ((retval =
+         nc_put_vara_double (context->ncid, context->var_node_x_id,
+                             &start_ptr, &count_ptr, &Mesh_node_x[0]))) {
+      ERR (retval);
     }
-    for (; i < context->nMaxMesh_elem_nodes; i++) {
-      /* Pre-fills the the elements corresponding nodes, if it is an element having less than nMaxMesh_elem_nodes. */
-      Mesh_elem_nodes[(ltree_id) * (context->nMaxMesh_elem_nodes) + i] = -1;
+    /* Write the y-coordinate data */
+    if ((retval =
+         nc_put_vara_double (context->ncid, context->var_node_y_id,
+                             &start_ptr, &count_ptr, &Mesh_node_y[0]))) {
+      ERR (retval);
     }
-  }
-
-  /* Write the data into the NetCDF coordinate variables. */
-  /* Fill the 'Mesh_elem_node'-variable. */
-
-  /* Allocate memory for node offsets */
-  t8_gloidx_t        *node_offset[mpisize];
-
-  retval =
-    sc_MPI_Allgather (&context->nMesh_local_node, 1, T8_MPI_GLOIDX,
-                      node_offset, 1, T8_MPI_GLOIDX, comm);
-  SC_CHECK_MPI (retval);
-
-  /* Define a (2D) NetCDF-Hyperslab for filling the variable */
-  const size_t        start_ptr_var[2] = { local_tree_offset, 0 };
-  const size_t        count_ptr_var[2] =
-    { num_local_trees, context->nMaxMesh_elem_nodes };
-  if ((retval =
-       nc_put_vara_long (context->ncid, context->var_elem_nodes_id,
-                         start_ptr_var, count_ptr_var,
-                         &Mesh_elem_nodes[0]))) {
-    ERR (retval);
-  }
-
-  /* Counters which imply the position in the NetCDF-variable where the data will be written, */
-  start_ptr = 0;
-  for (j = 0; j < mpirank; ++j) {
-    start_ptr += (size_t) node_offset[j];
-  }
-  count_ptr = (size_t) context->nMesh_local_node;
-  /* Write the x-coordinate data */
-  if ((retval =
-       nc_put_vara_double (context->ncid, context->var_node_x_id,
-                           &start_ptr, &count_ptr, &Mesh_node_x[0]))) {
-    ERR (retval);
-  }
-  /* Write the y-coordinate data */
-  if ((retval =
-       nc_put_vara_double (context->ncid, context->var_node_y_id,
-                           &start_ptr, &count_ptr, &Mesh_node_y[0]))) {
-    ERR (retval);
-  }
-  /* Write the z-coordinate data */
-  if ((retval =
-       nc_put_vara_double (context->ncid, context->var_node_z_id,
-                           &start_ptr, &count_ptr, &Mesh_node_z[0]))) {
-    ERR (retval);
+    /* Write the z-coordinate data */
+    if ((retval =
+         nc_put_vara_double (context->ncid, context->var_node_z_id,
+                             &start_ptr, &count_ptr, &Mesh_node_z[0]))) {
+      ERR (retval);
+    }
+    node_it += (t8_gloidx_t) batch_nodes;
   }
 
   /* Free the allocated memory */
@@ -798,6 +820,10 @@ t8_cmesh_write_netcdf_coordinate_data (t8_cmesh_t cmesh,
 #endif
 }
 
+/* Write the element types and tree ids, streamed in batches of
+ * \ref T8_CMESH_NETCDF_BATCH trees. Along the way the node count of the
+ * written tree range is computed, from which the 'nMesh_node' dimension
+ * and the node offset of each process are derived. */
 static void
 t8_cmesh_write_netcdf_data (t8_cmesh_t cmesh,
                             t8_cmesh_netcdf_context_t * context,
@@ -805,54 +831,56 @@ t8_cmesh_write_netcdf_data (t8_cmesh_t cmesh,
 {
 #if T8_WITH_NETCDF
   t8_eclass_t         tree_class;
-  t8_gloidx_t         gtree_id;
-  t8_locidx_t         num_local_trees;
-  t8_locidx_t         ltree_id = 0;
+  t8_locidx_t         ltree_id;
+  t8_locidx_t         batch_first, batch_count, it;
+  int                 ibatch;
   t8_nc_int64_t      *Mesh_elem_tree_id;
   t8_nc_int32_t      *Mesh_elem_types;
   t8_gloidx_t         num;
   t8_gloidx_t         num_nodes;
+  t8_gloidx_t         node_offset;
   size_t              start_ptr;
   size_t              count_ptr;
   int                 retval;
+  int                 mpirank;
 
-  /* Get number of local trees. */
-  num_local_trees = t8_cmesh_get_num_local_trees (cmesh);
-
-  /* Declare variables with their proper dimensions. */
-  Mesh_elem_types = T8_ALLOC (t8_nc_int32_t, num_local_trees);
-  Mesh_elem_tree_id = T8_ALLOC (t8_nc_int64_t, num_local_trees);
+  retval = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (retval);
 
-  /* Check if pointers are not NULL. */
-  T8_ASSERT (Mesh_elem_types != NULL && Mesh_elem_tree_id != NULL);
+  /* Allocate the bounded batch scratch. */
+  Mesh_elem_types = T8_ALLOC (t8_nc_int32_t, T8_CMESH_NETCDF_BATCH);
+  Mesh_elem_tree_id = T8_ALLOC (t8_nc_int64_t, T8_CMESH_NETCDF_BATCH);
 
-  /* Determine the number of nodes. */
+  /* Counts the number of nodes of the written tree range. */
   num = 0;
-  for (ltree_id = 0; ltree_id < num_local_trees; ++ltree_id) {
-    tree_class = t8_cmesh_get_tree_class (cmesh, ltree_id);
-    num += t8_eclass_num_vertices[tree_class];
-    /* Store the element class of the cmesh-element at the global_id position. */
-    gtree_id = t8_cmesh_get_global_id (cmesh, ltree_id);
-    /* Getting the integer element class (in vtk_type), might not be conform with UGRID? */
-    Mesh_elem_types[ltree_id] = t8_eclass_vtk_type[tree_class];
-    /* The number trees equals the number of elements in the cmesh. */
-    Mesh_elem_tree_id[ltree_id] = gtree_id;
-  }
-
-  /* Write the data in the corresponding NetCDF-variable. */
-  /* Fill the 'Mesh_elem_types'-variable. */
-  /* Define the pointer where to write the data an how much entries */
-  start_ptr = (size_t) t8_cmesh_get_first_treeid (cmesh);
-  count_ptr = (size_t) num_local_trees;
-  if ((retval =
-       nc_put_vara_int (context->ncid, context->var_elem_types_id,
-                        &start_ptr, &count_ptr, &Mesh_elem_types[0]))) {
-    ERR (retval);
-  }
-  if ((retval =
-       nc_put_vara_long (context->ncid, context->var_elem_tree_id,
-                         &start_ptr, &count_ptr, &Mesh_elem_tree_id[0]))) {
-    ERR (retval);
+  for (ibatch = 0; ibatch < context->num_write_batches; ibatch++) {
+    batch_first = (t8_locidx_t) ibatch * T8_CMESH_NETCDF_BATCH;
+    batch_count = context->num_write_trees - batch_first;
+    batch_count = SC_MAX (SC_MIN (batch_count, T8_CMESH_NETCDF_BATCH), 0);
+    for (it = 0; it < batch_count; it++) {
+      ltree_id = context->first_write_tree + batch_first + it;
+      tree_class = t8_cmesh_get_tree_class (cmesh, ltree_id);
+      num += t8_eclass_num_vertices[tree_class];
+      /* Getting the integer element class (in vtk_type), might not be conform with UGRID? */
+      Mesh_elem_types[it] = t8_eclass_vtk_type[tree_class];
+      /* The number trees equals the number of elements in the cmesh. */
+      Mesh_elem_tree_id[it] = t8_cmesh_get_global_id (cmesh, ltree_id);
+    }
+    /* Write the data in the corresponding NetCDF-variable. */
+    /* Define the pointer where to write the data an how much entries */
+    start_ptr = batch_count > 0
+      ? (size_t) (context->write_offset + batch_first) : 0;
+    count_ptr = (size_t) batch_count;
+    if ((retval =
+         nc_put_vara_int (context->ncid, context->var_elem_types_id,
+                          &start_ptr, &count_ptr, &Mesh_elem_types[0]))) {
+      ERR (retval);
+    }
+    if ((retval =
+         nc_put_vara_long (context->ncid, context->var_elem_tree_id,
+                           &start_ptr, &count_ptr, &Mesh_elem_tree_id[0]))) {
+      ERR (retval);
+    }
   }
 
   /* Free the allocated memory */
@@ -861,6 +889,17 @@ t8_cmesh_write_netcdf_data (t8_cmesh_t cmesh,
 
   /* After counting the number of nodes, the  NetCDF-dimension 'nMesh_node' can be created => Store the 'nMesh_node' dimension */
   context->nMesh_local_node = num;
+  /* Compute the node offset of this process as the prefix sum of the
+   * node counts over the processes. */
+  node_offset = 0;
+  retval =
+    sc_MPI_Exscan (&num, &node_offset, 1, T8_MPI_GLOIDX, sc_MPI_SUM, comm);
+  SC_CHECK_MPI (retval);
+  if (mpirank == 0) {
+    /* Exscan leaves the result on rank 0 undefined. */
+    node_offset = 0;
+  }
+  context->node_write_offset = node_offset;
   retval =
     sc_MPI_Allreduce (&num, &num_nodes, 1, T8_MPI_GLOIDX, sc_MPI_SUM, comm);
   SC_CHECK_MPI (retval);
@@ -884,13 +923,21 @@ t8_cmesh_write_user_netcdf_data (t8_cmesh_t cmesh,
     size_t              start_ptr;
     size_t              count_ptr;
 
-    /* Counters which imply the position in the NetCDF-variable where the data will be written, */
-    start_ptr = (size_t) t8_cmesh_get_first_treeid (cmesh);
-    count_ptr = (size_t) t8_cmesh_get_num_local_trees (cmesh);
+    /* Counters which imply the position in the NetCDF-variable where the
+     * data will be written. On a replicated cmesh written into one shared
+     * file only the slice of the write range of this process is put. */
+    start_ptr = (size_t) context->write_offset;
+    count_ptr = (size_t) context->num_write_trees;
     /* Iterate over the amount of user-defined variables */
     for (i = 0; i < num_extern_netcdf_vars; ++i) {
+      void               *var_data;
+
       /* Check if exactly one value per element is given */
-      T8_ASSERT (count_ptr == ext_variables[i]->var_user_data->elem_count);
+      T8_ASSERT ((size_t) t8_cmesh_get_num_local_trees (cmesh) ==
+                 ext_variables[i]->var_user_data->elem_count);
+      var_data = count_ptr > 0
+        ? sc_array_index (ext_variables[i]->var_user_data,
+                          (size_t) context->first_write_tree) : NULL;
       /* Check the variable data type */
       switch (ext_variables[i]->datatype) {
       case T8_NETCDF_INT:
@@ -898,9 +945,7 @@ t8_cmesh_write_user_netcdf_data (t8_cmesh_t cmesh,
         if ((retval =
              nc_put_vara_int (context->ncid,
                               ext_variables[i]->var_user_dimid, &start_ptr,
-                              &count_ptr, (t8_nc_int32_t *)
-                              sc_array_index (ext_variables
-                                              [i]->var_user_data, 0)))) {
+                              &count_ptr, (t8_nc_int32_t *) var_data))) {
           ERR (retval);
         }
         break;
@@ -909,9 +954,7 @@ t8_cmesh_write_user_netcdf_data (t8_cmesh_t cmesh,
         if ((retval =
              nc_put_vara_long (context->ncid,
                                ext_variables[i]->var_user_dimid, &start_ptr,
-                               &count_ptr, (t8_nc_int64_t *)
-                               sc_array_index (ext_variables
-                                               [i]->var_user_data, 0)))) {
+                               &count_ptr, (t8_nc_int64_t *) var_data))) {
           ERR (retval);
         }
         break;
@@ -920,9 +963,7 @@ t8_cmesh_write_user_netcdf_data (t8_cmesh_t cmesh,
         if ((retval =
              nc_put_vara_double (context->ncid,
                                  ext_variables[i]->var_user_dimid, &start_ptr,
-                                 &count_ptr, (double *)
-                                 sc_array_index (ext_variables
-                                                 [i]->var_user_data, 0)))) {
+                                 &count_ptr, (double *) var_data))) {
           ERR (retval);
         }
         break;
@@ -1058,13 +1099,16 @@ t8_cmesh_write_netcdf_file (t8_cmesh_t cmesh,
 #endif
 }
 
-/* Function that gets called if a cmesh schould be written in NetCDF-Format */
+/* Extended variant that additionally takes the netCDF variable storage
+ * and mpi access patterns. With parallel netCDF routines available, all
+ * processes stream their tree ranges collectively into one shared file. */
 void
-t8_cmesh_write_netcdf (t8_cmesh_t cmesh, const char *file_prefix,
-                       const char *file_title, int dim,
-                       int num_extern_netcdf_vars,
-                       t8_netcdf_variable_t * ext_variables[],
-                       sc_MPI_Comm comm)
+t8_cmesh_write_netcdf_ext (t8_cmesh_t cmesh, const char *file_prefix,
+                           const char *file_title, int dim,
+                           int num_extern_netcdf_vars,
+                           t8_netcdf_variable_t * ext_variables[],
+                           sc_MPI_Comm comm, int netcdf_var_storage_mode,
+                           int netcdf_mpi_access)
 {
   t8_cmesh_netcdf_context_t context;
   /* Check whether pointers are not NULL */
@@ -1073,6 +1117,8 @@ t8_cmesh_write_netcdf (t8_cmesh_t cmesh, const char *file_prefix,
   char                file_name[BUFSIZ];
   int                 retval;
   int                 mpirank, mpisize;
+  int                 num_batches;
+  t8_gloidx_t         num_global_trees;
 
   /* Size of the communicator */
   retval = sc_MPI_Comm_size (comm, &mpisize);
@@ -1081,6 +1127,10 @@ t8_cmesh_write_netcdf (t8_cmesh_t cmesh, const char *file_prefix,
   retval = sc_MPI_Comm_rank (comm, &mpirank);
   SC_CHECK_MPI (retval);
 
+#if T8_WITH_NETCDF_PAR
+  /* All processes write collectively into one shared file. */
+  snprintf (file_name, BUFSIZ, "%s.nc", file_prefix);
+#else
   /* Prevent the single file to be overwritten if more proceses are involved */
   if (mpisize > 1) {
     /* Create the NetCDF-Filname for each process */
@@ -1090,6 +1140,7 @@ t8_cmesh_write_netcdf (t8_cmesh_t cmesh, const char *file_prefix,
     /* Create the NetCDF-Filname */
     snprintf (file_name, BUFSIZ, "%s.nc", file_prefix);
   }
+#endif
 
   /* Initialize first variables for NetCDF purposes. */
   context.filename = file_name;
@@ -1099,11 +1150,41 @@ t8_cmesh_write_netcdf (t8_cmesh_t cmesh, const char *file_prefix,
   context.fillvalue64 = -1;
   context.start_index = 0;
   context.convention = "UGRID v1.0";
-  /* Set the netCDF per variable storage and mpi-access patterns (only if parallel netCDF routines are accessible) */
+  /* Set the netCDF per variable storage and mpi-access patterns */
+  context.netcdf_var_storage_mode = netcdf_var_storage_mode;
+  context.netcdf_mpi_access = netcdf_mpi_access;
+
+  /* Determine the tree range this process writes. */
+  num_global_trees = t8_cmesh_get_num_trees (cmesh);
 #if T8_WITH_NETCDF_PAR
-  context.netcdf_var_storage_mode = NC_CONTIGUOUS;
-  context.netcdf_mpi_access = NC_INDEPENDENT;
+  if (!t8_cmesh_is_partitioned (cmesh) && mpisize > 1) {
+    /* Every process holds every tree of a replicated cmesh; split the
+     * global range evenly, so that the shared file is written once
+     * instead of mpisize times. */
+    context.write_offset = num_global_trees * mpirank / mpisize;
+    context.first_write_tree = (t8_locidx_t) context.write_offset;
+    context.num_write_trees = (t8_locidx_t)
+      (num_global_trees * (mpirank + 1) / mpisize - context.write_offset);
+  }
+  else
 #endif
+  {
+    /* A partitioned cmesh (or a process local file) writes the local
+     * trees of this process. */
+    context.first_write_tree = 0;
+    context.num_write_trees = t8_cmesh_get_num_local_trees (cmesh);
+    context.write_offset = t8_cmesh_get_first_treeid (cmesh);
+  }
+  /* All processes must issue the same number of puts, so that the
+   * variables can be written with collective access. */
+  num_batches =
+    (int) ((context.num_write_trees + T8_CMESH_NETCDF_BATCH - 1)
+           / T8_CMESH_NETCDF_BATCH);
+  retval = sc_MPI_Allreduce (&num_batches, &context.num_write_batches, 1,
+                             sc_MPI_INT, sc_MPI_MAX, comm);
+  SC_CHECK_MPI (retval);
+  context.node_write_offset = 0;
+
   /* Get the max number of corners for elements in a specific dimension */
   context.nMaxMesh_elem_nodes = t8_element_shape_max_num_corner[dim];
   t8_cmesh_netcdf_ugrid_namespace_t namespace_context;
@@ -1120,3 +1201,18 @@ t8_cmesh_write_netcdf (t8_cmesh_t cmesh, const char *file_prefix,
                                 num_extern_netcdf_vars, ext_variables, comm);
   }
 }
+
+/* Function that gets called if a cmesh schould be written in NetCDF-Format */
+void
+t8_cmesh_write_netcdf (t8_cmesh_t cmesh, const char *file_prefix,
+                       const char *file_title, int dim,
+                       int num_extern_netcdf_vars,
+                       t8_netcdf_variable_t * ext_variables[],
+                       sc_MPI_Comm comm)
+{
+  /* The default pattern matches the previous behavior: contiguous
+   * variable storage with independent access. */
+  t8_cmesh_write_netcdf_ext (cmesh, file_prefix, file_title, dim,
+                             num_extern_netcdf_vars, ext_variables, comm,
+                             NC_CONTIGUOUS, NC_INDEPENDENT);
+}
@@ -569,3 +569,159 @@ t8_offset_print (t8_shmem_array_t offset, sc_MPI_Comm comm)
   t8_debugf ("Offsets = %s\n", buf);
 #endif
 }
+
+t8_offset_compressed_t *
+t8_offset_compressed_new (const t8_gloidx_t *offset, int mpisize)
+{
+  t8_offset_compressed_t *compressed;
+  t8_offset_run_t    *run;
+  size_t              num_runs;
+  int                 iproc;
+
+  T8_ASSERT (offset != NULL);
+  T8_ASSERT (mpisize >= 1);
+
+  compressed = T8_ALLOC (t8_offset_compressed_t, 1);
+  compressed->num_procs = mpisize;
+  /* In the worst case every entry starts its own run */
+  compressed->runs = T8_ALLOC (t8_offset_run_t, mpisize + 1);
+  /* The first run starts at entry 0 */
+  run = compressed->runs;
+  run->first_proc = 0;
+  run->first_entry = offset[0];
+  run->stride = offset[1] - offset[0];
+  num_runs = 1;
+  for (iproc = 1; iproc <= mpisize; iproc++) {
+    if (offset[iproc] != run->first_entry
+        + (t8_gloidx_t) (iproc - run->first_proc) * run->stride) {
+      /* The entry breaks the linearity of the current run,
+       * so it starts a new run. */
+      run = compressed->runs + num_runs++;
+      run->first_proc = iproc;
+      run->first_entry = offset[iproc];
+      run->stride =
+        iproc < mpisize ? offset[iproc + 1] - offset[iproc] : 0;
+    }
+  }
+  compressed->num_runs = num_runs;
+  /* Shrink the run array to the number of runs found */
+  compressed->runs = T8_REALLOC (compressed->runs, t8_offset_run_t, num_runs);
+  return compressed;
+}
+
+void
+t8_offset_compressed_destroy (t8_offset_compressed_t **pcompressed)
+{
+  T8_ASSERT (pcompressed != NULL && *pcompressed != NULL);
+  T8_FREE ((*pcompressed)->runs);
+  T8_FREE (*pcompressed);
+  *pcompressed = NULL;
+}
+
+/* Binary search for the run that contains a given entry index. */
+static const t8_offset_run_t *
+t8_offset_compressed_find_run (const t8_offset_compressed_t *compressed,
+                               int proc)
+{
+  size_t              low, high, mid;
+
+  T8_ASSERT (compressed != NULL);
+  T8_ASSERT (0 <= proc && proc <= compressed->num_procs);
+  /* Find the last run with first_proc <= proc */
+  low = 0;
+  high = compressed->num_runs - 1;
+  while (low < high) {
+    mid = (low + high + 1) / 2;
+    if (compressed->runs[mid].first_proc <= proc) {
+      low = mid;
+    }
+    else {
+      high = mid - 1;
+    }
+  }
+  T8_ASSERT (compressed->runs[low].first_proc <= proc);
+  return compressed->runs + low;
+}
+
+t8_gloidx_t
+t8_offset_compressed_get (const t8_offset_compressed_t *compressed, int proc)
+{
+  const t8_offset_run_t *run;
+
+  run = t8_offset_compressed_find_run (compressed, proc);
+  return run->first_entry
+    + (t8_gloidx_t) (proc - run->first_proc) * run->stride;
+}
+
+t8_gloidx_t
+t8_offset_compressed_first (const t8_offset_compressed_t *compressed,
+                            int proc)
+{
+  t8_gloidx_t         entry;
+
+  T8_ASSERT (0 <= proc && proc < compressed->num_procs);
+  entry = t8_offset_compressed_get (compressed, proc);
+  return T8_GLOIDX_ABS (entry) + t8_glo_kl0 (entry);
+}
+
+t8_gloidx_t
+t8_offset_compressed_last (const t8_offset_compressed_t *compressed,
+                           int proc)
+{
+  T8_ASSERT (0 <= proc && proc < compressed->num_procs);
+  return T8_GLOIDX_ABS (t8_offset_compressed_get (compressed, proc + 1)) - 1;
+}
+
+int
+t8_offset_compressed_first_owner (const t8_offset_compressed_t *compressed,
+                                  t8_gloidx_t gtree)
+{
+  int                 low, high, mid, proc;
+
+  T8_ASSERT (compressed != NULL);
+  T8_ASSERT (gtree >= 0);
+  /* The last tree of a process is nondecreasing in the rank, so the ranks
+   * with last tree >= gtree form a suffix. Binary search for the smallest
+   * rank in that suffix; its first tree is <= gtree, so it owns gtree
+   * unless it is empty. */
+  low = 0;
+  high = compressed->num_procs - 1;
+  while (low < high) {
+    mid = (low + high) / 2;
+    if (t8_offset_compressed_last (compressed, mid) >= gtree) {
+      high = mid;
+    }
+    else {
+      low = mid + 1;
+    }
+  }
+  proc = low;
+  /* Skip empty processes; they carry the same last tree as their
+   * predecessor. Stretches of empty processes are single zero-stride
+   * runs, so we jump run by run instead of rank by rank. */
+  while (t8_offset_compressed_first (compressed, proc)
+         > t8_offset_compressed_last (compressed, proc)) {
+    const t8_offset_run_t *run =
+      t8_offset_compressed_find_run (compressed, proc);
+    if (run->stride == 0
+        && run + 1 < compressed->runs + compressed->num_runs) {
+      /* All remaining processes of this run are empty as well */
+      proc = SC_MAX (proc + 1, (run + 1)->first_proc - 1);
+    }
+    else {
+      proc++;
+    }
+    T8_ASSERT (proc < compressed->num_procs);
+  }
+  T8_ASSERT (t8_offset_compressed_first (compressed, proc) <= gtree);
+  T8_ASSERT (gtree <= t8_offset_compressed_last (compressed, proc));
+  return proc;
+}
+
+size_t
+t8_offset_compressed_bytes (const t8_offset_compressed_t *compressed)
+{
+  T8_ASSERT (compressed != NULL);
+  return sizeof (t8_offset_compressed_t)
+    + compressed->num_runs * sizeof (t8_offset_run_t);
+}
@@ -284,6 +284,103 @@ int                 t8_offset_range_send (int start, int end, int mpirank,
 void                t8_offset_print (t8_shmem_array_t offset,
                                      sc_MPI_Comm comm);
 
+/** One piecewise-linear run of a compressed offset array.
+ * The raw entry of a process \a proc inside the run is
+ * first_entry + (proc - first_proc) * stride.
+ * \see t8_offset_compressed_t
+ */
+typedef struct t8_offset_run
+{
+  int                 first_proc; /**< The first process of the run. */
+  t8_gloidx_t         first_entry; /**< The raw offset entry of \a first_proc,
+                                        including the shared tree encoding. */
+  t8_gloidx_t         stride; /**< The entry difference between consecutive
+                                   processes of the run. */
+} t8_offset_run_t;
+
+/** A run-length compressed partition offset array.
+ * Offsets along the space-filling curve are mostly uniform, so the
+ * mpisize + 1 entries of an offset array typically collapse into few
+ * piecewise-linear runs. The compressed form stores one \ref
+ * t8_offset_run_t per run and answers entry lookups in O(log runs),
+ * which makes it suitable for extreme rank counts where the full array
+ * is too large to keep per process.
+ * Construct with \ref t8_offset_compressed_new, query with
+ * \ref t8_offset_compressed_get and the derived functions below.
+ */
+typedef struct t8_offset_compressed
+{
+  int                 num_procs; /**< The number of processes; the compressed
+                                      array represents entries 0 .. num_procs. */
+  size_t              num_runs; /**< The number of piecewise-linear runs. */
+  t8_offset_run_t    *runs; /**< The runs, ascending in \a first_proc. */
+} t8_offset_compressed_t;
+
+/** Compress a partition offset array into piecewise-linear runs.
+ * \param [in] offset   A partition table with \a mpisize + 1 entries.
+ * \param [in] mpisize  The number of processes of the partition.
+ * \return              The newly allocated compressed form, to be freed
+ *                      with \ref t8_offset_compressed_destroy.
+ */
+t8_offset_compressed_t *t8_offset_compressed_new (const t8_gloidx_t *offset,
+                                                  int mpisize);
+
+/** Free a compressed offset array.
+ * \param [in,out] pcompressed Pointer to a compressed offset array.
+ *                             Set to NULL on output.
+ */
+void                t8_offset_compressed_destroy (t8_offset_compressed_t
+                                                  **pcompressed);
+
+/** Look up a raw offset entry in a compressed offset array.
+ * Equivalent to offset[proc] on the uncompressed array, in O(log runs).
+ * \param [in] compressed A compressed offset array.
+ * \param [in] proc       An entry index, 0 <= \a proc <= num_procs.
+ * \return                The raw entry of \a proc, including the shared
+ *                        tree encoding.
+ */
+t8_gloidx_t         t8_offset_compressed_get (const t8_offset_compressed_t
+                                              *compressed, int proc);
+
+/** The first tree of a process, like \ref t8_offset_first on the
+ * uncompressed array.
+ * \param [in] compressed A compressed offset array.
+ * \param [in] proc       The rank of a process.
+ * \return                The global id of the first local tree of \a proc.
+ */
+t8_gloidx_t         t8_offset_compressed_first (const t8_offset_compressed_t
+                                                *compressed, int proc);
+
+/** The last tree of a process, like \ref t8_offset_last on the
+ * uncompressed array.
+ * \param [in] compressed A compressed offset array.
+ * \param [in] proc       The rank of a process.
+ * \return                The global id of the last local tree of \a proc.
+ */
+t8_gloidx_t         t8_offset_compressed_last (const t8_offset_compressed_t
+                                               *compressed, int proc);
+
+/** Find the smallest process that owns a given tree, like
+ * \ref t8_offset_first_owner_of_tree but in O(log runs) instead of a
+ * linear owner walk.
+ * \param [in] compressed A compressed offset array.
+ * \param [in] gtree      A global tree id of the partition.
+ * \return                The smallest rank that owns \a gtree.
+ */
+int                 t8_offset_compressed_first_owner (const
+                                                      t8_offset_compressed_t
+                                                      *compressed,
+                                                      t8_gloidx_t gtree);
+
+/** The number of bytes of heap memory of a compressed offset array.
+ * \param [in] compressed A compressed offset array.
+ * \return                The allocated byte count, for comparison with the
+ *                        (mpisize + 1) * sizeof (t8_gloidx_t) bytes of the
+ *                        uncompressed array.
+ */
+size_t              t8_offset_compressed_bytes (const t8_offset_compressed_t
+                                                *compressed);
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_CMESH_OFFSET_H */
@@ -32,6 +32,7 @@
 #include "t8_cmesh_trees.h"
 #include "t8_cmesh_partition.h"
 #include "t8_cmesh_offset.h"
+#include <t8_mpi_profile.h>
 
 /* Change the neighbor entry of a tree to match the new partition.
  * Input: A face_neighbor entry in cmesh_from and a process to which the corresponding tree will be send
@@ -546,41 +547,217 @@ t8_partition_compute_gnb (t8_cmesh_t cmesh_from, sc_array_t *send_as_ghost)
   return ghost_neighbor_bytes;
 }
 
+/* Collect the attribute block of an entry of send_as_ghost.
+ * The entry may refer to a local tree or a ghost of cmesh_from.
+ * Returns the total byte count of the attribute data and sets
+ * *num_attributes and *attr_info (the first attribute info) and
+ * *first_attribute (the first data byte).  The latter two are set to
+ * NULL if the entry carries no attributes. */
+static size_t
+t8_partition_ghost_attr_block (t8_cmesh_t cmesh_from, t8_locidx_t ghost_id,
+                               int *num_attributes,
+                               t8_attribute_info_struct_t ** attr_info,
+                               void **first_attribute)
+{
+  t8_ctree_t          tree;
+  t8_cghost_t         ghost;
+
+  T8_ASSERT (ghost_id >= 0);
+  if (ghost_id < cmesh_from->num_local_trees) {
+    /* This ghost is currently a local tree */
+    tree = t8_cmesh_get_tree (cmesh_from, ghost_id);
+    *num_attributes = tree->num_attributes;
+    if (*num_attributes > 0) {
+      *attr_info = T8_TREE_ATTR_INFO (tree, 0);
+      *first_attribute = T8_TREE_ATTR (tree, *attr_info);
+      return t8_cmesh_trees_attribute_size (tree);
+    }
+  }
+  else {
+    /* This ghost is currently a ghost */
+    T8_ASSERT (ghost_id < cmesh_from->num_local_trees
+               + cmesh_from->num_ghosts);
+    ghost = t8_cmesh_trees_get_ghost (cmesh_from->trees, ghost_id
+                                      - cmesh_from->num_local_trees);
+    *num_attributes = ghost->num_attributes;
+    if (*num_attributes > 0) {
+      *attr_info = T8_GHOST_ATTR_INFO (ghost, 0);
+      *first_attribute = T8_GHOST_ATTR (ghost, *attr_info);
+      return t8_cmesh_trees_ghost_attribute_size (ghost);
+    }
+  }
+  *attr_info = NULL;
+  *first_attribute = NULL;
+  return 0;
+}
+
+/* Compute a content hash (FNV-1a) over the attribute keys, sizes and
+ * data bytes of a ghost's attribute block.  Used to deduplicate ghost
+ * attributes in the send buffer. */
+static size_t
+t8_partition_ghost_attr_hash (int num_attributes,
+                              const t8_attribute_info_struct_t *attr_info,
+                              const void *first_attribute, size_t attr_bytes)
+{
+  const unsigned char *bytes = (const unsigned char *) first_attribute;
+  size_t              hash = 2166136261U;
+  size_t              iz;
+  int                 iatt;
+
+  for (iatt = 0; iatt < num_attributes; iatt++) {
+    hash = (hash ^ (size_t) attr_info[iatt].package_id) * 16777619U;
+    hash = (hash ^ (size_t) attr_info[iatt].key) * 16777619U;
+    hash = (hash ^ attr_info[iatt].attribute_size) * 16777619U;
+  }
+  for (iz = 0; iz < attr_bytes; iz++) {
+    hash = (hash ^ bytes[iz]) * 16777619U;
+  }
+  return hash;
+}
+
+/* Check whether two entries of send_as_ghost carry identical attribute
+ * blocks, that is the same number of attributes with the same package ids,
+ * keys, sizes and data bytes. */
+static int
+t8_partition_ghost_attr_equal (t8_cmesh_t cmesh_from, t8_locidx_t ghost_id_a,
+                               t8_locidx_t ghost_id_b)
+{
+  t8_attribute_info_struct_t *attr_info_a, *attr_info_b;
+  void               *first_attribute_a, *first_attribute_b;
+  size_t              attr_bytes_a, attr_bytes_b;
+  int                 num_attributes_a, num_attributes_b, iatt;
+
+  attr_bytes_a = t8_partition_ghost_attr_block (cmesh_from, ghost_id_a,
+                                                &num_attributes_a,
+                                                &attr_info_a,
+                                                &first_attribute_a);
+  attr_bytes_b = t8_partition_ghost_attr_block (cmesh_from, ghost_id_b,
+                                                &num_attributes_b,
+                                                &attr_info_b,
+                                                &first_attribute_b);
+  if (num_attributes_a != num_attributes_b || attr_bytes_a != attr_bytes_b) {
+    return 0;
+  }
+  for (iatt = 0; iatt < num_attributes_a; iatt++) {
+    if (attr_info_a[iatt].package_id != attr_info_b[iatt].package_id
+        || attr_info_a[iatt].key != attr_info_b[iatt].key
+        || attr_info_a[iatt].attribute_size
+        != attr_info_b[iatt].attribute_size) {
+      return 0;
+    }
+  }
+  return attr_bytes_a == 0
+    || memcmp (first_attribute_a, first_attribute_b, attr_bytes_a) == 0;
+}
+
+/* An entry for the sort based deduplication of ghost attribute blocks. */
+typedef struct
+{
+  size_t              hash;     /* Content hash of the attribute block */
+  size_t              ighost;   /* Index of the ghost in send_as_ghost */
+} t8_part_ghost_attr_entry_t;
+
+/* qsort callback: sort by hash first and by ghost index second, such that
+ * within a group of equal hashes the first entry is the one that will
+ * actually store the data. */
+static int
+t8_partition_ghost_attr_entry_compare (const void *e1, const void *e2)
+{
+  const t8_part_ghost_attr_entry_t *entry1 =
+    (const t8_part_ghost_attr_entry_t *) e1;
+  const t8_part_ghost_attr_entry_t *entry2 =
+    (const t8_part_ghost_attr_entry_t *) e2;
+
+  if (entry1->hash != entry2->hash) {
+    return entry1->hash < entry2->hash ? -1 : 1;
+  }
+  return entry1->ighost < entry2->ighost ? -1 :
+    entry1->ighost == entry2->ighost ? 0 : 1;
+}
+
 /* Compute the number of bytes that need to be allocated in the send buffer
- * for the attribute entries of all ghosts. */
+ * for the attribute entries of all ghosts.
+ * Ghost attribute blocks with identical content are stored only once:
+ * dup_of (allocated by the caller with one entry per ghost in
+ * send_as_ghost) is set to the index of the first ghost with the same
+ * content, or to -1 if the ghost stores its own data.  Duplicates do not
+ * count towards the returned byte count; their attribute infos are still
+ * counted in attr_info_bytes. */
 static size_t
 t8_partition_compute_gab (t8_cmesh_t cmesh_from, sc_array_t *send_as_ghost,
-                          size_t *attr_info_bytes)
+                          size_t *attr_info_bytes, t8_locidx_t *dup_of)
 {
-  size_t              ghost_attribute_bytes = 0, ighost;
-  t8_locidx_t         ghost_id, ghost_id_min_offset;
-  t8_cghost_t         ghost;
-  t8_ctree_t          tree;
+  size_t              ghost_attribute_bytes = 0, ighost, jz, group_start;
+  t8_locidx_t         ghost_id, ghost_id_other;
+  t8_attribute_info_struct_t *attr_info;
+  void               *first_attribute;
+  size_t              attr_bytes;
+  int                 num_attributes;
+  t8_part_ghost_attr_entry_t *entries;
 
   T8_ASSERT (attr_info_bytes != NULL);
+  T8_ASSERT (dup_of != NULL || send_as_ghost->elem_count == 0);
   *attr_info_bytes = 0;
+  if (send_as_ghost->elem_count == 0) {
+    return 0;
+  }
+  entries = T8_ALLOC (t8_part_ghost_attr_entry_t, send_as_ghost->elem_count);
   for (ighost = 0; ighost < send_as_ghost->elem_count; ighost++) {
     ghost_id = *(t8_locidx_t *) sc_array_index (send_as_ghost, ighost);
-    T8_ASSERT (ghost_id >= 0);
-    if (ghost_id < cmesh_from->num_local_trees) {
-      /* This ghost is currently a local tree */
-      tree = t8_cmesh_get_tree (cmesh_from, ghost_id);
-      ghost_attribute_bytes += t8_cmesh_trees_attribute_size (tree);
-      *attr_info_bytes += tree->num_attributes
-        * sizeof (t8_attribute_info_struct_t);
+    attr_bytes = t8_partition_ghost_attr_block (cmesh_from, ghost_id,
+                                                &num_attributes, &attr_info,
+                                                &first_attribute);
+    *attr_info_bytes += num_attributes
+      * sizeof (t8_attribute_info_struct_t);
+    dup_of[ighost] = -1;
+    entries[ighost].hash = attr_bytes > 0 ?
+      t8_partition_ghost_attr_hash (num_attributes, attr_info,
+                                    first_attribute, attr_bytes) : 0;
+    entries[ighost].ighost = ighost;
+  }
+  /* Sort the content hashes, then detect duplicates within each group of
+   * equal hashes.  Equal hashes are confirmed by comparing the actual
+   * content, so hash collisions merely cost an extra comparison. */
+  qsort (entries, send_as_ghost->elem_count,
+         sizeof (t8_part_ghost_attr_entry_t),
+         t8_partition_ghost_attr_entry_compare);
+  group_start = 0;
+  for (ighost = 1; ighost < send_as_ghost->elem_count; ighost++) {
+    if (entries[ighost].hash != entries[group_start].hash) {
+      group_start = ighost;
+      continue;
     }
-    else {
-      /* This ghost is currently a ghost */
-      ghost_id_min_offset =
-        ghost_id - t8_cmesh_get_num_local_trees (cmesh_from);
-      T8_ASSERT (0 <= ghost_id_min_offset
-                 && ghost_id_min_offset <
-                 t8_cmesh_get_num_ghosts (cmesh_from));
-      ghost =
-        t8_cmesh_trees_get_ghost (cmesh_from->trees, ghost_id_min_offset);
-      ghost_attribute_bytes += t8_cmesh_trees_ghost_attribute_size (ghost);
-      *attr_info_bytes += ghost->num_attributes
-        * sizeof (t8_attribute_info_struct_t);
+    ghost_id = *(t8_locidx_t *)
+      sc_array_index (send_as_ghost, entries[ighost].ighost);
+    attr_bytes = t8_partition_ghost_attr_block (cmesh_from, ghost_id,
+                                                &num_attributes, &attr_info,
+                                                &first_attribute);
+    if (attr_bytes == 0) {
+      /* Empty blocks are never deduplicated */
+      continue;
+    }
+    for (jz = group_start; jz < ighost; jz++) {
+      if (dup_of[entries[jz].ighost] != -1) {
+        /* Compare against stored blocks only */
+        continue;
+      }
+      ghost_id_other = *(t8_locidx_t *)
+        sc_array_index (send_as_ghost, entries[jz].ighost);
+      if (t8_partition_ghost_attr_equal (cmesh_from, ghost_id,
+                                         ghost_id_other)) {
+        dup_of[entries[ighost].ighost] = (t8_locidx_t) entries[jz].ighost;
+        break;
+      }
+    }
+  }
+  T8_FREE (entries);
+  /* Count the attribute bytes of all blocks that are actually stored */
+  for (ighost = 0; ighost < send_as_ghost->elem_count; ighost++) {
+    if (dup_of[ighost] == -1) {
+      ghost_id = *(t8_locidx_t *) sc_array_index (send_as_ghost, ighost);
+      ghost_attribute_bytes +=
+        t8_partition_ghost_attr_block (cmesh_from, ghost_id, &num_attributes,
+                                       &attr_info, &first_attribute);
     }
   }
   return ghost_attribute_bytes;
@@ -733,6 +910,7 @@ t8_cmesh_partition_copy_data (char *send_buffer, t8_cmesh_t cmesh,
                               size_t tree_neighbor_bytes,
                               size_t tree_attribute_bytes,
                               sc_array_t *send_as_ghost,
+                              const t8_locidx_t *ghost_dup_of,
                               t8_locidx_t send_first, t8_locidx_t send_last,
                               size_t total_alloc, int to_proc)
 {
@@ -743,6 +921,7 @@ t8_cmesh_partition_copy_data (char *send_buffer, t8_cmesh_t cmesh,
     temp_offset_ghost_att, temp_offset_ghost_data, temp_offset_ghost,
     ghost_attr_info_bytes_sofar;
   size_t              ghost_att_size;
+  size_t             *ghost_block_offset;
   //ssize_t             last_attribute_diff;
   t8_attribute_info_struct_t *attr_info;
   void               *first_attribute;
@@ -755,9 +934,6 @@ t8_cmesh_partition_copy_data (char *send_buffer, t8_cmesh_t cmesh,
   int8_t             *ttf_ghost, *ttf;
 
   /* Copy all trees to the send buffer */
-  /* TODO: This is currently inefficient since we copy each tree for itself.
-   *       Best practive is to copy chunks of trees out of the different part
-   *       arrays of cmesh_from */
   if (total_alloc == 0 || send_buffer == NULL) {
     t8_debugf ("No data to store in buffer.\n");
     return;
@@ -770,45 +946,88 @@ t8_cmesh_partition_copy_data (char *send_buffer, t8_cmesh_t cmesh,
   temp_offset_data = 0;
   /* offset from the beginning to the current tree */
   temp_offset_tree = 0;
-  for (itree = send_first; itree <= send_last; itree++) {
-    tree = t8_cmesh_trees_get_tree_ext (cmesh_from->trees, itree,
+  if (num_trees > 0 && cmesh_from->trees->tree_to_proc[send_first]
+      == cmesh_from->trees->tree_to_proc[send_last]) {
+    /* All trees of the send range lie in the same part of cmesh_from.
+     * Within a part the tree structs, the face neighbor entries, the
+     * attribute infos and the attribute data of consecutive trees each
+     * form one contiguous block, so we copy them as four chunks instead
+     * of copying each tree for itself. During repartitioning this range
+     * is usually the bulk of trees that a process keeps, with only the
+     * trees near the partition boundary moving to other processes. */
+    tree = t8_cmesh_trees_get_tree_ext (cmesh_from->trees, send_first,
                                         &face_neighbor, NULL);
-
-    (void) memcpy (send_buffer + temp_offset_tree, tree,
-                   sizeof (t8_ctree_struct_t));
-    temp_offset_tree += sizeof (t8_ctree_struct_t);
+    (void) memcpy (send_buffer, tree, num_trees * sizeof (t8_ctree_struct_t));
     /* Copy all face neighbor information to send_buffer */
     (void) memcpy (send_buffer + num_trees * sizeof (t8_ctree_struct_t) +
                    num_ghost_send * sizeof (t8_cghost_struct_t) +
-                   ghost_neighbor_bytes + temp_offset, face_neighbor,
-                   t8_eclass_num_faces[tree->eclass] *
-                   (sizeof (t8_locidx_t) + sizeof (int8_t)));
-    temp_offset += t8_eclass_num_faces[tree->eclass] *
-      (sizeof (t8_locidx_t) + sizeof (int8_t))
-      + T8_ADD_PADDING (t8_eclass_num_faces[tree->eclass] *
-                        (sizeof (t8_locidx_t) + sizeof (int8_t)));
-    /* TODO: ??? temp_offset += T8_ADD_PADDING (temp_offset) instead of the last 2 lines? */
-    if (tree->num_attributes > 0) {
+                   ghost_neighbor_bytes, face_neighbor, tree_neighbor_bytes);
+    /* The first tree of the range that has attributes marks the start of
+     * the contiguous attribute info and attribute data blocks. */
+    for (itree = send_first; itree <= send_last; itree++) {
+      tree = t8_cmesh_trees_get_tree (cmesh_from->trees, itree);
+      if (tree->num_attributes > 0) {
+        break;
+      }
+    }
+    if (itree <= send_last) {
       /* Copy all attribute infos to send_buffer */
       (void) memcpy (send_buffer + num_trees * sizeof (t8_ctree_struct_t) +
                      num_ghost_send * sizeof (t8_cghost_struct_t) +
-                     ghost_neighbor_bytes + tree_neighbor_bytes +
-                     temp_offset_att, T8_TREE_ATTR_INFO (tree, 0),
-                     tree->num_attributes *
-                     sizeof (t8_attribute_info_struct_t));
-      temp_offset_att +=
-        tree->num_attributes * sizeof (t8_attribute_info_struct_t);
+                     ghost_neighbor_bytes + tree_neighbor_bytes,
+                     T8_TREE_ATTR_INFO (tree, 0), attr_info_bytes);
       /* Copy all attribute data to send_buffer */
       (void) memcpy (send_buffer + num_trees * sizeof (t8_ctree_struct_t) +
                      num_ghost_send * sizeof (t8_cghost_struct_t) +
                      ghost_neighbor_bytes + tree_neighbor_bytes +
-                     attr_info_bytes + temp_offset_data,
+                     attr_info_bytes,
                      T8_TREE_ATTR (tree, T8_TREE_ATTR_INFO (tree, 0)),
-                     t8_cmesh_trees_attribute_size (tree));
-      temp_offset_data += t8_cmesh_trees_attribute_size (tree);
+                     tree_attribute_bytes);
+    }
+  }
+  else {
+    /* The send range spans more than one part, we copy each tree for
+     * itself. */
+    for (itree = send_first; itree <= send_last; itree++) {
+      tree = t8_cmesh_trees_get_tree_ext (cmesh_from->trees, itree,
+                                          &face_neighbor, NULL);
+
+      (void) memcpy (send_buffer + temp_offset_tree, tree,
+                     sizeof (t8_ctree_struct_t));
+      temp_offset_tree += sizeof (t8_ctree_struct_t);
+      /* Copy all face neighbor information to send_buffer */
+      (void) memcpy (send_buffer + num_trees * sizeof (t8_ctree_struct_t) +
+                     num_ghost_send * sizeof (t8_cghost_struct_t) +
+                     ghost_neighbor_bytes + temp_offset, face_neighbor,
+                     t8_eclass_num_faces[tree->eclass] *
+                     (sizeof (t8_locidx_t) + sizeof (int8_t)));
+      temp_offset += t8_eclass_num_faces[tree->eclass] *
+        (sizeof (t8_locidx_t) + sizeof (int8_t))
+        + T8_ADD_PADDING (t8_eclass_num_faces[tree->eclass] *
+                          (sizeof (t8_locidx_t) + sizeof (int8_t)));
+      /* TODO: ??? temp_offset += T8_ADD_PADDING (temp_offset) instead of the last 2 lines? */
+      if (tree->num_attributes > 0) {
+        /* Copy all attribute infos to send_buffer */
+        (void) memcpy (send_buffer + num_trees * sizeof (t8_ctree_struct_t) +
+                       num_ghost_send * sizeof (t8_cghost_struct_t) +
+                       ghost_neighbor_bytes + tree_neighbor_bytes +
+                       temp_offset_att, T8_TREE_ATTR_INFO (tree, 0),
+                       tree->num_attributes *
+                       sizeof (t8_attribute_info_struct_t));
+        temp_offset_att +=
+          tree->num_attributes * sizeof (t8_attribute_info_struct_t);
+        /* Copy all attribute data to send_buffer */
+        (void) memcpy (send_buffer + num_trees * sizeof (t8_ctree_struct_t) +
+                       num_ghost_send * sizeof (t8_cghost_struct_t) +
+                       ghost_neighbor_bytes + tree_neighbor_bytes +
+                       attr_info_bytes + temp_offset_data,
+                       T8_TREE_ATTR (tree, T8_TREE_ATTR_INFO (tree, 0)),
+                       t8_cmesh_trees_attribute_size (tree));
+        temp_offset_data += t8_cmesh_trees_attribute_size (tree);
+      }
     }
+    T8_ASSERT (tree_attribute_bytes == temp_offset_data);
   }
-  T8_ASSERT (tree_attribute_bytes == temp_offset_data);
   /* Set new face_neighbor offsets */
   /* TODO: indent bug? */
   /* Computes the offset of the face neighbors of the new trees */
@@ -870,6 +1089,10 @@ t8_cmesh_partition_copy_data (char *send_buffer, t8_cmesh_t cmesh,
   }
 
   /* Copy all ghosts and set their face entries and offsets */
+  /* Stores for each ghost that carries its own attribute data the offset
+   * of its data block in the send buffer.  Ghosts with duplicated content
+   * point into these blocks instead of storing the data again. */
+  ghost_block_offset = T8_ALLOC (size_t, num_ghost_send);
   /* Offset of ghost face_neighbor from first ghost */
   temp_offset = num_ghost_send * sizeof (t8_cghost_struct_t);
   /* Offset of current ghost from first ghost */
@@ -984,29 +1207,52 @@ t8_cmesh_partition_copy_data (char *send_buffer, t8_cmesh_t cmesh,
       memcpy (first_attr_info, attr_info, this_ghosts_att_info_size);
       temp_offset_ghost_att += this_ghosts_att_info_size;
 
-      /* Compute all new attribute data offsets */
-      for (iatt = 0; iatt < num_attributes; iatt++) {
-        /* Get the current attribute info */
-        attr_info = T8_GHOST_ATTR_INFO (ghost_cpy, iatt);
-        /* The new attribute offset is the offset from the first att_info to the data.
-         * Thus, the count of the bytes occupied by the att_info (ghosts_attr_info_bytes)
-         * plus the count of all attributes before this attribute (this_data_temp_offset).*/
-        /* all att info from this ghost and after. + all attributes before this attribute  */
-        attr_info->attribute_offset = ghost_attr_info_bytes -
-          ghost_attr_info_bytes_sofar + temp_offset_ghost_data;
-        temp_offset_ghost_data += attr_info->attribute_size;
+      if (ghost_dup_of[iz] >= 0) {
+        size_t              dup_data_offset;
+
+        /* This ghost's attribute data is identical to that of an earlier
+         * ghost in the buffer.  We do not store the data again but let
+         * the attribute infos point into the block of that ghost. */
+        T8_ASSERT ((size_t) ghost_dup_of[iz] < iz);
+        dup_data_offset = ghost_block_offset[ghost_dup_of[iz]];
+        for (iatt = 0; iatt < num_attributes; iatt++) {
+          attr_info = T8_GHOST_ATTR_INFO (ghost_cpy, iatt);
+          attr_info->attribute_offset = dup_data_offset
+            - ((size_t) ((char *) ghost_cpy - send_buffer)
+               + ghost_cpy->att_offset);
+          dup_data_offset += attr_info->attribute_size;
+        }
+      }
+      else {
+        /* Compute all new attribute data offsets */
+        for (iatt = 0; iatt < num_attributes; iatt++) {
+          /* Get the current attribute info */
+          attr_info = T8_GHOST_ATTR_INFO (ghost_cpy, iatt);
+          /* The new attribute offset is the offset from the first att_info to the data.
+           * Thus, the count of the bytes occupied by the att_info (ghosts_attr_info_bytes)
+           * plus the count of all attributes before this attribute (this_data_temp_offset).*/
+          /* all att info from this ghost and after. + all attributes before this attribute  */
+          attr_info->attribute_offset = ghost_attr_info_bytes -
+            ghost_attr_info_bytes_sofar + temp_offset_ghost_data;
+          temp_offset_ghost_data += attr_info->attribute_size;
+        }
+        /* Remember where this ghost's data block starts in the buffer */
+        ghost_block_offset[iz] =
+          (size_t) ((char *) T8_GHOST_ATTR (ghost_cpy, first_attr_info)
+                    - send_buffer);
+        /* Copy all attribute data of this ghost */
+        memcpy (T8_GHOST_ATTR (ghost_cpy, first_attr_info),
+                first_attribute, ghost_att_size);
       }
       ghost_attr_info_bytes_sofar +=
         num_attributes * sizeof (t8_attribute_info_struct_t);
-      /* Copy all attribute data of this ghost */
-      memcpy (T8_GHOST_ATTR (ghost_cpy, first_attr_info),
-              first_attribute, ghost_att_size);
     }                           /* end num_attributes > 0 */
     /* compute new offsets */
     temp_offset += t8_eclass_num_faces[ghost_cpy->eclass] * (sizeof (t8_gloidx_t) + sizeof (int8_t))    /* offset */
       +T8_ADD_PADDING (t8_eclass_num_faces[ghost_cpy->eclass] * (sizeof (t8_gloidx_t) + sizeof (int8_t)));      /* padding */
     temp_offset_ghost += sizeof (t8_cghost_struct_t);
   }
+  T8_FREE (ghost_block_offset);
   /* Store number of trees and ghosts at the end of send buffer */
   *(t8_locidx_t *) (send_buffer + total_alloc - 2 * sizeof (t8_locidx_t))
     = num_trees;
@@ -1114,6 +1360,8 @@ t8_cmesh_partition_sendloop (t8_cmesh_t cmesh, t8_cmesh_t cmesh_from,
   char               *buffer;
   t8_locidx_t         num_trees, num_ghost_send, range_start, range_end;
   sc_array_t          send_as_ghost;    /* Stores local id's of trees and ghosts that will be send as ghosts */
+  t8_locidx_t        *ghost_dup_of;     /* For each entry of send_as_ghost the index of the first entry with
+                                           identical attribute content, or -1 if the entry stores its own data */
   int8_t             *ghost_flag_send;  /* For each local tree and ghost set to 1 if it is in send_as_ghost */
   const t8_gloidx_t  *offset_from, *offset_to;
 
@@ -1211,10 +1459,13 @@ t8_cmesh_partition_sendloop (t8_cmesh_t cmesh, t8_cmesh_t cmesh_from,
     /* parse through send_as_ghost to compute ghost_neighbor_bytes */
     ghost_neighbor_bytes = t8_partition_compute_gnb (cmesh_from,
                                                      &send_as_ghost);
-    /* parse through send_as_ghost to compute ghost_attribute_bytes and attr_info_bytes */
+    /* parse through send_as_ghost to compute ghost_attribute_bytes and attr_info_bytes.
+     * Ghosts with identical attribute content share one data block. */
+    ghost_dup_of = T8_ALLOC (t8_locidx_t, send_as_ghost.elem_count);
     ghost_attribute_bytes = t8_partition_compute_gab (cmesh_from,
                                                       &send_as_ghost,
-                                                      &ghost_attr_info_bytes);
+                                                      &ghost_attr_info_bytes,
+                                                      ghost_dup_of);
     /* Total number of bytes that we send to the other process */
     total_alloc = num_trees * sizeof (t8_ctree_struct_t) +
       num_ghost_send * sizeof (t8_cghost_struct_t) + ghost_neighbor_bytes +
@@ -1269,8 +1520,9 @@ t8_cmesh_partition_sendloop (t8_cmesh_t cmesh, t8_cmesh_t cmesh_from,
                                   ghost_attr_info_bytes,
                                   ghost_neighbor_bytes,
                                   tree_neighbor_bytes, attr_bytes,
-                                  &send_as_ghost,
+                                  &send_as_ghost, ghost_dup_of,
                                   range_start, range_end, total_alloc, iproc);
+    T8_FREE (ghost_dup_of);
 
     /* If we send to a remote process we post the MPI_Isend here */
     if (iproc != cmesh->mpirank) {
@@ -1281,9 +1533,9 @@ t8_cmesh_partition_sendloop (t8_cmesh_t cmesh, t8_cmesh_t cmesh_from,
                                      total_alloc - 2 * sizeof (t8_locidx_t)),
                    total_alloc, iproc - flag);
         mpiret =
-          sc_MPI_Isend (buffer, total_alloc,
-                        sc_MPI_BYTE, iproc, T8_MPI_PARTITION_CMESH,
-                        comm, *requests + iproc - flag - *send_first);
+          t8_mpi_profile_isend (buffer, total_alloc,
+                                sc_MPI_BYTE, iproc, T8_MPI_PARTITION_CMESH,
+                                comm, *requests + iproc - flag - *send_first, T8_MPI_PROFILE_CMESH_PARTITION);
         SC_CHECK_MPI (mpiret);
         num_send_mpi++;
       }
@@ -1384,9 +1636,9 @@ t8_cmesh_partition_receive_message (t8_cmesh_t cmesh, sc_MPI_Comm comm,
   /* take first tree of part and allocate recv_bytes */
   recv_part->first_tree = T8_ALLOC (char, recv_bytes);
   /* Receive message */
-  mpiret = sc_MPI_Recv (recv_part->first_tree, recv_bytes, sc_MPI_BYTE,
-                        proc_recv, T8_MPI_PARTITION_CMESH, comm,
-                        sc_MPI_STATUS_IGNORE);
+  mpiret = t8_mpi_profile_recv (recv_part->first_tree, recv_bytes, sc_MPI_BYTE,
+                                proc_recv, T8_MPI_PARTITION_CMESH, comm,
+                                sc_MPI_STATUS_IGNORE, T8_MPI_PROFILE_CMESH_PARTITION);
   SC_CHECK_MPI (mpiret);
   /* Read num trees and num ghosts */
   recv_part->num_trees =
@@ -1523,8 +1775,8 @@ t8_cmesh_partition_recvloop (t8_cmesh_t cmesh,
      * The last message can be received via probe */
     while (num_receive > 0) {
       t8_debugf ("Probing for %i messages.\n", num_receive);
-      mpiret = sc_MPI_Probe (sc_MPI_ANY_SOURCE, T8_MPI_PARTITION_CMESH, comm,
-                             &status);
+      mpiret = t8_mpi_profile_probe (sc_MPI_ANY_SOURCE, T8_MPI_PARTITION_CMESH, comm,
+                                     &status, T8_MPI_PROFILE_CMESH_PARTITION);
       SC_CHECK_MPI (mpiret);
       num_receive--;
       /* There is a message to receive */
@@ -1691,8 +1943,8 @@ t8_cmesh_partition_given (t8_cmesh_t cmesh, const struct t8_cmesh *cmesh_from,
   t8_cmesh_partition_recvloop (cmesh, cmesh_from, tree_offset, my_buffer,
                                my_buffer_bytes, comm, fr, lr);
   if (num_send_mpi > 0) {
-    mpiret = sc_MPI_Waitall (num_request_alloc, requests,
-                             sc_MPI_STATUSES_IGNORE);
+    mpiret = t8_mpi_profile_waitall (num_request_alloc, requests,
+                                     sc_MPI_STATUSES_IGNORE, T8_MPI_PROFILE_CMESH_PARTITION);
     SC_CHECK_MPI (mpiret);
   }
 
@@ -1767,6 +2019,13 @@ t8_cmesh_partition (t8_cmesh_t cmesh, sc_MPI_Comm comm)
   cmesh_from = (t8_cmesh_t) cmesh->set_from;
   cmesh->num_trees = cmesh_from->num_trees;
 
+  if (cmesh_from->lazy_attr_resident != NULL) {
+    /* The source cmesh has lazy attributes. All payloads must be resident
+     * before they are shipped to other processes. */
+    t8_cmesh_prefetch_attributes (cmesh_from, 0,
+                                  cmesh_from->num_local_trees);
+  }
+
   /**********************************************/
   /*      Compute local number of trees         */
   /*         and trees per proc array           */
@@ -1920,7 +2179,7 @@ t8_cmesh_offset_random (sc_MPI_Comm comm, t8_gloidx_t num_trees, int shared,
   if (mpirank == 0) {
     t8_debugf ("Random number seed = %u\n", u_seed);
   }
-  mpiret = sc_MPI_Bcast (&u_seed, 1, sc_MPI_INT, 0, comm);
+  mpiret = t8_mpi_profile_bcast (&u_seed, 1, sc_MPI_INT, 0, comm, T8_MPI_PROFILE_CMESH_PARTITION);
   SC_CHECK_MPI (mpiret);
   srand (u_seed);
 
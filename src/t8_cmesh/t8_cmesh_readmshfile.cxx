@@ -161,9 +161,12 @@ t8_msh_file_node_compare (const void *node_a, const void *node_b,
   return Node_a->index == Node_b->index;
 }
 
-/* Reads an open msh-file and checks whether the MeshFormat-Version is supported by t8code or not. */
+/* Reads an open msh-file and checks whether the MeshFormat-Version is
+ * supported by t8code or not.
+ * On output *is_binary is true if the file stores its data in binary form.
+ * Binary files are currently only supported for version 2. */
 static int
-t8_cmesh_check_version_of_msh_file (FILE *fp)
+t8_cmesh_check_version_of_msh_file (FILE *fp, int *is_binary)
 {
   char               *line = (char *) malloc (1024);
   char                first_word[2048] = "\0";
@@ -205,15 +208,17 @@ t8_cmesh_check_version_of_msh_file (FILE *fp)
   }
 
   /* Checks if the file is of Binary-type. */
+  *is_binary = 0;
   if (check_format) {
-    t8_global_errorf
-      ("Incompatible file-type. t8code works with ASCII-type msh-files with the versions:\n");
-    for (int n_versions = 0;
-         n_versions < T8_CMESH_N_SUPPORTED_MSH_FILE_VERSIONS; ++n_versions) {
-      t8_global_errorf ("%d.X\n",
-                        t8_cmesh_supported_msh_file_versions[n_versions]);
+    /* We only support binary files of version 2. */
+    if (version_number != 2) {
+      t8_global_errorf
+        ("Incompatible file-type. t8code only supports binary msh-files of "
+         "version 2.X, this file has version %d.%d.\n", version_number,
+         sub_version_number);
+      goto die_format;
     }
-    goto die_format;
+    *is_binary = 1;
   }
 
   /* Check if MeshFormat-number is compatible. */
@@ -354,6 +359,107 @@ die_node:
   return NULL;
 }
 
+/* Read an open binary .msh file of version 2 and parse the nodes into
+ * a hash table.
+ * In the binary format each node is stored as an int holding the node
+ * index followed by three doubles holding the coordinates, so we can
+ * read the nodes with fread instead of parsing lines. */
+static sc_hash_t   *
+t8_msh_file_2_read_nodes_binary (FILE *fp, t8_locidx_t *num_nodes,
+                                 sc_mempool_t ** node_mempool)
+{
+  t8_msh_file_node_t *Node;
+  sc_hash_t          *node_table = NULL;
+  t8_locidx_t         ln;
+  char               *line = (char *) malloc (1024);
+  char                first_word[2048] = "\0";
+  size_t              linen = 1024;
+  size_t              nread;
+  int                 retval;
+  int                 index;
+  long                lnum_nodes;
+  double              coordinates[3];
+
+  T8_ASSERT (fp != NULL);
+  /* Go to the beginning of the file */
+  fseek (fp, 0, SEEK_SET);
+  /* Search for the line beginning with "$Nodes" */
+  while (!feof (fp) && strcmp (first_word, "$Nodes")) {
+    (void) t8_cmesh_msh_read_next_line (&line, &linen, fp);
+    /* Get the first word of this line */
+    retval = sscanf (line, "%2048s", first_word);
+
+    /* Checking for read/write error */
+    if (retval != 1) {
+      t8_global_errorf ("Premature end of line while reading num nodes.\n");
+      t8_debugf ("The line is %s", line);
+      goto die_node;
+    }
+  }
+
+  /* Read the line containing the number of nodes */
+  (void) t8_cmesh_msh_read_next_line (&line, &linen, fp);
+  retval = sscanf (line, "%li", &lnum_nodes);
+  /* Checking for read/write error */
+  if (retval != 1) {
+    t8_global_errorf ("Premature end of line while reading num nodes.\n");
+    t8_debugf ("The line is %s", line);
+    goto die_node;
+  }
+  *num_nodes = lnum_nodes;
+  /* Check for type conversion error. */
+  T8_ASSERT (*num_nodes == lnum_nodes);
+
+  /* Create the mempool for the nodes */
+  *node_mempool = sc_mempool_new (sizeof (t8_msh_file_node_t));
+  /* Create the hash table */
+  node_table = sc_hash_new (t8_msh_file_node_hash, t8_msh_file_node_compare,
+                            num_nodes, NULL);
+
+  /* Read each node record and add it to the hash table */
+  for (ln = 0; ln < *num_nodes; ln++) {
+    nread = fread (&index, sizeof (int), 1, fp);
+    if (nread != 1) {
+      t8_global_errorf ("Premature end of file while reading nodes.\n");
+      goto die_node;
+    }
+    nread = fread (coordinates, sizeof (double), 3, fp);
+    if (nread != 3) {
+      t8_global_errorf ("Premature end of file while reading nodes.\n");
+      goto die_node;
+    }
+    /* Allocate a new node and fill it */
+    Node = (t8_msh_file_node_t *) sc_mempool_alloc (*node_mempool);
+    Node->index = index;
+    Node->coordinates[0] = coordinates[0];
+    Node->coordinates[1] = coordinates[1];
+    Node->coordinates[2] = coordinates[2];
+    /* Insert the node in the hash table */
+    retval = sc_hash_insert_unique (node_table, Node, NULL);
+    /* If retval is zero then the node was already in the hash table.
+     * This case should not occur. */
+    T8_ASSERT (retval);
+  }
+
+  free (line);
+  t8_debugf ("Successfully read all Nodes.\n");
+  return node_table;
+  /* If everything went well, the function ends here. */
+
+  /* This code is execute when a read/write error occurs */
+die_node:
+  /* If we allocated the hash table, destroy it */
+  if (node_table != NULL) {
+    sc_hash_destroy (node_table);
+    sc_mempool_destroy (*node_mempool);
+    node_mempool = NULL;
+  }
+  /* Free memory */
+  free (line);
+  /* Return NULL as error code */
+  return NULL;
+}
+
 /* Read an open .msh file of version 4 and parse the nodes into a hash table. */
 static sc_hash_t   *
 t8_msh_file_4_read_nodes (FILE *fp,
@@ -529,6 +635,69 @@ die_node:
   return NULL;
 }
 
+/* If the vertices of a tree describe a negative volume, permute them
+ * such that the volume is positive.
+ * For tets we switch 0 and 3.
+ * For prisms we switch 0 and 3, 1 and 4, 2 and 5.
+ * For hexahedra we switch 0 and 4, 1 and 5, 2 and 6, 3 and 7.
+ * For pyramids we switch 0 and 4. */
+static void
+t8_cmesh_msh_correct_negative_volume (t8_eclass_t eclass,
+                                      double *tree_vertices, int num_nodes,
+                                      t8_gloidx_t tree_count)
+{
+  double              temp;
+  int                 num_switches = 0;
+  int                 switch_indices[4] = { 0 };
+  int                 iswitch, i;
+
+  if (!t8_cmesh_tree_vertices_negative_volume (eclass, tree_vertices,
+                                               num_nodes)) {
+    /* The volume is positive, nothing to do */
+    return;
+  }
+  T8_ASSERT (t8_eclass_to_dimension[eclass] == 3);
+  t8_debugf ("Correcting negative volume of tree %li\n", (long) tree_count);
+  switch (eclass) {
+  case T8_ECLASS_TET:
+    /* We switch vertex 0 and vertex 3 */
+    num_switches = 1;
+    switch_indices[0] = 3;
+    break;
+  case T8_ECLASS_PRISM:
+    num_switches = 3;
+    switch_indices[0] = 3;
+    switch_indices[1] = 4;
+    switch_indices[2] = 5;
+    break;
+  case T8_ECLASS_HEX:
+    num_switches = 4;
+    switch_indices[0] = 4;
+    switch_indices[1] = 5;
+    switch_indices[2] = 6;
+    switch_indices[3] = 7;
+    break;
+  case T8_ECLASS_PYRAMID:
+    num_switches = 1;
+    switch_indices[0] = 4;
+    break;
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+
+  for (iswitch = 0; iswitch < num_switches; ++iswitch) {
+    /* We switch vertex 0 + iswitch and vertex switch_indices[iswitch] */
+    for (i = 0; i < 3; i++) {
+      temp = tree_vertices[3 * iswitch + i];
+      tree_vertices[3 * iswitch + i] =
+        tree_vertices[3 * switch_indices[iswitch] + i];
+      tree_vertices[3 * switch_indices[iswitch] + i] = temp;
+    }
+  }
+  T8_ASSERT (!t8_cmesh_tree_vertices_negative_volume
+             (eclass, tree_vertices, num_nodes));
+}
+
 /* fp should be set after the Nodes section, right before the tree section.
  * If vertex_indices is not NULL, it is allocated and will store
  * for each tree the indices of its vertices.
@@ -734,10 +903,174 @@ die_ele:
   return -1;
 }
 
+/* Read the $Elements section of an open binary .msh file of version 2.
+ * fp should be set after the Nodes section, right before the tree section.
+ * In the binary format the elements are stored in runs of equal type as
+ * | ele_type | num_eles | num_tags | followed by num_eles records of
+ * | ele_number | tags | node indices |, all entries ints. Since the
+ * record size of a run is fixed, runs of the wrong dimension can be
+ * skipped with a single fseek.
+ * If vertex_indices is not NULL, it is allocated and will store
+ * for each tree the indices of its vertices.
+ * They are stored as arrays of long ints. */
+static int
+t8_cmesh_msh_file_2_read_eles_binary (t8_cmesh_t cmesh, FILE *fp,
+                                      sc_hash_t * vertices,
+                                      sc_array_t **vertex_indices, int dim)
+{
+  char               *line = (char *) malloc (1024);
+  char                first_word[2048] = "\0";
+  size_t              linen = 1024;
+  size_t              nread;
+  t8_locidx_t         num_trees, tree_loop;
+  t8_gloidx_t         tree_count;
+  t8_eclass_t         eclass;
+  t8_msh_file_node_t  Node, **found_node;
+  long                lnum_trees;
+  int                 retval, i;
+  int                 header[3], ele_type, num_eles_in_run, num_tags;
+  int                 ele_number, node_ints[T8_ECLASS_MAX_CORNERS];
+  int                 num_nodes, record_ints, t8_vertex_num;
+  long                node_indices[8], *stored_indices;
+  double              tree_vertices[24];
+
+  T8_ASSERT (fp != NULL);
+  /* Search for the line beginning with "$Elements" */
+  while (!feof (fp) && strcmp (first_word, "$Elements")) {
+    (void) t8_cmesh_msh_read_next_line (&line, &linen, fp);
+    /* Get the first word of this line */
+    retval = sscanf (line, "%2048s", first_word);
+
+    /* Checking for read/write error */
+    if (retval != 1) {
+      t8_global_errorf ("Premature end of line while reading num trees.\n");
+      t8_debugf ("The line is %s", line);
+      goto die_ele;
+    }
+  }
+
+  /* Read the line containing the number of trees */
+  (void) t8_cmesh_msh_read_next_line (&line, &linen, fp);
+  retval = sscanf (line, "%li", &lnum_trees);
+  /* Checking for read/write error */
+  if (retval != 1) {
+    t8_global_errorf ("Premature end of line while reading num trees.\n");
+    t8_debugf ("The line is %s", line);
+    goto die_ele;
+  }
+  num_trees = lnum_trees;
+  /* Check for type conversion error */
+  T8_ASSERT (num_trees == lnum_trees);
+
+  if (vertex_indices != NULL) {
+    /* We store a list of the vertex indices for each element */
+    *vertex_indices = sc_array_new (sizeof (long *));
+  }
+  tree_count = 0;               /* The index of the next tree to insert */
+  for (tree_loop = 0; tree_loop < num_trees;) {
+    /* Read the header of the next run of elements of equal type */
+    nread = fread (header, sizeof (int), 3, fp);
+    if (nread != 3) {
+      t8_global_errorf ("Premature end of file while reading trees.\n");
+      goto die_ele;
+    }
+    ele_type = header[0];
+    num_eles_in_run = header[1];
+    num_tags = header[2];
+    /* Check if the tree type is supported */
+    if (ele_type > T8_NUM_GMSH_ELEM_CLASSES || ele_type < 0
+        || t8_msh_tree_type_to_eclass[ele_type] == T8_ECLASS_COUNT) {
+      t8_global_errorf ("tree type %i is not supported by t8code.\n",
+                        ele_type);
+      goto die_ele;
+    }
+    eclass = t8_msh_tree_type_to_eclass[ele_type];
+    T8_ASSERT (eclass != T8_ECLASS_COUNT);
+    num_nodes = t8_eclass_num_vertices[eclass];
+    /* Each record stores the element number, the tags and the nodes */
+    record_ints = 1 + num_tags + num_nodes;
+    if (num_tags < 0 || num_eles_in_run <= 0
+        || num_eles_in_run > num_trees - tree_loop) {
+      t8_global_errorf ("Error while reading element run header.\n");
+      goto die_ele;
+    }
+    tree_loop += num_eles_in_run;
+    if (t8_eclass_to_dimension[eclass] != dim) {
+      /* The trees in this run are not of the correct dimension.
+       * Thus, we skip them with a single seek. */
+      retval = fseek (fp, (long) num_eles_in_run * record_ints
+                      * sizeof (int), SEEK_CUR);
+      if (retval != 0) {
+        t8_global_errorf ("Premature end of file while reading trees.\n");
+        goto die_ele;
+      }
+      continue;
+    }
+    for (i = 0; i < num_eles_in_run; i++, tree_count++) {
+      /* Read the element number and skip the tags of this record */
+      nread = fread (&ele_number, sizeof (int), 1, fp);
+      if (nread != 1
+          || fseek (fp, (long) num_tags * sizeof (int), SEEK_CUR) != 0) {
+        t8_global_errorf ("Premature end of file while reading trees.\n");
+        goto die_ele;
+      }
+      /* Read the node indices of this record */
+      nread = fread (node_ints, sizeof (int), num_nodes, fp);
+      if (nread != (size_t) num_nodes) {
+        t8_global_errorf ("Premature end of file while reading trees.\n");
+        goto die_ele;
+      }
+      t8_cmesh_set_tree_class (cmesh, tree_count, eclass);
+      for (int inode = 0; inode < num_nodes; inode++) {
+        node_indices[inode] = node_ints[inode];
+      }
+      /* Now the nodes are read and we get their coordinates from
+       * the stored nodes */
+      for (int inode = 0; inode < num_nodes; inode++) {
+        Node.index = node_indices[inode];
+        sc_hash_lookup (vertices, (void *) &Node, (void ***) &found_node);
+        /* Add node coordinates to the tree vertices */
+        t8_vertex_num = t8_msh_tree_vertex_to_t8_vertex_num[eclass][inode];
+        tree_vertices[3 * t8_vertex_num] = (*found_node)->coordinates[0];
+        tree_vertices[3 * t8_vertex_num + 1] = (*found_node)->coordinates[1];
+        tree_vertices[3 * t8_vertex_num + 2] = (*found_node)->coordinates[2];
+      }
+      /* Detect and correct negative volumes */
+      t8_cmesh_msh_correct_negative_volume (eclass, tree_vertices,
+                                            num_nodes, tree_count);
+      /* Set the vertices of this tree */
+      t8_cmesh_set_tree_vertices (cmesh, tree_count, tree_vertices,
+                                  num_nodes);
+      /* If wished, we store the vertex indices of that tree. */
+      if (vertex_indices != NULL) {
+        /* Allocate memory for the indices */
+        stored_indices = T8_ALLOC (long, num_nodes);
+        for (int inode = 0; inode < num_nodes; inode++) {
+          /* Get the i-th node index in t8code order and store it. */
+          stored_indices[inode] =
+            node_indices[t8_vertex_to_msh_vertex_num[eclass][inode]];
+        }
+        /* Set the index array as a new entry in the array */
+        *(long **) sc_array_push (*vertex_indices) = stored_indices;
+      }
+    }
+  }
+  free (line);
+  if (tree_count == 0) {
+    t8_global_errorf ("Warning: No %iD elements found in msh file.\n", dim);
+  }
+  return 0;
+die_ele:
+  /* Error handling */
+  free (line);
+  t8_cmesh_destroy (&cmesh);
+  return -1;
+}
+
 /* fp should be set after the Nodes section, right before the tree section.
  * If vertex_indices is not NULL, it is allocated and will store
  * for each tree the indices of its vertices.
- * They are stored as arrays of long ints. 
+ * They are stored as arrays of long ints.
  * If occ geometry is used, the geometry is passed as a pointer here.
  * We cannot access this geometry over the cmesh interface since the cmesh
  * is not committed yet. */
@@ -1760,6 +2093,237 @@ t8_cmesh_msh_file_find_neighbors (t8_cmesh_t cmesh,
   t8_debugf ("Done finding tree neighbors.\n");
 }
 
+/* The suffix of the sidecar index file that caches the parsed stash of
+ * a .msh file, appended to the full .msh file name. */
+#define T8_MSH_INDEX_SUFFIX ".t8idx"
+
+/* The fixed-size header of a sidecar index file. The index stores the
+ * stash entries in host byte order and with the host struct sizes, so
+ * it is only valid on the architecture that wrote it; the struct size
+ * fields below reject indices of a different architecture and the hash
+ * rejects indices of an outdated or different .msh file. */
+typedef struct t8_msh_index_header
+{
+  char                magic[8]; /* "t8mshix" and a terminating zero */
+  int                 version;  /* The index format version */
+  int                 dim;      /* The dimension the mesh was read with */
+  int                 use_occ;  /* Whether the occ attributes were generated */
+  int                 gloidx_bytes;     /* sizeof (t8_gloidx_t) of the writer */
+  int                 class_bytes;      /* sizeof (t8_stash_class_struct_t) */
+  int                 joinface_bytes;   /* sizeof (t8_stash_joinface_struct_t) */
+  uint64_t            msh_hash; /* The content hash of the .msh file */
+  uint64_t            num_classes;      /* The number of class entries */
+  uint64_t            num_joinfaces;    /* The number of joinface entries */
+  uint64_t            num_attributes;   /* The number of attribute entries */
+  uint64_t            attr_bytes;       /* The total attribute payload bytes */
+} t8_msh_index_header_t;
+
+/* The index format version. Bump when the layout changes. */
+#define T8_MSH_INDEX_VERSION 1
+
+/* One attribute record of a sidecar index file. The payloads of all
+ * attributes follow the records, concatenated in record order. */
+typedef struct t8_msh_index_attr
+{
+  t8_gloidx_t         id;       /* The global tree id of the attribute */
+  uint64_t            attr_size;        /* The payload size in bytes */
+  int                 package_id;       /* The package id of the attribute */
+  int                 key;      /* The key of the attribute */
+} t8_msh_index_attr_t;
+
+/* Compute a 64 bit FNV-1a hash of the contents of a file.
+ * Returns 0 if the file could not be read. Hashing streams the file
+ * once without parsing, which is the cost of an index validation. */
+static uint64_t
+t8_msh_index_file_hash (const char *filename)
+{
+  FILE               *fp;
+  unsigned char       buffer[65536];
+  size_t              bytes_read, ibyte;
+  uint64_t            hash = UINT64_C (14695981039346656037);
+
+  fp = fopen (filename, "rb");
+  if (fp == NULL) {
+    return 0;
+  }
+  while ((bytes_read = fread (buffer, 1, sizeof (buffer), fp)) > 0) {
+    for (ibyte = 0; ibyte < bytes_read; ibyte++) {
+      hash = (hash ^ buffer[ibyte]) * UINT64_C (1099511628211);
+    }
+  }
+  fclose (fp);
+  /* 0 marks failure, so never return it for a readable file */
+  return hash != 0 ? hash : 1;
+}
+
+/* Write the sidecar index for a parsed .msh file: the header followed by
+ * the raw class and joinface entries of the stash, the attribute records
+ * and the concatenated attribute payloads. Failures only cost the cache,
+ * so they are logged and the partial file is removed. */
+static void
+t8_cmesh_msh_index_write (const char *fileprefix, int dim, int use_occ,
+                          uint64_t msh_hash, t8_stash_t stash)
+{
+  t8_msh_index_header_t header;
+  t8_msh_index_attr_t record;
+  t8_stash_attribute_struct_t *attribute;
+  char                index_file[BUFSIZ];
+  FILE               *fp;
+  size_t              si;
+  int                 failed = 0;
+
+  snprintf (index_file, BUFSIZ, "%s.msh" T8_MSH_INDEX_SUFFIX, fileprefix);
+  fp = fopen (index_file, "wb");
+  if (fp == NULL) {
+    t8_debugf ("Could not write msh index file %s.\n", index_file);
+    return;
+  }
+  memset (&header, 0, sizeof (header));
+  strncpy (header.magic, "t8mshix", sizeof (header.magic));
+  header.version = T8_MSH_INDEX_VERSION;
+  header.dim = dim;
+  header.use_occ = use_occ;
+  header.gloidx_bytes = (int) sizeof (t8_gloidx_t);
+  header.class_bytes = (int) sizeof (t8_stash_class_struct_t);
+  header.joinface_bytes = (int) sizeof (t8_stash_joinface_struct_t);
+  header.msh_hash = msh_hash;
+  header.num_classes = stash->classes.elem_count;
+  header.num_joinfaces = stash->joinfaces.elem_count;
+  header.num_attributes = stash->attributes.elem_count;
+  for (si = 0; si < stash->attributes.elem_count; si++) {
+    attribute = (t8_stash_attribute_struct_t *)
+      sc_array_index (&stash->attributes, si);
+    header.attr_bytes += attribute->attr_size;
+  }
+  failed = fwrite (&header, sizeof (header), 1, fp) != 1;
+  if (!failed && stash->classes.elem_count > 0) {
+    failed = fwrite (stash->classes.array,
+                     sizeof (t8_stash_class_struct_t),
+                     stash->classes.elem_count,
+                     fp) != stash->classes.elem_count;
+  }
+  if (!failed && stash->joinfaces.elem_count > 0) {
+    failed = fwrite (stash->joinfaces.array,
+                     sizeof (t8_stash_joinface_struct_t),
+                     stash->joinfaces.elem_count,
+                     fp) != stash->joinfaces.elem_count;
+  }
+  for (si = 0; !failed && si < stash->attributes.elem_count; si++) {
+    attribute = (t8_stash_attribute_struct_t *)
+      sc_array_index (&stash->attributes, si);
+    record.id = attribute->id;
+    record.attr_size = attribute->attr_size;
+    record.package_id = attribute->package_id;
+    record.key = attribute->key;
+    failed = fwrite (&record, sizeof (record), 1, fp) != 1;
+  }
+  for (si = 0; !failed && si < stash->attributes.elem_count; si++) {
+    attribute = (t8_stash_attribute_struct_t *)
+      sc_array_index (&stash->attributes, si);
+    if (attribute->attr_size > 0) {
+      failed = fwrite (attribute->attr_data, 1, attribute->attr_size,
+                       fp) != attribute->attr_size;
+    }
+  }
+  if (fclose (fp) != 0) {
+    failed = 1;
+  }
+  if (failed) {
+    t8_debugf ("Could not write msh index file %s.\n", index_file);
+    remove (index_file);
+  }
+  else {
+    t8_debugf ("Wrote msh index file %s.\n", index_file);
+  }
+}
+
+/* Try to fill the stash of \a cmesh from the sidecar index of a .msh
+ * file. The index is used only if its header matches the requested
+ * read parameters, the host struct layout and the content hash
+ * \a msh_hash of the current .msh file. All data is read into temporary
+ * buffers before the stash is touched, so a truncated or corrupt index
+ * leaves the stash empty and the caller falls back to parsing.
+ * Returns true if the stash was filled from the index. */
+static int
+t8_cmesh_msh_index_read (t8_cmesh_t cmesh, const char *fileprefix, int dim,
+                         int use_occ, uint64_t msh_hash)
+{
+  t8_msh_index_header_t header;
+  t8_msh_index_attr_t *records = NULL;
+  t8_stash_class_struct_t *classes = NULL;
+  t8_stash_joinface_struct_t *joinfaces = NULL;
+  char               *payloads = NULL, *payload;
+  char                index_file[BUFSIZ];
+  FILE               *fp;
+  size_t              si;
+  int                 failed;
+
+  snprintf (index_file, BUFSIZ, "%s.msh" T8_MSH_INDEX_SUFFIX, fileprefix);
+  fp = fopen (index_file, "rb");
+  if (fp == NULL) {
+    /* No index was written yet */
+    return 0;
+  }
+  failed = fread (&header, sizeof (header), 1, fp) != 1;
+  if (failed || strncmp (header.magic, "t8mshix", 8) != 0
+      || header.version != T8_MSH_INDEX_VERSION
+      || header.dim != dim || header.use_occ != use_occ
+      || header.gloidx_bytes != (int) sizeof (t8_gloidx_t)
+      || header.class_bytes != (int) sizeof (t8_stash_class_struct_t)
+      || header.joinface_bytes != (int) sizeof (t8_stash_joinface_struct_t)
+      || header.msh_hash != msh_hash) {
+    /* The index belongs to another file, architecture or read setup */
+    t8_debugf ("Ignoring stale msh index file %s.\n", index_file);
+    fclose (fp);
+    return 0;
+  }
+  /* Read all entries into temporary buffers */
+  classes = T8_ALLOC (t8_stash_class_struct_t, header.num_classes);
+  joinfaces = T8_ALLOC (t8_stash_joinface_struct_t, header.num_joinfaces);
+  records = T8_ALLOC (t8_msh_index_attr_t, header.num_attributes);
+  payloads = T8_ALLOC (char, header.attr_bytes);
+  if (header.num_classes > 0) {
+    failed = fread (classes, sizeof (t8_stash_class_struct_t),
+                    header.num_classes, fp) != header.num_classes;
+  }
+  if (!failed && header.num_joinfaces > 0) {
+    failed = fread (joinfaces, sizeof (t8_stash_joinface_struct_t),
+                    header.num_joinfaces, fp) != header.num_joinfaces;
+  }
+  if (!failed && header.num_attributes > 0) {
+    failed = fread (records, sizeof (t8_msh_index_attr_t),
+                    header.num_attributes, fp) != header.num_attributes;
+  }
+  if (!failed && header.attr_bytes > 0) {
+    failed = fread (payloads, 1, header.attr_bytes, fp) != header.attr_bytes;
+  }
+  fclose (fp);
+  if (!failed) {
+    /* All data arrived; fill the stash in bulk */
+    sc_array_resize (&cmesh->stash->classes, header.num_classes);
+    memcpy (cmesh->stash->classes.array, classes,
+            header.num_classes * sizeof (t8_stash_class_struct_t));
+    sc_array_resize (&cmesh->stash->joinfaces, header.num_joinfaces);
+    memcpy (cmesh->stash->joinfaces.array, joinfaces,
+            header.num_joinfaces * sizeof (t8_stash_joinface_struct_t));
+    payload = payloads;
+    for (si = 0; si < header.num_attributes; si++) {
+      t8_stash_add_attribute (cmesh->stash, records[si].id,
+                              records[si].package_id, records[si].key,
+                              (size_t) records[si].attr_size, payload, 1);
+      payload += records[si].attr_size;
+    }
+  }
+  else {
+    t8_debugf ("Ignoring truncated msh index file %s.\n", index_file);
+  }
+  T8_FREE (classes);
+  T8_FREE (joinfaces);
+  T8_FREE (records);
+  T8_FREE (payloads);
+  return !failed;
+}
+
 /* This part should be callable from C */
 T8_EXTERN_C_BEGIN ();
 
@@ -1817,6 +2381,9 @@ t8_cmesh_from_msh_file (const char *fileprefix, int partition,
   t8_gloidx_t         num_trees, first_tree, last_tree = -1;
   int                 main_proc_read_successful = 0;
   int                 msh_version;
+  int                 is_binary = 0;
+  uint64_t            msh_hash = 0;
+  int                 used_index = 0;
   const t8_geometry_c *occ_geometry = NULL;
   const t8_geometry_c *linear_geometry = NULL;
 
@@ -1851,6 +2418,19 @@ t8_cmesh_from_msh_file (const char *fileprefix, int partition,
 
   if (!partition || mpirank == main_proc) {
     snprintf (current_file, BUFSIZ, "%s.msh", fileprefix);
+    /* Try the sidecar index of an earlier run before parsing the text.
+     * The hash streams the .msh file once and validates the index
+     * against its current contents. */
+    msh_hash = t8_msh_index_file_hash (current_file);
+    if (msh_hash != 0
+        && t8_cmesh_msh_index_read (cmesh, fileprefix, dim,
+                                    use_occ_geometry, msh_hash)) {
+      t8_debugf ("Filled cmesh from msh index file, skipping the parse.\n");
+      main_proc_read_successful = 1;
+      used_index = 1;
+    }
+  }
+  if ((!partition || mpirank == main_proc) && !used_index) {
     /* Open the file */
     t8_debugf ("Opening file %s\n", current_file);
     file = fopen (current_file, "r");
@@ -1867,7 +2447,7 @@ t8_cmesh_from_msh_file (const char *fileprefix, int partition,
       return NULL;
     }
     /* Check if msh-file version is compatible. */
-    msh_version = t8_cmesh_check_version_of_msh_file (file);
+    msh_version = t8_cmesh_check_version_of_msh_file (file, &is_binary);
     if (msh_version < 1) {
       /* If reading the MeshFormat-number failed or the version is incompatible, close the file */
       fclose (file);
@@ -1900,10 +2480,19 @@ t8_cmesh_from_msh_file (const char *fileprefix, int partition,
         }
         return NULL;
       }
-      vertices =
-        t8_msh_file_2_read_nodes (file, &num_vertices, &node_mempool);
-      t8_cmesh_msh_file_2_read_eles (cmesh, file, vertices, &vertex_indices,
-                                     dim);
+      if (is_binary) {
+        vertices =
+          t8_msh_file_2_read_nodes_binary (file, &num_vertices,
+                                           &node_mempool);
+        t8_cmesh_msh_file_2_read_eles_binary (cmesh, file, vertices,
+                                              &vertex_indices, dim);
+      }
+      else {
+        vertices =
+          t8_msh_file_2_read_nodes (file, &num_vertices, &node_mempool);
+        t8_cmesh_msh_file_2_read_eles (cmesh, file, vertices, &vertex_indices,
+                                       dim);
+      }
       break;
 
     case 4:
@@ -1930,6 +2519,12 @@ t8_cmesh_from_msh_file (const char *fileprefix, int partition,
     }
     sc_array_destroy (vertex_indices);
 
+    if (msh_hash != 0) {
+      /* Cache the parsed stash, so the next read of this file skips the
+       * parse. Failures only cost the cache and are not fatal. */
+      t8_cmesh_msh_index_write (fileprefix, dim, use_occ_geometry, msh_hash,
+                                cmesh->stash);
+    }
     main_proc_read_successful = 1;
   }
 
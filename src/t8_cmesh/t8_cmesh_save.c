@@ -37,6 +37,9 @@
 #include <t8_geometry/t8_geometry.h>
 #include <t8_geometry/t8_geometry_base.h>
 #include <t8_geometry/t8_geometry_implementations/t8_geometry_linear.h>
+#ifdef T8_HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
 
 /* This macro is called to check a condition and if not fulfilled
  * close the file and exit the function */
@@ -45,6 +48,50 @@
               "Line %i in file %s\n", #x, __LINE__, __FILE__);\
               fclose (fp); return 0;}
 
+/* The header of a binary cmesh file. It is written and read as raw bytes,
+ * thus a file can only be loaded by a build with the same ABI as the build
+ * that saved it. We store the sizes of the relevant datatypes in the header
+ * and check them on load in order to detect mismatches. */
+typedef struct t8_cmesh_binary_header
+{
+  char                magic[8];       /* T8_CMESH_BINARY_MAGIC */
+  int                 format;         /* T8_CMESH_BINARY_FORMAT */
+  int                 sizeof_locidx;  /* sizeof (t8_locidx_t) */
+  int                 sizeof_gloidx;  /* sizeof (t8_gloidx_t) */
+  int                 sizeof_int;     /* sizeof (int) */
+  int                 sizeof_ctree;   /* sizeof (t8_ctree_struct_t) */
+  int                 sizeof_cghost;  /* sizeof (t8_cghost_struct_t) */
+  int                 sizeof_attribute_info;      /* sizeof (t8_attribute_info_struct_t) */
+  int                 set_partition;
+  int                 mpirank;
+  int                 mpisize;
+  int                 dimension;
+  t8_gloidx_t         num_trees;
+  t8_locidx_t         num_local_trees;
+  t8_locidx_t         num_ghosts;
+  t8_locidx_t         num_local_trees_per_eclass[T8_ECLASS_COUNT];
+  t8_gloidx_t         num_trees_per_eclass[T8_ECLASS_COUNT];
+  t8_gloidx_t         first_tree;
+  int                 first_tree_shared;
+  int                 num_parts;      /* The number of parts of the trees structure */
+  size_t              payload_bytes;  /* The total number of bytes of all part data blocks */
+  size_t              payload_offset; /* The file offset of the first part data block */
+} t8_cmesh_binary_header_t;
+
+/* The per part metadata of a binary cmesh file. The part data itself is
+ * stored as one contiguous block at payload_offset + byte_offset. Since all
+ * offsets inside the block are relative to the respective tree or ghost
+ * (\see t8_cmesh_trees.h), the block can be used in place after loading. */
+typedef struct t8_cmesh_binary_part
+{
+  t8_locidx_t         first_tree_id;
+  t8_locidx_t         first_ghost_id;
+  t8_locidx_t         num_trees;
+  t8_locidx_t         num_ghosts;
+  size_t              byte_count;     /* The number of bytes of this part's data */
+  size_t              byte_offset;    /* The offset of this part's data within the payload */
+} t8_cmesh_binary_part_t;
+
 /* Write the neighbor data of all ghosts */
 static int
 t8_cmesh_save_ghost_neighbors (t8_cmesh_t cmesh, FILE *fp)
@@ -556,6 +603,9 @@ t8_cmesh_save (t8_cmesh_t cmesh, const char *fileprefix)
     return 1;
   }
 
+  /* With lazy attributes all payloads must be resident before writing */
+  t8_cmesh_prefetch_attributes (cmesh, 0, cmesh->num_local_trees);
+
   /* Check that the only registered geometry is the linear geometry and
    * that this geometry is used for all trees. */
   if (t8_geom_handler_get_num_geometries (cmesh->geometry_handler) == 1) {
@@ -623,6 +673,134 @@ t8_cmesh_save (t8_cmesh_t cmesh, const char *fileprefix)
   return 1;
 }
 
+int
+t8_cmesh_save_binary (t8_cmesh_t cmesh, const char *fileprefix)
+{
+  FILE               *fp;
+  char                filename[BUFSIZ];
+  t8_cmesh_binary_header_t header;
+  t8_cmesh_binary_part_t part_entry;
+  t8_part_tree_t      part;
+  size_t              byte_offset, payload_bytes;
+  size_t              ret;
+  int                 ipart, num_parts, eclass;
+  int                 has_linear_geom = 0;
+
+  T8_ASSERT (t8_cmesh_is_committed (cmesh));
+  if (!cmesh->set_partition && cmesh->mpirank != 0) {
+    /* If the cmesh is replicated, only rank 0 writes it */
+    return 1;
+  }
+
+  /* With lazy attributes all payloads must be resident before writing */
+  t8_cmesh_prefetch_attributes (cmesh, 0, cmesh->num_local_trees);
+
+  /* Check that the only registered geometry is the linear geometry and
+   * that this geometry is used for all trees. */
+  if (t8_geom_handler_get_num_geometries (cmesh->geometry_handler) == 1) {
+    const t8_geometry_c *geom =
+      t8_geom_handler_get_unique_geometry (cmesh->geometry_handler);
+    t8_geometry_c      *linear_geom =
+      t8_geometry_linear_new (cmesh->dimension);
+
+    if (!strcmp (t8_geom_get_name (geom), t8_geom_get_name (linear_geom))) {
+      has_linear_geom = 1;
+    }
+    t8_geometry_linear_destroy (&linear_geom);
+  }
+  if (!has_linear_geom) {
+    t8_errorf
+      ("Error when saving cmesh. Cmesh does not have linear geometry.\n");
+    return 0;
+  }
+
+  num_parts = (int) t8_cmesh_trees_get_numproc (cmesh->trees);
+  /* Compute the total number of payload bytes */
+  payload_bytes = 0;
+  for (ipart = 0; ipart < num_parts; ipart++) {
+    payload_bytes += t8_cmesh_trees_get_part_size (cmesh->trees, ipart);
+  }
+
+  /* Fill the header */
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, T8_CMESH_BINARY_MAGIC,
+          strlen (T8_CMESH_BINARY_MAGIC));
+  header.format = T8_CMESH_BINARY_FORMAT;
+  header.sizeof_locidx = (int) sizeof (t8_locidx_t);
+  header.sizeof_gloidx = (int) sizeof (t8_gloidx_t);
+  header.sizeof_int = (int) sizeof (int);
+  header.sizeof_ctree = (int) sizeof (t8_ctree_struct_t);
+  header.sizeof_cghost = (int) sizeof (t8_cghost_struct_t);
+  header.sizeof_attribute_info = (int) sizeof (t8_attribute_info_struct_t);
+  header.set_partition = cmesh->set_partition != 0;
+  header.mpirank = cmesh->mpirank;
+  header.mpisize = cmesh->mpisize;
+  header.dimension = cmesh->dimension;
+  header.num_trees = cmesh->num_trees;
+  header.num_local_trees = cmesh->num_local_trees;
+  header.num_ghosts = cmesh->num_ghosts;
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; eclass++) {
+    header.num_local_trees_per_eclass[eclass] =
+      cmesh->num_local_trees_per_eclass[eclass];
+    header.num_trees_per_eclass[eclass] = cmesh->num_trees_per_eclass[eclass];
+  }
+  header.first_tree = cmesh->first_tree;
+  header.first_tree_shared = cmesh->first_tree_shared;
+  header.num_parts = num_parts;
+  header.payload_bytes = payload_bytes;
+  /* The payload directly follows the header, the part table and the
+   * tree_to_proc and ghost_to_proc arrays */
+  header.payload_offset = sizeof (header)
+    + num_parts * sizeof (t8_cmesh_binary_part_t)
+    + (cmesh->num_local_trees + cmesh->num_ghosts) * sizeof (int);
+
+  /* Create the output filename as fileprefix_RANK.bcmesh,
+   * where we write RANK with 4 significant figures. */
+  snprintf (filename, BUFSIZ, "%s_%04i.bcmesh", fileprefix, cmesh->mpirank);
+  fp = fopen (filename, "wb");
+  if (fp == NULL) {
+    t8_errorf ("Error when opening file %s.\n", filename);
+    return 0;
+  }
+  ret = fwrite (&header, sizeof (header), 1, fp);
+  T8_SAVE_CHECK_CLOSE (ret == 1, fp);
+  /* Write the part table */
+  byte_offset = 0;
+  for (ipart = 0; ipart < num_parts; ipart++) {
+    part = t8_cmesh_trees_get_part (cmesh->trees, ipart);
+    part_entry.first_tree_id = part->first_tree_id;
+    part_entry.first_ghost_id = part->first_ghost_id;
+    part_entry.num_trees = part->num_trees;
+    part_entry.num_ghosts = part->num_ghosts;
+    part_entry.byte_count = t8_cmesh_trees_get_part_size (cmesh->trees,
+                                                          ipart);
+    part_entry.byte_offset = byte_offset;
+    byte_offset += part_entry.byte_count;
+    ret = fwrite (&part_entry, sizeof (part_entry), 1, fp);
+    T8_SAVE_CHECK_CLOSE (ret == 1, fp);
+  }
+  /* Write the tree_to_proc and ghost_to_proc arrays */
+  if (cmesh->num_local_trees > 0) {
+    ret = fwrite (cmesh->trees->tree_to_proc, sizeof (int),
+                  cmesh->num_local_trees, fp);
+    T8_SAVE_CHECK_CLOSE (ret == (size_t) cmesh->num_local_trees, fp);
+  }
+  if (cmesh->num_ghosts > 0) {
+    ret = fwrite (cmesh->trees->ghost_to_proc, sizeof (int),
+                  cmesh->num_ghosts, fp);
+    T8_SAVE_CHECK_CLOSE (ret == (size_t) cmesh->num_ghosts, fp);
+  }
+  /* Write the part data blocks in their in-memory layout */
+  for (ipart = 0; ipart < num_parts; ipart++) {
+    part = t8_cmesh_trees_get_part (cmesh->trees, ipart);
+    byte_offset = t8_cmesh_trees_get_part_size (cmesh->trees, ipart);
+    ret = fwrite (part->first_tree, 1, byte_offset, fp);
+    T8_SAVE_CHECK_CLOSE (ret == byte_offset, fp);
+  }
+  fclose (fp);
+  return 1;
+}
+
 #undef T8_SAVE_CHECK_CLOSE
 
 t8_cmesh_t
@@ -686,6 +864,187 @@ t8_cmesh_load (const char *filename, sc_MPI_Comm comm)
   return cmesh;
 }
 
+/* This macro is called to check a condition and if not fulfilled
+ * free the part table, close the file and exit the function */
+#define T8_LOAD_BINARY_CHECK_CLOSE(x, part_table, fp) \
+  if (!(x)) { t8_errorf ("file i/o error. Condition %s not fulfilled. "\
+              "Line %i in file %s\n", #x, __LINE__, __FILE__);\
+              T8_FREE (part_table); fclose (fp); return 0;}
+
+/* Read the trees of a binary cmesh file into a cmesh.
+ * If possible, the part data is mapped via mmap and used in place,
+ * otherwise it is read into allocated memory.
+ * On error the file is closed and 0 is returned. */
+static int
+t8_cmesh_load_binary_data (t8_cmesh_t cmesh, FILE *fp)
+{
+  t8_cmesh_binary_header_t header;
+  t8_cmesh_binary_part_t *part_table = NULL;
+  t8_part_tree_t      part;
+  char               *payload = NULL;
+  size_t              ret;
+  int                 ipart, eclass;
+
+  /* Read and check the header */
+  ret = fread (&header, sizeof (header), 1, fp);
+  T8_LOAD_BINARY_CHECK_CLOSE (ret == 1, part_table, fp);
+  T8_LOAD_BINARY_CHECK_CLOSE (!memcmp (header.magic, T8_CMESH_BINARY_MAGIC,
+                                       strlen (T8_CMESH_BINARY_MAGIC)),
+                              part_table, fp);
+  if (header.format != T8_CMESH_BINARY_FORMAT) {
+    t8_errorf
+      ("Input file is in an old format that we cannot read anymore.\n");
+    fclose (fp);
+    return 0;
+  }
+  /* The part data is stored in its in-memory layout. Check that the
+   * layout of this build matches the one that wrote the file. */
+  T8_LOAD_BINARY_CHECK_CLOSE (header.sizeof_locidx == sizeof (t8_locidx_t)
+                              && header.sizeof_gloidx ==
+                              sizeof (t8_gloidx_t)
+                              && header.sizeof_int == sizeof (int)
+                              && header.sizeof_ctree ==
+                              sizeof (t8_ctree_struct_t)
+                              && header.sizeof_cghost ==
+                              sizeof (t8_cghost_struct_t)
+                              && header.sizeof_attribute_info ==
+                              sizeof (t8_attribute_info_struct_t),
+                              part_table, fp);
+  T8_LOAD_BINARY_CHECK_CLOSE (0 <= header.dimension && header.dimension <= 3,
+                              part_table, fp);
+  T8_LOAD_BINARY_CHECK_CLOSE (0 <= header.num_local_trees
+                              && header.num_local_trees <= header.num_trees,
+                              part_table, fp);
+  T8_LOAD_BINARY_CHECK_CLOSE (0 <= header.num_ghosts
+                              && header.num_ghosts < header.num_trees + 1,
+                              part_table, fp);
+  T8_LOAD_BINARY_CHECK_CLOSE (header.num_parts >= 0, part_table, fp);
+
+  /* Copy the metadata into the cmesh */
+  cmesh->set_partition = header.set_partition;
+  cmesh->dimension = header.dimension;
+  cmesh->num_trees = header.num_trees;
+  cmesh->num_local_trees = header.num_local_trees;
+  cmesh->num_ghosts = header.num_ghosts;
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; eclass++) {
+    cmesh->num_local_trees_per_eclass[eclass] =
+      header.num_local_trees_per_eclass[eclass];
+    cmesh->num_trees_per_eclass[eclass] = header.num_trees_per_eclass[eclass];
+  }
+  cmesh->first_tree = header.first_tree;
+  cmesh->first_tree_shared = header.first_tree_shared;
+
+  /* Read the part table and the tree_to_proc and ghost_to_proc arrays */
+  t8_cmesh_trees_init (&cmesh->trees, header.num_parts,
+                       cmesh->num_local_trees, cmesh->num_ghosts);
+  part_table = T8_ALLOC (t8_cmesh_binary_part_t, header.num_parts);
+  ret = fread (part_table, sizeof (t8_cmesh_binary_part_t), header.num_parts,
+               fp);
+  T8_LOAD_BINARY_CHECK_CLOSE (ret == (size_t) header.num_parts, part_table,
+                              fp);
+  if (cmesh->num_local_trees > 0) {
+    ret = fread (cmesh->trees->tree_to_proc, sizeof (int),
+                 cmesh->num_local_trees, fp);
+    T8_LOAD_BINARY_CHECK_CLOSE (ret == (size_t) cmesh->num_local_trees,
+                                part_table, fp);
+  }
+  if (cmesh->num_ghosts > 0) {
+    ret = fread (cmesh->trees->ghost_to_proc, sizeof (int),
+                 cmesh->num_ghosts, fp);
+    T8_LOAD_BINARY_CHECK_CLOSE (ret == (size_t) cmesh->num_ghosts,
+                                part_table, fp);
+  }
+
+  /* Initialize all parts. With alloc = 0 no part data is allocated,
+   * we attach the data below. */
+  for (ipart = 0; ipart < header.num_parts; ipart++) {
+    t8_cmesh_trees_start_part (cmesh->trees, ipart,
+                               part_table[ipart].first_tree_id,
+                               part_table[ipart].num_trees,
+                               part_table[ipart].first_ghost_id,
+                               part_table[ipart].num_ghosts, 0);
+  }
+
+#ifdef T8_HAVE_SYS_MMAN_H
+  {
+    /* Map the whole file. With MAP_PRIVATE the pages are paged in on
+     * demand and modifications are kept in memory and never written
+     * back to the file. */
+    const size_t        map_size =
+      header.payload_offset + header.payload_bytes;
+    void               *map = mmap (NULL, map_size, PROT_READ | PROT_WRITE,
+                                    MAP_PRIVATE, fileno (fp), 0);
+
+    if (map != MAP_FAILED) {
+      cmesh->trees->mmap_data = map;
+      cmesh->trees->mmap_size = map_size;
+      payload = (char *) map + header.payload_offset;
+    }
+  }
+#endif
+  for (ipart = 0; ipart < header.num_parts; ipart++) {
+    part = t8_cmesh_trees_get_part (cmesh->trees, ipart);
+    if (payload != NULL) {
+      /* Use the mapped part data in place */
+      part->first_tree = payload + part_table[ipart].byte_offset;
+    }
+    else {
+      /* mmap is not available or failed, read the part data instead */
+      part->first_tree = T8_ALLOC (char, part_table[ipart].byte_count);
+      ret = fseek (fp, header.payload_offset + part_table[ipart].byte_offset,
+                   SEEK_SET);
+      T8_LOAD_BINARY_CHECK_CLOSE (ret == 0, part_table, fp);
+      ret = fread (part->first_tree, 1, part_table[ipart].byte_count, fp);
+      T8_LOAD_BINARY_CHECK_CLOSE (ret == part_table[ipart].byte_count,
+                                  part_table, fp);
+    }
+  }
+  T8_FREE (part_table);
+  /* The ghosts were not added via t8_cmesh_trees_add_ghost, thus we have
+   * to build the global id to local id hash table ourselves */
+  t8_cmesh_trees_build_ghost_hash (cmesh->trees, cmesh->num_local_trees);
+  return 1;
+}
+
+#undef T8_LOAD_BINARY_CHECK_CLOSE
+
+t8_cmesh_t
+t8_cmesh_load_binary (const char *filename, sc_MPI_Comm comm)
+{
+  FILE               *fp;
+  t8_cmesh_t          cmesh;
+  int                 mpiret;
+
+  /* Open the file in binary read mode */
+  fp = fopen (filename, "rb");
+  if (fp == NULL) {
+    t8_errorf ("Error when opening file %s.\n", filename);
+    return NULL;
+  }
+  t8_cmesh_init (&cmesh);
+  if (!t8_cmesh_load_binary_data (cmesh, fp)) {
+    /* The file was already closed */
+    t8_errorf ("Error when loading file %s.\n", filename);
+    t8_cmesh_destroy (&cmesh);
+    return NULL;
+  }
+  /* A mapping established with mmap stays valid after closing the file */
+  fclose (fp);
+
+  /* Only cmeshes with the linear geometry can be saved, thus we register
+   * the linear geometry for the loaded cmesh. */
+  t8_cmesh_register_geometry (cmesh,
+                              t8_geometry_linear_new (cmesh->dimension));
+  t8_geom_handler_commit (cmesh->geometry_handler);
+  cmesh->committed = 1;
+  mpiret = sc_MPI_Comm_rank (comm, &cmesh->mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (comm, &cmesh->mpisize);
+  SC_CHECK_MPI (mpiret);
+  t8_stash_destroy (&cmesh->stash);
+  return cmesh;
+}
+
 /* Query whether a given process will open a cmesh saved file.
  * This depends on the number of processes, the number of files and
  * the load mode.
@@ -28,6 +28,141 @@
 #include <t8_eclass.h>
 #include "t8_cmesh_stash.h"
 
+#if T8_ENABLE_OPENMP
+#include <omp.h>
+#include <t8_thread_pool.h>
+
+/* Only sort in parallel if the array has at least this many elements.
+ * For smaller arrays the thread startup does not pay off. */
+#define T8_STASH_SORT_THRESHOLD 8192
+
+/* Sort an sc_array with a parallel merge sort.
+ * Each thread sorts a contiguous chunk of the array with qsort and the
+ * sorted chunks are then merged pairwise, one merge per thread, until a
+ * single sorted run remains. Small arrays are sorted serially. */
+static void
+t8_stash_array_sort_parallel (sc_array_t *array,
+                              int (*compar) (const void *, const void *))
+{
+  const size_t        count = array->elem_count;
+  const size_t        size = array->elem_size;
+  size_t             *chunk_offset;
+  char               *src, *dest, *aux, *swap;
+  int                 num_chunks, ichunk, width;
+
+  /* Clamp to the process-wide thread limit, so that
+   * t8_thread_pool_set_num_threads also caps this OpenMP phase. */
+  num_chunks = t8_thread_pool_clamp_num_threads (omp_get_max_threads ());
+  if (num_chunks <= 1 || count < T8_STASH_SORT_THRESHOLD) {
+    sc_array_sort (array, compar);
+    return;
+  }
+  /* Compute the chunk boundaries */
+  chunk_offset = T8_ALLOC (size_t, num_chunks + 1);
+  for (ichunk = 0; ichunk <= num_chunks; ichunk++) {
+    chunk_offset[ichunk] = count * ichunk / num_chunks;
+  }
+  T8_ASSERT (chunk_offset[num_chunks] == count);
+  src = array->array;
+  aux = dest = T8_ALLOC (char, count * size);
+  /* Sort each chunk with one thread */
+#pragma omp parallel for schedule (static) num_threads (num_chunks)
+  for (ichunk = 0; ichunk < num_chunks; ichunk++) {
+    qsort (src + chunk_offset[ichunk] * size,
+           chunk_offset[ichunk + 1] - chunk_offset[ichunk], size, compar);
+  }
+  /* Merge pairs of sorted runs of width chunks from src into dest until
+   * only one run remains. */
+  for (width = 1; width < num_chunks; width *= 2) {
+#pragma omp parallel for schedule (static) num_threads (num_chunks)
+    for (ichunk = 0; ichunk < num_chunks; ichunk += 2 * width) {
+      const size_t        lo = chunk_offset[ichunk];
+      const size_t        mid =
+        chunk_offset[SC_MIN (ichunk + width, num_chunks)];
+      const size_t        hi =
+        chunk_offset[SC_MIN (ichunk + 2 * width, num_chunks)];
+      size_t              ileft = lo, iright = mid, iout = lo;
+      char               *left = src + lo * size;
+      char               *right = src + mid * size;
+      while (ileft < mid && iright < hi) {
+        if (compar (left, right) <= 0) {
+          memcpy (dest + iout++ * size, left, size);
+          left += size;
+          ileft++;
+        }
+        else {
+          memcpy (dest + iout++ * size, right, size);
+          right += size;
+          iright++;
+        }
+      }
+      /* Copy the remainder of the run that is not exhausted yet */
+      memcpy (dest + iout * size, left, (mid - ileft) * size);
+      iout += mid - ileft;
+      memcpy (dest + iout * size, right, (hi - iright) * size);
+    }
+    /* The merged runs are in dest, swap the roles of the buffers */
+    swap = src;
+    src = dest;
+    dest = swap;
+  }
+  if (src != array->array) {
+    memcpy (array->array, src, count * size);
+  }
+  T8_FREE (aux);
+  T8_FREE (chunk_offset);
+}
+#endif /* T8_ENABLE_OPENMP */
+
+/* Sort an sc_array, in parallel if OpenMP is enabled. */
+static void
+t8_stash_array_sort (sc_array_t *array,
+                     int (*compar) (const void *, const void *))
+{
+#if T8_ENABLE_OPENMP
+  t8_stash_array_sort_parallel (array, compar);
+#else
+  sc_array_sort (array, compar);
+#endif
+}
+
+/* The default allocation size (in bytes) of the memory slabs that back
+ * the copied attribute data. */
+#define T8_STASH_ATTRIBUTE_SLAB_SIZE (1 << 20)
+/* The alignment (in bytes, a power of two) of the attribute payloads
+ * within a slab. Must suffice for any scalar type stored as attribute. */
+#define T8_STASH_ATTRIBUTE_ALIGN     8
+
+/* Allocate size bytes of attribute storage from the stash's slabs.
+ * We bump a pointer in the newest slab and only fall back to a new
+ * slab allocation when the current one is exhausted. This way adding
+ * an attribute does not cost one heap allocation per tree.
+ * The slabs are freed collectively in t8_stash_destroy. */
+static void        *
+t8_stash_attribute_alloc (t8_stash_t stash, size_t size)
+{
+  char               *slab;
+  void               *data;
+
+  /* Round up to keep all returned addresses properly aligned. */
+  size = SC_MAX (size, 1);
+  size = (size + (T8_STASH_ATTRIBUTE_ALIGN - 1))
+    & ~(size_t) (T8_STASH_ATTRIBUTE_ALIGN - 1);
+  if (stash->slab_used + size > stash->slab_size) {
+    /* The current slab cannot serve this allocation, we open a new one.
+     * Payloads larger than the default slab size get a slab of their own. */
+    stash->slab_size = SC_MAX (size, (size_t) T8_STASH_ATTRIBUTE_SLAB_SIZE);
+    slab = T8_ALLOC (char, stash->slab_size);
+    *(char **) sc_array_push (&stash->attribute_slabs) = slab;
+    stash->slab_used = 0;
+  }
+  slab = *(char **) sc_array_index (&stash->attribute_slabs,
+                                    stash->attribute_slabs.elem_count - 1);
+  data = slab + stash->slab_used;
+  stash->slab_used += size;
+  return data;
+}
+
 void
 t8_stash_init (t8_stash_t *pstash)
 {
@@ -38,29 +173,29 @@ t8_stash_init (t8_stash_t *pstash)
   sc_array_init (&stash->attributes, sizeof (t8_stash_attribute_struct_t));
   sc_array_init (&stash->classes, sizeof (t8_stash_class_struct_t));
   sc_array_init (&stash->joinfaces, sizeof (t8_stash_joinface_struct_t));
+  sc_array_init (&stash->attribute_slabs, sizeof (char *));
+  stash->slab_used = 0;
+  stash->slab_size = 0;
 }
 
 void
 t8_stash_destroy (t8_stash_t *pstash)
 {
   t8_stash_t          stash;
-  t8_stash_attribute_struct_t *attr;
-  size_t              attr_count;
+  size_t              slab_count;
 
   T8_ASSERT (pstash != NULL);
   stash = *pstash;
   sc_array_reset (&stash->classes);
   sc_array_reset (&stash->joinfaces);
-  for (attr_count = 0; attr_count < stash->attributes.elem_count;
-       attr_count++) {
-    attr =
-      (t8_stash_attribute_struct_t *) sc_array_index (&stash->attributes,
-                                                      attr_count);
-    if (attr->is_owned) {
-      T8_FREE (attr->attr_data);
-    }
-  }
   sc_array_reset (&stash->attributes);
+  /* All copied attribute data lives in the slabs, so we do not free
+   * the attribute entries individually. */
+  for (slab_count = 0; slab_count < stash->attribute_slabs.elem_count;
+       slab_count++) {
+    T8_FREE (*(char **) sc_array_index (&stash->attribute_slabs, slab_count));
+  }
+  sc_array_reset (&stash->attribute_slabs);
   T8_FREE (stash);
   pstash = NULL;
 }
@@ -95,7 +230,7 @@ t8_stash_class_sort (t8_stash_t stash)
 {
   T8_ASSERT (stash != NULL);
 
-  sc_array_sort (&stash->classes, t8_stash_class_compare);
+  t8_stash_array_sort (&stash->classes, t8_stash_class_compare);
 }
 
 static int
@@ -153,7 +288,7 @@ t8_stash_joinface_sort (t8_stash_t stash)
 {
   T8_ASSERT (stash != NULL);
 
-  sc_array_sort (&stash->joinfaces, t8_stash_facejoin_compare);
+  t8_stash_array_sort (&stash->joinfaces, t8_stash_facejoin_compare);
 }
 
 void
@@ -169,12 +304,42 @@ t8_stash_add_attribute (t8_stash_t stash, t8_gloidx_t id, int package_id,
   sattr->is_owned = !copy ? 0 : 1;
   sattr->key = key;
   sattr->package_id = package_id;
-  sattr->attr_data = !copy ? attr : T8_ALLOC (char, size);
+  sattr->attr_data = !copy ? attr : t8_stash_attribute_alloc (stash, size);
   if (copy) {
     memcpy (sattr->attr_data, attr, size);
   }
 }
 
+void
+t8_stash_add_attributes (t8_stash_t stash, size_t num_attributes,
+                         const t8_gloidx_t *ids, int package_id, int key,
+                         const size_t *sizes, void *attr, int copy)
+{
+  t8_stash_attribute_struct_t *sattr;
+  char               *attr_bytes = (char *) attr;
+  size_t              iattr;
+
+  T8_ASSERT (stash != NULL);
+  T8_ASSERT (num_attributes == 0 || (ids != NULL && sizes != NULL));
+  /* Grow the attribute array only once for all entries */
+  sattr = (t8_stash_attribute_struct_t *)
+    sc_array_push_count (&stash->attributes, num_attributes);
+  for (iattr = 0; iattr < num_attributes; iattr++, sattr++) {
+    sattr->attr_size = sizes[iattr];
+    sattr->id = ids[iattr];
+    sattr->is_owned = !copy ? 0 : 1;
+    sattr->key = key;
+    sattr->package_id = package_id;
+    sattr->attr_data =
+      !copy ? (void *) attr_bytes : t8_stash_attribute_alloc (stash,
+                                                              sizes[iattr]);
+    if (copy) {
+      memcpy (sattr->attr_data, attr_bytes, sizes[iattr]);
+    }
+    attr_bytes += sizes[iattr];
+  }
+}
+
 size_t
 t8_stash_get_attribute_size (t8_stash_t stash, size_t index)
 {
@@ -242,12 +407,75 @@ t8_stash_attribute_compare (const void *v1, const void *v2)
 void
 t8_stash_attribute_sort (t8_stash_t stash)
 {
-  sc_array_sort (&stash->attributes, t8_stash_attribute_compare);
+  t8_stash_array_sort (&stash->attributes, t8_stash_attribute_compare);
 }
 
+/* The chunk size in bytes and the number of simultaneously outstanding
+ * chunks used by t8_stash_bcast_chunked. With 4 MiB chunks and a window
+ * of 8 the pipeline holds at most 32 MiB in flight. */
+#define T8_STASH_BCAST_CHUNK_BYTES (1 << 22)
+#define T8_STASH_BCAST_WINDOW 8
+
+/* Broadcast a byte buffer in fixed-size chunks.
+ * If MPI-3 nonblocking collectives are available, the chunks are sent
+ * with MPI_Ibcast and up to \ref T8_STASH_BCAST_WINDOW broadcasts are
+ * kept in flight, such that consecutive chunks travel through the
+ * broadcast tree in a pipelined fashion instead of one monolithic
+ * message. Otherwise we fall back to chunked blocking broadcasts, which
+ * also avoids overflowing the int count argument for large stashes. */
 static void
-t8_stash_bcast_attributes (sc_array_t *attributes, int root, sc_MPI_Comm comm)
+t8_stash_bcast_chunked (void *data, size_t num_bytes, int root,
+                        sc_MPI_Comm comm)
 {
+  char               *bytes = (char *) data;
+  size_t              num_chunks, ichunk, offset, chunk_bytes;
+  int                 mpiret;
+
+  num_chunks =
+    (num_bytes + T8_STASH_BCAST_CHUNK_BYTES - 1) / T8_STASH_BCAST_CHUNK_BYTES;
+#if defined (SC_ENABLE_MPI) && defined (MPI_VERSION) && MPI_VERSION >= 3
+  {
+    MPI_Request         requests[T8_STASH_BCAST_WINDOW];
+    int                 slot;
+
+    for (ichunk = 0; ichunk < num_chunks; ichunk++) {
+      slot = (int) (ichunk % T8_STASH_BCAST_WINDOW);
+      if (ichunk >= T8_STASH_BCAST_WINDOW) {
+        /* The pipeline is full. Wait for the oldest outstanding chunk
+         * before reusing its request slot. */
+        mpiret = MPI_Wait (&requests[slot], MPI_STATUS_IGNORE);
+        SC_CHECK_MPI (mpiret);
+      }
+      offset = ichunk * T8_STASH_BCAST_CHUNK_BYTES;
+      chunk_bytes =
+        SC_MIN (num_bytes - offset, (size_t) T8_STASH_BCAST_CHUNK_BYTES);
+      mpiret = MPI_Ibcast (bytes + offset, (int) chunk_bytes, MPI_BYTE, root,
+                           comm, &requests[slot]);
+      SC_CHECK_MPI (mpiret);
+    }
+    /* Wait for the tail of the pipeline. Completed requests were set to
+     * MPI_REQUEST_NULL by MPI_Wait, so waiting on all slots is safe. */
+    mpiret =
+      MPI_Waitall ((int) SC_MIN (num_chunks, (size_t) T8_STASH_BCAST_WINDOW),
+                   requests, MPI_STATUSES_IGNORE);
+    SC_CHECK_MPI (mpiret);
+  }
+#else
+  for (ichunk = 0; ichunk < num_chunks; ichunk++) {
+    offset = ichunk * T8_STASH_BCAST_CHUNK_BYTES;
+    chunk_bytes =
+      SC_MIN (num_bytes - offset, (size_t) T8_STASH_BCAST_CHUNK_BYTES);
+    mpiret = sc_MPI_Bcast (bytes + offset, (int) chunk_bytes, sc_MPI_BYTE,
+                           root, comm);
+    SC_CHECK_MPI (mpiret);
+  }
+#endif
+}
+
+static void
+t8_stash_bcast_attributes (t8_stash_t stash, int root, sc_MPI_Comm comm)
+{
+  sc_array_t         *attributes;
   size_t              num_atts, iatt, att_size, copied_bytes;
   t8_stash_attribute_struct_t *att;
   char               *buffer;
@@ -257,7 +485,8 @@ t8_stash_bcast_attributes (sc_array_t *attributes, int root, sc_MPI_Comm comm)
   mpiret = sc_MPI_Comm_size (comm, &mpisize);
   SC_CHECK_MPI (mpiret);
 
-  T8_ASSERT (attributes != NULL);
+  T8_ASSERT (stash != NULL);
+  attributes = &stash->attributes;
 
   num_atts = attributes->elem_count;
 
@@ -278,14 +507,15 @@ t8_stash_bcast_attributes (sc_array_t *attributes, int root, sc_MPI_Comm comm)
       copied_bytes += att->attr_size;
     }
   }
-  /* broadcast buffer */
-  sc_MPI_Bcast (buffer, att_size, sc_MPI_BYTE, root, comm);
+  /* broadcast buffer in pipelined chunks */
+  t8_stash_bcast_chunked (buffer, att_size, root, comm);
   /* Copy attributes from buffer back to stash */
   if (mpirank != root) {
     copied_bytes = 0;
     for (iatt = 0; iatt < num_atts; iatt++) {
       att = (t8_stash_attribute_struct_t *) sc_array_index (attributes, iatt);
-      att->attr_data = T8_ALLOC (char, att->attr_size);
+      att->attr_data = t8_stash_attribute_alloc (stash, att->attr_size);
+      att->is_owned = 1;
       memcpy (att->attr_data, buffer + copied_bytes, att->attr_size);
       copied_bytes += att->attr_size;
     }
@@ -311,25 +541,20 @@ t8_stash_bcast (t8_stash_t stash, int root, sc_MPI_Comm comm,
     sc_array_resize (&stash->joinfaces, elem_counts[2]);
   }
   if (elem_counts[0] > 0) {
-    mpiret = sc_MPI_Bcast (stash->attributes.array,
-                           elem_counts[0] *
-                           sizeof (t8_stash_attribute_struct_t), sc_MPI_BYTE,
-                           0, comm);
-    SC_CHECK_MPI (mpiret);
-    t8_stash_bcast_attributes (&stash->attributes, root, comm);
+    t8_stash_bcast_chunked (stash->attributes.array,
+                            elem_counts[0] *
+                            sizeof (t8_stash_attribute_struct_t), root, comm);
+    t8_stash_bcast_attributes (stash, root, comm);
   }
   if (elem_counts[1] > 0) {
-    mpiret = sc_MPI_Bcast (stash->classes.array,
-                           elem_counts[1] * sizeof (t8_stash_class_struct_t),
-                           sc_MPI_BYTE, 0, comm);
-    SC_CHECK_MPI (mpiret);
+    t8_stash_bcast_chunked (stash->classes.array,
+                            elem_counts[1] *
+                            sizeof (t8_stash_class_struct_t), root, comm);
   }
   if (elem_counts[2] > 0) {
-    mpiret = sc_MPI_Bcast (stash->joinfaces.array,
-                           elem_counts[2] *
-                           sizeof (t8_stash_joinface_struct_t), sc_MPI_BYTE,
-                           0, comm);
-    SC_CHECK_MPI (mpiret);
+    t8_stash_bcast_chunked (stash->joinfaces.array,
+                            elem_counts[2] *
+                            sizeof (t8_stash_joinface_struct_t), root, comm);
   }
   return stash;
 }
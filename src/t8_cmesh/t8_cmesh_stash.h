@@ -82,6 +82,12 @@ typedef struct t8_stash
   sc_array_t          classes; /**< Stores the eclasses of the trees. \see t8_stash_class */
   sc_array_t          joinfaces; /**< Stores the face-connections. \see t8_stash_joinface */
   sc_array_t          attributes; /**< Stores the attributes. \see t8_stash_attribute */
+  sc_array_t          attribute_slabs; /**< Stores pointers to the memory slabs that back
+                                            all copied attribute data. Attribute payloads are
+                                            bump-allocated from these slabs and freed together
+                                            when the stash is destroyed. */
+  size_t              slab_used; /**< The number of bytes used in the newest slab. */
+  size_t              slab_size; /**< The allocation size of the newest slab. */
 } t8_stash_struct_t;
 
 T8_EXTERN_C_BEGIN ();
@@ -155,6 +161,29 @@ void                t8_stash_add_attribute (t8_stash_t stash, t8_gloidx_t id,
                                             size_t size, void *attr,
                                             int copy);
 
+/** Add the same kind of attribute to many trees at once.
+ * This is equivalent to calling \ref t8_stash_add_attribute once per tree,
+ * but grows the attribute array only once and serves all payload copies
+ * from bulk memory, which avoids one allocation per tree.
+ * \param [in] stash    The stash structure to be modified.
+ * \param [in] num_attributes The number of attributes to add.
+ * \param [in] ids      The global indices of the trees to which the attributes are added.
+ * \param [in] package_id The unique id of the current package.
+ * \param [in] key      An integer value used to identify these attributes.
+ * \param [in] sizes    The sizes (in bytes) of the attributes.
+ * \param [in] attr     Points to the data of all attributes, packed contiguously
+ *                      in the order given by \a ids.
+ * \param [in] copy     If true the attribute data is copied from \a attr to an internal storage.
+ *                      If false only pointers into \a attr are stored and the data is only copied
+ *                      if the cmesh is committed. (More memory efficient).
+ */
+void                t8_stash_add_attributes (t8_stash_t stash,
+                                             size_t num_attributes,
+                                             const t8_gloidx_t *ids,
+                                             int package_id, int key,
+                                             const size_t *sizes, void *attr,
+                                             int copy);
+
 /** Return the size (in bytes) of an attribute in the stash.
  * \param [in]   stash   The stash to be considered.
  * \param [in]   index   The index of the attribute in the attribute array of \a stash.
@@ -213,6 +242,9 @@ void                t8_stash_attribute_sort (t8_stash_t stash);
 /** Broadcast a stash on the root process to all processes in a communicator.
  *  The number of entries in the classes, joinfaces and attributes arrays must
  *  be known on the receiving processes before calling this function.
+ *  The payload is broadcast in fixed-size chunks and, if MPI-3 nonblocking
+ *  collectives are available, several chunks are kept in flight at once,
+ *  so that large stashes are pipelined through the broadcast tree.
  *  \param [in,out] stash   On root the stash that is to be broadcasted.
  *                          On the other process an initialized stash. Its entries will
  *                          get overwritten by the entries in the root stash.
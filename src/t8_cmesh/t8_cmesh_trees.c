@@ -25,8 +25,12 @@
  * TODO: document this file
  */
 
+#include <t8_data/t8_shmem.h>
 #include "t8_cmesh_stash.h"
 #include "t8_cmesh_trees.h"
+#ifdef T8_HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
 
 /* This struct is needed as a key to search
  * for an argument in the arguments array of a tree */
@@ -88,7 +92,11 @@ t8_cmesh_trees_init (t8_cmesh_trees_t *ptrees, int num_procs,
   trees->ghost_globalid_to_local_id =
     sc_hash_new (t8_cmesh_trees_glo_lo_hash_func,
                  t8_cmesh_trees_glo_lo_hash_equal, NULL, NULL);
-
+  /* The part data is not memory mapped (yet) */
+  trees->mmap_data = NULL;
+  trees->mmap_size = 0;
+  /* The part data does not live in a shared window (yet) */
+  trees->shared_base = NULL;
 }
 
 void
@@ -635,6 +643,146 @@ t8_cmesh_trees_size (t8_cmesh_trees_t trees)
   return total_bytes;
 }
 
+size_t
+t8_cmesh_trees_get_part_size (t8_cmesh_trees_t trees, int proc)
+{
+  t8_part_tree_t      part;
+
+  part = t8_cmesh_trees_get_part (trees, proc);
+  return t8_cmesh_trees_get_part_alloc (trees, part);
+}
+
+/* Alignment of the parts inside a shared window.
+ * The part buffers store structs, so each part must start at a
+ * sufficiently aligned offset. */
+#define T8_CMESH_TREES_SHARED_ALIGN 16
+
+void
+t8_cmesh_trees_share_node_memory (t8_cmesh_trees_t trees, sc_MPI_Comm comm)
+{
+#if defined(SC_ENABLE_MPIWINSHARED)
+  sc_MPI_Comm         intranode, internode;
+  t8_part_tree_t      part;
+  size_t              iproc, num_parts;
+  size_t             *part_offset;
+  char               *base;
+  MPI_Aint            winsize, querysize;
+  int                 mpiret, intrarank, intrasize, disp_unit;
+
+  T8_ASSERT (trees != NULL);
+  T8_ASSERT (trees->mmap_data == NULL);
+  T8_ASSERT (trees->shared_base == NULL);
+
+  /* Get the intranode communicator, attaching the node communicators
+   * to comm if this was not done yet. */
+  t8_shmem_init (comm);
+  sc_mpi_comm_get_node_comms (comm, &intranode, &internode);
+  if (intranode == sc_MPI_COMM_NULL) {
+    t8_debugf ("No intranode communicator available."
+               " The cmesh is not moved to node shared memory.\n");
+    return;
+  }
+  mpiret = sc_MPI_Comm_rank (intranode, &intrarank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (intranode, &intrasize);
+  SC_CHECK_MPI (mpiret);
+  if (intrasize == 1) {
+    /* One rank per node, there is no copy to deduplicate. */
+    return;
+  }
+
+  /* Compute the aligned offset of each part inside the window.
+   * All ranks of the node hold identical replicated data, so they
+   * compute identical offsets. */
+  num_parts = trees->from_proc->elem_count;
+  part_offset = T8_ALLOC (size_t, num_parts + 1);
+  part_offset[0] = 0;
+  for (iproc = 0; iproc < num_parts; iproc++) {
+    size_t              part_bytes =
+      t8_cmesh_trees_get_part_size (trees, (int) iproc);
+    /* Round up, so that the next part starts aligned */
+    part_bytes +=
+      (T8_CMESH_TREES_SHARED_ALIGN - part_bytes %
+       T8_CMESH_TREES_SHARED_ALIGN) % T8_CMESH_TREES_SHARED_ALIGN;
+    part_offset[iproc + 1] = part_offset[iproc] + part_bytes;
+  }
+
+  /* The first rank of the node allocates the whole window, all other
+   * ranks allocate zero bytes and query the base address. */
+  winsize = intrarank == 0 ? (MPI_Aint) part_offset[num_parts] : 0;
+  mpiret = MPI_Win_allocate_shared (winsize, 1, MPI_INFO_NULL, intranode,
+                                    &base, &trees->shared_win);
+  SC_CHECK_MPI (mpiret);
+  if (intrarank == 0) {
+    /* Fill the window with this rank's copy of the part data. */
+    for (iproc = 0; iproc < num_parts; iproc++) {
+      part = t8_cmesh_trees_get_part (trees, iproc);
+      memcpy (base + part_offset[iproc], part->first_tree,
+              t8_cmesh_trees_get_part_alloc (trees, part));
+    }
+  }
+  else {
+    mpiret = MPI_Win_shared_query (trees->shared_win, 0, &querysize,
+                                   &disp_unit, &base);
+    SC_CHECK_MPI (mpiret);
+  }
+  /* Make the written data visible on all ranks of the node. */
+  mpiret = MPI_Win_fence (0, trees->shared_win);
+  SC_CHECK_MPI (mpiret);
+
+  /* Point the parts into the window and drop the private copies.
+   * All tree, ghost and attribute lookups are offset based relative to
+   * first_tree, so no further translation is needed,
+   * \see t8_cmesh_load_binary for the same relocation via mmap. */
+  for (iproc = 0; iproc < num_parts; iproc++) {
+    part = t8_cmesh_trees_get_part (trees, iproc);
+    T8_FREE (part->first_tree);
+    part->first_tree = base + part_offset[iproc];
+  }
+  trees->shared_base = (void *) base;
+  T8_FREE (part_offset);
+#else
+  /* Without MPI window support every rank keeps its own copy. */
+  t8_debugf ("t8code was configured without MPI shared window support."
+             " The cmesh is not moved to node shared memory.\n");
+#endif
+}
+
+void
+t8_cmesh_trees_build_ghost_hash (t8_cmesh_trees_t trees,
+                                 t8_locidx_t num_local_trees)
+{
+  t8_part_tree_t      part;
+  t8_cghost_t         ghost;
+  t8_trees_glo_lo_hash_t *hash_entry;
+  t8_locidx_t         lghost;
+  int                 ipart;
+#ifdef T8_ENABLE_DEBUG
+  int                 ret;
+#endif
+
+  for (ipart = 0; ipart < (int) trees->from_proc->elem_count; ipart++) {
+    part = t8_cmesh_trees_get_part (trees, ipart);
+    for (lghost = 0; lghost < part->num_ghosts; lghost++) {
+      ghost = &((t8_cghost_t) (((t8_ctree_struct_t *) part->first_tree) +
+                               part->num_trees))[lghost];
+      /* Insert this ghost's global id into the hash table,
+       * just as \ref t8_cmesh_trees_add_ghost does. */
+      hash_entry = (t8_trees_glo_lo_hash_t *)
+        sc_mempool_alloc (trees->global_local_mempool);
+      hash_entry->global_id = ghost->treeid;
+      hash_entry->local_id = lghost + part->first_ghost_id + num_local_trees;
+#ifdef T8_ENABLE_DEBUG
+      ret =
+#endif
+        sc_hash_insert_unique (trees->ghost_globalid_to_local_id, hash_entry,
+                               NULL);
+      /* It must not have existed before, thus true was returned */
+      T8_ASSERT (ret);
+    }
+  }
+}
+
 void
 t8_cmesh_trees_copy_toproc (t8_cmesh_trees_t trees_dest,
                             t8_cmesh_trees_t trees_src,
@@ -674,13 +822,12 @@ t8_cmesh_trees_init_attributes (t8_cmesh_trees_t trees, t8_locidx_t ltree_id,
 /* TODO: This is not the final version, currently we still need the attributes
  * array to be sorted! */
 void
-t8_cmesh_trees_add_attribute (t8_cmesh_trees_t trees, int proc,
-                              t8_stash_attribute_struct_t *attr,
-                              t8_locidx_t tree_id, size_t index)
+t8_cmesh_trees_add_attribute_info (t8_cmesh_trees_t trees, int proc,
+                                   t8_stash_attribute_struct_t *attr,
+                                   t8_locidx_t tree_id, size_t index)
 {
   t8_part_tree_t      part;
   t8_ctree_t          tree;
-  char               *new_attr;
   t8_attribute_info_struct_t *attr_info;
   size_t              offset;
 
@@ -693,9 +840,6 @@ t8_cmesh_trees_add_attribute (t8_cmesh_trees_t trees, int proc,
   tree = t8_part_tree_get_tree (part, tree_id);
 
   attr_info = T8_TREE_ATTR_INFO (tree, index);
-  new_attr = T8_TREE_ATTR (tree, attr_info);
-
-  memcpy (new_attr, attr->attr_data, attr->attr_size);
 
   /* Set new values */
   attr_info->key = attr->key;
@@ -719,6 +863,34 @@ t8_cmesh_trees_add_attribute (t8_cmesh_trees_t trees, int proc,
   }
 }
 
+void
+t8_cmesh_trees_copy_attribute_data (t8_cmesh_trees_t trees, int proc,
+                                    t8_stash_attribute_struct_t *attr,
+                                    t8_locidx_t tree_id, size_t index)
+{
+  t8_ctree_t          tree;
+  t8_attribute_info_struct_t *attr_info;
+
+  T8_ASSERT (trees != NULL);
+  T8_ASSERT (attr != NULL);
+  T8_ASSERT (attr->attr_data != NULL || attr->attr_size == 0);
+
+  tree = t8_part_tree_get_tree (t8_cmesh_trees_get_part (trees, proc),
+                                tree_id);
+  attr_info = T8_TREE_ATTR_INFO (tree, index);
+  memcpy (T8_TREE_ATTR (tree, attr_info), attr->attr_data, attr->attr_size);
+}
+
+void
+t8_cmesh_trees_add_attribute (t8_cmesh_trees_t trees, int proc,
+                              t8_stash_attribute_struct_t *attr,
+                              t8_locidx_t tree_id, size_t index)
+{
+  /* Chain up the attribute info offsets first, then copy the payload. */
+  t8_cmesh_trees_add_attribute_info (trees, proc, attr, tree_id, index);
+  t8_cmesh_trees_copy_attribute_data (trees, proc, attr, tree_id, index);
+}
+
 void
 t8_cmesh_trees_add_ghost_attribute (t8_cmesh_trees_t trees, int proc,
                                     t8_stash_attribute_struct_t *attr,
@@ -851,6 +1023,70 @@ t8_cmesh_trees_get_attribute (t8_cmesh_trees_t trees, t8_locidx_t ltree_id,
   return attribute;
 }
 
+void
+t8_cmesh_trees_get_attribute_range (t8_cmesh_trees_t trees,
+                                    t8_locidx_t first_ltree,
+                                    t8_locidx_t num_trees, int package_id,
+                                    int key, void **attributes)
+{
+  t8_part_tree_t      part;
+  t8_ctree_t          tree;
+  t8_attribute_info_struct_t *attr_info;
+  sc_array_t          attr_array;
+  struct t8_key_id_pair key_id;
+  ssize_t             index;
+  t8_locidx_t         itree;
+  int                 proc, num_attributes;
+  void               *first_att_info;
+
+  T8_ASSERT (trees != NULL);
+  T8_ASSERT (first_ltree >= 0);
+  T8_ASSERT (num_trees >= 0);
+
+  key_id.key = key;
+  key_id.package_id = package_id;
+
+  /* Walk the range in one pass. The trees of a part are consecutive, so
+   * the part lookup only fires when the range enters the next part, and
+   * since the trees of a part usually share one attribute layout, the
+   * attribute index found for the previous tree is tried before falling
+   * back to the binary search. */
+  part = NULL;
+  proc = -1;
+  index = -1;
+  for (itree = first_ltree; itree < first_ltree + num_trees; itree++) {
+    if (part == NULL || trees->tree_to_proc[itree] != proc) {
+      proc = trees->tree_to_proc[itree];
+      T8_ASSERT (proc >= 0 && proc < t8_cmesh_trees_get_num_procs (trees));
+      part = t8_cmesh_trees_get_part (trees, proc);
+    }
+    tree = t8_part_tree_get_tree (part, itree);
+    num_attributes = tree->num_attributes;
+    if (num_attributes <= 0) {
+      attributes[itree - first_ltree] = NULL;
+      index = -1;
+      continue;
+    }
+    first_att_info = T8_TREE_FIRST_ATT (tree);
+    if (index < 0 || index >= num_attributes
+        || t8_cmesh_trees_compare_keyattr (&key_id,
+                                           T8_TREE_ATTR_INFO (tree,
+                                                              index)) != 0) {
+      sc_array_init_data (&attr_array, first_att_info,
+                          sizeof (t8_attribute_info_struct_t),
+                          num_attributes);
+      index = sc_array_bsearch (&attr_array, &key_id,
+                                t8_cmesh_trees_compare_keyattr);
+    }
+    if (index < 0) {
+      attributes[itree - first_ltree] = NULL;
+      continue;
+    }
+    attr_info = T8_TREE_ATTR_INFO (tree, index);
+    attributes[itree - first_ltree] = T8_TREE_ATTR (tree, attr_info);
+  }
+}
+
 size_t
 t8_cmesh_trees_get_numproc (t8_cmesh_trees_t trees)
 {
@@ -1282,9 +1518,33 @@ t8_cmesh_trees_destroy (t8_cmesh_trees_t *ptrees)
   t8_cmesh_trees_t    trees = *ptrees;
   t8_part_tree_t      part;
 
-  for (proc = 0; proc < trees->from_proc->elem_count; proc++) {
-    part = t8_cmesh_trees_get_part (trees, proc);
-    T8_FREE (part->first_tree);
+  if (trees->shared_base != NULL) {
+    /* The part data lives in an MPI-3 shared window.
+     * \see t8_cmesh_trees_share_node_memory */
+#if defined(SC_ENABLE_MPIWINSHARED)
+    int                 mpiret;
+
+    /* Freeing the window is collective over the intranode communicator. */
+    mpiret = MPI_Win_free (&trees->shared_win);
+    SC_CHECK_MPI (mpiret);
+#else
+    SC_ABORT_NOT_REACHED ();
+#endif
+  }
+  else if (trees->mmap_data == NULL) {
+    for (proc = 0; proc < trees->from_proc->elem_count; proc++) {
+      part = t8_cmesh_trees_get_part (trees, proc);
+      T8_FREE (part->first_tree);
+    }
+  }
+  else {
+    /* The part data points into a memory mapped file and was not allocated.
+     * \see t8_cmesh_load_binary */
+#ifdef T8_HAVE_SYS_MMAN_H
+    munmap (trees->mmap_data, trees->mmap_size);
+#else
+    SC_ABORT_NOT_REACHED ();
+#endif
   }
   T8_FREE (trees->ghost_to_proc);
   T8_FREE (trees->tree_to_proc);
@@ -408,6 +408,42 @@ t8_locidx_t         t8_cmesh_trees_get_ghost_local_id (t8_cmesh_trees_t trees,
  * returns the complete size in bytes needed to store all information */
 size_t              t8_cmesh_trees_size (t8_cmesh_trees_t trees);
 
+/** Return the number of bytes allocated for one part of a trees structure.
+ * \param [in]        trees The trees structure.
+ * \param [in]        proc  The index of the part.
+ * \return            The number of bytes of part \a proc's first_tree array.
+ */
+size_t              t8_cmesh_trees_get_part_size (t8_cmesh_trees_t trees,
+                                                  int proc);
+
+/** Move the part data of a replicated trees structure into an MPI-3
+ * shared memory window on the intranode communicator of \a comm.
+ * All ranks of a node must hold identical part data; the first rank of
+ * the node writes its copy into the window and all ranks then point
+ * their parts into the window read-only, so the data is stored once per
+ * node. Collective over \a comm. If t8code was configured without MPI
+ * window support or no intranode communicator is available, the call
+ * does nothing and every rank keeps its private copy.
+ * \param [in,out]    trees The trees structure of a committed replicated
+ *                          cmesh.
+ * \param [in]        comm  The communicator of the cmesh.
+ * \note The window is freed collectively in \ref t8_cmesh_trees_destroy.
+ */
+void                t8_cmesh_trees_share_node_memory (t8_cmesh_trees_t trees,
+                                                      sc_MPI_Comm comm);
+
+/** Insert all ghosts of a trees structure into the global id to local id
+ * hash table. This is needed if the part data of \a trees was filled
+ * directly from a buffer (\see t8_cmesh_load_binary) instead of via
+ * \ref t8_cmesh_trees_add_ghost, which inserts the ghosts on the fly.
+ * \param [in,out]    trees The trees structure. Its parts must be filled
+ *                          and its hash table must be empty.
+ * \param [in]        num_local_trees The number of local trees in the cmesh.
+ */
+void                t8_cmesh_trees_build_ghost_hash (t8_cmesh_trees_t trees,
+                                                     t8_locidx_t
+                                                     num_local_trees);
+
 /** For one tree in a trees structure set the number of attributes
  *  and temporarily store the total size of all of this tree's attributes.
  *  This temporary value is used in \ref t8_cmesh_trees_finish_part.
@@ -440,6 +476,33 @@ void               *t8_cmesh_trees_get_attribute (t8_cmesh_trees_t trees,
                                                   int package_id, int key,
                                                   size_t *size, int is_ghost);
 
+/** Return the same attribute of each tree in a range of local trees.
+ *  The range version of \ref t8_cmesh_trees_get_attribute for local trees.
+ *  The range is resolved in a single pass: the part of a tree is only
+ *  looked up when the range enters the next part and the attribute search
+ *  is skipped for trees that share the attribute layout of their
+ *  predecessor, amortizing the per tree lookup machinery.
+ *  \param [in]       trees   The trees structure.
+ *  \param [in]       first_ltree The first local tree of the range.
+ *  \param [in]       num_trees The number of trees in the range.
+ *  \param [in]       package_id The package identifier of the attribute.
+ *  \param [in]       key       The key of the attribute within all attributes of
+ *                              the same package identifier.
+ *  \param [out]      attributes An array of \a num_trees entries provided
+ *                              by the caller. On output entry i points to
+ *                              the attribute of tree \a first_ltree + i,
+ *                              or is NULL if that tree does not store the
+ *                              attribute.
+ */
+void                t8_cmesh_trees_get_attribute_range (t8_cmesh_trees_t
+                                                        trees,
+                                                        t8_locidx_t
+                                                        first_ltree,
+                                                        t8_locidx_t num_trees,
+                                                        int package_id,
+                                                        int key,
+                                                        void **attributes);
+
 /** Return the total size of all attributes stored at a specified tree.
  * \param [in]        tree  A tree structure.
  * \return            The total size (in bytes) of the attributes of \a tree.
@@ -462,6 +525,28 @@ void                t8_cmesh_trees_add_attribute (t8_cmesh_trees_t trees,
                                                   *attr, t8_locidx_t tree_id,
                                                   size_t index);
 
+/* Set the attribute info entry of an attribute and chain up the offset of
+ * the following attribute info, but do not copy the attribute's payload.
+ * The offset chaining must happen serially and in sorted attribute order,
+ * while the payload copies can afterwards be carried out in any order
+ * (and thus concurrently) via \ref t8_cmesh_trees_copy_attribute_data. */
+void                t8_cmesh_trees_add_attribute_info (t8_cmesh_trees_t trees,
+                                                       int proc,
+                                                       t8_stash_attribute_struct_t
+                                                       *attr,
+                                                       t8_locidx_t tree_id,
+                                                       size_t index);
+
+/* Copy the payload of an attribute into the trees structure. The attribute
+ * info of this attribute must have been set before with
+ * \ref t8_cmesh_trees_add_attribute_info. */
+void                t8_cmesh_trees_copy_attribute_data (t8_cmesh_trees_t
+                                                        trees, int proc,
+                                                        t8_stash_attribute_struct_t
+                                                        *attr,
+                                                        t8_locidx_t tree_id,
+                                                        size_t index);
+
 void                t8_cmesh_trees_add_ghost_attribute (t8_cmesh_trees_t
                                                         trees, int proc,
                                                         t8_stash_attribute_struct_t
@@ -135,13 +135,68 @@ typedef struct t8_cmesh
 
   t8_geometry_handler_t *geometry_handler;  /**< Handles all geometries that are used by trees in this cmesh. */
 
+  t8_locidx_t        *face_neigh_offsets; /**< If not NULL, for each local tree and ghost the
+                                        index of its first face in the flat face neighbor
+                                        table, terminated by the total face count. The per
+                                        entry face count follows the eclass, so mixed meshes
+                                        waste no slots. Built at commit by
+                                        \ref t8_cmesh_build_face_table. */
+  t8_locidx_t        *face_neigh_table; /**< If not NULL, for each face of each local tree and
+                                        ghost the local id of the face neighbor, or -1 at
+                                        domain boundaries and for neighbors that are neither
+                                        local nor ghost. Indexed via \a face_neigh_offsets. */
+  int8_t             *face_neigh_dual; /**< The dual faces of the entries of \a face_neigh_table. */
+  int8_t             *face_neigh_orient; /**< The orientations of the entries of \a face_neigh_table. */
+
+  void              **attr_table; /**< If not NULL, for each local tree a direct pointer to the
+                                        payload of the indexed attribute, or NULL if the tree does
+                                        not carry it. Lookups of the indexed (package, key) pair
+                                        then skip the per tree info record search. Built at commit
+                                        for the tree vertices by
+                                        \ref t8_cmesh_build_attribute_table. */
+  int                 attr_table_package_id; /**< The package id of the indexed attribute. */
+  int                 attr_table_key; /**< The key of the indexed attribute. */
+
+  sc_array_t         *uniform_bounds_cache; /**< If not NULL, the cached results of
+                                        \ref t8_cmesh_uniform_bounds, one entry per queried
+                                        (scheme, level) pair. A committed cmesh is immutable,
+                                        so the entries stay valid for its lifetime. */
+
 #ifdef T8_ENABLE_DEBUG
   t8_locidx_t         inserted_trees; /**< Count the number of inserted trees to
                                            check at commit if it equals the total number. */
   t8_locidx_t         inserted_ghosts; /**< Count the number of inserted ghosts to
                                            check at commit if it equals the total number. */
 #endif
-  t8_stash_t          stash; /**< Used as temporary storage for the trees before commit. */
+  int                 set_lazy_attributes; /**< If nonzero, tree attribute payloads are not copied
+                                        into the trees structure at commit. Instead the stash is kept
+                                        and the payloads of a tree are copied on its first attribute
+                                        access. Only honored by the replicated commit from a stash.
+                                        \see t8_cmesh_set_lazy_attributes. */
+  int8_t             *lazy_attr_resident; /**< NULL unless attributes are lazy. Otherwise one entry
+                                        per local tree that is nonzero if the tree's attribute
+                                        payloads have been copied from the stash.
+                                        \see t8_cmesh_prefetch_attributes. */
+  int                 set_node_shared; /**< If nonzero and the cmesh is replicated, the commit
+                                        moves the trees and attribute data into an MPI-3 shared
+                                        window that is stored once per compute node.
+                                        \see t8_cmesh_set_shared_node_memory. */
+  int                 set_reorder_trees; /**< If nonzero, the commit renumbers the trees along a
+                                        breadth-first ordering of the face-neighbor graph, so that
+                                        neighboring trees get nearby ids. Only honored by the
+                                        replicated commit from a stash.
+                                        \see t8_cmesh_set_reorder_trees. */
+  int                 direct_build; /**< If nonzero, the trees structure was preallocated and is
+                                        filled directly by the application instead of via the stash;
+                                        the commit then reduces to a validation pass.
+                                        \see t8_cmesh_set_direct_build. */
+  t8_locidx_t         direct_attr_tree; /**< With a direct build, the tree of the most recent
+                                        \ref t8_cmesh_direct_set_attribute call. */
+  size_t              direct_attr_index; /**< With a direct build, the index of the next attribute
+                                        of tree \a direct_attr_tree. */
+  t8_stash_t          stash; /**< Used as temporary storage for the trees before commit.
+                                  Kept alive after commit if attributes are lazy, since it then
+                                  backs the unmaterialized attribute payloads. */
   t8_cprofile_t      *profile; /**< Used to measure runtimes and statistics of the cmesh algorithms. */
 }
 t8_cmesh_struct_t;
@@ -236,6 +291,16 @@ typedef struct t8_cmesh_trees
                                                            global_id -> local_id for the ghost trees.
                                                            The local_id is the local ghost id starting at num_local_trees  */
   sc_mempool_t       *global_local_mempool;     /* Memory pool for the entries in the hash table */
+  void               *mmap_data;        /* If the part data was loaded via mmap, the start of the mapping.
+                                           NULL if the part data was allocated. \see t8_cmesh_load_binary */
+  size_t              mmap_size;        /* The length of the mapping. 0 if mmap_data is NULL */
+  void               *shared_base;      /* If not NULL, the part data lives in an MPI-3 shared window
+                                           that is stored once per compute node and this is its local
+                                           base address. \see t8_cmesh_trees_share_node_memory */
+#if defined(SC_ENABLE_MPIWINSHARED)
+  MPI_Win             shared_win;       /* The shared window backing the part data.
+                                           Only valid if shared_base is not NULL. */
+#endif
 }
 t8_cmesh_trees_struct_t;
 
@@ -48,6 +48,30 @@ void                t8_cmesh_write_netcdf (t8_cmesh_t cmesh,
                                            t8_netcdf_variable_t *
                                            variables[], sc_MPI_Comm comm);
 
+/** Creates a netCDF-4 file containing the (geometrical) information about the given cmesh and additional elementwise data variables.
+ * In addition to \ref t8_cmesh_write_netcdf, the netCDF variable storage and mpi access patterns can be chosen.
+ * If parallel netCDF routines are accessible, all processes write collectively into one shared file,
+ * otherwise each process writes its own file.
+ * \param [in]  cmesh    A cmesh.
+ * \param [in]  file_prefix    A string which holds the file's name (output file will be 'file_prefix.nc').
+ * \param [in]  file_title    A string to caption the NetCDF-File.
+ * \param [in]  dim    The Dimension of the cmesh (2D or 3D).
+ * \param [in]  num_extern_netcdf_vars    The number of extern user-defined variables which hold elementwise data (if none, set it to 0).
+ * \param [in]  ext_variables An array of pointers of the herein before mentioned user-defined variables (if none, set it to NULL).
+ * \param [in]  comm The sc_MPI_Communicator to use.
+ * \param [in]  netcdf_var_storage_mode The netCDF storage pattern for the variables (NC_CONTIGUOUS or NC_CHUNKED).
+ * \param [in]  netcdf_mpi_access The netCDF mpi access pattern for the variables (NC_INDEPENDENT or NC_COLLECTIVE); only used if parallel netCDF routines are accessible.
+ */
+void                t8_cmesh_write_netcdf_ext (t8_cmesh_t cmesh,
+                                               const char *file_prefix,
+                                               const char *file_title,
+                                               int dim,
+                                               int num_extern_netcdf_vars,
+                                               t8_netcdf_variable_t *
+                                               variables[], sc_MPI_Comm comm,
+                                               int netcdf_var_storage_mode,
+                                               int netcdf_mpi_access);
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_CMESH_NETCDF_H */
@@ -97,6 +97,12 @@ T8_EXTERN_C_BEGIN ();
  *                                  occ geometry.
  * \return        A committed cmesh holding the mesh of dimension \a dim in the
  *                specified .msh file.
+ * \note On the first successful read a sidecar index file
+ * fileprefix.msh.t8idx is written next to the mesh. Later reads of the
+ * unchanged mesh fill the cmesh from the index and skip the text parse
+ * entirely; the index is validated against a content hash of the .msh
+ * file and ignored if the mesh, the read parameters or the architecture
+ * changed. Delete the .t8idx file to force a reparse.
  */
 /* *INDENT-OFF* */
 t8_cmesh_t
@@ -0,0 +1,122 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_cpuid.h>
+
+#if (defined (__x86_64__) || defined (__i386__)) && \
+  (defined (__GNUC__) || defined (__clang__))
+#define T8_CPUID_HAVE_X86 1
+#include <cpuid.h>
+#endif
+
+/* Cached feature word; -1 means not detected yet.  The detection is pure
+ * and idempotent, so a benign race between threads at most repeats it. */
+static int          t8_cpuid_cached_features = -1;
+
+#ifdef T8_CPUID_HAVE_X86
+
+/** Read the extended control register 0 to learn which vector register
+ * state the operating system saves on context switches.  Without this
+ * check a CPUID feature bit alone does not make an instruction set safe
+ * to execute. */
+static unsigned long long
+t8_cpuid_xgetbv0 (void)
+{
+  unsigned int        eax, edx;
+
+  __asm__ __volatile__ ("xgetbv":"=a" (eax), "=d" (edx):"c" (0));
+  return ((unsigned long long) edx << 32) | eax;
+}
+
+static int
+t8_cpuid_detect (void)
+{
+  unsigned int        eax, ebx, ecx, edx;
+  unsigned long long  xcr0;
+  int                 features = 0;
+
+  /* Leaf 1 tells us whether OSXSAVE and AVX are available at all. */
+  if (!__get_cpuid (1, &eax, &ebx, &ecx, &edx)) {
+    return 0;
+  }
+  if (!(ecx & bit_OSXSAVE) || !(ecx & bit_AVX)) {
+    return 0;
+  }
+  xcr0 = t8_cpuid_xgetbv0 ();
+  /* XMM and YMM state (bits 1 and 2) must be enabled for AVX2. */
+  if ((xcr0 & 0x6) != 0x6) {
+    return 0;
+  }
+  /* Leaf 7 carries the AVX2 and AVX-512 feature bits. */
+  if (!__get_cpuid_count (7, 0, &eax, &ebx, &ecx, &edx)) {
+    return 0;
+  }
+  if (ebx & bit_AVX2) {
+    features |= T8_CPUID_AVX2;
+  }
+  /* Opmask, upper ZMM and full ZMM state (bits 5-7) for AVX-512. */
+  if ((ebx & bit_AVX512F) && (xcr0 & 0xe0) == 0xe0) {
+    features |= T8_CPUID_AVX512F;
+  }
+  return features;
+}
+
+#else /* !T8_CPUID_HAVE_X86 */
+
+static int
+t8_cpuid_detect (void)
+{
+#if defined (__aarch64__) || defined (__ARM_NEON)
+  /* NEON/ASIMD is a mandatory part of AArch64. */
+  return T8_CPUID_NEON;
+#else
+  return 0;
+#endif
+}
+
+#endif /* !T8_CPUID_HAVE_X86 */
+
+int
+t8_cpuid_features (void)
+{
+  if (t8_cpuid_cached_features < 0) {
+    t8_cpuid_cached_features = t8_cpuid_detect ();
+  }
+  return t8_cpuid_cached_features;
+}
+
+const char         *
+t8_cpuid_isa_name (void)
+{
+  const int           features = t8_cpuid_features ();
+
+  if (features & T8_CPUID_AVX512F) {
+    return "AVX-512F";
+  }
+  if (features & T8_CPUID_AVX2) {
+    return "AVX2";
+  }
+  if (features & T8_CPUID_NEON) {
+    return "NEON";
+  }
+  return "generic";
+}
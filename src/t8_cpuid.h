@@ -0,0 +1,66 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_cpuid.h
+ * Runtime CPU feature detection.
+ *
+ * t8code is often built once and deployed across machine partitions with
+ * different vector units (for example AVX2 and AVX-512 x86 nodes sharing
+ * one module tree).  This header exposes the features of the CPU the
+ * binary actually runs on, so that hot kernels can be compiled in several
+ * instruction set variants and the widest supported one can be selected
+ * once at \ref t8_init, \see t8_geom_batch_kernels_init.
+ */
+
+#ifndef T8_CPUID_H
+#define T8_CPUID_H
+
+#include <t8.h>
+
+/** The CPU supports the x86 AVX2 instruction set and the operating
+ * system saves the 256 bit vector registers across context switches. */
+#define T8_CPUID_AVX2     0x01
+/** The CPU supports the x86 AVX-512 foundation instruction set and the
+ * operating system saves the 512 bit vector registers. */
+#define T8_CPUID_AVX512F  0x02
+/** The CPU supports ARM NEON/ASIMD (always set on AArch64). */
+#define T8_CPUID_NEON     0x04
+
+T8_EXTERN_C_BEGIN ();
+
+/** Query the vector features of the CPU this process runs on.
+ * The detection runs once and the result is cached; subsequent calls are
+ * cheap.  On architectures without a detection path all flags are zero
+ * and callers must fall back to their generic kernels.
+ * \return  The bitwise or of the T8_CPUID_* flags supported at runtime.
+ */
+int                 t8_cpuid_features (void);
+
+/** Return a static, human readable name for the widest vector instruction
+ * set in \ref t8_cpuid_features, for logging at \ref t8_init.
+ * \return  One of "AVX-512F", "AVX2", "NEON" or "generic".
+ */
+const char         *t8_cpuid_isa_name (void);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_CPUID_H */
@@ -27,9 +27,156 @@
 #include <t8_element_cxx.hxx>
 #include <sc_containers.h>
 #include <t8_data/t8_containers.h>
+#include <t8_thread_pool.h>
+#if T8_ENABLE_OPENMP
+#include <omp.h>
+#endif
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
 
 T8_EXTERN_C_BEGIN ();
 
+/* The alignment of slab allocations. Slabs of at least one huge page are
+ * aligned to the huge page size, so that the kernel can back them with
+ * transparent huge pages; smaller slabs are cache line aligned. */
+#define T8_ELEMENT_SLAB_HUGEPAGE_BYTES (2 * 1024 * 1024)
+#define T8_ELEMENT_SLAB_CACHELINE_BYTES 64
+
+/* Pool of retired element storage slabs. With pooling enabled, slabs of
+ * destroyed element arrays are retained here and the slab allocator
+ * serves new requests from the pool first, so steady state cycles that
+ * destroy and rebuild forests of similar size stop hitting the system
+ * allocator. \see t8_forest_swap_storage */
+#define T8_ELEMENT_SLAB_POOL_MAX 32
+static int          t8_element_slab_pooling = 0;
+static int          t8_element_slab_pool_count = 0;
+static char        *t8_element_slab_pool[T8_ELEMENT_SLAB_POOL_MAX];
+static size_t       t8_element_slab_pool_bytes[T8_ELEMENT_SLAB_POOL_MAX];
+
+void
+t8_element_array_slab_pool_clear (void)
+{
+  while (t8_element_slab_pool_count > 0) {
+    free (t8_element_slab_pool[--t8_element_slab_pool_count]);
+  }
+}
+
+void
+t8_element_array_slab_pool_set (int enable)
+{
+  t8_element_slab_pooling = enable != 0;
+  if (!t8_element_slab_pooling) {
+    t8_element_array_slab_pool_clear ();
+  }
+}
+
+/* Retire a slab into the pool, or free it if pooling is off or the pool
+ * is full. */
+static void
+t8_element_slab_release (char *slab, size_t num_bytes)
+{
+  if (t8_element_slab_pooling
+      && t8_element_slab_pool_count < T8_ELEMENT_SLAB_POOL_MAX) {
+    t8_element_slab_pool[t8_element_slab_pool_count] = slab;
+    t8_element_slab_pool_bytes[t8_element_slab_pool_count] = num_bytes;
+    t8_element_slab_pool_count++;
+  }
+  else {
+    free (slab);
+  }
+}
+
+/* Allocate an aligned slab of num_bytes bytes for element storage.
+ * A sufficiently large pooled slab is reused before the system allocator
+ * is asked; \a alloc_bytes receives the actual slab size, which may
+ * exceed the request. \see T8_ELEMENT_MEMORY_SLAB */
+static char        *
+t8_element_slab_alloc (size_t num_bytes, size_t *alloc_bytes)
+{
+  char               *slab;
+  const size_t        align =
+    num_bytes >= T8_ELEMENT_SLAB_HUGEPAGE_BYTES ?
+    T8_ELEMENT_SLAB_HUGEPAGE_BYTES : T8_ELEMENT_SLAB_CACHELINE_BYTES;
+  int                 ret, islab;
+
+  /* Serve the request from the slab pool if possible */
+  for (islab = 0; islab < t8_element_slab_pool_count; islab++) {
+    if (t8_element_slab_pool_bytes[islab] >= num_bytes) {
+      slab = t8_element_slab_pool[islab];
+      *alloc_bytes = t8_element_slab_pool_bytes[islab];
+      t8_element_slab_pool_count--;
+      t8_element_slab_pool[islab] =
+        t8_element_slab_pool[t8_element_slab_pool_count];
+      t8_element_slab_pool_bytes[islab] =
+        t8_element_slab_pool_bytes[t8_element_slab_pool_count];
+      return slab;
+    }
+  }
+  *alloc_bytes = num_bytes;
+
+  /* We allocate with posix_memalign instead of T8_ALLOC, since the malloc
+   * family does not provide alignment. */
+  ret = posix_memalign ((void **) &slab, align, num_bytes);
+  SC_CHECK_ABORT (ret == 0 && slab != NULL,
+                  "Slab allocation for element storage failed.");
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (num_bytes >= T8_ELEMENT_SLAB_HUGEPAGE_BYTES) {
+    /* Best effort advice; a failure only costs the huge page backing */
+    (void) madvise (slab, num_bytes, MADV_HUGEPAGE);
+  }
+#endif
+#if T8_ENABLE_OPENMP
+  {
+    /* First-touch the pages from a statically scheduled parallel loop, so
+     * that they are placed on the NUMA domains of the threads that later
+     * sweep the elements with the same schedule. The thread count is
+     * clamped to the process-wide limit of
+     * t8_thread_pool_set_num_threads. */
+    const size_t        page_bytes = 4096;
+    size_t              ipage;
+    const size_t        num_pages = num_bytes / page_bytes;
+#pragma omp parallel for schedule (static) \
+  num_threads (t8_thread_pool_clamp_num_threads (omp_get_max_threads ()))
+    for (ipage = 0; ipage < num_pages; ipage++) {
+      slab[ipage * page_bytes] = 0;
+    }
+  }
+#endif
+  return slab;
+}
+
+/* Set the element count of an array in slab mode, growing the slab
+ * geometrically if necessary. The sc_array of the element array is
+ * reinitialized as a view of the slab. */
+static void
+t8_element_array_slab_set_count (t8_element_array_t *element_array,
+                                 size_t new_count)
+{
+  const size_t        elem_size = element_array->array.elem_size;
+  const size_t        new_bytes = new_count * elem_size;
+  char               *new_slab;
+
+  if (element_array->slab == NULL || new_bytes > element_array->slab_bytes) {
+    /* Grow at least geometrically and always allocate the slab, even for
+     * empty arrays, since a non-NULL slab marks the array as slab mode. */
+    size_t              grow_bytes =
+      SC_MAX (new_bytes, 2 * element_array->slab_bytes);
+    grow_bytes = SC_MAX (grow_bytes, elem_size);
+    new_slab = t8_element_slab_alloc (grow_bytes, &grow_bytes);
+    if (element_array->slab != NULL) {
+      memcpy (new_slab, element_array->slab,
+              element_array->array.elem_count * elem_size);
+      t8_element_slab_release (element_array->slab,
+                               element_array->slab_bytes);
+    }
+    element_array->slab = new_slab;
+    element_array->slab_bytes = grow_bytes;
+  }
+  sc_array_init_data (&element_array->array, element_array->slab, elem_size,
+                      new_count);
+}
+
 #ifdef T8_ENABLE_DEBUG
 /* Query whether an element array is initialized properly. */
 static int
@@ -54,6 +201,22 @@ t8_element_array_is_valid (t8_element_array_t *element_array)
 }
 #endif
 
+/* Drop the linear id cache of an element array.
+ * Must be called by every operation that modifies the stored elements. */
+static void
+t8_element_array_invalidate_id_cache (t8_element_array_t *element_array)
+{
+  if (element_array->id_cache != NULL) {
+    T8_FREE (element_array->id_cache);
+    element_array->id_cache = NULL;
+  }
+  if (element_array->id_sample_cache != NULL) {
+    T8_FREE (element_array->id_sample_cache);
+    element_array->id_sample_cache = NULL;
+  }
+  element_array->id_cache_maxlevel = -1;
+}
+
 t8_element_array_t *
 t8_element_array_new (t8_eclass_scheme_c *scheme)
 {
@@ -95,20 +258,48 @@ t8_element_array_init (t8_element_array_t *element_array,
   /* get the size of an element and initialize the array member */
   elem_size = scheme->t8_element_size ();
   sc_array_init (&element_array->array, elem_size);
+  element_array->id_cache = NULL;
+  element_array->id_sample_cache = NULL;
+  element_array->id_cache_maxlevel = -1;
+  element_array->slab = NULL;
+  element_array->slab_bytes = 0;
   T8_ASSERT (t8_element_array_is_valid (element_array));
 }
 
 void
 t8_element_array_init_size (t8_element_array_t *element_array,
                             t8_eclass_scheme_c *scheme, size_t num_elements)
+{
+  t8_element_array_init_size_mode (element_array, scheme, num_elements,
+                                   T8_ELEMENT_MEMORY_DEFAULT);
+}
+
+void
+t8_element_array_init_size_mode (t8_element_array_t *element_array,
+                                 t8_eclass_scheme_c *scheme,
+                                 size_t num_elements,
+                                 t8_element_memory_mode_t memory_mode)
 {
   t8_element_t       *first_element;
   T8_ASSERT (element_array != NULL);
 
   element_array->scheme = scheme;
+  element_array->id_cache = NULL;
+  element_array->id_sample_cache = NULL;
+  element_array->id_cache_maxlevel = -1;
+  element_array->slab = NULL;
+  element_array->slab_bytes = 0;
   /* allocate the elements */
-  sc_array_init_size (&element_array->array, scheme->t8_element_size (),
-                      num_elements);
+  if (memory_mode == T8_ELEMENT_MEMORY_SLAB) {
+    /* Initialize the array with the element size only, the storage comes
+     * from an aligned slab. */
+    sc_array_init (&element_array->array, scheme->t8_element_size ());
+    t8_element_array_slab_set_count (element_array, num_elements);
+  }
+  else {
+    sc_array_init_size (&element_array->array, scheme->t8_element_size (),
+                        num_elements);
+  }
 
   if (num_elements > 0) {
     /* Call t8_element_init for the elements */
@@ -130,6 +321,13 @@ t8_element_array_init_view (t8_element_array_t *view,
   sc_array_init_view (&view->array, &array->array, offset, length);
   /* Set the scheme */
   view->scheme = array->scheme;
+  /* Views do not inherit the id cache of the viewed array */
+  view->id_cache = NULL;
+  view->id_sample_cache = NULL;
+  view->id_cache_maxlevel = -1;
+  /* Views do not own the slab of the viewed array */
+  view->slab = NULL;
+  view->slab_bytes = 0;
   T8_ASSERT (t8_element_array_is_valid (view));
 }
 
@@ -142,6 +340,11 @@ t8_element_array_init_data (t8_element_array_t *view, t8_element_t *base,
                       elem_count);
   /* set the scheme */
   view->scheme = scheme;
+  view->id_cache = NULL;
+  view->id_sample_cache = NULL;
+  view->id_cache_maxlevel = -1;
+  view->slab = NULL;
+  view->slab_bytes = 0;
   T8_ASSERT (t8_element_array_is_valid (view));
 }
 
@@ -183,10 +386,16 @@ t8_element_array_resize (t8_element_array_t *element_array, size_t new_count)
 {
   size_t              old_count;
   T8_ASSERT (t8_element_array_is_valid (element_array));
+  t8_element_array_invalidate_id_cache (element_array);
   /* Store the old number of elements */
   old_count = t8_element_array_get_count (element_array);
   /* resize the data array */
-  sc_array_resize (&element_array->array, new_count);
+  if (element_array->slab != NULL) {
+    t8_element_array_slab_set_count (element_array, new_count);
+  }
+  else {
+    sc_array_resize (&element_array->array, new_count);
+  }
   /* if the new_count is larger than the previous count, we need to
    * call t8_element_init on the newly allocated elements. */
   if (old_count < new_count) {
@@ -205,7 +414,16 @@ t8_element_array_copy (t8_element_array_t *dest, t8_element_array_t *src)
   T8_ASSERT (t8_element_array_is_valid (dest));
   T8_ASSERT (t8_element_array_is_valid (src));
   T8_ASSERT (dest->scheme == src->scheme);
-  sc_array_copy (&dest->array, &src->array);
+  t8_element_array_invalidate_id_cache (dest);
+  if (dest->slab != NULL) {
+    /* sc_array_copy cannot resize a slab view */
+    t8_element_array_slab_set_count (dest, src->array.elem_count);
+    memcpy (dest->array.array, src->array.array,
+            src->array.elem_count * src->array.elem_size);
+  }
+  else {
+    sc_array_copy (&dest->array, &src->array);
+  }
 }
 
 t8_element_t       *
@@ -213,8 +431,17 @@ t8_element_array_push (t8_element_array_t *element_array)
 {
   t8_element_t       *new_element;
   T8_ASSERT (t8_element_array_is_valid (element_array));
-  new_element = (t8_element_t *)
-    sc_array_push (&element_array->array);
+  t8_element_array_invalidate_id_cache (element_array);
+  if (element_array->slab != NULL) {
+    const size_t        old_count = element_array->array.elem_count;
+    t8_element_array_slab_set_count (element_array, old_count + 1);
+    new_element = (t8_element_t *)
+      sc_array_index (&element_array->array, old_count);
+  }
+  else {
+    new_element = (t8_element_t *)
+      sc_array_push (&element_array->array);
+  }
   element_array->scheme->t8_element_init (1, new_element, 0);
   return new_element;
 }
@@ -224,14 +451,85 @@ t8_element_array_push_count (t8_element_array_t *element_array, size_t count)
 {
   t8_element_t       *new_elements;
   T8_ASSERT (t8_element_array_is_valid (element_array));
+  t8_element_array_invalidate_id_cache (element_array);
   /* grow the array */
-  new_elements = (t8_element_t *)
-    sc_array_push_count (&element_array->array, count);
+  if (element_array->slab != NULL) {
+    const size_t        old_count = element_array->array.elem_count;
+    t8_element_array_slab_set_count (element_array, old_count + count);
+    new_elements = (t8_element_t *)
+      (element_array->array.array + old_count * element_array->array.elem_size);
+  }
+  else {
+    new_elements = (t8_element_t *)
+      sc_array_push_count (&element_array->array, count);
+  }
   /* initialize the elements */
   element_array->scheme->t8_element_init (count, new_elements, 0);
   return new_elements;
 }
 
+void
+t8_element_array_build_id_cache (t8_element_array_t *element_array,
+                                 int maxlevel)
+{
+  const t8_element_t *element;
+  size_t              ielem, count, num_samples;
+
+  T8_ASSERT (t8_element_array_is_valid (element_array));
+  T8_ASSERT (0 <= maxlevel
+             && maxlevel <= element_array->scheme->t8_element_maxlevel ());
+
+  count = element_array->array.elem_count;
+  /* (Re)allocate the cache to the current element count */
+  element_array->id_cache =
+    T8_REALLOC (element_array->id_cache, t8_linearidx_t, count);
+  for (ielem = 0; ielem < count; ielem++) {
+    element =
+      (const t8_element_t *) sc_array_index (&element_array->array, ielem);
+    element_array->id_cache[ielem] =
+      element_array->scheme->t8_element_get_linear_id (element, maxlevel);
+  }
+  /* Sample every T8_ELEMENT_ARRAY_ID_SAMPLE_STRIDE-th id into the small
+   * second level that narrows a search to one stride sized range. */
+  num_samples = (count + T8_ELEMENT_ARRAY_ID_SAMPLE_STRIDE - 1)
+    / T8_ELEMENT_ARRAY_ID_SAMPLE_STRIDE;
+  element_array->id_sample_cache =
+    T8_REALLOC (element_array->id_sample_cache, t8_linearidx_t, num_samples);
+  for (ielem = 0; ielem < num_samples; ielem++) {
+    element_array->id_sample_cache[ielem] =
+      element_array->id_cache[ielem * T8_ELEMENT_ARRAY_ID_SAMPLE_STRIDE];
+  }
+  element_array->id_cache_maxlevel = maxlevel;
+}
+
+const t8_linearidx_t *
+t8_element_array_get_id_cache (t8_element_array_t *element_array,
+                               int maxlevel)
+{
+  T8_ASSERT (t8_element_array_is_valid (element_array));
+  if (element_array->id_cache != NULL
+      && element_array->id_cache_maxlevel == maxlevel) {
+    return element_array->id_cache;
+  }
+  return NULL;
+}
+
+const t8_linearidx_t *
+t8_element_array_get_id_sample_cache (t8_element_array_t *element_array,
+                                      int maxlevel, size_t *num_samples)
+{
+  T8_ASSERT (t8_element_array_is_valid (element_array));
+  if (element_array->id_sample_cache != NULL
+      && element_array->id_cache_maxlevel == maxlevel) {
+    *num_samples = (element_array->array.elem_count
+                    + T8_ELEMENT_ARRAY_ID_SAMPLE_STRIDE - 1)
+      / T8_ELEMENT_ARRAY_ID_SAMPLE_STRIDE;
+    return element_array->id_sample_cache;
+  }
+  *num_samples = 0;
+  return NULL;
+}
+
 t8_element_t       *
 t8_element_array_index_locidx (t8_element_array_t *element_array,
                                t8_locidx_t index)
@@ -270,6 +568,29 @@ t8_element_array_get_size (t8_element_array_t *element_array)
   return element_array->scheme->t8_element_size ();
 }
 
+size_t
+t8_element_array_get_memory_used (t8_element_array_t *element_array)
+{
+  size_t              bytes;
+
+  T8_ASSERT (t8_element_array_is_valid (element_array));
+  if (element_array->slab != NULL) {
+    /* In slab mode the array is a view into the slab */
+    bytes = element_array->slab_bytes;
+  }
+  else if (element_array->array.byte_alloc >= 0) {
+    bytes = (size_t) element_array->array.byte_alloc;
+  }
+  else {
+    /* A view; count the bytes of the stored elements */
+    bytes = element_array->array.elem_count * element_array->array.elem_size;
+  }
+  if (element_array->id_cache != NULL) {
+    bytes += element_array->array.elem_count * sizeof (t8_linearidx_t);
+  }
+  return bytes;
+}
+
 t8_element_t       *
 t8_element_array_get_data (t8_element_array_t *element_array)
 {
@@ -295,14 +616,31 @@ void
 t8_element_array_reset (t8_element_array_t *element_array)
 {
   T8_ASSERT (t8_element_array_is_valid (element_array));
-  sc_array_reset (&element_array->array);
+  t8_element_array_invalidate_id_cache (element_array);
+  if (element_array->slab != NULL) {
+    /* The slab view does not own its memory, retire the slab instead */
+    t8_element_slab_release (element_array->slab, element_array->slab_bytes);
+    element_array->slab = NULL;
+    element_array->slab_bytes = 0;
+    sc_array_init (&element_array->array, element_array->array.elem_size);
+  }
+  else {
+    sc_array_reset (&element_array->array);
+  }
 }
 
 void
 t8_element_array_truncate (t8_element_array_t *element_array)
 {
   T8_ASSERT (t8_element_array_is_valid (element_array));
-  sc_array_truncate (&element_array->array);
+  t8_element_array_invalidate_id_cache (element_array);
+  if (element_array->slab != NULL) {
+    /* Keep the slab for reuse, only drop the elements */
+    t8_element_array_slab_set_count (element_array, 0);
+  }
+  else {
+    sc_array_truncate (&element_array->array);
+  }
 }
 
 T8_EXTERN_C_END ();
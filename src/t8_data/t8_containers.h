@@ -31,6 +31,31 @@
 #include <t8.h>
 #include <t8_element.h>
 
+/** Selects how the element storage of a \ref t8_element_array_t is
+ * allocated.
+ * \see t8_element_array_init_size_mode
+ */
+typedef enum t8_element_memory_mode
+{
+  T8_ELEMENT_MEMORY_DEFAULT, /**< The storage is managed by sc_array and
+                                  grows by realloc. */
+  T8_ELEMENT_MEMORY_SLAB     /**< The storage is one aligned slab. Slabs of
+                                  at least one huge page are aligned to the
+                                  huge page size and advised to be backed by
+                                  transparent huge pages, and their pages are
+                                  first touched by the threads of a parallel
+                                  loop, so that they distribute over the NUMA
+                                  domains of the threads that later sweep the
+                                  elements. Growth allocates a new slab and
+                                  copies the elements. */
+} t8_element_memory_mode_t;
+
+/** The stride of the sampled second level of the linear id cache of a
+ * \ref t8_element_array_t: every this many-th cached id is duplicated into
+ * a small array that narrows an id search to one stride-sized range.
+ * \see t8_element_array_build_id_cache */
+#define T8_ELEMENT_ARRAY_ID_SAMPLE_STRIDE 256
+
 /** The t8_element_array_t is an array to store t8_element_t * of a given
  * eclass_scheme implementation. It is a wrapper around \ref sc_array_t.
  * Each time, a new element is created by the functions for \ref t8_element_array_t,
@@ -42,10 +67,44 @@ typedef struct
 {
   t8_eclass_scheme_c *scheme; /**< An eclass scheme of which elements should be stored */
   sc_array_t          array;  /**< The array in which the elements are stored */
+  t8_linearidx_t     *id_cache; /**< If not NULL, the linear ids of all stored elements at
+                                     level \a id_cache_maxlevel, in storage order. Searches
+                                     can then compare plain integers instead of calling
+                                     virtual element functions per probe. NULL until
+                                     \ref t8_element_array_build_id_cache is called and
+                                     after any operation that modifies the array. */
+  int                 id_cache_maxlevel; /**< The level at which the cached linear ids were
+                                     computed. -1 if \a id_cache is NULL. */
+  t8_linearidx_t     *id_sample_cache; /**< If not NULL, every
+                                     \ref T8_ELEMENT_ARRAY_ID_SAMPLE_STRIDE-th entry of
+                                     \a id_cache. An id search narrows its range over this
+                                     small array first and only then touches the stride
+                                     sized range of \a id_cache it selects. Built and
+                                     invalidated together with \a id_cache. */
+  char               *slab;   /**< If not NULL, the elements live in this aligned
+                                   slab and \a array is a view into it.
+                                   \see T8_ELEMENT_MEMORY_SLAB */
+  size_t              slab_bytes; /**< The allocated byte count of \a slab. */
 } t8_element_array_t;
 
 T8_EXTERN_C_BEGIN ();
 
+/** Enable or disable pooling of retired element storage slabs.
+ * With pooling enabled, the slabs of destroyed element arrays in
+ * \ref T8_ELEMENT_MEMORY_SLAB mode are retained and reused for new
+ * slab allocations instead of being returned to the system allocator.
+ * Disabling the pool frees all retained slabs.
+ * \param [in] enable   True to pool retired slabs, false to free them.
+ * \see t8_forest_swap_storage
+ */
+void                t8_element_array_slab_pool_set (int enable);
+
+/** Free all slabs currently retained in the slab pool.
+ * The pool stays enabled if it was enabled before; only its current
+ * contents are released.
+ */
+void                t8_element_array_slab_pool_clear (void);
+
 /** Creates a new array structure with 0 elements.
  * \param [in] scheme   The eclass scheme of which elements should be stored.
  * \return              Return an allocated array of zero length.
@@ -81,6 +140,22 @@ void                t8_element_array_init_size (t8_element_array_t
                                                 t8_eclass_scheme_c *scheme,
                                                 size_t num_elements);
 
+/** Like \ref t8_element_array_init_size with an additional choice of the
+ * allocation mode of the element storage.
+ * \param [in,out]  element_array Array structure to be initialized.
+ * \param [in] scheme         The eclass scheme of which elements should be stored.
+ * \param [in] num_elements   Number of initial array elements.
+ * \param [in] memory_mode    The allocation mode of the element storage,
+ *                            \see t8_element_memory_mode_t.
+ */
+void                t8_element_array_init_size_mode (t8_element_array_t
+                                                     *element_array,
+                                                     t8_eclass_scheme_c
+                                                     *scheme,
+                                                     size_t num_elements,
+                                                     t8_element_memory_mode_t
+                                                     memory_mode);
+
 /** Initializes an already allocated (or static) view from existing t8_element_array.
  * The array view returned does not require t8_element_array_reset (doesn't hurt though).
  * \param [in,out] view  Array structure to be initialized.
@@ -163,6 +238,46 @@ t8_element_t       *t8_element_array_push_count (t8_element_array_t
                                                  *element_array,
                                                  size_t count);
 
+/** Build (or rebuild) the linear id cache of an element array.
+ * After this call \ref t8_element_array_get_id_cache returns the linear ids
+ * of all stored elements at level \a maxlevel. The cache is invalidated by
+ * any operation that modifies the array and stores the ids for one level at
+ * a time; building it for a different level overwrites the previous cache.
+ * \param [in,out] element_array Array of elements.
+ * \param [in]     maxlevel      The level at which the linear ids are computed.
+ */
+void                t8_element_array_build_id_cache (t8_element_array_t
+                                                     *element_array,
+                                                     int maxlevel);
+
+/** Return the linear id cache of an element array, if it is valid.
+ * \param [in]  element_array Array of elements.
+ * \param [in]  maxlevel      The level at which the cached ids must have been
+ *                            computed.
+ * \return      An array of the linear ids at level \a maxlevel of all stored
+ *              elements, in storage order, or NULL if no cache for this level
+ *              was built. \see t8_element_array_build_id_cache
+ */
+const t8_linearidx_t *t8_element_array_get_id_cache (t8_element_array_t
+                                                     *element_array,
+                                                     int maxlevel);
+
+/** Return the sampled second level of the linear id cache, if it is valid.
+ * \param [in]  element_array Array of elements.
+ * \param [in]  maxlevel      The level at which the cached ids must have been
+ *                            computed.
+ * \param [out] num_samples   On output the number of sampled ids.
+ * \return      An array holding every
+ *              \ref T8_ELEMENT_ARRAY_ID_SAMPLE_STRIDE-th cached linear id,
+ *              or NULL if no cache for this level was built.
+ *              \see t8_element_array_build_id_cache
+ */
+const t8_linearidx_t *t8_element_array_get_id_sample_cache (t8_element_array_t
+                                                            *element_array,
+                                                            int maxlevel,
+                                                            size_t
+                                                            *num_samples);
+
 /** Return a given element in an array.
  * \param [in]  element_array Array of elements.
  * \param [in]  index The index of an element whithin the array.
@@ -182,6 +297,129 @@ t8_element_t       *t8_element_array_index_locidx (t8_element_array_t
 t8_element_t       *t8_element_array_index_int (t8_element_array_t
                                                 *element_array, int index);
 
+/** Return a given element in an array without any validity checks.
+ * Unlike \ref t8_element_array_index_locidx this is an inline address
+ * computation with no assertions, so it fully inlines into hot sweep
+ * loops even in debug enabled builds.
+ * \param [in]  element_array Array of elements. Must be valid and \a index
+ *                            must be a valid index; this is not checked.
+ * \param [in]  index The index of an element whithin the array.
+ * \return            A pointer to the element stored at position \a index in
+ *                    \a element_array.
+ */
+static inline t8_element_t *
+t8_element_array_index_locidx_unchecked (const t8_element_array_t
+                                         *element_array, t8_locidx_t index)
+{
+  return (t8_element_t *) (element_array->array.array +
+                           element_array->array.elem_size * (size_t) index);
+}
+
+/** Issue a software prefetch for a memory address.
+ * Expands to nothing on compilers without \a __builtin_prefetch. */
+#ifdef __GNUC__
+#define T8_PREFETCH(addr) __builtin_prefetch (addr)
+#else
+#define T8_PREFETCH(addr) do { (void) (addr); } while (0)
+#endif
+
+/** The maximum number of user data arrays of a sweep iterator. */
+#define T8_ELEMENT_ARRAY_SWEEP_MAX_USER_ARRAYS 3
+
+/** The default prefetch distance (in elements) of a sweep iterator. */
+#define T8_ELEMENT_ARRAY_SWEEP_PREFETCH_DEFAULT 8
+
+/** Iterator for sweeps over the elements of a \ref t8_element_array_t.
+ * Leaf sweeps touch the elements in SFC order, but the per element user
+ * data usually lives in separate arrays, so each element of the sweep
+ * pulls several independent cache lines. The iterator issues software
+ * prefetches a configurable distance ahead into the element storage and
+ * into up to \ref T8_ELEMENT_ARRAY_SWEEP_MAX_USER_ARRAYS registered user
+ * arrays, so those lines are in flight while the body of the sweep runs.
+ * Initialize with \ref t8_element_array_sweep_init, register user arrays
+ * with \ref t8_element_array_sweep_add_user and advance with
+ * \ref t8_element_array_sweep_next. No heap allocation is performed; the
+ * iterator lives on the caller's stack and must not outlive the array.
+ */
+typedef struct
+{
+  const char         *elem_base; /**< The base address of the element storage. */
+  size_t              elem_size; /**< The byte size of one element. */
+  size_t              index;     /**< The index of the next element to return. */
+  size_t              count;     /**< The number of elements of the sweep. */
+  size_t              prefetch_distance; /**< How many elements ahead to prefetch. */
+  int                 num_user;  /**< The number of registered user arrays. */
+  const char         *user_base[T8_ELEMENT_ARRAY_SWEEP_MAX_USER_ARRAYS]; /**< The user array base addresses. */
+  size_t              user_size[T8_ELEMENT_ARRAY_SWEEP_MAX_USER_ARRAYS]; /**< The per element byte sizes of the user arrays. */
+} t8_element_array_sweep_t;
+
+/** Initialize a sweep iterator over all elements of an element array.
+ * \param [out] sweep         The iterator to initialize.
+ * \param [in]  element_array The array whose elements are swept. Must not
+ *                            be modified while the sweep is in progress.
+ * \param [in]  prefetch_distance How many elements ahead of the current one
+ *                            the storage is prefetched. Pass 0 for the
+ *                            default \ref T8_ELEMENT_ARRAY_SWEEP_PREFETCH_DEFAULT.
+ */
+static inline void
+t8_element_array_sweep_init (t8_element_array_sweep_t *sweep,
+                             const t8_element_array_t *element_array,
+                             size_t prefetch_distance)
+{
+  sweep->elem_base = element_array->array.array;
+  sweep->elem_size = element_array->array.elem_size;
+  sweep->index = 0;
+  sweep->count = element_array->array.elem_count;
+  sweep->prefetch_distance = prefetch_distance > 0 ? prefetch_distance :
+    (size_t) T8_ELEMENT_ARRAY_SWEEP_PREFETCH_DEFAULT;
+  sweep->num_user = 0;
+}
+
+/** Register a user data array with a sweep iterator.
+ * The array must hold one entry of \a entry_bytes bytes per element of the
+ * swept element array, in the same order. Its entries are prefetched
+ * alongside the element storage.
+ * \param [in,out] sweep      An initialized sweep iterator.
+ * \param [in]     user_data  The base address of the user data array.
+ * \param [in]     entry_bytes The byte size of one entry of \a user_data.
+ */
+static inline void
+t8_element_array_sweep_add_user (t8_element_array_sweep_t *sweep,
+                                 const void *user_data, size_t entry_bytes)
+{
+  T8_ASSERT (sweep->num_user < T8_ELEMENT_ARRAY_SWEEP_MAX_USER_ARRAYS);
+  sweep->user_base[sweep->num_user] = (const char *) user_data;
+  sweep->user_size[sweep->num_user] = entry_bytes;
+  sweep->num_user++;
+}
+
+/** Return the next element of a sweep and prefetch ahead.
+ * \param [in,out] sweep An initialized sweep iterator.
+ * \return The next element of the sweep, or NULL if all elements have been
+ *         returned. The index of the returned element is the value of
+ *         sweep->index before the call.
+ */
+static inline t8_element_t *
+t8_element_array_sweep_next (t8_element_array_sweep_t *sweep)
+{
+  const size_t        index = sweep->index;
+
+  if (index >= sweep->count) {
+    return NULL;
+  }
+  if (index + sweep->prefetch_distance < sweep->count) {
+    const size_t        pindex = index + sweep->prefetch_distance;
+    int                 iuser;
+
+    T8_PREFETCH (sweep->elem_base + pindex * sweep->elem_size);
+    for (iuser = 0; iuser < sweep->num_user; iuser++) {
+      T8_PREFETCH (sweep->user_base[iuser] + pindex * sweep->user_size[iuser]);
+    }
+  }
+  sweep->index = index + 1;
+  return (t8_element_t *) (sweep->elem_base + index * sweep->elem_size);
+}
+
 /** Return the eclass scheme associated to a t8_element_array.
  * \param [in]  element_array Array of elements.
  * \return      The eclass scheme stored at \a element_array.
@@ -202,6 +440,17 @@ size_t              t8_element_array_get_count (t8_element_array_t
 size_t              t8_element_array_get_size (t8_element_array_t
                                                *element_array);
 
+/** Return the number of bytes of heap memory that the element storage of a
+ * t8_element_array_t occupies, including the unused capacity of the
+ * allocation and the id cache if one was built.
+ * \param [in]  element_array  Array structure.
+ * \return                     The allocated byte count of the storage of
+ *                             \a element_array. For a view, the byte count
+ *                             of the viewed elements.
+ */
+size_t              t8_element_array_get_memory_used (t8_element_array_t
+                                                      *element_array);
+
 /** Return a pointer to the real data array stored in a t8_element_array.
  * \param [in]  element_array  Array structure.
  * \return                     A pointer to the stored data. If the number of stored
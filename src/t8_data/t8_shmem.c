@@ -26,6 +26,7 @@
  */
 
 #include <t8_data/t8_shmem.h>
+#include <t8_mpi_profile.h>
 
 /* TODO: Think about whether we include a reference counter */
 
@@ -94,6 +95,58 @@ t8_shmem_finalize (sc_MPI_Comm comm)
   }
 }
 
+sc_MPI_Comm
+t8_shmem_new_node_ordered_comm (sc_MPI_Comm comm)
+{
+  sc_MPI_Comm         intranode, internode, ordered;
+  int                 intra_rank, intra_size;
+  int                 inter_rank, inter_size;
+  int                *node_sizes;
+  int                 node_offset, inode, mpiret;
+
+  SC_CHECK_ABORT (comm != sc_MPI_COMM_NULL,
+                  "Trying to node-order a NULL communicator.");
+
+  /* Make sure the node split of the communicator is computed */
+  t8_shmem_init (comm);
+  sc_mpi_comm_get_node_comms (comm, &intranode, &internode);
+  if (intranode == sc_MPI_COMM_NULL || internode == sc_MPI_COMM_NULL) {
+    /* Without node information we keep the present rank order */
+    mpiret = sc_MPI_Comm_dup (comm, &ordered);
+    SC_CHECK_MPI (mpiret);
+    return ordered;
+  }
+  mpiret = sc_MPI_Comm_rank (intranode, &intra_rank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (intranode, &intra_size);
+  SC_CHECK_MPI (mpiret);
+  /* The first new rank of this node is the number of ranks on the
+   * preceding nodes. The node roots compute it from the node sizes and
+   * broadcast it within their node; the internode communicator of the
+   * node roots holds exactly one rank per node. */
+  node_offset = 0;
+  if (intra_rank == 0) {
+    mpiret = sc_MPI_Comm_rank (internode, &inter_rank);
+    SC_CHECK_MPI (mpiret);
+    mpiret = sc_MPI_Comm_size (internode, &inter_size);
+    SC_CHECK_MPI (mpiret);
+    node_sizes = T8_ALLOC (int, inter_size);
+    mpiret = t8_mpi_profile_allgather (&intra_size, 1, sc_MPI_INT, node_sizes, 1,
+                                       sc_MPI_INT, internode, T8_MPI_PROFILE_SHMEM);
+    SC_CHECK_MPI (mpiret);
+    for (inode = 0; inode < inter_rank; inode++) {
+      node_offset += node_sizes[inode];
+    }
+    T8_FREE (node_sizes);
+  }
+  mpiret = t8_mpi_profile_bcast (&node_offset, 1, sc_MPI_INT, 0, intranode, T8_MPI_PROFILE_SHMEM);
+  SC_CHECK_MPI (mpiret);
+  /* Renumber the ranks node-contiguously */
+  mpiret = sc_MPI_Comm_split (comm, 0, node_offset + intra_rank, &ordered);
+  SC_CHECK_MPI (mpiret);
+  return ordered;
+}
+
 void
 t8_shmem_set_type (sc_MPI_Comm comm, sc_shmem_type_t type)
 {
@@ -114,6 +167,122 @@ t8_shmem_set_type (sc_MPI_Comm comm, sc_shmem_type_t type)
   sc_shmem_set_type (comm, type);
 }
 
+/* Session cache of auto-tuned shared memory types, keyed by communicator.
+ * Applications use a handful of communicators at most, so a small linear
+ * table suffices; once the table is full further communicators are tuned
+ * again on each query, which only happens if their type was reset. */
+#define T8_SHMEM_TUNE_CACHE 8
+/** Number of timed allgather rounds per candidate strategy. */
+#define T8_SHMEM_TUNE_ROUNDS 10
+
+static int          t8_shmem_autotune_enabled = 0;
+static int          t8_shmem_tune_num_cached = 0;
+static sc_MPI_Comm  t8_shmem_tune_comms[T8_SHMEM_TUNE_CACHE];
+static sc_shmem_type_t t8_shmem_tune_types[T8_SHMEM_TUNE_CACHE];
+
+void
+t8_shmem_set_autotune (int enable)
+{
+  t8_shmem_autotune_enabled = enable != 0;
+}
+
+/* Time one candidate shared memory type with the offset array allgather
+ * pattern, one t8_gloidx_t per process, which dominates the shmem traffic
+ * of partition and commit. The scratch array is allocated and freed under
+ * the candidate type, so no other array may exist on \a comm.
+ * Returns the time of the slowest process, so that all processes rank the
+ * candidates identically. */
+static double
+t8_shmem_tune_time_type (sc_MPI_Comm comm, sc_shmem_type_t type,
+                         int mpisize, int mpirank)
+{
+  t8_gloidx_t        *scratch;
+  t8_gloidx_t         sendval;
+  double              elapsed, maxtime;
+  int                 iround, mpiret;
+
+  sc_shmem_set_type (comm, type);
+  scratch = (t8_gloidx_t *)
+    sc_shmem_malloc (t8_get_package_id (), sizeof (t8_gloidx_t), mpisize,
+                     comm);
+  sendval = (t8_gloidx_t) mpirank;
+  /* One warmup round pays the setup cost of the strategy */
+  sc_shmem_allgather (&sendval, 1, T8_MPI_GLOIDX, scratch, 1, T8_MPI_GLOIDX,
+                      comm);
+  mpiret = sc_MPI_Barrier (comm);
+  SC_CHECK_MPI (mpiret);
+  elapsed = -sc_MPI_Wtime ();
+  for (iround = 0; iround < T8_SHMEM_TUNE_ROUNDS; iround++) {
+    sc_shmem_allgather (&sendval, 1, T8_MPI_GLOIDX, scratch, 1,
+                        T8_MPI_GLOIDX, comm);
+  }
+  elapsed += sc_MPI_Wtime ();
+  sc_shmem_free (t8_get_package_id (), scratch, comm);
+  mpiret = sc_MPI_Allreduce (&elapsed, &maxtime, 1, sc_MPI_DOUBLE,
+                             sc_MPI_MAX, comm);
+  SC_CHECK_MPI (mpiret);
+  return maxtime;
+}
+
+sc_shmem_type_t
+t8_shmem_autotune_type (sc_MPI_Comm comm)
+{
+  sc_shmem_type_t     candidates[6];
+  sc_shmem_type_t     best_type;
+  sc_MPI_Comm         intranode, internode;
+  double              best_time, cand_time;
+  int                 num_candidates, icand, icache;
+  int                 mpisize, mpirank, mpiret;
+
+  /* Serve repeated queries from the session cache */
+  for (icache = 0; icache < t8_shmem_tune_num_cached; icache++) {
+    if (t8_shmem_tune_comms[icache] == comm) {
+      return t8_shmem_tune_types[icache];
+    }
+  }
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  candidates[0] = SC_SHMEM_BASIC;
+  candidates[1] = SC_SHMEM_PRESCAN;
+  num_candidates = 2;
+  /* The window and BGQ strategies need the node split of the communicator */
+  sc_mpi_comm_get_node_comms (comm, &intranode, &internode);
+  if (intranode != sc_MPI_COMM_NULL && internode != sc_MPI_COMM_NULL) {
+#if defined(__bgq__)
+    candidates[num_candidates++] = SC_SHMEM_BGQ;
+    candidates[num_candidates++] = SC_SHMEM_BGQ_PRESCAN;
+#endif
+#if defined(SC_ENABLE_MPIWINSHARED)
+    candidates[num_candidates++] = SC_SHMEM_WINDOW;
+    candidates[num_candidates++] = SC_SHMEM_WINDOW_PRESCAN;
+#endif
+  }
+  best_type = candidates[0];
+  best_time = -1;
+  for (icand = 0; icand < num_candidates; icand++) {
+    cand_time = t8_shmem_tune_time_type (comm, candidates[icand], mpisize,
+                                         mpirank);
+    if (icand == 0 || cand_time < best_time) {
+      best_type = candidates[icand];
+      best_time = cand_time;
+    }
+  }
+  /* Fix the winner as the communicator's type for the session */
+  sc_shmem_set_type (comm, best_type);
+  t8_debugf ("Auto-tuned shmem type %i for a communicator of size %i "
+             "(%i candidates, winner %.3es per %i allgathers).\n",
+             (int) best_type, mpisize, num_candidates, best_time,
+             T8_SHMEM_TUNE_ROUNDS);
+  if (t8_shmem_tune_num_cached < T8_SHMEM_TUNE_CACHE) {
+    t8_shmem_tune_comms[t8_shmem_tune_num_cached] = comm;
+    t8_shmem_tune_types[t8_shmem_tune_num_cached] = best_type;
+    t8_shmem_tune_num_cached++;
+  }
+  return best_type;
+}
+
 void
 t8_shmem_array_init (t8_shmem_array_t *parray, size_t elem_size,
                      size_t elem_count, sc_MPI_Comm comm)
@@ -139,8 +308,15 @@ t8_shmem_array_init (t8_shmem_array_t *parray, size_t elem_size,
   T8_ASSERT (parray != NULL);
 
   if (sc_shmem_get_type (comm) == SC_SHMEM_NOT_SET) {
-    /* Set the shmem type to the best availble. */
-    t8_shmem_set_type (comm, T8_SHMEM_BEST_TYPE);
+    if (t8_shmem_autotune_enabled) {
+      /* Benchmark the available strategies and keep the winner. This is
+       * only possible while no array exists on the communicator. */
+      t8_shmem_set_type (comm, t8_shmem_autotune_type (comm));
+    }
+    else {
+      /* Set the shmem type to the best availble. */
+      t8_shmem_set_type (comm, T8_SHMEM_BEST_TYPE);
+    }
   }
   array = *parray = T8_ALLOC_ZERO (t8_shmem_array_struct_t, 1);
   array->array = sc_shmem_malloc (t8_get_package_id (), elem_size, elem_count,
@@ -151,7 +327,7 @@ t8_shmem_array_init (t8_shmem_array_t *parray, size_t elem_size,
   array->writing_possible = 0;
   array->write_start_called = 0;
 #ifdef T8_ENABLE_DEBUG
-  array->shmem_type = T8_SHMEM_BEST_TYPE;
+  array->shmem_type = sc_shmem_get_type (comm);
 #endif
 }
 
@@ -247,8 +423,8 @@ t8_compute_recvcounts_displs (int sendcount, int *recvcounts, int *displs,
   int                 mpiret = sc_MPI_Comm_size (comm, &mpisize);
   SC_CHECK_MPI (mpiret);
 
-  mpiret = sc_MPI_Allgather ((void *) &sendcount, 1, sc_MPI_INT, recvcounts,
-                             1, sc_MPI_INT, comm);
+  mpiret = t8_mpi_profile_allgather ((void *) &sendcount, 1, sc_MPI_INT, recvcounts,
+                                     1, sc_MPI_INT, comm, T8_MPI_PROFILE_SHMEM);
   SC_CHECK_MPI (mpiret);
 
   int                 recv_total = recvcounts[0];
@@ -311,9 +487,9 @@ t8_shmem_array_allgatherv_common (void *sendbuf,
     noderecvchar = T8_ALLOC (char, intra_recv_total * typesize);
   }
   mpiret =
-    sc_MPI_Gatherv (sendbuf, sendcount, sendtype, noderecvchar,
-                    intra_recvcounts, intra_displ, recvtype, 0,
-                    intranode_comm);
+    t8_mpi_profile_gatherv (sendbuf, sendcount, sendtype, noderecvchar,
+                            intra_recvcounts, intra_displ, recvtype, 0,
+                            intranode_comm, T8_MPI_PROFILE_SHMEM);
   SC_CHECK_MPI (mpiret);
 
 /* internode-allgatherv */
@@ -325,9 +501,9 @@ t8_shmem_array_allgatherv_common (void *sendbuf,
 
   if (t8_shmem_array_start_writing (recvarray)) {
     mpiret =
-      sc_MPI_Allgatherv (noderecvchar, intra_recv_total, sendtype,
-                         recvarray->array, inter_recvcount, inter_displ,
-                         recvtype, internode_comm);
+      t8_mpi_profile_allgatherv (noderecvchar, intra_recv_total, sendtype,
+                                 recvarray->array, inter_recvcount, inter_displ,
+                                 recvtype, internode_comm, T8_MPI_PROFILE_SHMEM);
     SC_CHECK_MPI (mpiret);
     T8_FREE (noderecvchar);
   }
@@ -373,8 +549,8 @@ t8_shmem_array_allgatherv_basic (void *sendbuf,
                                 sizeof (sendtype), comm);
 
   mpiret =
-    sc_MPI_Allgatherv ((void *) sendbuf, sendcount, sendtype,
-                       recvarray->array, recvcounts, displs, recvtype, comm);
+    t8_mpi_profile_allgatherv ((void *) sendbuf, sendcount, sendtype,
+                               recvarray->array, recvcounts, displs, recvtype, comm, T8_MPI_PROFILE_SHMEM);
   SC_CHECK_MPI (mpiret);
 
   T8_FREE (recvcounts);
@@ -77,6 +77,25 @@ int                 t8_shmem_array_is_initialized (const t8_shmem_array_t
  */
 void                t8_shmem_finalize (sc_MPI_Comm comm);
 
+/** Create a communicator whose ranks are numbered node-contiguously.
+ * On the returned communicator all ranks of one compute node hold
+ * consecutive rank numbers. Committing a forest on it thus places
+ * SFC-adjacent partition segments on node-local ranks, so that most
+ * nearest-neighbor (ghost) communication stays within a node.
+ * The node information is taken from the shmem node split of \a comm,
+ * which is computed if not yet present, \see t8_shmem_init.
+ * If no node split is available, a duplicate of \a comm is returned.
+ * \param [in]          comm    The MPI Communicator. Must not be NULL.
+ * \return              A new communicator with node-ordered ranks.
+ *                      The caller owns it and must free it with
+ *                      sc_MPI_Comm_free after all objects committed on
+ *                      it have been destroyed.
+ * \note This function is MPI collective over \a comm.
+ */
+/* *INDENT-OFF* */
+sc_MPI_Comm         t8_shmem_new_node_ordered_comm (sc_MPI_Comm comm);
+/* *INDENT-ON* */
+
 /** Set a shared memory type of a communicator.
  * If the type was already set it is overwritten.
  * \param [in,out]      comm    The MPI Communicator
@@ -85,6 +104,34 @@ void                t8_shmem_finalize (sc_MPI_Comm comm);
 void                t8_shmem_set_type (sc_MPI_Comm comm,
                                        sc_shmem_type_t type);
 
+/** Enable or disable auto-tuning of the shared memory type.
+ * The best shared memory strategy depends on the machine, the number of
+ * processes and the node layout. With auto-tuning enabled, the first
+ * shared memory array initialized on a communicator whose type is not
+ * yet set microbenchmarks the available strategies with the offset array
+ * allgather pattern and fixes the fastest one for the session, instead
+ * of the compile time default \ref T8_SHMEM_BEST_TYPE.
+ * \param [in]          enable  If true, enable auto-tuning.
+ * \note Auto-tuning is disabled by default. Enable it on all processes
+ *  before the first shared memory array is initialized; the benchmark is
+ *  MPI collective over the respective communicator.
+ */
+void                t8_shmem_set_autotune (int enable);
+
+/** Benchmark the available shared memory strategies on a communicator
+ * and return the fastest one. The winner is also set as the
+ * communicator's shared memory type and cached for the session, so
+ * repeated queries for the same communicator are free.
+ * \param [in]          comm    The MPI Communicator. No shared memory
+ *                              array may currently exist on it, since the
+ *                              benchmark changes its shared memory type.
+ * \return              The fastest shared memory type for \a comm.
+ * \note This function is MPI collective over \a comm.
+ */
+/* *INDENT-OFF* */
+sc_shmem_type_t     t8_shmem_autotune_type (sc_MPI_Comm comm);
+/* *INDENT-ON* */
+
 /** Initialize and allocate a shared memory array structure.
  * \param [in,out]      parray On input this pointer must be non-NULL.
  *                             On return this pointer is set to the new t8_shmem_array.
@@ -44,6 +44,29 @@ typedef struct t8_element t8_element_t;
 /** This typedef holds virtual functions for a particular element class. */
 typedef struct t8_eclass_scheme t8_eclass_scheme_c;
 
+/** Precomputed refinement constants of an element scheme.
+ * A scheme may expose such a table through
+ * \ref t8_eclass_scheme::t8_element_scheme_table. The forest algorithms
+ * query the table once per tree and consume the constants in their inner
+ * loops, so a table driven scheme runs through the same fast paths as the
+ * default schemes without additional virtual calls per element.
+ * All default schemes provide a table. */
+typedef struct t8_scheme_table
+{
+  int                 num_children; /**< The number of children every element refines
+                                         into, or 0 if the count differs between
+                                         elements (as for the default pyramids). */
+  int                 leaf_count_log2;  /**< If >= 0, every element of level \a l covers
+                                         exactly 2^(leaf_count_log2 * (maxlevel - l))
+                                         leafs of the maximum level. Then families can
+                                         be detected from cached linear ids with pure
+                                         integer arithmetic,
+                                         \see t8_forest_adapt. -1 if the descendant
+                                         counts are not of this form. For an isotropic
+                                         1:2^dim refinement this is the dimension, for
+                                         a binary (1:2) refinement it is 1. */
+} t8_scheme_table_t;
+
 typedef struct t8_scheme_cxx t8_scheme_cxx_t;
 
 /** The scheme holds implementations for one or more element classes. */
@@ -54,6 +77,18 @@ struct t8_scheme_cxx
 
   /** This array holds one virtual table per element class. */
   t8_eclass_scheme_c *eclass_schemes[T8_ECLASS_COUNT];
+
+  /** If not NULL, this function is called at the beginning of
+   * \ref t8_scheme_cxx_destroy. Scheme implementations that share one
+   * instance process-wide use this hook to invalidate their cached
+   * pointer to the instance, \see t8_scheme_new_default_cxx. */
+  void                (*destroy_callback) (t8_scheme_cxx_t *scheme);
+
+  /** Cache for the maximum refinement level of each element class.
+   * Values <= 0 mean not computed yet; the cache is filled on first
+   * query in \ref t8_forest_compute_maxlevel so that repeated forest
+   * commits do not walk the virtual tables again. */
+  int                 eclass_maxlevel[T8_ECLASS_COUNT];
 };
 
 extern const double
@@ -35,6 +35,11 @@ t8_scheme_cxx_destroy (t8_scheme_cxx_t *s)
   T8_ASSERT (s != NULL);
   T8_ASSERT (s->rc.refcount == 0);
 
+  if (s->destroy_callback != NULL) {
+    /* Let the scheme implementation drop its cached pointer to this
+     * instance before the memory is freed */
+    s->destroy_callback (s);
+  }
   for (t = 0; t < T8_ECLASS_COUNT; ++t) {
     if (s->eclass_schemes[t] != NULL) {
       delete              s->eclass_schemes[t];
@@ -50,6 +55,14 @@ t8_eclass_scheme::t8_element_size () const
   return element_size;
 }
 
+/* Default implementation for the refinement table. Schemes that do not
+ * provide precomputed constants return NULL and take the generic paths. */
+const t8_scheme_table_t *
+t8_eclass_scheme::t8_element_scheme_table () const
+{
+  return NULL;
+}
+
 /* Default implementation for array_index */
 t8_element_t       *
 t8_eclass_scheme::t8_element_array_index (sc_array_t *array, size_t it) const
@@ -60,4 +73,88 @@ t8_eclass_scheme::t8_element_array_index (sc_array_t *array, size_t it) const
   return (t8_element_t *) sc_array_index (array, it);
 }
 
+/* Default implementation for the allocation contexts. Schemes without
+ * private element storage return NULL and the context taking calls
+ * below route to the shared allocation path. */
+void               *
+t8_eclass_scheme::t8_element_context_new () const
+{
+  return NULL;
+}
+
+void
+t8_eclass_scheme::t8_element_context_destroy (void **context) const
+{
+  T8_ASSERT (context != NULL);
+  T8_ASSERT (*context == NULL);
+}
+
+void
+t8_eclass_scheme::t8_element_new_ctx (void *context, int length,
+                                      t8_element_t **elem) const
+{
+  /* No private storage in the default implementation. */
+  t8_element_new (length, elem);
+}
+
+void
+t8_eclass_scheme::t8_element_destroy_ctx (void *context, int length,
+                                          t8_element_t **elem) const
+{
+  t8_element_destroy (length, elem);
+}
+
+/* Default implementation for batched children construction.
+ * We loop over the range and construct the children of each element
+ * directly inside the output array. */
+void
+t8_eclass_scheme::t8_element_children_batch (sc_array_t *elems,
+                                             size_t first_elem, size_t count,
+                                             sc_array_t *children,
+                                             size_t first_child) const
+{
+  t8_element_t      **child_pointers = NULL;
+  int                 buffer_size = 0;
+  size_t              child_index = first_child;
+
+  T8_ASSERT (elems != children);
+  T8_ASSERT (first_elem + count <= elems->elem_count);
+  for (size_t ielem = 0; ielem < count; ielem++) {
+    const t8_element_t *elem =
+      t8_element_array_index (elems, first_elem + ielem);
+    const int           num_children = t8_element_num_children (elem);
+    if (num_children > buffer_size) {
+      /* Enlarge the pointer buffer. Since the number of children is
+       * bounded by the element class, this happens at most a few times. */
+      child_pointers =
+        T8_REALLOC (child_pointers, t8_element_t *, num_children);
+      buffer_size = num_children;
+    }
+    for (int ichild = 0; ichild < num_children; ichild++) {
+      child_pointers[ichild] =
+        t8_element_array_index (children, child_index + ichild);
+    }
+    t8_element_children (elem, num_children, child_pointers);
+    child_index += num_children;
+  }
+  T8_FREE (child_pointers);
+}
+
+/* Default implementation for batched parent construction. */
+void
+t8_eclass_scheme::t8_element_parent_batch (sc_array_t *elems,
+                                           size_t first_elem, size_t count,
+                                           sc_array_t *parents,
+                                           size_t first_parent) const
+{
+  T8_ASSERT (elems != parents);
+  T8_ASSERT (first_elem + count <= elems->elem_count);
+  T8_ASSERT (first_parent + count <= parents->elem_count);
+  for (size_t ielem = 0; ielem < count; ielem++) {
+    t8_element_parent (t8_element_array_index (elems, first_elem + ielem),
+                       t8_element_array_index (parents,
+                                               first_parent + ielem));
+  }
+}
+
 T8_EXTERN_C_END ();
@@ -72,6 +72,18 @@ public:
    */
   virtual size_t      t8_element_size (void) const;
 
+  /** Return the precomputed refinement table of this scheme, or NULL if
+   * the scheme does not provide one. The forest algorithms call this
+   * function once per tree and consume the returned constants in their
+   * inner loops, so table driven schemes share the fast paths of the
+   * default schemes without per element virtual calls. The returned
+   * pointer must stay valid for the lifetime of the scheme.
+   * We provide a default implementation that returns NULL, so existing
+   * schemes are not affected and simply take the generic paths.
+   * \return            The refinement table of this scheme or NULL.
+   */
+  virtual const t8_scheme_table_t *t8_element_scheme_table (void) const;
+
   /** Returns true, if there is one element in the tree, that does not refine into 2^dim children.
    * Returns false otherwise.
    * \return                    non-zero if there is one element in the tree that does not refine into 2^dim children.
@@ -263,6 +275,55 @@ public:
                                            int length,
                                            t8_element_t *c[]) const = 0;
 
+  /** Construct the children of each element in a range of an array.
+   * This batched version of \ref t8_element_children writes the children
+   * directly into consecutive slots of an output array, such that a sweep
+   * over many elements issues one virtual call per range instead of one
+   * call per element and performs no intermediate element allocations.
+   * We provide a default implementation that loops over the range; scheme
+   * implementations may override it with a specialized version.
+   * \param [in] elems        An array of valid elements of this scheme.
+   * \param [in] first_elem   The index of the first element to refine.
+   * \param [in] count        The number of consecutive elements to refine.
+   * \param [in,out] children An array of allocated elements of this scheme.
+   *                      Starting at \a first_child it must provide one slot
+   *                      for each child of the input range. On output, these
+   *                      slots store the children of the input elements in
+   *                      the order of \ref t8_element_children.
+   * \param [in] first_child  The index of the first output slot to fill.
+   * \note \a elems and \a children must not be the same array.
+   * \see t8_element_children
+   */
+  virtual void        t8_element_children_batch (sc_array_t *elems,
+                                                 size_t first_elem,
+                                                 size_t count,
+                                                 sc_array_t *children,
+                                                 size_t first_child) const;
+
+  /** Construct the parent of each element in a range of an array.
+   * This batched version of \ref t8_element_parent stores the parent of
+   * the element at index \a first_elem + i in the slot \a first_parent + i
+   * of the output array.
+   * We provide a default implementation that loops over the range; scheme
+   * implementations may override it with a specialized version.
+   * \param [in] elems        An array of valid elements of this scheme.
+   *                      None of the elements in the range may have level 0.
+   * \param [in] first_elem   The index of the first element in the range.
+   * \param [in] count        The number of consecutive elements in the range.
+   * \param [in,out] parents  An array of allocated elements of this scheme.
+   *                      On output, the \a count slots starting at
+   *                      \a first_parent store the parents of the input
+   *                      elements.
+   * \param [in] first_parent The index of the first output slot to fill.
+   * \note \a elems and \a parents must not be the same array.
+   * \see t8_element_parent
+   */
+  virtual void        t8_element_parent_batch (sc_array_t *elems,
+                                               size_t first_elem,
+                                               size_t count,
+                                               sc_array_t *parents,
+                                               size_t first_parent) const;
+
   /** Compute the child id of an element.
    * \param [in] elem     This must be a valid element.
    * \return              The child id of elem.
@@ -751,6 +812,61 @@ public:
    */
   virtual void        t8_element_destroy (int length,
                                           t8_element_t **elem) const = 0;
+
+  /** Create a private allocation context for this scheme.
+   * The element storage of a scheme is shared by all of its users, so
+   * concurrent calls to \ref t8_element_new and \ref t8_element_destroy
+   * must serialize on it. A context instead owns private storage: one
+   * context is created per concurrent worker and passed explicitly to
+   * \ref t8_element_new_ctx and \ref t8_element_destroy_ctx, which then
+   * touch no shared state at all. Elements from different contexts of
+   * the same scheme are fully interchangeable; only the allocation and
+   * deallocation calls are bound to the context that created an element.
+   * We provide a default implementation that returns NULL, in which case
+   * the context taking calls fall back to the shared storage.
+   * \return              A new allocation context, or NULL if this scheme
+   *                      does not provide private contexts.
+   * \see t8_element_context_destroy
+   */
+  virtual void       *t8_element_context_new (void) const;
+
+  /** Destroy a private allocation context.
+   * All elements allocated from the context must have been returned to it
+   * via \ref t8_element_destroy_ctx before.
+   * \param [in,out] context On input a context created by \ref
+   *                      t8_element_context_new (possibly NULL).
+   *                      Set to NULL on output.
+   */
+  virtual void        t8_element_context_destroy (void **context) const;
+
+  /** Allocate elements from a private context.
+   * Behaves like \ref t8_element_new, but draws the storage from
+   * \a context so that workers with distinct contexts allocate without
+   * synchronization. If \a context is NULL, the shared storage of the
+   * scheme is used instead.
+   * \param [in,out] context A context created by \ref t8_element_context_new,
+   *                      or NULL.
+   * \param [in] length   The number of elements to be allocated.
+   * \param [in,out] elem On output an array of \b length many pointers to
+   *                      allocated and initialized elements.
+   * \see t8_element_new
+   */
+  virtual void        t8_element_new_ctx (void *context, int length,
+                                          t8_element_t **elem) const;
+
+  /** Return elements to the private context they were allocated from.
+   * The counterpart of \ref t8_element_new_ctx. Elements must be returned
+   * to the same context (or NULL for the shared storage) that allocated
+   * them.
+   * \param [in,out] context The context the elements were allocated from,
+   *                      or NULL.
+   * \param [in] length   The number of elements in the array.
+   * \param [in,out] elem On input an array of \b length many allocated
+   *                      element pointers, all of which are freed.
+   * \see t8_element_destroy
+   */
+  virtual void        t8_element_destroy_ctx (void *context, int length,
+                                              t8_element_t **elem) const;
 };
 
 /** Destroy an implementation of a particular element class. 
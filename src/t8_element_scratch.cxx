@@ -0,0 +1,160 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_element_scratch.h>
+#include <t8_element_cxx.hxx>
+
+/** The default byte size of the first storage block of an arena.
+ * Further blocks double in size. The value is large enough to hold a
+ * family of every default element class. */
+#define T8_ELEMENT_SCRATCH_BLOCK_BYTES 4096
+
+/** One storage block of a scratch arena. */
+typedef struct t8_element_scratch_block
+{
+  struct t8_element_scratch_block *next; /**< The next (larger) block, or NULL. */
+  struct t8_element_scratch_block *prev; /**< The previous (smaller) block, or NULL. */
+  size_t              capacity; /**< The byte capacity of \a storage. */
+  char               *storage;  /**< The element storage of this block. */
+} t8_element_scratch_block_t;
+
+/** A scratch arena. The blocks form a doubly linked list and only grow;
+ * they are freed when the arena is destroyed. */
+struct t8_element_scratch
+{
+  t8_element_scratch_block_t *first_block; /**< The smallest block, or NULL if empty. */
+  t8_element_scratch_block_t *block; /**< The block that is currently carved from. */
+  size_t              used;     /**< The number of used bytes in \a block. */
+};
+
+t8_element_scratch_t *
+t8_element_scratch_new (void)
+{
+  t8_element_scratch_t *scratch = T8_ALLOC_ZERO (t8_element_scratch_t, 1);
+
+  return scratch;
+}
+
+t8_element_scratch_mark_t
+t8_element_scratch_begin (t8_element_scratch_t *scratch)
+{
+  t8_element_scratch_mark_t mark;
+
+  T8_ASSERT (scratch != NULL);
+  mark.block = scratch->block;
+  mark.used = scratch->used;
+  return mark;
+}
+
+void
+t8_element_scratch_elements (t8_element_scratch_t *scratch,
+                             const t8_eclass_scheme_c *ts, int length,
+                             t8_element_t **elem)
+{
+  size_t              elem_size, bytes;
+  char               *storage;
+  int                 ielem;
+
+  T8_ASSERT (scratch != NULL);
+  T8_ASSERT (ts != NULL);
+  T8_ASSERT (0 <= length);
+  T8_ASSERT (elem != NULL);
+
+  elem_size = ts->t8_element_size ();
+  bytes = length * elem_size;
+  if (scratch->block == NULL
+      || scratch->used + bytes > scratch->block->capacity) {
+    /* The current block cannot hold the elements. Move on to the next
+     * block, allocating it if it does not exist yet. */
+    t8_element_scratch_block_t *next =
+      scratch->block == NULL ? scratch->first_block : scratch->block->next;
+    if (next == NULL || next->capacity < bytes) {
+      /* Allocate a new block, doubling the capacity and making sure
+       * that the requested elements fit in it. A block that became too
+       * small to hold a single request is dropped and replaced. */
+      t8_element_scratch_block_t *tail = next == NULL ? NULL : next->next;
+      size_t              capacity =
+        scratch->block == NULL ? T8_ELEMENT_SCRATCH_BLOCK_BYTES :
+        2 * scratch->block->capacity;
+      while (capacity < bytes) {
+        capacity *= 2;
+      }
+      if (next != NULL) {
+        T8_FREE (next->storage);
+        T8_FREE (next);
+      }
+      next = T8_ALLOC (t8_element_scratch_block_t, 1);
+      next->capacity = capacity;
+      next->storage = T8_ALLOC (char, capacity);
+      next->next = tail;
+      next->prev = scratch->block;
+      if (tail != NULL) {
+        tail->prev = next;
+      }
+      if (scratch->block == NULL) {
+        scratch->first_block = next;
+      }
+      else {
+        scratch->block->next = next;
+      }
+    }
+    scratch->block = next;
+    scratch->used = 0;
+  }
+  /* Carve the elements from the current block and initialize them. */
+  storage = scratch->block->storage + scratch->used;
+  scratch->used += bytes;
+  if (length > 0) {
+    ts->t8_element_init (length, (t8_element_t *) storage, 0);
+  }
+  for (ielem = 0; ielem < length; ielem++) {
+    elem[ielem] = (t8_element_t *) (storage + ielem * elem_size);
+  }
+}
+
+void
+t8_element_scratch_end (t8_element_scratch_t *scratch,
+                        t8_element_scratch_mark_t mark)
+{
+  T8_ASSERT (scratch != NULL);
+  scratch->block = mark.block;
+  scratch->used = mark.used;
+}
+
+void
+t8_element_scratch_destroy (t8_element_scratch_t **pscratch)
+{
+  t8_element_scratch_t *scratch;
+  t8_element_scratch_block_t *block, *next;
+
+  T8_ASSERT (pscratch != NULL && *pscratch != NULL);
+  scratch = *pscratch;
+  /* All frames must have been closed. */
+  T8_ASSERT (scratch->block == NULL && scratch->used == 0);
+  for (block = scratch->first_block; block != NULL; block = next) {
+    next = block->next;
+    T8_FREE (block->storage);
+    T8_FREE (block);
+  }
+  T8_FREE (scratch);
+  *pscratch = NULL;
+}
@@ -0,0 +1,115 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_element_scratch.h
+ * A scratch arena for short-lived elements.
+ * Hot paths such as the face neighbor computation and the ghost layer
+ * construction create and destroy many temporary elements. Allocating
+ * them from the scheme's mempool via \ref t8_element_new pays the
+ * mempool bookkeeping for every single element. A scratch arena instead
+ * hands out stack-like element storage from a few large blocks:
+ * \ref t8_element_scratch_begin opens a frame, \ref
+ * t8_element_scratch_elements carves initialized elements from the
+ * blocks and \ref t8_element_scratch_end releases all elements of the
+ * frame at once in O(1). The blocks are kept for reuse until the arena
+ * is destroyed, so that after a warm-up phase no allocations are
+ * performed at all.
+ * An arena is not protected against concurrent access. It must only be
+ * used by the thread (respectively the MPI process) that created it;
+ * concurrent callers create one arena each.
+ */
+
+#ifndef T8_ELEMENT_SCRATCH_H
+#define T8_ELEMENT_SCRATCH_H
+
+#include <t8_element.h>
+
+T8_EXTERN_C_BEGIN ();
+
+/** Opaque handle for a scratch arena. */
+typedef struct t8_element_scratch t8_element_scratch_t;
+
+/** A position inside a scratch arena. It is returned by \ref
+ * t8_element_scratch_begin and passed to \ref t8_element_scratch_end
+ * to release all elements that were carved in between. */
+typedef struct t8_element_scratch_mark
+{
+  struct t8_element_scratch_block *block; /**< The block that was active when the mark was taken. */
+  size_t              used;     /**< The number of used bytes in \a block at that time. */
+} t8_element_scratch_mark_t;
+
+/** Create a new scratch arena without any storage.
+ * Storage blocks are allocated on demand by \ref
+ * t8_element_scratch_elements and kept until the arena is destroyed.
+ * \return              A newly allocated empty scratch arena.
+ */
+t8_element_scratch_t *t8_element_scratch_new (void);
+
+/** Open a scratch frame.
+ * All elements carved from the arena after this call are released
+ * together by passing the returned mark to \ref t8_element_scratch_end.
+ * Frames may be nested, but must be closed in reverse order of opening.
+ * \param [in] scratch  The scratch arena.
+ * \return              A mark describing the current arena position.
+ */
+t8_element_scratch_mark_t t8_element_scratch_begin (t8_element_scratch_t *
+                                                    scratch);
+
+/** Carve storage for a bunch of elements from a scratch arena.
+ * The elements are initialized via \ref t8_element_init and are valid
+ * until the enclosing frame is closed with \ref t8_element_scratch_end.
+ * They must not be passed to \ref t8_element_destroy.
+ * \param [in,out] scratch The scratch arena.
+ * \param [in] ts       The eclass scheme of which elements are requested.
+ * \param [in] length   Non-negative number of elements to carve.
+ * \param [in,out] elem An array of \a length many element pointers.
+ *                      On output they point to initialized elements
+ *                      stored inside the arena.
+ */
+void                t8_element_scratch_elements (t8_element_scratch_t *
+                                                 scratch,
+                                                 const t8_eclass_scheme_c
+                                                 *ts, int length,
+                                                 t8_element_t **elem);
+
+/** Close a scratch frame.
+ * All elements carved since the corresponding \ref
+ * t8_element_scratch_begin are released at once. The storage blocks are
+ * kept inside the arena for reuse.
+ * \param [in,out] scratch The scratch arena.
+ * \param [in] mark     The mark returned by the matching call to
+ *                      \ref t8_element_scratch_begin.
+ */
+void                t8_element_scratch_end (t8_element_scratch_t *scratch,
+                                            t8_element_scratch_mark_t mark);
+
+/** Destroy a scratch arena and free all of its storage blocks.
+ * All frames must have been closed before.
+ * \param [in,out] pscratch Pointer to a scratch arena. Set to NULL on
+ *                      output.
+ */
+void                t8_element_scratch_destroy (t8_element_scratch_t **
+                                                pscratch);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_ELEMENT_SCRATCH_H */
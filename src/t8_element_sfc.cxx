@@ -0,0 +1,209 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_element_sfc.h>
+#include <t8_element_cxx.hxx>
+
+void
+t8_sfc_ids_to_elements (t8_eclass_scheme_c *ts, int level,
+                        const t8_linearidx_t *ids, size_t num_ids,
+                        t8_element_t **elements)
+{
+  size_t              iid;
+
+  T8_ASSERT (ts != NULL);
+  T8_ASSERT (num_ids == 0 || (ids != NULL && elements != NULL));
+
+  for (iid = 0; iid < num_ids; iid++) {
+    if (iid > 0 && ids[iid] == ids[iid - 1] + 1) {
+      /* The id continues a consecutive run. The successor operation
+       * updates the previous element in place of decoding the id. */
+      ts->t8_element_successor (elements[iid - 1], elements[iid], level);
+    }
+    else {
+      ts->t8_element_set_linear_id (elements[iid], level, ids[iid]);
+    }
+  }
+}
+
+void
+t8_sfc_elements_to_ids (t8_eclass_scheme_c *ts, int level,
+                        t8_element_t *const *elements, size_t num_elements,
+                        t8_linearidx_t *ids)
+{
+  size_t              ielem;
+
+  T8_ASSERT (ts != NULL);
+  T8_ASSERT (num_elements == 0 || (elements != NULL && ids != NULL));
+
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    T8_ASSERT (ts->t8_element_level (elements[ielem]) <= level);
+    ids[ielem] = ts->t8_element_get_linear_id (elements[ielem], level);
+  }
+}
+
+void
+t8_sfc_cursor_init (t8_sfc_cursor_t *cursor, t8_eclass_scheme_c *ts,
+                    int level, t8_linearidx_t first_id)
+{
+  T8_ASSERT (cursor != NULL);
+  T8_ASSERT (ts != NULL);
+  T8_ASSERT (0 <= level);
+
+  cursor->ts = ts;
+  cursor->level = level;
+  cursor->id = first_id;
+  ts->t8_element_new (2, cursor->elements);
+  cursor->current = 0;
+  cursor->element_id = 0;
+  cursor->element_valid = 0;
+}
+
+void
+t8_sfc_cursor_reset (t8_sfc_cursor_t *cursor)
+{
+  T8_ASSERT (cursor != NULL && cursor->ts != NULL);
+
+  cursor->ts->t8_element_destroy (2, cursor->elements);
+  cursor->elements[0] = cursor->elements[1] = NULL;
+  cursor->ts = NULL;
+  cursor->element_valid = 0;
+}
+
+t8_linearidx_t
+t8_sfc_cursor_id (const t8_sfc_cursor_t *cursor)
+{
+  T8_ASSERT (cursor != NULL && cursor->ts != NULL);
+
+  return cursor->id;
+}
+
+int
+t8_sfc_cursor_level (const t8_sfc_cursor_t *cursor)
+{
+  T8_ASSERT (cursor != NULL && cursor->ts != NULL);
+
+  return cursor->level;
+}
+
+void
+t8_sfc_cursor_advance (t8_sfc_cursor_t *cursor, t8_linearidx_t num_leafs)
+{
+  T8_ASSERT (cursor != NULL && cursor->ts != NULL);
+
+  /* Only the packed key moves. Whether the scratch element can still be
+   * advanced incrementally is decided on the next materialization. */
+  cursor->id += num_leafs;
+}
+
+const t8_element_t *
+t8_sfc_cursor_element (t8_sfc_cursor_t *cursor)
+{
+  t8_eclass_scheme_c *ts;
+
+  T8_ASSERT (cursor != NULL && cursor->ts != NULL);
+
+  ts = cursor->ts;
+  if (cursor->element_valid && cursor->id == cursor->element_id) {
+    /* The cursor did not move since the last materialization */
+    return cursor->elements[cursor->current];
+  }
+  if (cursor->element_valid && cursor->id == cursor->element_id + 1) {
+    /* The cursor moved by one leaf. The successor operation updates the
+     * previous element into the other scratch slot in place of decoding
+     * the full linear id. */
+    ts->t8_element_successor (cursor->elements[cursor->current],
+                              cursor->elements[!cursor->current],
+                              cursor->level);
+    cursor->current = !cursor->current;
+  }
+  else {
+    ts->t8_element_set_linear_id (cursor->elements[cursor->current],
+                                  cursor->level, cursor->id);
+  }
+  cursor->element_id = cursor->id;
+  cursor->element_valid = 1;
+  return cursor->elements[cursor->current];
+}
+
+void
+t8_sfc_split_range (t8_eclass_scheme_c *ts, int leaf_level,
+                    t8_linearidx_t first_id, t8_linearidx_t end_id,
+                    sc_array_t *ranges)
+{
+  t8_element_t       *temps[4];
+  t8_element_t       *leaf, *anc, *parent, *desc;
+  t8_linearidx_t      id, remaining;
+  t8_linearidx_t      num_leafs, parent_leafs;
+  t8_sfc_subtree_range_t *range;
+
+  T8_ASSERT (ts != NULL);
+  T8_ASSERT (0 <= leaf_level);
+  T8_ASSERT (ranges != NULL
+             && ranges->elem_size == sizeof (t8_sfc_subtree_range_t));
+
+  if (first_id >= end_id) {
+    /* The range is empty */
+    return;
+  }
+
+  ts->t8_element_new (4, temps);
+  leaf = temps[0];
+  anc = temps[1];
+  parent = temps[2];
+  desc = temps[3];
+
+  id = first_id;
+  while (id < end_id) {
+    remaining = end_id - id;
+    /* The leaf at id is the first leaf of the next subtree. We climb to
+     * the coarsest ancestor whose leaf range starts exactly at id and
+     * fits into the remaining range. */
+    ts->t8_element_set_linear_id (leaf, leaf_level, id);
+    ts->t8_element_copy (leaf, anc);
+    num_leafs = 1;
+    while (ts->t8_element_level (anc) > 0) {
+      ts->t8_element_parent (anc, parent);
+      ts->t8_element_first_descendant (parent, desc, leaf_level);
+      if (ts->t8_element_compare (desc, leaf) != 0) {
+        /* The leaf is not the first leaf of the parent, so the parent's
+         * range would begin before id. */
+        break;
+      }
+      parent_leafs = (t8_linearidx_t)
+        ts->t8_element_count_leafs (parent, leaf_level);
+      if (parent_leafs > remaining) {
+        /* The parent's range would extend past end_id */
+        break;
+      }
+      ts->t8_element_copy (parent, anc);
+      num_leafs = parent_leafs;
+    }
+    range = (t8_sfc_subtree_range_t *) sc_array_push (ranges);
+    range->first_id = id;
+    range->num_leafs = num_leafs;
+    range->level = ts->t8_element_level (anc);
+    id += num_leafs;
+  }
+
+  ts->t8_element_destroy (4, temps);
+}
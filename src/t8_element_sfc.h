@@ -0,0 +1,194 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_element_sfc.h
+ * Bulk conversion between elements and their space-filling curve indices
+ * and splitting of index ranges into aligned subtrees.
+ * The per-element conversions \ref t8_element_set_linear_id and
+ * t8_element_get_linear_id decode respectively encode the full digit
+ * string of an id on every call. Tools that convert long runs of
+ * consecutive ids, such as partition preprocessing, can instead update
+ * the previous element incrementally, which touches only the digits that
+ * actually change. The functions in this file provide such bulk kernels
+ * on top of the element scheme interface, together with the classic
+ * operation of decomposing an id range into the few coarse subtrees that
+ * exactly cover it.
+ */
+
+#ifndef T8_ELEMENT_SFC_H
+#define T8_ELEMENT_SFC_H
+
+#include <t8_element.h>
+
+T8_EXTERN_C_BEGIN ();
+
+/** One maximal aligned subtree of an index range decomposition.
+ * The subtree root has refinement level \a level and its uniform leaf
+ * refinement covers the ids \a first_id to \a first_id + \a num_leafs - 1.
+ * \see t8_sfc_split_range */
+typedef struct t8_sfc_subtree_range
+{
+  t8_linearidx_t      first_id; /**< The linear id of the first leaf of the subtree. */
+  t8_linearidx_t      num_leafs; /**< The number of leafs of the subtree. */
+  int                 level;    /**< The refinement level of the subtree root. */
+} t8_sfc_subtree_range_t;
+
+/** Construct the elements of a batch of linear ids.
+ * Wherever the ids are consecutive, each element is computed from its
+ * predecessor via \ref t8_element_successor, which only updates the
+ * trailing digits of the id, instead of decoding the full id. For sorted
+ * id batches, as they arise in partition preprocessing, this turns the
+ * per-id cost from O(level) into amortized O(1).
+ * \param [in]      ts          The element scheme of the elements.
+ * \param [in]      level       The level of the uniform refinement whose
+ *                              leafs the ids enumerate.
+ * \param [in]      ids         An array of \a num_ids linear ids, each
+ *                              valid on \a level. Consecutive runs are
+ *                              exploited, sorting is not required.
+ * \param [in]      num_ids     The number of ids to convert.
+ * \param [in,out]  elements    An array of \a num_ids allocated elements
+ *                              whose entries will be set.
+ */
+void                t8_sfc_ids_to_elements (t8_eclass_scheme_c *ts,
+                                            int level,
+                                            const t8_linearidx_t *ids,
+                                            size_t num_ids,
+                                            t8_element_t **elements);
+
+/** Compute the linear ids of a batch of elements.
+ * \param [in]      ts          The element scheme of the elements.
+ * \param [in]      level       The level of the uniform refinement in
+ *                              which the ids are computed. Must be at
+ *                              least the level of each element.
+ * \param [in]      elements    An array of \a num_elements elements.
+ * \param [in]      num_elements The number of elements to convert.
+ * \param [out]     ids         On output, the linear id of each element.
+ */
+void                t8_sfc_elements_to_ids (t8_eclass_scheme_c *ts,
+                                            int level,
+                                            t8_element_t *const *elements,
+                                            size_t num_elements,
+                                            t8_linearidx_t *ids);
+
+/** A lazy cursor over the leafs of a uniform refinement in
+ * space-filling-curve order.
+ * The cursor carries only the packed key of its current position, that is
+ * the leaf level and the linear id. Advancing is a plain id increment and
+ * the level and id can be read without ever constructing an element.
+ * The full \ref t8_element_t state is synthesized on demand by
+ * \ref t8_sfc_cursor_element, incrementally via
+ * \ref t8_element_successor if the cursor moved by one leaf since the
+ * last materialization and by decoding the id otherwise. Sweeps that
+ * read coordinates only for few of the visited leafs this way skip the
+ * reconstruction cost for all others.
+ * All fields are private to the cursor functions. */
+typedef struct t8_sfc_cursor
+{
+  t8_eclass_scheme_c *ts;       /**< The element scheme of the refinement. */
+  int                 level;    /**< The leaf level of the refinement. */
+  t8_linearidx_t      id;       /**< The linear id of the current position. */
+  t8_element_t       *elements[2];      /**< Two scratch elements, alternated by \ref t8_sfc_cursor_element. */
+  int                 current;  /**< Which scratch element was materialized last. */
+  t8_linearidx_t      element_id;       /**< The id encoded in the current scratch element. */
+  int                 element_valid;    /**< Nonzero if a scratch element was materialized. */
+} t8_sfc_cursor_t;
+
+/** Initialize a cursor at a position without constructing an element.
+ * \param [in,out]  cursor      The cursor to initialize. Must be released
+ *                              with \ref t8_sfc_cursor_reset.
+ * \param [in]      ts          The element scheme of the refinement.
+ * \param [in]      level       The level of the uniform refinement whose
+ *                              leafs the cursor visits.
+ * \param [in]      first_id    The linear id of the initial position.
+ */
+void                t8_sfc_cursor_init (t8_sfc_cursor_t *cursor,
+                                        t8_eclass_scheme_c *ts, int level,
+                                        t8_linearidx_t first_id);
+
+/** Release the scratch elements of a cursor.
+ * \param [in,out]  cursor      An initialized cursor. After the call the
+ *                              cursor is invalid.
+ */
+void                t8_sfc_cursor_reset (t8_sfc_cursor_t *cursor);
+
+/** Get the linear id of the current position. Does not construct an
+ * element.
+ * \param [in]      cursor      An initialized cursor.
+ * \return                      The linear id of the current position.
+ */
+t8_linearidx_t      t8_sfc_cursor_id (const t8_sfc_cursor_t *cursor);
+
+/** Get the leaf level of a cursor. Does not construct an element.
+ * \param [in]      cursor      An initialized cursor.
+ * \return                      The level passed to \ref t8_sfc_cursor_init.
+ */
+int                 t8_sfc_cursor_level (const t8_sfc_cursor_t *cursor);
+
+/** Move a cursor forward along the space-filling curve. Only the packed
+ * key is updated, no element state is touched.
+ * \param [in,out]  cursor      An initialized cursor.
+ * \param [in]      num_leafs   The number of leafs to skip. The caller
+ *                              must ensure the new position stays within
+ *                              the refinement.
+ */
+void                t8_sfc_cursor_advance (t8_sfc_cursor_t *cursor,
+                                           t8_linearidx_t num_leafs);
+
+/** Materialize the element of the current position.
+ * If the cursor advanced by one leaf since the last materialization, the
+ * element is computed from the previous one via
+ * \ref t8_element_successor, so a sweep that reads every position pays
+ * amortized constant cost per leaf. Otherwise the linear id is decoded.
+ * \param [in,out]  cursor      An initialized cursor.
+ * \return                      The element of the current position. The
+ *                              pointer is owned by the cursor and only
+ *                              valid until the next call on it.
+ */
+const t8_element_t *t8_sfc_cursor_element (t8_sfc_cursor_t *cursor);
+
+/** Decompose a linear id range into maximal aligned subtrees.
+ * The leafs with ids \a first_id <= id < \a end_id of the uniform
+ * refinement of level \a leaf_level are covered by a short sequence of
+ * subtrees, each as coarse as the alignment of its first leaf and the
+ * remaining range length permit. A contiguous partition slice can this
+ * way be described, communicated or traversed by a handful of subtree
+ * roots instead of element by element.
+ * \param [in]      ts          The element scheme of the refinement.
+ * \param [in]      leaf_level  The level of the uniform refinement whose
+ *                              leafs the ids enumerate.
+ * \param [in]      first_id    The first id of the range.
+ * \param [in]      end_id      One past the last id of the range. If not
+ *                              greater than \a first_id, no subtree is
+ *                              produced.
+ * \param [in,out]  ranges      An initialized sc_array of
+ *                              \ref t8_sfc_subtree_range_t. The subtrees
+ *                              are pushed onto it in ascending id order.
+ */
+void                t8_sfc_split_range (t8_eclass_scheme_c *ts,
+                                        int leaf_level,
+                                        t8_linearidx_t first_id,
+                                        t8_linearidx_t end_id,
+                                        sc_array_t *ranges);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_ELEMENT_SFC_H */
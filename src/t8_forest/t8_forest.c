@@ -34,8 +34,86 @@
 #include <t8_forest/t8_forest_vtk.h>
 #include <t8_cmesh/t8_cmesh_offset.h>
 #include <t8_cmesh/t8_cmesh_trees.h>
+#include <t8_cmesh_readmshfile.h>
 #include<t8_element_c_interface.h>
 
+/* Recycling pool for the skeleton allocations of destroyed forests.
+ *
+ * Adapt/partition pipelines that rebuild the forest at a high rate free
+ * and reallocate the forest struct, the trees array and the profile
+ * block on every cycle.  We keep a small per-process free list of these
+ * fixed-shape allocations and hand them back out in \ref t8_forest_init,
+ * \ref t8_forest_copy_trees and \ref t8_forest_set_profiling.  Forests
+ * are constructed and destroyed on the main thread only, so plain
+ * arrays without locking suffice.
+ *
+ * The pool is drained as soon as the last live forest is destroyed.
+ * This way no pooled memory outlives the application's forests and the
+ * allocation balance check in sc_finalize stays clean. */
+
+#define T8_FOREST_RECYCLE_MAX 8 /**< Retained objects per free list. */
+
+static t8_forest_struct_t *t8_forest_recycle_structs[T8_FOREST_RECYCLE_MAX];
+static int          t8_forest_recycle_num_structs = 0;
+static sc_array_t  *t8_forest_recycle_trees_pool[T8_FOREST_RECYCLE_MAX];
+static int          t8_forest_recycle_num_trees = 0;
+static t8_profile_t *t8_forest_recycle_profiles[T8_FOREST_RECYCLE_MAX];
+static int          t8_forest_recycle_num_profiles = 0;
+/* The number of forests that are currently initialized or committed. */
+static int          t8_forest_recycle_live_forests = 0;
+
+/* Free all retained skeleton allocations. */
+static void
+t8_forest_recycle_pool_clear (void)
+{
+  while (t8_forest_recycle_num_structs > 0) {
+    T8_FREE (t8_forest_recycle_structs[--t8_forest_recycle_num_structs]);
+  }
+  while (t8_forest_recycle_num_trees > 0) {
+    sc_array_destroy (t8_forest_recycle_trees_pool
+                      [--t8_forest_recycle_num_trees]);
+  }
+  while (t8_forest_recycle_num_profiles > 0) {
+    T8_FREE (t8_forest_recycle_profiles[--t8_forest_recycle_num_profiles]);
+  }
+}
+
+sc_array_t         *
+t8_forest_recycle_trees_new (t8_locidx_t num_trees)
+{
+  sc_array_t         *trees;
+
+  T8_ASSERT (num_trees >= 0);
+  if (t8_forest_recycle_num_trees > 0) {
+    /* Reuse a retained trees array; its capacity survives the resize,
+     * so repeated cycles over similar partitions do not reallocate. */
+    trees = t8_forest_recycle_trees_pool[--t8_forest_recycle_num_trees];
+    T8_ASSERT (trees->elem_size == sizeof (t8_tree_struct_t));
+    sc_array_resize (trees, (size_t) num_trees);
+  }
+  else {
+    trees =
+      sc_array_new_count (sizeof (t8_tree_struct_t), (size_t) num_trees);
+  }
+  return trees;
+}
+
+void
+t8_forest_recycle_trees_retire (sc_array_t **ptrees)
+{
+  T8_ASSERT (ptrees != NULL && *ptrees != NULL);
+  T8_ASSERT ((*ptrees)->elem_size == sizeof (t8_tree_struct_t));
+
+  if (t8_forest_recycle_num_trees < T8_FOREST_RECYCLE_MAX) {
+    sc_array_resize (*ptrees, 0);
+    t8_forest_recycle_trees_pool[t8_forest_recycle_num_trees++] = *ptrees;
+  }
+  else {
+    sc_array_destroy (*ptrees);
+  }
+  *ptrees = NULL;
+}
+
 void
 t8_forest_init (t8_forest_t *pforest)
 {
@@ -43,7 +121,15 @@ t8_forest_init (t8_forest_t *pforest)
 
   T8_ASSERT (pforest != NULL);
 
-  forest = *pforest = T8_ALLOC_ZERO (t8_forest_struct_t, 1);
+  if (t8_forest_recycle_num_structs > 0) {
+    forest = *pforest =
+      t8_forest_recycle_structs[--t8_forest_recycle_num_structs];
+    memset (forest, 0, sizeof (t8_forest_struct_t));
+  }
+  else {
+    forest = *pforest = T8_ALLOC_ZERO (t8_forest_struct_t, 1);
+  }
+  t8_forest_recycle_live_forests++;
   t8_refcount_init (&forest->rc);
 
   /* sensible (hard error) defaults */
@@ -60,6 +146,23 @@ t8_forest_init (t8_forest_t *pforest)
   forest->maxlevel_existing = -1;
   forest->stats_computed = 0;
   forest->incomplete_trees = -1;
+  forest->last_owner = -1;
+  forest->ghost_width = 1;
+  forest->ghost_aggregate = 0;
+  forest->ghost_packed = 0;
+  forest->ghost_compress = 0;
+  forest->ghost_num_threads = 1;
+  forest->populate_num_threads = 1;
+  forest->vtk_num_threads = 1;
+  forest->adapt_num_threads = 1;
+  forest->coord_precision = T8_COORD_PRECISION_FLOAT64;
+  forest->coord_quant_bits = 0;
+  forest->do_subcomm = 0;
+  forest->subcomm = sc_MPI_COMM_NULL;
+  forest->ghost_neighbor_comm = sc_MPI_COMM_NULL;
+  forest->ghost_comm = sc_MPI_COMM_NULL;
+  forest->partition_comm = sc_MPI_COMM_NULL;
+  forest->element_memory_mode = T8_ELEMENT_MEMORY_DEFAULT;
 }
 
 int
@@ -214,6 +317,17 @@ t8_forest_set_partition (t8_forest_t forest, const t8_forest_t set_from,
   }
 }
 
+void
+t8_forest_set_partition_weights (t8_forest_t forest,
+                                 t8_forest_partition_weight_t weight_fn)
+{
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (forest->rc.refcount > 0);
+  T8_ASSERT (!forest->committed);
+
+  forest->set_partition_weight_fn = weight_fn;
+}
+
 void
 t8_forest_set_balance (t8_forest_t forest, const t8_forest_t set_from,
                        int no_repartition)
@@ -244,16 +358,25 @@ t8_forest_set_balance (t8_forest_t forest, const t8_forest_t set_from,
   }
 }
 
+void
+t8_forest_set_balance_replace (t8_forest_t forest,
+                               t8_forest_replace_t replace_fn)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->balance_replace_fn = replace_fn;
+}
+
 void
 t8_forest_set_ghost_ext (t8_forest_t forest, int do_ghost,
-                         t8_ghost_type_t ghost_type, int ghost_version)
+                         t8_ghost_type_t ghost_type, int ghost_version,
+                         int ghost_width)
 {
   T8_ASSERT (t8_forest_is_initialized (forest));
-  /* We currently only support face ghosts */
-  SC_CHECK_ABORT (do_ghost == 0 || ghost_type == T8_GHOST_FACES,
-                  "Ghost neighbors other than face-neighbors are not supported.\n");
-  SC_CHECK_ABORT (1 <= ghost_version && ghost_version <= 3,
-                  "Invalid choice for ghost version. Choose 1, 2, or 3.\n");
+  SC_CHECK_ABORT (0 <= ghost_version && ghost_version <= 3,
+                  "Invalid choice for ghost version. Choose 0 (automatic), 1, 2, or 3.\n");
+  SC_CHECK_ABORT (do_ghost == 0 || ghost_width >= 1,
+                  "Invalid choice for ghost width. The width must be >= 1.\n");
 
   if (ghost_type == T8_GHOST_NONE) {
     /* none type disables ghost */
@@ -265,6 +388,7 @@ t8_forest_set_ghost_ext (t8_forest_t forest, int do_ghost,
   if (forest->do_ghost) {
     forest->ghost_type = ghost_type;
     forest->ghost_algorithm = ghost_version;
+    forest->ghost_width = ghost_width;
   }
 }
 
@@ -272,8 +396,316 @@ void
 t8_forest_set_ghost (t8_forest_t forest, int do_ghost,
                      t8_ghost_type_t ghost_type)
 {
-  /* Use ghost version 3, top-down search and for unbalanced forests. */
-  t8_forest_set_ghost_ext (forest, do_ghost, ghost_type, 3);
+  /* Use ghost version 3, top-down search and for unbalanced forests,
+   * with a single layer of ghost elements. */
+  t8_forest_set_ghost_ext (forest, do_ghost, ghost_type, 3, 1);
+}
+
+void
+t8_forest_set_ghost_packed (t8_forest_t forest, int ghost_packed)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->ghost_packed = (ghost_packed != 0);
+}
+
+void
+t8_forest_set_ghost_filter (t8_forest_t forest,
+                            t8_forest_ghost_filter_t filter_fn,
+                            void *user_data)
+{
+  T8_ASSERT (forest != NULL);
+
+  forest->ghost_filter_fn = filter_fn;
+  forest->ghost_filter_data = user_data;
+}
+
+void
+t8_forest_set_ghost_compress (t8_forest_t forest, int ghost_compress)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->ghost_compress = (ghost_compress != 0);
+}
+
+void
+t8_forest_set_ghost_threads (t8_forest_t forest, int num_threads)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest)
+             || t8_forest_is_committed (forest));
+  SC_CHECK_ABORT (num_threads >= 1,
+                  "Invalid choice for ghost threads. The number must be >= 1.\n");
+
+  forest->ghost_num_threads = num_threads;
+}
+
+void
+t8_forest_set_populate_threads (t8_forest_t forest, int num_threads)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+  SC_CHECK_ABORT (num_threads >= 1,
+                  "Invalid choice for populate threads. The number must be >= 1.\n");
+
+  forest->populate_num_threads = num_threads;
+}
+
+void
+t8_forest_set_vtk_threads (t8_forest_t forest, int num_threads)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest)
+             || t8_forest_is_committed (forest));
+  SC_CHECK_ABORT (num_threads >= 1,
+                  "Invalid choice for vtk threads. The number must be >= 1.\n");
+
+  forest->vtk_num_threads = num_threads;
+}
+
+void
+t8_forest_set_adapt_threads (t8_forest_t forest, int num_threads)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest)
+             || t8_forest_is_committed (forest));
+  SC_CHECK_ABORT (num_threads >= 1,
+                  "Invalid choice for adapt threads. The number must be >= 1.\n");
+
+  forest->adapt_num_threads = num_threads;
+}
+
+void
+t8_forest_set_num_threads (t8_forest_t forest, int num_threads)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest)
+             || t8_forest_is_committed (forest));
+  SC_CHECK_ABORT (num_threads >= 1,
+                  "Invalid choice for forest threads. The number must be >= 1.\n");
+
+  forest->ghost_num_threads = num_threads;
+  forest->populate_num_threads = num_threads;
+  forest->vtk_num_threads = num_threads;
+  /* The adapt tree loop is deliberately not covered here: with more than
+   * one adapt thread the user's adapt callback is invoked concurrently and
+   * must be thread-safe, so that phase requires the explicit opt-in via
+   * t8_forest_set_adapt_threads. */
+}
+
+void
+t8_forest_set_coordinate_precision (t8_forest_t forest,
+                                    t8_coord_precision_t precision,
+                                    int quantization_bits)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest)
+             || t8_forest_is_committed (forest));
+  SC_CHECK_ABORT (precision == T8_COORD_PRECISION_FLOAT64
+                  || precision == T8_COORD_PRECISION_FLOAT32
+                  || precision == T8_COORD_PRECISION_QUANTIZED,
+                  "Invalid coordinate precision.\n");
+  SC_CHECK_ABORT (precision != T8_COORD_PRECISION_QUANTIZED
+                  || (1 <= quantization_bits && quantization_bits <= 24),
+                  "Invalid choice for coordinate quantization bits. "
+                  "The number must be in [1, 24].\n");
+
+  forest->coord_precision = (int) precision;
+  forest->coord_quant_bits =
+    precision == T8_COORD_PRECISION_QUANTIZED ? quantization_bits : 0;
+}
+
+t8_coord_precision_t
+t8_forest_get_coordinate_precision (t8_forest_t forest,
+                                    int *quantization_bits)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest)
+             || t8_forest_is_committed (forest));
+  if (quantization_bits != NULL) {
+    *quantization_bits = forest->coord_quant_bits;
+  }
+  return (t8_coord_precision_t) forest->coord_precision;
+}
+
+void
+t8_forest_set_subcomm (t8_forest_t forest, int set_subcomm)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->do_subcomm = set_subcomm;
+}
+
+void
+t8_forest_set_comm_isolation (t8_forest_t forest, int set_isolation)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->set_comm_isolation = set_isolation != 0;
+}
+
+/** Duplicate the dedicated ghost and partition communicators of a forest
+ * during commit, if communicator isolation was requested. The duplicates
+ * provide independent MPI contexts, so the ghost and partition traffic of
+ * this forest can never match messages of each other, of other forests or
+ * of the application, even when they are in flight concurrently.
+ * \param [in,out] forest   The forest being committed. Its \a mpicomm,
+ *                          \a mpisize and \a mpirank must be set up.
+ */
+static void
+t8_forest_comm_isolation_setup (t8_forest_t forest)
+{
+  int                 mpiret;
+
+  if (!forest->set_comm_isolation || forest->mpisize == 1) {
+    return;
+  }
+  T8_ASSERT (forest->ghost_comm == sc_MPI_COMM_NULL);
+  T8_ASSERT (forest->partition_comm == sc_MPI_COMM_NULL);
+  mpiret = sc_MPI_Comm_dup (forest->mpicomm, &forest->ghost_comm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_dup (forest->mpicomm, &forest->partition_comm);
+  SC_CHECK_MPI (mpiret);
+}
+
+sc_MPI_Comm
+t8_forest_comm_for_ghost (t8_forest_t forest)
+{
+  return forest->ghost_comm != sc_MPI_COMM_NULL ? forest->ghost_comm :
+    forest->mpicomm;
+}
+
+sc_MPI_Comm
+t8_forest_comm_for_partition (t8_forest_t forest)
+{
+  return forest->partition_comm != sc_MPI_COMM_NULL ? forest->partition_comm :
+    forest->mpicomm;
+}
+
+void
+t8_forest_set_memory_mode (t8_forest_t forest,
+                           t8_element_memory_mode_t memory_mode)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->element_memory_mode = memory_mode;
+}
+
+t8_forest_commit_context_t
+t8_forest_commit_context_new (sc_MPI_Comm mpicomm, int do_dup)
+{
+  t8_forest_commit_context_t context;
+  int                 mpiret;
+
+  context = T8_ALLOC_ZERO (t8_forest_commit_context_struct_t, 1);
+  t8_refcount_init (&context->rc);
+  if (do_dup) {
+    /* The context owns the one duplicate of the pipeline's communicator */
+    mpiret = sc_MPI_Comm_dup (mpicomm, &context->mpicomm);
+    SC_CHECK_MPI (mpiret);
+  }
+  else {
+    context->mpicomm = mpicomm;
+  }
+  context->do_dup = do_dup;
+
+  return context;
+}
+
+void
+t8_forest_commit_context_ref (t8_forest_commit_context_t context)
+{
+  T8_ASSERT (context != NULL);
+  t8_refcount_ref (&context->rc);
+}
+
+void
+t8_forest_commit_context_unref (t8_forest_commit_context_t *pcontext)
+{
+  t8_forest_commit_context_t context;
+  int                 islot, mpiret;
+
+  T8_ASSERT (pcontext != NULL);
+  context = *pcontext;
+  T8_ASSERT (context != NULL);
+  T8_ASSERT (context->rc.refcount > 0);
+  if (t8_refcount_unref (&context->rc)) {
+    /* Destroy the parked shared memory arrays */
+    for (islot = 0; islot < T8_FOREST_CONTEXT_SHMEM_SLOTS; islot++) {
+      if (context->shmem_pool[islot] != NULL) {
+        t8_shmem_array_destroy (&context->shmem_pool[islot]);
+      }
+    }
+    if (context->do_dup) {
+      mpiret = sc_MPI_Comm_free (&context->mpicomm);
+      SC_CHECK_MPI (mpiret);
+    }
+    T8_FREE (context);
+  }
+  *pcontext = NULL;
+}
+
+void
+t8_forest_set_commit_context (t8_forest_t forest,
+                              t8_forest_commit_context_t context)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  if (context != NULL) {
+    t8_forest_commit_context_ref (context);
+  }
+  if (forest->commit_context != NULL) {
+    t8_forest_commit_context_unref (&forest->commit_context);
+  }
+  forest->commit_context = context;
+}
+
+/* Offer a shared memory array of a forest that is being destroyed to the
+ * forest's commit context. If a free slot exists, the context takes
+ * ownership and *parray is set to NULL; otherwise the array is left with the
+ * forest and destroyed as usual. */
+static void
+t8_forest_commit_context_park (t8_forest_commit_context_t context,
+                               t8_shmem_array_t *parray)
+{
+  int                 islot;
+
+  T8_ASSERT (context != NULL);
+  if (*parray == NULL
+      || t8_shmem_array_get_comm (*parray) != context->mpicomm) {
+    return;
+  }
+  for (islot = 0; islot < T8_FOREST_CONTEXT_SHMEM_SLOTS; islot++) {
+    if (context->shmem_pool[islot] == NULL) {
+      context->shmem_pool[islot] = *parray;
+      *parray = NULL;
+      return;
+    }
+  }
+}
+
+void
+t8_forest_shmem_array_init (t8_forest_t forest, t8_shmem_array_t *parray,
+                            size_t elem_size, size_t elem_count)
+{
+  sc_MPI_Comm         comm = forest->mpicomm;
+
+  T8_ASSERT (*parray == NULL);
+  if (forest->commit_context != NULL) {
+    t8_forest_commit_context_t context = forest->commit_context;
+    int                 islot;
+
+    for (islot = 0; islot < T8_FOREST_CONTEXT_SHMEM_SLOTS; islot++) {
+      t8_shmem_array_t    parked = context->shmem_pool[islot];
+      if (parked != NULL
+          && t8_shmem_array_get_elem_size (parked) == elem_size
+          && t8_shmem_array_get_elem_count (parked) == elem_count
+          && t8_shmem_array_get_comm (parked) == comm) {
+        /* Hand out the parked shared memory window instead of opening a
+         * new one. The caller overwrites the stale contents. */
+        *parray = parked;
+        context->shmem_pool[islot] = NULL;
+        return;
+      }
+    }
+  }
+  /* Set the shmem array type of comm */
+  t8_shmem_init (comm);
+  t8_shmem_set_type (comm, T8_SHMEM_BEST_TYPE);
+  t8_shmem_array_init (parray, elem_size, elem_count, comm);
 }
 
 void
@@ -308,6 +740,315 @@ t8_forest_set_adapt (t8_forest_t forest, const t8_forest_t set_from,
   }
 }
 
+void
+t8_forest_set_adapt_batched (t8_forest_t forest, const t8_forest_t set_from,
+                             t8_forest_adapt_batched_t adapt_fn)
+{
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (forest->rc.refcount > 0);
+  T8_ASSERT (!forest->committed);
+  T8_ASSERT (forest->mpicomm == sc_MPI_COMM_NULL);
+  T8_ASSERT (forest->cmesh == NULL);
+  T8_ASSERT (forest->scheme_cxx == NULL);
+  T8_ASSERT (forest->set_adapt_fn == NULL);
+  T8_ASSERT (forest->set_adapt_batched_fn == NULL);
+  T8_ASSERT (forest->set_adapt_recursive == -1);
+
+  forest->set_adapt_batched_fn = adapt_fn;
+  /* Batched adaptation is never recursive, since the refine flags refer
+   * to the elements of the source forest only. */
+  forest->set_adapt_recursive = 0;
+
+  if (set_from != NULL) {
+    /* If set_from = NULL, we assume a previous forest_from was set */
+    forest->set_from = set_from;
+  }
+
+  /* Add ADAPT to the from_method.
+   * This overwrites T8_FOREST_FROM_COPY */
+
+  if (forest->from_method == T8_FOREST_FROM_LAST) {
+    forest->from_method = T8_FOREST_FROM_ADAPT;
+  }
+  else {
+    forest->from_method |= T8_FOREST_FROM_ADAPT;
+  }
+}
+
+void
+t8_forest_set_adapt_prune (t8_forest_t forest,
+                           t8_forest_adapt_prune_t prune_fn)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->set_adapt_prune_fn = prune_fn;
+}
+
+void
+t8_forest_set_adapt_region (t8_forest_t forest,
+                            const t8_forest_adapt_region_t *regions,
+                            t8_locidx_t num_regions)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+  T8_ASSERT (num_regions >= 0);
+  T8_ASSERT (regions != NULL || num_regions == 0);
+
+  if (forest->set_adapt_regions != NULL) {
+    sc_array_destroy (forest->set_adapt_regions);
+    forest->set_adapt_regions = NULL;
+  }
+  if (regions != NULL && num_regions > 0) {
+    forest->set_adapt_regions =
+      sc_array_new_count (sizeof (t8_forest_adapt_region_t),
+                          (size_t) num_regions);
+    memcpy (forest->set_adapt_regions->array, regions,
+            (size_t) num_regions * sizeof (t8_forest_adapt_region_t));
+  }
+}
+
+void
+t8_forest_set_adapt_recycle (t8_forest_t forest, int recycle)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->set_adapt_recycle = recycle != 0;
+}
+
+void
+t8_forest_set_commit_fused (t8_forest_t forest, int fused)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->set_commit_fused = fused != 0;
+}
+
+void
+t8_forest_set_element_stats (t8_forest_t forest, int set_element_stats)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->set_element_stats = set_element_stats != 0;
+}
+
+void
+t8_forest_set_adapt_journal (t8_forest_t forest, int record)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->set_adapt_journal = record != 0;
+}
+
+sc_array_t         *
+t8_forest_get_adapt_journal (t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  return forest->adapt_journal;
+}
+
+void
+t8_forest_cache_hook_register (t8_forest_t forest,
+                               t8_forest_cache_invalidate_t callback,
+                               void *user_data)
+{
+  t8_forest_cache_hook_struct_t *hook;
+
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (callback != NULL);
+
+  if (forest->cache_hooks == NULL) {
+    forest->cache_hooks =
+      sc_array_new (sizeof (t8_forest_cache_hook_struct_t));
+  }
+  hook = (t8_forest_cache_hook_struct_t *)
+    sc_array_push (forest->cache_hooks);
+  hook->callback = callback;
+  hook->user_data = user_data;
+}
+
+unsigned
+t8_forest_get_generation (t8_forest_t forest)
+{
+  T8_ASSERT (forest != NULL);
+
+  return forest->generation;
+}
+
+/* Append a run to one of the arrays of a forest delta, merging it into
+ * the previous run when the carrying range continues contiguously.
+ * Which range carries the elements is given by merge_old/merge_new; the
+ * kept array requires both ranges to continue, since an intervening
+ * refine or coarsen advances both cursors unevenly. */
+static void
+t8_forest_delta_push (sc_array_t *runs, int merge_old, int merge_new,
+                      t8_locidx_t old_start, t8_locidx_t new_start,
+                      t8_locidx_t count)
+{
+  t8_forest_delta_run_t *run;
+
+  if (runs->elem_count > 0) {
+    run = (t8_forest_delta_run_t *)
+      sc_array_index (runs, runs->elem_count - 1);
+    if ((!merge_old || run->old_start + run->count == old_start)
+        && (!merge_new || run->new_start + run->count == new_start)) {
+      run->count += count;
+      return;
+    }
+  }
+  run = (t8_forest_delta_run_t *) sc_array_push (runs);
+  run->old_start = old_start;
+  run->new_start = new_start;
+  run->count = count;
+}
+
+int
+t8_forest_delta_extract (t8_forest_t forest, unsigned last_seen_generation,
+                         t8_forest_delta_t **pdelta)
+{
+  t8_forest_delta_t  *delta;
+  t8_forest_adapt_journal_entry_t *entry;
+  sc_array_t         *journal;
+  t8_locidx_t         old_pos, new_pos;
+  size_t              ientry;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (pdelta != NULL);
+
+  *pdelta = NULL;
+  if (last_seen_generation != forest->generation
+      && (last_seen_generation + 1 != forest->generation
+          || forest->adapt_journal == NULL)) {
+    /* The subscriber is more than one adaptation behind, or the commit
+     * did not record an adapt journal (for example because partition or
+     * balance were fused into it). A full re-extraction is required. */
+    return 0;
+  }
+
+  delta = T8_ALLOC (t8_forest_delta_t, 1);
+  delta->old_generation = last_seen_generation;
+  delta->new_generation = forest->generation;
+  sc_array_init (&delta->kept, sizeof (t8_forest_delta_run_t));
+  sc_array_init (&delta->added, sizeof (t8_forest_delta_run_t));
+  sc_array_init (&delta->removed, sizeof (t8_forest_delta_run_t));
+
+  if (last_seen_generation == forest->generation) {
+    /* The subscriber is up to date, the delta is empty. */
+    *pdelta = delta;
+    return 1;
+  }
+
+  /* Replay the adapt journal with one cursor in the old and one in the
+   * new forest. The journal covers every element of both forests, so the
+   * runs tile both element ranges completely. */
+  journal = forest->adapt_journal;
+  old_pos = new_pos = 0;
+  for (ientry = 0; ientry < journal->elem_count; ientry++) {
+    entry = (t8_forest_adapt_journal_entry_t *)
+      sc_array_index (journal, ientry);
+    switch (entry->action) {
+    case T8_FOREST_ADAPT_KEPT:
+      t8_forest_delta_push (&delta->kept, 1, 1, old_pos, new_pos,
+                            entry->count);
+      old_pos += entry->count;
+      new_pos += entry->count;
+      break;
+    case T8_FOREST_ADAPT_REFINED:
+      t8_forest_delta_push (&delta->removed, 1, 0, old_pos, new_pos, 1);
+      t8_forest_delta_push (&delta->added, 0, 1, old_pos, new_pos,
+                            entry->count);
+      old_pos += 1;
+      new_pos += entry->count;
+      break;
+    case T8_FOREST_ADAPT_COARSENED:
+      t8_forest_delta_push (&delta->removed, 1, 0, old_pos, new_pos,
+                            entry->count);
+      t8_forest_delta_push (&delta->added, 0, 1, old_pos, new_pos, 1);
+      old_pos += entry->count;
+      new_pos += 1;
+      break;
+    case T8_FOREST_ADAPT_REMOVED:
+      t8_forest_delta_push (&delta->removed, 1, 0, old_pos, new_pos,
+                            entry->count);
+      old_pos += entry->count;
+      break;
+    default:
+      SC_ABORT_NOT_REACHED ();
+    }
+  }
+  T8_ASSERT (new_pos == forest->local_num_elements);
+
+  *pdelta = delta;
+  return 1;
+}
+
+void
+t8_forest_delta_destroy (t8_forest_delta_t **pdelta)
+{
+  t8_forest_delta_t  *delta;
+
+  T8_ASSERT (pdelta != NULL);
+  delta = *pdelta;
+  if (delta == NULL) {
+    return;
+  }
+  sc_array_reset (&delta->kept);
+  sc_array_reset (&delta->added);
+  sc_array_reset (&delta->removed);
+  T8_FREE (delta);
+  *pdelta = NULL;
+}
+
+/** Fire the registered cache invalidation hooks of a freshly committed
+ * forest. If the commit recorded an adapt journal, the tree partition is
+ * unchanged and the hooks fire only for the trees that hold a refined,
+ * coarsened or removed run; otherwise they fire for all local trees.
+ * \param [in,out] forest   The forest, must be committed.
+ */
+static void
+t8_forest_cache_hooks_fire (t8_forest_t forest)
+{
+  t8_forest_cache_hook_struct_t *hook;
+  t8_locidx_t         itree, num_trees;
+  size_t              ihook, ientry;
+  char               *tree_changed = NULL;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  if (forest->cache_hooks == NULL || forest->cache_hooks->elem_count == 0) {
+    return;
+  }
+  num_trees = t8_forest_get_num_local_trees (forest);
+  if (forest->adapt_journal != NULL) {
+    /* Mark the trees that hold at least one non-kept run. The journal is
+     * only recorded for adapt-only commits, so the local tree ids of the
+     * journal match this forest. */
+    t8_forest_adapt_journal_entry_t *entry;
+
+    tree_changed = T8_ALLOC_ZERO (char, num_trees);
+    for (ientry = 0; ientry < forest->adapt_journal->elem_count; ientry++) {
+      entry = (t8_forest_adapt_journal_entry_t *)
+        sc_array_index (forest->adapt_journal, ientry);
+      if (entry->action != T8_FOREST_ADAPT_KEPT) {
+        T8_ASSERT (0 <= entry->ltreeid && entry->ltreeid < num_trees);
+        tree_changed[entry->ltreeid] = 1;
+      }
+    }
+  }
+  for (itree = 0; itree < num_trees; itree++) {
+    if (tree_changed != NULL && !tree_changed[itree]) {
+      continue;
+    }
+    for (ihook = 0; ihook < forest->cache_hooks->elem_count; ihook++) {
+      hook = (t8_forest_cache_hook_struct_t *)
+        sc_array_index (forest->cache_hooks, ihook);
+      hook->callback (forest, itree, hook->user_data);
+    }
+  }
+  if (tree_changed != NULL) {
+    T8_FREE (tree_changed);
+  }
+}
+
 void
 t8_forest_set_user_data (t8_forest_t forest, void *data)
 {
@@ -344,6 +1085,12 @@ t8_forest_comm_global_num_elements (t8_forest_t forest)
   t8_gloidx_t         local_num_el;
   t8_gloidx_t         global_num_el;
 
+  if (forest->defer_global_count) {
+    /* t8_forest_commit_batch performs this reduction for several forests
+     * at once after their commits. */
+    forest->global_num_elements = -1;
+    return;
+  }
   local_num_el = (t8_gloidx_t) forest->local_num_elements;
   mpiret = sc_MPI_Allreduce (&local_num_el, &global_num_el, 1,
                              T8_MPI_GLOIDX, sc_MPI_SUM, forest->mpicomm);
@@ -448,9 +1195,383 @@ t8_forest_populate_irregular (t8_forest_t forest)
     t8_forest_commit (forest_tmp_partition);
     forest_zero = forest_tmp_partition;
   }
-  /* Copy all elements over to the original forest. */
-  t8_forest_copy_trees (forest, forest_zero, 1);
-  t8_forest_unref (&forest_tmp_partition);
+  /* Copy all elements over to the original forest. */
+  t8_forest_copy_trees (forest, forest_zero, 1);
+  t8_forest_unref (&forest_tmp_partition);
+}
+
+int
+t8_forest_field_id (t8_forest_t forest, const char *name)
+{
+  size_t              ifield;
+  t8_forest_field_struct_t *field;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (name != NULL);
+
+  if (forest->fields == NULL) {
+    return -1;
+  }
+  for (ifield = 0; ifield < forest->fields->elem_count; ifield++) {
+    field = (t8_forest_field_struct_t *)
+      sc_array_index (forest->fields, ifield);
+    if (!strcmp (field->name, name)) {
+      return (int) ifield;
+    }
+  }
+  return -1;
+}
+
+int
+t8_forest_num_fields (t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  return forest->fields == NULL ? 0 : (int) forest->fields->elem_count;
+}
+
+int
+t8_forest_field_register (t8_forest_t forest, const char *name,
+                          size_t bytes_per_element)
+{
+  t8_forest_field_struct_t *field;
+  size_t              num_entries;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (name != NULL
+             && strlen (name) < (size_t) T8_FOREST_FIELD_NAME_MAX);
+  T8_ASSERT (bytes_per_element > 0);
+  /* Field names must be unique per forest */
+  T8_ASSERT (t8_forest_field_id (forest, name) < 0);
+
+  if (forest->fields == NULL) {
+    forest->fields = sc_array_new (sizeof (t8_forest_field_struct_t));
+  }
+  field = (t8_forest_field_struct_t *) sc_array_push (forest->fields);
+  strncpy (field->name, name, T8_FOREST_FIELD_NAME_MAX - 1);
+  field->name[T8_FOREST_FIELD_NAME_MAX - 1] = '\0';
+  field->elem_bytes = bytes_per_element;
+  /* The field stores one entry per local element and one per ghost */
+  num_entries = (size_t) forest->local_num_elements
+    + (size_t) t8_forest_get_num_ghosts (forest);
+  field->data = sc_array_new_count (bytes_per_element, num_entries);
+  memset (field->data->array, 0, bytes_per_element * num_entries);
+  return (int) forest->fields->elem_count - 1;
+}
+
+void               *
+t8_forest_field_data (t8_forest_t forest, int field_id)
+{
+  t8_forest_field_struct_t *field;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (forest->fields != NULL);
+  T8_ASSERT (0 <= field_id
+             && (size_t) field_id < forest->fields->elem_count);
+
+  field = (t8_forest_field_struct_t *)
+    sc_array_index (forest->fields, (size_t) field_id);
+  return field->data->array;
+}
+
+void
+t8_forest_fields_exchange (t8_forest_t forest)
+{
+  sc_array_t        **arrays;
+  t8_forest_field_struct_t *field;
+  size_t              ifield;
+  int                 num_fields;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  num_fields = t8_forest_num_fields (forest);
+  if (num_fields <= 0) {
+    return;
+  }
+  /* Collect the field storages and update all ghost entries in a single
+   * round of communication. */
+  arrays = T8_ALLOC (sc_array_t *, num_fields);
+  for (ifield = 0; ifield < (size_t) num_fields; ifield++) {
+    field = (t8_forest_field_struct_t *)
+      sc_array_index (forest->fields, ifield);
+    arrays[ifield] = field->data;
+  }
+  t8_forest_ghost_exchange_data_multiple (forest, num_fields, arrays);
+  T8_FREE (arrays);
+}
+
+/** Carry the registered element data fields of a source forest over to a
+ * newly committed derived forest.
+ * The fields are registered on \a forest with the same names and entry
+ * widths and their values are migrated according to the commit step that
+ * built \a forest from \a forest_from: a copy step copies them, a partition
+ * step ships all fields of an element together in one
+ * \ref t8_forest_partition_data round and an adapt step replays the adapt
+ * journal, copying the parent value to new children and the first child
+ * value to a new parent. The ghost entries of the new fields are zero.
+ * \param [in,out] forest   The derived forest. Must be committed.
+ * \param [in] forest_from  The source forest the fields live on.
+ * \param [in] action       The commit step, one of \ref T8_FOREST_FROM_COPY,
+ *                          \ref T8_FOREST_FROM_ADAPT and
+ *                          \ref T8_FOREST_FROM_PARTITION.
+ */
+static void
+t8_forest_fields_inherit (t8_forest_t forest, t8_forest_t forest_from,
+                          int action)
+{
+  t8_forest_field_struct_t *field_from;
+  size_t              ifield;
+  size_t              num_fields;
+  size_t              elem_bytes;
+  char               *data_new;
+  const char         *data_old;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (t8_forest_is_committed (forest_from));
+  T8_ASSERT (forest_from->fields != NULL);
+
+  if (action == T8_FOREST_FROM_ADAPT && forest->adapt_journal == NULL) {
+    /* Without a journal the adapt pattern cannot be replayed (recursive
+     * adaptation), so the fields are not carried over. */
+    t8_debugf ("Not carrying element data fields across a recursive "
+               "adaptation.\n");
+    return;
+  }
+
+  num_fields = forest_from->fields->elem_count;
+  /* Register the same fields on the new forest */
+  for (ifield = 0; ifield < num_fields; ifield++) {
+    field_from = (t8_forest_field_struct_t *)
+      sc_array_index (forest_from->fields, ifield);
+    (void) t8_forest_field_register (forest, field_from->name,
+                                     field_from->elem_bytes);
+  }
+
+  if (action == T8_FOREST_FROM_COPY) {
+    /* The element layout is unchanged, copy the local entries */
+    T8_ASSERT (forest->local_num_elements ==
+               forest_from->local_num_elements);
+    for (ifield = 0; ifield < num_fields; ifield++) {
+      field_from = (t8_forest_field_struct_t *)
+        sc_array_index (forest_from->fields, ifield);
+      memcpy (t8_forest_field_data (forest, (int) ifield),
+              field_from->data->array,
+              field_from->elem_bytes * (size_t) forest->local_num_elements);
+    }
+  }
+  else if (action == T8_FOREST_FROM_PARTITION) {
+    /* Pack the entries of all fields of an element together, so that one
+     * partition data round migrates every field in the same messages. */
+    sc_array_t         *data_in;
+    sc_array_t         *data_out;
+    size_t              total_bytes = 0;
+    size_t              offset;
+    t8_locidx_t         ielem;
+
+    for (ifield = 0; ifield < num_fields; ifield++) {
+      field_from = (t8_forest_field_struct_t *)
+        sc_array_index (forest_from->fields, ifield);
+      total_bytes += field_from->elem_bytes;
+    }
+    data_in = sc_array_new_count (total_bytes,
+                                  (size_t) forest_from->local_num_elements);
+    data_out = sc_array_new_count (total_bytes,
+                                   (size_t) forest->local_num_elements);
+    offset = 0;
+    for (ifield = 0; ifield < num_fields; ifield++) {
+      field_from = (t8_forest_field_struct_t *)
+        sc_array_index (forest_from->fields, ifield);
+      elem_bytes = field_from->elem_bytes;
+      data_old = field_from->data->array;
+      for (ielem = 0; ielem < forest_from->local_num_elements; ielem++) {
+        memcpy (data_in->array + (size_t) ielem * total_bytes + offset,
+                data_old + (size_t) ielem * elem_bytes, elem_bytes);
+      }
+      offset += elem_bytes;
+    }
+    t8_forest_partition_data (forest_from, forest, data_in, data_out);
+    offset = 0;
+    for (ifield = 0; ifield < num_fields; ifield++) {
+      field_from = (t8_forest_field_struct_t *)
+        sc_array_index (forest_from->fields, ifield);
+      elem_bytes = field_from->elem_bytes;
+      data_new = (char *) t8_forest_field_data (forest, (int) ifield);
+      for (ielem = 0; ielem < forest->local_num_elements; ielem++) {
+        memcpy (data_new + (size_t) ielem * elem_bytes,
+                data_out->array + (size_t) ielem * total_bytes + offset,
+                elem_bytes);
+      }
+      offset += elem_bytes;
+    }
+    sc_array_destroy (data_in);
+    sc_array_destroy (data_out);
+  }
+  else {
+    /* Replay the adapt journal, advancing one position counter in the old
+     * and one in the new forest. */
+    t8_forest_adapt_journal_entry_t *entry;
+    size_t              ientry;
+    t8_locidx_t         iold = 0;
+    t8_locidx_t         inew = 0;
+    t8_locidx_t         iz;
+
+    T8_ASSERT (action == T8_FOREST_FROM_ADAPT);
+    for (ientry = 0; ientry < forest->adapt_journal->elem_count; ientry++) {
+      entry = (t8_forest_adapt_journal_entry_t *)
+        sc_array_index (forest->adapt_journal, ientry);
+      for (ifield = 0; ifield < num_fields; ifield++) {
+        field_from = (t8_forest_field_struct_t *)
+          sc_array_index (forest_from->fields, ifield);
+        elem_bytes = field_from->elem_bytes;
+        data_old = field_from->data->array;
+        data_new = (char *) t8_forest_field_data (forest, (int) ifield);
+        switch (entry->action) {
+        case T8_FOREST_ADAPT_KEPT:
+          memcpy (data_new + (size_t) inew * elem_bytes,
+                  data_old + (size_t) iold * elem_bytes,
+                  (size_t) entry->count * elem_bytes);
+          break;
+        case T8_FOREST_ADAPT_REFINED:
+          /* Each new child inherits the value of its parent */
+          for (iz = 0; iz < entry->count; iz++) {
+            memcpy (data_new + (size_t) (inew + iz) * elem_bytes,
+                    data_old + (size_t) iold * elem_bytes, elem_bytes);
+          }
+          break;
+        case T8_FOREST_ADAPT_COARSENED:
+          /* The new parent inherits the value of its first child */
+          memcpy (data_new + (size_t) inew * elem_bytes,
+                  data_old + (size_t) iold * elem_bytes, elem_bytes);
+          break;
+        default:
+          T8_ASSERT (entry->action == T8_FOREST_ADAPT_REMOVED);
+          break;
+        }
+      }
+      /* Advance the position counters according to the action */
+      switch (entry->action) {
+      case T8_FOREST_ADAPT_KEPT:
+        iold += entry->count;
+        inew += entry->count;
+        break;
+      case T8_FOREST_ADAPT_REFINED:
+        iold += 1;
+        inew += entry->count;
+        break;
+      case T8_FOREST_ADAPT_COARSENED:
+        iold += entry->count;
+        inew += 1;
+        break;
+      default:
+        iold += entry->count;
+        break;
+      }
+    }
+    T8_ASSERT (iold == forest_from->local_num_elements);
+    T8_ASSERT (inew == forest->local_num_elements);
+  }
+}
+
+/* Build the subcommunicator of the element holding ranks of a forest.
+ * If no rank is empty, the subcommunicator is the forest's communicator
+ * itself and no new communicator is created, so a forest that grows back
+ * to all ranks does not pay for the shrinking. Otherwise the element
+ * holding ranks split off a new communicator in rank order and the empty
+ * ranks receive sc_MPI_COMM_NULL.
+ * Collective over the forest's communicator. */
+static void
+t8_forest_subcomm_build (t8_forest_t forest)
+{
+  int                 is_empty, has_empty;
+  int                 mpiret;
+
+  T8_ASSERT (forest->do_subcomm);
+  T8_ASSERT (forest->subcomm == sc_MPI_COMM_NULL);
+
+  is_empty = forest->local_num_elements == 0;
+  mpiret = sc_MPI_Allreduce (&is_empty, &has_empty, 1, sc_MPI_INT,
+                             sc_MPI_LOR, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  if (!has_empty) {
+    /* Every rank holds elements, the full communicator serves as the
+     * subcommunicator. */
+    forest->subcomm = forest->mpicomm;
+    return;
+  }
+  mpiret = sc_MPI_Comm_split (forest->mpicomm,
+                              is_empty ? sc_MPI_UNDEFINED : 0,
+                              forest->mpirank, &forest->subcomm);
+  SC_CHECK_MPI (mpiret);
+}
+
+/* Accumulate the per eclass leaf counts and the level statistics of a
+ * forest in one pass over the local leafs and reduce them over all
+ * processes. The counts are indexed by element shape, so for schemes
+ * whose trees hold mixed shapes (for example tetrahedra inside pyramid
+ * trees) each leaf is attributed to its own shape.
+ * Collective over the forest's communicator. */
+static void
+t8_forest_compute_element_stats (t8_forest_t forest)
+{
+  t8_tree_t           tree;
+  t8_eclass_scheme_c *scheme;
+  t8_element_t       *element;
+  long long           local_counts[T8_ECLASS_COUNT + 1];
+  long long           global_counts[T8_ECLASS_COUNT + 1];
+  int                 local_minmax[2], global_minmax[2];
+  t8_locidx_t         itree, ielement, num_local_trees, num_tree_elements;
+  t8_gloidx_t         global_count;
+  int                 ieclass, level;
+  int                 mpiret;
+
+  /* The last entry of the count buffers accumulates the level sum for
+   * the mean level. local_minmax holds the maximum level and the negated
+   * minimum level, so that one maximum reduction yields both extrema;
+   * a process without elements contributes neutral entries. */
+  memset (local_counts, 0, sizeof (local_counts));
+  local_minmax[0] = -1;
+  local_minmax[1] = -forest->maxlevel - 1;
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0; itree < num_local_trees; itree++) {
+    tree = t8_forest_get_tree (forest, itree);
+    scheme = t8_forest_get_eclass_scheme (forest, tree->eclass);
+    num_tree_elements =
+      (t8_locidx_t) t8_element_array_get_count (&tree->elements);
+    for (ielement = 0; ielement < num_tree_elements; ielement++) {
+      element = t8_element_array_index_locidx (&tree->elements, ielement);
+      local_counts[t8_element_shape (scheme, element)]++;
+      level = t8_element_level (scheme, element);
+      local_counts[T8_ECLASS_COUNT] += level;
+      local_minmax[0] = SC_MAX (local_minmax[0], level);
+      local_minmax[1] = SC_MAX (local_minmax[1], -level);
+    }
+  }
+  mpiret = sc_MPI_Allreduce (local_counts, global_counts,
+                             T8_ECLASS_COUNT + 1, sc_MPI_LONG_LONG_INT,
+                             sc_MPI_SUM, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Allreduce (local_minmax, global_minmax, 2, sc_MPI_INT,
+                             sc_MPI_MAX, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  global_count = 0;
+  for (ieclass = 0; ieclass < T8_ECLASS_COUNT; ieclass++) {
+    forest->local_eclass_counts[ieclass] =
+      (t8_locidx_t) local_counts[ieclass];
+    forest->global_eclass_counts[ieclass] =
+      (t8_gloidx_t) global_counts[ieclass];
+    global_count += forest->global_eclass_counts[ieclass];
+  }
+  if (global_count > 0) {
+    forest->stats_max_level = global_minmax[0];
+    forest->stats_min_level = -global_minmax[1];
+    forest->stats_mean_level =
+      (double) global_counts[T8_ECLASS_COUNT] / (double) global_count;
+  }
+  else {
+    forest->stats_min_level = forest->stats_max_level = 0;
+    forest->stats_mean_level = 0;
+  }
+  forest->element_stats_valid = 1;
 }
 
 void
@@ -459,6 +1580,9 @@ t8_forest_commit (t8_forest_t forest)
   int                 mpiret;
   int                 partitioned = 0;
   sc_MPI_Comm         comm_dup;
+  t8_forest_t         fields_from = NULL;
+  int                 fields_action = -1;
+  int                 consumed_from = 0;
 
   T8_ASSERT (forest != NULL);
   T8_ASSERT (forest->rc.refcount > 0);
@@ -478,7 +1602,13 @@ t8_forest_commit (t8_forest_t forest)
     T8_ASSERT (forest->incomplete_trees == -1);
 
     /* dup communicator if requested */
-    if (forest->do_dup) {
+    if (forest->commit_context != NULL) {
+      /* The commit context owns the pipeline's communicator (and its
+       * duplicate, if one was requested), so we never dup per commit. */
+      forest->mpicomm = forest->commit_context->mpicomm;
+      forest->do_dup = 0;
+    }
+    else if (forest->do_dup) {
       mpiret = sc_MPI_Comm_dup (forest->mpicomm, &comm_dup);
       SC_CHECK_MPI (mpiret);
       forest->mpicomm = comm_dup;
@@ -490,6 +1620,8 @@ t8_forest_commit (t8_forest_t forest)
     SC_CHECK_MPI (mpiret);
     mpiret = sc_MPI_Comm_rank (forest->mpicomm, &forest->mpirank);
     SC_CHECK_MPI (mpiret);
+    /* Duplicate dedicated ghost/partition communicators if requested */
+    t8_forest_comm_isolation_setup (forest);
     /* Compute the maximum allowed refinement level */
     t8_forest_compute_maxlevel (forest);
     T8_ASSERT (forest->set_level <= forest->maxlevel);
@@ -503,6 +1635,14 @@ t8_forest_commit (t8_forest_t forest)
     }
     forest->global_num_trees = t8_cmesh_get_num_trees (forest->cmesh);
     forest->incomplete_trees = 0;
+    /* A uniform forest is balanced by construction */
+    forest->known_balanced = 1;
+    if (forest->do_ghost && forest->ghost_algorithm == 0) {
+      /* Automatic ghost algorithm selection. A new forest has no profile
+       * history, so the choice is based on the balance state only. */
+      forest->ghost_algorithm =
+        t8_forest_ghost_choose_algorithm (forest, NULL);
+    }
   }
   else {                        /* set_from != NULL */
     t8_forest_t         forest_from = forest->set_from; /* temporarily store set_from, since we may overwrite it */
@@ -518,14 +1658,21 @@ t8_forest_commit (t8_forest_t forest)
     /* TODO: optimize all this when forest->set_from has reference count one */
     /* TODO: Get rid of duping the communicator */
     /* we must prevent the case that set_from frees the source communicator */
-    if (!forest->set_from->do_dup) {
+    if (forest->commit_context != NULL) {
+      /* The commit context keeps the communicator alive across the whole
+       * pipeline, so derived forests share it without duplication. */
+      forest->mpicomm = forest->commit_context->mpicomm;
+      forest->do_dup = 0;
+    }
+    else if (!forest->set_from->do_dup) {
       forest->mpicomm = forest->set_from->mpicomm;
+      forest->do_dup = forest->set_from->do_dup;
     }
     else {
       mpiret = sc_MPI_Comm_dup (forest->set_from->mpicomm, &forest->mpicomm);
       SC_CHECK_MPI (mpiret);
+      forest->do_dup = forest->set_from->do_dup;
     }
-    forest->do_dup = forest->set_from->do_dup;
 
     /* Set mpirank and mpisize */
     mpiret = sc_MPI_Comm_size (forest->mpicomm, &forest->mpisize);
@@ -541,6 +1688,18 @@ t8_forest_commit (t8_forest_t forest)
     forest->cmesh = forest->set_from->cmesh;
     forest->scheme_cxx = forest->set_from->scheme_cxx;
     forest->global_num_trees = forest->set_from->global_num_trees;
+    /* Inherit the balance state of the source forest. It is invalidated
+     * below if we adapt without balancing afterwards. */
+    forest->known_balanced = forest->set_from->known_balanced;
+    /* Subcommunicator shrinking stays enabled along a forest hierarchy,
+     * so that the subcommunicator follows the changing element
+     * distribution through adapt/partition cycles. */
+    forest->do_subcomm = forest->do_subcomm || forest->set_from->do_subcomm;
+    /* Communicator isolation likewise stays enabled along a hierarchy */
+    forest->set_comm_isolation = forest->set_comm_isolation
+      || forest->set_from->set_comm_isolation;
+    /* Duplicate dedicated ghost/partition communicators if requested */
+    t8_forest_comm_isolation_setup (forest);
 
     /* Compute the maximum allowed refinement level */
     t8_forest_compute_maxlevel (forest);
@@ -548,37 +1707,69 @@ t8_forest_commit (t8_forest_t forest)
       SC_CHECK_ABORT (forest->set_from != NULL,
                       "No forest to copy from was specified.");
       t8_forest_copy_trees (forest, forest->set_from, 1);
+      fields_action = T8_FOREST_FROM_COPY;
     }
     /* TODO: currently we can only handle copy, adapt, partition, and balance */
 
     /* T8_ASSERT (forest->from_method == T8_FOREST_FROM_COPY); */
     if (forest->from_method & T8_FOREST_FROM_ADAPT) {
-      SC_CHECK_ABORT (forest->set_adapt_fn != NULL,
+      SC_CHECK_ABORT (forest->set_adapt_fn != NULL
+                      || forest->set_adapt_batched_fn != NULL,
                       "No adapt function specified");
       forest->from_method -= T8_FOREST_FROM_ADAPT;
+      /* Adaptation may introduce level jumps larger than one. If balance is
+       * also set, the balance step below restores the flag. */
+      forest->known_balanced = 0;
       if (forest->from_method > 0) {
         /* The forest should also be partitioned/balanced.
          * We first adapt the forest, then balance and then partition */
         t8_forest_t         forest_adapt;
 
         t8_forest_init (&forest_adapt);
-        /* forest_adapt should not change ownership of forest->set_from */
-        t8_forest_ref (forest->set_from);
+        if (forest->set_commit_fused && forest->set_from->rc.refcount == 1) {
+          /* Fused pipeline: hand our only reference of the source forest
+           * to the intermediate adapt, which streams the source leaf
+           * storage away tree by tree while adapting and destroys the
+           * source when it commits. The pipeline then holds at most one
+           * complete forest plus a single tree at its memory peak. */
+          consumed_from = 1;
+          t8_forest_set_adapt_recycle (forest_adapt, 1);
+        }
+        else {
+          /* forest_adapt should not change ownership of forest->set_from */
+          t8_forest_ref (forest->set_from);
+        }
         /* set user data of forest to forest_adapt */
         t8_forest_set_user_data (forest_adapt,
                                  t8_forest_get_user_data (forest));
         /* Construct an intermediate, adapted forest */
-        t8_forest_set_adapt (forest_adapt, forest->set_from,
-                             forest->set_adapt_fn,
-                             forest->set_adapt_recursive);
+        if (forest->set_adapt_batched_fn != NULL) {
+          t8_forest_set_adapt_batched (forest_adapt, forest->set_from,
+                                       forest->set_adapt_batched_fn);
+        }
+        else {
+          t8_forest_set_adapt (forest_adapt, forest->set_from,
+                               forest->set_adapt_fn,
+                               forest->set_adapt_recursive);
+        }
+        /* Pass a possibly set prune callback on */
+        forest_adapt->set_adapt_prune_fn = forest->set_adapt_prune_fn;
+        /* Share the commit context with the intermediate forest */
+        if (forest->commit_context != NULL) {
+          t8_forest_set_commit_context (forest_adapt, forest->commit_context);
+        }
         /* Set profiling if enabled */
         t8_forest_set_profiling (forest_adapt, forest->profile != NULL);
+        /* Only the final forest fires the cache invalidation hooks */
+        forest_adapt->commit_internal = 1;
         t8_forest_commit (forest_adapt);
         /* The new forest will be partitioned/balanced from forest_adapt */
         forest->set_from = forest_adapt;
-        /* Set the user data of forest_from to forest_adapt */
-        t8_forest_set_user_data (forest_adapt,
-                                 t8_forest_get_user_data (forest_from));
+        if (!consumed_from) {
+          /* Set the user data of forest_from to forest_adapt */
+          t8_forest_set_user_data (forest_adapt,
+                                   t8_forest_get_user_data (forest_from));
+        }
         /* If profiling is enabled copy the runtime of adapt. */
         if (forest->profile != NULL) {
           forest->profile->adapt_runtime =
@@ -587,8 +1778,27 @@ t8_forest_commit (t8_forest_t forest)
       }
       else {
         /* This forest should only be adapted */
+        if (forest->set_from->fields != NULL && !forest->set_adapt_recursive
+            && !forest->set_adapt_journal) {
+          /* The element data fields of the source forest are carried over
+           * by replaying the adapt journal, so ensure one is recorded. */
+          forest->set_adapt_journal = 1;
+        }
+        fields_action = T8_FOREST_FROM_ADAPT;
         t8_forest_copy_trees (forest, forest->set_from, 0);
         t8_forest_adapt (forest);
+        if (forest->do_ghost && forest->mpisize > 1
+            && forest->set_from->ghosts != NULL
+            && forest->ghost_type == forest->set_from->ghosts->ghost_type
+            && forest->ghost_width == forest->set_from->ghost_width
+            && !forest->set_adapt_recycle) {
+          /* The tree partition is unchanged, so if no process touched a
+           * boundary tree we can reuse the old ghost layer instead of
+           * rebuilding it below. The check compares old and new leaf
+           * elements, so it is unavailable in the memory lean adaptation
+           * mode, which already freed the source leafs. */
+          (void) t8_forest_ghost_update (forest, forest->set_from);
+        }
       }
     }
     if (forest->from_method & T8_FOREST_FROM_PARTITION) {
@@ -607,8 +1817,18 @@ t8_forest_commit (t8_forest_t forest)
         }
         t8_forest_set_partition (forest_partition, forest->set_from,
                                  forest->set_for_coarsening);
+        /* pass a possibly set partition weight function on */
+        t8_forest_set_partition_weights (forest_partition,
+                                         forest->set_partition_weight_fn);
+        /* Share the commit context with the intermediate forest */
+        if (forest->commit_context != NULL) {
+          t8_forest_set_commit_context (forest_partition,
+                                        forest->commit_context);
+        }
         /* activate profiling, if this forest has profiling */
         t8_forest_set_profiling (forest_partition, forest->profile != NULL);
+        /* Only the final forest fires the cache invalidation hooks */
+        forest_partition->commit_internal = 1;
         /* Commit the partitioned forest */
         t8_forest_commit (forest_partition);
         forest->set_from = forest_partition;
@@ -630,9 +1850,10 @@ t8_forest_commit (t8_forest_t forest)
         /* Partitioning is the last routine, no balance was set */
         forest->global_num_elements = forest->set_from->global_num_elements;
         /* Initialize the trees array of the forest */
-        forest->trees = sc_array_new (sizeof (t8_tree_struct_t));
+        forest->trees = t8_forest_recycle_trees_new (0);
         /* partition the forest */
         t8_forest_partition (forest);
+        fields_action = T8_FOREST_FROM_PARTITION;
       }
     }
     if (forest->from_method & T8_FOREST_FROM_BALANCE) {
@@ -643,7 +1864,16 @@ t8_forest_commit (t8_forest_t forest)
       T8_ASSERT (forest->from_method == 0);
 
       /* This forest should only be balanced */
-      if (forest->set_balance == T8_FOREST_BALANCE_NO_REPART) {
+      if (forest->balance_replace_fn != NULL) {
+        /* A data transfer callback is registered. We use the iterated
+         * algorithm, whose non-recursive rounds provide the one-level
+         * element correspondence the callback relies on. */
+        SC_CHECK_ABORT (forest->set_balance == T8_FOREST_BALANCE_NO_REPART,
+                        "t8_forest_set_balance_replace requires balance "
+                        "without repartitioning.");
+        t8_forest_balance_iterated (forest, 0);
+      }
+      else if (forest->set_balance == T8_FOREST_BALANCE_NO_REPART) {
         /* balance without repartition */
         t8_forest_balance (forest, 0);
       }
@@ -651,22 +1881,75 @@ t8_forest_commit (t8_forest_t forest)
         /* balance with repartition */
         t8_forest_balance (forest, 1);
       }
+      forest->known_balanced = 1;
     }
 
+    if (forest->do_ghost && forest->ghost_algorithm == 0) {
+      /* Automatic ghost algorithm selection was requested. We resolve it
+       * now, while the profile of the source forest is still available.
+       * In the fused pipeline the source forest was already consumed, so
+       * the selection falls back to its profile-free defaults. */
+      forest->ghost_algorithm =
+        t8_forest_ghost_choose_algorithm (forest,
+                                          consumed_from ? NULL : forest_from);
+    }
+    if (forest->do_ghost && forest->mpisize > 1) {
+      /* Decide collectively whether the ghost exchange bundles its
+       * messages through node leaders, based on the message sizes the
+       * source forest measured. */
+      forest->ghost_aggregate =
+        t8_forest_ghost_choose_aggregation (forest,
+                                            consumed_from ? NULL :
+                                            forest_from);
+    }
+
+    /* Inherit the cache generation and the registered invalidation hooks
+     * of the source forest, so that lineage keyed caches keep receiving
+     * their callbacks on derived forests. */
+    forest->generation = forest->set_from->generation + 1;
+    if (forest->set_from->cache_hooks != NULL) {
+      t8_forest_cache_hook_struct_t *hook_from;
+      size_t              iz;
+
+      if (forest->cache_hooks == NULL) {
+        forest->cache_hooks =
+          sc_array_new (sizeof (t8_forest_cache_hook_struct_t));
+      }
+      for (iz = 0; iz < forest->set_from->cache_hooks->elem_count; iz++) {
+        hook_from = (t8_forest_cache_hook_struct_t *)
+          sc_array_index (forest->set_from->cache_hooks, iz);
+        t8_forest_cache_hook_register (forest, hook_from->callback,
+                                       hook_from->user_data);
+      }
+    }
+    if (forest->set_from->fields != NULL && fields_action >= 0) {
+      /* Keep the source forest alive until this forest is committed, so
+       * that its element data fields can be carried over below. */
+      fields_from = forest->set_from;
+      t8_forest_ref (fields_from);
+    }
     if (forest_from != forest->set_from) {
       /* decrease reference count of intermediate input forest, possibly destroying it */
       t8_forest_unref (&forest->set_from);
     }
-    /* reset forest->set_from */
-    forest->set_from = forest_from;
-    /* decrease reference count of input forest, possibly destroying it */
-    t8_forest_unref (&forest->set_from);
+    if (consumed_from) {
+      /* The fused pipeline handed our reference of the input forest to
+       * the intermediate adapt, which already destroyed it. */
+      forest->set_from = NULL;
+    }
+    else {
+      /* reset forest->set_from */
+      forest->set_from = forest_from;
+      /* decrease reference count of input forest, possibly destroying it */
+      t8_forest_unref (&forest->set_from);
+    }
   }                             /* end set_from != NULL */
 
   /* Compute the element offset of the trees */
   t8_forest_compute_elements_offset (forest);
 
-  /* Compute first and last descendant for each tree */
+  /* Invalidate the stored first and last descendant of each tree; they
+   * are computed lazily on the first access per tree */
   t8_forest_compute_desc (forest);
 
   /* we do not need the set parameters anymore */
@@ -694,6 +1977,12 @@ t8_forest_commit (t8_forest_t forest)
     t8_forest_partition_create_first_desc (forest);
   }
 
+  if (forest->set_element_stats) {
+    /* Record the per eclass leaf counts and level statistics while the
+     * commit is still collective. */
+    t8_forest_compute_element_stats (forest);
+  }
+
   if (forest->profile != NULL) {
     /* If profiling is enabled, we measure the runtime of commit */
     forest->profile->commit_runtime = sc_MPI_Wtime () -
@@ -708,9 +1997,19 @@ t8_forest_commit (t8_forest_t forest)
                                forest->profile != NULL);
   }
 
+  /* Install the per tree geometry shortcuts. For trees with the linear
+   * vertex geometry the coordinate routines then evaluate a plain C
+   * kernel from the cached tree vertices instead of routing through the
+   * virtual dispatch and active tree bookkeeping of the geometry
+   * handler. Must happen after the cmesh was re-partitioned, since the
+   * cache points into the cmesh tree attributes. */
+  t8_forest_geometry_cache_create (forest);
+
   if (forest->mpisize > 1) {
-    /* Construct a ghost layer, if desired */
-    if (forest->do_ghost) {
+    /* Construct a ghost layer, if desired.
+     * If the ghost layer of the source forest was reused by
+     * t8_forest_ghost_update, there is nothing to do. */
+    if (forest->do_ghost && forest->ghosts == NULL) {
       /* TODO: ghost type */
       switch (forest->ghost_algorithm) {
       case 1:
@@ -728,11 +2027,82 @@ t8_forest_commit (t8_forest_t forest)
     }
     forest->do_ghost = 0;
   }
+
+  if (forest->do_subcomm) {
+    /* Build the subcommunicator of the element holding ranks, so that
+     * collectives on a coarse forest need not span the empty ranks. */
+    t8_forest_subcomm_build (forest);
+  }
+
+  if (fields_from != NULL) {
+    /* Carry the element data fields of the source forest over, now that
+     * this forest is committed and its ghost layer exists. */
+    t8_forest_fields_inherit (forest, fields_from, fields_action);
+    t8_forest_unref (&fields_from);
+  }
+
+  if (forest->cache_hooks != NULL && !forest->commit_internal) {
+    /* Fire the registered cache invalidation hooks, now that the forest
+     * is fully assembled including its ghost layer and data fields. */
+    t8_forest_cache_hooks_fire (forest);
+  }
 #ifdef T8_ENABLE_DEBUG
   t8_forest_partition_test_boundery_element (forest);
 #endif
 }
 
+void
+t8_forest_commit_batch (t8_forest_t *forests, const int num_forests)
+{
+  int                 iforest, jforest, count, mpiret;
+  t8_gloidx_t        *local_counts, *global_counts;
+
+  T8_ASSERT (num_forests >= 0);
+
+  /* Commit each forest with a deferred terminal global element count
+   * reduction. All other communication of a commit runs on the forest's
+   * own communicator and completes within its commit. */
+  for (iforest = 0; iforest < num_forests; iforest++) {
+    T8_ASSERT (t8_forest_is_initialized (forests[iforest]));
+    forests[iforest]->defer_global_count = 1;
+    t8_forest_commit (forests[iforest]);
+    forests[iforest]->defer_global_count = 0;
+  }
+
+  /* Carry out the deferred reductions, one vector valued collective per
+   * distinct communicator instead of one scalar collective per forest.
+   * Forests that inherited their count during commit carry a count >= 0
+   * and are skipped. */
+  local_counts = T8_ALLOC (t8_gloidx_t, num_forests);
+  global_counts = T8_ALLOC (t8_gloidx_t, num_forests);
+  for (iforest = 0; iforest < num_forests; iforest++) {
+    if (forests[iforest]->global_num_elements >= 0) {
+      continue;
+    }
+    count = 0;
+    for (jforest = iforest; jforest < num_forests; jforest++) {
+      if (forests[jforest]->global_num_elements < 0
+          && forests[jforest]->mpicomm == forests[iforest]->mpicomm) {
+        local_counts[count++] =
+          (t8_gloidx_t) forests[jforest]->local_num_elements;
+      }
+    }
+    mpiret = sc_MPI_Allreduce (local_counts, global_counts, count,
+                               T8_MPI_GLOIDX, sc_MPI_SUM,
+                               forests[iforest]->mpicomm);
+    SC_CHECK_MPI (mpiret);
+    count = 0;
+    for (jforest = iforest; jforest < num_forests; jforest++) {
+      if (forests[jforest]->global_num_elements < 0
+          && forests[jforest]->mpicomm == forests[iforest]->mpicomm) {
+        forests[jforest]->global_num_elements = global_counts[count++];
+      }
+    }
+  }
+  T8_FREE (local_counts);
+  T8_FREE (global_counts);
+}
+
 t8_locidx_t
 t8_forest_get_local_num_elements (t8_forest_t forest)
 {
@@ -749,6 +2119,109 @@ t8_forest_get_global_num_elements (t8_forest_t forest)
   return forest->global_num_elements;
 }
 
+/* Add the byte count of a partition offset shmem array to *bytes, if the
+ * array was constructed. */
+static void
+t8_forest_footprint_add_shmem (t8_shmem_array_t array, size_t *bytes)
+{
+  if (array != NULL) {
+    *bytes += t8_shmem_array_get_elem_count (array)
+      * t8_shmem_array_get_elem_size (array);
+  }
+}
+
+void
+t8_forest_get_memory_footprint (t8_forest_t forest,
+                                t8_forest_mem_footprint_t *footprint)
+{
+  t8_cmesh_mem_footprint_t cmesh_footprint;
+  t8_tree_t           tree;
+  t8_locidx_t         itree, num_local_trees;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (footprint != NULL);
+
+  /* The leaf element storage of the local trees */
+  footprint->elements_bytes = 0;
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0; itree < num_local_trees; itree++) {
+    tree = t8_forest_get_tree (forest, itree);
+    footprint->elements_bytes +=
+      t8_element_array_get_memory_used (&tree->elements);
+  }
+  /* The tree records and the forest struct */
+  footprint->trees_bytes = sizeof (t8_forest_struct_t) + sizeof (sc_array_t)
+    + (size_t) forest->trees->byte_alloc;
+  footprint->ghosts_bytes = t8_forest_ghost_memory_used (forest);
+  /* The partition offset arrays that were constructed so far */
+  footprint->offsets_bytes = 0;
+  t8_forest_footprint_add_shmem (forest->element_offsets,
+                                 &footprint->offsets_bytes);
+  t8_forest_footprint_add_shmem (forest->tree_offsets,
+                                 &footprint->offsets_bytes);
+  t8_forest_footprint_add_shmem (forest->global_first_desc,
+                                 &footprint->offsets_bytes);
+  t8_cmesh_get_memory_footprint (forest->cmesh, &cmesh_footprint);
+  footprint->cmesh_bytes = cmesh_footprint.total_bytes;
+  footprint->total_bytes = footprint->elements_bytes
+    + footprint->trees_bytes + footprint->ghosts_bytes
+    + footprint->offsets_bytes + footprint->cmesh_bytes;
+}
+
+size_t
+t8_forest_estimate_commit_memory (t8_forest_t forest)
+{
+  size_t              bytes, offsets_bytes;
+  int                 mpiret, mpisize;
+
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  /* The commit may construct all three offset arrays */
+  mpiret = sc_MPI_Comm_size (forest->mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  offsets_bytes = (size_t) (mpisize + 1)
+    * (2 * sizeof (t8_gloidx_t) + sizeof (t8_linearidx_t));
+
+  if (forest->set_from != NULL) {
+    /* A derived forest (adapt, partition, balance). We assume that the
+     * element count stays of the same order, so the peak is dominated by
+     * the source and the result leaf storage existing at the same time.
+     * The ghost layer of the result is estimated by the source's. */
+    t8_forest_mem_footprint_t from_footprint;
+
+    T8_ASSERT (t8_forest_is_committed (forest->set_from));
+    t8_forest_get_memory_footprint (forest->set_from, &from_footprint);
+    bytes = 2 * from_footprint.elements_bytes + from_footprint.trees_bytes
+      + from_footprint.ghosts_bytes + from_footprint.cmesh_bytes;
+  }
+  else {
+    /* A new uniform forest. Count the leafs of each local tree exactly
+     * from the refinement level. */
+    t8_cmesh_mem_footprint_t cmesh_footprint;
+    t8_eclass_scheme_c *scheme;
+    t8_eclass_t         eclass;
+    t8_locidx_t         itree, num_local_trees;
+    t8_gloidx_t         num_leafs;
+
+    T8_ASSERT (forest->cmesh != NULL
+               && t8_cmesh_is_committed (forest->cmesh));
+    T8_ASSERT (forest->scheme_cxx != NULL);
+    T8_ASSERT (forest->set_level >= 0);
+    bytes = 0;
+    num_local_trees = t8_cmesh_get_num_local_trees (forest->cmesh);
+    for (itree = 0; itree < num_local_trees; itree++) {
+      eclass = t8_cmesh_get_tree_class (forest->cmesh, itree);
+      scheme = forest->scheme_cxx->eclass_schemes[eclass];
+      num_leafs = t8_element_count_leafs_from_root (scheme,
+                                                    forest->set_level);
+      bytes += (size_t) num_leafs * t8_element_size (scheme);
+    }
+    t8_cmesh_get_memory_footprint (forest->cmesh, &cmesh_footprint);
+    bytes += cmesh_footprint.total_bytes;
+  }
+  return bytes + offsets_bytes;
+}
+
 t8_locidx_t
 t8_forest_get_num_ghosts (t8_forest_t forest)
 {
@@ -820,6 +2293,15 @@ t8_forest_get_mpicomm (t8_forest_t forest)
   return forest->mpicomm;
 }
 
+sc_MPI_Comm
+t8_forest_get_subcomm (t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (forest->do_subcomm);
+
+  return forest->subcomm;
+}
+
 t8_gloidx_t
 t8_forest_get_first_local_tree_id (t8_forest_t forest)
 {
@@ -896,6 +2378,17 @@ t8_forest_get_tree (t8_forest_t forest, t8_locidx_t ltree_id)
   return (t8_tree_t) t8_sc_array_index_locidx (forest->trees, ltree_id);
 }
 
+t8_element_scratch_t *
+t8_forest_get_element_scratch (t8_forest_t forest)
+{
+  T8_ASSERT (forest != NULL);
+  if (forest->element_scratch == NULL) {
+    /* Create the scratch arena on the first request. */
+    forest->element_scratch = t8_element_scratch_new ();
+  }
+  return forest->element_scratch;
+}
+
 double             *
 t8_forest_get_tree_vertices (t8_forest_t forest, t8_locidx_t ltreeid)
 {
@@ -1016,17 +2509,155 @@ t8_forest_get_element (t8_forest_t forest, t8_locidx_t lelement_id,
   return NULL;
 }
 
+void
+t8_forest_get_team_range (t8_forest_t forest, int iteam, int num_teams,
+                          t8_locidx_t *first_local_tree,
+                          t8_locidx_t *last_local_tree,
+                          t8_locidx_t *first_element,
+                          t8_locidx_t *last_element)
+{
+  t8_locidx_t         num_elements, el_begin, el_end, last_id;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (num_teams >= 1);
+  T8_ASSERT (0 <= iteam && iteam < num_teams);
+
+  /* Split the local elements into chunks of (almost) equal count, with
+   * the same splitting as the threaded phases use for their workers */
+  num_elements = t8_forest_get_local_num_elements (forest);
+  el_begin = (t8_locidx_t)
+    ((t8_gloidx_t) num_elements * iteam / num_teams);
+  el_end = (t8_locidx_t)
+    ((t8_gloidx_t) num_elements * (iteam + 1) / num_teams);
+  if (first_element != NULL) {
+    *first_element = el_begin;
+  }
+  if (last_element != NULL) {
+    *last_element = el_end;
+  }
+  if (first_local_tree == NULL && last_local_tree == NULL) {
+    return;
+  }
+  if (el_begin >= el_end) {
+    /* The team's range is empty. Mark it with an inverted tree range,
+     * like an empty forest marks its local trees. */
+    if (first_local_tree != NULL) {
+      *first_local_tree = 0;
+    }
+    if (last_local_tree != NULL) {
+      *last_local_tree = -1;
+    }
+    return;
+  }
+  /* Locate the trees of the first and last element of the range */
+  if (first_local_tree != NULL) {
+    *first_local_tree =
+      sc_array_bsearch (forest->trees, &el_begin,
+                        t8_forest_compare_elem_tree);
+    T8_ASSERT (*first_local_tree >= 0);
+  }
+  if (last_local_tree != NULL) {
+    last_id = el_end - 1;
+    *last_local_tree =
+      sc_array_bsearch (forest->trees, &last_id,
+                        t8_forest_compare_elem_tree);
+    T8_ASSERT (*last_local_tree >= 0);
+  }
+}
+
+t8_tree_hot_struct_t *
+t8_forest_get_tree_hot (t8_forest_t forest)
+{
+  t8_tree_hot_struct_t *record;
+  t8_tree_t           tree;
+  t8_locidx_t         num_local_trees, itree;
+  size_t              num_bytes;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  if (forest->tree_hot != NULL) {
+    return forest->tree_hot;
+  }
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  /* Allocate with slack and round the record pointer up to the cache
+   * line size, so that the 32 byte records never straddle a line. */
+  num_bytes = (size_t) num_local_trees * sizeof (t8_tree_hot_struct_t);
+  forest->tree_hot_storage = T8_ALLOC (char, num_bytes + 63);
+  forest->tree_hot = (t8_tree_hot_struct_t *)
+    (((size_t) forest->tree_hot_storage + 63) & ~(size_t) 63);
+  for (itree = 0; itree < num_local_trees; itree++) {
+    tree = t8_forest_get_tree (forest, itree);
+    record = forest->tree_hot + itree;
+    record->elements = &tree->elements;
+    record->elements_offset = tree->elements_offset;
+    record->num_elements =
+      (t8_locidx_t) t8_element_array_get_count (&tree->elements);
+    record->eclass = tree->eclass;
+  }
+  return forest->tree_hot;
+}
+
+t8_element_t       *
+t8_forest_get_element_fast (t8_forest_t forest, t8_locidx_t lelement_id,
+                            t8_locidx_t *ltreeid)
+{
+  t8_tree_hot_struct_t *tree_hot;
+  const t8_locidx_t  *offsets;
+  t8_locidx_t         num_local_trees, base, length, half;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= lelement_id
+             && lelement_id < t8_forest_get_local_num_elements (forest));
+
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  if (forest->tree_element_offsets == NULL) {
+    /* Build the flat offset index on the first lookup. */
+    t8_locidx_t         itree;
+    forest->tree_element_offsets =
+      T8_ALLOC (t8_locidx_t, num_local_trees + 1);
+    for (itree = 0; itree < num_local_trees; itree++) {
+      forest->tree_element_offsets[itree] =
+        t8_forest_get_tree (forest, itree)->elements_offset;
+    }
+    forest->tree_element_offsets[num_local_trees] =
+      forest->local_num_elements;
+  }
+  offsets = forest->tree_element_offsets;
+  /* Branch-free binary search for the last tree whose element offset is
+   * less than or equal to lelement_id. Ties between empty trees and
+   * their successor resolve to the rightmost tree, which is the one
+   * that actually stores the element. */
+  base = 0;
+  length = num_local_trees;
+  while (length > 1) {
+    half = length / 2;
+    base += (offsets[base + half] <= lelement_id) ? half : 0;
+    length -= half;
+  }
+  T8_ASSERT (offsets[base] <= lelement_id
+             && lelement_id < offsets[base + 1]);
+  if (ltreeid != NULL) {
+    *ltreeid = base;
+  }
+  /* Resolve the element storage through the hot tree table instead of
+   * the full tree struct */
+  tree_hot = t8_forest_get_tree_hot (forest);
+  return t8_element_array_index_locidx (tree_hot[base].elements,
+                                        lelement_id - offsets[base]);
+}
+
 t8_element_t       *
 t8_forest_get_element_in_tree (t8_forest_t forest, t8_locidx_t ltreeid,
                                t8_locidx_t leid_in_tree)
 {
-  t8_tree_t           tree;
+  t8_tree_hot_struct_t *tree_hot;
   T8_ASSERT (t8_forest_is_committed (forest));
   T8_ASSERT (0 <= ltreeid
              && ltreeid < t8_forest_get_num_local_trees (forest));
 
-  tree = t8_forest_get_tree (forest, ltreeid);
-  return t8_forest_get_tree_element (tree, leid_in_tree);
+  tree_hot = t8_forest_get_tree_hot (forest) + ltreeid;
+  T8_ASSERT (0 <= leid_in_tree && leid_in_tree < tree_hot->num_elements);
+  return t8_element_array_index_locidx (tree_hot->elements, leid_in_tree);
 }
 
 t8_locidx_t
@@ -1034,7 +2665,303 @@ t8_forest_get_tree_element_offset (t8_forest_t forest, t8_locidx_t ltreeid)
 {
   T8_ASSERT (t8_forest_is_committed (forest));
 
-  return t8_forest_get_tree (forest, ltreeid)->elements_offset;
+  return t8_forest_get_tree_hot (forest)[ltreeid].elements_offset;
+}
+
+/* Build the level view of a committed forest in one pass over the leafs:
+ * the per tree per level leaf counts and the leaf indices grouped by
+ * level via a counting sort, so the grouping is stable and the indices
+ * within each level stay ascending. */
+static void
+t8_forest_level_view_build (t8_forest_t forest)
+{
+  t8_tree_t           tree;
+  t8_eclass_scheme_c *scheme;
+  t8_element_t       *element;
+  t8_locidx_t        *cursor;
+  t8_locidx_t         itree, ielement, num_local_trees, num_tree_elements;
+  t8_locidx_t         element_index;
+  int                 num_levels, level, ilevel;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (forest->level_view_offsets == NULL);
+
+  num_levels = forest->maxlevel + 1;
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  forest->tree_level_counts =
+    T8_ALLOC_ZERO (t8_locidx_t, (size_t) num_local_trees * num_levels);
+  forest->level_view_offsets = T8_ALLOC_ZERO (t8_locidx_t, num_levels + 1);
+  /* Count the leafs of each tree per level */
+  for (itree = 0; itree < num_local_trees; itree++) {
+    tree = t8_forest_get_tree (forest, itree);
+    scheme = t8_forest_get_eclass_scheme (forest, tree->eclass);
+    num_tree_elements =
+      (t8_locidx_t) t8_element_array_get_count (&tree->elements);
+    for (ielement = 0; ielement < num_tree_elements; ielement++) {
+      element = t8_element_array_index_locidx (&tree->elements, ielement);
+      level = t8_element_level (scheme, element);
+      T8_ASSERT (0 <= level && level < num_levels);
+      forest->tree_level_counts[itree * num_levels + level]++;
+      forest->level_view_offsets[level + 1]++;
+    }
+  }
+  /* Turn the per level counts into offsets */
+  for (ilevel = 0; ilevel < num_levels; ilevel++) {
+    forest->level_view_offsets[ilevel + 1] +=
+      forest->level_view_offsets[ilevel];
+  }
+  T8_ASSERT (forest->level_view_offsets[num_levels]
+             == forest->local_num_elements);
+  /* Distribute the leaf indices into their level groups */
+  forest->level_view_indices =
+    T8_ALLOC (t8_locidx_t, forest->local_num_elements);
+  cursor = T8_ALLOC (t8_locidx_t, num_levels);
+  memcpy (cursor, forest->level_view_offsets,
+          num_levels * sizeof (t8_locidx_t));
+  element_index = 0;
+  for (itree = 0; itree < num_local_trees; itree++) {
+    tree = t8_forest_get_tree (forest, itree);
+    scheme = t8_forest_get_eclass_scheme (forest, tree->eclass);
+    num_tree_elements =
+      (t8_locidx_t) t8_element_array_get_count (&tree->elements);
+    for (ielement = 0; ielement < num_tree_elements; ielement++) {
+      element = t8_element_array_index_locidx (&tree->elements, ielement);
+      level = t8_element_level (scheme, element);
+      forest->level_view_indices[cursor[level]++] = element_index++;
+    }
+  }
+  T8_FREE (cursor);
+}
+
+const t8_locidx_t  *
+t8_forest_get_level_view (t8_forest_t forest, int level,
+                          t8_locidx_t *num_elements)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= level && level <= forest->maxlevel);
+  T8_ASSERT (num_elements != NULL);
+
+  if (forest->level_view_offsets == NULL) {
+    /* Build the level view on the first query */
+    t8_forest_level_view_build (forest);
+  }
+  *num_elements = forest->level_view_offsets[level + 1]
+    - forest->level_view_offsets[level];
+  return forest->level_view_indices + forest->level_view_offsets[level];
+}
+
+t8_locidx_t
+t8_forest_get_tree_num_level_elements (t8_forest_t forest,
+                                       t8_locidx_t ltreeid, int level)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= ltreeid
+             && ltreeid < t8_forest_get_num_local_trees (forest));
+  T8_ASSERT (0 <= level && level <= forest->maxlevel);
+
+  if (forest->tree_level_counts == NULL) {
+    t8_forest_level_view_build (forest);
+  }
+  return forest->tree_level_counts[ltreeid * (forest->maxlevel + 1) + level];
+}
+
+void
+t8_forest_get_eclass_counts (t8_forest_t forest, t8_eclass_t eclass,
+                             t8_locidx_t *local_count,
+                             t8_gloidx_t *global_count)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= eclass && eclass < T8_ECLASS_COUNT);
+  SC_CHECK_ABORT (forest->element_stats_valid,
+                  "Element statistics were not recorded for this forest. "
+                  "Call t8_forest_set_element_stats before commit.\n");
+
+  if (local_count != NULL) {
+    *local_count = forest->local_eclass_counts[eclass];
+  }
+  if (global_count != NULL) {
+    *global_count = forest->global_eclass_counts[eclass];
+  }
+}
+
+void
+t8_forest_get_level_stats (t8_forest_t forest, int *min_level,
+                           int *max_level, double *mean_level)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  SC_CHECK_ABORT (forest->element_stats_valid,
+                  "Element statistics were not recorded for this forest. "
+                  "Call t8_forest_set_element_stats before commit.\n");
+
+  if (min_level != NULL) {
+    *min_level = forest->stats_min_level;
+  }
+  if (max_level != NULL) {
+    *max_level = forest->stats_max_level;
+  }
+  if (mean_level != NULL) {
+    *mean_level = forest->stats_mean_level;
+  }
+}
+
+/* Layout of the packed reduction vector of t8_forest_compute_statistics.
+ * The first T8_FOREST_STATS_RED_NUM_MAX entries are combined with a
+ * maximum, all following entries with a sum; t8_forest_stats_reduce
+ * relies on this split. The level extrema need no slots of their own,
+ * they are read off the summed per level counts. */
+#define T8_FOREST_STATS_RED_MAX_ELEMENTS 0      /* largest local leaf count */
+#define T8_FOREST_STATS_RED_MAX_GHOSTS 1        /* largest local ghost count */
+#define T8_FOREST_STATS_RED_NUM_MAX 2
+#define T8_FOREST_STATS_RED_GHOSTS 2            /* sum of the local ghost counts */
+#define T8_FOREST_STATS_RED_LEVELS 3            /* per level leaf counts follow */
+
+#if T8_ENABLE_MPI
+/* The user defined operator of the fused statistics reduction. Combines
+ * the leading maximum segment of each vector with a maximum and the
+ * remaining entries with a sum. The vector is passed to the reduction as
+ * one contiguous derived datatype, so MPI cannot split it into chunks
+ * that would shift the segment boundary; the number of entries is
+ * recovered from the extent of the datatype. */
+static void
+t8_forest_stats_reduce (void *invec, void *inoutvec, int *len,
+                        MPI_Datatype *datatype)
+{
+  const long long    *in = (const long long *) invec;
+  long long          *inout = (long long *) inoutvec;
+  MPI_Aint            lb, extent;
+  size_t              num_entries, ientry, ioffset;
+  int                 iblock, mpiret;
+
+  mpiret = MPI_Type_get_extent (*datatype, &lb, &extent);
+  SC_CHECK_MPI (mpiret);
+  num_entries = (size_t) extent / sizeof (long long);
+  for (iblock = 0; iblock < *len; iblock++) {
+    ioffset = (size_t) iblock * num_entries;
+    for (ientry = 0; ientry < num_entries; ientry++) {
+      if (ientry < T8_FOREST_STATS_RED_NUM_MAX) {
+        inout[ioffset + ientry] =
+          SC_MAX (inout[ioffset + ientry], in[ioffset + ientry]);
+      }
+      else {
+        inout[ioffset + ientry] += in[ioffset + ientry];
+      }
+    }
+  }
+}
+#endif
+
+void
+t8_forest_compute_statistics (t8_forest_t forest, t8_forest_stats_t *stats)
+{
+  t8_tree_t           tree;
+  t8_eclass_scheme_c *scheme;
+  t8_element_t       *element;
+  long long          *local_red, *global_red;
+  t8_gloidx_t         global_count, level_sum, level_count;
+  t8_locidx_t         itree, ielement, num_local_trees, num_tree_elements;
+  t8_locidx_t         num_ghosts;
+  int                 num_levels, num_entries, level;
+#if T8_ENABLE_MPI
+  MPI_Datatype        red_type;
+  MPI_Op              red_op;
+  int                 mpiret;
+#endif
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (stats != NULL);
+  T8_ASSERT (forest->maxlevel < T8_FOREST_STATS_MAX_LEVELS);
+
+  num_levels = forest->maxlevel + 1;
+  num_entries = T8_FOREST_STATS_RED_LEVELS + num_levels;
+  local_red = T8_ALLOC_ZERO (long long, 2 * num_entries);
+  global_red = local_red + num_entries;
+
+  /* Gather the local tallies. If the level view of the forest was
+   * already built, its per tree counters are folded without touching any
+   * element; otherwise one sweep over the local leafs suffices. */
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  if (forest->tree_level_counts != NULL) {
+    for (itree = 0; itree < num_local_trees; itree++) {
+      for (level = 0; level < num_levels; level++) {
+        local_red[T8_FOREST_STATS_RED_LEVELS + level] +=
+          forest->tree_level_counts[itree * num_levels + level];
+      }
+    }
+  }
+  else {
+    for (itree = 0; itree < num_local_trees; itree++) {
+      tree = t8_forest_get_tree (forest, itree);
+      scheme = t8_forest_get_eclass_scheme (forest, tree->eclass);
+      num_tree_elements =
+        (t8_locidx_t) t8_element_array_get_count (&tree->elements);
+      for (ielement = 0; ielement < num_tree_elements; ielement++) {
+        element = t8_element_array_index_locidx (&tree->elements, ielement);
+        local_red[T8_FOREST_STATS_RED_LEVELS
+                  + t8_element_level (scheme, element)]++;
+      }
+    }
+  }
+  num_ghosts = t8_forest_get_num_ghosts (forest);
+  local_red[T8_FOREST_STATS_RED_MAX_ELEMENTS] = forest->local_num_elements;
+  local_red[T8_FOREST_STATS_RED_MAX_GHOSTS] = num_ghosts;
+  local_red[T8_FOREST_STATS_RED_GHOSTS] = num_ghosts;
+
+  /* The one fused reduction over the packed vector. */
+#if T8_ENABLE_MPI
+  mpiret = MPI_Type_contiguous (num_entries, MPI_LONG_LONG_INT, &red_type);
+  SC_CHECK_MPI (mpiret);
+  mpiret = MPI_Type_commit (&red_type);
+  SC_CHECK_MPI (mpiret);
+  mpiret = MPI_Op_create (t8_forest_stats_reduce, 1, &red_op);
+  SC_CHECK_MPI (mpiret);
+  mpiret = MPI_Allreduce (local_red, global_red, 1, red_type, red_op,
+                          forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = MPI_Op_free (&red_op);
+  SC_CHECK_MPI (mpiret);
+  mpiret = MPI_Type_free (&red_type);
+  SC_CHECK_MPI (mpiret);
+#else
+  memcpy (global_red, local_red, num_entries * sizeof (long long));
+#endif
+
+  /* Unpack the reduced vector into the statistics. */
+  memset (stats, 0, sizeof (*stats));
+  stats->min_level = -1;
+  global_count = 0;
+  level_sum = 0;
+  for (level = 0; level < num_levels; level++) {
+    level_count =
+      (t8_gloidx_t) global_red[T8_FOREST_STATS_RED_LEVELS + level];
+    stats->num_elements_per_level[level] = level_count;
+    global_count += level_count;
+    level_sum += (t8_gloidx_t) level * level_count;
+    if (level_count > 0) {
+      if (stats->min_level < 0) {
+        stats->min_level = level;
+      }
+      stats->max_level = level;
+    }
+  }
+  T8_ASSERT (global_count == forest->global_num_elements);
+  stats->global_num_elements = global_count;
+  stats->global_num_ghosts =
+    (t8_gloidx_t) global_red[T8_FOREST_STATS_RED_GHOSTS];
+  stats->max_local_num_elements =
+    (t8_locidx_t) global_red[T8_FOREST_STATS_RED_MAX_ELEMENTS];
+  stats->max_local_num_ghosts =
+    (t8_locidx_t) global_red[T8_FOREST_STATS_RED_MAX_GHOSTS];
+  if (global_count > 0) {
+    stats->mean_level = (double) level_sum / (double) global_count;
+    stats->ghost_fraction =
+      (double) stats->global_num_ghosts / (double) global_count;
+    stats->imbalance = (double) stats->max_local_num_elements
+      * (double) forest->mpisize / (double) global_count;
+  }
+  else {
+    stats->min_level = 0;
+  }
+  T8_FREE (local_red);
 }
 
 t8_locidx_t
@@ -1057,6 +2984,9 @@ t8_forest_get_tree_num_elements (t8_forest_t forest, t8_locidx_t ltreeid)
   T8_ASSERT (0 <= ltreeid
              && ltreeid < t8_forest_get_num_local_trees (forest));
 
+  if (forest->tree_hot != NULL) {
+    return forest->tree_hot[ltreeid].num_elements;
+  }
   return t8_forest_get_tree_element_count (t8_forest_get_tree (forest,
                                                                ltreeid));
 }
@@ -1071,7 +3001,11 @@ t8_forest_get_tree_class (t8_forest_t forest, t8_locidx_t ltreeid)
              && ltreeid <
              num_local_trees + t8_forest_get_num_ghost_trees (forest));
   if (ltreeid < num_local_trees) {
-    /* The id belongs to a local tree */
+    /* The id belongs to a local tree. Prefer the hot tree table, but do
+     * not build it here; this query is also used during commit. */
+    if (forest->tree_hot != NULL) {
+      return forest->tree_hot[ltreeid].eclass;
+    }
     return t8_forest_get_tree (forest, ltreeid)->eclass;
   }
   else {
@@ -1236,13 +3170,31 @@ t8_forest_set_profiling (t8_forest_t forest, int set_profiling)
   if (set_profiling) {
     if (forest->profile == NULL) {
       /* Only do something if profiling is not enabled already */
-      forest->profile = T8_ALLOC_ZERO (t8_profile_struct_t, 1);
+      if (t8_forest_recycle_num_profiles > 0) {
+        forest->profile =
+          t8_forest_recycle_profiles[--t8_forest_recycle_num_profiles];
+        memset (forest->profile, 0, sizeof (t8_profile_struct_t));
+      }
+      else {
+        forest->profile = T8_ALLOC_ZERO (t8_profile_struct_t, 1);
+      }
+      /* Also activate the region timers for the inner steps of adapt,
+       * ghost and partition. */
+      forest->profile->region_profile = t8_region_profile_new ();
     }
   }
   else {
     /* Free any profile that is already set */
     if (forest->profile != NULL) {
-      T8_FREE (forest->profile);
+      t8_region_profile_destroy (&forest->profile->region_profile);
+      if (t8_forest_recycle_num_profiles < T8_FOREST_RECYCLE_MAX) {
+        t8_forest_recycle_profiles[t8_forest_recycle_num_profiles++] =
+          forest->profile;
+      }
+      else {
+        T8_FREE (forest->profile);
+      }
+      forest->profile = NULL;
     }
   }
 }
@@ -1284,6 +3236,9 @@ t8_forest_compute_profile (t8_forest_t forest)
                    "forest: Balance runtime.");
     sc_stats_set1 (&forest->stats[13], profile->balance_rounds,
                    "forest: Balance rounds.");
+    sc_stats_set1 (&forest->stats[14],
+                   profile->ghost_message_sizes[0],
+                   "forest: Number of ghost messages below 1KiB.");
     /* compute stats */
     sc_stats_compute (sc_MPI_COMM_WORLD, T8_PROFILE_NUM_STATS, forest->stats);
     forest->stats_computed = 1;
@@ -1303,6 +3258,9 @@ t8_forest_print_profile (t8_forest_t forest)
     t8_logf (SC_LC_GLOBAL, SC_LP_STATISTICS, "Printing stats for forest.\n");
     sc_stats_print (t8_get_package_id (), SC_LP_STATISTICS,
                     T8_PROFILE_NUM_STATS, forest->stats, 1, 1);
+    /* Also print the region timers of the inner algorithm steps */
+    t8_region_profile_print (forest->profile->region_profile,
+                             forest->mpicomm);
   }
 }
 
@@ -1552,6 +3510,48 @@ t8_forest_new_uniform (t8_cmesh_t cmesh, t8_scheme_cxx_t *scheme,
   return forest;
 }
 
+t8_forest_t
+t8_forest_from_msh_partitioned (const char *fileprefix, sc_MPI_Comm comm,
+                                int dim, int master, int use_occ_geometry,
+                                t8_scheme_cxx_t *scheme, const int level,
+                                const int do_face_ghost)
+{
+  t8_cmesh_t          cmesh, cmesh_partition;
+
+  T8_ASSERT (fileprefix != NULL);
+  T8_ASSERT (scheme != NULL);
+  T8_ASSERT (0 <= level);
+
+  /* Read the mesh onto the master process only. In contrast to a
+   * replicated read no process ever holds a second copy of the full
+   * mesh, so the aggregate memory is bounded by one copy plus the
+   * final partition. */
+  cmesh =
+    t8_cmesh_from_msh_file (fileprefix, 1, comm, dim, master,
+                            use_occ_geometry);
+  if (cmesh == NULL) {
+    /* Reading failed on the master process. t8_cmesh_from_msh_file
+     * returns NULL collectively in this case. */
+    t8_scheme_cxx_unref (&scheme);
+    return NULL;
+  }
+  /* Derive the cmesh partitioned for a uniform refinement of the given
+   * level. The commit ships each tree from the master process directly
+   * to its owner and releases the master copy, so afterwards every
+   * process holds only its slice of the final partition. */
+  t8_cmesh_init (&cmesh_partition);
+  t8_cmesh_set_derive (cmesh_partition, cmesh);
+  /* set_partition_uniform takes ownership of the scheme, but we also
+   * pass it to the forest below. */
+  t8_scheme_cxx_ref (scheme);
+  t8_cmesh_set_partition_uniform (cmesh_partition, level, scheme);
+  t8_cmesh_commit (cmesh_partition, comm);
+  /* Build the uniform forest on the partitioned cmesh. This takes
+   * ownership of the cmesh and the scheme. */
+  return t8_forest_new_uniform (cmesh_partition, scheme, level,
+                                do_face_ghost, comm);
+}
+
 t8_forest_t
 t8_forest_new_adapt (t8_forest_t forest_from,
                      t8_forest_adapt_t adapt_fn,
@@ -1586,7 +3586,8 @@ t8_forest_free_trees (t8_forest_t forest)
     tree = (t8_tree_t) t8_sc_array_index_locidx (forest->trees, jt);
     t8_element_array_reset (&tree->elements);
   }
-  sc_array_destroy (forest->trees);
+  /* Keep the trees array skeleton for the next forest commit */
+  t8_forest_recycle_trees_retire (&forest->trees);
 }
 
 /* Completely destroy a forest and unreference all structs that the
@@ -1613,6 +3614,32 @@ t8_forest_reset (t8_forest_t *pforest)
     T8_ASSERT (forest->set_from == NULL);
   }
 
+  /* Free the subcommunicator of the element holding ranks if one was
+   * split off during commit */
+  if (forest->subcomm != sc_MPI_COMM_NULL
+      && forest->subcomm != forest->mpicomm) {
+    mpiret = sc_MPI_Comm_free (&forest->subcomm);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  /* Free the ghost neighborhood communicator if one was built during
+   * ghost creation */
+  if (forest->ghost_neighbor_comm != sc_MPI_COMM_NULL) {
+    mpiret = sc_MPI_Comm_free (&forest->ghost_neighbor_comm);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  /* Free the dedicated ghost and partition communicators if they were
+   * duplicated during commit */
+  if (forest->ghost_comm != sc_MPI_COMM_NULL) {
+    mpiret = sc_MPI_Comm_free (&forest->ghost_comm);
+    SC_CHECK_MPI (mpiret);
+  }
+  if (forest->partition_comm != sc_MPI_COMM_NULL) {
+    mpiret = sc_MPI_Comm_free (&forest->partition_comm);
+    SC_CHECK_MPI (mpiret);
+  }
+
   /* undup communicator if necessary */
   if (forest->committed) {
     if (forest->do_dup) {
@@ -1626,6 +3653,52 @@ t8_forest_reset (t8_forest_t *pforest)
   if (forest->ghosts != NULL) {
     t8_forest_ghost_unref (&forest->ghosts);
   }
+  /* Destroy the face neighbor index if it exists */
+  t8_forest_face_neighbor_index_destroy (forest);
+  /* Destroy the element scratch arena if it exists */
+  if (forest->element_scratch != NULL) {
+    t8_element_scratch_destroy (&forest->element_scratch);
+  }
+  /* Free the flat tree element offset index if it exists */
+  if (forest->tree_element_offsets != NULL) {
+    T8_FREE (forest->tree_element_offsets);
+  }
+  /* Free the hot tree table if it was built */
+  if (forest->tree_hot_storage != NULL) {
+    T8_FREE (forest->tree_hot_storage);
+  }
+  /* Free the level view if it was built */
+  if (forest->level_view_offsets != NULL) {
+    T8_FREE (forest->level_view_offsets);
+    T8_FREE (forest->level_view_indices);
+    T8_FREE (forest->tree_level_counts);
+  }
+  /* Destroy the geometry cache if it exists */
+  t8_forest_geometry_cache_destroy (forest);
+  /* Destroy the cached element bounding boxes if they exist */
+  t8_forest_aabb_cache_destroy (forest);
+  /* Destroy the adapt journal if it was recorded */
+  if (forest->adapt_journal != NULL) {
+    sc_array_destroy (forest->adapt_journal);
+  }
+  /* Destroy the adapt regions if they were set */
+  if (forest->set_adapt_regions != NULL) {
+    sc_array_destroy (forest->set_adapt_regions);
+  }
+  /* Destroy the registered cache invalidation hooks if there are any */
+  if (forest->cache_hooks != NULL) {
+    sc_array_destroy (forest->cache_hooks);
+  }
+  /* Destroy the registered element data fields if there are any */
+  if (forest->fields != NULL) {
+    size_t              ifield;
+    for (ifield = 0; ifield < forest->fields->elem_count; ifield++) {
+      t8_forest_field_struct_t *field = (t8_forest_field_struct_t *)
+        sc_array_index (forest->fields, ifield);
+      sc_array_destroy (field->data);
+    }
+    sc_array_destroy (forest->fields);
+  }
   /* we have taken ownership on calling t8_forest_set_* */
   if (forest->scheme_cxx != NULL) {
     t8_scheme_cxx_unref (&forest->scheme_cxx);
@@ -1634,6 +3707,18 @@ t8_forest_reset (t8_forest_t *pforest)
     t8_cmesh_unref (&forest->cmesh);
   }
 
+  if (forest->commit_context != NULL) {
+    /* Park the offset arrays in the commit context so that the next commit
+     * of the pipeline reuses their shared memory windows instead of opening
+     * new ones. Arrays the context has no room for are destroyed below. */
+    t8_forest_commit_context_park (forest->commit_context,
+                                   &forest->element_offsets);
+    t8_forest_commit_context_park (forest->commit_context,
+                                   &forest->global_first_desc);
+    t8_forest_commit_context_park (forest->commit_context,
+                                   &forest->tree_offsets);
+    t8_forest_commit_context_unref (&forest->commit_context);
+  }
   /* free the memory of the offset array */
   if (forest->element_offsets != NULL) {
     t8_shmem_array_destroy (&forest->element_offsets);
@@ -1646,11 +3731,37 @@ t8_forest_reset (t8_forest_t *pforest)
   if (forest->tree_offsets != NULL) {
     t8_shmem_array_destroy (&forest->tree_offsets);
   }
+  /* free the memory of the node_offsets array */
+  if (forest->node_offsets != NULL) {
+    t8_shmem_array_destroy (&forest->node_offsets);
+  }
+  /* free the speculation state, if any */
+  t8_forest_speculation_destroy (forest);
   if (forest->profile != NULL) {
-    T8_FREE (forest->profile);
+    t8_region_profile_destroy (&forest->profile->region_profile);
+    if (t8_forest_recycle_num_profiles < T8_FOREST_RECYCLE_MAX) {
+      t8_forest_recycle_profiles[t8_forest_recycle_num_profiles++] =
+        forest->profile;
+    }
+    else {
+      T8_FREE (forest->profile);
+    }
+  }
+  /* Keep the struct allocation for the next t8_forest_init */
+  if (t8_forest_recycle_num_structs < T8_FOREST_RECYCLE_MAX) {
+    t8_forest_recycle_structs[t8_forest_recycle_num_structs++] = forest;
+  }
+  else {
+    T8_FREE (forest);
   }
-  T8_FREE (forest);
   *pforest = NULL;
+  if (--t8_forest_recycle_live_forests == 0) {
+    /* The last live forest is gone; release all pooled skeletons and
+     * element storage slabs so that no memory is held back at
+     * sc_finalize */
+    t8_forest_recycle_pool_clear ();
+    t8_element_array_slab_pool_clear ();
+  }
 }
 
 void
@@ -1673,3 +3784,18 @@ t8_forest_unref (t8_forest_t *pforest)
     t8_forest_reset (pforest);
   }
 }
+
+void
+t8_forest_swap_storage (t8_forest_t *pforest_old, t8_forest_t forest_new)
+{
+  T8_ASSERT (pforest_old != NULL);
+  T8_ASSERT (*pforest_old != NULL);
+  T8_ASSERT (*pforest_old != forest_new);
+
+  /* Enable slab pooling, so that the element storage slabs of the old
+   * forest are retained and serve the allocations of the next commit
+   * instead of going back to the system allocator. */
+  t8_element_array_slab_pool_set (1);
+  t8_forest_unref (pforest_old);
+  *pforest_old = forest_new;
+}
@@ -24,12 +24,219 @@
 #include <t8_forest/t8_forest_types.h>
 #include <t8_forest/t8_forest_private.h>
 #include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_iterate.h>
 #include <t8_data/t8_containers.h>
 #include <t8_element_cxx.hxx>
+#include <t8_thread_pool.h>
+/* The concrete default schemes are included so that the per-tree adapt
+ * kernel can be instantiated with their final classes, which lets the
+ * compiler devirtualize and inline the element operations in the loop. */
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_vertex/t8_default_vertex_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_line/t8_default_line_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_quad/t8_default_quad_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_tri/t8_default_tri_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_hex/t8_default_hex_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_tet/t8_default_tet_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_prism/t8_default_prism_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_pyramid/t8_default_pyramid_cxx.hxx>
 
 /* We want to export the whole implementation to be callable from "C" */
 T8_EXTERN_C_BEGIN ();
 
+/* Minimum element count of a tree for which the adapt loop builds the
+ * linear id cache of the source element array to accelerate family
+ * detection. For smaller trees the build cost does not pay off. */
+#define T8_FOREST_ADAPT_ID_CACHE_MIN 16
+
+/* One entry of the speculation pool: the pre-generated children of one
+ * leaf that the predictor flagged for refinement. The entries are stored
+ * in ascending order of the parent's forest local element index, since
+ * the examination cursor only moves forward. */
+typedef struct t8_forest_speculation_entry
+{
+  t8_locidx_t         lelement; /* forest local index of the parent leaf */
+  int                 num_children;     /* number of pre-generated children */
+  char               *child_bytes;      /* their element storage, NULL once consumed */
+} t8_forest_speculation_entry_t;
+
+/* The speculative refinement state of a forest: the registered predictor
+ * and the side pool of pre-generated children,
+ * see t8_forest_set_speculation. */
+struct t8_forest_speculation
+{
+  t8_forest_speculate_t predictor;      /* the registered predictor */
+  void               *user_data;        /* passed to the predictor */
+  sc_array_t         *pool;     /* t8_forest_speculation_entry_t entries */
+  size_t              consumed; /* pool entries already passed by adapt */
+  t8_locidx_t         cursor;   /* next local element to examine */
+  unsigned            generation;       /* forest generation of the pool */
+};
+
+/* Drop all pool entries and restart the examination at the first leaf. */
+static void
+t8_forest_speculation_clear (struct t8_forest_speculation *speculation)
+{
+  size_t              ientry;
+
+  for (ientry = 0; ientry < speculation->pool->elem_count; ientry++) {
+    t8_forest_speculation_entry_t *entry = (t8_forest_speculation_entry_t *)
+      sc_array_index (speculation->pool, ientry);
+    T8_FREE (entry->child_bytes);
+  }
+  sc_array_truncate (speculation->pool);
+  speculation->consumed = 0;
+  speculation->cursor = 0;
+}
+
+void
+t8_forest_set_speculation (t8_forest_t forest,
+                           t8_forest_speculate_t predictor_fn,
+                           void *user_data)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  if (predictor_fn == NULL) {
+    t8_forest_speculation_destroy (forest);
+    return;
+  }
+  if (forest->speculation == NULL) {
+    forest->speculation = T8_ALLOC_ZERO (struct t8_forest_speculation, 1);
+    forest->speculation->pool =
+      sc_array_new (sizeof (t8_forest_speculation_entry_t));
+  }
+  else {
+    /* A pool built with the previous predictor is no longer meaningful */
+    t8_forest_speculation_clear (forest->speculation);
+  }
+  forest->speculation->predictor = predictor_fn;
+  forest->speculation->user_data = user_data;
+  forest->speculation->generation = forest->generation;
+}
+
+int
+t8_forest_speculation_pending (t8_forest_t forest)
+{
+  return forest->speculation != NULL
+    && (forest->speculation->generation != forest->generation
+        || forest->speculation->cursor < forest->local_num_elements);
+}
+
+void
+t8_forest_speculation_progress (t8_forest_t forest, t8_locidx_t num_leaves)
+{
+  struct t8_forest_speculation *speculation = forest->speculation;
+  t8_locidx_t         examined;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  if (speculation == NULL) {
+    return;
+  }
+  if (speculation->generation != forest->generation) {
+    /* The forest was modified in place, the pool refers to stale leafs */
+    t8_forest_speculation_clear (speculation);
+    speculation->generation = forest->generation;
+  }
+  for (examined = 0;
+       examined < num_leaves
+       && speculation->cursor < forest->local_num_elements; examined++) {
+    t8_locidx_t         ltree;
+    t8_element_t       *element =
+      t8_forest_get_element (forest, speculation->cursor, &ltree);
+    const t8_eclass_t   eclass = t8_forest_get_tree_class (forest, ltree);
+    t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, eclass);
+    const t8_locidx_t   lelement_id = speculation->cursor
+      - t8_forest_get_tree_element_offset (forest, ltree);
+
+    if (ts->t8_element_level (element) < forest->maxlevel
+        && speculation->predictor (forest, ltree, ts, lelement_id, element,
+                                   speculation->user_data)) {
+      /* Pre-generate the children of this leaf into a pool entry */
+      const int           num_children =
+        ts->t8_element_num_children (element);
+      const size_t        element_size = ts->t8_element_size ();
+      t8_element_t      **children =
+        T8_ALLOC (t8_element_t *, num_children);
+      t8_forest_speculation_entry_t *entry;
+      int                 ichild;
+
+      ts->t8_element_new (num_children, children);
+      ts->t8_element_children (element, num_children, children);
+      entry = (t8_forest_speculation_entry_t *)
+        sc_array_push (speculation->pool);
+      entry->lelement = speculation->cursor;
+      entry->num_children = num_children;
+      entry->child_bytes = T8_ALLOC (char, num_children * element_size);
+      for (ichild = 0; ichild < num_children; ichild++) {
+        memcpy (entry->child_bytes + ichild * element_size,
+                children[ichild], element_size);
+      }
+      ts->t8_element_destroy (num_children, children);
+      T8_FREE (children);
+    }
+    speculation->cursor++;
+  }
+}
+
+int
+t8_forest_speculation_consume (t8_forest_t forest_from, t8_locidx_t lelement,
+                               t8_eclass_scheme_c *ts, int num_children,
+                               t8_element_t **elements)
+{
+  struct t8_forest_speculation *speculation = forest_from->speculation;
+  t8_forest_speculation_entry_t *entry;
+
+  if (speculation == NULL
+      || speculation->generation != forest_from->generation) {
+    return 0;
+  }
+  /* The adaptation walks the leafs in ascending order, as does the
+   * examination cursor, so advancing a consume cursor past the smaller
+   * entries finds a hit in amortized constant time. */
+  while (speculation->consumed < speculation->pool->elem_count) {
+    entry = (t8_forest_speculation_entry_t *)
+      sc_array_index (speculation->pool, speculation->consumed);
+    if (entry->lelement >= lelement) {
+      break;
+    }
+    speculation->consumed++;
+  }
+  if (speculation->consumed >= speculation->pool->elem_count) {
+    return 0;
+  }
+  entry = (t8_forest_speculation_entry_t *)
+    sc_array_index (speculation->pool, speculation->consumed);
+  if (entry->lelement != lelement || entry->num_children != num_children
+      || entry->child_bytes == NULL) {
+    return 0;
+  }
+  {
+    const size_t        element_size = ts->t8_element_size ();
+    int                 ichild;
+
+    for (ichild = 0; ichild < num_children; ichild++) {
+      memcpy (elements[ichild],
+              entry->child_bytes + ichild * element_size, element_size);
+    }
+  }
+  T8_FREE (entry->child_bytes);
+  entry->child_bytes = NULL;
+  speculation->consumed++;
+  return 1;
+}
+
+void
+t8_forest_speculation_destroy (t8_forest_t forest)
+{
+  if (forest->speculation == NULL) {
+    return;
+  }
+  t8_forest_speculation_clear (forest->speculation);
+  sc_array_destroy (forest->speculation->pool);
+  T8_FREE (forest->speculation);
+  forest->speculation = NULL;
+}
+
 #if T8_ENABLE_DEBUG
 /** Return zero if the first \a num_elements in \a elements are not a (sub)family.
  * \param [in] tscheme       The element scheme for current local tree 
@@ -393,26 +600,181 @@ t8_forest_adapt_refine_recursive (t8_forest_t forest, t8_locidx_t ltreeid,
   }                             /* End while loop */
 }
 
-/* TODO: optimize this when we own forest_from */
-void
-t8_forest_adapt (t8_forest_t forest)
+/* The top-down walk of the prune pass of \ref t8_forest_adapt_tree.
+ * Input is an ancestor element and the array of all leafs of the tree that
+ * are descendants of it, analogous to the recursion of
+ * \ref t8_forest_search. The prune callback is evaluated for the element;
+ * if it accepts, all leafs of the subtree are flagged to be kept unchanged
+ * and the walk stops, otherwise it descends into the children. */
+static void
+t8_forest_adapt_prune_recursion (t8_forest_t forest, t8_forest_t forest_from,
+                                 t8_locidx_t ltree_id,
+                                 t8_eclass_scheme_c *ts,
+                                 t8_element_t *element,
+                                 t8_element_array_t *leaf_elements,
+                                 t8_locidx_t tree_lindex_of_first_leaf,
+                                 short *skip_flags)
 {
-  t8_forest_t         forest_from;
-  t8_eclass_scheme_c *tscheme;
+  t8_element_t      **children;
+  t8_element_array_t  child_leafs;
+  size_t             *split_offsets, indexa, indexb;
+  size_t              elem_count;
+  t8_locidx_t         ileaf;
+  int                 num_children, ichild, is_leaf;
+
+  elem_count = t8_element_array_get_count (leaf_elements);
+  if (elem_count == 0) {
+    /* There are no leafs left, so we have nothing to do */
+    return;
+  }
+
+  is_leaf = 0;
+  if (elem_count == 1) {
+    /* If the element equals its only leaf descendant, it is a leaf. */
+    const t8_element_t *leaf =
+      t8_element_array_index_locidx (leaf_elements, 0);
+    T8_ASSERT (ts->t8_element_level (element) <=
+               ts->t8_element_level (leaf));
+    if (ts->t8_element_level (element) == ts->t8_element_level (leaf)) {
+      T8_ASSERT (!ts->t8_element_compare (element, leaf));
+      is_leaf = 1;
+    }
+  }
+  if (forest->set_adapt_prune_fn (forest, forest_from, ltree_id, ts, element,
+                                  is_leaf, (t8_locidx_t) elem_count,
+                                  tree_lindex_of_first_leaf)) {
+    /* The whole subtree is quiescent. Flag its leafs, so the element loop
+     * keeps them without evaluating the adapt callback. */
+    for (ileaf = 0; ileaf < (t8_locidx_t) elem_count; ileaf++) {
+      skip_flags[tree_lindex_of_first_leaf + ileaf] = 1;
+    }
+    return;
+  }
+  if (is_leaf) {
+    /* The leafs of this subtree will be passed to the adapt callback. */
+    return;
+  }
+
+  /* Descend into the children of the element, splitting the leaf array
+   * into the portions that belong to each child. */
+  num_children = ts->t8_element_num_children (element);
+  children = T8_ALLOC (t8_element_t *, num_children);
+  /* The scheme mempools are shared, thus element allocation must be
+   * serialized when the trees are adapted by multiple threads. */
+#if T8_ENABLE_OPENMP
+#pragma omp critical (t8_forest_adapt_prune_element_alloc)
+#endif
+  ts->t8_element_new (num_children, children);
+  split_offsets = T8_ALLOC (size_t, num_children + 1);
+  ts->t8_element_children (element, num_children, children);
+  t8_forest_split_array (element, leaf_elements, split_offsets);
+  for (ichild = 0; ichild < num_children; ichild++) {
+    indexa = split_offsets[ichild];     /* first leaf of this child */
+    indexb = split_offsets[ichild + 1]; /* first leaf of next child */
+    if (indexa < indexb) {
+      t8_element_array_init_view (&child_leafs, leaf_elements, indexa,
+                                  indexb - indexa);
+      t8_forest_adapt_prune_recursion (forest, forest_from, ltree_id, ts,
+                                       children[ichild], &child_leafs,
+                                       tree_lindex_of_first_leaf +
+                                       (t8_locidx_t) indexa, skip_flags);
+    }
+  }
+  /* clean-up */
+#if T8_ENABLE_OPENMP
+#pragma omp critical (t8_forest_adapt_prune_element_alloc)
+#endif
+  ts->t8_element_destroy (num_children, children);
+  T8_FREE (children);
+  T8_FREE (split_offsets);
+}
+
+/* Append one run to an adapt journal. Runs of kept and removed elements
+ * are merged with the previous entry, refined and coarsened runs record
+ * one entry per element respectively family. If \a journal is NULL,
+ * nothing is recorded. */
+static void
+t8_forest_adapt_journal_record (sc_array_t *journal, t8_locidx_t ltreeid,
+                                t8_forest_adapt_action_t action,
+                                t8_locidx_t count)
+{
+  t8_forest_adapt_journal_entry_t *entry;
+
+  if (journal == NULL) {
+    return;
+  }
+  if ((action == T8_FOREST_ADAPT_KEPT || action == T8_FOREST_ADAPT_REMOVED)
+      && journal->elem_count > 0) {
+    entry = (t8_forest_adapt_journal_entry_t *)
+      sc_array_index (journal, journal->elem_count - 1);
+    if (entry->action == action && entry->ltreeid == ltreeid) {
+      /* Extend the previous run instead of starting a new entry. */
+      entry->count += count;
+      return;
+    }
+  }
+  entry = (t8_forest_adapt_journal_entry_t *) sc_array_push (journal);
+  entry->ltreeid = ltreeid;
+  entry->action = action;
+  entry->count = count;
+}
+
+/* The adapt kernel below is a template and thus cannot have "C" linkage. */
+T8_EXTERN_C_END ();
+
+/** Adapt a single local tree and build its new element array.
+ * This is the per-tree work horse of \ref t8_forest_adapt. It only reads
+ * from \a forest_from and writes to the element array of the tree
+ * \a ltree_id in \a forest, so distinct trees can be processed
+ * independently (and, if t8code was configured with --enable-openmp,
+ * concurrently). The element offset of the tree is not set here, since
+ * it depends on the preceding trees; the caller computes all offsets in
+ * a prefix pass over the per-tree element counts.
+ * \param [in,out] forest   The new forest currently in construction.
+ * \param [in] forest_from  The forest that is adapted; must be \a forest->set_from.
+ * \param [in] ltree_id     The local tree to adapt.
+ * \param [in] refine_list  Helper list for recursive refinement. Must be an
+ *                          empty list if \a forest->set_adapt_recursive is
+ *                          true and may be NULL otherwise. When threading,
+ *                          each thread must pass its own list.
+ * \param [in,out] journal  If not NULL, the adapt actions of this tree are
+ *                          recorded here as t8_forest_adapt_journal_entry_t.
+ *                          Must be NULL for recursive adaptation. When
+ *                          threading, each tree must get its own array.
+ * \param [in,out] element_removed Set to 1 if an element was removed from the tree.
+ *                          When threading, each thread must pass its own flag.
+ * \return                  The number of elements inserted into the new tree.
+ * \note This kernel is a template over the concrete scheme class. When the
+ * tree uses one of the (final) default schemes, \ref t8_forest_adapt_tree
+ * dispatches to the matching instantiation once per tree, so the element
+ * operations in the loop are devirtualized and can be inlined. The generic
+ * instantiation with \ref t8_eclass_scheme_c keeps the virtual dispatch and
+ * serves any other scheme implementation.
+ */
+template <typename scheme_t>
+static t8_locidx_t
+t8_forest_adapt_tree_kernel (t8_forest_t forest, t8_forest_t forest_from,
+                             t8_locidx_t ltree_id, sc_list_t * refine_list,
+                             sc_array_t *journal, int *element_removed)
+{
+  scheme_t           *tscheme;
   t8_element_array_t *telements;
   t8_element_array_t *telements_from;
   t8_element_t      **elements;
   t8_element_t      **elements_from;
-  t8_locidx_t         ltree_id;
-  t8_locidx_t         num_trees;
   t8_locidx_t         num_el_from;
   t8_locidx_t         el_considered;
   t8_locidx_t         el_inserted;
   t8_locidx_t         el_coarsen;
-  t8_locidx_t         el_offset;
   t8_tree_t           tree;
   t8_tree_t           tree_from;
-  sc_list_t          *refine_list = NULL;       /* This is only needed when we adapt recursively */
+  short              *refine_flags = NULL;
+  short              *skip_flags = NULL;
+  t8_locidx_t        *window_starts = NULL;
+  t8_locidx_t        *window_ends = NULL;
+  t8_locidx_t         num_windows = 0;
+  t8_locidx_t         iwindow = 0;
+  t8_locidx_t         window_end = 0;
   int                 num_children;
   int                 num_siblings;
   int                 curr_size_elements_from;
@@ -422,95 +784,288 @@ t8_forest_adapt (t8_forest_t forest)
   int                 ci;
   int                 refine;
   int                 is_family;
-  int                 element_removed = 0;
 
-  T8_ASSERT (forest != NULL);
-  T8_ASSERT (forest->set_from != NULL);
-  T8_ASSERT (forest->set_adapt_recursive != -1);
+  /* The journal cannot describe recursive adaptation, since recursive
+   * coarsening may merge elements that originate from different source
+   * elements. */
+  T8_ASSERT (journal == NULL || !forest->set_adapt_recursive);
 
-  /* if profiling is enabled, measure runtime */
-  if (forest->profile != NULL) {
-    forest->profile->adapt_runtime = -sc_MPI_Wtime ();
-    /* DO NOT DELETE THE FOLLOWING line.
-     * even if you do not want this output. It fixes a bug that occured on JUQUEEN, where the
-     * runtimes were computed to 0.
-     * Only delete the line, if you know what you are doing. */
-    t8_global_productionf ("Start adadpt %f %f\n", sc_MPI_Wtime (),
-                           forest->profile->adapt_runtime);
-  }
-
-  forest_from = forest->set_from;
-  t8_global_productionf ("Into t8_forest_adapt from %lld total elements\n",
-                         (long long) forest_from->global_num_elements);
+  /* Get the new and old tree and the new and old element arrays */
+  tree = t8_forest_get_tree (forest, ltree_id);
+  tree_from = t8_forest_get_tree (forest_from, ltree_id);
+  telements = &tree->elements;
+  telements_from = &tree_from->elements;
+  /* Number of elements in the old tree */
+  num_el_from = (t8_locidx_t) t8_element_array_get_count (telements_from);
+  T8_ASSERT (num_el_from ==
+             t8_forest_get_tree_num_elements (forest_from, ltree_id));
+  /* Continue only if tree_from is not empty.
+   * Otherwise there is nothing to adapt, since elements can't be inserted. */
+  if (num_el_from > 0) {
+    const t8_element_t *first_element_from = t8_element_array_index_locidx
+      (telements_from, 0);
+    /* Get the element scheme for this tree. The cast to the concrete
+     * scheme class is validated by the dispatcher. */
+    tscheme =
+      (scheme_t *) t8_forest_get_eclass_scheme (forest_from, tree->eclass);
+    if (forest->set_adapt_batched_fn != NULL) {
+      /* Evaluate the batched callback once for the whole tree. The refine
+       * decisions in the element loop below are then mere table lookups. */
+      T8_ASSERT (forest->set_adapt_fn == NULL);
+      T8_ASSERT (!forest->set_adapt_recursive);
+      refine_flags = T8_ALLOC_ZERO (short, num_el_from);
+      forest->set_adapt_batched_fn (forest, forest_from, ltree_id, tscheme,
+                                    num_el_from, telements_from,
+                                    refine_flags);
+    }
+    if (forest->set_adapt_prune_fn != NULL) {
+      /* Run the top-down prune pass over the tree. Leafs of accepted
+       * subtrees are flagged and skip the adapt callback in the element
+       * loop below. */
+      t8_element_t       *nca;
+      const t8_element_t *last_element_from =
+        t8_element_array_index_locidx (telements_from, num_el_from - 1);
+      T8_ASSERT (!forest->set_adapt_recursive);
+      skip_flags = T8_ALLOC_ZERO (short, num_el_from);
+#if T8_ENABLE_OPENMP
+#pragma omp critical (t8_forest_adapt_prune_element_alloc)
+#endif
+      tscheme->t8_element_new (1, &nca);
+      tscheme->t8_element_nca (first_element_from, last_element_from, nca);
+      t8_forest_adapt_prune_recursion (forest, forest_from, ltree_id,
+                                       tscheme, nca, telements_from, 0,
+                                       skip_flags);
+#if T8_ENABLE_OPENMP
+#pragma omp critical (t8_forest_adapt_prune_element_alloc)
+#endif
+      tscheme->t8_element_destroy (1, &nca);
+    }
+    if (forest->set_adapt_regions != NULL) {
+      /* Collect and prepare the adapt windows of this tree: clip them to
+       * the tree, extend them to the enclosing family boundaries and
+       * merge overlaps. The element loop below only evaluates the adapt
+       * callback inside the windows and copies everything in between
+       * wholesale. */
+      const size_t        num_regions = forest->set_adapt_regions->elem_count;
+      size_t              iregion;
+      t8_locidx_t         start, end, iwin;
+      window_starts = T8_ALLOC (t8_locidx_t, num_regions);
+      window_ends = T8_ALLOC (t8_locidx_t, num_regions);
+      for (iregion = 0; iregion < num_regions; iregion++) {
+        const t8_forest_adapt_region_t *region =
+          (const t8_forest_adapt_region_t *)
+          sc_array_index (forest->set_adapt_regions, iregion);
+        if (region->ltree_id != ltree_id) {
+          continue;
+        }
+        start = SC_MAX (region->start, 0);
+        end = SC_MIN (region->end, num_el_from);
+        if (start >= end) {
+          continue;
+        }
+        /* The first member of a family has child id 0, so no family
+         * straddles a boundary that lies on a child id 0 element. */
+        while (start > 0
+               && tscheme->
+               t8_element_child_id (t8_element_array_index_locidx
+                                    (telements_from, start)) != 0) {
+          start--;
+        }
+        while (end < num_el_from
+               && tscheme->
+               t8_element_child_id (t8_element_array_index_locidx
+                                    (telements_from, end)) != 0) {
+          end++;
+        }
+        /* Insert sorted by window start */
+        for (iwin = num_windows; iwin > 0 && window_starts[iwin - 1] > start;
+             iwin--) {
+          window_starts[iwin] = window_starts[iwin - 1];
+          window_ends[iwin] = window_ends[iwin - 1];
+        }
+        window_starts[iwin] = start;
+        window_ends[iwin] = end;
+        num_windows++;
+      }
+      /* Merge overlapping and touching windows */
+      iwin = 0;
+      for (start = 0; start < num_windows; start++) {
+        if (iwin > 0 && window_starts[start] <= window_ends[iwin - 1]) {
+          window_ends[iwin - 1] =
+            SC_MAX (window_ends[iwin - 1], window_ends[start]);
+        }
+        else {
+          window_starts[iwin] = window_starts[start];
+          window_ends[iwin] = window_ends[start];
+          iwin++;
+        }
+      }
+      num_windows = iwin;
+    }
+    int                 presized = 0;
+    if (refine_flags != NULL) {
+      /* With the refine decisions for the whole tree at hand we can bound
+       * the number of new elements before producing any: an element
+       * flagged for refinement contributes at most its children, every
+       * other element at most itself (a coarsened family contributes one
+       * parent for all of its members, a removed element nothing). We
+       * size the new element array once with this bound and fill it by
+       * index, so the element loop below performs no reallocations; the
+       * final resize shrinks the array to the exact count. */
+      t8_locidx_t         el_bound = 0;
+      t8_locidx_t         iel;
+      for (iel = 0; iel < num_el_from; iel++) {
+        if (refine_flags[iel] > 0) {
+          el_bound += (t8_locidx_t)
+            tscheme->t8_element_num_children (t8_element_array_index_locidx
+                                              (telements_from, iel));
+        }
+        else {
+          el_bound++;
+        }
+      }
+      t8_element_array_resize (telements, (size_t) el_bound);
+      presized = 1;
+    }
+    /* Index of the element we currently consider for refinement/coarsening. */
+    el_considered = 0;
+    /* Index into the newly inserted elements */
+    el_inserted = 0;
+    /* el_coarsen is the index of the first element in the new element
+     * array which could be coarsened recursively. */
+    el_coarsen = 0;
+    num_children = tscheme->t8_element_num_children (first_element_from);
+    curr_size_elements = num_children;
+    curr_size_elements_from =
+      tscheme->t8_element_num_siblings (first_element_from);
+    /* Buffer for a family of new elements */
+    elements = T8_ALLOC (t8_element_t *, num_children);
+    /* Buffer for a family of old elements */
+    elements_from = T8_ALLOC (t8_element_t *, curr_size_elements_from);
+    /* Family detection fast path: if the scheme's refinement table
+     * declares a uniform descendant count (as the default schemes except
+     * for pyramids do), every child of an element covers the same number
+     * of descendants at the maximum level, so family membership is
+     * decidable from the cached linear ids of consecutive leafs with pure
+     * integer arithmetic, see below. The cache of the source array is
+     * valid for the whole adapt loop since the source forest is not
+     * modified. */
+    const t8_linearidx_t *id_cache_from = NULL;
+    const int           maxlevel_from = forest_from->maxlevel;
+    const t8_scheme_table_t *scheme_table =
+      tscheme->t8_element_scheme_table ();
+    const int           leaf_count_log2 =
+      scheme_table != NULL ? scheme_table->leaf_count_log2 : -1;
+    if (!forest_from->incomplete_trees && leaf_count_log2 >= 0) {
+      if (num_el_from >= T8_FOREST_ADAPT_ID_CACHE_MIN
+          && t8_element_array_get_id_cache (telements_from,
+                                            maxlevel_from) == NULL) {
+        t8_element_array_build_id_cache (telements_from, maxlevel_from);
+      }
+      id_cache_from =
+        t8_element_array_get_id_cache (telements_from, maxlevel_from);
+    }
+    /* We now iterate over all elements in this tree and check them for refinement/coarsening. */
+    while (el_considered < num_el_from) {
+      if (window_starts != NULL && el_considered >= window_end) {
+        /* We are outside of the adapt windows. Copy the elements up to
+         * the next window (or the end of the tree) wholesale and
+         * continue the decision loop inside the window. */
+        t8_locidx_t         gap_end;
+        if (iwindow < num_windows) {
+          gap_end = window_starts[iwindow];
+          window_end = window_ends[iwindow];
+          iwindow++;
+        }
+        else {
+          gap_end = num_el_from;
+          window_end = num_el_from;
+        }
+        if (gap_end > el_considered) {
+          const t8_locidx_t   gap_count = gap_end - el_considered;
+          t8_element_t       *dest =
+            t8_element_array_push_count (telements, (size_t) gap_count);
+          memcpy (dest,
+                  t8_element_array_index_locidx (telements_from,
+                                                 el_considered),
+                  (size_t) gap_count *
+                  t8_element_array_get_size (telements_from));
+          el_inserted += gap_count;
+          t8_forest_adapt_journal_record (journal, ltree_id,
+                                          T8_FOREST_ADAPT_KEPT, gap_count);
+          el_considered = gap_end;
+        }
+        continue;
+      }
+      /* Load the current element and at most num_siblings-1 many others into
+       * the elements_from buffer. Stop when we are certain that they cannot from
+       * a family.
+       * At the end is_family will be true, if these elements form a family.
+       */
 
-  T8_ASSERT (forest_from->incomplete_trees != -1);
-  T8_ASSERT (forest->incomplete_trees == -1);
-  /* TODO: Allocate memory for the trees of forest.
-   * Will we do this here or in an extra function? */
-  T8_ASSERT (forest->trees->elem_count == forest_from->trees->elem_count);
+      num_siblings =
+        tscheme->t8_element_num_siblings (t8_element_array_index_locidx
+                                          (telements_from, el_considered));
 
-  if (forest->set_adapt_recursive) {
-    refine_list = sc_list_new (NULL);
-  }
-  forest->local_num_elements = 0;
-  el_offset = 0;
-  num_trees = t8_forest_get_num_local_trees (forest);
-  /* Iterate over the trees and build the new element arrays for each one. */
-  for (ltree_id = 0; ltree_id < num_trees; ltree_id++) {
-    /* Get the new and old tree and the new and old element arrays */
-    tree = t8_forest_get_tree (forest, ltree_id);
-    tree_from = t8_forest_get_tree (forest_from, ltree_id);
-    telements = &tree->elements;
-    telements_from = &tree_from->elements;
-    /* Number of elements in the old tree */
-    num_el_from = (t8_locidx_t) t8_element_array_get_count (telements_from);
-    T8_ASSERT (num_el_from ==
-               t8_forest_get_tree_num_elements (forest_from, ltree_id));
-    /* Continue only if tree_from is not empty.
-     * Otherwise there is nothing to adapt, since elements can't be inserted. */
-    if (num_el_from > 0) {
-      const t8_element_t *first_element_from = t8_element_array_index_locidx
-        (telements_from, 0);
-      /* Get the element scheme for this tree */
-      tscheme = t8_forest_get_eclass_scheme (forest_from, tree->eclass);
-      /* Index of the element we currently consider for refinement/coarsening. */
-      el_considered = 0;
-      /* Index into the newly inserted elements */
-      el_inserted = 0;
-      /* el_coarsen is the index of the first element in the new element
-       * array which could be coarsened recursively. */
-      el_coarsen = 0;
-      num_children = tscheme->t8_element_num_children (first_element_from);
-      curr_size_elements = num_children;
-      curr_size_elements_from =
-        tscheme->t8_element_num_siblings (first_element_from);
-      /* Buffer for a family of new elements */
-      elements = T8_ALLOC (t8_element_t *, num_children);
-      /* Buffer for a family of old elements */
-      elements_from = T8_ALLOC (t8_element_t *, curr_size_elements_from);
-      /* We now iterate over all elements in this tree and check them for refinement/coarsening. */
-      while (el_considered < num_el_from) {
-        /* Load the current element and at most num_siblings-1 many others into
-         * the elements_from buffer. Stop when we are certain that they cannot from
-         * a family.
-         * At the end is_family will be true, if these elements form a family.
-         */
-
-        num_siblings =
-          tscheme->t8_element_num_siblings (t8_element_array_index_locidx
-                                            (telements_from, el_considered));
-
-        if (num_siblings > curr_size_elements_from) {
-          /* Enlarge the elements_from buffer if required */
-          elements_from =
-            T8_REALLOC (elements_from, t8_element_t *, num_siblings);
-          curr_size_elements_from = num_siblings;
-        }
+      if (num_siblings > curr_size_elements_from) {
+        /* Enlarge the elements_from buffer if required */
+        elements_from =
+          T8_REALLOC (elements_from, t8_element_t *, num_siblings);
+        curr_size_elements_from = num_siblings;
+      }
 #if T8_ENABLE_DEBUG
-        for (zz = 0; zz < num_siblings; zz++) {
-          elements_from[zz] = NULL;
-        }
+      for (zz = 0; zz < num_siblings; zz++) {
+        elements_from[zz] = NULL;
+      }
 #endif
+      /* We assume that the elements do not form a family.
+       * So we will only pass the first element to the adapt callback. */
+      is_family = 0;
+      num_elements_to_adapt_callback = 1;
+      if (id_cache_from != NULL
+          && el_considered + (t8_locidx_t) num_siblings <= num_el_from) {
+        /* Fast path: decide family membership from the cached linear ids
+         * alone. The members of a family share the level of the first
+         * element, their ids are spaced by the descendant count of one
+         * member and the first id is aligned to the descendant count of
+         * the parent. Since levels are not cached, we additionally check
+         * that the element behind the window starts directly behind the
+         * family, which rules out a finer element in the last slot. */
+        elements_from[0] =
+          t8_element_array_index_locidx (telements_from, el_considered);
+        const int           level =
+          tscheme->t8_element_level (elements_from[0]);
+        if (level > 0) {
+          const int           shift =
+            leaf_count_log2 * (maxlevel_from - level);
+          const t8_linearidx_t leafs_per_member =
+            ((t8_linearidx_t) 1) << shift;
+          const t8_linearidx_t id_first = id_cache_from[el_considered];
+          zz = 1;
+          if (id_first % (leafs_per_member * num_siblings) == 0) {
+            while (zz < num_siblings
+                   && id_cache_from[el_considered + zz] ==
+                   id_first + (t8_linearidx_t) zz * leafs_per_member) {
+              zz++;
+            }
+          }
+          if (zz == num_siblings
+              && (el_considered + (t8_locidx_t) num_siblings == num_el_from
+                  || id_cache_from[el_considered + num_siblings] ==
+                  id_first +
+                  (t8_linearidx_t) num_siblings * leafs_per_member)) {
+            for (zz = 1; zz < num_siblings; zz++) {
+              elements_from[zz] =
+                t8_element_array_index_locidx (telements_from,
+                                               el_considered +
+                                               (t8_locidx_t) zz);
+            }
+            is_family = 1;
+            num_elements_to_adapt_callback = num_siblings;
+          }
+        }
+      }
+      else {
         for (zz = 0; zz < num_siblings &&
              el_considered + (t8_locidx_t) zz < num_el_from; zz++) {
           elements_from[zz] = t8_element_array_index_locidx (telements_from,
@@ -529,10 +1084,6 @@ t8_forest_adapt (t8_forest_t forest)
           }
         }
 
-        /* We assume that the elements do not form a family.
-         * So we will only pass the first element to the adapt callback. */
-        is_family = 0;
-        num_elements_to_adapt_callback = 1;
         if (forest_from->incomplete_trees) {
           is_family =
             t8_forest_is_incomplete_family (forest_from, ltree_id,
@@ -550,159 +1101,457 @@ t8_forest_adapt (t8_forest_t forest)
           is_family = 1;
           num_elements_to_adapt_callback = num_siblings;
         }
-        T8_ASSERT (num_elements_to_adapt_callback <= num_siblings);
+      }
+      T8_ASSERT (num_elements_to_adapt_callback <= num_siblings);
 #if T8_ENABLE_DEBUG
-        if (forest_from->incomplete_trees) {
-          T8_ASSERT (forest_from->incomplete_trees == 1);
-          T8_ASSERT (!is_family ||
-                     t8_forest_is_family_callback (tscheme,
-                                                   num_elements_to_adapt_callback,
-                                                   elements_from));
-        }
-        else {
-          T8_ASSERT (forest_from->incomplete_trees == 0);
-          T8_ASSERT (!is_family
-                     || tscheme->t8_element_is_family (elements_from));
-        }
+      if (forest_from->incomplete_trees) {
+        T8_ASSERT (forest_from->incomplete_trees == 1);
+        T8_ASSERT (!is_family ||
+                   t8_forest_is_family_callback (tscheme,
+                                                 num_elements_to_adapt_callback,
+                                                 elements_from));
+      }
+      else {
+        T8_ASSERT (forest_from->incomplete_trees == 0);
+        T8_ASSERT (!is_family
+                   || tscheme->t8_element_is_family (elements_from));
+      }
 #endif
-        /* Pass the element, or the family to the adapt callback.
-         * The output will be  1 if the element should be refined
-         *                     0 if the element should remain as is
-         *                    -1 if we passed a family and it should get coarsened
-         *                    -2 if the element should be removed.
-         */
+      /* Pass the element, or the family to the adapt callback.
+       * The output will be  1 if the element should be refined
+       *                     0 if the element should remain as is
+       *                    -1 if we passed a family and it should get coarsened
+       *                    -2 if the element should be removed.
+       */
+      if (skip_flags != NULL && skip_flags[el_considered]) {
+        /* The prune pass flagged this leaf to be kept unchanged, so the
+         * adapt callback is not evaluated. */
+        refine = 0;
+      }
+      else if (refine_flags != NULL) {
+        /* Look up the precomputed refine flag instead of calling the
+         * per-element callback. */
+        refine = refine_flags[el_considered];
+        if (refine == -1) {
+          if (!is_family) {
+            refine = 0;
+          }
+          for (zz = 1; refine == -1 && zz < num_elements_to_adapt_callback;
+               zz++) {
+            /* A family is only coarsened if all of its members are
+             * flagged for coarsening. */
+            if (refine_flags[el_considered + zz] != -1) {
+              refine = 0;
+            }
+          }
+        }
+      }
+      else {
         refine =
           forest->set_adapt_fn (forest, forest->set_from, ltree_id,
                                 el_considered, tscheme, is_family,
                                 num_elements_to_adapt_callback,
                                 elements_from);
+      }
 
-        T8_ASSERT (is_family || refine != -1);
-        if (refine > 0 && tscheme->t8_element_level (elements_from[0]) >=
-            forest->maxlevel) {
-          /* Only refine an element if it does not exceed the maximum level */
-          refine = 0;
-        }
-        if (refine == 1) {
-          /* The first element is to be refined */
-          num_children = tscheme->t8_element_num_children (elements_from[0]);
-          if (num_children > curr_size_elements) {
-            elements = T8_REALLOC (elements, t8_element_t *, num_children);
-            curr_size_elements = num_children;
+      T8_ASSERT (is_family || refine != -1);
+      if (skip_flags != NULL && refine == -1) {
+        /* A family may only be coarsened if none of its members lies in a
+         * pruned subtree, since those members must be kept unchanged. */
+        for (zz = 0; zz < num_elements_to_adapt_callback; zz++) {
+          if (skip_flags[el_considered + zz]) {
+            refine = 0;
+            break;
           }
-          if (forest->set_adapt_recursive) {
-            /* Create the children of this element */
-            tscheme->t8_element_new (num_children, elements);
-            tscheme->t8_element_children (elements_from[0], num_children,
-                                          elements);
-            for (ci = num_children - 1; ci >= 0; ci--) {
-              /* Prepend the children to the refine_list.
-               * These should now be the only elements in the list.
-               */
-              (void) sc_list_prepend (refine_list, elements[ci]);
-            }
-            /* We now recursively check the newly created elements for refinement. */
-            t8_forest_adapt_refine_recursive (forest, ltree_id, el_considered,
-                                              tscheme, refine_list, telements,
-                                              &el_inserted, elements,
-                                              &element_removed);
-            el_coarsen = el_inserted;
+        }
+      }
+      if (refine > 0 && tscheme->t8_element_level (elements_from[0]) >=
+          forest->maxlevel) {
+        /* Only refine an element if it does not exceed the maximum level */
+        refine = 0;
+      }
+      if (refine == 1) {
+        /* The first element is to be refined */
+        num_children = tscheme->t8_element_num_children (elements_from[0]);
+        if (num_children > curr_size_elements) {
+          elements = T8_REALLOC (elements, t8_element_t *, num_children);
+          curr_size_elements = num_children;
+        }
+        if (forest->set_adapt_recursive) {
+          /* Create the children of this element */
+          tscheme->t8_element_new (num_children, elements);
+          tscheme->t8_element_children (elements_from[0], num_children,
+                                        elements);
+          for (ci = num_children - 1; ci >= 0; ci--) {
+            /* Prepend the children to the refine_list.
+             * These should now be the only elements in the list.
+             */
+            (void) sc_list_prepend (refine_list, elements[ci]);
           }
-          else {
+          /* We now recursively check the newly created elements for refinement. */
+          t8_forest_adapt_refine_recursive (forest, ltree_id, el_considered,
+                                            tscheme, refine_list, telements,
+                                            &el_inserted, elements,
+                                            element_removed);
+          el_coarsen = el_inserted;
+        }
+        else {
+          if (!presized) {
             (void) t8_element_array_push_count (telements, num_children);
-            for (zz = 0; zz < num_children; zz++) {
-              elements[zz] =
-                t8_element_array_index_locidx (telements, el_inserted + zz);
-            }
+          }
+          for (zz = 0; zz < num_children; zz++) {
+            elements[zz] =
+              t8_element_array_index_locidx (telements, el_inserted + zz);
+          }
+          /* Serve the children from the speculation pool if they were
+           * pre-generated during a communication wait,
+           * see t8_forest_set_speculation. */
+          if (forest_from->speculation == NULL
+              || !t8_forest_speculation_consume (forest_from,
+                                                 t8_forest_get_tree_element_offset
+                                                 (forest_from, ltree_id)
+                                                 + el_considered, tscheme,
+                                                 num_children, elements)) {
             tscheme->t8_element_children (elements_from[0], num_children,
                                           elements);
-            el_inserted += (t8_locidx_t) num_children;
           }
-          el_considered++;
+          el_inserted += (t8_locidx_t) num_children;
+          t8_forest_adapt_journal_record (journal, ltree_id,
+                                          T8_FOREST_ADAPT_REFINED,
+                                          (t8_locidx_t) num_children);
         }
-        else if (refine == -1) {
-          /* The elements form a family and are to be coarsened. */
-          /* Make room for one more new element. */
-          elements[0] = t8_element_array_push (telements);
-          /* Compute the parent of the current family.
-           * This parent is now inserted in telements. */
-          T8_ASSERT (tscheme->t8_element_level (elements_from[0]) > 0);
-          tscheme->t8_element_parent (elements_from[0], elements[0]);
-          /* num_siblings is now equivalent to the number of children of elements[0],
-           * as num_siblings is always associated with elements_from*/
-          num_children = num_siblings;
-          el_inserted++;
-          if (num_children > curr_size_elements) {
-            elements = T8_REALLOC (elements, t8_element_t *, num_children);
-            curr_size_elements = num_children;
-          }
-          if (forest->set_adapt_recursive) {
-            /* Adaptation is recursive.
-             * We check whether the just generated parent is the last in its
-             * family (and not the only one).
-             * If so, we check this family for recursive coarsening. */
-            const int           child_id =
-              tscheme->t8_element_child_id (elements[0]);
-            if (child_id > 0 && child_id == num_children - 1) {
-              t8_forest_adapt_coarsen_recursive (forest, ltree_id,
-                                                 el_considered, tscheme,
-                                                 telements, el_coarsen,
-                                                 &el_inserted, elements);
-            }
-          }
-          el_considered += (t8_locidx_t) num_elements_to_adapt_callback;
+        el_considered++;
+      }
+      else if (refine == -1) {
+        /* The elements form a family and are to be coarsened. */
+        /* Make room for one more new element. */
+        elements[0] = presized ?
+          t8_element_array_index_locidx (telements, el_inserted) :
+          t8_element_array_push (telements);
+        /* Compute the parent of the current family.
+         * This parent is now inserted in telements. */
+        T8_ASSERT (tscheme->t8_element_level (elements_from[0]) > 0);
+        tscheme->t8_element_parent (elements_from[0], elements[0]);
+        /* num_siblings is now equivalent to the number of children of elements[0],
+         * as num_siblings is always associated with elements_from*/
+        num_children = num_siblings;
+        el_inserted++;
+        if (num_children > curr_size_elements) {
+          elements = T8_REALLOC (elements, t8_element_t *, num_children);
+          curr_size_elements = num_children;
         }
-        else if (refine == 0) {
-          /* The considered elements are neither to be coarsened nor is the first
-           * one to be refined.
-           * We copy the element to the new element array. */
-          elements[0] = t8_element_array_push (telements);
-          tscheme->t8_element_copy (elements_from[0], elements[0]);
-          el_inserted++;
-          if (forest->set_adapt_recursive) {
-            /* Adaptation is recursive.
-             * If adaptation is recursive and this was the last element in its family
-             * (and not the only one), we need to check for recursive coarsening. */
-            const int           child_id =
-              tscheme->t8_element_child_id (elements[0]);
-            if (child_id > 0 && child_id == num_children - 1) {
-              t8_forest_adapt_coarsen_recursive (forest, ltree_id,
-                                                 el_considered, tscheme,
-                                                 telements, el_coarsen,
-                                                 &el_inserted, elements);
-            }
+        if (forest->set_adapt_recursive) {
+          /* Adaptation is recursive.
+           * We check whether the just generated parent is the last in its
+           * family (and not the only one).
+           * If so, we check this family for recursive coarsening. */
+          const int           child_id =
+            tscheme->t8_element_child_id (elements[0]);
+          if (child_id > 0 && child_id == num_children - 1) {
+            t8_forest_adapt_coarsen_recursive (forest, ltree_id,
+                                               el_considered, tscheme,
+                                               telements, el_coarsen,
+                                               &el_inserted, elements);
           }
-          el_considered++;
         }
-        else {
-          /* Remove the element */
-          T8_ASSERT (refine == -2);
-          element_removed = 1;
-          el_considered++;
+        t8_forest_adapt_journal_record (journal, ltree_id,
+                                        T8_FOREST_ADAPT_COARSENED,
+                                        (t8_locidx_t)
+                                        num_elements_to_adapt_callback);
+        el_considered += (t8_locidx_t) num_elements_to_adapt_callback;
+      }
+      else if (refine == 0) {
+        /* The considered elements are neither to be coarsened nor is the first
+         * one to be refined.
+         * We copy the element to the new element array. */
+        elements[0] = presized ?
+          t8_element_array_index_locidx (telements, el_inserted) :
+          t8_element_array_push (telements);
+        tscheme->t8_element_copy (elements_from[0], elements[0]);
+        el_inserted++;
+        if (forest->set_adapt_recursive) {
+          /* Adaptation is recursive.
+           * If adaptation is recursive and this was the last element in its family
+           * (and not the only one), we need to check for recursive coarsening. */
+          const int           child_id =
+            tscheme->t8_element_child_id (elements[0]);
+          if (child_id > 0 && child_id == num_children - 1) {
+            t8_forest_adapt_coarsen_recursive (forest, ltree_id,
+                                               el_considered, tscheme,
+                                               telements, el_coarsen,
+                                               &el_inserted, elements);
+          }
         }
-      }                         /* End element loop */
+        t8_forest_adapt_journal_record (journal, ltree_id,
+                                        T8_FOREST_ADAPT_KEPT, 1);
+        el_considered++;
+      }
+      else {
+        /* Remove the element */
+        T8_ASSERT (refine == -2);
+        *element_removed = 1;
+        t8_forest_adapt_journal_record (journal, ltree_id,
+                                        T8_FOREST_ADAPT_REMOVED, 1);
+        el_considered++;
+      }
+    }                         /* End element loop */
 
-      /* Check that if we had recursive adaptation, the refine list is now empty. */
-      T8_ASSERT (!forest->set_adapt_recursive
-                 || refine_list->elem_count == 0);
+    /* Check that if we had recursive adaptation, the refine list is now empty. */
+    T8_ASSERT (!forest->set_adapt_recursive
+               || refine_list->elem_count == 0);
 
-      /* Set the new element offset of this tree */
-      tree->elements_offset = el_offset;
-      el_offset += el_inserted;
-      /* Add to the new number of local elements. */
-      forest->local_num_elements += el_inserted;
-      /* Possibly shrink the telements array to the correct size */
-      t8_element_array_resize (telements, el_inserted);
+    /* Possibly shrink the telements array to the correct size */
+    t8_element_array_resize (telements, el_inserted);
 
-      /* clean up */
-      T8_FREE (elements);
-      T8_FREE (elements_from);
-    }                           /* End if (num_el_from > 0) */
-  }                             /* End tree loop */
-  if (forest->set_adapt_recursive) {
     /* clean up */
-    sc_list_destroy (refine_list);
+    T8_FREE (refine_flags);
+    T8_FREE (skip_flags);
+    T8_FREE (window_starts);
+    T8_FREE (window_ends);
+    T8_FREE (elements);
+    T8_FREE (elements_from);
+    return el_inserted;
+  }                             /* End if (num_el_from > 0) */
+  return 0;
+}
+
+/** Adapt a single local tree, dispatching to the kernel instantiation that
+ * matches the tree's scheme.
+ * If the tree uses one of the default schemes, the kernel specialized for
+ * the concrete scheme class is selected once per tree, removing the virtual
+ * dispatch from the element loop. Any other scheme falls back to the
+ * generic kernel. See \ref t8_forest_adapt_tree_kernel for the parameters.
+ */
+static t8_locidx_t
+t8_forest_adapt_tree (t8_forest_t forest, t8_forest_t forest_from,
+                      t8_locidx_t ltree_id, sc_list_t * refine_list,
+                      sc_array_t *journal, int *element_removed)
+{
+  t8_tree_t           tree = t8_forest_get_tree (forest, ltree_id);
+  t8_eclass_scheme_c *tscheme =
+    t8_forest_get_eclass_scheme (forest_from, tree->eclass);
+
+  if (t8_eclass_scheme_is_default (tscheme)) {
+    switch (tree->eclass) {
+    case T8_ECLASS_VERTEX:
+      return t8_forest_adapt_tree_kernel <t8_default_scheme_vertex_c>
+        (forest, forest_from, ltree_id, refine_list, journal,
+         element_removed);
+    case T8_ECLASS_LINE:
+      return t8_forest_adapt_tree_kernel <t8_default_scheme_line_c>
+        (forest, forest_from, ltree_id, refine_list, journal,
+         element_removed);
+    case T8_ECLASS_QUAD:
+      return t8_forest_adapt_tree_kernel <t8_default_scheme_quad_c>
+        (forest, forest_from, ltree_id, refine_list, journal,
+         element_removed);
+    case T8_ECLASS_TRIANGLE:
+      return t8_forest_adapt_tree_kernel <t8_default_scheme_tri_c>
+        (forest, forest_from, ltree_id, refine_list, journal,
+         element_removed);
+    case T8_ECLASS_HEX:
+      return t8_forest_adapt_tree_kernel <t8_default_scheme_hex_c>
+        (forest, forest_from, ltree_id, refine_list, journal,
+         element_removed);
+    case T8_ECLASS_TET:
+      return t8_forest_adapt_tree_kernel <t8_default_scheme_tet_c>
+        (forest, forest_from, ltree_id, refine_list, journal,
+         element_removed);
+    case T8_ECLASS_PRISM:
+      return t8_forest_adapt_tree_kernel <t8_default_scheme_prism_c>
+        (forest, forest_from, ltree_id, refine_list, journal,
+         element_removed);
+    case T8_ECLASS_PYRAMID:
+      return t8_forest_adapt_tree_kernel <t8_default_scheme_pyramid_c>
+        (forest, forest_from, ltree_id, refine_list, journal,
+         element_removed);
+    default:
+      SC_ABORT_NOT_REACHED ();
+    }
+  }
+  /* Generic fallback for non-default schemes, using the virtual table. */
+  return t8_forest_adapt_tree_kernel <t8_eclass_scheme_c>
+    (forest, forest_from, ltree_id, refine_list, journal, element_removed);
+}
+
+T8_EXTERN_C_BEGIN ();
+
+void
+t8_forest_adapt (t8_forest_t forest)
+{
+  t8_forest_t         forest_from;
+  t8_locidx_t         ltree_id;
+  t8_locidx_t         num_trees;
+  t8_locidx_t         el_offset;
+  t8_locidx_t        *el_inserted_per_tree;
+  sc_list_t          *refine_list = NULL;       /* This is only needed when we adapt recursively */
+  sc_array_t        **tree_journals = NULL;     /* Per tree journals, merged after the tree loop */
+  int                 element_removed = 0;
+  int                 recycle;
+  t8_region_profile_t *region_profile;
+
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (forest->set_from != NULL);
+  T8_ASSERT (forest->set_adapt_recursive != -1);
+
+  /* if profiling is enabled, measure runtime */
+  if (forest->profile != NULL) {
+    forest->profile->adapt_runtime = -sc_MPI_Wtime ();
+    /* DO NOT DELETE THE FOLLOWING line.
+     * even if you do not want this output. It fixes a bug that occured on JUQUEEN, where the
+     * runtimes were computed to 0.
+     * Only delete the line, if you know what you are doing. */
+    t8_global_productionf ("Start adadpt %f %f\n", sc_MPI_Wtime (),
+                           forest->profile->adapt_runtime);
+  }
+
+  region_profile =
+    forest->profile != NULL ? forest->profile->region_profile : NULL;
+
+  forest_from = forest->set_from;
+  t8_global_productionf ("Into t8_forest_adapt from %lld total elements\n",
+                         (long long) forest_from->global_num_elements);
+
+  T8_ASSERT (forest_from->incomplete_trees != -1);
+  T8_ASSERT (forest->incomplete_trees == -1);
+  /* TODO: Allocate memory for the trees of forest.
+   * Will we do this here or in an extra function? */
+  T8_ASSERT (forest->trees->elem_count == forest_from->trees->elem_count);
+
+  /* In the memory lean adaptation mode we free the leaf storage of each
+   * source tree right after it was adapted, so that the peak memory stays
+   * close to the size of one forest plus a single tree instead of holding
+   * the old and the new leafs side by side. This is only possible if we
+   * hold the only reference to forest_from, which is then destroyed at the
+   * end of the commit anyway. */
+  recycle = forest->set_adapt_recycle && forest_from->rc.refcount == 1;
+
+  num_trees = t8_forest_get_num_local_trees (forest);
+  if (forest->set_adapt_prune_fn != NULL) {
+    SC_CHECK_ABORT (!forest->set_adapt_recursive,
+                    "Adapt pruning is only supported for non-recursive adaptation.\n");
+  }
+  if (forest->set_adapt_regions != NULL) {
+    SC_CHECK_ABORT (!forest->set_adapt_recursive,
+                    "Adapt regions are only supported for non-recursive adaptation.\n");
+    SC_CHECK_ABORT (forest->set_adapt_batched_fn == NULL,
+                    "Adapt regions cannot be combined with the batched adapt callback.\n");
+  }
+  if (forest->set_adapt_journal) {
+    SC_CHECK_ABORT (!forest->set_adapt_recursive,
+                    "The adapt journal is only supported for non-recursive adaptation.\n");
+    /* Each tree records into its own journal, so the recording also works
+     * in the threaded tree loop. The per tree journals are concatenated in
+     * tree order after the loop. */
+    tree_journals = T8_ALLOC (sc_array_t *, num_trees);
+    for (ltree_id = 0; ltree_id < num_trees; ltree_id++) {
+      tree_journals[ltree_id] =
+        sc_array_new (sizeof (t8_forest_adapt_journal_entry_t));
+    }
+  }
+  /* The number of elements each adapted tree received. The element offsets
+   * are computed from these counts in a prefix pass after the tree loop,
+   * so the per-tree work stays independent. */
+  el_inserted_per_tree = T8_ALLOC_ZERO (t8_locidx_t, num_trees);
+
+#if T8_ENABLE_OPENMP
+  if (forest->adapt_num_threads > 1 && !forest->set_adapt_recursive
+      && !forest_from->incomplete_trees && forest_from->speculation == NULL) {
+    /* Adapt the trees concurrently. Each tree only touches its own element
+     * array, so the trees can be dispatched to worker threads. The threaded
+     * mode is opt-in via t8_forest_set_adapt_threads, since the adapt
+     * callback is invoked concurrently and thus must be thread-safe.
+     * We restrict it to non-recursive adaptation, since recursive
+     * refinement and coarsening allocate elements from the shared scheme
+     * mempools, which are not thread-safe. Forests with incomplete trees
+     * are excluded for the same reason: their family detection goes
+     * through t8_forest_is_incomplete_family, which allocates a parent
+     * element from the shared mempools for every family candidate.
+     * Forests with speculative refinement data are excluded as well:
+     * t8_forest_speculation_consume advances a forward-only cursor over
+     * the speculation entries and frees consumed child data without any
+     * synchronization, which is incompatible with the trees being
+     * processed concurrently and out of order.
+     * Dynamic scheduling balances trees of different sizes over the
+     * threads. The thread count is clamped to the process-wide limit of
+     * t8_thread_pool_set_num_threads. */
+    const int           adapt_num_threads =
+      t8_thread_pool_clamp_num_threads (forest->adapt_num_threads);
+    int                 element_removed_thread = 0;
+#pragma omp parallel num_threads (adapt_num_threads) \
+  reduction (max:element_removed_thread)
+    {
+#pragma omp for schedule (dynamic)
+      for (ltree_id = 0; ltree_id < num_trees; ltree_id++) {
+        el_inserted_per_tree[ltree_id] =
+          t8_forest_adapt_tree (forest, forest_from, ltree_id, NULL,
+                                tree_journals == NULL ? NULL :
+                                tree_journals[ltree_id],
+                                &element_removed_thread);
+        if (recycle) {
+          /* Each thread only frees the storage of its own trees. */
+          t8_element_array_reset (&t8_forest_get_tree (forest_from,
+                                                       ltree_id)->elements);
+        }
+      }
+    }
+    element_removed = element_removed_thread;
+  }
+  else
+#endif
+  {
+    if (forest->set_adapt_recursive) {
+      refine_list = sc_list_new (NULL);
+    }
+    /* Iterate over the trees and build the new element arrays for each one.
+     * With profiling enabled, each tree is timed as one region visit, so
+     * the visit count and longest visit of "adapt/tree" expose load
+     * imbalance between the trees. The threaded loop above is not
+     * instrumented since the region profiler is not thread-safe. */
+    for (ltree_id = 0; ltree_id < num_trees; ltree_id++) {
+      t8_region_profile_enter (region_profile, "adapt/tree");
+      el_inserted_per_tree[ltree_id] =
+        t8_forest_adapt_tree (forest, forest_from, ltree_id, refine_list,
+                              tree_journals == NULL ? NULL :
+                              tree_journals[ltree_id], &element_removed);
+      if (recycle) {
+        t8_element_array_reset (&t8_forest_get_tree (forest_from,
+                                                     ltree_id)->elements);
+      }
+      t8_region_profile_leave (region_profile, "adapt/tree");
+    }
+    if (forest->set_adapt_recursive) {
+      /* clean up */
+      sc_list_destroy (refine_list);
+    }
+  }
+
+  if (tree_journals != NULL) {
+    /* Concatenate the per tree journals into the journal of the forest. */
+    T8_ASSERT (forest->adapt_journal == NULL);
+    forest->adapt_journal =
+      sc_array_new (sizeof (t8_forest_adapt_journal_entry_t));
+    for (ltree_id = 0; ltree_id < num_trees; ltree_id++) {
+      sc_array_t         *tree_journal = tree_journals[ltree_id];
+      if (tree_journal->elem_count > 0) {
+        memcpy (sc_array_push_count (forest->adapt_journal,
+                                     tree_journal->elem_count),
+                tree_journal->array,
+                tree_journal->elem_count * tree_journal->elem_size);
+      }
+      sc_array_destroy (tree_journal);
+    }
+    T8_FREE (tree_journals);
+  }
+
+  /* Set the element offsets of the trees and count the local elements. */
+  el_offset = 0;
+  for (ltree_id = 0; ltree_id < num_trees; ltree_id++) {
+    t8_forest_get_tree (forest, ltree_id)->elements_offset = el_offset;
+    el_offset += el_inserted_per_tree[ltree_id];
   }
+  forest->local_num_elements = el_offset;
+  T8_FREE (el_inserted_per_tree);
 
   /* We now adapted all local trees */
   /* Compute the new global number of elements */
@@ -36,6 +36,133 @@ T8_EXTERN_C_BEGIN ();
 /* TODO: comment */
 void                t8_forest_adapt (t8_forest_t forest);
 
+/** The action of one entry of the adapt journal.
+ * The values match the refine codes of the adapt callback and of
+ * \ref t8_forest_replace_t. */
+typedef enum t8_forest_adapt_action
+{
+  T8_FOREST_ADAPT_KEPT = 0,     /**< A run of elements was kept unchanged. */
+  T8_FOREST_ADAPT_REFINED = 1,  /**< One element was refined into its children. */
+  T8_FOREST_ADAPT_COARSENED = -1, /**< A family of elements was coarsened into its parent. */
+  T8_FOREST_ADAPT_REMOVED = -2  /**< A run of elements was removed. */
+} t8_forest_adapt_action_t;
+
+/** One run of the adapt journal. The entries of the journal describe the
+ * adaptation tree by tree in the order of the elements, so walking the
+ * journal while advancing one position counter in the old and one in the
+ * new forest reproduces the element matching of
+ * \ref t8_forest_iterate_replace without any element comparisons. */
+typedef struct t8_forest_adapt_journal_entry
+{
+  t8_locidx_t         ltreeid;  /**< The local tree the run belongs to. */
+  t8_forest_adapt_action_t action;      /**< The action applied to the run. */
+  t8_locidx_t         count;    /**< For \ref T8_FOREST_ADAPT_KEPT and
+                                     \ref T8_FOREST_ADAPT_REMOVED the number of
+                                     consecutive old elements of the run.
+                                     For \ref T8_FOREST_ADAPT_REFINED the number
+                                     of children the old element was refined
+                                     into. For \ref T8_FOREST_ADAPT_COARSENED
+                                     the number of old elements that were
+                                     coarsened into one parent. */
+} t8_forest_adapt_journal_entry_t;
+
+/** Enable or disable the recording of the adapt journal of a forest.
+ * If enabled, \ref t8_forest_adapt records one
+ * \ref t8_forest_adapt_journal_entry_t per refined element, coarsened
+ * family and run of kept or removed elements, retrievable from the
+ * committed forest with \ref t8_forest_get_adapt_journal. Solution
+ * transfer and similar consumers can then replay the adapt pattern
+ * without traversing and comparing both forests again.
+ * The journal is only recorded for non-recursive adaptation and only if
+ * the forest is not also partitioned or balanced in the same commit.
+ * \param [in,out] forest  The forest, must be initialized and not committed.
+ * \param [in]     record  If true, record the journal during adaptation.
+ */
+void                t8_forest_set_adapt_journal (t8_forest_t forest,
+                                                 int record);
+
+/** Return the adapt journal of a committed forest.
+ * \param [in] forest   A committed forest.
+ * \return              An array of \ref t8_forest_adapt_journal_entry_t
+ *                      describing the adaptation that built \a forest, or
+ *                      NULL if no journal was recorded. The array belongs
+ *                      to \a forest and is valid until the forest is
+ *                      destroyed.
+ * \see t8_forest_set_adapt_journal
+ */
+sc_array_t         *t8_forest_get_adapt_journal (t8_forest_t forest);
+
+/** One run of a forest delta, \see t8_forest_delta_extract.
+ * A run describes a range of \a count consecutive elements together with
+ * the positions of the two cursors that walk the old and the new forest
+ * while the delta is replayed. Which of the two ranges carries the
+ * elements of the run depends on the array the run is stored in. */
+typedef struct t8_forest_delta_run
+{
+  t8_locidx_t         old_start;        /**< The old forest cursor at the run. */
+  t8_locidx_t         new_start;        /**< The new forest cursor at the run. */
+  t8_locidx_t         count;    /**< The number of elements of the run. */
+} t8_forest_delta_run_t;
+
+/** The element granular difference between a forest and the forest it was
+ * adapted from, \see t8_forest_delta_extract. All runs are ordered by
+ * element index and the three arrays interleave consistently, so a
+ * consumer can either walk one array in isolation (for example only the
+ * added cells) or merge all three into one pass over both forests. */
+typedef struct t8_forest_delta
+{
+  unsigned            old_generation;   /**< The generation of the old forest. */
+  unsigned            new_generation;   /**< The generation of the new forest. */
+  sc_array_t          kept;     /**< Runs of \ref t8_forest_delta_run_t for
+                                     elements that exist unchanged in both
+                                     forests. Old range [old_start, old_start +
+                                     count) maps to new range [new_start,
+                                     new_start + count); a cell that only moved
+                                     can be updated in place by the copy of its
+                                     payload. */
+  sc_array_t          added;    /**< Runs for elements that exist only in the
+                                     new forest (children of refined elements
+                                     and parents of coarsened families). The
+                                     new range carries the elements; old_start
+                                     is the position of the source elements in
+                                     the old forest. */
+  sc_array_t          removed;  /**< Runs for elements that exist only in the
+                                     old forest (refined elements, coarsened
+                                     families and removed runs). The old range
+                                     carries the elements; new_start is the
+                                     position the new forest cursor had when
+                                     the run was consumed. */
+} t8_forest_delta_t;
+
+/** Extract the element granular difference of a committed forest against a
+ * subscriber's last seen generation. In-situ visualization pipelines can
+ * replay the returned runs to update their extracted grid incrementally
+ * instead of re-extracting every cell, \see t8_forest_to_vtkUnstructured.
+ * The delta is only available if \a last_seen_generation is the
+ * generation of \a forest itself (the delta is empty) or of the forest
+ * \a forest was adapted from in a commit that recorded the adapt journal,
+ * \see t8_forest_set_adapt_journal. In every other case (several steps
+ * behind, no journal, adaptation fused with partition or balance) the
+ * subscriber must fall back to a full re-extraction.
+ * \param [in]  forest          A committed forest.
+ * \param [in]  last_seen_generation The generation the subscriber last
+ *                              extracted, \see t8_forest_get_generation.
+ * \param [out] pdelta          On success filled with a newly allocated
+ *                              delta, to be released with
+ *                              \ref t8_forest_delta_destroy.
+ * \return                      True if the delta could be extracted, false
+ *                              if the subscriber must re-extract fully.
+ */
+int                 t8_forest_delta_extract (t8_forest_t forest,
+                                             unsigned last_seen_generation,
+                                             t8_forest_delta_t **pdelta);
+
+/** Free a forest delta obtained from \ref t8_forest_delta_extract and set
+ * the pointer to NULL.
+ * \param [in,out] pdelta   Pointer to a delta; may point to NULL.
+ */
+void                t8_forest_delta_destroy (t8_forest_delta_t **pdelta);
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_FOREST_ADAPT_H! */
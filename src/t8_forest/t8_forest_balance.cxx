@@ -26,7 +26,9 @@
 #include <t8_forest/t8_forest_private.h>
 #include <t8_forest/t8_forest_ghost.h>
 #include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_iterate.h>
 #include <t8_forest/t8_forest_profiling.h>
+#include <t8_data/t8_containers.h>
 #include <t8_element_cxx.hxx>
 
 /* We want to export the whole implementation to be callable from "C" */
@@ -141,7 +143,7 @@ t8_forest_compute_max_element_level (t8_forest_t forest)
 }
 
 void
-t8_forest_balance (t8_forest_t forest, int repartition)
+t8_forest_balance_iterated (t8_forest_t forest, int repartition)
 {
   t8_forest_t         forest_temp, forest_from, forest_partition;
   int                 done = 0, done_global = 0;
@@ -160,6 +162,10 @@ t8_forest_balance (t8_forest_t forest, int repartition)
      (long long) t8_forest_get_global_num_elements (forest->set_from));
   t8_log_indent_push ();
 
+  /* A registered data transfer callback relies on the local element
+   * correspondence between the rounds, which repartitioning would break. */
+  T8_ASSERT (forest->balance_replace_fn == NULL || !repartition);
+
   /* Set default value to prevent compiler warning */
   adap_stats = ghost_stats = partition_stats = NULL;
 
@@ -211,9 +217,24 @@ t8_forest_balance (t8_forest_t forest, int repartition)
     if (forest->profile != NULL) {
       t8_forest_set_profiling (forest_temp, 1);
     }
+    if (forest->balance_replace_fn != NULL) {
+      /* Make the application context available to the transfer callback
+       * and keep the source forest of this round alive until the element
+       * data has been carried over. */
+      t8_forest_set_user_data (forest_temp,
+                               t8_forest_get_user_data (forest));
+      t8_forest_ref (forest_from);
+    }
     t8_global_productionf ("Profiling: %i\n", forest->profile != NULL);
     /* Adapt the forest */
     t8_forest_commit (forest_temp);
+    if (forest->balance_replace_fn != NULL) {
+      /* Carry the element data over this round's one-level refinements
+       * while the correspondence to forest_from is still known. */
+      t8_forest_iterate_replace (forest_temp, forest_from,
+                                 forest->balance_replace_fn);
+      t8_forest_unref (&forest_from);
+    }
     /* Store the runtimes of adapt and ghost */
     if (forest->profile != NULL) {
       if (count_rounds > num_stats_allocated - 2) {
@@ -345,6 +366,13 @@ t8_forest_balance (t8_forest_t forest, int repartition)
   }
 }
 
+void
+t8_forest_balance (t8_forest_t forest, int repartition)
+{
+  /* The iterated algorithm produces the minimal graded balance. */
+  t8_forest_balance_iterated (forest, repartition);
+}
+
 /* Check whether the local elements of a forest are balanced. */
 int
 t8_forest_is_balanced (t8_forest_t forest)
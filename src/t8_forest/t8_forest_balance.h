@@ -35,10 +35,28 @@
 
 T8_EXTERN_C_BEGIN ();
 
-/* TODO: document
- * only temporary and will be replaced in future */
+/** Establish a 2:1 balance in \a forest->set_from and store the balanced
+ * forest in \a forest. This is the default algorithm used by
+ * \ref t8_forest_set_balance; it forwards to
+ * \ref t8_forest_balance_iterated.
+ * \param [in,out] forest      The forest under construction. Its \a set_from
+ *                             member must be a committed forest.
+ * \param [in]     repartition If true, the balanced forest is repartitioned.
+ */
 void                t8_forest_balance (t8_forest_t forest, int repartition);
 
+/** Balance algorithm that repeatedly adapts the forest with
+ * \a t8_forest_balance_adapt and rebuilds the ghost layer each round until
+ * no element changes anymore. It produces the minimal graded balance and
+ * is the algorithm \ref t8_forest_balance uses.
+ * \param [in,out] forest      The forest under construction. Its \a set_from
+ *                             member must be a committed forest.
+ * \param [in]     repartition If true, the forest is repartitioned in between
+ *                             the balance rounds.
+ */
+void                t8_forest_balance_iterated (t8_forest_t forest,
+                                                int repartition);
+
 /* Check whether the local elements of a forest are balanced. */
 int                 t8_forest_is_balanced (t8_forest_t forest);
 
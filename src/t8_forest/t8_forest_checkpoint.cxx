@@ -0,0 +1,1427 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/* In this file we implement binary checkpoint and restart of a forest,
+ * see the documentation of t8_forest_write_checkpoint and
+ * t8_forest_load_checkpoint in t8_forest_io.h for the file layout.
+ * The file stores one fixed size record per leaf element, so every
+ * section of the file can be addressed by seeking and a restart run may
+ * use a different number of processes than the run that wrote the file.
+ */
+
+#include <t8_cmesh.h>
+#include <t8_element_cxx.hxx>
+#include <t8_data/t8_containers.h>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_io.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_forest/t8_forest_partition.h>
+#ifdef T8_HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+/* The first bytes of a checkpoint file. */
+#define T8_FOREST_CHECKPOINT_MAGIC "t8forchk"
+/* The version of the checkpoint file layout. */
+#define T8_FOREST_CHECKPOINT_FORMAT 0x0001
+/* MPI I/O write counts are ints, thus a single collective write is
+ * limited to 2 GB and we split larger payloads into chunks. */
+#define T8_FOREST_CHECKPOINT_CHUNK_BYTES (1 << 30)
+
+/* The first bytes of a raw leaf file. */
+#define T8_FOREST_LEAVES_MAGIC "t8leaves"
+/* The version of the raw leaf file layout. */
+#define T8_FOREST_LEAVES_FORMAT 0x0001
+/* The version of the raw leaf file layout with a native element payload
+ * instead of records, see t8_forest_write_leaves_mapped. */
+#define T8_FOREST_LEAVES_MAPPED_FORMAT 0x0002
+
+/* The fixed size file header. It is followed by the tree offset and
+ * element offset arrays of the writing partition (num_ranks + 1 entries
+ * of type t8_gloidx_t each), the element records and the user data. */
+typedef struct t8_forest_checkpoint_header
+{
+  char                magic[8]; /* T8_FOREST_CHECKPOINT_MAGIC, not NUL terminated */
+  int32_t             format;   /* T8_FOREST_CHECKPOINT_FORMAT */
+  int32_t             num_ranks;        /* number of processes that wrote the file */
+  int32_t             dimension;        /* dimension of the forest */
+  int32_t             record_bytes;     /* sizeof (t8_forest_checkpoint_record_t) */
+  int64_t             global_num_trees; /* global number of trees */
+  int64_t             global_num_elements;      /* global number of elements */
+  int64_t             data_size;        /* user data bytes per element */
+} t8_forest_checkpoint_header_t;
+
+/* One record per leaf element. The records are stored in the order of
+ * the global element index, thus sorted by the global tree id.
+ * The in-memory record type of t8_forest_private.h doubles as the file
+ * format; its size is recorded in the header for compatibility checks. */
+typedef t8_forest_leaf_record_t t8_forest_checkpoint_record_t;
+
+/* A contiguous section of the checkpoint file to which each process
+ * contributes one consecutive slice of bytes. */
+typedef struct t8_forest_checkpoint_block
+{
+  const char         *local_bytes;      /* this process' payload */
+  long long           local_byte_count; /* number of payload bytes */
+  long long           local_byte_offset;        /* offset of the payload inside the block */
+  long long           block_start;      /* file offset where the block starts */
+} t8_forest_checkpoint_block_t;
+
+#ifdef T8_ENABLE_MPIIO
+/* Write the checkpoint file with collective MPI-IO. All processes call
+ * the same sequence of collective writes; for the meta section (header
+ * and offset arrays) only process 0 contributes bytes. */
+static int
+t8_forest_checkpoint_write_mpiio (sc_MPI_Comm comm, int mpirank,
+                                  const char *filename, const char *meta,
+                                  const long long meta_bytes,
+                                  t8_forest_checkpoint_block_t *blocks,
+                                  const int num_blocks,
+                                  const long long total_bytes)
+{
+  MPI_File            fh;
+  MPI_Status          status;
+  int                 mpiret, iblock, ichunk, num_chunks;
+  long long           max_local_bytes = 0;
+  size_t              written;
+
+  mpiret = MPI_File_open (comm, (char *) filename,
+                          MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL,
+                          &fh);
+  if (mpiret != sc_MPI_SUCCESS) {
+    t8_errorf ("Error when opening file %s for MPI-IO\n", filename);
+    return 0;
+  }
+  /* Truncate any leftover content from a previous file */
+  mpiret = MPI_File_set_size (fh, (MPI_Offset) total_bytes);
+  SC_CHECK_MPI (mpiret);
+
+  /* Write the header and the offset arrays */
+  mpiret = MPI_File_write_at_all (fh, 0, (void *) meta,
+                                  mpirank == 0 ? (int) meta_bytes : 0,
+                                  MPI_BYTE, &status);
+  SC_CHECK_MPI (mpiret);
+
+  /* The number of chunks must be equal on all processes for the writes
+   * to stay collective, so we use the maximum local payload size. */
+  for (iblock = 0; iblock < num_blocks; iblock++) {
+    max_local_bytes = SC_MAX (max_local_bytes,
+                              blocks[iblock].local_byte_count);
+  }
+  mpiret = sc_MPI_Allreduce (sc_MPI_IN_PLACE, &max_local_bytes, 1,
+                             sc_MPI_LONG_LONG_INT, sc_MPI_MAX, comm);
+  SC_CHECK_MPI (mpiret);
+  num_chunks = (int) ((max_local_bytes + T8_FOREST_CHECKPOINT_CHUNK_BYTES - 1)
+                      / T8_FOREST_CHECKPOINT_CHUNK_BYTES);
+
+  for (iblock = 0; iblock < num_blocks; iblock++) {
+    const t8_forest_checkpoint_block_t *block = blocks + iblock;
+
+    for (ichunk = 0, written = 0; ichunk < num_chunks; ichunk++) {
+      const size_t        chunk_bytes =
+        SC_MIN ((size_t) T8_FOREST_CHECKPOINT_CHUNK_BYTES,
+                (size_t) block->local_byte_count - written);
+      mpiret = MPI_File_write_at_all (fh, (MPI_Offset) (block->block_start
+                                                        +
+                                                        block->local_byte_offset
+                                                        + (long long) written),
+                                      (void *) (block->local_bytes + written),
+                                      (int) chunk_bytes, MPI_BYTE, &status);
+      SC_CHECK_MPI (mpiret);
+      written += chunk_bytes;
+    }
+  }
+  mpiret = MPI_File_close (&fh);
+  SC_CHECK_MPI (mpiret);
+  return 1;
+}
+#else
+/* Write the checkpoint file without MPI-IO. The processes write to the
+ * shared file one after another, serialized by a token passed along the
+ * ranks. The offsets are precomputed, so each process seeks to its
+ * slice of every block and writes it with stdio. */
+static int
+t8_forest_checkpoint_write_serial (sc_MPI_Comm comm, int mpirank,
+                                   int mpisize, const char *filename,
+                                   const char *meta,
+                                   const long long meta_bytes,
+                                   t8_forest_checkpoint_block_t *blocks,
+                                   const int num_blocks)
+{
+  FILE               *file;
+  int                 mpiret, iblock, token = 0;
+  int                 retval = 1;
+
+  if (mpirank > 0) {
+    /* Wait until the previous process is done writing */
+    mpiret = sc_MPI_Recv (&token, 1, sc_MPI_INT, mpirank - 1, 0, comm,
+                          sc_MPI_STATUS_IGNORE);
+    SC_CHECK_MPI (mpiret);
+  }
+  file = fopen (filename, mpirank == 0 ? "wb" : "r+b");
+  if (file == NULL) {
+    t8_errorf ("Error when opening file %s\n", filename);
+    retval = 0;
+  }
+  else {
+    if (mpirank == 0) {
+      /* Process 0 writes the header and the offset arrays */
+      if ((long long) fwrite (meta, 1, meta_bytes, file) != meta_bytes) {
+        t8_errorf ("Error when writing to file %s\n", filename);
+        retval = 0;
+      }
+    }
+    for (iblock = 0; retval && iblock < num_blocks; iblock++) {
+      const t8_forest_checkpoint_block_t *block = blocks + iblock;
+
+      fseek (file, block->block_start + block->local_byte_offset, SEEK_SET);
+      if ((long long) fwrite (block->local_bytes, 1, block->local_byte_count,
+                              file) != block->local_byte_count) {
+        t8_errorf ("Error when writing to file %s\n", filename);
+        retval = 0;
+      }
+    }
+    if (fclose (file) != 0) {
+      t8_errorf ("Error when closing file %s\n", filename);
+      retval = 0;
+    }
+  }
+  if (mpirank < mpisize - 1) {
+    /* Pass the token to the next process. This must also happen when an
+     * error occurred above, since the next process blocks in sc_MPI_Recv
+     * until it receives the token; the error itself is reported through
+     * the return value of the failing process. */
+    mpiret = sc_MPI_Send (&token, 1, sc_MPI_INT, mpirank + 1, 0, comm);
+    SC_CHECK_MPI (mpiret);
+  }
+  return retval;
+}
+#endif
+
+int
+t8_forest_write_checkpoint (t8_forest_t forest, const char *filename,
+                            const void *data, size_t data_size)
+{
+  t8_forest_checkpoint_header_t header;
+  t8_forest_checkpoint_record_t *records;
+  t8_forest_checkpoint_block_t blocks[2];
+  t8_tree_t           tree;
+  t8_eclass_scheme_c *eclass_scheme;
+  t8_element_t       *element;
+  t8_gloidx_t         element_offset;
+  t8_locidx_t         num_local_trees, itree, ielem, iel;
+  char               *meta;
+  long long           meta_bytes, offset_bytes, total_bytes;
+  int                 level, retval;
+
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (filename != NULL);
+  T8_ASSERT (data != NULL || data_size == 0);
+
+  /* Fill the file header. All entries are the same on each process. */
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, T8_FOREST_CHECKPOINT_MAGIC, sizeof (header.magic));
+  header.format = T8_FOREST_CHECKPOINT_FORMAT;
+  header.num_ranks = forest->mpisize;
+  header.dimension = forest->dimension;
+  header.record_bytes = (int32_t) sizeof (t8_forest_checkpoint_record_t);
+  header.global_num_trees = (int64_t) forest->global_num_trees;
+  header.global_num_elements = (int64_t) forest->global_num_elements;
+  header.data_size = (int64_t) data_size;
+
+  /* Assemble the meta section from the header and the tree and element
+   * offset arrays of the current partition. Both shared memory arrays
+   * exist on a committed forest. */
+  offset_bytes = (forest->mpisize + 1) * sizeof (t8_gloidx_t);
+  meta_bytes = (long long) sizeof (header) + 2 * offset_bytes;
+  meta = T8_ALLOC (char, meta_bytes);
+  memcpy (meta, &header, sizeof (header));
+  memcpy (meta + sizeof (header),
+          t8_shmem_array_get_gloidx_array (forest->tree_offsets),
+          offset_bytes);
+  memcpy (meta + sizeof (header) + offset_bytes,
+          t8_shmem_array_get_gloidx_array (forest->element_offsets),
+          offset_bytes);
+
+  /* Fill one record per local leaf element */
+  records = T8_ALLOC (t8_forest_checkpoint_record_t,
+                      forest->local_num_elements);
+  num_local_trees = (t8_locidx_t) forest->trees->elem_count;
+  for (itree = 0, iel = 0; itree < num_local_trees; itree++) {
+    tree = (t8_tree_t) t8_sc_array_index_locidx (forest->trees, itree);
+    eclass_scheme = forest->scheme_cxx->eclass_schemes[tree->eclass];
+    for (ielem = 0;
+         ielem < (t8_locidx_t) t8_element_array_get_count (&tree->elements);
+         ielem++, iel++) {
+      element = t8_element_array_index_locidx (&tree->elements, ielem);
+      level = eclass_scheme->t8_element_level (element);
+      records[iel].gtree = forest->first_local_tree + itree;
+      records[iel].linear_id =
+        eclass_scheme->t8_element_get_linear_id (element, level);
+      records[iel].level = (int32_t) level;
+      records[iel].pad = 0;
+    }
+  }
+  T8_ASSERT (iel == forest->local_num_elements);
+
+  /* The global element offset of this process positions its slices */
+  element_offset = t8_shmem_array_get_gloidx (forest->element_offsets,
+                                              forest->mpirank);
+
+  /* The element records */
+  blocks[0].local_bytes = (const char *) records;
+  blocks[0].local_byte_count = (long long) forest->local_num_elements
+    * sizeof (t8_forest_checkpoint_record_t);
+  blocks[0].local_byte_offset = (long long) element_offset
+    * sizeof (t8_forest_checkpoint_record_t);
+  blocks[0].block_start = meta_bytes;
+  /* The user data */
+  blocks[1].local_bytes = (const char *) data;
+  blocks[1].local_byte_count = (long long) forest->local_num_elements
+    * data_size;
+  blocks[1].local_byte_offset = (long long) element_offset * data_size;
+  blocks[1].block_start = meta_bytes
+    + (long long) forest->global_num_elements
+    * sizeof (t8_forest_checkpoint_record_t);
+  total_bytes = blocks[1].block_start
+    + (long long) forest->global_num_elements * data_size;
+
+#ifdef T8_ENABLE_MPIIO
+  retval = t8_forest_checkpoint_write_mpiio (forest->mpicomm,
+                                             forest->mpirank, filename, meta,
+                                             meta_bytes, blocks, 2,
+                                             total_bytes);
+#else
+  retval = t8_forest_checkpoint_write_serial (forest->mpicomm,
+                                              forest->mpirank,
+                                              forest->mpisize, filename,
+                                              meta, meta_bytes, blocks, 2);
+#endif
+  T8_FREE (records);
+  T8_FREE (meta);
+  return retval;
+}
+
+/* Read this process' part of a checkpoint file: the header, the element
+ * records of the local slice and optionally the user data.
+ * On success *num_local_elements_out is the local element count,
+ * *records_out the local records and *prev_record/*next_record are valid
+ * if *has_prev_record/*has_next_record are set. They are needed to
+ * decide whether the first local tree is shared with a smaller process
+ * and on which tree an empty process is located.
+ * Returns true on success. This function is process local; the caller
+ * combines the return values of all processes. */
+static int
+t8_forest_checkpoint_read_local (const char *filename, int mpirank,
+                                 int mpisize, size_t data_size,
+                                 void **data,
+                                 t8_forest_checkpoint_header_t *header,
+                                 t8_forest_checkpoint_record_t **records_out,
+                                 t8_gloidx_t *first_element,
+                                 t8_locidx_t *num_local_elements_out,
+                                 t8_forest_checkpoint_record_t *prev_record,
+                                 int *has_prev_record,
+                                 t8_forest_checkpoint_record_t *next_record,
+                                 int *has_next_record)
+{
+  FILE               *file;
+  t8_forest_checkpoint_record_t *records = NULL;
+  t8_gloidx_t         first, end;
+  long long           offset_bytes, records_start, data_start;
+  size_t              num_read;
+
+  *records_out = NULL;
+  *has_prev_record = *has_next_record = 0;
+
+  file = fopen (filename, "rb");
+  if (file == NULL) {
+    t8_errorf ("Error when opening file %s\n", filename);
+    return 0;
+  }
+  /* Read and check the file header */
+  if (fread (header, sizeof (*header), 1, file) != 1
+      || memcmp (header->magic, T8_FOREST_CHECKPOINT_MAGIC,
+                 sizeof (header->magic))
+      || header->format != T8_FOREST_CHECKPOINT_FORMAT) {
+    t8_errorf ("File %s is not a t8code checkpoint file\n", filename);
+    fclose (file);
+    return 0;
+  }
+  if (header->record_bytes
+      != (int32_t) sizeof (t8_forest_checkpoint_record_t)) {
+    t8_errorf ("File %s was written with an incompatible record layout\n",
+               filename);
+    fclose (file);
+    return 0;
+  }
+  if (data != NULL && header->data_size != (int64_t) data_size) {
+    t8_errorf ("File %s stores %lli data bytes per element, expected %lli\n",
+               filename, (long long) header->data_size,
+               (long long) data_size);
+    fclose (file);
+    return 0;
+  }
+  offset_bytes = (header->num_ranks + 1) * sizeof (t8_gloidx_t);
+  records_start = (long long) sizeof (*header) + 2 * offset_bytes;
+  data_start = records_start + (long long) header->global_num_elements
+    * sizeof (t8_forest_checkpoint_record_t);
+
+  if (mpisize == header->num_ranks) {
+    /* The process counts match, restore the stored partition */
+    t8_gloidx_t         stored_offsets[2];
+
+    fseek (file, sizeof (*header) + offset_bytes
+           + mpirank * (long long) sizeof (t8_gloidx_t), SEEK_SET);
+    if (fread (stored_offsets, sizeof (t8_gloidx_t), 2, file) != 2) {
+      t8_errorf ("Error when reading the element offsets from file %s\n",
+                 filename);
+      fclose (file);
+      return 0;
+    }
+    first = stored_offsets[0];
+    end = stored_offsets[1];
+  }
+  else {
+    /* Split the global number of elements uniformly */
+    first = ((t8_gloidx_t) header->global_num_elements * mpirank) / mpisize;
+    end = ((t8_gloidx_t) header->global_num_elements * (mpirank + 1))
+      / mpisize;
+  }
+  T8_ASSERT (0 <= first && first <= end
+             && end <= (t8_gloidx_t) header->global_num_elements);
+
+  /* Read the local element records */
+  records = T8_ALLOC (t8_forest_checkpoint_record_t, end - first);
+  fseek (file, records_start
+         + first * (long long) sizeof (t8_forest_checkpoint_record_t),
+         SEEK_SET);
+  num_read = fread (records, sizeof (t8_forest_checkpoint_record_t),
+                    end - first, file);
+  if (num_read != (size_t) (end - first)) {
+    t8_errorf ("Error when reading the element records from file %s\n",
+               filename);
+    fclose (file);
+    T8_FREE (records);
+    return 0;
+  }
+  if (first > 0 && end > first) {
+    /* Read the last record of the previous process to detect whether
+     * our first tree is shared with it */
+    fseek (file, records_start
+           + (first - 1) * (long long) sizeof (t8_forest_checkpoint_record_t),
+           SEEK_SET);
+    if (fread (prev_record, sizeof (t8_forest_checkpoint_record_t), 1, file)
+        != 1) {
+      t8_errorf ("Error when reading the element records from file %s\n",
+                 filename);
+      fclose (file);
+      T8_FREE (records);
+      return 0;
+    }
+    *has_prev_record = 1;
+  }
+  if (end == first && first < (t8_gloidx_t) header->global_num_elements) {
+    /* This process is empty. Read the first record of the next process
+     * with elements to learn the tree this process is located on. */
+    fseek (file, records_start
+           + first * (long long) sizeof (t8_forest_checkpoint_record_t),
+           SEEK_SET);
+    if (fread (next_record, sizeof (t8_forest_checkpoint_record_t), 1, file)
+        != 1) {
+      t8_errorf ("Error when reading the element records from file %s\n",
+                 filename);
+      fclose (file);
+      T8_FREE (records);
+      return 0;
+    }
+    *has_next_record = 1;
+  }
+
+  /* Read the local slice of the user data */
+  if (data != NULL) {
+    *data = T8_ALLOC (char, (end - first) * data_size);
+    fseek (file, data_start + first * (long long) data_size, SEEK_SET);
+    if (fread (*data, 1, (end - first) * data_size, file)
+        != (size_t) (end - first) * data_size) {
+      t8_errorf ("Error when reading the user data from file %s\n",
+                 filename);
+      fclose (file);
+      T8_FREE (records);
+      T8_FREE (*data);
+      *data = NULL;
+      return 0;
+    }
+  }
+  fclose (file);
+
+  *records_out = records;
+  *first_element = first;
+  *num_local_elements_out = (t8_locidx_t) (end - first);
+  return 1;
+}
+
+t8_forest_t
+t8_forest_build_from_records (t8_cmesh_t cmesh, t8_scheme_cxx_t *scheme,
+                              sc_MPI_Comm comm,
+                              const t8_forest_leaf_record_t *records,
+                              t8_locidx_t num_local_elements,
+                              t8_gloidx_t global_num_elements,
+                              const t8_forest_leaf_record_t *prev_record,
+                              const t8_forest_leaf_record_t *next_record)
+{
+  t8_forest_t         forest;
+  t8_cmesh_t          cmesh_part;
+  t8_tree_t           tree;
+  t8_eclass_scheme_c *eclass_scheme;
+  t8_element_t       *element;
+  t8_gloidx_t         first_tree, last_tree, jt, first_ctree;
+  t8_locidx_t         num_tree_elements, iel, et;
+  int                 mpiret;
+
+  T8_ASSERT (cmesh != NULL);
+  T8_ASSERT (t8_cmesh_is_committed (cmesh));
+  T8_ASSERT (scheme != NULL);
+  T8_ASSERT (records != NULL || num_local_elements == 0);
+
+  /* Determine the local tree range and derive a matching partition of
+   * the cmesh. A first tree that is shared with a smaller process is
+   * passed with the negative encoding of t8_cmesh_set_partition_range. */
+  if (num_local_elements > 0) {
+    first_tree = records[0].gtree;
+    last_tree = records[num_local_elements - 1].gtree;
+  }
+  else {
+    /* An empty process lives between the trees of its neighbors; we
+     * place it on the first tree of the next process with elements. */
+    first_tree = next_record != NULL ? next_record->gtree
+      : t8_cmesh_get_num_trees (cmesh);
+    last_tree = first_tree - 1;
+  }
+  t8_cmesh_init (&cmesh_part);
+  t8_cmesh_set_derive (cmesh_part, cmesh);
+  t8_cmesh_set_partition_range (cmesh_part, 3,
+                                (prev_record != NULL
+                                 && prev_record->gtree == first_tree)
+                                ? -first_tree - 1 : first_tree, last_tree);
+  t8_cmesh_commit (cmesh_part, comm);
+
+  /* Build the forest on the derived cmesh. We follow the commit path of
+   * a forest that is constructed solely from its cmesh, but create the
+   * elements from the given records instead of a uniform refinement. */
+  t8_forest_init (&forest);
+  t8_forest_set_cmesh (forest, cmesh_part, comm);
+  t8_forest_set_scheme (forest, scheme);
+  forest->dimension = cmesh_part->dimension;
+  mpiret = sc_MPI_Comm_size (forest->mpicomm, &forest->mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (forest->mpicomm, &forest->mpirank);
+  SC_CHECK_MPI (mpiret);
+  t8_forest_compute_maxlevel (forest);
+
+  if (num_local_elements == 0) {
+    /* This process is empty. As in t8_forest_populate we still create
+     * the tree array and set the first tree larger than the last one. */
+    forest->trees = t8_forest_recycle_trees_new (0);
+    forest->first_local_tree = first_tree;
+    forest->last_local_tree = first_tree - 1;
+  }
+  else {
+    forest->first_local_tree = first_tree;
+    forest->last_local_tree = last_tree;
+    forest->trees = t8_forest_recycle_trees_new (last_tree - first_tree + 1);
+    first_ctree = t8_cmesh_get_first_treeid (forest->cmesh);
+    for (jt = first_tree, iel = 0; jt <= last_tree; jt++) {
+      tree = (t8_tree_t) t8_sc_array_index_locidx (forest->trees,
+                                                   jt - first_tree);
+      tree->eclass = t8_cmesh_get_tree_class (forest->cmesh,
+                                              jt - first_ctree);
+      tree->elements_offset = iel;
+      eclass_scheme = forest->scheme_cxx->eclass_schemes[tree->eclass];
+      T8_ASSERT (eclass_scheme != NULL);
+      /* The records are sorted by tree, count the elements of this tree */
+      for (num_tree_elements = 0;
+           iel + num_tree_elements < num_local_elements
+           && records[iel + num_tree_elements].gtree == jt;
+           num_tree_elements++) {
+      }
+      SC_CHECK_ABORT (num_tree_elements > 0,
+                      "The element records are inconsistent.\n");
+      t8_element_array_init_size (&tree->elements, eclass_scheme,
+                                  num_tree_elements);
+      for (et = 0; et < num_tree_elements; et++, iel++) {
+        T8_ASSERT (0 <= records[iel].level
+                   && records[iel].level <= forest->maxlevel);
+        element = t8_element_array_index_locidx (&tree->elements, et);
+        eclass_scheme->t8_element_set_linear_id (element,
+                                                 (int) records[iel].level,
+                                                 records[iel].linear_id);
+      }
+    }
+    T8_ASSERT (iel == num_local_elements);
+  }
+  forest->local_num_elements = num_local_elements;
+  forest->global_num_elements = global_num_elements;
+  forest->global_num_trees = t8_cmesh_get_num_trees (forest->cmesh);
+  forest->incomplete_trees = 0;
+
+  /* Finalize the forest as t8_forest_commit does after population */
+  t8_forest_compute_elements_offset (forest);
+  t8_forest_compute_desc (forest);
+  forest->set_level = 0;
+  forest->set_from = NULL;
+  forest->committed = 1;
+  t8_forest_partition_create_tree_offsets (forest);
+  t8_forest_partition_create_offsets (forest);
+  t8_forest_partition_create_first_desc (forest);
+  return forest;
+}
+
+t8_forest_t
+t8_forest_load_checkpoint (const char *filename, t8_cmesh_t cmesh,
+                           t8_scheme_cxx_t *scheme, sc_MPI_Comm comm,
+                           size_t data_size, void **data)
+{
+  t8_forest_checkpoint_header_t header;
+  t8_forest_checkpoint_record_t *records;
+  t8_forest_checkpoint_record_t prev_record, next_record;
+  t8_forest_t         forest;
+  t8_gloidx_t         first_element;
+  t8_locidx_t         num_local_elements;
+  int                 has_prev_record, has_next_record;
+  int                 mpiret, mpisize, mpirank, retval;
+
+  T8_ASSERT (filename != NULL);
+  T8_ASSERT (cmesh != NULL);
+  T8_ASSERT (t8_cmesh_is_committed (cmesh));
+  T8_ASSERT (scheme != NULL);
+
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  /* Each process reads its slice of the file independently. The reads
+   * must succeed on all processes for the load to continue. */
+  retval = t8_forest_checkpoint_read_local (filename, mpirank, mpisize,
+                                            data_size, data, &header,
+                                            &records, &first_element,
+                                            &num_local_elements,
+                                            &prev_record, &has_prev_record,
+                                            &next_record, &has_next_record);
+  mpiret = sc_MPI_Allreduce (sc_MPI_IN_PLACE, &retval, 1, sc_MPI_INT,
+                             sc_MPI_MIN, comm);
+  SC_CHECK_MPI (mpiret);
+  if (!retval) {
+    T8_FREE (records);
+    if (data != NULL && *data != NULL) {
+      T8_FREE (*data);
+      *data = NULL;
+    }
+    t8_scheme_cxx_unref (&scheme);
+    return NULL;
+  }
+  SC_CHECK_ABORTF (header.global_num_trees == t8_cmesh_get_num_trees (cmesh),
+                   "Checkpoint file %s does not match the given cmesh.\n",
+                   filename);
+
+  /* Rebuild the forest from the records of the local slice */
+  forest = t8_forest_build_from_records (cmesh, scheme, comm, records,
+                                         num_local_elements,
+                                         (t8_gloidx_t)
+                                         header.global_num_elements,
+                                         has_prev_record ? &prev_record
+                                         : NULL,
+                                         has_next_record ? &next_record
+                                         : NULL);
+  T8_FREE (records);
+  t8_debugf ("Loaded forest with %li local elements and %lli "
+             "global elements from checkpoint %s.\n",
+             (long) forest->local_num_elements,
+             (long long) forest->global_num_elements, filename);
+  return forest;
+}
+
+int
+t8_forest_write_leaves_raw (t8_forest_t forest, const char *filename)
+{
+  t8_forest_leaves_header_t header;
+  t8_forest_leaves_tree_t *tree_entries, closing_entry;
+  t8_forest_leaves_record_t *records;
+  t8_forest_checkpoint_block_t blocks[3];
+  t8_tree_t           tree;
+  t8_eclass_scheme_c *eclass_scheme;
+  t8_element_t       *element;
+  t8_gloidx_t         element_offset, first_index_tree;
+  t8_locidx_t         num_local_trees, itree, ielem, iel;
+  long long           records_start;
+  int                 level, num_index_trees, ientry, retval;
+
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (filename != NULL);
+
+  /* Fill the file header. All entries are the same on each process. */
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, T8_FOREST_LEAVES_MAGIC, sizeof (header.magic));
+  header.format = T8_FOREST_LEAVES_FORMAT;
+  header.record_bytes = (int32_t) sizeof (t8_forest_leaves_record_t);
+  header.global_num_trees = (int64_t) forest->global_num_trees;
+  header.global_num_elements = (int64_t) forest->global_num_elements;
+
+  /* The tree index entry of a tree is written by the process that holds
+   * the tree's first element, so a first local tree that is shared with
+   * the previous process is skipped. */
+  num_local_trees = (t8_locidx_t) forest->trees->elem_count;
+  first_index_tree = forest->first_local_tree;
+  if (num_local_trees > 0 && t8_forest_first_tree_shared (forest)) {
+    first_index_tree++;
+  }
+  num_index_trees = num_local_trees > 0
+    ? (int) (forest->last_local_tree - first_index_tree + 1) : 0;
+  T8_ASSERT (num_index_trees >= 0);
+
+  /* The global element offset of this process positions its slices */
+  element_offset = t8_shmem_array_get_gloidx (forest->element_offsets,
+                                              forest->mpirank);
+
+  tree_entries = T8_ALLOC (t8_forest_leaves_tree_t, num_index_trees);
+  for (ientry = 0; ientry < num_index_trees; ientry++) {
+    itree = (t8_locidx_t) (first_index_tree - forest->first_local_tree)
+      + (t8_locidx_t) ientry;
+    tree = (t8_tree_t) t8_sc_array_index_locidx (forest->trees, itree);
+    tree_entries[ientry].first_element = (int64_t) element_offset
+      + (int64_t) tree->elements_offset;
+    tree_entries[ientry].eclass = (int32_t) tree->eclass;
+    tree_entries[ientry].pad = 0;
+  }
+  /* The closing entry is contributed by process 0 */
+  closing_entry.first_element = (int64_t) forest->global_num_elements;
+  closing_entry.eclass = -1;
+  closing_entry.pad = 0;
+
+  /* Fill one record per local leaf element in SFC order */
+  records = T8_ALLOC (t8_forest_leaves_record_t,
+                      forest->local_num_elements);
+  for (itree = 0, iel = 0; itree < num_local_trees; itree++) {
+    tree = (t8_tree_t) t8_sc_array_index_locidx (forest->trees, itree);
+    eclass_scheme = forest->scheme_cxx->eclass_schemes[tree->eclass];
+    for (ielem = 0;
+         ielem < (t8_locidx_t) t8_element_array_get_count (&tree->elements);
+         ielem++, iel++) {
+      element = t8_element_array_index_locidx (&tree->elements, ielem);
+      level = eclass_scheme->t8_element_level (element);
+      records[iel].linear_id =
+        eclass_scheme->t8_element_get_linear_id (element, level);
+      records[iel].level = (int32_t) level;
+      records[iel].pad = 0;
+    }
+  }
+  T8_ASSERT (iel == forest->local_num_elements);
+
+  records_start = (long long) sizeof (header)
+    + (long long) (forest->global_num_trees + 1)
+    * sizeof (t8_forest_leaves_tree_t);
+
+  /* This process' slice of the tree index */
+  blocks[0].local_bytes = (const char *) tree_entries;
+  blocks[0].local_byte_count = (long long) num_index_trees
+    * sizeof (t8_forest_leaves_tree_t);
+  blocks[0].local_byte_offset = (long long) first_index_tree
+    * sizeof (t8_forest_leaves_tree_t);
+  blocks[0].block_start = (long long) sizeof (header);
+  /* The closing index entry */
+  blocks[1].local_bytes = (const char *) &closing_entry;
+  blocks[1].local_byte_count = forest->mpirank == 0
+    ? (long long) sizeof (t8_forest_leaves_tree_t) : 0;
+  blocks[1].local_byte_offset = (long long) forest->global_num_trees
+    * sizeof (t8_forest_leaves_tree_t);
+  blocks[1].block_start = (long long) sizeof (header);
+  /* The element records */
+  blocks[2].local_bytes = (const char *) records;
+  blocks[2].local_byte_count = (long long) forest->local_num_elements
+    * sizeof (t8_forest_leaves_record_t);
+  blocks[2].local_byte_offset = (long long) element_offset
+    * sizeof (t8_forest_leaves_record_t);
+  blocks[2].block_start = records_start;
+
+#ifdef T8_ENABLE_MPIIO
+  retval = t8_forest_checkpoint_write_mpiio (forest->mpicomm,
+                                             forest->mpirank, filename,
+                                             (const char *) &header,
+                                             sizeof (header), blocks, 3,
+                                             records_start
+                                             + (long long)
+                                             forest->global_num_elements
+                                             * sizeof
+                                             (t8_forest_leaves_record_t));
+#else
+  retval = t8_forest_checkpoint_write_serial (forest->mpicomm,
+                                              forest->mpirank,
+                                              forest->mpisize, filename,
+                                              (const char *) &header,
+                                              sizeof (header), blocks, 3);
+#endif
+  T8_FREE (tree_entries);
+  T8_FREE (records);
+  return retval;
+}
+
+int
+t8_forest_write_leaves_mapped (t8_forest_t forest, const char *filename)
+{
+  t8_forest_leaves_header_t header;
+  t8_forest_leaves_tree_t *tree_entries, closing_entry;
+  t8_forest_checkpoint_block_t blocks[4];
+  t8_tree_t           tree;
+  t8_eclass_scheme_c *eclass_scheme;
+  t8_gloidx_t         element_offset, first_index_tree;
+  t8_locidx_t         num_local_trees, itree;
+  int64_t             element_sizes[T8_ECLASS_COUNT];
+  char               *payload;
+  size_t              tree_bytes;
+  long long           local_payload_bytes, payload_byte_offset;
+  long long           global_payload_bytes, payload_start, filled;
+  int                 ieclass, num_index_trees, ientry, mpiret, retval;
+
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (filename != NULL);
+
+  /* Fill the file header. All entries are the same on each process.
+   * A zero record_bytes distinguishes the native payload layout. */
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, T8_FOREST_LEAVES_MAGIC, sizeof (header.magic));
+  header.format = T8_FOREST_LEAVES_MAPPED_FORMAT;
+  header.record_bytes = 0;
+  header.global_num_trees = (int64_t) forest->global_num_trees;
+  header.global_num_elements = (int64_t) forest->global_num_elements;
+
+  /* The element byte size of each eclass, needed by the reader to
+   * address the payload and to detect a mismatching scheme or host. */
+  for (ieclass = 0; ieclass < T8_ECLASS_COUNT; ieclass++) {
+    eclass_scheme = forest->scheme_cxx->eclass_schemes[ieclass];
+    element_sizes[ieclass] = eclass_scheme != NULL
+      ? (int64_t) eclass_scheme->t8_element_size () : 0;
+  }
+
+  /* The tree index entry of a tree is written by the process that holds
+   * the tree's first element, as in t8_forest_write_leaves_raw. */
+  num_local_trees = (t8_locidx_t) forest->trees->elem_count;
+  first_index_tree = forest->first_local_tree;
+  if (num_local_trees > 0 && t8_forest_first_tree_shared (forest)) {
+    first_index_tree++;
+  }
+  num_index_trees = num_local_trees > 0
+    ? (int) (forest->last_local_tree - first_index_tree + 1) : 0;
+  T8_ASSERT (num_index_trees >= 0);
+
+  element_offset = t8_shmem_array_get_gloidx (forest->element_offsets,
+                                              forest->mpirank);
+
+  tree_entries = T8_ALLOC (t8_forest_leaves_tree_t, num_index_trees);
+  for (ientry = 0; ientry < num_index_trees; ientry++) {
+    itree = (t8_locidx_t) (first_index_tree - forest->first_local_tree)
+      + (t8_locidx_t) ientry;
+    tree = (t8_tree_t) t8_sc_array_index_locidx (forest->trees, itree);
+    tree_entries[ientry].first_element = (int64_t) element_offset
+      + (int64_t) tree->elements_offset;
+    tree_entries[ientry].eclass = (int32_t) tree->eclass;
+    tree_entries[ientry].pad = 0;
+  }
+  /* The closing entry is contributed by process 0 */
+  closing_entry.first_element = (int64_t) forest->global_num_elements;
+  closing_entry.eclass = -1;
+  closing_entry.pad = 0;
+
+  /* Concatenate the native element storage of the local trees. Within a
+   * tree the elements are contiguous already, so one memcpy per tree
+   * assembles the local payload slice in SFC order. */
+  local_payload_bytes = 0;
+  for (itree = 0; itree < num_local_trees; itree++) {
+    tree = (t8_tree_t) t8_sc_array_index_locidx (forest->trees, itree);
+    eclass_scheme = forest->scheme_cxx->eclass_schemes[tree->eclass];
+    local_payload_bytes += (long long)
+      (t8_element_array_get_count (&tree->elements)
+       * eclass_scheme->t8_element_size ());
+  }
+  payload = T8_ALLOC (char, local_payload_bytes);
+  filled = 0;
+  for (itree = 0; itree < num_local_trees; itree++) {
+    tree = (t8_tree_t) t8_sc_array_index_locidx (forest->trees, itree);
+    eclass_scheme = forest->scheme_cxx->eclass_schemes[tree->eclass];
+    tree_bytes = t8_element_array_get_count (&tree->elements)
+      * eclass_scheme->t8_element_size ();
+    if (tree_bytes > 0) {
+      memcpy (payload + filled,
+              t8_element_array_index_locidx (&tree->elements, 0), tree_bytes);
+      filled += (long long) tree_bytes;
+    }
+  }
+  T8_ASSERT (filled == local_payload_bytes);
+
+  /* Since the element sizes vary by eclass, the payload byte offset of
+   * this process is the prefix sum of the local payload sizes. */
+  mpiret = sc_MPI_Exscan (&local_payload_bytes, &payload_byte_offset, 1,
+                          sc_MPI_LONG_LONG_INT, sc_MPI_SUM, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  if (forest->mpirank == 0) {
+    /* The Exscan result is undefined on process 0 */
+    payload_byte_offset = 0;
+  }
+  mpiret = sc_MPI_Allreduce (&local_payload_bytes, &global_payload_bytes, 1,
+                             sc_MPI_LONG_LONG_INT, sc_MPI_SUM,
+                             forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  payload_start = (long long) sizeof (header)
+    + (long long) (forest->global_num_trees + 1)
+    * sizeof (t8_forest_leaves_tree_t) + (long long) sizeof (element_sizes);
+
+  /* This process' slice of the tree index */
+  blocks[0].local_bytes = (const char *) tree_entries;
+  blocks[0].local_byte_count = (long long) num_index_trees
+    * sizeof (t8_forest_leaves_tree_t);
+  blocks[0].local_byte_offset = (long long) first_index_tree
+    * sizeof (t8_forest_leaves_tree_t);
+  blocks[0].block_start = (long long) sizeof (header);
+  /* The closing index entry */
+  blocks[1].local_bytes = (const char *) &closing_entry;
+  blocks[1].local_byte_count = forest->mpirank == 0
+    ? (long long) sizeof (t8_forest_leaves_tree_t) : 0;
+  blocks[1].local_byte_offset = (long long) forest->global_num_trees
+    * sizeof (t8_forest_leaves_tree_t);
+  blocks[1].block_start = (long long) sizeof (header);
+  /* The element size table, contributed by process 0 */
+  blocks[2].local_bytes = (const char *) element_sizes;
+  blocks[2].local_byte_count = forest->mpirank == 0
+    ? (long long) sizeof (element_sizes) : 0;
+  blocks[2].local_byte_offset = 0;
+  blocks[2].block_start = payload_start - (long long) sizeof (element_sizes);
+  /* The element payload */
+  blocks[3].local_bytes = payload;
+  blocks[3].local_byte_count = local_payload_bytes;
+  blocks[3].local_byte_offset = payload_byte_offset;
+  blocks[3].block_start = payload_start;
+
+#ifdef T8_ENABLE_MPIIO
+  retval = t8_forest_checkpoint_write_mpiio (forest->mpicomm,
+                                             forest->mpirank, filename,
+                                             (const char *) &header,
+                                             sizeof (header), blocks, 4,
+                                             payload_start
+                                             + global_payload_bytes);
+#else
+  retval = t8_forest_checkpoint_write_serial (forest->mpicomm,
+                                              forest->mpirank,
+                                              forest->mpisize, filename,
+                                              (const char *) &header,
+                                              sizeof (header), blocks, 4);
+#endif
+  T8_FREE (tree_entries);
+  T8_FREE (payload);
+  return retval;
+}
+
+/* The state behind a t8_forest_leaves_reader_t: the file content, either
+ * memory mapped or read into an allocated buffer. */
+struct t8_forest_leaves_reader
+{
+  const char         *bytes;    /* the file content */
+  size_t              num_bytes;        /* the file size */
+  int                 is_mapped;        /* true if bytes is a memory map */
+};
+
+t8_forest_leaves_reader_t
+t8_forest_leaves_reader_open (const char *filename)
+{
+  t8_forest_leaves_reader_t reader;
+  const t8_forest_leaves_header_t *header;
+  FILE               *file;
+  char               *bytes = NULL;
+  long long           num_bytes, expected_bytes;
+  int                 is_mapped = 0;
+
+  file = fopen (filename, "rb");
+  if (file == NULL) {
+    t8_errorf ("Error when opening file %s\n", filename);
+    return NULL;
+  }
+  fseek (file, 0, SEEK_END);
+  num_bytes = (long long) ftell (file);
+  if (num_bytes < (long long) sizeof (t8_forest_leaves_header_t)) {
+    t8_errorf ("File %s is not a t8code raw leaf file\n", filename);
+    fclose (file);
+    return NULL;
+  }
+#ifdef T8_HAVE_SYS_MMAN_H
+  {
+    /* Map the whole file read only. The pages are paged in on demand, so
+     * scanning sections of a large file does not read the rest. */
+    void               *map = mmap (NULL, (size_t) num_bytes, PROT_READ,
+                                    MAP_PRIVATE, fileno (file), 0);
+
+    if (map != MAP_FAILED) {
+      bytes = (char *) map;
+      is_mapped = 1;
+    }
+  }
+#endif
+  if (bytes == NULL) {
+    /* mmap is not available or failed, read the file instead */
+    bytes = T8_ALLOC (char, num_bytes);
+    fseek (file, 0, SEEK_SET);
+    if ((long long) fread (bytes, 1, num_bytes, file) != num_bytes) {
+      t8_errorf ("Error when reading file %s\n", filename);
+      fclose (file);
+      T8_FREE (bytes);
+      return NULL;
+    }
+  }
+  fclose (file);
+
+  /* Validate the header and the file size */
+  header = (const t8_forest_leaves_header_t *) bytes;
+  expected_bytes = (long long) sizeof (*header)
+    + (header->global_num_trees + 1)
+    * (long long) sizeof (t8_forest_leaves_tree_t)
+    + header->global_num_elements
+    * (long long) sizeof (t8_forest_leaves_record_t);
+  if (memcmp (header->magic, T8_FOREST_LEAVES_MAGIC, sizeof (header->magic))
+      || header->format != T8_FOREST_LEAVES_FORMAT
+      || header->record_bytes != (int32_t) sizeof (t8_forest_leaves_record_t)
+      || num_bytes < expected_bytes) {
+    t8_errorf ("File %s is not a t8code raw leaf file\n", filename);
+    if (is_mapped) {
+#ifdef T8_HAVE_SYS_MMAN_H
+      munmap ((void *) bytes, (size_t) num_bytes);
+#endif
+    }
+    else {
+      T8_FREE (bytes);
+    }
+    return NULL;
+  }
+
+  reader = T8_ALLOC (struct t8_forest_leaves_reader, 1);
+  reader->bytes = bytes;
+  reader->num_bytes = (size_t) num_bytes;
+  reader->is_mapped = is_mapped;
+  return reader;
+}
+
+const t8_forest_leaves_header_t *
+t8_forest_leaves_reader_header (t8_forest_leaves_reader_t reader)
+{
+  T8_ASSERT (reader != NULL);
+  return (const t8_forest_leaves_header_t *) reader->bytes;
+}
+
+const t8_forest_leaves_tree_t *
+t8_forest_leaves_reader_tree_index (t8_forest_leaves_reader_t reader)
+{
+  T8_ASSERT (reader != NULL);
+  return (const t8_forest_leaves_tree_t *)
+    (reader->bytes + sizeof (t8_forest_leaves_header_t));
+}
+
+const t8_forest_leaves_record_t *
+t8_forest_leaves_reader_records (t8_forest_leaves_reader_t reader)
+{
+  const t8_forest_leaves_header_t *header;
+
+  T8_ASSERT (reader != NULL);
+  header = t8_forest_leaves_reader_header (reader);
+  return (const t8_forest_leaves_record_t *)
+    (reader->bytes + sizeof (t8_forest_leaves_header_t)
+     + (header->global_num_trees + 1) * sizeof (t8_forest_leaves_tree_t));
+}
+
+void
+t8_forest_leaves_reader_close (t8_forest_leaves_reader_t *preader)
+{
+  t8_forest_leaves_reader_t reader;
+
+  T8_ASSERT (preader != NULL && *preader != NULL);
+  reader = *preader;
+  if (reader->is_mapped) {
+#ifdef T8_HAVE_SYS_MMAN_H
+    munmap ((void *) reader->bytes, reader->num_bytes);
+#endif
+  }
+  else {
+    T8_FREE ((void *) reader->bytes);
+  }
+  T8_FREE (reader);
+  *preader = NULL;
+}
+
+/* The state behind a t8_forest_mapped_t: the committed read only forest
+ * view and the file content that backs its element arrays. */
+struct t8_forest_mapped
+{
+  t8_forest_t         forest;   /* the read only forest view */
+  const char         *bytes;    /* the file content */
+  size_t              num_bytes;        /* the file size */
+  int                 is_mapped;        /* true if bytes is a memory map */
+};
+
+/* Map or read a mapped leaf file and validate it against the given
+ * scheme. On success *pbytes/*pnum_bytes/*pis_mapped describe the file
+ * content as in t8_forest_leaves_reader_open. Returns true on success.
+ * This function is process local; the caller combines the return values
+ * of all processes. */
+static int
+t8_forest_mapped_open_local (const char *filename, t8_scheme_cxx_t *scheme,
+                             const char **pbytes, size_t *pnum_bytes,
+                             int *pis_mapped)
+{
+  const t8_forest_leaves_header_t *header;
+  const t8_forest_leaves_tree_t *tree_index;
+  const int64_t      *element_sizes;
+  t8_eclass_scheme_c *eclass_scheme;
+  FILE               *file;
+  char               *bytes = NULL;
+  long long           num_bytes, payload_bytes;
+  int64_t             jt;
+  int                 is_mapped = 0, valid;
+
+  file = fopen (filename, "rb");
+  if (file == NULL) {
+    t8_errorf ("Error when opening file %s\n", filename);
+    return 0;
+  }
+  fseek (file, 0, SEEK_END);
+  num_bytes = (long long) ftell (file);
+  if (num_bytes < (long long) sizeof (t8_forest_leaves_header_t)) {
+    t8_errorf ("File %s is not a t8code mapped leaf file\n", filename);
+    fclose (file);
+    return 0;
+  }
+#ifdef T8_HAVE_SYS_MMAN_H
+  {
+    /* Map the whole file read only. The element arrays of the view will
+     * point into this mapping, so the leafs are paged in on first access
+     * and never copied into heap memory. */
+    void               *map = mmap (NULL, (size_t) num_bytes, PROT_READ,
+                                    MAP_PRIVATE, fileno (file), 0);
+
+    if (map != MAP_FAILED) {
+      bytes = (char *) map;
+      is_mapped = 1;
+    }
+  }
+#endif
+  if (bytes == NULL) {
+    /* mmap is not available or failed, read the file instead */
+    bytes = T8_ALLOC (char, num_bytes);
+    fseek (file, 0, SEEK_SET);
+    if ((long long) fread (bytes, 1, num_bytes, file) != num_bytes) {
+      t8_errorf ("Error when reading file %s\n", filename);
+      fclose (file);
+      T8_FREE (bytes);
+      return 0;
+    }
+  }
+  fclose (file);
+
+  /* Validate the header, the element size table and the file size. The
+   * size table must match the given scheme exactly, since a file from a
+   * different scheme or host would be misinterpreted byte for byte. */
+  header = (const t8_forest_leaves_header_t *) bytes;
+  valid = memcmp (header->magic, T8_FOREST_LEAVES_MAGIC,
+                  sizeof (header->magic)) == 0
+    && header->format == T8_FOREST_LEAVES_MAPPED_FORMAT
+    && header->record_bytes == 0
+    && num_bytes >= (long long) sizeof (*header)
+    + (header->global_num_trees + 1)
+    * (long long) sizeof (t8_forest_leaves_tree_t)
+    + (long long) sizeof (int64_t) * T8_ECLASS_COUNT;
+  if (valid) {
+    tree_index = (const t8_forest_leaves_tree_t *)
+      (bytes + sizeof (t8_forest_leaves_header_t));
+    element_sizes = (const int64_t *)
+      (tree_index + header->global_num_trees + 1);
+    payload_bytes = 0;
+    for (jt = 0; valid && jt < header->global_num_trees; jt++) {
+      const int32_t       eclass = tree_index[jt].eclass;
+
+      eclass_scheme = 0 <= eclass && eclass < T8_ECLASS_COUNT
+        ? scheme->eclass_schemes[eclass] : NULL;
+      if (eclass_scheme == NULL
+          || element_sizes[eclass]
+          != (int64_t) eclass_scheme->t8_element_size ()) {
+        valid = 0;
+      }
+      else {
+        payload_bytes += (tree_index[jt + 1].first_element
+                          - tree_index[jt].first_element)
+          * element_sizes[eclass];
+      }
+    }
+    valid = valid && num_bytes >= (long long) sizeof (*header)
+      + (header->global_num_trees + 1)
+      * (long long) sizeof (t8_forest_leaves_tree_t)
+      + (long long) sizeof (int64_t) * T8_ECLASS_COUNT + payload_bytes;
+  }
+  if (!valid) {
+    t8_errorf ("File %s is not a t8code mapped leaf file "
+               "or does not match the given scheme\n", filename);
+    if (is_mapped) {
+#ifdef T8_HAVE_SYS_MMAN_H
+      munmap ((void *) bytes, (size_t) num_bytes);
+#endif
+    }
+    else {
+      T8_FREE (bytes);
+    }
+    return 0;
+  }
+
+  *pbytes = bytes;
+  *pnum_bytes = (size_t) num_bytes;
+  *pis_mapped = is_mapped;
+  return 1;
+}
+
+t8_forest_mapped_t
+t8_forest_open_mapped (const char *filename, t8_cmesh_t cmesh,
+                       t8_scheme_cxx_t *scheme, sc_MPI_Comm comm)
+{
+  t8_forest_mapped_t  mapped;
+  const t8_forest_leaves_header_t *header;
+  const t8_forest_leaves_tree_t *tree_index;
+  const int64_t      *element_sizes;
+  const char         *bytes, *payload;
+  t8_forest_t         forest;
+  t8_cmesh_t          cmesh_part;
+  t8_tree_t           tree;
+  t8_eclass_scheme_c *eclass_scheme;
+  t8_gloidx_t         first_element, end_element, first_tree, last_tree;
+  t8_gloidx_t         jt, first_ctree, tree_first, tree_end;
+  t8_locidx_t         num_local_elements, num_tree_elements;
+  long long           tree_byte_start;
+  size_t              num_bytes;
+  int                 mpiret, mpisize, mpirank, is_mapped, retval;
+
+  T8_ASSERT (filename != NULL);
+  T8_ASSERT (cmesh != NULL);
+  T8_ASSERT (t8_cmesh_is_committed (cmesh));
+  T8_ASSERT (scheme != NULL);
+
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  /* Each process maps the file independently. The opens must succeed on
+   * all processes for the view to be created. */
+  bytes = NULL;
+  retval = t8_forest_mapped_open_local (filename, scheme, &bytes,
+                                        &num_bytes, &is_mapped);
+  mpiret = sc_MPI_Allreduce (sc_MPI_IN_PLACE, &retval, 1, sc_MPI_INT,
+                             sc_MPI_MIN, comm);
+  SC_CHECK_MPI (mpiret);
+  if (!retval) {
+    if (bytes != NULL) {
+      if (is_mapped) {
+#ifdef T8_HAVE_SYS_MMAN_H
+        munmap ((void *) bytes, num_bytes);
+#endif
+      }
+      else {
+        T8_FREE ((void *) bytes);
+      }
+    }
+    t8_scheme_cxx_unref (&scheme);
+    return NULL;
+  }
+  header = (const t8_forest_leaves_header_t *) bytes;
+  tree_index = (const t8_forest_leaves_tree_t *)
+    (bytes + sizeof (t8_forest_leaves_header_t));
+  element_sizes = (const int64_t *)
+    (tree_index + header->global_num_trees + 1);
+  payload = (const char *) (element_sizes + T8_ECLASS_COUNT);
+  SC_CHECK_ABORTF (header->global_num_trees == t8_cmesh_get_num_trees (cmesh),
+                   "Mapped leaf file %s does not match the given cmesh.\n",
+                   filename);
+
+  /* Partition the elements uniformly over the calling processes and
+   * locate the local tree range in the tree index. */
+  first_element = ((t8_gloidx_t) header->global_num_elements * mpirank)
+    / mpisize;
+  end_element = ((t8_gloidx_t) header->global_num_elements * (mpirank + 1))
+    / mpisize;
+  num_local_elements = (t8_locidx_t) (end_element - first_element);
+  first_tree = 0;
+  while (first_tree < (t8_gloidx_t) header->global_num_trees
+         && (t8_gloidx_t) tree_index[first_tree + 1].first_element
+         <= first_element) {
+    first_tree++;
+  }
+  if (num_local_elements > 0) {
+    last_tree = first_tree;
+    while ((t8_gloidx_t) tree_index[last_tree + 1].first_element
+           < end_element) {
+      last_tree++;
+    }
+  }
+  else {
+    /* An empty process lives between the trees of its neighbors; we
+     * place it on the tree that holds the next element. */
+    last_tree = first_tree - 1;
+  }
+
+  /* Derive a matching partition of the cmesh. A first tree whose first
+   * element lives on a smaller process is shared and passed with the
+   * negative encoding of t8_cmesh_set_partition_range. */
+  t8_cmesh_init (&cmesh_part);
+  t8_cmesh_set_derive (cmesh_part, cmesh);
+  t8_cmesh_set_partition_range (cmesh_part, 3,
+                                (num_local_elements > 0
+                                 && (t8_gloidx_t)
+                                 tree_index[first_tree].first_element
+                                 < first_element)
+                                ? -first_tree - 1 : first_tree, last_tree);
+  t8_cmesh_commit (cmesh_part, comm);
+
+  /* Build the forest on the derived cmesh as t8_forest_load_checkpoint
+   * does, but instead of constructing elements from records we point the
+   * element array of each tree into the mapped payload. */
+  t8_forest_init (&forest);
+  t8_forest_set_cmesh (forest, cmesh_part, comm);
+  t8_forest_set_scheme (forest, scheme);
+  forest->dimension = cmesh_part->dimension;
+  mpiret = sc_MPI_Comm_size (forest->mpicomm, &forest->mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (forest->mpicomm, &forest->mpirank);
+  SC_CHECK_MPI (mpiret);
+  t8_forest_compute_maxlevel (forest);
+
+  if (num_local_elements == 0) {
+    /* This process is empty. As in t8_forest_populate we still create
+     * the tree array and set the first tree larger than the last one. */
+    forest->trees = t8_forest_recycle_trees_new (0);
+    forest->first_local_tree = first_tree;
+    forest->last_local_tree = first_tree - 1;
+  }
+  else {
+    forest->first_local_tree = first_tree;
+    forest->last_local_tree = last_tree;
+    forest->trees = t8_forest_recycle_trees_new (last_tree - first_tree + 1);
+    first_ctree = t8_cmesh_get_first_treeid (forest->cmesh);
+    /* The payload byte offset of the first local tree is the prefix sum
+     * of the full tree payload sizes before it. */
+    tree_byte_start = 0;
+    for (jt = 0; jt < first_tree; jt++) {
+      tree_byte_start += (tree_index[jt + 1].first_element
+                          - tree_index[jt].first_element)
+        * element_sizes[tree_index[jt].eclass];
+    }
+    for (jt = first_tree; jt <= last_tree; jt++) {
+      const size_t        element_size =
+        (size_t) element_sizes[tree_index[jt].eclass];
+
+      tree = (t8_tree_t) t8_sc_array_index_locidx (forest->trees,
+                                                   jt - first_tree);
+      tree->eclass = t8_cmesh_get_tree_class (forest->cmesh,
+                                              jt - first_ctree);
+      T8_ASSERT ((int32_t) tree->eclass == tree_index[jt].eclass);
+      eclass_scheme = forest->scheme_cxx->eclass_schemes[tree->eclass];
+      T8_ASSERT (eclass_scheme != NULL);
+      /* The local slice of this tree in global element indices */
+      tree_first = SC_MAX (first_element,
+                           (t8_gloidx_t) tree_index[jt].first_element);
+      tree_end = SC_MIN (end_element,
+                         (t8_gloidx_t) tree_index[jt + 1].first_element);
+      num_tree_elements = (t8_locidx_t) (tree_end - tree_first);
+      SC_CHECK_ABORTF (num_tree_elements > 0,
+                       "Mapped leaf file %s is inconsistent.\n", filename);
+      tree->elements_offset = (t8_locidx_t) (tree_first - first_element);
+      /* The mapping is read only; writing through this view faults */
+      t8_element_array_init_data (&tree->elements, (t8_element_t *)
+                                  (payload + tree_byte_start
+                                   + (tree_first
+                                      - tree_index[jt].first_element)
+                                   * element_size), eclass_scheme,
+                                  (size_t) num_tree_elements);
+      tree_byte_start += (tree_index[jt + 1].first_element
+                          - tree_index[jt].first_element)
+        * (long long) element_size;
+    }
+  }
+  forest->local_num_elements = num_local_elements;
+  forest->global_num_elements = (t8_gloidx_t) header->global_num_elements;
+  forest->global_num_trees = t8_cmesh_get_num_trees (forest->cmesh);
+  forest->incomplete_trees = 0;
+
+  /* Finalize the forest as t8_forest_commit does after population */
+  t8_forest_compute_elements_offset (forest);
+  t8_forest_compute_desc (forest);
+  forest->set_level = 0;
+  forest->set_from = NULL;
+  forest->committed = 1;
+  t8_forest_partition_create_tree_offsets (forest);
+  t8_forest_partition_create_offsets (forest);
+  t8_forest_partition_create_first_desc (forest);
+  t8_debugf ("Opened mapped forest view with %li local elements and %lli "
+             "global elements from %s.\n",
+             (long) forest->local_num_elements,
+             (long long) forest->global_num_elements, filename);
+
+  mapped = T8_ALLOC (struct t8_forest_mapped, 1);
+  mapped->forest = forest;
+  mapped->bytes = bytes;
+  mapped->num_bytes = num_bytes;
+  mapped->is_mapped = is_mapped;
+  return mapped;
+}
+
+t8_forest_t
+t8_forest_mapped_get_forest (t8_forest_mapped_t mapped)
+{
+  T8_ASSERT (mapped != NULL);
+  return mapped->forest;
+}
+
+void
+t8_forest_close_mapped (t8_forest_mapped_t *pmapped)
+{
+  t8_forest_mapped_t  mapped;
+
+  T8_ASSERT (pmapped != NULL && *pmapped != NULL);
+  mapped = *pmapped;
+  /* The element arrays of the forest point into the file content, so
+   * the forest must be destroyed before the file is unmapped. */
+  t8_forest_unref (&mapped->forest);
+  if (mapped->is_mapped) {
+#ifdef T8_HAVE_SYS_MMAN_H
+    munmap ((void *) mapped->bytes, mapped->num_bytes);
+#endif
+  }
+  else {
+    T8_FREE ((void *) mapped->bytes);
+  }
+  T8_FREE (mapped);
+  *pmapped = NULL;
+}
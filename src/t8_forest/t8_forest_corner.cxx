@@ -0,0 +1,765 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/* In this file we implement the corner and edge neighbor queries of a
+ * forest, see t8_forest_corner.h.
+ * Both queries are driven by the same engine: the queried vertex (or
+ * edge) is represented as a line segment in the reference space of the
+ * leaf's tree - a degenerate segment with equal end points for a
+ * vertex - and the adjacent leafs are collected by a breadth first
+ * closure over face hops. A leaf is expanded across exactly the faces
+ * that contain a point of the segment, and a face neighbor is accepted
+ * if its closed reference cell intersects the segment, so every leaf
+ * around the vertex is visited once and the closure terminates after
+ * the handful of cells of the vertex star.
+ * The leafs of a tree are axis aligned boxes or affine simplices in
+ * the embedded reference space [0,1]^d of the tree, hence all
+ * intersection tests reduce to clipping the segment against the
+ * supporting planes of the element faces. When a hop crosses a coarse
+ * mesh face the segment is mapped into the reference space of the
+ * neighbor tree with the same boundary/transform machinery that the
+ * face neighbor path uses, so arbitrary orientations and hybrid
+ * face connections are handled. */
+
+#include <t8_cmesh.h>
+#include <t8_element_cxx.hxx>
+#include <t8_data/t8_containers.h>
+#include <t8_cmesh/t8_cmesh_trees.h>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_corner.h>
+#include <t8_forest/t8_forest_ghost.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_forest/t8_forest_private.h>
+
+/* Tolerance for the reference space intersection tests. The reference
+ * coordinates of element vertices are exact dyadic numbers, but the
+ * segment parameters below are results of divisions. */
+#define T8_FOREST_CORNER_EPS 1e-10
+
+/* One entry of the closure front: a local leaf together with the query
+ * segment expressed in the reference space of the leaf's tree. */
+typedef struct t8_forest_corner_front
+{
+  t8_locidx_t         element_index;    /* forest local element index */
+  t8_locidx_t         ltreeid;  /* forest local tree of the leaf */
+  double              seg_a[3]; /* one segment end point in tree reference space */
+  double              seg_b[3]; /* the other end point; equal for a vertex query */
+} t8_forest_corner_front_t;
+
+/* Compute the inward oriented supporting plane of a face of an element
+ * in reference space: a unit normal and the offset such that
+ * normal * x - offset >= 0 holds inside the element.
+ * The face corners must be filled in q, the element midpoint serves as
+ * the inside reference point. */
+static void
+t8_forest_corner_face_plane (const double q[][3], int dim,
+                             const double inside[3], double normal[3],
+                             double *offset)
+{
+  double              norm, side;
+  int                 i;
+
+  normal[0] = normal[1] = normal[2] = 0;
+  switch (dim) {
+  case 1:
+    /* The face is a point; the plane is the point itself */
+    normal[0] = 1;
+    break;
+  case 2:
+    /* The face is a segment; rotate its direction by 90 degrees */
+    normal[0] = -(q[1][1] - q[0][1]);
+    normal[1] = q[1][0] - q[0][0];
+    break;
+  default:
+    T8_ASSERT (dim == 3);
+    /* The face is planar; use the cross product of two edges */
+    normal[0] = (q[1][1] - q[0][1]) * (q[2][2] - q[0][2])
+      - (q[1][2] - q[0][2]) * (q[2][1] - q[0][1]);
+    normal[1] = (q[1][2] - q[0][2]) * (q[2][0] - q[0][0])
+      - (q[1][0] - q[0][0]) * (q[2][2] - q[0][2]);
+    normal[2] = (q[1][0] - q[0][0]) * (q[2][1] - q[0][1])
+      - (q[1][1] - q[0][1]) * (q[2][0] - q[0][0]);
+    break;
+  }
+  norm = sqrt (normal[0] * normal[0] + normal[1] * normal[1]
+               + normal[2] * normal[2]);
+  T8_ASSERT (norm > 0);
+  for (i = 0; i < 3; i++) {
+    normal[i] /= norm;
+  }
+  *offset = normal[0] * q[0][0] + normal[1] * q[0][1] + normal[2] * q[0][2];
+  /* Orient the normal towards the element midpoint */
+  side = normal[0] * inside[0] + normal[1] * inside[1]
+    + normal[2] * inside[2] - *offset;
+  if (side < 0) {
+    for (i = 0; i < 3; i++) {
+      normal[i] = -normal[i];
+    }
+    *offset = -*offset;
+  }
+}
+
+/* Compute the signed plane distances of the segment end points for each
+ * face of an element and clip the segment parameter interval to the
+ * element. On output dist_a[f] and dist_b[f] are the distances of the
+ * end points to face f and [*clip_first, *clip_end] is the parameter
+ * interval of the segment inside the element. Returns true if the
+ * intersection is non-empty. */
+static int
+t8_forest_corner_clip_element (t8_eclass_scheme_c *ts,
+                               const t8_element_t *elem, int dim,
+                               const double seg_a[3], const double seg_b[3],
+                               double dist_a[T8_ECLASS_MAX_FACES],
+                               double dist_b[T8_ECLASS_MAX_FACES],
+                               double *clip_first, double *clip_end)
+{
+  double              q[T8_ECLASS_MAX_CORNERS_2D][3];
+  double              inside[3], normal[3];
+  double              offset, slope, tcut;
+  int                 num_faces, num_corners, iface, icorner, nfc, i;
+
+  /* The element midpoint as the inside reference point of the planes */
+  inside[0] = inside[1] = inside[2] = 0;
+  num_corners = ts->t8_element_num_corners (elem);
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    q[0][0] = q[0][1] = q[0][2] = 0;
+    ts->t8_element_vertex_reference_coords (elem, icorner, q[0]);
+    for (i = 0; i < 3; i++) {
+      inside[i] += q[0][i] / num_corners;
+    }
+  }
+
+  *clip_first = 0;
+  *clip_end = 1;
+  num_faces = ts->t8_element_num_faces (elem);
+  T8_ASSERT (num_faces <= T8_ECLASS_MAX_FACES);
+  for (iface = 0; iface < num_faces; iface++) {
+    nfc = t8_eclass_num_vertices[ts->t8_element_face_shape (elem, iface)];
+    T8_ASSERT (nfc <= T8_ECLASS_MAX_CORNERS_2D);
+    for (icorner = 0; icorner < nfc; icorner++) {
+      q[icorner][0] = q[icorner][1] = q[icorner][2] = 0;
+      ts->t8_element_vertex_reference_coords (elem,
+                                              ts->t8_element_get_face_corner
+                                              (elem, iface, icorner),
+                                              q[icorner]);
+    }
+    t8_forest_corner_face_plane (q, dim, inside, normal, &offset);
+    dist_a[iface] = normal[0] * seg_a[0] + normal[1] * seg_a[1]
+      + normal[2] * seg_a[2] - offset;
+    dist_b[iface] = normal[0] * seg_b[0] + normal[1] * seg_b[1]
+      + normal[2] * seg_b[2] - offset;
+    /* Clip the interval against dist_a + t * (dist_b - dist_a) >= -eps */
+    slope = dist_b[iface] - dist_a[iface];
+    if (fabs (slope) <= T8_FOREST_CORNER_EPS) {
+      if (dist_a[iface] < -T8_FOREST_CORNER_EPS) {
+        return 0;
+      }
+    }
+    else {
+      tcut = (-T8_FOREST_CORNER_EPS - dist_a[iface]) / slope;
+      if (slope > 0) {
+        *clip_first = SC_MAX (*clip_first, tcut);
+      }
+      else {
+        *clip_end = SC_MIN (*clip_end, tcut);
+      }
+    }
+  }
+  return *clip_first <= *clip_end + T8_FOREST_CORNER_EPS;
+}
+
+/* Given the plane distances of a face and the parameter interval of the
+ * segment inside the element, compute the parameter subinterval that
+ * lies on the face. Returns true if it is non-empty, that is if the
+ * segment touches the face. */
+static int
+t8_forest_corner_face_interval (double dist_a, double dist_b,
+                                double clip_first, double clip_end,
+                                double *face_first, double *face_end)
+{
+  double              slope, tcut;
+
+  slope = dist_b - dist_a;
+  if (fabs (slope) <= T8_FOREST_CORNER_EPS) {
+    /* The segment is parallel to the face plane */
+    if (fabs (dist_a) > T8_FOREST_CORNER_EPS) {
+      return 0;
+    }
+    *face_first = clip_first;
+    *face_end = clip_end;
+    return 1;
+  }
+  /* The segment crosses the plane in a single point */
+  tcut = -dist_a / slope;
+  if (tcut < clip_first - T8_FOREST_CORNER_EPS
+      || tcut > clip_end + T8_FOREST_CORNER_EPS) {
+    return 0;
+  }
+  *face_first = *face_end = SC_MAX (clip_first, SC_MIN (clip_end, tcut));
+  return 1;
+}
+
+/* Compute the shape function weights of a point on a face with corners
+ * q[0], ..., q[nfc-1] (volume reference coordinates, boundary corner
+ * order), such that the point is the weighted sum of the corners. The
+ * faces of the reference elements are affine (parallelogram shaped for
+ * quadrilateral faces), so an affine solve in the two spanning edges is
+ * exact. */
+static void
+t8_forest_corner_face_weights (const double q[][3], int nfc,
+                               const double point[3], double weights[])
+{
+  double              e1[3], e2[3], rhs[3];
+  double              g11, g12, g22, r1, r2, det, s, u;
+  int                 i;
+
+  T8_ASSERT (1 <= nfc && nfc <= 4);
+  if (nfc == 1) {
+    weights[0] = 1;
+    return;
+  }
+  for (i = 0; i < 3; i++) {
+    e1[i] = q[1][i] - q[0][i];
+    rhs[i] = point[i] - q[0][i];
+  }
+  if (nfc == 2) {
+    /* One dimensional solve along the dominant axis */
+    g11 = e1[0] * e1[0] + e1[1] * e1[1] + e1[2] * e1[2];
+    T8_ASSERT (g11 > 0);
+    s = (rhs[0] * e1[0] + rhs[1] * e1[1] + rhs[2] * e1[2]) / g11;
+    weights[0] = 1 - s;
+    weights[1] = s;
+    return;
+  }
+  /* Triangle or parallelogram: solve the normal equations of
+   * point - q0 = s * e1 + u * e2 */
+  for (i = 0; i < 3; i++) {
+    e2[i] = q[2][i] - q[0][i];
+  }
+  g11 = e1[0] * e1[0] + e1[1] * e1[1] + e1[2] * e1[2];
+  g12 = e1[0] * e2[0] + e1[1] * e2[1] + e1[2] * e2[2];
+  g22 = e2[0] * e2[0] + e2[1] * e2[1] + e2[2] * e2[2];
+  r1 = rhs[0] * e1[0] + rhs[1] * e1[1] + rhs[2] * e1[2];
+  r2 = rhs[0] * e2[0] + rhs[1] * e2[1] + rhs[2] * e2[2];
+  det = g11 * g22 - g12 * g12;
+  T8_ASSERT (fabs (det) > 0);
+  s = (g22 * r1 - g12 * r2) / det;
+  u = (g11 * r2 - g12 * r1) / det;
+  if (nfc == 3) {
+    weights[0] = 1 - s - u;
+    weights[1] = s;
+    weights[2] = u;
+  }
+  else {
+    /* Bilinear weights in the Z-order corner numbering of the face */
+    weights[0] = (1 - s) * (1 - u);
+    weights[1] = s * (1 - u);
+    weights[2] = (1 - s) * u;
+    weights[3] = s * u;
+  }
+}
+
+/* Return true if two element corners have the same reference
+ * coordinates. */
+static int
+t8_forest_corner_coords_equal (const double a[3], const double b[3])
+{
+  return fabs (a[0] - b[0]) <= T8_FOREST_CORNER_EPS
+    && fabs (a[1] - b[1]) <= T8_FOREST_CORNER_EPS
+    && fabs (a[2] - b[2]) <= T8_FOREST_CORNER_EPS;
+}
+
+/* Map two points on a coarse mesh face of a tree into the reference
+ * space of the face neighbor tree, crossing the face of \a elem like
+ * t8_forest_element_face_neighbor does.
+ * The corner permutation induced by the face connection is computed by
+ * transforming the level one corner children of the root boundary face
+ * element and reading off which root corner each image touches; the
+ * points then map by applying the permuted shape function weights of
+ * the neighbor's tree face corners.
+ * On output *pneigh_ltreeid is the forest local tree id of the
+ * neighbor tree, or -1 if the neighbor tree is not forest local.
+ * Returns false if the tree face is a domain boundary. */
+static int
+t8_forest_corner_transport (t8_forest_t forest, t8_locidx_t ltreeid,
+                            const t8_element_t *elem, t8_eclass_scheme_c *ts,
+                            int face, const double point_a[3],
+                            const double point_b[3],
+                            t8_locidx_t *pneigh_ltreeid, double neigh_a[3],
+                            double neigh_b[3])
+{
+  t8_cmesh_t          cmesh;
+  t8_cghost_t         ghost;
+  t8_eclass_scheme_c *neighbor_scheme;
+  t8_eclass_t         eclass, neigh_eclass, boundary_class;
+  t8_element_t       *root;
+  t8_locidx_t         lctree_id, lcneigh_id;
+  t8_locidx_t        *face_neighbor;
+  int8_t             *ttf;
+  double              qa[T8_ECLASS_MAX_CORNERS_2D][3];
+  double              qb[T8_ECLASS_MAX_CORNERS_2D][3];
+  double              weights[T8_ECLASS_MAX_CORNERS_2D];
+  int                 sigma[T8_ECLASS_MAX_CORNERS_2D];
+  int                 tree_face, tree_neigh_face, orientation, sign;
+  int                 is_smaller, eclass_compare, F, nfc, j, i;
+
+  cmesh = forest->cmesh;
+  eclass = t8_forest_get_tree_class (forest, ltreeid);
+  tree_face = ts->t8_element_tree_face (elem, face);
+  lctree_id = t8_forest_ltreeid_to_cmesh_ltreeid (forest, ltreeid);
+  if (t8_cmesh_tree_face_is_boundary (cmesh, lctree_id, tree_face)) {
+    return 0;
+  }
+  (void) t8_cmesh_trees_get_tree_ext (cmesh->trees, lctree_id,
+                                      &face_neighbor, &ttf);
+  lcneigh_id = face_neighbor[tree_face];
+  F = t8_eclass_max_num_faces[cmesh->dimension];
+  tree_neigh_face = ttf[tree_face] % F;
+  orientation = ttf[tree_face] / F;
+  if (lcneigh_id == lctree_id && tree_face == tree_neigh_face) {
+    return 0;
+  }
+  if (lcneigh_id < t8_cmesh_get_num_local_trees (cmesh)) {
+    neigh_eclass = t8_cmesh_get_tree_class (cmesh, lcneigh_id);
+    *pneigh_ltreeid = t8_forest_cmesh_ltreeid_to_ltreeid (forest, lcneigh_id);
+  }
+  else {
+    ghost = t8_cmesh_trees_get_ghost (cmesh->trees,
+                                      lcneigh_id -
+                                      t8_cmesh_get_num_local_trees (cmesh));
+    neigh_eclass = ghost->eclass;
+    *pneigh_ltreeid = -1;
+  }
+  /* Determine the smaller face and the sign as in
+   * t8_forest_element_face_neighbor */
+  eclass_compare = t8_eclass_compare (eclass, neigh_eclass);
+  is_smaller = eclass_compare < 0
+    || (eclass_compare == 0 && tree_face <= tree_neigh_face);
+  sign = t8_eclass_face_orientation[eclass][tree_face]
+    == t8_eclass_face_orientation[neigh_eclass][tree_neigh_face];
+
+  boundary_class = (t8_eclass_t) t8_eclass_face_types[eclass][tree_face];
+  nfc = t8_eclass_num_vertices[boundary_class];
+  T8_ASSERT (nfc <= T8_ECLASS_MAX_CORNERS_2D);
+  T8_ASSERT (nfc == t8_eclass_num_vertices[t8_eclass_face_types
+                                           [neigh_eclass][tree_neigh_face]]);
+  if (nfc == 1) {
+    /* A point connection permutes nothing */
+    sigma[0] = 0;
+  }
+  else {
+    /* Compute the corner permutation of the face connection. The corner
+     * children of the root face element touch one root corner each;
+     * transforming them and looking up the touched corner of the image
+     * yields the permutation without re-implementing the orientation
+     * conventions of t8_element_transform_face. */
+    t8_eclass_scheme_c *boundary_scheme;
+    t8_element_t       *face_root, *child;
+    double              cref[T8_ECLASS_MAX_CORNERS_2D][3];
+    double              cc[3];
+    int                 num_children, ichild, icorner, found;
+
+    boundary_scheme = t8_forest_get_eclass_scheme (forest, boundary_class);
+    boundary_scheme->t8_element_new (1, &face_root);
+    boundary_scheme->t8_element_new (1, &child);
+    boundary_scheme->t8_element_set_linear_id (face_root, 0, 0);
+    for (j = 0; j < nfc; j++) {
+      cref[j][0] = cref[j][1] = cref[j][2] = 0;
+      boundary_scheme->t8_element_vertex_reference_coords (face_root, j,
+                                                           cref[j]);
+    }
+    num_children = boundary_scheme->t8_element_num_children (face_root);
+    for (j = 0; j < nfc; j++) {
+      /* Find the child touching corner j of the root face element */
+      found = 0;
+      for (ichild = 0; ichild < num_children && !found; ichild++) {
+        boundary_scheme->t8_element_child (face_root, ichild, child);
+        for (icorner = 0;
+             icorner < boundary_scheme->t8_element_num_corners (child);
+             icorner++) {
+          cc[0] = cc[1] = cc[2] = 0;
+          boundary_scheme->t8_element_vertex_reference_coords (child,
+                                                               icorner, cc);
+          if (t8_forest_corner_coords_equal (cc, cref[j])) {
+            found = 1;
+            break;
+          }
+        }
+      }
+      T8_ASSERT (found);
+      /* Transform the corner child and read off the root corner its
+       * image touches */
+      boundary_scheme->t8_element_transform_face (child, child, orientation,
+                                                  sign, is_smaller);
+      sigma[j] = -1;
+      for (icorner = 0;
+           icorner < boundary_scheme->t8_element_num_corners (child)
+           && sigma[j] < 0; icorner++) {
+        cc[0] = cc[1] = cc[2] = 0;
+        boundary_scheme->t8_element_vertex_reference_coords (child, icorner,
+                                                             cc);
+        for (i = 0; i < nfc; i++) {
+          if (t8_forest_corner_coords_equal (cc, cref[i])) {
+            sigma[j] = i;
+            break;
+          }
+        }
+      }
+      T8_ASSERT (sigma[j] >= 0);
+    }
+    boundary_scheme->t8_element_destroy (1, &face_root);
+    boundary_scheme->t8_element_destroy (1, &child);
+  }
+
+  /* The volume reference coordinates of the tree face corners on both
+   * sides, in boundary corner order */
+  ts->t8_element_new (1, &root);
+  ts->t8_element_set_linear_id (root, 0, 0);
+  for (j = 0; j < nfc; j++) {
+    qa[j][0] = qa[j][1] = qa[j][2] = 0;
+    ts->t8_element_vertex_reference_coords (root,
+                                            ts->t8_element_get_face_corner
+                                            (root, tree_face, j), qa[j]);
+  }
+  ts->t8_element_destroy (1, &root);
+  neighbor_scheme = t8_forest_get_eclass_scheme (forest, neigh_eclass);
+  neighbor_scheme->t8_element_new (1, &root);
+  neighbor_scheme->t8_element_set_linear_id (root, 0, 0);
+  for (j = 0; j < nfc; j++) {
+    qb[j][0] = qb[j][1] = qb[j][2] = 0;
+    neighbor_scheme->t8_element_vertex_reference_coords (root,
+                                                         neighbor_scheme->t8_element_get_face_corner
+                                                         (root,
+                                                          tree_neigh_face,
+                                                          j), qb[j]);
+  }
+  neighbor_scheme->t8_element_destroy (1, &root);
+
+  /* Map both points: weights on this side, permuted corners on the
+   * neighbor side */
+  t8_forest_corner_face_weights (qa, nfc, point_a, weights);
+  neigh_a[0] = neigh_a[1] = neigh_a[2] = 0;
+  for (j = 0; j < nfc; j++) {
+    for (i = 0; i < 3; i++) {
+      neigh_a[i] += weights[j] * qb[sigma[j]][i];
+    }
+  }
+  t8_forest_corner_face_weights (qa, nfc, point_b, weights);
+  neigh_b[0] = neigh_b[1] = neigh_b[2] = 0;
+  for (j = 0; j < nfc; j++) {
+    for (i = 0; i < 3; i++) {
+      neigh_b[i] += weights[j] * qb[sigma[j]][i];
+    }
+  }
+  return 1;
+}
+
+/* Compare two t8_locidx_t for qsort */
+static int
+t8_forest_corner_locidx_compare (const void *a, const void *b)
+{
+  const t8_locidx_t   la = *(const t8_locidx_t *) a;
+  const t8_locidx_t   lb = *(const t8_locidx_t *) b;
+
+  return la < lb ? -1 : la > lb;
+}
+
+/* The common engine of the corner and edge queries: collect all local
+ * and ghost leafs whose closed reference cell intersects the segment
+ * [seg_a, seg_b] given in the reference space of tree ltreeid, by a
+ * closure over face hops starting from the given leaf. The indices are
+ * appended to the initialized results array, excluding the leaf
+ * itself. */
+static void
+t8_forest_corner_neighbors_segment (t8_forest_t forest, t8_locidx_t ltreeid,
+                                    const t8_element_t *leaf,
+                                    const double seg_a[3],
+                                    const double seg_b[3],
+                                    sc_array_t *results,
+                                    int forest_is_balanced)
+{
+  t8_forest_corner_front_t *front_entry;
+  t8_eclass_scheme_c *ts, *neigh_scheme;
+  t8_element_t       *element, **neighbor_leafs;
+  t8_tree_t           tree;
+  sc_array_t          visited, front;
+  t8_locidx_t         self_index, neigh_ltreeid, push_ltreeid;
+  t8_locidx_t        *element_indices;
+  t8_locidx_t         num_local_elements;
+  double              dist_a[T8_ECLASS_MAX_FACES];
+  double              dist_b[T8_ECLASS_MAX_FACES];
+  double              ndist_a[T8_ECLASS_MAX_FACES];
+  double              ndist_b[T8_ECLASS_MAX_FACES];
+  double              elem_a[3], elem_b[3], cross_a[3], cross_b[3];
+  double              clip_first, clip_end, face_first, face_end;
+  double              na, nb, drop_first, drop_end;
+  const double       *next_a, *next_b;
+  int                 dim, num_faces, iface, ineigh, num_neighbors;
+  int                *dual_faces;
+  size_t              iz;
+
+  dim = t8_eclass_to_dimension[t8_forest_get_tree_class (forest, ltreeid)];
+  num_local_elements = t8_forest_get_local_num_elements (forest);
+
+  /* Find the forest local index of the query leaf */
+  tree = t8_forest_get_tree (forest, ltreeid);
+  ts = t8_forest_get_eclass_scheme (forest, tree->eclass);
+  self_index = tree->elements_offset
+    + t8_forest_bin_search_lower (&tree->elements,
+                                  ts->t8_element_get_linear_id (leaf,
+                                                                forest->maxlevel),
+                                  forest->maxlevel);
+  T8_ASSERT (0 <= self_index && self_index < num_local_elements);
+
+  sc_array_init (&visited, sizeof (t8_locidx_t));
+  sc_array_init (&front, sizeof (t8_forest_corner_front_t));
+  *(t8_locidx_t *) sc_array_push (&visited) = self_index;
+  front_entry = (t8_forest_corner_front_t *) sc_array_push (&front);
+  front_entry->element_index = self_index;
+  front_entry->ltreeid = ltreeid;
+  memcpy (front_entry->seg_a, seg_a, 3 * sizeof (double));
+  memcpy (front_entry->seg_b, seg_b, 3 * sizeof (double));
+
+  while (front.elem_count > 0) {
+    t8_locidx_t         pop_index, pop_ltreeid;
+
+    front_entry = (t8_forest_corner_front_t *)
+      sc_array_index (&front, front.elem_count - 1);
+    pop_index = front_entry->element_index;
+    pop_ltreeid = front_entry->ltreeid;
+    memcpy (elem_a, front_entry->seg_a, 3 * sizeof (double));
+    memcpy (elem_b, front_entry->seg_b, 3 * sizeof (double));
+    sc_array_pop (&front);
+
+    tree = t8_forest_get_tree (forest, pop_ltreeid);
+    ts = t8_forest_get_eclass_scheme (forest, tree->eclass);
+    element = t8_forest_get_element_in_tree (forest, pop_ltreeid,
+                                             pop_index
+                                             - tree->elements_offset);
+    if (!t8_forest_corner_clip_element (ts, element, dim, elem_a, elem_b,
+                                        dist_a, dist_b, &clip_first,
+                                        &clip_end)) {
+      /* Possible only through tolerance effects at a grazing touch */
+      continue;
+    }
+    num_faces = ts->t8_element_num_faces (element);
+    for (iface = 0; iface < num_faces; iface++) {
+      if (!t8_forest_corner_face_interval (dist_a[iface], dist_b[iface],
+                                           clip_first, clip_end,
+                                           &face_first, &face_end)) {
+        continue;
+      }
+      t8_forest_leaf_face_neighbors (forest, pop_ltreeid, element,
+                                     &neighbor_leafs, iface, &dual_faces,
+                                     &num_neighbors, &element_indices,
+                                     &neigh_scheme, forest_is_balanced);
+      if (num_neighbors == 0) {
+        continue;
+      }
+      /* Express the part of the segment that touches the face in the
+       * coordinates of the neighbor's tree */
+      if (ts->t8_element_is_root_boundary (element, iface)) {
+        int                 i;
+
+        for (i = 0; i < 3; i++) {
+          na = elem_a[i] + face_first * (elem_b[i] - elem_a[i]);
+          nb = elem_a[i] + face_end * (elem_b[i] - elem_a[i]);
+          cross_a[i] = na;
+          cross_b[i] = nb;
+        }
+        if (!t8_forest_corner_transport (forest, pop_ltreeid, element, ts,
+                                         iface, cross_a, cross_b,
+                                         &neigh_ltreeid, cross_a, cross_b)) {
+          /* Inconsistent with num_neighbors > 0, be defensive */
+          neigh_scheme->t8_element_destroy (num_neighbors, neighbor_leafs);
+          T8_FREE (neighbor_leafs);
+          T8_FREE (element_indices);
+          T8_FREE (dual_faces);
+          continue;
+        }
+        next_a = cross_a;
+        next_b = cross_b;
+        push_ltreeid = neigh_ltreeid;
+      }
+      else {
+        next_a = elem_a;
+        next_b = elem_b;
+        push_ltreeid = pop_ltreeid;
+      }
+      for (ineigh = 0; ineigh < num_neighbors; ineigh++) {
+        int                 known = 0;
+
+        for (iz = 0; iz < visited.elem_count; iz++) {
+          if (*(t8_locidx_t *) sc_array_index (&visited, iz)
+              == element_indices[ineigh]) {
+            known = 1;
+            break;
+          }
+        }
+        if (known) {
+          continue;
+        }
+        /* Accept the neighbor if it touches the segment */
+        if (!t8_forest_corner_clip_element (neigh_scheme,
+                                            neighbor_leafs[ineigh], dim,
+                                            next_a, next_b, ndist_a,
+                                            ndist_b, &drop_first,
+                                            &drop_end)) {
+          continue;
+        }
+        *(t8_locidx_t *) sc_array_push (&visited) = element_indices[ineigh];
+        *(t8_locidx_t *) sc_array_push (results) = element_indices[ineigh];
+        if (element_indices[ineigh] < num_local_elements
+            && push_ltreeid >= 0) {
+          front_entry = (t8_forest_corner_front_t *) sc_array_push (&front);
+          front_entry->element_index = element_indices[ineigh];
+          front_entry->ltreeid = push_ltreeid;
+          memcpy (front_entry->seg_a, next_a, 3 * sizeof (double));
+          memcpy (front_entry->seg_b, next_b, 3 * sizeof (double));
+        }
+      }
+      neigh_scheme->t8_element_destroy (num_neighbors, neighbor_leafs);
+      T8_FREE (neighbor_leafs);
+      T8_FREE (element_indices);
+      T8_FREE (dual_faces);
+    }
+  }
+  sc_array_reset (&visited);
+  sc_array_reset (&front);
+}
+
+/* Run the segment engine and return the sorted indices as an allocated
+ * array, the common tail of the public queries. */
+static void
+t8_forest_corner_neighbors_collect (t8_forest_t forest, t8_locidx_t ltreeid,
+                                    const t8_element_t *leaf,
+                                    const double seg_a[3],
+                                    const double seg_b[3],
+                                    int *num_neighbors,
+                                    t8_locidx_t **pelement_indices,
+                                    int forest_is_balanced)
+{
+  sc_array_t          results;
+  t8_locidx_t        *indices;
+  size_t              iz;
+
+  sc_array_init (&results, sizeof (t8_locidx_t));
+  t8_forest_corner_neighbors_segment (forest, ltreeid, leaf, seg_a, seg_b,
+                                      &results, forest_is_balanced);
+  *num_neighbors = (int) results.elem_count;
+  indices = T8_ALLOC (t8_locidx_t, results.elem_count);
+  for (iz = 0; iz < results.elem_count; iz++) {
+    indices[iz] = *(t8_locidx_t *) sc_array_index (&results, iz);
+  }
+  qsort (indices, results.elem_count, sizeof (t8_locidx_t),
+         t8_forest_corner_locidx_compare);
+  *pelement_indices = indices;
+  sc_array_reset (&results);
+}
+
+void
+t8_forest_leaf_corner_neighbors (t8_forest_t forest, t8_locidx_t ltreeid,
+                                 const t8_element_t *leaf, int corner,
+                                 int *num_neighbors,
+                                 t8_locidx_t **pelement_indices,
+                                 int forest_is_balanced)
+{
+  t8_eclass_scheme_c *ts;
+  double              vertex[3] = { 0, 0, 0 };
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  ts = t8_forest_get_eclass_scheme (forest,
+                                    t8_forest_get_tree_class (forest,
+                                                              ltreeid));
+  T8_ASSERT (0 <= corner && corner < ts->t8_element_num_corners (leaf));
+  ts->t8_element_vertex_reference_coords (leaf, corner, vertex);
+  t8_forest_corner_neighbors_collect (forest, ltreeid, leaf, vertex, vertex,
+                                      num_neighbors, pelement_indices,
+                                      forest_is_balanced);
+}
+
+void
+t8_forest_leaf_edge_neighbors (t8_forest_t forest, t8_locidx_t ltreeid,
+                               const t8_element_t *leaf, int corner_a,
+                               int corner_b, int *num_neighbors,
+                               t8_locidx_t **pelement_indices,
+                               int forest_is_balanced)
+{
+  t8_eclass_scheme_c *ts;
+  double              vertex_a[3] = { 0, 0, 0 };
+  double              vertex_b[3] = { 0, 0, 0 };
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  ts = t8_forest_get_eclass_scheme (forest,
+                                    t8_forest_get_tree_class (forest,
+                                                              ltreeid));
+  T8_ASSERT (0 <= corner_a && corner_a < ts->t8_element_num_corners (leaf));
+  T8_ASSERT (0 <= corner_b && corner_b < ts->t8_element_num_corners (leaf));
+  ts->t8_element_vertex_reference_coords (leaf, corner_a, vertex_a);
+  ts->t8_element_vertex_reference_coords (leaf, corner_b, vertex_b);
+  t8_forest_corner_neighbors_collect (forest, ltreeid, leaf, vertex_a,
+                                      vertex_b, num_neighbors,
+                                      pelement_indices, forest_is_balanced);
+}
+
+void
+t8_forest_leaf_corner_neighbors_batch (t8_forest_t forest,
+                                       t8_locidx_t num_queries,
+                                       const t8_locidx_t *lelement_ids,
+                                       const int *corners,
+                                       sc_array_t *neighbor_indices,
+                                       t8_locidx_t *neighbor_offsets,
+                                       int forest_is_balanced)
+{
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *element;
+  t8_locidx_t         iquery, ltreeid;
+  double              vertex[3];
+  size_t              old_count;
+  t8_locidx_t        *flat;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (neighbor_indices->elem_size == sizeof (t8_locidx_t));
+
+  neighbor_offsets[0] = (t8_locidx_t) neighbor_indices->elem_count;
+  for (iquery = 0; iquery < num_queries; iquery++) {
+    element = t8_forest_get_element (forest, lelement_ids[iquery], &ltreeid);
+    T8_ASSERT (element != NULL);
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                ltreeid));
+    vertex[0] = vertex[1] = vertex[2] = 0;
+    ts->t8_element_vertex_reference_coords (element, corners[iquery],
+                                            vertex);
+    old_count = neighbor_indices->elem_count;
+    t8_forest_corner_neighbors_segment (forest, ltreeid, element, vertex,
+                                        vertex, neighbor_indices,
+                                        forest_is_balanced);
+    /* Sort the indices of this query as in the single element variant */
+    if (neighbor_indices->elem_count > old_count) {
+      flat = (t8_locidx_t *) sc_array_index (neighbor_indices, old_count);
+      qsort (flat, neighbor_indices->elem_count - old_count,
+             sizeof (t8_locidx_t), t8_forest_corner_locidx_compare);
+    }
+    neighbor_offsets[iquery + 1] = (t8_locidx_t) neighbor_indices->elem_count;
+  }
+}
@@ -0,0 +1,151 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_corner.h
+ * Corner (vertex) and edge neighbor queries for the leafs of a forest,
+ * complementing the face neighbor queries of t8_forest_general.h.
+ * The neighbors are enumerated by a deduplicated closure over face
+ * hops that cross only the faces containing the queried vertex or edge,
+ * so each adjacent leaf is visited exactly once instead of the
+ * combinatorial blow up of naive repeated face neighbor calls at
+ * corners of deep refinement. Tree boundaries are crossed with the
+ * same transform machinery as the face path, hence the queries work
+ * across coarse mesh faces of hybrid meshes with arbitrary orientation.
+ */
+
+#ifndef T8_FOREST_CORNER_H
+#define T8_FOREST_CORNER_H
+
+#include <t8_forest/t8_forest_general.h>
+
+T8_EXTERN_C_BEGIN ();
+
+/** Compute the leaf corner neighbors of a forest leaf.
+ * All local leafs and ghost leafs that touch the given corner of
+ * \a leaf - including neighbors that share only this vertex, not a
+ * face - are collected by a face hop closure around the vertex.
+ * \param [in]    forest  The forest. Must have a valid ghost layer
+ *                        (if parallel).
+ * \param [in]    ltreeid A local tree id.
+ * \param [in]    leaf    A leaf in tree \a ltreeid of \a forest.
+ * \param [in]    corner  The corner number of \a leaf whose neighbors
+ *                        are searched, 0 <= \a corner <
+ *                        \ref t8_element_num_corners.
+ * \param [out]   num_neighbors On output the number of neighbor leafs.
+ * \param [out]   pelement_indices Unallocated on input. On output the
+ *                        element indices of the neighbor leafs in
+ *                        ascending order, numbered as in
+ *                        \ref t8_forest_leaf_face_neighbors. \a leaf
+ *                        itself is not included. Allocated with
+ *                        T8_ALLOC, the caller takes ownership.
+ * \param [in]    forest_is_balanced True if we know that \a forest is
+ *                        balanced, false otherwise.
+ * \note Only neighbors that are local leafs or part of the ghost layer
+ * are found; with a face ghost layer the diagonal neighbors of remote
+ * processes are exactly the ghost leafs present.
+ * \note Currently \a forest must be balanced.
+ * \note \a forest must be committed before calling this function.
+ */
+void                t8_forest_leaf_corner_neighbors (t8_forest_t forest,
+                                                     t8_locidx_t ltreeid,
+                                                     const t8_element_t *leaf,
+                                                     int corner,
+                                                     int *num_neighbors,
+                                                     t8_locidx_t
+                                                     **pelement_indices,
+                                                     int forest_is_balanced);
+
+/** Compute the leaf edge neighbors of a forest leaf.
+ * All local leafs and ghost leafs that touch the closed line segment
+ * between two corners of \a leaf are collected; for the edge of a
+ * 3D element pass its two end corners. In contrast to intersecting two
+ * corner queries this also finds smaller neighbors that touch only the
+ * interior of the edge.
+ * \param [in]    forest  The forest. Must have a valid ghost layer
+ *                        (if parallel).
+ * \param [in]    ltreeid A local tree id.
+ * \param [in]    leaf    A leaf in tree \a ltreeid of \a forest.
+ * \param [in]    corner_a The corner number of one end of the edge.
+ * \param [in]    corner_b The corner number of the other end.
+ * \param [out]   num_neighbors On output the number of neighbor leafs.
+ * \param [out]   pelement_indices Unallocated on input. On output the
+ *                        element indices of the neighbor leafs in
+ *                        ascending order, as in
+ *                        \ref t8_forest_leaf_corner_neighbors.
+ * \param [in]    forest_is_balanced True if we know that \a forest is
+ *                        balanced, false otherwise.
+ * \note Currently \a forest must be balanced.
+ * \note \a forest must be committed before calling this function.
+ * \see t8_forest_leaf_corner_neighbors
+ */
+void                t8_forest_leaf_edge_neighbors (t8_forest_t forest,
+                                                   t8_locidx_t ltreeid,
+                                                   const t8_element_t *leaf,
+                                                   int corner_a,
+                                                   int corner_b,
+                                                   int *num_neighbors,
+                                                   t8_locidx_t
+                                                   **pelement_indices,
+                                                   int forest_is_balanced);
+
+/** Compute the corner neighbors of many element corners in one pass.
+ * This is the batch variant of \ref t8_forest_leaf_corner_neighbors.
+ * Instead of one allocation per query, the neighbor indices of all
+ * queries are appended to a flat array, analogous to
+ * \ref t8_forest_leaf_face_neighbors_batch.
+ * \param [in]  forest      The forest. Must have a valid ghost layer
+ *                          (if parallel).
+ * \param [in]  num_queries The number of (element, corner) pairs.
+ * \param [in]  lelement_ids The local element indices of the queries,
+ *                          over all trees.
+ * \param [in]  corners     For each query the corner number of the
+ *                          element.
+ * \param [in,out] neighbor_indices An initialized array of t8_locidx_t
+ *                          entries. The neighbor leaf indices of all
+ *                          queries are appended in query order.
+ * \param [out] neighbor_offsets Array of \a num_queries + 1 entries
+ *                          provided by the caller. On output the
+ *                          neighbors of query \a i are the entries
+ *                          neighbor_offsets[i] up to (excluding)
+ *                          neighbor_offsets[i+1] of
+ *                          \a neighbor_indices, counted from the array
+ *                          length on input.
+ * \param [in]  forest_is_balanced True if we know that \a forest is
+ *                          balanced, false otherwise.
+ * \note \a forest must be committed before calling this function.
+ */
+void                t8_forest_leaf_corner_neighbors_batch (t8_forest_t forest,
+                                                           t8_locidx_t
+                                                           num_queries,
+                                                           const t8_locidx_t
+                                                           *lelement_ids,
+                                                           const int *corners,
+                                                           sc_array_t
+                                                           *neighbor_indices,
+                                                           t8_locidx_t
+                                                           *neighbor_offsets,
+                                                           int
+                                                           forest_is_balanced);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_FOREST_CORNER_H */
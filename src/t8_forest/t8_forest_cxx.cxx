@@ -20,6 +20,7 @@
   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 */
 
+#include <float.h>
 #include <sc_statistics.h>
 #include <t8_refcount.h>
 #include <t8_vec.h>
@@ -35,10 +36,16 @@
 #include <t8_element_c_interface.h>
 #include <t8_cmesh/t8_cmesh_trees.h>
 #include <t8_cmesh/t8_cmesh_offset.h>
+#include <t8_geometry/t8_geometry.h>
 #include <t8_geometry/t8_geometry_base.hxx>
+#include <t8_geometry/t8_geometry_helpers.h>
+#include <t8_geometry/t8_geometry_implementations/t8_geometry_linear.hxx>
 #if T8_ENABLE_DEBUG
 #include <t8_geometry/t8_geometry_implementations/t8_geometry_linear.h>
 #endif
+#if defined (SC_ENABLE_PTHREAD)
+#include <t8_thread_pool.h>
+#endif
 
 /* We want to export the whole implementation to be callable from "C" */
 T8_EXTERN_C_BEGIN ();
@@ -197,10 +204,16 @@ t8_forest_compute_maxlevel (t8_forest_t forest)
   forest->maxlevel = -1;
   for (eclass_it = T8_ECLASS_VERTEX; eclass_it < T8_ECLASS_COUNT; eclass_it++) {
     if (forest->cmesh->num_trees_per_eclass[eclass_it] > 0) {
-      /* If there are trees of this class, compute the maxlevel of the class */
-      ts = t8_forest_get_eclass_scheme_before_commit (forest, (t8_eclass_t)
-                                                      eclass_it);
-      maxlevel = ts->t8_element_maxlevel ();
+      /* If there are trees of this class, compute the maxlevel of the class.
+       * The value is cached in the scheme, so the virtual call is only
+       * paid once per scheme instance and class. */
+      if (forest->scheme_cxx->eclass_maxlevel[eclass_it] <= 0) {
+        ts = t8_forest_get_eclass_scheme_before_commit (forest, (t8_eclass_t)
+                                                        eclass_it);
+        forest->scheme_cxx->eclass_maxlevel[eclass_it] =
+          ts->t8_element_maxlevel ();
+      }
+      maxlevel = forest->scheme_cxx->eclass_maxlevel[eclass_it];
       /* Compute the minimum of this level and the stored maxlevel */
       if (forest->maxlevel == -1) {
         forest->maxlevel = maxlevel;
@@ -343,6 +356,153 @@ t8_forest_no_overlap (t8_forest_t forest)
   return 1;
 }
 
+/* An SFC position exchanged in the rank handshake of
+ * t8_forest_validate: a global tree and within it the linear id of a
+ * descendant on the tree's maximum level. Positions at the end of a tree
+ * are normalized to the start of the next tree, so that positions of
+ * different processes compare lexicographically. */
+typedef struct t8_forest_validate_pos
+{
+  t8_gloidx_t         gtree;
+  t8_linearidx_t      id;
+} t8_forest_validate_pos_t;
+
+/* Return whether position a is less than or equal to position b. */
+static int
+t8_forest_validate_pos_leq (const t8_forest_validate_pos_t *a,
+                            const t8_forest_validate_pos_t *b)
+{
+  return a->gtree < b->gtree || (a->gtree == b->gtree && a->id <= b->id);
+}
+
+int
+t8_forest_validate (t8_forest_t forest)
+{
+  t8_locidx_t         num_local_trees, itree, ielem, elems_in_tree;
+  t8_eclass_scheme_c *ts;
+  int                 maxlevel, level;
+  t8_linearidx_t      prev_end, id_first;
+  t8_forest_validate_pos_t my_first, my_end, incoming;
+  int                 failed = 0, failed_global;
+  int                 have_elements, mpiret;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  /* Local pass: walk each tree's elements once and check that their
+   * maxlevel descendant ranges are strictly ascending and disjoint.
+   * Incomplete forests may leave holes, so gaps are not an error. */
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  /* The position before the first and after the last local element */
+  my_first.gtree = my_end.gtree = -1;
+  my_first.id = my_end.id = 0;
+  for (itree = 0; itree < num_local_trees && !failed; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    maxlevel = ts->t8_element_maxlevel ();
+    elems_in_tree = t8_forest_get_tree_num_elements (forest, itree);
+    prev_end = 0;
+    for (ielem = 0; ielem < elems_in_tree; ielem++) {
+      const t8_element_t *element =
+        t8_forest_get_element_in_tree (forest, itree, ielem);
+
+      level = ts->t8_element_level (element);
+      if (level < 0 || level > maxlevel) {
+        failed = 1;
+        break;
+      }
+      id_first = ts->t8_element_get_linear_id (element, maxlevel);
+      if (ielem > 0 && id_first < prev_end) {
+        /* The element starts before its predecessor's range ends, so
+         * the two overlap or are out of order */
+        failed = 1;
+        break;
+      }
+      prev_end = id_first +
+        (t8_linearidx_t) ts->t8_element_count_leafs (element, maxlevel);
+      if (my_first.gtree < 0) {
+        /* The first local element fixes the start position */
+        my_first.gtree = t8_forest_global_tree_id (forest, itree);
+        my_first.id = id_first;
+      }
+    }
+    if (elems_in_tree > 0 && !failed) {
+      /* Track the position after the last element seen so far */
+      if (prev_end ==
+          (t8_linearidx_t)
+          ts->t8_element_count_leafs_from_root (maxlevel)) {
+        my_end.gtree = t8_forest_global_tree_id (forest, itree) + 1;
+        my_end.id = 0;
+      }
+      else {
+        my_end.gtree = t8_forest_global_tree_id (forest, itree);
+        my_end.id = prev_end;
+      }
+    }
+  }
+  have_elements = my_end.gtree >= 0;
+
+  /* Rank handshake: each process passes the position after its last
+   * element to its successor, which checks that its own first element
+   * does not start before it. Processes without elements forward the
+   * position of their predecessor unchanged. */
+  if (forest->mpisize > 1) {
+    if (forest->mpirank > 0 && (!have_elements || failed)) {
+      /* Receive first; the forwarded position must not be our own */
+      mpiret =
+        sc_MPI_Recv (&incoming, sizeof (t8_forest_validate_pos_t),
+                     sc_MPI_BYTE, forest->mpirank - 1,
+                     T8_MPI_VALIDATE_FOREST, forest->mpicomm,
+                     sc_MPI_STATUS_IGNORE);
+      SC_CHECK_MPI (mpiret);
+      my_end = incoming;
+      if (forest->mpirank < forest->mpisize - 1) {
+        mpiret =
+          sc_MPI_Send (&my_end, sizeof (t8_forest_validate_pos_t),
+                       sc_MPI_BYTE, forest->mpirank + 1,
+                       T8_MPI_VALIDATE_FOREST, forest->mpicomm);
+        SC_CHECK_MPI (mpiret);
+      }
+    }
+    else {
+      /* Post the send of our end position before receiving from the
+       * predecessor, so ranks with elements handshake concurrently */
+      sc_MPI_Request      request = sc_MPI_REQUEST_NULL;
+
+      if (forest->mpirank < forest->mpisize - 1) {
+        mpiret =
+          sc_MPI_Isend (&my_end, sizeof (t8_forest_validate_pos_t),
+                        sc_MPI_BYTE, forest->mpirank + 1,
+                        T8_MPI_VALIDATE_FOREST, forest->mpicomm, &request);
+        SC_CHECK_MPI (mpiret);
+      }
+      if (forest->mpirank > 0) {
+        mpiret =
+          sc_MPI_Recv (&incoming, sizeof (t8_forest_validate_pos_t),
+                       sc_MPI_BYTE, forest->mpirank - 1,
+                       T8_MPI_VALIDATE_FOREST, forest->mpicomm,
+                       sc_MPI_STATUS_IGNORE);
+        SC_CHECK_MPI (mpiret);
+        if (!t8_forest_validate_pos_leq (&incoming, &my_first)) {
+          /* Our first element starts before the predecessor's range
+           * ends */
+          failed = 1;
+        }
+      }
+      if (forest->mpirank < forest->mpisize - 1) {
+        mpiret = sc_MPI_Wait (&request, sc_MPI_STATUS_IGNORE);
+        SC_CHECK_MPI (mpiret);
+      }
+    }
+  }
+
+  /* Agree on the verdict, so all processes return the same value */
+  mpiret = sc_MPI_Allreduce (&failed, &failed_global, 1, sc_MPI_INT,
+                             sc_MPI_MAX, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  return !failed_global;
+}
+
 int
 t8_forest_is_equal (t8_forest_t forest_a, t8_forest_t forest_b)
 {
@@ -397,6 +557,107 @@ t8_forest_is_equal (t8_forest_t forest_a, t8_forest_t forest_b)
   return 1;
 }
 
+/* Compute a hash of the (level, linear id) pairs of the elements of a
+ * local tree. Two trees with the same leaf sequence hash equally, so
+ * equal hashes short-circuit the element-wise comparison in
+ * t8_forest_diff and the revalidation of search cursors. We use the
+ * 64 bit Fowler-Noll-Vo multiply-xor scheme. */
+uint64_t
+t8_forest_tree_leaf_checksum (t8_forest_t forest, t8_locidx_t ltree_id,
+                              t8_eclass_scheme_c *ts)
+{
+  uint64_t            hash = 14695981039346656037ULL;
+  t8_locidx_t         num_elements, ielem;
+  const t8_element_t *element;
+  int                 level;
+
+  num_elements = t8_forest_get_tree_num_elements (forest, ltree_id);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    element = t8_forest_get_element_in_tree (forest, ltree_id, ielem);
+    level = ts->t8_element_level (element);
+    hash = (hash ^ (uint64_t) level) * 1099511628211ULL;
+    hash = (hash ^ (uint64_t) ts->t8_element_get_linear_id (element, level))
+      * 1099511628211ULL;
+  }
+  return hash;
+}
+
+int
+t8_forest_diff (t8_forest_t forest_a, t8_forest_t forest_b,
+                sc_array_t *diff_ranges)
+{
+  t8_locidx_t         num_local_trees;
+  t8_locidx_t         elems_in_tree_a, elems_in_tree_b, elems_min;
+  t8_locidx_t         prefix, suffix;
+  t8_locidx_t         itree;
+  t8_element_t       *elem_a, *elem_b;
+  t8_eclass_scheme_c *ts;
+  t8_forest_diff_range_t *range;
+
+  T8_ASSERT (t8_forest_is_committed (forest_a));
+  T8_ASSERT (t8_forest_is_committed (forest_b));
+  T8_ASSERT (diff_ranges != NULL
+             && diff_ranges->elem_size == sizeof (t8_forest_diff_range_t));
+  /* Both forests must have the same local trees with the same schemes */
+  T8_ASSERT (t8_forest_get_num_local_trees (forest_a) ==
+             t8_forest_get_num_local_trees (forest_b));
+
+  sc_array_resize (diff_ranges, 0);
+  num_local_trees = t8_forest_get_num_local_trees (forest_a);
+  for (itree = 0; itree < num_local_trees; itree++) {
+    ts =
+      t8_forest_get_eclass_scheme (forest_a,
+                                   t8_forest_get_tree_class (forest_a,
+                                                             itree));
+    T8_ASSERT (ts ==
+               t8_forest_get_eclass_scheme (forest_b,
+                                            t8_forest_get_tree_class
+                                            (forest_b, itree)));
+    elems_in_tree_a = t8_forest_get_tree_num_elements (forest_a, itree);
+    elems_in_tree_b = t8_forest_get_tree_num_elements (forest_b, itree);
+    if (elems_in_tree_a == elems_in_tree_b
+        && t8_forest_tree_leaf_checksum (forest_a, itree, ts) ==
+        t8_forest_tree_leaf_checksum (forest_b, itree, ts)) {
+      /* The leaf sequences hash equally, the tree is unchanged */
+      continue;
+    }
+    /* Skip the identical leading elements */
+    elems_min = SC_MIN (elems_in_tree_a, elems_in_tree_b);
+    prefix = 0;
+    while (prefix < elems_min) {
+      elem_a = t8_forest_get_element_in_tree (forest_a, itree, prefix);
+      elem_b = t8_forest_get_element_in_tree (forest_b, itree, prefix);
+      if (ts->t8_element_compare (elem_a, elem_b)) {
+        break;
+      }
+      prefix++;
+    }
+    /* Skip the identical trailing elements */
+    suffix = 0;
+    while (suffix < elems_min - prefix) {
+      elem_a = t8_forest_get_element_in_tree (forest_a, itree,
+                                              elems_in_tree_a - 1 - suffix);
+      elem_b = t8_forest_get_element_in_tree (forest_b, itree,
+                                              elems_in_tree_b - 1 - suffix);
+      if (ts->t8_element_compare (elem_a, elem_b)) {
+        break;
+      }
+      suffix++;
+    }
+    if (elems_in_tree_a - prefix - suffix > 0
+        || elems_in_tree_b - prefix - suffix > 0) {
+      /* Report the changed range of this tree */
+      range = (t8_forest_diff_range_t *) sc_array_push (diff_ranges);
+      range->ltree_id = itree;
+      range->first_a = prefix;
+      range->num_a = elems_in_tree_a - prefix - suffix;
+      range->first_b = prefix;
+      range->num_b = elems_in_tree_b - prefix - suffix;
+    }
+  }
+  return diff_ranges->elem_count == 0;
+}
+
 /* given an element in a coarse tree, the corner coordinates of the coarse tree
  * and a corner number of the element compute the coordinates of that corner
  * within the coarse tree.
@@ -421,6 +682,16 @@ t8_forest_element_coordinate (t8_forest_t forest, t8_locidx_t ltree_id,
   /* Compute the vertex coordinates inside [0,1]^dim reference cube. */
   ts->t8_element_vertex_reference_coords (element, corner_number,
                                           vertex_coords);
+  if (forest->geom_cache != NULL
+      && forest->geom_cache->tree_vertices[ltree_id] != NULL) {
+    /* The tree has the linear vertex geometry. Evaluate it directly from
+     * the cached tree vertices and skip the per element geometry and
+     * attribute resolution. */
+    t8_geom_compute_linear_geometry (tree_class,
+                                     forest->geom_cache->tree_vertices
+                                     [ltree_id], vertex_coords, coordinates);
+    return;
+  }
   /* Compute the global tree id */
   gtreeid = t8_forest_global_tree_id (forest, ltree_id);
   /* Get the cmesh */
@@ -429,6 +700,130 @@ t8_forest_element_coordinate (t8_forest_t forest, t8_locidx_t ltree_id,
   t8_geometry_evaluate (cmesh, gtreeid, vertex_coords, coordinates);
 }
 
+void
+t8_forest_coordinate_quantization_grid (t8_forest_t forest,
+                                        double box_min[3], double step[3])
+{
+  t8_locidx_t         itree, num_local_trees, lctreeid;
+  t8_eclass_t         tree_class;
+  t8_cmesh_t          cmesh;
+  /* The minima and the negated maxima, so one MIN reduction suffices */
+  double              box[6];
+  double              coords[3], ref_coords[3];
+  double              extent, num_steps;
+  const double       *vertices;
+  int                 ivertex, num_vertices, idim;
+  int                 mpiret;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (forest->coord_quant_bits > 0);
+
+  for (idim = 0; idim < 3; idim++) {
+    box[idim] = DBL_MAX;
+    box[3 + idim] = DBL_MAX;
+  }
+  cmesh = t8_forest_get_cmesh (forest);
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0; itree < num_local_trees; itree++) {
+    tree_class = t8_forest_get_tree_class (forest, itree);
+    num_vertices = t8_eclass_num_vertices[tree_class];
+    lctreeid = t8_forest_ltreeid_to_cmesh_ltreeid (forest, itree);
+    vertices = t8_cmesh_get_tree_vertices (cmesh, lctreeid);
+    for (ivertex = 0; ivertex < num_vertices; ivertex++) {
+      if (vertices != NULL) {
+        coords[0] = vertices[3 * ivertex];
+        coords[1] = vertices[3 * ivertex + 1];
+        coords[2] = vertices[3 * ivertex + 2];
+      }
+      else {
+        /* The tree carries no vertex attribute, evaluate its geometry at
+         * the reference corner instead */
+        memcpy (ref_coords,
+                t8_element_corner_ref_coords[tree_class][ivertex],
+                3 * sizeof (double));
+        t8_geometry_evaluate (cmesh,
+                              t8_forest_global_tree_id (forest, itree),
+                              ref_coords, coords);
+      }
+      for (idim = 0; idim < 3; idim++) {
+        box[idim] = SC_MIN (box[idim], coords[idim]);
+        box[3 + idim] = SC_MIN (box[3 + idim], -coords[idim]);
+      }
+    }
+  }
+  /* All processes must agree on the grid */
+  mpiret = sc_MPI_Allreduce (sc_MPI_IN_PLACE, box, 6, sc_MPI_DOUBLE,
+                             sc_MPI_MIN, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  num_steps = (double) ((1 << forest->coord_quant_bits) - 1);
+  for (idim = 0; idim < 3; idim++) {
+    box_min[idim] = box[idim];
+    extent = -box[3 + idim] - box[idim];
+    /* A flat dimension needs no quantization steps */
+    step[idim] = extent > 0 ? extent / num_steps : 0;
+  }
+}
+
+t8_locidx_t
+t8_forest_element_coordinates_all (t8_forest_t forest, t8_locidx_t ltreeid,
+                                   double *x, double *y, double *z)
+{
+  t8_element_array_t *telements;
+  t8_eclass_scheme_c *ts;
+  t8_eclass_t         tree_class;
+  const double       *tree_vertices = NULL;
+  t8_gloidx_t         gtreeid = -1;
+  t8_cmesh_t          cmesh = NULL;
+  t8_locidx_t         num_elements, ielem;
+  t8_locidx_t         num_written = 0;
+  double              vertex_coords[3];
+  double              coordinates[3];
+  int                 icorner, num_corners;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= ltreeid
+             && ltreeid < t8_forest_get_num_local_trees (forest));
+
+  tree_class = t8_forest_get_tree_class (forest, ltreeid);
+  ts = t8_forest_get_eclass_scheme (forest, tree_class);
+  telements = t8_forest_tree_get_leafs (forest, ltreeid);
+  num_elements = (t8_locidx_t) t8_element_array_get_count (telements);
+
+  /* Resolve the geometry of the tree once instead of once per corner.
+   * The per corner work then reduces to the reference coordinates and the
+   * geometry evaluation itself. */
+  if (forest->geom_cache != NULL
+      && forest->geom_cache->tree_vertices[ltreeid] != NULL) {
+    tree_vertices = forest->geom_cache->tree_vertices[ltreeid];
+  }
+  else {
+    gtreeid = t8_forest_global_tree_id (forest, ltreeid);
+    cmesh = t8_forest_get_cmesh (forest);
+  }
+
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    const t8_element_t *element =
+      t8_element_array_index_locidx (telements, ielem);
+    num_corners = ts->t8_element_num_corners (element);
+    for (icorner = 0; icorner < num_corners; icorner++) {
+      ts->t8_element_vertex_reference_coords (element, icorner,
+                                              vertex_coords);
+      if (tree_vertices != NULL) {
+        t8_geom_compute_linear_geometry (tree_class, tree_vertices,
+                                         vertex_coords, coordinates);
+      }
+      else {
+        t8_geometry_evaluate (cmesh, gtreeid, vertex_coords, coordinates);
+      }
+      x[num_written] = coordinates[0];
+      y[num_written] = coordinates[1];
+      z[num_written] = coordinates[2];
+      num_written++;
+    }
+  }
+  return num_written;
+}
+
 void
 t8_forest_element_from_ref_coords (t8_forest_t forest, t8_locidx_t ltreeid,
                                    const t8_element_t *element,
@@ -442,11 +837,62 @@ t8_forest_element_from_ref_coords (t8_forest_t forest, t8_locidx_t ltreeid,
     t8_forest_get_eclass_scheme (forest, tree_class);
   scheme->t8_element_reference_coords (element, ref_coords, NULL,
                                        tree_ref_coords);
+  if (forest->geom_cache != NULL
+      && forest->geom_cache->tree_vertices[ltreeid] != NULL) {
+    /* Evaluate the linear geometry from the cached tree vertices */
+    t8_geom_compute_linear_geometry (tree_class,
+                                     forest->geom_cache->tree_vertices
+                                     [ltreeid], tree_ref_coords, coords_out);
+    return;
+  }
   const t8_cmesh_t    cmesh = t8_forest_get_cmesh (forest);
   const t8_gloidx_t   gtreeid = t8_forest_global_tree_id (forest, ltreeid);
   t8_geometry_evaluate (cmesh, gtreeid, tree_ref_coords, coords_out);
 }
 
+/* Gather the coordinates of all corners of one element into a contiguous
+ * block of 3D vectors, resolving the tree's geometry once instead of once
+ * per corner as \ref t8_forest_element_coordinate would. The gathered tile
+ * feeds the vectorized passes of \ref t8_forest_element_diam, the bounding
+ * box construction and the point inside tests. */
+static void
+t8_forest_element_corner_coords (t8_forest_t forest, t8_locidx_t ltreeid,
+                                 const t8_element_t *element,
+                                 t8_eclass_scheme_c *ts, int num_corners,
+                                 double *corner_coords)
+{
+  const t8_eclass_t   tree_class = t8_forest_get_tree_class (forest,
+                                                             ltreeid);
+  const double       *tree_vertices = NULL;
+  t8_gloidx_t         gtreeid = -1;
+  t8_cmesh_t          cmesh = NULL;
+  double              vertex_coords[3];
+  int                 icorner;
+
+  T8_ASSERT (num_corners <= T8_ECLASS_MAX_CORNERS);
+  if (forest->geom_cache != NULL
+      && forest->geom_cache->tree_vertices[ltreeid] != NULL) {
+    tree_vertices = forest->geom_cache->tree_vertices[ltreeid];
+  }
+  else {
+    gtreeid = t8_forest_global_tree_id (forest, ltreeid);
+    cmesh = t8_forest_get_cmesh (forest);
+  }
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    ts->t8_element_vertex_reference_coords (element, icorner,
+                                            vertex_coords);
+    if (tree_vertices != NULL) {
+      t8_geom_compute_linear_geometry (tree_class, tree_vertices,
+                                       vertex_coords,
+                                       corner_coords + 3 * icorner);
+    }
+    else {
+      t8_geometry_evaluate (cmesh, gtreeid, vertex_coords,
+                            corner_coords + 3 * icorner);
+    }
+  }
+}
+
 /* Compute the diameter of an element. */
 double
 t8_forest_element_diam (t8_forest_t forest, t8_locidx_t ltreeid,
@@ -455,7 +901,9 @@ t8_forest_element_diam (t8_forest_t forest, t8_locidx_t ltreeid,
   t8_eclass_t         tree_class;
   t8_eclass_scheme_c *ts;
 
-  double              centroid[3], coordinates[3];
+  double              centroid[3];
+  double              coordinates[T8_ECLASS_MAX_CORNERS][3];
+  double              dists[T8_ECLASS_MAX_CORNERS];
   double              dist;
   int                 i, num_corners;
 
@@ -469,15 +917,19 @@ t8_forest_element_diam (t8_forest_t forest, t8_locidx_t ltreeid,
    * from the vertices to the centroid. */
 
   num_corners = ts->t8_element_num_corners (element);
+  T8_ASSERT (num_corners <= T8_ECLASS_MAX_CORNERS);
 
   /* Compute the centroid */
   t8_forest_element_centroid (forest, ltreeid, element, centroid);
+  /* Gather the corner coordinates into one contiguous block, resolving
+   * the geometry once, and compute the distances to the centroid in a
+   * single vectorizable pass. */
+  t8_forest_element_corner_coords (forest, ltreeid, element, ts,
+                                   num_corners, coordinates[0]);
+  t8_vec_dist_n (coordinates[0], centroid, dists, num_corners);
   dist = 0;
   for (i = 0; i < num_corners; i++) {
-    /* Compute coordinates of this corner */
-    t8_forest_element_coordinate (forest, ltreeid, element, i, coordinates);
-    /* Compute the distance to the midpoint */
-    dist += t8_vec_dist (coordinates, centroid);
+    dist += dists[i];
   }
   /* We approximate the diameter as twice the average of the distances
    * from the vertices to the centroid. */
@@ -1255,11 +1707,9 @@ t8_forest_element_point_inside (t8_forest_t forest, t8_locidx_t ltreeid,
   t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, tree_class);
   const t8_element_shape_t element_shape = ts->t8_element_shape (element);
   const int           num_faces = ts->t8_element_num_faces (element);
+  const int           num_corners = ts->t8_element_num_corners (element);
+  double              corner_coords[T8_ECLASS_MAX_CORNERS][3];
   int                 iface;
-  int                 afacecorner;
-  double              face_normal[3];
-  double              dot_product;
-  double              point_on_face[3];
 
 #if T8_ENABLE_DEBUG
   /* Check whether the provided geometry is linear */
@@ -1272,17 +1722,18 @@ t8_forest_element_point_inside (t8_forest_t forest, t8_locidx_t ltreeid,
   T8_ASSERT (t8_geom_is_linear (geometry));
 #endif
 
+  /* Gather the coordinates of all corners into one contiguous tile with a
+   * single geometry resolution. All shape cases below work on the tile. */
+  t8_forest_element_corner_coords (forest, ltreeid, element, ts,
+                                   num_corners, corner_coords[0]);
+
   switch (element_shape) {
   case T8_ECLASS_VERTEX:
     {
       /* A point is 'inside' a vertex if they have the same coordinates */
-      double              vertex_coords[3];
-      /* Get the vertex coordinates */
-      t8_forest_element_coordinate (forest, ltreeid, element,
-                                    0, vertex_coords);
       /* Check whether the point and the vertex are within tolerance distance
        * to each other */
-      if (t8_vec_dist (vertex_coords, point) > tolerance) {
+      if (t8_vec_dist (corner_coords[0], point) > tolerance) {
         return 0;
       }
       return 1;
@@ -1295,16 +1746,13 @@ t8_forest_element_point_inside (t8_forest_t forest, t8_locidx_t ltreeid,
        * (p_1 - p_0)x = p - p_0
        * has a solution x with 0 <= x <= 1
        */
-      double              p_0[3], v[3], b[3];
+      const double       *p_0 = corner_coords[0];
+      double              v[3], b[3];
       double              x = 0;        /* Initialized to prevent compiler warning. */
       int                 i;
 
-      /* Compute the vertex coordinates of the line */
-      t8_forest_element_coordinate (forest, ltreeid, element, 0, p_0);
-      /* v = p_1 */
-      t8_forest_element_coordinate (forest, ltreeid, element, 1, v);
       /* v = p_1 - p_0 */
-      t8_vec_axpy (p_0, v, -1);
+      t8_vec_axpyz (p_0, corner_coords[1], v, -1);
       /* b = p - p_0 */
       t8_vec_axpyz (p_0, point, b, -1);
 
@@ -1347,13 +1795,11 @@ t8_forest_element_point_inside (t8_forest_t forest, t8_locidx_t ltreeid,
   case T8_ECLASS_QUAD:
     {
       /* We divide the quad in two triangles and use the triangle check. */
-      double              p_0[3], p_1[3], p_2[3], p_3[3];
+      const double       *p_0 = corner_coords[0];
+      const double       *p_1 = corner_coords[1];
+      const double       *p_2 = corner_coords[2];
+      const double       *p_3 = corner_coords[3];
       int                 point_inside = 0;
-      /* Compute the vertex coordinates of the quad */
-      t8_forest_element_coordinate (forest, ltreeid, element, 0, p_0);
-      t8_forest_element_coordinate (forest, ltreeid, element, 1, p_1);
-      t8_forest_element_coordinate (forest, ltreeid, element, 2, p_2);
-      t8_forest_element_coordinate (forest, ltreeid, element, 3, p_3);
 
 #if T8_ENABLE_DEBUG
       /* Issue a warning if the points of the quad do not lie in the same plane */
@@ -1377,14 +1823,8 @@ t8_forest_element_point_inside (t8_forest_t forest, t8_locidx_t ltreeid,
     }
   case T8_ECLASS_TRIANGLE:
     {
-      double              p_0[3], p_1[3], p_2[3];
-
-      /* Compute the vertex coordinates of the triangle */
-      t8_forest_element_coordinate (forest, ltreeid, element, 0, p_0);
-      t8_forest_element_coordinate (forest, ltreeid, element, 1, p_1);
-      t8_forest_element_coordinate (forest, ltreeid, element, 2, p_2);
-
-      return t8_triangle_point_inside (p_0, p_1, p_2, point, tolerance);
+      return t8_triangle_point_inside (corner_coords[0], corner_coords[1],
+                                       corner_coords[2], point, tolerance);
     }
   case T8_ECLASS_TET:
   case T8_ECLASS_HEX:
@@ -1406,22 +1846,60 @@ t8_forest_element_point_inside (t8_forest_t forest, t8_locidx_t ltreeid,
      *  <x - p, n> >= 0
      **/
 
-    for (iface = 0; iface < num_faces; ++iface) {
-      /* Compute the outer normal n of the face */
-      t8_forest_element_face_normal (forest, ltreeid, element, iface,
-                                     face_normal);
-      /* Compute a point x on the face */
-      afacecorner = ts->t8_element_get_face_corner (element, iface, 0);
-      t8_forest_element_coordinate (forest, ltreeid, element,
-                                    afacecorner, point_on_face);
-
-      /* Set x = x - p */
-      t8_vec_axpy (point, point_on_face, -1);
-      /* Compute <x-p,n> */
-      dot_product = t8_vec_dot (point_on_face, face_normal);
-      if (dot_product < 0) {
-        /* The point is outside of the element */
-        return 0;
+    {
+      /* As in \ref t8_forest_element_face_normal we construct the normal
+       * of each face as the cross product of two spanning vectors built
+       * from the face corners 0, 1 and 2 and orient it outwards with the
+       * element centroid. We work on the gathered corner tile, compute
+       * all cross products in one batched call and skip the
+       * normalization, since only the sign of the dot products below
+       * enters the decision. */
+      double              centroid[3];
+      double              spans_a[T8_ECLASS_MAX_FACES][3];
+      double              spans_b[T8_ECLASS_MAX_FACES][3];
+      double              normals[T8_ECLASS_MAX_FACES][3];
+      int                 face_corner[T8_ECLASS_MAX_FACES];
+      const double       *x_0, *normal;
+      double              c_n, dot_product;
+      int                 icorner;
+
+      T8_ASSERT (num_faces <= T8_ECLASS_MAX_FACES);
+      /* Compute the centroid of the element once for all faces */
+      t8_forest_element_centroid (forest, ltreeid, element, centroid);
+      for (iface = 0; iface < num_faces; ++iface) {
+        /* Build the two spanning vectors of the face from its corners */
+        face_corner[iface] =
+          ts->t8_element_get_face_corner (element, iface, 0);
+        icorner = ts->t8_element_get_face_corner (element, iface, 1);
+        t8_vec_axpyz (corner_coords[face_corner[iface]],
+                      corner_coords[icorner], spans_a[iface], -1);
+        icorner = ts->t8_element_get_face_corner (element, iface, 2);
+        t8_vec_axpyz (corner_coords[face_corner[iface]],
+                      corner_coords[icorner], spans_b[iface], -1);
+      }
+      /* Compute the (unnormalized) normals of all faces at once */
+      t8_vec_cross_n (spans_a[0], spans_b[0], normals[0], num_faces);
+      for (iface = 0; iface < num_faces; ++iface) {
+        x_0 = corner_coords[face_corner[iface]];
+        normal = normals[iface];
+        /* The normal points inwards iff <c - x, n> > 0, with c the
+         * centroid and x the face corner 0 */
+        c_n = (centroid[0] - x_0[0]) * normal[0]
+          + (centroid[1] - x_0[1]) * normal[1]
+          + (centroid[2] - x_0[2]) * normal[2];
+        /* Compute <x - p, n> */
+        dot_product = (x_0[0] - point[0]) * normal[0]
+          + (x_0[1] - point[1]) * normal[1]
+          + (x_0[2] - point[2]) * normal[2];
+        if (c_n > 0) {
+          /* Flip the sign such that dot_product refers to the outer
+           * normal */
+          dot_product = -dot_product;
+        }
+        if (dot_product < 0) {
+          /* The point is outside of the element */
+          return 0;
+        }
       }
     }
     /* For all faces the dot product with the outer normal is <= 0.
@@ -1432,14 +1910,194 @@ t8_forest_element_point_inside (t8_forest_t forest, t8_locidx_t ltreeid,
   }
 }
 
-/* For each tree in a forest compute its first and last descendant */
+/* Locate the leaf of one local tree that contains a point, or return -1.
+ * Instead of testing every leaf, we descend from the tree root: on each
+ * level we pick the child that contains the point and look up the leaf
+ * array by the linear id of the child's first descendant with
+ * \ref t8_forest_bin_search_lower. The descent stops as soon as the found
+ * leaf covers the whole region of the current element, so the cost is
+ * O(maxlevel) point tests and binary searches instead of one test per
+ * leaf. All short-lived elements are carved from the forest's scratch
+ * arena, so no memory is allocated per query. */
+static t8_locidx_t
+t8_forest_find_point_owner_in_tree (t8_forest_t forest, t8_locidx_t ltreeid,
+                                    const double point[3],
+                                    const double tolerance)
+{
+  t8_element_array_t *leaf_elements;
+  t8_eclass_scheme_c *ts;
+  t8_element_scratch_t *scratch;
+  t8_element_scratch_mark_t scratch_mark;
+  t8_element_t       *ancestor, *first_desc, **children;
+  const t8_element_t *leaf;
+  t8_linearidx_t      desc_id;
+  t8_locidx_t         index, result = -1;
+  int                 num_children, ichild, found_child;
+
+  leaf_elements = t8_forest_tree_get_leafs (forest, ltreeid);
+  if (t8_element_array_get_count (leaf_elements) == 0) {
+    return -1;
+  }
+  ts =
+    t8_forest_get_eclass_scheme (forest,
+                                 t8_forest_get_tree_class (forest, ltreeid));
+  scratch = t8_forest_get_element_scratch (forest);
+  scratch_mark = t8_element_scratch_begin (scratch);
+  t8_element_scratch_elements (scratch, ts, 1, &ancestor);
+  t8_element_scratch_elements (scratch, ts, 1, &first_desc);
+  children = NULL;
+  /* Start the descent at the tree root */
+  ts->t8_element_set_linear_id (ancestor, 0, 0);
+  for (;;) {
+    /* Look up the leaf whose range contains the first descendant of the
+     * current element. */
+    ts->t8_element_first_descendant (ancestor, first_desc, forest->maxlevel);
+    desc_id = ts->t8_element_get_linear_id (first_desc, forest->maxlevel);
+    index = t8_forest_bin_search_lower (leaf_elements, desc_id,
+                                        forest->maxlevel);
+    if (index < 0) {
+      /* The tree's leafs all have larger ids, the point region is not
+       * covered by this (possibly incomplete) tree. */
+      break;
+    }
+    leaf = t8_element_array_index_locidx (leaf_elements, index);
+    if (ts->t8_element_level (leaf) <= ts->t8_element_level (ancestor)) {
+      /* The leaf covers the whole region of the current element, so it is
+       * the only candidate. Verify, since the point may lie in a hole of
+       * an incomplete tree or outside a non-convex tree. */
+      if (t8_forest_element_point_inside (forest, ltreeid, leaf, point,
+                                          tolerance)) {
+        result = index;
+      }
+      break;
+    }
+    if (ts->t8_element_level (ancestor) >= forest->maxlevel) {
+      break;
+    }
+    /* Descend into the child that contains the point */
+    num_children = ts->t8_element_num_children (ancestor);
+    if (children == NULL) {
+      /* The number of children cannot grow during the descent, carving
+       * once suffices. */
+      children = T8_ALLOC (t8_element_t *, num_children);
+      t8_element_scratch_elements (scratch, ts, num_children, children);
+    }
+    ts->t8_element_children (ancestor, num_children, children);
+    found_child = -1;
+    for (ichild = 0; ichild < num_children; ichild++) {
+      if (t8_forest_element_point_inside (forest, ltreeid, children[ichild],
+                                          point, tolerance)) {
+        found_child = ichild;
+        break;
+      }
+    }
+    if (found_child < 0) {
+      /* No child contains the point, it lies outside of this tree. */
+      break;
+    }
+    ts->t8_element_copy (children[found_child], ancestor);
+  }
+  t8_element_scratch_end (scratch, scratch_mark);
+  T8_FREE (children);
+  return result;
+}
+
+t8_locidx_t
+t8_forest_find_point_owners (t8_forest_t forest, const double *points,
+                             t8_locidx_t num_points, const double tolerance,
+                             t8_locidx_t *element_indices)
+{
+  const t8_locidx_t   num_local_trees =
+    t8_forest_get_num_local_trees (forest);
+  double             *tree_bounds;
+  t8_locidx_t         itree, ipoint, index;
+  t8_locidx_t         num_found = 0;
+  int                 icoord;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (num_points == 0 || points != NULL);
+  T8_ASSERT (num_points == 0 || element_indices != NULL);
+  T8_ASSERT (tolerance > 0);
+
+  /* Compute the bounding box of each local tree once. For trees with the
+   * linear vertex geometry it bounds the tree exactly and rejects points
+   * without any per element work. */
+  tree_bounds = T8_ALLOC (double, 6 * num_local_trees);
+  for (itree = 0; itree < num_local_trees; itree++) {
+    const t8_eclass_t   tree_class =
+      t8_forest_get_tree_class (forest, itree);
+    const int           num_vertices = t8_eclass_num_vertices[tree_class];
+    const double       *vertices = NULL;
+    double             *bounds = tree_bounds + 6 * itree;
+    int                 ivertex;
+
+    if (forest->geom_cache != NULL
+        && forest->geom_cache->tree_vertices[itree] != NULL) {
+      vertices = forest->geom_cache->tree_vertices[itree];
+    }
+    if (vertices == NULL) {
+      /* The tree vertices are not cached (no geometry cache or not the
+       * linear geometry), disable the bounding box filter for this tree. */
+      bounds[0] = bounds[2] = bounds[4] = -DBL_MAX;
+      bounds[1] = bounds[3] = bounds[5] = DBL_MAX;
+      continue;
+    }
+    for (icoord = 0; icoord < 3; icoord++) {
+      bounds[2 * icoord] = DBL_MAX;
+      bounds[2 * icoord + 1] = -DBL_MAX;
+    }
+    for (ivertex = 0; ivertex < num_vertices; ivertex++) {
+      for (icoord = 0; icoord < 3; icoord++) {
+        const double        coord = vertices[3 * ivertex + icoord];
+        bounds[2 * icoord] = SC_MIN (bounds[2 * icoord], coord);
+        bounds[2 * icoord + 1] = SC_MAX (bounds[2 * icoord + 1], coord);
+      }
+    }
+  }
+
+  for (ipoint = 0; ipoint < num_points; ipoint++) {
+    const double       *point = points + 3 * ipoint;
+
+    element_indices[ipoint] = -1;
+    for (itree = 0; itree < num_local_trees; itree++) {
+      const double       *bounds = tree_bounds + 6 * itree;
+      int                 outside = 0;
+
+      for (icoord = 0; icoord < 3; icoord++) {
+        if (point[icoord] < bounds[2 * icoord] - tolerance
+            || point[icoord] > bounds[2 * icoord + 1] + tolerance) {
+          outside = 1;
+          break;
+        }
+      }
+      if (outside) {
+        continue;
+      }
+      index =
+        t8_forest_find_point_owner_in_tree (forest, itree, point, tolerance);
+      if (index >= 0) {
+        element_indices[ipoint] =
+          t8_forest_get_tree_element_offset (forest, itree) + index;
+        num_found++;
+        break;
+      }
+    }
+  }
+  T8_FREE (tree_bounds);
+  return num_found;
+}
+
+/* For each tree in a forest invalidate its first and last descendant.
+ * The tree structs are copied from recycled or source storage, so the
+ * descendant pointers hold stale values after commit. The descendants
+ * themselves are computed lazily on the first access per tree by
+ * \ref t8_forest_tree_ensure_desc, so commit only pays a pointer sweep
+ * instead of two scheme calls and element allocations per tree. */
 void
 t8_forest_compute_desc (t8_forest_t forest)
 {
-  t8_locidx_t         itree_id, num_trees, num_elements;
+  t8_locidx_t         itree_id, num_trees;
   t8_tree_t           itree;
-  t8_eclass_scheme_c *ts;
-  t8_element_t       *element;
 
   T8_ASSERT (forest != NULL);
   /* Iterate over all trees */
@@ -1447,36 +2105,136 @@ t8_forest_compute_desc (t8_forest_t forest)
   for (itree_id = 0; itree_id < num_trees; itree_id++) {
     /* get a pointer to the tree */
     itree = t8_forest_get_tree (forest, itree_id);
-    if (t8_forest_get_tree_element_count (itree) < 1) {
-      /* if local tree is empty */
-      T8_ASSERT (forest->incomplete_trees);
-      itree->first_desc = NULL;
-      itree->last_desc = NULL;
+    itree->first_desc = NULL;
+    itree->last_desc = NULL;
+  }
+}
+
+/* Compute the first and last descendant of one tree on the first access
+ * and cache them in the tree struct. Deferred from
+ * \ref t8_forest_compute_desc. */
+static void
+t8_forest_tree_ensure_desc (t8_forest_t forest, t8_tree_t tree)
+{
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *element;
+  t8_locidx_t         num_elements;
+
+  if (tree->first_desc != NULL) {
+    return;
+  }
+  num_elements = t8_forest_get_tree_element_count (tree);
+  if (num_elements < 1) {
+    /* An empty local tree of an incomplete forest has no descendants */
+    T8_ASSERT (forest->incomplete_trees);
+    return;
+  }
+  /* get the eclass scheme associated to tree */
+  ts = forest->scheme_cxx->eclass_schemes[tree->eclass];
+  /* calculate the first descendant of the first element */
+  element = t8_element_array_index_locidx (&tree->elements, 0);
+  ts->t8_element_new (1, &tree->first_desc);
+  ts->t8_element_first_descendant (element, tree->first_desc,
+                                   forest->maxlevel);
+  /* calculate the last descendant of the last element */
+  element =
+    t8_element_array_index_locidx (&tree->elements, num_elements - 1);
+  ts->t8_element_new (1, &tree->last_desc);
+  ts->t8_element_last_descendant (element, tree->last_desc,
+                                  forest->maxlevel);
+}
+
+/* Fill the elements with forest local indices in [el_begin, el_end) of a
+ * freshly allocated uniform forest with their leaf elements.
+ * Each leaf of the uniform refinement is determined by its linear id
+ * alone, so disjoint ranges can be filled concurrently. Only the first
+ * element of each range decodes its full linear id, all further elements
+ * are computed from their predecessor via t8_element_successor, which
+ * only updates the trailing digits of the id.
+ * \a child_in_tree_begin is the linear id of the first element of the
+ * first local tree, all further trees start at id 0. */
+static void
+t8_forest_populate_fill_range (t8_forest_t forest,
+                               t8_gloidx_t child_in_tree_begin,
+                               t8_locidx_t el_begin, t8_locidx_t el_end)
+{
+  t8_locidx_t         num_local_trees, itree;
+  t8_locidx_t         num_tree_elements;
+  t8_locidx_t         elem_begin, elem_end, ielem;
+  t8_tree_t           tree;
+  t8_eclass_scheme_c *eclass_scheme;
+  t8_element_t       *element, *prev_element;
+  t8_gloidx_t         first_id;
+
+  num_local_trees = (t8_locidx_t) forest->trees->elem_count;
+  for (itree = 0; itree < num_local_trees; itree++) {
+    tree = (t8_tree_t) t8_sc_array_index_locidx (forest->trees, itree);
+    if (tree->elements_offset >= el_end) {
+      /* This tree and all further trees lie behind the range */
       break;
     }
-    /* get the eclass scheme associated to tree */
-    ts = forest->scheme_cxx->eclass_schemes[itree->eclass];
-    /* get a pointer to the first element of itree */
-    element = t8_element_array_index_locidx (&itree->elements, 0);
-    /* get memory for the trees first descendant */
-    ts->t8_element_new (1, &itree->first_desc);
-    /* calculate the first descendant of the first element */
-    ts->t8_element_first_descendant (element, itree->first_desc,
-                                     forest->maxlevel);
-    /* get a pointer to the last element of itree */
-    num_elements = t8_element_array_get_count (&itree->elements);
-    element =
-      t8_element_array_index_locidx (&itree->elements, num_elements - 1);
-    /* get memory for the trees first descendant */
-    ts->t8_element_new (1, &itree->last_desc);
-    /* calculate the last descendant of the first element */
-    ts->t8_element_last_descendant (element, itree->last_desc,
-                                    forest->maxlevel);
+    num_tree_elements =
+      (t8_locidx_t) t8_element_array_get_count (&tree->elements);
+    if (tree->elements_offset + num_tree_elements <= el_begin) {
+      /* This tree lies before the range */
+      continue;
+    }
+    /* Clip the range to the elements of this tree */
+    elem_begin = SC_MAX (el_begin - tree->elements_offset, 0);
+    elem_end = SC_MIN (el_end - tree->elements_offset, num_tree_elements);
+    eclass_scheme = forest->scheme_cxx->eclass_schemes[tree->eclass];
+    /* Only the first local tree may start at a nonzero linear id */
+    first_id = itree == 0 ? child_in_tree_begin : 0;
+    prev_element = NULL;
+    for (ielem = elem_begin; ielem < elem_end; ielem++) {
+      element = t8_element_array_index_locidx (&tree->elements, ielem);
+      if (prev_element != NULL) {
+        /* The ids within the range are consecutive, so the successor
+         * operation updates the previous element in place of decoding
+         * the full linear id. */
+        eclass_scheme->t8_element_successor (prev_element, element,
+                                             forest->set_level);
+      }
+      else {
+        eclass_scheme->t8_element_set_linear_id (element, forest->set_level,
+                                                 first_id + ielem);
+      }
+      prev_element = element;
+    }
   }
 }
 
+#if defined (SC_ENABLE_PTHREAD)
+/* The per-thread state of one worker of the threaded uniform fill. */
+typedef struct t8_forest_populate_worker
+{
+  t8_forest_t         forest;   /* The forest whose elements are filled. */
+  t8_gloidx_t         child_in_tree_begin;      /* The linear id of the first element of the first local tree. */
+  t8_locidx_t         el_begin; /* The first forest local element index of this worker's range. */
+  t8_locidx_t         el_end;   /* One past the last element index of this worker's range. */
+} t8_forest_populate_worker_t;
+
+/* The thread entry point of the threaded uniform fill. */
+static void        *
+t8_forest_populate_worker_run (void *pworker)
+{
+  t8_forest_populate_worker_t *worker =
+    (t8_forest_populate_worker_t *) pworker;
+
+  t8_forest_populate_fill_range (worker->forest, worker->child_in_tree_begin,
+                                 worker->el_begin, worker->el_end);
+  return NULL;
+}
+#endif
+
 /* Create the elements on this process given a uniform partition
- * of the coarse mesh. */
+ * of the coarse mesh.
+ * The element arrays of all local trees are allocated first and then
+ * filled elementwise from the linear ids of the uniform refinement.
+ * If \ref t8_forest_set_populate_threads requested more than one thread
+ * and t8code was configured with pthread support, the fill is split into
+ * chunks of equal element count that are processed by the shared thread
+ * pool, \see t8_thread_pool.h. */
 void
 t8_forest_populate (t8_forest_t forest)
 {
@@ -1486,14 +2244,16 @@ t8_forest_populate (t8_forest_t forest)
   t8_locidx_t         num_tree_elements;
   t8_locidx_t         num_local_trees;
   t8_gloidx_t         jt, first_ctree;
-  t8_gloidx_t         start, end, et;
+  t8_gloidx_t         start, end;
   t8_tree_t           tree;
-  t8_element_t       *element, *element_succ;
   t8_element_array_t *telements;
   t8_eclass_t         tree_class;
   t8_eclass_scheme_c *eclass_scheme;
   t8_gloidx_t         cmesh_first_tree, cmesh_last_tree;
   int                 is_empty;
+#if defined (SC_ENABLE_PTHREAD)
+  int                 num_threads;
+#endif
 
   SC_CHECK_ABORT (forest->set_level <= forest->maxlevel,
                   "Given refinement level exceeds the maximum.\n");
@@ -1524,7 +2284,7 @@ t8_forest_populate (t8_forest_t forest)
   if (is_empty) {
     /* This processor is empty
      * we still set the tree array to store 0 as the number of trees here */
-    forest->trees = sc_array_new (sizeof (t8_tree_struct_t));
+    forest->trees = t8_forest_recycle_trees_new (0);
     count_elements = 0;
     /* Set the first local tree larger than the last local tree to
      * indicate empty forest */
@@ -1533,8 +2293,7 @@ t8_forest_populate (t8_forest_t forest)
   else {
     /* for each tree, allocate elements */
     num_local_trees = forest->last_local_tree - forest->first_local_tree + 1;
-    forest->trees =
-      sc_array_new_count (sizeof (t8_tree_struct_t), num_local_trees);
+    forest->trees = t8_forest_recycle_trees_new (num_local_trees);
     first_ctree = t8_cmesh_get_first_treeid (forest->cmesh);
     for (jt = forest->first_local_tree, count_elements = 0;
          jt <= forest->last_local_tree; jt++) {
@@ -1554,19 +2313,39 @@ t8_forest_populate (t8_forest_t forest)
       num_tree_elements = end - start;
       T8_ASSERT (num_tree_elements > 0);
       /* Allocate elements for this processor. */
-      t8_element_array_init_size (telements, eclass_scheme,
-                                  num_tree_elements);
-      element = t8_element_array_index_locidx (telements, 0);
-      eclass_scheme->t8_element_set_linear_id (element, forest->set_level,
-                                               start);
-      count_elements++;
-      for (et = start + 1; et < end; et++, count_elements++) {
-        element_succ = t8_element_array_index_locidx (telements, et - start);
-        eclass_scheme->t8_element_successor (element, element_succ,
-                                             forest->set_level);
-        /* TODO: process elements here */
-        element = element_succ;
+      t8_element_array_init_size_mode (telements, eclass_scheme,
+                                       num_tree_elements,
+                                       forest->element_memory_mode);
+      count_elements += num_tree_elements;
+    }
+    /* Fill the allocated elements from their linear ids */
+#if defined (SC_ENABLE_PTHREAD)
+    num_threads = SC_MAX (forest->populate_num_threads, 1);
+    /* Do not spawn more workers than there are elements to fill */
+    num_threads = SC_MIN (num_threads, count_elements);
+    if (num_threads > 1) {
+      t8_forest_populate_worker_t *workers;
+      int                 ithread;
+
+      workers = T8_ALLOC (t8_forest_populate_worker_t, num_threads);
+      for (ithread = 0; ithread < num_threads; ithread++) {
+        workers[ithread].forest = forest;
+        workers[ithread].child_in_tree_begin = child_in_tree_begin;
+        /* Split the local elements into chunks of (almost) equal count */
+        workers[ithread].el_begin = (t8_locidx_t)
+          ((t8_gloidx_t) count_elements * ithread / num_threads);
+        workers[ithread].el_end = (t8_locidx_t)
+          ((t8_gloidx_t) count_elements * (ithread + 1) / num_threads);
       }
+      t8_thread_pool_exec (t8_forest_populate_worker_run, workers,
+                           sizeof (t8_forest_populate_worker_t), num_threads);
+      T8_FREE (workers);
+    }
+    else
+#endif
+    {
+      t8_forest_populate_fill_range (forest, child_in_tree_begin, 0,
+                                     count_elements);
     }
   }
   forest->local_num_elements = count_elements;
@@ -1701,6 +2480,7 @@ t8_forest_tree_shared (t8_forest_t forest, int first_or_last)
     }
     /* We can now check whether the first/last possible descendant matches the
      * first/last local descendant */
+    t8_forest_tree_ensure_desc (forest, tree);
     tree_desc = first_or_last == 0 ? tree->first_desc : tree->last_desc;
     ret = ts->t8_element_compare (desc, tree_desc);
     /* clean-up */
@@ -1746,8 +2526,7 @@ t8_forest_copy_trees (t8_forest_t forest, t8_forest_t from, int copy_elements)
   T8_ASSERT (from->committed);
 
   number_of_trees = from->trees->elem_count;
-  forest->trees =
-    sc_array_new_size (sizeof (t8_tree_struct_t), number_of_trees);
+  forest->trees = t8_forest_recycle_trees_new (number_of_trees);
   sc_array_copy (forest->trees, from->trees);
   for (jt = 0; jt < number_of_trees; jt++) {
     tree = (t8_tree_t) t8_sc_array_index_locidx (forest->trees, jt);
@@ -1755,23 +2534,23 @@ t8_forest_copy_trees (t8_forest_t forest, t8_forest_t from, int copy_elements)
     tree->eclass = fromtree->eclass;
     eclass_scheme = forest->scheme_cxx->eclass_schemes[tree->eclass];
     num_tree_elements = t8_element_array_get_count (&fromtree->elements);
-    t8_element_array_init_size (&tree->elements, eclass_scheme,
-                                num_tree_elements);
+    t8_element_array_init_size_mode (&tree->elements, eclass_scheme,
+                                     num_tree_elements,
+                                     forest->element_memory_mode);
     /* TODO: replace with t8_elem_copy (not existing yet), in order to
      * eventually copy additional pointer data stored in the elements?
      * -> i.m.o. we should not allow such pointer data at the elements */
     if (copy_elements) {
       t8_element_array_copy (&tree->elements, &fromtree->elements);
       tree->elements_offset = fromtree->elements_offset;
-      /* Copy the first and last descendant */
-      eclass_scheme->t8_element_new (1, &tree->first_desc);
-      eclass_scheme->t8_element_copy (fromtree->first_desc, tree->first_desc);
-      eclass_scheme->t8_element_new (1, &tree->last_desc);
-      eclass_scheme->t8_element_copy (fromtree->last_desc, tree->last_desc);
     }
     else {
       t8_element_array_truncate (&tree->elements);
     }
+    /* The descendants are computed lazily on first access; clear the
+     * pointers that sc_array_copy took over from the source structs. */
+    tree->first_desc = NULL;
+    tree->last_desc = NULL;
   }
   forest->first_local_tree = from->first_local_tree;
   forest->last_local_tree = from->last_local_tree;
@@ -1792,8 +2571,13 @@ t8_forest_copy_trees (t8_forest_t forest, t8_forest_t from, int copy_elements)
  * such that the element at position i has a smaller id than the given one.
  * If no such i exists, return -1.
  */
+/* Minimum element count for which a binary search builds the linear id
+ * cache of the searched array. For smaller arrays the build cost does not
+ * pay off. */
+#define T8_FOREST_BIN_SEARCH_ID_CACHE_MIN 16
+
 /* TODO: should return t8_locidx_t */
-static t8_locidx_t
+t8_locidx_t
 t8_forest_bin_search_lower (t8_element_array_t *elements,
                             t8_linearidx_t element_id, int maxlevel)
 {
@@ -1801,8 +2585,63 @@ t8_forest_bin_search_lower (t8_element_array_t *elements,
   t8_linearidx_t      query_id;
   t8_locidx_t         low, high, guess;
   t8_eclass_scheme_c *ts;
+  const t8_linearidx_t *id_cache;
 
   ts = t8_element_array_get_scheme (elements);
+  if (t8_element_array_get_count (elements) >=
+      T8_FOREST_BIN_SEARCH_ID_CACHE_MIN
+      && t8_element_array_get_id_cache (elements, maxlevel) == NULL) {
+    /* The arrays that we search are searched many times (for example once
+     * per element face during ghost creation), so computing all linear ids
+     * once amortizes quickly. The cache is dropped automatically when the
+     * array is modified. */
+    t8_element_array_build_id_cache (elements, maxlevel);
+  }
+  id_cache = t8_element_array_get_id_cache (elements, maxlevel);
+  if (id_cache != NULL) {
+    /* Fast path: compare the cached ids, no virtual calls per probe.
+     * The search is two-level: the small sample array (every
+     * T8_ELEMENT_ARRAY_ID_SAMPLE_STRIDE-th id, usually cache resident)
+     * narrows the range to one stride, which a branch free counting scan
+     * over the cached ids finishes. */
+    const t8_linearidx_t *id_samples;
+    size_t              num_samples;
+    t8_locidx_t         index, i;
+
+    if (id_cache[0] > element_id) {
+      /* No element has id smaller than the given one */
+      return -1;
+    }
+    id_samples =
+      t8_element_array_get_id_sample_cache (elements, maxlevel,
+                                            &num_samples);
+    T8_ASSERT (id_samples != NULL && num_samples > 0);
+    /* Find the last sample with id <= element_id; its stride sized range
+     * contains the result, since all ids from the next sample on are
+     * larger. */
+    low = 0;
+    high = (t8_locidx_t) num_samples - 1;
+    while (low < high) {
+      guess = (low + high + 1) / 2;
+      if (id_samples[guess] > element_id) {
+        high = guess - 1;
+      }
+      else {
+        low = guess;
+      }
+    }
+    index = low * T8_ELEMENT_ARRAY_ID_SAMPLE_STRIDE;
+    high = SC_MIN (index + T8_ELEMENT_ARRAY_ID_SAMPLE_STRIDE - 1,
+                   (t8_locidx_t) t8_element_array_get_count (elements) - 1);
+    /* The ids are sorted, so the entries <= element_id form a prefix of
+     * the range and counting them is a branch free scan. */
+    for (i = index + 1; i <= high; i++) {
+      index += id_cache[i] <= element_id;
+    }
+    T8_ASSERT (id_cache[index] <= element_id);
+    return index;
+  }
+
   /* At first, we check whether any element has smaller id than the
    * given one. */
   query = t8_element_array_index_int (elements, 0);
@@ -2030,6 +2869,8 @@ t8_forest_element_half_face_neighbors (t8_forest_t forest,
   t8_tree_t           tree;
   t8_eclass_t         eclass;
   t8_element_t      **children_at_face;
+  t8_element_scratch_t *scratch;
+  t8_element_scratch_mark_t scratch_mark;
   t8_gloidx_t         neighbor_tree = -1;
 #ifdef T8_ENABLE_DEBUG
   t8_gloidx_t         last_neighbor_tree = -1;
@@ -2049,9 +2890,13 @@ t8_forest_element_half_face_neighbors (t8_forest_t forest,
   /* The number of children of elem at face */
   T8_ASSERT (num_neighs == ts->t8_element_num_face_children (elem, face));
   num_children_at_face = num_neighs;
-  /* Allocate memory for the children of elem that share a face with face. */
+  /* Carve the short-lived children of elem that share a face with face
+   * from the scratch arena instead of the mempool. */
+  scratch = t8_forest_get_element_scratch (forest);
+  scratch_mark = t8_element_scratch_begin (scratch);
   children_at_face = T8_ALLOC (t8_element_t *, num_children_at_face);
-  ts->t8_element_new (num_children_at_face, children_at_face);
+  t8_element_scratch_elements (scratch, ts, num_children_at_face,
+                               children_at_face);
 
   /* Construct the children of elem at face
    *
@@ -2087,8 +2932,8 @@ t8_forest_element_half_face_neighbors (t8_forest_t forest,
     last_neighbor_tree = neighbor_tree;
 #endif
   }
-  /* Clean-up the memory */
-  ts->t8_element_destroy (num_children_at_face, children_at_face);
+  /* Clean-up the memory. The children are released in bulk. */
+  t8_element_scratch_end (scratch, scratch_mark);
   T8_FREE (children_at_face);
   return neighbor_tree;
 }
@@ -2458,6 +3303,460 @@ t8_forest_print_all_leaf_neighbors (t8_forest_t forest)
   }
 }
 
+void
+t8_forest_leaf_face_neighbors_batch (t8_forest_t forest,
+                                     t8_locidx_t num_queries,
+                                     const t8_locidx_t *lelement_ids,
+                                     const int *faces,
+                                     sc_array_t *neighbor_indices,
+                                     sc_array_t *dual_faces,
+                                     t8_locidx_t *neighbor_offsets,
+                                     int forest_is_balanced)
+{
+  t8_locidx_t         iquery, lelement_id, ltree, num_local_trees;
+  t8_locidx_t         tree_offset, tree_num_elements, *element_indices;
+  t8_locidx_t         entry_count;
+  t8_element_t       *leaf, **neighbor_leafs;
+  t8_eclass_scheme_c *neigh_scheme;
+  int                 num_neighbors, ineigh;
+  int                *query_dual_faces;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (neighbor_indices->elem_size == sizeof (t8_locidx_t));
+  T8_ASSERT (dual_faces->elem_size == sizeof (int));
+
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  /* We resolve the tree of a query incrementally. Since subsequent queries
+   * mostly stay within one tree, this avoids a binary tree search per query. */
+  ltree = 0;
+  tree_offset = 0;
+  tree_num_elements =
+    num_local_trees > 0 ? t8_forest_get_tree_num_elements (forest, 0) : 0;
+  entry_count = (t8_locidx_t) neighbor_indices->elem_count;
+  for (iquery = 0; iquery < num_queries; iquery++) {
+    lelement_id = lelement_ids[iquery];
+    T8_ASSERT (0 <= lelement_id
+               && lelement_id < forest->local_num_elements);
+    if (lelement_id < tree_offset) {
+      /* The query jumped backwards, restart the tree walk */
+      ltree = 0;
+      tree_offset = 0;
+      tree_num_elements = t8_forest_get_tree_num_elements (forest, 0);
+    }
+    while (lelement_id >= tree_offset + tree_num_elements) {
+      /* Advance to the tree containing the element */
+      ltree++;
+      T8_ASSERT (ltree < num_local_trees);
+      tree_offset += tree_num_elements;
+      tree_num_elements = t8_forest_get_tree_num_elements (forest, ltree);
+    }
+    leaf =
+      t8_forest_get_element_in_tree (forest, ltree,
+                                     lelement_id - tree_offset);
+    neighbor_offsets[iquery] = entry_count;
+    t8_forest_leaf_face_neighbors (forest, ltree, leaf, &neighbor_leafs,
+                                   faces[iquery], &query_dual_faces,
+                                   &num_neighbors, &element_indices,
+                                   &neigh_scheme, forest_is_balanced);
+    for (ineigh = 0; ineigh < num_neighbors; ineigh++) {
+      *(t8_locidx_t *) sc_array_push (neighbor_indices) =
+        element_indices[ineigh];
+      *(int *) sc_array_push (dual_faces) = query_dual_faces[ineigh];
+    }
+    entry_count += num_neighbors;
+    if (num_neighbors > 0) {
+      /* The neighbor elements themselves are not returned in batch mode */
+      neigh_scheme->t8_element_destroy (num_neighbors, neighbor_leafs);
+      T8_FREE (element_indices);
+      T8_FREE (neighbor_leafs);
+      T8_FREE (query_dual_faces);
+    }
+  }
+  neighbor_offsets[num_queries] = entry_count;
+}
+
+void
+t8_forest_face_neighbor_index_create (t8_forest_t forest)
+{
+  t8_forest_face_neighbor_index_t index;
+  t8_locidx_t         num_local_elements, ielem, total_faces, entry_count;
+  t8_locidx_t         ltree, *element_indices;
+  t8_element_t       *leaf, **neighbor_leafs;
+  t8_eclass_scheme_c *ts, *neigh_scheme;
+  int                 iface, num_faces, num_neighbors, ineigh;
+  int                *dual_faces;
+  sc_array_t          neighbors, duals;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  if (forest->face_neighbor_index != NULL) {
+    /* The index was already built for this forest */
+    return;
+  }
+
+  index = T8_ALLOC_ZERO (t8_forest_face_neighbor_index_struct_t, 1);
+  num_local_elements = t8_forest_get_local_num_elements (forest);
+  index->num_local_elements = num_local_elements;
+  index->face_offsets = T8_ALLOC (t8_locidx_t, num_local_elements + 1);
+  /* Count the total number of element faces to size the offset array */
+  total_faces = 0;
+  for (ielem = 0; ielem < num_local_elements; ielem++) {
+    leaf = t8_forest_get_element (forest, ielem, &ltree);
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                ltree));
+    index->face_offsets[ielem] = total_faces;
+    total_faces += ts->t8_element_num_faces (leaf);
+  }
+  index->face_offsets[num_local_elements] = total_faces;
+  index->neighbor_offsets = T8_ALLOC (t8_locidx_t, total_faces + 1);
+
+  /* Compute the neighbors of each element face once and store them in
+   * flat arrays. */
+  sc_array_init (&neighbors, sizeof (t8_locidx_t));
+  sc_array_init (&duals, sizeof (int8_t));
+  entry_count = 0;
+  for (ielem = 0; ielem < num_local_elements; ielem++) {
+    leaf = t8_forest_get_element (forest, ielem, &ltree);
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                ltree));
+    num_faces = ts->t8_element_num_faces (leaf);
+    for (iface = 0; iface < num_faces; iface++) {
+      index->neighbor_offsets[index->face_offsets[ielem] + iface] =
+        entry_count;
+      t8_forest_leaf_face_neighbors (forest, ltree, leaf, &neighbor_leafs,
+                                     iface, &dual_faces, &num_neighbors,
+                                     &element_indices, &neigh_scheme, 1);
+      for (ineigh = 0; ineigh < num_neighbors; ineigh++) {
+        *(t8_locidx_t *) sc_array_push (&neighbors) =
+          element_indices[ineigh];
+        *(int8_t *) sc_array_push (&duals) = (int8_t) dual_faces[ineigh];
+      }
+      entry_count += num_neighbors;
+      if (num_neighbors > 0) {
+        neigh_scheme->t8_element_destroy (num_neighbors, neighbor_leafs);
+        T8_FREE (element_indices);
+        T8_FREE (neighbor_leafs);
+        T8_FREE (dual_faces);
+      }
+    }
+  }
+  index->neighbor_offsets[total_faces] = entry_count;
+  /* Copy the entries into exactly fitting arrays */
+  index->neighbors = T8_ALLOC (t8_locidx_t, entry_count);
+  index->dual_faces = T8_ALLOC (int8_t, entry_count);
+  memcpy (index->neighbors, neighbors.array,
+          entry_count * sizeof (t8_locidx_t));
+  memcpy (index->dual_faces, duals.array, entry_count * sizeof (int8_t));
+  sc_array_reset (&neighbors);
+  sc_array_reset (&duals);
+
+  forest->face_neighbor_index = index;
+}
+
+void
+t8_forest_face_neighbor_index_query (t8_forest_t forest,
+                                     t8_locidx_t lelement_id, int face,
+                                     int *num_neighbors,
+                                     const t8_locidx_t **pneighbor_indices,
+                                     const int8_t **pdual_faces)
+{
+  t8_forest_face_neighbor_index_t index;
+  t8_locidx_t         face_entry, first_entry, end_entry;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  index = forest->face_neighbor_index;
+  T8_ASSERT (index != NULL);
+  T8_ASSERT (0 <= lelement_id && lelement_id < index->num_local_elements);
+
+  face_entry = index->face_offsets[lelement_id] + face;
+  T8_ASSERT (0 <= face && face_entry < index->face_offsets[lelement_id + 1]);
+  first_entry = index->neighbor_offsets[face_entry];
+  end_entry = index->neighbor_offsets[face_entry + 1];
+  *num_neighbors = (int) (end_entry - first_entry);
+  *pneighbor_indices = index->neighbors + first_entry;
+  *pdual_faces = index->dual_faces + first_entry;
+}
+
+void
+t8_forest_face_neighbor_index_destroy (t8_forest_t forest)
+{
+  t8_forest_face_neighbor_index_t index;
+
+  T8_ASSERT (forest != NULL);
+  index = forest->face_neighbor_index;
+  if (index == NULL) {
+    return;
+  }
+  T8_FREE (index->face_offsets);
+  T8_FREE (index->neighbor_offsets);
+  T8_FREE (index->neighbors);
+  T8_FREE (index->dual_faces);
+  T8_FREE (index);
+  forest->face_neighbor_index = NULL;
+}
+
+void
+t8_forest_geometry_cache_create (t8_forest_t forest)
+{
+  t8_forest_geom_cache_t cache;
+  t8_cmesh_t          cmesh;
+  t8_locidx_t         itree, num_local_trees;
+  t8_gloidx_t         gtreeid;
+  const t8_geometry_c *geometry;
+  const t8_geometry_c *unique_geometry = NULL;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  if (forest->geom_cache != NULL) {
+    /* The cache is installed automatically at commit; further calls are
+     * a no-op. */
+    return;
+  }
+  cmesh = t8_forest_get_cmesh (forest);
+  if (cmesh->geometry_handler == NULL
+      || !t8_geom_handler_is_committed (cmesh->geometry_handler)
+      || t8_geom_handler_get_num_geometries (cmesh->geometry_handler) == 0) {
+    /* The cmesh carries no geometry; the coordinate routines keep their
+     * generic path. */
+    return;
+  }
+  if (t8_geom_handler_get_num_geometries (cmesh->geometry_handler) == 1) {
+    /* All trees share one geometry; resolve it once instead of once per
+     * tree through the active tree bookkeeping of the handler. */
+    unique_geometry =
+      t8_geom_handler_get_unique_geometry (cmesh->geometry_handler);
+  }
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  cache = T8_ALLOC_ZERO (t8_forest_geom_cache_struct_t, 1);
+  cache->num_local_trees = num_local_trees;
+  cache->tree_geometries =
+    T8_ALLOC_ZERO (const struct t8_geometry *, num_local_trees);
+  cache->tree_vertices = T8_ALLOC_ZERO (const double *, num_local_trees);
+  for (itree = 0; itree < num_local_trees; itree++) {
+    if (unique_geometry != NULL) {
+      geometry = unique_geometry;
+    }
+    else {
+      gtreeid = t8_forest_global_tree_id (forest, itree);
+      geometry = t8_cmesh_get_tree_geometry (cmesh, gtreeid);
+    }
+    cache->tree_geometries[itree] = geometry;
+    /* Only for trees with the linear geometry we can shortcut the
+     * evaluation via the stored tree vertices. */
+    if (dynamic_cast < const t8_geometry_linear * >(geometry) != NULL) {
+      cache->tree_vertices[itree] =
+        t8_cmesh_get_tree_vertices (cmesh,
+                                    t8_forest_ltreeid_to_cmesh_ltreeid
+                                    (forest, itree));
+    }
+  }
+  forest->geom_cache = cache;
+}
+
+void
+t8_forest_geometry_cache_destroy (t8_forest_t forest)
+{
+  t8_forest_geom_cache_t cache;
+
+  T8_ASSERT (forest != NULL);
+  cache = forest->geom_cache;
+  if (cache == NULL) {
+    return;
+  }
+  T8_FREE (cache->tree_geometries);
+  T8_FREE (cache->tree_vertices);
+  T8_FREE (cache);
+  forest->geom_cache = NULL;
+}
+
+/* Return true if two axis aligned boxes, each stored as
+ * xmin, xmax, ymin, ymax, zmin, zmax, overlap or touch. */
+static int
+t8_forest_aabb_overlaps (const double *box_a, const double *box_b)
+{
+  int                 idim;
+
+  for (idim = 0; idim < 3; idim++) {
+    if (box_a[2 * idim] > box_b[2 * idim + 1]
+        || box_b[2 * idim] > box_a[2 * idim + 1]) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* Build the bounding boxes of all elements of a local tree and the
+ * bounding box of the tree as their union. */
+static void
+t8_forest_aabb_cache_build_tree (t8_forest_t forest, t8_locidx_t ltreeid)
+{
+  t8_forest_aabb_cache_t cache = forest->aabb_cache;
+  t8_eclass_scheme_c *ts;
+  t8_tree_t           tree;
+  const t8_element_t *element;
+  t8_locidx_t         num_elements, ielem;
+  double             *box;
+  double             *tree_box;
+  double              corner_coords[T8_ECLASS_MAX_CORNERS][3];
+  int                 num_corners, icorner, idim;
+
+  T8_ASSERT (cache != NULL);
+  T8_ASSERT (cache->element_aabb[ltreeid] == NULL);
+
+  tree = t8_forest_get_tree (forest, ltreeid);
+  ts = t8_forest_get_eclass_scheme (forest, tree->eclass);
+  num_elements = t8_forest_get_tree_element_count (tree);
+  cache->element_aabb[ltreeid] =
+    T8_ALLOC (double, 6 * (size_t) num_elements);
+  /* Initialize the tree box empty; it stays empty for an empty tree and
+   * then overlaps nothing. */
+  tree_box = cache->tree_aabb + 6 * (size_t) ltreeid;
+  for (idim = 0; idim < 3; idim++) {
+    tree_box[2 * idim] = DBL_MAX;
+    tree_box[2 * idim + 1] = -DBL_MAX;
+  }
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    element = t8_forest_get_tree_element (tree, ielem);
+    box = cache->element_aabb[ltreeid] + 6 * (size_t) ielem;
+    for (idim = 0; idim < 3; idim++) {
+      box[2 * idim] = DBL_MAX;
+      box[2 * idim + 1] = -DBL_MAX;
+    }
+    num_corners = ts->t8_element_num_corners (element);
+    /* Gather the corner coordinates with one geometry resolution and take
+     * the min/max over the contiguous tile in a vectorizable pass. */
+    t8_forest_element_corner_coords (forest, ltreeid, element, ts,
+                                     num_corners, corner_coords[0]);
+    for (icorner = 0; icorner < num_corners; icorner++) {
+      for (idim = 0; idim < 3; idim++) {
+        box[2 * idim] = SC_MIN (box[2 * idim], corner_coords[icorner][idim]);
+        box[2 * idim + 1] =
+          SC_MAX (box[2 * idim + 1], corner_coords[icorner][idim]);
+      }
+    }
+    /* Grow the tree box by the element box */
+    for (idim = 0; idim < 3; idim++) {
+      tree_box[2 * idim] = SC_MIN (tree_box[2 * idim], box[2 * idim]);
+      tree_box[2 * idim + 1] =
+        SC_MAX (tree_box[2 * idim + 1], box[2 * idim + 1]);
+    }
+  }
+}
+
+/* Allocate the bounding box cache of a forest if it does not exist yet
+ * and build the boxes of the given local tree if they are missing. */
+static void
+t8_forest_aabb_cache_ensure_tree (t8_forest_t forest, t8_locidx_t ltreeid)
+{
+  t8_forest_aabb_cache_t cache;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= ltreeid
+             && ltreeid < t8_forest_get_num_local_trees (forest));
+
+  if (forest->aabb_cache == NULL) {
+    cache = T8_ALLOC_ZERO (t8_forest_aabb_cache_struct_t, 1);
+    cache->num_local_trees = t8_forest_get_num_local_trees (forest);
+    cache->element_aabb =
+      T8_ALLOC_ZERO (double *, cache->num_local_trees);
+    cache->tree_aabb = T8_ALLOC (double, 6 * (size_t)
+                                 cache->num_local_trees);
+    forest->aabb_cache = cache;
+  }
+  if (forest->aabb_cache->element_aabb[ltreeid] == NULL) {
+    t8_forest_aabb_cache_build_tree (forest, ltreeid);
+  }
+}
+
+const double       *
+t8_forest_element_aabb (t8_forest_t forest, t8_locidx_t ltreeid,
+                        t8_locidx_t index_in_tree)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  t8_forest_aabb_cache_ensure_tree (forest, ltreeid);
+  T8_ASSERT (0 <= index_in_tree
+             && index_in_tree <
+             t8_forest_get_tree_num_elements (forest, ltreeid));
+  return forest->aabb_cache->element_aabb[ltreeid]
+    + 6 * (size_t) index_in_tree;
+}
+
+t8_locidx_t        *
+t8_forest_elements_in_box (t8_forest_t forest, const double *box,
+                           t8_locidx_t *num_elements)
+{
+  t8_forest_aabb_cache_t cache;
+  t8_locidx_t        *indices;
+  t8_locidx_t         num_local_trees, itree;
+  t8_locidx_t         num_tree_elements, ielem;
+  t8_locidx_t         count, tree_offset;
+  const double       *element_box;
+  int                 ipass;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (box != NULL);
+  T8_ASSERT (num_elements != NULL);
+
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  indices = NULL;
+  count = 0;
+  /* The first pass counts the overlapping leaves, the second pass fills
+   * the index array. Both walk the trees and their leaves in space
+   * filling curve order and prune by the tree boxes. */
+  for (ipass = 0; ipass < 2; ipass++) {
+    if (ipass == 1) {
+      if (count == 0) {
+        break;
+      }
+      indices = T8_ALLOC (t8_locidx_t, count);
+      count = 0;
+    }
+    for (itree = 0; itree < num_local_trees; itree++) {
+      t8_forest_aabb_cache_ensure_tree (forest, itree);
+      cache = forest->aabb_cache;
+      if (!t8_forest_aabb_overlaps (cache->tree_aabb + 6 * (size_t) itree,
+                                    box)) {
+        continue;
+      }
+      num_tree_elements = t8_forest_get_tree_num_elements (forest, itree);
+      tree_offset = t8_forest_get_tree_element_offset (forest, itree);
+      for (ielem = 0; ielem < num_tree_elements; ielem++) {
+        element_box = cache->element_aabb[itree] + 6 * (size_t) ielem;
+        if (t8_forest_aabb_overlaps (element_box, box)) {
+          if (indices != NULL) {
+            indices[count] = tree_offset + ielem;
+          }
+          count++;
+        }
+      }
+    }
+  }
+  *num_elements = count;
+  return indices;
+}
+
+void
+t8_forest_aabb_cache_destroy (t8_forest_t forest)
+{
+  t8_forest_aabb_cache_t cache;
+  t8_locidx_t         itree;
+
+  T8_ASSERT (forest != NULL);
+  cache = forest->aabb_cache;
+  if (cache == NULL) {
+    return;
+  }
+  for (itree = 0; itree < cache->num_local_trees; itree++) {
+    T8_FREE (cache->element_aabb[itree]);
+  }
+  T8_FREE (cache->element_aabb);
+  T8_FREE (cache->tree_aabb);
+  T8_FREE (cache);
+  forest->aabb_cache = NULL;
+}
+
 /* Check if an element is owned by a specific rank */
 int
 t8_forest_element_check_owner (t8_forest_t forest,
@@ -2763,13 +4062,511 @@ t8_forest_element_find_owner_ext (t8_forest_t forest,
   return guess;
 }
 
+int
+t8_forest_element_find_owner_cached (t8_forest_t forest, t8_gloidx_t gtreeid,
+                                     t8_element_t *element,
+                                     t8_eclass_t eclass, int *last_owner)
+{
+  int                 owner = *last_owner;
+
+  /* Owner queries are strongly clustered along the space-filling curve,
+   * thus the rank found by the previous query very often owns the next
+   * queried element as well. We check it in constant time before we
+   * fall back to the binary search, in which case the cached rank still
+   * serves as the initial guess. */
+  if (0 <= owner
+      && t8_forest_element_check_owner (forest, element, gtreeid, eclass,
+                                        owner, 0)) {
+    return owner;
+  }
+  owner =
+    t8_forest_element_find_owner_ext (forest, gtreeid, element, eclass, 0,
+                                      forest->mpisize - 1,
+                                      owner >= 0 ? owner : (forest->mpisize -
+                                                            1) / 2, 0);
+  *last_owner = owner;
+  return owner;
+}
+
 int
 t8_forest_element_find_owner (t8_forest_t forest, t8_gloidx_t gtreeid,
                               t8_element_t *element, t8_eclass_t eclass)
 {
-  return t8_forest_element_find_owner_ext (forest, gtreeid, element,
-                                           eclass, 0, forest->mpisize - 1,
-                                           (forest->mpisize - 1) / 2, 0);
+  return t8_forest_element_find_owner_cached (forest, gtreeid, element,
+                                              eclass, &forest->last_owner);
+}
+
+void
+t8_forest_element_find_owners_range (t8_forest_t forest, t8_gloidx_t gtreeid,
+                                     t8_element_t **elements,
+                                     int num_elements, t8_eclass_t eclass,
+                                     int *owners)
+{
+  int                 ielem, lower_bound = 0;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (num_elements == 0 || elements != NULL);
+  T8_ASSERT (num_elements == 0 || owners != NULL);
+
+  for (ielem = 0; ielem < num_elements; ielem++) {
+#ifdef T8_ENABLE_DEBUG
+    if (ielem > 0) {
+      /* The queries must be sorted in space-filling curve order. */
+      t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, eclass);
+      T8_ASSERT (ts->t8_element_compare (elements[ielem - 1],
+                                         elements[ielem]) <= 0);
+    }
+#endif
+    /* Since the queries ascend along the space-filling curve, the owner
+     * of this element cannot be smaller than the previous owner. We
+     * shrink the search window accordingly and sweep through the ranks
+     * only once for the whole sequence. */
+    owners[ielem] =
+      t8_forest_element_find_owner_ext (forest, gtreeid, elements[ielem],
+                                        eclass, lower_bound,
+                                        forest->mpisize - 1, lower_bound, 0);
+    lower_bound = owners[ielem];
+  }
+  if (num_elements > 0) {
+    /* Seed the owner cache for subsequent single queries. */
+    forest->last_owner = owners[num_elements - 1];
+  }
+}
+
+/* One entry of the sort scratch of t8_forest_sample_elements. */
+typedef struct t8_forest_sample_key
+{
+  t8_gloidx_t         gid;      /* The sampled global element id. */
+  t8_locidx_t         isample;  /* Its position in the input array. */
+} t8_forest_sample_key_t;
+
+/* qsort callback to sort sample keys by ascending global element id. */
+static int
+t8_forest_sample_key_compare (const void *a, const void *b)
+{
+  const t8_forest_sample_key_t *key_a = (const t8_forest_sample_key_t *) a;
+  const t8_forest_sample_key_t *key_b = (const t8_forest_sample_key_t *) b;
+
+  return key_a->gid < key_b->gid ? -1 : key_a->gid > key_b->gid ? 1 : 0;
+}
+
+t8_locidx_t
+t8_forest_sample_elements (t8_forest_t forest, const t8_gloidx_t *sample_gids,
+                           t8_locidx_t num_samples,
+                           t8_locidx_t *sample_positions,
+                           t8_locidx_t *ltreeids, t8_element_t **elements,
+                           double *centroids)
+{
+  t8_forest_sample_key_t *keys;
+  t8_tree_hot_struct_t *tree_hot;
+  t8_gloidx_t         gfirst, glast;
+  t8_locidx_t         isample, ihit, num_hits;
+  t8_locidx_t         itree, num_local_trees;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (num_samples == 0 || sample_gids != NULL);
+
+  /* The element offset array was built during commit, so the global id
+   * of the first local element is known without communication. */
+  T8_ASSERT (forest->element_offsets != NULL);
+  gfirst =
+    t8_shmem_array_get_gloidx (forest->element_offsets, forest->mpirank);
+  glast = gfirst + (t8_gloidx_t) forest->local_num_elements;
+
+  /* Collect the samples that hit this process and sort them by id. */
+  keys = T8_ALLOC (t8_forest_sample_key_t, num_samples);
+  num_hits = 0;
+  for (isample = 0; isample < num_samples; isample++) {
+    T8_ASSERT (0 <= sample_gids[isample]);
+    if (gfirst <= sample_gids[isample] && sample_gids[isample] < glast) {
+      keys[num_hits].gid = sample_gids[isample];
+      keys[num_hits].isample = isample;
+      num_hits++;
+    }
+  }
+  qsort (keys, num_hits, sizeof (t8_forest_sample_key_t),
+         t8_forest_sample_key_compare);
+
+  /* One linear sweep resolves all hits: the sorted local element ids and
+   * the tree element offsets both ascend, so the tree cursor only ever
+   * moves forward and each tree record is touched at most once. */
+  tree_hot = t8_forest_get_tree_hot (forest);
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  itree = 0;
+  for (ihit = 0; ihit < num_hits; ihit++) {
+    const t8_locidx_t   lelement = (t8_locidx_t) (keys[ihit].gid - gfirst);
+    t8_element_t       *element;
+
+    while (itree < num_local_trees - 1
+           && lelement >=
+           tree_hot[itree].elements_offset + tree_hot[itree].num_elements) {
+      itree++;
+    }
+    T8_ASSERT (tree_hot[itree].elements_offset <= lelement
+               && lelement <
+               tree_hot[itree].elements_offset +
+               tree_hot[itree].num_elements);
+    element =
+      t8_element_array_index_locidx (tree_hot[itree].elements,
+                                     lelement -
+                                     tree_hot[itree].elements_offset);
+    if (sample_positions != NULL) {
+      sample_positions[ihit] = keys[ihit].isample;
+    }
+    if (ltreeids != NULL) {
+      ltreeids[ihit] = itree;
+    }
+    if (elements != NULL) {
+      elements[ihit] = element;
+    }
+    if (centroids != NULL) {
+      t8_forest_element_centroid (forest, itree, element,
+                                  centroids + 3 * (size_t) ihit);
+    }
+  }
+  T8_FREE (keys);
+  return num_hits;
+}
+
+/* One validated directive of a micro adapt, extended by the bookkeeping
+ * of the splice. */
+typedef struct t8_forest_micro_work
+{
+  t8_locidx_t         ltreeid;  /* The local tree of the directive. */
+  t8_locidx_t         lelement_id;      /* The element index within the tree. */
+  int                 refine;   /* 1 to refine, -1 to coarsen. */
+  t8_locidx_t         flat_old; /* The forest local index of the first outgoing element. */
+  t8_locidx_t         num_out;  /* The number of outgoing elements. */
+  t8_locidx_t         num_in;   /* The number of incoming elements. */
+} t8_forest_micro_work_t;
+
+/* qsort callback sorting micro adapt work entries along the space-filling
+ * curve. */
+static int
+t8_forest_micro_work_compare (const void *pa, const void *pb)
+{
+  const t8_forest_micro_work_t *a = (const t8_forest_micro_work_t *) pa;
+  const t8_forest_micro_work_t *b = (const t8_forest_micro_work_t *) pb;
+
+  if (a->flat_old != b->flat_old) {
+    return a->flat_old < b->flat_old ? -1 : 1;
+  }
+  return 0;
+}
+
+/* Check whether any leaf face neighbor of \a element is owned by another
+ * process, in which case the element is a remote of that process and a
+ * micro adapt of it invalidates the ghost layer. */
+static int
+t8_forest_micro_element_at_boundary (t8_forest_t forest, t8_locidx_t ltreeid,
+                                     const t8_element_t *element,
+                                     t8_eclass_scheme_c *ts)
+{
+  sc_array_t          owners;
+  int                 iface, num_faces;
+  size_t              iowner;
+  int                 at_boundary = 0;
+
+  sc_array_init (&owners, sizeof (int));
+  num_faces = ts->t8_element_num_faces (element);
+  for (iface = 0; iface < num_faces && !at_boundary; iface++) {
+    sc_array_resize (&owners, 0);
+    t8_forest_element_owners_at_neigh_face (forest, ltreeid, element, iface,
+                                            &owners);
+    for (iowner = 0; iowner < owners.elem_count; iowner++) {
+      if (*(int *) sc_array_index (&owners, iowner) != forest->mpirank) {
+        at_boundary = 1;
+        break;
+      }
+    }
+  }
+  sc_array_reset (&owners);
+  return at_boundary;
+}
+
+void
+t8_forest_micro_adapt (t8_forest_t forest,
+                       const t8_forest_micro_directive_t *directives,
+                       t8_locidx_t num_directives)
+{
+  t8_forest_micro_work_t *work;
+  t8_tree_t           tree;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *element, *parent;
+  t8_element_array_t  new_elements;
+  t8_locidx_t         idir, iwork, wend;
+  t8_locidx_t         itree, num_local_trees;
+  t8_locidx_t         iold, inew, num_old, num_new;
+  t8_locidx_t         ichild;
+  t8_gloidx_t         local_count;
+  t8_locidx_t         offset;
+  int                 boundary_changed = 0, boundary_changed_global;
+  int                 mpiret;
+  size_t              ihook, ifield;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (num_directives == 0 || directives != NULL);
+
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+
+  /* Validate the directives and compute the outgoing and incoming element
+   * counts of each of them. */
+  work = T8_ALLOC (t8_forest_micro_work_t, num_directives);
+  for (idir = 0; idir < num_directives; idir++) {
+    t8_forest_micro_work_t *w = work + idir;
+
+    w->ltreeid = directives[idir].ltreeid;
+    w->lelement_id = directives[idir].lelement_id;
+    w->refine = directives[idir].refine;
+    T8_ASSERT (0 <= w->ltreeid && w->ltreeid < num_local_trees);
+    T8_ASSERT (w->refine == 1 || w->refine == -1);
+    tree = t8_forest_get_tree (forest, w->ltreeid);
+    ts = t8_forest_get_eclass_scheme (forest, tree->eclass);
+    T8_ASSERT (0 <= w->lelement_id
+               && w->lelement_id
+               < (t8_locidx_t) t8_element_array_get_count (&tree->elements));
+    element =
+      t8_element_array_index_locidx (&tree->elements, w->lelement_id);
+    w->flat_old = tree->elements_offset + w->lelement_id;
+    if (w->refine == 1) {
+      SC_CHECK_ABORT (ts->t8_element_level (element) < forest->maxlevel,
+                      "Micro adapt: cannot refine an element of maximum "
+                      "level.");
+      w->num_out = 1;
+      w->num_in = ts->t8_element_num_children (element);
+    }
+    else {
+      /* The directive must name the first member of a complete family
+       * that lies entirely in this tree. */
+      SC_CHECK_ABORT (ts->t8_element_level (element) > 0,
+                      "Micro adapt: cannot coarsen a root element.");
+      ts->t8_element_new (1, &parent);
+      ts->t8_element_parent (element, parent);
+      w->num_out = ts->t8_element_num_children (parent);
+      w->num_in = 1;
+      ts->t8_element_destroy (1, &parent);
+      SC_CHECK_ABORT (ts->t8_element_child_id (element) == 0
+                      && w->lelement_id + w->num_out
+                      <= (t8_locidx_t)
+                      t8_element_array_get_count (&tree->elements),
+                      "Micro adapt: coarsen directive does not name the "
+                      "first member of a complete local family.");
+    }
+    if (!boundary_changed && forest->ghosts != NULL) {
+      /* If the element is a remote of another process, its change
+       * invalidates the ghost layer of that process. */
+      boundary_changed =
+        t8_forest_micro_element_at_boundary (forest, w->ltreeid, element,
+                                             ts);
+    }
+  }
+  qsort (work, num_directives, sizeof (t8_forest_micro_work_t),
+         t8_forest_micro_work_compare);
+#ifdef T8_ENABLE_DEBUG
+  /* The directives must not overlap */
+  for (idir = 0; idir + 1 < num_directives; idir++) {
+    T8_ASSERT (work[idir].flat_old + work[idir].num_out
+               <= work[idir + 1].flat_old);
+  }
+#endif
+
+  /* Splice the element data fields before the element arrays change.
+   * Refined elements copy their value to every child, a coarsened family
+   * passes the value of its first member to the parent. The ghost entries
+   * are resized below, after the ghost layer was updated. */
+  if (forest->fields != NULL) {
+    for (ifield = 0; ifield < forest->fields->elem_count; ifield++) {
+      t8_forest_field_struct_t *field = (t8_forest_field_struct_t *)
+        sc_array_index (forest->fields, ifield);
+      sc_array_t         *new_data;
+
+      num_new = forest->local_num_elements;
+      for (idir = 0; idir < num_directives; idir++) {
+        num_new += work[idir].num_in - work[idir].num_out;
+      }
+      new_data = sc_array_new_count (field->elem_bytes, (size_t) num_new);
+      iold = inew = 0;
+      for (idir = 0; idir <= num_directives; idir++) {
+        const t8_locidx_t   span_end = idir < num_directives ?
+          work[idir].flat_old : forest->local_num_elements;
+        if (span_end > iold) {
+          /* Copy the unchanged span in one block */
+          memcpy (sc_array_index_int (new_data, inew),
+                  sc_array_index_int (field->data, iold),
+                  (size_t) (span_end - iold) * field->elem_bytes);
+          inew += span_end - iold;
+          iold = span_end;
+        }
+        if (idir < num_directives) {
+          for (ichild = 0; ichild < work[idir].num_in; ichild++) {
+            memcpy (sc_array_index_int (new_data, inew + ichild),
+                    sc_array_index_int (field->data, iold),
+                    field->elem_bytes);
+          }
+          iold += work[idir].num_out;
+          inew += work[idir].num_in;
+        }
+      }
+      T8_ASSERT (inew == num_new);
+      sc_array_destroy (field->data);
+      field->data = new_data;
+    }
+  }
+
+  /* Splice the element arrays of the affected trees. Each affected tree
+   * is rebuilt in one forward pass, all other trees are untouched. */
+  iwork = 0;
+  while (iwork < num_directives) {
+    itree = work[iwork].ltreeid;
+    for (wend = iwork + 1;
+         wend < num_directives && work[wend].ltreeid == itree; wend++) {
+    }
+    tree = t8_forest_get_tree (forest, itree);
+    ts = t8_forest_get_eclass_scheme (forest, tree->eclass);
+    num_old = (t8_locidx_t) t8_element_array_get_count (&tree->elements);
+    num_new = num_old;
+    for (idir = iwork; idir < wend; idir++) {
+      num_new += work[idir].num_in - work[idir].num_out;
+    }
+    t8_element_array_init_size_mode (&new_elements, ts, num_new,
+                                     forest->element_memory_mode);
+    iold = inew = 0;
+    idir = iwork;
+    while (iold < num_old) {
+      element = t8_element_array_index_locidx (&tree->elements, iold);
+      if (idir < wend && work[idir].lelement_id == iold) {
+        if (work[idir].refine == 1) {
+          for (ichild = 0; ichild < work[idir].num_in; ichild++) {
+            ts->t8_element_child (element, ichild,
+                                  t8_element_array_index_locidx
+                                  (&new_elements, inew + ichild));
+          }
+        }
+        else {
+          ts->t8_element_parent (element,
+                                 t8_element_array_index_locidx
+                                 (&new_elements, inew));
+        }
+        iold += work[idir].num_out;
+        inew += work[idir].num_in;
+        idir++;
+      }
+      else {
+        ts->t8_element_copy (element,
+                             t8_element_array_index_locidx (&new_elements,
+                                                            inew));
+        iold++;
+        inew++;
+      }
+    }
+    T8_ASSERT (inew == num_new && idir == wend);
+    t8_element_array_reset (&tree->elements);
+    tree->elements = new_elements;
+    /* Invalidate the cached tree descendants, they are recomputed on the
+     * next access. */
+    if (tree->first_desc != NULL) {
+      ts->t8_element_destroy (1, &tree->first_desc);
+      tree->first_desc = NULL;
+    }
+    if (tree->last_desc != NULL) {
+      ts->t8_element_destroy (1, &tree->last_desc);
+      tree->last_desc = NULL;
+    }
+    iwork = wend;
+  }
+
+  /* Recompute the tree element offsets and the local element count */
+  offset = 0;
+  for (itree = 0; itree < num_local_trees; itree++) {
+    tree = t8_forest_get_tree (forest, itree);
+    tree->elements_offset = offset;
+    offset += (t8_locidx_t) t8_element_array_get_count (&tree->elements);
+  }
+  forest->local_num_elements = offset;
+  local_count = (t8_gloidx_t) offset;
+  mpiret = sc_MPI_Allreduce (&local_count, &forest->global_num_elements, 1,
+                             T8_MPI_GLOIDX, sc_MPI_SUM, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  /* Drop every derived structure of the old element layout. All of them
+   * are rebuilt lazily on the next access. */
+  t8_forest_face_neighbor_index_destroy (forest);
+  if (forest->tree_element_offsets != NULL) {
+    T8_FREE (forest->tree_element_offsets);
+    forest->tree_element_offsets = NULL;
+  }
+  if (forest->tree_hot_storage != NULL) {
+    T8_FREE (forest->tree_hot_storage);
+    forest->tree_hot_storage = NULL;
+    forest->tree_hot = NULL;
+  }
+  if (forest->level_view_offsets != NULL) {
+    T8_FREE (forest->level_view_offsets);
+    T8_FREE (forest->level_view_indices);
+    T8_FREE (forest->tree_level_counts);
+    forest->level_view_offsets = NULL;
+    forest->level_view_indices = NULL;
+    forest->tree_level_counts = NULL;
+  }
+  t8_forest_aabb_cache_destroy (forest);
+  /* Rebuild the element offset table. The partition no longer follows
+   * the closed uniform form. */
+  forest->partition_is_uniform = 0;
+  if (forest->element_offsets != NULL) {
+    t8_shmem_array_destroy (&forest->element_offsets);
+  }
+  t8_forest_partition_create_offsets (forest);
+  if (forest->node_offsets != NULL) {
+    t8_shmem_array_destroy (&forest->node_offsets);
+  }
+  if (forest->global_first_desc != NULL) {
+    t8_shmem_array_destroy (&forest->global_first_desc);
+  }
+  /* Refining can introduce new level jumps */
+  forest->known_balanced = 0;
+  forest->maxlevel_existing = -1;
+  /* An in place change starts a new generation of this forest */
+  forest->generation++;
+
+  /* Rebuild the ghost layer only if some process changed an element at
+   * its process boundary. Interior changes, the common case when tracking
+   * probes, keep the existing layer valid. */
+  if (forest->ghosts != NULL) {
+    mpiret = sc_MPI_Allreduce (&boundary_changed, &boundary_changed_global,
+                               1, sc_MPI_INT, sc_MPI_LOR, forest->mpicomm);
+    SC_CHECK_MPI (mpiret);
+    if (boundary_changed_global) {
+      t8_forest_ghost_unref (&forest->ghosts);
+      t8_forest_ghost_create (forest);
+    }
+  }
+  /* Resize the ghost entries of the element data fields to the updated
+   * ghost count. Their values are filled by the next field exchange. */
+  if (forest->fields != NULL) {
+    for (ifield = 0; ifield < forest->fields->elem_count; ifield++) {
+      t8_forest_field_struct_t *field = (t8_forest_field_struct_t *)
+        sc_array_index (forest->fields, ifield);
+      sc_array_resize (field->data, (size_t) forest->local_num_elements
+                       + (size_t) t8_forest_get_num_ghosts (forest));
+    }
+  }
+
+  /* Fire the registered cache invalidation hooks for the changed trees */
+  if (forest->cache_hooks != NULL) {
+    for (ihook = 0; ihook < forest->cache_hooks->elem_count; ihook++) {
+      const t8_forest_cache_hook_struct_t *hook =
+        (const t8_forest_cache_hook_struct_t *)
+        sc_array_index (forest->cache_hooks, ihook);
+      itree = -1;
+      for (iwork = 0; iwork < num_directives; iwork++) {
+        if (work[iwork].ltreeid != itree) {
+          itree = work[iwork].ltreeid;
+          hook->callback (forest, itree, hook->user_data);
+        }
+      }
+    }
+  }
+  T8_FREE (work);
 }
 
 /* This is a deprecated version of the element_find_owner algorithm which
@@ -0,0 +1,234 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_forest/t8_forest_decimate.h>
+#include <t8_forest/t8_forest_geometrical.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_element_cxx.hxx>
+
+/* Return true if the centroid of \a element lies inside the closed box
+ * [box_min, box_max]. */
+static int
+t8_forest_decimation_cell_in_box (t8_forest_t forest, t8_locidx_t ltreeid,
+                                  const t8_element_t *element,
+                                  const double *box_min,
+                                  const double *box_max)
+{
+  double              centroid[3];
+  int                 idim;
+
+  t8_forest_element_centroid (forest, ltreeid, element, centroid);
+  for (idim = 0; idim < 3; idim++) {
+    if (centroid[idim] < box_min[idim] || centroid[idim] > box_max[idim]) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+t8_forest_decimation_plan_t *
+t8_forest_decimation_plan_new (t8_forest_t forest, int max_level,
+                               const double *box_min, const double *box_max)
+{
+  t8_forest_decimation_plan_t *plan;
+  t8_forest_decimation_cell_t *cell;
+  t8_locidx_t         num_local_trees, itree;
+  t8_locidx_t         num_tree_elems, ielem;
+  t8_gloidx_t         local_num_cells;
+  int                 mpiret;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= max_level);
+  T8_ASSERT ((box_min == NULL) == (box_max == NULL));
+
+  plan = T8_ALLOC_ZERO (t8_forest_decimation_plan_t, 1);
+  t8_forest_ref (forest);
+  plan->forest = forest;
+  sc_array_init (&plan->cells, sizeof (t8_forest_decimation_cell_t));
+
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0; itree < num_local_trees; itree++) {
+    const t8_eclass_t   tree_class =
+      t8_forest_get_tree_class (forest, itree);
+    t8_eclass_scheme_c *ts =
+      t8_forest_get_eclass_scheme (forest, tree_class);
+
+    num_tree_elems = t8_forest_get_tree_num_elements (forest, itree);
+    ielem = 0;
+    while (ielem < num_tree_elems) {
+      const t8_element_t *element =
+        t8_forest_get_element_in_tree (forest, itree, ielem);
+      const t8_element_t *cell_element = element;
+      t8_element_t       *ancestor = NULL;
+      t8_locidx_t         count = 1;
+
+      if (ts->t8_element_level (element) > max_level) {
+        /* Aggregate this element and all following elements below the
+         * same level max_level ancestor. The linear id truncated to
+         * max_level identifies that ancestor, so the span is found
+         * without constructing any intermediate elements. */
+        const t8_linearidx_t ancestor_id =
+          ts->t8_element_get_linear_id (element, max_level);
+
+        while (ielem + count < num_tree_elems) {
+          const t8_element_t *next =
+            t8_forest_get_element_in_tree (forest, itree, ielem + count);
+          if (ts->t8_element_level (next) <= max_level
+              || ts->t8_element_get_linear_id (next, max_level)
+              != ancestor_id) {
+            break;
+          }
+          count++;
+        }
+        ts->t8_element_new (1, &ancestor);
+        ts->t8_element_set_linear_id (ancestor, max_level, ancestor_id);
+        cell_element = ancestor;
+      }
+
+      if (box_min == NULL
+          || t8_forest_decimation_cell_in_box (forest, itree, cell_element,
+                                               box_min, box_max)) {
+        cell = (t8_forest_decimation_cell_t *)
+          sc_array_push (&plan->cells);
+        cell->ltreeid = itree;
+        cell->first = ielem;
+        cell->count = count;
+        cell->element = ancestor;
+      }
+      else if (ancestor != NULL) {
+        /* The cell is filtered out, drop its ancestor again. */
+        ts->t8_element_destroy (1, &ancestor);
+      }
+      ielem += count;
+    }
+  }
+
+  /* Compute the global cell count and the global index of this process'
+   * first output cell. */
+  local_num_cells = (t8_gloidx_t) plan->cells.elem_count;
+  mpiret = sc_MPI_Allreduce (&local_num_cells, &plan->global_num_cells, 1,
+                             T8_MPI_GLOIDX, sc_MPI_SUM, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Exscan (&local_num_cells, &plan->first_cell_id, 1,
+                          T8_MPI_GLOIDX, sc_MPI_SUM, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  if (forest->mpirank == 0) {
+    /* Exscan leaves the buffer of rank 0 undefined. */
+    plan->first_cell_id = 0;
+  }
+  return plan;
+}
+
+t8_locidx_t
+t8_forest_decimation_plan_num_cells (const t8_forest_decimation_plan_t *plan)
+{
+  T8_ASSERT (plan != NULL);
+  return (t8_locidx_t) plan->cells.elem_count;
+}
+
+const t8_forest_decimation_cell_t *
+t8_forest_decimation_plan_get_cell (const t8_forest_decimation_plan_t *plan,
+                                    t8_locidx_t icell)
+{
+  T8_ASSERT (plan != NULL);
+  T8_ASSERT (0 <= icell && (size_t) icell < plan->cells.elem_count);
+  return (const t8_forest_decimation_cell_t *)
+    sc_array_index ((sc_array_t *) &plan->cells, (size_t) icell);
+}
+
+const t8_element_t *
+t8_forest_decimation_cell_element (const t8_forest_decimation_plan_t *plan,
+                                   const t8_forest_decimation_cell_t *cell)
+{
+  T8_ASSERT (plan != NULL && cell != NULL);
+  if (cell->element != NULL) {
+    return cell->element;
+  }
+  return t8_forest_get_element_in_tree (plan->forest, cell->ltreeid,
+                                        cell->first);
+}
+
+double
+t8_forest_decimation_reduce_cell (t8_forest_decimation_plan_t *plan,
+                                  t8_locidx_t icell, const double *values,
+                                  size_t stride, size_t component,
+                                  t8_forest_reduce_fn reduce_fn,
+                                  void *user_data)
+{
+  const t8_forest_decimation_cell_t *cell =
+    t8_forest_decimation_plan_get_cell (plan, icell);
+  const t8_locidx_t   first_elem =
+    t8_forest_get_tree_element_offset (plan->forest, cell->ltreeid)
+    + cell->first;
+  const double       *first_value =
+    values + (size_t) first_elem * stride + component;
+  t8_locidx_t         imember;
+
+  T8_ASSERT (component < stride);
+  if (reduce_fn == NULL) {
+    /* Default reduction: the arithmetic mean of the member values. */
+    double              sum = 0;
+
+    for (imember = 0; imember < cell->count; imember++) {
+      sum += first_value[(size_t) imember * stride];
+    }
+    return sum / cell->count;
+  }
+  if (stride == 1) {
+    return reduce_fn (first_value, cell->count, user_data);
+  }
+  /* Stage the strided values contiguously for the callback. */
+  if ((size_t) cell->count > plan->scratch_size) {
+    plan->scratch = T8_REALLOC (plan->scratch, double, (size_t) cell->count);
+    plan->scratch_size = (size_t) cell->count;
+  }
+  for (imember = 0; imember < cell->count; imember++) {
+    plan->scratch[imember] = first_value[(size_t) imember * stride];
+  }
+  return reduce_fn (plan->scratch, cell->count, user_data);
+}
+
+void
+t8_forest_decimation_plan_destroy (t8_forest_decimation_plan_t **pplan)
+{
+  t8_forest_decimation_plan_t *plan;
+  size_t              icell;
+
+  T8_ASSERT (pplan != NULL && *pplan != NULL);
+  plan = *pplan;
+  for (icell = 0; icell < plan->cells.elem_count; icell++) {
+    t8_forest_decimation_cell_t *cell = (t8_forest_decimation_cell_t *)
+      sc_array_index (&plan->cells, icell);
+    if (cell->element != NULL) {
+      const t8_eclass_t   tree_class =
+        t8_forest_get_tree_class (plan->forest, cell->ltreeid);
+      t8_eclass_scheme_c *ts =
+        t8_forest_get_eclass_scheme (plan->forest, tree_class);
+      ts->t8_element_destroy (1, &cell->element);
+    }
+  }
+  sc_array_reset (&plan->cells);
+  T8_FREE (plan->scratch);
+  t8_forest_unref (&plan->forest);
+  T8_FREE (plan);
+  *pplan = NULL;
+}
@@ -0,0 +1,178 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_decimate.h
+ * Writer side decimation of a forest.
+ * Full resolution dumps of large forests are rarely needed for
+ * visualization. A decimation plan describes a down sampled view of a
+ * committed forest without modifying it: elements finer than a maximum
+ * output level are aggregated to their ancestor of that level and an
+ * optional axis aligned box drops all output cells whose centroid lies
+ * outside of it. The plan stores one small entry per output cell, so
+ * its memory is proportional to the decimated output and never to the
+ * full forest. The output writers iterate the plan instead of the
+ * element arrays and reduce the per element data of an aggregated cell
+ * with a user provided reduction function.
+ * \see t8_forest_vtk_write_file_decimated
+ * \see t8_forest_write_netcdf_decimated
+ */
+
+#ifndef T8_FOREST_DECIMATE_H
+#define T8_FOREST_DECIMATE_H
+
+#include <t8_forest/t8_forest_general.h>
+
+T8_EXTERN_C_BEGIN ();
+
+/** Reduce the data values of the member elements of an aggregated output
+ * cell to a single output value.
+ * \param [in] values     The \a num_values data values of the members,
+ *                        stored contiguously in ascending element order.
+ * \param [in] num_values The number of member elements, at least 1.
+ * \param [in] user_data  The user pointer passed alongside the function.
+ * \return                The reduced value written for the output cell.
+ */
+typedef double      (*t8_forest_reduce_fn) (const double *values,
+                                            t8_locidx_t num_values,
+                                            void *user_data);
+
+/** One output cell of a decimation plan.
+ * The cell represents the \a count consecutive elements starting at the
+ * tree local index \a first in tree \a ltreeid. If \a count is 1 the
+ * output element is the forest element itself, otherwise it is the
+ * common level capped ancestor of the members, owned by the plan. */
+typedef struct t8_forest_decimation_cell
+{
+  t8_locidx_t         ltreeid;  /**< The local tree of the member elements. */
+  t8_locidx_t         first;    /**< Tree local index of the first member. */
+  t8_locidx_t         count;    /**< The number of aggregated members. */
+  t8_element_t       *element;  /**< The ancestor element if \a count > 1,
+                                     NULL otherwise. Owned by the plan. */
+} t8_forest_decimation_cell_t;
+
+/** A decimation plan. \see t8_forest_decimation_plan_new */
+typedef struct t8_forest_decimation_plan
+{
+  t8_forest_t         forest;   /**< The forest the plan was built for.
+                                     The plan holds a reference. */
+  sc_array_t          cells;    /**< The output cells of this process, of
+                                     type t8_forest_decimation_cell_t. */
+  t8_gloidx_t         global_num_cells; /**< The number of output cells over
+                                     all processes. */
+  t8_gloidx_t         first_cell_id;    /**< The global index of this process'
+                                     first output cell. */
+  double             *scratch;  /**< Staging buffer for strided reductions. */
+  size_t              scratch_size;     /**< The capacity of \a scratch. */
+} t8_forest_decimation_plan_t;
+
+/** Build a decimation plan for a committed forest.
+ * This function is collective over the forest's communicator.
+ * Elements of level greater than \a max_level are aggregated to their
+ * ancestor of level \a max_level; since the elements are stored in space
+ * filling curve order, the members of one ancestor are consecutive and
+ * the plan records them as a single cell. If the partition cuts through
+ * the descendants of an ancestor, each process emits a cell for its own
+ * members; such a boundary ancestor then appears once per sharing
+ * process.
+ * \param [in] forest    A committed forest. The plan takes a reference.
+ * \param [in] max_level The maximum refinement level of the output.
+ *                       Elements of this level or coarser pass through
+ *                       unchanged.
+ * \param [in] box_min   If not NULL, the minimal corner of an axis aligned
+ *                       filter box (3 entries). Output cells whose centroid
+ *                       lies outside the box are dropped.
+ * \param [in] box_max   The maximal corner of the filter box, or NULL.
+ *                       Must be NULL if and only if \a box_min is NULL.
+ * \return               The newly allocated plan. Free it with
+ *                       \ref t8_forest_decimation_plan_destroy.
+ */
+t8_forest_decimation_plan_t *t8_forest_decimation_plan_new (t8_forest_t
+                                                            forest,
+                                                            int max_level,
+                                                            const double
+                                                            *box_min,
+                                                            const double
+                                                            *box_max);
+
+/** Return the number of output cells of this process.
+ * \param [in] plan     A decimation plan.
+ * \return              The number of entries in \a plan->cells.
+ */
+t8_locidx_t         t8_forest_decimation_plan_num_cells (const
+                                                         t8_forest_decimation_plan_t
+                                                         *plan);
+
+/** Return the \a icell-th output cell of a plan.
+ * \param [in] plan     A decimation plan.
+ * \param [in] icell    An index, 0 <= \a icell <
+ *                      \ref t8_forest_decimation_plan_num_cells.
+ * \return              A pointer into the plan's cell array.
+ */
+const t8_forest_decimation_cell_t
+  *t8_forest_decimation_plan_get_cell (const t8_forest_decimation_plan_t
+                                       *plan, t8_locidx_t icell);
+
+/** Return the output element of a cell.
+ * For an aggregated cell this is the plan owned ancestor, otherwise the
+ * forest element itself.
+ * \param [in] plan     A decimation plan.
+ * \param [in] cell     A cell of \a plan.
+ * \return              The element to write for this cell.
+ */
+const t8_element_t *t8_forest_decimation_cell_element (const
+                                                       t8_forest_decimation_plan_t
+                                                       *plan,
+                                                       const
+                                                       t8_forest_decimation_cell_t
+                                                       *cell);
+
+/** Reduce the per element data of an output cell to its output value.
+ * \param [in,out] plan A decimation plan. The plan's scratch buffer may
+ *                      grow to stage strided values.
+ * \param [in] icell    The index of the output cell.
+ * \param [in] values   The per element data, indexed by the local element
+ *                      index (over all local trees) times \a stride plus
+ *                      \a component.
+ * \param [in] stride   The number of data entries per element, 1 for
+ *                      scalar data and 3 for one component of vector data.
+ * \param [in] component The component to reduce, 0 <= \a component <
+ *                      \a stride.
+ * \param [in] reduce_fn The reduction function, or NULL for the
+ *                      arithmetic mean of the member values.
+ * \param [in] user_data Passed through to \a reduce_fn.
+ * \return              The reduced value of the cell.
+ */
+double              t8_forest_decimation_reduce_cell
+  (t8_forest_decimation_plan_t *plan, t8_locidx_t icell,
+   const double *values, size_t stride, size_t component,
+   t8_forest_reduce_fn reduce_fn, void *user_data);
+
+/** Destroy a decimation plan, its owned ancestor elements and release
+ * the reference on the forest.
+ * \param [in,out] pplan Pointer to a plan. Set to NULL on output.
+ */
+void                t8_forest_decimation_plan_destroy
+  (t8_forest_decimation_plan_t **pplan);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_FOREST_DECIMATE_H */
@@ -0,0 +1,492 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/* In this file we implement the device resident forest mirror, see
+ * t8_forest_device.h. The mirror keeps a host staging copy of the leaf
+ * buffers, so that an incremental sync can fill the changed runs on the
+ * host from the forest delta and only transfer those, and so that moved
+ * runs can be re-uploaded when the application provides no device to
+ * device copy. */
+
+#include <t8_element_cxx.hxx>
+#include <t8_data/t8_containers.h>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_adapt.h>
+#include <t8_forest/t8_forest_device.h>
+#include <t8_forest/t8_forest_ghost.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_forest/t8_forest_private.h>
+
+/* Convenience wrappers around the memory operations of a mirror */
+
+static void        *
+t8_forest_device_alloc (t8_forest_device_mirror_t *mirror, size_t bytes)
+{
+  return mirror->memops.alloc (bytes, mirror->memops.user);
+}
+
+static void
+t8_forest_device_free (t8_forest_device_mirror_t *mirror, void *ptr)
+{
+  if (ptr != NULL) {
+    mirror->memops.free_mem (ptr, mirror->memops.user);
+  }
+}
+
+static void
+t8_forest_device_upload (t8_forest_device_mirror_t *mirror, void *device_dst,
+                         const void *host_src, size_t bytes)
+{
+  if (bytes > 0) {
+    mirror->memops.copy_to_device (device_dst, host_src, bytes,
+                                   mirror->memops.user);
+  }
+}
+
+/* Fill the host staging entries of the ghost leafs: the linear id at
+ * the maximum level and the level of each ghost leaf. The arrays must
+ * provide num_ghosts entries; the ghost leafs are written from
+ * position 0. */
+static void
+t8_forest_device_fill_ghosts (t8_forest_t forest, t8_linearidx_t *keys,
+                              int8_t *levels)
+{
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *element;
+  t8_locidx_t         itree, ielement, num_trees, num_tree_elements;
+  t8_locidx_t         position;
+
+  if (forest->ghosts == NULL) {
+    return;
+  }
+  position = 0;
+  num_trees = t8_forest_ghost_num_trees (forest);
+  for (itree = 0; itree < num_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_ghost_get_tree_class
+                                      (forest, itree));
+    num_tree_elements = (t8_locidx_t)
+      t8_element_array_get_count (t8_forest_ghost_get_tree_elements
+                                  (forest, itree));
+    for (ielement = 0; ielement < num_tree_elements; ielement++) {
+      element = t8_forest_ghost_get_element (forest, itree, ielement);
+      keys[position] = ts->t8_element_get_linear_id (element,
+                                                     forest->maxlevel);
+      levels[position] = (int8_t) ts->t8_element_level (element);
+      position++;
+    }
+  }
+  T8_ASSERT (position == t8_forest_get_num_ghosts (forest));
+}
+
+/* Fill the host staging arrays of the leaf buffers: the local leafs,
+ * followed by the ghost leafs. The staging arrays must provide
+ * num_local + num_ghosts entries. */
+static void
+t8_forest_device_fill_leafs (t8_forest_t forest, t8_linearidx_t *keys,
+                             int8_t *levels)
+{
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *element;
+  t8_locidx_t         itree, ielement, num_trees, num_tree_elements;
+  t8_locidx_t         position;
+
+  position = 0;
+  num_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0; itree < num_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    num_tree_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielement = 0; ielement < num_tree_elements; ielement++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielement);
+      keys[position] = ts->t8_element_get_linear_id (element,
+                                                     forest->maxlevel);
+      levels[position] = (int8_t) ts->t8_element_level (element);
+      position++;
+    }
+  }
+  T8_ASSERT (position == t8_forest_get_local_num_elements (forest));
+  t8_forest_device_fill_ghosts (forest, keys + position, levels + position);
+}
+
+/* Fill the host staging entries of a run of new elements from the new
+ * forest, [new_start, new_start + count) in local element numbering. */
+static void
+t8_forest_device_fill_run (t8_forest_t forest, t8_locidx_t new_start,
+                           t8_locidx_t count, t8_linearidx_t *keys,
+                           int8_t *levels)
+{
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *element;
+  t8_locidx_t         ielement, ltreeid;
+
+  for (ielement = new_start; ielement < new_start + count; ielement++) {
+    element = t8_forest_get_element (forest, ielement, &ltreeid);
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                ltreeid));
+    keys[ielement] = ts->t8_element_get_linear_id (element,
+                                                   forest->maxlevel);
+    levels[ielement] = (int8_t) ts->t8_element_level (element);
+  }
+}
+
+/* Free the device buffers of the tree offsets, the face index and the
+ * ghost gather lists of a mirror. */
+static void
+t8_forest_device_release_structure (t8_forest_device_mirror_t *mirror)
+{
+  t8_forest_device_free (mirror, mirror->d_tree_offsets);
+  t8_forest_device_free (mirror, mirror->d_face_offsets);
+  t8_forest_device_free (mirror, mirror->d_entry_offsets);
+  t8_forest_device_free (mirror, mirror->d_face_neighbors);
+  t8_forest_device_free (mirror, mirror->d_dual_faces);
+  t8_forest_device_free (mirror, mirror->d_send_indices);
+  T8_FREE (mirror->send_offsets);
+  mirror->d_tree_offsets = NULL;
+  mirror->d_face_offsets = NULL;
+  mirror->d_entry_offsets = NULL;
+  mirror->d_face_neighbors = NULL;
+  mirror->d_dual_faces = NULL;
+  mirror->d_send_indices = NULL;
+  mirror->send_offsets = NULL;
+  mirror->num_faces = 0;
+  mirror->num_face_entries = 0;
+  mirror->num_remotes = 0;
+}
+
+/* Upload the tree offsets, the face neighbor index and the ghost gather
+ * lists of the mirrored forest. These buffers are small against the
+ * leaf arrays (offsets) or recomputed on the host after an adapt anyway
+ * (face index, gather lists), so they are always transferred as a
+ * whole. */
+static void
+t8_forest_device_upload_structure (t8_forest_device_mirror_t *mirror,
+                                   t8_forest_t forest)
+{
+  t8_locidx_t        *offsets;
+  t8_locidx_t         itree, num_indices;
+  size_t              bytes;
+
+  t8_forest_device_release_structure (mirror);
+
+  /* The per tree element offsets */
+  offsets = T8_ALLOC (t8_locidx_t, mirror->num_trees + 1);
+  for (itree = 0; itree < mirror->num_trees; itree++) {
+    offsets[itree] = t8_forest_get_tree_element_offset (forest, itree);
+  }
+  offsets[mirror->num_trees] = mirror->num_local_elements;
+  bytes = (mirror->num_trees + 1) * sizeof (t8_locidx_t);
+  mirror->d_tree_offsets = (t8_locidx_t *)
+    t8_forest_device_alloc (mirror, bytes);
+  t8_forest_device_upload (mirror, mirror->d_tree_offsets, offsets, bytes);
+  T8_FREE (offsets);
+
+  /* The face neighbor index, if the forest carries one */
+  if (forest->face_neighbor_index != NULL) {
+    const t8_forest_face_neighbor_index_t index =
+      forest->face_neighbor_index;
+
+    T8_ASSERT (index->num_local_elements == mirror->num_local_elements);
+    mirror->num_faces = index->face_offsets[index->num_local_elements];
+    mirror->num_face_entries = index->neighbor_offsets[mirror->num_faces];
+
+    bytes = (index->num_local_elements + 1) * sizeof (t8_locidx_t);
+    mirror->d_face_offsets = (t8_locidx_t *)
+      t8_forest_device_alloc (mirror, bytes);
+    t8_forest_device_upload (mirror, mirror->d_face_offsets,
+                             index->face_offsets, bytes);
+    bytes = (mirror->num_faces + 1) * sizeof (t8_locidx_t);
+    mirror->d_entry_offsets = (t8_locidx_t *)
+      t8_forest_device_alloc (mirror, bytes);
+    t8_forest_device_upload (mirror, mirror->d_entry_offsets,
+                             index->neighbor_offsets, bytes);
+    bytes = mirror->num_face_entries * sizeof (t8_locidx_t);
+    mirror->d_face_neighbors = (t8_locidx_t *)
+      t8_forest_device_alloc (mirror, bytes);
+    t8_forest_device_upload (mirror, mirror->d_face_neighbors,
+                             index->neighbors, bytes);
+    bytes = mirror->num_face_entries * sizeof (int8_t);
+    mirror->d_dual_faces = (int8_t *)
+      t8_forest_device_alloc (mirror, bytes);
+    t8_forest_device_upload (mirror, mirror->d_dual_faces,
+                             index->dual_faces, bytes);
+  }
+
+  /* The gather index lists of the ghost exchange */
+  if (forest->ghosts != NULL) {
+    const t8_locidx_t  *send_indices;
+    int                 iremote;
+
+    (void) t8_forest_ghost_get_remotes (forest, &mirror->num_remotes);
+    mirror->send_offsets = T8_ALLOC (t8_locidx_t, mirror->num_remotes + 1);
+    mirror->send_offsets[0] = 0;
+    for (iremote = 0; iremote < mirror->num_remotes; iremote++) {
+      (void) t8_forest_ghost_remote_send_indices (forest, iremote,
+                                                  &num_indices);
+      mirror->send_offsets[iremote + 1] =
+        mirror->send_offsets[iremote] + num_indices;
+    }
+    bytes = mirror->send_offsets[mirror->num_remotes]
+      * sizeof (t8_locidx_t);
+    mirror->d_send_indices = (t8_locidx_t *)
+      t8_forest_device_alloc (mirror, bytes > 0 ? bytes
+                              : sizeof (t8_locidx_t));
+    for (iremote = 0; iremote < mirror->num_remotes; iremote++) {
+      send_indices = t8_forest_ghost_remote_send_indices (forest, iremote,
+                                                          &num_indices);
+      t8_forest_device_upload (mirror,
+                               mirror->d_send_indices
+                               + mirror->send_offsets[iremote],
+                               send_indices,
+                               num_indices * sizeof (t8_locidx_t));
+    }
+  }
+}
+
+/* Fill the staging arrays for a forest and upload the leaf buffers as a
+ * whole, growing the device buffers if needed. The counts of the mirror
+ * must already be updated. */
+static void
+t8_forest_device_upload_leafs_full (t8_forest_device_mirror_t *mirror,
+                                    t8_forest_t forest)
+{
+  const t8_locidx_t   num_total =
+    mirror->num_local_elements + mirror->num_ghosts;
+
+  T8_FREE (mirror->h_leaf_keys);
+  T8_FREE (mirror->h_leaf_levels);
+  mirror->h_leaf_keys = T8_ALLOC (t8_linearidx_t, num_total);
+  mirror->h_leaf_levels = T8_ALLOC (int8_t, num_total);
+  t8_forest_device_fill_leafs (forest, mirror->h_leaf_keys,
+                               mirror->h_leaf_levels);
+  if (num_total > mirror->leaf_capacity) {
+    t8_forest_device_free (mirror, mirror->d_leaf_keys);
+    t8_forest_device_free (mirror, mirror->d_leaf_levels);
+    mirror->d_leaf_keys = (t8_linearidx_t *)
+      t8_forest_device_alloc (mirror, num_total * sizeof (t8_linearidx_t));
+    mirror->d_leaf_levels = (int8_t *)
+      t8_forest_device_alloc (mirror, num_total * sizeof (int8_t));
+    mirror->leaf_capacity = num_total;
+  }
+  t8_forest_device_upload (mirror, mirror->d_leaf_keys, mirror->h_leaf_keys,
+                           num_total * sizeof (t8_linearidx_t));
+  t8_forest_device_upload (mirror, mirror->d_leaf_levels,
+                           mirror->h_leaf_levels,
+                           num_total * sizeof (int8_t));
+}
+
+/* Move one kept run of the leaf buffers from its old to its new
+ * position, on the device if the application provides a device to
+ * device copy and from the host staging copy otherwise. */
+static void
+t8_forest_device_move_run (t8_forest_device_mirror_t *mirror,
+                           const t8_linearidx_t *new_keys,
+                           const int8_t *new_levels,
+                           const t8_forest_delta_run_t *run)
+{
+  if (mirror->memops.copy_on_device != NULL) {
+    mirror->memops.copy_on_device (mirror->d_leaf_keys + run->new_start,
+                                   mirror->d_leaf_keys + run->old_start,
+                                   run->count * sizeof (t8_linearidx_t),
+                                   mirror->memops.user);
+    mirror->memops.copy_on_device (mirror->d_leaf_levels + run->new_start,
+                                   mirror->d_leaf_levels + run->old_start,
+                                   run->count * sizeof (int8_t),
+                                   mirror->memops.user);
+  }
+  else {
+    t8_forest_device_upload (mirror, mirror->d_leaf_keys + run->new_start,
+                             new_keys + run->new_start,
+                             run->count * sizeof (t8_linearidx_t));
+    t8_forest_device_upload (mirror, mirror->d_leaf_levels + run->new_start,
+                             new_levels + run->new_start,
+                             run->count * sizeof (int8_t));
+  }
+}
+
+/* Update the leaf buffers of a mirror incrementally from a forest
+ * delta. The device buffers must be large enough for the new counts.
+ * The kept runs are moved in two sweeps like a memmove - runs that move
+ * towards the front in ascending order, runs that move towards the back
+ * in descending order - so that no run overwrites the old data of a
+ * later one; the added runs and the ghost section are then uploaded
+ * from the new staging arrays. */
+static void
+t8_forest_device_update_leafs_delta (t8_forest_device_mirror_t *mirror,
+                                     t8_forest_t forest,
+                                     t8_forest_delta_t *delta)
+{
+  const t8_locidx_t   num_total =
+    mirror->num_local_elements + mirror->num_ghosts;
+  t8_linearidx_t     *new_keys;
+  int8_t             *new_levels;
+  t8_forest_delta_run_t *run;
+  size_t              iz;
+
+  new_keys = T8_ALLOC (t8_linearidx_t, num_total);
+  new_levels = T8_ALLOC (int8_t, num_total);
+
+  /* Build the new staging arrays: kept runs copy from the old staging,
+   * added runs are computed from the new forest */
+  for (iz = 0; iz < delta->kept.elem_count; iz++) {
+    run = (t8_forest_delta_run_t *) sc_array_index (&delta->kept, iz);
+    memcpy (new_keys + run->new_start, mirror->h_leaf_keys + run->old_start,
+            run->count * sizeof (t8_linearidx_t));
+    memcpy (new_levels + run->new_start,
+            mirror->h_leaf_levels + run->old_start,
+            run->count * sizeof (int8_t));
+  }
+  for (iz = 0; iz < delta->added.elem_count; iz++) {
+    run = (t8_forest_delta_run_t *) sc_array_index (&delta->added, iz);
+    t8_forest_device_fill_run (forest, run->new_start, run->count,
+                               new_keys, new_levels);
+  }
+
+  /* Move the kept runs on the device */
+  for (iz = 0; iz < delta->kept.elem_count; iz++) {
+    run = (t8_forest_delta_run_t *) sc_array_index (&delta->kept, iz);
+    if (run->new_start < run->old_start) {
+      t8_forest_device_move_run (mirror, new_keys, new_levels, run);
+    }
+  }
+  for (iz = delta->kept.elem_count; iz > 0; iz--) {
+    run = (t8_forest_delta_run_t *) sc_array_index (&delta->kept, iz - 1);
+    if (run->new_start > run->old_start) {
+      t8_forest_device_move_run (mirror, new_keys, new_levels, run);
+    }
+  }
+  /* Upload the added runs */
+  for (iz = 0; iz < delta->added.elem_count; iz++) {
+    run = (t8_forest_delta_run_t *) sc_array_index (&delta->added, iz);
+    t8_forest_device_upload (mirror, mirror->d_leaf_keys + run->new_start,
+                             new_keys + run->new_start,
+                             run->count * sizeof (t8_linearidx_t));
+    t8_forest_device_upload (mirror, mirror->d_leaf_levels + run->new_start,
+                             new_levels + run->new_start,
+                             run->count * sizeof (int8_t));
+  }
+  /* The ghost layer was rebuilt by the adapt, upload its section */
+  if (mirror->num_ghosts > 0) {
+    t8_forest_device_fill_ghosts (forest,
+                                  new_keys + mirror->num_local_elements,
+                                  new_levels + mirror->num_local_elements);
+    t8_forest_device_upload (mirror,
+                             mirror->d_leaf_keys
+                             + mirror->num_local_elements,
+                             new_keys + mirror->num_local_elements,
+                             mirror->num_ghosts * sizeof (t8_linearidx_t));
+    t8_forest_device_upload (mirror,
+                             mirror->d_leaf_levels
+                             + mirror->num_local_elements,
+                             new_levels + mirror->num_local_elements,
+                             mirror->num_ghosts * sizeof (int8_t));
+  }
+
+  T8_FREE (mirror->h_leaf_keys);
+  T8_FREE (mirror->h_leaf_levels);
+  mirror->h_leaf_keys = new_keys;
+  mirror->h_leaf_levels = new_levels;
+}
+
+t8_forest_device_mirror_t *
+t8_forest_device_mirror_create (t8_forest_t forest,
+                                const t8_forest_device_memops_t *memops)
+{
+  t8_forest_device_mirror_t *mirror;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (memops != NULL);
+  T8_ASSERT (memops->alloc != NULL);
+  T8_ASSERT (memops->free_mem != NULL);
+  T8_ASSERT (memops->copy_to_device != NULL);
+
+  mirror = T8_ALLOC_ZERO (t8_forest_device_mirror_t, 1);
+  mirror->memops = *memops;
+  t8_forest_ref (forest);
+  mirror->forest = forest;
+  mirror->generation = t8_forest_get_generation (forest);
+  mirror->num_local_elements = t8_forest_get_local_num_elements (forest);
+  mirror->num_ghosts = t8_forest_get_num_ghosts (forest);
+  mirror->num_trees = t8_forest_get_num_local_trees (forest);
+  t8_forest_device_upload_leafs_full (mirror, forest);
+  t8_forest_device_upload_structure (mirror, forest);
+  return mirror;
+}
+
+int
+t8_forest_device_mirror_sync (t8_forest_device_mirror_t *mirror,
+                              t8_forest_t forest)
+{
+  t8_forest_delta_t  *delta;
+  t8_locidx_t         num_total;
+  int                 incremental;
+
+  T8_ASSERT (mirror != NULL);
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  incremental = t8_forest_delta_extract (forest, mirror->generation, &delta);
+  mirror->num_local_elements = t8_forest_get_local_num_elements (forest);
+  mirror->num_ghosts = t8_forest_get_num_ghosts (forest);
+  mirror->num_trees = t8_forest_get_num_local_trees (forest);
+  num_total = mirror->num_local_elements + mirror->num_ghosts;
+  if (incremental && num_total > mirror->leaf_capacity) {
+    /* The buffers are outgrown; an incremental update could not reuse
+     * any device resident data */
+    t8_forest_delta_destroy (&delta);
+    incremental = 0;
+  }
+  if (incremental) {
+    t8_forest_device_update_leafs_delta (mirror, forest, delta);
+    t8_forest_delta_destroy (&delta);
+  }
+  else {
+    t8_forest_device_upload_leafs_full (mirror, forest);
+  }
+  t8_forest_device_upload_structure (mirror, forest);
+  t8_forest_ref (forest);
+  t8_forest_unref (&mirror->forest);
+  mirror->forest = forest;
+  mirror->generation = t8_forest_get_generation (forest);
+  return incremental;
+}
+
+void
+t8_forest_device_mirror_destroy (t8_forest_device_mirror_t **pmirror)
+{
+  t8_forest_device_mirror_t *mirror;
+
+  T8_ASSERT (pmirror != NULL);
+  mirror = *pmirror;
+  if (mirror == NULL) {
+    return;
+  }
+  t8_forest_device_release_structure (mirror);
+  t8_forest_device_free (mirror, mirror->d_leaf_keys);
+  t8_forest_device_free (mirror, mirror->d_leaf_levels);
+  T8_FREE (mirror->h_leaf_keys);
+  T8_FREE (mirror->h_leaf_levels);
+  t8_forest_unref (&mirror->forest);
+  T8_FREE (mirror);
+  *pmirror = NULL;
+}
@@ -0,0 +1,179 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_device.h
+ * A device resident mirror of the structural data of a forest, so that
+ * solver kernels can traverse the forest natively on a GPU: the leaf
+ * keys (linear id and level per local and ghost leaf), the per tree
+ * element offsets, the face neighbor index in CSR form and the gather
+ * index lists of the ghost exchange are kept in device buffers that are
+ * described by a compact host side descriptor.
+ * t8code itself links against neither CUDA nor HIP. As with the raw
+ * ghost exchange (\ref t8_forest_ghost_exchange_data_raw_begin) the
+ * device specifics stay on the application side: the mirror drives a
+ * small vtable of memory operations (\ref t8_forest_device_memops_t)
+ * that the application implements with cudaMalloc/cudaMemcpy,
+ * hipMalloc/hipMemcpy or any other allocator. All device operations are
+ * issued inside \ref t8_forest_device_mirror_create and
+ * \ref t8_forest_device_mirror_sync, which are therefore the explicit
+ * synchronization points; between them the buffers are never touched
+ * and kernels may use them freely.
+ * After an adaptation that recorded the adapt journal
+ * (\ref t8_forest_set_adapt_journal), \ref t8_forest_device_mirror_sync
+ * updates the leaf buffers incrementally from the forest delta instead
+ * of re-uploading them: unchanged runs are moved on the device and only
+ * the new elements are transferred.
+ */
+
+#ifndef T8_FOREST_DEVICE_H
+#define T8_FOREST_DEVICE_H
+
+#include <t8_forest/t8_forest_general.h>
+
+T8_EXTERN_C_BEGIN ();
+
+/** The device memory operations a mirror is built on, implemented by
+ * the application with its GPU runtime of choice. The callbacks are
+ * only invoked from inside \ref t8_forest_device_mirror_create and
+ * \ref t8_forest_device_mirror_sync and must have completed their
+ * effect when they return (or when the application's stream is next
+ * synchronized, if all callbacks enqueue into one stream). */
+typedef struct t8_forest_device_memops
+{
+  /** Allocate \a bytes bytes of device memory and return the device
+   * pointer. Must not return NULL. */
+  void               *(*alloc) (size_t bytes, void *user);
+  /** Free a device pointer obtained from \b alloc. */
+  void                (*free_mem) (void *ptr, void *user);
+  /** Copy \a bytes bytes from host memory to device memory. */
+  void                (*copy_to_device) (void *device_dst,
+                                         const void *host_src, size_t bytes,
+                                         void *user);
+  /** Copy \a bytes bytes between two non-overlapping device ranges.
+   * May be NULL; the mirror then uploads moved ranges from the host
+   * again instead of moving them on the device. */
+  void                (*copy_on_device) (void *device_dst,
+                                         const void *device_src,
+                                         size_t bytes, void *user);
+  void               *user;     /**< Arbitrary pointer passed to all callbacks. */
+} t8_forest_device_memops_t;
+
+/** The descriptor of a device resident forest mirror.
+ * The d_ prefixed members are device pointers obtained from the
+ * application's \ref t8_forest_device_memops_t and are valid kernel
+ * arguments; all other members live on the host. The leaf arrays store
+ * the local elements first and the ghost elements behind them, numbered
+ * as in \ref t8_forest_leaf_face_neighbors, so the neighbor entries of
+ * the face index address both uniformly. */
+typedef struct t8_forest_device_mirror
+{
+  t8_forest_t         forest;   /**< The mirrored forest, referenced by the mirror. */
+  unsigned            generation;       /**< The forest generation the buffers reflect,
+                                             \see t8_forest_get_generation. */
+  t8_forest_device_memops_t memops;     /**< The device memory operations. */
+  t8_locidx_t         num_local_elements;       /**< The number of local leafs mirrored. */
+  t8_locidx_t         num_ghosts;       /**< The number of ghost leafs mirrored. */
+  t8_locidx_t         num_trees;        /**< The number of local trees. */
+  t8_linearidx_t     *d_leaf_keys;      /**< Device: for each local and ghost leaf its linear id
+                                             at the maximum level of the forest. */
+  int8_t             *d_leaf_levels;    /**< Device: for each local and ghost leaf its level. */
+  t8_locidx_t        *d_tree_offsets;   /**< Device: for each local tree the index of its first
+                                             leaf, \b num_trees + 1 entries; the last one is
+                                             \b num_local_elements. */
+  t8_locidx_t        *d_face_offsets;   /**< Device: CSR row offsets of the face neighbor index,
+                                             \b num_local_elements + 1 entries, or NULL if the
+                                             forest carries no face neighbor index. */
+  t8_locidx_t        *d_entry_offsets;  /**< Device: for each element face the index of its first
+                                             neighbor entry, \b num_faces + 1 entries, or NULL. */
+  t8_locidx_t        *d_face_neighbors; /**< Device: the neighbor leaf indices of all faces,
+                                             \b num_face_entries entries, or NULL. */
+  int8_t             *d_dual_faces;     /**< Device: for each neighbor entry its dual face,
+                                             or NULL. */
+  t8_locidx_t         num_faces;        /**< The total face count of the face index, 0 if none. */
+  t8_locidx_t         num_face_entries; /**< The total neighbor entry count, 0 if none. */
+  t8_locidx_t        *d_send_indices;   /**< Device: the concatenated gather index lists of the
+                                             ghost exchange (\ref
+                                             t8_forest_ghost_remote_send_indices), or NULL if the
+                                             forest has no ghost layer. */
+  int                 num_remotes;      /**< The number of remote ranks of the ghost layer. */
+  t8_locidx_t        *send_offsets;     /**< Host: for each remote rank the offset of its list in
+                                             \b d_send_indices, \b num_remotes + 1 entries. */
+  /* The members below are internal to the mirror. */
+  t8_locidx_t         leaf_capacity;    /**< The allocated entry count of the leaf buffers. */
+  t8_linearidx_t     *h_leaf_keys;      /**< Host staging copy of \b d_leaf_keys. */
+  int8_t             *h_leaf_levels;    /**< Host staging copy of \b d_leaf_levels. */
+} t8_forest_device_mirror_t;
+
+/** Create a device mirror of a committed forest and upload all buffers.
+ * The face neighbor index is mirrored if the forest carries one, so
+ * call \ref t8_forest_face_neighbor_index_create beforehand if the
+ * kernels traverse faces; the ghost gather lists are mirrored if the
+ * forest has a ghost layer.
+ * \param [in]  forest  A committed forest. Referenced by the mirror and
+ *                      released again on destroy or when a sync moves
+ *                      the mirror to a newer forest.
+ * \param [in]  memops  The device memory operations; copied into the
+ *                      mirror. \b alloc, \b free_mem and
+ *                      \b copy_to_device must be set.
+ * \return              The mirror descriptor, to be released with
+ *                      \ref t8_forest_device_mirror_destroy.
+ */
+t8_forest_device_mirror_t *t8_forest_device_mirror_create (t8_forest_t
+                                                           forest,
+                                                           const
+                                                           t8_forest_device_memops_t
+                                                           *memops);
+
+/** Update a device mirror to a newer forest of the same lineage.
+ * If \a forest was adapted from the mirrored forest in a commit that
+ * recorded the adapt journal, the leaf buffers are updated from the
+ * forest delta: kept runs are moved on the device (or re-uploaded from
+ * the host staging copy if no \b copy_on_device callback is set) and
+ * only the new elements are uploaded. In every other case - several
+ * generations behind, no journal, adaptation fused with partition or
+ * balance, or leaf buffers outgrown - all buffers are re-uploaded. The
+ * tree offsets, the face index and the ghost gather lists are always
+ * uploaded anew; they are small against the leaf arrays respectively
+ * rebuilt on the host anyway.
+ * \param [in,out] mirror  A mirror created by
+ *                      \ref t8_forest_device_mirror_create.
+ * \param [in]  forest  A committed forest derived from the currently
+ *                      mirrored forest. Referenced by the mirror in
+ *                      place of the previous forest.
+ * \return              True if the leaf buffers were updated
+ *                      incrementally, false if they were re-uploaded
+ *                      fully.
+ */
+int                 t8_forest_device_mirror_sync (t8_forest_device_mirror_t
+                                                  *mirror,
+                                                  t8_forest_t forest);
+
+/** Free all device buffers of a mirror, release the mirrored forest and
+ * set the pointer to NULL.
+ * \param [in,out] pmirror  Pointer to a mirror; may point to NULL.
+ */
+void                t8_forest_device_mirror_destroy (t8_forest_device_mirror_t
+                                                     **pmirror);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_FOREST_DEVICE_H */
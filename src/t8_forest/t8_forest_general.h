@@ -37,6 +37,11 @@
 typedef struct t8_forest *t8_forest_t;
 typedef struct t8_tree *t8_tree_t;
 
+/** Opaque pointer to a forest commit context. A commit context survives
+ * across derived forests and owns the resources that are reused by every
+ * commit of a forest pipeline. \see t8_forest_set_commit_context. */
+typedef struct t8_forest_commit_context *t8_forest_commit_context_t;
+
 /** This type controls, which neighbors count as ghost elements.
  * Currently, we support face-neighbors. Vertex and edge neighbors
  * will eventually be added. */
@@ -127,6 +132,136 @@ typedef int         (*t8_forest_adapt_t) (t8_forest_t forest,
                                           const int num_elements,
                                           t8_element_t *elements[]);
 
+/** Batched callback function prototype to decide for refining and coarsening.
+ * In contrast to \ref t8_forest_adapt_t, this callback is invoked only once
+ * per local tree and receives the whole element array of the tree, so the
+ * caller can evaluate its refinement criterion over contiguous element
+ * ranges (for example vectorized) without per-element callback dispatch.
+ * The callback must fill \a refine_flags with one entry per element:
+ *          1 if the element should be refined,
+ *         -1 if the element may be coarsened with its family,
+ *         -2 if the element should be removed,
+ *          0 else.
+ * A family is only coarsened if all of its members are flagged -1.
+ * \param [in] forest       the forest to which the new elements belong
+ * \param [in] forest_from  the forest that is adapted.
+ * \param [in] which_tree   the local tree whose elements are passed
+ * \param [in] ts           the eclass scheme of the tree
+ * \param [in] num_elements the number of elements in \a elements
+ * \param [in] elements     the element array of tree \a which_tree in \a forest_from
+ * \param [out] refine_flags array of \a num_elements flags to be filled by the callback.
+ *                          All entries are initialized to 0.
+ */
+typedef void        (*t8_forest_adapt_batched_t) (t8_forest_t forest,
+                                                  t8_forest_t forest_from,
+                                                  t8_locidx_t which_tree,
+                                                  t8_eclass_scheme_c *ts,
+                                                  const t8_locidx_t
+                                                  num_elements,
+                                                  const t8_element_array_t
+                                                  *elements,
+                                                  short *refine_flags);
+
+/** Callback function prototype of a ghost filter predicate.
+ * The predicate is evaluated during the remote collection phase of ghost
+ * creation for every local boundary element that is about to become a
+ * remote (and thus a ghost on another process),
+ * \see t8_forest_set_ghost_filter.
+ * \param [in] forest       the forest whose ghost layer is built
+ * \param [in] ltreeid      the local tree containing \a element
+ * \param [in] element      the local boundary element in question
+ * \param [in] user_data    the pointer the filter was registered with
+ * \return  Nonzero if \a element should become a ghost, zero to drop it.
+ */
+typedef int         (*t8_forest_ghost_filter_t) (t8_forest_t forest,
+                                                 t8_locidx_t ltreeid,
+                                                 const t8_element_t *element,
+                                                 void *user_data);
+
+/** Callback function prototype of a refinement predictor for speculative
+ * child generation, \see t8_forest_set_speculation.
+ * The predictor is evaluated on the leaf elements of a committed forest
+ * during communication wait windows and returns whether the leaf will
+ * likely be refined by the next adaptation. The children of flagged leafs
+ * are pre-generated into a side pool that the next \ref t8_forest_adapt
+ * consumes on a hit instead of computing them. A wrong prediction only
+ * wastes the pre-generation; the adapted forest is identical either way.
+ * \param [in] forest       the committed forest the prediction refers to
+ * \param [in] which_tree   the local tree containing \a element
+ * \param [in] ts           the eclass scheme of the tree
+ * \param [in] lelement_id  the local element id of \a element in \a which_tree
+ * \param [in] element      the leaf element in question
+ * \param [in] user_data    the pointer the predictor was registered with
+ * \return  Nonzero if \a element will likely be refined, zero otherwise.
+ */
+typedef int         (*t8_forest_speculate_t) (t8_forest_t forest,
+                                              t8_locidx_t which_tree,
+                                              t8_eclass_scheme_c *ts,
+                                              t8_locidx_t lelement_id,
+                                              const t8_element_t *element,
+                                              void *user_data);
+
+/** Callback function prototype of a cache invalidation hook.
+ * Registered hooks are fired at the end of \ref t8_forest_commit once per
+ * local tree whose leaf elements changed, \see t8_forest_cache_hook_register.
+ * \param [in] forest       the newly committed forest
+ * \param [in] ltreeid      the local id in \a forest of a tree whose leaf
+ *                          elements differ from the source forest
+ * \param [in] user_data    the pointer the hook was registered with
+ */
+typedef void        (*t8_forest_cache_invalidate_t) (t8_forest_t forest,
+                                                     t8_locidx_t ltreeid,
+                                                     void *user_data);
+
+/** Callback function prototype to prune whole subtrees from adaptation.
+ * If set via \ref t8_forest_set_adapt_prune, adaptation walks each local
+ * tree of the source forest top-down before the per leaf refinement
+ * decisions, starting at the nearest common ancestor of the tree's leafs.
+ * The callback is invoked on the ancestor elements of the leafs; if it
+ * returns true, all leaf descendants of \a element are kept unchanged and
+ * the adapt callback is never evaluated for them. If it returns false, the
+ * walk descends into the children of \a element.
+ * This way a coarse level criterion (for example a bounding box test
+ * against a shock front) can reject large quiescent regions with a handful
+ * of evaluations instead of one adapt callback per leaf.
+ * \param [in] forest       the forest to which the new elements belong
+ * \param [in] forest_from  the forest that is adapted.
+ * \param [in] which_tree   the local tree containing the leafs
+ * \param [in] ts           the eclass scheme of the tree
+ * \param [in] element      the currently considered ancestor element
+ * \param [in] is_leaf      true if and only if \a element is a leaf of \a forest_from
+ * \param [in] num_leafs    the number of leafs that are descendants of \a element
+ * \param [in] first_leaf   the tree local index of the first of these leafs
+ * \return nonzero if all leaf descendants of \a element should be kept
+ *         unchanged, zero to descend further.
+ */
+typedef int         (*t8_forest_adapt_prune_t) (t8_forest_t forest,
+                                                t8_forest_t forest_from,
+                                                t8_locidx_t which_tree,
+                                                t8_eclass_scheme_c *ts,
+                                                const t8_element_t *element,
+                                                const int is_leaf,
+                                                const t8_locidx_t num_leafs,
+                                                const t8_locidx_t
+                                                first_leaf);
+
+/** Callback function prototype to compute the partition weight of an element.
+ * If set via \ref t8_forest_set_partition_weights, partitioning assigns to
+ * each process a range of elements of (approximately) equal cumulative weight
+ * along the space-filling curve instead of an equal element count.
+ * \param [in] forest_from  the forest that is partitioned.
+ * \param [in] which_tree   the local tree containing \a element
+ * \param [in] lelement_id  the local element id of \a element in \a which_tree
+ * \param [in] ts           the eclass scheme of the tree
+ * \param [in] element      the element for which the weight is computed
+ * \return                  The non-negative weight of \a element.
+ */
+typedef double      (*t8_forest_partition_weight_t) (t8_forest_t forest_from,
+                                                     t8_locidx_t which_tree,
+                                                     t8_locidx_t lelement_id,
+                                                     t8_eclass_scheme_c *ts,
+                                                     t8_element_t *element);
+
   /** Create a new forest with reference count one.
  * This forest needs to be specialized with the t8_forest_set_* calls.
  * Currently it is manatory to either call the functions \ref
@@ -169,6 +304,25 @@ int                 t8_forest_is_committed (t8_forest_t forest);
  */
 int                 t8_forest_no_overlap (t8_forest_t forest);
 
+/** Check the leaf invariants of a committed forest in a single pass.
+ * Verifies that within each local tree the maxlevel descendant ranges of
+ * the elements are strictly ascending and disjoint -- so no element
+ * overlaps or precedes another along the space-filling curve -- that all
+ * element levels are valid, and, via one position handshake with the
+ * neighboring ranks, that the local element ranges of consecutive
+ * processes do not overlap. Holes in the curve are not an error, since
+ * incomplete forests may remove elements.
+ * Unlike \ref t8_forest_no_overlap this runs in O(local elements) with
+ * one small message per rank pair and one Allreduce, and is compiled in
+ * all configurations, so it is cheap enough to run after every commit in
+ * production.
+ * \param [in] forest   The forest to validate. Must be committed.
+ * \return              True if no process found a violation.
+ * \note This function is collective and returns the same value on all
+ * processes of the forest.
+ */
+int                 t8_forest_validate (t8_forest_t forest);
+
 /** Check whether two committed forests have the same local elements.
  * \param [in] forest_a The first forest.
  * \param [in] forest_b The second forest.
@@ -182,6 +336,43 @@ int                 t8_forest_no_overlap (t8_forest_t forest);
 int                 t8_forest_is_equal (t8_forest_t forest_a,
                                         t8_forest_t forest_b);
 
+/** A changed element range reported by \ref t8_forest_diff.
+ * The elements before \a first_a (respectively \a first_b) and after the
+ * range in the tree are identical in both forests. */
+typedef struct t8_forest_diff_range
+{
+  t8_locidx_t         ltree_id; /**< The local tree id of the changed range. */
+  t8_locidx_t         first_a;  /**< The first changed element in the tree in forest_a. */
+  t8_locidx_t         num_a;    /**< The number of changed elements in forest_a. May be 0. */
+  t8_locidx_t         first_b;  /**< The first changed element in the tree in forest_b. */
+  t8_locidx_t         num_b;    /**< The number of changed elements in forest_b. May be 0. */
+} t8_forest_diff_range_t;
+
+/** Compute the differing element ranges of two committed forests.
+ * For each local tree the identical leading and trailing elements are
+ * skipped and the remaining changed range is reported, one entry of type
+ * \ref t8_forest_diff_range_t per changed tree. Trees whose leaf
+ * checksums agree are short-circuited without an element comparison, so
+ * in steady state the cost is proportional to the changed elements plus
+ * one cheap checksum pass, not to a full element-wise comparison.
+ * Both forests must have the same local trees with the same schemes,
+ * for example two adapt stages of the same forest.
+ * \param [in]  forest_a     The first committed forest.
+ * \param [in]  forest_b     The second committed forest.
+ * \param [in,out] diff_ranges An initialized array of
+ *                           \ref t8_forest_diff_range_t entries. Its
+ *                           contents are overwritten with the changed
+ *                           ranges in ascending tree order.
+ * \return                   True if the forests have the same local
+ *                           elements, in which case \a diff_ranges is
+ *                           empty. \see t8_forest_is_equal
+ * \note This function is not collective. It only compares the local
+ * elements on the current rank.
+ */
+int                 t8_forest_diff (t8_forest_t forest_a,
+                                    t8_forest_t forest_b,
+                                    sc_array_t *diff_ranges);
+
 /** Set the cmesh associated to a forest.
  * By default, the forest takes ownership of the cmesh such that it will be
  * destroyed when the forest is destroyed.  To keep ownership of the cmesh,
@@ -264,6 +455,137 @@ void                t8_forest_set_adapt (t8_forest_t forest,
                                          t8_forest_adapt_t adapt_fn,
                                          int recursive);
 
+/** Set a source forest with a batched adapt callback to be adapted on commiting.
+ * The batched callback is invoked once per local tree with the tree's whole
+ * element array and fills an array of refine flags, see
+ * \ref t8_forest_adapt_batched_t. This avoids the per-element callback
+ * dispatch of \ref t8_forest_set_adapt and allows the criterion to be
+ * evaluated over contiguous element ranges.
+ * Ownership semantics of \b set_from are the same as in \ref t8_forest_set_adapt.
+ * \param [in,out] forest   The forest
+ * \param [in] set_from     The source forest from which \b forest will be adapted.
+ *                          We take ownership. This can be prevented by
+ *                          referencing \b set_from.
+ *                          If NULL, a previously (or later) set forest will
+ *                          be taken (\ref t8_forest_set_partition, \ref t8_forest_set_balance).
+ * \param [in] adapt_fn     The batched adapt callback used on commiting.
+ * \note Batched adaptation is never recursive, since the refine flags refer
+ * to the elements of \b set_from only.
+ * \note This setting can be combined with \ref t8_forest_set_partition and \ref
+ * t8_forest_set_balance and may not be combined with \ref t8_forest_set_adapt
+ * or \ref t8_forest_set_copy.
+ */
+void                t8_forest_set_adapt_batched (t8_forest_t forest,
+                                                 const t8_forest_t set_from,
+                                                 t8_forest_adapt_batched_t
+                                                 adapt_fn);
+
+/** Set a prune callback to skip the adapt callback on unchanged subtrees.
+ * If set, adaptation performs a top-down walk over each local tree of the
+ * source forest and keeps all leafs of subtrees accepted by \a prune_fn
+ * unchanged without evaluating the adapt callback for them,
+ * \see t8_forest_adapt_prune_t.
+ * Pruning is only supported for non-recursive adaptation, since recursive
+ * coarsening could otherwise merge leafs that the prune pass promised to
+ * keep unchanged.
+ * \param [in,out] forest   The forest, must be initialized and not committed.
+ * \param [in] prune_fn     The prune callback, or NULL to disable pruning.
+ */
+void                t8_forest_set_adapt_prune (t8_forest_t forest,
+                                               t8_forest_adapt_prune_t
+                                               prune_fn);
+
+/** A window of elements of one local tree to be adapted,
+ * \see t8_forest_set_adapt_region. */
+typedef struct t8_forest_adapt_region
+{
+  t8_locidx_t         ltree_id; /**< The local tree the window refers to. */
+  t8_locidx_t         start;    /**< Tree local index of the first element of the window. */
+  t8_locidx_t         end;      /**< One past the tree local index of the last element. */
+} t8_forest_adapt_region_t;
+
+/** Restrict the adapt callback sweep to a list of element windows.
+ * If regions are set, \ref t8_forest_adapt evaluates the adapt callback
+ * and the family detection only for the elements inside the given
+ * windows; all elements outside are copied to the new forest wholesale,
+ * without per element work. Use this when the refinement criterion is
+ * known to have changed only in small parts of the domain, for example
+ * near moving features, and the dirty element ranges are known from the
+ * solution update.
+ * Each window is clipped to its tree and extended to the enclosing
+ * family boundaries, so a family is never split between inside and
+ * outside; overlapping windows are merged. Elements of trees without a
+ * window are all copied wholesale.
+ * Regions are only supported for non-recursive adaptation with the per
+ * element adapt callback and apply to the next commit of \a forest.
+ * \param [in,out] forest      The forest, must be initialized and not
+ *                             committed.
+ * \param [in] regions         The windows to adapt, in no particular
+ *                             order. The array is copied. NULL to remove
+ *                             previously set regions.
+ * \param [in] num_regions     The number of entries of \a regions.
+ */
+void                t8_forest_set_adapt_region (t8_forest_t forest,
+                                                const t8_forest_adapt_region_t
+                                                *regions,
+                                                t8_locidx_t num_regions);
+
+/** Enable the memory lean adaptation mode of a forest.
+ * By default adaptation builds the complete new forest next to the source
+ * forest, which temporarily holds the old and the new leaf elements side by
+ * side. With this mode enabled the leaf storage of each source tree is freed
+ * as soon as that tree was adapted, so the peak memory stays close to the
+ * size of one forest plus a single tree.
+ * The mode only takes effect if the committed forest holds the only
+ * reference to its source forest, since the source leafs are destroyed
+ * during adaptation. It also disables the reuse of the source forest's
+ * ghost layer, because the reuse check compares the old and new leaf
+ * elements after adaptation.
+ * \param [in,out] forest   The forest, must be initialized and not committed.
+ * \param [in]     recycle  If true, enable the memory lean adaptation mode.
+ * \see t8_forest_set_adapt
+ */
+void                t8_forest_set_adapt_recycle (t8_forest_t forest,
+                                                 int recycle);
+
+/** Fuse the phases of a commit that combines adapt with partition or
+ * balance. By default such a commit materializes the adapted forest as
+ * a complete intermediate forest next to the source forest before
+ * partitioning it, which holds two full forests at the memory peak.
+ * With the fused mode enabled and this forest holding the only
+ * reference to its source, the pipeline consumes the source instead:
+ * its leaf storage is freed tree by tree while it is adapted (the
+ * memory lean mode of \ref t8_forest_set_adapt_recycle) and each
+ * intermediate forest is destroyed as soon as the next phase has
+ * consumed it, so the peak memory stays close to one complete forest
+ * plus a single tree.
+ * The mode changes memory behavior only; the committed forest is
+ * identical to the unfused result. It implies that the source forest's
+ * ghost layer cannot be consulted for reuse or algorithm selection
+ * after adapt.
+ * \param [in,out] forest   The forest, must be initialized and not
+ *                          committed.
+ * \param [in]     fused    If true, enable the fused commit pipeline.
+ * \see t8_forest_set_adapt \see t8_forest_set_partition
+ */
+void                t8_forest_set_commit_fused (t8_forest_t forest,
+                                                int fused);
+
+/** Record per eclass element counts and level statistics during commit.
+ * Load estimation and hybrid mesh kernels need the number of leafs per
+ * element shape and the level extrema; without this mode they must scan
+ * every leaf after each commit. With the mode enabled the statistics are
+ * accumulated in one pass at the end of commit and reduced over all
+ * processes, so that \ref t8_forest_get_eclass_counts and
+ * \ref t8_forest_get_level_stats answer in constant time.
+ * \param [in,out] forest             The forest, must be initialized and
+ *                                    not committed.
+ * \param [in]     set_element_stats  If true, record the statistics.
+ *                                    Must be set on all processes.
+ */
+void                t8_forest_set_element_stats (t8_forest_t forest,
+                                                 int set_element_stats);
+
 /** Set the user data of a forest. This can i.e. be used to pass user defined
  * arguments to the adapt routine.
  * \param [in,out] forest   The forest
@@ -327,6 +649,22 @@ void                t8_forest_set_partition (t8_forest_t forest,
                                              const t8_forest_t set_from,
                                              int set_for_coarsening);
 
+/** Set a weight function for the partitioning of a forest.
+ * If a weight function is set, \ref t8_forest_set_partition balances the
+ * cumulative element weight along the space-filling curve instead of the
+ * element count. The weights are evaluated on the source forest of the
+ * partition (after adapt and balance were carried out, if set).
+ * \param [in, out] forest  The forest to be partitioned.
+ * \param [in]      weight_fn The weight callback, or NULL to restore the
+ *                          default uniform partitioning.
+ * \note This setting is only effective in combination with
+ * \ref t8_forest_set_partition or \ref t8_forest_set_balance with
+ * repartitioning.
+ */
+void                t8_forest_set_partition_weights (t8_forest_t forest,
+                                                     t8_forest_partition_weight_t
+                                                     weight_fn);
+
 /** Set a source forest to be balanced during commit.
  * A forest is said to be balanced if each element has face neighbors of level
  * at most +1 or -1 of the element's level.
@@ -354,28 +692,563 @@ void                t8_forest_set_balance (t8_forest_t forest,
                                            const t8_forest_t set_from,
                                            int no_repartition);
 
+/** Register an element data transfer callback with the balance step.
+ * If set, \a replace_fn is invoked after every round of the iterated
+ * balance algorithm with the forests before and after the round, which
+ * differ by at most one refinement level per element. The application can
+ * thus carry its element data forward incrementally with cheap one-level
+ * stencils instead of interpolating across deep level differences against
+ * the original forest after balance has finished.
+ * The callback can access the application context via
+ * \ref t8_forest_get_user_data of the round's new forest, which inherits
+ * the user data of \a forest.
+ * \param [in, out] forest  The forest. Must be initialized and have balance
+ *                          set via \ref t8_forest_set_balance with
+ *                          \a no_repartition nonzero, since intermediate
+ *                          repartitioning would break the local element
+ *                          correspondence the callback relies on.
+ * \param [in] replace_fn   The transfer callback, or NULL to unset.
+ * \note Registering a callback selects the iterated balance algorithm for
+ * this commit. The default single-pass algorithm adapts recursively and
+ * cannot offer per-level correspondence.
+ * \see t8_forest_iterate_replace
+ */
+void                t8_forest_set_balance_replace (t8_forest_t forest,
+                                                   t8_forest_replace_t
+                                                   replace_fn);
+
 /** Enable or disable the creation of a layer of ghost elements.
  * On default no ghosts are created.
  * \param [in]      forest    The forest.
  * \param [in]      do_ghost  If non-zero a ghost layer will be created.
  * \param [in]      ghost_type Controls which neighbors count as ghost elements,
- *                             currently only T8_GHOST_FACES is supported. This value
+ *                             see \ref t8_ghost_type_t. This value
  *                             is ignored if \a do_ghost = 0.
+ * \note For the edge and vertex ghost types the same completeness
+ * limitation applies as for ghost layers of width > 1, see the note at
+ * \ref t8_forest_set_ghost_ext.
  */
 void                t8_forest_set_ghost (t8_forest_t forest, int do_ghost,
                                          t8_ghost_type_t ghost_type);
 
 /** Like \ref t8_forest_set_ghost but with the additional options to change the
- * ghost algorithm. This is used for debugging and timing the algorithm.
- * An application should almost always use \ref t8_forest_set_ghost.
- * \param [in]      ghost_version If 1, the iterative ghost algorithm for balanced forests is used.
+ * ghost algorithm and the width of the ghost layer.
+ * An application that only needs one layer of face ghosts should use
+ * \ref t8_forest_set_ghost.
+ * \param [in]      ghost_version If 0, the algorithm is chosen automatically during
+ *                                commit, depending on the balance state of the forest
+ *                                and on profile data of the forest it is derived from.
+ *                                If 1, the iterative ghost algorithm for balanced forests is used.
  *                                If 2, the iterative algorithm for unbalanced forests.
  *                                If 3, the top-down search algorithm for unbalanced forests.
+ * \param [in]      ghost_width   The number of ghost layers to create, must be >= 1.
+ *                                With width k a local element within k
+ *                                neighbor steps of another process becomes a
+ *                                remote element of that process. The layer
+ *                                is gathered in a single communication
+ *                                round.
+ * \note The layers beyond the first, as well as the edge and vertex
+ * neighbors of \ref t8_ghost_type_t, are computed by rounds of process
+ * local face-neighbor closure. An element whose every chain of at most
+ * k neighbor steps to another process crosses the domain of a third
+ * process is not discovered. This can happen between processes whose
+ * partitions touch each other only at a point where three or more
+ * partitions meet; the affected elements are missing from the ghost
+ * layer of the touching process. Applications that need the complete
+ * width-k neighborhood at such constellations must account for this.
  * \see t8_forest_set_ghost
  */
 void                t8_forest_set_ghost_ext (t8_forest_t forest, int do_ghost,
                                              t8_ghost_type_t ghost_type,
-                                             int ghost_version);
+                                             int ghost_version,
+                                             int ghost_width);
+
+/** Set the number of threads used for the boundary walk of the ghost
+ * algorithms.
+ * The walk over the local boundary elements dominates the runtime of
+ * ghost creation on large local meshes. With \a num_threads > 1 it is
+ * split into chunks of equal element count that are processed by worker
+ * threads, each collecting the remote elements of its chunk into a
+ * private buffer. The buffers are merged in element order before the
+ * communication phase, so the resulting ghost layer is identical to the
+ * one of the serial walk.
+ * \param [in,out]  forest      The forest whose ghost layers will be
+ *                              constructed with \a num_threads threads.
+ *                              May be initialized or committed; the
+ *                              setting applies to all subsequent ghost
+ *                              constructions of \a forest.
+ * \param [in]      num_threads The number of threads to use, must be >= 1.
+ * \note The setting only takes effect if t8code was configured with
+ * pthread support. Without it the walk always runs serially.
+ * \see t8_forest_set_ghost_ext
+ */
+void                t8_forest_set_ghost_threads (t8_forest_t forest,
+                                                 int num_threads);
+
+/** Select the packed wire format for the ghost element exchange.
+ * By default the ghost creation ships the raw element structs of the
+ * remote elements. With \a ghost_packed set, each element is sent as its
+ * (linear id, level) pair instead and the receiver materializes all
+ * ghost elements of a tree in one bulk t8_element_set_linear_id pass.
+ * This shrinks the messages (a linear id and a level are smaller than
+ * most element structs) at the cost of recomputing the element data on
+ * the receiver.
+ * \param [in,out]  forest       The forest to be constructed with ghosts.
+ *                               Must be initialized and not committed.
+ * \param [in]      ghost_packed If nonzero, use the packed wire format.
+ * \note The flag must be set equally on all processes, since it changes
+ * the format of the exchanged messages.
+ * \see t8_forest_set_ghost_ext
+ */
+void                t8_forest_set_ghost_packed (t8_forest_t forest,
+                                                int ghost_packed);
+
+/** Set a predicate that filters the ghost layer down to the elements the
+ * application actually consumes.
+ * The ghost types select neighbors globally, but many solvers read ghost
+ * values only across a subset of the boundary, for example at material
+ * interfaces. If a filter is set, it is evaluated once per local boundary
+ * element during the remote collection phase of ghost creation; elements
+ * for which it returns zero are not announced as remotes, so they never
+ * become ghosts elsewhere and drop out of the ghost storage and of every
+ * subsequent ghost exchange.
+ * \param [in,out]  forest      The forest whose ghost layers will be
+ *                              filtered. May be initialized or committed;
+ *                              the setting applies to all subsequent ghost
+ *                              constructions of \a forest.
+ * \param [in]      filter_fn   The predicate, or NULL to remove a
+ *                              previously set filter.
+ * \param [in]      user_data   Arbitrary pointer passed to \a filter_fn.
+ * \note The filter must be symmetric: if it drops an element towards a
+ * neighbor process, the application must not expect the mirror ghost on
+ * that process either. Face neighbor queries that hit a dropped ghost
+ * report the neighbor as missing.
+ * \see t8_forest_set_ghost_ext
+ */
+void                t8_forest_set_ghost_filter (t8_forest_t forest,
+                                                t8_forest_ghost_filter_t
+                                                filter_fn, void *user_data);
+
+/** Register a refinement predictor for speculative child generation.
+ * While \ref t8_forest_ghost_exchange_data_end and
+ * \ref t8_forest_partition_data_end poll their pending messages, the
+ * otherwise idle wait time is used to evaluate \a predictor_fn on the
+ * local leafs and to pre-generate the children of flagged leafs into a
+ * side pool. The next \ref t8_forest_adapt of this forest copies the
+ * pre-generated children on a hit instead of computing them, so with an
+ * accurate predictor - for example one extrapolating an error indicator
+ * along the advection direction - most of the child generation cost of
+ * the adaptation is hidden inside the communication waits.
+ * Each pool entry is consumed by at most one adaptation and the pool is
+ * dropped whenever the forest is modified in place.
+ * \param [in,out]  forest       A committed forest.
+ * \param [in]      predictor_fn The predictor, or NULL to deactivate
+ *                               speculation and drop the pool.
+ * \param [in]      user_data    Arbitrary pointer passed to \a predictor_fn.
+ * \note Speculation is process local and performs no communication, so
+ * the predictor may be registered on any subset of the processes.
+ */
+void                t8_forest_set_speculation (t8_forest_t forest,
+                                               t8_forest_speculate_t
+                                               predictor_fn,
+                                               void *user_data);
+
+/** Compress the packed ghost streams with delta and varint encoding.
+ * The remote elements of a tree are sent in space-filling curve order,
+ * so consecutive linear ids share their high order bits. With this flag
+ * set, the (linear id, level) stream of each sufficiently large tree is
+ * delta encoded and packed in base 128 varints, typically shrinking the
+ * inter node ghost messages by more than half. Trees with few elements
+ * keep the plain packed stream, so latency bound messages do not pay
+ * the encoding CPU.
+ * \param [in,out]  forest         The forest to be constructed with
+ *                                 ghosts. Must be initialized and not
+ *                                 committed.
+ * \param [in]      ghost_compress If nonzero, compress the streams.
+ * \note Only effective together with \ref t8_forest_set_ghost_packed.
+ * \note The flag must be set equally on all processes, since it changes
+ * the format of the exchanged messages.
+ */
+void                t8_forest_set_ghost_compress (t8_forest_t forest,
+                                                  int ghost_compress);
+
+/** Set the number of threads used to fill the element arrays of a new
+ * uniform forest.
+ * The leaf elements of a uniform forest occupy a contiguous range of
+ * linear ids per tree, so each element can be materialized independently
+ * via its id. With \a num_threads > 1 the local element range is split
+ * into chunks of equal count that are filled by worker threads, which
+ * also first-touches the element pages in parallel.
+ * The constructed forest is identical to the one of the serial fill.
+ * \param [in,out]  forest      The forest to be updated. Must be
+ *                              initialized but not committed.
+ * \param [in]      num_threads The number of threads to use, must be >= 1.
+ * \note The setting only takes effect if t8code was configured with
+ * pthread support. Without it the fill always runs serially.
+ * \see t8_forest_set_level
+ */
+void                t8_forest_set_populate_threads (t8_forest_t forest,
+                                                    int num_threads);
+
+/** Set the number of threads used to serialize the cells of a vtk
+ * output file.
+ * Formatting the coordinates, connectivity and cell data of every
+ * element dominates the runtime of \ref t8_forest_vtk_write_file on
+ * large local meshes. With \a num_threads > 1 the local trees are split
+ * into ranges of roughly equal element count that worker threads render
+ * into in-memory buffers, which are then written to the file in order.
+ * The resulting file is identical up to the placement of line breaks.
+ * \param [in,out]  forest      The forest to be updated. May be
+ *                              initialized or committed; the setting
+ *                              applies to all subsequent vtk writes of
+ *                              \a forest.
+ * \param [in]      num_threads The number of threads to use, must be >= 1.
+ * \note The setting only takes effect if t8code was configured with
+ * pthread support. Without it the serialization always runs serially.
+ * \see t8_forest_vtk_write_file
+ */
+void                t8_forest_set_vtk_threads (t8_forest_t forest,
+                                               int num_threads);
+
+/** Set the number of threads used for the tree loop of a non-recursive
+ * adaptation.
+ * With \a num_threads > 1 the local trees of a \ref t8_forest_set_adapt
+ * forest (without recursive adaptation) are distributed among worker
+ * threads that adapt them concurrently. The default is 1, that is, the
+ * adaptation runs serially.
+ * \param [in,out]  forest      The forest to be updated. May be
+ *                              initialized or committed; the setting
+ *                              applies to the next commit of \a forest
+ *                              with a set adapt function.
+ * \param [in]      num_threads The number of threads to use, must be >= 1.
+ * \note With \a num_threads > 1 the adapt callback is invoked concurrently
+ * from the worker threads and therefore must be thread-safe: it must not
+ * modify shared state (such as the forest's user data) without its own
+ * synchronization. Callbacks that only read their arguments and shared
+ * data are safe. Because of this contract the adapt phase is not covered
+ * by \ref t8_forest_set_num_threads and stays serial unless explicitly
+ * enabled here.
+ * \note The setting only takes effect if t8code was configured with
+ * OpenMP support and the adaptation is not recursive. Otherwise the
+ * adaptation always runs serially.
+ * \see t8_forest_set_adapt
+ */
+void                t8_forest_set_adapt_threads (t8_forest_t forest,
+                                                 int num_threads);
+
+/** Set the number of threads for all threaded phases of a forest.
+ * A convenience setter that applies \a num_threads to the ghost boundary
+ * walk, the uniform populate and the vtk serialization of \a forest in
+ * one call, \see t8_forest_set_ghost_threads,
+ * \see t8_forest_set_populate_threads, \see t8_forest_set_vtk_threads.
+ * All phases execute their workers on one process-wide thread pool, so
+ * different settings on different forests do not multiply the number of
+ * spawned threads; use \ref t8_thread_pool_set_num_threads to cap the
+ * pool size process-wide, for example to compose with the threading of
+ * the host application.
+ * The adapt tree loop is deliberately not covered, since with more than
+ * one thread it requires a thread-safe adapt callback; it has to be
+ * enabled explicitly via \ref t8_forest_set_adapt_threads.
+ * \param [in,out]  forest      The forest to be updated. May be
+ *                              initialized or committed.
+ * \param [in]      num_threads The number of threads to use, must be >= 1.
+ * \note The setting only takes effect if t8code was configured with
+ * pthread support. Without it all phases run serially.
+ */
+void                t8_forest_set_num_threads (t8_forest_t forest,
+                                               int num_threads);
+
+/** Compute the element and tree range of one team of a committed forest.
+ * Splits the local elements of \a forest into \a num_teams contiguous
+ * chunks of (almost) equal element count -- the same splitting the
+ * threaded phases use for their workers -- and returns the chunk of team
+ * \a iteam as a local element range together with the local trees that
+ * contain it.
+ * This supports a node-rank execution model: instead of one MPI rank per
+ * core, run one rank per compute node (for example on the internode
+ * communicator of the shared memory split, \see t8_shmem_init), commit
+ * the forest there -- so the replicated metadata and the collectives pay
+ * per node instead of per core -- and have the threads of the node each
+ * process their team's range. Combine with
+ * \ref t8_cmesh_set_shared_node_memory and the shared default scheme to
+ * also store the cmesh and scheme once per node.
+ * \param [in]  forest           The forest. Must be committed.
+ * \param [in]  iteam            The team number, 0 <= \a iteam < \a num_teams.
+ * \param [in]  num_teams        The number of teams, must be >= 1.
+ * \param [out] first_local_tree The first local tree containing an element
+ *                               of the range. May be NULL.
+ * \param [out] last_local_tree  The last local tree containing an element
+ *                               of the range; smaller than
+ *                               \a first_local_tree if the range is empty.
+ *                               May be NULL.
+ * \param [out] first_element    The first local element id of the range.
+ *                               May be NULL.
+ * \param [out] last_element     The local element id after the range, so
+ *                               the range is [\a first_element,
+ *                               \a last_element). May be NULL.
+ * \note Consecutive teams may share a tree; per-tree data written by the
+ * teams of a shared tree must be synchronized by the caller.
+ */
+void                t8_forest_get_team_range (t8_forest_t forest, int iteam,
+                                              int num_teams,
+                                              t8_locidx_t *first_local_tree,
+                                              t8_locidx_t *last_local_tree,
+                                              t8_locidx_t *first_element,
+                                              t8_locidx_t *last_element);
+
+/** The precision in which the output writers emit element coordinates. */
+typedef enum
+{
+  T8_COORD_PRECISION_FLOAT64 = 0, /**< Full double precision (the default). */
+  T8_COORD_PRECISION_FLOAT32,     /**< Single precision. */
+  T8_COORD_PRECISION_QUANTIZED    /**< Single precision, additionally snapped
+                                       to a fixed point grid over the
+                                       bounding box of the coarse mesh
+                                       vertices. The zeroed mantissa bits
+                                       make the coordinates compress much
+                                       better. */
+} t8_coord_precision_t;
+
+/** Select the precision in which subsequent vtk and netcdf writes of a
+ * forest emit the element coordinates.
+ * Visualization rarely needs more than single precision, but the
+ * coordinates dominate the output volume; with
+ * \ref T8_COORD_PRECISION_FLOAT32 the coordinate buffers and file blocks
+ * halve. \ref T8_COORD_PRECISION_QUANTIZED additionally snaps each
+ * coordinate to a uniform grid with 2^\a quantization_bits steps per
+ * dimension of the bounding box of the coarse mesh vertices before the
+ * float conversion, which reduces the entropy for compressed outputs.
+ * The ascii vtk writer renders quantized coordinates with single
+ * precision digits.
+ * \param [in,out]  forest      The forest to be updated. May be
+ *                              initialized or committed; the setting
+ *                              applies to all subsequent output writes
+ *                              of \a forest.
+ * \param [in]      precision   The coordinate precision to use.
+ * \param [in]      quantization_bits If \a precision is
+ *                              \ref T8_COORD_PRECISION_QUANTIZED, the
+ *                              number of grid bits per dimension, in
+ *                              [1, 24]. Ignored otherwise.
+ * \see t8_forest_vtk_write_file \see t8_forest_write_netcdf
+ */
+void                t8_forest_set_coordinate_precision (t8_forest_t forest,
+                                                        t8_coord_precision_t
+                                                        precision,
+                                                        int
+                                                        quantization_bits);
+
+/** Query the coordinate output precision of a forest.
+ * \param [in]  forest      The forest.
+ * \param [out] quantization_bits If not NULL, filled with the number of
+ *                          quantization grid bits, 0 if quantization is
+ *                          not selected.
+ * \return                  The coordinate precision set via
+ *                          \ref t8_forest_set_coordinate_precision.
+ */
+t8_coord_precision_t t8_forest_get_coordinate_precision (t8_forest_t forest,
+                                                         int
+                                                         *quantization_bits);
+
+/** Enable or disable the construction of a subcommunicator that spans
+ * only the ranks holding elements of the forest.
+ * After heavy coarsening a forest may occupy far fewer ranks than its
+ * communicator has; collectives issued on such a forest then pay the
+ * latency of the full communicator although most ranks contribute
+ * nothing. If enabled, \ref t8_forest_commit splits off a communicator
+ * of the element holding ranks that can be queried with
+ * \ref t8_forest_get_subcomm and used for coarse-level collectives,
+ * e.g. in the levels of a multigrid hierarchy.
+ * The setting is inherited by forests derived from this forest, so the
+ * subcommunicator follows the element distribution through
+ * adapt/partition cycles and expands back to the full communicator when
+ * the forest grows onto all ranks again.
+ * \param [in,out]  forest      The forest to be updated. Must be
+ *                              initialized but not committed.
+ * \param [in]      set_subcomm If true, the commit of \a forest builds
+ *                              the subcommunicator.
+ * \see t8_forest_get_subcomm
+ */
+void                t8_forest_set_subcomm (t8_forest_t forest,
+                                           int set_subcomm);
+
+/** Enable or disable communicator isolation for a forest.
+ * By default all communication of a forest runs on its \a mpicomm with
+ * static message tags, so overlapping the partition traffic of a derived
+ * commit with ghost exchanges of the source forest funnels both through
+ * one MPI context. If enabled, \ref t8_forest_commit duplicates two
+ * dedicated communicators, one carrying all ghost messages and one
+ * carrying all partition messages of the forest, so the two kinds of
+ * traffic match only among themselves and can progress concurrently.
+ * The setting is inherited by forests derived from this forest.
+ * \param [in,out]  forest      The forest to be updated. Must be
+ *                              initialized but not committed.
+ * \param [in]      set_isolation If true, the commit of \a forest
+ *                              duplicates the dedicated communicators.
+ * \note Duplicating communicators is collective and not free; enable the
+ *       isolation once on the first forest of a hierarchy rather than
+ *       toggling it per commit.
+ */
+void                t8_forest_set_comm_isolation (t8_forest_t forest,
+                                                  int set_isolation);
+
+/** Set the allocation mode for the leaf element storage of a forest.
+ * With \ref T8_ELEMENT_MEMORY_SLAB the element arrays of the local trees
+ * are allocated as aligned slabs that are advised to be backed by huge
+ * pages and whose pages are first touched in parallel, which distributes
+ * them over the NUMA domains of the threads that sweep the elements.
+ * The mode takes effect when the forest is committed.
+ * \param [in,out]  forest      The forest whose elements will be allocated
+ *                              with \a memory_mode. The forest must not be
+ *                              committed yet.
+ * \param [in]      memory_mode The allocation mode to use,
+ *                              \see t8_element_memory_mode_t.
+ */
+void                t8_forest_set_memory_mode (t8_forest_t forest,
+                                               t8_element_memory_mode_t
+                                               memory_mode);
+
+/** Create a new commit context with reference count one.
+ * A commit context owns the resources that \ref t8_forest_commit would
+ * otherwise set up and tear down for every forest of an
+ * adapt-partition-ghost pipeline: the (possibly duplicated) communicator
+ * and the shared memory windows of the partition offset arrays.
+ * This function is collective on \a mpicomm.
+ * \param [in]      mpicomm     The communicator of the pipeline.
+ * \param [in]      do_dup      If true, the context duplicates \a mpicomm
+ *                              once and owns the duplicate. The forests that
+ *                              share the context then never duplicate a
+ *                              communicator themselves.
+ * \return                      The new commit context. It must be released
+ *                              with \ref t8_forest_commit_context_unref.
+ */
+t8_forest_commit_context_t t8_forest_commit_context_new (sc_MPI_Comm mpicomm,
+                                                         int do_dup);
+
+/** Increase the reference count of a commit context.
+ * \param [in,out]  context     A commit context with positive reference count.
+ */
+void                t8_forest_commit_context_ref (t8_forest_commit_context_t
+                                                  context);
+
+/** Decrease the reference count of a commit context.
+ * If the count reaches zero, the context is destroyed: its parked shared
+ * memory arrays are freed and, if it owns a duplicated communicator, the
+ * duplicate is freed as well. Destruction is collective on the context's
+ * communicator.
+ * \param [in,out]  pcontext    Pointer to a commit context with positive
+ *                              reference count. Set to NULL on output.
+ */
+void                t8_forest_commit_context_unref (t8_forest_commit_context_t
+                                                    *pcontext);
+
+/** Set the commit context of a forest.
+ * The forest then uses the context's communicator during commit and, when it
+ * is destroyed, parks its offset shared memory arrays in the context instead
+ * of freeing them, so the next commit of the pipeline reuses their windows.
+ * \ref t8_forest_commit passes the context on to the intermediate forests it
+ * creates internally, so setting it on each derived forest of a pipeline
+ * eliminates the per-commit communicator duplication and shared memory
+ * window creation entirely.
+ * \param [in,out]  forest      The forest, must be initialized and not
+ *                              committed. It takes a reference on \a context
+ *                              that is released when the forest is destroyed.
+ * \param [in]      context     A commit context created with
+ *                              \ref t8_forest_commit_context_new. Its
+ *                              communicator must be the communicator the
+ *                              forest (pipeline) lives on.
+ */
+void                t8_forest_set_commit_context (t8_forest_t forest,
+                                                  t8_forest_commit_context_t
+                                                  context);
+
+/** Register a named element data field on a committed forest.
+ * The field stores \a bytes_per_element bytes per local leaf element,
+ * followed by one entry per ghost element, in its own contiguous array
+ * (structure of arrays layout across fields). The storage belongs to the
+ * forest and is initialized to zero.
+ * Registered fields are carried over automatically when a derived forest is
+ * committed: a partition commit ships them inside one message round
+ * alongside the element shipment (\see t8_forest_partition_data), a
+ * non-recursive adapt commit replays the adapt journal, copying the parent
+ * value to new children and the first child value to a new parent, and a
+ * copy commit copies them. Fields are not carried across balance or
+ * recursive adaptation.
+ * The ghost entries are not filled automatically; use
+ * \ref t8_forest_fields_exchange to update them.
+ * \param [in,out]  forest      The forest. Must be committed.
+ * \param [in]      name        The name of the field. Must be shorter than
+ *                              \ref T8_FOREST_FIELD_NAME_MAX characters and
+ *                              must not be registered on \a forest yet.
+ * \param [in]      bytes_per_element The fixed width of one field entry.
+ * \return                      The id of the new field, starting from 0 in
+ *                              order of registration.
+ */
+int                 t8_forest_field_register (t8_forest_t forest,
+                                              const char *name,
+                                              size_t bytes_per_element);
+
+/** Look up a registered element data field by name.
+ * \param [in]  forest      The forest. Must be committed.
+ * \param [in]  name        The name the field was registered with.
+ * \return                  The id of the field, or -1 if no field of this
+ *                          name is registered.
+ */
+int                 t8_forest_field_id (t8_forest_t forest,
+                                        const char *name);
+
+/** Return the number of registered element data fields of a forest.
+ * \param [in]  forest      The forest. Must be committed.
+ * \return                  The number of fields registered on \a forest.
+ */
+int                 t8_forest_num_fields (t8_forest_t forest);
+
+/** Return the storage of a registered element data field.
+ * \param [in]  forest      The forest. Must be committed.
+ * \param [in]  field_id    The id of the field, as returned by
+ *                          \ref t8_forest_field_register or
+ *                          \ref t8_forest_field_id.
+ * \return                  The field's array of
+ *                          num_local_elements + num_ghosts fixed width
+ *                          entries. It belongs to the forest and is valid
+ *                          until the forest is destroyed.
+ */
+void               *t8_forest_field_data (t8_forest_t forest, int field_id);
+
+/** Exchange the ghost entries of all registered element data fields of a
+ * forest in one round of communication,
+ * \see t8_forest_ghost_exchange_data_multiple.
+ * \param [in,out]  forest      The forest. Must be committed.
+ * \note This function is collective and hence must be called by all
+ *       processes in the forest's MPI Communicator.
+ */
+void                t8_forest_fields_exchange (t8_forest_t forest);
+
+/** Register a cache invalidation hook on a forest.
+ * Hooks are carried over to every forest derived from this one and are fired
+ * at the end of each derived commit, once per local tree whose leaf elements
+ * changed. A commit that only adapted non-recursively consumes the adapt
+ * journal and fires precisely for the adapted trees; any other commit
+ * (partition, balance, recursive adaptation, or a fresh forest) fires for all
+ * local trees. Caches that are keyed to the forest lineage can thereby be
+ * updated incrementally instead of being rebuilt whole after every commit,
+ * \see t8_forest_get_generation.
+ * \param [in,out]  forest      The forest. May be initialized or committed.
+ * \param [in]      callback    The hook to fire, must not be NULL.
+ * \param [in]      user_data   Arbitrary pointer passed to \a callback.
+ */
+void                t8_forest_cache_hook_register (t8_forest_t forest,
+                                                   t8_forest_cache_invalidate_t
+                                                   callback, void *user_data);
+
+/** Return the generation of a forest.
+ * The generation is a monotonic counter along a forest lineage: a committed
+ * forest derived from another forest always carries a strictly larger
+ * generation than its source. Caches can stamp the generation they were
+ * built at and compare it to decide whether they are stale.
+ * \param [in]  forest      A committed forest.
+ * \return                  The generation of \a forest.
+ */
+unsigned            t8_forest_get_generation (t8_forest_t forest);
 
 /* TODO: use assertions and document that the forest_set (..., from) and
  *       set_load are mutually exclusive. */
@@ -395,6 +1268,23 @@ void                t8_forest_comm_global_num_elements (t8_forest_t forest);
  */
 void                t8_forest_commit (t8_forest_t forest);
 
+/** Commit a batch of independent forests.
+ * Commits each forest in \a forests as \ref t8_forest_commit would, but
+ * defers the terminal reduction of the global element count and performs one
+ * vector valued reduction per distinct communicator afterwards, so that
+ * committing many small forests (for example ensemble members) issues fewer
+ * collectives. This function is collective on every communicator occurring
+ * in \a forests; all ranks of a communicator must pass the forests living on
+ * it in the same order.
+ * \param [in,out] forests      Array of \a num_forests forests, each created
+ *                              with \ref t8_forest_init and specialized with
+ *                              t8_forest_set_* calls. All are committed on
+ *                              output.
+ * \param [in]     num_forests  The number of forests in \a forests.
+ */
+void                t8_forest_commit_batch (t8_forest_t *forests,
+                                            const int num_forests);
+
 /** Return the maximum allowed refinement level for any element in a forest.
  * \param [in]  forest    A forest.
  * \return                The maximum level of refinement that is allowed for
@@ -431,6 +1321,163 @@ t8_gloidx_t         t8_forest_get_global_num_elements (t8_forest_t forest);
  */
 t8_locidx_t         t8_forest_get_num_ghosts (t8_forest_t forest);
 
+/** Memory usage of a committed forest, split by component.
+ * \see t8_forest_get_memory_footprint */
+typedef struct t8_forest_mem_footprint
+{
+  size_t              elements_bytes; /**< The leaf element storage of the
+                                           local trees, including unused
+                                           capacity and id caches. */
+  size_t              trees_bytes; /**< The tree records themselves. */
+  size_t              ghosts_bytes; /**< The ghost structure, including the
+                                         ghost element storage.
+                                         \see t8_forest_ghost_memory_used */
+  size_t              offsets_bytes; /**< The partition offset shared memory
+                                          arrays that were constructed. */
+  size_t              cmesh_bytes; /**< The attached cmesh.
+                                        \see t8_cmesh_get_memory_footprint */
+  size_t              total_bytes; /**< The sum of all components. */
+} t8_forest_mem_footprint_t;
+
+/** Compute the number of bytes of heap memory that a committed forest
+ * occupies on this process, split by component.
+ * The offset arrays live in MPI shared memory and are counted with their
+ * full length, even though they exist only once per compute node. The
+ * per-entry link overhead of internal hash tables is not counted.
+ * \param [in]  forest    The forest. Must be committed.
+ * \param [out] footprint The byte counts are stored here.
+ */
+void                t8_forest_get_memory_footprint (t8_forest_t forest,
+                                                    t8_forest_mem_footprint_t
+                                                    *footprint);
+
+/** Estimate the peak number of bytes of heap memory that committing a
+ * forest will consume on this process, so that job scripts can size
+ * compute nodes before the commit is attempted.
+ * For a forest derived from another forest (adapt, partition, balance) the
+ * estimate assumes that the element count stays of the same order, so that
+ * the peak is dominated by the source and the result leaf storage existing
+ * at the same time. For a new uniform forest the leaf count is computed
+ * exactly from the refinement level. Ghost layer growth beyond the source
+ * forest's ghost layer is not modeled.
+ * \param [in] forest  An initialized, not yet committed forest whose
+ *                     parameters (set_from or cmesh, scheme and level)
+ *                     have been set.
+ * \return             The estimated peak byte count of \ref t8_forest_commit.
+ */
+size_t              t8_forest_estimate_commit_memory (t8_forest_t forest);
+
+/** Return the local leaf indices of all leafs of a given refinement level.
+ * Multigrid style algorithms repeatedly visit all leafs of one level;
+ * with this view they iterate the level's index list instead of scanning
+ * the whole forest and testing \ref t8_element_level per leaf.
+ * The view over all levels is built in a single pass over the leafs on
+ * the first query and cached; committed forests do not change, so it
+ * stays valid for the lifetime of the forest.
+ * \param [in]  forest       The forest. Must be committed.
+ * \param [in]  level        A refinement level, 0 <= \a level <= maxlevel.
+ * \param [out] num_elements The number of local leafs of \a level.
+ * \return                   A pointer to the \a num_elements ascending local
+ *                           leaf indices of level \a level, owned by the
+ *                           forest. Only valid to dereference if
+ *                           \a num_elements is positive.
+ */
+const t8_locidx_t  *t8_forest_get_level_view (t8_forest_t forest, int level,
+                                              t8_locidx_t *num_elements);
+
+/** Return the number of leafs of a local tree that have a given
+ * refinement level. The counts of all trees and levels are accumulated
+ * together with the level view on the first query.
+ * \param [in] forest   The forest. Must be committed.
+ * \param [in] ltreeid  The local id of a tree in \a forest.
+ * \param [in] level    A refinement level, 0 <= \a level <= maxlevel.
+ * \return              The number of leafs of \a ltreeid with level \a level.
+ * \see t8_forest_get_level_view
+ */
+t8_locidx_t         t8_forest_get_tree_num_level_elements (t8_forest_t
+                                                           forest,
+                                                           t8_locidx_t
+                                                           ltreeid,
+                                                           int level);
+
+/** Return the number of leafs of one element shape without scanning the
+ * forest. The counts were recorded during commit.
+ * \param [in]  forest       The forest. Must be committed with
+ *                           \ref t8_forest_set_element_stats enabled.
+ * \param [in]  eclass       An element class.
+ * \param [out] local_count  If not NULL, filled with the number of local
+ *                           leafs of shape \a eclass.
+ * \param [out] global_count If not NULL, filled with the number of global
+ *                           leafs of shape \a eclass.
+ */
+void                t8_forest_get_eclass_counts (t8_forest_t forest,
+                                                 t8_eclass_t eclass,
+                                                 t8_locidx_t *local_count,
+                                                 t8_gloidx_t *global_count);
+
+/** Return the global leaf level statistics recorded during commit.
+ * \param [in]  forest     The forest. Must be committed with
+ *                         \ref t8_forest_set_element_stats enabled.
+ * \param [out] min_level  If not NULL, filled with the minimum leaf level
+ *                         over all processes.
+ * \param [out] max_level  If not NULL, filled with the maximum leaf level
+ *                         over all processes.
+ * \param [out] mean_level If not NULL, filled with the mean leaf level
+ *                         over all processes.
+ * For an empty forest all three statistics are zero.
+ */
+void                t8_forest_get_level_stats (t8_forest_t forest,
+                                               int *min_level,
+                                               int *max_level,
+                                               double *mean_level);
+
+/** The number of entries of the per level count array of
+ * \ref t8_forest_stats_t. An upper bound for the maximum refinement
+ * level of any element scheme plus one. */
+#define T8_FOREST_STATS_MAX_LEVELS 32
+
+/** Collective refinement and partition statistics of a forest,
+ * filled by \ref t8_forest_compute_statistics. */
+typedef struct t8_forest_stats
+{
+  t8_gloidx_t         global_num_elements; /**< The number of leafs over all processes. */
+  t8_gloidx_t         global_num_ghosts;   /**< The number of ghost elements summed
+                                                over all processes, 0 if no ghost
+                                                layer exists. */
+  t8_locidx_t         max_local_num_elements; /**< The largest local leaf count of
+                                                   any process. */
+  t8_locidx_t         max_local_num_ghosts; /**< The largest local ghost count of
+                                                 any process. */
+  int                 min_level;    /**< The minimum leaf level over all processes. */
+  int                 max_level;    /**< The maximum leaf level over all processes. */
+  double              mean_level;   /**< The mean leaf level over all processes. */
+  double              imbalance;    /**< \a max_local_num_elements divided by the
+                                         mean local leaf count; 1 for a perfectly
+                                         balanced partition. */
+  double              ghost_fraction; /**< \a global_num_ghosts divided by
+                                           \a global_num_elements. */
+  t8_gloidx_t         num_elements_per_level[T8_FOREST_STATS_MAX_LEVELS];
+                                    /**< The number of leafs of each level over
+                                         all processes. Only the entries 0 to
+                                         \a max_level are used, the rest is 0. */
+} t8_forest_stats_t;
+
+/** Compute the refinement and partition statistics of a committed forest
+ * with a single fused reduction. The local tallies are folded from the
+ * per tree level counters if the level view was already built,
+ * \see t8_forest_get_level_view, and gathered in one sweep over the local
+ * leafs otherwise; all of them are then combined in one reduction over a
+ * packed vector with a user defined operator. Monitoring code that
+ * queries several of these metrics per adapt cycle thus pays the
+ * collective latency once instead of once per metric.
+ * Collective over the forest's communicator.
+ * \param [in]  forest  The forest. Must be committed.
+ * \param [out] stats   Filled with the statistics of \a forest. For an
+ *                      empty forest the levels and ratios are 0.
+ */
+void                t8_forest_compute_statistics (t8_forest_t forest,
+                                                  t8_forest_stats_t *stats);
+
 /** Return the element class of a forest local tree.
  *  \param [in] forest    The forest.
  *  \param [in] ltreeid   The local id of a tree in \a forest.
@@ -522,6 +1569,116 @@ void                t8_forest_leaf_face_neighbors (t8_forest_t forest,
                                                    **pneigh_scheme,
                                                    int forest_is_balanced);
 
+/** Compute the leaf face neighbors of many element faces in one pass.
+ * This is the batch variant of \ref t8_forest_leaf_face_neighbors. Instead
+ * of one allocation per query, the neighbor indices and dual faces of all
+ * queries are appended to flat arrays, and the tree and eclass scheme
+ * lookups are amortized over consecutive queries of the same tree.
+ * \param [in]  forest      The forest. Must have a valid ghost layer.
+ * \param [in]  num_queries The number of (element, face) pairs to process.
+ * \param [in]  lelement_ids The local element indices of the queries,
+ *                          over all trees. Sorting them ascending speeds up
+ *                          the tree lookup, but is not required.
+ * \param [in]  faces       For each query the face number of the element.
+ * \param [in,out] neighbor_indices An initialized array of t8_locidx_t
+ *                          entries. The neighbor leaf indices of all queries
+ *                          are appended in query order, numbered as in
+ *                          \ref t8_forest_leaf_face_neighbors.
+ * \param [in,out] dual_faces An initialized array of int entries. For each
+ *                          appended neighbor index its dual face.
+ * \param [out] neighbor_offsets Array of \a num_queries + 1 entries provided
+ *                          by the caller. On output the neighbors of query
+ *                          \a i are the entries neighbor_offsets[i] up to
+ *                          (excluding) neighbor_offsets[i+1] of
+ *                          \a neighbor_indices, counted from the array
+ *                          length on input.
+ * \param [in]  forest_is_balanced True if we know that \a forest is
+ *                          balanced, false otherwise.
+ * \note \a forest must be committed before calling this function.
+ */
+void                t8_forest_leaf_face_neighbors_batch (t8_forest_t forest,
+                                                         t8_locidx_t
+                                                         num_queries,
+                                                         const t8_locidx_t
+                                                         *lelement_ids,
+                                                         const int *faces,
+                                                         sc_array_t
+                                                         *neighbor_indices,
+                                                         sc_array_t
+                                                         *dual_faces,
+                                                         t8_locidx_t
+                                                         *neighbor_offsets,
+                                                         int
+                                                         forest_is_balanced);
+
+/** Build a face neighbor index for a committed forest.
+ * The index stores for each face of each local element the indices and dual
+ * faces of the neighboring leafs in flat arrays, so that repeated neighbor
+ * lookups (for example one per face per time step) are answered in constant
+ * time by \ref t8_forest_face_neighbor_index_query instead of recomputing
+ * \ref t8_forest_leaf_face_neighbors.
+ * The index is valid until the forest is modified; a forest derived via
+ * adapt, partition or balance does not inherit it and must build its own.
+ * \param [in,out] forest   A committed balanced forest with a valid ghost
+ *                          layer (if parallel). If the index already exists,
+ *                          nothing happens.
+ */
+void                t8_forest_face_neighbor_index_create (t8_forest_t forest);
+
+/** Query the face neighbor index of a forest.
+ * \param [in]  forest      A committed forest for which
+ *                          \ref t8_forest_face_neighbor_index_create was called.
+ * \param [in]  lelement_id The local index of an element, over all trees.
+ * \param [in]  face        A face number of that element.
+ * \param [out] num_neighbors On output the number of neighbor leafs.
+ * \param [out] pneighbor_indices On output points to the \a num_neighbors
+ *                          indices of the neighbor leafs,
+ *                          0, ..., num_local_el - 1 for local leafs and
+ *                          num_local_el, ... for ghosts. Owned by the index,
+ *                          must not be freed.
+ * \param [out] pdual_faces On output points to the \a num_neighbors dual
+ *                          faces of the neighbors. Owned by the index,
+ *                          must not be freed.
+ */
+void                t8_forest_face_neighbor_index_query (t8_forest_t forest,
+                                                         t8_locidx_t
+                                                         lelement_id,
+                                                         int face,
+                                                         int *num_neighbors,
+                                                         const t8_locidx_t
+                                                         **pneighbor_indices,
+                                                         const int8_t
+                                                         **pdual_faces);
+
+/** Free the face neighbor index of a forest.
+ * \param [in,out] forest   A forest. If no index exists, nothing happens.
+ * The index is also freed automatically when the forest is destroyed.
+ */
+void                t8_forest_face_neighbor_index_destroy (t8_forest_t
+                                                           forest);
+
+/** Build a per tree geometry cache for a committed forest.
+ * The cache resolves for each local tree its geometry and, for trees with
+ * the linear vertex geometry, the vertex coordinate attribute. The element
+ * coordinate routines (\ref t8_forest_element_coordinate,
+ * \ref t8_forest_element_centroid and the routines built on them) then
+ * evaluate such trees directly from the cached vertices instead of looking
+ * up the geometry and the cmesh attributes per element.
+ * \param [in,out] forest   A committed forest. If the cache already exists,
+ *                          nothing happens.
+ * \note The cache is installed automatically at the end of
+ * \ref t8_forest_commit if the cmesh carries a geometry, so calling this
+ * function by hand is only needed for forests committed before a geometry
+ * was registered.
+ */
+void                t8_forest_geometry_cache_create (t8_forest_t forest);
+
+/** Free the geometry cache of a forest.
+ * \param [in,out] forest   A forest. If no cache exists, nothing happens.
+ * The cache is also freed automatically when the forest is destroyed.
+ */
+void                t8_forest_geometry_cache_destroy (t8_forest_t forest);
+
 /** Exchange ghost information of user defined element data.
  * \param[in] forest       The forest. Must be committed.
  * \param[in] element_data An array of length num_local_elements + num_ghosts
@@ -538,6 +1695,180 @@ void                t8_forest_leaf_face_neighbors (t8_forest_t forest,
 void                t8_forest_ghost_exchange_data (t8_forest_t forest,
                                                    sc_array_t *element_data);
 
+/** Exchange ghost information of user defined element data with a different
+ * payload size per element. \ref t8_forest_ghost_exchange_data requires one
+ * fixed element size, which forces applications with strongly varying
+ * payloads (for example p-adaptive discretizations) to pad every element to
+ * the maximum. This function first exchanges the per element byte counts
+ * through the fixed size path and then sends the payloads exactly sized, so
+ * the exchange volume matches the actual data.
+ * \param[in] forest         The forest. Must be committed.
+ * \param[in] element_bytes  An array of num_local_elements entries storing
+ *                           the payload byte count of each local element.
+ *                           May be NULL if the process has no local elements.
+ * \param[in] element_data   The payloads of the local elements, concatenated
+ *                           in element order without padding (CSR layout with
+ *                           the prefix sums of \a element_bytes as offsets).
+ * \param[out] pghost_offsets On output an array of num_ghosts + 1 byte
+ *                           offsets into \a *pghost_data; the payload of the
+ *                           i-th ghost occupies the bytes
+ *                           [offset[i], offset[i+1]). Allocated by this
+ *                           function, to be freed with T8_FREE.
+ * \param[out] pghost_data   On output the concatenated payloads of the ghost
+ *                           elements. Allocated by this function, to be freed
+ *                           with T8_FREE.
+ * \note This function is collective and hence must be called by all processes
+ *       in the forest's MPI Communicator.
+ */
+void                t8_forest_ghost_exchange_data_var (t8_forest_t forest,
+                                                       const size_t
+                                                       *element_bytes,
+                                                       const char
+                                                       *element_data,
+                                                       size_t
+                                                       **pghost_offsets,
+                                                       char **pghost_data);
+
+/** Opaque handle for an ongoing ghost data exchange.
+ * \see t8_forest_ghost_exchange_data_begin
+ */
+typedef struct t8_ghost_data_exchange t8_ghost_data_exchange_t;
+
+/** Begin a ghost exchange of user defined element data without waiting for
+ * its completion. The communication is posted asynchronously, so the caller
+ * can overlap it with computation on the interior elements and complete it
+ * with \ref t8_forest_ghost_exchange_data_end.
+ * \param[in] forest       The forest. Must be committed.
+ * \param[in,out] element_data An array of length num_local_elements + num_ghosts
+ *                         storing one value for each local element and ghost in
+ *                         \a forest. The ghost entries are written to until the
+ *                         matching end call returns; the local entries may be
+ *                         read in the meantime, but must not be modified.
+ * \return                 A handle that must be passed to
+ *                         \ref t8_forest_ghost_exchange_data_end. May be NULL
+ *                         if there is nothing to communicate.
+ * \note This function is collective and hence must be called by all processes
+ *       in the forest's MPI Communicator.
+ * \note Where MPI-3 is available, the exchange is posted as one neighborhood
+ *       collective on a distributed graph communicator built during ghost
+ *       creation, letting the MPI library optimize for the communication
+ *       topology; otherwise point-to-point messages are used.
+ */
+t8_ghost_data_exchange_t *t8_forest_ghost_exchange_data_begin (t8_forest_t
+                                                               forest,
+                                                               sc_array_t
+                                                               *element_data);
+
+/** Complete a ghost data exchange started with
+ * \ref t8_forest_ghost_exchange_data_begin. After this call returns, the
+ * ghost entries of the element data array are updated and the handle is
+ * invalidated.
+ * \param[in] forest        The forest the exchange was started on.
+ * \param[in] data_exchange The handle returned by the begin call. May be NULL.
+ */
+void                t8_forest_ghost_exchange_data_end (t8_forest_t forest,
+                                                       t8_ghost_data_exchange_t
+                                                       *data_exchange);
+
+/** Exchange the ghost information of several user defined element data
+ * arrays in one round of communication. The fields of all arrays that go
+ * to the same process are packed into a single message, so the latency
+ * does not grow with the number of arrays as it would with one
+ * \ref t8_forest_ghost_exchange_data call per array. The arrays may have
+ * different element sizes.
+ * \param[in] forest       The forest. Must be committed.
+ * \param[in] num_arrays   The number of data arrays, must be > 0.
+ * \param[in,out] element_data An array of \a num_arrays data arrays, each of
+ *                         length num_local_elements + num_ghosts as in
+ *                         \ref t8_forest_ghost_exchange_data. The ghost
+ *                         entries of all arrays are updated.
+ * \note This function is collective and hence must be called by all processes
+ *       in the forest's MPI Communicator.
+ */
+void                t8_forest_ghost_exchange_data_multiple (t8_forest_t
+                                                            forest,
+                                                            int num_arrays,
+                                                            sc_array_t
+                                                            **element_data);
+
+/** Begin a ghost exchange of several data arrays without waiting for its
+ * completion, analogous to \ref t8_forest_ghost_exchange_data_begin.
+ * The exchange is completed with \ref t8_forest_ghost_exchange_data_end;
+ * the ghost entries of the arrays are only valid after that call returned,
+ * since the packed messages are staged and distributed into the arrays at
+ * completion.
+ * \param[in] forest       The forest. Must be committed.
+ * \param[in] num_arrays   The number of data arrays, must be > 0.
+ * \param[in,out] element_data An array of \a num_arrays data arrays, each of
+ *                         length num_local_elements + num_ghosts. The local
+ *                         entries may be read until the end call, but must
+ *                         not be modified.
+ * \return                 A handle that must be passed to
+ *                         \ref t8_forest_ghost_exchange_data_end. May be NULL
+ *                         if there is nothing to communicate.
+ * \note This function is collective and hence must be called by all processes
+ *       in the forest's MPI Communicator.
+ */
+t8_ghost_data_exchange_t
+  *t8_forest_ghost_exchange_data_multiple_begin (t8_forest_t forest,
+                                                 int num_arrays,
+                                                 sc_array_t **element_data);
+
+/** Begin a ghost exchange of a raw data buffer with caller packed send
+ * buffers. Unlike \ref t8_forest_ghost_exchange_data_begin, t8code never
+ * dereferences \a data or the send buffers; they are handed to MPI as
+ * plain addresses. With a GPU-aware MPI library they may therefore be
+ * device memory, so device resident fields can be exchanged without
+ * staging them through the host.
+ * The caller packs the send buffer of each remote rank itself, for
+ * example with a device side gather kernel driven by the index list of
+ * \ref t8_forest_ghost_remote_send_indices; the ghost entries are
+ * received in place into \a data. The exchange is completed with
+ * \ref t8_forest_ghost_exchange_data_end. The send buffers must stay
+ * valid until that call returned and are not freed by t8code.
+ * \param[in] forest       The forest. Must be committed.
+ * \param[in,out] data     A buffer of num_local_elements + num_ghosts
+ *                         entries of \a entry_bytes bytes each. The ghost
+ *                         entries are updated by the exchange.
+ * \param[in] entry_bytes  The byte size of one entry of \a data.
+ * \param[in] send_buffers For each remote rank (in the order of
+ *                         \ref t8_forest_ghost_get_remotes) the packed
+ *                         buffer of the entries sent to it, holding one
+ *                         entry per send index in send order.
+ * \return                 A handle that must be passed to
+ *                         \ref t8_forest_ghost_exchange_data_end. May be NULL
+ *                         if there is nothing to communicate.
+ * \note This function is collective and hence must be called by all processes
+ *       in the forest's MPI Communicator.
+ */
+t8_ghost_data_exchange_t
+  *t8_forest_ghost_exchange_data_raw_begin (t8_forest_t forest, void *data,
+                                            size_t entry_bytes,
+                                            char **send_buffers);
+
+/** Exchange ghost information of user defined element data, using MPI-3
+ * shared memory for the same-node neighbors.
+ * The data for remote ranks on the same compute node is placed in a
+ * shared memory window on the node-local communicator (\see t8_shmem_init)
+ * and copied directly by the neighbors, so that network messages are only
+ * posted for off-node remotes. The result is identical to
+ * \ref t8_forest_ghost_exchange_data.
+ * If the node communicators are not attached to the forest's communicator
+ * or t8code was configured without MPI-3 shared memory windows, this
+ * function falls back to the message based exchange.
+ * \param[in] forest       The forest. Must be committed.
+ * \param[in] element_data An array of length num_local_elements + num_ghosts
+ *                         storing one value for each local element and ghost in \a forest.
+ *                         After calling this function the entries for the ghost elements
+ *                         are update with the entries in the \a element_data array of
+ *                         the corresponding owning process.
+ * \note This function is collective and hence must be called by all processes in the forest's
+ *       MPI Communicator.
+ */
+void                t8_forest_ghost_exchange_data_shmem (t8_forest_t forest,
+                                                         sc_array_t
+                                                         *element_data);
+
 /** Print the ghost structure of a forest. Only used for debugging. */
 void                t8_forest_ghost_print (t8_forest_t forest);
 
@@ -561,6 +1892,23 @@ void                t8_forest_partition_cmesh (t8_forest_t forest,
  */
 sc_MPI_Comm         t8_forest_get_mpicomm (t8_forest_t forest);
 
+/** Return the subcommunicator of the ranks that hold elements of a
+ * forest.
+ * \param [in]      forest      The forest. Must be committed and must
+ *                              have been committed with
+ *                              \ref t8_forest_set_subcomm enabled.
+ * \return                      The communicator spanning the element
+ *                              holding ranks of \a forest, ordered by
+ *                              their ranks in the forest's communicator.
+ *                              If no rank is empty, this is the forest's
+ *                              communicator itself. On ranks without
+ *                              elements sc_MPI_COMM_NULL is returned and
+ *                              no collective may be issued on the result.
+ * The returned communicator is owned by the forest and freed with it.
+ * \see t8_forest_set_subcomm
+ */
+sc_MPI_Comm         t8_forest_get_subcomm (t8_forest_t forest);
+
 /** Return the global id of the first local tree of a forest.
  * \param [in]      forest      The forest.
  * \return                      The global id of the first local tree in \a forest.
@@ -642,6 +1990,107 @@ t8_element_t       *t8_forest_get_element (t8_forest_t forest,
                                            t8_locidx_t lelement_id,
                                            t8_locidx_t *ltreeid);
 
+/** Return an element of the forest, using a flat offset index.
+ * In contrast to \ref t8_forest_get_element, the owning tree is found
+ * by a branch-free binary search in a flat array of the per tree
+ * element offsets that is built on the first call and cached in the
+ * forest, avoiding the per call sc_array traversal. Use this variant
+ * when many scattered element ids are looked up, for example when
+ * mapping element ids of a coupled code.
+ * \param [in]      forest      The forest.
+ * \param [in]      lelement_id The local id of an element in \a forest.
+ *                              Must satisfy 0 <= \a lelement_id and
+ *                              \a lelement_id < number of local elements.
+ * \param [out]     ltreeid     If not NULL, on output the local tree id of the tree in which the
+ *                              element lies in.
+ * \return          A pointer to the element.
+ * \a forest must be committed before calling this function.
+ */
+t8_element_t       *t8_forest_get_element_fast (t8_forest_t forest,
+                                                t8_locidx_t lelement_id,
+                                                t8_locidx_t *ltreeid);
+
+/** Resolve a batch of global element indices to local elements in one sweep.
+ * The samples that fall into the local element range of this process are
+ * sorted by id and resolved against the tree element offsets in a single
+ * linear scan, so N scattered samples cost one sort plus one pass over the
+ * touched trees instead of N independent offset searches. Samples owned by
+ * other processes are skipped; each process resolves exactly its own hits,
+ * so drawing the same global samples on all processes partitions them.
+ * Intended for Monte Carlo estimators that sample random elements globally;
+ * uniform random keys in [0, 1) map to valid indices by multiplying with
+ * \ref t8_forest_get_global_num_elements.
+ * \param [in]      forest      The forest. Must be committed.
+ * \param [in]      sample_gids The sampled global element indices, in any
+ *                              order, repetitions allowed.
+ * \param [in]      num_samples The number of entries of \a sample_gids.
+ * \param [out]     sample_positions If not NULL, an array of \a num_samples
+ *                              entries; on output entry \a i holds the
+ *                              position in \a sample_gids of the i-th hit.
+ * \param [out]     ltreeids    If not NULL, an array of \a num_samples
+ *                              entries; on output the local tree id of each
+ *                              hit.
+ * \param [out]     elements    If not NULL, an array of \a num_samples
+ *                              pointers; on output the element of each hit.
+ *                              The elements belong to the forest.
+ * \param [out]     centroids   If not NULL, an array of 3 * \a num_samples
+ *                              doubles; on output the x, y and z coordinates
+ *                              of the centroid of each hit.
+ * \return                      The number of hits, that is the number of
+ *                              samples owned by this process. Only this many
+ *                              leading entries of the output arrays are
+ *                              filled.
+ */
+t8_locidx_t         t8_forest_sample_elements (t8_forest_t forest,
+                                               const t8_gloidx_t
+                                               *sample_gids,
+                                               t8_locidx_t num_samples,
+                                               t8_locidx_t *sample_positions,
+                                               t8_locidx_t *ltreeids,
+                                               t8_element_t **elements,
+                                               double *centroids);
+
+/** One refine or coarsen directive of \ref t8_forest_micro_adapt. */
+typedef struct t8_forest_micro_directive
+{
+  t8_locidx_t         ltreeid;  /**< The local tree containing the element. */
+  t8_locidx_t         lelement_id;      /**< The index of the element within its tree.
+                                             For a coarsen directive, the index of the
+                                             first member of the family. */
+  int                 refine;   /**< 1 to refine the element, -1 to coarsen the
+                                     family starting at \a lelement_id. */
+} t8_forest_micro_directive_t;
+
+/** Patch a committed forest in place by an explicit list of refine and
+ * coarsen directives.
+ * This is a structural fast path for sparse changes, such as tracking a
+ * handful of moving probes between full adapt cycles: the element arrays
+ * of the affected trees are spliced locally, the element offsets are
+ * updated and the ghost layer is rebuilt only if some process changed an
+ * element at its process boundary. All other trees, caches and the ghost
+ * layer stay untouched, so a change of a few hundred interior elements
+ * costs far below a full \ref t8_forest_adapt plus commit cycle.
+ * Registered element data fields are spliced along: children inherit the
+ * value of the refined element, a coarsened family passes the value of
+ * its first member to the parent. Registered cache invalidation hooks
+ * are fired for the changed trees and the forest's generation counter is
+ * advanced.
+ * \param [in,out] forest   A committed forest, modified in place.
+ * \param [in] directives   An array of \a num_directives directives.
+ *                          They must name disjoint elements; a coarsen
+ *                          directive must name the first member of a
+ *                          complete family of local elements.
+ * \param [in] num_directives The number of directives. May differ between
+ *                          the processes and may be 0.
+ * \note This function is collective over the forest's communicator.
+ * \note The forest does not re-establish balance; refining may introduce
+ * level jumps that a later \ref t8_forest_set_balance commit removes.
+ */
+void                t8_forest_micro_adapt (t8_forest_t forest,
+                                           const t8_forest_micro_directive_t
+                                           *directives,
+                                           t8_locidx_t num_directives);
+
 /** Return an element of a local tree in a forest.
  * \param [in]      forest      The forest.
  * \param [in]      ltreeid     An id of a local tree in the forest.
@@ -779,6 +2228,83 @@ int                 t8_forest_element_point_inside (t8_forest_t forest,
                                                     const double point[3],
                                                     const double tolerance);
 
+/** Find the local leaf elements that contain a batch of points.
+ * Instead of testing the points against every leaf, each candidate tree is
+ * descended from its root: on each level only the child that contains the
+ * point is followed and the leaf array is looked up by the linear id of the
+ * child's first descendant, so locating a point costs O(maxlevel) point
+ * tests and binary searches. Trees whose bounding box does not contain a
+ * point are rejected without any element test, and no memory is allocated
+ * per query.
+ * Like \ref t8_forest_element_point_inside this function relies on linearly
+ * interpolated geometries.
+ * \param [in]      forest     The committed forest to search.
+ * \param [in]      points     An array of \a num_points x 3 coordinates.
+ * \param [in]      num_points The number of points.
+ * \param [in]      tolerance  Tolerance for the point tests, must be
+ *                             positive, \see t8_forest_element_point_inside.
+ *                             Points within \a tolerance of a leaf boundary
+ *                             may be assigned to either adjacent leaf.
+ * \param [out]     element_indices On output, entry i is the forest local
+ *                             index of a leaf that contains point i, or -1
+ *                             if no local leaf contains it (the point then
+ *                             lies outside the local partition).
+ * \return                     The number of points that were found in the
+ *                             local leaf elements.
+ */
+t8_locidx_t         t8_forest_find_point_owners (t8_forest_t forest,
+                                                 const double *points,
+                                                 t8_locidx_t num_points,
+                                                 const double tolerance,
+                                                 t8_locidx_t
+                                                 *element_indices);
+
+/** Return the axis aligned bounding box of a local leaf element.
+ * The boxes of all elements of the tree are computed from the element
+ * corner coordinates and cached on the first call for that tree; repeated
+ * point and range queries against the same committed forest thus reuse
+ * them. The cache is freed with the forest. Since a committed forest is
+ * immutable, adaptation creates a new forest and thereby a fresh cache.
+ * \param [in]  forest        The forest. Must be committed.
+ * \param [in]  ltreeid       A local tree id of \a forest.
+ * \param [in]  index_in_tree The tree local index of a leaf in the tree.
+ * \return                    The box of the leaf as the six values
+ *                            xmin, xmax, ymin, ymax, zmin, zmax. The
+ *                            storage belongs to the forest and is valid
+ *                            until the forest is destroyed.
+ */
+const double       *t8_forest_element_aabb (t8_forest_t forest,
+                                            t8_locidx_t ltreeid,
+                                            t8_locidx_t index_in_tree);
+
+/** Collect all local leaf elements whose bounding box overlaps a given
+ * axis aligned box.
+ * The query walks the local trees in space-filling curve order, skips
+ * every tree whose bounding box does not touch \a box and tests the
+ * cached element boxes of the remaining trees,
+ * \see t8_forest_element_aabb.
+ * \param [in]  forest        The forest. Must be committed.
+ * \param [in]  box           The query box as the six values
+ *                            xmin, xmax, ymin, ymax, zmin, zmax.
+ * \param [out] num_elements  On output the number of collected leaves.
+ * \return                    The forest local indices of the overlapping
+ *                            leaves in ascending order, allocated with
+ *                            T8_ALLOC; the caller must free the array with
+ *                            T8_FREE. NULL if no leaf overlaps \a box.
+ * \note An element whose box overlaps \a box does not necessarily
+ * intersect \a box itself; for exact tests filter the returned candidates
+ * with \ref t8_forest_element_point_inside or a custom predicate.
+ */
+t8_locidx_t        *t8_forest_elements_in_box (t8_forest_t forest,
+                                               const double *box,
+                                               t8_locidx_t *num_elements);
+
+/** Free the cached element bounding boxes of a forest, if they exist.
+ * This is called automatically when the forest is destroyed.
+ * \param [in,out] forest  A forest.
+ */
+void                t8_forest_aabb_cache_destroy (t8_forest_t forest);
+
 /* TODO: if set level and partition/adapt/balance all give NULL, then
  * refine uniformly and partition/adapt/balance the unfiform forest. */
 /** Build a uniformly refined forest on a coarse mesh.
@@ -833,6 +2359,31 @@ void                t8_forest_ref (t8_forest_t forest);
  *                              the forest is not modified in other ways.
  */
 void                t8_forest_unref (t8_forest_t *pforest);
+
+/** Replace a forest by its successor, donating its element storage.
+ * This implements the double buffer pattern of time loops that rebuild
+ * the forest every cycle:
+ *
+ *     t8_forest_swap_storage (&forest, forest_new);
+ *
+ * replaces the usual unref-and-assign sequence.  The old forest is
+ * dereferenced as by \ref t8_forest_unref and \a forest_new is stored in
+ * \a *pforest_old.  In addition, slab pooling is enabled, so that the
+ * element storage slabs of the destroyed forest are retained and reused
+ * by the next commit instead of being freed; steady state adapt cycles
+ * thus stop allocating element storage altogether.  The donation takes
+ * effect for forests whose element storage uses the slab memory mode,
+ * \see t8_forest_set_memory_mode.  All retained slabs are released
+ * when the last live forest is destroyed.
+ * \param [in,out] pforest_old  On input, the forest pointed to must exist
+ *                              with positive reference count.  On output,
+ *                              it is set to \a forest_new.
+ * \param [in]     forest_new   The successor forest, usually the result
+ *                              of committing an adapt/partition cycle.
+ *                              May be NULL to end the loop.
+ */
+void                t8_forest_swap_storage (t8_forest_t *pforest_old,
+                                            t8_forest_t forest_new);
 T8_EXTERN_C_END ();
 
 #endif /* !T8_FOREST_GENERAL_H */
@@ -48,6 +48,29 @@ void                t8_forest_element_coordinate (t8_forest_t forest,
                                                   int corner_number,
                                                   double *coordinates);
 
+/** Compute the corner coordinates of all elements of a local tree in one
+ * pass and store them as a structure of arrays.
+ * The corners of the elements are appended in the order of the elements in
+ * the tree; for each element all of its corners follow in Z-order. Compared
+ * to calling \ref t8_forest_element_coordinate per corner, the tree class,
+ * scheme and geometry are resolved only once for the whole tree and the
+ * separate x, y and z arrays allow vectorized consumption of the result.
+ * \param [in]      forest     The forest. Must be committed.
+ * \param [in]      ltreeid    The forest local id of the tree.
+ * \param [out]     x          On input an allocated array with one entry per
+ *                             element corner of the tree,
+ *                             t8_eclass_num_vertices of the tree class times
+ *                             the number of elements suffices. On output the
+ *                             x coordinates of the corners.
+ * \param [out]     y          Like \a x for the y coordinates.
+ * \param [out]     z          Like \a x for the z coordinates.
+ * \return                     The number of entries written to each array.
+ */
+t8_locidx_t         t8_forest_element_coordinates_all (t8_forest_t forest,
+                                                       t8_locidx_t ltreeid,
+                                                       double *x, double *y,
+                                                       double *z);
+
 /** Compute the coordinates of a point inside an element inside a tree.
  *  The point is given in reference coordinates inside the element and gets
  *  converted to reference coordinates inside the tree. After that, the point
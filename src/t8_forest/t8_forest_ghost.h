@@ -97,6 +97,41 @@ t8_locidx_t         t8_forest_ghost_get_ghost_treeid (t8_forest_t forest,
 t8_eclass_t         t8_forest_ghost_get_tree_class (t8_forest_t forest,
                                                     t8_locidx_t lghost_tree);
 
+/** Return the number of ghost trees of one element class.
+ * Together with \ref t8_forest_ghost_get_tree_of_class this provides an
+ * eclass-major iteration over the ghost layer: the ghost elements of
+ * each tree are stored contiguously and are all of the tree's class, so
+ * iterating the trees class by class visits the ghost elements in
+ * homogeneous per-class runs, without per-element class branches in
+ * hybrid meshes.
+ * \param [in]  forest    The forest. Ghost layer must exist.
+ * \param [in]  eclass    An element class.
+ * \return                The number of ghost trees whose class is \a eclass.
+ * \a forest must be committed before calling this function.
+ * \note The class-wise index is built on the first call and kept for the
+ * lifetime of the ghost layer.
+ */
+t8_locidx_t         t8_forest_ghost_num_trees_of_class (t8_forest_t forest,
+                                                        t8_eclass_t eclass);
+
+/** Return the i-th ghost tree of one element class.
+ * \param [in]  forest    The forest. Ghost layer must exist.
+ * \param [in]  eclass    An element class.
+ * \param [in]  itree     An index, 0 <= \a itree <
+ *                        \ref t8_forest_ghost_num_trees_of_class.
+ * \return                The ghost tree id of the \a itree-th ghost tree
+ *                        of class \a eclass. The trees of a class are
+ *                        returned in ascending ghost tree order, so their
+ *                        element offsets
+ *                        (\ref t8_forest_ghost_get_tree_element_offset)
+ *                        map each per-class run back to the (tree, index)
+ *                        order of the ghost storage.
+ * \a forest must be committed before calling this function.
+ */
+t8_locidx_t         t8_forest_ghost_get_tree_of_class (t8_forest_t forest,
+                                                       t8_eclass_t eclass,
+                                                       t8_locidx_t itree);
+
 /** Given a local ghost tree compute the global tree id of it.
  * \param [in]  forest    The forest. Ghost layer must exist.
  * \param [in]  lghost_tree The ghost tree id of a ghost tree.
@@ -138,6 +173,208 @@ t8_locidx_t         t8_forest_ghost_remote_first_tree (t8_forest_t forest,
 t8_locidx_t         t8_forest_ghost_remote_first_elem (t8_forest_t forest,
                                                        int remote);
 
+/** Return the number of ranks that own ghost elements of this process.
+ * \param [in] forest   A forest with constructed ghost layer.
+ * \return              The number of owner ranks. Their contiguous ghost
+ *                      ranges are iterated with
+ *                      \ref t8_forest_ghost_rank_range.
+ */
+int                 t8_forest_ghost_num_ghost_ranks (t8_forest_t forest);
+
+/** Return the contiguous range of ghost elements owned by one rank.
+ * The ghost elements are stored grouped by their owner rank in ascending
+ * rank (and thus space-filling curve) order, so the ranges of the owner
+ * ranks partition the ghost index space and unpack loops and per-rank
+ * accumulation kernels can run over them sequentially without an
+ * indirection array.
+ * \param [in]  forest      A forest with constructed ghost layer.
+ * \param [in]  irank       An index of an owner rank, 0 <= \a irank <
+ *                          \ref t8_forest_ghost_num_ghost_ranks.
+ * \param [out] first_ghost If not NULL, filled with the index of the
+ *                          rank's first element among all ghost elements.
+ * \param [out] num_elements If not NULL, filled with the number of ghost
+ *                          elements owned by the rank.
+ * \return                  The mpirank of the \a irank th owner rank.
+ *                          The ranks are ascending in \a irank.
+ * \see t8_forest_ghost_remote_recv_range for the ranges of the data
+ * exchange, which are indexed by the remote ranks instead.
+ */
+int                 t8_forest_ghost_rank_range (t8_forest_t forest,
+                                                int irank,
+                                                t8_locidx_t *first_ghost,
+                                                t8_locidx_t *num_elements);
+
+/** Return the indices of the local elements that are sent to a remote rank
+ * during a ghost data exchange, in send order.
+ * The list stays valid and unchanged for the lifetime of the ghost layer,
+ * so a caller that packs its send buffers itself (for example with a
+ * device side gather kernel, see
+ * \ref t8_forest_ghost_exchange_data_raw_begin) can upload it once per
+ * ghost layer.
+ * \param [in] forest       A committed forest with constructed ghost layer.
+ * \param [in] iremote      The position of the remote rank in the array
+ *                          returned by \ref t8_forest_ghost_get_remotes.
+ * \param [out] num_indices The number of indices is stored here.
+ * \return                  A pointer to the indices, owned by the ghost layer.
+ */
+const t8_locidx_t  *t8_forest_ghost_remote_send_indices (t8_forest_t forest,
+                                                         int iremote,
+                                                         t8_locidx_t
+                                                         *num_indices);
+
+/** Return the range of ghost elements that is received from a remote rank
+ * during a ghost data exchange.
+ * \param [in] forest       A committed forest with constructed ghost layer.
+ * \param [in] iremote      The position of the remote rank in the array
+ *                          returned by \ref t8_forest_ghost_get_remotes.
+ * \param [out] recv_offset The offset of the first ghost element of the
+ *                          remote among all ghost elements is stored here.
+ * \param [out] recv_count  The number of ghost elements of the remote is
+ *                          stored here.
+ */
+void                t8_forest_ghost_remote_recv_range (t8_forest_t forest,
+                                                       int iremote,
+                                                       t8_locidx_t
+                                                       *recv_offset,
+                                                       t8_locidx_t
+                                                       *recv_count);
+
+/** Compute the number of bytes of heap memory that the ghost structure of
+ * a forest occupies, including the ghost element storage, the per remote
+ * bookkeeping and the communication plans. The per-entry link overhead of
+ * the internal hash tables is not counted.
+ * \param [in] forest   A committed forest.
+ * \return              The byte count of the ghost structure, 0 if the
+ *                      forest has no ghost layer.
+ * \see t8_forest_get_memory_footprint
+ */
+size_t              t8_forest_ghost_memory_used (t8_forest_t forest);
+
+/** Collect the local indices of all process boundary elements, that is of
+ * all local elements that are remote elements of at least one other rank.
+ * The indices were recorded during the ghost layer creation, so no face
+ * neighbor computation is performed.
+ * \param [in] forest       A committed forest with constructed ghost layer.
+ * \param [out] num_indices The number of collected indices.
+ * \return                  A newly allocated ascending array of the forest
+ *                          local leaf indices of the boundary elements, or
+ *                          NULL if the forest has no ghost layer or no
+ *                          remote elements. The caller takes ownership and
+ *                          frees it with T8_FREE.
+ * \see t8_forest_subset_new_boundary
+ */
+t8_locidx_t        *t8_forest_ghost_remote_leaf_indices (t8_forest_t forest,
+                                                         t8_locidx_t
+                                                         *num_indices);
+
+/** Opaque handle of a ghost data view.
+ * A ghost data view co-locates the exchanged user data of every ghost
+ * element with its ghost tree metadata in one interleaved record array
+ * and precomputes the face stencils across the process boundary, so
+ * that stencil kernels reach a ghost neighbor's data with a single
+ * cached pointer instead of a ghost tree lookup, an offset computation
+ * and a load from a separate data array.
+ * \see t8_forest_ghost_view_new
+ */
+typedef struct t8_forest_ghost_view *t8_forest_ghost_view_t;
+
+/** Callback for \ref t8_forest_ghost_view_iterate_faces. It is invoked
+ * once per local boundary leaf face that has at least one ghost neighbor.
+ * \param [in] forest        The forest of the view.
+ * \param [in] leaf_index    The forest local index of the boundary leaf.
+ * \param [in] face          The face of the leaf across which the ghost
+ *                           neighbors lie.
+ * \param [in] num_neighbors The number of ghost neighbors at this face.
+ * \param [in] neighbor_data The co-located data of the ghost neighbors,
+ *                           \a num_neighbors pointers into the view.
+ * \param [in] user_data     The pointer passed to the iterator.
+ */
+typedef void        (*t8_forest_ghost_view_face_fn) (t8_forest_t forest,
+                                                     t8_locidx_t leaf_index,
+                                                     int face,
+                                                     int num_neighbors,
+                                                     const void
+                                                     **neighbor_data,
+                                                     void *user_data);
+
+/** Create a ghost data view. The ghost entries of \a element_data are
+ * first updated with \ref t8_forest_ghost_exchange_data, then copied next
+ * to the ghost metadata into the interleaved record storage of the view,
+ * and the face stencils of all process boundary leafs are resolved once
+ * with the batch neighbor search.
+ * \param [in] forest       The forest. Must be committed, balanced and
+ *                          have a ghost layer.
+ * \param [in,out] element_data An array of length
+ *                          num_local_elements + num_ghosts as in
+ *                          \ref t8_forest_ghost_exchange_data. The ghost
+ *                          entries are updated.
+ * \return                  The ghost data view. The caller owns it and
+ *                          destroys it with
+ *                          \ref t8_forest_ghost_view_destroy.
+ * \note This function is collective over the forest's communicator.
+ */
+t8_forest_ghost_view_t t8_forest_ghost_view_new (t8_forest_t forest,
+                                                 sc_array_t *element_data);
+
+/** Refresh the data of a ghost data view after the local entries of the
+ * element data changed, for example once per time step. The exchange is
+ * repeated and the ghost data copied into the view; the stencils and all
+ * pointers previously handed out stay valid.
+ * \param [in,out] view     A ghost data view.
+ * \param [in,out] element_data The data array; must have the element size
+ *                          and length the view was created with. The
+ *                          ghost entries are updated.
+ * \note This function is collective over the forest's communicator.
+ */
+void                t8_forest_ghost_view_update (t8_forest_ghost_view_t view,
+                                                 sc_array_t *element_data);
+
+/** Return a pointer to the co-located data of one ghost element.
+ * \param [in] view         A ghost data view.
+ * \param [in] ghost_index  The index of a ghost element among all ghosts,
+ *                          0 <= \a ghost_index < num_ghosts.
+ * \return                  A pointer to the data of the ghost, valid until
+ *                          the view is destroyed and refreshed in place by
+ *                          \ref t8_forest_ghost_view_update.
+ */
+const void         *t8_forest_ghost_view_data (t8_forest_ghost_view_t view,
+                                               t8_locidx_t ghost_index);
+
+/** Return the ghost tree id of one ghost element of a view.
+ * \param [in] view         A ghost data view.
+ * \param [in] ghost_index  The index of a ghost element among all ghosts.
+ * \return                  The ghost tree id of the ghost, as in
+ *                          \ref t8_forest_ghost_get_ghost_treeid.
+ */
+t8_locidx_t         t8_forest_ghost_view_treeid (t8_forest_ghost_view_t view,
+                                                 t8_locidx_t ghost_index);
+
+/** Return the number of face stencils of a view, that is the number of
+ * (boundary leaf, face) pairs with at least one ghost neighbor.
+ * \param [in] view         A ghost data view.
+ * \return                  The number of stencils.
+ */
+t8_locidx_t         t8_forest_ghost_view_num_stencils (t8_forest_ghost_view_t
+                                                       view);
+
+/** Iterate over all face stencils at the process boundary, delivering the
+ * local leaf and the data pointers of its ghost neighbors directly.
+ * \param [in] view         A ghost data view.
+ * \param [in] callback     Invoked once per stencil.
+ * \param [in] user_data    Passed to \a callback.
+ */
+void                t8_forest_ghost_view_iterate_faces (t8_forest_ghost_view_t
+                                                        view,
+                                                        t8_forest_ghost_view_face_fn
+                                                        callback,
+                                                        void *user_data);
+
+/** Destroy a ghost data view and free its storage.
+ * \param [in,out] pview    Pointer to a view. Set to NULL on output.
+ */
+void                t8_forest_ghost_view_destroy (t8_forest_ghost_view_t
+                                                  *pview);
+
 /** Increase the reference count of a ghost structure.
  * \param [in,out]  ghost     On input, this ghost structure must exist with
  *                            positive reference count.
@@ -167,6 +404,17 @@ void                t8_forest_ghost_unref (t8_forest_ghost_t *pghost);
 void                t8_forest_ghost_destroy (t8_forest_ghost_t *pghost);
 
 /** Create one layer of ghost elements for a forest.
+ * The constructed ghost layer stores its elements in globally ascending
+ * space-filling curve order: the ghost trees are sorted by their global
+ * tree id and the ghost elements of each tree by their position on the
+ * curve. This ordering is guaranteed: the received messages are merged
+ * in ascending rank order and the partition assigns ascending curve
+ * segments to ascending ranks, so the per-rank ghost ranges concatenate
+ * into the sorted sequence. In particular the ghost range of each remote
+ * rank is contiguous (\see t8_forest_ghost_remote_recv_range), the data
+ * unpack of \ref t8_forest_ghost_exchange_data writes each rank's region
+ * with one sequential copy, and kernels that read ghost data in curve
+ * order traverse the ghost arrays strictly sequentially.
  * \see t8_forest_set_ghost
  * \param [in,out]    forest     The forest.
  * \a forest must be committed before calling this function.
@@ -186,6 +434,59 @@ void                t8_forest_ghost_create_balanced_only (t8_forest_t forest);
 /* experimental version using the ghost_v3 algorithm */
 void                t8_forest_ghost_create_topdown (t8_forest_t forest);
 
+/** Choose the ghost algorithm for a forest automatically.
+ * Called during \ref t8_forest_commit if ghost version 0 was passed to
+ * \ref t8_forest_set_ghost_ext. If the forest is known to be balanced, the
+ * iterative balanced-only algorithm is chosen. Otherwise the decision
+ * between the iterative unbalanced algorithm and the top-down search is
+ * based on the ghost timers in the profile of the source forest, if
+ * available.
+ * \param [in]        forest      The forest for which ghosts will be created.
+ *                                Does not need to be committed yet.
+ * \param [in]        forest_from The forest that \a forest is derived from,
+ *                                or NULL if there is none.
+ * \return                        The ghost version to use, 1, 2, or 3.
+ * \see t8_forest_set_ghost_ext
+ */
+int                 t8_forest_ghost_choose_algorithm (t8_forest_t forest,
+                                                      t8_forest_t
+                                                      forest_from);
+
+/** Decide whether the ghost creation of a forest should aggregate its
+ * messages through one leader rank per compute node.
+ * Called during \ref t8_forest_commit. Each ghost creation records a
+ * histogram of its message sizes in the profile. If most of the messages
+ * of the previous ghost creation were below one kilobyte, their cost is
+ * dominated by injection latency and bundling them per node pays off.
+ * The histograms of all processes are combined, so the decision is the
+ * same on each process.
+ * \param [in]        forest      The forest for which ghosts will be created.
+ *                                Does not need to be committed yet.
+ * \param [in]        forest_from The forest that \a forest is derived from,
+ *                                or NULL if there is none.
+ * \return                        Nonzero if the ghost creation should use
+ *                                the node leader exchange.
+ * \note This function is collective over the forest's MPI communicator.
+ */
+int                 t8_forest_ghost_choose_aggregation (t8_forest_t forest,
+                                                        t8_forest_t
+                                                        forest_from);
+
+/** Try to reuse the ghost layer of a source forest for an adapted forest.
+ * If no process changed a tree that contains remote elements, the old ghost
+ * structure is still valid and is referenced by \a forest, skipping the
+ * full rebuild. Otherwise nothing happens and the caller must create the
+ * ghost layer from scratch.
+ * \param [in,out]    forest      The adapted forest. Must have the same tree
+ *                                partition as \a forest_from and no ghost
+ *                                structure yet.
+ * \param [in]        forest_from The committed source forest with ghost layer.
+ * \return            Nonzero if the ghost layer was reused, zero otherwise.
+ * \note This function is collective over the forest's MPI communicator.
+ */
+int                 t8_forest_ghost_update (t8_forest_t forest,
+                                            t8_forest_t forest_from);
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_FOREST_GHOST_H! */
@@ -37,6 +37,257 @@ T8_EXTERN_C_BEGIN ();
 /* TODO: implement */
 void                t8_forest_save (t8_forest_t forest);
 
+/** Write a checkpoint of a committed forest to a binary file.
+ * The file stores the tree and element offsets of the writing partition,
+ * one (tree id, linear id, level) record per local leaf element and an
+ * optional user data array with \a data_size bytes per element.
+ * All processes write into the same file, each at the offset given by its
+ * global element offset, so the file layout is independent of the number
+ * of processes. If t8code is configured with MPI I/O the processes write
+ * collectively, otherwise they append sequentially to the shared file.
+ * The forest itself (its cmesh and scheme) is not stored; on load the
+ * matching cmesh and scheme must be provided, see
+ * \ref t8_forest_load_checkpoint.
+ * \param [in]  forest    A committed forest.
+ * \param [in]  filename  The name of the checkpoint file to create.
+ * \param [in]  data      Pointer to \a data_size bytes of user data per
+ *                        local element, ordered as the local elements.
+ *                        May be NULL if \a data_size is 0.
+ * \param [in]  data_size The number of user data bytes per element.
+ * \return  True if successful, false if not (collective over all processes).
+ */
+int                 t8_forest_write_checkpoint (t8_forest_t forest,
+                                                const char *filename,
+                                                const void *data,
+                                                size_t data_size);
+
+/** Load a forest from a checkpoint file written by
+ * \ref t8_forest_write_checkpoint.
+ * The number of calling processes may differ from the number of processes
+ * that wrote the file; the elements are then repartitioned uniformly and
+ * a matching partition of \a cmesh is derived internally.
+ * If the process counts match, the stored partition is restored exactly.
+ * \param [in]  filename  The name of the checkpoint file.
+ * \param [in]  cmesh     The coarse mesh the forest was built from.
+ *                        Must be committed and must have the same trees as
+ *                        the cmesh the checkpoint was written with.
+ *                        The reference count of \a cmesh is not changed.
+ * \param [in]  scheme    The element scheme to build the elements with.
+ *                        The loaded forest takes ownership of one reference,
+ *                        call \ref t8_scheme_cxx_ref to keep your own.
+ * \param [in]  comm      The MPI communicator to load the forest on.
+ * \param [in]  data_size The expected number of user data bytes per element.
+ *                        Must match the value the checkpoint was written
+ *                        with if \a data is not NULL.
+ * \param [out] data      If not NULL, on output *\a data points to a newly
+ *                        allocated array with \a data_size bytes per local
+ *                        element holding the stored user data.
+ *                        It must be freed with T8_FREE.
+ * \return  The loaded and committed forest, or NULL on failure
+ *          (collective over all processes).
+ */
+t8_forest_t         t8_forest_load_checkpoint (const char *filename,
+                                               t8_cmesh_t cmesh,
+                                               t8_scheme_cxx_t *scheme,
+                                               sc_MPI_Comm comm,
+                                               size_t data_size,
+                                               void **data);
+
+/** Read a .msh file and build a uniformly refined, partitioned forest
+ * from it in one fused pipeline.
+ * The mesh is read onto the \a master process only, the cmesh is then
+ * committed directly into the partition of the uniform refinement of
+ * \a level and the level \a level forest is built on it. At no point does
+ * any process hold a replicated copy of the mesh, so the peak memory is
+ * bounded by one full copy on \a master during the parse plus the final
+ * partitioned state, instead of one full copy per process as with a
+ * replicated read followed by separate partition steps.
+ * \param [in] fileprefix  The prefix of the mesh file, fileprefix.msh is
+ *                         read. \see t8_cmesh_from_msh_file
+ * \param [in] comm        The MPI communicator to commit the forest with.
+ * \param [in] dim         The dimension to read from the .msh file.
+ * \param [in] master      The MPI rank that reads the file.
+ * \param [in] use_occ_geometry Read the parameters of a parametric msh
+ *                         file and use the occ geometry.
+ * \param [in] scheme      The element scheme of the forest.
+ *                         We take ownership. This can be prevented by
+ *                         referencing \b scheme.
+ * \param [in] level       The uniform refinement level of the forest.
+ * \param [in] do_face_ghost If true, a face ghost layer is created.
+ * \return  The committed uniform forest, or NULL if reading the file
+ *          failed (collective over all processes).
+ */
+t8_forest_t         t8_forest_from_msh_partitioned (const char *fileprefix,
+                                                    sc_MPI_Comm comm,
+                                                    int dim, int master,
+                                                    int use_occ_geometry,
+                                                    t8_scheme_cxx_t *scheme,
+                                                    const int level,
+                                                    const int do_face_ghost);
+
+/** The fixed size header at the start of a raw leaf file.
+ * See \ref t8_forest_write_leaves_raw for the file layout. */
+typedef struct t8_forest_leaves_header
+{
+  char                magic[8]; /**< "t8leaves", not NUL terminated. */
+  int32_t             format;   /**< Version of the file layout. */
+  int32_t             record_bytes;     /**< sizeof (t8_forest_leaves_record_t). */
+  int64_t             global_num_trees; /**< Global number of trees. */
+  int64_t             global_num_elements;      /**< Global number of elements. */
+} t8_forest_leaves_header_t;
+
+/** One entry of the tree index of a raw leaf file.
+ * The index holds one entry per global tree plus one closing entry, so the
+ * records of tree \a t are the global element indices
+ * [entry t].first_element to [entry t+1].first_element - 1. */
+typedef struct t8_forest_leaves_tree
+{
+  int64_t             first_element;    /**< Global index of the first element of the tree. */
+  int32_t             eclass;   /**< The t8_eclass_t of the tree, -1 in the closing entry. */
+  int32_t             pad;      /**< Explicit padding, always 0. */
+} t8_forest_leaves_tree_t;
+
+/** One record per leaf element of a raw leaf file, stored in SFC order. */
+typedef struct t8_forest_leaves_record
+{
+  t8_linearidx_t      linear_id;        /**< Linear id of the element on its level. */
+  int32_t             level;    /**< Refinement level of the element. */
+  int32_t             pad;      /**< Explicit padding, always 0. */
+} t8_forest_leaves_record_t;
+
+/** Write the leaf elements of a committed forest to one binary file that
+ * external tools can scan without t8code.
+ * The file stores the \ref t8_forest_leaves_header_t, a tree index of
+ * global_num_trees + 1 entries of \ref t8_forest_leaves_tree_t and one
+ * packed \ref t8_forest_leaves_record_t per element in SFC order.
+ * All processes write into the same file, each at the offset given by its
+ * global element offset. If t8code is configured with MPI I/O the processes
+ * write collectively, otherwise they append sequentially to the shared file.
+ * \param [in]  forest    A committed forest.
+ * \param [in]  filename  The name of the file to create.
+ * \return  True if successful, false if not (collective over all processes).
+ * \see t8_forest_leaves_reader_open for reading the file back.
+ */
+int                 t8_forest_write_leaves_raw (t8_forest_t forest,
+                                                const char *filename);
+
+/** A read only view of a raw leaf file written by
+ * \ref t8_forest_write_leaves_raw.
+ * Where supported, the file is memory mapped, so opening is cheap and only
+ * the accessed sections are paged in; otherwise it is read into memory. */
+typedef struct t8_forest_leaves_reader *t8_forest_leaves_reader_t;
+
+/** Open a raw leaf file for reading.
+ * \param [in]  filename  The name of a file written by
+ *                        \ref t8_forest_write_leaves_raw.
+ * \return  The reader, or NULL if the file cannot be opened or is not a
+ *          valid raw leaf file. Release it with
+ *          \ref t8_forest_leaves_reader_close.
+ */
+t8_forest_leaves_reader_t t8_forest_leaves_reader_open (const char *filename);
+
+/** Get the header of an open raw leaf file.
+ * \param [in]  reader    An open reader.
+ * \return  The file header. Valid until the reader is closed.
+ */
+const t8_forest_leaves_header_t
+  *t8_forest_leaves_reader_header (t8_forest_leaves_reader_t reader);
+
+/** Get the tree index of an open raw leaf file.
+ * \param [in]  reader    An open reader.
+ * \return  The global_num_trees + 1 tree index entries.
+ *          Valid until the reader is closed.
+ */
+const t8_forest_leaves_tree_t
+  *t8_forest_leaves_reader_tree_index (t8_forest_leaves_reader_t reader);
+
+/** Get the element records of an open raw leaf file.
+ * \param [in]  reader    An open reader.
+ * \return  The global_num_elements records in SFC order.
+ *          Valid until the reader is closed.
+ */
+const t8_forest_leaves_record_t
+  *t8_forest_leaves_reader_records (t8_forest_leaves_reader_t reader);
+
+/** Close a raw leaf file reader and unmap or free its file content.
+ * All pointers obtained from the reader are invalidated.
+ * \param [in,out]  preader   Pointer to an open reader. Set to NULL.
+ */
+void                t8_forest_leaves_reader_close (t8_forest_leaves_reader_t
+                                                   *preader);
+
+/** Write the leaf elements of a committed forest to one binary file whose
+ * element payload can be memory mapped by \ref t8_forest_open_mapped.
+ * The layout extends the raw leaf format of
+ * \ref t8_forest_write_leaves_raw: after the
+ * \ref t8_forest_leaves_header_t (with format 0x0002 and record_bytes 0)
+ * and the tree index follow a table with the element byte size of each
+ * t8_eclass_t and the native element storage of all leafs in SFC order.
+ * Since the native storage is written, the file depends on the element
+ * scheme and the host architecture and is meant for post processing on
+ * the same system, not for archival or exchange; use
+ * \ref t8_forest_write_leaves_raw for a portable file.
+ * All processes write into the same file, each at the offset given by its
+ * global element offset. If t8code is configured with MPI I/O the processes
+ * write collectively, otherwise they append sequentially to the shared file.
+ * \param [in]  forest    A committed forest.
+ * \param [in]  filename  The name of the file to create.
+ * \return  True if successful, false if not (collective over all processes).
+ */
+int                 t8_forest_write_leaves_mapped (t8_forest_t forest,
+                                                   const char *filename);
+
+/** Handle of a read only forest view whose element arrays point into a
+ * memory mapped leaf file, see \ref t8_forest_open_mapped. */
+typedef struct t8_forest_mapped *t8_forest_mapped_t;
+
+/** Open a file written by \ref t8_forest_write_leaves_mapped as a read
+ * only forest view.
+ * Where supported, the file is memory mapped and the element arrays of
+ * the view point directly into the mapping, so no leaf is ever copied
+ * into heap memory; opening costs only the tree and partition metadata
+ * and the elements are paged in on first access. The view is a committed
+ * forest that supports traversal, search and geometry evaluation like
+ * any other forest, but its elements reside in read only pages: any
+ * attempt to modify them in place fails with a segmentation fault.
+ * Use \ref t8_forest_set_copy to derive a mutable forest from the view.
+ * The elements are partitioned uniformly over the calling processes and
+ * a matching partition of \a cmesh is derived internally.
+ * \param [in]  filename  The name of a file written by
+ *                        \ref t8_forest_write_leaves_mapped on the same
+ *                        system with the same element scheme.
+ * \param [in]  cmesh     The coarse mesh the forest was built from.
+ *                        Must be committed and must have the same trees as
+ *                        the cmesh the file was written with.
+ *                        The reference count of \a cmesh is not changed.
+ * \param [in]  scheme    The element scheme the file was written with.
+ *                        The view takes ownership of one reference,
+ *                        call \ref t8_scheme_cxx_ref to keep your own.
+ * \param [in]  comm      The MPI communicator to open the view on.
+ * \return  The handle, or NULL on failure (collective over all processes).
+ *          Release it with \ref t8_forest_close_mapped.
+ */
+t8_forest_mapped_t  t8_forest_open_mapped (const char *filename,
+                                           t8_cmesh_t cmesh,
+                                           t8_scheme_cxx_t *scheme,
+                                           sc_MPI_Comm comm);
+
+/** Get the forest of a mapped view.
+ * \param [in]  mapped    An open mapped view.
+ * \return  The committed read only forest. It is owned by the view; take
+ *          a reference with \ref t8_forest_ref to keep it, but release
+ *          all such references before \ref t8_forest_close_mapped.
+ */
+t8_forest_t         t8_forest_mapped_get_forest (t8_forest_mapped_t mapped);
+
+/** Close a mapped view, destroy its forest and unmap the file content.
+ * All references to the forest except the one held by the view must have
+ * been released, since the element arrays are invalid once the file is
+ * unmapped.
+ * \param [in,out]  pmapped   Pointer to an open mapped view. Set to NULL.
+ */
+void                t8_forest_close_mapped (t8_forest_mapped_t *pmapped);
+
 /** Write the forest in a parallel vtu format. Extended version.
  * See \ref t8_forest_write_vtk for the standard version of this function.
  * Writes one master .pvtu file and each process writes in its own .vtu file.
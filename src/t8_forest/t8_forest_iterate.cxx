@@ -23,7 +23,18 @@
 #include <t8_forest/t8_forest_iterate.h>
 #include <t8_forest/t8_forest_types.h>
 #include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_ghost.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_cmesh.h>
 #include <t8_element_cxx.hxx>
+#include <t8_thread_pool.h>
+
+#ifdef SC_ENABLE_PTHREAD
+#include <pthread.h>
+#endif
+#if T8_ENABLE_OPENMP
+#include <omp.h>
+#endif
 
 /* We want to export the whole implementation to be callable from "C" */
 T8_EXTERN_C_BEGIN ();
@@ -82,13 +93,120 @@ t8_forest_split_array (const t8_element_t *element,
                   t8_forest_determine_child_type, (void *) &query_data);
 }
 
+/* The preallocated buffers of one recursion level of a face iteration
+ * context. The capacity grows on demand, since the child count of an
+ * element is not uniform for all schemes (pyramids). */
+typedef struct t8_forest_iterate_faces_level
+{
+  t8_element_t      **elements; /* capacity allocated scheme elements */
+  int                *child_indices;    /* capacity entries */
+  size_t             *split_offsets;    /* capacity + 1 entries */
+  int                 capacity; /* 0 while the level is untouched */
+} t8_forest_iterate_faces_level_t;
+
+/* A reusable face iteration context, \see t8_forest_iterate_faces_ctx.
+ * The buffers are keyed by element class and element level; a recursion
+ * step at level l uses the level l slab and its child recursions the
+ * deeper slabs, so one context serves a whole recursion without
+ * aliasing. */
+struct t8_forest_iterate_faces_ctx
+{
+  t8_forest_t         forest;
+  t8_eclass_scheme_c *scheme[T8_ECLASS_COUNT];  /* Set on first use. */
+  t8_forest_iterate_faces_level_t *levels[T8_ECLASS_COUNT];
+  int                 num_levels;       /* maxlevel + 1 level slots. */
+};
+
+t8_forest_iterate_faces_ctx_t *
+t8_forest_iterate_faces_ctx_new (t8_forest_t forest)
+{
+  t8_forest_iterate_faces_ctx_t *ctx;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  ctx = T8_ALLOC_ZERO (t8_forest_iterate_faces_ctx_t, 1);
+  ctx->forest = forest;
+  ctx->num_levels = t8_forest_get_maxlevel (forest) + 1;
+  return ctx;
+}
+
 void
-t8_forest_iterate_faces (t8_forest_t forest, t8_locidx_t ltreeid,
-                         const t8_element_t *element, int face,
-                         t8_element_array_t *leaf_elements, void *user_data,
-                         t8_locidx_t tree_lindex_of_first_leaf,
-                         t8_forest_iterate_face_fn callback)
+t8_forest_iterate_faces_ctx_destroy (t8_forest_iterate_faces_ctx_t **pctx)
 {
+  t8_forest_iterate_faces_ctx_t *ctx;
+  t8_forest_iterate_faces_level_t *lvl;
+  int                 ieclass, ilevel;
+
+  T8_ASSERT (pctx != NULL);
+  ctx = *pctx;
+  if (ctx == NULL) {
+    return;
+  }
+  for (ieclass = 0; ieclass < T8_ECLASS_COUNT; ieclass++) {
+    if (ctx->levels[ieclass] == NULL) {
+      continue;
+    }
+    for (ilevel = 0; ilevel < ctx->num_levels; ilevel++) {
+      lvl = &ctx->levels[ieclass][ilevel];
+      if (lvl->capacity > 0) {
+        ctx->scheme[ieclass]->t8_element_destroy (lvl->capacity,
+                                                  lvl->elements);
+        T8_FREE (lvl->elements);
+        T8_FREE (lvl->child_indices);
+        T8_FREE (lvl->split_offsets);
+      }
+    }
+    T8_FREE (ctx->levels[ieclass]);
+  }
+  T8_FREE (ctx);
+  *pctx = NULL;
+}
+
+/* Return the level slab of a context for a recursion step, creating or
+ * growing it when needed. capacity must cover both the child count (for
+ * the split offsets) and the face child count (for the elements). */
+static t8_forest_iterate_faces_level_t *
+t8_forest_iterate_faces_ctx_level (t8_forest_iterate_faces_ctx_t *ctx,
+                                   t8_eclass_t eclass,
+                                   t8_eclass_scheme_c *ts, int level,
+                                   int capacity)
+{
+  t8_forest_iterate_faces_level_t *lvl;
+
+  T8_ASSERT (0 <= level && level < ctx->num_levels);
+  if (ctx->levels[eclass] == NULL) {
+    ctx->levels[eclass] =
+      T8_ALLOC_ZERO (t8_forest_iterate_faces_level_t, ctx->num_levels);
+    ctx->scheme[eclass] = ts;
+  }
+  T8_ASSERT (ctx->scheme[eclass] == ts);
+  lvl = &ctx->levels[eclass][level];
+  if (lvl->capacity < capacity) {
+    if (lvl->capacity > 0) {
+      ts->t8_element_destroy (lvl->capacity, lvl->elements);
+      T8_FREE (lvl->elements);
+      T8_FREE (lvl->child_indices);
+      T8_FREE (lvl->split_offsets);
+    }
+    lvl->elements = T8_ALLOC (t8_element_t *, capacity);
+    ts->t8_element_new (capacity, lvl->elements);
+    lvl->child_indices = T8_ALLOC (int, capacity);
+    lvl->split_offsets = T8_ALLOC (size_t, capacity + 1);
+    lvl->capacity = capacity;
+  }
+  return lvl;
+}
+
+void
+t8_forest_iterate_faces_ctx (t8_forest_t forest, t8_locidx_t ltreeid,
+                             const t8_element_t *element, int face,
+                             t8_element_array_t *leaf_elements,
+                             void *user_data,
+                             t8_locidx_t tree_lindex_of_first_leaf,
+                             t8_forest_iterate_face_fn callback,
+                             t8_forest_iterate_faces_ctx_t *ctx)
+{
+  t8_forest_iterate_faces_level_t *lvl;
   t8_eclass_scheme_c *ts;
   t8_eclass_t         eclass;
   t8_element_t       *leaf, **face_children;
@@ -100,6 +218,7 @@ t8_forest_iterate_faces (t8_forest_t forest, t8_locidx_t ltreeid,
   T8_ASSERT (t8_forest_is_committed (forest));
   T8_ASSERT (0 <= ltreeid
              && ltreeid < t8_forest_get_num_local_trees (forest));
+  T8_ASSERT (ctx == NULL || ctx->forest == forest);
 
   elem_count = t8_element_array_get_count (leaf_elements);
   if (elem_count == 0) {
@@ -135,15 +254,26 @@ t8_forest_iterate_faces (t8_forest_t forest, t8_locidx_t ltreeid,
     /* Enter the recursion */
     /* We compute all face children of E, compute their leaf arrays and
      * call iterate_faces */
-    /* allocate the memory to store the face children */
     num_face_children = ts->t8_element_num_face_children (element, face);
-    face_children = T8_ALLOC (t8_element_t *, num_face_children);
-    ts->t8_element_new (num_face_children, face_children);
-    /* Memory for the child indices of the face children */
-    child_indices = T8_ALLOC (int, num_face_children);
-    /* Memory for the indices that split the leaf_elements array */
-    split_offsets =
-      T8_ALLOC (size_t, ts->t8_element_num_children (element) + 1);
+    if (ctx != NULL) {
+      /* Draw the buffers for this level from the reusable context */
+      lvl = t8_forest_iterate_faces_ctx_level
+        (ctx, eclass, ts, ts->t8_element_level (element),
+         SC_MAX (num_face_children, ts->t8_element_num_children (element)));
+      face_children = lvl->elements;
+      child_indices = lvl->child_indices;
+      split_offsets = lvl->split_offsets;
+    }
+    else {
+      /* allocate the memory to store the face children */
+      face_children = T8_ALLOC (t8_element_t *, num_face_children);
+      ts->t8_element_new (num_face_children, face_children);
+      /* Memory for the child indices of the face children */
+      child_indices = T8_ALLOC (int, num_face_children);
+      /* Memory for the indices that split the leaf_elements array */
+      split_offsets =
+        T8_ALLOC (size_t, ts->t8_element_num_children (element) + 1);
+    }
     /* Compute the face children */
     ts->t8_element_children_at_face (element, face, face_children,
                                      num_face_children, child_indices);
@@ -160,18 +290,232 @@ t8_forest_iterate_faces (t8_forest_t forest, t8_locidx_t ltreeid,
                                     indexb - indexa);
         /* Compute the corresponding face number of this face child */
         child_face = ts->t8_element_face_child_face (element, face, iface);
-        /* Enter the recursion */
-        t8_forest_iterate_faces (forest, ltreeid, face_children[iface],
-                                 child_face, &face_child_leafs, user_data,
-                                 indexa + tree_lindex_of_first_leaf,
-                                 callback);
+        /* Enter the recursion. The child recursion uses the deeper level
+         * slabs of the context, so our buffers stay valid. */
+        t8_forest_iterate_faces_ctx (forest, ltreeid, face_children[iface],
+                                     child_face, &face_child_leafs,
+                                     user_data,
+                                     indexa + tree_lindex_of_first_leaf,
+                                     callback, ctx);
+      }
+    }
+    if (ctx == NULL) {
+      /* clean-up */
+      ts->t8_element_destroy (num_face_children, face_children);
+      T8_FREE (face_children);
+      T8_FREE (child_indices);
+      T8_FREE (split_offsets);
+    }
+  }
+}
+
+void
+t8_forest_iterate_faces (t8_forest_t forest, t8_locidx_t ltreeid,
+                         const t8_element_t *element, int face,
+                         t8_element_array_t *leaf_elements, void *user_data,
+                         t8_locidx_t tree_lindex_of_first_leaf,
+                         t8_forest_iterate_face_fn callback)
+{
+  t8_forest_iterate_faces_ctx (forest, ltreeid, element, face, leaf_elements,
+                               user_data, tree_lindex_of_first_leaf,
+                               callback, NULL);
+}
+
+/* The state shared by the workers of a face iteration batch. The
+ * contexts of finished tasks are parked on a stack, so each concurrent
+ * worker ends up reusing one context rather than allocating per task. */
+typedef struct t8_forest_iterate_faces_batch_shared
+{
+  t8_forest_t         forest;
+  t8_forest_iterate_face_fn callback;
+  sc_array_t          ctx_stack;        /* of t8_forest_iterate_faces_ctx_t * */
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_t     mutex;    /* Protects ctx_stack. */
+#endif
+} t8_forest_iterate_faces_batch_shared_t;
+
+/* The argument struct of one batch worker, \see t8_thread_pool_exec. */
+typedef struct t8_forest_iterate_faces_batch_worker
+{
+  t8_forest_iterate_faces_batch_shared_t *shared;
+  t8_forest_iterate_faces_task_t task;
+} t8_forest_iterate_faces_batch_worker_t;
+
+static void        *
+t8_forest_iterate_faces_batch_run (void *varg)
+{
+  t8_forest_iterate_faces_batch_worker_t *worker =
+    (t8_forest_iterate_faces_batch_worker_t *) varg;
+  t8_forest_iterate_faces_batch_shared_t *shared = worker->shared;
+  t8_forest_iterate_faces_ctx_t *ctx = NULL;
+
+  /* Take a parked context if one is available */
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_lock (&shared->mutex);
+#endif
+  if (shared->ctx_stack.elem_count > 0) {
+    ctx = *(t8_forest_iterate_faces_ctx_t **)
+      sc_array_index (&shared->ctx_stack,
+                      shared->ctx_stack.elem_count - 1);
+    sc_array_resize (&shared->ctx_stack, shared->ctx_stack.elem_count - 1);
+  }
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_unlock (&shared->mutex);
+#endif
+  if (ctx == NULL) {
+    /* First task of this worker slot, create a context. At most one
+     * context per concurrent worker is ever created. */
+    ctx = t8_forest_iterate_faces_ctx_new (shared->forest);
+  }
+
+  t8_forest_iterate_faces_ctx (shared->forest, worker->task.ltreeid,
+                               worker->task.element, worker->task.face,
+                               worker->task.leaf_elements,
+                               worker->task.user_data,
+                               worker->task.tree_lindex_of_first_leaf,
+                               shared->callback, ctx);
+
+  /* Park the context for the next task */
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_lock (&shared->mutex);
+#endif
+  *(t8_forest_iterate_faces_ctx_t **) sc_array_push (&shared->ctx_stack) =
+    ctx;
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_unlock (&shared->mutex);
+#endif
+  return NULL;
+}
+
+void
+t8_forest_iterate_faces_batch (t8_forest_t forest,
+                               const t8_forest_iterate_faces_task_t *tasks,
+                               int num_tasks,
+                               t8_forest_iterate_face_fn callback)
+{
+  t8_forest_iterate_faces_batch_shared_t shared;
+  t8_forest_iterate_faces_batch_worker_t *workers;
+  t8_forest_iterate_faces_ctx_t *ctx;
+  int                 itask;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (tasks != NULL || num_tasks == 0);
+
+  if (num_tasks == 0) {
+    return;
+  }
+
+  shared.forest = forest;
+  shared.callback = callback;
+  sc_array_init (&shared.ctx_stack,
+                 sizeof (t8_forest_iterate_faces_ctx_t *));
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_init (&shared.mutex, NULL);
+#endif
+
+  workers = T8_ALLOC (t8_forest_iterate_faces_batch_worker_t, num_tasks);
+  for (itask = 0; itask < num_tasks; itask++) {
+    workers[itask].shared = &shared;
+    workers[itask].task = tasks[itask];
+  }
+  t8_thread_pool_exec (t8_forest_iterate_faces_batch_run, workers,
+                       sizeof (t8_forest_iterate_faces_batch_worker_t),
+                       num_tasks);
+  T8_FREE (workers);
+
+  /* All workers have finished, destroy the parked contexts */
+  while (shared.ctx_stack.elem_count > 0) {
+    ctx = *(t8_forest_iterate_faces_ctx_t **)
+      sc_array_index (&shared.ctx_stack, shared.ctx_stack.elem_count - 1);
+    sc_array_resize (&shared.ctx_stack, shared.ctx_stack.elem_count - 1);
+    t8_forest_iterate_faces_ctx_destroy (&ctx);
+  }
+  sc_array_reset (&shared.ctx_stack);
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_destroy (&shared.mutex);
+#endif
+}
+
+void
+t8_forest_iterate_all_faces (t8_forest_t forest,
+                             t8_forest_iterate_all_faces_fn callback,
+                             void *user_data)
+{
+  t8_locidx_t         num_local_elements, lelement_id, ltreeid, lctreeid;
+  t8_locidx_t        *element_indices;
+  t8_element_t       *leaf, **neighbor_leafs;
+  t8_eclass_scheme_c *ts, *neigh_scheme;
+  t8_eclass_t         eclass;
+  int                 iface, num_faces, num_neighbors, ineigh;
+  int                *dual_faces;
+  int                 level, neigh_level;
+  int                 orientation, tree_face;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (callback != NULL);
+
+  num_local_elements = t8_forest_get_local_num_elements (forest);
+  for (lelement_id = 0; lelement_id < num_local_elements; lelement_id++) {
+    /* Get a pointer to the leaf, its tree, eclass scheme and level */
+    leaf = t8_forest_get_element (forest, lelement_id, &ltreeid);
+    eclass = t8_forest_get_tree_class (forest, ltreeid);
+    ts = t8_forest_get_eclass_scheme (forest, eclass);
+    level = ts->t8_element_level (leaf);
+    num_faces = ts->t8_element_num_faces (leaf);
+    for (iface = 0; iface < num_faces; iface++) {
+      /* The orientation is nontrivial only if the face lies on a coarse
+       * mesh face connection */
+      orientation = 0;
+      if (ts->t8_element_is_root_boundary (leaf, iface)) {
+        tree_face = ts->t8_element_tree_face (leaf, iface);
+        lctreeid = t8_forest_ltreeid_to_cmesh_ltreeid (forest, ltreeid);
+        /* If the tree face is a domain boundary, the orientation stays 0 */
+        (void) t8_cmesh_get_face_neighbor (t8_forest_get_cmesh (forest),
+                                           lctreeid, tree_face, NULL,
+                                           &orientation);
       }
+      /* Compute the leaf neighbors across this face */
+      t8_forest_leaf_face_neighbors (forest, ltreeid, leaf, &neighbor_leafs,
+                                     iface, &dual_faces, &num_neighbors,
+                                     &element_indices, &neigh_scheme, 1);
+      if (num_neighbors == 0) {
+        /* The face lies on the domain boundary */
+        callback (forest, ltreeid, leaf, lelement_id, iface,
+                  T8_FOREST_FACE_BOUNDARY, NULL, NULL, -1, -1, orientation,
+                  user_data);
+        continue;
+      }
+      for (ineigh = 0; ineigh < num_neighbors; ineigh++) {
+        if (element_indices[ineigh] >= num_local_elements) {
+          /* The neighbor is a ghost. Each adjoining process reports this
+           * face for its own element. */
+          callback (forest, ltreeid, leaf, lelement_id, iface,
+                    T8_FOREST_FACE_GHOST, neighbor_leafs[ineigh],
+                    neigh_scheme, element_indices[ineigh],
+                    dual_faces[ineigh], orientation, user_data);
+          continue;
+        }
+        neigh_level = neigh_scheme->t8_element_level (neighbor_leafs[ineigh]);
+        if (neigh_level < level
+            || (neigh_level == level
+                && lelement_id < element_indices[ineigh])) {
+          /* We report a face between local leaves from the side of the
+           * finer element, between equal level leaves from the side of the
+           * smaller local index. The skipped side sees this leaf as its
+           * coarser respectively larger index neighbor, so each interior
+           * face is reported exactly once. */
+          callback (forest, ltreeid, leaf, lelement_id, iface,
+                    T8_FOREST_FACE_INTERIOR, neighbor_leafs[ineigh],
+                    neigh_scheme, element_indices[ineigh],
+                    dual_faces[ineigh], orientation, user_data);
+        }
+      }
+      /* clean-up */
+      neigh_scheme->t8_element_destroy (num_neighbors, neighbor_leafs);
+      T8_FREE (neighbor_leafs);
+      T8_FREE (element_indices);
+      T8_FREE (dual_faces);
     }
-    /* clean-up */
-    ts->t8_element_destroy (num_face_children, face_children);
-    T8_FREE (face_children);
-    T8_FREE (child_indices);
-    T8_FREE (split_offsets);
   }
 }
 
@@ -187,6 +531,10 @@ t8_forest_iterate_faces (t8_forest_t forest, t8_locidx_t ltreeid,
  * for the parent element.
  * If the callback function (search_fn) returns false for an element,
  * the query function is not called for this element.
+ * If \a record is not NULL, the tree local index of each leaf that the
+ * recursion reaches is pushed onto it. Search cursors replay these
+ * leaves on unchanged trees instead of re-descending, \see
+ * t8_forest_search_cursor_search.
  */
 static void
 t8_forest_search_recursion (t8_forest_t forest, t8_locidx_t ltreeid,
@@ -196,7 +544,8 @@ t8_forest_search_recursion (t8_forest_t forest, t8_locidx_t ltreeid,
                             t8_locidx_t tree_lindex_of_first_leaf,
                             t8_forest_search_query_fn search_fn,
                             t8_forest_search_query_fn query_fn,
-                            sc_array_t *queries, sc_array_t *active_queries)
+                            sc_array_t *queries, sc_array_t *active_queries,
+                            sc_array_t *record)
 {
   t8_element_t       *leaf, **children;
   int                 num_children, ichild;
@@ -212,9 +561,11 @@ t8_forest_search_recursion (t8_forest_t forest, t8_locidx_t ltreeid,
   /* Assertions to check for necessary requirements */
   /* The forest must be committed */
   T8_ASSERT (t8_forest_is_committed (forest));
-  /* The tree must be local */
+  /* The tree must be local or a ghost tree (ghost trees are indexed
+   * after the local trees) */
   T8_ASSERT (0 <= ltreeid
-             && ltreeid < t8_forest_get_num_local_trees (forest));
+             && ltreeid < t8_forest_get_num_local_trees (forest)
+             + t8_forest_ghost_num_trees (forest));
   /* If we have queries, we also must have a query function */
   T8_ASSERT ((queries == NULL) == (query_fn == NULL));
 
@@ -248,6 +599,11 @@ t8_forest_search_recursion (t8_forest_t forest, t8_locidx_t ltreeid,
   ret = search_fn (forest, ltreeid, element, is_leaf, leaf_elements,
                    tree_lindex_of_first_leaf, NULL, 0);
 
+  if (is_leaf && record != NULL) {
+    /* Remember that the recursion reached this leaf */
+    *(t8_locidx_t *) sc_array_push (record) = tree_lindex_of_first_leaf;
+  }
+
   if (!ret) {
     /* The function returned false. We abort the recursion */
     return;
@@ -291,6 +647,11 @@ t8_forest_search_recursion (t8_forest_t forest, t8_locidx_t ltreeid,
   /* allocate the memory to store the children */
   num_children = ts->t8_element_num_children (element);
   children = T8_ALLOC (t8_element_t *, num_children);
+  /* The scheme mempools are shared, thus element allocation must be
+   * serialized when the trees are searched by multiple threads. */
+#if T8_ENABLE_OPENMP
+#pragma omp critical (t8_forest_search_element_alloc)
+#endif
   ts->t8_element_new (num_children, children);
   /* Memory for the indices that split the leaf_elements array */
   split_offsets = T8_ALLOC (size_t, num_children + 1);
@@ -312,10 +673,13 @@ t8_forest_search_recursion (t8_forest_t forest, t8_locidx_t ltreeid,
                                   ts, &child_leafs,
                                   indexa + tree_lindex_of_first_leaf,
                                   search_fn, query_fn, queries,
-                                  new_active_queries);
+                                  new_active_queries, record);
     }
   }
   /* clean-up */
+#if T8_ENABLE_OPENMP
+#pragma omp critical (t8_forest_search_element_alloc)
+#endif
   ts->t8_element_destroy (num_children, children);
   T8_FREE (children);
   T8_FREE (split_offsets);
@@ -324,23 +688,38 @@ t8_forest_search_recursion (t8_forest_t forest, t8_locidx_t ltreeid,
   }
 }
 
-/* Perform a top-down search in one tree of the forest */
+/* Perform a top-down search in one tree of the forest.
+ * \a ltreeid may also address a ghost tree, in which case it is the
+ * number of local trees plus the ghost tree id and the recursion runs
+ * over the elements of the ghost layer. */
 static void
 t8_forest_search_tree (t8_forest_t forest, t8_locidx_t ltreeid,
                        t8_forest_search_query_fn search_fn,
                        t8_forest_search_query_fn query_fn,
-                       sc_array_t *queries)
+                       sc_array_t *queries, sc_array_t *record)
 {
   t8_eclass_t         eclass;
   t8_eclass_scheme_c *ts;
   t8_element_t       *nca, *first_el, *last_el;
   t8_element_array_t *leaf_elements;
   sc_array_t         *active_queries = NULL;
+  t8_locidx_t         num_local_trees;
 
   /* Get the element class, scheme and leaf elements of this tree */
-  eclass = t8_forest_get_eclass (forest, ltreeid);
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  if (ltreeid < num_local_trees) {
+    eclass = t8_forest_get_eclass (forest, ltreeid);
+    leaf_elements = t8_forest_tree_get_leafs (forest, ltreeid);
+  }
+  else {
+    /* This is a ghost tree; its elements are stored in the ghost layer */
+    const t8_locidx_t   lghost_tree = ltreeid - num_local_trees;
+
+    T8_ASSERT (lghost_tree < t8_forest_ghost_num_trees (forest));
+    eclass = t8_forest_ghost_get_tree_class (forest, lghost_tree);
+    leaf_elements = t8_forest_ghost_get_tree_elements (forest, lghost_tree);
+  }
   ts = t8_forest_get_eclass_scheme (forest, eclass);
-  leaf_elements = t8_forest_tree_get_leafs (forest, ltreeid);
 
   /* assert for empty tree */
   T8_ASSERT (t8_element_array_get_count (leaf_elements) >= 0);
@@ -351,6 +730,9 @@ t8_forest_search_tree (t8_forest_t forest, t8_locidx_t ltreeid,
                                    t8_element_array_get_count (leaf_elements)
                                    - 1);
   /* Compute their nearest common ancestor */
+#if T8_ENABLE_OPENMP
+#pragma omp critical (t8_forest_search_element_alloc)
+#endif
   ts->t8_element_new (1, &nca);
   ts->t8_element_nca (first_el, last_el, nca);
 
@@ -369,7 +751,7 @@ t8_forest_search_tree (t8_forest_t forest, t8_locidx_t ltreeid,
   /* Start the top-down search */
   t8_forest_search_recursion (forest, ltreeid, eclass, nca, ts, leaf_elements,
                               0, search_fn, query_fn, queries,
-                              active_queries);
+                              active_queries, record);
 
   /* Clean up the array of active queries */
   if (queries != NULL) {
@@ -377,33 +759,309 @@ t8_forest_search_tree (t8_forest_t forest, t8_locidx_t ltreeid,
   }
 }
 
+void
+t8_forest_search_ext (t8_forest_t forest, t8_forest_search_query_fn search_fn,
+                      t8_forest_search_query_fn query_fn,
+                      sc_array_t *queries, int search_ghosts)
+{
+  t8_locidx_t         num_local_trees, num_trees, itree;
+
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  num_trees = num_local_trees;
+  if (search_ghosts) {
+    /* Also descend the ghost trees; they are indexed after the local
+     * trees so that the callbacks can recognize them by their tree id */
+    num_trees += t8_forest_ghost_num_trees (forest);
+  }
+  for (itree = 0; itree < num_trees; itree++) {
+    t8_forest_search_tree (forest, itree, search_fn, query_fn, queries, NULL);
+  }
+}
+
 void
 t8_forest_search (t8_forest_t forest, t8_forest_search_query_fn search_fn,
                   t8_forest_search_query_fn query_fn, sc_array_t *queries)
 {
-  t8_locidx_t         num_local_trees, itree;
+  t8_forest_search_ext (forest, search_fn, query_fn, queries, 0);
+}
+
+void
+t8_forest_search_parallel_ext (t8_forest_t forest,
+                               t8_forest_search_query_fn search_fn,
+                               t8_forest_search_query_fn query_fn,
+                               sc_array_t *queries, int search_ghosts)
+{
+  t8_locidx_t         num_trees, itree;
+
+  num_trees = t8_forest_get_num_local_trees (forest);
+  if (search_ghosts) {
+    /* Also descend the ghost trees; they are indexed after the local
+     * trees so that the callbacks can recognize them by their tree id */
+    num_trees += t8_forest_ghost_num_trees (forest);
+  }
+  /* The trees carry independent leaf arrays and each one maintains its own
+   * array of active queries during the recursion, so they can be searched
+   * concurrently. Dynamic scheduling balances trees of different sizes.
+   * The thread count is clamped to the process-wide limit of
+   * t8_thread_pool_set_num_threads. */
+#if T8_ENABLE_OPENMP
+#pragma omp parallel for schedule (dynamic) \
+  num_threads (t8_thread_pool_clamp_num_threads (omp_get_max_threads ()))
+#endif
+  for (itree = 0; itree < num_trees; itree++) {
+    t8_forest_search_tree (forest, itree, search_fn, query_fn, queries, NULL);
+  }
+}
+
+void
+t8_forest_search_parallel (t8_forest_t forest,
+                           t8_forest_search_query_fn search_fn,
+                           t8_forest_search_query_fn query_fn,
+                           sc_array_t *queries)
+{
+  t8_forest_search_parallel_ext (forest, search_fn, query_fn, queries, 0);
+}
+
+/* A search cursor stores the result of the last cursor search: the leaf
+ * checksum of every local tree and the tree local indices of the leaves
+ * that the search recursion reached, grouped by tree. A later search
+ * replays the recorded leaves of every tree whose checksum is unchanged
+ * and re-descends only the changed trees, \see
+ * t8_forest_search_cursor_search. */
+typedef struct t8_forest_search_cursor
+{
+  int                 valid;    /**< True if the cursor stores a previous run. */
+  t8_locidx_t         num_local_trees;  /**< The local trees of that run. */
+  uint64_t           *tree_checksums;   /**< Per tree leaf checksum of that run. */
+  sc_array_t         *matches;  /**< The reached leaves as tree local indices,
+                                     in ascending tree order. */
+  size_t             *tree_offset;      /**< Offsets of the trees in \a matches,
+                                             num_local_trees + 1 entries. */
+} t8_forest_search_cursor_struct_t;
+
+t8_forest_search_cursor_t
+t8_forest_search_cursor_new (void)
+{
+  t8_forest_search_cursor_t cursor;
+
+  cursor = T8_ALLOC_ZERO (t8_forest_search_cursor_struct_t, 1);
+  cursor->matches = sc_array_new (sizeof (t8_locidx_t));
+  return cursor;
+}
+
+void
+t8_forest_search_cursor_invalidate (t8_forest_search_cursor_t cursor)
+{
+  T8_ASSERT (cursor != NULL);
+  cursor->valid = 0;
+}
+
+void
+t8_forest_search_cursor_search (t8_forest_t forest,
+                                t8_forest_search_cursor_t cursor,
+                                t8_forest_search_query_fn search_fn)
+{
+  t8_locidx_t         num_local_trees, itree, lindex;
+  t8_eclass_scheme_c *ts;
+  t8_element_array_t *leaf_elements;
+  t8_element_t       *leaf;
+  uint64_t            checksum, *new_checksums;
+  sc_array_t         *new_matches;
+  size_t             *new_offset;
+  size_t              imatch;
+  int                 revalidate;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (cursor != NULL);
+  T8_ASSERT (search_fn != NULL);
 
   num_local_trees = t8_forest_get_num_local_trees (forest);
+  /* If the cursor is invalid or the local trees changed, for example
+   * after a repartition, every tree is treated as changed */
+  revalidate = cursor->valid && cursor->num_local_trees == num_local_trees;
+
+  new_checksums = T8_ALLOC (uint64_t, num_local_trees);
+  new_offset = T8_ALLOC (size_t, num_local_trees + 1);
+  new_matches = sc_array_new (sizeof (t8_locidx_t));
   for (itree = 0; itree < num_local_trees; itree++) {
-    t8_forest_search_tree (forest, itree, search_fn, query_fn, queries);
+    new_offset[itree] = new_matches->elem_count;
+    ts =
+      t8_forest_get_eclass_scheme (forest,
+                                   t8_forest_get_tree_class (forest, itree));
+    checksum = t8_forest_tree_leaf_checksum (forest, itree, ts);
+    new_checksums[itree] = checksum;
+    leaf_elements = t8_forest_tree_get_leafs (forest, itree);
+    if (t8_element_array_get_count (leaf_elements) == 0) {
+      /* An empty tree of an incomplete forest; nothing to search */
+      continue;
+    }
+    if (revalidate && checksum == cursor->tree_checksums[itree]) {
+      /* The leaf sequence of this tree is unchanged since the recorded
+       * run; replay the recorded leaves instead of re-descending */
+      for (imatch = cursor->tree_offset[itree];
+           imatch < cursor->tree_offset[itree + 1]; imatch++) {
+        lindex = *(t8_locidx_t *) sc_array_index (cursor->matches, imatch);
+        leaf = t8_element_array_index_locidx (leaf_elements, lindex);
+        (void) search_fn (forest, itree, leaf, 1, leaf_elements, lindex,
+                          NULL, 0);
+        *(t8_locidx_t *) sc_array_push (new_matches) = lindex;
+      }
+    }
+    else {
+      /* The tree changed (or there is no recorded run); perform the
+       * full top-down search and record the reached leaves */
+      t8_forest_search_tree (forest, itree, search_fn, NULL, NULL,
+                             new_matches);
+    }
   }
+  new_offset[num_local_trees] = new_matches->elem_count;
+
+  /* Replace the recorded run by the current one */
+  T8_FREE (cursor->tree_checksums);
+  T8_FREE (cursor->tree_offset);
+  sc_array_destroy (cursor->matches);
+  cursor->tree_checksums = new_checksums;
+  cursor->tree_offset = new_offset;
+  cursor->matches = new_matches;
+  cursor->num_local_trees = num_local_trees;
+  cursor->valid = 1;
 }
 
 void
-t8_forest_iterate_replace (t8_forest_t forest_new,
-                           t8_forest_t forest_old,
-                           t8_forest_replace_t replace_fn)
+t8_forest_search_cursor_destroy (t8_forest_search_cursor_t *pcursor)
 {
-  t8_global_productionf ("Into t8_forest_iterate_replace\n");
-  T8_ASSERT (t8_forest_is_committed (forest_old));
-  T8_ASSERT (t8_forest_is_committed (forest_new));
+  t8_forest_search_cursor_t cursor;
 
-  const t8_locidx_t   num_local_trees =
-    t8_forest_get_num_local_trees (forest_new);
-  T8_ASSERT (num_local_trees == t8_forest_get_num_local_trees (forest_old));
+  T8_ASSERT (pcursor != NULL && *pcursor != NULL);
+  cursor = *pcursor;
+  T8_FREE (cursor->tree_checksums);
+  T8_FREE (cursor->tree_offset);
+  sc_array_destroy (cursor->matches);
+  T8_FREE (cursor);
+  *pcursor = NULL;
+}
 
-  for (t8_locidx_t itree = 0; itree < num_local_trees; itree++) {
-    /* Loop over the trees */
+/* Enumerate the complete leaf families of one local tree and call
+ * \a callback once per family. This is the per-tree work horse of
+ * \ref t8_forest_iterate_families.
+ * Since the leaf elements are stored in SFC order, the members of a
+ * complete family are consecutive in the leaf array and the first
+ * member has child id 0. We therefore filter candidate positions by
+ * child id and by the levels of the following elements - cheap key
+ * arithmetic - and only then verify the window with
+ * t8_element_is_family. */
+static void
+t8_forest_iterate_families_tree (t8_forest_t forest, t8_locidx_t itree,
+                                 t8_forest_iterate_families_fn callback)
+{
+  t8_eclass_t         eclass;
+  t8_eclass_scheme_c *ts;
+  t8_element_array_t *leaf_elements;
+  t8_element_t      **fam;
+  t8_element_t       *leaf;
+  t8_locidx_t         num_leafs, ileaf;
+  int                 buf_size, num_siblings, level, imember, is_fam;
+
+  eclass = t8_forest_get_tree_class (forest, itree);
+  ts = t8_forest_get_eclass_scheme (forest, eclass);
+  leaf_elements = t8_forest_tree_get_leafs (forest, itree);
+  num_leafs = (t8_locidx_t) t8_element_array_get_count (leaf_elements);
+  if (num_leafs < 2) {
+    /* A family has at least two members */
+    return;
+  }
+  buf_size = ts->t8_element_num_children (t8_element_array_index_locidx
+                                          (leaf_elements, 0));
+  fam = T8_ALLOC (t8_element_t *, buf_size);
+  ileaf = 0;
+  while (ileaf < num_leafs) {
+    leaf = t8_element_array_index_locidx (leaf_elements, ileaf);
+    level = ts->t8_element_level (leaf);
+    if (level == 0 || ts->t8_element_child_id (leaf) != 0) {
+      /* A family starts with a child id 0 element of positive level */
+      ileaf++;
+      continue;
+    }
+    num_siblings = ts->t8_element_num_siblings (leaf);
+    if (ileaf + (t8_locidx_t) num_siblings > num_leafs) {
+      /* Not enough elements left in this tree for this family. A later
+       * position may still start a smaller family (transition schemes
+       * have families of different sizes), so keep scanning. */
+      ileaf++;
+      continue;
+    }
+    if (num_siblings > buf_size) {
+      fam = T8_REALLOC (fam, t8_element_t *, num_siblings);
+      buf_size = num_siblings;
+    }
+    /* Gather the window and reject it as soon as a level differs */
+    fam[0] = leaf;
+    is_fam = 1;
+    for (imember = 1; imember < num_siblings; imember++) {
+      fam[imember] =
+        t8_element_array_index_locidx (leaf_elements, ileaf + imember);
+      if (ts->t8_element_level (fam[imember]) != level) {
+        is_fam = 0;
+        break;
+      }
+    }
+    if (is_fam && ts->t8_element_is_family (fam)) {
+      callback (forest, itree, ts, ileaf, fam, num_siblings);
+      /* Family members cannot start another family, skip the window */
+      ileaf += (t8_locidx_t) num_siblings;
+    }
+    else {
+      ileaf++;
+    }
+  }
+  T8_FREE (fam);
+}
+
+void
+t8_forest_iterate_families (t8_forest_t forest,
+                            t8_forest_iterate_families_fn callback,
+                            int parallel)
+{
+  t8_locidx_t         num_trees, itree;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (callback != NULL);
+  num_trees = t8_forest_get_num_local_trees (forest);
+  if (parallel) {
+    /* The trees carry independent leaf arrays, so they can be
+     * enumerated concurrently. Dynamic scheduling balances trees of
+     * different sizes. The thread count is clamped to the process-wide
+     * limit of t8_thread_pool_set_num_threads. */
+#if T8_ENABLE_OPENMP
+#pragma omp parallel for schedule (dynamic) \
+  num_threads (t8_thread_pool_clamp_num_threads (omp_get_max_threads ()))
+#endif
+    for (itree = 0; itree < num_trees; itree++) {
+      t8_forest_iterate_families_tree (forest, itree, callback);
+    }
+  }
+  else {
+    for (itree = 0; itree < num_trees; itree++) {
+      t8_forest_iterate_families_tree (forest, itree, callback);
+    }
+  }
+}
+
+/* Walk the elements of one local tree of the old and the new forest and
+ * call \a replace_fn for each refined element, coarsened family, unchanged
+ * element and removed element. This is the per-tree work horse of
+ * \ref t8_forest_iterate_replace and
+ * \ref t8_forest_iterate_replace_parallel.
+ * If \a batch_unchanged is true, a run of consecutive unchanged elements is
+ * reported in a single callback invocation with matching element counts
+ * instead of one invocation per element. */
+static void
+t8_forest_iterate_replace_tree (t8_forest_t forest_new,
+                                t8_forest_t forest_old, t8_locidx_t itree,
+                                t8_forest_replace_t replace_fn,
+                                int batch_unchanged)
+{
+  {
     /* Get the number of elements of this tree in old and new forest */
     const t8_locidx_t   elems_per_tree_new =
       t8_forest_get_tree_num_elements (forest_new, itree);
@@ -583,11 +1241,33 @@ t8_forest_iterate_replace (t8_forest_t forest_new,
           /* elem_new = elem_old */
           T8_ASSERT (!ts->t8_element_compare (elem_new, elem_old));
           const int           refine = 0;
-          replace_fn (forest_old, forest_new, itree, ts, refine, 1, ielem_old,
-                      1, ielem_new);
+          t8_locidx_t         num_unchanged = 1;
+          if (batch_unchanged) {
+            /* Extend the match over the whole run of consecutive unchanged
+             * elements. As long as the levels of an element pair agree the
+             * elements are identical and both forests advance in lockstep,
+             * so comparing the levels suffices to find the end of the run. */
+            while (ielem_new + num_unchanged < elems_per_tree_new
+                   && ielem_old + num_unchanged < elems_per_tree_old) {
+              const t8_element_t *run_new =
+                t8_forest_get_element_in_tree (forest_new, itree,
+                                               ielem_new + num_unchanged);
+              const t8_element_t *run_old =
+                t8_forest_get_element_in_tree (forest_old, itree,
+                                               ielem_old + num_unchanged);
+              if (ts->t8_element_level (run_new) !=
+                  ts->t8_element_level (run_old)) {
+                break;
+              }
+              T8_ASSERT (!ts->t8_element_compare (run_new, run_old));
+              num_unchanged++;
+            }
+          }
+          replace_fn (forest_old, forest_new, itree, ts, refine,
+                      num_unchanged, ielem_old, num_unchanged, ielem_new);
           /* Advance to the next element */
-          ielem_new++;
-          ielem_old++;
+          ielem_new += num_unchanged;
+          ielem_old += num_unchanged;
         }
       }
     }                           /* element loop */
@@ -603,8 +1283,341 @@ t8_forest_iterate_replace (t8_forest_t forest_new,
     else {
       T8_ASSERT (ielem_old == elems_per_tree_old);
     }
+  }
+}
+
+void
+t8_forest_iterate_replace (t8_forest_t forest_new,
+                           t8_forest_t forest_old,
+                           t8_forest_replace_t replace_fn)
+{
+  t8_global_productionf ("Into t8_forest_iterate_replace\n");
+  T8_ASSERT (t8_forest_is_committed (forest_old));
+  T8_ASSERT (t8_forest_is_committed (forest_new));
+
+  const t8_locidx_t   num_local_trees =
+    t8_forest_get_num_local_trees (forest_new);
+  T8_ASSERT (num_local_trees == t8_forest_get_num_local_trees (forest_old));
+
+  for (t8_locidx_t itree = 0; itree < num_local_trees; itree++) {
+    /* Loop over the trees */
+    t8_forest_iterate_replace_tree (forest_new, forest_old, itree,
+                                    replace_fn, 0);
   }                             /* tree loop */
   t8_global_productionf ("Done t8_forest_iterate_replace\n");
 }
 
+void
+t8_forest_iterate_replace_parallel (t8_forest_t forest_new,
+                                    t8_forest_t forest_old,
+                                    t8_forest_replace_t replace_fn)
+{
+  t8_locidx_t         num_local_trees, itree;
+
+  t8_global_productionf ("Into t8_forest_iterate_replace_parallel\n");
+  T8_ASSERT (t8_forest_is_committed (forest_old));
+  T8_ASSERT (t8_forest_is_committed (forest_new));
+
+  num_local_trees = t8_forest_get_num_local_trees (forest_new);
+  T8_ASSERT (num_local_trees == t8_forest_get_num_local_trees (forest_old));
+
+#if T8_ENABLE_OPENMP
+  if (!forest_new->incomplete_trees) {
+    /* The matching inside a tree only reads both forests and in the
+     * complete case derives the refine pattern from level arithmetic, so
+     * the trees can be walked concurrently. Trees with removed elements
+     * are excluded, since their matching constructs parent elements from
+     * the shared scheme mempools, which are not thread-safe. Dynamic
+     * scheduling balances trees of different sizes. The thread count is
+     * clamped to the process-wide limit of
+     * t8_thread_pool_set_num_threads. */
+#pragma omp parallel for schedule (dynamic) \
+  num_threads (t8_thread_pool_clamp_num_threads (omp_get_max_threads ()))
+    for (itree = 0; itree < num_local_trees; itree++) {
+      t8_forest_iterate_replace_tree (forest_new, forest_old, itree,
+                                      replace_fn, 1);
+    }
+  }
+  else
+#endif
+  {
+    for (itree = 0; itree < num_local_trees; itree++) {
+      t8_forest_iterate_replace_tree (forest_new, forest_old, itree,
+                                      replace_fn, 1);
+    }
+  }
+  t8_global_productionf ("Done t8_forest_iterate_replace_parallel\n");
+}
+
+void
+t8_forest_leaf_iterator_init (t8_forest_leaf_iterator_t *iterator,
+                              t8_forest_t forest,
+                              t8_locidx_t first_local_element,
+                              t8_locidx_t end_local_element)
+{
+  t8_locidx_t         num_local_trees, tree_offset, num_tree_elements;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= first_local_element
+             && first_local_element <= end_local_element
+             && end_local_element
+             <= t8_forest_get_local_num_elements (forest));
+
+  iterator->forest = forest;
+  iterator->ielement = first_local_element;
+  iterator->end_element = end_local_element;
+  iterator->itree = 0;
+  iterator->element_in_tree = 0;
+  iterator->leaf_elements = NULL;
+  if (first_local_element >= end_local_element) {
+    /* The range is empty, the iterator starts out done */
+    return;
+  }
+  /* Find the tree that the first leaf belongs to by accumulating the
+   * element counts of the local trees.  We do not use
+   * t8_forest_get_tree_element_offset here, since that builds a lazy
+   * cache on first use and the iterator must not write to the forest. */
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  tree_offset = 0;
+  for (iterator->itree = 0; iterator->itree < num_local_trees;
+       iterator->itree++) {
+    num_tree_elements =
+      t8_forest_get_tree_num_elements (forest, iterator->itree);
+    if (first_local_element < tree_offset + num_tree_elements) {
+      break;
+    }
+    tree_offset += num_tree_elements;
+  }
+  T8_ASSERT (iterator->itree < num_local_trees);
+  iterator->element_in_tree = first_local_element - tree_offset;
+  iterator->leaf_elements =
+    t8_forest_tree_get_leafs (forest, iterator->itree);
+}
+
+int
+t8_forest_leaf_iterator_is_done (const t8_forest_leaf_iterator_t *iterator)
+{
+  T8_ASSERT (iterator != NULL);
+  return iterator->ielement >= iterator->end_element;
+}
+
+void
+t8_forest_leaf_iterator_next (t8_forest_leaf_iterator_t *iterator)
+{
+  T8_ASSERT (!t8_forest_leaf_iterator_is_done (iterator));
+
+  iterator->ielement++;
+  iterator->element_in_tree++;
+  if (t8_forest_leaf_iterator_is_done (iterator)) {
+    return;
+  }
+  if ((size_t) iterator->element_in_tree
+      >= t8_element_array_get_count (iterator->leaf_elements)) {
+    /* The current tree is exhausted, advance to the next nonempty tree */
+    do {
+      iterator->itree++;
+      T8_ASSERT (iterator->itree
+                 < t8_forest_get_num_local_trees (iterator->forest));
+      iterator->leaf_elements =
+        t8_forest_tree_get_leafs (iterator->forest, iterator->itree);
+    } while (t8_element_array_get_count (iterator->leaf_elements) == 0);
+    iterator->element_in_tree = 0;
+  }
+}
+
+const t8_element_t *
+t8_forest_leaf_iterator_element (const t8_forest_leaf_iterator_t *iterator)
+{
+  T8_ASSERT (!t8_forest_leaf_iterator_is_done (iterator));
+  T8_ASSERT ((size_t) iterator->element_in_tree
+             < t8_element_array_get_count (iterator->leaf_elements));
+  return t8_element_array_index_locidx (iterator->leaf_elements,
+                                        iterator->element_in_tree);
+}
+
+/* A subset of the local leaf elements of a committed forest. It stores the
+ * forest local indices of its elements sorted ascending, so a sweep visits
+ * them in memory order. */
+typedef struct t8_forest_subset
+{
+  t8_locidx_t         num_elements;     /* The number of leaf indices. */
+  t8_locidx_t        *indices;  /* The ascending forest local leaf indices,
+                                   NULL if the subset is empty. */
+} t8_forest_subset_struct_t;
+
+/* qsort callback to sort t8_locidx_t in ascending order */
+static int
+t8_forest_subset_compare_locidx (const void *pa, const void *pb)
+{
+  const t8_locidx_t   a = *(const t8_locidx_t *) pa;
+  const t8_locidx_t   b = *(const t8_locidx_t *) pb;
+
+  return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+/* Allocate a subset taking ownership of an index array */
+static t8_forest_subset_t
+t8_forest_subset_new (t8_locidx_t num_elements, t8_locidx_t *indices)
+{
+  t8_forest_subset_t  subset;
+
+  T8_ASSERT (num_elements == 0 || indices != NULL);
+  subset = T8_ALLOC (t8_forest_subset_struct_t, 1);
+  subset->num_elements = num_elements;
+  subset->indices = indices;
+  return subset;
+}
+
+t8_forest_subset_t
+t8_forest_subset_new_from_indices (t8_forest_t forest,
+                                   const t8_locidx_t *indices,
+                                   t8_locidx_t num_indices)
+{
+  t8_locidx_t        *copy;
+  t8_locidx_t         ielement, num_unique;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (num_indices == 0 || indices != NULL);
+
+  if (num_indices == 0) {
+    return t8_forest_subset_new (0, NULL);
+  }
+  copy = T8_ALLOC (t8_locidx_t, num_indices);
+  memcpy (copy, indices, num_indices * sizeof (t8_locidx_t));
+  /* Sort the indices and remove repetitions */
+  qsort (copy, num_indices, sizeof (t8_locidx_t),
+         t8_forest_subset_compare_locidx);
+  num_unique = 0;
+  for (ielement = 0; ielement < num_indices; ielement++) {
+    T8_ASSERT (0 <= copy[ielement]
+               && copy[ielement]
+               < t8_forest_get_local_num_elements (forest));
+    if (ielement == 0 || copy[ielement] != copy[ielement - 1]) {
+      copy[num_unique++] = copy[ielement];
+    }
+  }
+  return t8_forest_subset_new (num_unique, copy);
+}
+
+t8_forest_subset_t
+t8_forest_subset_new_from_mask (t8_forest_t forest, const int8_t *mask)
+{
+  t8_locidx_t        *indices;
+  t8_locidx_t         num_local_elements, ielement, num_masked;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (mask != NULL);
+
+  num_local_elements = t8_forest_get_local_num_elements (forest);
+  num_masked = 0;
+  for (ielement = 0; ielement < num_local_elements; ielement++) {
+    num_masked += mask[ielement] != 0;
+  }
+  if (num_masked == 0) {
+    return t8_forest_subset_new (0, NULL);
+  }
+  indices = T8_ALLOC (t8_locidx_t, num_masked);
+  num_masked = 0;
+  for (ielement = 0; ielement < num_local_elements; ielement++) {
+    if (mask[ielement]) {
+      indices[num_masked++] = ielement;
+    }
+  }
+  return t8_forest_subset_new (num_masked, indices);
+}
+
+t8_forest_subset_t
+t8_forest_subset_new_boundary (t8_forest_t forest)
+{
+  t8_locidx_t        *indices;
+  t8_locidx_t         num_indices;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  /* The ghost layer creation recorded the local indices of the remote
+   * elements, we only collect them. */
+  indices = t8_forest_ghost_remote_leaf_indices (forest, &num_indices);
+  return t8_forest_subset_new (num_indices, indices);
+}
+
+t8_locidx_t
+t8_forest_subset_num_elements (const t8_forest_subset_t subset)
+{
+  T8_ASSERT (subset != NULL);
+  return subset->num_elements;
+}
+
+t8_locidx_t
+t8_forest_subset_index (const t8_forest_subset_t subset, t8_locidx_t index)
+{
+  T8_ASSERT (subset != NULL);
+  T8_ASSERT (0 <= index && index < subset->num_elements);
+  return subset->indices[index];
+}
+
+void
+t8_forest_subset_iterate (t8_forest_t forest, t8_forest_subset_t subset,
+                          t8_forest_subset_fn callback, void *user_data)
+{
+  t8_element_array_t *leaf_elements;
+  const t8_element_t *element;
+  t8_locidx_t         isub, leaf_index, itree;
+  t8_locidx_t         tree_offset, num_tree_elements;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (subset != NULL);
+  T8_ASSERT (callback != NULL);
+
+  if (subset->num_elements == 0) {
+    return;
+  }
+  /* Walk the sorted indices with a tree cursor, so no index-to-tree lookup
+   * is performed per element. */
+  itree = 0;
+  tree_offset = 0;
+  num_tree_elements = t8_forest_get_tree_num_elements (forest, 0);
+  leaf_elements = t8_forest_tree_get_leafs (forest, 0);
+  for (isub = 0; isub < subset->num_elements; isub++) {
+    leaf_index = subset->indices[isub];
+    while (leaf_index >= tree_offset + num_tree_elements) {
+      /* Advance the cursor to the tree of this leaf */
+      tree_offset += num_tree_elements;
+      itree++;
+      T8_ASSERT (itree < t8_forest_get_num_local_trees (forest));
+      num_tree_elements = t8_forest_get_tree_num_elements (forest, itree);
+      leaf_elements = t8_forest_tree_get_leafs (forest, itree);
+    }
+    element =
+      t8_element_array_index_locidx (leaf_elements,
+                                     leaf_index - tree_offset);
+#ifdef __GNUC__
+    if (isub + 1 < subset->num_elements
+        && subset->indices[isub + 1] < tree_offset + num_tree_elements) {
+      /* Prefetch the storage of the next subset element of this tree while
+       * the callback runs on the current one. Subsets are typically sparse,
+       * so the next element is usually not on the current cache line. */
+      __builtin_prefetch (t8_element_array_index_locidx
+                          (leaf_elements,
+                           subset->indices[isub + 1] - tree_offset));
+    }
+#endif
+    callback (forest, itree, element, leaf_index, user_data);
+  }
+}
+
+void
+t8_forest_subset_destroy (t8_forest_subset_t *psubset)
+{
+  t8_forest_subset_t  subset;
+
+  T8_ASSERT (psubset != NULL);
+  subset = *psubset;
+  T8_ASSERT (subset != NULL);
+  if (subset->indices != NULL) {
+    T8_FREE (subset->indices);
+  }
+  T8_FREE (subset);
+  *psubset = NULL;
+}
+
 T8_EXTERN_C_END ();
@@ -40,6 +40,61 @@ typedef int         (*t8_forest_iterate_face_fn) (t8_forest_t forest,
                                                   t8_locidx_t
                                                   tree_leaf_index);
 
+/** The type of a face reported by \ref t8_forest_iterate_all_faces. */
+typedef enum
+{
+  T8_FOREST_FACE_INTERIOR = 0, /**< The neighbor is a local leaf element. */
+  T8_FOREST_FACE_GHOST,        /**< The neighbor is a ghost element. */
+  T8_FOREST_FACE_BOUNDARY      /**< The face lies on the domain boundary. */
+} t8_forest_face_type_t;
+
+/** Callback function prototype for \ref t8_forest_iterate_all_faces.
+ * It is called once per unique leaf face, \see t8_forest_iterate_all_faces
+ * for the uniqueness rule.
+ * \param [in] forest        The forest that is iterated.
+ * \param [in] ltreeid       The local tree of \a element.
+ * \param [in] element       The local leaf element from whose side the face
+ *                           is reported.
+ * \param [in] lelement_id   The forest local index of \a element.
+ * \param [in] face          The face number of \a element.
+ * \param [in] face_type     Whether the face is interior, a ghost face or a
+ *                           domain boundary face.
+ * \param [in] neighbor      The leaf element on the other side of the face,
+ *                           or NULL for a boundary face. If \a face_type is
+ *                           \ref T8_FOREST_FACE_GHOST this element is a
+ *                           ghost.
+ * \param [in] neigh_scheme  The eclass scheme of \a neighbor, or NULL for a
+ *                           boundary face.
+ * \param [in] neighbor_index The index of \a neighbor, numbered as in
+ *                           \ref t8_forest_leaf_face_neighbors: local leaves
+ *                           in [0, num_local_el), ghosts from num_local_el
+ *                           on. -1 for a boundary face.
+ * \param [in] dual_face     The face number of \a neighbor at this face, or
+ *                           -1 for a boundary face.
+ * \param [in] orientation   The orientation of the coarse mesh face
+ *                           connection the face lies on, or 0 if the face is
+ *                           in the interior of its tree.
+ * \param [in] user_data     The pointer passed to
+ *                           \ref t8_forest_iterate_all_faces.
+ */
+typedef void        (*t8_forest_iterate_all_faces_fn) (t8_forest_t forest,
+                                                       t8_locidx_t ltreeid,
+                                                       const t8_element_t
+                                                       *element,
+                                                       t8_locidx_t
+                                                       lelement_id, int face,
+                                                       t8_forest_face_type_t
+                                                       face_type,
+                                                       const t8_element_t
+                                                       *neighbor,
+                                                       t8_eclass_scheme_c
+                                                       *neigh_scheme,
+                                                       t8_locidx_t
+                                                       neighbor_index,
+                                                       int dual_face,
+                                                       int orientation,
+                                                       void *user_data);
+
 /*
  * forest          the forest
  * ltreeid         the local tree id of the current tree
@@ -66,6 +121,28 @@ typedef int         (*t8_forest_search_query_fn) (t8_forest_t forest,
                                                   void *query,
                                                   size_t query_index);
 
+/** Callback function prototype for \ref t8_forest_iterate_families.
+ * It is called once per complete family of local leaf elements.
+ * To pass user data to the callback use \ref t8_forest_set_user_data.
+ * \param [in] forest       The forest that is iterated.
+ * \param [in] ltreeid      The local tree containing the family.
+ * \param [in] ts           The eclass scheme of the tree.
+ * \param [in] first_leaf   The tree local index of \a family[0] among the
+ *                          leaf elements of the tree. The remaining members
+ *                          follow at consecutive indices.
+ * \param [in] family       The members of the family in SFC order. The
+ *                          elements belong to the forest and must not be
+ *                          modified. The array is only valid during the
+ *                          callback.
+ * \param [in] family_size  The number of elements in \a family.
+ */
+typedef void        (*t8_forest_iterate_families_fn) (t8_forest_t forest,
+                                                      t8_locidx_t ltreeid,
+                                                      t8_eclass_scheme_c *ts,
+                                                      t8_locidx_t first_leaf,
+                                                      t8_element_t **family,
+                                                      int family_size);
+
 T8_EXTERN_C_BEGIN ();
 
 /* TODO: Document */
@@ -92,6 +169,116 @@ void                t8_forest_iterate_faces (t8_forest_t forest,
                                              t8_forest_iterate_face_fn
                                              callback);
 
+/** Opaque reusable context for \ref t8_forest_iterate_faces_ctx.
+ * \ref t8_forest_iterate_faces allocates fresh child elements and index
+ * buffers at every level of its recursion. A context carries these
+ * buffers preallocated per recursion level (the depth is bounded by the
+ * forest maxlevel), so driving many face recursions through the same
+ * context removes the allocation churn entirely.
+ */
+typedef struct t8_forest_iterate_faces_ctx t8_forest_iterate_faces_ctx_t;
+
+/** Allocate a reusable face iteration context for a forest.
+ * The per level buffers are created lazily on first use, so an untouched
+ * context is cheap.
+ * \param [in] forest   A committed forest.
+ * \return              A context for \ref t8_forest_iterate_faces_ctx, to
+ *                      be released with
+ *                      \ref t8_forest_iterate_faces_ctx_destroy.
+ * \note A context must not be used from two threads at the same time;
+ * \ref t8_forest_iterate_faces_batch manages one context per concurrent
+ * worker internally.
+ */
+t8_forest_iterate_faces_ctx_t *t8_forest_iterate_faces_ctx_new (t8_forest_t
+                                                                forest);
+
+/** Free a face iteration context and set the pointer to NULL.
+ * \param [in,out] pctx   Pointer to a context; may point to NULL.
+ */
+void                t8_forest_iterate_faces_ctx_destroy
+  (t8_forest_iterate_faces_ctx_t **pctx);
+
+/** Exactly \ref t8_forest_iterate_faces, but drawing the per level child
+ * elements and index buffers from a reusable context instead of
+ * allocating them in every recursion step.
+ * \param [in] ctx    A context created with
+ *                    \ref t8_forest_iterate_faces_ctx_new for \a forest.
+ *                    May be NULL, in which case the behavior is identical
+ *                    to \ref t8_forest_iterate_faces.
+ * The remaining parameters are as in \ref t8_forest_iterate_faces.
+ */
+void                t8_forest_iterate_faces_ctx (t8_forest_t forest,
+                                                 t8_locidx_t ltreeid,
+                                                 const t8_element_t *element,
+                                                 int face,
+                                                 t8_element_array_t
+                                                 *leaf_elements,
+                                                 void *user_data,
+                                                 t8_locidx_t
+                                                 tree_lindex_of_first_leaf,
+                                                 t8_forest_iterate_face_fn
+                                                 callback,
+                                                 t8_forest_iterate_faces_ctx_t
+                                                 *ctx);
+
+/** Description of one independent face recursion for
+ * \ref t8_forest_iterate_faces_batch. The fields mirror the parameters of
+ * \ref t8_forest_iterate_faces.
+ */
+typedef struct t8_forest_iterate_faces_task
+{
+  t8_locidx_t         ltreeid;  /**< The local tree of the recursion root. */
+  const t8_element_t *element;  /**< The recursion root element. */
+  int                 face;     /**< The face of \a element to recurse on. */
+  t8_element_array_t *leaf_elements;    /**< The leaf elements of \a element. */
+  void               *user_data;        /**< Passed through to the callback. */
+  t8_locidx_t         tree_lindex_of_first_leaf;        /**< \see t8_forest_iterate_faces */
+} t8_forest_iterate_faces_task_t;
+
+/** Run many independent face recursions, dispatched over the process-wide
+ * thread pool (\see t8_thread_pool_exec) with one reusable iteration
+ * context per concurrent worker. Without pthread support the tasks are
+ * executed serially through a single context, which still removes the
+ * per level allocation churn.
+ * \param [in] forest     A committed forest.
+ * \param [in] tasks      Array of \a num_tasks face recursions.
+ * \param [in] num_tasks  The number of tasks.
+ * \param [in] callback   The face callback, \see t8_forest_iterate_faces.
+ *                        It may be invoked from different threads at the
+ *                        same time and must be thread safe with respect
+ *                        to its user data.
+ */
+void                t8_forest_iterate_faces_batch (t8_forest_t forest,
+                                                   const
+                                                   t8_forest_iterate_faces_task_t
+                                                   *tasks, int num_tasks,
+                                                   t8_forest_iterate_face_fn
+                                                   callback);
+
+/** Iterate over all faces of all local leaf elements, reporting each
+ * interior face exactly once.
+ * For each local leaf and each of its faces the leaf neighbors are
+ * computed once in SFC order and the face is reported from the side of
+ * the finer element; between equal level local leaves from the side of
+ * the element with the smaller local index. Thus every interior face
+ * between two local leaves triggers exactly one callback with both
+ * elements, the dual face and the orientation of the coarse mesh face
+ * connection - instead of being computed twice as when looping
+ * \ref t8_forest_leaf_face_neighbors over all elements.
+ * Domain boundary faces are reported with a NULL neighbor.
+ * A face whose neighbor is a ghost is reported tagged
+ * \ref T8_FOREST_FACE_GHOST on every process adjoining the face, since
+ * each process needs the face for its own element.
+ * \param [in] forest     A committed balanced forest with a valid ghost
+ *                        layer (if parallel),
+ *                        \see t8_forest_leaf_face_neighbors.
+ * \param [in] callback   Called once per unique face as described above.
+ * \param [in] user_data  Arbitrary data passed through to \a callback.
+ */
+void                t8_forest_iterate_all_faces (t8_forest_t forest,
+                                                 t8_forest_iterate_all_faces_fn
+                                                 callback, void *user_data);
+
 /* Perform a top-down search of the forest, executing a callback on each
  * intermediate element. The search will enter each tree at least once.
  * If the callback returns false for an element, its descendants
@@ -103,6 +290,154 @@ void                t8_forest_search (t8_forest_t forest,
                                       t8_forest_search_query_fn query_fn,
                                       sc_array_t *queries);
 
+/** Variant of \ref t8_forest_search that can additionally descend the
+ * trees of the ghost layer, so that queries near partition boundaries
+ * do not need a hand written second pass over the ghost elements.
+ * Ghost trees are searched with the same top-down recursion and the
+ * same query batching as local trees. They are identified by their
+ * tree id: a ghost tree is passed to the callbacks as the number of
+ * local trees plus the ghost tree id, hence a callback recognizes a
+ * ghost element by
+ * ltreeid >= t8_forest_get_num_local_trees (forest).
+ * For ghost trees \a tree_leaf_index refers to the index within the
+ * element array of the ghost tree,
+ * \see t8_forest_ghost_get_tree_elements.
+ * \param [in] forest        The forest to be searched.
+ * \param [in] search_fn     The callback executed on each intermediate
+ *                           element, \see t8_forest_search.
+ * \param [in] query_fn      The query callback, may be NULL.
+ * \param [in] queries       The queries, must be NULL if and only if
+ *                           \a query_fn is NULL.
+ * \param [in] search_ghosts If true, also search the ghost trees.
+ *                           If the forest has no ghost layer, the
+ *                           search is identical to
+ *                           \ref t8_forest_search.
+ */
+void                t8_forest_search_ext (t8_forest_t forest,
+                                          t8_forest_search_query_fn search_fn,
+                                          t8_forest_search_query_fn query_fn,
+                                          sc_array_t *queries,
+                                          int search_ghosts);
+
+/* Variant of \ref t8_forest_search that searches the local trees
+ * concurrently with OpenMP threads (if t8code was configured with
+ * --enable-openmp, otherwise it is identical to \ref t8_forest_search).
+ * As in \ref t8_forest_search, the recursion in each tree carries an array
+ * of the queries that are still active, so a query only descends into
+ * matching subtrees.
+ * \note \a search_fn and \a query_fn are called concurrently from multiple
+ * threads and must be thread-safe. The entries of \a queries are shared
+ * between the trees and should only be read.
+ */
+void                t8_forest_search_parallel (t8_forest_t forest,
+                                               t8_forest_search_query_fn
+                                               search_fn,
+                                               t8_forest_search_query_fn
+                                               query_fn,
+                                               sc_array_t *queries);
+
+/** Variant of \ref t8_forest_search_parallel with the ghost layer
+ * option of \ref t8_forest_search_ext. Ghost trees are distributed to
+ * the threads like local trees.
+ * \param [in] search_ghosts If true, also search the ghost trees,
+ *                           \see t8_forest_search_ext for the tree id
+ *                           convention in the callbacks.
+ */
+void                t8_forest_search_parallel_ext (t8_forest_t forest,
+                                                   t8_forest_search_query_fn
+                                                   search_fn,
+                                                   t8_forest_search_query_fn
+                                                   query_fn,
+                                                   sc_array_t *queries,
+                                                   int search_ghosts);
+
+/** Opaque pointer to a search cursor.
+ * A cursor makes repeated searches with the same predicate cheap: it
+ * records which leaves the search recursion of its last execution
+ * reached, together with a leaf checksum per local tree. A later
+ * execution re-descends only the trees whose leaf sequence changed
+ * since then and replays the recorded leaves of the unchanged trees
+ * directly, so in steady state a repeated search costs one checksum
+ * pass plus one callback per result instead of a full top-down
+ * traversal. \see t8_forest_search_cursor_search */
+typedef struct t8_forest_search_cursor *t8_forest_search_cursor_t;
+
+/** Create a new, empty search cursor.
+ * \return    The new cursor. Its first search performs a full
+ *            traversal. Free it with
+ *            \ref t8_forest_search_cursor_destroy.
+ */
+t8_forest_search_cursor_t t8_forest_search_cursor_new (void);
+
+/** Perform a search through a cursor.
+ * On the trees whose leaf checksum differs from the cursor's recorded
+ * run - and on all trees if the cursor is empty or was invalidated -
+ * this behaves like \ref t8_forest_search: the tree is descended top
+ * down and \a search_fn is called on every intermediate element and
+ * leaf. On the unchanged trees \a search_fn is only called once per
+ * recorded leaf, with is_leaf true; the intermediate calls of the
+ * descent are skipped there. After the call the cursor records the
+ * current run.
+ * \param [in] forest     A committed forest. It may be a different
+ *                        forest object than in the previous execution,
+ *                        for example a later adapt stage, as long as it
+ *                        has the same local trees.
+ * \param [in,out] cursor The cursor holding the previous run.
+ * \param [in] search_fn  The search callback, \see t8_forest_search.
+ *                        It must implement the same predicate in every
+ *                        execution through the same cursor, otherwise
+ *                        the replayed leaves of unchanged trees do not
+ *                        match the predicate.
+ * \note Only the local trees are searched; queries and the ghost layer
+ * option of \ref t8_forest_search_ext are not supported by cursors.
+ * \note Changed trees are detected by the same leaf checksums as in
+ * \ref t8_forest_diff.
+ */
+void                t8_forest_search_cursor_search (t8_forest_t forest,
+                                                    t8_forest_search_cursor_t
+                                                    cursor,
+                                                    t8_forest_search_query_fn
+                                                    search_fn);
+
+/** Drop the recorded run of a cursor, so that its next search performs
+ * a full traversal. Call this if the predicate of the search changed,
+ * for example because a sampling plane moved.
+ * \param [in,out] cursor  The cursor to invalidate.
+ */
+void                t8_forest_search_cursor_invalidate (t8_forest_search_cursor_t
+                                                        cursor);
+
+/** Destroy a search cursor and free its memory.
+ * \param [in,out] pcursor Pointer to a cursor. Set to NULL on output.
+ */
+void                t8_forest_search_cursor_destroy (t8_forest_search_cursor_t
+                                                     *pcursor);
+
+/** Enumerate all complete families of local leaf elements and call a
+ * callback once per family with the member elements.
+ * A family is a set of elements that are all children of the same
+ * parent, \see t8_element_is_family. Since the leaf elements are stored
+ * in space-filling curve order, the members of a complete family are
+ * consecutive in the leaf array of their tree; candidate positions are
+ * filtered by child id and level before the full family check, so no
+ * elements are constructed during the enumeration. Families whose
+ * members are distributed over multiple processes are not reported,
+ * matching the coarsening rule of \ref t8_forest_adapt.
+ * \param [in] forest    A committed forest.
+ * \param [in] callback  Called once per complete family, with the
+ *                       members in SFC order.
+ * \param [in] parallel  If true, the local trees are enumerated
+ *                       concurrently with OpenMP threads (if t8code was
+ *                       configured with --enable-openmp, otherwise the
+ *                       trees are walked serially). The callback must
+ *                       then be thread safe; families of different
+ *                       trees may be reported concurrently and in any
+ *                       order.
+ */
+void                t8_forest_iterate_families (t8_forest_t forest,
+                                                t8_forest_iterate_families_fn
+                                                callback, int parallel);
+
 /** Given two forest where the elements in one forest are either direct children or
  * parents of the elements in the other forest
  * compare the two forests and for each refined element or coarsened
@@ -119,6 +454,185 @@ void                t8_forest_iterate_replace (t8_forest_t forest_new,
                                                t8_forest_replace_t
                                                replace_fn);
 
+/** Variant of \ref t8_forest_iterate_replace that walks the local trees
+ * concurrently with OpenMP threads (if t8code was configured with
+ * --enable-openmp, otherwise the trees are walked serially) and that
+ * reports runs of consecutive unchanged elements in one callback
+ * invocation. If \a replace_fn is called with refine = 0, num_outgoing and
+ * num_incoming are equal but may be larger than one; the i-th element of
+ * the outgoing range then matches the i-th element of the incoming range.
+ * This lets the callback transfer the data of all unchanged elements of a
+ * run in one contiguous, vectorizable pass.
+ * Forests with removed elements are walked serially, since matching their
+ * trees constructs parent elements from the shared scheme mempools.
+ * \note \a replace_fn is called concurrently from multiple threads, must be
+ * thread-safe, and must not rely on any ordering of the calls.
+ * \see t8_forest_iterate_replace
+ */
+void                t8_forest_iterate_replace_parallel (t8_forest_t
+                                                        forest_new,
+                                                        t8_forest_t
+                                                        forest_old,
+                                                        t8_forest_replace_t
+                                                        replace_fn);
+
+/** A read-only cursor over the local leaf elements of a committed forest.
+ * The iterator visits the leaves of a given range of local element indices
+ * in ascending order and keeps track of the tree that the current leaf
+ * belongs to, so no index-to-tree lookup is needed per element.
+ *
+ * All iterator functions only read the committed forest and do not modify
+ * any shared state.  Hence, several iterators over the same forest may be
+ * used concurrently, for example one per OpenMP thread with disjoint
+ * element ranges.  The same holds for the plain getters
+ * \ref t8_forest_get_element_in_tree, \ref t8_forest_get_tree_element_count
+ * and \ref t8_element_array_index_locidx.
+ * \note Functions that fill lazy caches on first use, for example
+ * \ref t8_forest_get_tree_element_offset and the element owner queries,
+ * should be called once before entering a threaded region. */
+typedef struct t8_forest_leaf_iterator
+{
+  t8_forest_t         forest;   /**< The committed forest that is iterated. */
+  t8_locidx_t         itree;    /**< The local tree of the current leaf. */
+  t8_locidx_t         element_in_tree;  /**< The index of the current leaf within its tree. */
+  t8_locidx_t         ielement; /**< The local index of the current leaf in the forest. */
+  t8_locidx_t         end_element;      /**< The first local element index that is not iterated. */
+  t8_element_array_t *leaf_elements;    /**< The leaf elements of the current tree. */
+} t8_forest_leaf_iterator_t;
+
+/** Initialize a leaf iterator for a range of local elements.
+ * \param [out] iterator  The iterator to initialize.
+ * \param [in]  forest    A committed forest.
+ * \param [in]  first_local_element The local index of the first leaf to visit.
+ * \param [in]  end_local_element   The first local index that is not visited.
+ *                        Pass 0 and \ref t8_forest_get_local_num_elements to
+ *                        iterate all local leaves.
+ */
+void                t8_forest_leaf_iterator_init (t8_forest_leaf_iterator_t
+                                                  *iterator,
+                                                  t8_forest_t forest,
+                                                  t8_locidx_t
+                                                  first_local_element,
+                                                  t8_locidx_t
+                                                  end_local_element);
+
+/** Query whether a leaf iterator has visited all leaves of its range.
+ * \param [in] iterator  An initialized iterator.
+ * \return               True if and only if there is no current leaf.
+ */
+int                 t8_forest_leaf_iterator_is_done (const
+                                                     t8_forest_leaf_iterator_t
+                                                     *iterator);
+
+/** Advance a leaf iterator to the next leaf in its range.
+ * \param [in,out] iterator  An initialized iterator that is not done.
+ */
+void                t8_forest_leaf_iterator_next (t8_forest_leaf_iterator_t
+                                                  *iterator);
+
+/** Get the current leaf element of a leaf iterator.
+ * \param [in] iterator  An initialized iterator that is not done.
+ * \return               A pointer to the current leaf element.
+ */
+const t8_element_t *t8_forest_leaf_iterator_element (const
+                                                     t8_forest_leaf_iterator_t
+                                                     *iterator);
+
+/** Opaque pointer to a subset of the local leaf elements of a forest.
+ * A subset stores the forest local indices of its elements in ascending
+ * order, so sweeping it with \ref t8_forest_subset_iterate touches only the
+ * selected elements instead of traversing all leaves and branching per
+ * element. */
+typedef struct t8_forest_subset *t8_forest_subset_t;
+
+/** Callback function prototype for \ref t8_forest_subset_iterate.
+ * \param [in] forest      The forest that is swept.
+ * \param [in] ltreeid     The local tree of the current element.
+ * \param [in] element     The current leaf element.
+ * \param [in] leaf_index  The forest local index of \a element, suitable to
+ *                         index per element data arrays.
+ * \param [in] user_data   The user data pointer passed to the iterate call.
+ */
+typedef void        (*t8_forest_subset_fn) (t8_forest_t forest,
+                                            t8_locidx_t ltreeid,
+                                            const t8_element_t *element,
+                                            t8_locidx_t leaf_index,
+                                            void *user_data);
+
+/** Create a subset from a list of forest local leaf indices.
+ * The indices are copied, sorted and deduplicated, so the input may be in
+ * any order and contain repetitions.
+ * \param [in] forest      A committed forest.
+ * \param [in] indices     An array of \a num_indices forest local leaf
+ *                         indices in [0, num local elements).
+ * \param [in] num_indices The number of entries of \a indices.
+ * \return                 The new subset. It stays valid as long as the
+ *                         element partition of \a forest is unchanged and
+ *                         must be freed with \ref t8_forest_subset_destroy.
+ */
+t8_forest_subset_t  t8_forest_subset_new_from_indices (t8_forest_t forest,
+                                                       const t8_locidx_t
+                                                       *indices,
+                                                       t8_locidx_t
+                                                       num_indices);
+
+/** Create a subset from a mask over the local leaf elements.
+ * \param [in] forest      A committed forest.
+ * \param [in] mask        An array with one entry per local leaf element.
+ *                         A leaf is in the subset if and only if its entry
+ *                         is nonzero.
+ * \return                 The new subset, \see t8_forest_subset_new_from_indices.
+ */
+t8_forest_subset_t  t8_forest_subset_new_from_mask (t8_forest_t forest,
+                                                    const int8_t *mask);
+
+/** Create the built-in subset of the process boundary elements, that is of
+ * all local elements that are remote elements of at least one other rank.
+ * The indices were recorded during the ghost layer creation, so no face
+ * neighbor computation is performed. Boundary kernels can thus sweep only
+ * the elements that interact with ghost data.
+ * \param [in] forest      A committed forest with constructed ghost layer.
+ * \return                 The new subset. It is empty if the forest has no
+ *                         ghost layer or no remote elements.
+ * \see t8_forest_ghost_remote_leaf_indices
+ */
+t8_forest_subset_t  t8_forest_subset_new_boundary (t8_forest_t forest);
+
+/** Return the number of elements of a subset.
+ * \param [in] subset      A subset.
+ * \return                 The number of leaf elements in \a subset.
+ */
+t8_locidx_t         t8_forest_subset_num_elements (const t8_forest_subset_t
+                                                   subset);
+
+/** Return the forest local leaf index of the i-th subset element.
+ * \param [in] subset      A subset.
+ * \param [in] index       An index into the subset,
+ *                         0 <= \a index < \ref t8_forest_subset_num_elements.
+ * \return                 The forest local leaf index of the element.
+ */
+t8_locidx_t         t8_forest_subset_index (const t8_forest_subset_t subset,
+                                            t8_locidx_t index);
+
+/** Call a callback for each element of a subset in ascending index order.
+ * The sweep keeps a tree cursor, so no index-to-tree lookup is performed
+ * per element, and prefetches the storage of the next subset element while
+ * the callback runs on the current one.
+ * \param [in] forest      The committed forest the subset was created for.
+ * \param [in] subset      The subset to sweep.
+ * \param [in] callback    The callback to call for each subset element.
+ * \param [in] user_data   Arbitrary data passed through to \a callback.
+ */
+void                t8_forest_subset_iterate (t8_forest_t forest,
+                                              t8_forest_subset_t subset,
+                                              t8_forest_subset_fn callback,
+                                              void *user_data);
+
+/** Destroy a subset and free its memory.
+ * \param [in,out] psubset Pointer to a subset. Set to NULL on output.
+ */
+void                t8_forest_subset_destroy (t8_forest_subset_t *psubset);
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_FOREST_ITERATE_H! */
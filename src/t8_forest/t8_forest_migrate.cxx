@@ -0,0 +1,296 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/* In this file we implement the migration of a committed forest onto a
+ * communicator with a different number of processes, see
+ * t8_forest_migrate.h. The exchange plan is computed symmetrically on
+ * the senders and the receivers from the old element counts, which are
+ * gathered once over the routing communicator. Every process then knows
+ * exactly which contiguous record slices it exchanges with whom, so the
+ * migration needs a single allgather and one point-to-point exchange,
+ * no handshake and no file. */
+
+#include <t8_cmesh.h>
+#include <t8_element_cxx.hxx>
+#include <t8_data/t8_containers.h>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_migrate.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_forest/t8_forest_private.h>
+
+/* Return the first global element index of the uniform target range of
+ * a rank of the new communicator. */
+static t8_gloidx_t
+t8_forest_migrate_new_offset (t8_gloidx_t global_num_elements, int rank,
+                              int num_ranks)
+{
+  return (global_num_elements * rank) / num_ranks;
+}
+
+/* Compute the closed-open interval of global element indices whose
+ * records a rank of the new communicator needs to rebuild its part of
+ * the forest: its uniform target range, extended downwards by the
+ * record of its predecessor element (to detect a first tree that is
+ * shared with a smaller rank) and, for an empty rank, the record of its
+ * successor element (to place the rank on a tree). This mirrors the
+ * extra reads of the checkpoint loader, see
+ * t8_forest_checkpoint_read_local. */
+static void
+t8_forest_migrate_need_range (t8_gloidx_t global_num_elements, int rank,
+                              int num_ranks, t8_gloidx_t *need_first,
+                              t8_gloidx_t *need_end)
+{
+  t8_gloidx_t         first, end;
+
+  first = t8_forest_migrate_new_offset (global_num_elements, rank, num_ranks);
+  end = t8_forest_migrate_new_offset (global_num_elements, rank + 1,
+                                      num_ranks);
+  if (end > first) {
+    *need_first = first > 0 ? first - 1 : 0;
+    *need_end = end;
+  }
+  else if (first < global_num_elements) {
+    *need_first = first;
+    *need_end = first + 1;
+  }
+  else {
+    /* An empty rank behind the last element needs no records at all */
+    *need_first = *need_end = global_num_elements;
+  }
+}
+
+t8_forest_t
+t8_forest_migrate_comm (t8_forest_t forest, sc_MPI_Comm new_comm,
+                        t8_cmesh_t cmesh, t8_scheme_cxx_t *scheme)
+{
+  t8_forest_leaf_record_t *local_records = NULL;
+  t8_forest_leaf_record_t *recv_records = NULL;
+  const t8_forest_leaf_record_t *records, *prev_record, *next_record;
+  sc_MPI_Comm         routing_comm;
+  sc_MPI_Request     *requests;
+  t8_forest_t         forest_new;
+  t8_tree_t           tree;
+  t8_eclass_scheme_c *eclass_scheme;
+  t8_element_t       *element;
+  long long          *gathered;
+  t8_gloidx_t        *old_offsets;
+  t8_gloidx_t         global_num_elements, my_old_first, my_old_end;
+  t8_gloidx_t         need_first, need_end, slice_first, slice_end, ga, gb;
+  t8_locidx_t         num_local_trees, itree, ielem, iel, num_new_elements;
+  long long           sendvals[2];
+  int                 in_new, new_size, routing_size, routing_rank;
+  int                 mpiret, irank, level, num_requests;
+
+  T8_ASSERT (forest == NULL || t8_forest_is_committed (forest));
+  in_new = new_comm != sc_MPI_COMM_NULL;
+  T8_ASSERT (forest != NULL || in_new);
+  T8_ASSERT (in_new || (cmesh == NULL && scheme == NULL));
+  T8_ASSERT (!in_new || (cmesh != NULL && t8_cmesh_is_committed (cmesh)));
+  T8_ASSERT (!in_new || scheme != NULL);
+
+  /* The records are routed over the communicator that contains every
+   * participating process: the old one when shrinking, the new one when
+   * growing. A process in both groups picks the larger communicator;
+   * since the smaller group forms the first ranks of the larger
+   * communicator, all processes agree on the routing ranks. */
+  if (forest == NULL) {
+    routing_comm = new_comm;
+  }
+  else if (!in_new) {
+    routing_comm = forest->mpicomm;
+  }
+  else {
+    int                 check_new_size;
+
+    mpiret = sc_MPI_Comm_size (new_comm, &check_new_size);
+    SC_CHECK_MPI (mpiret);
+    routing_comm = forest->mpisize >= check_new_size ? forest->mpicomm
+      : new_comm;
+#ifdef T8_ENABLE_DEBUG
+    {
+      /* The ranks of a process in the nested groups must coincide */
+      int                 check_new_rank;
+
+      mpiret = sc_MPI_Comm_rank (new_comm, &check_new_rank);
+      SC_CHECK_MPI (mpiret);
+      T8_ASSERT (check_new_rank == forest->mpirank);
+    }
+#endif
+  }
+  mpiret = sc_MPI_Comm_size (routing_comm, &routing_size);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (routing_comm, &routing_rank);
+  SC_CHECK_MPI (mpiret);
+
+  /* Gather the old partition and the new process group. Each process
+   * contributes its old element count and whether it is part of the new
+   * communicator; joining processes contribute a zero count, so the
+   * cumulative counts are the old element offsets on every process. */
+  sendvals[0] = forest != NULL ? (long long) forest->local_num_elements : 0;
+  sendvals[1] = in_new ? 1 : 0;
+  gathered = T8_ALLOC (long long, 2 * routing_size);
+  mpiret = sc_MPI_Allgather (sendvals, 2, sc_MPI_LONG_LONG_INT, gathered, 2,
+                             sc_MPI_LONG_LONG_INT, routing_comm);
+  SC_CHECK_MPI (mpiret);
+  old_offsets = T8_ALLOC (t8_gloidx_t, routing_size + 1);
+  old_offsets[0] = 0;
+  new_size = 0;
+  for (irank = 0; irank < routing_size; irank++) {
+    old_offsets[irank + 1] =
+      old_offsets[irank] + (t8_gloidx_t) gathered[2 * irank];
+    new_size += (int) gathered[2 * irank + 1];
+    /* The new group must be a prefix of the routing communicator */
+    T8_ASSERT (irank == 0
+               || gathered[2 * irank + 1] <= gathered[2 * (irank - 1) + 1]);
+  }
+  T8_FREE (gathered);
+  global_num_elements = old_offsets[routing_size];
+  T8_ASSERT (new_size > 0);
+  T8_ASSERT (in_new == (routing_rank < new_size));
+  T8_ASSERT (forest == NULL
+             || global_num_elements == forest->global_num_elements);
+
+  requests = T8_ALLOC (sc_MPI_Request, routing_size + new_size);
+  num_requests = 0;
+
+  /* Post the receives for the records this process needs. The needed
+   * interval is covered by the old ranks whose element ranges intersect
+   * it; the slice exchanged with ourselves is copied below. */
+  need_first = need_end = 0;
+  if (in_new) {
+    t8_forest_migrate_need_range (global_num_elements, routing_rank,
+                                  new_size, &need_first, &need_end);
+    recv_records = T8_ALLOC (t8_forest_leaf_record_t,
+                             need_end - need_first);
+    for (irank = 0; irank < routing_size; irank++) {
+      ga = SC_MAX (need_first, old_offsets[irank]);
+      gb = SC_MIN (need_end, old_offsets[irank + 1]);
+      if (gb <= ga || irank == routing_rank) {
+        continue;
+      }
+      mpiret = sc_MPI_Irecv (recv_records + (ga - need_first),
+                             (int) ((gb - ga)
+                                    * sizeof (t8_forest_leaf_record_t)),
+                             sc_MPI_BYTE, irank, T8_MPI_MIGRATE_FOREST,
+                             routing_comm, requests + num_requests++);
+      SC_CHECK_MPI (mpiret);
+    }
+  }
+
+  /* Fill one record per local leaf element as in the checkpoint writer
+   * and send each new rank the slice of its needed interval that this
+   * process owns. The needed intervals ascend with the rank, so the
+   * destination ranks form a contiguous range. */
+  if (forest != NULL && forest->local_num_elements > 0) {
+    local_records = T8_ALLOC (t8_forest_leaf_record_t,
+                              forest->local_num_elements);
+    num_local_trees = (t8_locidx_t) forest->trees->elem_count;
+    for (itree = 0, iel = 0; itree < num_local_trees; itree++) {
+      tree = (t8_tree_t) t8_sc_array_index_locidx (forest->trees, itree);
+      eclass_scheme = forest->scheme_cxx->eclass_schemes[tree->eclass];
+      for (ielem = 0;
+           ielem < (t8_locidx_t) t8_element_array_get_count (&tree->elements);
+           ielem++, iel++) {
+        element = t8_element_array_index_locidx (&tree->elements, ielem);
+        level = eclass_scheme->t8_element_level (element);
+        local_records[iel].gtree = forest->first_local_tree + itree;
+        local_records[iel].linear_id =
+          eclass_scheme->t8_element_get_linear_id (element, level);
+        local_records[iel].level = (int32_t) level;
+        local_records[iel].pad = 0;
+      }
+    }
+    T8_ASSERT (iel == forest->local_num_elements);
+
+    my_old_first = old_offsets[routing_rank];
+    my_old_end = my_old_first + forest->local_num_elements;
+    for (irank = 0; irank < new_size; irank++) {
+      t8_gloidx_t         rank_first, rank_end;
+
+      t8_forest_migrate_need_range (global_num_elements, irank, new_size,
+                                    &rank_first, &rank_end);
+      if (rank_first >= my_old_end) {
+        break;
+      }
+      ga = SC_MAX (rank_first, my_old_first);
+      gb = SC_MIN (rank_end, my_old_end);
+      if (gb <= ga) {
+        continue;
+      }
+      if (irank == routing_rank) {
+        memcpy (recv_records + (ga - need_first),
+                local_records + (ga - my_old_first),
+                (gb - ga) * sizeof (t8_forest_leaf_record_t));
+      }
+      else {
+        mpiret = sc_MPI_Isend (local_records + (ga - my_old_first),
+                               (int) ((gb - ga)
+                                      * sizeof (t8_forest_leaf_record_t)),
+                               sc_MPI_BYTE, irank, T8_MPI_MIGRATE_FOREST,
+                               routing_comm, requests + num_requests++);
+        SC_CHECK_MPI (mpiret);
+      }
+    }
+  }
+
+  if (num_requests > 0) {
+    mpiret = sc_MPI_Waitall (num_requests, requests,
+                             sc_MPI_STATUSES_IGNORE);
+    SC_CHECK_MPI (mpiret);
+  }
+  T8_FREE (requests);
+  T8_FREE (local_records);
+  T8_FREE (old_offsets);
+
+  if (!in_new) {
+    /* This process leaves the computation */
+    return NULL;
+  }
+
+  /* Split the received interval into the predecessor record, the own
+   * slice and the successor record of an empty rank, then rebuild the
+   * forest exactly as the checkpoint loader does. */
+  slice_first = t8_forest_migrate_new_offset (global_num_elements,
+                                              routing_rank, new_size);
+  slice_end = t8_forest_migrate_new_offset (global_num_elements,
+                                            routing_rank + 1, new_size);
+  num_new_elements = (t8_locidx_t) (slice_end - slice_first);
+  prev_record = next_record = NULL;
+  records = recv_records;
+  if (num_new_elements > 0 && slice_first > 0) {
+    prev_record = recv_records;
+    records = recv_records + 1;
+  }
+  else if (num_new_elements == 0 && slice_first < global_num_elements) {
+    next_record = recv_records;
+  }
+  forest_new = t8_forest_build_from_records (cmesh, scheme, new_comm,
+                                             records, num_new_elements,
+                                             global_num_elements,
+                                             prev_record, next_record);
+  T8_FREE (recv_records);
+  t8_debugf ("Migrated forest with %lli global elements onto "
+             "%i processes, %li local elements.\n",
+             (long long) global_num_elements, new_size,
+             (long) num_new_elements);
+  return forest_new;
+}
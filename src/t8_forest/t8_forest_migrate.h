@@ -0,0 +1,80 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_migrate.h
+ * Migration of a committed forest onto a communicator with a different
+ * number of processes, for malleable jobs that grow or shrink their
+ * rank count at runtime. The leafs are shipped as (tree, level, linear
+ * id) records in a single point-to-point exchange and the forest and a
+ * matching partition of its coarse mesh are rebuilt on the new
+ * communicator, without the file round trip of a checkpoint/restart
+ * cycle, \see t8_forest_write_checkpoint.
+ */
+
+#ifndef T8_FOREST_MIGRATE_H
+#define T8_FOREST_MIGRATE_H
+
+#include <t8_forest/t8_forest_general.h>
+
+T8_EXTERN_C_BEGIN ();
+
+/** Repartition a committed forest onto a communicator with a different
+ * number of processes.
+ * The global element sequence is split uniformly over the processes of
+ * \a new_comm and each process receives its slice of the leafs in one
+ * point-to-point record exchange, then commits a forest on \a new_comm
+ * whose coarse mesh is a partition of \a cmesh derived with the cmesh
+ * partition machinery.
+ * The function is collective over the union of the two process groups,
+ * which must be nested: the smaller group must consist of the first
+ * ranks of the larger communicator in the same order, as produced by
+ * splitting or growing a parent communicator at the front. Processes
+ * that leave the computation pass \a new_comm = sc_MPI_COMM_NULL and
+ * NULL for \a cmesh and \a scheme; processes that join pass
+ * \a forest = NULL.
+ * \param [in]  forest   The committed forest to migrate, or NULL on a
+ *                       joining process. The forest is not modified;
+ *                       the caller keeps its reference.
+ * \param [in]  new_comm The communicator to migrate to, or
+ *                       sc_MPI_COMM_NULL on a leaving process.
+ * \param [in]  cmesh    A committed cmesh with the same trees as the
+ *                       cmesh of \a forest, valid on \a new_comm;
+ *                       usually a replicated copy of the coarse mesh.
+ *                       Its reference count is unchanged. NULL on a
+ *                       leaving process.
+ * \param [in]  scheme   The element scheme of the migrated forest. The
+ *                       function takes ownership of this reference.
+ *                       NULL on a leaving process.
+ * \return               The committed forest on \a new_comm holding the
+ *                       same global leafs as \a forest, uniformly
+ *                       partitioned. NULL on a leaving process.
+ * \note The element data of the forest is not migrated. Transfer it
+ *       separately, for example keyed by the global element index.
+ */
+t8_forest_t         t8_forest_migrate_comm (t8_forest_t forest,
+                                            sc_MPI_Comm new_comm,
+                                            t8_cmesh_t cmesh,
+                                            t8_scheme_cxx_t *scheme);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_FOREST_MIGRATE_H */
@@ -54,11 +54,19 @@ These functions write a file in the NetCDF-format which represents the given 2D-
 #include <t8_element_cxx.hxx>
 #include <t8_forest/t8_forest_general.h>
 #include <t8_forest/t8_forest_geometrical.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_forest/t8_forest_decimate.h>
 #include <t8_forest_netcdf.h>
 #include <t8_element_shape.h>
 
 T8_EXTERN_C_BEGIN ();
 
+/* Number of elements per write round of the chunk-streamed variable
+ * output. The staging buffers of the data writers hold at most this
+ * many elements, so the output-phase memory stays flat regardless of
+ * the local element count. */
+#define T8_FOREST_NETCDF_CHUNK_ELEMS 4096
+
 /* Contains all Variables used in order to work with the NetCDF-File */
 typedef struct
 {
@@ -89,9 +97,22 @@ typedef struct
   t8_nc_int32_t       start_index;
   const char         *convention;
   int                 netcdf_var_storage_mode;
+  size_t              netcdf_var_chunksize;
+  int                 netcdf_var_deflate_level;
   int                 netcdf_mpi_access;
+  /* The coordinate output precision of the forest,
+   * \see t8_forest_set_coordinate_precision */
+  int                 coord_nc_type;    /* NC_DOUBLE or NC_FLOAT */
+  int                 coord_quantize;   /* True if the coordinates are snapped to a grid */
+  double              coord_box_min[3]; /* Minimal corner of the quantization box */
+  double              coord_step[3];    /* Quantization step per dimension */
   /* Stores the old NetCDF-FillMode if it gets changed */
   int                 old_fill_mode;
+  /* The decimation plan of this write, or NULL for a full resolution
+   * write, \see t8_forest_write_netcdf_decimated */
+  t8_forest_decimation_plan_t *plan;
+  t8_forest_reduce_fn reduce_fn;        /* Reduction of aggregated data, NULL for the mean */
+  void               *reduce_user_data; /* Passed through to reduce_fn */
 
 } t8_forest_netcdf_context_t;
 
@@ -157,6 +178,75 @@ t8_forest_init_ugrid_namespace_context (t8_forest_netcdf_ugrid_namespace_t
   }
 }
 
+#if T8_WITH_NETCDF
+/* Apply storage, chunking, compression and mpi access hints to an
+ * already defined netCDF-variable.
+ * A chunksize of 0 leaves the chunk shape to the netCDF default and a
+ * deflate level of -1 disables compression. The given dimension lengths
+ * clamp the chunk shape; for one-dimensional variables the second
+ * length is 1 and its entry is ignored by netCDF. */
+static void
+t8_forest_write_netcdf_apply_hints (t8_forest_netcdf_context_t * context,
+                                    const int varid, int storage_mode,
+                                    size_t chunksize, int deflate_level,
+                                    int mpi_access,
+                                    const size_t first_dim_length,
+                                    const size_t second_dim_length)
+{
+  int                 retval;
+  size_t              chunksizes[2];
+
+  /* Define whether a contiguous or chunked storage is used for the
+   * variable and eventually prescribe the chunk shape */
+  if (storage_mode == NC_CHUNKED && chunksize > 0 && first_dim_length > 0) {
+    chunksizes[0] = SC_MIN (chunksize, first_dim_length);
+    chunksizes[1] = second_dim_length;
+    retval = nc_def_var_chunking (context->ncid, varid, NC_CHUNKED,
+                                  chunksizes);
+  }
+  else {
+    retval = nc_def_var_chunking (context->ncid, varid, storage_mode, NULL);
+  }
+  if (retval) {
+    ERR (retval);
+  }
+  /* Enable zlib compression of the variable. netCDF switches the
+   * variable to chunked storage if it was not chunked already. */
+  if (deflate_level >= 0) {
+    if ((retval =
+         nc_def_var_deflate (context->ncid, varid, 0, 1, deflate_level))) {
+      ERR (retval);
+    }
+  }
+  /* Define whether an independent or collective variable access is used */
+#if T8_WITH_NETCDF_PAR
+  /* HDF5 supports parallel writes to compressed variables only with
+   * collective access */
+  if (deflate_level >= 0) {
+    mpi_access = NC_COLLECTIVE;
+  }
+  if ((retval = nc_var_par_access (context->ncid, varid, mpi_access))) {
+    ERR (retval);
+  }
+#endif
+}
+
+/* Apply the file wide hints of the context to a netCDF-variable */
+static void
+t8_forest_write_netcdf_context_hints (t8_forest_netcdf_context_t * context,
+                                      const int varid,
+                                      const size_t first_dim_length,
+                                      const size_t second_dim_length)
+{
+  t8_forest_write_netcdf_apply_hints (context, varid,
+                                      context->netcdf_var_storage_mode,
+                                      context->netcdf_var_chunksize,
+                                      context->netcdf_var_deflate_level,
+                                      context->netcdf_mpi_access,
+                                      first_dim_length, second_dim_length);
+}
+#endif
+
 /* Define NetCDF-dimesnions */
 static void
 t8_forest_write_netcdf_dimensions (t8_forest_netcdf_context_t * context,
@@ -275,20 +365,9 @@ t8_forest_write_netcdf_variables (t8_forest_netcdf_context_t * context,
                    &context->var_elem_types_id))) {
     ERR (retval);
   }
-  /* Define whether a contiguous or chunked storage is used for the variable */
-  if ((retval =
-       nc_def_var_chunking (context->ncid, context->var_elem_types_id,
-                            context->netcdf_var_storage_mode, NULL))) {
-    ERR (retval);
-  }
-  /* Define whether an independent or collective variable access is used */
-#if T8_WITH_NETCDF_PAR
-  if ((retval =
-       nc_var_par_access (context->ncid, context->var_elem_types_id,
-                          context->netcdf_mpi_access))) {
-    ERR (retval);
-  }
-#endif
+  /* Apply the storage, chunking, compression and access hints */
+  t8_forest_write_netcdf_context_hints (context, context->var_elem_types_id,
+                                        (size_t) context->nMesh_elem, 1);
   /* Define cf_role attribute */
   if ((retval =
        nc_put_att_text (context->ncid, context->var_elem_types_id, "cf_role",
@@ -326,20 +405,9 @@ t8_forest_write_netcdf_variables (t8_forest_netcdf_context_t * context,
                    &context->var_elem_tree_id))) {
     ERR (retval);
   }
-  /* Define whether a contiguous or chunked storage is used for the variable */
-  if ((retval =
-       nc_def_var_chunking (context->ncid, context->var_elem_tree_id,
-                            context->netcdf_var_storage_mode, NULL))) {
-    ERR (retval);
-  }
-  /* Define whether an independent or collective variable access is used */
-#if T8_WITH_NETCDF_PAR
-  if ((retval =
-       nc_var_par_access (context->ncid, context->var_elem_tree_id,
-                          context->netcdf_mpi_access))) {
-    ERR (retval);
-  }
-#endif
+  /* Apply the storage, chunking, compression and access hints */
+  t8_forest_write_netcdf_context_hints (context, context->var_elem_tree_id,
+                                        (size_t) context->nMesh_elem, 1);
   /* Define cf_role attribute */
   if ((retval =
        nc_put_att_text (context->ncid, context->var_elem_tree_id, "cf_role",
@@ -376,20 +444,11 @@ t8_forest_write_netcdf_variables (t8_forest_netcdf_context_t * context,
                    &context->var_elem_nodes_id))) {
     ERR (retval);
   }
-  /* Define whether a contiguous or chunked storage is used for the variable */
-  if ((retval =
-       nc_def_var_chunking (context->ncid, context->var_elem_nodes_id,
-                            context->netcdf_var_storage_mode, NULL))) {
-    ERR (retval);
-  }
-  /* Define whether an independent or collective variable access is used */
-#if T8_WITH_NETCDF_PAR
-  if ((retval =
-       nc_var_par_access (context->ncid, context->var_elem_nodes_id,
-                          context->netcdf_mpi_access))) {
-    ERR (retval);
-  }
-#endif
+  /* Apply the storage, chunking, compression and access hints */
+  t8_forest_write_netcdf_context_hints (context, context->var_elem_nodes_id,
+                                        (size_t) context->nMesh_elem,
+                                        (size_t)
+                                        context->nMaxMesh_elem_nodes);
   /* Define cf_role attribute */
   if ((retval =
        nc_put_att_text (context->ncid, context->var_elem_nodes_id, "cf_role",
@@ -436,12 +495,14 @@ t8_forest_write_netcdf_data (t8_forest_t forest,
   t8_locidx_t         num_local_tree_elem;
   t8_element_shape_t  element_shape;
   t8_element_t       *element;
-  t8_locidx_t         local_tree_offset;
   t8_gloidx_t         first_local_elem_id;
   t8_gloidx_t         num_local_nodes;
   t8_gloidx_t         num_nodes;
+  t8_gloidx_t         num_written;
+  t8_locidx_t         chunk_fill;
   int                *Mesh_elem_types;
   t8_nc_int64_t      *Mesh_elem_tree_id;
+  int                 num_rounds, num_rounds_max, rounds_done;
   size_t              start_ptr;
   size_t              count_ptr;
   int                 retval;
@@ -455,21 +516,34 @@ t8_forest_write_netcdf_data (t8_forest_t forest,
   /* Ger number of local elements */
   num_local_elements = t8_forest_get_local_num_elements (forest);
 
-  /* Declare variables with their proper dimensions. */
-  Mesh_elem_types = T8_ALLOC (int, num_local_elements);
-  Mesh_elem_tree_id = T8_ALLOC (t8_nc_int64_t, num_local_elements);
+  /* The staging buffers hold at most a chunk of elements; the variables
+   * are written in several rounds. */
+  Mesh_elem_types = T8_ALLOC (int, T8_FOREST_NETCDF_CHUNK_ELEMS);
+  Mesh_elem_tree_id = T8_ALLOC (t8_nc_int64_t, T8_FOREST_NETCDF_CHUNK_ELEMS);
 
   /* Check if pointers are not NULL. */
   T8_ASSERT (Mesh_elem_types != NULL && Mesh_elem_tree_id != NULL);
 
+  /* With collective mpi access every process has to take part in every
+   * write call, so all processes perform the maximum number of rounds
+   * and processes that ran out of elements write empty hyperslabs. */
+  num_rounds = (int) ((num_local_elements + T8_FOREST_NETCDF_CHUNK_ELEMS - 1)
+                      / T8_FOREST_NETCDF_CHUNK_ELEMS);
+  retval =
+    sc_MPI_Allreduce (&num_rounds, &num_rounds_max, 1, sc_MPI_INT,
+                      sc_MPI_MAX, comm);
+  SC_CHECK_MPI (retval);
+
   /* Counts the number of nodes */
   num_local_nodes = 0;
+  /* Counts the elements that were already written */
+  num_written = 0;
+  chunk_fill = 0;
+  rounds_done = 0;
   /* Iterate over all local trees and their respective elements */
   for (ltree_id = 0; ltree_id < num_local_trees; ltree_id++) {
     num_local_tree_elem = t8_forest_get_tree_num_elements (forest, ltree_id);
     tree_class = t8_forest_get_tree_class (forest, ltree_id);
-    /* Computing the local tree offest */
-    local_tree_offset = t8_forest_get_tree_element_offset (forest, ltree_id);
     /* Iterate over all local elements in the local tree */
     for (local_elem_id = 0; local_elem_id < num_local_tree_elem;
          local_elem_id++) {
@@ -481,31 +555,55 @@ t8_forest_write_netcdf_data (t8_forest_t forest,
         t8_forest_get_element_in_tree (forest, ltree_id, local_elem_id);
       /* Determine the element shape */
       element_shape = scheme->t8_element_shape (element);
-      /* Store the type of the element in its global index position */
-      Mesh_elem_types[(local_tree_offset + local_elem_id)] =
+      /* Store the type of the element in the chunk */
+      Mesh_elem_types[chunk_fill] =
         t8_element_shape_vtk_type (element_shape);
-      /* Store the elements tree_id in its global index position */
-      Mesh_elem_tree_id[(local_tree_offset + local_elem_id)] =
+      /* Store the elements tree_id in the chunk */
+      Mesh_elem_tree_id[chunk_fill] =
         t8_forest_global_tree_id (forest, ltree_id);
+      chunk_fill++;
       /* Adding the number of corners of this elements shape to the counter */
       num_local_nodes += t8_element_shape_num_vertices (element_shape);
+      if (chunk_fill == T8_FOREST_NETCDF_CHUNK_ELEMS) {
+        /* The chunk is full, stream it to the file */
+        start_ptr = (size_t) (first_local_elem_id + num_written);
+        count_ptr = (size_t) chunk_fill;
+        if ((retval =
+             nc_put_vara_int (context->ncid, context->var_elem_types_id,
+                              &start_ptr, &count_ptr, &Mesh_elem_types[0]))) {
+          ERR (retval);
+        }
+        if ((retval =
+             nc_put_vara_long (context->ncid, context->var_elem_tree_id,
+                               &start_ptr, &count_ptr,
+                               &Mesh_elem_tree_id[0]))) {
+          ERR (retval);
+        }
+        num_written += chunk_fill;
+        chunk_fill = 0;
+        rounds_done++;
+      }
     }
   }
-  /* Write the data in the corresponding NetCDF-variable. */
-  /* Fill the 'Mesh_elem_types'-variable. */
-  start_ptr = (size_t) first_local_elem_id;
-  count_ptr = (size_t) num_local_elements;
-  if ((retval =
-       nc_put_vara_int (context->ncid, context->var_elem_types_id, &start_ptr,
-                        &count_ptr, &Mesh_elem_types[0]))) {
-    ERR (retval);
-  }
-  /* Fill the 'Mesh_elem_tree_id'-variable. */
-  if ((retval =
-       nc_put_vara_long (context->ncid, context->var_elem_tree_id, &start_ptr,
-                         &count_ptr, &Mesh_elem_tree_id[0]))) {
-    ERR (retval);
+  /* Write the partially filled last chunk and as many empty hyperslabs
+   * as other processes still stream chunks. */
+  for (; rounds_done < num_rounds_max; rounds_done++) {
+    start_ptr = (size_t) (first_local_elem_id + num_written);
+    count_ptr = (size_t) chunk_fill;
+    if ((retval =
+         nc_put_vara_int (context->ncid, context->var_elem_types_id,
+                          &start_ptr, &count_ptr, &Mesh_elem_types[0]))) {
+      ERR (retval);
+    }
+    if ((retval =
+         nc_put_vara_long (context->ncid, context->var_elem_tree_id,
+                           &start_ptr, &count_ptr, &Mesh_elem_tree_id[0]))) {
+      ERR (retval);
+    }
+    num_written += chunk_fill;
+    chunk_fill = 0;
   }
+  T8_ASSERT (num_written == (t8_gloidx_t) num_local_elements);
   /* Free the allocated memory */
   T8_FREE (Mesh_elem_types);
   T8_FREE (Mesh_elem_tree_id);
@@ -524,6 +622,130 @@ t8_forest_write_netcdf_data (t8_forest_t forest,
 #endif
 }
 
+/* Decimated variant of t8_forest_write_netcdf_data. The element loop is
+ * replaced by a loop over the output cells of the decimation plan; the
+ * chunk streaming and the round padding for collective access are kept. */
+static void
+t8_forest_write_netcdf_data_decimated (t8_forest_t forest,
+                                       t8_forest_netcdf_context_t * context,
+                                       sc_MPI_Comm comm)
+{
+#if T8_WITH_NETCDF
+  t8_forest_decimation_plan_t *plan = context->plan;
+  t8_locidx_t         num_cells;
+  t8_locidx_t         icell;
+  t8_element_shape_t  element_shape;
+  t8_gloidx_t         num_local_nodes;
+  t8_gloidx_t         num_nodes;
+  t8_gloidx_t         num_written;
+  t8_locidx_t         chunk_fill;
+  int                *Mesh_elem_types;
+  t8_nc_int64_t      *Mesh_elem_tree_id;
+  int                 num_rounds, num_rounds_max, rounds_done;
+  size_t              start_ptr;
+  size_t              count_ptr;
+  int                 retval;
+
+  T8_ASSERT (plan != NULL);
+  num_cells = t8_forest_decimation_plan_num_cells (plan);
+
+  /* The staging buffers hold at most a chunk of output cells; the
+   * variables are written in several rounds. */
+  Mesh_elem_types = T8_ALLOC (int, T8_FOREST_NETCDF_CHUNK_ELEMS);
+  Mesh_elem_tree_id = T8_ALLOC (t8_nc_int64_t, T8_FOREST_NETCDF_CHUNK_ELEMS);
+
+  /* With collective mpi access every process has to take part in every
+   * write call, so all processes perform the maximum number of rounds
+   * and processes that ran out of cells write empty hyperslabs. */
+  num_rounds = (int) ((num_cells + T8_FOREST_NETCDF_CHUNK_ELEMS - 1)
+                      / T8_FOREST_NETCDF_CHUNK_ELEMS);
+  retval =
+    sc_MPI_Allreduce (&num_rounds, &num_rounds_max, 1, sc_MPI_INT,
+                      sc_MPI_MAX, comm);
+  SC_CHECK_MPI (retval);
+
+  num_local_nodes = 0;
+  num_written = 0;
+  chunk_fill = 0;
+  rounds_done = 0;
+  /* Iterate over the output cells of the plan */
+  for (icell = 0; icell < num_cells; icell++) {
+    const t8_forest_decimation_cell_t *cell =
+      t8_forest_decimation_plan_get_cell (plan, icell);
+    const t8_eclass_t   tree_class =
+      t8_forest_get_tree_class (forest, cell->ltreeid);
+    t8_eclass_scheme_c *scheme =
+      t8_forest_get_eclass_scheme (forest, tree_class);
+    const t8_element_t *element =
+      t8_forest_decimation_cell_element (plan, cell);
+
+    /* Determine the shape of the output element */
+    element_shape = scheme->t8_element_shape (element);
+    /* Store the type of the output cell in the chunk */
+    Mesh_elem_types[chunk_fill] = t8_element_shape_vtk_type (element_shape);
+    /* Store the cells tree_id in the chunk */
+    Mesh_elem_tree_id[chunk_fill] =
+      t8_forest_global_tree_id (forest, cell->ltreeid);
+    chunk_fill++;
+    /* Adding the number of corners of this cells shape to the counter */
+    num_local_nodes += t8_element_shape_num_vertices (element_shape);
+    if (chunk_fill == T8_FOREST_NETCDF_CHUNK_ELEMS) {
+      /* The chunk is full, stream it to the file */
+      start_ptr = (size_t) (plan->first_cell_id + num_written);
+      count_ptr = (size_t) chunk_fill;
+      if ((retval =
+           nc_put_vara_int (context->ncid, context->var_elem_types_id,
+                            &start_ptr, &count_ptr, &Mesh_elem_types[0]))) {
+        ERR (retval);
+      }
+      if ((retval =
+           nc_put_vara_long (context->ncid, context->var_elem_tree_id,
+                             &start_ptr, &count_ptr,
+                             &Mesh_elem_tree_id[0]))) {
+        ERR (retval);
+      }
+      num_written += chunk_fill;
+      chunk_fill = 0;
+      rounds_done++;
+    }
+  }
+  /* Write the partially filled last chunk and as many empty hyperslabs
+   * as other processes still stream chunks. */
+  for (; rounds_done < num_rounds_max; rounds_done++) {
+    start_ptr = (size_t) (plan->first_cell_id + num_written);
+    count_ptr = (size_t) chunk_fill;
+    if ((retval =
+         nc_put_vara_int (context->ncid, context->var_elem_types_id,
+                          &start_ptr, &count_ptr, &Mesh_elem_types[0]))) {
+      ERR (retval);
+    }
+    if ((retval =
+         nc_put_vara_long (context->ncid, context->var_elem_tree_id,
+                           &start_ptr, &count_ptr, &Mesh_elem_tree_id[0]))) {
+      ERR (retval);
+    }
+    num_written += chunk_fill;
+    chunk_fill = 0;
+  }
+  T8_ASSERT (num_written == (t8_gloidx_t) num_cells);
+  /* Free the allocated memory */
+  T8_FREE (Mesh_elem_types);
+  T8_FREE (Mesh_elem_tree_id);
+
+  /* Store the number of local nodes */
+  context->nMesh_local_node = num_local_nodes;
+  /* Gather the number of all global nodes */
+  retval =
+    sc_MPI_Allreduce (&num_local_nodes, &num_nodes, 1, T8_MPI_GLOIDX,
+                      sc_MPI_SUM, comm);
+  SC_CHECK_MPI (retval);
+
+  /* Store the 'nMesh_node' dimension */
+  context->nMesh_node = num_nodes;
+
+#endif
+}
+
 /* Define NetCDF-coordinate-dimension */
 static void
 t8_forest_write_netcdf_coordinate_dimension (t8_forest_netcdf_context_t
@@ -554,24 +776,13 @@ t8_forest_write_netcdf_coordinate_variables (t8_forest_netcdf_context_t
   int                 retval;
   if ((retval =
        nc_def_var (context->ncid, namespace_context->var_Mesh_node_x,
-                   NC_DOUBLE, 1, &context->nMesh_node_dimid,
-                   &context->var_node_x_id))) {
+                   (nc_type) context->coord_nc_type, 1,
+                   &context->nMesh_node_dimid, &context->var_node_x_id))) {
     ERR (retval);
   }
-  /* Define whether contiguous or chunked storage is used for the variable */
-  if ((retval =
-       nc_def_var_chunking (context->ncid, context->var_node_x_id,
-                            context->netcdf_var_storage_mode, NULL))) {
-    ERR (retval);
-  }
-  /* Define whether an independent or collective variable access is used */
-#if T8_WITH_NETCDF_PAR
-  if ((retval =
-       nc_var_par_access (context->ncid, context->var_node_x_id,
-                          context->netcdf_mpi_access))) {
-    ERR (retval);
-  }
-#endif
+  /* Apply the storage, chunking, compression and access hints */
+  t8_forest_write_netcdf_context_hints (context, context->var_node_x_id,
+                                        (size_t) context->nMesh_node, 1);
   /* Define standard_name attribute. */
   const char         *standard_node_x = "Longitude";
   if ((retval =
@@ -600,24 +811,13 @@ t8_forest_write_netcdf_coordinate_variables (t8_forest_netcdf_context_t
   /* Define the Mesh_node_y variable. */
   if ((retval =
        nc_def_var (context->ncid, namespace_context->var_Mesh_node_y,
-                   NC_DOUBLE, 1, &context->nMesh_node_dimid,
-                   &context->var_node_y_id))) {
-    ERR (retval);
-  }
-  /* Define whether contiguous or chunked storage is used for the variable */
-  if ((retval =
-       nc_def_var_chunking (context->ncid, context->var_node_y_id,
-                            context->netcdf_var_storage_mode, NULL))) {
-    ERR (retval);
-  }
-  /* Define whether an independent or collective variable access is used */
-#if T8_WITH_NETCDF_PAR
-  if ((retval =
-       nc_var_par_access (context->ncid, context->var_node_y_id,
-                          context->netcdf_mpi_access))) {
+                   (nc_type) context->coord_nc_type, 1,
+                   &context->nMesh_node_dimid, &context->var_node_y_id))) {
     ERR (retval);
   }
-#endif
+  /* Apply the storage, chunking, compression and access hints */
+  t8_forest_write_netcdf_context_hints (context, context->var_node_y_id,
+                                        (size_t) context->nMesh_node, 1);
   /* Define standard_name attribute. */
   const char         *standard_node_y = "Latitude";
   if ((retval =
@@ -646,24 +846,13 @@ t8_forest_write_netcdf_coordinate_variables (t8_forest_netcdf_context_t
   /* Define the Mesh_node_z variable. */
   if ((retval =
        nc_def_var (context->ncid, namespace_context->var_Mesh_node_z,
-                   NC_DOUBLE, 1, &context->nMesh_node_dimid,
-                   &context->var_node_z_id))) {
-    ERR (retval);
-  }
-  /* Define whether contiguous or chunked storage is used for the variable */
-  if ((retval =
-       nc_def_var_chunking (context->ncid, context->var_node_z_id,
-                            context->netcdf_var_storage_mode, NULL))) {
-    ERR (retval);
-  }
-  /* Define whether an independent or collective variable access is used */
-#if T8_WITH_NETCDF_PAR
-  if ((retval =
-       nc_var_par_access (context->ncid, context->var_node_z_id,
-                          context->netcdf_mpi_access))) {
+                   (nc_type) context->coord_nc_type, 1,
+                   &context->nMesh_node_dimid, &context->var_node_z_id))) {
     ERR (retval);
   }
-#endif
+  /* Apply the storage, chunking, compression and access hints */
+  t8_forest_write_netcdf_context_hints (context, context->var_node_z_id,
+                                        (size_t) context->nMesh_node, 1);
   /* Define standard_name attribute. */
   const char         *standard_node_z = "Height";
   if ((retval =
@@ -738,26 +927,30 @@ t8_forest_write_user_netcdf_vars (t8_forest_netcdf_context_t * context,
                          NC_DOUBLE, 1, &context->nMesh_elem_dimid,
                          &(ext_variables[i]->var_user_dimid)))) {
           ERR (retval);
-          break;
         }
-
-        /* Define whether contiguous or chunked storage is used for the variable */
-        if ((retval =
-             nc_def_var_chunking (context->ncid,
-                                  ext_variables[i]->var_user_dimid,
-                                  context->netcdf_var_storage_mode, NULL))) {
-          ERR (retval);
-        }
-        /* Define whether an independent or collective variable access is used */
-#if T8_WITH_NETCDF_PAR
-        if ((retval =
-             nc_var_par_access (context->ncid,
-                                ext_variables[i]->var_user_dimid,
-                                context->netcdf_mpi_access))) {
-          ERR (retval);
-        }
-#endif
+        break;
       }
+      /* Apply the storage, chunking, compression and access hints.
+       * Negative per-variable hints (and a chunksize of 0) inherit the
+       * file wide settings, see t8_netcdf_variable_set_hints. */
+      t8_forest_write_netcdf_apply_hints (context,
+                                          ext_variables[i]->var_user_dimid,
+                                          ext_variables[i]->var_storage_mode
+                                          >= 0
+                                          ? ext_variables[i]->var_storage_mode
+                                          : context->netcdf_var_storage_mode,
+                                          ext_variables[i]->var_chunksize > 0
+                                          ? ext_variables[i]->var_chunksize
+                                          : context->netcdf_var_chunksize,
+                                          ext_variables[i]->var_deflate_level
+                                          >= -1
+                                          ? ext_variables[i]->var_deflate_level
+                                          : context->netcdf_var_deflate_level,
+                                          ext_variables[i]->var_mpi_access
+                                          >= 0
+                                          ? ext_variables[i]->var_mpi_access
+                                          : context->netcdf_mpi_access,
+                                          (size_t) context->nMesh_elem, 1);
       /* Attach the user-defined 'long_name' attribute to the variable */
       if ((retval =
            nc_put_att_text (context->ncid, (ext_variables[i]->var_user_dimid),
@@ -780,6 +973,65 @@ t8_forest_write_user_netcdf_vars (t8_forest_netcdf_context_t * context,
 #endif
 }
 
+#if T8_WITH_NETCDF
+/* Stream one chunk of the connectivity and node coordinate data to the
+ * file. The chunk holds chunk_fill elements with chunk_nodes nodes;
+ * both may be zero for the empty hyperslabs of the round padding of
+ * collective writes. */
+static void
+t8_forest_write_netcdf_coordinate_chunk (t8_forest_netcdf_context_t *
+                                         context,
+                                         t8_gloidx_t first_local_elem_id,
+                                         size_t node_start,
+                                         t8_gloidx_t elems_written,
+                                         t8_gloidx_t nodes_written,
+                                         t8_locidx_t chunk_fill,
+                                         t8_gloidx_t chunk_nodes,
+                                         t8_nc_int64_t *Mesh_elem_nodes,
+                                         double *Mesh_node_x,
+                                         double *Mesh_node_y,
+                                         double *Mesh_node_z)
+{
+  /* Define a (2D) NetCDF-Hyperslab for filling the variable */
+  const size_t        start_ptr_var[2] =
+    { (size_t) (first_local_elem_id + elems_written), 0 };
+  const size_t        count_ptr_var[2] =
+    { (size_t) chunk_fill, (size_t) context->nMaxMesh_elem_nodes };
+  size_t              start_node;
+  size_t              count_node;
+  int                 retval;
+
+  /* Fill the 'Mesh_elem_node'-variable. */
+  if ((retval =
+       nc_put_vara_long (context->ncid, context->var_elem_nodes_id,
+                         start_ptr_var, count_ptr_var,
+                         &Mesh_elem_nodes[0]))) {
+    ERR (retval);
+  }
+  /* Fill the space coordinate variables */
+  start_node = node_start + (size_t) nodes_written;
+  count_node = (size_t) chunk_nodes;
+  /* Fill the 'Mesh_node_x'-variable. */
+  if ((retval =
+       nc_put_vara_double (context->ncid, context->var_node_x_id,
+                           &start_node, &count_node, &Mesh_node_x[0]))) {
+    ERR (retval);
+  }
+  /* Fill the 'Mesh_node_y'-variable. */
+  if ((retval =
+       nc_put_vara_double (context->ncid, context->var_node_y_id,
+                           &start_node, &count_node, &Mesh_node_y[0]))) {
+    ERR (retval);
+  }
+  /* Fill the 'Mesh_node_z'-variable. */
+  if ((retval =
+       nc_put_vara_double (context->ncid, context->var_node_z_id,
+                           &start_node, &count_node, &Mesh_node_z[0]))) {
+    ERR (retval);
+  }
+}
+#endif
+
 /* Write the netCDF coordinate data to he file */
 static void
 t8_forest_write_netcdf_coordinate_data (t8_forest_t forest,
@@ -794,23 +1046,24 @@ t8_forest_write_netcdf_coordinate_data (t8_forest_t forest,
   t8_locidx_t         num_local_elements;
   t8_locidx_t         num_local_tree_elem;
   t8_locidx_t         local_elem_id;
-  t8_locidx_t         local_tree_offset;
+  t8_locidx_t         chunk_fill;
   t8_element_t       *element;
   t8_element_shape_t  element_shape;
   t8_gloidx_t         first_local_elem_id;
-  size_t              num_elements;
+  t8_gloidx_t         elems_written;
+  t8_gloidx_t         nodes_written;
+  t8_gloidx_t         chunk_nodes;
   size_t              num_max_nodes_per_elem;
-  size_t              num_nodes;
+  size_t              max_chunk_nodes;
   t8_nc_int64_t      *Mesh_elem_nodes;
   double             *Mesh_node_x;
   double             *Mesh_node_y;
   double             *Mesh_node_z;
   t8_gloidx_t        *node_offset;
-  t8_gloidx_t         num_it = 0;
+  int                 num_rounds, num_rounds_max, rounds_done;
   int                 retval;
   int                 mpisize, mpirank;
   size_t              start_ptr = 0;
-  size_t              count_ptr;
   int                 i;
   int                 number_nodes;
 
@@ -842,28 +1095,50 @@ t8_forest_write_netcdf_coordinate_data (t8_forest_t forest,
     start_ptr += (size_t) node_offset[j];
   }
 
-  /* Allocate the Variable-data that will be put out in the NetCDF variables */
-  num_elements = (size_t) num_local_elements;
+  if (context->coord_quantize) {
+    /* Compute the quantization grid once per write; this call is
+     * collective over the forest communicator */
+    t8_forest_coordinate_quantization_grid (forest, context->coord_box_min,
+                                            context->coord_step);
+  }
+
+  /* Allocate the staging buffers for one chunk of elements. The node
+   * buffers are sized for the worst case of nMaxMesh_elem_nodes nodes
+   * per element, so the output memory is bounded independently of the
+   * local element count. */
   num_max_nodes_per_elem = (size_t) (context->nMaxMesh_elem_nodes);
-  num_nodes = (size_t) (context->nMesh_local_node);
+  max_chunk_nodes = T8_FOREST_NETCDF_CHUNK_ELEMS * num_max_nodes_per_elem;
 
-  Mesh_elem_nodes =
-    T8_ALLOC (t8_nc_int64_t, num_elements * num_max_nodes_per_elem);
-  Mesh_node_x = T8_ALLOC (double, num_nodes);
-  Mesh_node_y = T8_ALLOC (double, num_nodes);
-  Mesh_node_z = T8_ALLOC (double, num_nodes);
+  Mesh_elem_nodes = T8_ALLOC (t8_nc_int64_t, max_chunk_nodes);
+  Mesh_node_x = T8_ALLOC (double, max_chunk_nodes);
+  Mesh_node_y = T8_ALLOC (double, max_chunk_nodes);
+  Mesh_node_z = T8_ALLOC (double, max_chunk_nodes);
 
   /* Check if pointers are not NULL. */
   T8_ASSERT (Mesh_node_x != NULL && Mesh_node_y != NULL
              && Mesh_node_z != NULL && Mesh_elem_nodes != NULL);
 
+  /* With collective mpi access every process has to take part in every
+   * write call, so all processes perform the maximum number of rounds
+   * and processes that ran out of elements write empty hyperslabs. */
+  num_rounds =
+    (int) ((num_local_elements + T8_FOREST_NETCDF_CHUNK_ELEMS - 1)
+           / T8_FOREST_NETCDF_CHUNK_ELEMS);
+  retval =
+    sc_MPI_Allreduce (&num_rounds, &num_rounds_max, 1, sc_MPI_INT,
+                      sc_MPI_MAX, comm);
+  SC_CHECK_MPI (retval);
+
+  elems_written = 0;
+  nodes_written = 0;
+  chunk_fill = 0;
+  chunk_nodes = 0;
+  rounds_done = 0;
   /* Iterate over all local trees. */
   /* Corners should be stored in the same order as in a vtk-file (read that somewehere on a netcdf page). */
   for (ltree_id = 0; ltree_id < num_local_trees; ltree_id++) {
     num_local_tree_elem = t8_forest_get_tree_num_elements (forest, ltree_id);
     tree_class = t8_forest_get_tree_class (forest, ltree_id);
-    /* Computing the local tree offest */
-    local_tree_offset = t8_forest_get_tree_element_offset (forest, ltree_id);
 
     for (local_elem_id = 0; local_elem_id < num_local_tree_elem;
          local_elem_id++) {
@@ -881,61 +1156,247 @@ t8_forest_write_netcdf_coordinate_data (t8_forest_t forest,
       for (; i < number_nodes; i++) {
         t8_forest_element_coordinate (forest, ltree_id, element,
                                       t8_element_shape_vtk_corner_number ((int) element_shape, i), vertex_coords);
+        if (context->coord_quantize) {
+          /* Snap the coordinates to the quantization grid */
+          for (int idim = 0; idim < 3; idim++) {
+            if (context->coord_step[idim] > 0) {
+              vertex_coords[idim] = context->coord_box_min[idim]
+                + round ((vertex_coords[idim]
+                          - context->coord_box_min[idim])
+                         / context->coord_step[idim])
+                * context->coord_step[idim];
+            }
+          }
+        }
         /* Stores the x-, y- and z- coordinate of the nodes */
-        Mesh_node_x[num_it] = vertex_coords[0];
-        Mesh_node_y[num_it] = vertex_coords[1];
-        Mesh_node_z[num_it] = vertex_coords[2];
+        Mesh_node_x[chunk_nodes] = vertex_coords[0];
+        Mesh_node_y[chunk_nodes] = vertex_coords[1];
+        Mesh_node_z[chunk_nodes] = vertex_coords[2];
         /* Stores the the nodes which correspond to this element. */
-        Mesh_elem_nodes[(local_tree_offset +
-                         local_elem_id) * (context->nMaxMesh_elem_nodes) +
-                        i] = ((t8_gloidx_t) start_ptr) + num_it;
-        num_it++;
+        Mesh_elem_nodes[chunk_fill * (context->nMaxMesh_elem_nodes) + i] =
+          ((t8_gloidx_t) start_ptr) + nodes_written + chunk_nodes;
+        chunk_nodes++;
       }
       for (; i < context->nMaxMesh_elem_nodes; i++) {
         /* Fill the elements corresponding nodes, which remain empty, if it is an element having less than nMaxMesh_elem_nodes. */
-        Mesh_elem_nodes[(local_tree_offset +
-                         local_elem_id) * (context->nMaxMesh_elem_nodes) +
-                        i] = context->fillvalue64;
+        Mesh_elem_nodes[chunk_fill * (context->nMaxMesh_elem_nodes) + i] =
+          context->fillvalue64;
+      }
+      chunk_fill++;
+      if (chunk_fill == T8_FOREST_NETCDF_CHUNK_ELEMS) {
+        /* The chunk is full, stream it to the file */
+        t8_forest_write_netcdf_coordinate_chunk (context, first_local_elem_id,
+                                                 start_ptr, elems_written,
+                                                 nodes_written, chunk_fill,
+                                                 chunk_nodes, Mesh_elem_nodes,
+                                                 Mesh_node_x, Mesh_node_y,
+                                                 Mesh_node_z);
+        elems_written += chunk_fill;
+        nodes_written += chunk_nodes;
+        chunk_fill = 0;
+        chunk_nodes = 0;
+        rounds_done++;
       }
     }
   }
   /* Free allocated memory */
   T8_FREE (vertex_coords);
 
-  /* *Write the data into the NetCDF coordinate variables.* */
+  /* Write the partially filled last chunk and as many empty hyperslabs
+   * as other processes still stream chunks. */
+  for (; rounds_done < num_rounds_max; rounds_done++) {
+    t8_forest_write_netcdf_coordinate_chunk (context, first_local_elem_id,
+                                             start_ptr, elems_written,
+                                             nodes_written, chunk_fill,
+                                             chunk_nodes, Mesh_elem_nodes,
+                                             Mesh_node_x, Mesh_node_y,
+                                             Mesh_node_z);
+    elems_written += chunk_fill;
+    nodes_written += chunk_nodes;
+    chunk_fill = 0;
+    chunk_nodes = 0;
+  }
+  T8_ASSERT (elems_written == (t8_gloidx_t) num_local_elements);
+  T8_ASSERT (nodes_written == context->nMesh_local_node);
 
-  /* Define a (2D) NetCDF-Hyperslab for filling the variable */
-  const size_t        start_ptr_var[2] = { (size_t) first_local_elem_id, 0 };
-  const size_t        count_ptr_var[2] =
-    { num_elements, (size_t) context->nMaxMesh_elem_nodes };
-  /* Fill the 'Mesh_elem_node'-variable. */
-  if ((retval =
-       nc_put_vara_long (context->ncid, context->var_elem_nodes_id,
-                         start_ptr_var, count_ptr_var,
-                         &Mesh_elem_nodes[0]))) {
-    ERR (retval);
-  }
+  /* Free the allocated memory */
+  T8_FREE (node_offset);
+  T8_FREE (Mesh_node_x);
+  T8_FREE (Mesh_node_y);
+  T8_FREE (Mesh_node_z);
+  T8_FREE (Mesh_elem_nodes);
 
-  /* Fill the space coordinate variables */
-  count_ptr = (size_t) context->nMesh_local_node;
-  /* Fill the 'Mesh_node_x'-variable. */
-  if ((retval =
-       nc_put_vara_double (context->ncid, context->var_node_x_id, &start_ptr,
-                           &count_ptr, &Mesh_node_x[0]))) {
-    ERR (retval);
+#endif
+}
+
+/* Decimated variant of t8_forest_write_netcdf_coordinate_data. The node
+ * coordinates and the connectivity are taken from the output elements of
+ * the decimation plan, the chunk streaming stays unchanged. */
+static void
+t8_forest_write_netcdf_coordinate_data_decimated (t8_forest_t forest,
+                                                  t8_forest_netcdf_context_t
+                                                  * context,
+                                                  sc_MPI_Comm comm)
+{
+#if T8_WITH_NETCDF
+  double             *vertex_coords = T8_ALLOC (double, 3);
+  t8_forest_decimation_plan_t *plan = context->plan;
+  t8_locidx_t         num_cells;
+  t8_locidx_t         icell;
+  t8_locidx_t         chunk_fill;
+  t8_element_shape_t  element_shape;
+  t8_gloidx_t         cells_written;
+  t8_gloidx_t         nodes_written;
+  t8_gloidx_t         chunk_nodes;
+  size_t              num_max_nodes_per_elem;
+  size_t              max_chunk_nodes;
+  t8_nc_int64_t      *Mesh_elem_nodes;
+  double             *Mesh_node_x;
+  double             *Mesh_node_y;
+  double             *Mesh_node_z;
+  t8_gloidx_t        *node_offset;
+  int                 num_rounds, num_rounds_max, rounds_done;
+  int                 retval;
+  int                 mpisize, mpirank;
+  size_t              start_ptr = 0;
+  int                 i;
+  int                 number_nodes;
+
+  T8_ASSERT (plan != NULL);
+  num_cells = t8_forest_decimation_plan_num_cells (plan);
+
+  /* Get the size of the MPI_Comm and the process local rank */
+  retval = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (retval);
+  retval = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (retval);
+
+  /* Allocate memory for node offsets */
+  node_offset = T8_ALLOC (t8_gloidx_t, mpisize);
+
+  /* Get the number of all nodes local to each rank */
+  retval =
+    sc_MPI_Allgather (&context->nMesh_local_node, 1, T8_MPI_GLOIDX,
+                      node_offset, 1, T8_MPI_GLOIDX, comm);
+  SC_CHECK_MPI (retval);
+  /* Calculate the global number of output nodes on the previous ranks */
+  for (int j = 0; j < mpirank; j++) {
+    start_ptr += (size_t) node_offset[j];
   }
-  /* Fill the 'Mesh_node_y'-variable. */
-  if ((retval =
-       nc_put_vara_double (context->ncid, context->var_node_y_id, &start_ptr,
-                           &count_ptr, &Mesh_node_y[0]))) {
-    ERR (retval);
+
+  if (context->coord_quantize) {
+    /* Compute the quantization grid once per write; this call is
+     * collective over the forest communicator */
+    t8_forest_coordinate_quantization_grid (forest, context->coord_box_min,
+                                            context->coord_step);
   }
-  /* Fill the 'Mesh_node_z'-variable. */
-  if ((retval =
-       nc_put_vara_double (context->ncid, context->var_node_z_id, &start_ptr,
-                           &count_ptr, &Mesh_node_z[0]))) {
-    ERR (retval);
+
+  /* Allocate the staging buffers for one chunk of output cells. */
+  num_max_nodes_per_elem = (size_t) (context->nMaxMesh_elem_nodes);
+  max_chunk_nodes = T8_FOREST_NETCDF_CHUNK_ELEMS * num_max_nodes_per_elem;
+
+  Mesh_elem_nodes = T8_ALLOC (t8_nc_int64_t, max_chunk_nodes);
+  Mesh_node_x = T8_ALLOC (double, max_chunk_nodes);
+  Mesh_node_y = T8_ALLOC (double, max_chunk_nodes);
+  Mesh_node_z = T8_ALLOC (double, max_chunk_nodes);
+
+  /* With collective mpi access every process has to take part in every
+   * write call, so all processes perform the maximum number of rounds
+   * and processes that ran out of cells write empty hyperslabs. */
+  num_rounds =
+    (int) ((num_cells + T8_FOREST_NETCDF_CHUNK_ELEMS - 1)
+           / T8_FOREST_NETCDF_CHUNK_ELEMS);
+  retval =
+    sc_MPI_Allreduce (&num_rounds, &num_rounds_max, 1, sc_MPI_INT,
+                      sc_MPI_MAX, comm);
+  SC_CHECK_MPI (retval);
+
+  cells_written = 0;
+  nodes_written = 0;
+  chunk_fill = 0;
+  chunk_nodes = 0;
+  rounds_done = 0;
+  /* Iterate over the output cells of the plan. Corners are stored in the
+   * same order as in a vtk-file, as in the full resolution writer. */
+  for (icell = 0; icell < num_cells; icell++) {
+    const t8_forest_decimation_cell_t *cell =
+      t8_forest_decimation_plan_get_cell (plan, icell);
+    const t8_eclass_t   tree_class =
+      t8_forest_get_tree_class (forest, cell->ltreeid);
+    t8_eclass_scheme_c *scheme =
+      t8_forest_get_eclass_scheme (forest, tree_class);
+    const t8_element_t *element =
+      t8_forest_decimation_cell_element (plan, cell);
+
+    /* Determine the shape of the output element */
+    element_shape = scheme->t8_element_shape (element);
+    /* Get the number of nodes for this cells shape */
+    number_nodes = t8_element_shape_num_vertices (element_shape);
+    i = 0;
+    for (; i < number_nodes; i++) {
+      t8_forest_element_coordinate (forest, cell->ltreeid, element,
+                                    t8_element_shape_vtk_corner_number ((int) element_shape, i), vertex_coords);
+      if (context->coord_quantize) {
+        /* Snap the coordinates to the quantization grid */
+        for (int idim = 0; idim < 3; idim++) {
+          if (context->coord_step[idim] > 0) {
+            vertex_coords[idim] = context->coord_box_min[idim]
+              + round ((vertex_coords[idim]
+                        - context->coord_box_min[idim])
+                       / context->coord_step[idim])
+              * context->coord_step[idim];
+          }
+        }
+      }
+      /* Stores the x-, y- and z- coordinate of the nodes */
+      Mesh_node_x[chunk_nodes] = vertex_coords[0];
+      Mesh_node_y[chunk_nodes] = vertex_coords[1];
+      Mesh_node_z[chunk_nodes] = vertex_coords[2];
+      /* Stores the the nodes which correspond to this cell. */
+      Mesh_elem_nodes[chunk_fill * (context->nMaxMesh_elem_nodes) + i] =
+        ((t8_gloidx_t) start_ptr) + nodes_written + chunk_nodes;
+      chunk_nodes++;
+    }
+    for (; i < context->nMaxMesh_elem_nodes; i++) {
+      /* Fill the cells corresponding nodes, which remain empty, if it is a cell having less than nMaxMesh_elem_nodes. */
+      Mesh_elem_nodes[chunk_fill * (context->nMaxMesh_elem_nodes) + i] =
+        context->fillvalue64;
+    }
+    chunk_fill++;
+    if (chunk_fill == T8_FOREST_NETCDF_CHUNK_ELEMS) {
+      /* The chunk is full, stream it to the file */
+      t8_forest_write_netcdf_coordinate_chunk (context, plan->first_cell_id,
+                                               start_ptr, cells_written,
+                                               nodes_written, chunk_fill,
+                                               chunk_nodes, Mesh_elem_nodes,
+                                               Mesh_node_x, Mesh_node_y,
+                                               Mesh_node_z);
+      cells_written += chunk_fill;
+      nodes_written += chunk_nodes;
+      chunk_fill = 0;
+      chunk_nodes = 0;
+      rounds_done++;
+    }
   }
+  /* Free allocated memory */
+  T8_FREE (vertex_coords);
+
+  /* Write the partially filled last chunk and as many empty hyperslabs
+   * as other processes still stream chunks. */
+  for (; rounds_done < num_rounds_max; rounds_done++) {
+    t8_forest_write_netcdf_coordinate_chunk (context, plan->first_cell_id,
+                                             start_ptr, cells_written,
+                                             nodes_written, chunk_fill,
+                                             chunk_nodes, Mesh_elem_nodes,
+                                             Mesh_node_x, Mesh_node_y,
+                                             Mesh_node_z);
+    cells_written += chunk_fill;
+    nodes_written += chunk_nodes;
+    chunk_fill = 0;
+    chunk_nodes = 0;
+  }
+  T8_ASSERT (cells_written == (t8_gloidx_t) num_cells);
+  T8_ASSERT (nodes_written == context->nMesh_local_node);
 
   /* Free the allocated memory */
   T8_FREE (node_offset);
@@ -1014,6 +1475,175 @@ t8_forest_write_user_netcdf_data (t8_forest_t forest,
 #endif
 }
 
+/* Decimated variant of t8_forest_write_user_netcdf_data. The variables
+ * still hold one value per forest element at full resolution; for every
+ * output cell the values of its member elements are reduced with the
+ * contexts reduction function. Integer variables can not be reduced
+ * meaningfully, so an aggregated output cell takes the value of its
+ * first member element. The variables are streamed chunkwise like the
+ * mesh data, with round padding for collective access. */
+static void
+t8_forest_write_user_netcdf_data_decimated (t8_forest_t forest,
+                                            t8_forest_netcdf_context_t
+                                            * context,
+                                            int num_extern_netcdf_vars,
+                                            t8_netcdf_variable_t *
+                                            ext_variables[], sc_MPI_Comm comm)
+{
+#if T8_WITH_NETCDF
+  if (num_extern_netcdf_vars > 0 && ext_variables != NULL) {
+    t8_forest_decimation_plan_t *plan = context->plan;
+    const t8_locidx_t   num_cells =
+      t8_forest_decimation_plan_num_cells (plan);
+    t8_locidx_t         icell;
+    t8_locidx_t         chunk_fill;
+    t8_gloidx_t         num_written;
+    t8_nc_int32_t      *chunk_int32;
+    t8_nc_int64_t      *chunk_int64;
+    double             *chunk_double;
+    int                 num_rounds, num_rounds_max, rounds_done;
+    size_t              start_ptr;
+    size_t              count_ptr;
+    int                 retval;
+    int                 i;
+
+    T8_ASSERT (plan != NULL);
+
+    /* The staging buffers hold at most a chunk of output cells */
+    chunk_int32 = T8_ALLOC (t8_nc_int32_t, T8_FOREST_NETCDF_CHUNK_ELEMS);
+    chunk_int64 = T8_ALLOC (t8_nc_int64_t, T8_FOREST_NETCDF_CHUNK_ELEMS);
+    chunk_double = T8_ALLOC (double, T8_FOREST_NETCDF_CHUNK_ELEMS);
+
+    /* With collective mpi access every process has to take part in every
+     * write call, so all processes perform the maximum number of rounds
+     * and processes that ran out of cells write empty hyperslabs. */
+    num_rounds = (int) ((num_cells + T8_FOREST_NETCDF_CHUNK_ELEMS - 1)
+                        / T8_FOREST_NETCDF_CHUNK_ELEMS);
+    retval =
+      sc_MPI_Allreduce (&num_rounds, &num_rounds_max, 1, sc_MPI_INT,
+                        sc_MPI_MAX, comm);
+    SC_CHECK_MPI (retval);
+
+    /* Iterate over the amount of user-defined variables */
+    for (i = 0; i < num_extern_netcdf_vars; i++) {
+
+      /* Check if exactly one value per forest element is given */
+      T8_ASSERT ((size_t) t8_forest_get_local_num_elements (forest)
+                 == ext_variables[i]->var_user_data->elem_count);
+
+      num_written = 0;
+      chunk_fill = 0;
+      rounds_done = 0;
+      for (icell = 0; icell < num_cells; icell++) {
+        const t8_forest_decimation_cell_t *cell =
+          t8_forest_decimation_plan_get_cell (plan, icell);
+        const t8_locidx_t   first_elem =
+          t8_forest_get_tree_element_offset (forest, cell->ltreeid)
+          + cell->first;
+
+        /* Check the variable data type */
+        switch (ext_variables[i]->datatype) {
+        case T8_NETCDF_INT:
+          chunk_int32[chunk_fill] = *(t8_nc_int32_t *)
+            sc_array_index (ext_variables[i]->var_user_data,
+                            (size_t) first_elem);
+          break;
+        case T8_NETCDF_INT64:
+          chunk_int64[chunk_fill] = *(t8_nc_int64_t *)
+            sc_array_index (ext_variables[i]->var_user_data,
+                            (size_t) first_elem);
+          break;
+        case T8_NETCDF_DOUBLE:
+          chunk_double[chunk_fill] =
+            t8_forest_decimation_reduce_cell (plan, icell, (const double *)
+                                              sc_array_index (ext_variables
+                                                              [i]->var_user_data,
+                                                              0), 1, 0,
+                                              context->reduce_fn,
+                                              context->reduce_user_data);
+          break;
+        }
+        chunk_fill++;
+        if (chunk_fill == T8_FOREST_NETCDF_CHUNK_ELEMS) {
+          /* The chunk is full, stream it to the file */
+          start_ptr = (size_t) (plan->first_cell_id + num_written);
+          count_ptr = (size_t) chunk_fill;
+          switch (ext_variables[i]->datatype) {
+          case T8_NETCDF_INT:
+            if ((retval =
+                 nc_put_vara_int (context->ncid,
+                                  ext_variables[i]->var_user_dimid,
+                                  &start_ptr, &count_ptr, chunk_int32))) {
+              ERR (retval);
+            }
+            break;
+          case T8_NETCDF_INT64:
+            if ((retval =
+                 nc_put_vara_long (context->ncid,
+                                   ext_variables[i]->var_user_dimid,
+                                   &start_ptr, &count_ptr, chunk_int64))) {
+              ERR (retval);
+            }
+            break;
+          case T8_NETCDF_DOUBLE:
+            if ((retval =
+                 nc_put_vara_double (context->ncid,
+                                     ext_variables[i]->var_user_dimid,
+                                     &start_ptr, &count_ptr,
+                                     chunk_double))) {
+              ERR (retval);
+            }
+            break;
+          }
+          num_written += chunk_fill;
+          chunk_fill = 0;
+          rounds_done++;
+        }
+      }
+      /* Write the partially filled last chunk and as many empty
+       * hyperslabs as other processes still stream chunks. */
+      for (; rounds_done < num_rounds_max; rounds_done++) {
+        start_ptr = (size_t) (plan->first_cell_id + num_written);
+        count_ptr = (size_t) chunk_fill;
+        switch (ext_variables[i]->datatype) {
+        case T8_NETCDF_INT:
+          if ((retval =
+               nc_put_vara_int (context->ncid,
+                                ext_variables[i]->var_user_dimid, &start_ptr,
+                                &count_ptr, chunk_int32))) {
+            ERR (retval);
+          }
+          break;
+        case T8_NETCDF_INT64:
+          if ((retval =
+               nc_put_vara_long (context->ncid,
+                                 ext_variables[i]->var_user_dimid, &start_ptr,
+                                 &count_ptr, chunk_int64))) {
+            ERR (retval);
+          }
+          break;
+        case T8_NETCDF_DOUBLE:
+          if ((retval =
+               nc_put_vara_double (context->ncid,
+                                   ext_variables[i]->var_user_dimid,
+                                   &start_ptr, &count_ptr, chunk_double))) {
+            ERR (retval);
+          }
+          break;
+        }
+        num_written += chunk_fill;
+        chunk_fill = 0;
+      }
+      T8_ASSERT (num_written == (t8_gloidx_t) num_cells);
+    }
+    /* Free the staging buffers */
+    T8_FREE (chunk_int32);
+    T8_FREE (chunk_int64);
+    T8_FREE (chunk_double);
+  }
+#endif
+}
+
 /* Function that creates the NetCDF-File and fills it  */
 static void
 t8_forest_write_netcdf_file (t8_forest_t forest,
@@ -1034,8 +1664,10 @@ t8_forest_write_netcdf_file (t8_forest_t forest,
   /* Get the number of global elements in the forest. */
   num_glo_elem = t8_forest_get_global_num_elements (forest);
 
-  /* Assign global number of elements. */
-  context->nMesh_elem = num_glo_elem;
+  /* Assign global number of elements; for a decimated write this is the
+   * global number of output cells of the plan. */
+  context->nMesh_elem = context->plan != NULL
+    ? context->plan->global_num_cells : num_glo_elem;
 
   /* Create a parallel NetCDF-File (NetCDF-4/HDF5 file) */
   /* NC_MPIIO seems to be redundant since NetCDF version 4.6.2 */
@@ -1090,7 +1722,12 @@ t8_forest_write_netcdf_file (t8_forest_t forest,
 #endif
 
   /* Fill the already defined NetCDF-variables and calculate the 'nMesh_node' (global number of nodes) -dimension */
-  t8_forest_write_netcdf_data (forest, context, comm);
+  if (context->plan != NULL) {
+    t8_forest_write_netcdf_data_decimated (forest, context, comm);
+  }
+  else {
+    t8_forest_write_netcdf_data (forest, context, comm);
+  }
 
   /* Leave the NetCDF-data-mode and re-enter the define-mode. */
 #if T8_WITH_NETCDF
@@ -1124,11 +1761,24 @@ t8_forest_write_netcdf_file (t8_forest_t forest,
 #endif
 
   /* Write the NetCDF-coordinate variable data */
-  t8_forest_write_netcdf_coordinate_data (forest, context, comm);
+  if (context->plan != NULL) {
+    t8_forest_write_netcdf_coordinate_data_decimated (forest, context, comm);
+  }
+  else {
+    t8_forest_write_netcdf_coordinate_data (forest, context, comm);
+  }
 
   /* Eventually write user-defined variable data */
-  t8_forest_write_user_netcdf_data (forest, context, num_extern_netcdf_vars,
-                                    ext_variables, comm);
+  if (context->plan != NULL) {
+    t8_forest_write_user_netcdf_data_decimated (forest, context,
+                                                num_extern_netcdf_vars,
+                                                ext_variables, comm);
+  }
+  else {
+    t8_forest_write_user_netcdf_data (forest, context,
+                                      num_extern_netcdf_vars, ext_variables,
+                                      comm);
+  }
 
   /* All data has been written to the NetCDF-file, therefore, close the file. */
 #if T8_WITH_NETCDF
@@ -1142,14 +1792,22 @@ t8_forest_write_netcdf_file (t8_forest_t forest,
 #endif
 }
 
-/* Function that gets called if a forest schould be written in NetCDF-Format. This function is somehow an extended version which allows the user to decide if contiguous or chunked storage should used and whether the MPI ranks write independetly or collectively. */
-void
-t8_forest_write_netcdf_ext (t8_forest_t forest, const char *file_prefix,
+/* Internal version of t8_forest_write_netcdf_ext2 that additionally
+ * takes an optional decimation plan and the reduction of the aggregated
+ * variable data, \see t8_forest_write_netcdf_decimated. A NULL plan
+ * yields the full resolution write. */
+static void
+t8_forest_write_netcdf_int (t8_forest_t forest, const char *file_prefix,
                             const char *file_title, int dim,
                             int num_extern_netcdf_vars,
                             t8_netcdf_variable_t * ext_variables[],
                             sc_MPI_Comm comm, int netcdf_var_storage_mode,
-                            int netcdf_mpi_access)
+                            size_t netcdf_var_chunksize,
+                            int netcdf_var_deflate_level,
+                            int netcdf_mpi_access,
+                            t8_forest_decimation_plan_t * plan,
+                            t8_forest_reduce_fn reduce_fn,
+                            void *reduce_user_data)
 {
   t8_forest_netcdf_context_t context;
   /* Check whether pointers are not NULL */
@@ -1200,6 +1858,10 @@ t8_forest_write_netcdf_ext (t8_forest_t forest, const char *file_prefix,
   context.fillvalue64 = -1;
   context.start_index = 0;
   context.convention = "UGRID v1.0";
+  /* An optional decimation plan selects the down sampled write path */
+  context.plan = plan;
+  context.reduce_fn = reduce_fn;
+  context.reduce_user_data = reduce_user_data;
 
 #if T8_WITH_NETCDF
   /* Check the given 'netcdf_storage_mode' */
@@ -1212,6 +1874,28 @@ t8_forest_write_netcdf_ext (t8_forest_t forest, const char *file_prefix,
   else {
     context.netcdf_var_storage_mode = netcdf_var_storage_mode;
   }
+  /* The chunk size is only used with NC_CHUNKED, a value of 0 leaves
+   * the chunk shapes to the netCDF default */
+  context.netcdf_var_chunksize = netcdf_var_chunksize;
+  /* The coordinate precision selected on the forest. With reduced
+   * precision the node coordinate variables are defined as NC_FLOAT,
+   * which halves their file blocks; quantization additionally snaps the
+   * values to a grid over the coarse mesh bounding box. */
+  context.coord_nc_type =
+    t8_forest_get_coordinate_precision (forest, NULL)
+    == T8_COORD_PRECISION_FLOAT64 ? NC_DOUBLE : NC_FLOAT;
+  context.coord_quantize =
+    t8_forest_get_coordinate_precision (forest, NULL)
+    == T8_COORD_PRECISION_QUANTIZED;
+  /* Check the given 'netcdf_var_deflate_level' */
+  if (netcdf_var_deflate_level < -1 || netcdf_var_deflate_level > 9) {
+    t8_global_productionf
+      ("Illegal input parameter for the deflate-level (-1 disables compression, valid levels are 0 - 9) was given.\nTherefore, compression will be disabled.\n");
+    context.netcdf_var_deflate_level = -1;
+  }
+  else {
+    context.netcdf_var_deflate_level = netcdf_var_deflate_level;
+  }
 #endif
 #if T8_WITH_NETCDF_PAR
   /* Check the given 'netcdf_mpi_access' */
@@ -1242,6 +1926,70 @@ t8_forest_write_netcdf_ext (t8_forest_t forest, const char *file_prefix,
   }
 }
 
+/* Function that gets called if a forest schould be written in NetCDF-Format. This function is a further extended version which additionally allows the user to prescribe the chunk size and a zlib deflate level for the variables. */
+void
+t8_forest_write_netcdf_ext2 (t8_forest_t forest, const char *file_prefix,
+                             const char *file_title, int dim,
+                             int num_extern_netcdf_vars,
+                             t8_netcdf_variable_t * ext_variables[],
+                             sc_MPI_Comm comm, int netcdf_var_storage_mode,
+                             size_t netcdf_var_chunksize,
+                             int netcdf_var_deflate_level,
+                             int netcdf_mpi_access)
+{
+  /* A full resolution write without a decimation plan */
+  t8_forest_write_netcdf_int (forest, file_prefix, file_title, dim,
+                              num_extern_netcdf_vars, ext_variables, comm,
+                              netcdf_var_storage_mode, netcdf_var_chunksize,
+                              netcdf_var_deflate_level, netcdf_mpi_access,
+                              NULL, NULL, NULL);
+}
+
+/* Writes a down sampled view of the forest in the netCDF format,
+ * \see t8_forest_decimation_plan_new for the decimation semantics. */
+void
+t8_forest_write_netcdf_decimated (t8_forest_t forest,
+                                  const char *file_prefix,
+                                  const char *file_title, int dim,
+                                  int num_extern_netcdf_vars,
+                                  t8_netcdf_variable_t * ext_variables[],
+                                  sc_MPI_Comm comm, int max_level,
+                                  const double *box_min,
+                                  const double *box_max,
+                                  t8_forest_reduce_fn reduce_fn,
+                                  void *reduce_user_data)
+{
+  t8_forest_decimation_plan_t *plan;
+
+  /* Build the down sampled view; this call is collective */
+  plan = t8_forest_decimation_plan_new (forest, max_level, box_min, box_max);
+
+  /* Write with the default storage and access hints of
+   * t8_forest_write_netcdf */
+  t8_forest_write_netcdf_int (forest, file_prefix, file_title, dim,
+                              num_extern_netcdf_vars, ext_variables, comm,
+                              NC_CONTIGUOUS, 0, -1, NC_INDEPENDENT,
+                              plan, reduce_fn, reduce_user_data);
+
+  t8_forest_decimation_plan_destroy (&plan);
+}
+
+/* Function that gets called if a forest schould be written in NetCDF-Format. This function is somehow an extended version which allows the user to decide if contiguous or chunked storage should used and whether the MPI ranks write independetly or collectively. */
+void
+t8_forest_write_netcdf_ext (t8_forest_t forest, const char *file_prefix,
+                            const char *file_title, int dim,
+                            int num_extern_netcdf_vars,
+                            t8_netcdf_variable_t * ext_variables[],
+                            sc_MPI_Comm comm, int netcdf_var_storage_mode,
+                            int netcdf_mpi_access)
+{
+  /* Use the netCDF default chunk shapes and no compression */
+  t8_forest_write_netcdf_ext2 (forest, file_prefix, file_title, dim,
+                               num_extern_netcdf_vars, ext_variables, comm,
+                               netcdf_var_storage_mode, 0, -1,
+                               netcdf_mpi_access);
+}
+
 /* Function which writes out the forest in the netCDF format, this function calls the extended method with given default values (e.g. NC_CONTIGUOUS and NC_INDEPENDENT) for storage and MPI access for variables */
 void
 t8_forest_write_netcdf (t8_forest_t forest, const char *file_prefix,
@@ -26,6 +26,8 @@
 #include <t8_forest/t8_forest_general.h>
 #include <t8_cmesh/t8_cmesh_offset.h>
 #include <t8_element_cxx.hxx>
+#include <t8_mpi_profile.h>
+#include <t8_progress.h>
 
 /* We want to export the whole implementation to be callable from "C" */
 T8_EXTERN_C_BEGIN ();
@@ -40,6 +42,32 @@ typedef struct
   t8_locidx_t         num_elements;     /* The number of elements from this tree that were sent */
 } t8_forest_partition_tree_info_t;
 
+/* In the zero-copy send path we do not stage a tree's elements in the send
+ * buffer. Instead we record one pointer/length pair per tree that points
+ * into the existing element array and build an MPI derived datatype over
+ * these blocks. */
+typedef struct
+{
+  void               *data;     /* Start of a contiguous element block */
+  int                 num_bytes;        /* Length of the block in bytes */
+} t8_forest_partition_block_t;
+
+/* The state of a split-phase data partition between
+ * t8_forest_partition_data_begin and t8_forest_partition_data_end.
+ * It keeps the posted send requests and their buffers alive while the
+ * caller overlaps computation with the transfer. */
+struct t8_forest_partition_data_handle
+{
+  t8_forest_t         forest_from;      /* The forest of the old partition */
+  t8_forest_t         forest_to;        /* The forest of the new partition */
+  sc_array_t         *data_out; /* The output data array */
+  sc_MPI_Request     *requests; /* The posted send requests */
+  int                 num_request_alloc;        /* The count of elements in the request array */
+  char              **send_buffer;      /* The buffers of the posted sends */
+  char               *sent_to_self;     /* The message to ourselves, or NULL */
+  size_t              byte_to_self;     /* The byte count of the message to ourselves */
+};
+
 /* Given the element offset array and a rank, return the first
  * local element id of this rank */
 static t8_gloidx_t
@@ -56,6 +84,54 @@ t8_forest_partition_last_element (const t8_gloidx_t *offset, int rank)
   return offset[rank + 1] - 1;
 }
 
+/* Evaluate the offset that the unweighted partition assigns to a rank
+ * without storing an offset array.
+ * This formula must match the one in
+ * \ref t8_forest_partition_compute_new_offset bit for bit, hence the
+ * identical floating point expression. */
+static t8_gloidx_t
+t8_forest_partition_uniform_offset (int rank, int mpisize,
+                                    t8_gloidx_t global_num_elements)
+{
+  T8_ASSERT (0 <= rank && rank <= mpisize);
+  if (rank == mpisize) {
+    return global_num_elements;
+  }
+  /* We convert to doubles to prevent overflow */
+  return (t8_gloidx_t) (((double) rank *
+                         (long double) global_num_elements) /
+                        (double) mpisize);
+}
+
+/* Find the owner of a global element id in the unweighted partition by
+ * binary search over the closed-form offsets. Needs no offset array and
+ * no communication. Ranks with empty element ranges share their offset
+ * with the next rank and are thus never returned. */
+static int
+t8_forest_partition_uniform_owner (t8_gloidx_t gelement, int mpisize,
+                                   t8_gloidx_t global_num_elements)
+{
+  int                 low, high, guess;
+
+  T8_ASSERT (0 <= gelement && gelement < global_num_elements);
+  /* Search for the largest rank whose offset is less or equal to
+   * gelement. Its range then contains gelement. */
+  low = 0;
+  high = mpisize - 1;
+  while (low < high) {
+    guess = (low + high + 1) / 2;
+    if (t8_forest_partition_uniform_offset (guess, mpisize,
+                                            global_num_elements)
+        <= gelement) {
+      low = guess;
+    }
+    else {
+      high = guess - 1;
+    }
+  }
+  return low;
+}
+
 /* Query whether a given process is assigned no elements in
  * an offset array */
 static int
@@ -81,7 +157,7 @@ t8_forest_compute_first_local_element_id (t8_forest_t forest)
   /* MPI Scan over local_num_elements lead the global index of the first
    * local element */
   sc_MPI_Scan (&local_num_elements, &first_element, 1, T8_MPI_GLOIDX,
-               sc_MPI_SUM, forest->mpicomm);
+               sc_MPI_SUM, t8_forest_comm_for_partition (forest));
   /* MPI_Scan is inklusive, thus it counts our own data.
    * Therefore, we have to subtract it again */
   first_element -= local_num_elements;
@@ -95,21 +171,42 @@ t8_forest_compute_first_local_element_id (t8_forest_t forest)
 void
 t8_forest_partition_create_offsets (t8_forest_t forest)
 {
-  sc_MPI_Comm         comm;
   t8_gloidx_t         first_local_element;
 
   T8_ASSERT (t8_forest_is_committed (forest));
 
   T8_ASSERT (forest->element_offsets == NULL);
   t8_debugf ("Building offsets for forest %p\n", (void *) forest);
-  comm = forest->mpicomm;
-  /* Set the shmem array type of comm */
-  t8_shmem_init (comm);
-  t8_shmem_set_type (comm, T8_SHMEM_BEST_TYPE);
   /* Initialize the offset array as a shmem array
    * holding mpisize+1 many t8_gloidx_t */
-  t8_shmem_array_init (&forest->element_offsets, sizeof (t8_gloidx_t),
-                       forest->mpisize + 1, comm);
+  t8_forest_shmem_array_init (forest, &forest->element_offsets,
+                              sizeof (t8_gloidx_t), forest->mpisize + 1);
+  if (forest->partition_is_uniform) {
+    /* The partition follows the closed-form offsets of the unweighted
+     * partition routine, so every process can fill the table locally
+     * and we skip the allgather. */
+    if (t8_shmem_array_start_writing (forest->element_offsets)) {
+      t8_gloidx_t        *element_offsets =
+        t8_shmem_array_get_gloidx_array_for_writing
+        (forest->element_offsets);
+      int                 i;
+      for (i = 0; i < forest->mpisize; i++) {
+        element_offsets[i] =
+          t8_forest_partition_uniform_offset (i, forest->mpisize,
+                                              forest->global_num_elements);
+      }
+      element_offsets[forest->mpisize] = forest->global_num_elements;
+    }
+    t8_shmem_array_end_writing (forest->element_offsets);
+#ifdef T8_ENABLE_DEBUG
+    /* Verify the closed form against the actual first local element */
+    T8_ASSERT (t8_forest_partition_uniform_offset
+               (forest->mpirank, forest->mpisize,
+                forest->global_num_elements)
+               == t8_forest_compute_first_local_element_id (forest));
+#endif
+    return;
+  }
   /* Calculate the global index of the first local element */
   first_local_element = t8_forest_compute_first_local_element_id (forest);
 
@@ -123,6 +220,172 @@ t8_forest_partition_create_offsets (t8_forest_t forest)
   t8_shmem_array_end_writing (forest->element_offsets);
 }
 
+/* One entry of the node offset array. The entries describe consecutive
+ * blocks of the element offset array, one block per compute node, plus
+ * one closing entry with first_rank == mpisize. */
+typedef struct t8_forest_node_offset
+{
+  t8_gloidx_t         first_element;    /* global index of the first element of the block */
+  t8_gloidx_t         first_rank;       /* first rank of the block */
+} t8_forest_node_offset_t;
+
+void
+t8_forest_partition_create_node_offsets (t8_forest_t forest)
+{
+  sc_MPI_Comm         intranode, internode;
+  const t8_gloidx_t  *element_offsets;
+  t8_forest_node_offset_t *gathered, *entries;
+  int                 intra_rank, intra_size, inter_size;
+  int                 num_nodes, inode, block_first, block_check;
+  int                 contiguous, mpiret;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (forest->node_offsets == NULL);
+  if (forest->element_offsets == NULL) {
+    t8_forest_partition_create_offsets (forest);
+  }
+
+  /* Query the node split of the communicator. Without one - no MPI or
+   * shared memory support - all ranks form a single block and the two
+   * level lookup degenerates to the flat binary search. */
+  t8_shmem_init (forest->mpicomm);
+  sc_mpi_comm_get_node_comms (forest->mpicomm, &intranode, &internode);
+  block_first = 0;
+  intra_rank = 0;
+  intra_size = forest->mpisize;
+  inter_size = 1;
+  contiguous = intranode != sc_MPI_COMM_NULL && internode != sc_MPI_COMM_NULL;
+  if (contiguous) {
+    mpiret = sc_MPI_Comm_rank (intranode, &intra_rank);
+    SC_CHECK_MPI (mpiret);
+    mpiret = sc_MPI_Comm_size (intranode, &intra_size);
+    SC_CHECK_MPI (mpiret);
+    /* The block of this node starts at the rank of its intranode root.
+     * The blocks tile the communicator if and only if the ranks of every
+     * node are consecutive; all processes must agree on the outcome. */
+    block_first = forest->mpirank - intra_rank;
+    block_check = block_first;
+    mpiret = sc_MPI_Allreduce (sc_MPI_IN_PLACE, &block_check, 1, sc_MPI_INT,
+                               sc_MPI_MAX, intranode);
+    SC_CHECK_MPI (mpiret);
+    contiguous = block_check == block_first && block_first >= 0;
+  }
+  mpiret = sc_MPI_Allreduce (sc_MPI_IN_PLACE, &contiguous, 1, sc_MPI_INT,
+                             sc_MPI_MIN, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  if (!contiguous) {
+    t8_debugf ("The node ranks are not consecutive, creating a "
+               "single node block.\n");
+    block_first = 0;
+    intra_rank = forest->mpirank;
+    intra_size = forest->mpisize;
+  }
+
+  /* The node roots gather one entry per node over the internode
+   * communicator, which holds exactly one rank per node. */
+  gathered = NULL;
+  num_nodes = 1;
+  if (contiguous && intra_rank == 0) {
+    t8_forest_node_offset_t mine;
+
+    mpiret = sc_MPI_Comm_size (internode, &inter_size);
+    SC_CHECK_MPI (mpiret);
+    num_nodes = inter_size;
+    mine.first_element = t8_shmem_array_get_gloidx (forest->element_offsets,
+                                                    block_first);
+    mine.first_rank = (t8_gloidx_t) block_first;
+    gathered = T8_ALLOC (t8_forest_node_offset_t, inter_size);
+    mpiret = sc_MPI_Allgather (&mine, 2, T8_MPI_GLOIDX, gathered, 2,
+                               T8_MPI_GLOIDX, internode);
+    SC_CHECK_MPI (mpiret);
+  }
+  if (contiguous) {
+    /* The number of nodes is needed on every process to size the shared
+     * memory array; only the node roots know it so far. */
+    mpiret = sc_MPI_Bcast (&num_nodes, 1, sc_MPI_INT, 0, intranode);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  t8_forest_shmem_array_init (forest, &forest->node_offsets,
+                              sizeof (t8_forest_node_offset_t),
+                              num_nodes + 1);
+  if (t8_shmem_array_start_writing (forest->node_offsets)) {
+    entries = (t8_forest_node_offset_t *)
+      t8_shmem_array_index_for_writing (forest->node_offsets, 0);
+    if (gathered != NULL) {
+      memcpy (entries, gathered,
+              num_nodes * sizeof (t8_forest_node_offset_t));
+    }
+    else {
+      /* The single block of the degenerate view */
+      element_offsets =
+        t8_shmem_array_get_gloidx_array (forest->element_offsets);
+      for (inode = 0; inode < num_nodes; inode++) {
+        entries[inode].first_element = element_offsets[0];
+        entries[inode].first_rank = 0;
+      }
+    }
+    entries[num_nodes].first_element = forest->global_num_elements;
+    entries[num_nodes].first_rank = (t8_gloidx_t) forest->mpisize;
+  }
+  t8_shmem_array_end_writing (forest->node_offsets);
+  T8_FREE (gathered);
+}
+
+int
+t8_forest_partition_two_level_owner (t8_forest_t forest, t8_gloidx_t gelement,
+                                     int *pnode)
+{
+  const t8_forest_node_offset_t *entries;
+  const t8_gloidx_t  *element_offsets;
+  int                 num_nodes, low, high, guess;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (forest->node_offsets != NULL);
+  T8_ASSERT (forest->element_offsets != NULL);
+  T8_ASSERT (0 <= gelement && gelement < forest->global_num_elements);
+
+  entries = (const t8_forest_node_offset_t *)
+    t8_shmem_array_index (forest->node_offsets, 0);
+  num_nodes = (int) t8_shmem_array_get_elem_count (forest->node_offsets) - 1;
+  /* Search for the largest node block whose first element is less or
+   * equal to gelement. Empty blocks share their offset with the next
+   * block and are thus never returned. */
+  low = 0;
+  high = num_nodes - 1;
+  while (low < high) {
+    guess = (low + high + 1) / 2;
+    if (entries[guess].first_element <= gelement) {
+      low = guess;
+    }
+    else {
+      high = guess - 1;
+    }
+  }
+  if (pnode != NULL) {
+    *pnode = low;
+  }
+  /* Resolve the rank within the node block the same way over the node's
+   * slice of the element offset array. */
+  element_offsets =
+    t8_shmem_array_get_gloidx_array (forest->element_offsets);
+  T8_ASSERT (element_offsets[entries[low].first_rank] <= gelement);
+  high = (int) entries[low + 1].first_rank - 1;
+  low = (int) entries[low].first_rank;
+  while (low < high) {
+    guess = (low + high + 1) / 2;
+    if (element_offsets[guess] <= gelement) {
+      low = guess;
+    }
+    else {
+      high = guess - 1;
+    }
+  }
+  T8_ASSERT (element_offsets[low] <= gelement
+             && gelement < element_offsets[low + 1]);
+  return low;
+}
+
 #ifdef T8_ENABLE_DEBUG
 /* Test if all first descendants of the elements in the first tree have
  * a greater or equal linear id than the stored first descendant. */
@@ -199,13 +462,13 @@ t8_forest_partition_test_boundery_element (const t8_forest_t forest)
     mpirank_from = forest->mpirank + 1;
     mpirank_to = forest->mpirank - 1;
   }
-  mpiret = sc_MPI_Irecv (&local_tree_num_elemets, 1, T8_MPI_LOCIDX,
-                         mpirank_from, 0, forest->mpicomm, &request);
+  mpiret = t8_mpi_profile_irecv (&local_tree_num_elemets, 1, T8_MPI_LOCIDX,
+                                 mpirank_from, 0, t8_forest_comm_for_partition (forest), &request, T8_MPI_PROFILE_PARTITION);
   SC_CHECK_MPI (mpiret);
-  mpiret = sc_MPI_Send (&local_tree_num_elemets_my, 1, T8_MPI_LOCIDX,
-                        mpirank_to, 0, forest->mpicomm);
+  mpiret = t8_mpi_profile_send (&local_tree_num_elemets_my, 1, T8_MPI_LOCIDX,
+                                mpirank_to, 0, t8_forest_comm_for_partition (forest), T8_MPI_PROFILE_PARTITION);
   SC_CHECK_MPI (mpiret);
-  mpiret = sc_MPI_Wait (&request, &status);
+  mpiret = t8_mpi_profile_wait (&request, &status, T8_MPI_PROFILE_PARTITION);
   SC_CHECK_MPI (mpiret);
 
   const t8_locidx_t   num_local_trees =
@@ -273,7 +536,6 @@ t8_forest_partition_test_boundery_element (const t8_forest_t forest)
 void
 t8_forest_partition_create_first_desc (t8_forest_t forest)
 {
-  sc_MPI_Comm         comm;
   t8_linearidx_t      local_first_desc;
   t8_element_t       *first_element = NULL;
   t8_element_t       *first_desc = NULL;
@@ -284,23 +546,20 @@ t8_forest_partition_create_first_desc (t8_forest_t forest)
   T8_ASSERT (forest->global_first_desc == NULL);
   t8_debugf ("Building global first descendants for forest %p\n",
              (void *) forest);
-  comm = forest->mpicomm;
 
   if (forest->global_first_desc == NULL) {
-    /* Set the shmem array type of comm */
-    t8_shmem_init (comm);
-    t8_shmem_set_type (comm, T8_SHMEM_BEST_TYPE);
     /* Initialize the offset array as a shmem array
      * holding mpisize+1 many t8_linearidx_t to store the elements linear ids */
-    t8_shmem_array_init (&forest->global_first_desc, sizeof (t8_linearidx_t),
-                         forest->mpisize, comm);
+    t8_forest_shmem_array_init (forest, &forest->global_first_desc,
+                                sizeof (t8_linearidx_t), forest->mpisize);
   }
   /* Assert whether the array is set up correctly */
   T8_ASSERT (t8_shmem_array_get_elem_count (forest->global_first_desc) ==
              (size_t) forest->mpisize);
   T8_ASSERT (t8_shmem_array_get_elem_size (forest->global_first_desc) ==
              sizeof (t8_linearidx_t));
-  T8_ASSERT (t8_shmem_array_get_comm (forest->global_first_desc) == comm);
+  T8_ASSERT (t8_shmem_array_get_comm (forest->global_first_desc) ==
+             forest->mpicomm);
   if (forest->local_num_elements <= 0) {
     /* This process is empty, we store 0 in the array */
     local_first_desc = 0;
@@ -371,12 +630,10 @@ void
 t8_forest_partition_create_tree_offsets (t8_forest_t forest)
 {
   t8_gloidx_t         tree_offset;
-  sc_MPI_Comm         comm;
   int                 is_empty, has_empty;
 
   T8_ASSERT (t8_forest_is_committed (forest));
 
-  comm = forest->mpicomm;
   /* *INDENT-OFF* */
   /* Calculate this process's tree offset */
   tree_offset =
@@ -393,19 +650,17 @@ t8_forest_partition_create_tree_offsets (t8_forest_t forest)
   }
   /* *INDENT-ON* */
   if (forest->tree_offsets == NULL) {
-    /* Set the shmem array type of comm */
-    t8_shmem_init (comm);
-    t8_shmem_set_type (comm, T8_SHMEM_BEST_TYPE);
     /* Only allocate the shmem array, if it is not already allocated */
-    t8_shmem_array_init (&forest->tree_offsets, sizeof (t8_gloidx_t),
-                         forest->mpisize + 1, comm);
+    t8_forest_shmem_array_init (forest, &forest->tree_offsets,
+                                sizeof (t8_gloidx_t), forest->mpisize + 1);
   }
   /* Assert whether the array is set up correctly */
   T8_ASSERT (t8_shmem_array_get_elem_count (forest->tree_offsets) ==
              (size_t) forest->mpisize + 1);
   T8_ASSERT (t8_shmem_array_get_elem_size (forest->tree_offsets) ==
              sizeof (t8_gloidx_t));
-  T8_ASSERT (t8_shmem_array_get_comm (forest->tree_offsets) == comm);
+  T8_ASSERT (t8_shmem_array_get_comm (forest->tree_offsets) ==
+             forest->mpicomm);
   /* gather all tree offsets from all processes */
   t8_shmem_array_allgather (&tree_offset, 1, T8_MPI_GLOIDX,
                             forest->tree_offsets, 1, T8_MPI_GLOIDX);
@@ -419,7 +674,7 @@ t8_forest_partition_create_tree_offsets (t8_forest_t forest)
 
   /* Communicate whether we have empty processes */
   sc_MPI_Allreduce (&is_empty, &has_empty, 1, sc_MPI_INT, sc_MPI_LOR,
-                    forest->mpicomm);
+                    t8_forest_comm_for_partition (forest));
 
   if (has_empty) {
     int                 next_nonempty;
@@ -447,6 +702,142 @@ t8_forest_partition_create_tree_offsets (t8_forest_t forest)
   }
 }
 
+static void         t8_forest_partition_compute_new_offset (t8_forest_t
+                                                            forest);
+
+/* Calculate the new element_offset for forest from the elements in
+ * forest->set_from and the weight function in forest->set_partition_weight_fn.
+ * Each process is assigned a range of elements along the SFC such that the
+ * cumulative element weights of the processes are approximately equal. */
+static void
+t8_forest_partition_compute_new_offset_weighted (t8_forest_t forest)
+{
+  t8_forest_t         forest_from;
+  t8_forest_partition_weight_t weight_fn;
+  sc_MPI_Comm         comm;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *element;
+  t8_locidx_t         itree, num_trees, ielement, tree_num_elements;
+  t8_locidx_t         num_local_elements, el_index;
+  t8_gloidx_t         first_local_element, *offsets_local, *offsets_global;
+  double             *cumulative_weight;
+  double              local_weight, weight_prefix, total_weight, target;
+  int                 i, mpiret, mpisize;
+
+  forest_from = forest->set_from;
+  weight_fn = forest->set_partition_weight_fn;
+  comm = t8_forest_comm_for_partition (forest);
+  mpisize = forest->mpisize;
+  T8_ASSERT (weight_fn != NULL);
+
+  /* Compute the cumulative weights of the local elements, such that
+   * cumulative_weight[i] is the summed weight of the elements 0,...,i-1. */
+  num_local_elements = forest_from->local_num_elements;
+  cumulative_weight = T8_ALLOC (double, num_local_elements + 1);
+  cumulative_weight[0] = 0;
+  el_index = 0;
+  num_trees = t8_forest_get_num_local_trees (forest_from);
+  for (itree = 0; itree < num_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest_from,
+                                      t8_forest_get_tree_class (forest_from,
+                                                                itree));
+    tree_num_elements = t8_forest_get_tree_num_elements (forest_from, itree);
+    for (ielement = 0; ielement < tree_num_elements; ielement++, el_index++) {
+      element = t8_forest_get_element_in_tree (forest_from, itree, ielement);
+      cumulative_weight[el_index + 1] = cumulative_weight[el_index]
+        + weight_fn (forest_from, itree, ielement, ts, element);
+      /* Weights must not be negative */
+      T8_ASSERT (cumulative_weight[el_index + 1] >=
+                 cumulative_weight[el_index]);
+    }
+  }
+  T8_ASSERT (el_index == num_local_elements);
+  local_weight = cumulative_weight[num_local_elements];
+
+  /* Compute the summed weight of all smaller ranks and the total weight.
+   * Since Exscan computes the partial sums in rank order, the prefix weights
+   * are consistent across the processes and partition the interval
+   * [0, total_weight) without gaps. */
+  weight_prefix = 0;
+  mpiret = sc_MPI_Exscan (&local_weight, &weight_prefix, 1, sc_MPI_DOUBLE,
+                          sc_MPI_SUM, comm);
+  SC_CHECK_MPI (mpiret);
+  if (forest->mpirank == 0) {
+    /* The Exscan result is undefined on rank 0 */
+    weight_prefix = 0;
+  }
+  total_weight = weight_prefix + local_weight;
+  mpiret = t8_mpi_profile_bcast (&total_weight, 1, sc_MPI_DOUBLE, mpisize - 1, comm, T8_MPI_PROFILE_PARTITION);
+  SC_CHECK_MPI (mpiret);
+
+  if (total_weight <= 0) {
+    /* All elements have weight zero, fall back to uniform partition */
+    T8_FREE (cumulative_weight);
+    t8_forest_partition_compute_new_offset (forest);
+    return;
+  }
+
+  /* Each process computes the new offsets of the weight boundaries that
+   * fall into its local weight range. The remaining entries stay at -1 and
+   * are determined by the other processes in the allreduce below. */
+  offsets_local = T8_ALLOC (t8_gloidx_t, mpisize + 1);
+  offsets_global = T8_ALLOC (t8_gloidx_t, mpisize + 1);
+  for (i = 0; i <= mpisize; i++) {
+    offsets_local[i] = -1;
+  }
+  offsets_local[0] = 0;
+  offsets_local[mpisize] = forest_from->global_num_elements;
+  first_local_element = t8_forest_get_first_local_element_id (forest_from);
+  for (i = 1; i < mpisize; i++) {
+    /* The i-th process should start at cumulative weight i * W/P */
+    target = (total_weight * i) / mpisize;
+    if (weight_prefix <= target && target < weight_prefix + local_weight) {
+      /* The boundary lies in our weight range. Find the first local element
+       * whose cumulative start weight is at least the target. */
+      t8_locidx_t         low = 0, high = num_local_elements, mid;
+      while (low < high) {
+        mid = low + (high - low) / 2;
+        if (weight_prefix + cumulative_weight[mid] < target) {
+          low = mid + 1;
+        }
+        else {
+          high = mid;
+        }
+      }
+      offsets_local[i] = first_local_element + low;
+    }
+  }
+  /* Combine the partial offset arrays. Each interior entry was computed by
+   * at most one process; entries that no process claimed (only possible via
+   * trailing zero weights) remain -1 and are filled below. */
+  mpiret = sc_MPI_Allreduce (offsets_local, offsets_global, mpisize + 1,
+                             T8_MPI_GLOIDX, sc_MPI_MAX, comm);
+  SC_CHECK_MPI (mpiret);
+  for (i = mpisize - 1; i > 0; i--) {
+    if (offsets_global[i] < 0) {
+      offsets_global[i] = offsets_global[i + 1];
+    }
+  }
+
+  /* Write the new offsets into the shared memory array */
+  T8_ASSERT (forest->element_offsets == NULL);
+  t8_forest_shmem_array_init (forest, &forest->element_offsets,
+                              sizeof (t8_gloidx_t), mpisize + 1);
+  if (t8_shmem_array_start_writing (forest->element_offsets)) {
+    t8_gloidx_t        *element_offsets =
+      t8_shmem_array_get_gloidx_array_for_writing (forest->element_offsets);
+    for (i = 0; i <= mpisize; i++) {
+      T8_ASSERT (i == 0 || offsets_global[i] >= offsets_global[i - 1]);
+      element_offsets[i] = offsets_global[i];
+    }
+  }
+  t8_shmem_array_end_writing (forest->element_offsets);
+
+  T8_FREE (cumulative_weight);
+  T8_FREE (offsets_local);
+  T8_FREE (offsets_global);
+}
+
 /* Calculate the new element_offset for forest from
  * the element in forest->set_from assuming a partition without
  * element weights */
@@ -462,15 +853,12 @@ t8_forest_partition_compute_new_offset (t8_forest_t forest)
   T8_ASSERT (forest->set_from != NULL);
 
   forest_from = forest->set_from;
-  comm = forest->mpicomm;
+  comm = t8_forest_comm_for_partition (forest);
 
   T8_ASSERT (forest->element_offsets == NULL);
-  /* Set the shmem array type to comm */
-  t8_shmem_init (comm);
-  t8_shmem_set_type (comm, T8_SHMEM_BEST_TYPE);
   /* Initialize the shmem array */
-  t8_shmem_array_init (&forest->element_offsets, sizeof (t8_gloidx_t),
-                       forest->mpisize + 1, comm);
+  t8_forest_shmem_array_init (forest, &forest->element_offsets,
+                              sizeof (t8_gloidx_t), forest->mpisize + 1);
   mpiret = sc_MPI_Comm_size (comm, &mpisize);
   SC_CHECK_MPI (mpiret);
 
@@ -490,6 +878,8 @@ t8_forest_partition_compute_new_offset (t8_forest_t forest)
     element_offsets[forest->mpisize] = forest->global_num_elements;
   }
   t8_shmem_array_end_writing (forest->element_offsets);
+  /* The offsets follow the closed formula */
+  forest->partition_is_uniform = 1;
 }
 
 /* Find the owner of a given element.
@@ -514,14 +904,30 @@ t8_forest_partition_recvrange (t8_forest_t forest, int *recv_first,
   /* Get the old element offset array */
   const t8_gloidx_t  *offset_old =
     t8_shmem_array_get_gloidx_array (forest->set_from->element_offsets);
-  /* Get the new element offset array */
-  const t8_gloidx_t  *offset_new =
-    t8_shmem_array_get_gloidx_array (forest->element_offsets);
-  /* Compute new first and last element on this process from offset array */
-  first_element =
-    t8_forest_partition_first_element (offset_new, forest->mpirank);
-  last_element =
-    t8_forest_partition_last_element (offset_new, forest->mpirank);
+  if (forest->element_offsets != NULL) {
+    /* Get the new element offset array */
+    const t8_gloidx_t  *offset_new =
+      t8_shmem_array_get_gloidx_array (forest->element_offsets);
+    /* Compute new first and last element on this process from offset array */
+    first_element =
+      t8_forest_partition_first_element (offset_new, forest->mpirank);
+    last_element =
+      t8_forest_partition_last_element (offset_new, forest->mpirank);
+  }
+  else {
+    /* The new offsets are the closed-form unweighted offsets and were not
+     * materialized. */
+    T8_ASSERT (forest->partition_is_uniform);
+    first_element =
+      t8_forest_partition_uniform_offset (forest->mpirank, forest->mpisize,
+                                          forest->set_from->
+                                          global_num_elements);
+    last_element =
+      t8_forest_partition_uniform_offset (forest->mpirank + 1,
+                                          forest->mpisize,
+                                          forest->set_from->
+                                          global_num_elements) - 1;
+  }
   if (last_element < first_element) {
     /* There are no elements on this process and thus we cannot
      * receive anything */
@@ -556,24 +962,39 @@ t8_forest_partition_sendrange (t8_forest_t forest, int *send_first,
   const t8_gloidx_t  *offset_old =
     t8_shmem_array_get_gloidx_array (forest->set_from->element_offsets);
   t8_debugf ("Partition forest from:\n");
-  t8_offset_print (forest->set_from->element_offsets, forest->mpicomm);
-  /* Get the new element offset array */
-  const t8_gloidx_t  *offset_new =
-    t8_shmem_array_get_gloidx_array (forest->element_offsets);
-  t8_debugf ("Partition forest to:\n");
-  t8_offset_print (forest->element_offsets, forest->mpicomm);
+  t8_offset_print (forest->set_from->element_offsets, t8_forest_comm_for_partition (forest));
   /* Compute old first and last element on this process from offset array */
   first_element =
     t8_forest_partition_first_element (offset_old, forest->mpirank);
   last_element =
     t8_forest_partition_last_element (offset_old, forest->mpirank);
-  /* Calculate the first and last process we send to */
-  *send_first = t8_forest_partition_owner_of_element (forest->mpisize,
-                                                      first_element,
-                                                      offset_new);
-  *send_last = t8_forest_partition_owner_of_element (forest->mpisize,
-                                                     last_element,
-                                                     offset_new);
+  if (forest->element_offsets != NULL) {
+    /* Get the new element offset array */
+    const t8_gloidx_t  *offset_new =
+      t8_shmem_array_get_gloidx_array (forest->element_offsets);
+    t8_debugf ("Partition forest to:\n");
+    t8_offset_print (forest->element_offsets, t8_forest_comm_for_partition (forest));
+    /* Calculate the first and last process we send to */
+    *send_first = t8_forest_partition_owner_of_element (forest->mpisize,
+                                                        first_element,
+                                                        offset_new);
+    *send_last = t8_forest_partition_owner_of_element (forest->mpisize,
+                                                       last_element,
+                                                       offset_new);
+  }
+  else {
+    /* The new offsets are the closed-form unweighted offsets. We find the
+     * owners by evaluating the formula, the offset array is not needed. */
+    T8_ASSERT (forest->partition_is_uniform);
+    *send_first =
+      t8_forest_partition_uniform_owner (first_element, forest->mpisize,
+                                         forest->set_from->
+                                         global_num_elements);
+    *send_last =
+      t8_forest_partition_uniform_owner (last_element, forest->mpisize,
+                                         forest->set_from->
+                                         global_num_elements);
+  }
 }
 
 /* Given a tree and its local id, the first and last element id that we need to send to a proc
@@ -628,6 +1049,12 @@ t8_forest_partition_tree_first_last_el (t8_tree_t tree,
  *                              we would send elements from to the next process.
  * \param [in]  first_element_send The local id of the first element that we need to send.
  * \param [in]  last_element_send The local id of the last element that we need to send.
+ * \param [in,out] element_blocks If not NULL, the elements are not copied into the
+ *                              send buffer. Instead the buffer only holds the header
+ *                              and for each tree a t8_forest_partition_block_t
+ *                              pointing into the tree's element array is pushed to
+ *                              this array. \a buffer_alloc is the byte count of the
+ *                              full message in both cases.
  */
 /* The send buffer will look like this:
  *
@@ -640,7 +1067,8 @@ t8_forest_partition_fill_buffer (t8_forest_t forest_from,
                                  char **send_buffer, int *buffer_alloc,
                                  t8_locidx_t *current_tree,
                                  t8_locidx_t first_element_send,
-                                 t8_locidx_t last_element_send)
+                                 t8_locidx_t last_element_send,
+                                 sc_array_t *element_blocks)
 {
   t8_locidx_t         num_elements_send;
   t8_tree_t           tree;
@@ -695,7 +1123,14 @@ t8_forest_partition_fill_buffer (t8_forest_t forest_from,
    * each tree's elements, since these are multiples of structs and
    * structs are padded correctly */
   /* We allocate the buffer */
-  *send_buffer = T8_ALLOC (char, byte_alloc);
+  if (element_blocks == NULL) {
+    *send_buffer = T8_ALLOC (char, byte_alloc);
+  }
+  else {
+    /* Zero-copy mode, the buffer stores the header only. The elements
+     * are sent from their tree arrays via the recorded blocks. */
+    *send_buffer = T8_ALLOC (char, element_pos);
+  }
   /* We store the number of trees at first in the send buffer */
   pnum_trees_send = (t8_locidx_t *) *send_buffer;
   *pnum_trees_send = num_trees_send;
@@ -727,8 +1162,17 @@ t8_forest_partition_fill_buffer (t8_forest_t forest_from,
       pfirst_element =
         t8_element_array_index_locidx (&tree->elements, first_tree_element);
       elem_size = t8_element_array_get_size (&tree->elements);
-      memcpy (*send_buffer + element_pos, pfirst_element,
-              num_elements_send * elem_size);
+      if (element_blocks == NULL) {
+        memcpy (*send_buffer + element_pos, pfirst_element,
+                num_elements_send * elem_size);
+      }
+      else {
+        /* Record the block instead of copying it */
+        t8_forest_partition_block_t *block = (t8_forest_partition_block_t *)
+          sc_array_push (element_blocks);
+        block->data = pfirst_element;
+        block->num_bytes = num_elements_send * elem_size;
+      }
       element_pos += num_elements_send * elem_size;
     }
   }
@@ -772,6 +1216,61 @@ t8_forest_partition_fill_buffer_data (t8_forest_t forest_from,
   memcpy (*send_buffer, data_entry, *buffer_alloc);
 }
 
+#if T8_ENABLE_MPI
+/* Post the zero-copy send of one partition message.
+ * The header was packed by \ref t8_forest_partition_fill_buffer into \a header,
+ * the element payload stays in the tree element arrays and is described by
+ * \a element_blocks. We build a derived datatype with absolute addresses over
+ * the header and the blocks, so the message has the same byte layout on the
+ * wire as a message of the copying path and the receiver does not need to
+ * distinguish the two. \a element_blocks is emptied.
+ */
+static void
+t8_forest_partition_isend_blocks (char *header, int total_bytes,
+                                  sc_array_t *element_blocks, int iproc,
+                                  sc_MPI_Comm comm, sc_MPI_Request *request)
+{
+  int                 mpiret, iblock, count, header_bytes;
+  int                *block_lengths;
+  MPI_Aint           *block_displs;
+  MPI_Datatype        send_type;
+  t8_forest_partition_block_t *block;
+
+  count = 1 + (int) element_blocks->elem_count;
+  block_lengths = T8_ALLOC (int, count);
+  block_displs = T8_ALLOC (MPI_Aint, count);
+  /* The first block is the header. Its length is the total message length
+   * minus the payload bytes. */
+  header_bytes = total_bytes;
+  for (iblock = 0; iblock < count - 1; iblock++) {
+    block = (t8_forest_partition_block_t *)
+      sc_array_index_int (element_blocks, iblock);
+    header_bytes -= block->num_bytes;
+    block_lengths[iblock + 1] = block->num_bytes;
+    mpiret = MPI_Get_address (block->data, &block_displs[iblock + 1]);
+    SC_CHECK_MPI (mpiret);
+  }
+  T8_ASSERT (header_bytes > 0);
+  block_lengths[0] = header_bytes;
+  mpiret = MPI_Get_address (header, &block_displs[0]);
+  SC_CHECK_MPI (mpiret);
+  mpiret = MPI_Type_create_hindexed (count, block_lengths, block_displs,
+                                     MPI_BYTE, &send_type);
+  SC_CHECK_MPI (mpiret);
+  mpiret = MPI_Type_commit (&send_type);
+  SC_CHECK_MPI (mpiret);
+  mpiret = MPI_Isend (MPI_BOTTOM, 1, send_type, iproc,
+                      T8_MPI_PARTITION_FOREST, comm, request);
+  SC_CHECK_MPI (mpiret);
+  /* The MPI library keeps its own reference until the send completes */
+  mpiret = MPI_Type_free (&send_type);
+  SC_CHECK_MPI (mpiret);
+  T8_FREE (block_lengths);
+  T8_FREE (block_displs);
+  sc_array_reset (element_blocks);
+}
+#endif /* T8_ENABLE_MPI */
+
 /* Carry out all sending of elements */
 /* If send_data is true, the elements are not send but element data
  * stored in an sc_array of length forest->set_from->num_local_elements.
@@ -781,7 +1280,8 @@ t8_forest_partition_sendloop (t8_forest_t forest, const int send_first,
                               const int send_last, sc_MPI_Request ** requests,
                               int *num_request_alloc, char ***send_buffer,
                               const int send_data, const sc_array_t *data_in,
-                              size_t *byte_to_self)
+                              size_t *byte_to_self,
+                              sc_array_t *self_blocks)
 {
   int                 iproc, mpiret;
   t8_gloidx_t         gfirst_element_send, glast_element_send;
@@ -794,6 +1294,11 @@ t8_forest_partition_sendloop (t8_forest_t forest, const int send_first,
   int                 buffer_alloc;
   sc_MPI_Comm         comm;
   int                 to_self = 0;
+#if T8_ENABLE_MPI
+  sc_array_t          element_blocks;
+
+  sc_array_init (&element_blocks, sizeof (t8_forest_partition_block_t));
+#endif
 
   t8_debugf ("Start send loop\n");
   /* If send_data is false, the forest must not be committed but initialized.
@@ -808,7 +1313,7 @@ t8_forest_partition_sendloop (t8_forest_t forest, const int send_first,
              || data_in->elem_count ==
              (size_t) forest_from->local_num_elements);
 
-  comm = forest->mpicomm;
+  comm = t8_forest_comm_for_partition (forest);
   /* Determine the number of requests for MPI communication. */
   *num_request_alloc = send_last - send_first + 1;
   if (*num_request_alloc < 0) {
@@ -824,9 +1329,10 @@ t8_forest_partition_sendloop (t8_forest_t forest, const int send_first,
    * we can pass them to free */
   *send_buffer = T8_ALLOC_ZERO (char *, send_last - send_first + 1);
 
-  /* Get the new and old offset array */
-  const t8_gloidx_t  *offset_to =
-    t8_shmem_array_get_gloidx_array (forest->element_offsets);
+  /* Get the new and old offset array. The new offsets may not be
+   * materialized if the partition is the closed-form unweighted one. */
+  const t8_gloidx_t  *offset_to = forest->element_offsets != NULL ?
+    t8_shmem_array_get_gloidx_array (forest->element_offsets) : NULL;
   const t8_gloidx_t  *offset_from =
     t8_shmem_array_get_gloidx_array (forest_from->element_offsets);
 
@@ -845,7 +1351,10 @@ t8_forest_partition_sendloop (t8_forest_t forest, const int send_first,
     else {
       /* Otherwise, the first element we send is the new first element on the
        * process */
-      gfirst_element_send = offset_to[iproc];
+      gfirst_element_send = offset_to != NULL ? offset_to[iproc]
+        : t8_forest_partition_uniform_offset (iproc, forest->mpisize,
+                                              forest_from->
+                                              global_num_elements);
       first_element_send = gfirst_element_send - gfirst_local_element;
       /* assert for overflow error */
       T8_ASSERT ((t8_gloidx_t) first_element_send ==
@@ -858,7 +1367,10 @@ t8_forest_partition_sendloop (t8_forest_t forest, const int send_first,
     else {
       /* Otherwise, the last element we send to proc is the last
        * element on proc in the new partition. */
-      glast_element_send = offset_to[iproc + 1] - 1;
+      glast_element_send = (offset_to != NULL ? offset_to[iproc + 1]
+                            : t8_forest_partition_uniform_offset
+                            (iproc + 1, forest->mpisize,
+                             forest_from->global_num_elements)) - 1;
       last_element_send = glast_element_send - gfirst_local_element;
     }
     num_elements_send = last_element_send - first_element_send + 1;
@@ -874,11 +1386,26 @@ t8_forest_partition_sendloop (t8_forest_t forest, const int send_first,
       }
       if (!send_data) {
         /* Fill the buffer with the elements and calculate the next tree
-         * from which to send elements */
+         * from which to send elements.
+         * In all cases only the header is packed: for a remote receiver
+         * the element blocks are sent in place via a derived datatype and
+         * for the message to ourselves they are recorded in \a self_blocks
+         * and consumed directly by the receive loop. */
+#if T8_ENABLE_MPI
         t8_forest_partition_fill_buffer (forest_from,
                                          buffer, &buffer_alloc,
                                          &current_tree, first_element_send,
-                                         last_element_send);
+                                         last_element_send,
+                                         iproc != forest->mpirank ?
+                                         &element_blocks : self_blocks);
+#else
+        t8_forest_partition_fill_buffer (forest_from,
+                                         buffer, &buffer_alloc,
+                                         &current_tree, first_element_send,
+                                         last_element_send,
+                                         iproc == forest->mpirank ?
+                                         self_blocks : NULL);
+#endif
       }
       else {
         T8_ASSERT (send_data);
@@ -893,10 +1420,26 @@ t8_forest_partition_sendloop (t8_forest_t forest, const int send_first,
       if (iproc != forest->mpirank) {
         t8_debugf ("Post send of %li elements (%i bytes) to process %i\n",
                    (long) num_elements_send, buffer_alloc, iproc);
-        mpiret = sc_MPI_Isend (*buffer, buffer_alloc, sc_MPI_BYTE, iproc,
-                               T8_MPI_PARTITION_FOREST, comm,
-                               *requests + iproc - send_first);
-        SC_CHECK_MPI (mpiret);
+        if (forest->profile != NULL) {
+          /* Account the message size to the open partition region timer */
+          t8_region_profile_add_bytes (forest->profile->region_profile,
+                                       buffer_alloc);
+        }
+#if T8_ENABLE_MPI
+        if (!send_data) {
+          /* Zero-copy send of header plus in-place element blocks */
+          t8_forest_partition_isend_blocks (*buffer, buffer_alloc,
+                                            &element_blocks, iproc, comm,
+                                            *requests + iproc - send_first);
+        }
+        else
+#endif
+        {
+          mpiret = t8_mpi_profile_isend (*buffer, buffer_alloc, sc_MPI_BYTE, iproc,
+                                         T8_MPI_PARTITION_FOREST, comm,
+                                         *requests + iproc - send_first, T8_MPI_PROFILE_PARTITION);
+          SC_CHECK_MPI (mpiret);
+        }
       }
       else {
         *byte_to_self = buffer_alloc;
@@ -921,6 +1464,9 @@ t8_forest_partition_sendloop (t8_forest_t forest, const int send_first,
       *(*requests + iproc - send_first) = sc_MPI_REQUEST_NULL;
     }
   }
+#if T8_ENABLE_MPI
+  sc_array_reset (&element_blocks);
+#endif
   t8_debugf ("End send loop\n");
   return to_self;
 }
@@ -972,9 +1518,9 @@ t8_forest_partition_recv_message_data (t8_forest_t forest, sc_MPI_Comm comm,
     /* allocate the receive buffer */
     recv_buffer = T8_ALLOC (char, recv_bytes);
     /* receive the message */
-    mpiret = sc_MPI_Recv (recv_buffer, recv_bytes, sc_MPI_BYTE, proc,
-                          T8_MPI_PARTITION_FOREST, comm,
-                          sc_MPI_STATUS_IGNORE);
+    mpiret = t8_mpi_profile_recv (recv_buffer, recv_bytes, sc_MPI_BYTE, proc,
+                                  T8_MPI_PARTITION_FOREST, comm,
+                                  sc_MPI_STATUS_IGNORE, T8_MPI_PROFILE_PARTITION);
     SC_CHECK_MPI (mpiret);
   }
   else {
@@ -1014,7 +1560,8 @@ static void
 t8_forest_partition_recv_message (t8_forest_t forest, sc_MPI_Comm comm,
                                   int proc, sc_MPI_Status * status,
                                   int prev_recvd, char *sent_to_self,
-                                  size_t byte_to_self)
+                                  size_t byte_to_self,
+                                  sc_array_t *self_blocks)
 {
   int                 mpiret;
   int                 recv_bytes;
@@ -1023,10 +1570,13 @@ t8_forest_partition_recv_message (t8_forest_t forest, sc_MPI_Comm comm,
   t8_locidx_t         num_elements_recv;
   t8_locidx_t         old_num_elements, new_num_elements;
   size_t              tree_cursor, element_cursor;
+  size_t              iblock = 0;
   t8_forest_partition_tree_info_t *tree_info;
+  t8_forest_partition_block_t *block;
   t8_tree_t           tree, last_tree;
   size_t              element_size;
   void               *first_new_element;
+  char               *element_src;
   t8_eclass_scheme_c *eclass_scheme;
 
   if (proc != forest->mpirank) {
@@ -1046,9 +1596,9 @@ t8_forest_partition_recv_message (t8_forest_t forest, sc_MPI_Comm comm,
     /* allocate the receive buffer */
     recv_buffer = T8_ALLOC (char, recv_bytes);
     /* receive the message */
-    mpiret = sc_MPI_Recv (recv_buffer, recv_bytes, sc_MPI_BYTE, proc,
-                          T8_MPI_PARTITION_FOREST, comm,
-                          sc_MPI_STATUS_IGNORE);
+    mpiret = t8_mpi_profile_recv (recv_buffer, recv_bytes, sc_MPI_BYTE, proc,
+                                  T8_MPI_PARTITION_FOREST, comm,
+                                  sc_MPI_STATUS_IGNORE, T8_MPI_PROFILE_PARTITION);
     SC_CHECK_MPI (mpiret);
   }
   else {
@@ -1075,6 +1625,22 @@ t8_forest_partition_recv_message (t8_forest_t forest, sc_MPI_Comm comm,
   for (itree = 0; itree < num_trees; itree++) {
     num_elements_recv += tree_info->num_elements;
     T8_ASSERT (tree_info->gtree_id >= forest->last_local_tree);
+    /* Determine where the elements of this tree are read from. The message
+     * to ourselves stages only the header and its elements are copied
+     * directly out of the old tree arrays via the recorded blocks. */
+    if (proc == forest->mpirank && self_blocks != NULL) {
+      if (tree_info->num_elements > 0) {
+        block = (t8_forest_partition_block_t *)
+          sc_array_index (self_blocks, iblock++);
+        element_src = (char *) block->data;
+      }
+      else {
+        element_src = NULL;
+      }
+    }
+    else {
+      element_src = recv_buffer + element_cursor;
+    }
     if (tree_info->gtree_id > forest->last_local_tree) {
       /* We will insert a new tree in the forest */
       tree = (t8_tree_t) sc_array_push (forest->trees);
@@ -1105,8 +1671,7 @@ t8_forest_partition_recv_message (t8_forest_t forest, sc_MPI_Comm comm,
       T8_ASSERT (element_cursor + tree_info->num_elements * element_size <=
                  (size_t) recv_bytes);
       t8_element_array_init_copy (&tree->elements, eclass_scheme,
-                                  (t8_element_t *) (recv_buffer +
-                                                    element_cursor),
+                                  (t8_element_t *) element_src,
                                   tree_info->num_elements);
     }
     else {
@@ -1132,7 +1697,7 @@ t8_forest_partition_recv_message (t8_forest_t forest, sc_MPI_Comm comm,
       element_size = eclass_scheme->t8_element_size ();
       T8_ASSERT (element_size == t8_element_array_get_size (&tree->elements));
       /* Copy the elements from the receive buffer to the elements array */
-      memcpy (first_new_element, recv_buffer + element_cursor,
+      memcpy (first_new_element, element_src,
               tree_info->num_elements * element_size);
     }
 
@@ -1167,10 +1732,13 @@ static void
 t8_forest_partition_recvloop (t8_forest_t forest, int recv_first,
                               int recv_last, const int recv_data,
                               sc_array_t *data_out, char *sent_to_self,
-                              size_t byte_to_self)
+                              size_t byte_to_self, sc_array_t *self_blocks,
+                              t8_forest_partition_data_range_t data_callback,
+                              void *callback_data)
 {
   int                 iproc, num_receive, prev_recvd;
   t8_locidx_t         last_received_local_element = 0;
+  t8_locidx_t         first_element_of_message;
   t8_forest_t         forest_from;
   int                 mpiret;
   sc_MPI_Comm         comm;
@@ -1185,7 +1753,7 @@ t8_forest_partition_recvloop (t8_forest_t forest, int recv_first,
   T8_ASSERT (t8_forest_is_committed (forest_from));
   const t8_gloidx_t  *offset_from =
     t8_shmem_array_get_gloidx_array (forest_from->element_offsets);
-  comm = forest->mpicomm;
+  comm = t8_forest_comm_for_partition (forest);
 
   /****     Actual communication    ****/
 
@@ -1203,7 +1771,7 @@ t8_forest_partition_recvloop (t8_forest_t forest, int recv_first,
       num_receive++;
       if (iproc != forest->mpirank) {
         /* Probe for the message */
-        mpiret = sc_MPI_Probe (iproc, T8_MPI_PARTITION_FOREST, comm, &status);
+        mpiret = t8_mpi_profile_probe (iproc, T8_MPI_PARTITION_FOREST, comm, &status, T8_MPI_PROFILE_PARTITION);
         SC_CHECK_MPI (mpiret);
         /* Consistency checks */
         T8_ASSERT (iproc == status.MPI_SOURCE);
@@ -1213,16 +1781,25 @@ t8_forest_partition_recvloop (t8_forest_t forest, int recv_first,
       if (!recv_data) {
         t8_forest_partition_recv_message (forest, comm, iproc, &status,
                                           prev_recvd, sent_to_self,
-                                          byte_to_self);
+                                          byte_to_self, self_blocks);
       }
       else {
         T8_ASSERT (data_out != NULL);
         T8_ASSERT (data_out->elem_count ==
                    (size_t) forest->local_num_elements);
+        first_element_of_message = last_received_local_element;
         t8_forest_partition_recv_message_data (forest, comm, iproc, &status,
                                                &last_received_local_element,
                                                data_out, sent_to_self,
                                                byte_to_self);
+        if (data_callback != NULL) {
+          /* Report the received contiguous range to the caller, who may
+           * start computing on it while later messages are in transit. */
+          data_callback (forest, first_element_of_message,
+                         last_received_local_element
+                         - first_element_of_message, data_out,
+                         callback_data);
+        }
       }
       prev_recvd++;
     }
@@ -1243,22 +1820,37 @@ t8_forest_partition_given (t8_forest_t forest, const int send_data,
   int                 mpiret, i, to_self;
   t8_locidx_t         num_new_elements;
   size_t              byte_to_self = 0;
+  sc_array_t          self_blocks;
+  t8_region_profile_t *region_profile;
 
   t8_debugf ("Start partition_given\n");
+  /* The element blocks of the message to ourselves. They point into the
+   * old tree arrays and are consumed by the receive loop, so the elements
+   * we keep are copied once instead of being staged in a buffer first. */
+  sc_array_init (&self_blocks, sizeof (t8_forest_partition_block_t));
   T8_ASSERT (send_data || t8_forest_is_initialized (forest));
   T8_ASSERT (!send_data || t8_forest_is_committed (forest));
   T8_ASSERT (forest->set_from != NULL);
   T8_ASSERT (t8_forest_is_committed (forest->set_from));
+  /* The region timers of the inner partition steps (NULL if profiling
+   * is off) */
+  region_profile =
+    forest->profile != NULL ? forest->profile->region_profile : NULL;
   /* Compute the first and last rank that we send to */
+  t8_region_profile_enter (region_profile, "partition/sendrange");
   t8_forest_partition_sendrange (forest, &send_first, &send_last);
+  t8_region_profile_leave (region_profile, "partition/sendrange");
   t8_debugf ("send_first = %i\n", send_first);
   t8_debugf ("send_last = %i\n", send_last);
 
   /* Send all elements to other ranks */
+  t8_region_profile_enter (region_profile, "partition/send_loop");
   to_self =
     t8_forest_partition_sendloop (forest, send_first, send_last, &requests,
                                   &num_request_alloc, &send_buffer, send_data,
-                                  data_in, &byte_to_self);
+                                  data_in, &byte_to_self,
+                                  send_data ? NULL : &self_blocks);
+  t8_region_profile_leave (region_profile, "partition/send_loop");
   if (to_self) {
     /* We have sent data to ourselves. */
     sent_to_self = *(send_buffer + forest->mpirank - send_first);
@@ -1269,19 +1861,38 @@ t8_forest_partition_given (t8_forest_t forest, const int send_data,
 
   /* Compute the number of new elements on this forest */
   if (!send_data) {
-    num_new_elements =
-      t8_shmem_array_get_gloidx (forest->element_offsets, forest->mpirank + 1)
-      - t8_shmem_array_get_gloidx (forest->element_offsets, forest->mpirank);
+    if (forest->element_offsets != NULL) {
+      num_new_elements =
+        t8_shmem_array_get_gloidx (forest->element_offsets,
+                                   forest->mpirank + 1)
+        - t8_shmem_array_get_gloidx (forest->element_offsets,
+                                     forest->mpirank);
+    }
+    else {
+      T8_ASSERT (forest->partition_is_uniform);
+      num_new_elements =
+        t8_forest_partition_uniform_offset (forest->mpirank + 1,
+                                            forest->mpisize,
+                                            forest->set_from->
+                                            global_num_elements)
+        - t8_forest_partition_uniform_offset (forest->mpirank,
+                                              forest->mpisize,
+                                              forest->set_from->
+                                              global_num_elements);
+    }
   }
   else {
     num_new_elements = t8_forest_get_local_num_elements (forest);
   }
 
+  t8_region_profile_enter (region_profile, "partition/recv_loop");
   if (num_new_elements > 0) {
     /* Receive all element from other ranks */
     t8_forest_partition_recvrange (forest, &recv_first, &recv_last);
     t8_forest_partition_recvloop (forest, recv_first, recv_last, send_data,
-                                  data_out, sent_to_self, byte_to_self);
+                                  data_out, sent_to_self, byte_to_self,
+                                  send_data ? NULL : &self_blocks, NULL,
+                                  NULL);
   }
   else if (!send_data) {
     /* This forest is empty, set first and last local tree such
@@ -1290,21 +1901,58 @@ t8_forest_partition_given (t8_forest_t forest, const int send_data,
     forest->last_local_tree = -1;
     forest->local_num_elements = 0;
   }
+  t8_region_profile_leave (region_profile, "partition/recv_loop");
   /* Wait for all sends to complete */
+  t8_region_profile_enter (region_profile, "partition/send_wait");
   if (num_request_alloc > 0) {
     mpiret =
-      sc_MPI_Waitall (num_request_alloc, requests, sc_MPI_STATUSES_IGNORE);
+      t8_mpi_profile_waitall (num_request_alloc, requests, sc_MPI_STATUSES_IGNORE, T8_MPI_PROFILE_PARTITION);
     SC_CHECK_MPI (mpiret);
   }
+  t8_region_profile_leave (region_profile, "partition/send_wait");
   T8_FREE (requests);
   for (i = 0; i < num_request_alloc; i++) {
     T8_FREE (send_buffer[i]);
   }
   T8_FREE (send_buffer);
+  sc_array_reset (&self_blocks);
 
   t8_debugf ("Done partition_given\n");
 }
 
+/** Compute the number of elements that change their owning process between
+ * the partition of \a forest->set_from and the new partition of \a forest.
+ * The count is derived from the offset table of the old partition and the
+ * offset table (or the closed-form unweighted offsets) of the new one, so
+ * it involves no communication and every process computes the same value.
+ * \param [in] forest  A forest in construction whose new offsets are set.
+ * \return             The sum over the process boundaries of the number of
+ *                     elements shifted across them. Zero if and only if the
+ *                     new partition equals the old one.
+ */
+static t8_gloidx_t
+t8_forest_partition_moved_elements (t8_forest_t forest)
+{
+  t8_forest_t         forest_from = forest->set_from;
+  const t8_gloidx_t  *offset_from =
+    t8_shmem_array_get_gloidx_array (forest_from->element_offsets);
+  const t8_gloidx_t  *offset_to = forest->element_offsets != NULL ?
+    t8_shmem_array_get_gloidx_array (forest->element_offsets) : NULL;
+  t8_gloidx_t         moved = 0;
+  t8_gloidx_t         shift;
+  int                 iproc;
+
+  for (iproc = 1; iproc < forest->mpisize; iproc++) {
+    shift = (offset_to != NULL ? offset_to[iproc]
+             : t8_forest_partition_uniform_offset (iproc, forest->mpisize,
+                                                   forest_from->
+                                                   global_num_elements))
+      - offset_from[iproc];
+    moved += shift >= 0 ? shift : -shift;
+  }
+  return moved;
+}
+
 /* Populate a forest with the partitioned elements of
  * forest->set_from.
  * Currently the elements are distributed evenly (each element
@@ -1342,8 +1990,32 @@ t8_forest_partition (t8_forest_t forest)
   /* TODO: if offsets already exist on forest_from, check it for consistency */
 
   /* We now calculate the new element offsets */
-  t8_forest_partition_compute_new_offset (forest);
-  t8_forest_partition_given (forest, 0, NULL, NULL);
+  if (forest->set_partition_weight_fn != NULL) {
+    t8_forest_partition_compute_new_offset_weighted (forest);
+  }
+  else {
+    /* The unweighted offsets are given by a closed formula, so we do not
+     * materialize the offset array here. The send and receive ranges
+     * evaluate the formula for the O(1) neighbor offsets they need and
+     * the full array is built lazily by
+     * \ref t8_forest_partition_create_offsets when it is requested. */
+    forest->partition_is_uniform = 1;
+  }
+  if (t8_forest_partition_moved_elements (forest) == 0) {
+    /* The new partition equals the old one, so no element changes its
+     * owner. Skip the send/receive machinery entirely and copy the local
+     * elements directly. */
+    t8_debugf ("Partition is unchanged, copying the local elements.\n");
+    if (forest->trees != NULL) {
+      /* The caller allocated an empty trees array for the receive loop;
+       * t8_forest_copy_trees allocates its own. */
+      t8_forest_recycle_trees_retire (&forest->trees);
+    }
+    t8_forest_copy_trees (forest, forest_from, 1);
+  }
+  else {
+    t8_forest_partition_given (forest, 0, NULL, NULL);
+  }
 
   T8_ASSERT ((size_t) t8_forest_get_num_local_trees (forest_from)
              == forest_from->trees->elem_count);
@@ -1372,15 +2044,17 @@ t8_forest_partition (t8_forest_t forest)
   t8_global_productionf ("Done forest partition.\n");
 }
 
-void
-t8_forest_partition_data (t8_forest_t forest_from, t8_forest_t forest_to,
-                          const sc_array_t *data_in, sc_array_t *data_out)
+t8_forest_partition_data_handle_t
+t8_forest_partition_data_begin (t8_forest_t forest_from,
+                                t8_forest_t forest_to,
+                                const sc_array_t *data_in,
+                                sc_array_t *data_out)
 {
+  t8_forest_partition_data_handle_t handle;
   t8_forest_t         save_set_from;
+  int                 send_first, send_last, to_self;
 
-  t8_global_productionf ("Enter forest partition data.\n");
-  t8_log_indent_push ();
-
+  t8_debugf ("Start partition data begin\n");
   /* Assertions */
   T8_ASSERT (t8_forest_is_committed (forest_from));
   T8_ASSERT (t8_forest_is_committed (forest_to));
@@ -1403,14 +2077,197 @@ t8_forest_partition_data (t8_forest_t forest_from, t8_forest_t forest_to,
     t8_forest_partition_create_offsets (forest_to);
   }
 
-  /* perform the actual partitioning */
+  handle = T8_ALLOC_ZERO (struct t8_forest_partition_data_handle, 1);
+  handle->forest_from = forest_from;
+  handle->forest_to = forest_to;
+  handle->data_out = data_out;
+
+  /* The send and receive routines read the old partition from
+   * forest->set_from, so we install forest_from there for their duration. */
   save_set_from = forest_to->set_from;
   forest_to->set_from = forest_from;
-  t8_forest_partition_given (forest_to, 1, data_in, data_out);
+  /* Compute the first and last rank that we send to and post the
+   * nonblocking sends. The requests and buffers stay alive in the handle
+   * until t8_forest_partition_data_end waits for them. */
+  t8_forest_partition_sendrange (forest_to, &send_first, &send_last);
+  to_self =
+    t8_forest_partition_sendloop (forest_to, send_first, send_last,
+                                  &handle->requests,
+                                  &handle->num_request_alloc,
+                                  &handle->send_buffer, 1, data_in,
+                                  &handle->byte_to_self, NULL);
   forest_to->set_from = save_set_from;
+  if (to_self) {
+    /* We have sent data to ourselves. */
+    handle->sent_to_self =
+      *(handle->send_buffer + forest_to->mpirank - send_first);
+  }
+
+  /* Let the async progress engine (if enabled) drive the sends while the
+   * caller computes, see t8_progress.h. */
+  t8_progress_begin ();
+
+  t8_debugf ("Done partition data begin\n");
+  return handle;
+}
+
+void
+t8_forest_partition_data_end (t8_forest_partition_data_handle_t *phandle,
+                              t8_forest_partition_data_range_t range_callback,
+                              void *user_data)
+{
+  t8_forest_partition_data_handle_t handle;
+  t8_forest_t         forest_to, save_set_from;
+  int                 recv_first, recv_last;
+  int                 mpiret, i;
+
+  T8_ASSERT (phandle != NULL && *phandle != NULL);
+  handle = *phandle;
+  forest_to = handle->forest_to;
+
+  t8_debugf ("Start partition data end\n");
+  save_set_from = forest_to->set_from;
+  forest_to->set_from = handle->forest_from;
+  if (forest_to->local_num_elements > 0) {
+    /* Receive the data from the other ranks. Each received message is a
+     * contiguous range of the new local elements and is reported to the
+     * caller as soon as it arrived. */
+    t8_forest_partition_recvrange (forest_to, &recv_first, &recv_last);
+    t8_forest_partition_recvloop (forest_to, recv_first, recv_last, 1,
+                                  handle->data_out, handle->sent_to_self,
+                                  handle->byte_to_self, NULL, range_callback,
+                                  user_data);
+  }
+  forest_to->set_from = save_set_from;
+
+#if T8_ENABLE_MPI
+  /* Drive speculative child generation of the new partition while the
+   * sends are in flight, see t8_forest_set_speculation. */
+  while (handle->num_request_alloc > 0
+         && t8_forest_speculation_pending (forest_to)) {
+    int                 done;
+
+    mpiret = MPI_Testall (handle->num_request_alloc, handle->requests, &done,
+                          sc_MPI_STATUSES_IGNORE);
+    SC_CHECK_MPI (mpiret);
+    if (done) {
+      break;
+    }
+    t8_forest_speculation_progress (forest_to, T8_FOREST_SPECULATE_CHUNK);
+  }
+#endif
+  /* Wait for all sends to complete */
+  if (handle->num_request_alloc > 0) {
+    mpiret = t8_mpi_profile_waitall (handle->num_request_alloc, handle->requests,
+                                     sc_MPI_STATUSES_IGNORE, T8_MPI_PROFILE_PARTITION);
+    SC_CHECK_MPI (mpiret);
+  }
+  /* The phase announced in the begin call is over, the progress engine
+   * can go back to sleep. */
+  t8_progress_end ();
+  T8_FREE (handle->requests);
+  for (i = 0; i < handle->num_request_alloc; i++) {
+    T8_FREE (handle->send_buffer[i]);
+  }
+  T8_FREE (handle->send_buffer);
+  T8_FREE (handle);
+  *phandle = NULL;
+  t8_debugf ("Done partition data end\n");
+}
+
+void
+t8_forest_partition_data (t8_forest_t forest_from, t8_forest_t forest_to,
+                          const sc_array_t *data_in, sc_array_t *data_out)
+{
+  t8_forest_partition_data_handle_t handle;
+
+  t8_global_productionf ("Enter forest partition data.\n");
+  t8_log_indent_push ();
+
+  /* The blocking version is the split-phase transfer with no computation
+   * in between */
+  handle =
+    t8_forest_partition_data_begin (forest_from, forest_to, data_in,
+                                    data_out);
+  t8_forest_partition_data_end (&handle, NULL, NULL);
 
   t8_log_indent_pop ();
   t8_global_productionf ("Done forest partition data.\n");
 }
 
+void
+t8_forest_partition_data_multiple (t8_forest_t forest_from,
+                                   t8_forest_t forest_to,
+                                   const int num_arrays,
+                                   const sc_array_t **data_in,
+                                   sc_array_t **data_out)
+{
+  sc_array_t          batch_in, batch_out;
+  size_t              batch_size, offset;
+  size_t              ielem;
+  char               *batch_entry;
+  int                 iarray;
+
+  T8_ASSERT (t8_forest_is_committed (forest_from));
+  T8_ASSERT (t8_forest_is_committed (forest_to));
+  T8_ASSERT (num_arrays >= 0);
+
+  if (num_arrays <= 0) {
+    /* Nothing to transfer */
+    return;
+  }
+  if (num_arrays == 1) {
+    /* A single array does not need the batching detour */
+    t8_forest_partition_data (forest_from, forest_to, data_in[0],
+                              data_out[0]);
+    return;
+  }
+
+  /* The batched payload of an element is the concatenation of this
+   * element's entries of all arrays. */
+  batch_size = 0;
+  for (iarray = 0; iarray < num_arrays; iarray++) {
+    T8_ASSERT (data_in[iarray] != NULL && data_out[iarray] != NULL);
+    T8_ASSERT (data_in[iarray]->elem_size == data_out[iarray]->elem_size);
+    T8_ASSERT (data_in[iarray]->elem_count
+               == (size_t) forest_from->local_num_elements);
+    T8_ASSERT (data_out[iarray]->elem_count
+               == (size_t) forest_to->local_num_elements);
+    batch_size += data_in[iarray]->elem_size;
+  }
+
+  /* Gather the entries of all arrays into the batched input array */
+  sc_array_init_size (&batch_in, batch_size,
+                      (size_t) forest_from->local_num_elements);
+  sc_array_init_size (&batch_out, batch_size,
+                      (size_t) forest_to->local_num_elements);
+  for (ielem = 0; ielem < batch_in.elem_count; ielem++) {
+    batch_entry = (char *) sc_array_index (&batch_in, ielem);
+    offset = 0;
+    for (iarray = 0; iarray < num_arrays; iarray++) {
+      memcpy (batch_entry + offset,
+              sc_array_index ((sc_array_t *) data_in[iarray], ielem),
+              data_in[iarray]->elem_size);
+      offset += data_in[iarray]->elem_size;
+    }
+  }
+
+  /* Transfer the batch with a single plan. Independent of the number of
+   * arrays we send one message per communicating process pair. */
+  t8_forest_partition_data (forest_from, forest_to, &batch_in, &batch_out);
+
+  /* Scatter the batched entries back into the output arrays */
+  for (ielem = 0; ielem < batch_out.elem_count; ielem++) {
+    batch_entry = (char *) sc_array_index (&batch_out, ielem);
+    offset = 0;
+    for (iarray = 0; iarray < num_arrays; iarray++) {
+      memcpy (sc_array_index (data_out[iarray], ielem),
+              batch_entry + offset, data_out[iarray]->elem_size);
+      offset += data_out[iarray]->elem_size;
+    }
+  }
+  sc_array_reset (&batch_in);
+  sc_array_reset (&batch_out);
+}
+
 T8_EXTERN_C_END ();
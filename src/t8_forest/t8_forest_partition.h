@@ -42,6 +42,45 @@ void                t8_forest_partition (t8_forest_t forest);
  */
 void                t8_forest_partition_create_offsets (t8_forest_t forest);
 
+/** Create the two level node offset array of a partitioned forest.
+ * The ranks of each compute node form one block of consecutive entries of
+ * the element offset array; the node offset array stores one entry per
+ * node with the first element and the first rank of its block, so it is
+ * smaller than the element offset array by the ranks-per-node factor.
+ * It is built from the node local copy of the element offset array: only
+ * one entry per node crosses the network, the subdivision among the node
+ * local ranks is read from the existing shared memory array.
+ * If the ranks of a node are not consecutive in the communicator, a
+ * single block spanning all ranks is created and the two level lookup
+ * degenerates to the flat binary search; renumber the communicator with
+ * \ref t8_shmem_new_node_ordered_comm to guarantee consecutive blocks.
+ * \param [in,out]  forest The forest.
+ * \a forest must be committed before calling this function.
+ * \see t8_forest_partition_two_level_owner
+ */
+void                t8_forest_partition_create_node_offsets (t8_forest_t
+                                                             forest);
+
+/** Find the owner process of a global element index with the two level
+ * node offset array: the owning node is resolved first by binary search
+ * over the node blocks, then the rank within the node block by binary
+ * search over the node's slice of the element offset array.
+ * Both arrays are read from node shared memory, so the lookup performs no
+ * communication.
+ * \param [in]      forest The forest. Its node offset array must have been
+ *                         created with
+ *                         \ref t8_forest_partition_create_node_offsets.
+ * \param [in]      gelement A global element index of \a forest.
+ * \param [out]     pnode  If not NULL, filled with the index of the node
+ *                         block that owns \a gelement.
+ * \return                 The rank that owns \a gelement. Empty ranks are
+ *                         never returned.
+ */
+int                 t8_forest_partition_two_level_owner (t8_forest_t forest,
+                                                         t8_gloidx_t
+                                                         gelement,
+                                                         int *pnode);
+
 /** If \ref t8_forest_partition_create_offsets was already called,
  * compute for a given rank the next greater rank that is not empty.
  * \param [in]      forest The forest.
@@ -78,6 +117,108 @@ void                t8_forest_partition_data (t8_forest_t forest_from,
                                               const sc_array_t *data_in,
                                               sc_array_t *data_out);
 
+/** Repartition several per element data arrays at once.
+ * The arrays are batched into a single payload, thus the transfer uses
+ * the same send and receive ranges as \ref t8_forest_partition_data and
+ * posts one message per communicating process pair independent of the
+ * number of arrays.
+ * \param [in] forest_from  The forest of the old partition. Must be
+ *                          committed.
+ * \param [in] forest_to    The forest of the new partition. Must be
+ *                          committed and must carry the same global
+ *                          elements as \a forest_from.
+ * \param [in] num_arrays   The number of data arrays to repartition.
+ * \param [in] data_in      \a num_arrays arrays, each with one entry per
+ *                          local element of \a forest_from. The entry
+ *                          sizes of different arrays may differ.
+ * \param [in,out] data_out \a num_arrays arrays, each with one entry per
+ *                          local element of \a forest_to and the same
+ *                          entry size as the matching \a data_in array.
+ */
+void                t8_forest_partition_data_multiple (t8_forest_t
+                                                       forest_from,
+                                                       t8_forest_t forest_to,
+                                                       const int num_arrays,
+                                                       const sc_array_t
+                                                       **data_in,
+                                                       sc_array_t **data_out);
+
+/** Opaque handle of a split-phase data partition.
+ * It is created by \ref t8_forest_partition_data_begin and must be
+ * completed with exactly one call to \ref t8_forest_partition_data_end.
+ */
+typedef struct t8_forest_partition_data_handle
+  *t8_forest_partition_data_handle_t;
+
+/** Callback to process a contiguous range of repartitioned element data
+ * as soon as it arrived, before the remaining messages are received.
+ * The ranges are reported in ascending order and cover all local elements
+ * of the new partition exactly once.
+ * \param [in] forest_to     The forest of the new partition.
+ * \param [in] first_element The new local index of the first element of
+ *                           the range.
+ * \param [in] num_elements  The number of elements in the range.
+ * \param [in] data_out      The output data array. The entries of the
+ *                           range are valid, later entries may not be.
+ * \param [in] user_data     The pointer passed to
+ *                           \ref t8_forest_partition_data_end.
+ */
+typedef void        (*t8_forest_partition_data_range_t) (t8_forest_t
+                                                         forest_to,
+                                                         t8_locidx_t
+                                                         first_element,
+                                                         t8_locidx_t
+                                                         num_elements,
+                                                         sc_array_t
+                                                         *data_out,
+                                                         void *user_data);
+
+/** Start a split-phase repartition of element data.
+ * The outgoing data is posted as nonblocking sends and control returns to
+ * the caller, who can overlap computation on the elements it keeps with
+ * the transfer and later complete it with
+ * \ref t8_forest_partition_data_end.
+ * The semantics of the arguments are those of
+ * \ref t8_forest_partition_data.
+ * \param [in] forest_from  The forest of the old partition. Must be
+ *                          committed.
+ * \param [in] forest_to    The forest of the new partition. Must be
+ *                          committed and must carry the same global
+ *                          elements as \a forest_from.
+ * \param [in] data_in      Per element data of the old partition, one
+ *                          entry per local element of \a forest_from.
+ *                          Must not be modified before the matching end
+ *                          call.
+ * \param [in,out] data_out On input an array with one entry per local
+ *                          element of \a forest_to and the same entry
+ *                          size as \a data_in. Filled by the matching
+ *                          end call.
+ * \return                  A handle that must be passed to
+ *                          \ref t8_forest_partition_data_end.
+ */
+t8_forest_partition_data_handle_t
+t8_forest_partition_data_begin (t8_forest_t forest_from,
+                                t8_forest_t forest_to,
+                                const sc_array_t *data_in,
+                                sc_array_t *data_out);
+
+/** Complete a split-phase repartition of element data.
+ * Receives the incoming messages, optionally reporting each received
+ * contiguous range via \a range_callback so the caller can start working
+ * on it while later messages are still in transit, waits for the posted
+ * sends and frees the handle.
+ * \param [in,out] phandle  Pointer to a handle created by
+ *                          \ref t8_forest_partition_data_begin.
+ *                          Set to NULL on output.
+ * \param [in] range_callback If not NULL, called once per received
+ *                          contiguous element range, in ascending order.
+ * \param [in] user_data    Arbitrary pointer passed to
+ *                          \a range_callback.
+ */
+void                t8_forest_partition_data_end
+  (t8_forest_partition_data_handle_t *phandle,
+   t8_forest_partition_data_range_t range_callback, void *user_data);
+
 /** Test if the last descendant of the last element of current rank has
  * a smaller linear id than the stored first descendant of rank+1.
  * If this is not the case, elements overlap.
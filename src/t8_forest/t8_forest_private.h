@@ -32,6 +32,7 @@
 
 #include <t8.h>
 #include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_types.h>
 
 T8_EXTERN_C_BEGIN ();
 
@@ -65,7 +66,22 @@ int                 t8_forest_is_incomplete_family (const t8_forest_t forest,
                                                     t8_element_t **elements,
                                                     const int elements_size);
 
-/* For each tree in a forest compute its first and last descendant */
+/** Compute a hash over the (level, linear id) pairs of the leaf
+ * elements of a local tree. Two trees with the same leaf sequence hash
+ * equally, so equal hashes detect unchanged trees without an
+ * element-wise comparison, \see t8_forest_diff.
+ * \param [in]      forest    A committed forest.
+ * \param [in]      ltree_id  A local tree id of \a forest.
+ * \param [in]      ts        The eclass scheme of the tree.
+ * \return          The hash of the leaf sequence of the tree.
+ */
+uint64_t            t8_forest_tree_leaf_checksum (t8_forest_t forest,
+                                                  t8_locidx_t ltree_id,
+                                                  t8_eclass_scheme_c *ts);
+
+/* For each tree in a forest invalidate its stored first and last
+ * descendant. The descendants are computed lazily on the first access
+ * per tree, so commit does not pay a scheme call sweep over all trees. */
 void                t8_forest_compute_desc (t8_forest_t forest);
 
 /* Create the elements on this process given a uniform partition
@@ -135,6 +151,27 @@ void                t8_forest_copy_trees (t8_forest_t forest,
                                           t8_forest_t from,
                                           int copy_elements);
 
+/** Obtain a trees array with entry type \ref t8_tree_struct_t, reusing a
+ * retained array from the forest recycling pool if one is available.
+ * The recycling pool keeps the skeleton allocations of destroyed forests
+ * so that adapt/partition pipelines that rebuild the forest at a high
+ * rate do not stress the allocator.
+ * \param [in] num_trees  The number of (uninitialized) tree entries the
+ *                        returned array holds.
+ * \return                An array of \a num_trees entries of size
+ *                        sizeof (t8_tree_struct_t).
+ */
+sc_array_t         *t8_forest_recycle_trees_new (t8_locidx_t num_trees);
+
+/** Hand a trees array back to the forest recycling pool, or destroy it
+ * if the pool is full.  The element arrays of all tree entries must have
+ * been reset before calling this function.
+ * \param [in,out] ptrees On input a pointer to a trees array as returned
+ *                        by \ref t8_forest_recycle_trees_new.
+ *                        Set to NULL on output.
+ */
+void                t8_forest_recycle_trees_retire (sc_array_t **ptrees);
+
 /** Given the local id of a tree in a forest, return the coarse tree of the
  * cmesh that corresponds to this tree, also return the neighbor information of
  * the tree.
@@ -163,6 +200,15 @@ t8_ctree_t          t8_forest_get_coarse_tree_ext (t8_forest_t forest,
  */
 void                t8_forest_compute_elements_offset (t8_forest_t forest);
 
+/** Return the scratch arena of a forest for short-lived elements.
+ * The arena is created on the first call and destroyed together with
+ * the forest. Internal routines use it for temporary elements instead
+ * of \ref t8_element_new to avoid the per element mempool bookkeeping.
+ * \param [in,out] forest  The forest.
+ * \return      Returns the scratch arena of \a forest.
+ */
+t8_element_scratch_t *t8_forest_get_element_scratch (t8_forest_t forest);
+
 /** Return an element of a tree.
  * \param [in]  tree  The tree.
  * \param [in]  elem_in_tree The index of the element within the tree.
@@ -181,6 +227,48 @@ t8_element_t       *t8_forest_get_tree_element (t8_tree_t tree,
 t8_element_array_t *t8_forest_get_tree_element_array (t8_forest_t forest,
                                                       t8_locidx_t ltreeid);
 
+/** Return the hot tree table of a committed forest.
+ * The table duplicates the traversal relevant fields of the tree structs
+ * into dense, cache-line aligned 32 byte records, so that leaf lookups
+ * do not stride over the cold bytes of \ref t8_tree_struct_t.
+ * It is built on the first call and destroyed together with the forest.
+ * \param [in,out] forest  The forest. Must be committed.
+ * \return      An array with one \ref t8_tree_hot_struct_t per local tree.
+ */
+t8_tree_hot_struct_t *t8_forest_get_tree_hot (t8_forest_t forest);
+
+/** Return the communicator that carries the ghost traffic of a forest.
+ * This is the dedicated ghost communicator if communicator isolation was
+ * requested and the forest's \a mpicomm otherwise. Both span the same
+ * ranks, \see t8_forest_set_comm_isolation.
+ * \param [in] forest   A forest whose communicator is set up.
+ * \return    The communicator to use for ghost messages and collectives.
+ */
+sc_MPI_Comm         t8_forest_comm_for_ghost (t8_forest_t forest);
+
+/** Return the communicator that carries the partition traffic of a forest.
+ * This is the dedicated partition communicator if communicator isolation
+ * was requested and the forest's \a mpicomm otherwise. Both span the same
+ * ranks, \see t8_forest_set_comm_isolation.
+ * \param [in] forest   A forest whose communicator is set up.
+ * \return    The communicator to use for partition messages and collectives.
+ */
+sc_MPI_Comm         t8_forest_comm_for_partition (t8_forest_t forest);
+
+/** Search for a linear element id (at forest->maxlevel) in a sorted array of
+ * elements. If the element does not exist, return the largest index i
+ * such that the element at position i has a smaller id than the given one.
+ * If no such i exists, return -1.
+ * \param [in]  elements   A sorted array of elements.
+ * \param [in]  element_id The linear element id to search for.
+ * \param [in]  maxlevel   The level at which the linear ids are computed.
+ * \return      The index of the largest element in \a elements with linear
+ *              id smaller or equal to \a element_id, or -1.
+ */
+t8_locidx_t         t8_forest_bin_search_lower (t8_element_array_t *elements,
+                                                t8_linearidx_t element_id,
+                                                int maxlevel);
+
 /** Find the owner process of a given element, deprecated version.
  * Use t8_forest_element_find_owner instead.
  * \param [in]    forest  The forest.
@@ -229,6 +317,28 @@ int                 t8_forest_element_find_owner (t8_forest_t forest,
                                                   t8_element_t *element,
                                                   t8_eclass_t eclass);
 
+/** Find the owner process of a given element with a caller provided cache.
+ * Behaves like \ref t8_forest_element_find_owner, but reads and updates the
+ * cache of the previously found owner through \a last_owner instead of the
+ * forest's internal cache. Threaded callers use one cache per thread, so
+ * concurrent owner queries do not write to shared forest state.
+ * \param [in]    forest  The forest.
+ * \param [in]    gtreeid The global id of the tree in which the element lies.
+ * \param [in]    element The element to look for.
+ * \param [in]    eclass  The element class of the tree \a gtreeid.
+ * \param [in,out] last_owner On input, the result of the previous query
+ *                        through this cache, or -1 for the first query.
+ *                        On output, the owner of \a element.
+ * \return                The mpirank of the process that owns \a element.
+ * \see t8_forest_element_find_owner
+ */
+int                 t8_forest_element_find_owner_cached (t8_forest_t forest,
+                                                         t8_gloidx_t gtreeid,
+                                                         t8_element_t
+                                                         *element,
+                                                         t8_eclass_t eclass,
+                                                         int *last_owner);
+
 /** Find the owner process of a given element, if bounds for the owner process are known.
  * \param [in]    forest  The forest.
  * \param [in]    gtreeid The global id of the tree in which the element lies.
@@ -258,6 +368,31 @@ int                 t8_forest_element_find_owner_ext (t8_forest_t forest,
                                                       int guess,
                                                       int element_is_desc);
 
+/** Find the owner processes of a sorted sequence of elements in one sweep.
+ * The elements must all lie in the same tree and must ascend along the
+ * space-filling curve. The owner of each element then bounds the owner of
+ * the next one from below, so the ranks are traversed only once for the
+ * whole sequence instead of one independent binary search per element.
+ * \param [in]    forest  The forest.
+ * \param [in]    gtreeid The global id of the tree in which the elements lie.
+ * \param [in]    elements An array of \a num_elements elements, sorted in
+ *                        ascending space-filling curve order.
+ * \param [in]    num_elements The number of elements in \a elements.
+ * \param [in]    eclass  The element class of the tree \a gtreeid.
+ * \param [out]   owners  An array of \a num_elements integers. On output,
+ *                        the i-th entry is the mpirank that owns the i-th
+ *                        element.
+ * \note \a forest must be committed before calling this function.
+ * \see t8_forest_element_find_owner
+ */
+void                t8_forest_element_find_owners_range (t8_forest_t forest,
+                                                         t8_gloidx_t gtreeid,
+                                                         t8_element_t
+                                                         **elements,
+                                                         int num_elements,
+                                                         t8_eclass_t eclass,
+                                                         int *owners);
+
 /** Perform a constant runtime check if a given rank is owner of a given element.
  * If the element is owned by more than one rank, then this check is only true
  * for the smallest.
@@ -445,6 +580,23 @@ t8_gloidx_t         t8_forest_element_half_face_neighbors (t8_forest_t forest,
  */
 void                t8_forest_print_all_leaf_neighbors (t8_forest_t forest);
 
+/** Compute the fixed point grid of the quantized coordinate output.
+ * The grid spans the bounding box of the coarse mesh vertices (for trees
+ * without vertex attribute of the geometry evaluated at the reference
+ * corners) with 2^quantization_bits steps per dimension, where the number
+ * of bits was set via \ref t8_forest_set_coordinate_precision.
+ * This function is collective over the forest communicator, so all
+ * processes agree on the grid.
+ * \param [in]  forest   A committed forest with
+ *                       \ref T8_COORD_PRECISION_QUANTIZED selected.
+ * \param [out] box_min  The minimal corner of the bounding box.
+ * \param [out] step     The grid step per dimension, 0 for flat dimensions.
+ */
+void                t8_forest_coordinate_quantization_grid (t8_forest_t
+                                                            forest,
+                                                            double box_min[3],
+                                                            double step[3]);
+
 /** Compute whether for a given element there exist leaf or ghost leaf elements in
  * the local forest that are a descendant of the element but not the element itself
  * \param [in]  forest    The forest.
@@ -462,6 +614,128 @@ int                 t8_forest_element_has_leaf_desc (t8_forest_t forest,
                                                      *element,
                                                      t8_eclass_scheme_c *ts);
 
+/** Initialize a shared memory array of a forest, reusing a parked array of
+ * the forest's commit context if one with matching element size and count is
+ * available. Otherwise a new array is created on the forest's communicator
+ * with \ref t8_shmem_array_init, as before.
+ * Since parking in \ref t8_forest_unref and matching are deterministic and
+ * symmetric across the processes, all processes take the same branch and the
+ * collective semantics of \ref t8_shmem_array_init are preserved.
+ * \param [in,out]  forest      A forest whose communicator is set.
+ * \param [out]     parray      On input the array pointer must be NULL. On
+ *                              output it points to an allocated shared memory
+ *                              array with unspecified contents.
+ * \param [in]      elem_size   The size in bytes of one array element.
+ * \param [in]      elem_count  The number of array elements.
+ */
+void                t8_forest_shmem_array_init (t8_forest_t forest,
+                                                t8_shmem_array_t *parray,
+                                                size_t elem_size,
+                                                size_t elem_count);
+
+/** One (tree, level, linear id) record per leaf element. A sequence of
+ * these records sorted by the global element index describes the leafs
+ * of a forest independently of the element memory layout and of the
+ * number of processes. The checkpoint files store one such record per
+ * element and the communicator migration ships them between processes,
+ * \see t8_forest_build_from_records. */
+typedef struct t8_forest_leaf_record
+{
+  t8_gloidx_t         gtree;    /**< global id of the tree of the element */
+  t8_linearidx_t      linear_id;        /**< linear id of the element on its level */
+  int32_t             level;    /**< refinement level of the element */
+  int32_t             pad;      /**< explicit padding, always 0 */
+} t8_forest_leaf_record_t;
+
+/** Build a committed forest from this process' slice of a global
+ * sequence of leaf records.
+ * The records must be the contiguous slice of the global, element index
+ * sorted record sequence that this process is to own. A matching
+ * partition of \a cmesh is derived and committed internally, then the
+ * elements are created from the records following the commit path of a
+ * forest that is constructed solely from its cmesh. Collective over
+ * \a comm.
+ * \param [in]  cmesh    A committed cmesh matching the trees of the
+ *                       records. Its reference count is unchanged.
+ * \param [in]  scheme   The element scheme of the forest. The function
+ *                       takes ownership of this reference.
+ * \param [in]  comm     The communicator to build the forest on.
+ * \param [in]  records  The \a num_local_elements records of this
+ *                       process, sorted by the global element index.
+ * \param [in]  num_local_elements The number of local records.
+ * \param [in]  global_num_elements The global number of elements. Must
+ *                       equal the sum of \a num_local_elements over
+ *                       \a comm.
+ * \param [in]  prev_record If not NULL, the record preceding
+ *                       \a records[0] globally. It decides whether the
+ *                       first local tree is shared with a smaller
+ *                       process and must be provided whenever such a
+ *                       record exists and \a num_local_elements > 0.
+ * \param [in]  next_record If not NULL, the record following the slice
+ *                       globally. It places an empty process on a tree
+ *                       and must be provided whenever such a record
+ *                       exists and \a num_local_elements == 0.
+ * \return               The committed forest.
+ */
+t8_forest_t         t8_forest_build_from_records (t8_cmesh_t cmesh,
+                                                  t8_scheme_cxx_t *scheme,
+                                                  sc_MPI_Comm comm,
+                                                  const t8_forest_leaf_record_t
+                                                  *records,
+                                                  t8_locidx_t
+                                                  num_local_elements,
+                                                  t8_gloidx_t
+                                                  global_num_elements,
+                                                  const t8_forest_leaf_record_t
+                                                  *prev_record,
+                                                  const t8_forest_leaf_record_t
+                                                  *next_record);
+
+/** The number of leafs one speculation step examines between two polls of
+ * the pending communication, \see t8_forest_speculation_progress. */
+#define T8_FOREST_SPECULATE_CHUNK 64
+
+/** Query whether a forest has speculative work left.
+ * \param [in]      forest     A committed forest.
+ * \return  Nonzero if a predictor is registered via
+ *          \ref t8_forest_set_speculation and not all local leafs have
+ *          been examined yet.
+ */
+int                 t8_forest_speculation_pending (t8_forest_t forest);
+
+/** Advance the speculative child generation of a forest: examine up to
+ * \a num_leaves local leafs with the registered predictor and pre-generate
+ * the children of flagged leafs into the side pool.
+ * Called from the communication wait loops of the split-phase ghost and
+ * partition data exchanges. Process local, performs no communication.
+ * \param [in,out]  forest     A committed forest with a registered
+ *                             predictor, \see t8_forest_set_speculation.
+ * \param [in]      num_leaves The maximal number of leafs to examine.
+ */
+void                t8_forest_speculation_progress (t8_forest_t forest,
+                                                    t8_locidx_t num_leaves);
+
+/** Try to serve the children of a leaf that is being refined from the
+ * speculation pool of the source forest.
+ * On a hit the pre-generated children are copied into \a elements and the
+ * pool entry is released.
+ * \param [in,out]  forest_from The source forest of the adaptation.
+ * \param [in]      lelement    The forest local index of the refined leaf.
+ * \param [in]      ts          The eclass scheme of the leaf's tree.
+ * \param [in]      num_children The number of children to produce.
+ * \param [in,out]  elements    Pointers to \a num_children element slots.
+ * \return  True if the children were copied from the pool, false if the
+ *          caller must compute them.
+ */
+int                 t8_forest_speculation_consume (t8_forest_t forest_from,
+                                                   t8_locidx_t lelement,
+                                                   t8_eclass_scheme_c *ts,
+                                                   int num_children,
+                                                   t8_element_t **elements);
+
+/** Free the speculation state of a forest, if any. */
+void                t8_forest_speculation_destroy (t8_forest_t forest);
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_FOREST_PRIVATE_H! */
@@ -32,6 +32,10 @@
 /*TODO: Check if all headers are needed */
 #include <sc_statistics.h>
 #include <t8_cmesh.h>
+/* Per phase communication matrices and wait time histograms; enable the
+ * recording with t8_mpi_profile_enable and print it with
+ * t8_mpi_profile_dump. */
+#include <t8_mpi_profile.h>
 T8_EXTERN_C_BEGIN ();
 
 /** Enable or disable profiling for a forest. If profiling is enabled, runtimes
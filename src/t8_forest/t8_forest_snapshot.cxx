@@ -0,0 +1,373 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/* In this file we implement compact in-memory snapshots of a forest,
+ * see t8_forest_snapshot.h. A committed forest is fully described by
+ * its partition and, per local tree, the sequence of leaf levels along
+ * the space filling curve. We store the level sequences delta-encoded
+ * in a bit stream: neighboring leafs rarely differ by more than one
+ * level, so almost every leaf costs two bits. The reconstruction walks
+ * the stream and rebuilds each leaf from the maxlevel linear id right
+ * after the last descendant of its predecessor, following the commit
+ * path of a forest that is constructed solely from its cmesh as the
+ * checkpoint loading does. */
+
+#include <t8_cmesh.h>
+#include <t8_element_cxx.hxx>
+#include <t8_data/t8_containers.h>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_snapshot.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_forest/t8_forest_partition.h>
+
+/* The two bit symbols of the delta stream. Symbol escape is followed by
+ * eight bits storing the level difference plus 128. */
+#define T8_SNAPSHOT_DELTA_SAME 0
+#define T8_SNAPSHOT_DELTA_FINER 1
+#define T8_SNAPSHOT_DELTA_COARSER 2
+#define T8_SNAPSHOT_DELTA_ESCAPE 3
+
+/* The per tree storage of a snapshot. */
+typedef struct t8_forest_snapshot_tree
+{
+  t8_eclass_t         eclass;   /* The element class of the tree */
+  t8_locidx_t         num_elements;     /* The number of local leafs of the tree */
+  int8_t              first_level;      /* The level of the first local leaf */
+  t8_linearidx_t      first_desc_id;    /* The maxlevel linear id of the first
+                                           local leaf's first descendant. The
+                                           first local tree of a process may
+                                           start in the middle of the tree. */
+  size_t              num_bytes;        /* The byte count of the delta stream */
+  uint8_t            *stream;   /* The delta encoded levels of the leafs
+                                   after the first one */
+} t8_forest_snapshot_tree_t;
+
+/* The snapshot of a committed forest. It stores the leaf structure and
+ * the partition, plus references to the cmesh and the scheme that are
+ * needed to reconstruct the forest. */
+struct t8_forest_snapshot
+{
+  t8_cmesh_t          cmesh;    /* The (referenced) cmesh of the forest */
+  t8_scheme_cxx_t    *scheme_cxx;       /* The (referenced) scheme of the forest */
+  sc_MPI_Comm         mpicomm;  /* The communicator of the forest */
+  t8_gloidx_t         first_local_tree; /* The global id of the first local tree */
+  t8_gloidx_t         last_local_tree;  /* The global id of the last local tree */
+  t8_locidx_t         local_num_elements;       /* The number of process local leafs */
+  t8_gloidx_t         global_num_elements;      /* The number of global leafs */
+  sc_array_t         *trees;    /* The per tree streams, an array of
+                                   t8_forest_snapshot_tree_t */
+};
+
+/* A growing bit stream writer for the delta encoding. */
+typedef struct
+{
+  uint8_t            *bytes;    /* The stream storage */
+  size_t              byte_alloc;       /* The allocated byte count */
+  size_t              num_bits; /* The number of bits written so far */
+} t8_snapshot_bitstream_t;
+
+/* Append the \a num_bits lowest bits of \a value to the stream, least
+ * significant bit first. */
+static void
+t8_snapshot_bitstream_push (t8_snapshot_bitstream_t *stream,
+                            unsigned value, int num_bits)
+{
+  int                 ibit;
+  size_t              byte_pos;
+
+  for (ibit = 0; ibit < num_bits; ibit++) {
+    byte_pos = stream->num_bits / 8;
+    if (byte_pos >= stream->byte_alloc) {
+      /* Grow the storage by doubling */
+      stream->byte_alloc = SC_MAX (2 * stream->byte_alloc, (size_t) 16);
+      stream->bytes = T8_REALLOC (stream->bytes, uint8_t,
+                                  stream->byte_alloc);
+    }
+    if (stream->num_bits % 8 == 0) {
+      /* We enter a fresh byte, clear it */
+      stream->bytes[byte_pos] = 0;
+    }
+    stream->bytes[byte_pos] |=
+      (uint8_t) (((value >> ibit) & 1) << (stream->num_bits % 8));
+    stream->num_bits++;
+  }
+}
+
+/* Read \a num_bits bits from the stream at the bit position \a bitpos,
+ * advancing the position. Inverse of \ref t8_snapshot_bitstream_push. */
+static unsigned
+t8_snapshot_bitstream_pull (const uint8_t *bytes, size_t *bitpos,
+                            int num_bits)
+{
+  unsigned            value = 0;
+  int                 ibit;
+
+  for (ibit = 0; ibit < num_bits; ibit++) {
+    value |= (unsigned) ((bytes[*bitpos / 8] >> (*bitpos % 8)) & 1) << ibit;
+    (*bitpos)++;
+  }
+  return value;
+}
+
+/* Append the level difference of two consecutive leafs to the stream. */
+static void
+t8_snapshot_encode_delta (t8_snapshot_bitstream_t *stream, int delta)
+{
+  if (delta == 0) {
+    t8_snapshot_bitstream_push (stream, T8_SNAPSHOT_DELTA_SAME, 2);
+  }
+  else if (delta == 1) {
+    t8_snapshot_bitstream_push (stream, T8_SNAPSHOT_DELTA_FINER, 2);
+  }
+  else if (delta == -1) {
+    t8_snapshot_bitstream_push (stream, T8_SNAPSHOT_DELTA_COARSER, 2);
+  }
+  else {
+    T8_ASSERT (-128 <= delta && delta < 128);
+    t8_snapshot_bitstream_push (stream, T8_SNAPSHOT_DELTA_ESCAPE, 2);
+    t8_snapshot_bitstream_push (stream, (unsigned) (delta + 128), 8);
+  }
+}
+
+/* Read the next level difference from the stream. */
+static int
+t8_snapshot_decode_delta (const uint8_t *bytes, size_t *bitpos)
+{
+  unsigned            symbol;
+
+  symbol = t8_snapshot_bitstream_pull (bytes, bitpos, 2);
+  switch (symbol) {
+  case T8_SNAPSHOT_DELTA_SAME:
+    return 0;
+  case T8_SNAPSHOT_DELTA_FINER:
+    return 1;
+  case T8_SNAPSHOT_DELTA_COARSER:
+    return -1;
+  default:
+    return (int) t8_snapshot_bitstream_pull (bytes, bitpos, 8) - 128;
+  }
+}
+
+t8_forest_snapshot_t
+t8_forest_snapshot_create (t8_forest_t forest)
+{
+  t8_forest_snapshot_t snapshot;
+  t8_forest_snapshot_tree_t *snap_tree;
+  t8_snapshot_bitstream_t stream;
+  t8_tree_t           tree;
+  t8_eclass_scheme_c *ts;
+  const t8_element_t *element;
+  t8_locidx_t         itree, num_local_trees, ielement;
+  int                 elem_maxlevel, level, prev_level;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  snapshot = T8_ALLOC_ZERO (struct t8_forest_snapshot, 1);
+  /* The snapshot keeps the cmesh and the scheme alive; they are shared
+   * with the forest and any reconstruction. */
+  snapshot->cmesh = forest->cmesh;
+  t8_cmesh_ref (snapshot->cmesh);
+  snapshot->scheme_cxx = forest->scheme_cxx;
+  t8_scheme_cxx_ref (snapshot->scheme_cxx);
+  snapshot->mpicomm = forest->mpicomm;
+  snapshot->first_local_tree = forest->first_local_tree;
+  snapshot->last_local_tree = forest->last_local_tree;
+  snapshot->local_num_elements = forest->local_num_elements;
+  snapshot->global_num_elements = forest->global_num_elements;
+
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  snapshot->trees = sc_array_new_count (sizeof (t8_forest_snapshot_tree_t),
+                                        num_local_trees);
+  for (itree = 0; itree < num_local_trees; itree++) {
+    tree = t8_forest_get_tree (forest, itree);
+    snap_tree = (t8_forest_snapshot_tree_t *)
+      t8_sc_array_index_locidx (snapshot->trees, itree);
+    snap_tree->eclass = tree->eclass;
+    snap_tree->num_elements =
+      (t8_locidx_t) t8_element_array_get_count (&tree->elements);
+    T8_ASSERT (snap_tree->num_elements > 0);
+    ts = forest->scheme_cxx->eclass_schemes[tree->eclass];
+    elem_maxlevel = ts->t8_element_maxlevel ();
+    /* The first leaf is stored as its level and the maxlevel linear id
+     * of its first descendant, all further leafs as level differences. */
+    element = t8_element_array_index_locidx (&tree->elements, 0);
+    prev_level = ts->t8_element_level (element);
+    snap_tree->first_level = (int8_t) prev_level;
+    snap_tree->first_desc_id =
+      ts->t8_element_get_linear_id (element, elem_maxlevel);
+    stream.bytes = NULL;
+    stream.byte_alloc = 0;
+    stream.num_bits = 0;
+    for (ielement = 1; ielement < snap_tree->num_elements; ielement++) {
+      element = t8_element_array_index_locidx (&tree->elements, ielement);
+      level = ts->t8_element_level (element);
+      t8_snapshot_encode_delta (&stream, level - prev_level);
+      prev_level = level;
+    }
+    /* Trim the stream storage to the written bytes */
+    snap_tree->num_bytes = (stream.num_bits + 7) / 8;
+    snap_tree->stream = T8_REALLOC (stream.bytes, uint8_t,
+                                    snap_tree->num_bytes);
+  }
+  t8_debugf ("Created snapshot of %li local elements in %li bytes.\n",
+             (long) snapshot->local_num_elements,
+             (long) t8_forest_snapshot_memory_used (snapshot));
+  return snapshot;
+}
+
+t8_forest_t
+t8_forest_from_snapshot (t8_forest_snapshot_t snapshot)
+{
+  t8_forest_t         forest;
+  t8_forest_snapshot_tree_t *snap_tree;
+  t8_tree_t           tree;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *element, *prev_element, *desc;
+  t8_linearidx_t      id;
+  t8_locidx_t         itree, num_local_trees, ielement, count_elements;
+  size_t              bitpos;
+  int                 elem_maxlevel, level, mpiret;
+
+  T8_ASSERT (snapshot != NULL);
+
+  /* Build the forest on the stored cmesh, scheme and communicator. We
+   * follow the commit path of a forest that is constructed solely from
+   * its cmesh, but create the elements from the level streams instead
+   * of a uniform refinement. */
+  t8_forest_init (&forest);
+  t8_cmesh_ref (snapshot->cmesh);
+  t8_scheme_cxx_ref (snapshot->scheme_cxx);
+  t8_forest_set_cmesh (forest, snapshot->cmesh, snapshot->mpicomm);
+  t8_forest_set_scheme (forest, snapshot->scheme_cxx);
+  forest->dimension = snapshot->cmesh->dimension;
+  mpiret = sc_MPI_Comm_size (forest->mpicomm, &forest->mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (forest->mpicomm, &forest->mpirank);
+  SC_CHECK_MPI (mpiret);
+  t8_forest_compute_maxlevel (forest);
+
+  forest->first_local_tree = snapshot->first_local_tree;
+  forest->last_local_tree = snapshot->last_local_tree;
+  num_local_trees = (t8_locidx_t) snapshot->trees->elem_count;
+  if (num_local_trees == 0) {
+    /* This process is empty. As in t8_forest_populate we still create
+     * the tree array. */
+    forest->trees = t8_forest_recycle_trees_new (0);
+  }
+  else {
+    forest->trees = t8_forest_recycle_trees_new (num_local_trees);
+  }
+  count_elements = 0;
+  for (itree = 0; itree < num_local_trees; itree++) {
+    snap_tree = (t8_forest_snapshot_tree_t *)
+      t8_sc_array_index_locidx (snapshot->trees, itree);
+    tree = (t8_tree_t) t8_sc_array_index_locidx (forest->trees, itree);
+    tree->eclass = snap_tree->eclass;
+    tree->elements_offset = count_elements;
+    ts = forest->scheme_cxx->eclass_schemes[tree->eclass];
+    elem_maxlevel = ts->t8_element_maxlevel ();
+    t8_element_array_init_size (&tree->elements, ts,
+                                snap_tree->num_elements);
+    ts->t8_element_new (1, &desc);
+    /* The first leaf is the level first_level ancestor of the maxlevel
+     * element with the stored linear id. */
+    level = snap_tree->first_level;
+    element = t8_element_array_index_locidx (&tree->elements, 0);
+    ts->t8_element_set_linear_id (desc, elem_maxlevel,
+                                  snap_tree->first_desc_id);
+    id = ts->t8_element_get_linear_id (desc, level);
+    ts->t8_element_set_linear_id (element, level, id);
+    bitpos = 0;
+    for (ielement = 1; ielement < snap_tree->num_elements; ielement++) {
+      prev_element = element;
+      level += t8_snapshot_decode_delta (snap_tree->stream, &bitpos);
+      T8_ASSERT (0 <= level && level <= elem_maxlevel);
+      /* The next leaf is the level ancestor of the maxlevel element
+       * right after the last descendant of its predecessor. */
+      ts->t8_element_last_descendant (prev_element, desc, elem_maxlevel);
+      id = ts->t8_element_get_linear_id (desc, elem_maxlevel) + 1;
+      ts->t8_element_set_linear_id (desc, elem_maxlevel, id);
+      id = ts->t8_element_get_linear_id (desc, level);
+      element = t8_element_array_index_locidx (&tree->elements, ielement);
+      ts->t8_element_set_linear_id (element, level, id);
+    }
+    T8_ASSERT (bitpos <= 8 * snap_tree->num_bytes);
+    ts->t8_element_destroy (1, &desc);
+    count_elements += snap_tree->num_elements;
+  }
+  T8_ASSERT (count_elements == snapshot->local_num_elements);
+  forest->local_num_elements = snapshot->local_num_elements;
+  forest->global_num_elements = snapshot->global_num_elements;
+  forest->global_num_trees = t8_cmesh_get_num_trees (forest->cmesh);
+  forest->incomplete_trees = 0;
+
+  /* Finalize the forest as t8_forest_commit does after population */
+  t8_forest_compute_elements_offset (forest);
+  t8_forest_compute_desc (forest);
+  forest->set_level = 0;
+  forest->set_from = NULL;
+  forest->committed = 1;
+  t8_debugf ("Reconstructed forest with %li local elements from "
+             "snapshot.\n", (long) forest->local_num_elements);
+  return forest;
+}
+
+size_t
+t8_forest_snapshot_memory_used (t8_forest_snapshot_t snapshot)
+{
+  t8_forest_snapshot_tree_t *snap_tree;
+  size_t              bytes, itree;
+
+  T8_ASSERT (snapshot != NULL);
+
+  bytes = sizeof (struct t8_forest_snapshot);
+  bytes += sizeof (sc_array_t) + (size_t) snapshot->trees->byte_alloc;
+  for (itree = 0; itree < snapshot->trees->elem_count; itree++) {
+    snap_tree = (t8_forest_snapshot_tree_t *)
+      sc_array_index (snapshot->trees, itree);
+    bytes += snap_tree->num_bytes;
+  }
+  return bytes;
+}
+
+void
+t8_forest_snapshot_destroy (t8_forest_snapshot_t *psnapshot)
+{
+  t8_forest_snapshot_t snapshot;
+  t8_forest_snapshot_tree_t *snap_tree;
+  size_t              itree;
+
+  T8_ASSERT (psnapshot != NULL && *psnapshot != NULL);
+  snapshot = *psnapshot;
+
+  for (itree = 0; itree < snapshot->trees->elem_count; itree++) {
+    snap_tree = (t8_forest_snapshot_tree_t *)
+      sc_array_index (snapshot->trees, itree);
+    T8_FREE (snap_tree->stream);
+  }
+  sc_array_destroy (snapshot->trees);
+  t8_cmesh_unref (&snapshot->cmesh);
+  t8_scheme_cxx_unref (&snapshot->scheme_cxx);
+  T8_FREE (snapshot);
+  *psnapshot = NULL;
+}
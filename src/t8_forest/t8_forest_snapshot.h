@@ -0,0 +1,90 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_snapshot.h
+ * We define compact in-memory snapshots of a forest in this file.
+ * A snapshot stores the leaf structure of a committed forest as
+ * delta-encoded level streams along the space filling curve, typically
+ * a few bits per element, and a committed forest can be reconstructed
+ * from it on demand. This allows applications such as adjoint solvers
+ * to keep many earlier forest states resident at a small fraction of
+ * the memory of referenced forest copies.
+ */
+
+#ifndef T8_FOREST_SNAPSHOT_H
+#define T8_FOREST_SNAPSHOT_H
+
+#include <t8.h>
+#include <t8_forest/t8_forest_general.h>
+
+T8_EXTERN_C_BEGIN ();
+
+/** Opaque handle of a forest snapshot.
+ * \see t8_forest_snapshot_create, \see t8_forest_from_snapshot
+ */
+typedef struct t8_forest_snapshot *t8_forest_snapshot_t;
+
+/** Create a snapshot of the leaf structure of a committed forest.
+ * The snapshot references the cmesh and the scheme of the forest, but
+ * not its element storage, and stays valid after the forest is
+ * destroyed. The element data of the forest is not part of the
+ * snapshot.
+ * \param [in] forest   A committed forest.
+ * \return              A snapshot storing the leaf structure and the
+ *                      partition of \a forest.
+ */
+t8_forest_snapshot_t t8_forest_snapshot_create (t8_forest_t forest);
+
+/** Reconstruct a committed forest from a snapshot.
+ * The forest is built on the communicator, the cmesh and the scheme of
+ * the snapshotted forest with the original partition and leaf
+ * structure. The snapshot stays valid and can be reconstructed from
+ * again. This call is local, it involves no communication.
+ * \param [in] snapshot A snapshot created by
+ *                      \ref t8_forest_snapshot_create.
+ * \return              A committed forest with the leaf structure of
+ *                      the snapshotted forest. The caller owns the
+ *                      reference.
+ */
+t8_forest_t         t8_forest_from_snapshot (t8_forest_snapshot_t snapshot);
+
+/** Return the number of bytes of heap memory a snapshot occupies on
+ * this process. The referenced cmesh and scheme are not counted, since
+ * they are shared with the application.
+ * \param [in] snapshot A snapshot.
+ * \return              The local memory footprint of \a snapshot in
+ *                      bytes.
+ */
+size_t              t8_forest_snapshot_memory_used (t8_forest_snapshot_t
+                                                    snapshot);
+
+/** Destroy a snapshot and release its references to the cmesh and the
+ * scheme.
+ * \param [in,out] psnapshot  Pointer to a snapshot. Set to NULL on
+ *                            output.
+ */
+void                t8_forest_snapshot_destroy (t8_forest_snapshot_t
+                                                *psnapshot);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_FOREST_SNAPSHOT_H */
@@ -68,6 +68,94 @@ void                t8_forest_to_vtkUnstructuredGrid (t8_forest_t forest,
                                                       const int num_data,
                                                       t8_vtk_data_field_t
                                                       *data);
+
+/** A reusable cache for repeated in-memory handoffs of a forest to a
+ * vtkUnstructuredGrid, for example from an in-situ pipeline that consumes
+ * the grid every few time steps.
+ * The cache owns the grid and a reference to the forest of the last fill.
+ * Create it with \ref t8_forest_vtk_grid_cache_new, fill it with
+ * \ref t8_forest_to_vtkUnstructuredGrid_cached and destroy it with
+ * \ref t8_forest_vtk_grid_cache_destroy.
+ * The members are managed by the fill function; users only read \a grid.
+ */
+typedef struct t8_forest_vtk_grid_cache
+{
+  t8_forest_t         forest;   /**< The forest of the last fill (referenced). NULL if the cache is empty. */
+  vtkSmartPointer < vtkUnstructuredGrid > grid; /**< The grid that is filled and reused across calls. */
+  int                 write_treeid;     /**< The write_treeid flag of the last fill. */
+  int                 write_mpirank;    /**< The write_mpirank flag of the last fill. */
+  int                 write_level;      /**< The write_level flag of the last fill. */
+  int                 write_element_id; /**< The write_element_id flag of the last fill. */
+  int                 curved_flag;      /**< The curved_flag of the last fill. */
+  int                 write_ghosts;     /**< The (normalized) ghost flag of the last fill. */
+  t8_locidx_t         num_elements;     /**< The number of cells of the last fill. */
+} t8_forest_vtk_grid_cache_t;
+
+/** Allocate an empty grid cache.
+ * \return A cache that can be passed to
+ * \ref t8_forest_to_vtkUnstructuredGrid_cached.
+ */
+t8_forest_vtk_grid_cache_t *t8_forest_vtk_grid_cache_new (void);
+
+/** Fill the grid of a cache with the elements and data of a forest.
+ * Produces the same grid as \ref t8_forest_to_vtkUnstructuredGrid, but
+ * avoids the per-point and per-cell VTK insertion calls: the point
+ * coordinates are computed directly into a preallocated coordinate
+ * buffer, the connectivity is a running enumeration of the points and
+ * the user data arrays are bound zero-copy to the caller's buffers.
+ * If the cache was last filled from the same committed forest with the
+ * same flags, the points and cells of the grid are known to be unchanged
+ * (committed forests are immutable) and only the user data arrays are
+ * rebound, so a call between two adaptations costs next to nothing.
+ * \param [in]      forest    The committed forest to hand off.
+ * \param [in,out]  cache     The cache whose grid is filled. Holds a
+ *                            reference to \a forest until the next fill
+ *                            or the destruction of the cache.
+ * \param [in]  write_treeid If true, the global tree id is written for each element.
+ * \param [in]  write_mpirank If true, the mpirank is written for each element.
+ * \param [in]  write_level If true, the refinement level is written for each element.
+ * \param [in]  write_element_id If true, the global element id is written for each element.
+ * \param [in]  curved_flag If true, write the elements as curved element types from vtk.
+ * \param [in]  write_ghosts If true, write ghost elements.
+ * \param [in]  num_data  Number of user defined double valued data fields to write.
+ * \param [in]  data      Array of t8_vtk_data_field_t of length \a num_data.
+ *                        The data is not copied; the caller's buffers must
+ *                        stay alive while the grid is in use and the set of
+ *                        field names should stay the same across calls.
+ * \see t8_forest_to_vtkUnstructuredGrid
+ * \note Pipelines that keep their own extracted arrays (rather than the
+ * grid of this cache) can update them incrementally across an adaptation:
+ * \ref t8_forest_delta_extract returns the added/removed/kept cell runs
+ * since a last seen generation, so only the changed cells need to be
+ * re-extracted.
+ */
+void                t8_forest_to_vtkUnstructuredGrid_cached (t8_forest_t
+                                                             forest,
+                                                             t8_forest_vtk_grid_cache_t
+                                                             *cache,
+                                                             const int
+                                                             write_treeid,
+                                                             const int
+                                                             write_mpirank,
+                                                             const int
+                                                             write_level,
+                                                             const int
+                                                             write_element_id,
+                                                             const int
+                                                             curved_flag,
+                                                             const int
+                                                             write_ghosts,
+                                                             const int
+                                                             num_data,
+                                                             t8_vtk_data_field_t
+                                                             *data);
+
+/** Destroy a grid cache, releasing its forest reference and vtk objects.
+ * \param [in,out] pcache On input, a cache created with
+ *                        \ref t8_forest_vtk_grid_cache_new.
+ *                        Set to NULL on output.
+ */
+void                t8_forest_vtk_grid_cache_destroy (t8_forest_vtk_grid_cache_t **pcache);
 #endif
 
 T8_EXTERN_C_END ();
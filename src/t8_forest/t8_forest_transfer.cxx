@@ -0,0 +1,144 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_forest/t8_forest_transfer.h>
+#include <t8_element_cxx.hxx>
+
+/* Count how many consecutive leafs of a tree, starting at \a ielem, are
+ * descendants of the ancestor identified by \a anc_id at \a anc_level.
+ * The linear id truncated to anc_level identifies the ancestor, so the
+ * run is found without constructing any elements. */
+static t8_locidx_t
+t8_forest_transfer_count_descendants (t8_forest_t forest, t8_locidx_t itree,
+                                      t8_eclass_scheme_c *ts,
+                                      t8_locidx_t ielem,
+                                      t8_locidx_t num_elems,
+                                      t8_linearidx_t anc_id, int anc_level)
+{
+  t8_locidx_t         count = 0;
+
+  while (ielem + count < num_elems) {
+    const t8_element_t *leaf =
+      t8_forest_get_element_in_tree (forest, itree, ielem + count);
+    if (ts->t8_element_level (leaf) <= anc_level
+        || ts->t8_element_get_linear_id (leaf, anc_level) != anc_id) {
+      break;
+    }
+    count++;
+  }
+  return count;
+}
+
+void
+t8_forest_transfer (t8_forest_t forest_a, t8_forest_t forest_b,
+                    t8_forest_transfer_fn callback, void *user_data)
+{
+  t8_locidx_t         num_local_trees, itree;
+
+  T8_ASSERT (t8_forest_is_committed (forest_a));
+  T8_ASSERT (t8_forest_is_committed (forest_b));
+  T8_ASSERT (callback != NULL);
+  /* Both forests must share the tree decomposition of this process */
+  T8_ASSERT (t8_forest_get_cmesh (forest_a)
+             == t8_forest_get_cmesh (forest_b));
+  T8_ASSERT (t8_forest_get_num_local_trees (forest_a)
+             == t8_forest_get_num_local_trees (forest_b));
+
+  num_local_trees = t8_forest_get_num_local_trees (forest_a);
+  for (itree = 0; itree < num_local_trees; itree++) {
+    const t8_eclass_t   tree_class =
+      t8_forest_get_tree_class (forest_a, itree);
+    t8_eclass_scheme_c *ts =
+      t8_forest_get_eclass_scheme (forest_a, tree_class);
+    const t8_locidx_t   num_a =
+      t8_forest_get_tree_num_elements (forest_a, itree);
+    const t8_locidx_t   num_b =
+      t8_forest_get_tree_num_elements (forest_b, itree);
+    t8_locidx_t         ia = 0;
+    t8_locidx_t         ib = 0;
+
+    T8_ASSERT (tree_class == t8_forest_get_tree_class (forest_b, itree));
+
+    /* Merge-style co-walk over the leaf arrays of this tree. In every
+     * step the front leafs are either identical, in an ancestor-
+     * descendant relation, or disjoint; in the first two cases one
+     * overlap is emitted, in the last case the leaf that comes first in
+     * space filling curve order has no local counterpart and is
+     * skipped. */
+    while (ia < num_a && ib < num_b) {
+      const t8_element_t *ea =
+        t8_forest_get_element_in_tree (forest_a, itree, ia);
+      const t8_element_t *eb =
+        t8_forest_get_element_in_tree (forest_b, itree, ib);
+      const int           la = ts->t8_element_level (ea);
+      const int           lb = ts->t8_element_level (eb);
+
+      if (la == lb) {
+        if (ts->t8_element_compare (ea, eb) == 0) {
+          /* The leafs are identical */
+          callback (forest_a, forest_b, itree, ts, 0, 1, ia, 1, ib,
+                    user_data);
+          ia++;
+          ib++;
+          continue;
+        }
+      }
+      else if (la < lb) {
+        const t8_linearidx_t anc_id = ts->t8_element_get_linear_id (ea, la);
+
+        if (ts->t8_element_get_linear_id (eb, la) == anc_id) {
+          /* The leaf of forest_a contains a run of leafs of forest_b */
+          const t8_locidx_t   count =
+            t8_forest_transfer_count_descendants (forest_b, itree, ts, ib,
+                                                  num_b, anc_id, la);
+          callback (forest_a, forest_b, itree, ts, 1, 1, ia, count, ib,
+                    user_data);
+          ia++;
+          ib += count;
+          continue;
+        }
+      }
+      else {
+        const t8_linearidx_t anc_id = ts->t8_element_get_linear_id (eb, lb);
+
+        if (ts->t8_element_get_linear_id (ea, lb) == anc_id) {
+          /* The leaf of forest_b contains a run of leafs of forest_a */
+          const t8_locidx_t   count =
+            t8_forest_transfer_count_descendants (forest_a, itree, ts, ia,
+                                                  num_a, anc_id, lb);
+          callback (forest_a, forest_b, itree, ts, -1, count, ia, 1, ib,
+                    user_data);
+          ia += count;
+          ib++;
+          continue;
+        }
+      }
+      /* The front leafs are disjoint; skip the earlier one */
+      if (ts->t8_element_compare (ea, eb) < 0) {
+        ia++;
+      }
+      else {
+        ib++;
+      }
+    }
+  }
+}
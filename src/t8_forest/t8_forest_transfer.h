@@ -0,0 +1,99 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_transfer.h
+ * Cross-forest overlap enumeration for data transfer between two
+ * independently adapted forests over the same cmesh.
+ * Since both forests share the tree decomposition and the space filling
+ * curve order of their leafs, their overlaps can be enumerated by a
+ * merge-style co-walk of the per tree leaf arrays in linear time, like
+ * \ref t8_forest_iterate_replace generalized to forests that are not
+ * related by a single adapt step. For each overlap the callback receives
+ * the containment relation, so applications can interpolate or project
+ * element data between coupled forests without any search structure.
+ */
+
+#ifndef T8_FOREST_TRANSFER_H
+#define T8_FOREST_TRANSFER_H
+
+#include <t8_forest/t8_forest_general.h>
+
+T8_EXTERN_C_BEGIN ();
+
+/** Callback of \ref t8_forest_transfer, called once per overlap.
+ * The overlapping elements of the two forests are consecutive in their
+ * trees, hence each side is described by a tree local index range.
+ * \param [in] forest_a    The first forest.
+ * \param [in] forest_b    The second forest.
+ * \param [in] which_tree  The local tree containing the overlap, valid in
+ *                         both forests.
+ * \param [in] ts          The eclass scheme of the tree.
+ * \param [in] relation    0 if the two elements are identical (\a num_a
+ *                         and \a num_b are 1), 1 if the element of
+ *                         \a forest_a contains the \a num_b elements of
+ *                         \a forest_b (\a num_a is 1) and -1 if the
+ *                         element of \a forest_b contains the \a num_a
+ *                         elements of \a forest_a (\a num_b is 1).
+ * \param [in] num_a       The number of overlapping elements of \a forest_a.
+ * \param [in] first_a     The tree local index of the first of them.
+ * \param [in] num_b       The number of overlapping elements of \a forest_b.
+ * \param [in] first_b     The tree local index of the first of them.
+ * \param [in] user_data   The user pointer passed to \ref t8_forest_transfer.
+ */
+typedef void        (*t8_forest_transfer_fn) (t8_forest_t forest_a,
+                                              t8_forest_t forest_b,
+                                              t8_locidx_t which_tree,
+                                              t8_eclass_scheme_c *ts,
+                                              int relation,
+                                              t8_locidx_t num_a,
+                                              t8_locidx_t first_a,
+                                              t8_locidx_t num_b,
+                                              t8_locidx_t first_b,
+                                              void *user_data);
+
+/** Enumerate all overlaps between the local leafs of two forests.
+ * The forests must be committed over the same cmesh and agree on the
+ * local trees of this process. The leaf arrays of each tree are co-walked
+ * in space filling curve order, so the enumeration is linear in the total
+ * number of local leafs and constructs no elements.
+ * Since the forests partition the same trees, the front leafs of the
+ * co-walk are always identical or in an ancestor-descendant relation;
+ * leafs without a local counterpart - at partition boundaries inside a
+ * tree or in forests with removed elements - produce no overlap and are
+ * skipped. If the partition cuts through the descendants of a coarse
+ * element, each sharing process reports an overlap with its own local
+ * descendants only.
+ * \param [in] forest_a   A committed forest.
+ * \param [in] forest_b   A committed forest over the same cmesh with the
+ *                        same local trees.
+ * \param [in] callback   Called once per overlap, in ascending space
+ *                        filling curve order per tree.
+ * \param [in] user_data  Passed through to \a callback.
+ */
+void                t8_forest_transfer (t8_forest_t forest_a,
+                                        t8_forest_t forest_b,
+                                        t8_forest_transfer_fn callback,
+                                        void *user_data);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_FOREST_TRANSFER_H */
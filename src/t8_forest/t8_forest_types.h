@@ -32,12 +32,17 @@
 #include <t8_refcount.h>
 #include <t8_cmesh.h>
 #include <t8_element.h>
+#include <t8_element_scratch.h>
+#include <t8_region_profile.h>
 #include <t8_data/t8_containers.h>
 #include <t8_forest/t8_forest_adapt.h>
 #include <t8_forest/t8_forest_general.h>
 
 typedef struct t8_profile t8_profile_t; /* Defined below */
 typedef struct t8_forest_ghost *t8_forest_ghost_t;      /* Defined below */
+typedef struct t8_forest_face_neighbor_index *t8_forest_face_neighbor_index_t;  /* Defined below */
+typedef struct t8_forest_geom_cache *t8_forest_geom_cache_t;    /* Defined below */
+typedef struct t8_forest_aabb_cache *t8_forest_aabb_cache_t;    /* Defined below */
 
 /** If a forest is to be derived from another forest, there are different
  * possibilities how the original forest is modified.
@@ -62,7 +67,33 @@ typedef int8_t      t8_forest_from_t;
 #define T8_FOREST_BALANCE_NO_REPART 2 /**< Value of forest->set_balance if balancing without repartitioning */
 
 /** The number of statistics collected by a profile struct. */
-#define T8_PROFILE_NUM_STATS 14
+#define T8_PROFILE_NUM_STATS 15
+
+/** The number of bins of the ghost message size histogram in a profile
+ * struct. Bin \a i counts the messages with fewer than 1024 * 4^i bytes,
+ * the last bin counts all larger messages. */
+#define T8_PROFILE_GHOST_MSG_BINS 8
+
+/** A dense, cache friendly per-tree record for leaf traversal.
+ * \ref t8_tree_struct_t mixes the fields that every leaf lookup touches
+ * with cold data (the descendant elements), so iterating the tree array
+ * strides over bytes the traversal never reads. A committed forest
+ * therefore duplicates the hot fields into this side table of 32 byte
+ * records, allocated cache-line aligned so that no record straddles a
+ * line, \see t8_forest_get_tree_hot. The records are read only; the
+ * tree structs in \a trees remain the owners of the data. */
+typedef struct t8_tree_hot
+{
+  t8_element_array_t *elements;        /**< The element storage of the tree */
+  t8_locidx_t         elements_offset; /**< cumulative sum over earlier
+                                            trees on this processor
+                                            (locals only) */
+  t8_locidx_t         num_elements;    /**< The local element count of the tree */
+  t8_eclass_t         eclass;          /**< The element class of this tree */
+  int                 padding[3];      /**< Pad the record to 32 bytes, so that
+                                            two records share one cache line. */
+}
+t8_tree_hot_struct_t;
 
 /** This structure is private to the implementation. */
 typedef struct t8_forest
@@ -80,6 +111,15 @@ typedef struct t8_forest
   int                 maxlevel;         /**< The maximum allowed refinement level for elements in this forest. */
   int                 maxlevel_existing;/**< If >= 0, the maximum occurring refinemnent level of a forest element. */
   int                 do_dup;           /**< Communicator shall be duped. */
+  int                 defer_global_count; /**< If true, \ref t8_forest_comm_global_num_elements
+                                             does not communicate and leaves the global element
+                                             count at -1. Set by \ref t8_forest_commit_batch, which
+                                             batches the deferred reductions of several forests. */
+  int                 commit_internal;  /**< True for the intermediate forests that
+                                             \ref t8_forest_commit creates internally for
+                                             combined from methods. Suppresses the cache
+                                             invalidation hooks of the intermediate commit;
+                                             only the final forest fires them. */
   int                 dimension;        /**< Dimension inferred from \b cmesh. */
   int                 incomplete_trees; /**< Flag to check whether the forest has (potential) incomplete trees.
                                              A tree is incomplete if an element has been removed from it.
@@ -89,20 +129,149 @@ typedef struct t8_forest
   t8_forest_from_t    from_method;      /**< Method to derive from \b set_from. */
   t8_forest_adapt_t   set_adapt_fn;     /**< refinement and coarsen function. Called when \b from_method
                                              is set to T8_FOREST_FROM_ADAPT. */
+  t8_forest_adapt_batched_t set_adapt_batched_fn; /**< If not NULL, batched refinement and coarsen
+                                             function called once per tree instead of \b set_adapt_fn.
+                                             \see t8_forest_set_adapt_batched. */
+  t8_forest_adapt_prune_t set_adapt_prune_fn; /**< If not NULL, top-down predicate that keeps
+                                             whole subtrees unchanged during adaptation without
+                                             evaluating the adapt callback for their leafs.
+                                             \see t8_forest_set_adapt_prune. */
+  sc_array_t         *set_adapt_regions; /**< If not NULL, array of t8_forest_adapt_region_t.
+                                             The adapt callback is only evaluated inside these
+                                             windows; all other elements are copied wholesale.
+                                             \see t8_forest_set_adapt_region. */
+  t8_forest_partition_weight_t set_partition_weight_fn; /**< If not NULL, per element weight function
+                                             used to balance the cumulative weight instead of the
+                                             element count during partition.
+                                             \see t8_forest_set_partition_weights. */
   int                 set_adapt_recursive; /**< Flag to decide whether coarsen and refine
                                                 are carried out recursive */
+  int                 set_adapt_recycle; /**< If true and this forest holds the only
+                                              reference to \b set_from, the leaf storage of
+                                              each source tree is freed as soon as the tree
+                                              was adapted. \see t8_forest_set_adapt_recycle */
+  int                 set_commit_fused; /**< If true, a commit that combines adapt with
+                                             partition/balance consumes the source forest:
+                                             its leaf storage is streamed away during adapt
+                                             and intermediate forests are dropped as early
+                                             as possible. \see t8_forest_set_commit_fused */
+  int                 set_adapt_journal; /**< If true, \ref t8_forest_adapt records the
+                                              adapt pattern in \b adapt_journal.
+                                              \see t8_forest_set_adapt_journal */
+  sc_array_t         *adapt_journal;    /**< If not NULL, the recorded adapt pattern as an
+                                             array of t8_forest_adapt_journal_entry_t.
+                                             \see t8_forest_get_adapt_journal */
   int                 set_balance;      /**< Flag to decide whether to forest will be balance in \ref t8_forest_commit.
                                              See \ref t8_forest_set_balance.
                                              If 0, no balance. If 1 balance with repartitioning, if 2 balance without
                                              repartitioning, \see t8_forest_balance */
+  t8_forest_replace_t balance_replace_fn;   /**< If not NULL, element data transfer callback invoked
+                                             after each round of the iterated balance algorithm.
+                                             \see t8_forest_set_balance_replace */
   int                 do_ghost;         /**< If True, a ghost layer will be created when the forest is committed. */
   t8_ghost_type_t     ghost_type;       /**< If a ghost layer will be created, the type of neighbors that count as ghost. */
-  int                 ghost_algorithm;  /**< Controls the algorithm used for ghost. 1 = balanced only. 2 = also unbalanced
+  int                 ghost_algorithm;  /**< Controls the algorithm used for ghost. 0 = automatic choice during commit.
+                                             1 = balanced only. 2 = also unbalanced
                                              3 = top-down search and unbalanced. */
+  int                 ghost_width;      /**< The number of ghost layers to create, >= 1.
+                                             \see t8_forest_set_ghost_ext */
+  t8_forest_ghost_filter_t ghost_filter_fn; /**< If not NULL, per boundary element predicate
+                                             deciding which remote elements enter the ghost
+                                             layer. \see t8_forest_set_ghost_filter */
+  void               *ghost_filter_data; /**< Pointer passed to \a ghost_filter_fn. */
+  struct t8_forest_speculation *speculation; /**< If not NULL, the registered refinement
+                                             predictor and its side pool of pre-generated
+                                             children. \see t8_forest_set_speculation */
+  int                 ghost_aggregate;  /**< If nonzero, the ghost creation of this forest
+                                             bundles its point-to-point messages through one
+                                             leader rank per compute node. Chosen during commit
+                                             from the message size histogram in the profile of
+                                             the source forest.
+                                             \see t8_forest_ghost_choose_aggregation */
+  int                 ghost_packed;     /**< If nonzero, ghost elements are exchanged as packed
+                                             (linear id, level) streams and materialized in bulk
+                                             on the receiver instead of sending the raw element
+                                             structs. Must be set equally on all processes.
+                                             \see t8_forest_set_ghost_packed */
+  int                 ghost_compress;   /**< If nonzero, the packed ghost streams of large
+                                             trees are additionally delta and varint encoded.
+                                             Only effective together with \a ghost_packed.
+                                             Must be set equally on all processes.
+                                             \see t8_forest_set_ghost_compress */
+  int                 ghost_num_threads; /**< The number of threads used for the boundary walk
+                                             of the ghost algorithms, >= 1. Only effective if
+                                             t8code was configured with pthread support.
+                                             \see t8_forest_set_ghost_threads */
+  int                 populate_num_threads; /**< The number of threads used to fill the
+                                             element arrays of a new uniform forest, >= 1.
+                                             Only effective if t8code was configured with
+                                             pthread support.
+                                             \see t8_forest_set_populate_threads */
+  int                 vtk_num_threads; /**< The number of threads used to serialize
+                                             the cells of a vtk output file, >= 1.
+                                             Only effective if t8code was configured with
+                                             pthread support.
+                                             \see t8_forest_set_vtk_threads */
+  int                 adapt_num_threads; /**< The number of threads used for the tree loop
+                                             of a non-recursive adaptation, >= 1. Only
+                                             effective if t8code was configured with
+                                             OpenMP support. With more than one thread the
+                                             adapt callback must be thread-safe.
+                                             \see t8_forest_set_adapt_threads */
+  int                 coord_precision; /**< The floating point precision in which
+                                             the vtk and netcdf writers emit the
+                                             element coordinates.
+                                             \see t8_forest_set_coordinate_precision */
+  int                 coord_quant_bits; /**< If \a coord_precision selects quantization,
+                                             the number of bits of the fixed point grid
+                                             over the coarse mesh bounding box.
+                                             \see t8_forest_set_coordinate_precision */
+  int                 do_subcomm; /**< If true, the commit builds a subcommunicator
+                                             spanning only the ranks that hold elements.
+                                             \see t8_forest_set_subcomm */
+  sc_MPI_Comm         subcomm;  /**< If \a do_subcomm is set, the communicator of the
+                                             element holding ranks, built during commit.
+                                             Equals \a mpicomm if no rank is empty and
+                                             sc_MPI_COMM_NULL on ranks without elements.
+                                             \see t8_forest_get_subcomm */
+  int                 set_comm_isolation; /**< If true, the commit duplicates dedicated
+                                             communicators for the ghost and partition
+                                             traffic of this forest.
+                                             \see t8_forest_set_comm_isolation */
+  sc_MPI_Comm         ghost_comm; /**< If not sc_MPI_COMM_NULL, the dedicated communicator
+                                             that carries all ghost messages of this forest.
+                                             \see t8_forest_set_comm_isolation */
+  sc_MPI_Comm         partition_comm; /**< If not sc_MPI_COMM_NULL, the dedicated communicator
+                                             that carries all partition messages of this forest.
+                                             \see t8_forest_set_comm_isolation */
+  t8_element_memory_mode_t element_memory_mode; /**< The allocation mode for the leaf element
+                                             storage of the trees. \see t8_forest_set_memory_mode */
+  t8_forest_commit_context_t commit_context; /**< If not NULL, the commit context whose
+                                             communicator and parked shared memory arrays
+                                             this forest reuses.
+                                             \see t8_forest_set_commit_context */
+  sc_array_t         *fields;           /**< If not NULL, the registered element data fields
+                                             of this forest as an array of
+                                             t8_forest_field_struct_t.
+                                             \see t8_forest_field_register */
+  unsigned            generation;       /**< Monotonic counter along the forest lineage.
+                                             A committed derived forest always carries a
+                                             strictly larger generation than its source.
+                                             \see t8_forest_get_generation */
+  sc_array_t         *cache_hooks;      /**< If not NULL, the registered cache invalidation
+                                             hooks of this forest as an array of
+                                             t8_forest_cache_hook_struct_t. They are carried
+                                             over to derived forests and fired at the end of
+                                             commit for the trees whose leafs changed.
+                                             \see t8_forest_cache_hook_register */
   void               *user_data;        /**< Pointer for arbitrary user data. \see t8_forest_set_user_data. */
   void                (*user_function) ();/**< Pointer for arbitrary user function. \see t8_forest_set_user_function. */
   void               *t8code_data;      /**< Pointer for arbitrary data that is used internally. */
   int                 committed;        /**< \ref t8_forest_commit called? */
+  int                 known_balanced;   /**< Nonzero if the forest is known to be balanced without checking,
+                                             for example because it is uniform or was balanced during commit.
+                                             0 if the forest is unbalanced or its balance state is unknown.
+                                             Used to choose the ghost algorithm automatically. */
   int                 mpisize;          /**< Number of MPI processes. */
   int                 mpirank;          /**< Number of this MPI process. */
 
@@ -115,9 +284,29 @@ typedef struct t8_forest
   t8_gloidx_t         global_num_trees; /**< The total number of global trees */
   sc_array_t         *trees;
   t8_forest_ghost_t   ghosts;           /**< If not NULL, the ghost elements. \see t8_forest_ghost.h */
+  sc_MPI_Comm         ghost_neighbor_comm; /**< If not sc_MPI_COMM_NULL, a distributed graph
+                                            communicator derived from \a mpicomm whose neighbors
+                                            are the remote processes of \a ghosts. It is built
+                                            during ghost creation where MPI-3 is available and
+                                            carries the neighborhood collective ghost data
+                                            exchanges, so the MPI library can exploit the
+                                            communication topology. */
+  t8_forest_face_neighbor_index_t face_neighbor_index; /**< If not NULL, a precomputed index of the leaf
+                                            face neighbors of all local elements.
+                                            \see t8_forest_face_neighbor_index_create. */
+  t8_forest_geom_cache_t geom_cache;    /**< If not NULL, per tree cached geometry data that the
+                                            element coordinate routines consult.
+                                            \see t8_forest_geometry_cache_create. */
+  t8_forest_aabb_cache_t aabb_cache;    /**< If not NULL, lazily built axis aligned bounding
+                                            boxes of the local elements.
+                                            \see t8_forest_element_aabb. */
   t8_shmem_array_t    element_offsets; /**< If partitioned, for each process the global index
                                             of its first element. Since it is memory consuming,
                                             it is usually only constructed when needed and otherwise unallocated. */
+  int                 partition_is_uniform; /**< Nonzero if the element partition of this forest
+                                            follows the closed-form offsets of the unweighted
+                                            partition routine. Then \ref t8_forest_partition_create_offsets
+                                            can fill \a element_offsets locally without communication. */
   t8_shmem_array_t    global_first_desc; /**< If partitioned, for each process the linear id (at maxlevel) of its
                                               first element's first descendant.
                                              \ref t8_element_set_linear_id. Stores 0 for empty processes.
@@ -128,12 +317,67 @@ typedef struct t8_forest
                                           if the first tree on that process is shared.
                                           Since this is memory consuming we only construct it when needed.
                                           This array follows the same logic as \a tree_offsets in \a t8_cmesh_t */
+  t8_shmem_array_t    node_offsets; /**< If created, a two level view of \a element_offsets with one
+                                         entry per compute node instead of one per process.
+                                         \see t8_forest_partition_create_node_offsets */
 
   t8_locidx_t         local_num_elements;  /**< Number of elements on this processor. */
   t8_gloidx_t         global_num_elements; /**< Number of elements on all processors. */
   t8_profile_t       *profile; /**< If not NULL, runtimes and statistics about forest_commit are stored here. */
   sc_statinfo_t       stats[T8_PROFILE_NUM_STATS];
   int                 stats_computed;
+
+  t8_element_scratch_t *element_scratch; /**< If not NULL, a scratch arena for
+                                            short-lived elements in hot paths.
+                                            It is created on demand by
+                                            \ref t8_forest_get_element_scratch. */
+  int                 last_owner; /**< The result of the last owner query of
+                                       \ref t8_forest_element_find_owner, or -1
+                                       if no query was performed yet. Owner
+                                       queries are strongly clustered along the
+                                       space-filling curve, so the cached rank
+                                       is checked first before a new search. */
+  t8_locidx_t        *tree_element_offsets; /**< If not NULL, a flat array of
+                                            num_local_trees + 1 entries storing
+                                            for each local tree the element offset
+                                            \a elements_offset of its tree struct,
+                                            terminated by the local number of
+                                            elements. It is built on demand by
+                                            \ref t8_forest_get_element_fast. */
+  t8_tree_hot_struct_t *tree_hot;      /**< If not NULL, the cache-line aligned
+                                            hot tree table with one record per
+                                            local tree. Built on demand by
+                                            \ref t8_forest_get_tree_hot. */
+  char               *tree_hot_storage; /**< The raw allocation behind
+                                            \a tree_hot, which is aligned
+                                            within it. */
+  t8_locidx_t        *level_view_offsets; /**< If not NULL, maxlevel + 2 offsets
+                                            into \a level_view_indices grouping
+                                            the local leafs by refinement level.
+                                            Built on demand by
+                                            \ref t8_forest_get_level_view. */
+  t8_locidx_t        *level_view_indices; /**< If not NULL, the local leaf indices
+                                            grouped by refinement level, ascending
+                                            within each level.
+                                            \see t8_forest_get_level_view */
+  t8_locidx_t        *tree_level_counts; /**< If not NULL, num_local_trees *
+                                            (maxlevel + 1) entries storing for
+                                            each local tree the number of its
+                                            leafs per refinement level. Built
+                                            together with the level view. */
+  int                 set_element_stats; /**< If true, per eclass leaf counts and
+                                            level statistics are recorded at the
+                                            end of commit.
+                                            \see t8_forest_set_element_stats */
+  int                 element_stats_valid; /**< True if the statistics entries
+                                            below hold valid data. */
+  t8_locidx_t         local_eclass_counts[T8_ECLASS_COUNT]; /**< The number of
+                                            local leafs per element shape. */
+  t8_gloidx_t         global_eclass_counts[T8_ECLASS_COUNT]; /**< The number of
+                                            global leafs per element shape. */
+  int                 stats_min_level;   /**< Minimum leaf level over all processes. */
+  int                 stats_max_level;   /**< Maximum leaf level over all processes. */
+  double              stats_mean_level;  /**< Mean leaf level over all processes. */
 }
 t8_forest_struct_t;
 
@@ -143,8 +387,11 @@ typedef struct t8_tree
   t8_element_array_t  elements;              /**< locally stored elements */
   t8_eclass_t         eclass;                /**< The element class of this tree */
   /* TODO: We will need the *_desc variables later for shure. */
-  t8_element_t       *first_desc,            /**< first local descendant */
-                     *last_desc;             /**< last local descendant */
+  t8_element_t       *first_desc,            /**< first local descendant. NULL until
+                                                  the first access; computed lazily,
+                                                  \see t8_forest_compute_desc */
+                     *last_desc;             /**< last local descendant. NULL until
+                                                  the first access */
   t8_locidx_t         elements_offset;      /**< cumulative sum over earlier
                                                   trees on this processor
                                                   (locals only) */
@@ -158,7 +405,7 @@ t8_tree_struct_t;
  */
 
 /** The number of statistics collected by a profile struct. */
-#define T8_PROFILE_NUM_STATS 14
+#define T8_PROFILE_NUM_STATS 15
 typedef struct t8_profile
 {
   t8_locidx_t         partition_elements_shipped; /**< The number of elements this process has
@@ -172,14 +419,24 @@ typedef struct t8_profile
   t8_locidx_t         ghosts_shipped;     /**< The number of ghost elements this process has sent to other processes. */
   t8_locidx_t         ghosts_received;    /**< The number of ghost elements this process has received from other processes. */
   int                 ghosts_remotes;     /**< The number of processes this process have sent ghost elements to (and received from). */
+  size_t              ghost_message_sizes[T8_PROFILE_GHOST_MSG_BINS]; /**< Histogram of the sizes of the
+                                                 messages sent in the last ghost creation. Bin \a i counts the
+                                                 messages with fewer than 1024 * 4^i bytes, the last bin counts
+                                                 all larger messages. Consulted by
+                                                 \ref t8_forest_ghost_choose_aggregation. */
   int                 balance_rounds;     /**< The number of iterations during balance. */
   double              adapt_runtime;      /**< The runtime of the last call to \a t8_forest_adapt (not counting adaptation in t8_forest_balance). */
   double              partition_runtime;  /**< The runtime of  the last call to \a t8_cmesh_partition (not countint partition in t8_forest_balance). */
   double              ghost_runtime;      /**< The runtime of the last call to \a t8_forest_ghost_create. */
   double              ghost_waittime;     /**< Amount of synchronisation time in ghost. */
+  int                 ghost_algorithm_used; /**< The ghost algorithm (1, 2, or 3) of the last ghost
+                                                 creation. 0 if no ghost layer was created yet.
+                                                 \see t8_forest_ghost_choose_algorithm. */
   double              balance_runtime;    /**< The runtime of the last call to \a t8_forest_balance. */
   double              commit_runtime;     /**< The runtime of the last call to \a t8_cmesh_commit. */
-
+  struct t8_region_profile *region_profile; /**< Hierarchical timers for the inner steps of
+                                                 adapt, ghost and partition.
+                                                 \see t8_region_profile.h */
 }
 t8_profile_struct_t;
 
@@ -198,10 +455,19 @@ typedef struct t8_forest_ghost
                                            elements. In linear id order */
   sc_hash_t          *global_tree_to_ghost_tree;        /* Indexes into ghost_trees.
                                                            Given a global tree id I give the index
-                                                           i such that the tree is in ghost_trees[i]
-                                                         */
-  sc_hash_t          *process_offsets;  /* Given a process, return the first ghost tree and
-                                           whithin it the first element of that process. */
+                                                           i such that the tree is in ghost_trees[i].
+                                                           Only used while the ghost layer is built;
+                                                           committed lookups binary search the sorted
+                                                           ghost_trees array instead. */
+  sc_array_t         *process_offsets;  /* Given a process, return the first ghost tree and
+                                           whithin it the first element of that process.
+                                           Array of t8_ghost_process_info_t, sorted ascending
+                                           by rank since the messages are parsed in rank
+                                           order. Looked up via binary search. */
+  sc_array_t         *remote_index;     /* Sorted (rank, position) pairs indexing the entries
+                                           of remote_ghosts by the remote rank. Built lazily
+                                           on the first committed lookup, since the remote
+                                           sets do not change after creation. */
   sc_hash_array_t    *remote_ghosts;    /* array of local trees that have ghost elements for another process.
                                            for each tree an array of t8_element_t * of the local ghost elements.
                                            Also an array of t8_locidx_t of the local indices of these elements whithin the tree.
@@ -210,9 +476,136 @@ typedef struct t8_forest_ghost
                                          */
   sc_array_t         *remote_processes; /* The ranks of the processes for which local elements are ghost.
                                            Array of int's. */
+  sc_array_t         *exchange_plan;    /* The precomputed communication pattern of the ghost data
+                                           exchanges, one t8_ghost_exchange_plan_t per remote process.
+                                           Built lazily on the first exchange and valid for the
+                                           lifetime of the ghost layer, since the remote sets do not
+                                           change after creation. */
+  t8_locidx_t        *trees_by_eclass;  /* The ghost tree indices permuted to eclass-major order,
+                                           the trees of one eclass contiguous and sorted ascending
+                                           within the class. Built lazily on the first class-wise
+                                           query, \see t8_forest_ghost_num_trees_of_class. */
+  t8_locidx_t         eclass_tree_offset[T8_ECLASS_COUNT + 1];  /* The offsets of the classes in
+                                           trees_by_eclass; only valid if that array is built. */
 
   sc_mempool_t       *glo_tree_mempool;
-  sc_mempool_t       *proc_offset_mempool;
 } t8_forest_ghost_struct_t;
 
+/** A flat CSR-style index of the leaf face neighbors of all local elements
+ * of a forest. It is built once per committed forest on demand and queried
+ * in constant time, \see t8_forest_face_neighbor_index_create.
+ * The neighbors of face \a f of the local element \a e are the entries
+ * neighbors[k] with
+ * neighbor_offsets[face_offsets[e] + f] <= k < neighbor_offsets[face_offsets[e] + f + 1].
+ */
+typedef struct t8_forest_face_neighbor_index
+{
+  t8_locidx_t         num_local_elements; /**< The number of local elements indexed. */
+  t8_locidx_t        *face_offsets;     /**< For each local element the index of its first face
+                                             in \a neighbor_offsets. num_local_elements + 1 entries,
+                                             the last one is the total face count. */
+  t8_locidx_t        *neighbor_offsets; /**< For each element face the index of its first entry
+                                             in \a neighbors. face_offsets[num_local_elements] + 1
+                                             entries, the last one is the total entry count. */
+  t8_locidx_t        *neighbors;        /**< The indices of the neighbor leafs,
+                                             0, ..., num_local_elements - 1 for local leafs,
+                                             num_local_elements, ... for ghost leafs. */
+  int8_t             *dual_faces;       /**< For each entry in \a neighbors the face number of
+                                             the neighbor that touches the element. */
+} t8_forest_face_neighbor_index_struct_t;
+
+/** A per tree cache of geometry data for a committed forest.
+ * It stores for each local tree its geometry and, if the geometry is the
+ * linear vertex interpolation, a pointer to the tree's vertex coordinates.
+ * The element coordinate routines then evaluate the linear geometry directly
+ * from the cached vertices instead of resolving the tree's geometry and
+ * vertex attribute per element, \see t8_forest_geometry_cache_create.
+ */
+typedef struct t8_forest_geom_cache
+{
+  t8_locidx_t         num_local_trees;  /**< The number of cached local trees. */
+  const struct t8_geometry **tree_geometries; /**< For each local tree its geometry. */
+  const double      **tree_vertices;    /**< For each local tree a pointer to its vertex
+                                             coordinates if its geometry is the linear
+                                             geometry, NULL otherwise. The pointers refer
+                                             into the cmesh attribute storage. */
+} t8_forest_geom_cache_struct_t;
+
+/** A lazily built cache of axis aligned bounding boxes of the local
+ * elements of a committed forest.
+ * The boxes of the elements of a tree are built on the first access to that
+ * tree and the box of the tree is the union of its element boxes. Since a
+ * committed forest is immutable the cache never has to be invalidated; an
+ * adapted forest is a new forest and starts without a cache.
+ * \see t8_forest_element_aabb, \see t8_forest_elements_in_box.
+ */
+typedef struct t8_forest_aabb_cache
+{
+  t8_locidx_t         num_local_trees;  /**< The number of local trees covered. */
+  double            **element_aabb;     /**< For each local tree NULL if not built yet,
+                                             or the boxes of its elements in leaf order,
+                                             stored as xmin, xmax, ymin, ymax, zmin, zmax
+                                             per element. */
+  double             *tree_aabb;        /**< For each local tree its box in the same
+                                             layout. Only valid for trees whose
+                                             \a element_aabb entry is not NULL. */
+} t8_forest_aabb_cache_struct_t;
+
+/** The maximum length of the name of a registered element data field,
+ * including the terminating NUL. */
+#define T8_FOREST_FIELD_NAME_MAX 64
+
+/** One registered element data field of a forest.
+ * A field stores one fixed width value per local leaf element, followed by
+ * one value per ghost element, in its own contiguous array (structure of
+ * arrays layout across fields). Fields are carried over to derived forests
+ * during commit and their ghost entries can be exchanged together,
+ * \see t8_forest_field_register.
+ */
+typedef struct t8_forest_field
+{
+  char                name[T8_FOREST_FIELD_NAME_MAX]; /**< The name of the field. */
+  size_t              elem_bytes;       /**< The number of bytes stored per element. */
+  sc_array_t         *data;             /**< The field values; element size \a elem_bytes
+                                             and length num_local_elements + num_ghosts. */
+} t8_forest_field_struct_t;
+
+/** One registered cache invalidation hook of a forest.
+ * Hooks are carried over to derived forests during commit and fired at the
+ * end of commit for the trees whose leaf elements changed,
+ * \see t8_forest_cache_hook_register.
+ */
+typedef struct t8_forest_cache_hook
+{
+  t8_forest_cache_invalidate_t callback; /**< The callback to fire. */
+  void               *user_data;        /**< Pointer passed to \a callback. */
+} t8_forest_cache_hook_struct_t;
+
+/** The number of shared memory arrays a commit context can park for reuse.
+ * A forest owns at most the element offsets, the tree offsets and the global
+ * first descendants, so three slots always suffice. */
+#define T8_FOREST_CONTEXT_SHMEM_SLOTS 3
+
+/** A commit context owns resources that every commit of a forest pipeline
+ * would otherwise set up and tear down again: the (possibly duplicated)
+ * communicator and the shared memory windows of the partition offset arrays.
+ * It is reference counted; each forest that it is set for via
+ * \ref t8_forest_set_commit_context holds one reference and returns its
+ * offset arrays to the context when the forest is destroyed.
+ */
+typedef struct t8_forest_commit_context
+{
+  t8_refcount_t       rc;       /**< Reference counter. */
+  sc_MPI_Comm         mpicomm;  /**< The communicator of the pipeline. All forests
+                                     that share this context use it directly and
+                                     never duplicate a communicator per commit. */
+  int                 do_dup;   /**< If true, \a mpicomm is a duplicate owned and
+                                     freed by the context. */
+  t8_shmem_array_t    shmem_pool[T8_FOREST_CONTEXT_SHMEM_SLOTS]; /**< Parked shared
+                                     memory arrays of destroyed forests. They are
+                                     handed out again by matching element size and
+                                     count, so no new windows are opened in steady
+                                     state. Empty slots are NULL. */
+} t8_forest_commit_context_struct_t;
+
 #endif /* ! T8_FOREST_TYPES_H! */
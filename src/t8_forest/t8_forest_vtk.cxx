@@ -22,11 +22,17 @@
 
 #include <t8_forest/t8_forest_to_vtkUnstructured.hxx>
 #include <t8_forest/t8_forest_vtk.h>
+#include <t8_forest/t8_forest_decimate.h>
 #include <t8_vtk.h>
 #include <t8_element_cxx.hxx>
 #include <t8_forest/t8_forest_ghost.h>
 #include <t8_vec.h>
 #include "t8_forest_types.h"
+#include "t8_forest_private.h"
+#if defined (SC_ENABLE_PTHREAD)
+#include <pthread.h>
+#include <t8_thread_pool.h>
+#endif
 #if T8_WITH_VTK
 #include <vtkCellArray.h>
 #include <vtkCellData.h>
@@ -82,14 +88,21 @@ T8_EXTERN_C_BEGIN ();
 typedef enum
 {
   T8_VTK_KERNEL_INIT,
+  T8_VTK_KERNEL_SEED,
   T8_VTK_KERNEL_EXECUTE,
   T8_VTK_KERNEL_CLEANUP
 } T8_VTK_KERNEL_MODUS;
 
 /* Callback function prototype for writing cell data.
  * The function is executed for each element.
- * The callback can run in three different modi:
+ * The callback can run in four different modi:
  *  INIT    - Called once, to (possibly) initialize the data pointer
+ *  SEED    - Called after INIT when the kernel does not start at the
+ *            first local element. \a element is NULL and
+ *            \a element_index holds the number of element corners of
+ *            all preceding elements. Kernels that keep running
+ *            counters fast-forward them here; all other kernels
+ *            ignore this modus. Used by the threaded serialization.
  *  EXECUTE - Called for each element, the actual writing happens here.
  *  CLEANUP - Called once after all elements. Used to cleanup any memory
  *            allocated during INIT.
@@ -677,6 +690,285 @@ t8_forest_to_vtkUnstructuredGrid (t8_forest_t forest,
   T8_FREE (cellTypes);
   T8_FREE (dataArrays);
 }
+
+t8_forest_vtk_grid_cache_t *
+t8_forest_vtk_grid_cache_new (void)
+{
+  t8_forest_vtk_grid_cache_t *cache;
+
+  /* The cache holds vtk smart pointers, so we construct it with new
+   * instead of T8_ALLOC. */
+  cache = new t8_forest_vtk_grid_cache_t ();
+  cache->forest = NULL;
+  cache->grid = vtkSmartPointer < vtkUnstructuredGrid >::New ();
+  /* Invalid flag values, so that the first fill always builds the grid */
+  cache->write_treeid = cache->write_mpirank = -1;
+  cache->write_level = cache->write_element_id = -1;
+  cache->curved_flag = -1;
+  cache->write_ghosts = -1;
+  cache->num_elements = 0;
+  return cache;
+}
+
+void
+t8_forest_vtk_grid_cache_destroy (t8_forest_vtk_grid_cache_t **pcache)
+{
+  t8_forest_vtk_grid_cache_t *cache;
+
+  T8_ASSERT (pcache != NULL && *pcache != NULL);
+  cache = *pcache;
+  if (cache->forest != NULL) {
+    t8_forest_unref (&cache->forest);
+  }
+  delete cache;
+  *pcache = NULL;
+}
+
+void
+t8_forest_to_vtkUnstructuredGrid_cached (t8_forest_t forest,
+                                         t8_forest_vtk_grid_cache_t *cache,
+                                         const int write_treeid,
+                                         const int write_mpirank,
+                                         const int write_level,
+                                         const int write_element_id,
+                                         const int curved_flag,
+                                         const int write_ghosts,
+                                         const int num_data,
+                                         t8_vtk_data_field_t *data)
+{
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (forest->rc.refcount > 0);
+  T8_ASSERT (forest->committed);
+  T8_ASSERT (cache != NULL);
+
+  int                 ghosts = write_ghosts;
+  if (forest->ghosts == NULL || forest->ghosts->num_ghosts_elements == 0) {
+    /* Never write ghost elements if there aren't any */
+    ghosts = 0;
+  }
+  T8_ASSERT (forest->ghosts != NULL || !ghosts);
+
+  t8_locidx_t         num_elements =
+    t8_forest_get_local_num_elements (forest);
+  if (ghosts) {
+    num_elements += t8_forest_get_num_ghosts (forest);
+  }
+
+  if (cache->forest != forest || cache->write_treeid != write_treeid
+      || cache->write_mpirank != write_mpirank
+      || cache->write_level != write_level
+      || cache->write_element_id != write_element_id
+      || cache->curved_flag != curved_flag || cache->write_ghosts != ghosts) {
+    /* The topology is (possibly) different from the cached one, we build
+     * the points and cells of the grid. A committed forest is immutable,
+     * so if the same forest is passed again with the same flags we can
+     * skip this whole block and only rebind the user data below. */
+    const t8_gloidx_t   offset =
+      t8_forest_get_first_local_element_id (forest);
+    const t8_locidx_t   num_local_trees =
+      t8_forest_get_num_local_trees (forest);
+    const t8_locidx_t   num_ghost_trees =
+      ghosts ? t8_forest_ghost_num_trees (forest) : 0;
+    t8_locidx_t         num_points = 0;
+    t8_locidx_t         icell = 0;
+    vtkIdType           ids[T8_FOREST_VTK_QUADRATIC_ELEMENT_MAX_CORNERS];
+    vtkIdType           point_id = 0;
+
+    /* Count the points of all cells, so that the coordinate buffer can
+     * be allocated in one piece up front. */
+    for (t8_locidx_t itree = 0; itree < num_local_trees + num_ghost_trees;
+         itree++) {
+      const int           is_ghost = itree >= num_local_trees;
+      t8_eclass_scheme_c *scheme = t8_forest_get_eclass_scheme (forest,
+                                                                is_ghost ?
+                                                                t8_forest_ghost_get_tree_class
+                                                                (forest,
+                                                                 itree -
+                                                                 num_local_trees)
+                                                                :
+                                                                t8_forest_get_tree_class
+                                                                (forest,
+                                                                 itree));
+      const t8_locidx_t   elems_in_tree = is_ghost ?
+        t8_forest_ghost_tree_num_elements (forest, itree - num_local_trees) :
+        t8_forest_get_tree_num_elements (forest, itree);
+      for (t8_locidx_t ielement = 0; ielement < elems_in_tree; ielement++) {
+        const t8_element_t *element = is_ghost ?
+          t8_forest_ghost_get_element (forest, itree - num_local_trees,
+                                       ielement) :
+          t8_forest_get_element_in_tree (forest, itree, ielement);
+        num_points +=
+          t8_get_number_of_vtk_nodes (scheme->t8_element_shape (element),
+                                      curved_flag);
+      }
+    }
+
+    /* The coordinate buffer backing the vtkPoints. We fill it directly
+     * with the coordinate kernel instead of inserting the points one by
+     * one through the VTK API. */
+    vtkSmartPointer < vtkDoubleArray > coordinates =
+      vtkSmartPointer < vtkDoubleArray >::New ();
+    coordinates->SetNumberOfComponents (3);
+    coordinates->SetNumberOfTuples (num_points);
+    double             *coords = coordinates->GetPointer (0);
+
+    vtkSmartPointer < vtkCellArray > cellArray =
+      vtkSmartPointer < vtkCellArray >::New ();
+    int                *cellTypes = T8_ALLOC (int, num_elements);
+
+    vtkSmartPointer < t8_vtk_gloidx_array_type_t > vtk_treeid =
+      vtkSmartPointer < t8_vtk_gloidx_array_type_t >::New ();
+    vtkSmartPointer < t8_vtk_gloidx_array_type_t > vtk_mpirank =
+      vtkSmartPointer < t8_vtk_gloidx_array_type_t >::New ();
+    vtkSmartPointer < t8_vtk_gloidx_array_type_t > vtk_level =
+      vtkSmartPointer < t8_vtk_gloidx_array_type_t >::New ();
+    vtkSmartPointer < t8_vtk_gloidx_array_type_t > vtk_element_id =
+      vtkSmartPointer < t8_vtk_gloidx_array_type_t >::New ();
+    /* The meta data arrays are preallocated as well and filled by index */
+    if (write_treeid) {
+      vtk_treeid->SetNumberOfTuples (num_elements);
+    }
+    if (write_mpirank) {
+      vtk_mpirank->SetNumberOfTuples (num_elements);
+    }
+    if (write_level) {
+      vtk_level->SetNumberOfTuples (num_elements);
+    }
+    if (write_element_id) {
+      vtk_element_id->SetNumberOfTuples (num_elements);
+    }
+
+    /* Fill coordinates, connectivity, cell types and meta data in one
+     * sweep over the local and ghost elements. */
+    for (t8_locidx_t itree = 0; itree < num_local_trees + num_ghost_trees;
+         itree++) {
+      const int           is_ghost = itree >= num_local_trees;
+      const t8_locidx_t   lghost_tree = itree - num_local_trees;
+      t8_eclass_scheme_c *scheme = t8_forest_get_eclass_scheme (forest,
+                                                                is_ghost ?
+                                                                t8_forest_ghost_get_tree_class
+                                                                (forest,
+                                                                 lghost_tree)
+                                                                :
+                                                                t8_forest_get_tree_class
+                                                                (forest,
+                                                                 itree));
+      const t8_locidx_t   elems_in_tree = is_ghost ?
+        t8_forest_ghost_tree_num_elements (forest, lghost_tree) :
+        t8_forest_get_tree_num_elements (forest, itree);
+      for (t8_locidx_t ielement = 0; ielement < elems_in_tree;
+           ielement++, icell++) {
+        const t8_element_t *element = is_ghost ?
+          t8_forest_ghost_get_element (forest, lghost_tree, ielement) :
+          t8_forest_get_element_in_tree (forest, itree, ielement);
+        const t8_element_shape_t element_shape =
+          scheme->t8_element_shape (element);
+        const int           num_node =
+          t8_get_number_of_vtk_nodes (element_shape, curved_flag);
+
+        for (int ivertex = 0; ivertex < num_node; ivertex++, point_id++) {
+          /* Compute the vertex coordinates directly into the buffer */
+          t8_forest_vtk_get_element_nodes (forest, itree, element, ivertex,
+                                           coords + 3 * point_id, NULL);
+          ids[ivertex] = point_id;
+        }
+        /* The points are never shared between cells, so the connectivity
+         * is the running enumeration of the points */
+        cellArray->InsertNextCell (num_node, ids);
+        cellTypes[icell] = curved_flag ?
+          t8_curved_eclass_vtk_type[element_shape] :
+          t8_eclass_vtk_type[element_shape];
+        if (write_treeid) {
+          vtk_treeid->SetValue (icell, is_ghost ? -1 :
+                                t8_forest_global_tree_id (forest, itree));
+        }
+        if (write_mpirank) {
+          vtk_mpirank->SetValue (icell, forest->mpirank);
+        }
+        if (write_level) {
+          vtk_level->SetValue (icell, scheme->t8_element_level (element));
+        }
+        if (write_element_id) {
+          vtk_element_id->SetValue (icell, offset + icell);
+        }
+      }
+    }
+    T8_ASSERT (icell == num_elements);
+    T8_ASSERT (point_id == (vtkIdType) num_points);
+
+    vtkSmartPointer < vtkPoints > points =
+      vtkSmartPointer < vtkPoints >::New ();
+    points->SetData (coordinates);
+    cache->grid->SetPoints (points);
+    cache->grid->SetCells (cellTypes, cellArray);
+    T8_FREE (cellTypes);
+
+    /* *INDENT-OFF* */
+    if (write_treeid) {
+      vtk_treeid->SetName ("treeid");
+      cache->grid->GetCellData()->AddArray(vtk_treeid);
+    }
+    else {
+      cache->grid->GetCellData()->RemoveArray("treeid");
+    }
+    if (write_mpirank) {
+      vtk_mpirank->SetName ("mpirank");
+      cache->grid->GetCellData()->AddArray(vtk_mpirank);
+    }
+    else {
+      cache->grid->GetCellData()->RemoveArray("mpirank");
+    }
+    if (write_level) {
+      vtk_level->SetName ("level");
+      cache->grid->GetCellData()->AddArray(vtk_level);
+    }
+    else {
+      cache->grid->GetCellData()->RemoveArray("level");
+    }
+    if (write_element_id) {
+      vtk_element_id->SetName ("element_id");
+      cache->grid->GetCellData()->AddArray(vtk_element_id);
+    }
+    else {
+      cache->grid->GetCellData()->RemoveArray("element_id");
+    }
+    /* *INDENT-ON* */
+
+    /* Remember what the grid was built from. The reference keeps the
+     * forest alive, so the pointer comparison above cannot be fooled by
+     * a new forest that reuses the address of a destroyed one. */
+    t8_forest_ref (forest);
+    if (cache->forest != NULL) {
+      t8_forest_unref (&cache->forest);
+    }
+    cache->forest = forest;
+    cache->write_treeid = write_treeid;
+    cache->write_mpirank = write_mpirank;
+    cache->write_level = write_level;
+    cache->write_element_id = write_element_id;
+    cache->curved_flag = curved_flag;
+    cache->write_ghosts = ghosts;
+    cache->num_elements = num_elements;
+  }
+
+  /* (Re)bind the user data arrays zero-copy to the caller's buffers.
+   * vtkCellData replaces arrays with the same name, so between two
+   * adaptations this is all that happens per call. */
+  for (int idata = 0; idata < num_data; idata++) {
+    vtkSmartPointer < vtkDoubleArray > dataArray =
+      vtkSmartPointer < vtkDoubleArray >::New ();
+    dataArray->SetName (data[idata].description);
+    if (data[idata].type == T8_VTK_SCALAR) {
+      dataArray->SetVoidArray (data[idata].data, num_elements, 1);
+      cache->grid->GetCellData ()->AddArray (dataArray);
+    }
+    else {
+      dataArray->SetNumberOfComponents (3);
+      dataArray->SetVoidArray (data[idata].data, num_elements * 3, 1);
+      cache->grid->GetCellData ()->SetVectors (dataArray);
+    }
+  }
+}
 #endif
 
 static t8_locidx_t
@@ -725,6 +1017,17 @@ t8_forest_num_points (t8_forest_t forest, const int count_ghosts)
   return num_points;
 }
 
+/* The coordinate precision settings of one write, passed to the
+ * vertices kernel as user data. box_min and step are only valid if
+ * precision is T8_COORD_PRECISION_QUANTIZED,
+ * \see t8_forest_coordinate_quantization_grid. */
+typedef struct
+{
+  int                 precision;        /* The t8_coord_precision_t of the write */
+  double              box_min[3];       /* Minimal corner of the quantization box */
+  double              step[3];  /* Quantization step per dimension */
+} t8_forest_vtk_coord_precision_t;
+
 static int
 t8_forest_vtk_cells_vertices_kernel (t8_forest_t forest,
                                      const t8_locidx_t ltree_id,
@@ -736,8 +1039,9 @@ t8_forest_vtk_cells_vertices_kernel (t8_forest_t forest,
                                      int *columns, void **data,
                                      T8_VTK_KERNEL_MODUS modus)
 {
+  const t8_forest_vtk_coord_precision_t *precision;
   double              element_coordinates[3];
-  int                 num_el_vertices, ivertex;
+  int                 num_el_vertices, ivertex, idim;
   int                 freturn;
   t8_element_shape_t  element_shape;
 
@@ -750,6 +1054,9 @@ t8_forest_vtk_cells_vertices_kernel (t8_forest_t forest,
    *       does this work too over tree->class or do we need something else?
    */
 
+  /* The reduced precision settings of this write, \see
+   * t8_forest_vtk_write_points */
+  precision = (const t8_forest_vtk_coord_precision_t *) *data;
   element_shape = ts->t8_element_shape (element);
   num_el_vertices = t8_eclass_num_vertices[element_shape];
   for (ivertex = 0; ivertex < num_el_vertices; ivertex++) {
@@ -761,15 +1068,36 @@ t8_forest_vtk_cells_vertices_kernel (t8_forest_t forest,
     if (freturn <= 0) {
       return 0;
     }
+    if (precision != NULL
+        && precision->precision != T8_COORD_PRECISION_FLOAT64) {
+      if (precision->precision == T8_COORD_PRECISION_QUANTIZED) {
+        /* Snap the coordinates to the quantization grid */
+        for (idim = 0; idim < 3; idim++) {
+          if (precision->step[idim] > 0) {
+            element_coordinates[idim] = precision->box_min[idim]
+              + round ((element_coordinates[idim]
+                        - precision->box_min[idim])
+                       / precision->step[idim]) * precision->step[idim];
+          }
+        }
+      }
+      /* Render with single precision digits */
+      freturn = fprintf (vtufile, " %16.8e %16.8e %16.8e\n",
+                         (double) (float) element_coordinates[0],
+                         (double) (float) element_coordinates[1],
+                         (double) (float) element_coordinates[2]);
+    }
+    else {
 #ifdef T8_VTK_DOUBLES
-    freturn = fprintf (vtufile, " %24.16e %24.16e %24.16e\n",
-                       element_coordinates[0], element_coordinates[1],
-                       element_coordinates[2]);
+      freturn = fprintf (vtufile, " %24.16e %24.16e %24.16e\n",
+                         element_coordinates[0], element_coordinates[1],
+                         element_coordinates[2]);
 #else
-    freturn = fprintf (vtufile, " %16.8e %16.8e %16.8e\n",
-                       element_coordinates[0], element_coordinates[1],
-                       element_coordinates[2]);
+      freturn = fprintf (vtufile, " %16.8e %16.8e %16.8e\n",
+                         element_coordinates[0], element_coordinates[1],
+                         element_coordinates[2]);
 #endif
+    }
     if (freturn <= 0) {
       return 0;
     }
@@ -805,6 +1133,11 @@ t8_forest_vtk_cells_connectivity_kernel (t8_forest_t forest,
     T8_FREE (*data);
     return 1;
   }
+  else if (modus == T8_VTK_KERNEL_SEED) {
+    /* Fast-forward the vertex counter past the preceding elements. */
+    *(t8_locidx_t *) *data = element_index;
+    return 1;
+  }
   T8_ASSERT (modus == T8_VTK_KERNEL_EXECUTE);
 
   count_vertices = (t8_locidx_t *) *data;
@@ -842,6 +1175,11 @@ t8_forest_vtk_cells_offset_kernel (t8_forest_t forest,
     T8_FREE (*data);
     return 1;
   }
+  else if (modus == T8_VTK_KERNEL_SEED) {
+    /* Fast-forward the offset counter past the preceding elements. */
+    *(long long *) *data = (long long) element_index;
+    return 1;
+  }
   T8_ASSERT (modus == T8_VTK_KERNEL_EXECUTE);
 
   offset = (long long *) *data;
@@ -1108,6 +1446,218 @@ t8_forest_vtk_vertices_vector_kernel (t8_forest_t forest,
 
 /* Iterate over all cells and write cell data to the file using
  * the cell_data_kernel as callback */
+/* Execute a cell data kernel on all elements of the local trees
+ * [first_tree, end_tree), writing to \a vtufile. The kernel must have
+ * been initialized (and possibly seeded) before; the caller remains
+ * responsible for calling it in clean-up modus.
+ * Returns true on success and zero on file i/o error. */
+static int
+t8_forest_vtk_write_cell_range (t8_forest_t forest, FILE *vtufile,
+                                const int max_columns,
+                                t8_forest_vtk_cell_data_kernel kernel,
+                                const t8_locidx_t first_tree,
+                                const t8_locidx_t end_tree,
+                                int *countcols, void **data)
+{
+  int                 freturn;
+  t8_tree_t           tree;
+  t8_locidx_t         itree;
+  t8_locidx_t         element_index, elems_in_tree;
+  t8_element_t       *element;
+  t8_eclass_scheme_c *ts;
+
+  /* We iterate over the trees and execute the kernel on each element */
+  /* TODO: replace with an element iterator */
+  for (itree = first_tree; itree < end_tree; itree++) {
+    /* Get the tree that stores the elements */
+    tree = t8_forest_get_tree (forest, itree);
+    /* Get the eclass scheme of the tree */
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    elems_in_tree =
+      (t8_locidx_t) t8_element_array_get_count (&tree->elements);
+    for (element_index = 0; element_index < elems_in_tree; element_index++) {
+      /* Get a pointer to the element */
+      element =
+        t8_forest_get_element (forest, tree->elements_offset + element_index,
+                               NULL);
+      T8_ASSERT (element != NULL);
+      /* Execute the given callback on each element */
+      if (!kernel
+          (forest, itree, tree, element_index, element, ts, 0, vtufile,
+           countcols, data, T8_VTK_KERNEL_EXECUTE)) {
+        return 0;
+      }
+      /* After max_columns we break the line */
+      if (!(*countcols % max_columns)) {
+        freturn = fprintf (vtufile, "\n         ");
+        if (freturn <= 0) {
+          return 0;
+        }
+      }
+    }                           /* element loop ends here */
+  }                             /* tree loop ends here */
+  return 1;
+}
+
+#if defined (SC_ENABLE_PTHREAD)
+/* The share of one thread of the cell serialization. Each worker
+ * renders the elements of a contiguous tree range into an in-memory
+ * stream with a private copy of the kernel state. */
+typedef struct t8_forest_vtk_render_worker
+{
+  t8_forest_t         forest;   /**< The forest that is written. */
+  t8_forest_vtk_cell_data_kernel kernel;        /**< The kernel to execute. */
+  void               *udata;    /**< User data for the kernel, or NULL. */
+  t8_locidx_t         first_tree;       /**< First local tree of the range. */
+  t8_locidx_t         end_tree; /**< One past the last tree of the range. */
+  t8_locidx_t         seed;     /**< Number of element corners of all elements
+                                     before \a first_tree. */
+  int                 max_columns;      /**< Column count before a line break. */
+  char               *buffer;   /**< The rendered bytes, allocated by
+                                     open_memstream. */
+  size_t              buffer_bytes;     /**< Number of bytes in \a buffer. */
+  int                 retval;   /**< True if the range was rendered. */
+} t8_forest_vtk_render_worker_t;
+
+/* Entry point of a render worker thread. Renders the worker's tree
+ * range into a memory stream via the unchanged fprintf based kernel. */
+static void        *
+t8_forest_vtk_render_worker_run (void *vworker)
+{
+  t8_forest_vtk_render_worker_t *worker =
+    (t8_forest_vtk_render_worker_t *) vworker;
+  FILE               *memfile;
+  void               *data = NULL;
+  int                 countcols = 0;
+
+  worker->retval = 0;
+  /* open_memstream is POSIX 2008 and thus available wherever the
+   * pthread support that guards this function is. */
+  memfile = open_memstream (&worker->buffer, &worker->buffer_bytes);
+  if (memfile == NULL) {
+    return NULL;
+  }
+  if (worker->udata != NULL) {
+    data = worker->udata;
+  }
+  worker->kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, &data,
+                  T8_VTK_KERNEL_INIT);
+  /* Fast-forward stateful kernels to the start of the range. */
+  worker->kernel (worker->forest, 0, NULL, worker->seed, NULL, NULL, 0, NULL,
+                  NULL, &data, T8_VTK_KERNEL_SEED);
+  worker->retval =
+    t8_forest_vtk_write_cell_range (worker->forest, memfile,
+                                    worker->max_columns, worker->kernel,
+                                    worker->first_tree, worker->end_tree,
+                                    &countcols, &data);
+  worker->kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, &data,
+                  T8_VTK_KERNEL_CLEANUP);
+  if (fclose (memfile) != 0) {
+    worker->retval = 0;
+  }
+  return NULL;
+}
+
+/* Render the cell data of all local trees with the forest's vtk threads
+ * and write the buffers to \a vtufile in tree order. On output
+ * \a points_written holds the number of element corners of all local
+ * elements, which the caller uses to seed its own kernel state for the
+ * ghost loop. Returns true on success. */
+static int
+t8_forest_vtk_write_cells_threaded (t8_forest_t forest, FILE *vtufile,
+                                    const int max_columns,
+                                    t8_forest_vtk_cell_data_kernel kernel,
+                                    void *udata,
+                                    t8_locidx_t *points_written)
+{
+  t8_forest_vtk_render_worker_t *workers;
+  t8_locidx_t        *tree_points;
+  t8_locidx_t         num_local_trees, itree, split_tree;
+  t8_locidx_t         num_elements;
+  t8_tree_t           tree;
+  t8_eclass_scheme_c *ts;
+  size_t              ielem, elems_in_tree;
+  int                 num_threads, ithread;
+  int                 retval = 1;
+
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  num_elements = t8_forest_get_local_num_elements (forest);
+  num_threads = SC_MIN (forest->vtk_num_threads, (int) num_local_trees);
+  T8_ASSERT (num_threads >= 1);
+
+  /* Count the element corners per tree, so that each worker knows the
+   * number of corners preceding its range. tree_points[i] holds the
+   * count of all elements before tree i. */
+  tree_points = T8_ALLOC (t8_locidx_t, num_local_trees + 1);
+  tree_points[0] = 0;
+  for (itree = 0; itree < num_local_trees; itree++) {
+    tree = t8_forest_get_tree (forest, itree);
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    tree_points[itree + 1] = tree_points[itree];
+    elems_in_tree = t8_element_array_get_count (&tree->elements);
+    for (ielem = 0; ielem < elems_in_tree; ielem++) {
+      const t8_element_t *element =
+        t8_element_array_index_locidx (&tree->elements, ielem);
+      tree_points[itree + 1] +=
+        t8_eclass_num_vertices[ts->t8_element_shape (element)];
+    }
+  }
+
+  workers = T8_ALLOC (t8_forest_vtk_render_worker_t, num_threads);
+  /* Split the trees into ranges of roughly equal element count. The
+   * range of thread i ends at the first tree whose element offset
+   * reaches the i+1-th fraction of the local element count. */
+  split_tree = 0;
+  for (ithread = 0; ithread < num_threads; ithread++) {
+    workers[ithread].forest = forest;
+    workers[ithread].kernel = kernel;
+    workers[ithread].udata = udata;
+    workers[ithread].max_columns = max_columns;
+    workers[ithread].first_tree = split_tree;
+    workers[ithread].seed = tree_points[split_tree];
+    if (ithread == num_threads - 1) {
+      split_tree = num_local_trees;
+    }
+    else {
+      const t8_locidx_t   target =
+        (t8_locidx_t) ((t8_gloidx_t) num_elements * (ithread + 1) /
+                       num_threads);
+      while (split_tree < num_local_trees
+             && t8_forest_get_tree (forest, split_tree)->elements_offset <
+             target) {
+        split_tree++;
+      }
+    }
+    workers[ithread].end_tree = split_tree;
+  }
+  T8_ASSERT (split_tree == num_local_trees);
+  t8_thread_pool_exec (t8_forest_vtk_render_worker_run, workers,
+                       sizeof (t8_forest_vtk_render_worker_t), num_threads);
+  /* Write the rendered buffers to the file in tree order. */
+  for (ithread = 0; ithread < num_threads; ithread++) {
+    if (!workers[ithread].retval) {
+      retval = 0;
+    }
+    else if (workers[ithread].buffer_bytes > 0
+             && fwrite (workers[ithread].buffer, 1,
+                        workers[ithread].buffer_bytes,
+                        vtufile) != workers[ithread].buffer_bytes) {
+      retval = 0;
+    }
+    /* The buffer was allocated by open_memstream, thus stdio's free. */
+    free (workers[ithread].buffer);
+  }
+  *points_written = tree_points[num_local_trees];
+  T8_FREE (tree_points);
+  T8_FREE (workers);
+  return retval;
+}
+#endif /* SC_ENABLE_PTHREAD */
+
 static int
 t8_forest_vtk_write_cell_data (t8_forest_t forest, FILE *vtufile,
                                const char *dataname,
@@ -1119,9 +1669,8 @@ t8_forest_vtk_write_cell_data (t8_forest_t forest, FILE *vtufile,
 {
   int                 freturn;
   int                 countcols;
-  t8_tree_t           tree;
-  t8_locidx_t         itree, ighost;
-  t8_locidx_t         element_index, elems_in_tree;
+  t8_locidx_t         ighost;
+  t8_locidx_t         element_index;
   t8_locidx_t         num_local_trees, num_ghost_trees;
   t8_element_t       *element;
   t8_eclass_scheme_c *ts;
@@ -1148,50 +1697,38 @@ t8_forest_vtk_write_cell_data (t8_forest_t forest, FILE *vtufile,
           T8_VTK_KERNEL_INIT);
   /* We iterate over the trees and count each trees vertices,
    * we add this to the already counted vertices and write it to the file */
-  /* TODO: replace with an element iterator */
   num_local_trees = t8_forest_get_num_local_trees (forest);
-  for (itree = 0, countcols = 0; itree < num_local_trees; itree++) {
-    /* Get the tree that stores the elements */
-    tree = t8_forest_get_tree (forest, itree);
-    /* Get the eclass scheme of the tree */
-    ts = t8_forest_get_eclass_scheme (forest,
-                                      t8_forest_get_tree_class (forest,
-                                                                itree));
-    elems_in_tree =
-      (t8_locidx_t) t8_element_array_get_count (&tree->elements);
-    for (element_index = 0; element_index < elems_in_tree; element_index++) {
-      /* Get a pointer to the element */
-      element =
-        t8_forest_get_element (forest, tree->elements_offset + element_index,
-                               NULL);
-      T8_ASSERT (element != NULL);
-      /* Execute the given callback on each element */
-      if (!kernel
-          (forest, itree, tree, element_index, element, ts, 0, vtufile,
-           &countcols, &data, T8_VTK_KERNEL_EXECUTE)) {
-        /* call the kernel in clean-up modus */
-        kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, &data,
-                T8_VTK_KERNEL_CLEANUP);
-        return 0;
-      }
-      /* After max_columns we break the line */
-      if (!(countcols % max_columns)) {
-        freturn = fprintf (vtufile, "\n         ");
-        if (freturn <= 0) {
-          /* call the kernel in clean-up modus */
-          kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, &data,
-                  T8_VTK_KERNEL_CLEANUP);
-          return 0;
-        }
-      }
-    }                           /* element loop ends here */
-    if (freturn <= 0) {
+  countcols = 0;
+  freturn = 1;
+#if defined (SC_ENABLE_PTHREAD)
+  if (forest->vtk_num_threads > 1 && num_local_trees > 1) {
+    t8_locidx_t         points_written;
+
+    /* Render the local trees with worker threads into in-memory
+     * buffers that are written to the file in tree order. */
+    if (!t8_forest_vtk_write_cells_threaded (forest, vtufile, max_columns,
+                                             kernel, udata,
+                                             &points_written)) {
       /* call the kernel in clean-up modus */
       kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, &data,
               T8_VTK_KERNEL_CLEANUP);
       return 0;
     }
-  }                             /* tree loop ends here */
+    /* Fast-forward the kernel state of this thread past the local
+     * elements, so that the ghost loop below continues correctly. */
+    kernel (forest, 0, NULL, points_written, NULL, NULL, 0, NULL, NULL,
+            &data, T8_VTK_KERNEL_SEED);
+  }
+  else
+#endif
+  if (!t8_forest_vtk_write_cell_range (forest, vtufile, max_columns, kernel,
+                                       0, num_local_trees, &countcols,
+                                       &data)) {
+    /* call the kernel in clean-up modus */
+    kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, &data,
+            T8_VTK_KERNEL_CLEANUP);
+    return 0;
+  }
 
   if (write_ghosts) {
     t8_locidx_t         num_ghosts_in_tree;
@@ -1425,6 +1962,8 @@ t8_forest_vtk_write_points (t8_forest_t forest, FILE *vtufile,
                             const int write_ghosts,
                             const int num_data, t8_vtk_data_field_t *data)
 {
+  t8_forest_vtk_coord_precision_t precision;
+  const char         *position_type;
   int                 freturn;
   int                 sreturn;
   int                 idata;
@@ -1433,6 +1972,20 @@ t8_forest_vtk_write_points (t8_forest_t forest, FILE *vtufile,
   T8_ASSERT (t8_forest_is_committed (forest));
   T8_ASSERT (vtufile != NULL);
 
+  /* Select the coordinate precision of this write,
+   * \see t8_forest_set_coordinate_precision */
+  precision.precision = forest->coord_precision;
+  position_type = T8_VTK_FLOAT_NAME;
+  if (forest->coord_precision != T8_COORD_PRECISION_FLOAT64) {
+    position_type = "Float32";
+    if (forest->coord_precision == T8_COORD_PRECISION_QUANTIZED) {
+      /* Compute the quantization grid. This is a collective call, all
+       * processes enter the writer. */
+      t8_forest_coordinate_quantization_grid (forest, precision.box_min,
+                                              precision.step);
+    }
+  }
+
   /* Write the vertex coordinates */
 
   freturn = fprintf (vtufile, "      <Points>\n");
@@ -1440,11 +1993,11 @@ t8_forest_vtk_write_points (t8_forest_t forest, FILE *vtufile,
     goto t8_forest_vtk_cell_failure;
   }
   freturn = t8_forest_vtk_write_cell_data (forest, vtufile, "Position",
-                                           T8_VTK_FLOAT_NAME,
+                                           position_type,
                                            "NumberOfComponents=\"3\"",
                                            8,
                                            t8_forest_vtk_cells_vertices_kernel,
-                                           write_ghosts, NULL);
+                                           write_ghosts, &precision);
   if (!freturn) {
     goto t8_forest_vtk_cell_failure;
   }
@@ -1515,48 +2068,837 @@ t8_forest_vtk_cell_failure:
   return 0;
 }
 
-int
-t8_forest_vtk_write_file (t8_forest_t forest, const char *fileprefix,
-                          const int write_treeid,
-                          const int write_mpirank,
-                          const int write_level, const int write_element_id,
-                          int write_ghosts,
-                          const int num_data, t8_vtk_data_field_t *data)
+/* A data array of the binary appended-data vtk writer.
+ * Each array becomes one raw block in the appended data section of the
+ * shared .vtu file. The block starts with its total payload byte count
+ * (written by process 0) followed by the payloads of all processes in
+ * rank order. */
+typedef struct t8_forest_vtk_binary_array
 {
-  FILE               *vtufile = NULL;
-  t8_locidx_t         num_elements, num_points;
-  char                vtufilename[BUFSIZ];
-  int                 freturn;
+  const char         *name;     /* The DataArray name */
+  const char         *datatype; /* The vtk type string, e.g. "Float64" */
+  int                 num_components;   /* Number of components, 0 if the attribute is omitted */
+  char               *local_bytes;      /* This process' payload */
+  int                 owns_bytes;       /* True if local_bytes was allocated by us */
+  size_t              local_byte_count; /* Payload bytes of this process */
+  long long           local_byte_offset;        /* Offset of this process' payload inside the block */
+  long long           global_byte_count;        /* Payload bytes of all processes */
+  long long           appended_offset;  /* Offset of the block inside the appended data section */
+} t8_forest_vtk_binary_array_t;
+
+/* The maximum number of bytes written per i/o call. MPI-IO counts are
+ * ints, so larger payloads are split into chunks of this size. */
+#define T8_FOREST_VTK_CHUNK_BYTES (1 << 30)
+
+/* Fill the local payload buffers of all data arrays in a single pass
+ * over the local elements. \a point_offset is the global index of this
+ * process' first point and \a element_offset the global index of its
+ * first element. */
+static void
+t8_forest_vtk_fill_binary_arrays (t8_forest_t forest,
+                                  t8_forest_vtk_binary_array_t *arrays,
+                                  const int num_fixed_arrays,
+                                  const long long point_offset,
+                                  const long long element_offset)
+{
+  double             *points = (double *) arrays[0].local_bytes;
+  long long          *connectivity = (long long *) arrays[1].local_bytes;
+  long long          *offsets = (long long *) arrays[2].local_bytes;
+  int32_t            *types = (int32_t *) arrays[3].local_bytes;
+  t8_locidx_t         num_local_trees, itree;
+  t8_locidx_t         element_index, elems_in_tree;
+  long long           point_count = 0, element_count = 0;
+  int                 iarray;
 
-  T8_ASSERT (forest != NULL);
-  T8_ASSERT (t8_forest_is_committed (forest));
-  T8_ASSERT (fileprefix != NULL);
-  if (forest->ghosts == NULL || forest->ghosts->num_ghosts_elements == 0) {
-    /* Never write ghost elements if there aren't any */
-    write_ghosts = 0;
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0; itree < num_local_trees; itree++) {
+    t8_tree_t           tree = t8_forest_get_tree (forest, itree);
+    t8_eclass_scheme_c *ts =
+      t8_forest_get_eclass_scheme (forest,
+                                   t8_forest_get_tree_class (forest, itree));
+    elems_in_tree = (t8_locidx_t) t8_element_array_get_count (&tree->elements);
+    for (element_index = 0; element_index < elems_in_tree;
+         element_index++, element_count++) {
+      const t8_element_t *element =
+        t8_forest_get_element (forest, tree->elements_offset + element_index,
+                               NULL);
+      const t8_element_shape_t element_shape = ts->t8_element_shape (element);
+      const int           num_vertices = t8_eclass_num_vertices[element_shape];
+      int                 ivertex;
+
+      for (ivertex = 0; ivertex < num_vertices; ivertex++, point_count++) {
+        /* The points are written per element in vtk corner order, thus
+         * the connectivity simply counts up globally. */
+        t8_forest_element_coordinate (forest, itree, element,
+                                      t8_eclass_t8_to_vtk_corner_number
+                                      [element_shape][ivertex],
+                                      points + 3 * point_count);
+        connectivity[point_count] = point_offset + point_count;
+      }
+      offsets[element_count] = point_offset + point_count;
+      types[element_count] = t8_eclass_vtk_type[element_shape];
+      /* Fill the optional per element arrays */
+      for (iarray = 4; iarray < num_fixed_arrays; iarray++) {
+        if (!strcmp (arrays[iarray].name, "treeid")) {
+          ((long long *) arrays[iarray].local_bytes)[element_count] =
+            (long long) itree + forest->first_local_tree;
+        }
+        else if (!strcmp (arrays[iarray].name, "mpirank")) {
+          ((int32_t *) arrays[iarray].local_bytes)[element_count] =
+            forest->mpirank;
+        }
+        else if (!strcmp (arrays[iarray].name, "level")) {
+          ((int32_t *) arrays[iarray].local_bytes)[element_count] =
+            ts->t8_element_level (element);
+        }
+        else {
+          T8_ASSERT (!strcmp (arrays[iarray].name, "element_id"));
+          ((long long *) arrays[iarray].local_bytes)[element_count] =
+            element_offset + element_count;
+        }
+      }
+    }
   }
-  T8_ASSERT (forest->ghosts != NULL || !write_ghosts);
-
-  /* Currently we only support output in ascii format, not binary */
-  T8_ASSERT (T8_VTK_ASCII == 1);
+  T8_ASSERT (point_count * (long long) sizeof (long long)
+             == (long long) arrays[1].local_byte_count);
+  T8_ASSERT (element_count * (long long) sizeof (int32_t)
+             == (long long) arrays[3].local_byte_count);
+}
 
-  /* process 0 creates the .pvtu file */
-  if (forest->mpirank == 0) {
-    if (t8_write_pvtu
-        (fileprefix, forest->mpisize, write_treeid, write_mpirank,
-         write_level, write_element_id, num_data, data)) {
-      t8_errorf ("Error when writing file %s.pvtu\n", fileprefix);
-      goto t8_forest_vtk_failure;
+/* Convert the generated double precision coordinates to the reduced
+ * output precision, optionally snapping them to the quantization grid
+ * first. Collective if quantization is selected, since the grid is
+ * agreed on by all processes. */
+static void
+t8_forest_vtk_reduce_coordinates (t8_forest_t forest, const double *coords,
+                                  float *reduced, long long num_values)
+{
+  double              box_min[3], step[3];
+  double              value;
+  long long           ival;
+  int                 idim;
+
+  if (forest->coord_precision == T8_COORD_PRECISION_QUANTIZED) {
+    t8_forest_coordinate_quantization_grid (forest, box_min, step);
+    for (ival = 0; ival < num_values; ival++) {
+      idim = (int) (ival % 3);
+      value = coords[ival];
+      if (step[idim] > 0) {
+        value = box_min[idim]
+          + round ((value - box_min[idim]) / step[idim]) * step[idim];
+      }
+      reduced[ival] = (float) value;
     }
   }
-
-  /* The local number of elements */
-  num_elements = t8_forest_get_local_num_elements (forest);
-  if (write_ghosts) {
-    num_elements += t8_forest_get_num_ghosts (forest);
+  else {
+    for (ival = 0; ival < num_values; ival++) {
+      reduced[ival] = (float) coords[ival];
+    }
   }
-  /* The local number of points, counted with multiplicity */
-  num_points = t8_forest_num_points (forest, write_ghosts);
+}
+
+#ifdef T8_ENABLE_MPIIO
+/* Write the file with collective MPI-IO. Every process calls the same
+ * sequence of collective writes; for the header, the block byte counts
+ * and the file tail only process 0 contributes bytes. */
+static int
+t8_forest_vtk_write_binary_file_mpiio (sc_MPI_Comm comm, int mpirank,
+                                       const char *vtufilename,
+                                       const char *header,
+                                       const long long header_bytes,
+                                       const char *tail,
+                                       t8_forest_vtk_binary_array_t *arrays,
+                                       const int num_arrays,
+                                       const long long total_bytes)
+{
+  MPI_File            fh;
+  MPI_Status          status;
+  int                 mpiret, iarray, ichunk, num_chunks;
+  size_t              max_local_bytes = 0, written;
+  long long           block_start;
+  uint64_t            block_size;
+
+  mpiret = MPI_File_open (comm, (char *) vtufilename,
+                          MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL,
+                          &fh);
+  if (mpiret != sc_MPI_SUCCESS) {
+    t8_errorf ("Error when opening file %s for MPI-IO\n", vtufilename);
+    return 0;
+  }
+  /* Truncate any leftover content from a previous file */
+  mpiret = MPI_File_set_size (fh, (MPI_Offset) total_bytes);
+  SC_CHECK_MPI (mpiret);
+
+  /* Write the xml header */
+  mpiret = MPI_File_write_at_all (fh, 0, (void *) header,
+                                  mpirank == 0 ? (int) header_bytes : 0,
+                                  MPI_BYTE, &status);
+  SC_CHECK_MPI (mpiret);
+
+  /* The number of chunks must be equal on all processes for the writes
+   * to stay collective, so we use the maximum local payload size. */
+  for (iarray = 0; iarray < num_arrays; iarray++) {
+    max_local_bytes = SC_MAX (max_local_bytes, arrays[iarray].local_byte_count);
+  }
+  mpiret = sc_MPI_Allreduce (sc_MPI_IN_PLACE, &max_local_bytes, 1,
+                             sc_MPI_UNSIGNED_LONG, sc_MPI_MAX, comm);
+  SC_CHECK_MPI (mpiret);
+  num_chunks = (int) ((max_local_bytes + T8_FOREST_VTK_CHUNK_BYTES - 1)
+                      / T8_FOREST_VTK_CHUNK_BYTES);
+
+  block_start = header_bytes;
+  for (iarray = 0; iarray < num_arrays; iarray++) {
+    t8_forest_vtk_binary_array_t *arr = arrays + iarray;
+
+    T8_ASSERT (block_start == header_bytes + arr->appended_offset);
+    /* Process 0 writes the byte count that starts the block */
+    block_size = (uint64_t) arr->global_byte_count;
+    mpiret = MPI_File_write_at_all (fh, (MPI_Offset) block_start,
+                                    &block_size,
+                                    mpirank == 0 ? (int) sizeof (uint64_t) : 0,
+                                    MPI_BYTE, &status);
+    SC_CHECK_MPI (mpiret);
+    /* All processes write their payload slice of the block */
+    for (ichunk = 0, written = 0; ichunk < num_chunks; ichunk++) {
+      const size_t        chunk_bytes =
+        SC_MIN ((size_t) T8_FOREST_VTK_CHUNK_BYTES,
+                arr->local_byte_count - written);
+      mpiret = MPI_File_write_at_all (fh, (MPI_Offset) (block_start
+                                                        + (long long)
+                                                        sizeof (uint64_t)
+                                                        +
+                                                        arr->local_byte_offset
+                                                        + (long long) written),
+                                      arr->local_bytes + written,
+                                      (int) chunk_bytes, MPI_BYTE, &status);
+      SC_CHECK_MPI (mpiret);
+      written += chunk_bytes;
+    }
+    block_start += (long long) sizeof (uint64_t) + arr->global_byte_count;
+  }
+
+  /* Write the file tail */
+  mpiret = MPI_File_write_at_all (fh, (MPI_Offset) block_start, (void *) tail,
+                                  mpirank == 0 ? (int) strlen (tail) : 0,
+                                  MPI_BYTE, &status);
+  SC_CHECK_MPI (mpiret);
+  mpiret = MPI_File_close (&fh);
+  SC_CHECK_MPI (mpiret);
+  return 1;
+}
+#else
+/* Write the file without MPI-IO. The processes append to the shared
+ * file one after another, serialized by a token passed along the ranks.
+ * The write offsets are precomputed, so each process seeks to its slice
+ * of every block and writes it with stdio. */
+static int
+t8_forest_vtk_write_binary_file_serial (sc_MPI_Comm comm, int mpirank,
+                                        int mpisize,
+                                        const char *vtufilename,
+                                        const char *header,
+                                        const long long header_bytes,
+                                        const char *tail,
+                                        t8_forest_vtk_binary_array_t *arrays,
+                                        const int num_arrays,
+                                        const long long total_bytes)
+{
+  FILE               *vtufile;
+  int                 mpiret, iarray, token = 0;
+  long long           block_start;
+  uint64_t            block_size;
+
+  if (mpirank > 0) {
+    /* Wait until the previous process is done writing */
+    mpiret = sc_MPI_Recv (&token, 1, sc_MPI_INT, mpirank - 1, 0, comm,
+                          sc_MPI_STATUS_IGNORE);
+    SC_CHECK_MPI (mpiret);
+  }
+  vtufile = fopen (vtufilename, mpirank == 0 ? "wb" : "r+b");
+  if (vtufile == NULL) {
+    t8_errorf ("Error when opening file %s\n", vtufilename);
+    return 0;
+  }
+  if (mpirank == 0) {
+    /* Process 0 writes the header, the block byte counts and the tail */
+    fwrite (header, 1, header_bytes, vtufile);
+    for (iarray = 0; iarray < num_arrays; iarray++) {
+      block_size = (uint64_t) arrays[iarray].global_byte_count;
+      fseek (vtufile, header_bytes + arrays[iarray].appended_offset,
+             SEEK_SET);
+      fwrite (&block_size, sizeof (uint64_t), 1, vtufile);
+    }
+    fseek (vtufile, total_bytes - (long long) strlen (tail), SEEK_SET);
+    fwrite (tail, 1, strlen (tail), vtufile);
+  }
+  for (iarray = 0; iarray < num_arrays; iarray++) {
+    t8_forest_vtk_binary_array_t *arr = arrays + iarray;
+
+    block_start = header_bytes + arr->appended_offset
+      + (long long) sizeof (uint64_t);
+    fseek (vtufile, block_start + arr->local_byte_offset, SEEK_SET);
+    if (fwrite (arr->local_bytes, 1, arr->local_byte_count, vtufile)
+        != arr->local_byte_count) {
+      t8_errorf ("Error when writing to file %s\n", vtufilename);
+      fclose (vtufile);
+      return 0;
+    }
+  }
+  if (fclose (vtufile) != 0) {
+    t8_errorf ("Error when closing file %s\n", vtufilename);
+    return 0;
+  }
+  if (mpirank < mpisize - 1) {
+    /* Pass the token to the next process */
+    mpiret = sc_MPI_Send (&token, 1, sc_MPI_INT, mpirank + 1, 0, comm);
+    SC_CHECK_MPI (mpiret);
+  }
+  return 1;
+}
+#endif
+
+int
+t8_forest_vtk_write_file_binary (t8_forest_t forest, const char *fileprefix,
+                                 const int write_treeid,
+                                 const int write_mpirank,
+                                 const int write_level,
+                                 const int write_element_id,
+                                 const int num_data,
+                                 t8_vtk_data_field_t *data)
+{
+  t8_forest_vtk_binary_array_t arrays[8 + 16];
+  char                vtufilename[BUFSIZ];
+  char               *header = NULL;
+  const char         *tail = "\n  </AppendedData>\n</VTKFile>\n";
+  char                dataarray[BUFSIZ];
+  size_t              header_size, header_used;
+  long long           local_counts[2], scan_counts[2], total_counts[2];
+  long long           element_offset, point_offset;
+  long long           header_bytes, appended_bytes, total_bytes;
+  t8_locidx_t         num_elements, num_points;
+  double             *coords_full = NULL;
+  char               *coord_final = NULL;
+  size_t              coord_size;
+  int                 num_arrays, num_fixed_arrays, iarray, idata;
+  int                 coord_reduced;
+  int                 mpiret, retval;
+
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (fileprefix != NULL);
+  SC_CHECK_ABORT (num_data <= 16,
+                  "Too many data fields for binary vtk output.\n");
+
+  retval = snprintf (vtufilename, BUFSIZ, "%s.vtu", fileprefix);
+  if (retval >= BUFSIZ) {
+    t8_errorf ("Error when writing vtu file. Filename too long.\n");
+    return 0;
+  }
+
+  /* Compute the global counts and this process' offsets via prefix sums */
+  num_elements = t8_forest_get_local_num_elements (forest);
+  num_points = t8_forest_num_points (forest, 0);
+  local_counts[0] = (long long) num_elements;
+  local_counts[1] = (long long) num_points;
+  mpiret = sc_MPI_Scan (local_counts, scan_counts, 2, sc_MPI_LONG_LONG_INT,
+                        sc_MPI_SUM, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Allreduce (local_counts, total_counts, 2,
+                             sc_MPI_LONG_LONG_INT, sc_MPI_SUM,
+                             forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  element_offset = scan_counts[0] - local_counts[0];
+  point_offset = scan_counts[1] - local_counts[1];
+
+  /* The coordinates are generated in double precision and may be
+   * reduced to single precision before writing,
+   * \see t8_forest_set_coordinate_precision */
+  coord_reduced = forest->coord_precision != T8_COORD_PRECISION_FLOAT64;
+  coord_size = coord_reduced ? sizeof (float) : sizeof (double);
+
+  /* Set up the data arrays. The first four are always written. */
+  memset (arrays, 0, sizeof (arrays));
+  arrays[0].name = "Position";
+  arrays[0].datatype = coord_reduced ? "Float32" : "Float64";
+  arrays[0].num_components = 3;
+  arrays[0].local_byte_count = 3 * coord_size * num_points;
+  arrays[0].local_byte_offset = 3 * coord_size * point_offset;
+  arrays[0].global_byte_count = 3 * coord_size * total_counts[1];
+  arrays[1].name = "connectivity";
+  arrays[1].datatype = "Int64";
+  arrays[1].num_components = 1;
+  arrays[1].local_byte_count = sizeof (long long) * num_points;
+  arrays[1].local_byte_offset = sizeof (long long) * point_offset;
+  arrays[1].global_byte_count = sizeof (long long) * total_counts[1];
+  arrays[2].name = "offsets";
+  arrays[2].datatype = "Int64";
+  arrays[2].num_components = 1;
+  arrays[2].local_byte_count = sizeof (long long) * num_elements;
+  arrays[2].local_byte_offset = sizeof (long long) * element_offset;
+  arrays[2].global_byte_count = sizeof (long long) * total_counts[0];
+  arrays[3].name = "types";
+  arrays[3].datatype = "Int32";
+  arrays[3].num_components = 1;
+  arrays[3].local_byte_count = sizeof (int32_t) * num_elements;
+  arrays[3].local_byte_offset = sizeof (int32_t) * element_offset;
+  arrays[3].global_byte_count = sizeof (int32_t) * total_counts[0];
+  num_arrays = 4;
+  if (write_treeid) {
+    arrays[num_arrays].name = "treeid";
+    arrays[num_arrays].datatype = "Int64";
+    arrays[num_arrays].num_components = 1;
+    arrays[num_arrays].local_byte_count = sizeof (long long) * num_elements;
+    arrays[num_arrays].local_byte_offset =
+      sizeof (long long) * element_offset;
+    arrays[num_arrays].global_byte_count =
+      sizeof (long long) * total_counts[0];
+    num_arrays++;
+  }
+  if (write_mpirank) {
+    arrays[num_arrays].name = "mpirank";
+    arrays[num_arrays].datatype = "Int32";
+    arrays[num_arrays].num_components = 1;
+    arrays[num_arrays].local_byte_count = sizeof (int32_t) * num_elements;
+    arrays[num_arrays].local_byte_offset = sizeof (int32_t) * element_offset;
+    arrays[num_arrays].global_byte_count = sizeof (int32_t) * total_counts[0];
+    num_arrays++;
+  }
+  if (write_level) {
+    arrays[num_arrays].name = "level";
+    arrays[num_arrays].datatype = "Int32";
+    arrays[num_arrays].num_components = 1;
+    arrays[num_arrays].local_byte_count = sizeof (int32_t) * num_elements;
+    arrays[num_arrays].local_byte_offset = sizeof (int32_t) * element_offset;
+    arrays[num_arrays].global_byte_count = sizeof (int32_t) * total_counts[0];
+    num_arrays++;
+  }
+  if (write_element_id) {
+    arrays[num_arrays].name = "element_id";
+    arrays[num_arrays].datatype = "Int64";
+    arrays[num_arrays].num_components = 1;
+    arrays[num_arrays].local_byte_count = sizeof (long long) * num_elements;
+    arrays[num_arrays].local_byte_offset =
+      sizeof (long long) * element_offset;
+    arrays[num_arrays].global_byte_count =
+      sizeof (long long) * total_counts[0];
+    num_arrays++;
+  }
+  num_fixed_arrays = num_arrays;
+  for (idata = 0; idata < num_data; idata++, num_arrays++) {
+    const int           ncomp = data[idata].type == T8_VTK_SCALAR ? 1 : 3;
+
+    T8_ASSERT (data[idata].type == T8_VTK_SCALAR
+               || data[idata].type == T8_VTK_VECTOR);
+    arrays[num_arrays].name = data[idata].description;
+    arrays[num_arrays].datatype = "Float64";
+    arrays[num_arrays].num_components = ncomp;
+    /* The user data is already laid out contiguously over the local
+     * elements, so we can write it without copying. */
+    arrays[num_arrays].local_bytes = (char *) data[idata].data;
+    arrays[num_arrays].owns_bytes = 0;
+    arrays[num_arrays].local_byte_count =
+      ncomp * sizeof (double) * num_elements;
+    arrays[num_arrays].local_byte_offset =
+      ncomp * sizeof (double) * element_offset;
+    arrays[num_arrays].global_byte_count =
+      ncomp * sizeof (double) * total_counts[0];
+  }
+
+  /* Compute the block offsets inside the appended data section and
+   * allocate the payload buffers */
+  appended_bytes = 0;
+  for (iarray = 0; iarray < num_arrays; iarray++) {
+    arrays[iarray].appended_offset = appended_bytes;
+    appended_bytes += (long long) sizeof (uint64_t)
+      + arrays[iarray].global_byte_count;
+    if (arrays[iarray].local_bytes == NULL) {
+      arrays[iarray].local_bytes =
+        T8_ALLOC (char, arrays[iarray].local_byte_count);
+      arrays[iarray].owns_bytes = 1;
+    }
+  }
+  if (coord_reduced) {
+    /* Generate the coordinates into a full precision staging buffer and
+     * reduce them into the output buffer afterwards */
+    coord_final = arrays[0].local_bytes;
+    coords_full = T8_ALLOC (double, 3 * (size_t) num_points);
+    arrays[0].local_bytes = (char *) coords_full;
+  }
+  t8_forest_vtk_fill_binary_arrays (forest, arrays, num_fixed_arrays,
+                                    point_offset, element_offset);
+  if (coord_reduced) {
+    t8_forest_vtk_reduce_coordinates (forest, coords_full,
+                                      (float *) coord_final,
+                                      3 * (long long) num_points);
+    T8_FREE (coords_full);
+    arrays[0].local_bytes = coord_final;
+  }
+
+  /* Generate the xml header. Its length is needed on all processes to
+   * compute the file offsets, the content only on process 0. The offset
+   * attributes are relative to the appended data section, so they do
+   * not depend on the header length itself. */
+  header_size = BUFSIZ + num_arrays * BUFSIZ;
+  header = T8_ALLOC (char, header_size);
+#ifdef SC_IS_BIGENDIAN
+  const char         *byte_order = "BigEndian";
+#else
+  const char         *byte_order = "LittleEndian";
+#endif
+  header_used = snprintf (header, header_size,
+                          "<?xml version=\"1.0\"?>\n"
+                          "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\""
+                          " byte_order=\"%s\" header_type=\"UInt64\">\n"
+                          "  <UnstructuredGrid>\n"
+                          "    <Piece NumberOfPoints=\"%lld\""
+                          " NumberOfCells=\"%lld\">\n",
+                          byte_order, total_counts[1], total_counts[0]);
+  for (iarray = 0; iarray < num_arrays; iarray++) {
+    if (iarray == 0) {
+      header_used += snprintf (header + header_used,
+                               header_size - header_used, "      <Points>\n");
+    }
+    else if (iarray == 1) {
+      header_used += snprintf (header + header_used,
+                               header_size - header_used,
+                               "      </Points>\n      <Cells>\n");
+    }
+    else if (iarray == 4) {
+      header_used += snprintf (header + header_used,
+                               header_size - header_used,
+                               "      </Cells>\n      <CellData>\n");
+    }
+    if (arrays[iarray].num_components > 1) {
+      retval = snprintf (dataarray, BUFSIZ,
+                         "        <DataArray type=\"%s\" Name=\"%s\""
+                         " NumberOfComponents=\"%i\" format=\"appended\""
+                         " offset=\"%lld\"/>\n",
+                         arrays[iarray].datatype, arrays[iarray].name,
+                         arrays[iarray].num_components,
+                         arrays[iarray].appended_offset);
+    }
+    else {
+      retval = snprintf (dataarray, BUFSIZ,
+                         "        <DataArray type=\"%s\" Name=\"%s\""
+                         " format=\"appended\" offset=\"%lld\"/>\n",
+                         arrays[iarray].datatype, arrays[iarray].name,
+                         arrays[iarray].appended_offset);
+    }
+    if (retval >= BUFSIZ) {
+      t8_errorf ("Error when writing vtu file. Data name too long.\n");
+      goto t8_forest_vtk_binary_failure;
+    }
+    header_used += snprintf (header + header_used,
+                             header_size - header_used, "%s", dataarray);
+  }
+  header_used += snprintf (header + header_used, header_size - header_used,
+                           "%s"
+                           "    </Piece>\n"
+                           "  </UnstructuredGrid>\n"
+                           "  <AppendedData encoding=\"raw\">\n   _",
+                           num_arrays > 4 ? "      </CellData>\n"
+                           : "      </Cells>\n");
+  if (header_used >= header_size) {
+    t8_errorf ("Error when writing vtu file. Header too long.\n");
+    goto t8_forest_vtk_binary_failure;
+  }
+  header_bytes = (long long) header_used;
+  /* All processes must agree on the header length */
+  mpiret = sc_MPI_Bcast (&header_bytes, 1, sc_MPI_LONG_LONG_INT, 0,
+                         forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  total_bytes = header_bytes + appended_bytes + (long long) strlen (tail);
+
+#ifdef T8_ENABLE_MPIIO
+  retval = t8_forest_vtk_write_binary_file_mpiio (forest->mpicomm,
+                                                  forest->mpirank,
+                                                  vtufilename, header,
+                                                  header_bytes, tail, arrays,
+                                                  num_arrays, total_bytes);
+#else
+  retval = t8_forest_vtk_write_binary_file_serial (forest->mpicomm,
+                                                   forest->mpirank,
+                                                   forest->mpisize,
+                                                   vtufilename, header,
+                                                   header_bytes, tail, arrays,
+                                                   num_arrays, total_bytes);
+#endif
+  if (!retval) {
+    goto t8_forest_vtk_binary_failure;
+  }
+
+  /* clean up */
+  T8_FREE (header);
+  for (iarray = 0; iarray < num_arrays; iarray++) {
+    if (arrays[iarray].owns_bytes) {
+      T8_FREE (arrays[iarray].local_bytes);
+    }
+  }
+  return 1;
+t8_forest_vtk_binary_failure:
+  T8_FREE (header);
+  for (iarray = 0; iarray < num_arrays; iarray++) {
+    if (arrays[iarray].owns_bytes) {
+      T8_FREE (arrays[iarray].local_bytes);
+    }
+  }
+  t8_errorf ("Error when writing binary vtk file.\n");
+  return 0;
+}
+
+/* Burst buffer staging for the per process .vtu files. If a staging
+ * directory is set, t8_forest_vtk_write_file writes the .vtu file of
+ * this rank there - typically node local NVMe - and a background
+ * drainer copies it to the final path afterwards, so the caller does
+ * not wait on the parallel file system during dump storms. The final
+ * file is moved into place atomically, hence readers that find it see
+ * a complete file. */
+static char        *t8_forest_vtk_staging_dir = NULL;
+
+/* A pending drain: copy the staged file src to the final path dst */
+typedef struct t8_forest_vtk_staging_job
+{
+  char               *src;      /**< The staged file. Owned. */
+  char               *dst;      /**< The final path. Owned. */
+  struct t8_forest_vtk_staging_job *next;
+} t8_forest_vtk_staging_job_t;
+
+#if defined (SC_ENABLE_PTHREAD)
+static pthread_mutex_t t8_forest_vtk_staging_mutex =
+  PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t t8_forest_vtk_staging_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t t8_forest_vtk_staging_idle = PTHREAD_COND_INITIALIZER;
+static pthread_t    t8_forest_vtk_staging_thread;
+static int          t8_forest_vtk_staging_running = 0;
+static int          t8_forest_vtk_staging_shutdown = 0;
+static t8_forest_vtk_staging_job_t *t8_forest_vtk_staging_first = NULL;
+static t8_forest_vtk_staging_job_t *t8_forest_vtk_staging_last = NULL;
+static int          t8_forest_vtk_staging_pending = 0;
+#endif
+
+/* Copy a staged file to its final path and remove the staged copy.
+ * The final file is written under a temporary name and moved into
+ * place with rename, since the staging directory usually lies on a
+ * different (node local) file system and rename of the staged file
+ * itself would fail across file systems. */
+static int
+t8_forest_vtk_staging_drain_job (const char *src, const char *dst)
+{
+  char                tmpname[BUFSIZ];
+  char               *buffer;
+  FILE               *in, *out;
+  size_t              nread;
+  int                 failed = 0;
+
+  if (snprintf (tmpname, BUFSIZ, "%s.staging", dst) >= BUFSIZ) {
+    t8_errorf ("Error when draining staged file. Filename too long.\n");
+    return 0;
+  }
+  in = fopen (src, "rb");
+  if (in == NULL) {
+    t8_errorf ("Error when opening staged file %s\n", src);
+    return 0;
+  }
+  out = fopen (tmpname, "wb");
+  if (out == NULL) {
+    t8_errorf ("Error when opening file %s\n", tmpname);
+    fclose (in);
+    return 0;
+  }
+  buffer = T8_ALLOC (char, 1 << 16);
+  while ((nread = fread (buffer, 1, 1 << 16, in)) > 0) {
+    if (fwrite (buffer, 1, nread, out) != nread) {
+      failed = 1;
+      break;
+    }
+  }
+  failed = failed || ferror (in);
+  T8_FREE (buffer);
+  fclose (in);
+  failed = fclose (out) != 0 || failed;
+  if (!failed) {
+    failed = rename (tmpname, dst) != 0;
+  }
+  if (failed) {
+    t8_errorf ("Error when draining staged file %s to %s\n", src, dst);
+    remove (tmpname);
+    return 0;
+  }
+  remove (src);
+  return 1;
+}
+
+#if defined (SC_ENABLE_PTHREAD)
+/* The drainer thread. It moves pending staged files to their final
+ * paths one by one and sleeps when the queue is empty. */
+static void        *
+t8_forest_vtk_staging_run (void *arg)
+{
+  t8_forest_vtk_staging_job_t *job;
+
+  pthread_mutex_lock (&t8_forest_vtk_staging_mutex);
+  for (;;) {
+    while (t8_forest_vtk_staging_first == NULL
+           && !t8_forest_vtk_staging_shutdown) {
+      pthread_cond_wait (&t8_forest_vtk_staging_cond,
+                         &t8_forest_vtk_staging_mutex);
+    }
+    if (t8_forest_vtk_staging_first == NULL) {
+      /* Shutdown was requested and the queue is drained */
+      break;
+    }
+    job = t8_forest_vtk_staging_first;
+    t8_forest_vtk_staging_first = job->next;
+    if (t8_forest_vtk_staging_first == NULL) {
+      t8_forest_vtk_staging_last = NULL;
+    }
+    /* Perform the copy outside of the lock */
+    pthread_mutex_unlock (&t8_forest_vtk_staging_mutex);
+    (void) t8_forest_vtk_staging_drain_job (job->src, job->dst);
+    T8_FREE (job->src);
+    T8_FREE (job->dst);
+    T8_FREE (job);
+    pthread_mutex_lock (&t8_forest_vtk_staging_mutex);
+    if (--t8_forest_vtk_staging_pending == 0) {
+      pthread_cond_broadcast (&t8_forest_vtk_staging_idle);
+    }
+  }
+  pthread_mutex_unlock (&t8_forest_vtk_staging_mutex);
+  return NULL;
+}
+#endif
+
+/* Hand a written staged file over to the drainer. Without pthread
+ * support the file is drained synchronously. */
+static void
+t8_forest_vtk_staging_enqueue (const char *src, const char *dst)
+{
+#if defined (SC_ENABLE_PTHREAD)
+  t8_forest_vtk_staging_job_t *job;
+
+  job = T8_ALLOC (t8_forest_vtk_staging_job_t, 1);
+  job->src = T8_ALLOC (char, strlen (src) + 1);
+  strcpy (job->src, src);
+  job->dst = T8_ALLOC (char, strlen (dst) + 1);
+  strcpy (job->dst, dst);
+  job->next = NULL;
+  pthread_mutex_lock (&t8_forest_vtk_staging_mutex);
+  if (t8_forest_vtk_staging_last != NULL) {
+    t8_forest_vtk_staging_last->next = job;
+  }
+  else {
+    t8_forest_vtk_staging_first = job;
+  }
+  t8_forest_vtk_staging_last = job;
+  t8_forest_vtk_staging_pending++;
+  if (!t8_forest_vtk_staging_running) {
+    SC_CHECK_ABORT (pthread_create
+                    (&t8_forest_vtk_staging_thread, NULL,
+                     t8_forest_vtk_staging_run, NULL) == 0,
+                    "Could not create the vtk staging drainer thread.\n");
+    t8_forest_vtk_staging_running = 1;
+  }
+  pthread_cond_signal (&t8_forest_vtk_staging_cond);
+  pthread_mutex_unlock (&t8_forest_vtk_staging_mutex);
+#else
+  (void) t8_forest_vtk_staging_drain_job (src, dst);
+#endif
+}
+
+void
+t8_forest_vtk_staging_flush (void)
+{
+#if defined (SC_ENABLE_PTHREAD)
+  pthread_mutex_lock (&t8_forest_vtk_staging_mutex);
+  while (t8_forest_vtk_staging_pending > 0) {
+    pthread_cond_wait (&t8_forest_vtk_staging_idle,
+                       &t8_forest_vtk_staging_mutex);
+  }
+  pthread_mutex_unlock (&t8_forest_vtk_staging_mutex);
+#endif
+  /* Without pthread support staged files are drained synchronously and
+   * there is never a pending job */
+}
+
+void
+t8_forest_vtk_staging_finalize (void)
+{
+  t8_forest_vtk_staging_flush ();
+#if defined (SC_ENABLE_PTHREAD)
+  pthread_mutex_lock (&t8_forest_vtk_staging_mutex);
+  if (t8_forest_vtk_staging_running) {
+    t8_forest_vtk_staging_shutdown = 1;
+    pthread_cond_signal (&t8_forest_vtk_staging_cond);
+    pthread_mutex_unlock (&t8_forest_vtk_staging_mutex);
+    pthread_join (t8_forest_vtk_staging_thread, NULL);
+    pthread_mutex_lock (&t8_forest_vtk_staging_mutex);
+    t8_forest_vtk_staging_running = 0;
+    t8_forest_vtk_staging_shutdown = 0;
+  }
+  pthread_mutex_unlock (&t8_forest_vtk_staging_mutex);
+#endif
+  T8_FREE (t8_forest_vtk_staging_dir);
+  t8_forest_vtk_staging_dir = NULL;
+}
+
+void
+t8_forest_vtk_set_staging_dir (const char *staging_dir)
+{
+  /* Pending jobs own their full paths, so the directory may be
+   * replaced while drains are in flight */
+  T8_FREE (t8_forest_vtk_staging_dir);
+  t8_forest_vtk_staging_dir = NULL;
+  if (staging_dir != NULL) {
+    t8_forest_vtk_staging_dir = T8_ALLOC (char, strlen (staging_dir) + 1);
+    strcpy (t8_forest_vtk_staging_dir, staging_dir);
+  }
+}
+
+int
+t8_forest_vtk_write_file (t8_forest_t forest, const char *fileprefix,
+                          const int write_treeid,
+                          const int write_mpirank,
+                          const int write_level, const int write_element_id,
+                          int write_ghosts,
+                          const int num_data, t8_vtk_data_field_t *data)
+{
+  FILE               *vtufile = NULL;
+  t8_locidx_t         num_elements, num_points;
+  char                vtufilename[BUFSIZ];
+  char                stagedname[BUFSIZ];
+  const char         *writename;
+  const char         *basename;
+  int                 staged = 0;
+  int                 freturn;
+
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (fileprefix != NULL);
+  if (forest->ghosts == NULL || forest->ghosts->num_ghosts_elements == 0) {
+    /* Never write ghost elements if there aren't any */
+    write_ghosts = 0;
+  }
+  T8_ASSERT (forest->ghosts != NULL || !write_ghosts);
+
+  /* Currently we only support output in ascii format, not binary */
+  T8_ASSERT (T8_VTK_ASCII == 1);
+
+  /* process 0 creates the .pvtu file */
+  if (forest->mpirank == 0) {
+    if (t8_write_pvtu
+        (fileprefix, forest->mpisize, write_treeid, write_mpirank,
+         write_level, write_element_id, num_data, data)) {
+      t8_errorf ("Error when writing file %s.pvtu\n", fileprefix);
+      goto t8_forest_vtk_failure;
+    }
+  }
+
+  /* The local number of elements */
+  num_elements = t8_forest_get_local_num_elements (forest);
+  if (write_ghosts) {
+    num_elements += t8_forest_get_num_ghosts (forest);
+  }
+  /* The local number of points, counted with multiplicity */
+  num_points = t8_forest_num_points (forest, write_ghosts);
 
   /* The filename for this processes file */
   freturn =
@@ -1566,11 +2908,27 @@ t8_forest_vtk_write_file (t8_forest_t forest, const char *fileprefix,
     t8_errorf ("Error when writing vtu file. Filename too long.\n");
     goto t8_forest_vtk_failure;
   }
+  writename = vtufilename;
+  if (t8_forest_vtk_staging_dir != NULL) {
+    /* Staging is active. Write the file into the staging directory and
+     * let the background drainer move it to its final path. */
+    basename = strrchr (vtufilename, '/');
+    basename = basename == NULL ? vtufilename : basename + 1;
+    freturn =
+      snprintf (stagedname, BUFSIZ, "%s/%s", t8_forest_vtk_staging_dir,
+                basename);
+    if (freturn >= BUFSIZ) {
+      t8_errorf ("Error when writing vtu file. Filename too long.\n");
+      goto t8_forest_vtk_failure;
+    }
+    writename = stagedname;
+    staged = 1;
+  }
 
   /* Open the vtufile to write to */
-  vtufile = fopen (vtufilename, "w");
+  vtufile = fopen (writename, "w");
   if (vtufile == NULL) {
-    t8_errorf ("Error when opening file %s\n", vtufilename);
+    t8_errorf ("Error when opening file %s\n", writename);
     goto t8_forest_vtk_failure;
   }
   /* Write the header information in the .vtu file.
@@ -1629,9 +2987,14 @@ t8_forest_vtk_write_file (t8_forest_t forest, const char *fileprefix,
   if (freturn != 0) {
     /* Closing failed, this usually means that the final write operation could
      * not be completed. */
-    t8_global_errorf ("Error when closing file %s\n", vtufilename);
+    t8_global_errorf ("Error when closing file %s\n", writename);
     goto t8_forest_vtk_failure;
   }
+  if (staged) {
+    /* Hand the staged file over to the drainer, which copies it to the
+     * final path in the background */
+    t8_forest_vtk_staging_enqueue (stagedname, vtufilename);
+  }
   /* Writing was successful */
   return 1;
 t8_forest_vtk_failure:
@@ -1642,4 +3005,686 @@ t8_forest_vtk_failure:
   return 0;
 }
 
+/* Execute a cell data kernel once per output cell of a decimation plan
+ * and wrap the output in a DataArray, analogous to
+ * t8_forest_vtk_write_cell_data. The kernel receives the output element
+ * of each cell together with the tree local index of the cell's first
+ * member element, so the standard kernels above render the decimated
+ * mesh without modification; in particular the element id kernel
+ * reports the global id of the first member. Ghosts are never written. */
+static int
+t8_forest_vtk_write_cell_data_plan (t8_forest_t forest, FILE *vtufile,
+                                    const char *dataname,
+                                    const char *datatype,
+                                    const char *component_string,
+                                    const int max_columns,
+                                    t8_forest_vtk_cell_data_kernel kernel,
+                                    t8_forest_decimation_plan_t *plan,
+                                    void *udata)
+{
+  int                 freturn;
+  int                 countcols;
+  t8_locidx_t         icell;
+  const t8_locidx_t   num_cells = t8_forest_decimation_plan_num_cells (plan);
+  void               *data = NULL;
+
+  freturn = fprintf (vtufile, "        <DataArray type=\"%s\" "
+                     "Name=\"%s\" %s format=\"ascii\">\n         ",
+                     datatype, dataname, component_string);
+  if (freturn <= 0) {
+    return 0;
+  }
+  /* if udata != NULL, use it as the data pointer, in this case, the kernel
+   * should not modify it */
+  if (udata != NULL) {
+    data = udata;
+  }
+  kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, &data,
+          T8_VTK_KERNEL_INIT);
+  countcols = 0;
+  for (icell = 0; icell < num_cells; icell++) {
+    const t8_forest_decimation_cell_t *cell =
+      t8_forest_decimation_plan_get_cell (plan, icell);
+    const t8_tree_t     tree = t8_forest_get_tree (forest, cell->ltreeid);
+    t8_eclass_scheme_c *ts =
+      t8_forest_get_eclass_scheme (forest, tree->eclass);
+    const t8_element_t *element =
+      t8_forest_decimation_cell_element (plan, cell);
+
+    if (!kernel (forest, cell->ltreeid, tree, cell->first, element, ts, 0,
+                 vtufile, &countcols, &data, T8_VTK_KERNEL_EXECUTE)) {
+      kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, &data,
+              T8_VTK_KERNEL_CLEANUP);
+      return 0;
+    }
+    /* After max_columns we break the line */
+    if (!(countcols % max_columns)) {
+      freturn = fprintf (vtufile, "\n         ");
+      if (freturn <= 0) {
+        kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, &data,
+                T8_VTK_KERNEL_CLEANUP);
+        return 0;
+      }
+    }
+  }
+  kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, &data,
+          T8_VTK_KERNEL_CLEANUP);
+  freturn = fprintf (vtufile, "\n        </DataArray>\n");
+  if (freturn <= 0) {
+    return 0;
+  }
+  return 1;
+}
+
+/* User data of the decimated field kernels below. The plan driver
+ * executes the kernels in plan order, so the kernels track the current
+ * output cell with a running counter. */
+typedef struct
+{
+  t8_forest_decimation_plan_t *plan;    /* The plan of this write. */
+  const double       *values;   /* The full resolution field data. */
+  t8_forest_reduce_fn reduce_fn;        /* The reduction, NULL for the mean. */
+  void               *reduce_user_data; /* Passed to reduce_fn. */
+  t8_locidx_t         icell;    /* The current output cell. */
+  int                 per_vertex;       /* Repeat the value per element corner. */
+} t8_forest_vtk_reduce_data_t;
+
+/* Decimating version of the scalar kernel. The values of the member
+ * elements of each output cell are reduced to a single value. */
+static int
+t8_forest_vtk_cells_reduce_scalar_kernel (t8_forest_t forest,
+                                          const t8_locidx_t ltree_id,
+                                          const t8_tree_t tree,
+                                          const t8_locidx_t element_index,
+                                          const t8_element_t *element,
+                                          t8_eclass_scheme_c *ts,
+                                          const int is_ghost, FILE *vtufile,
+                                          int *columns, void **data,
+                                          T8_VTK_KERNEL_MODUS modus)
+{
+  t8_forest_vtk_reduce_data_t *rd;
+  double              value;
+  int                 irepeat, repeat;
+
+  if (modus != T8_VTK_KERNEL_EXECUTE) {
+    return 1;
+  }
+  rd = (t8_forest_vtk_reduce_data_t *) *data;
+  value = t8_forest_decimation_reduce_cell (rd->plan, rd->icell, rd->values,
+                                            1, 0, rd->reduce_fn,
+                                            rd->reduce_user_data);
+  repeat = rd->per_vertex ? ts->t8_element_num_corners (element) : 1;
+  for (irepeat = 0; irepeat < repeat; irepeat++) {
+    fprintf (vtufile, "%g ", value);
+    *columns += 1;
+  }
+  rd->icell++;
+  return 1;
+}
+
+/* Decimating version of the vector kernel. */
+static int
+t8_forest_vtk_cells_reduce_vector_kernel (t8_forest_t forest,
+                                          const t8_locidx_t ltree_id,
+                                          const t8_tree_t tree,
+                                          const t8_locidx_t element_index,
+                                          const t8_element_t *element,
+                                          t8_eclass_scheme_c *ts,
+                                          const int is_ghost, FILE *vtufile,
+                                          int *columns, void **data,
+                                          T8_VTK_KERNEL_MODUS modus)
+{
+  t8_forest_vtk_reduce_data_t *rd;
+  double              vec[3];
+  int                 irepeat, repeat, idim;
+
+  if (modus != T8_VTK_KERNEL_EXECUTE) {
+    return 1;
+  }
+  rd = (t8_forest_vtk_reduce_data_t *) *data;
+  for (idim = 0; idim < 3; idim++) {
+    vec[idim] =
+      t8_forest_decimation_reduce_cell (rd->plan, rd->icell, rd->values, 3,
+                                        idim, rd->reduce_fn,
+                                        rd->reduce_user_data);
+  }
+  repeat = rd->per_vertex ? ts->t8_element_num_corners (element) : 1;
+  for (irepeat = 0; irepeat < repeat; irepeat++) {
+    for (idim = 0; idim < 3; idim++) {
+      fprintf (vtufile, "%g ", vec[idim]);
+    }
+    *columns += 3;
+  }
+  rd->icell++;
+  return 1;
+}
+
+/* Plan analogue of t8_forest_vtk_write_points. The point data copies of
+ * the user defined fields repeat the reduced cell value for each corner
+ * of the output cell. */
+static int
+t8_forest_vtk_write_points_plan (t8_forest_t forest, FILE *vtufile,
+                                 t8_forest_decimation_plan_t *plan,
+                                 t8_forest_reduce_fn reduce_fn,
+                                 void *reduce_user_data,
+                                 const int num_data,
+                                 t8_vtk_data_field_t *data)
+{
+  t8_forest_vtk_coord_precision_t precision;
+  t8_forest_vtk_reduce_data_t reduce_data;
+  const char         *position_type;
+  int                 freturn;
+  int                 sreturn;
+  int                 idata;
+  char                description[BUFSIZ];
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (vtufile != NULL);
+
+  /* Select the coordinate precision of this write,
+   * \see t8_forest_set_coordinate_precision */
+  precision.precision = forest->coord_precision;
+  position_type = T8_VTK_FLOAT_NAME;
+  if (forest->coord_precision != T8_COORD_PRECISION_FLOAT64) {
+    position_type = "Float32";
+    if (forest->coord_precision == T8_COORD_PRECISION_QUANTIZED) {
+      /* Compute the quantization grid. This is a collective call, all
+       * processes enter the writer. */
+      t8_forest_coordinate_quantization_grid (forest, precision.box_min,
+                                              precision.step);
+    }
+  }
+
+  freturn = fprintf (vtufile, "      <Points>\n");
+  if (freturn <= 0) {
+    goto t8_forest_vtk_cell_failure;
+  }
+  freturn = t8_forest_vtk_write_cell_data_plan (forest, vtufile, "Position",
+                                                position_type,
+                                                "NumberOfComponents=\"3\"",
+                                                8,
+                                                t8_forest_vtk_cells_vertices_kernel,
+                                                plan, &precision);
+  if (!freturn) {
+    goto t8_forest_vtk_cell_failure;
+  }
+  freturn = fprintf (vtufile, "      </Points>\n");
+  if (freturn <= 0) {
+    goto t8_forest_vtk_cell_failure;
+  }
+
+  /* Write the user defined data fields per point */
+  if (num_data > 0) {
+    freturn = fprintf (vtufile, "      <PointData>\n");
+    for (idata = 0; idata < num_data; idata++) {
+      reduce_data.plan = plan;
+      reduce_data.values = data[idata].data;
+      reduce_data.reduce_fn = reduce_fn;
+      reduce_data.reduce_user_data = reduce_user_data;
+      reduce_data.icell = 0;
+      reduce_data.per_vertex = 1;
+      /* Write the description string. */
+      sreturn =
+        snprintf (description, BUFSIZ, "%s_%s", data[idata].description,
+                  "points");
+      if (sreturn >= BUFSIZ) {
+        /* The output was truncated */
+        t8_debugf ("Warning: Truncated vtk point data description to '%s'\n",
+                   description);
+      }
+      if (data[idata].type == T8_VTK_SCALAR) {
+        freturn =
+          t8_forest_vtk_write_cell_data_plan (forest, vtufile, description,
+                                              T8_VTK_FLOAT_NAME, "", 8,
+                                              t8_forest_vtk_cells_reduce_scalar_kernel,
+                                              plan, &reduce_data);
+      }
+      else {
+        char                component_string[BUFSIZ];
+        T8_ASSERT (data[idata].type == T8_VTK_VECTOR);
+        snprintf (component_string, BUFSIZ, "NumberOfComponents=\"3\"");
+        freturn =
+          t8_forest_vtk_write_cell_data_plan (forest, vtufile, description,
+                                              T8_VTK_FLOAT_NAME,
+                                              component_string,
+                                              8 * forest->dimension,
+                                              t8_forest_vtk_cells_reduce_vector_kernel,
+                                              plan, &reduce_data);
+      }
+      if (!freturn) {
+        goto t8_forest_vtk_cell_failure;
+      }
+    }
+    freturn = fprintf (vtufile, "      </PointData>\n");
+    if (freturn <= 0) {
+      goto t8_forest_vtk_cell_failure;
+    }
+  }
+  return 1;
+t8_forest_vtk_cell_failure:
+  t8_errorf ("Error when writing points to decimated forest vtk file.\n");
+  return 0;
+}
+
+/* Plan analogue of t8_forest_vtk_write_cells. */
+static int
+t8_forest_vtk_write_cells_plan (t8_forest_t forest, FILE *vtufile,
+                                const int write_treeid,
+                                const int write_mpirank,
+                                const int write_level,
+                                const int write_element_id,
+                                t8_forest_decimation_plan_t *plan,
+                                t8_forest_reduce_fn reduce_fn,
+                                void *reduce_user_data,
+                                const int num_data,
+                                t8_vtk_data_field_t *data)
+{
+  t8_forest_vtk_reduce_data_t reduce_data;
+  int                 freturn;
+  int                 idata;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (vtufile != NULL);
+
+  freturn = fprintf (vtufile, "      <Cells>\n");
+  if (freturn <= 0) {
+    goto t8_forest_vtk_cell_failure;
+  }
+  freturn =
+    t8_forest_vtk_write_cell_data_plan (forest, vtufile, "connectivity",
+                                        T8_VTK_LOCIDX, "", 8,
+                                        t8_forest_vtk_cells_connectivity_kernel,
+                                        plan, NULL);
+  if (!freturn) {
+    goto t8_forest_vtk_cell_failure;
+  }
+  freturn = t8_forest_vtk_write_cell_data_plan (forest, vtufile, "offsets",
+                                                T8_VTK_LOCIDX, "", 8,
+                                                t8_forest_vtk_cells_offset_kernel,
+                                                plan, NULL);
+  if (!freturn) {
+    goto t8_forest_vtk_cell_failure;
+  }
+  freturn = t8_forest_vtk_write_cell_data_plan (forest, vtufile, "types",
+                                                "Int32", "", 8,
+                                                t8_forest_vtk_cells_type_kernel,
+                                                plan, NULL);
+  if (!freturn) {
+    goto t8_forest_vtk_cell_failure;
+  }
+  freturn = fprintf (vtufile, "      </Cells>\n");
+  if (freturn <= 0) {
+    goto t8_forest_vtk_cell_failure;
+  }
+
+  freturn = fprintf (vtufile, "      <CellData Scalars =\"%s%s\">\n",
+                     "treeid,mpirank,level", (write_element_id ? "id" : ""));
+  if (freturn <= 0) {
+    goto t8_forest_vtk_cell_failure;
+  }
+
+  if (write_treeid) {
+    freturn = t8_forest_vtk_write_cell_data_plan (forest, vtufile, "treeid",
+                                                  T8_VTK_GLOIDX, "", 8,
+                                                  t8_forest_vtk_cells_treeid_kernel,
+                                                  plan, NULL);
+    if (!freturn) {
+      goto t8_forest_vtk_cell_failure;
+    }
+  }
+  if (write_mpirank) {
+    freturn = t8_forest_vtk_write_cell_data_plan (forest, vtufile, "mpirank",
+                                                  "Int32", "", 8,
+                                                  t8_forest_vtk_cells_rank_kernel,
+                                                  plan, NULL);
+    if (!freturn) {
+      goto t8_forest_vtk_cell_failure;
+    }
+  }
+  if (write_level) {
+    freturn = t8_forest_vtk_write_cell_data_plan (forest, vtufile, "level",
+                                                  "Int32", "", 8,
+                                                  t8_forest_vtk_cells_level_kernel,
+                                                  plan, NULL);
+    if (!freturn) {
+      goto t8_forest_vtk_cell_failure;
+    }
+  }
+  if (write_element_id) {
+    const char         *datatype;
+
+    /* Use 32 bit ints if the global element count fits, 64 bit otherwise. */
+    datatype = forest->global_num_elements > T8_LOCIDX_MAX ? T8_VTK_GLOIDX :
+      T8_VTK_LOCIDX;
+    freturn =
+      t8_forest_vtk_write_cell_data_plan (forest, vtufile, "element_id",
+                                          datatype, "", 8,
+                                          t8_forest_vtk_cells_elementid_kernel,
+                                          plan, NULL);
+    if (!freturn) {
+      goto t8_forest_vtk_cell_failure;
+    }
+  }
+  /* Write the user defined data fields per output cell */
+  for (idata = 0; idata < num_data; idata++) {
+    reduce_data.plan = plan;
+    reduce_data.values = data[idata].data;
+    reduce_data.reduce_fn = reduce_fn;
+    reduce_data.reduce_user_data = reduce_user_data;
+    reduce_data.icell = 0;
+    reduce_data.per_vertex = 0;
+    if (data[idata].type == T8_VTK_SCALAR) {
+      freturn =
+        t8_forest_vtk_write_cell_data_plan (forest, vtufile,
+                                            data[idata].description,
+                                            T8_VTK_FLOAT_NAME, "", 8,
+                                            t8_forest_vtk_cells_reduce_scalar_kernel,
+                                            plan, &reduce_data);
+    }
+    else {
+      char                component_string[BUFSIZ];
+      T8_ASSERT (data[idata].type == T8_VTK_VECTOR);
+      snprintf (component_string, BUFSIZ, "NumberOfComponents=\"3\"");
+      freturn =
+        t8_forest_vtk_write_cell_data_plan (forest, vtufile,
+                                            data[idata].description,
+                                            T8_VTK_FLOAT_NAME,
+                                            component_string,
+                                            8 * forest->dimension,
+                                            t8_forest_vtk_cells_reduce_vector_kernel,
+                                            plan, &reduce_data);
+    }
+    if (!freturn) {
+      goto t8_forest_vtk_cell_failure;
+    }
+  }
+
+  freturn = fprintf (vtufile, "      </CellData>\n");
+  if (freturn <= 0) {
+    goto t8_forest_vtk_cell_failure;
+  }
+  return 1;
+t8_forest_vtk_cell_failure:
+  t8_errorf ("Error when writing cell data to decimated forest vtk file.\n");
+  return 0;
+}
+
+int
+t8_forest_vtk_write_file_decimated (t8_forest_t forest,
+                                    const char *fileprefix,
+                                    const int write_treeid,
+                                    const int write_mpirank,
+                                    const int write_level,
+                                    const int write_element_id,
+                                    const int max_level,
+                                    const double *box_min,
+                                    const double *box_max,
+                                    t8_forest_reduce_fn reduce_fn,
+                                    void *reduce_user_data,
+                                    const int num_data,
+                                    t8_vtk_data_field_t *data)
+{
+  t8_forest_decimation_plan_t *plan;
+  FILE               *vtufile = NULL;
+  t8_locidx_t         num_cells, num_points, icell;
+  char                vtufilename[BUFSIZ];
+  int                 freturn;
+
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (fileprefix != NULL);
+
+  /* Currently we only support output in ascii format, not binary */
+  T8_ASSERT (T8_VTK_ASCII == 1);
+
+  /* Build the down sampled view. This call is collective, so it happens
+   * before any process local failure can return. */
+  plan = t8_forest_decimation_plan_new (forest, max_level, box_min, box_max);
+
+  /* process 0 creates the .pvtu file */
+  if (forest->mpirank == 0) {
+    if (t8_write_pvtu
+        (fileprefix, forest->mpisize, write_treeid, write_mpirank,
+         write_level, write_element_id, num_data, data)) {
+      t8_errorf ("Error when writing file %s.pvtu\n", fileprefix);
+      goto t8_forest_vtk_failure;
+    }
+  }
+
+  /* Count the output cells and their points */
+  num_cells = t8_forest_decimation_plan_num_cells (plan);
+  num_points = 0;
+  for (icell = 0; icell < num_cells; icell++) {
+    const t8_forest_decimation_cell_t *cell =
+      t8_forest_decimation_plan_get_cell (plan, icell);
+    const t8_eclass_t   tree_class =
+      t8_forest_get_tree_class (forest, cell->ltreeid);
+    t8_eclass_scheme_c *ts =
+      t8_forest_get_eclass_scheme (forest, tree_class);
+
+    num_points +=
+      ts->t8_element_num_corners (t8_forest_decimation_cell_element
+                                  (plan, cell));
+  }
+
+  /* The filename for this processes file */
+  freturn =
+    snprintf (vtufilename, BUFSIZ, "%s_%04d.vtu", fileprefix,
+              forest->mpirank);
+  if (freturn >= BUFSIZ) {
+    t8_errorf ("Error when writing vtu file. Filename too long.\n");
+    goto t8_forest_vtk_failure;
+  }
+  vtufile = fopen (vtufilename, "w");
+  if (vtufile == NULL) {
+    t8_errorf ("Error when opening file %s\n", vtufilename);
+    goto t8_forest_vtk_failure;
+  }
+  /* Write the header information in the .vtu file. */
+  freturn = fprintf (vtufile, "<?xml version=\"1.0\"?>\n");
+  if (freturn <= 0) {
+    goto t8_forest_vtk_failure;
+  }
+  freturn =
+    fprintf (vtufile, "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\"");
+  if (freturn <= 0) {
+    goto t8_forest_vtk_failure;
+  }
+#ifdef SC_IS_BIGENDIAN
+  freturn = fprintf (vtufile, " byte_order=\"BigEndian\">\n");
+#else
+  freturn = fprintf (vtufile, " byte_order=\"LittleEndian\">\n");
+#endif
+  if (freturn <= 0) {
+    goto t8_forest_vtk_failure;
+  }
+  freturn = fprintf (vtufile, "  <UnstructuredGrid>\n");
+  if (freturn <= 0) {
+    goto t8_forest_vtk_failure;
+  }
+  freturn = fprintf (vtufile,
+                     "    <Piece NumberOfPoints=\"%lld\" NumberOfCells=\"%lld\">\n",
+                     (long long) num_points, (long long) num_cells);
+  if (freturn <= 0) {
+    goto t8_forest_vtk_failure;
+  }
+  /* write the point data */
+  if (!t8_forest_vtk_write_points_plan
+      (forest, vtufile, plan, reduce_fn, reduce_user_data, num_data, data)) {
+    goto t8_forest_vtk_failure;
+  }
+  /* write the cell data */
+  if (!t8_forest_vtk_write_cells_plan
+      (forest, vtufile, write_treeid, write_mpirank, write_level,
+       write_element_id, plan, reduce_fn, reduce_user_data, num_data, data)) {
+    goto t8_forest_vtk_failure;
+  }
+
+  freturn = fprintf (vtufile, "    </Piece>\n"
+                     "  </UnstructuredGrid>\n" "</VTKFile>\n");
+  if (freturn <= 0) {
+    goto t8_forest_vtk_failure;
+  }
+
+  freturn = fclose (vtufile);
+  vtufile = NULL;
+  if (freturn != 0) {
+    t8_global_errorf ("Error when closing file %s\n", vtufilename);
+    goto t8_forest_vtk_failure;
+  }
+  t8_forest_decimation_plan_destroy (&plan);
+  /* Writing was successful */
+  return 1;
+t8_forest_vtk_failure:
+  if (vtufile != NULL) {
+    fclose (vtufile);
+  }
+  t8_forest_decimation_plan_destroy (&plan);
+  t8_errorf ("Error when writing decimated vtk file.\n");
+  return 0;
+}
+
+/* The state of an asynchronous vtk write. The handle owns a reference on
+ * the forest and deep copies of the user defined data fields, so the
+ * caller's buffers are decoupled as soon as
+ * t8_forest_vtk_write_file_async returns. */
+typedef struct t8_forest_vtk_async
+{
+  t8_forest_t         forest;   /**< The forest to write. Referenced. */
+  char               *fileprefix;       /**< Owned copy of the file prefix. */
+  int                 write_treeid;
+  int                 write_mpirank;
+  int                 write_level;
+  int                 write_element_id;
+  int                 write_ghosts;
+  int                 num_data; /**< Number of staged data fields. */
+  t8_vtk_data_field_t *data;    /**< Staged copies of the data fields. */
+  int                 retval;   /**< Return value of the write. */
+  int                 written;  /**< True if the write was performed. */
+#if defined (SC_ENABLE_PTHREAD)
+  pthread_t           thread;   /**< The background writer thread. */
+  int                 threaded; /**< True if \a thread was started. */
+#endif
+} t8_forest_vtk_async_struct_t;
+
+/* Perform the staged write. Calls t8_forest_vtk_write_file with the
+ * snapshotted parameters. This performs no MPI communication. */
+static void
+t8_forest_vtk_async_write (t8_forest_vtk_async_t handle)
+{
+  handle->retval =
+    t8_forest_vtk_write_file (handle->forest, handle->fileprefix,
+                              handle->write_treeid, handle->write_mpirank,
+                              handle->write_level, handle->write_element_id,
+                              handle->write_ghosts, handle->num_data,
+                              handle->data);
+  handle->written = 1;
+}
+
+#if defined (SC_ENABLE_PTHREAD)
+/* Entry point of the background writer thread. */
+static void        *
+t8_forest_vtk_async_thread (void *vhandle)
+{
+  t8_forest_vtk_async_write ((t8_forest_vtk_async_t) vhandle);
+  return NULL;
+}
+#endif
+
+t8_forest_vtk_async_t
+t8_forest_vtk_write_file_async (t8_forest_t forest, const char *fileprefix,
+                                const int write_treeid,
+                                const int write_mpirank,
+                                const int write_level,
+                                const int write_element_id, int write_ghosts,
+                                const int num_data,
+                                t8_vtk_data_field_t *data)
+{
+  t8_forest_vtk_async_t handle;
+  t8_locidx_t         num_entries;
+  size_t              num_doubles;
+  int                 idata;
+
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (forest->committed);
+  T8_ASSERT (fileprefix != NULL);
+
+  handle = T8_ALLOC_ZERO (t8_forest_vtk_async_struct_t, 1);
+  /* A committed forest is not modified anymore, thus holding a reference
+   * is a sufficient snapshot of the mesh. */
+  t8_forest_ref (forest);
+  handle->forest = forest;
+  handle->fileprefix = T8_ALLOC (char, strlen (fileprefix) + 1);
+  strcpy (handle->fileprefix, fileprefix);
+  handle->write_treeid = write_treeid;
+  handle->write_mpirank = write_mpirank;
+  handle->write_level = write_level;
+  handle->write_element_id = write_element_id;
+  if (forest->ghosts == NULL || forest->ghosts->num_ghosts_elements == 0) {
+    /* Never write ghosts if none exist, as in t8_forest_vtk_write_file. */
+    write_ghosts = 0;
+  }
+  handle->write_ghosts = write_ghosts;
+  handle->num_data = num_data;
+  /* Copy the user defined data fields into an owned staging buffer, so
+   * that the caller may reuse its arrays immediately. */
+  if (num_data > 0) {
+    num_entries = t8_forest_get_local_num_elements (forest);
+    if (write_ghosts) {
+      num_entries += t8_forest_get_num_ghosts (forest);
+    }
+    handle->data = T8_ALLOC (t8_vtk_data_field_t, num_data);
+    for (idata = 0; idata < num_data; idata++) {
+      handle->data[idata] = data[idata];
+      num_doubles =
+        (data[idata].type == T8_VTK_VECTOR ? 3 : 1) * (size_t) num_entries;
+      handle->data[idata].data = T8_ALLOC (double, num_doubles);
+      memcpy (handle->data[idata].data, data[idata].data,
+              num_doubles * sizeof (double));
+    }
+  }
+#if defined (SC_ENABLE_PTHREAD)
+  if (pthread_create (&handle->thread, NULL, t8_forest_vtk_async_thread,
+                      handle) == 0) {
+    handle->threaded = 1;
+    return handle;
+  }
+  /* Thread creation failed, fall through to the deferred write. */
+#endif
+  /* Without thread support the write is deferred to
+   * t8_forest_vtk_async_wait. The field snapshot above still decouples
+   * the caller's buffers. */
+  return handle;
+}
+
+int
+t8_forest_vtk_async_wait (t8_forest_vtk_async_t *phandle)
+{
+  t8_forest_vtk_async_t handle;
+  int                 retval;
+  int                 idata;
+
+  T8_ASSERT (phandle != NULL && *phandle != NULL);
+  handle = *phandle;
+#if defined (SC_ENABLE_PTHREAD)
+  if (handle->threaded) {
+    pthread_join (handle->thread, NULL);
+  }
+#endif
+  if (!handle->written) {
+    /* The write was deferred, perform it now. */
+    t8_forest_vtk_async_write (handle);
+  }
+  retval = handle->retval;
+  for (idata = 0; idata < handle->num_data; idata++) {
+    T8_FREE (handle->data[idata].data);
+  }
+  T8_FREE (handle->data);
+  T8_FREE (handle->fileprefix);
+  t8_forest_unref (&handle->forest);
+  T8_FREE (handle);
+  *phandle = NULL;
+  return retval;
+}
+
 T8_EXTERN_C_END ();
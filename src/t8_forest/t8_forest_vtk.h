@@ -31,6 +31,7 @@
 #include <t8_vtk.h>
 #include <t8_forest/t8_forest_general.h>
 #include <t8_forest/t8_forest_geometrical.h>
+#include <t8_forest/t8_forest_decimate.h>
 
 T8_EXTERN_C_BEGIN ();
 /* function declarations */
@@ -98,6 +99,173 @@ int                 t8_forest_vtk_write_file (t8_forest_t forest,
                                               const int num_data,
                                               t8_vtk_data_field_t *data);
 
+/** Write a decimated view of the forest in .pvtu file format.
+ * Like \ref t8_forest_vtk_write_file this function writes ASCII files,
+ * one .vtu file per process and a meta .pvtu file, but it down samples
+ * the forest during the write: elements finer than \a max_level are
+ * aggregated to their level \a max_level ancestor and an optional axis
+ * aligned box drops all output cells whose centroid lies outside of it,
+ * \see t8_forest_decimation_plan_new. The output is streamed cell by
+ * cell, so no full resolution buffer is ever allocated.
+ * Ghost elements are never written and burst buffer staging does not
+ * apply; the files are written to their final paths directly.
+ * \param [in]  forest    The forest.
+ * \param [in]  fileprefix  The prefix of the output files.
+ * \param [in]  write_treeid If true, the global tree id is written for each output cell.
+ * \param [in]  write_mpirank If true, the mpirank is written for each output cell.
+ * \param [in]  write_level If true, the refinement level of the output cell is written.
+ * \param [in]  write_element_id If true, the global element id of the first
+ *                        member element of each output cell is written.
+ * \param [in]  max_level The maximum refinement level of the output.
+ * \param [in]  box_min   Minimal corner of the filter box (3 entries), or NULL.
+ * \param [in]  box_max   Maximal corner of the filter box, NULL iff \a box_min is NULL.
+ * \param [in]  reduce_fn Reduction applied to the member values of an
+ *                        aggregated cell, or NULL for the arithmetic mean.
+ * \param [in]  reduce_user_data Passed through to \a reduce_fn.
+ * \param [in]  num_data  Number of user defined double valued data fields to write.
+ * \param [in]  data      Array of t8_vtk_data_field_t of length \a num_data
+ *                        providing the user defined per element data at full
+ *                        resolution. If scalar and vector fields are used,
+ *                        all scalar fields must come first in the array.
+ * \return  True if succesful, false if not (process local).
+ * \note If the partition cuts through the descendants of an ancestor, each
+ * sharing process writes its own output cell for that ancestor.
+ */
+int                 t8_forest_vtk_write_file_decimated (t8_forest_t forest,
+                                                        const char
+                                                        *fileprefix,
+                                                        const int
+                                                        write_treeid,
+                                                        const int
+                                                        write_mpirank,
+                                                        const int
+                                                        write_level,
+                                                        const int
+                                                        write_element_id,
+                                                        const int max_level,
+                                                        const double
+                                                        *box_min,
+                                                        const double
+                                                        *box_max,
+                                                        t8_forest_reduce_fn
+                                                        reduce_fn,
+                                                        void
+                                                        *reduce_user_data,
+                                                        const int num_data,
+                                                        t8_vtk_data_field_t
+                                                        *data);
+
+/** Write the forest as a single .vtu file in binary appended-data format.
+ * All processes write into the same file \a fileprefix.vtu, so no .pvtu
+ * meta file is needed and the number of files is independent of the
+ * number of processes.
+ * The data arrays are stored as raw binary blocks in the appended data
+ * section of the file and each process writes its elements at a file
+ * offset computed from a prefix sum over the local element counts.
+ * If t8code is configured with MPI I/O the processes write collectively,
+ * otherwise they append sequentially to the shared file.
+ * Ghost elements are never written and the user defined data fields are
+ * written as cell data only.
+ * \param [in]  forest    The forest.
+ * \param [in]  fileprefix  The prefix of the output file.
+ * \param [in]  write_treeid If true, the global tree id is written for each element.
+ * \param [in]  write_mpirank If true, the mpirank is written for each element.
+ * \param [in]  write_level If true, the refinement level is written for each element.
+ * \param [in]  write_element_id If true, the global element id is written for each element.
+ * \param [in]  num_data  Number of user defined double valued data fields to write.
+ * \param [in]  data      Array of t8_vtk_data_field_t of length \a num_data
+ *                        providing the user defined per element data.
+ *                        If scalar and vector fields are used, all scalar fields
+ *                        must come first in the array.
+ * \return  True if succesful, false if not (collective over all processes).
+ */
+int                 t8_forest_vtk_write_file_binary (t8_forest_t forest,
+                                                     const char *fileprefix,
+                                                     const int write_treeid,
+                                                     const int write_mpirank,
+                                                     const int write_level,
+                                                     const int
+                                                     write_element_id,
+                                                     const int num_data,
+                                                     t8_vtk_data_field_t
+                                                     *data);
+
+/** Opaque handle of an asynchronous vtk write started with
+ * \ref t8_forest_vtk_write_file_async. */
+typedef struct t8_forest_vtk_async *t8_forest_vtk_async_t;
+
+/** Start writing the forest in .pvtu file format without blocking the
+ * caller for the serialization and file system write.
+ * The call snapshots the output: it takes a reference on the forest and
+ * copies the user defined data fields into an owned staging buffer, so the
+ * caller may overwrite its field arrays and continue computing immediately.
+ * If t8code's sc library was configured with pthread support, the encoding
+ * and the file writes are performed on a background thread; otherwise they
+ * are deferred to \ref t8_forest_vtk_async_wait. The files written are
+ * identical to those of \ref t8_forest_vtk_write_file, which performs no
+ * MPI communication, so the background thread is safe at any MPI thread
+ * level. The parameters match \ref t8_forest_vtk_write_file.
+ * \return  A handle that must be completed with
+ *          \ref t8_forest_vtk_async_wait before the program exits. At most
+ *          one asynchronous write may be in flight per file prefix.
+ * \note The forest may be derived from and destroyed by the caller while
+ * the write is in flight, since the handle holds its own reference. The
+ * caller must not modify the forest in place.
+ */
+t8_forest_vtk_async_t t8_forest_vtk_write_file_async (t8_forest_t forest,
+                                                      const char *fileprefix,
+                                                      const int write_treeid,
+                                                      const int
+                                                      write_mpirank,
+                                                      const int write_level,
+                                                      const int
+                                                      write_element_id,
+                                                      int write_ghosts,
+                                                      const int num_data,
+                                                      t8_vtk_data_field_t
+                                                      *data);
+
+/** Wait for an asynchronous vtk write to complete and release its
+ * resources, including the reference on the forest.
+ * If the write was deferred (no thread support), it is performed now.
+ * \param [in,out] phandle Pointer to a handle returned by
+ *                         \ref t8_forest_vtk_write_file_async.
+ *                         Set to NULL on output.
+ * \return  True if the write was successful, false if not (process local),
+ *          \see t8_forest_vtk_write_file.
+ */
+int                 t8_forest_vtk_async_wait (t8_forest_vtk_async_t
+                                              *phandle);
+
+/** Activate burst buffer staging for \ref t8_forest_vtk_write_file.
+ * When a staging directory is set, each process writes its .vtu file
+ * there - typically node local storage such as NVMe - and returns as
+ * soon as that write completes. A background drainer then copies the
+ * file to its final path and deletes the staged copy, so the caller
+ * does not block on the parallel file system. The .pvtu file of
+ * process 0 is always written directly to the final location; it
+ * serves as the manifest for readers. Each drained .vtu file is moved
+ * into its final place atomically, hence a reader that finds a file
+ * named in the .pvtu sees it complete.
+ * \param [in] staging_dir  Path of a writable directory on every
+ *                          process, or NULL to deactivate staging.
+ *                          The string is copied.
+ * \note Without pthread support staged files are copied to their final
+ * path synchronously before \ref t8_forest_vtk_write_file returns.
+ */
+void                t8_forest_vtk_set_staging_dir (const char *staging_dir);
+
+/** Block until all staged vtk files have been drained to their final
+ * paths. Call this before reading the output of a staged write on the
+ * same process and before the staged files must be complete, for
+ * example at a restart checkpoint. Process local, no communication. */
+void                t8_forest_vtk_staging_flush (void);
+
+/** Drain all pending staged files, stop the background drainer and
+ * deactivate staging. Must be called before sc_finalize if staging was
+ * ever activated. \see t8_forest_vtk_set_staging_dir */
+void                t8_forest_vtk_staging_finalize (void);
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_FOREST_VTK_H */
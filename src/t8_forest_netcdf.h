@@ -28,6 +28,7 @@
 #define T8_FOREST_NETCDF_H
 
 #include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_decimate.h>
 #include <t8_netcdf.h>
 
 T8_EXTERN_C_BEGIN ();
@@ -50,6 +51,45 @@ void                t8_forest_write_netcdf (t8_forest_t forest,
                                             ext_variables[],
                                             sc_MPI_Comm comm);
 
+/** Creates a netCDF-4 file containing a decimated view of the given forest mesh and additional elementwise data variables
+ * Elements finer than \a max_level are aggregated to their level \a max_level ancestor and an optional axis aligned
+ * box drops all output cells whose centroid lies outside of it, \see t8_forest_decimation_plan_new.
+ * The double valued user variables of an aggregated output cell are reduced with \a reduce_fn; integer variables
+ * take the value of the first member element, since they can not be reduced meaningfully.
+ * The output is streamed in chunks, so no full-size buffer is ever allocated.
+ * This function uses the same default storage and access hints as \ref t8_forest_write_netcdf.
+ * \param [in]  forest    A forest.
+ * \param [in]  file_prefix    A string which holds the file's name (output file will be 'file_prefix.nc').
+ * \param [in]  file_title    A string to caption the NetCDF-File.
+ * \param [in]  dim    The Dimension of the forest mesh (2D or 3D).
+ * \param [in]  num_extern_netcdf_vars    The number of extern user-defined variables which hold elementwise data at full resolution (if none, set it to 0).
+ * \param [in]  ext_variables An array of pointers of the herein before mentioned user-defined variables (if none, set it to NULL).
+ * \param [in]  comm The sc_MPI_Communicator to use.
+ * \param [in]  max_level The maximum refinement level of the output; elements of this level or coarser pass through unchanged.
+ * \param [in]  box_min Minimal corner of the filter box (3 entries), or NULL for no region filter.
+ * \param [in]  box_max Maximal corner of the filter box; must be NULL if and only if \a box_min is NULL.
+ * \param [in]  reduce_fn Reduction applied to the member values of an aggregated output cell, or NULL for the arithmetic mean.
+ * \param [in]  reduce_user_data Passed through to \a reduce_fn.
+ * \note If the partition cuts through the descendants of an ancestor, each sharing process writes its own output cell for that ancestor.
+ */
+void                t8_forest_write_netcdf_decimated (t8_forest_t forest,
+                                                      const char
+                                                      *file_prefix,
+                                                      const char *file_title,
+                                                      int dim,
+                                                      int
+                                                      num_extern_netcdf_vars,
+                                                      t8_netcdf_variable_t *
+                                                      ext_variables[],
+                                                      sc_MPI_Comm comm,
+                                                      int max_level,
+                                                      const double *box_min,
+                                                      const double *box_max,
+                                                      t8_forest_reduce_fn
+                                                      reduce_fn,
+                                                      void
+                                                      *reduce_user_data);
+
 /** Creates a netCDF-4 file containing the (geometrical) information about the given forest mesh and additional elementwise data variables
  * \param [in]  forest    A forest.
  * \param [in]  file_prefix    A string which holds the file's name (output file will be 'file_prefix.nc').
@@ -73,6 +113,35 @@ void                t8_forest_write_netcdf_ext (t8_forest_t forest,
                                                 int netcdf_var_storage_mode,
                                                 int netcdf_var_mpi_access);
 
+/** Creates a netCDF-4 file containing the (geometrical) information about the given forest mesh and additional elementwise data variables
+ * This version additionally exposes the netCDF-4 chunk size and the zlib compression level of the variables.
+ * \param [in]  forest    A forest.
+ * \param [in]  file_prefix    A string which holds the file's name (output file will be 'file_prefix.nc').
+ * \param [in]  file_title    A string to caption the NetCDF-File.
+ * \param [in]  dim    The Dimension of the forest mesh (2D or 3D).
+ * \param [in]  num_extern_netcdf_vars    The number of extern user-defined variables which hold elementwise data (if none, set it to 0).
+ * \param [in]  ext_variables An array of pointers of the herein before mentioned user-defined variables (if none, set it to NULL).
+ * \param [in]  comm The sc_MPI_Communicator to use.
+ * \param [in]  netcdf_var_storage_mode This defines whether the variables in the netCDF-4 File are stored contiguously (NC_CONTIGUOUS) or in chunks (NC_CHUNKED).
+ * \param [in]  netcdf_var_chunksize The number of elements (resp. nodes) per chunk along the mesh dimension if NC_CHUNKED storage is used. A value of 0 leaves the chunk shapes to the netCDF default.
+ * \param [in]  netcdf_var_deflate_level The zlib compression level (0 - 9) applied to the variables, -1 disables compression. Compression implies chunked storage and, in a parallel configuration, collective variable access.
+ * \param [in]  netcdf_var_mpi_access This defines whether the mpi processes are writing the variables' data collectively or independently.
+ * \note The hints may be overridden per extern variable with \ref t8_netcdf_variable_set_hints.
+ * \note Only use this extended version of \ref t8_forest_write_netcdf if you know exactly what you are doing. In all other cases, we recommend using \ref t8_forest_write_netcdf instead.
+ */
+void                t8_forest_write_netcdf_ext2 (t8_forest_t forest,
+                                                 const char *file_prefix,
+                                                 const char *file_title,
+                                                 int dim,
+                                                 int num_extern_netcdf_vars,
+                                                 t8_netcdf_variable_t *
+                                                 ext_variables[],
+                                                 sc_MPI_Comm comm,
+                                                 int netcdf_var_storage_mode,
+                                                 size_t netcdf_var_chunksize,
+                                                 int netcdf_var_deflate_level,
+                                                 int netcdf_var_mpi_access);
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_FOREST_NETCDF_H */
@@ -352,6 +352,45 @@ t8_geometry_evaluate (t8_cmesh_t cmesh, t8_gloidx_t gtreeid,
   }
 }
 
+void
+t8_geometry_evaluate_batch (t8_cmesh_t cmesh, t8_gloidx_t gtreeid,
+                            size_t num_points, const double *ref_coords,
+                            double *out_coords)
+{
+  double              start_wtime = 0;  /* Used for profiling. */
+  /* The cmesh must be committed */
+  T8_ASSERT (t8_cmesh_is_committed (cmesh));
+  /* Get the geometry handler of the cmesh. */
+  t8_geometry_handler_t *geom_handler = cmesh->geometry_handler;
+  /* The handler must be committed. */
+  T8_ASSERT (t8_geom_handler_is_committed (geom_handler));
+
+  if (cmesh->profile != NULL) {
+    /* Measure the runtime of geometry evaluation.
+     * We accumulate the runtime over all calls. */
+    start_wtime = sc_MPI_Wtime ();
+  }
+  /* Update the active tree and geometry once for the whole batch. */
+  t8_geom_handler_update_tree (geom_handler, cmesh, gtreeid);
+
+  T8_ASSERT (geom_handler->active_geometry != NULL);
+
+  /* Evaluate the geometry for all points with a single virtual dispatch. */
+  geom_handler->active_geometry->t8_geom_evaluate_batch (cmesh,
+                                                         geom_handler->active_tree,
+                                                         num_points,
+                                                         ref_coords,
+                                                         out_coords);
+
+  if (cmesh->profile != NULL) {
+    /* If profiling is enabled, add the runtime to the profiling
+     * variable. */
+    cmesh->profile->geometry_evaluate_runtime +=
+      sc_MPI_Wtime () - start_wtime;
+    cmesh->profile->geometry_evaluate_num_calls += num_points;
+  }
+}
+
 void
 t8_geometry_jacobian (t8_cmesh_t cmesh, t8_gloidx_t gtreeid,
                       const double *ref_coords, double *jacobian)
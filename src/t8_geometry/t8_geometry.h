@@ -148,6 +148,23 @@ void                t8_geometry_evaluate (t8_cmesh_t cmesh,
                                           const double *ref_coords,
                                           double *out_coords);
 
+/** Evaluate the geometry of a tree at many reference points in one call.
+ * The active tree and geometry are resolved once and the evaluation is
+ * dispatched to \ref t8_geometry::t8_geom_evaluate_batch, so the virtual
+ * dispatch and the tree vertex loads are amortized over the whole batch.
+ * \param [in]  cmesh      A committed cmesh.
+ * \param [in]  gtreeid    A global tree id of \a cmesh.
+ * \param [in]  num_points The number of reference points.
+ * \param [in]  ref_coords \a num_points x dimension entries, the reference
+ *                         coordinates of the points stored contiguously.
+ * \param [out] out_coords \a num_points x 3 entries, the mapped coordinates.
+ */
+void                t8_geometry_evaluate_batch (t8_cmesh_t cmesh,
+                                                t8_gloidx_t gtreeid,
+                                                size_t num_points,
+                                                const double *ref_coords,
+                                                double *out_coords);
+
 void                t8_geometry_jacobian (t8_cmesh_t cmesh,
                                           t8_gloidx_t gtreeid,
                                           const double *ref_coords,
@@ -71,6 +71,31 @@ public:
                                         const double *ref_coords,
                                         double out_coords[3]) const = 0;
 
+  /**
+   * Map a batch of points in the reference space $$[0,1]^dimension$$ to $$\mathbb R^3$$.
+   * The default implementation loops over the points and calls
+   * \ref t8_geom_evaluate, so the virtual dispatch happens once per batch.
+   * Derived classes can override it with a vectorizable loop.
+   * \param [in]  cmesh      The cmesh in which the points lie.
+   * \param [in]  gtreeid    The global tree (of the cmesh) in which the reference points are.
+   * \param [in]  num_points The number of points to map.
+   * \param [in]  ref_coords  Array of \a num_points x \a dimension many entries, specifying
+   *                          \a num_points points in [0,1]^dimension, stored contiguously.
+   * \param [out] out_coords  Array of \a num_points x 3 entries. The mapped coordinates in
+   *                          physical space of the points in \a ref_coords.
+   */
+  virtual void        t8_geom_evaluate_batch (t8_cmesh_t cmesh,
+                                              t8_gloidx_t gtreeid,
+                                              size_t num_points,
+                                              const double *ref_coords,
+                                              double *out_coords) const
+  {
+    for (size_t ipoint = 0; ipoint < num_points; ipoint++) {
+      t8_geom_evaluate (cmesh, gtreeid, ref_coords + ipoint * dimension,
+                        out_coords + ipoint * 3);
+    }
+  }
+
   /**
    * Compute the jacobian of the \a t8_geom_evaluate map at a point in the reference space $$[0,1]^dimension$$.
    * \param [in]  cmesh      The cmesh in which the point lies.
@@ -22,9 +22,177 @@
 
 #include <t8_vec.h>
 #include <t8_eclass.h>
+#include <t8_cpuid.h>
 #include <t8_geometry/t8_geometry_helpers.h>
 #include <t8_geometry/t8_geometry_implementations/t8_geometry_occ.h>
 
+/* With gcc or clang on x86 we can compile the arithmetic dense point loops
+ * of the batch kernels several times with different target instruction
+ * sets and pick the widest supported one at runtime, \see t8_cpuid.h.
+ * On AArch64 the baseline build already emits NEON, so no extra variants
+ * are needed there. */
+#if defined (__x86_64__) && (defined (__GNUC__) || defined (__clang__))
+#define T8_GEOM_BATCH_X86_VARIANTS 1
+#endif
+
+/** Signature of a per shape point loop of the batch geometry kernels.
+ * The arguments match \ref t8_geom_compute_linear_geometry_batch with the
+ * shape dispatch already done. */
+typedef void        (*t8_geom_batch_kernel_t) (const double *tree_vertices,
+                                               size_t num_points,
+                                               const double *ref_coords,
+                                               double *out_coords);
+
+/* The loop bodies are shared between the generic kernel and the per
+ * instruction set variants via macros, so that all variants are compiled
+ * from the same arithmetic. */
+
+#define T8_GEOM_QUAD_BATCH_BODY \
+  size_t              ipoint; \
+  int                 i; \
+  for (ipoint = 0; ipoint < num_points; ipoint++) { \
+    const double        ref_x = ref_coords[2 * ipoint]; \
+    const double        ref_y = ref_coords[2 * ipoint + 1]; \
+    for (i = 0; i < 3; i++) { \
+      out_coords[3 * ipoint + i] = \
+        (tree_vertices[i] * (1 - ref_x) \
+         + tree_vertices[3 + i] * ref_x) * (1 - ref_y) \
+        + (tree_vertices[6 + i] * (1 - ref_x) \
+           + tree_vertices[9 + i] * ref_x) * ref_y; \
+    } \
+  }
+
+#define T8_GEOM_HEX_BATCH_BODY \
+  size_t              ipoint; \
+  int                 i; \
+  for (ipoint = 0; ipoint < num_points; ipoint++) { \
+    const double        ref_x = ref_coords[3 * ipoint]; \
+    const double        ref_y = ref_coords[3 * ipoint + 1]; \
+    const double        ref_z = ref_coords[3 * ipoint + 2]; \
+    for (i = 0; i < 3; i++) { \
+      out_coords[3 * ipoint + i] = \
+        ((tree_vertices[i] * (1 - ref_x) \
+          + tree_vertices[3 + i] * ref_x) * (1 - ref_y) \
+         + (tree_vertices[6 + i] * (1 - ref_x) \
+            + tree_vertices[9 + i] * ref_x) * ref_y) * (1 - ref_z) \
+        + ((tree_vertices[12 + i] * (1 - ref_x) \
+            + tree_vertices[15 + i] * ref_x) * (1 - ref_y) \
+           + (tree_vertices[18 + i] * (1 - ref_x) \
+              + tree_vertices[21 + i] * ref_x) * ref_y) * ref_z; \
+    } \
+  }
+
+#define T8_GEOM_AXIS_ALIGNED_HEX_BATCH_BODY \
+  size_t              ipoint; \
+  int                 dim; \
+  double              vector[3]; \
+  t8_vec_diff (tree_vertices + 3, tree_vertices, vector); \
+  for (ipoint = 0; ipoint < num_points; ipoint++) { \
+    for (dim = 0; dim < 3; ++dim) { \
+      out_coords[3 * ipoint + dim] = tree_vertices[dim] \
+        + ref_coords[3 * ipoint + dim] * vector[dim]; \
+    } \
+  }
+
+static void
+t8_geom_quad_batch_generic (const double *tree_vertices, size_t num_points,
+                            const double *ref_coords, double *out_coords)
+{
+  T8_GEOM_QUAD_BATCH_BODY;
+}
+
+static void
+t8_geom_hex_batch_generic (const double *tree_vertices, size_t num_points,
+                           const double *ref_coords, double *out_coords)
+{
+  T8_GEOM_HEX_BATCH_BODY;
+}
+
+static void
+t8_geom_axis_aligned_hex_batch_generic (const double *tree_vertices,
+                                        size_t num_points,
+                                        const double *ref_coords,
+                                        double *out_coords)
+{
+  T8_GEOM_AXIS_ALIGNED_HEX_BATCH_BODY;
+}
+
+#ifdef T8_GEOM_BATCH_X86_VARIANTS
+
+static void         __attribute__ ((target ("avx2,fma")))
+t8_geom_quad_batch_avx2 (const double *tree_vertices, size_t num_points,
+                         const double *ref_coords, double *out_coords)
+{
+  T8_GEOM_QUAD_BATCH_BODY;
+}
+
+static void         __attribute__ ((target ("avx512f")))
+t8_geom_quad_batch_avx512 (const double *tree_vertices, size_t num_points,
+                           const double *ref_coords, double *out_coords)
+{
+  T8_GEOM_QUAD_BATCH_BODY;
+}
+
+static void         __attribute__ ((target ("avx2,fma")))
+t8_geom_hex_batch_avx2 (const double *tree_vertices, size_t num_points,
+                        const double *ref_coords, double *out_coords)
+{
+  T8_GEOM_HEX_BATCH_BODY;
+}
+
+static void         __attribute__ ((target ("avx512f")))
+t8_geom_hex_batch_avx512 (const double *tree_vertices, size_t num_points,
+                          const double *ref_coords, double *out_coords)
+{
+  T8_GEOM_HEX_BATCH_BODY;
+}
+
+static void         __attribute__ ((target ("avx2,fma")))
+t8_geom_axis_aligned_hex_batch_avx2 (const double *tree_vertices,
+                                     size_t num_points,
+                                     const double *ref_coords,
+                                     double *out_coords)
+{
+  T8_GEOM_AXIS_ALIGNED_HEX_BATCH_BODY;
+}
+
+static void         __attribute__ ((target ("avx512f")))
+t8_geom_axis_aligned_hex_batch_avx512 (const double *tree_vertices,
+                                       size_t num_points,
+                                       const double *ref_coords,
+                                       double *out_coords)
+{
+  T8_GEOM_AXIS_ALIGNED_HEX_BATCH_BODY;
+}
+
+#endif /* T8_GEOM_BATCH_X86_VARIANTS */
+
+/* The active kernels.  They default to the generic variants so that the
+ * batch functions are safe to call even before \ref t8_init ran. */
+static t8_geom_batch_kernel_t t8_geom_quad_batch = t8_geom_quad_batch_generic;
+static t8_geom_batch_kernel_t t8_geom_hex_batch = t8_geom_hex_batch_generic;
+static t8_geom_batch_kernel_t t8_geom_axis_aligned_hex_batch =
+  t8_geom_axis_aligned_hex_batch_generic;
+
+void
+t8_geom_batch_kernels_init (void)
+{
+#ifdef T8_GEOM_BATCH_X86_VARIANTS
+  const int           features = t8_cpuid_features ();
+
+  if (features & T8_CPUID_AVX512F) {
+    t8_geom_quad_batch = t8_geom_quad_batch_avx512;
+    t8_geom_hex_batch = t8_geom_hex_batch_avx512;
+    t8_geom_axis_aligned_hex_batch = t8_geom_axis_aligned_hex_batch_avx512;
+  }
+  else if (features & T8_CPUID_AVX2) {
+    t8_geom_quad_batch = t8_geom_quad_batch_avx2;
+    t8_geom_hex_batch = t8_geom_hex_batch_avx2;
+    t8_geom_axis_aligned_hex_batch = t8_geom_axis_aligned_hex_batch_avx2;
+  }
+#endif
+}
+
 void
 t8_geom_linear_interpolation (const double *coefficients,
                               const double *corner_values,
@@ -169,6 +337,73 @@ t8_geom_compute_linear_geometry (t8_eclass_t tree_class,
   }
 }
 
+void
+t8_geom_compute_linear_geometry_batch (t8_eclass_t tree_class,
+                                       const double *tree_vertices,
+                                       size_t num_points,
+                                       const double *ref_coords,
+                                       double *out_coords)
+{
+  const int           dimension = t8_eclass_to_dimension[tree_class];
+  size_t              ipoint;
+  int                 i;
+
+  /* The shape dispatch is done once per batch. Each case runs a tight loop
+   * over the points with the same arithmetic as
+   * t8_geom_compute_linear_geometry, which the compiler can vectorize. */
+  switch (tree_class) {
+  case T8_ECLASS_VERTEX:
+    for (ipoint = 0; ipoint < num_points; ipoint++) {
+      for (i = 0; i < 3; i++) {
+        out_coords[3 * ipoint + i] = tree_vertices[i];
+      }
+    }
+    break;
+  case T8_ECLASS_LINE:
+    for (ipoint = 0; ipoint < num_points; ipoint++) {
+      const double        ref_x = ref_coords[ipoint];
+      for (i = 0; i < 3; i++) {
+        out_coords[3 * ipoint + i] =
+          (tree_vertices[3 + i] - tree_vertices[i]) * ref_x
+          + tree_vertices[i];
+      }
+    }
+    break;
+  case T8_ECLASS_TRIANGLE:
+  case T8_ECLASS_TET:
+    for (ipoint = 0; ipoint < num_points; ipoint++) {
+      const double       *ref = ref_coords + ipoint * dimension;
+      for (i = 0; i < 3; i++) {
+        out_coords[3 * ipoint + i] =
+          (tree_vertices[3 + i] - tree_vertices[i]) * ref[0]
+          + (dimension == 3
+             ? (tree_vertices[9 + i] - tree_vertices[6 + i]) * ref[1]
+             : 0.)
+          + (tree_vertices[6 + i] - tree_vertices[3 + i]) * ref[dimension -
+                                                                1]
+          + tree_vertices[i];
+      }
+    }
+    break;
+  case T8_ECLASS_QUAD:
+    /* The quad and hex loops run through the kernels selected in
+     * t8_geom_batch_kernels_init. */
+    t8_geom_quad_batch (tree_vertices, num_points, ref_coords, out_coords);
+    break;
+  case T8_ECLASS_HEX:
+    t8_geom_hex_batch (tree_vertices, num_points, ref_coords, out_coords);
+    break;
+  default:
+    /* Prisms and pyramids fall back to the per point computation */
+    for (ipoint = 0; ipoint < num_points; ipoint++) {
+      t8_geom_compute_linear_geometry (tree_class, tree_vertices,
+                                       ref_coords + ipoint * dimension,
+                                       out_coords + 3 * ipoint);
+    }
+    break;
+  }
+}
+
 void
 t8_geom_compute_linear_axis_aligned_geometry (t8_eclass_t tree_class,
                                               const double *tree_vertices,
@@ -211,6 +446,47 @@ t8_geom_compute_linear_axis_aligned_geometry (t8_eclass_t tree_class,
   }
 }
 
+void
+t8_geom_compute_linear_axis_aligned_geometry_batch (t8_eclass_t tree_class,
+                                                    const double
+                                                    *tree_vertices,
+                                                    size_t num_points,
+                                                    const double *ref_coords,
+                                                    double *out_coords)
+{
+  const int           dimension = t8_eclass_to_dimension[tree_class];
+  size_t              ipoint;
+  int                 dim;
+  double              vector[3];
+
+  if (tree_class != T8_ECLASS_LINE && tree_class != T8_ECLASS_QUAD
+      && tree_class != T8_ECLASS_HEX) {
+    SC_ABORT ("Linear geometry coordinate computation is only supported for "
+              "lines/quads/hexes.");
+  }
+
+  if (tree_class == T8_ECLASS_HEX) {
+    /* For hexes the reference coordinates fill all three dimensions and the
+     * loop runs through the kernel selected in t8_geom_batch_kernels_init. */
+    t8_geom_axis_aligned_hex_batch (tree_vertices, num_points, ref_coords,
+                                    out_coords);
+    return;
+  }
+
+  /* Compute the vector between both points once for all points */
+  t8_vec_diff (tree_vertices + 3, tree_vertices, vector);
+
+  /* Compute the coordinates of the reference points. Reference coordinates
+   * beyond the tree dimension are treated as zero. */
+  for (ipoint = 0; ipoint < num_points; ipoint++) {
+    const double       *ref = ref_coords + ipoint * dimension;
+    for (dim = 0; dim < 3; ++dim) {
+      out_coords[3 * ipoint + dim] = tree_vertices[dim]
+        + (dim < dimension ? ref[dim] : 0.) * vector[dim];
+    }
+  }
+}
+
 void
 t8_geom_get_face_vertices (const t8_eclass_t tree_class,
                            const double *tree_vertices,
@@ -62,6 +62,49 @@ void                t8_geom_compute_linear_axis_aligned_geometry (t8_eclass_t
                                                                   out_coords
                                                                   [3]);
 
+/** Compute the linear geometry of a tree at many reference coordinates at once.
+ *  The per point arithmetic is the same as in \ref t8_geom_compute_linear_geometry,
+ *  but the shape dispatch is hoisted out of the point loop, so that the loops over
+ *  the points can be vectorized by the compiler.
+ * \param [in]    tree_class     The eclass of the tree.
+ * \param [in]    tree_vertices  Array with the tree vertex coordinates.
+ * \param [in]    num_points     The number of reference points.
+ * \param [in]    ref_coords     The reference coordinates, \a num_points x dimension
+ *                               entries stored contiguously.
+ * \param [out]   out_coords     The output coordinates, \a num_points x 3 entries.
+ */
+void                t8_geom_compute_linear_geometry_batch (t8_eclass_t
+                                                           tree_class,
+                                                           const double
+                                                           *tree_vertices,
+                                                           size_t num_points,
+                                                           const double
+                                                           *ref_coords,
+                                                           double
+                                                           *out_coords);
+
+/** Compute the linear, axis-aligned geometry of a tree at many reference
+ *  coordinates at once, \see t8_geom_compute_linear_axis_aligned_geometry.
+ *  The diagonal vector of the tree is computed once and reused for all points.
+ * \param [in]    tree_class     The eclass of the tree.
+ * \param [in]    tree_vertices  Array with the tree vertex coordinates.
+ * \param [in]    num_points     The number of reference points.
+ * \param [in]    ref_coords     The reference coordinates, \a num_points x dimension
+ *                               entries stored contiguously.
+ * \param [out]   out_coords     The output coordinates, \a num_points x 3 entries.
+ */
+void                t8_geom_compute_linear_axis_aligned_geometry_batch
+  (t8_eclass_t tree_class, const double *tree_vertices, size_t num_points,
+   const double *ref_coords, double *out_coords);
+
+/** Select the widest instruction set variants of the batch geometry kernels
+ *  that the CPU this process runs on supports, \see t8_cpuid_features.
+ *  Called once from \ref t8_init.  Before the selection the batch functions
+ *  fall back to their generic kernels, so calling them earlier is safe,
+ *  just not as fast.
+ */
+void                t8_geom_batch_kernels_init (void);
+
 /** Interpolates linearly between 2, bilinearly between 4 or trilineraly between 8 points.
  * \param [in]    coefficients        An array of size at least dim giving the coefficients used for the interpolation
  * \param [in]    corner_values       An array of size 2^dim * 3, giving for each corner (in zorder) of
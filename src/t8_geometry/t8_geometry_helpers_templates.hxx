@@ -0,0 +1,339 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_geometry_helpers_templates.hxx
+ * Compile-time specialized linear interpolation kernels.
+ * The C helpers in \ref t8_geometry_helpers.h branch on the tree class
+ * and the dimension inside the per point computation. The function
+ * templates in this file are parameterized on the tree class instead, so
+ * each instantiation contains only the fully unrolled interpolation of
+ * its shape with all weights spelled out. A geometry selects the kernel
+ * of a tree once when the tree is loaded (\see
+ * t8_geometry_linear::t8_geom_load_tree_data) and evaluates points
+ * branch-free afterwards.
+ * The kernels perform the same operations in the same order as
+ * \ref t8_geom_compute_linear_geometry, so both produce bitwise
+ * identical coordinates.
+ */
+
+#ifndef T8_GEOMETRY_HELPERS_TEMPLATES_HXX
+#define T8_GEOMETRY_HELPERS_TEMPLATES_HXX
+
+#include <math.h>
+#include <t8_eclass.h>
+
+/** Map one point from the reference space of a tree of class \a TEclass
+ * to physical space by linear interpolation of the tree vertices.
+ * Only the specializations below are defined, one per element class.
+ * \param [in]  tree_vertices The vertex coordinates of the tree, 3 doubles
+ *                            per vertex in the class's vertex order.
+ * \param [in]  ref_coords    The reference coordinates of the point,
+ *                            one double per dimension of \a TEclass.
+ * \param [out] out_coords    The mapped coordinates, 3 doubles.
+ */
+template < t8_eclass_t TEclass >
+inline void         t8_geom_linear_evaluate_one (const double
+                                                 *tree_vertices,
+                                                 const double *ref_coords,
+                                                 double *out_coords);
+
+template <>
+inline void
+t8_geom_linear_evaluate_one < T8_ECLASS_VERTEX > (const double
+                                                  *tree_vertices,
+                                                  const double *ref_coords,
+                                                  double *out_coords)
+{
+  /* A vertex coincides with its single tree vertex */
+  out_coords[0] = tree_vertices[0];
+  out_coords[1] = tree_vertices[1];
+  out_coords[2] = tree_vertices[2];
+}
+
+template <>
+inline void
+t8_geom_linear_evaluate_one < T8_ECLASS_LINE > (const double *tree_vertices,
+                                                const double *ref_coords,
+                                                double *out_coords)
+{
+  const double        ref_x = ref_coords[0];
+
+  for (int i = 0; i < 3; i++) {
+    out_coords[i] =
+      (tree_vertices[3 + i] - tree_vertices[i]) * ref_x + tree_vertices[i];
+  }
+}
+
+template <>
+inline void
+t8_geom_linear_evaluate_one < T8_ECLASS_TRIANGLE > (const double
+                                                    *tree_vertices,
+                                                    const double *ref_coords,
+                                                    double *out_coords)
+{
+  const double        ref_x = ref_coords[0];
+  const double        ref_y = ref_coords[1];
+
+  for (int i = 0; i < 3; i++) {
+    out_coords[i] =
+      (tree_vertices[3 + i] - tree_vertices[i]) * ref_x
+      + (tree_vertices[6 + i] - tree_vertices[3 + i]) * ref_y
+      + tree_vertices[i];
+  }
+}
+
+template <>
+inline void
+t8_geom_linear_evaluate_one < T8_ECLASS_QUAD > (const double *tree_vertices,
+                                                const double *ref_coords,
+                                                double *out_coords)
+{
+  const double        ref_x = ref_coords[0];
+  const double        ref_y = ref_coords[1];
+
+  /* The bilinear interpolation in the nesting order of
+   * t8_geom_linear_interpolation */
+  for (int i = 0; i < 3; i++) {
+    double              temp = tree_vertices[0 * 3 + i] * (1 - ref_x)
+      + tree_vertices[1 * 3 + i] * ref_x;
+    temp *= (1 - ref_y);
+    temp += (tree_vertices[2 * 3 + i] * (1 - ref_x)
+             + tree_vertices[3 * 3 + i] * ref_x) * ref_y;
+    out_coords[i] = temp;
+  }
+}
+
+template <>
+inline void
+t8_geom_linear_evaluate_one < T8_ECLASS_TET > (const double *tree_vertices,
+                                               const double *ref_coords,
+                                               double *out_coords)
+{
+  const double        ref_x = ref_coords[0];
+  const double        ref_y = ref_coords[1];
+  const double        ref_z = ref_coords[2];
+
+  for (int i = 0; i < 3; i++) {
+    out_coords[i] =
+      (tree_vertices[3 + i] - tree_vertices[i]) * ref_x
+      + (tree_vertices[9 + i] - tree_vertices[6 + i]) * ref_y
+      + (tree_vertices[6 + i] - tree_vertices[3 + i]) * ref_z
+      + tree_vertices[i];
+  }
+}
+
+template <>
+inline void
+t8_geom_linear_evaluate_one < T8_ECLASS_HEX > (const double *tree_vertices,
+                                               const double *ref_coords,
+                                               double *out_coords)
+{
+  const double        ref_x = ref_coords[0];
+  const double        ref_y = ref_coords[1];
+  const double        ref_z = ref_coords[2];
+
+  /* The trilinear interpolation in the nesting order of
+   * t8_geom_linear_interpolation */
+  for (int i = 0; i < 3; i++) {
+    double              temp = tree_vertices[0 * 3 + i] * (1 - ref_x)
+      + tree_vertices[1 * 3 + i] * ref_x;
+    temp *= (1 - ref_y);
+    temp += (tree_vertices[2 * 3 + i] * (1 - ref_x)
+             + tree_vertices[3 * 3 + i] * ref_x) * ref_y;
+    temp *= (1 - ref_z);
+    temp += (tree_vertices[4 * 3 + i] * (1 - ref_x) * (1 - ref_y)
+             + tree_vertices[5 * 3 + i] * ref_x * (1 - ref_y)
+             + tree_vertices[6 * 3 + i] * (1 - ref_x) * ref_y
+             + tree_vertices[7 * 3 + i] * ref_x * ref_y) * ref_z;
+    out_coords[i] = temp;
+  }
+}
+
+template <>
+inline void
+t8_geom_linear_evaluate_one < T8_ECLASS_PRISM > (const double *tree_vertices,
+                                                 const double *ref_coords,
+                                                 double *out_coords)
+{
+  const double        ref_x = ref_coords[0];
+  const double        ref_y = ref_coords[1];
+  const double        ref_z = ref_coords[2];
+  double              tri_vertices[9];
+
+  /* Lift the bottom triangle to the height of the point and interpolate
+   * inside it, as in t8_geom_compute_linear_geometry */
+  for (int i = 0; i < 9; i++) {
+    tri_vertices[i] =
+      (tree_vertices[9 + i] - tree_vertices[i]) * ref_z + tree_vertices[i];
+  }
+  for (int i = 0; i < 3; i++) {
+    out_coords[i] =
+      (tri_vertices[3 + i] - tri_vertices[i]) * ref_x
+      + (tri_vertices[6 + i] - tri_vertices[3 + i]) * ref_y
+      + tri_vertices[i];
+  }
+}
+
+template <>
+inline void
+t8_geom_linear_evaluate_one < T8_ECLASS_PYRAMID > (const double
+                                                   *tree_vertices,
+                                                   const double *ref_coords,
+                                                   double *out_coords)
+{
+  double              ray[3], lambda, quad_coords[3], length, length2;
+  int                 i;
+
+  length = 0;
+  length2 = 0;
+  quad_coords[2] = 0;
+
+  /* The tip of the pyramid maps to the tip vertex */
+  if (ref_coords[0] == 1. && ref_coords[1] == 1. && ref_coords[2] == 1.) {
+    for (i = 0; i < 3; i++) {
+      out_coords[i] = tree_vertices[12 + i];
+    }
+    return;
+  }
+  /* Project the point onto the x-y-plane along the ray through the tip */
+  for (i = 0; i < 3; i++) {
+    ray[i] = 1 - ref_coords[i];
+  }
+  lambda = ref_coords[2] / ray[2];
+  for (i = 0; i < 2; i++) {
+    quad_coords[i] = ref_coords[i] - lambda * ray[i];
+    length += (1 - quad_coords[i]) * (1 - quad_coords[i]);
+  }
+  length += 1;
+  for (i = 0; i < 3; i++) {
+    length2 +=
+      (ref_coords[i] - quad_coords[i]) * (ref_coords[i] - quad_coords[i]);
+  }
+  lambda = sqrt (length2) / sqrt (length);
+
+  /* Interpolate on the base quad and lift towards the tip */
+  t8_geom_linear_evaluate_one < T8_ECLASS_QUAD > (tree_vertices, quad_coords,
+                                                  out_coords);
+  for (i = 0; i < 3; i++) {
+    out_coords[i] += (tree_vertices[12 + i] - out_coords[i]) * lambda;
+  }
+}
+
+/** Map a batch of points from the reference space of a tree of class
+ * \a TEclass to physical space.
+ * \param [in]  tree_vertices The vertex coordinates of the tree.
+ * \param [in]  num_points    The number of points to map.
+ * \param [in]  ref_coords    \a num_points times dimension many reference
+ *                            coordinates, stored contiguously per point.
+ * \param [out] out_coords    \a num_points times 3 mapped coordinates.
+ */
+template < t8_eclass_t TEclass >
+inline void
+t8_geom_linear_evaluate_batch (const double *tree_vertices,
+                               size_t num_points, const double *ref_coords,
+                               double *out_coords)
+{
+  const size_t        dimension =
+    (size_t) t8_eclass_to_dimension[TEclass];
+
+  for (size_t ipoint = 0; ipoint < num_points; ipoint++) {
+    t8_geom_linear_evaluate_one < TEclass > (tree_vertices,
+                                             ref_coords +
+                                             dimension * ipoint,
+                                             out_coords + 3 * ipoint);
+  }
+}
+
+/** The type of a single point interpolation kernel,
+ * \see t8_geom_linear_evaluate_one. */
+typedef void        (*t8_geom_linear_point_fn) (const double *tree_vertices,
+                                                const double *ref_coords,
+                                                double *out_coords);
+
+/** The type of a batched interpolation kernel,
+ * \see t8_geom_linear_evaluate_batch. */
+typedef void        (*t8_geom_linear_batch_fn) (const double *tree_vertices,
+                                                size_t num_points,
+                                                const double *ref_coords,
+                                                double *out_coords);
+
+/** Return the single point interpolation kernel specialized for a tree
+ * class. The dispatch is intended to run once per tree.
+ * \param [in] eclass   The class of the tree.
+ * \return              The kernel instantiated for \a eclass.
+ */
+inline t8_geom_linear_point_fn
+t8_geom_linear_point_kernel (t8_eclass_t eclass)
+{
+  switch (eclass) {
+  case T8_ECLASS_VERTEX:
+    return t8_geom_linear_evaluate_one < T8_ECLASS_VERTEX >;
+  case T8_ECLASS_LINE:
+    return t8_geom_linear_evaluate_one < T8_ECLASS_LINE >;
+  case T8_ECLASS_QUAD:
+    return t8_geom_linear_evaluate_one < T8_ECLASS_QUAD >;
+  case T8_ECLASS_TRIANGLE:
+    return t8_geom_linear_evaluate_one < T8_ECLASS_TRIANGLE >;
+  case T8_ECLASS_HEX:
+    return t8_geom_linear_evaluate_one < T8_ECLASS_HEX >;
+  case T8_ECLASS_TET:
+    return t8_geom_linear_evaluate_one < T8_ECLASS_TET >;
+  case T8_ECLASS_PRISM:
+    return t8_geom_linear_evaluate_one < T8_ECLASS_PRISM >;
+  case T8_ECLASS_PYRAMID:
+    return t8_geom_linear_evaluate_one < T8_ECLASS_PYRAMID >;
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+}
+
+/** Return the batched interpolation kernel specialized for a tree class.
+ * The dispatch is intended to run once per tree.
+ * \param [in] eclass   The class of the tree.
+ * \return              The kernel instantiated for \a eclass.
+ */
+inline t8_geom_linear_batch_fn
+t8_geom_linear_batch_kernel (t8_eclass_t eclass)
+{
+  switch (eclass) {
+  case T8_ECLASS_VERTEX:
+    return t8_geom_linear_evaluate_batch < T8_ECLASS_VERTEX >;
+  case T8_ECLASS_LINE:
+    return t8_geom_linear_evaluate_batch < T8_ECLASS_LINE >;
+  case T8_ECLASS_QUAD:
+    return t8_geom_linear_evaluate_batch < T8_ECLASS_QUAD >;
+  case T8_ECLASS_TRIANGLE:
+    return t8_geom_linear_evaluate_batch < T8_ECLASS_TRIANGLE >;
+  case T8_ECLASS_HEX:
+    return t8_geom_linear_evaluate_batch < T8_ECLASS_HEX >;
+  case T8_ECLASS_TET:
+    return t8_geom_linear_evaluate_batch < T8_ECLASS_TET >;
+  case T8_ECLASS_PRISM:
+    return t8_geom_linear_evaluate_batch < T8_ECLASS_PRISM >;
+  case T8_ECLASS_PYRAMID:
+    return t8_geom_linear_evaluate_batch < T8_ECLASS_PYRAMID >;
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+}
+
+#endif /* !T8_GEOMETRY_HELPERS_TEMPLATES_HXX */
@@ -36,6 +36,7 @@ t8_geometry_analytic::t8_geometry_analytic (int dim, const char *name_in,
   dimension = dim;
 
   analytical_function = analytical;
+  analytical_batch_function = NULL;
   jacobian = jacobian_in;
   load_tree_data = load_tree_data_in;
   user_data = user_data_in;
@@ -61,6 +62,30 @@ t8_geometry_analytic::t8_geom_evaluate (t8_cmesh_t cmesh,
                        tree_data, user_data);
 }
 
+/**
+ * Map a batch of points in the reference space $$[0,1]^dimension$$ to $$\mathbb R^3$$.
+ * If a batched callback is registered it maps all points in one call,
+ * otherwise each point goes through the scalar function.
+ */
+/* *INDENT-OFF* */
+/* Indent has trouble with the const keyword at the end */
+void
+t8_geometry_analytic::t8_geom_evaluate_batch (t8_cmesh_t cmesh,
+                                              t8_gloidx_t gtreeid,
+                                              size_t num_points,
+                                              const double *ref_coords,
+                                              double *out_coords) const
+/* *INDENT-ON* */
+{
+  if (analytical_batch_function != NULL) {
+    analytical_batch_function (cmesh, gtreeid, num_points, ref_coords,
+                               out_coords, tree_data, user_data);
+    return;
+  }
+  t8_geometry::t8_geom_evaluate_batch (cmesh, gtreeid, num_points,
+                                       ref_coords, out_coords);
+}
+
 /**
  * Compute the jacobian of the \a t8_geom_evaluate map at a point in the reference space $$[0,1]^dimension$$.
  * \param [in]  gtreeid     The global tree (of the cmesh) in which the reference point is.
@@ -65,6 +65,31 @@ typedef void        (*t8_geom_analytic_jacobian_fn) (t8_cmesh_t cmesh,
                                                      const void *tree_data,
                                                      const void *user_data);
 
+/**
+ * Definition of a batched analytic geometry function.
+ * Maps \a num_points reference points to physical coordinates in one
+ * call, so the per point function pointer dispatch of
+ * \ref t8_geom_analytic_fn is paid once per batch and the callback body
+ * can vectorize over the points, for example via
+ * \ref t8_mat_mult_vec_batch.
+ * \param [in]  cmesh       The cmesh.
+ * \param [in]  gtreeid     The global tree (of the cmesh) in which the reference points are.
+ * \param [in]  num_points  The number of points to map.
+ * \param [in]  ref_coords  Array of \a num_points x \a dimension many entries, specifying
+ *                          \a num_points points in [0,1]^dimension, stored contiguously.
+ * \param [out] out_coords  Array of \a num_points x 3 entries. The mapped coordinates in
+ *                          physical space of the points in \a ref_coords.
+ * \param [in]  tree_data   The data of the current tree as loaded by a \ref t8_geom_load_tree_data_fn.
+ * \param [in]  user_data   The user data pointer stored in the geometry.
+ */
+typedef void        (*t8_geom_analytic_batch_fn) (t8_cmesh_t cmesh,
+                                                  t8_gloidx_t gtreeid,
+                                                  size_t num_points,
+                                                  const double *ref_coords,
+                                                  double *out_coords,
+                                                  const void *tree_data,
+                                                  const void *user_data);
+
 /* TODO: Document. */
 typedef void        (*t8_geom_load_tree_data_fn) (t8_cmesh_t cmesh,
                                                   t8_gloidx_t gtreeid,
@@ -109,6 +134,38 @@ public:
                                         const double *ref_coords,
                                         double out_coords[3]) const;
 
+  /**
+   * Map a batch of points in the reference space $$[0,1]^dimension$$ to $$\mathbb R^3$$.
+   * If a batch capable callback was registered via
+   * \ref t8_geom_analytic_set_batch_function, all points are mapped in a
+   * single call of it. Otherwise the base class loop over
+   * \ref t8_geom_evaluate is used.
+   * \param [in]  cmesh      The cmesh in which the points lie.
+   * \param [in]  gtreeid    The global tree (of the cmesh) in which the reference points are.
+   * \param [in]  num_points The number of points to map.
+   * \param [in]  ref_coords  Array of \a num_points x \a dimension many entries, specifying
+   *                          \a num_points points in [0,1]^dimension, stored contiguously.
+   * \param [out] out_coords  Array of \a num_points x 3 entries. The mapped coordinates in
+   *                          physical space of the points in \a ref_coords.
+   */
+  virtual void        t8_geom_evaluate_batch (t8_cmesh_t cmesh,
+                                              t8_gloidx_t gtreeid,
+                                              size_t num_points,
+                                              const double *ref_coords,
+                                              double *out_coords) const;
+
+  /** Register a batch capable analytic function.
+   * \param [in] batch_function The batched variant of the analytical
+   *                         function passed to the constructor, or NULL to
+   *                         fall back to per point evaluation. It must map
+   *                         every point exactly like the scalar function.
+   */
+  inline void         t8_geom_analytic_set_batch_function
+    (t8_geom_analytic_batch_fn batch_function)
+  {
+    analytical_batch_function = batch_function;
+  }
+
   /**
    * Compute the jacobian of the \a t8_geom_evaluate map at a point in the reference space $$[0,1]^dimension$$.
    * \param [in]  cmesh      The cmesh in which the point lies.
@@ -144,6 +201,9 @@ public:
 private:
   t8_geom_analytic_fn analytical_function; /**< The given analytical function. */
 
+  t8_geom_analytic_batch_fn analytical_batch_function; /**< Its batched variant, or NULL.
+                                           \see t8_geom_analytic_set_batch_function */
+
   t8_geom_analytic_jacobian_fn jacobian;   /**< Its jacobian. */
 
   t8_geom_load_tree_data_fn load_tree_data; /**< The function to load the tree data. */
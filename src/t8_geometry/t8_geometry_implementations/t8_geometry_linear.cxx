@@ -34,6 +34,8 @@ t8_geometry_w_vertices (dim, "")
   snprintf (name_tmp, num_chars, "t8_geom_linear_%i", dim);
   name = name_tmp;
   dimension = dim;
+  active_point_kernel = NULL;
+  active_batch_kernel = NULL;
 }
 
 t8_geometry_linear::~t8_geometry_linear ()
@@ -57,9 +59,33 @@ t8_geometry_linear::t8_geom_evaluate (t8_cmesh_t cmesh,
                                       double out_coords[3]) const
 /* *INDENT-ON* */
 {
-  t8_geom_compute_linear_geometry (active_tree_class,
-                                   active_tree_vertices, ref_coords,
-                                   out_coords);
+  /* The kernel was selected in t8_geom_load_tree_data and contains the
+   * fully unrolled interpolation of the active tree's class. */
+  T8_ASSERT (active_point_kernel != NULL);
+  active_point_kernel (active_tree_vertices, ref_coords, out_coords);
+}
+
+/**
+ * Map a batch of points in the reference space $$[0,1]^dimension$$ to $$\mathbb R^3$$.
+ * \param [in]  cmesh      The cmesh in which the points lie.
+ * \param [in]  gtreeid    The global tree (of the cmesh) in which the reference points are.
+ * \param [in]  num_points The number of points to map.
+ * \param [in]  ref_coords  Array of \a num_points x \a dimension many entries, stored contiguously.
+ * \param [out] out_coords  Array of \a num_points x 3 entries, the mapped coordinates.
+ */
+/* *INDENT-OFF* */
+/* indent adds second const */
+void
+t8_geometry_linear::t8_geom_evaluate_batch (t8_cmesh_t cmesh,
+                                            t8_gloidx_t gtreeid,
+                                            size_t num_points,
+                                            const double *ref_coords,
+                                            double *out_coords) const
+/* *INDENT-ON* */
+{
+  T8_ASSERT (active_batch_kernel != NULL);
+  active_batch_kernel (active_tree_vertices, num_points, ref_coords,
+                       out_coords);
 }
 
 /**
@@ -83,6 +109,18 @@ t8_geometry_linear::t8_geom_evalute_jacobian (t8_cmesh_t cmesh,
   SC_ABORT ("Not implemented.");
 }
 
+/* Load the vertices of the tree and select the interpolation kernels
+ * that are specialized for the tree's element class. The dispatch thus
+ * happens once per tree instead of once per evaluated point. */
+void
+t8_geometry_linear::t8_geom_load_tree_data (t8_cmesh_t cmesh,
+                                            t8_gloidx_t gtreeid)
+{
+  t8_geometry_w_vertices::t8_geom_load_tree_data (cmesh, gtreeid);
+  active_point_kernel = t8_geom_linear_point_kernel (active_tree_class);
+  active_batch_kernel = t8_geom_linear_batch_kernel (active_tree_class);
+}
+
 T8_EXTERN_C_BEGIN ();
 
 /* Satisfy the C interface from t8_geometry_linear.h.
@@ -29,6 +29,7 @@
 
 #include <t8.h>
 #include <t8_geometry/t8_geometry_base.hxx>
+#include <t8_geometry/t8_geometry_helpers_templates.hxx>
 
 struct t8_geometry_linear:public t8_geometry_w_vertices
 {
@@ -43,6 +44,8 @@ public:
    * Sets dimension and name to invalid values. */
                       t8_geometry_linear ():t8_geometry_w_vertices ()
   {
+    active_point_kernel = NULL;
+    active_batch_kernel = NULL;
   }
 
   /** The destructor. 
@@ -62,6 +65,22 @@ public:
                                         const double *ref_coords,
                                         double out_coords[3]) const;
 
+  /**
+   * Map a batch of points in the reference space $$[0,1]^dimension$$ to $$\mathbb R^3$$.
+   * The tree vertices are loaded once and the interpolation runs in a
+   * vectorizable loop over the points, \see t8_geometry::t8_geom_evaluate_batch.
+   * \param [in]  cmesh      The cmesh in which the points lie.
+   * \param [in]  gtreeid    The global tree (of the cmesh) in which the reference points are.
+   * \param [in]  num_points The number of points to map.
+   * \param [in]  ref_coords  Array of \a num_points x \a dimension many entries, stored contiguously.
+   * \param [out] out_coords  Array of \a num_points x 3 entries, the mapped coordinates.
+   */
+  virtual void        t8_geom_evaluate_batch (t8_cmesh_t cmesh,
+                                              t8_gloidx_t gtreeid,
+                                              size_t num_points,
+                                              const double *ref_coords,
+                                              double *out_coords) const;
+
   /**
    * Compute the jacobian of the \a t8_geom_evaluate map at a point in the reference space $$[0,1]^dimension$$.
    * \param [in]  cmesh      The cmesh in which the point lies.
@@ -75,8 +94,19 @@ public:
                                                 const double *ref_coords,
                                                 double *jacobian) const;
 
-  /* Load tree data is inherited from t8_geometry_w_vertices. */
+  /** Load the vertices of the tree like \ref t8_geometry_w_vertices and
+   * additionally select the compile-time specialized interpolation
+   * kernels of the tree's class, so that the per point evaluation
+   * performs no shape or dimension branches.
+   * \param [in]  cmesh      The cmesh.
+   * \param [in]  gtreeid    The global tree.
+   */
+  virtual void        t8_geom_load_tree_data (t8_cmesh_t cmesh,
+                                              t8_gloidx_t gtreeid);
 
+protected:
+  t8_geom_linear_point_fn active_point_kernel;  /**< The single point kernel of the active tree's class. */
+  t8_geom_linear_batch_fn active_batch_kernel;  /**< The batched kernel of the active tree's class. */
 };
 
 #endif /* !T8_GEOMETRY_LINEAR_HXX! */
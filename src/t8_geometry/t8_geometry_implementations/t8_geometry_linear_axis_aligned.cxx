@@ -62,6 +62,30 @@ t8_geometry_linear_axis_aligned::t8_geom_evaluate (t8_cmesh_t cmesh,
                                                 ref_coords, out_coords);
 }
 
+/**
+ * Map a batch of points in the reference space $$[0,1]^dimension$$ to $$\mathbb R^3$$.
+ * \param [in]  cmesh      The cmesh in which the points lie.
+ * \param [in]  gtreeid    The global tree (of the cmesh) in which the reference points are.
+ * \param [in]  num_points The number of points to map.
+ * \param [in]  ref_coords  Array of \a num_points x \a dimension many entries, stored contiguously.
+ * \param [out] out_coords  Array of \a num_points x 3 entries, the mapped coordinates.
+ */
+/* *INDENT-OFF* */
+/* indent adds second const */
+void
+t8_geometry_linear_axis_aligned::t8_geom_evaluate_batch (t8_cmesh_t cmesh,
+                                      t8_gloidx_t gtreeid,
+                                      size_t num_points,
+                                      const double *ref_coords,
+                                      double *out_coords) const
+/* *INDENT-ON* */
+{
+  t8_geom_compute_linear_axis_aligned_geometry_batch (active_tree_class,
+                                                      active_tree_vertices,
+                                                      num_points, ref_coords,
+                                                      out_coords);
+}
+
 /**
  * Compute the jacobian of the \a t8_geom_evaluate map at a point in the reference space $$[0,1]^dimension$$.
  * \param [in]  cmesh      The cmesh in which the point lies.
@@ -66,6 +66,22 @@ public:
                                         const double *ref_coords,
                                         double out_coords[3]) const;
 
+  /**
+   * Map a batch of points in the reference space $$[0,1]^dimension$$ to $$\mathbb R^3$$.
+   * The diagonal vector of the tree is computed once and the point loop is
+   * vectorizable, \see t8_geometry::t8_geom_evaluate_batch.
+   * \param [in]  cmesh      The cmesh in which the points lie.
+   * \param [in]  gtreeid    The global tree (of the cmesh) in which the reference points are.
+   * \param [in]  num_points The number of points to map.
+   * \param [in]  ref_coords  Array of \a num_points x \a dimension many entries, stored contiguously.
+   * \param [out] out_coords  Array of \a num_points x 3 entries, the mapped coordinates.
+   */
+  virtual void        t8_geom_evaluate_batch (t8_cmesh_t cmesh,
+                                              t8_gloidx_t gtreeid,
+                                              size_t num_points,
+                                              const double *ref_coords,
+                                              double *out_coords) const;
+
   /**
    * Compute the jacobian of the \a t8_geom_evaluate map at a point in the reference space $$[0,1]^dimension$$.
    * \param [in]  cmesh      The cmesh in which the point lies.
@@ -88,6 +88,7 @@ t8_geometry_occ::t8_geometry_occ (int dim, const char *fileprefix,
                                        occ_shape_vertex2edge_map);
   TopExp::MapShapesAndUniqueAncestors (occ_shape, TopAbs_EDGE, TopAbs_FACE,
                                        occ_shape_edge2face_map);
+  t8_geom_cache_shape_handles ();
 }
 
 t8_geometry_occ::t8_geometry_occ (int dim, const TopoDS_Shape occ_shape,
@@ -107,14 +108,63 @@ t8_geometry_occ::t8_geometry_occ (int dim, const TopoDS_Shape occ_shape,
                                        occ_shape_vertex2edge_map);
   TopExp::MapShapesAndUniqueAncestors (occ_shape, TopAbs_EDGE, TopAbs_FACE,
                                        occ_shape_edge2face_map);
+  t8_geom_cache_shape_handles ();
 }
 
+/* *INDENT-OFF* */
+void
+t8_geometry_occ::t8_geom_cache_shape_handles ()
+{
+  Standard_Real first, last;
+
+  /* Resolve the curve of each edge together with its parameter bounds.
+   * Index 0 of the caches is unused, since the occ maps are 1-based.
+   * Degenerated edges yield a null handle; the asserts at the usage sites
+   * catch accesses to them. */
+  occ_curve_cache.resize (occ_shape_edge_map.Size () + 1);
+  occ_curve_bounds.resize (2 * (occ_shape_edge_map.Size () + 1));
+  for (int iedge = 1; iedge <= occ_shape_edge_map.Size (); ++iedge) {
+    occ_curve_cache[iedge] =
+      BRep_Tool::Curve (TopoDS::Edge (occ_shape_edge_map.FindKey (iedge)),
+                        first, last);
+    occ_curve_bounds[2 * iedge] = first;
+    occ_curve_bounds[2 * iedge + 1] = last;
+  }
+  /* Resolve the surface of each face. */
+  occ_surface_cache.resize (occ_shape_face_map.Size () + 1);
+  for (int iface = 1; iface <= occ_shape_face_map.Size (); ++iface) {
+    occ_surface_cache[iface] =
+      BRep_Tool::Surface (TopoDS::Face (occ_shape_face_map.FindKey (iface)));
+  }
+  /* Resolve the curve-on-surface of each edge on each of its faces. */
+  for (int iedge = 1; iedge <= occ_shape_edge2face_map.Size (); ++iedge) {
+    const TopoDS_Edge edge =
+      TopoDS::Edge (occ_shape_edge2face_map.FindKey (iedge));
+    auto face_collection = occ_shape_edge2face_map.FindFromIndex (iedge);
+    for (auto face = face_collection.begin ();
+         face != face_collection.end (); ++face) {
+      const int iface = occ_shape_face_map.FindIndex (*face);
+      occ_curve_on_surface_cache[std::pair<int, int> (iedge, iface)] =
+        BRep_Tool::CurveOnSurface (edge, TopoDS::Face (*face), first, last);
+    }
+  }
+  surrogate_degree = 0;
+  active_surrogate = NULL;
+}
+/* *INDENT-ON* */
+
 void
 t8_geometry_occ::t8_geom_evaluate (t8_cmesh_t cmesh,
                                    t8_gloidx_t gtreeid,
                                    const double *ref_coords,
                                    double out_coords[3]) const
 {
+  if (active_surrogate != NULL) {
+    /* The active tree was sampled, interpolate the samples instead of
+     * querying the occ geometry. */
+    t8_geometry_occ::t8_geom_evaluate_surrogate (ref_coords, out_coords);
+    return;
+  }
   switch (active_tree_class) {
   case T8_ECLASS_QUAD:
     t8_geometry_occ::t8_geom_evaluate_occ_quad (cmesh, gtreeid, ref_coords,
@@ -163,6 +213,62 @@ t8_geometry_occ::t8_geom_evalute_jacobian (t8_cmesh_t cmesh,
   }
 }
 
+void
+t8_geometry_occ::t8_geom_evaluate_surrogate (const double *ref_coords,
+                                             double out_coords[3]) const
+{
+  const int           degree = surrogate_degree;
+  const int           num_nodes = degree + 1;
+  const int           num_nodes_z = dimension == 3 ? num_nodes : 1;
+  double              basis[3][T8_GEOMETRY_OCC_SURROGATE_MAX_DEGREE + 1];
+
+  T8_ASSERT (active_surrogate != NULL);
+  T8_ASSERT (0 < degree && degree <= T8_GEOMETRY_OCC_SURROGATE_MAX_DEGREE);
+  T8_ASSERT (dimension == 2 || dimension == 3);
+
+  /* Evaluate the Lagrange basis of each dimension at the respective
+   * reference coordinate. The interpolation nodes are equidistant,
+   * node i lies at i / degree. */
+  for (int dim = 0; dim < dimension; ++dim) {
+    for (int inode = 0; inode < num_nodes; ++inode) {
+      double              value = 1;
+      for (int jnode = 0; jnode < num_nodes; ++jnode) {
+        if (jnode != inode) {
+          value *= (ref_coords[dim] * degree - jnode) / (inode - jnode);
+        }
+      }
+      basis[dim][inode] = value;
+    }
+  }
+  /* Tensor product interpolation of the samples. The samples are stored
+   * with the x index running fastest. */
+  out_coords[0] = out_coords[1] = out_coords[2] = 0;
+  for (int iz = 0; iz < num_nodes_z; ++iz) {
+    for (int iy = 0; iy < num_nodes; ++iy) {
+      for (int ix = 0; ix < num_nodes; ++ix) {
+        const double        weight = basis[0][ix] * basis[1][iy]
+          * (dimension == 3 ? basis[2][iz] : 1);
+        const double       *sample =
+          active_surrogate + 3 * ((iz * num_nodes + iy) * num_nodes + ix);
+        out_coords[0] += weight * sample[0];
+        out_coords[1] += weight * sample[1];
+        out_coords[2] += weight * sample[2];
+      }
+    }
+  }
+}
+
+void
+t8_geometry_occ::t8_geom_set_surrogate (int degree)
+{
+  SC_CHECK_ABORTF (0 <= degree
+                   && degree <= T8_GEOMETRY_OCC_SURROGATE_MAX_DEGREE,
+                   "Invalid surrogate degree %i.", degree);
+  surrogate_degree = degree;
+  surrogate_samples.clear ();
+  active_surrogate = NULL;
+}
+
 inline void
 t8_geometry_occ::t8_geom_load_tree_data (t8_cmesh_t cmesh,
                                          t8_gloidx_t gtreeid)
@@ -176,6 +282,38 @@ t8_geometry_occ::t8_geom_load_tree_data (t8_cmesh_t cmesh,
                                                 gtreeid);
   T8_ASSERT (edges != NULL);
   T8_ASSERT (faces != NULL);
+  /* Deactivate the surrogate while we possibly sample this tree, so that
+   * t8_geom_evaluate queries the occ geometry. */
+  active_surrogate = NULL;
+  if (surrogate_degree > 0) {
+    T8_ASSERT (dimension == 2 || dimension == 3);
+    std::vector<double> &samples = surrogate_samples[gtreeid];
+    if (samples.empty ()) {
+      /* First time this tree is loaded with an active surrogate. Sample the
+       * occ geometry on an equidistant lattice with the x index running
+       * fastest. */
+      const int           num_nodes = surrogate_degree + 1;
+      const int           num_nodes_z = dimension == 3 ? num_nodes : 1;
+      double              ref_coords[3] = { 0, 0, 0 };
+      size_t              isample = 0;
+
+      samples.resize (3 * num_nodes_z * num_nodes * num_nodes);
+      for (int iz = 0; iz < num_nodes_z; ++iz) {
+        ref_coords[2] = (double) iz / surrogate_degree;
+        for (int iy = 0; iy < num_nodes; ++iy) {
+          ref_coords[1] = (double) iy / surrogate_degree;
+          for (int ix = 0; ix < num_nodes; ++ix) {
+            ref_coords[0] = (double) ix / surrogate_degree;
+            t8_geometry_occ::t8_geom_evaluate (cmesh, gtreeid, ref_coords,
+                                               &samples[isample]);
+            isample += 3;
+          }
+        }
+      }
+      T8_ASSERT (isample == samples.size ());
+    }
+    active_surrogate = samples.data ();
+  }
 }
 
 void
@@ -201,7 +339,6 @@ t8_geometry_occ::t8_geom_evaluate_occ_hex (t8_cmesh_t cmesh,
     temp_edge_vertices[2 * 3];
   Handle_Geom_Curve   curve;
   Handle_Geom_Surface surface;
-  Standard_Real       first, last;
 
   /* Check each edge for a geometry. */
   for (int i_edge = 0; i_edge < num_edges; ++i_edge) {
@@ -255,12 +392,8 @@ t8_geometry_occ::t8_geom_evaluate_occ_hex (t8_cmesh_t cmesh,
                                       parameters, 1, 1,
                                       &interpolated_curve_param);
 
-        /* *INDENT-OFF* */
         T8_ASSERT (edges[i_edge] <= occ_shape_edge_map.Size ());
-        curve =
-          BRep_Tool::Curve (TopoDS::Edge (occ_shape_edge_map.FindKey (edges[i_edge])),
-                                                                       first, last);
-        /* *INDENT-ON* */
+        curve = occ_curve_cache[edges[i_edge]];
 
         /* Check if curve are valid */
         T8_ASSERT (!curve.IsNull ());
@@ -275,10 +408,7 @@ t8_geometry_occ::t8_geom_evaluate_occ_hex (t8_cmesh_t cmesh,
                                       interpolated_surface_params);
 
         T8_ASSERT (edges[i_edge + num_edges] <= occ_shape_face_map.Size ());
-        surface =
-          BRep_Tool::Surface (TopoDS::Face
-                              (occ_shape_face_map.FindKey
-                               (edges[i_edge + num_edges])));
+        surface = occ_surface_cache[edges[i_edge + num_edges]];
 
         /* Check if surface is valid */
         T8_ASSERT (!surface.IsNull ());
@@ -408,10 +538,8 @@ t8_geometry_occ::t8_geom_evaluate_occ_hex (t8_cmesh_t cmesh,
           T8_ASSERT (edges[t8_face_edge_to_tree_edge[i_faces][i_face_edge]] <=
                      occ_shape_edge_map.Size ());
           curve =
-            BRep_Tool::Curve (TopoDS::Edge (occ_shape_edge_map.FindKey (edges
-                                                                        [t8_face_edge_to_tree_edge
-                                                                         [i_faces]
-                                                                         [i_face_edge]])), first, last);
+            occ_curve_cache[edges[t8_face_edge_to_tree_edge[i_faces]
+                                  [i_face_edge]]];
           /* Check if curve is valid */
           T8_ASSERT (!curve.IsNull ());
           /* Calculate point on curve with interpolated parameters */
@@ -507,12 +635,9 @@ t8_geometry_occ::t8_geom_evaluate_occ_hex (t8_cmesh_t cmesh,
           surface_parameter_displacement_from_edges[dim];
       }
 
-      /* *INDENT-OFF* */
       /* Retrieve the surface of the edge */
       T8_ASSERT (faces[i_faces] <= occ_shape_face_map.Size ());
-      surface =
-        BRep_Tool::Surface (TopoDS::Face (occ_shape_face_map.FindKey (faces[i_faces])));
-      /* *INDENT-ON* */
+      surface = occ_surface_cache[faces[i_faces]];
 
       /* Check if surface is valid */
       T8_ASSERT (!surface.IsNull ());
@@ -561,7 +686,6 @@ t8_geometry_occ::t8_geom_evaluate_occ_quad (t8_cmesh_t cmesh,
   gp_Pnt              pnt;
   Handle_Geom_Curve   curve;
   Handle_Geom_Surface surface;
-  Standard_Real       first, last;
   double              interpolated_coords[3],
     interpolated_curve_parameter, interpolated_surface_parameters[2];
 
@@ -612,13 +736,7 @@ t8_geometry_occ::t8_geom_evaluate_occ_quad (t8_cmesh_t cmesh,
                                              gtreeid);
         T8_ASSERT (edge_parameters != NULL);
         T8_ASSERT (edges[i_edge] <= occ_shape_edge_map.Size ());
-
-        /* *INDENT-OFF* */
-        curve =
-          BRep_Tool::Curve (TopoDS::
-                            Edge (occ_shape_edge_map.FindKey (edges[i_edge])),
-                            first, last);
-        /* *INDENT-ON* */
+        curve = occ_curve_cache[edges[i_edge]];
 
         /* Check if curve is valid */
         T8_ASSERT (!curve.IsNull ());
@@ -668,8 +786,7 @@ t8_geometry_occ::t8_geom_evaluate_occ_quad (t8_cmesh_t cmesh,
 
     /* Retrieve surface */
     T8_ASSERT (*faces <= occ_shape_face_map.Size ());
-    surface =
-      BRep_Tool::Surface (TopoDS::Face (occ_shape_face_map.FindKey (*faces)));
+    surface = occ_surface_cache[*faces];
 
     /* Check if surface is valid */
     T8_ASSERT (!surface.IsNull ());
@@ -733,12 +850,8 @@ t8_geometry_occ::t8_geom_evaluate_occ_quad (t8_cmesh_t cmesh,
                                         parameters, 1, 1,
                                         &interpolated_curve_parameter);
 
-          /* *INDENT-OFF* */
           T8_ASSERT (edges[i_edge] <= occ_shape_edge_map.Size ());
-          curve =
-            BRep_Tool::Curve (TopoDS:: Edge (occ_shape_edge_map.FindKey (edges[i_edge])), 
-                                                                         first, last);
-          /* *INDENT-ON* */
+          curve = occ_curve_cache[edges[i_edge]];
 
           /* Check if curve are valid */
           T8_ASSERT (!curve.IsNull ());
@@ -754,10 +867,7 @@ t8_geometry_occ::t8_geom_evaluate_occ_quad (t8_cmesh_t cmesh,
                                         interpolated_surface_parameters);
 
           T8_ASSERT (edges[i_edge + num_edges] <= occ_shape_face_map.Size ());
-          surface =
-            BRep_Tool::Surface (TopoDS::Face
-                                (occ_shape_face_map.FindKey
-                                 (edges[i_edge + num_edges])));
+          surface = occ_surface_cache[edges[i_edge + num_edges]];
 
           /* Check if surface is valid */
           T8_ASSERT (!surface.IsNull ());
@@ -800,16 +910,14 @@ const Handle_Geom_Curve
 t8_geometry_occ::t8_geom_get_occ_curve (const int index) const
 {
   T8_ASSERT (index <= occ_shape_edge_map.Size());
-  Standard_Real first, last;
-  return BRep_Tool::Curve(TopoDS::Edge(occ_shape_edge_map.FindKey(index)), 
-                          first, last);
+  return occ_curve_cache[index];
 }
 
 const Handle_Geom_Surface
 t8_geometry_occ::t8_geom_get_occ_surface (const int index) const
 {
   T8_ASSERT (index <= occ_shape_face_map.Size());
-  return BRep_Tool::Surface(TopoDS::Face(occ_shape_face_map.FindKey(index)));
+  return occ_surface_cache[index];
 }
 
 const TopTools_IndexedMapOfShape 
@@ -935,13 +1043,11 @@ t8_geometry_occ::t8_geom_edge_parameter_to_face_parameters(const int edge_index,
                                                            double* face_params) const
 {
   T8_ASSERT(t8_geometry_occ::t8_geom_is_edge_on_face(edge_index, face_index));
-  Standard_Real first, last;
   gp_Pnt2d uv;
-  TopoDS_Edge edge = TopoDS::Edge(occ_shape_edge_map.FindKey(edge_index));
-  TopoDS_Face face = TopoDS::Face(occ_shape_face_map.FindKey(face_index));
-  Handle_Geom2d_Curve curve_on_surface  = BRep_Tool::CurveOnSurface(edge, face, 
-                                                                    first, last);
-  curve_on_surface->D0(edge_param, uv);
+  auto curve_on_surface =
+    occ_curve_on_surface_cache.find(std::pair<int, int>(edge_index, face_index));
+  T8_ASSERT(curve_on_surface != occ_curve_on_surface_cache.end());
+  curve_on_surface->second->D0(edge_param, uv);
   face_params[0] = uv.X();
   face_params[1] = uv.Y();
 }
@@ -40,6 +40,13 @@
 #include <gp_Pnt.hxx>
 #include <Geom_Curve.hxx>
 #include <Geom_Surface.hxx>
+#include <Geom2d_Curve.hxx>
+#include <vector>
+#include <map>
+
+/** The maximum polynomial degree of the Lagrange surrogate of the occ
+ *  geometry. See \ref t8_geometry_occ::t8_geom_set_surrogate. */
+#define T8_GEOMETRY_OCC_SURROGATE_MAX_DEGREE 15
 
 #endif /* T8_WITH_OCC */
 
@@ -136,10 +143,25 @@ public:
    * \param [in]  cmesh      The cmesh.
    * \param [in]  gtreeid    The global tree.
    */
-  virtual void 
+  virtual void
   t8_geom_load_tree_data (t8_cmesh_t cmesh,
                           t8_gloidx_t gtreeid);
-  
+
+  /** Activate or deactivate the Lagrange surrogate of this geometry.
+   * With a degree > 0 each tree samples the occ geometry once on an
+   * equidistant (\a degree + 1)^dimension lattice when it is loaded for the
+   * first time and all further evaluations of the tree interpolate these
+   * samples with tensor product Lagrange polynomials instead of querying
+   * the occ geometry point by point. The surrogate is an approximation of
+   * the exact geometry; its accuracy is controlled by \a degree.
+   * Collected samples are discarded on every call.
+   * \param [in] degree     The polynomial degree of the surrogate. Must be
+   *                        between 0 and \ref T8_GEOMETRY_OCC_SURROGATE_MAX_DEGREE.
+   *                        0 deactivates the surrogate (the default).
+   */
+  void
+  t8_geom_set_surrogate (int degree);
+
   /** Get an occ point from the occ_shape.
    * \param [in] index      The index of the point in the occ_shape.
    * \return                The occ point.
@@ -286,6 +308,24 @@ private:
                             const double *ref_coords,
                             double out_coords[3]) const;
 
+  /** Resolve all curve, surface and curve-on-surface handles of the shape
+   * once and store them together with the curve parameter bounds.
+   * Called at the end of each constructor. The caches are read-only
+   * afterwards, so concurrent evaluations may share them safely.
+   */
+  void
+  t8_geom_cache_shape_handles ();
+
+  /** Map a point in the reference space to $$\mathbb R^3$$ by interpolating
+   * the surrogate samples of the currently active tree with tensor product
+   * Lagrange polynomials.
+   * \param [in]  ref_coords  Array of \a dimension many entries, specifying a point in [0,1]^dimension.
+   * \param [out] out_coords  The mapped coordinates in physical space of \a ref_coords.
+   */
+  void
+  t8_geom_evaluate_surrogate (const double *ref_coords,
+                              double out_coords[3]) const;
+
   const int                                  *edges;                      /**< The linked edges of the currently active tree. */
   const int                                  *faces;                      /**< The linked faces of the currently active tree. */
   TopoDS_Shape                                occ_shape;                  /**< Occ geometry */
@@ -294,6 +334,14 @@ private:
   TopTools_IndexedMapOfShape                  occ_shape_face_map;         /**< Map of all TopoDS_Face in shape. */
   TopTools_IndexedDataMapOfShapeListOfShape   occ_shape_vertex2edge_map;  /**< Maps all TopoDS_Vertex of shape to all its connected TopoDS_Edge */
   TopTools_IndexedDataMapOfShapeListOfShape   occ_shape_edge2face_map;    /**< Maps all TopoDS_Edge of shape to all its connected TopoDS_Face */
+  std::vector<Handle_Geom_Curve>              occ_curve_cache;            /**< Resolved curve handle of each edge in \a occ_shape_edge_map, indexed 1 to Size. */
+  std::vector<double>                         occ_curve_bounds;           /**< Parameter bounds (first, last) of each cached curve at indices 2i and 2i + 1. */
+  std::vector<Handle_Geom_Surface>            occ_surface_cache;          /**< Resolved surface handle of each face in \a occ_shape_face_map, indexed 1 to Size. */
+  std::map<std::pair<int, int>, Handle_Geom2d_Curve>
+                                              occ_curve_on_surface_cache; /**< Resolved curve-on-surface handle of each (edge index, face index) pair of the shape. */
+  int                                         surrogate_degree;           /**< Degree of the Lagrange surrogate. 0 if deactivated. \see t8_geom_set_surrogate. */
+  std::map<t8_gloidx_t, std::vector<double>>  surrogate_samples;          /**< Sampled geometry of each tree that was loaded with an active surrogate. */
+  const double                               *active_surrogate;           /**< Surrogate samples of the currently active tree or NULL. */
 };
 /* *INDENT-ON* */
 
@@ -0,0 +1,157 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_geometry/t8_geometry_implementations/t8_geometry_p4est.hxx>
+#include <t8_geometry/t8_geometry_implementations/t8_geometry_p4est.h>
+
+t8_geometry_p4est::t8_geometry_p4est (int dim, void *conn,
+                                      int own_connectivity):
+t8_geometry (dim, "")
+{
+  size_t              num_chars = 100;
+  char               *name_tmp = T8_ALLOC (char, num_chars);
+
+  T8_ASSERT (dim == 2 || dim == 3);
+  T8_ASSERT (conn != NULL);
+
+  snprintf (name_tmp, num_chars, "t8_geom_from_p4est_%i", dim);
+  name = name_tmp;
+  dimension = dim;
+  this->conn = conn;
+  this->own_connectivity = own_connectivity;
+  active_tree = -1;
+  /* The connectivity holds only quads (2d) or only hexes (3d), so the
+   * interpolation kernels can be selected once and for all */
+  point_kernel =
+    t8_geom_linear_point_kernel (dim == 2 ? T8_ECLASS_QUAD : T8_ECLASS_HEX);
+  batch_kernel =
+    t8_geom_linear_batch_kernel (dim == 2 ? T8_ECLASS_QUAD : T8_ECLASS_HEX);
+}
+
+t8_geometry_p4est::~t8_geometry_p4est ()
+{
+  if (own_connectivity) {
+    if (dimension == 2) {
+      p4est_connectivity_destroy ((p4est_connectivity_t *) conn);
+    }
+    else {
+      p8est_connectivity_destroy ((p8est_connectivity_t *) conn);
+    }
+  }
+  T8_FREE ((char *) name);
+}
+
+/* *INDENT-OFF* */
+/* indent adds second const */
+void
+t8_geometry_p4est::t8_geom_evaluate (t8_cmesh_t cmesh,
+                                     t8_gloidx_t gtreeid,
+                                     const double *ref_coords,
+                                     double out_coords[3]) const
+/* *INDENT-ON* */
+{
+  T8_ASSERT (gtreeid == active_tree);
+  point_kernel (active_tree_vertices, ref_coords, out_coords);
+}
+
+/* *INDENT-OFF* */
+/* indent adds second const */
+void
+t8_geometry_p4est::t8_geom_evaluate_batch (t8_cmesh_t cmesh,
+                                           t8_gloidx_t gtreeid,
+                                           size_t num_points,
+                                           const double *ref_coords,
+                                           double *out_coords) const
+/* *INDENT-ON* */
+{
+  T8_ASSERT (gtreeid == active_tree);
+  batch_kernel (active_tree_vertices, num_points, ref_coords, out_coords);
+}
+
+/* *INDENT-OFF* */
+/* indent adds second const */
+void
+t8_geometry_p4est::t8_geom_evalute_jacobian (t8_cmesh_t cmesh,
+                                             t8_gloidx_t gtreeid,
+                                             const double *ref_coords,
+                                             double *jacobian) const
+/* *INDENT-ON* */
+{
+  SC_ABORT ("Not implemented.");
+}
+
+void
+t8_geometry_p4est::t8_geom_load_tree_data (t8_cmesh_t cmesh,
+                                           t8_gloidx_t gtreeid)
+{
+  const double       *conn_vertices;
+  const p4est_topidx_t *tree_to_vertex;
+  p4est_topidx_t      vertex_id;
+  int                 num_corners, icorner;
+
+  T8_ASSERT (0 <= gtreeid);
+  num_corners = 1 << dimension;
+  if (dimension == 2) {
+    const p4est_connectivity_t *conn2 = (const p4est_connectivity_t *) conn;
+
+    T8_ASSERT (gtreeid < (t8_gloidx_t) conn2->num_trees);
+    conn_vertices = conn2->vertices;
+    tree_to_vertex = conn2->tree_to_vertex;
+  }
+  else {
+    const p8est_connectivity_t *conn3 = (const p8est_connectivity_t *) conn;
+
+    T8_ASSERT (gtreeid < (t8_gloidx_t) conn3->num_trees);
+    conn_vertices = conn3->vertices;
+    tree_to_vertex = conn3->tree_to_vertex;
+  }
+  /* The corner numbering of p4est/p8est trees matches the vertex
+   * numbering of t8code quads and hexes, so we can copy in order */
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    vertex_id = tree_to_vertex[num_corners * gtreeid + icorner];
+    active_tree_vertices[3 * icorner] = conn_vertices[3 * vertex_id];
+    active_tree_vertices[3 * icorner + 1] = conn_vertices[3 * vertex_id + 1];
+    active_tree_vertices[3 * icorner + 2] = conn_vertices[3 * vertex_id + 2];
+  }
+  active_tree = gtreeid;
+}
+
+T8_EXTERN_C_BEGIN ();
+
+/* Satisfy the C interface from t8_geometry_p4est.h. */
+t8_geometry_c      *
+t8_geometry_from_p4est_new (p4est_connectivity_t *conn, int own_connectivity)
+{
+  t8_geometry_p4est  *geom =
+    new t8_geometry_p4est (2, (void *) conn, own_connectivity);
+  return (t8_geometry_c *) geom;
+}
+
+t8_geometry_c      *
+t8_geometry_from_p8est_new (p8est_connectivity_t *conn, int own_connectivity)
+{
+  t8_geometry_p4est  *geom =
+    new t8_geometry_p4est (3, (void *) conn, own_connectivity);
+  return (t8_geometry_c *) geom;
+}
+
+T8_EXTERN_C_END ();
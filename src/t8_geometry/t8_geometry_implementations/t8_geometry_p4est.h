@@ -0,0 +1,63 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_geometry_p4est.h
+ * This header provides the C interface to create a geometry that reads
+ * its vertex coordinates directly from a p4est/p8est connectivity,
+ * \see t8_geometry_p4est.hxx.
+ */
+
+#ifndef T8_GEOMETRY_P4EST_H
+#define T8_GEOMETRY_P4EST_H
+
+#include <t8.h>
+#include <t8_geometry/t8_geometry.h>
+#include <p4est_connectivity.h>
+#include <p8est_connectivity.h>
+
+T8_EXTERN_C_BEGIN ();
+
+/** Create a geometry that evaluates the bilinear map of the trees of a
+ * p4est connectivity, referencing the connectivity's vertex arrays in
+ * place instead of copying them into the cmesh.
+ * \param [in] conn             The connectivity. Must stay valid and
+ *                              unchanged for the lifetime of the geometry.
+ * \param [in] own_connectivity If true, the geometry takes ownership of
+ *                              \a conn and destroys it together with the
+ *                              cmesh the geometry is registered at.
+ * \return     A pointer to an allocated t8_geometry_p4est struct.
+ */
+t8_geometry_c      *t8_geometry_from_p4est_new (p4est_connectivity_t *conn,
+                                                int own_connectivity);
+
+/** Create a geometry that evaluates the trilinear map of the trees of a
+ * p8est connectivity, \see t8_geometry_from_p4est_new.
+ * \param [in] conn             The connectivity.
+ * \param [in] own_connectivity If true, the geometry takes ownership.
+ * \return     A pointer to an allocated t8_geometry_p4est struct.
+ */
+t8_geometry_c      *t8_geometry_from_p8est_new (p8est_connectivity_t *conn,
+                                                int own_connectivity);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_GEOMETRY_P4EST_H! */
@@ -0,0 +1,121 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_geometry_p4est.hxx
+ * A linear geometry that reads its vertex coordinates directly from a
+ * p4est/p8est connectivity instead of per tree vertex attributes of the
+ * cmesh. It is the geometry behind the zero-copy connectivity bridge
+ * \ref t8_cmesh_new_from_p4est_shared: the connectivity's vertices and
+ * tree_to_vertex arrays are referenced in place, so the vertex data
+ * exists only once in memory no matter how many trees share it.
+ */
+
+#ifndef T8_GEOMETRY_P4EST_HXX
+#define T8_GEOMETRY_P4EST_HXX
+
+#include <t8.h>
+#include <t8_geometry/t8_geometry_base.hxx>
+#include <t8_geometry/t8_geometry_helpers_templates.hxx>
+#include <p4est_connectivity.h>
+#include <p8est_connectivity.h>
+
+struct t8_geometry_p4est:public t8_geometry
+{
+public:
+
+  /** Construct a geometry that evaluates the trilinear (resp. bilinear)
+   * map of the trees of a p4est/p8est connectivity.
+   * \param [in] dim              2 for a p4est_connectivity_t,
+   *                              3 for a p8est_connectivity_t.
+   * \param [in] conn             The connectivity. It is referenced in
+   *                              place and must stay valid and unchanged
+   *                              for the lifetime of this geometry.
+   * \param [in] own_connectivity If true, the geometry takes ownership
+   *                              and destroys \a conn in its destructor.
+   */
+  t8_geometry_p4est (int dim, void *conn, int own_connectivity);
+
+  /** The destructor. Destroys the connectivity if the geometry owns it. */
+  virtual ~           t8_geometry_p4est ();
+
+  /**
+   * Map a point in the reference space $$[0,1]^dimension$$ to $$\mathbb R^3$$
+   * by the bi-/trilinear map of the active tree.
+   * \param [in]  cmesh      The cmesh in which the point lies.
+   * \param [in]  gtreeid    The global tree (of the cmesh) in which the reference point is.
+   * \param [in]  ref_coords  Array of \a dimension many entries, specifying a point in [0,1]^dimension.
+   * \param [out] out_coords  The mapped coordinates in physical space of \a ref_coords.
+   */
+  virtual void        t8_geom_evaluate (t8_cmesh_t cmesh,
+                                        t8_gloidx_t gtreeid,
+                                        const double *ref_coords,
+                                        double out_coords[3]) const;
+
+  /**
+   * Map a batch of points in the reference space $$[0,1]^dimension$$ to $$\mathbb R^3$$,
+   * \see t8_geometry_linear::t8_geom_evaluate_batch.
+   * \param [in]  cmesh      The cmesh in which the points lie.
+   * \param [in]  gtreeid    The global tree (of the cmesh) in which the reference points are.
+   * \param [in]  num_points The number of points to map.
+   * \param [in]  ref_coords  Array of \a num_points x \a dimension many entries, stored contiguously.
+   * \param [out] out_coords  Array of \a num_points x 3 entries, the mapped coordinates.
+   */
+  virtual void        t8_geom_evaluate_batch (t8_cmesh_t cmesh,
+                                              t8_gloidx_t gtreeid,
+                                              size_t num_points,
+                                              const double *ref_coords,
+                                              double *out_coords) const;
+
+  /**
+   * Compute the jacobian of the \a t8_geom_evaluate map at a point in the reference space $$[0,1]^dimension$$.
+   * \param [in]  cmesh      The cmesh in which the point lies.
+   * \param [in]  gtreeid    The global tree (of the cmesh) in which the reference point is.
+   * \param [in]  ref_coords  Array of \a dimension many entries, specifying a point in [0,1]^dimension.
+   * \param [out] jacobian    The jacobian at \a ref_coords. Array of size dimension x 3. Indices 3*i, 3*i+1, 3*i+2
+   *                          correspond to the i-th column of the jacobian (Entry 3*i + j is del f_j/del x_i).
+   */
+  virtual void        t8_geom_evalute_jacobian (t8_cmesh_t cmesh,
+                                                t8_gloidx_t gtreeid,
+                                                const double *ref_coords,
+                                                double *jacobian) const;
+
+  /** Gather the corner coordinates of the tree from the connectivity's
+   * vertices and tree_to_vertex arrays into the internal corner buffer.
+   * The per tree indirection thus happens once per tree instead of once
+   * per evaluated point, and no vertex data is stored in the cmesh.
+   * \param [in]  cmesh      The cmesh.
+   * \param [in]  gtreeid    The global tree. Must be a valid tree index
+   *                         of the connectivity.
+   */
+  virtual void        t8_geom_load_tree_data (t8_cmesh_t cmesh,
+                                              t8_gloidx_t gtreeid);
+
+protected:
+  void               *conn;     /**< The p4est/p8est connectivity, referenced in place. */
+  int                 own_connectivity; /**< If true, \a conn is destroyed in the destructor. */
+  t8_gloidx_t         active_tree;      /**< The tree whose corners are currently loaded. */
+  double              active_tree_vertices[24]; /**< The corner coordinates of the active tree. */
+  t8_geom_linear_point_fn point_kernel; /**< The single point interpolation kernel (quad or hex). */
+  t8_geom_linear_batch_fn batch_kernel; /**< The batched interpolation kernel (quad or hex). */
+};
+
+#endif /* !T8_GEOMETRY_P4EST_HXX! */
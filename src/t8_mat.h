@@ -28,6 +28,7 @@
 #define T8_MAT_H
 
 #include <math.h>
+#include <stddef.h>
 
 /** Initialize given 3x3 matrix as rotation matrix around the x-axis with given angle.
  * \param [in,out]      mat     3x3-matrix.
@@ -111,6 +112,62 @@ t8_mat_mult_vec (const double mat[3][3], const double a[3], double b[3])
   b[2] = mat[2][0] * a[0] + mat[2][1] * a[1] + mat[2][2] * a[2];
 }
 
+/** Apply one 3x3 matrix to a batch of vectors: b_i = M*a_i.
+ * The vectors are stored contiguously as xyz triples. The loop body is
+ * free of function calls and aliasing, so the compiler can unroll and
+ * fuse the multiply-adds; for large batches this replaces one call per
+ * point by one call per batch.
+ * \param [in]        mat   3x3-matrix.
+ * \param [in]        a     Array of 3 * \a num_vecs entries, \a num_vecs
+ *                          input vectors.
+ * \param [in,out]    b     Array of 3 * \a num_vecs entries. On output the
+ *                          i-th triple holds M times the i-th input vector.
+ *                          May not overlap \a a.
+ * \param [in]        num_vecs The number of vectors.
+ */
+static inline void
+t8_mat_mult_vec_batch (const double mat[3][3], const double *a, double *b,
+                       const size_t num_vecs)
+{
+  for (size_t ivec = 0; ivec < num_vecs; ivec++) {
+    const double        a0 = a[3 * ivec];
+    const double        a1 = a[3 * ivec + 1];
+    const double        a2 = a[3 * ivec + 2];
+
+    b[3 * ivec] = mat[0][0] * a0 + mat[0][1] * a1 + mat[0][2] * a2;
+    b[3 * ivec + 1] = mat[1][0] * a0 + mat[1][1] * a1 + mat[1][2] * a2;
+    b[3 * ivec + 2] = mat[2][0] * a0 + mat[2][1] * a1 + mat[2][2] * a2;
+  }
+}
+
+/** Apply one 3x3 matrix to a batch of vectors in structure-of-arrays
+ * layout: (bx_i, by_i, bz_i) = M*(ax_i, ay_i, az_i).
+ * With each component in its own contiguous array every load and store is
+ * unit stride, which lets the compiler emit packed vector instructions
+ * across the batch.
+ * \param [in]        mat   3x3-matrix.
+ * \param [in]        ax,ay,az Arrays of \a num_vecs input components.
+ * \param [in,out]    bx,by,bz Arrays of \a num_vecs output components.
+ *                          May not overlap the input arrays.
+ * \param [in]        num_vecs The number of vectors.
+ */
+static inline void
+t8_mat_mult_vec_soa (const double mat[3][3],
+                     const double *ax, const double *ay, const double *az,
+                     double *bx, double *by, double *bz,
+                     const size_t num_vecs)
+{
+  for (size_t ivec = 0; ivec < num_vecs; ivec++) {
+    const double        a0 = ax[ivec];
+    const double        a1 = ay[ivec];
+    const double        a2 = az[ivec];
+
+    bx[ivec] = mat[0][0] * a0 + mat[0][1] * a1 + mat[0][2] * a2;
+    by[ivec] = mat[1][0] * a0 + mat[1][1] * a1 + mat[1][2] * a2;
+    bz[ivec] = mat[2][0] * a0 + mat[2][1] * a1 + mat[2][2] * a2;
+  }
+}
+
 /** Apply matrix-matrix multiplication: C = A*B.
  * \param [in]        A     3x3-matrix.
  * \param [in]        B     3x3-matrix.
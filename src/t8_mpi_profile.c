@@ -0,0 +1,398 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_mpi_profile.h>
+
+/* The number of log2 microsecond buckets of the wait time histogram.
+ * The last bucket collects everything from 2^30 microseconds on. */
+#define T8_MPI_PROFILE_WAIT_BUCKETS 31
+
+/* The recorded counters of one communication phase. The peer arrays
+ * are allocated lazily on the first recorded message and sized by the
+ * communicator of that message; all t8code phases communicate over the
+ * communicator of their forest or cmesh. */
+typedef struct t8_mpi_profile_stats
+{
+  int                 num_peers;        /**< Size of the peer arrays, 0 if not allocated. */
+  long long          *bytes_sent;       /**< Per peer bytes sent. */
+  long long          *msgs_sent;        /**< Per peer messages sent. */
+  long long          *bytes_recvd;      /**< Per peer bytes received (posted sizes). */
+  long long          *msgs_recvd;       /**< Per peer messages received. */
+  long long           collective_calls; /**< Number of collective calls. */
+  long long           collective_bytes; /**< Bytes contributed to collectives. */
+  double              wait_seconds;     /**< Total time spent blocking. */
+  long long           wait_hist[T8_MPI_PROFILE_WAIT_BUCKETS];  /**< Histogram of
+                                          individual blocking times in log2
+                                          microsecond buckets. */
+} t8_mpi_profile_stats_t;
+
+static int          t8_mpi_profile_enabled = 0;
+static t8_mpi_profile_stats_t t8_mpi_profile_stats[T8_MPI_PROFILE_NUM_PHASES];
+
+static const char  *t8_mpi_profile_phase_names[T8_MPI_PROFILE_NUM_PHASES] = {
+  "ghost", "partition", "cmesh_partition", "shmem", "other"
+};
+
+void
+t8_mpi_profile_enable (void)
+{
+  t8_mpi_profile_enabled = 1;
+}
+
+void
+t8_mpi_profile_disable (void)
+{
+  t8_mpi_profile_enabled = 0;
+}
+
+int
+t8_mpi_profile_is_enabled (void)
+{
+  return t8_mpi_profile_enabled;
+}
+
+void
+t8_mpi_profile_reset (void)
+{
+  int                 iphase;
+
+  for (iphase = 0; iphase < T8_MPI_PROFILE_NUM_PHASES; iphase++) {
+    t8_mpi_profile_stats_t *stats = &t8_mpi_profile_stats[iphase];
+    T8_FREE (stats->bytes_sent);
+    T8_FREE (stats->msgs_sent);
+    T8_FREE (stats->bytes_recvd);
+    T8_FREE (stats->msgs_recvd);
+    memset (stats, 0, sizeof (*stats));
+  }
+}
+
+/* Determine the size in bytes of the datatypes that t8code's
+ * communication routines use. Unknown types are counted as zero bytes,
+ * so their traffic still appears in the message counts. */
+static size_t
+t8_mpi_profile_type_size (sc_MPI_Datatype datatype)
+{
+  if (datatype == sc_MPI_BYTE) {
+    return 1;
+  }
+  if (datatype == sc_MPI_INT) {
+    /* Also covers T8_MPI_LOCIDX */
+    return sizeof (int);
+  }
+  if (datatype == sc_MPI_DOUBLE) {
+    return sizeof (double);
+  }
+  if (datatype == sc_MPI_LONG_LONG_INT) {
+    /* Also covers T8_MPI_GLOIDX */
+    return sizeof (long long);
+  }
+  if (datatype == sc_MPI_UNSIGNED_LONG_LONG) {
+    /* Also covers T8_MPI_LINEARIDX */
+    return sizeof (unsigned long long);
+  }
+  return 0;
+}
+
+/* Ensure that the peer arrays of a phase cover the ranks of \a comm. */
+static t8_mpi_profile_stats_t *
+t8_mpi_profile_get_stats (t8_mpi_profile_phase_t phase, sc_MPI_Comm comm)
+{
+  t8_mpi_profile_stats_t *stats;
+  int                 mpisize, mpiret;
+
+  T8_ASSERT (0 <= phase && phase < T8_MPI_PROFILE_NUM_PHASES);
+  stats = &t8_mpi_profile_stats[phase];
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  if (mpisize > stats->num_peers) {
+    /* Grow the peer arrays. Different communicator sizes within one
+     * phase are merged by rank number. */
+    stats->bytes_sent = T8_REALLOC (stats->bytes_sent, long long, mpisize);
+    stats->msgs_sent = T8_REALLOC (stats->msgs_sent, long long, mpisize);
+    stats->bytes_recvd = T8_REALLOC (stats->bytes_recvd, long long, mpisize);
+    stats->msgs_recvd = T8_REALLOC (stats->msgs_recvd, long long, mpisize);
+    memset (stats->bytes_sent + stats->num_peers, 0,
+            (mpisize - stats->num_peers) * sizeof (long long));
+    memset (stats->msgs_sent + stats->num_peers, 0,
+            (mpisize - stats->num_peers) * sizeof (long long));
+    memset (stats->bytes_recvd + stats->num_peers, 0,
+            (mpisize - stats->num_peers) * sizeof (long long));
+    memset (stats->msgs_recvd + stats->num_peers, 0,
+            (mpisize - stats->num_peers) * sizeof (long long));
+    stats->num_peers = mpisize;
+  }
+  return stats;
+}
+
+static void
+t8_mpi_profile_record_send (t8_mpi_profile_phase_t phase, sc_MPI_Comm comm,
+                            int dest, int count, sc_MPI_Datatype datatype)
+{
+  t8_mpi_profile_stats_t *stats = t8_mpi_profile_get_stats (phase, comm);
+
+  T8_ASSERT (0 <= dest && dest < stats->num_peers);
+  stats->bytes_sent[dest] +=
+    (long long) count *(long long) t8_mpi_profile_type_size (datatype);
+  stats->msgs_sent[dest]++;
+}
+
+static void
+t8_mpi_profile_record_recv (t8_mpi_profile_phase_t phase, sc_MPI_Comm comm,
+                            int source, int count, sc_MPI_Datatype datatype)
+{
+  t8_mpi_profile_stats_t *stats = t8_mpi_profile_get_stats (phase, comm);
+
+  if (source < 0 || source >= stats->num_peers) {
+    /* sc_MPI_ANY_SOURCE; the peer is not known when the receive is
+     * posted, so the message is not attributed */
+    return;
+  }
+  stats->bytes_recvd[source] +=
+    (long long) count *(long long) t8_mpi_profile_type_size (datatype);
+  stats->msgs_recvd[source]++;
+}
+
+static void
+t8_mpi_profile_record_wait (t8_mpi_profile_phase_t phase, double seconds)
+{
+  t8_mpi_profile_stats_t *stats;
+  double              usec;
+  int                 bucket;
+
+  T8_ASSERT (0 <= phase && phase < T8_MPI_PROFILE_NUM_PHASES);
+  stats = &t8_mpi_profile_stats[phase];
+  stats->wait_seconds += seconds;
+  /* Find the log2 bucket of the blocking time in microseconds */
+  usec = seconds * 1.e6;
+  for (bucket = 0; bucket < T8_MPI_PROFILE_WAIT_BUCKETS - 1
+       && usec >= (double) (1LL << (bucket + 1)); bucket++) {
+  }
+  stats->wait_hist[bucket]++;
+}
+
+static void
+t8_mpi_profile_record_collective (t8_mpi_profile_phase_t phase, int count,
+                                  sc_MPI_Datatype datatype)
+{
+  t8_mpi_profile_stats_t *stats;
+
+  T8_ASSERT (0 <= phase && phase < T8_MPI_PROFILE_NUM_PHASES);
+  stats = &t8_mpi_profile_stats[phase];
+  stats->collective_calls++;
+  stats->collective_bytes +=
+    (long long) count *(long long) t8_mpi_profile_type_size (datatype);
+}
+
+void
+t8_mpi_profile_dump (void)
+{
+  int                 iphase, ipeer, bucket;
+
+  for (iphase = 0; iphase < T8_MPI_PROFILE_NUM_PHASES; iphase++) {
+    const t8_mpi_profile_stats_t *stats = &t8_mpi_profile_stats[iphase];
+    if (stats->num_peers == 0 && stats->collective_calls == 0
+        && stats->wait_seconds == 0) {
+      continue;
+    }
+    t8_productionf ("comm matrix phase %s:\n",
+                    t8_mpi_profile_phase_names[iphase]);
+    for (ipeer = 0; ipeer < stats->num_peers; ipeer++) {
+      if (stats->msgs_sent[ipeer] == 0 && stats->msgs_recvd[ipeer] == 0) {
+        continue;
+      }
+      t8_productionf ("  peer %d: sent %lld bytes in %lld messages, "
+                      "received %lld bytes in %lld messages\n", ipeer,
+                      stats->bytes_sent[ipeer], stats->msgs_sent[ipeer],
+                      stats->bytes_recvd[ipeer], stats->msgs_recvd[ipeer]);
+    }
+    if (stats->collective_calls > 0) {
+      t8_productionf ("  collectives: %lld calls, %lld bytes contributed\n",
+                      stats->collective_calls, stats->collective_bytes);
+    }
+    if (stats->wait_seconds > 0) {
+      t8_productionf ("  wait time: %g seconds\n", stats->wait_seconds);
+      for (bucket = 0; bucket < T8_MPI_PROFILE_WAIT_BUCKETS; bucket++) {
+        if (stats->wait_hist[bucket] == 0) {
+          continue;
+        }
+        t8_productionf ("  wait [%lld us, %lld us): %lld\n",
+                        bucket == 0 ? 0LL : (1LL << bucket),
+                        1LL << (bucket + 1), stats->wait_hist[bucket]);
+      }
+    }
+  }
+}
+
+int
+t8_mpi_profile_isend (void *buf, int count, sc_MPI_Datatype datatype,
+                      int dest, int tag, sc_MPI_Comm comm,
+                      sc_MPI_Request *request, t8_mpi_profile_phase_t phase)
+{
+  if (t8_mpi_profile_enabled) {
+    t8_mpi_profile_record_send (phase, comm, dest, count, datatype);
+  }
+  return sc_MPI_Isend (buf, count, datatype, dest, tag, comm, request);
+}
+
+int
+t8_mpi_profile_irecv (void *buf, int count, sc_MPI_Datatype datatype,
+                      int source, int tag, sc_MPI_Comm comm,
+                      sc_MPI_Request *request, t8_mpi_profile_phase_t phase)
+{
+  if (t8_mpi_profile_enabled) {
+    t8_mpi_profile_record_recv (phase, comm, source, count, datatype);
+  }
+  return sc_MPI_Irecv (buf, count, datatype, source, tag, comm, request);
+}
+
+int
+t8_mpi_profile_send (void *buf, int count, sc_MPI_Datatype datatype,
+                     int dest, int tag, sc_MPI_Comm comm,
+                     t8_mpi_profile_phase_t phase)
+{
+  if (t8_mpi_profile_enabled) {
+    t8_mpi_profile_record_send (phase, comm, dest, count, datatype);
+  }
+  return sc_MPI_Send (buf, count, datatype, dest, tag, comm);
+}
+
+int
+t8_mpi_profile_recv (void *buf, int count, sc_MPI_Datatype datatype,
+                     int source, int tag, sc_MPI_Comm comm,
+                     sc_MPI_Status *status, t8_mpi_profile_phase_t phase)
+{
+  double              wait;
+  int                 mpiret;
+
+  if (!t8_mpi_profile_enabled) {
+    return sc_MPI_Recv (buf, count, datatype, source, tag, comm, status);
+  }
+  wait = -sc_MPI_Wtime ();
+  mpiret = sc_MPI_Recv (buf, count, datatype, source, tag, comm, status);
+  wait += sc_MPI_Wtime ();
+  t8_mpi_profile_record_recv (phase, comm, source, count, datatype);
+  t8_mpi_profile_record_wait (phase, wait);
+  return mpiret;
+}
+
+int
+t8_mpi_profile_probe (int source, int tag, sc_MPI_Comm comm,
+                      sc_MPI_Status *status, t8_mpi_profile_phase_t phase)
+{
+  double              wait;
+  int                 mpiret;
+
+  if (!t8_mpi_profile_enabled) {
+    return sc_MPI_Probe (source, tag, comm, status);
+  }
+  wait = -sc_MPI_Wtime ();
+  mpiret = sc_MPI_Probe (source, tag, comm, status);
+  wait += sc_MPI_Wtime ();
+  t8_mpi_profile_record_wait (phase, wait);
+  return mpiret;
+}
+
+int
+t8_mpi_profile_wait (sc_MPI_Request *request, sc_MPI_Status *status,
+                     t8_mpi_profile_phase_t phase)
+{
+  double              wait;
+  int                 mpiret;
+
+  if (!t8_mpi_profile_enabled) {
+    return sc_MPI_Wait (request, status);
+  }
+  wait = -sc_MPI_Wtime ();
+  mpiret = sc_MPI_Wait (request, status);
+  wait += sc_MPI_Wtime ();
+  t8_mpi_profile_record_wait (phase, wait);
+  return mpiret;
+}
+
+int
+t8_mpi_profile_waitall (int count, sc_MPI_Request *requests,
+                        sc_MPI_Status *statuses, t8_mpi_profile_phase_t phase)
+{
+  double              wait;
+  int                 mpiret;
+
+  if (!t8_mpi_profile_enabled) {
+    return sc_MPI_Waitall (count, requests, statuses);
+  }
+  wait = -sc_MPI_Wtime ();
+  mpiret = sc_MPI_Waitall (count, requests, statuses);
+  wait += sc_MPI_Wtime ();
+  t8_mpi_profile_record_wait (phase, wait);
+  return mpiret;
+}
+
+int
+t8_mpi_profile_allgather (void *sendbuf, int sendcount,
+                          sc_MPI_Datatype sendtype, void *recvbuf,
+                          int recvcount, sc_MPI_Datatype recvtype,
+                          sc_MPI_Comm comm, t8_mpi_profile_phase_t phase)
+{
+  if (t8_mpi_profile_enabled) {
+    t8_mpi_profile_record_collective (phase, sendcount, sendtype);
+  }
+  return sc_MPI_Allgather (sendbuf, sendcount, sendtype, recvbuf, recvcount,
+                           recvtype, comm);
+}
+
+int
+t8_mpi_profile_allgatherv (void *sendbuf, int sendcount,
+                           sc_MPI_Datatype sendtype, void *recvbuf,
+                           int *recvcounts, int *displs,
+                           sc_MPI_Datatype recvtype, sc_MPI_Comm comm,
+                           t8_mpi_profile_phase_t phase)
+{
+  if (t8_mpi_profile_enabled) {
+    t8_mpi_profile_record_collective (phase, sendcount, sendtype);
+  }
+  return sc_MPI_Allgatherv (sendbuf, sendcount, sendtype, recvbuf,
+                            recvcounts, displs, recvtype, comm);
+}
+
+int
+t8_mpi_profile_gatherv (void *sendbuf, int sendcount,
+                        sc_MPI_Datatype sendtype, void *recvbuf,
+                        int *recvcounts, int *displs,
+                        sc_MPI_Datatype recvtype, int root, sc_MPI_Comm comm,
+                        t8_mpi_profile_phase_t phase)
+{
+  if (t8_mpi_profile_enabled) {
+    t8_mpi_profile_record_collective (phase, sendcount, sendtype);
+  }
+  return sc_MPI_Gatherv (sendbuf, sendcount, sendtype, recvbuf, recvcounts,
+                         displs, recvtype, root, comm);
+}
+
+int
+t8_mpi_profile_bcast (void *buf, int count, sc_MPI_Datatype datatype,
+                      int root, sc_MPI_Comm comm,
+                      t8_mpi_profile_phase_t phase)
+{
+  if (t8_mpi_profile_enabled) {
+    t8_mpi_profile_record_collective (phase, count, datatype);
+  }
+  return sc_MPI_Bcast (buf, count, datatype, root, comm);
+}
@@ -0,0 +1,166 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_mpi_profile.h
+ * A thin instrumented layer around the MPI calls of t8code's
+ * communication phases. The internal communication routines route
+ * their sends, receives and waits through the wrappers defined here,
+ * each tagged with the phase it belongs to. When recording is enabled,
+ * the layer accumulates per (phase, peer) byte and message counts and
+ * a wait time histogram per phase; when disabled, every wrapper is a
+ * single branch in front of the plain sc_MPI call. The recorded
+ * communication matrices attribute traffic to the t8code phase that
+ * produced it, which an external (PMPI based) profiler cannot do.
+ */
+
+#ifndef T8_MPI_PROFILE_H
+#define T8_MPI_PROFILE_H
+
+#include <t8.h>
+
+/** The communication phases that the instrumented layer distinguishes. */
+typedef enum t8_mpi_profile_phase
+{
+  T8_MPI_PROFILE_GHOST = 0,     /**< Ghost layer creation and data exchange. */
+  T8_MPI_PROFILE_PARTITION,     /**< Forest partitioning. */
+  T8_MPI_PROFILE_CMESH_PARTITION,       /**< Coarse mesh partitioning. */
+  T8_MPI_PROFILE_SHMEM,         /**< Shared memory array communication. */
+  T8_MPI_PROFILE_OTHER,         /**< Any other communication. */
+  T8_MPI_PROFILE_NUM_PHASES     /**< The number of phases. */
+} t8_mpi_profile_phase_t;
+
+T8_EXTERN_C_BEGIN ();
+
+/** Start recording communication. Counters are not reset, so recording
+ * can be paused and resumed around the operations of interest.
+ * Recording is disabled by default; while it is disabled the wrappers
+ * add a single branch per call. */
+void                t8_mpi_profile_enable (void);
+
+/** Stop recording communication. */
+void                t8_mpi_profile_disable (void);
+
+/** Query whether recording is currently enabled.
+ * \return  True if recording is enabled. */
+int                 t8_mpi_profile_is_enabled (void);
+
+/** Reset all recorded counters and free the per peer storage. */
+void                t8_mpi_profile_reset (void);
+
+/** Print the recorded communication matrices and wait time histograms
+ * of this process. For every phase with recorded traffic, one line per
+ * peer with nonzero counts is printed - bytes and messages sent to and
+ * received from that peer - followed by the total wait time and a
+ * histogram of individual wait times in log2 microsecond buckets.
+ * The output is per process (log level production), so at scale it is
+ * best redirected to per rank files. */
+void                t8_mpi_profile_dump (void);
+
+/** Instrumented \see sc_MPI_Isend. The trailing phase argument
+ * attributes the message to a communication phase; all wrappers below
+ * follow this pattern. */
+int                 t8_mpi_profile_isend (void *buf, int count,
+                                          sc_MPI_Datatype datatype, int dest,
+                                          int tag, sc_MPI_Comm comm,
+                                          sc_MPI_Request *request,
+                                          t8_mpi_profile_phase_t phase);
+
+/** Instrumented \see sc_MPI_Irecv. The recorded byte count is the
+ * posted receive size. */
+int                 t8_mpi_profile_irecv (void *buf, int count,
+                                          sc_MPI_Datatype datatype,
+                                          int source, int tag,
+                                          sc_MPI_Comm comm,
+                                          sc_MPI_Request *request,
+                                          t8_mpi_profile_phase_t phase);
+
+/** Instrumented \see sc_MPI_Send. */
+int                 t8_mpi_profile_send (void *buf, int count,
+                                         sc_MPI_Datatype datatype, int dest,
+                                         int tag, sc_MPI_Comm comm,
+                                         t8_mpi_profile_phase_t phase);
+
+/** Instrumented \see sc_MPI_Recv. The blocking time is added to the
+ * wait histogram of \a phase. */
+int                 t8_mpi_profile_recv (void *buf, int count,
+                                         sc_MPI_Datatype datatype,
+                                         int source, int tag,
+                                         sc_MPI_Comm comm,
+                                         sc_MPI_Status *status,
+                                         t8_mpi_profile_phase_t phase);
+
+/** Instrumented \see sc_MPI_Probe. The blocking time is added to the
+ * wait histogram of \a phase. */
+int                 t8_mpi_profile_probe (int source, int tag,
+                                          sc_MPI_Comm comm,
+                                          sc_MPI_Status *status,
+                                          t8_mpi_profile_phase_t phase);
+
+/** Instrumented \see sc_MPI_Wait. The blocking time is added to the
+ * wait histogram of \a phase. */
+int                 t8_mpi_profile_wait (sc_MPI_Request *request,
+                                         sc_MPI_Status *status,
+                                         t8_mpi_profile_phase_t phase);
+
+/** Instrumented \see sc_MPI_Waitall. The blocking time is added to the
+ * wait histogram of \a phase as one entry. */
+int                 t8_mpi_profile_waitall (int count,
+                                            sc_MPI_Request *requests,
+                                            sc_MPI_Status *statuses,
+                                            t8_mpi_profile_phase_t phase);
+
+/** Instrumented \see sc_MPI_Allgather. Collective traffic is recorded
+ * in a per phase collective counter instead of the peer matrix. */
+int                 t8_mpi_profile_allgather (void *sendbuf, int sendcount,
+                                              sc_MPI_Datatype sendtype,
+                                              void *recvbuf, int recvcount,
+                                              sc_MPI_Datatype recvtype,
+                                              sc_MPI_Comm comm,
+                                              t8_mpi_profile_phase_t phase);
+
+/** Instrumented \see sc_MPI_Allgatherv. \see t8_mpi_profile_allgather. */
+int                 t8_mpi_profile_allgatherv (void *sendbuf, int sendcount,
+                                               sc_MPI_Datatype sendtype,
+                                               void *recvbuf, int *recvcounts,
+                                               int *displs,
+                                               sc_MPI_Datatype recvtype,
+                                               sc_MPI_Comm comm,
+                                               t8_mpi_profile_phase_t phase);
+
+/** Instrumented \see sc_MPI_Gatherv. \see t8_mpi_profile_allgather. */
+int                 t8_mpi_profile_gatherv (void *sendbuf, int sendcount,
+                                            sc_MPI_Datatype sendtype,
+                                            void *recvbuf, int *recvcounts,
+                                            int *displs,
+                                            sc_MPI_Datatype recvtype,
+                                            int root, sc_MPI_Comm comm,
+                                            t8_mpi_profile_phase_t phase);
+
+/** Instrumented \see sc_MPI_Bcast. \see t8_mpi_profile_allgather. */
+int                 t8_mpi_profile_bcast (void *buf, int count,
+                                          sc_MPI_Datatype datatype, int root,
+                                          sc_MPI_Comm comm,
+                                          t8_mpi_profile_phase_t phase);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_MPI_PROFILE_H */
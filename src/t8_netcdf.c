@@ -39,6 +39,12 @@ t8_netcdf_create_var (t8_netcdf_variable_type_t var_type,
   netcdf_variable->variable_long_name = var_long_name;
   netcdf_variable->variable_units = var_unit;
   netcdf_variable->var_user_data = var_data;
+  /* By default all storage and access hints inherit the file wide
+   * settings, see t8_netcdf_variable_set_hints */
+  netcdf_variable->var_storage_mode = -1;
+  netcdf_variable->var_chunksize = 0;
+  netcdf_variable->var_deflate_level = -2;
+  netcdf_variable->var_mpi_access = -1;
   return netcdf_variable;
 #else
   t8_global_errorf
@@ -80,6 +86,20 @@ t8_netcdf_create_double_var (const char *var_name, const char *var_long_name,
 #endif
 }
 
+/* Set per-variable netCDF-4 storage and access hints */
+void
+t8_netcdf_variable_set_hints (t8_netcdf_variable_t *var, int storage_mode,
+                              size_t chunksize, int deflate_level,
+                              int mpi_access)
+{
+  T8_ASSERT (var != NULL);
+  T8_ASSERT (deflate_level <= 9);
+  var->var_storage_mode = storage_mode;
+  var->var_chunksize = chunksize;
+  var->var_deflate_level = deflate_level;
+  var->var_mpi_access = mpi_access;
+}
+
 /* Free the memory of the allocated NetCDF variable */
 void
 t8_netcdf_variable_destroy (t8_netcdf_variable_t * var_destroy)
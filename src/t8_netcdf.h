@@ -58,6 +58,12 @@ typedef struct
   t8_netcdf_variable_type_t datatype;
   int                 var_user_dimid;
   sc_array_t         *var_user_data;
+  /* Per-variable storage and access hints, see \ref t8_netcdf_variable_set_hints.
+   * The default values inherit the file wide settings. */
+  int                 var_storage_mode;
+  size_t              var_chunksize;
+  int                 var_deflate_level;
+  int                 var_mpi_access;
 } t8_netcdf_variable_t;
 
 /** Create an extern double variable which additionally should be put out to the NetCDF File
@@ -98,6 +104,29 @@ t8_netcdf_variable_t *t8_netcdf_create_double_var (const char *var_name,
                                                    const char *var_unit,
                                                    sc_array_t *var_data);
 
+/** Set per-variable netCDF-4 storage and access hints of an extern variable.
+ * The hints override the file wide settings that are passed to
+ * \ref t8_forest_write_netcdf_ext2 for this variable only.
+ * \param [in,out]  var    The variable whose hints are set.
+ * \param [in]  storage_mode    NC_CONTIGUOUS or NC_CHUNKED, a negative value
+ *                              inherits the file wide storage mode.
+ * \param [in]  chunksize    The number of elements per chunk if the variable
+ *                           is stored chunked. A value of 0 inherits the file
+ *                           wide chunk size (which in turn may leave the
+ *                           chunk shapes to the netCDF default).
+ * \param [in]  deflate_level    The zlib compression level (0 - 9) for this
+ *                               variable, -1 explicitly disables compression
+ *                               and values below -1 inherit the file wide
+ *                               deflate level.
+ * \param [in]  mpi_access    NC_INDEPENDENT or NC_COLLECTIVE, a negative
+ *                            value inherits the file wide access mode.
+ */
+void                t8_netcdf_variable_set_hints (t8_netcdf_variable_t *var,
+                                                  int storage_mode,
+                                                  size_t chunksize,
+                                                  int deflate_level,
+                                                  int mpi_access);
+
 /** Free the allocated memory of the a t8_netcdf_variable_t
  * \param [in]  var_destroy    A t8_netcdf_t variable whose allocated memory should be freed.
  */
@@ -0,0 +1,206 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_progress.h>
+
+#if defined (SC_ENABLE_PTHREAD) && defined (T8_ENABLE_MPI)
+#define T8_PROGRESS_IMPL 1
+#include <pthread.h>
+#include <time.h>
+#endif
+
+#ifdef T8_PROGRESS_IMPL
+
+/* The polling delay doubles from the minimum to the maximum while no
+ * phase activity is observed, so an engine that is enabled but mostly
+ * idle within a phase costs only a few thousand MPI calls per second. */
+#define T8_PROGRESS_DELAY_MIN_NS 1000
+#define T8_PROGRESS_DELAY_MAX_NS 500000
+
+/* The engine state. All fields except comm behind the mutex; comm is
+ * only used by the progress thread after creation. */
+typedef struct t8_progress_engine
+{
+  pthread_t           thread;   /* The progress thread. */
+  pthread_mutex_t     mutex;
+  pthread_cond_t      cond;     /* Signaled when a phase begins or the
+                                   engine is told to stop. */
+  MPI_Comm            comm;     /* Private communicator for the probe. */
+  int                 num_active;       /* Number of open begin calls. */
+  unsigned            generation;       /* Bumped by each begin call, so
+                                           the thread can reset its
+                                           backoff for a new phase. */
+  int                 stop;     /* Set to end the thread. */
+} t8_progress_engine_t;
+
+static t8_progress_engine_t *t8_progress = NULL;
+
+static void        *
+t8_progress_run (void *arg)
+{
+  t8_progress_engine_t *engine = (t8_progress_engine_t *) arg;
+  struct timespec     ts;
+  long                delay_ns = T8_PROGRESS_DELAY_MIN_NS;
+  unsigned            seen_generation = 0;
+  int                 mpiret, flag;
+
+  for (;;) {
+    pthread_mutex_lock (&engine->mutex);
+    while (!engine->stop && engine->num_active == 0) {
+      /* No communication phase in flight, sleep until one begins. */
+      pthread_cond_wait (&engine->cond, &engine->mutex);
+    }
+    if (engine->stop) {
+      pthread_mutex_unlock (&engine->mutex);
+      break;
+    }
+    if (engine->generation != seen_generation) {
+      /* A new phase was posted, poll densely again. */
+      seen_generation = engine->generation;
+      delay_ns = T8_PROGRESS_DELAY_MIN_NS;
+    }
+    pthread_mutex_unlock (&engine->mutex);
+
+    /* Poke the MPI progress engine. The probe can never match, since
+     * nothing is ever sent with the progress tag on the private
+     * communicator, but executing it progresses all outstanding traffic
+     * of the process in common MPI libraries. */
+    mpiret = MPI_Iprobe (MPI_ANY_SOURCE, T8_MPI_PROGRESS, engine->comm,
+                         &flag, MPI_STATUS_IGNORE);
+    SC_CHECK_MPI (mpiret);
+
+    /* Back off adaptively so that a long compute phase is not perforated
+     * with polls that find nothing new to do. */
+    ts.tv_sec = 0;
+    ts.tv_nsec = delay_ns;
+    nanosleep (&ts, NULL);
+    if (delay_ns < T8_PROGRESS_DELAY_MAX_NS) {
+      delay_ns = SC_MIN (2 * delay_ns, (long) T8_PROGRESS_DELAY_MAX_NS);
+    }
+  }
+  return NULL;
+}
+
+#endif /* T8_PROGRESS_IMPL */
+
+void
+t8_progress_enable (sc_MPI_Comm comm)
+{
+#ifdef T8_PROGRESS_IMPL
+  t8_progress_engine_t *engine;
+  int                 mpiret, provided;
+
+  if (t8_progress != NULL) {
+    /* The engine is already running. */
+    return;
+  }
+  mpiret = MPI_Query_thread (&provided);
+  SC_CHECK_MPI (mpiret);
+  if (provided < MPI_THREAD_MULTIPLE) {
+    t8_global_productionf ("Not enabling the async progress engine:"
+                           " MPI was not initialized with"
+                           " MPI_THREAD_MULTIPLE.\n");
+    return;
+  }
+
+  engine = T8_ALLOC_ZERO (t8_progress_engine_t, 1);
+  /* The probe runs on a private duplicate, so it can never interfere
+   * with the application's or t8code's own traffic. */
+  mpiret = MPI_Comm_dup (comm, &engine->comm);
+  SC_CHECK_MPI (mpiret);
+  pthread_mutex_init (&engine->mutex, NULL);
+  pthread_cond_init (&engine->cond, NULL);
+  engine->num_active = 0;
+  engine->generation = 0;
+  engine->stop = 0;
+  SC_CHECK_ABORT (pthread_create (&engine->thread, NULL, t8_progress_run,
+                                  engine) == 0,
+                  "Could not create the progress thread.");
+  t8_progress = engine;
+  t8_debugf ("Enabled the async progress engine.\n");
+#else
+  (void) comm;
+  t8_global_productionf ("Not enabling the async progress engine:"
+                         " t8code was configured without pthread support"
+                         " or without MPI.\n");
+#endif
+}
+
+void
+t8_progress_disable (void)
+{
+#ifdef T8_PROGRESS_IMPL
+  t8_progress_engine_t *engine = t8_progress;
+  int                 mpiret;
+
+  if (engine == NULL) {
+    return;
+  }
+  pthread_mutex_lock (&engine->mutex);
+  T8_ASSERT (engine->num_active == 0);
+  engine->stop = 1;
+  pthread_cond_signal (&engine->cond);
+  pthread_mutex_unlock (&engine->mutex);
+  SC_CHECK_ABORT (pthread_join (engine->thread, NULL) == 0,
+                  "Could not join the progress thread.");
+  pthread_mutex_destroy (&engine->mutex);
+  pthread_cond_destroy (&engine->cond);
+  mpiret = MPI_Comm_free (&engine->comm);
+  SC_CHECK_MPI (mpiret);
+  T8_FREE (engine);
+  t8_progress = NULL;
+  t8_debugf ("Disabled the async progress engine.\n");
+#endif
+}
+
+void
+t8_progress_begin (void)
+{
+#ifdef T8_PROGRESS_IMPL
+  t8_progress_engine_t *engine = t8_progress;
+
+  if (engine == NULL) {
+    return;
+  }
+  pthread_mutex_lock (&engine->mutex);
+  engine->num_active++;
+  engine->generation++;
+  pthread_cond_signal (&engine->cond);
+  pthread_mutex_unlock (&engine->mutex);
+#endif
+}
+
+void
+t8_progress_end (void)
+{
+#ifdef T8_PROGRESS_IMPL
+  t8_progress_engine_t *engine = t8_progress;
+
+  if (engine == NULL) {
+    return;
+  }
+  pthread_mutex_lock (&engine->mutex);
+  T8_ASSERT (engine->num_active > 0);
+  engine->num_active--;
+  pthread_mutex_unlock (&engine->mutex);
+#endif
+}
@@ -0,0 +1,92 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_progress.h
+ * An optional asynchronous MPI progress engine.
+ *
+ * The split begin/end communication APIs (\ref
+ * t8_forest_ghost_exchange_data_begin, \ref
+ * t8_forest_partition_data_begin) only overlap communication with
+ * computation if the MPI library progresses the posted messages in the
+ * background.  Common MPI libraries progress point-to-point traffic only
+ * inside MPI calls, so the overlap window is wasted unless the
+ * application sprinkles MPI_Test calls through its compute phase.
+ *
+ * This module runs a t8code managed progress thread instead: while a
+ * t8code communication phase is in flight, the thread periodically pokes
+ * the MPI progress engine with a receive probe on a private communicator
+ * and tag that is never sent to, which drives all outstanding traffic of
+ * the process.  The thread polls with adaptive backoff, so it steals few
+ * cycles from the compute threads, and sleeps entirely while no phase is
+ * active.  The outstanding requests themselves are never touched from
+ * the progress thread; MPI forbids testing a request concurrently with
+ * the wait of the main thread.
+ *
+ * The engine requires MPI_THREAD_MULTIPLE and pthread support.  If
+ * either is missing, enabling it logs a note and does nothing, so
+ * application code need not guard the calls.
+ */
+
+#ifndef T8_PROGRESS_H
+#define T8_PROGRESS_H
+
+#include <t8.h>
+
+T8_EXTERN_C_BEGIN ();
+
+/** Enable the asynchronous progress engine.
+ * Duplicates \a comm for the private probe traffic and starts the
+ * progress thread.  If MPI was not initialized with
+ * MPI_THREAD_MULTIPLE, or t8code was configured without pthread
+ * support, a note is logged and the engine stays disabled.
+ * \param [in] comm   The communicator the application communicates on.
+ *                    Communication phases on congruent communicators are
+ *                    progressed as well, since the MPI progress engine
+ *                    is driven per process.
+ * \note This function is collective over \a comm.
+ * \note Calling it twice without \ref t8_progress_disable is a no-op.
+ */
+void                t8_progress_enable (sc_MPI_Comm comm);
+
+/** Disable the asynchronous progress engine and join its thread.
+ * Call this before sc_finalize if the engine was enabled.  Safe to call
+ * when the engine is not running.
+ */
+void                t8_progress_disable (void);
+
+/** Announce that a nonblocking communication phase begins.
+ * Wakes the progress thread (if enabled).  Called internally by the
+ * begin calls of the ghost and partition subsystems; applications that
+ * post their own nonblocking traffic may bracket it with this pair as
+ * well.  Begin/end calls nest.
+ */
+void                t8_progress_begin (void);
+
+/** Announce that a nonblocking communication phase has completed,
+ * \see t8_progress_begin.  The progress thread goes back to sleep when
+ * the last outstanding phase ends.
+ */
+void                t8_progress_end (void);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_PROGRESS_H */
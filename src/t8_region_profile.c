@@ -0,0 +1,207 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_region_profile.h>
+#include <sc_statistics.h>
+
+/* The per-region bookkeeping.  Regions are few (a handful per profiled
+ * algorithm), so we store them in a flat array and look them up by a
+ * linear name comparison on enter. */
+typedef struct t8_region_profile_entry
+{
+  char                name[T8_REGION_PROFILE_NAME_LEN];  /* The region name */
+  double              time;     /* Accumulated elapsed seconds */
+  double              time_max; /* Longest single visit in seconds */
+  double              bytes;    /* Accumulated byte counter */
+  double              count;    /* Number of visits */
+} t8_region_profile_entry_t;
+
+struct t8_region_profile
+{
+  t8_region_profile_entry_t *entries;   /* The regions seen so far */
+  int                 num_entries;      /* Number of valid entries */
+  int                 entries_alloc;    /* Allocated number of entries */
+  int                 depth;    /* Current nesting depth */
+  int                 stack[T8_REGION_PROFILE_MAX_DEPTH]; /* Entry indices of
+                                                             the open regions */
+  double              start[T8_REGION_PROFILE_MAX_DEPTH]; /* Start times of
+                                                             the open regions */
+};
+
+t8_region_profile_t *
+t8_region_profile_new (void)
+{
+  t8_region_profile_t *region_profile;
+
+  region_profile = T8_ALLOC_ZERO (t8_region_profile_t, 1);
+  region_profile->entries_alloc = 8;
+  region_profile->entries =
+    T8_ALLOC_ZERO (t8_region_profile_entry_t,
+                   region_profile->entries_alloc);
+  return region_profile;
+}
+
+void
+t8_region_profile_destroy (t8_region_profile_t **pregion_profile)
+{
+  T8_ASSERT (pregion_profile != NULL);
+  if (*pregion_profile == NULL) {
+    return;
+  }
+  T8_ASSERT ((*pregion_profile)->depth == 0);
+  T8_FREE ((*pregion_profile)->entries);
+  T8_FREE (*pregion_profile);
+  *pregion_profile = NULL;
+}
+
+/* Find the entry with the given name, creating it if it does not exist
+ * yet.  Returns the index of the entry. */
+static int
+t8_region_profile_find (t8_region_profile_t *region_profile,
+                        const char *name)
+{
+  t8_region_profile_entry_t *entry;
+  int                 ientry;
+
+  for (ientry = 0; ientry < region_profile->num_entries; ientry++) {
+    if (!strncmp (region_profile->entries[ientry].name, name,
+                  T8_REGION_PROFILE_NAME_LEN)) {
+      return ientry;
+    }
+  }
+  /* The region is entered for the first time */
+  if (region_profile->num_entries == region_profile->entries_alloc) {
+    region_profile->entries_alloc *= 2;
+    region_profile->entries =
+      T8_REALLOC (region_profile->entries, t8_region_profile_entry_t,
+                  region_profile->entries_alloc);
+  }
+  entry = region_profile->entries + region_profile->num_entries;
+  memset (entry, 0, sizeof (t8_region_profile_entry_t));
+  strncpy (entry->name, name, T8_REGION_PROFILE_NAME_LEN - 1);
+  entry->name[T8_REGION_PROFILE_NAME_LEN - 1] = '\0';
+  return region_profile->num_entries++;
+}
+
+void
+t8_region_profile_enter (t8_region_profile_t *region_profile,
+                         const char *name)
+{
+  if (region_profile == NULL) {
+    return;
+  }
+  T8_ASSERT (name != NULL);
+  T8_ASSERT (region_profile->depth < T8_REGION_PROFILE_MAX_DEPTH);
+  region_profile->stack[region_profile->depth] =
+    t8_region_profile_find (region_profile, name);
+  region_profile->start[region_profile->depth] = sc_MPI_Wtime ();
+  region_profile->depth++;
+}
+
+void
+t8_region_profile_leave (t8_region_profile_t *region_profile,
+                         const char *name)
+{
+  t8_region_profile_entry_t *entry;
+  double              elapsed;
+
+  if (region_profile == NULL) {
+    return;
+  }
+  T8_ASSERT (region_profile->depth > 0);
+  region_profile->depth--;
+  entry =
+    region_profile->entries + region_profile->stack[region_profile->depth];
+  /* Check that enter and leave calls are properly nested */
+  T8_ASSERT (!strncmp (entry->name, name, T8_REGION_PROFILE_NAME_LEN));
+  elapsed = sc_MPI_Wtime () - region_profile->start[region_profile->depth];
+  entry->time += elapsed;
+  if (elapsed > entry->time_max) {
+    entry->time_max = elapsed;
+  }
+  entry->count += 1;
+}
+
+void
+t8_region_profile_add_bytes (t8_region_profile_t *region_profile,
+                             size_t num_bytes)
+{
+  if (region_profile == NULL) {
+    return;
+  }
+  T8_ASSERT (region_profile->depth > 0);
+  region_profile->entries[region_profile->stack[region_profile->depth - 1]].
+    bytes += (double) num_bytes;
+}
+
+void
+t8_region_profile_print (t8_region_profile_t *region_profile,
+                         sc_MPI_Comm comm)
+{
+  const size_t        statname_len = T8_REGION_PROFILE_NAME_LEN + 32;
+  sc_statinfo_t      *stats;
+  char               *statnames, *statname;
+  int                 num_stats, istat, ientry;
+  t8_region_profile_entry_t *entry;
+
+  if (region_profile == NULL || region_profile->num_entries == 0) {
+    return;
+  }
+  T8_ASSERT (region_profile->depth == 0);
+  /* Three stats per region (time, visits, longest visit) plus one byte
+   * counter for each region that accumulated bytes. */
+  num_stats = 3 * region_profile->num_entries;
+  for (ientry = 0; ientry < region_profile->num_entries; ientry++) {
+    if (region_profile->entries[ientry].bytes > 0) {
+      num_stats++;
+    }
+  }
+  stats = T8_ALLOC (sc_statinfo_t, num_stats);
+  /* sc_stats_set1 stores the name pointer, thus each stat needs its own
+   * string that lives until sc_stats_print is done. */
+  statnames = T8_ALLOC (char, num_stats * statname_len);
+  istat = 0;
+  for (ientry = 0; ientry < region_profile->num_entries; ientry++) {
+    entry = region_profile->entries + ientry;
+    statname = statnames + istat * statname_len;
+    snprintf (statname, statname_len, "region %s: time", entry->name);
+    sc_stats_set1 (&stats[istat++], entry->time, statname);
+    statname = statnames + istat * statname_len;
+    snprintf (statname, statname_len, "region %s: visits", entry->name);
+    sc_stats_set1 (&stats[istat++], entry->count, statname);
+    statname = statnames + istat * statname_len;
+    snprintf (statname, statname_len, "region %s: longest visit",
+              entry->name);
+    sc_stats_set1 (&stats[istat++], entry->time_max, statname);
+    if (entry->bytes > 0) {
+      statname = statnames + istat * statname_len;
+      snprintf (statname, statname_len, "region %s: bytes", entry->name);
+      sc_stats_set1 (&stats[istat++], entry->bytes, statname);
+    }
+  }
+  T8_ASSERT (istat == num_stats);
+  sc_stats_compute (comm, num_stats, stats);
+  sc_stats_print (t8_get_package_id (), SC_LP_STATISTICS, num_stats, stats,
+                  1, 1);
+  T8_FREE (statnames);
+  T8_FREE (stats);
+}
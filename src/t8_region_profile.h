@@ -0,0 +1,108 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_region_profile.h
+ * A lightweight hierarchical region profiler.
+ * Regions are identified by name and may be nested; each region
+ * accumulates its elapsed time, the number of visits, the shortest and
+ * longest single visit and an optional message byte counter.
+ * This complements the fixed phase timers of \ref t8_profile_t with
+ * timings of the phases' inner steps.
+ * All calls accept NULL as profiler handle and return immediately in that
+ * case, so profiling that is switched off costs one pointer test per call.
+ */
+
+#ifndef T8_REGION_PROFILE_H
+#define T8_REGION_PROFILE_H
+
+#include <t8.h>
+
+/** The maximum length of a region name including the terminating NUL. */
+#define T8_REGION_PROFILE_NAME_LEN 64
+/** The maximum nesting depth of regions. */
+#define T8_REGION_PROFILE_MAX_DEPTH 16
+
+T8_EXTERN_C_BEGIN ();
+
+/** Opaque handle for a hierarchical region profiler. */
+typedef struct t8_region_profile t8_region_profile_t;
+
+/** Allocate a region profiler without any regions.
+ * \return A profiler handle that must be freed with
+ *         \ref t8_region_profile_destroy. */
+t8_region_profile_t *t8_region_profile_new (void);
+
+/** Free a region profiler and all of its regions.
+ * \param [in,out] pregion_profile Pointer to a profiler handle.
+ *                        Set to NULL on output.  It is legal to pass a
+ *                        pointer to a NULL handle, in which case nothing
+ *                        happens. */
+void                t8_region_profile_destroy (t8_region_profile_t
+                                               **pregion_profile);
+
+/** Enter a region, starting its timer.  The region is created on first
+ * use.  Regions may be nested up to \ref T8_REGION_PROFILE_MAX_DEPTH
+ * levels; a nested region should carry the name of its parent as prefix,
+ * for example "ghost/fill_remote".
+ * \param [in,out] region_profile  A profiler handle or NULL for a no-op.
+ * \param [in]     name   The name of the region.
+ */
+void                t8_region_profile_enter (t8_region_profile_t
+                                             *region_profile,
+                                             const char *name);
+
+/** Leave the innermost open region, stopping its timer and updating its
+ * visit statistics.
+ * \param [in,out] region_profile  A profiler handle or NULL for a no-op.
+ * \param [in]     name   The name that was passed to the matching
+ *                        \ref t8_region_profile_enter.  Only used to check
+ *                        that enter and leave calls are balanced.
+ */
+void                t8_region_profile_leave (t8_region_profile_t
+                                             *region_profile,
+                                             const char *name);
+
+/** Add a number of bytes to the byte counter of the innermost open
+ * region.  Use this to account for message sizes inside a region.
+ * \param [in,out] region_profile  A profiler handle or NULL for a no-op.
+ * \param [in]     num_bytes  The number of bytes to add.
+ */
+void                t8_region_profile_add_bytes (t8_region_profile_t
+                                                 *region_profile,
+                                                 size_t num_bytes);
+
+/** Aggregate the statistics of all regions over the ranks of a
+ * communicator with sc_statistics and print them with log level
+ * SC_LP_STATISTICS.  For each region the accumulated time, the number of
+ * visits and the longest single visit are reported; the byte counter is
+ * reported for regions that accumulated bytes.
+ * \param [in] region_profile  A profiler handle or NULL for a no-op.
+ * \param [in] comm       The communicator to aggregate over.  This is a
+ *                        collective call over \a comm.
+ */
+void                t8_region_profile_print (t8_region_profile_t
+                                             *region_profile,
+                                             sc_MPI_Comm comm);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_REGION_PROFILE_H */
@@ -22,10 +22,23 @@
 
 #include <sc_functions.h>
 #include <t8_schemes/t8_default/t8_default_common/t8_default_common_cxx.hxx>
+#if defined (SC_ENABLE_PTHREAD)
+#include <pthread.h>
+#endif
 
 /* We want to export the whole implementation to be callable from "C" */
 T8_EXTERN_C_BEGIN ();
 
+#if defined (SC_ENABLE_PTHREAD)
+/* The element mempools are shared by all users of a scheme, but
+ * sc_mempool_t is not thread safe. The threaded boundary walk of the
+ * ghost layer construction allocates temporary elements from worker
+ * threads, so with pthread support we serialize the mempool access.
+ * Only the freelist bookkeeping is inside the lock, never any element
+ * computation, and in single threaded runs the lock is uncontended. */
+static pthread_mutex_t t8_default_mempool_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 /** This class independent function assumes an sc_mempool_t as context.
  * It is suitable as the elem_new callback in \ref t8_eclass_scheme_t.
  * We assume that the mempool has been created with the correct element size.
@@ -76,6 +89,68 @@ t8_default_scheme_common_c::t8_element_destroy (int length,
   t8_default_mempool_free ((sc_mempool_t *) this->ts_context, length, elem);
 }
 
+void               *
+t8_default_scheme_common_c::t8_element_context_new () const
+{
+  /* The private pool uses the same element size as the shared pool in
+   * ts_context, so elements from both are interchangeable. */
+  return (void *) sc_mempool_new (element_size);
+}
+
+void
+t8_default_scheme_common_c::t8_element_context_destroy (void **context) const
+{
+  T8_ASSERT (context != NULL);
+  if (*context != NULL) {
+    sc_mempool_destroy ((sc_mempool_t *) *context);
+    *context = NULL;
+  }
+}
+
+void
+t8_default_scheme_common_c::t8_element_new_ctx (void *context, int length,
+                                                t8_element_t **elem) const
+{
+  int                 i;
+
+  if (context == NULL) {
+    /* Route to the shared pool. The subclass override adds the same
+     * debug initialization that we perform below. */
+    t8_element_new (length, elem);
+    return;
+  }
+  T8_ASSERT (0 <= length);
+  T8_ASSERT (elem != NULL);
+  /* The context is owned by a single caller, so unlike
+   * t8_default_mempool_alloc we need no lock around the pool. */
+  for (i = 0; i < length; ++i) {
+    elem[i] = (t8_element_t *) sc_mempool_alloc ((sc_mempool_t *) context);
+  }
+  /* Establish the same initialization guarantee as t8_element_new.
+   * The element classes perform their (debug mode) default
+   * initialization in t8_element_init when new_called is false. */
+  for (i = 0; i < length; ++i) {
+    t8_element_init (1, elem[i], 0);
+  }
+}
+
+void
+t8_default_scheme_common_c::t8_element_destroy_ctx (void *context, int length,
+                                                    t8_element_t **elem) const
+{
+  int                 i;
+
+  if (context == NULL) {
+    t8_element_destroy (length, elem);
+    return;
+  }
+  T8_ASSERT (0 <= length);
+  T8_ASSERT (elem != NULL);
+  for (i = 0; i < length; ++i) {
+    sc_mempool_free ((sc_mempool_t *) context, elem[i]);
+  }
+}
+
 static void
 t8_default_mempool_alloc (sc_mempool_t * ts_context, int length,
                           t8_element_t **elem)
@@ -86,9 +161,15 @@ t8_default_mempool_alloc (sc_mempool_t * ts_context, int length,
   T8_ASSERT (0 <= length);
   T8_ASSERT (elem != NULL);
 
+#if defined (SC_ENABLE_PTHREAD)
+  pthread_mutex_lock (&t8_default_mempool_mutex);
+#endif
   for (i = 0; i < length; ++i) {
     elem[i] = (t8_element_t *) sc_mempool_alloc (ts_context);
   }
+#if defined (SC_ENABLE_PTHREAD)
+  pthread_mutex_unlock (&t8_default_mempool_mutex);
+#endif
 }
 
 static void
@@ -101,9 +182,15 @@ t8_default_mempool_free (sc_mempool_t * ts_context, int length,
   T8_ASSERT (0 <= length);
   T8_ASSERT (elem != NULL);
 
+#if defined (SC_ENABLE_PTHREAD)
+  pthread_mutex_lock (&t8_default_mempool_mutex);
+#endif
   for (i = 0; i < length; ++i) {
     sc_mempool_free (ts_context, elem[i]);
   }
+#if defined (SC_ENABLE_PTHREAD)
+  pthread_mutex_unlock (&t8_default_mempool_mutex);
+#endif
 }
 
 t8_element_shape_t
@@ -150,6 +237,29 @@ t8_default_scheme_common_c::t8_element_num_siblings (const t8_element_t *elem) c
   return sc_intpow (2, dim);
 }
 
+/* The refinement tables of the default schemes, indexed by element class.
+ * Every class refines isotropically into 2^dim equal children, so the
+ * descendant count of an element of level l is 2^(dim * (maxlevel - l)).
+ * The pyramids refine into 10 children of mixed shapes with unequal
+ * descendant ranges (and their tetrahedral members into 8), so they
+ * provide neither constant. */
+static const t8_scheme_table_t t8_default_scheme_tables[T8_ECLASS_COUNT] = {
+  {1, 0},                       /* T8_ECLASS_VERTEX */
+  {2, 1},                       /* T8_ECLASS_LINE */
+  {4, 2},                       /* T8_ECLASS_QUAD */
+  {4, 2},                       /* T8_ECLASS_TRIANGLE */
+  {8, 3},                       /* T8_ECLASS_HEX */
+  {8, 3},                       /* T8_ECLASS_TET */
+  {8, 3},                       /* T8_ECLASS_PRISM */
+  {0, -1}                       /* T8_ECLASS_PYRAMID */
+};
+
+const t8_scheme_table_t *
+t8_default_scheme_common_c::t8_element_scheme_table (void) const
+{
+  return &t8_default_scheme_tables[eclass];
+}
+
 t8_gloidx_t
 t8_default_scheme_common_c::t8_element_count_leafs_from_root (int level) const
 {
@@ -50,6 +50,25 @@ public:
   virtual void        t8_element_destroy (int length,
                                           t8_element_t **elem) const;
 
+  /** Create a private mempool with this scheme's element size.
+   * Elements drawn from it via \ref t8_element_new_ctx bypass the shared
+   * mempool of the scheme and its lock, so one context per worker makes
+   * temporary element allocation reentrant. */
+  virtual void       *t8_element_context_new (void) const;
+
+  /** Destroy a private mempool created by \ref t8_element_context_new. */
+  virtual void        t8_element_context_destroy (void **context) const;
+
+  /** Allocate elements from a private mempool without locking.
+   * Falls back to \ref t8_element_new if \a context is NULL. */
+  virtual void        t8_element_new_ctx (void *context, int length,
+                                          t8_element_t **elem) const;
+
+  /** Return elements to the private mempool they were drawn from.
+   * Falls back to \ref t8_element_destroy if \a context is NULL. */
+  virtual void        t8_element_destroy_ctx (void *context, int length,
+                                              t8_element_t **elem) const;
+
   /** Return the shape of an element */
   virtual t8_element_shape_t t8_element_shape (const t8_element_t *elem)
     const;
@@ -74,6 +93,15 @@ public:
   virtual int         t8_element_num_siblings (const t8_element_t *elem)
     const;
 
+  /** Return the precomputed refinement table of this scheme.
+   * Every default class refines into 2^dim equal children, so the forest
+   * algorithms can consume these constants without virtual calls. The
+   * pyramids report element dependent child counts and unequal descendant
+   * ranges, which disables the corresponding fast paths.
+   * \return The refinement table of this element class.
+   */
+  virtual const t8_scheme_table_t *t8_element_scheme_table (void) const;
+
   /** Count how many leaf descendants of a given uniform level the root element will produce.
    * \param [in] level A refinement level.
    * \return The value of \ref t8_element_count_leafs if the input element
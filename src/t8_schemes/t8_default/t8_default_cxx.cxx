@@ -36,13 +36,42 @@
 /* We want to export the whole implementation to be callable from "C" */
 T8_EXTERN_C_BEGIN ();
 
+/* The default scheme is stateless apart from its element mempools, so one
+ * instance can serve all forests of a process. We keep a pointer to the
+ * instance that is currently alive and hand out additional references to
+ * it, which saves the construction of all eight eclass schemes and their
+ * mempools for every short-lived forest. Schemes are created and
+ * destroyed on the main thread only, so no locking is needed. */
+static t8_scheme_cxx_t *t8_default_scheme_shared = NULL;
+
+/* Invalidate the shared instance pointer when the scheme is destroyed. */
+static void
+t8_default_scheme_destroy_callback (t8_scheme_cxx_t *s)
+{
+  T8_ASSERT (s == t8_default_scheme_shared);
+  t8_default_scheme_shared = NULL;
+}
+
 t8_scheme_cxx_t    *
 t8_scheme_new_default_cxx (void)
 {
   t8_scheme_cxx_t    *s;
+  int                 eclass_it;
+
+  if (t8_default_scheme_shared != NULL) {
+    /* A default scheme is already alive; share it instead of
+     * constructing a new one */
+    t8_scheme_cxx_ref (t8_default_scheme_shared);
+    return t8_default_scheme_shared;
+  }
 
   s = T8_ALLOC_ZERO (t8_scheme_cxx_t, 1);
   t8_refcount_init (&s->rc);
+  s->destroy_callback = t8_default_scheme_destroy_callback;
+  for (eclass_it = 0; eclass_it < T8_ECLASS_COUNT; eclass_it++) {
+    /* The maxlevel cache is filled on first use */
+    s->eclass_maxlevel[eclass_it] = -1;
+  }
 
   s->eclass_schemes[T8_ECLASS_VERTEX] = new t8_default_scheme_vertex_c ();
   s->eclass_schemes[T8_ECLASS_LINE] = new t8_default_scheme_line_c ();
@@ -53,6 +82,7 @@ t8_scheme_new_default_cxx (void)
   s->eclass_schemes[T8_ECLASS_PRISM] = new t8_default_scheme_prism_c ();
   s->eclass_schemes[T8_ECLASS_PYRAMID] = new t8_default_scheme_pyramid_c ();
 
+  t8_default_scheme_shared = s;
   return s;
 }
 
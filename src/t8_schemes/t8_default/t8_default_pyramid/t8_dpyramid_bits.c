@@ -692,38 +692,17 @@ t8_dpyramid_face_neighbour (const t8_dpyramid_t *p, const int face,
   neigh->pyramid.level = p->pyramid.level;
   if (t8_dpyramid_shape (p) == T8_ECLASS_PYRAMID) {
     /*pyramid touches tet or pyra */
-    /*Compute the type of the neighbour */
-    if (face == 0 || face == 1) {
-      neigh->pyramid.type = 3;
-    }
-    else if (face == 2 || face == 3) {
-      neigh->pyramid.type = 0;
-    }
-    else {
-      /*face == 4 */
-      neigh->pyramid.type =
-        ((p->pyramid.type ==
-          T8_DPYRAMID_FIRST_TYPE) ? T8_DPYRAMID_SECOND_TYPE :
-         T8_DPYRAMID_FIRST_TYPE);
-    }
-    /*Compute the coords of the neighbour */
-    /*Do nothing for face == 0 || face == 2 */
-    if (face == 1) {
-      neigh->pyramid.x +=
-        ((p->pyramid.type == T8_DPYRAMID_FIRST_TYPE) ? length : 0);
-      neigh->pyramid.y +=
-        ((p->pyramid.type == T8_DPYRAMID_FIRST_TYPE) ? 0 : -length);
-    }
-    else if (face == 3) {
-      neigh->pyramid.x +=
-        ((p->pyramid.type == T8_DPYRAMID_FIRST_TYPE) ? 0 : -length);
-      neigh->pyramid.y +=
-        ((p->pyramid.type == T8_DPYRAMID_FIRST_TYPE) ? length : 0);
-    }
-    else if (face == 4) {
-      neigh->pyramid.z +=
-        ((p->pyramid.type == T8_DPYRAMID_FIRST_TYPE) ? -length : length);
-    }
+    /*The type and the coordinate shift of the neighbour are precomputed
+     * per (type, face) combination in the connectivity tables */
+    const int          *coord_shift =
+      t8_dpyramid_type_face_to_coord_shift[p->pyramid.type -
+                                           T8_DPYRAMID_FIRST_TYPE][face];
+    neigh->pyramid.type =
+      t8_dpyramid_type_face_to_neighbour_type[p->pyramid.type -
+                                              T8_DPYRAMID_FIRST_TYPE][face];
+    neigh->pyramid.x += coord_shift[0] * length;
+    neigh->pyramid.y += coord_shift[1] * length;
+    neigh->pyramid.z += coord_shift[2] * length;
     return t8_dpyramid_type_face_to_nface[p->pyramid.type -
                                           T8_DPYRAMID_FIRST_TYPE][face];
   }
@@ -734,48 +713,16 @@ t8_dpyramid_face_neighbour (const t8_dpyramid_t *p, const int face,
       return t8_dtet_face_neighbour (&(p->pyramid), face, &(neigh->pyramid));
     }
     if (t8_dpyramid_tet_boundary (p, face)) {
-      /*tet touches pyra, compute the pyra */
-      if (p->pyramid.type == 0) {
-        switch (face) {
-        case 0:
-          neigh->pyramid.x += length;
-          neigh->pyramid.type = T8_DPYRAMID_SECOND_TYPE;
-          return 3;
-        case 1:
-          neigh->pyramid.type = T8_DPYRAMID_SECOND_TYPE;
-          return 2;
-        case 2:
-          neigh->pyramid.type = T8_DPYRAMID_FIRST_TYPE;
-          return 2;
-        case 3:
-          neigh->pyramid.y -= length;
-          neigh->pyramid.type = T8_DPYRAMID_FIRST_TYPE;
-          return 3;
-        default:
-          SC_ABORT_NOT_REACHED ();
-        }
-      }
-      else {
-        /*p->pyramid.type == 3 */
-        switch (face) {
-        case 0:
-          neigh->pyramid.y += length;
-          neigh->pyramid.type = T8_DPYRAMID_SECOND_TYPE;
-          return 1;
-        case 1:
-          neigh->pyramid.type = T8_DPYRAMID_SECOND_TYPE;
-          return 0;
-        case 2:
-          neigh->pyramid.type = T8_DPYRAMID_FIRST_TYPE;
-          return 0;
-        case 3:
-          neigh->pyramid.x -= length;
-          neigh->pyramid.type = T8_DPYRAMID_FIRST_TYPE;
-          return 1;
-        default:
-          SC_ABORT_NOT_REACHED ();
-        }
-      }
+      /*tet touches pyra, compute the pyra from the lookup tables */
+      const int           tet_index = (p->pyramid.type == 0) ? 0 : 1;
+      const int          *coord_shift =
+        t8_dpyramid_tettype_face_to_coord_shift[tet_index][face];
+      neigh->pyramid.type =
+        t8_dpyramid_tettype_face_to_pyratype[tet_index][face];
+      neigh->pyramid.x += coord_shift[0] * length;
+      neigh->pyramid.y += coord_shift[1] * length;
+      neigh->pyramid.z += coord_shift[2] * length;
+      return t8_dpyramid_tettype_face_to_nface[tet_index][face];
     }
     else {
       /*tet touches tet */
@@ -837,50 +784,12 @@ t8_dpyramid_face_parent_face (const t8_dpyramid_t *elem, const int face)
     else {
       t8_dpyramid_type_t  parent_type = t8_dpyramid_tetparent_type (elem);
       /*Only tets of type 0 or 3 have a pyra-parent.pyramid. Parent can have type 6 or 7 */
-      if (elem->pyramid.type == 0 && parent_type == T8_DPYRAMID_FIRST_TYPE) {
-        if (child_id == 3 && face == 1) {
-          return 0;
-        }
-        else if (child_id == 5 && face == 0) {
-          return 1;
-        }
-        else
-          return -1;
-      }
-      else if (elem->pyramid.type == 3
-               && parent_type == T8_DPYRAMID_FIRST_TYPE) {
-        if (child_id == 1 && face == 1) {
-          return 2;
-        }
-        else if (child_id == 6 && face == 0) {
-          return 3;
-        }
-        else
-          return -1;
-      }
-      else if (elem->pyramid.type == 0
-               && parent_type == T8_DPYRAMID_SECOND_TYPE) {
-        if (child_id == 1 && face == 3) {
-          return 1;
-        }
-        else if (child_id == 7 && face == 2) {
-          return 0;
-        }
-        else
-          return -1;
-      }
-      else if (elem->pyramid.type == 3
-               && parent_type == T8_DPYRAMID_SECOND_TYPE) {
-        if (child_id == 2 && face == 3) {
-          return 3;
-        }
-        else if (child_id == 5 && face == 2) {
-          return 2;
-        }
-        else
-          return -1;
+      if (elem->pyramid.type != 0 && elem->pyramid.type != 3) {
+        return -1;
       }
-      return -1;
+      return t8_dpyramid_tettype_parenttype_childid_face_to_parentface
+        [elem->pyramid.type == 0 ? 0 : 1]
+        [parent_type - T8_DPYRAMID_FIRST_TYPE][child_id][face];
     }
   }
 }
@@ -163,3 +163,83 @@ const int           t8_dpyramid_face_corner[5][4] = {
   {2, 3, 4, -1},
   {0, 1, 2, 3}
 };
+
+/* Line t - 6, row f gives the type of the face neighbor of a
+ * pyramid with type t along face f */
+const int           t8_dpyramid_type_face_to_neighbour_type[2][5] = {
+  {3, 3, 0, 0, 7},
+  {3, 3, 0, 0, 6}
+};
+
+/* Line t - 6, row f gives the anchor node shift of the face neighbor
+ * of a pyramid with type t along face f as a multiple of the
+ * edge length of the pyramid */
+const int           t8_dpyramid_type_face_to_coord_shift[2][5][3] = {
+  {{0, 0, 0}, {1, 0, 0}, {0, 0, 0}, {0, 1, 0}, {0, 0, -1}},
+  {{0, 0, 0}, {0, -1, 0}, {0, 0, 0}, {-1, 0, 0}, {0, 0, 1}}
+};
+
+/* Line i, row f gives the type of the pyramid touching the
+ * tetrahedron of type 0 (i = 0) resp. type 3 (i = 1) along face f,
+ * if the tetrahedron has a pyramid neighbor at this face */
+const int           t8_dpyramid_tettype_face_to_pyratype[2][4] = {
+  {7, 7, 6, 6},
+  {7, 7, 6, 6}
+};
+
+/* Line i, row f gives the face number of the pyramid neighbor of a
+ * tetrahedron of type 0 (i = 0) resp. type 3 (i = 1) at which the
+ * tetrahedron touches the pyramid */
+const int           t8_dpyramid_tettype_face_to_nface[2][4] = {
+  {3, 2, 2, 3},
+  {1, 0, 0, 1}
+};
+
+/* Line i, row f gives the anchor node shift of the pyramid neighbor
+ * of a tetrahedron of type 0 (i = 0) resp. type 3 (i = 1) along face f
+ * as a multiple of the edge length of the tetrahedron */
+const int           t8_dpyramid_tettype_face_to_coord_shift[2][4][3] = {
+  {{1, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, -1, 0}},
+  {{0, 1, 0}, {0, 0, 0}, {0, 0, 0}, {-1, 0, 0}}
+};
+
+/* Given a tetrahedron of type 0 (first index 0) resp. type 3
+ * (first index 1) with a pyramid parent of type 6 (second index 0)
+ * resp. type 7 (second index 1), the child id of the tetrahedron and a
+ * face number, give the face number of the parent that the face lies
+ * in, or -1 if the face is not a subface of a parent face */
+const int           t8_dpyramid_tettype_parenttype_childid_face_to_parentface
+  [2][2][8][4] = {
+  {{{-1, -1, -1, -1},
+    {-1, -1, -1, -1},
+    {-1, -1, -1, -1},
+    {-1, 0, -1, -1},
+    {-1, -1, -1, -1},
+    {1, -1, -1, -1},
+    {-1, -1, -1, -1},
+    {-1, -1, -1, -1}},
+   {{-1, -1, -1, -1},
+    {-1, -1, -1, 1},
+    {-1, -1, -1, -1},
+    {-1, -1, -1, -1},
+    {-1, -1, -1, -1},
+    {-1, -1, -1, -1},
+    {-1, -1, -1, -1},
+    {-1, -1, 0, -1}}},
+  {{{-1, -1, -1, -1},
+    {-1, 2, -1, -1},
+    {-1, -1, -1, -1},
+    {-1, -1, -1, -1},
+    {-1, -1, -1, -1},
+    {-1, -1, -1, -1},
+    {3, -1, -1, -1},
+    {-1, -1, -1, -1}},
+   {{-1, -1, -1, -1},
+    {-1, -1, -1, -1},
+    {-1, -1, -1, 3},
+    {-1, -1, -1, -1},
+    {-1, -1, -1, -1},
+    {-1, -1, 2, -1},
+    {-1, -1, -1, -1},
+    {-1, -1, -1, -1}}}
+};
@@ -115,4 +115,34 @@ extern const int    t8_dtet_type_cid_to_pyramid_parenttype[6][8];
 */
 extern const int    t8_dpyramid_face_corner[5][4];
 
+/** Return the type of the face neighbor of a pyramid along a face
+ * neighbour_type = A(type - 6, face)*/
+extern const int    t8_dpyramid_type_face_to_neighbour_type[2][5];
+
+/** Return the anchor node shift of the face neighbor of a pyramid along
+ * a face as a multiple of the edge length of the pyramid
+ * shift_of_dimension_d = A(type - 6, face, d)*/
+extern const int    t8_dpyramid_type_face_to_coord_shift[2][5][3];
+
+/** Return the type of the pyramid touching a tetrahedron of type 0 resp.
+ * type 3 along a face, provided such a pyramid neighbor exists
+ * pyra_type = A(tet_type == 0 ? 0 : 1, face)*/
+extern const int    t8_dpyramid_tettype_face_to_pyratype[2][4];
+
+/** Return the face number of the pyramid neighbor of a tetrahedron of
+ * type 0 resp. type 3 at which the tetrahedron touches the pyramid
+ * neigh_face = A(tet_type == 0 ? 0 : 1, face)*/
+extern const int    t8_dpyramid_tettype_face_to_nface[2][4];
+
+/** Return the anchor node shift of the pyramid neighbor of a tetrahedron
+ * of type 0 resp. type 3 along a face as a multiple of the edge length
+ * shift_of_dimension_d = A(tet_type == 0 ? 0 : 1, face, d)*/
+extern const int    t8_dpyramid_tettype_face_to_coord_shift[2][4][3];
+
+/** Return the face number of the pyramid parent of a tetrahedron that a
+ * tet-face lies in, or -1 if the face is not a subface of a parent face
+ * parent_face = A(tet_type == 0 ? 0 : 1, parent_type - 6, child_id, face)*/
+extern const int    t8_dpyramid_tettype_parenttype_childid_face_to_parentface
+  [2][2][8][4];
+
 #endif // T8_DPYRAMID_CONNECTIVITY_H
@@ -148,3 +148,30 @@ const int           t8_dtet_parent_type_type_to_face[6][6] =
   { {-1, 0, 2, -1, 1, 3}, {0, -1, 3, 1, -1, 2}, {1, 3, -1, 0, 2, -1},
 {-1, 2, 0, -1, 3, 1}, {2, -1, 1, 3, -1, 0}, {3, 1, -1, 2, 0, -1}
 };
+
+/* Line t, row f gives the type of the face neighbor
+ * of a tet with type t along face f */
+const int           t8_dtet_type_face_to_neighbour_type[6][4] = {
+  {4, 5, 1, 2},
+  {3, 2, 0, 5},
+  {0, 1, 3, 4},
+  {5, 4, 2, 1},
+  {2, 3, 5, 0},
+  {1, 0, 4, 3}
+};
+
+/* Line t, row f gives the coordinate shift of the face neighbor
+ * of a tet with type t along face f as a multiple of the
+ * edge length of the tet */
+const int           t8_dtet_type_face_to_coord_shift[6][4][3] = {
+  {{1, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, -1, 0}},
+  {{1, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, -1}},
+  {{0, 1, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, -1}},
+  {{0, 1, 0}, {0, 0, 0}, {0, 0, 0}, {-1, 0, 0}},
+  {{0, 0, 1}, {0, 0, 0}, {0, 0, 0}, {-1, 0, 0}},
+  {{0, 0, 1}, {0, 0, 0}, {0, 0, 0}, {0, -1, 0}}
+};
+
+/* Entry f gives the face number of the face neighbor along face f
+ * at which the original tet is its neighbor */
+const int           t8_dtet_face_to_dual_face[4] = { 3, 1, 2, 0 };
@@ -107,6 +107,17 @@ extern const int    t8_dtet_face_corner[4][3];
  * \see t8_dtet_face_parent_face
  */
 extern const int    t8_dtet_parent_type_type_to_face[6][6];
+
+/** Store the type of the face neighbor for each (type,face) combination. */
+extern const int    t8_dtet_type_face_to_neighbour_type[6][4];
+
+/** Store the anchor node shift of the face neighbor for each (type,face)
+  * combination as a multiple of the edge length of the tet. */
+extern const int    t8_dtet_type_face_to_coord_shift[6][4][3];
+
+/** Store the dual face of each face of a tet, that is the face number
+  * of the face neighbor along which the original tet is its neighbor. */
+extern const int    t8_dtet_face_to_dual_face[4];
 T8_EXTERN_C_END ();
 
 #endif /* T8_DTET_CONNECTIVITY_H */
@@ -63,6 +63,9 @@ T8_EXTERN_C_BEGIN ();
 #define t8_dtri_parenttype_Iloc_to_cid t8_dtet_parenttype_Iloc_to_cid
 #define t8_dtri_type_cid_to_Iloc t8_dtet_type_cid_to_Iloc
 #define t8_dtri_face_corner t8_dtet_face_corner
+#define t8_dtri_type_face_to_neighbour_type t8_dtet_type_face_to_neighbour_type
+#define t8_dtri_type_face_to_coord_shift t8_dtet_type_face_to_coord_shift
+#define t8_dtri_face_to_dual_face t8_dtet_face_to_dual_face
 
 /* functions in d8_dtri_bits.h */
 #define t8_dtri_is_equal t8_dtet_is_equal
@@ -682,75 +682,25 @@ int
 t8_dtri_face_neighbour (const t8_dtri_t *t, int face, t8_dtri_t *n)
 {
   /* TODO: document what happens if outside of root tet */
-  int                 type_new, type_old;
-#ifdef T8_DTRI_TO_DTET
-  int                 sign;
-#endif
-  int                 ret = -1;
-  int8_t              level;
-  t8_dtri_coord_t     coords[3];
+  /* The type transition and the shift of the anchor node are precomputed
+   * per (type, face) combination in the connectivity tables, since the
+   * Bey-type arithmetic showed up high in profiles of the neighbor
+   * searches on simplicial meshes. */
+  const int           type_old = t->type;
+  const t8_dtri_coord_t length = T8_DTRI_LEN (t->level);
+  const int          *coord_shift;
 
   T8_ASSERT (0 <= face && face < T8_DTRI_FACES);
 
-  level = t->level;
-  type_old = t->type;
-  type_new = type_old;
-  coords[0] = t->x;
-  coords[1] = t->y;
-#ifdef T8_DTRI_TO_DTET
-  coords[2] = t->z;
-#endif
-
-#ifndef T8_DTRI_TO_DTET
-  /* 2D */
-  ret = 2 - face;
-  type_new = 1 - type_old;
-  if (face == 0) {
-    coords[type_old] += T8_DTRI_LEN (level);
-  }
-  else if (face == 2) {
-    coords[1 - type_old] -= T8_DTRI_LEN (level);
-  }
-  /* 2D end */
-#else
-  /* 3D */
-  type_new += 6;                /* We want to compute modulo six and dont want negative numbers */
-  if (face == 1 || face == 2) {
-    sign = (type_new % 2 == 0 ? 1 : -1);
-    sign *= (face % 2 == 0 ? 1 : -1);
-    type_new += sign;
-    type_new %= 6;
-    ret = face;
-  }
-  else {
-    if (face == 0) {
-      /* type: 0,1 --> x+1
-       *       2,3 --> y+1
-       *       4,5 --> z+1 */
-      coords[type_old / 2] += T8_DTRI_LEN (level);
-      type_new += (type_new % 2 == 0 ? 4 : 2);
-    }
-    else {                      /* face == 3 */
-
-      /* type: 1,2 --> z-1
-       *       3,4 --> x-1
-       *       5,0 --> y-1 */
-      coords[((type_new + 3) % 6) / 2] -= T8_DTRI_LEN (level);
-      type_new += (type_new % 2 == 0 ? 2 : 4);
-    }
-    type_new %= 6;
-    ret = 3 - face;
-  }
-  /* 3D end */
-#endif
-  n->x = coords[0];
-  n->y = coords[1];
+  coord_shift = t8_dtri_type_face_to_coord_shift[type_old][face];
+  n->x = t->x + coord_shift[0] * length;
+  n->y = t->y + coord_shift[1] * length;
 #ifdef T8_DTRI_TO_DTET
-  n->z = coords[2];
+  n->z = t->z + coord_shift[2] * length;
 #endif
-  n->level = level;
-  n->type = type_new;
-  return ret;
+  n->level = t->level;
+  n->type = t8_dtri_type_face_to_neighbour_type[type_old][face];
+  return t8_dtri_face_to_dual_face[face];
 }
 
 void
@@ -98,3 +98,22 @@ const int           t8_dtri_corner_face[3][2] = {
   {0, 2},
   {0, 1}
 };
+
+/* Line t, row f gives the type of the face neighbor
+ * of a triangle with type t along face f */
+const int           t8_dtri_type_face_to_neighbour_type[2][3] = {
+  {1, 1, 1},
+  {0, 0, 0}
+};
+
+/* Line t, row f gives the coordinate shift of the face neighbor
+ * of a triangle with type t along face f as a multiple of the
+ * edge length of the triangle */
+const int           t8_dtri_type_face_to_coord_shift[2][3][2] = {
+  {{1, 0}, {0, 0}, {0, -1}},
+  {{0, 1}, {0, 0}, {-1, 0}}
+};
+
+/* Entry f gives the face number of the face neighbor along face f
+ * at which the original triangle is its neighbor */
+const int           t8_dtri_face_to_dual_face[3] = { 2, 1, 0 };
@@ -74,6 +74,17 @@ extern const int    t8_dtri_face_corner[3][2];
 /** Store the indices of the faces of each corner of a triangle. */
 extern const int    t8_dtri_corner_face[3][2];
 
+/** Store the type of the face neighbor for each (type,face) combination. */
+extern const int    t8_dtri_type_face_to_neighbour_type[2][3];
+
+/** Store the anchor node shift of the face neighbor for each (type,face)
+  * combination as a multiple of the edge length of the triangle. */
+extern const int    t8_dtri_type_face_to_coord_shift[2][3][2];
+
+/** Store the dual face of each face of a triangle, that is the face number
+  * of the face neighbor along which the original triangle is its neighbor. */
+extern const int    t8_dtri_face_to_dual_face[3];
+
 T8_EXTERN_C_END ();
 
 #endif /* T8_DTRI_CONNECTIVITY_H */
@@ -34,7 +34,7 @@
 #include <t8_schemes/t8_default/t8_default_tri/t8_default_tri_cxx.hxx>
 #include <t8_schemes/t8_default/t8_default_common/t8_default_common_cxx.hxx>
 
-struct t8_default_scheme_vertex_c:public t8_default_scheme_common_c
+struct t8_default_scheme_vertex_c final:public t8_default_scheme_common_c
 {
 public:
 
@@ -0,0 +1,853 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <new>
+#include <t8_schemes/t8_packed_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <t8_refcount.h>
+#if defined (SC_ENABLE_PTHREAD)
+#include <pthread.h>
+#endif
+
+/* The level bits occupy the low end of the packed word. */
+#define T8_PACKED_LEVEL_MASK \
+  ((((uint64_t) 1) << T8_PACKED_LEVEL_BITS) - 1)
+
+/* The number of linear ids that the packed word can represent. */
+#define T8_PACKED_MAX_IDS \
+  (((t8_gloidx_t) 1) << (64 - T8_PACKED_LEVEL_BITS))
+
+#if defined (SC_ENABLE_PTHREAD)
+/* Like the default scheme mempools, the packed element mempool may be
+ * used from the worker threads of the threaded phases, so we serialize
+ * the freelist bookkeeping. */
+static pthread_mutex_t t8_packed_mempool_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+t8_packed_scheme_c::t8_packed_scheme_c (t8_scheme_cxx_t *from, t8_eclass_t ec)
+{
+  int                 level;
+
+  T8_ASSERT (from != NULL);
+  T8_ASSERT (0 <= ec && ec < T8_ECLASS_COUNT);
+
+  eclass = ec;
+  inner_set = from;
+  t8_scheme_cxx_ref (inner_set);
+  inner = from->eclass_schemes[ec];
+  T8_ASSERT (inner != NULL);
+  element_size = sizeof (t8_packed_element_t);
+  ts_context = sc_mempool_new (element_size);
+
+  /* Determine the finest level that fits into the packed word: the
+   * level must fit into the level bits and the linear ids of the level
+   * into the id bits. For the default schemes only vertices (maxlevel
+   * 255) and the very finest hex and pyramid levels are lost. We probe
+   * the levels bottom up, so that we stop before the leaf count of the
+   * wrapped scheme can overflow. */
+  packed_maxlevel = SC_MIN (inner->t8_element_maxlevel (),
+                            (int) T8_PACKED_LEVEL_MASK);
+  for (level = 0; level < packed_maxlevel; level++) {
+    if (inner->t8_element_count_leafs_from_root (level + 1)
+        > T8_PACKED_MAX_IDS) {
+      packed_maxlevel = level;
+      break;
+    }
+  }
+}
+
+t8_packed_scheme_c::~t8_packed_scheme_c ()
+{
+  T8_ASSERT (ts_context != NULL);
+  sc_mempool_destroy ((sc_mempool_t *) ts_context);
+  t8_scheme_cxx_unref (&inner_set);
+}
+
+t8_element_t       *
+t8_packed_scheme_c::unpack (const t8_element_t *packed) const
+{
+  const t8_packed_element_t *p = (const t8_packed_element_t *) packed;
+  t8_element_t       *inner_elem;
+
+  inner->t8_element_new (1, &inner_elem);
+  inner->t8_element_set_linear_id (inner_elem,
+                                   (int) (p->key & T8_PACKED_LEVEL_MASK),
+                                   (t8_linearidx_t)
+                                   (p->key >> T8_PACKED_LEVEL_BITS));
+  return inner_elem;
+}
+
+t8_element_t       *
+t8_packed_scheme_c::unpack_new (void) const
+{
+  t8_element_t       *inner_elem;
+
+  inner->t8_element_new (1, &inner_elem);
+  return inner_elem;
+}
+
+void
+t8_packed_scheme_c::pack (const t8_element_t *inner_elem,
+                          t8_element_t *packed) const
+{
+  t8_packed_element_t *p = (t8_packed_element_t *) packed;
+  int                 level;
+  t8_linearidx_t      id;
+
+  level = inner->t8_element_level (inner_elem);
+  T8_ASSERT (0 <= level && level <= packed_maxlevel);
+  id = inner->t8_element_get_linear_id (inner_elem, level);
+  p->key = ((uint64_t) id << T8_PACKED_LEVEL_BITS) | (uint64_t) level;
+}
+
+void
+t8_packed_scheme_c::unpack_done (t8_element_t *inner_elem) const
+{
+  inner->t8_element_destroy (1, &inner_elem);
+}
+
+int
+t8_packed_scheme_c::t8_element_refines_irregular (void) const
+{
+  return inner->t8_element_refines_irregular ();
+}
+
+int
+t8_packed_scheme_c::t8_element_maxlevel (void) const
+{
+  return packed_maxlevel;
+}
+
+t8_eclass_t
+t8_packed_scheme_c::t8_element_child_eclass (int childid) const
+{
+  return inner->t8_element_child_eclass (childid);
+}
+
+int
+t8_packed_scheme_c::t8_element_level (const t8_element_t *elem) const
+{
+  return (int) (((const t8_packed_element_t *) elem)->key
+                & T8_PACKED_LEVEL_MASK);
+}
+
+void
+t8_packed_scheme_c::t8_element_copy (const t8_element_t *source,
+                                     t8_element_t *dest) const
+{
+  ((t8_packed_element_t *) dest)->key =
+    ((const t8_packed_element_t *) source)->key;
+}
+
+int
+t8_packed_scheme_c::t8_element_compare (const t8_element_t *elem1,
+                                        const t8_element_t *elem2) const
+{
+  t8_element_t       *e1, *e2;
+  int                 ret;
+
+  if (((const t8_packed_element_t *) elem1)->key
+      == ((const t8_packed_element_t *) elem2)->key) {
+    return 0;
+  }
+  e1 = unpack (elem1);
+  e2 = unpack (elem2);
+  ret = inner->t8_element_compare (e1, e2);
+  unpack_done (e1);
+  unpack_done (e2);
+  return ret;
+}
+
+void
+t8_packed_scheme_c::t8_element_parent (const t8_element_t *elem,
+                                       t8_element_t *parent) const
+{
+  t8_element_t       *e = unpack (elem);
+
+  inner->t8_element_parent (e, e);
+  pack (e, parent);
+  unpack_done (e);
+}
+
+int
+t8_packed_scheme_c::t8_element_num_siblings (const t8_element_t *elem) const
+{
+  t8_element_t       *e = unpack (elem);
+  int                 ret;
+
+  ret = inner->t8_element_num_siblings (e);
+  unpack_done (e);
+  return ret;
+}
+
+void
+t8_packed_scheme_c::t8_element_sibling (const t8_element_t *elem, int sibid,
+                                        t8_element_t *sibling) const
+{
+  t8_element_t       *e = unpack (elem);
+
+  inner->t8_element_sibling (e, sibid, e);
+  pack (e, sibling);
+  unpack_done (e);
+}
+
+int
+t8_packed_scheme_c::t8_element_num_corners (const t8_element_t *elem) const
+{
+  t8_element_t       *e = unpack (elem);
+  int                 ret;
+
+  ret = inner->t8_element_num_corners (e);
+  unpack_done (e);
+  return ret;
+}
+
+int
+t8_packed_scheme_c::t8_element_num_faces (const t8_element_t *elem) const
+{
+  t8_element_t       *e = unpack (elem);
+  int                 ret;
+
+  ret = inner->t8_element_num_faces (e);
+  unpack_done (e);
+  return ret;
+}
+
+int
+t8_packed_scheme_c::t8_element_max_num_faces (const t8_element_t *elem) const
+{
+  t8_element_t       *e = unpack (elem);
+  int                 ret;
+
+  ret = inner->t8_element_max_num_faces (e);
+  unpack_done (e);
+  return ret;
+}
+
+int
+t8_packed_scheme_c::t8_element_num_children (const t8_element_t *elem) const
+{
+  t8_element_t       *e = unpack (elem);
+  int                 ret;
+
+  ret = inner->t8_element_num_children (e);
+  unpack_done (e);
+  return ret;
+}
+
+int
+t8_packed_scheme_c::t8_element_num_face_children (const t8_element_t *elem,
+                                                  int face) const
+{
+  t8_element_t       *e = unpack (elem);
+  int                 ret;
+
+  ret = inner->t8_element_num_face_children (e, face);
+  unpack_done (e);
+  return ret;
+}
+
+int
+t8_packed_scheme_c::t8_element_get_face_corner (const t8_element_t *element,
+                                                int face, int corner) const
+{
+  t8_element_t       *e = unpack (element);
+  int                 ret;
+
+  ret = inner->t8_element_get_face_corner (e, face, corner);
+  unpack_done (e);
+  return ret;
+}
+
+int
+t8_packed_scheme_c::t8_element_get_corner_face (const t8_element_t *element,
+                                                int corner, int face) const
+{
+  t8_element_t       *e = unpack (element);
+  int                 ret;
+
+  ret = inner->t8_element_get_corner_face (e, corner, face);
+  unpack_done (e);
+  return ret;
+}
+
+void
+t8_packed_scheme_c::t8_element_child (const t8_element_t *elem, int childid,
+                                      t8_element_t *child) const
+{
+  t8_element_t       *e = unpack (elem);
+
+  inner->t8_element_child (e, childid, e);
+  pack (e, child);
+  unpack_done (e);
+}
+
+void
+t8_packed_scheme_c::t8_element_children (const t8_element_t *elem, int length,
+                                         t8_element_t *c[]) const
+{
+  t8_element_t       *e = unpack (elem);
+  t8_element_t      **inner_c;
+  int                 ichild;
+
+  inner_c = T8_ALLOC (t8_element_t *, length);
+  for (ichild = 0; ichild < length; ichild++) {
+    inner->t8_element_new (1, &inner_c[ichild]);
+  }
+  inner->t8_element_children (e, length, inner_c);
+  for (ichild = 0; ichild < length; ichild++) {
+    pack (inner_c[ichild], c[ichild]);
+    unpack_done (inner_c[ichild]);
+  }
+  T8_FREE (inner_c);
+  unpack_done (e);
+}
+
+int
+t8_packed_scheme_c::t8_element_child_id (const t8_element_t *elem) const
+{
+  t8_element_t       *e = unpack (elem);
+  int                 ret;
+
+  ret = inner->t8_element_child_id (e);
+  unpack_done (e);
+  return ret;
+}
+
+int
+t8_packed_scheme_c::t8_element_ancestor_id (const t8_element_t *elem,
+                                            int level) const
+{
+  t8_element_t       *e = unpack (elem);
+  int                 ret;
+
+  ret = inner->t8_element_ancestor_id (e, level);
+  unpack_done (e);
+  return ret;
+}
+
+int
+t8_packed_scheme_c::t8_element_is_family (t8_element_t **fam) const
+{
+  t8_element_t      **inner_fam;
+  int                 num_siblings, isib, ret;
+
+  num_siblings = t8_element_num_siblings (fam[0]);
+  inner_fam = T8_ALLOC (t8_element_t *, num_siblings);
+  for (isib = 0; isib < num_siblings; isib++) {
+    inner_fam[isib] = unpack (fam[isib]);
+  }
+  ret = inner->t8_element_is_family (inner_fam);
+  for (isib = 0; isib < num_siblings; isib++) {
+    unpack_done (inner_fam[isib]);
+  }
+  T8_FREE (inner_fam);
+  return ret;
+}
+
+void
+t8_packed_scheme_c::t8_element_nca (const t8_element_t *elem1,
+                                    const t8_element_t *elem2,
+                                    t8_element_t *nca) const
+{
+  t8_element_t       *e1 = unpack (elem1);
+  t8_element_t       *e2 = unpack (elem2);
+  t8_element_t       *out = unpack_new ();
+
+  inner->t8_element_nca (e1, e2, out);
+  pack (out, nca);
+  unpack_done (out);
+  unpack_done (e1);
+  unpack_done (e2);
+}
+
+t8_element_shape_t
+t8_packed_scheme_c::t8_element_face_shape (const t8_element_t *elem,
+                                           int face) const
+{
+  t8_element_t       *e = unpack (elem);
+  t8_element_shape_t  ret;
+
+  ret = inner->t8_element_face_shape (e, face);
+  unpack_done (e);
+  return ret;
+}
+
+void
+t8_packed_scheme_c::t8_element_children_at_face (const t8_element_t *elem,
+                                                 int face,
+                                                 t8_element_t *children[],
+                                                 int num_children,
+                                                 int *child_indices) const
+{
+  t8_element_t       *e = unpack (elem);
+  t8_element_t      **inner_c;
+  int                 ichild;
+
+  inner_c = T8_ALLOC (t8_element_t *, num_children);
+  for (ichild = 0; ichild < num_children; ichild++) {
+    inner->t8_element_new (1, &inner_c[ichild]);
+  }
+  inner->t8_element_children_at_face (e, face, inner_c, num_children,
+                                      child_indices);
+  for (ichild = 0; ichild < num_children; ichild++) {
+    pack (inner_c[ichild], children[ichild]);
+    unpack_done (inner_c[ichild]);
+  }
+  T8_FREE (inner_c);
+  unpack_done (e);
+}
+
+int
+t8_packed_scheme_c::t8_element_face_child_face (const t8_element_t *elem,
+                                                int face,
+                                                int face_child) const
+{
+  t8_element_t       *e = unpack (elem);
+  int                 ret;
+
+  ret = inner->t8_element_face_child_face (e, face, face_child);
+  unpack_done (e);
+  return ret;
+}
+
+int
+t8_packed_scheme_c::t8_element_face_parent_face (const t8_element_t *elem,
+                                                 int face) const
+{
+  t8_element_t       *e = unpack (elem);
+  int                 ret;
+
+  ret = inner->t8_element_face_parent_face (e, face);
+  unpack_done (e);
+  return ret;
+}
+
+int
+t8_packed_scheme_c::t8_element_tree_face (const t8_element_t *elem,
+                                          int face) const
+{
+  t8_element_t       *e = unpack (elem);
+  int                 ret;
+
+  ret = inner->t8_element_tree_face (e, face);
+  unpack_done (e);
+  return ret;
+}
+
+void
+t8_packed_scheme_c::t8_element_transform_face (const t8_element_t *elem1,
+                                               t8_element_t *elem2,
+                                               int orientation, int sign,
+                                               int is_smaller_face) const
+{
+  t8_element_t       *e = unpack (elem1);
+
+  inner->t8_element_transform_face (e, e, orientation, sign,
+                                    is_smaller_face);
+  pack (e, elem2);
+  unpack_done (e);
+}
+
+int
+t8_packed_scheme_c::t8_element_extrude_face (const t8_element_t *face,
+                                             const t8_eclass_scheme_c
+                                             *face_scheme,
+                                             t8_element_t *elem,
+                                             int root_face) const
+{
+  const t8_packed_scheme_c *packed_face_scheme =
+    dynamic_cast < const t8_packed_scheme_c * >(face_scheme);
+  t8_element_t       *inner_face, *e;
+  int                 ret;
+
+  /* The face element must be packed as well; mixing packed and unpacked
+   * schemes in one forest is not supported. */
+  T8_ASSERT (packed_face_scheme != NULL);
+  inner_face = packed_face_scheme->unpack (face);
+  e = unpack_new ();
+  ret = inner->t8_element_extrude_face (inner_face,
+                                        packed_face_scheme->inner, e,
+                                        root_face);
+  pack (e, elem);
+  unpack_done (e);
+  packed_face_scheme->unpack_done (inner_face);
+  return ret;
+}
+
+void
+t8_packed_scheme_c::t8_element_boundary_face (const t8_element_t *elem,
+                                              int face,
+                                              t8_element_t *boundary,
+                                              const t8_eclass_scheme_c
+                                              *boundary_scheme) const
+{
+  const t8_packed_scheme_c *packed_boundary_scheme = NULL;
+  t8_element_t       *e = unpack (elem);
+  t8_element_t       *inner_boundary = NULL;
+
+  if (boundary != NULL) {
+    packed_boundary_scheme =
+      dynamic_cast < const t8_packed_scheme_c * >(boundary_scheme);
+    T8_ASSERT (packed_boundary_scheme != NULL);
+    inner_boundary = packed_boundary_scheme->unpack_new ();
+  }
+  inner->t8_element_boundary_face (e, face, inner_boundary,
+                                   packed_boundary_scheme == NULL ? NULL
+                                   : packed_boundary_scheme->inner);
+  if (boundary != NULL) {
+    packed_boundary_scheme->pack (inner_boundary, boundary);
+    packed_boundary_scheme->unpack_done (inner_boundary);
+  }
+  unpack_done (e);
+}
+
+void
+t8_packed_scheme_c::t8_element_first_descendant_face (const t8_element_t
+                                                      *elem, int face,
+                                                      t8_element_t
+                                                      *first_desc,
+                                                      int level) const
+{
+  t8_element_t       *e = unpack (elem);
+  t8_element_t       *out = unpack_new ();
+
+  inner->t8_element_first_descendant_face (e, face, out, level);
+  pack (out, first_desc);
+  unpack_done (out);
+  unpack_done (e);
+}
+
+void
+t8_packed_scheme_c::t8_element_last_descendant_face (const t8_element_t
+                                                     *elem, int face,
+                                                     t8_element_t *last_desc,
+                                                     int level) const
+{
+  t8_element_t       *e = unpack (elem);
+  t8_element_t       *out = unpack_new ();
+
+  inner->t8_element_last_descendant_face (e, face, out, level);
+  pack (out, last_desc);
+  unpack_done (out);
+  unpack_done (e);
+}
+
+void
+t8_packed_scheme_c::t8_element_boundary (const t8_element_t *elem,
+                                         int min_dim, int length,
+                                         t8_element_t **boundary) const
+{
+  SC_ABORT ("t8_element_boundary is not implemented for the packed "
+            "scheme.\n");
+}
+
+int
+t8_packed_scheme_c::t8_element_is_root_boundary (const t8_element_t *elem,
+                                                 int face) const
+{
+  t8_element_t       *e = unpack (elem);
+  int                 ret;
+
+  ret = inner->t8_element_is_root_boundary (e, face);
+  unpack_done (e);
+  return ret;
+}
+
+int
+t8_packed_scheme_c::t8_element_face_neighbor_inside (const t8_element_t
+                                                     *elem,
+                                                     t8_element_t *neigh,
+                                                     int face,
+                                                     int *neigh_face) const
+{
+  t8_element_t       *e = unpack (elem);
+  t8_element_t       *out = unpack_new ();
+  int                 ret;
+
+  ret = inner->t8_element_face_neighbor_inside (e, out, face, neigh_face);
+  if (ret) {
+    pack (out, neigh);
+  }
+  unpack_done (out);
+  unpack_done (e);
+  return ret;
+}
+
+t8_element_shape_t
+t8_packed_scheme_c::t8_element_shape (const t8_element_t *elem) const
+{
+  t8_element_t       *e = unpack (elem);
+  t8_element_shape_t  ret;
+
+  ret = inner->t8_element_shape (e);
+  unpack_done (e);
+  return ret;
+}
+
+void
+t8_packed_scheme_c::t8_element_set_linear_id (t8_element_t *elem, int level,
+                                              t8_linearidx_t id) const
+{
+  T8_ASSERT (0 <= level && level <= packed_maxlevel);
+  ((t8_packed_element_t *) elem)->key =
+    ((uint64_t) id << T8_PACKED_LEVEL_BITS) | (uint64_t) level;
+}
+
+t8_linearidx_t
+t8_packed_scheme_c::t8_element_get_linear_id (const t8_element_t *elem,
+                                              int level) const
+{
+  const t8_packed_element_t *p = (const t8_packed_element_t *) elem;
+  t8_element_t       *e;
+  t8_linearidx_t      ret;
+
+  if (level == (int) (p->key & T8_PACKED_LEVEL_MASK)) {
+    /* The id at the element's own level is stored directly */
+    return (t8_linearidx_t) (p->key >> T8_PACKED_LEVEL_BITS);
+  }
+  e = unpack (elem);
+  ret = inner->t8_element_get_linear_id (e, level);
+  unpack_done (e);
+  return ret;
+}
+
+void
+t8_packed_scheme_c::t8_element_first_descendant (const t8_element_t *elem,
+                                                 t8_element_t *desc,
+                                                 int level) const
+{
+  t8_element_t       *e = unpack (elem);
+  t8_element_t       *out = unpack_new ();
+
+  inner->t8_element_first_descendant (e, out, level);
+  pack (out, desc);
+  unpack_done (out);
+  unpack_done (e);
+}
+
+void
+t8_packed_scheme_c::t8_element_last_descendant (const t8_element_t *elem,
+                                                t8_element_t *desc,
+                                                int level) const
+{
+  t8_element_t       *e = unpack (elem);
+  t8_element_t       *out = unpack_new ();
+
+  inner->t8_element_last_descendant (e, out, level);
+  pack (out, desc);
+  unpack_done (out);
+  unpack_done (e);
+}
+
+void
+t8_packed_scheme_c::t8_element_successor (const t8_element_t *t,
+                                          t8_element_t *s, int level) const
+{
+  t8_element_t       *e = unpack (t);
+  t8_element_t       *out = unpack_new ();
+
+  inner->t8_element_successor (e, out, level);
+  pack (out, s);
+  unpack_done (out);
+  unpack_done (e);
+}
+
+int
+t8_packed_scheme_c::t8_element_root_len (const t8_element_t *elem) const
+{
+  t8_element_t       *e = unpack (elem);
+  int                 ret;
+
+  ret = inner->t8_element_root_len (e);
+  unpack_done (e);
+  return ret;
+}
+
+void
+t8_packed_scheme_c::t8_element_vertex_reference_coords (const t8_element_t
+                                                        *t, const int vertex,
+                                                        double coords[]) const
+{
+  t8_element_t       *e = unpack (t);
+
+  inner->t8_element_vertex_reference_coords (e, vertex, coords);
+  unpack_done (e);
+}
+
+void
+t8_packed_scheme_c::t8_element_reference_coords (const t8_element_t *elem,
+                                                 const double *ref_coords,
+                                                 const void *user_data,
+                                                 double *out_coords) const
+{
+  t8_element_t       *e = unpack (elem);
+
+  inner->t8_element_reference_coords (e, ref_coords, user_data, out_coords);
+  unpack_done (e);
+}
+
+t8_gloidx_t
+t8_packed_scheme_c::t8_element_count_leafs (const t8_element_t *t,
+                                            int level) const
+{
+  t8_element_t       *e = unpack (t);
+  t8_gloidx_t         ret;
+
+  ret = inner->t8_element_count_leafs (e, level);
+  unpack_done (e);
+  return ret;
+}
+
+t8_gloidx_t
+t8_packed_scheme_c::t8_element_count_leafs_from_root (int level) const
+{
+  return inner->t8_element_count_leafs_from_root (level);
+}
+
+void
+t8_packed_scheme_c::t8_element_general_function (const t8_element_t *elem,
+                                                 const void *indata,
+                                                 void *outdata) const
+{
+  t8_element_t       *e = unpack (elem);
+
+  inner->t8_element_general_function (e, indata, outdata);
+  unpack_done (e);
+}
+
+#ifdef T8_ENABLE_DEBUG
+int
+t8_packed_scheme_c::t8_element_is_valid (const t8_element_t *elem) const
+{
+  const t8_packed_element_t *p = (const t8_packed_element_t *) elem;
+  int                 level = (int) (p->key & T8_PACKED_LEVEL_MASK);
+
+  return level <= packed_maxlevel
+    && (t8_gloidx_t) (p->key >> T8_PACKED_LEVEL_BITS)
+    < inner->t8_element_count_leafs_from_root (level);
+}
+
+void
+t8_packed_scheme_c::t8_element_debug_print (const t8_element_t *elem) const
+{
+  t8_element_t       *e = unpack (elem);
+
+  t8_debugf ("Packed element at level %i with linear id %llu. "
+             "Unpacked form:\n", t8_element_level (elem),
+             (unsigned long long) (((const t8_packed_element_t *) elem)->key
+                                   >> T8_PACKED_LEVEL_BITS));
+  inner->t8_element_debug_print (e);
+  unpack_done (e);
+}
+#endif
+
+void
+t8_packed_scheme_c::t8_element_new (int length, t8_element_t **elem) const
+{
+  int                 i;
+
+  T8_ASSERT (ts_context != NULL);
+  T8_ASSERT (0 <= length);
+  T8_ASSERT (elem != NULL);
+
+#if defined (SC_ENABLE_PTHREAD)
+  pthread_mutex_lock (&t8_packed_mempool_mutex);
+#endif
+  for (i = 0; i < length; ++i) {
+    elem[i] = (t8_element_t *) sc_mempool_alloc ((sc_mempool_t *) ts_context);
+  }
+#if defined (SC_ENABLE_PTHREAD)
+  pthread_mutex_unlock (&t8_packed_mempool_mutex);
+#endif
+  for (i = 0; i < length; ++i) {
+    /* A new packed element is the root element */
+    ((t8_packed_element_t *) elem[i])->key = 0;
+  }
+}
+
+void
+t8_packed_scheme_c::t8_element_init (int length, t8_element_t *elem,
+                                     int called_new) const
+{
+  int                 i;
+  t8_packed_element_t *p = (t8_packed_element_t *) elem;
+
+  if (!called_new) {
+    for (i = 0; i < length; i++) {
+      p[i].key = 0;
+    }
+  }
+}
+
+void
+t8_packed_scheme_c::t8_element_destroy (int length, t8_element_t **elem) const
+{
+  int                 i;
+
+  T8_ASSERT (ts_context != NULL);
+  T8_ASSERT (0 <= length);
+  T8_ASSERT (elem != NULL);
+
+#if defined (SC_ENABLE_PTHREAD)
+  pthread_mutex_lock (&t8_packed_mempool_mutex);
+#endif
+  for (i = 0; i < length; ++i) {
+    sc_mempool_free ((sc_mempool_t *) ts_context, elem[i]);
+  }
+#if defined (SC_ENABLE_PTHREAD)
+  pthread_mutex_unlock (&t8_packed_mempool_mutex);
+#endif
+}
+
+/* We want the creation and query functions to be callable from "C" */
+T8_EXTERN_C_BEGIN ();
+
+t8_scheme_cxx_t    *
+t8_scheme_new_packed_cxx (void)
+{
+  t8_scheme_cxx_t    *s, *inner_set;
+  int                 eclass_it;
+
+  /* The packed eclass schemes each take their own reference on the
+   * default scheme, which remains shared process wide. */
+  inner_set = t8_scheme_new_default_cxx ();
+
+  s = T8_ALLOC_ZERO (t8_scheme_cxx_t, 1);
+  t8_refcount_init (&s->rc);
+  for (eclass_it = 0; eclass_it < T8_ECLASS_COUNT; eclass_it++) {
+    /* The maxlevel cache is filled on first use */
+    s->eclass_maxlevel[eclass_it] = -1;
+    s->eclass_schemes[eclass_it] =
+      new t8_packed_scheme_c (inner_set, (t8_eclass_t) eclass_it);
+  }
+  t8_scheme_cxx_unref (&inner_set);
+  return s;
+}
+
+int
+t8_eclass_scheme_is_packed (t8_eclass_scheme_c *ts)
+{
+  return dynamic_cast < t8_packed_scheme_c * >(ts) != NULL;
+}
+
+T8_EXTERN_C_END ();
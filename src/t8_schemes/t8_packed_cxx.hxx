@@ -0,0 +1,230 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_packed_cxx.hxx
+ * A memory saving element representation that wraps another scheme.
+ *
+ * A packed element stores nothing but the linear id of the element at
+ * its own refinement level together with that level, packed into a
+ * single 64 bit word. Since the linear SFC enumeration of a level is a
+ * bijection, this determines the element uniquely, and all element
+ * operations are carried out by unpacking into a temporary element of
+ * the wrapped scheme, delegating, and packing the result again.
+ * Elements thus shrink to 8 bytes independent of the element class,
+ * which roughly triples the elements that fit into a given amount of
+ * memory, at the price of the pack/unpack work in every operation.
+ * Use it for runs that are bound by element memory, not by compute.
+ */
+
+#ifndef T8_PACKED_CXX_HXX
+#define T8_PACKED_CXX_HXX
+
+#include <t8_element_cxx.hxx>
+
+/** The number of low bits of the packed word that store the level. */
+#define T8_PACKED_LEVEL_BITS 6
+
+/** A packed element. The level occupies the \ref T8_PACKED_LEVEL_BITS
+ * low bits, the linear id of the element at this level the remaining
+ * high bits. */
+typedef struct t8_packed_element
+{
+  uint64_t            key;   /**< level | linear_id << T8_PACKED_LEVEL_BITS */
+} t8_packed_element_t;
+
+T8_EXTERN_C_BEGIN ();
+
+/** Return the packed variant of the default element implementation.
+ * All eight eclass schemes store their elements in packed form and
+ * delegate the element operations to the default scheme, \see
+ * t8_scheme_new_default_cxx.
+ * \return A packed scheme. The caller owns one reference to it.
+ * \note A packed scheme must not be mixed with unpacked schemes in one
+ * forest; the face operations assume that the schemes of all element
+ * classes pack their elements.
+ * \note If the linear ids of the finest level of an element class do
+ * not fit into the id bits of the packed word, the packed scheme
+ * reports a reduced maximum level, \see t8_eclass_scheme::t8_element_maxlevel.
+ */
+t8_scheme_cxx_t    *t8_scheme_new_packed_cxx (void);
+
+/** Check whether a given eclass_scheme is a packed scheme.
+ * \param [in] ts   A scheme.
+ * \return          True if \a ts is a packed eclass scheme.
+ */
+int                 t8_eclass_scheme_is_packed (t8_eclass_scheme_c *ts);
+
+T8_EXTERN_C_END ();
+
+/* *INDENT-OFF* */
+/** The packed eclass scheme. It holds the wrapped scheme of the same
+ * element class and translates between the packed and the unpacked
+ * element representation around every delegated operation. */
+class t8_packed_scheme_c:public t8_eclass_scheme_c
+{
+public:
+  /** Construct the packed scheme for one element class.
+   * \param [in] from   The scheme collection to wrap. The constructor
+   *                    takes its own reference on \a from.
+   * \param [in] ec     The element class of this scheme.
+   */
+  t8_packed_scheme_c (t8_scheme_cxx_t *from, t8_eclass_t ec);
+
+  virtual ~t8_packed_scheme_c ();
+
+  virtual int         t8_element_refines_irregular (void) const;
+  virtual int         t8_element_maxlevel (void) const;
+  virtual t8_eclass_t t8_element_child_eclass (int childid) const;
+  virtual int         t8_element_level (const t8_element_t *elem) const;
+  virtual void        t8_element_copy (const t8_element_t *source,
+                                       t8_element_t *dest) const;
+  virtual int         t8_element_compare (const t8_element_t *elem1,
+                                          const t8_element_t *elem2) const;
+  virtual void        t8_element_parent (const t8_element_t *elem,
+                                         t8_element_t *parent) const;
+  virtual int         t8_element_num_siblings (const t8_element_t *elem) const;
+  virtual void        t8_element_sibling (const t8_element_t *elem, int sibid,
+                                          t8_element_t *sibling) const;
+  virtual int         t8_element_num_corners (const t8_element_t *elem) const;
+  virtual int         t8_element_num_faces (const t8_element_t *elem) const;
+  virtual int         t8_element_max_num_faces (const t8_element_t *elem) const;
+  virtual int         t8_element_num_children (const t8_element_t *elem) const;
+  virtual int         t8_element_num_face_children (const t8_element_t *elem,
+                                                    int face) const;
+  virtual int         t8_element_get_face_corner (const t8_element_t *element,
+                                                  int face, int corner) const;
+  virtual int         t8_element_get_corner_face (const t8_element_t *element,
+                                                  int corner, int face) const;
+  virtual void        t8_element_child (const t8_element_t *elem, int childid,
+                                        t8_element_t *child) const;
+  virtual void        t8_element_children (const t8_element_t *elem,
+                                           int length, t8_element_t *c[]) const;
+  virtual int         t8_element_child_id (const t8_element_t *elem) const;
+  virtual int         t8_element_ancestor_id (const t8_element_t *elem,
+                                              int level) const;
+  virtual int         t8_element_is_family (t8_element_t **fam) const;
+  virtual void        t8_element_nca (const t8_element_t *elem1,
+                                      const t8_element_t *elem2,
+                                      t8_element_t *nca) const;
+  virtual t8_element_shape_t t8_element_face_shape (const t8_element_t *elem,
+                                                    int face) const;
+  virtual void        t8_element_children_at_face (const t8_element_t *elem,
+                                                   int face,
+                                                   t8_element_t *children[],
+                                                   int num_children,
+                                                   int *child_indices) const;
+  virtual int         t8_element_face_child_face (const t8_element_t *elem,
+                                                  int face, int face_child) const;
+  virtual int         t8_element_face_parent_face (const t8_element_t *elem,
+                                                   int face) const;
+  virtual int         t8_element_tree_face (const t8_element_t *elem,
+                                            int face) const;
+  virtual void        t8_element_transform_face (const t8_element_t *elem1,
+                                                 t8_element_t *elem2,
+                                                 int orientation, int sign,
+                                                 int is_smaller_face) const;
+  virtual int         t8_element_extrude_face (const t8_element_t *face,
+                                               const t8_eclass_scheme_c *face_scheme,
+                                               t8_element_t *elem,
+                                               int root_face) const;
+  virtual void        t8_element_boundary_face (const t8_element_t *elem,
+                                                int face, t8_element_t *boundary,
+                                                const t8_eclass_scheme_c *boundary_scheme) const;
+  virtual void        t8_element_first_descendant_face (const t8_element_t *elem,
+                                                        int face,
+                                                        t8_element_t *first_desc,
+                                                        int level) const;
+  virtual void        t8_element_last_descendant_face (const t8_element_t *elem,
+                                                       int face,
+                                                       t8_element_t *last_desc,
+                                                       int level) const;
+  virtual void        t8_element_boundary (const t8_element_t *elem,
+                                           int min_dim, int length,
+                                           t8_element_t **boundary) const;
+  virtual int         t8_element_is_root_boundary (const t8_element_t *elem,
+                                                   int face) const;
+  virtual int         t8_element_face_neighbor_inside (const t8_element_t *elem,
+                                                       t8_element_t *neigh,
+                                                       int face,
+                                                       int *neigh_face) const;
+  virtual t8_element_shape_t t8_element_shape (const t8_element_t *elem) const;
+  virtual void        t8_element_set_linear_id (t8_element_t *elem, int level,
+                                                t8_linearidx_t id) const;
+  virtual t8_linearidx_t t8_element_get_linear_id (const t8_element_t *elem,
+                                                   int level) const;
+  virtual void        t8_element_first_descendant (const t8_element_t *elem,
+                                                   t8_element_t *desc,
+                                                   int level) const;
+  virtual void        t8_element_last_descendant (const t8_element_t *elem,
+                                                  t8_element_t *desc,
+                                                  int level) const;
+  virtual void        t8_element_successor (const t8_element_t *t,
+                                            t8_element_t *s, int level) const;
+  virtual int         t8_element_root_len (const t8_element_t *elem) const;
+  virtual void        t8_element_vertex_reference_coords (const t8_element_t *t,
+                                                          const int vertex,
+                                                          double coords[]) const;
+  virtual void        t8_element_reference_coords (const t8_element_t *elem,
+                                                   const double *ref_coords,
+                                                   const void *user_data,
+                                                   double *out_coords) const;
+  virtual t8_gloidx_t t8_element_count_leafs (const t8_element_t *t,
+                                              int level) const;
+  virtual t8_gloidx_t t8_element_count_leafs_from_root (int level) const;
+  virtual void        t8_element_general_function (const t8_element_t *elem,
+                                                   const void *indata,
+                                                   void *outdata) const;
+#ifdef T8_ENABLE_DEBUG
+  virtual int         t8_element_is_valid (const t8_element_t *elem) const;
+  virtual void        t8_element_debug_print (const t8_element_t *elem) const;
+#endif
+  virtual void        t8_element_new (int length, t8_element_t **elem) const;
+  virtual void        t8_element_init (int length, t8_element_t *elem,
+                                       int called_new) const;
+  virtual void        t8_element_destroy (int length, t8_element_t **elem) const;
+
+protected:
+  /** Allocate a temporary element of the wrapped scheme and fill it
+   * with the unpacked data of \a packed. Release with \ref unpack_done. */
+  t8_element_t       *unpack (const t8_element_t *packed) const;
+
+  /** Allocate an uninitialized temporary element of the wrapped scheme,
+   * for example to hold the output of a delegated operation. */
+  t8_element_t       *unpack_new (void) const;
+
+  /** Store the packed form of the wrapped scheme's element \a inner_elem
+   * in the packed element \a packed. */
+  void                pack (const t8_element_t *inner_elem,
+                            t8_element_t *packed) const;
+
+  /** Return a temporary element to the wrapped scheme. */
+  void                unpack_done (t8_element_t *inner_elem) const;
+
+  t8_eclass_scheme_c *inner;            /**< The wrapped eclass scheme. */
+  t8_scheme_cxx_t    *inner_set;        /**< The scheme collection that owns
+                                             \a inner. We hold a reference. */
+  int                 packed_maxlevel;  /**< The finest level whose linear ids
+                                             fit into the packed word. */
+};
+/* *INDENT-ON* */
+
+#endif /* !T8_PACKED_CXX_HXX */
@@ -0,0 +1,267 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#if defined (__linux__) && !defined (_GNU_SOURCE)
+/* For pthread_setaffinity_np and CPU_SET */
+#define _GNU_SOURCE
+#endif
+
+#include <t8_thread_pool.h>
+
+#if defined (SC_ENABLE_PTHREAD)
+
+#include <pthread.h>
+#if defined (__linux__)
+#include <sched.h>
+#endif
+
+/* The pool state. All fields behind the mutex. The phases run one after
+ * the other on the main thread, so at most one exec is active at a time
+ * and one set of run fields suffices. */
+typedef struct t8_thread_pool
+{
+  pthread_t          *threads;  /* The pool threads. */
+  int                 num_threads;      /* The number of pool threads. */
+  pthread_mutex_t     mutex;
+  pthread_cond_t      work_cond;        /* Signaled when workers are submitted
+                                           or the pool shuts down. */
+  pthread_cond_t      done_cond;        /* Signaled when the last worker of a
+                                           run finishes. */
+  /* The active run. num_workers == 0 means no run is active. */
+  void               *(*worker_fn) (void *);
+  char               *workers;
+  size_t              worker_size;
+  int                 num_workers;
+  int                 next_worker;      /* The next worker index to pull. */
+  int                 workers_done;     /* The number of finished workers. */
+  int                 shutdown; /* If set, the threads exit. */
+} t8_thread_pool_t;
+
+static t8_thread_pool_t *t8_thread_pool = NULL;
+/* The process-wide thread limit, <= 0 if unlimited. */
+static int          t8_thread_pool_max_threads = 0;
+static t8_thread_pin_t t8_thread_pool_pin = T8_THREAD_PIN_NONE;
+
+/* The loop of one pool thread: pull workers from the shared counter
+ * while a run is active, sleep otherwise. */
+static void        *
+t8_thread_pool_thread_run (void *vpool)
+{
+  t8_thread_pool_t   *pool = (t8_thread_pool_t *) vpool;
+  int                 iworker;
+
+  pthread_mutex_lock (&pool->mutex);
+  for (;;) {
+    while (!pool->shutdown && pool->next_worker >= pool->num_workers) {
+      pthread_cond_wait (&pool->work_cond, &pool->mutex);
+    }
+    if (pool->shutdown && pool->next_worker >= pool->num_workers) {
+      break;
+    }
+    /* Pull the next worker and execute it outside the lock */
+    iworker = pool->next_worker++;
+    pthread_mutex_unlock (&pool->mutex);
+    pool->worker_fn (pool->workers + (size_t) iworker * pool->worker_size);
+    pthread_mutex_lock (&pool->mutex);
+    if (++pool->workers_done == pool->num_workers) {
+      pthread_cond_signal (&pool->done_cond);
+    }
+  }
+  pthread_mutex_unlock (&pool->mutex);
+  return NULL;
+}
+
+/* Create the pool with the given number of threads, applying the
+ * pinning policy. */
+static void
+t8_thread_pool_create (int num_threads)
+{
+  t8_thread_pool_t   *pool;
+  int                 ithread, retval;
+
+  T8_ASSERT (t8_thread_pool == NULL);
+  T8_ASSERT (num_threads >= 1);
+
+  pool = T8_ALLOC_ZERO (t8_thread_pool_t, 1);
+  pool->num_threads = num_threads;
+  pool->threads = T8_ALLOC (pthread_t, num_threads);
+  pthread_mutex_init (&pool->mutex, NULL);
+  pthread_cond_init (&pool->work_cond, NULL);
+  pthread_cond_init (&pool->done_cond, NULL);
+  for (ithread = 0; ithread < num_threads; ithread++) {
+    retval = pthread_create (&pool->threads[ithread], NULL,
+                             t8_thread_pool_thread_run, pool);
+    SC_CHECK_ABORTF (retval == 0, "Could not create pool thread %i.\n",
+                     ithread);
+#if defined (__linux__)
+    if (t8_thread_pool_pin == T8_THREAD_PIN_SPREAD) {
+      cpu_set_t           cpuset;
+
+      CPU_ZERO (&cpuset);
+      CPU_SET (ithread, &cpuset);
+      /* A failure (e.g. fewer cores than threads) is not fatal; the
+       * thread then keeps the inherited affinity. */
+      (void) pthread_setaffinity_np (pool->threads[ithread],
+                                     sizeof (cpu_set_t), &cpuset);
+    }
+#endif
+  }
+  t8_thread_pool = pool;
+}
+
+void
+t8_thread_pool_finalize (void)
+{
+  t8_thread_pool_t   *pool = t8_thread_pool;
+  int                 ithread, retval;
+
+  if (pool == NULL) {
+    return;
+  }
+  pthread_mutex_lock (&pool->mutex);
+  T8_ASSERT (pool->num_workers == 0);
+  pool->shutdown = 1;
+  pthread_cond_broadcast (&pool->work_cond);
+  pthread_mutex_unlock (&pool->mutex);
+  for (ithread = 0; ithread < pool->num_threads; ithread++) {
+    retval = pthread_join (pool->threads[ithread], NULL);
+    SC_CHECK_ABORTF (retval == 0, "Could not join pool thread %i.\n",
+                     ithread);
+  }
+  pthread_mutex_destroy (&pool->mutex);
+  pthread_cond_destroy (&pool->work_cond);
+  pthread_cond_destroy (&pool->done_cond);
+  T8_FREE (pool->threads);
+  T8_FREE (pool);
+  t8_thread_pool = NULL;
+}
+
+void
+t8_thread_pool_exec (void *(*worker_fn) (void *), void *workers,
+                     size_t worker_size, int num_workers)
+{
+  t8_thread_pool_t   *pool;
+  int                 target_threads, iworker;
+
+  T8_ASSERT (worker_fn != NULL);
+  T8_ASSERT (num_workers >= 0);
+  if (num_workers <= 0) {
+    return;
+  }
+
+  /* The number of threads this run would like to have */
+  target_threads = num_workers;
+  if (t8_thread_pool_max_threads > 0
+      && target_threads > t8_thread_pool_max_threads) {
+    target_threads = t8_thread_pool_max_threads;
+  }
+  if (target_threads <= 1) {
+    /* Run serially on the calling thread */
+    for (iworker = 0; iworker < num_workers; iworker++) {
+      worker_fn ((char *) workers + (size_t) iworker * worker_size);
+    }
+    return;
+  }
+  /* (Re)create the pool if it does not exist, is smaller than this run
+   * wants, or exceeds a lowered thread limit */
+  if (t8_thread_pool != NULL
+      && (t8_thread_pool->num_threads < target_threads
+          || (t8_thread_pool_max_threads > 0
+              && t8_thread_pool->num_threads > t8_thread_pool_max_threads))) {
+    t8_thread_pool_finalize ();
+  }
+  if (t8_thread_pool == NULL) {
+    t8_thread_pool_create (target_threads);
+  }
+  pool = t8_thread_pool;
+
+  pthread_mutex_lock (&pool->mutex);
+  T8_ASSERT (pool->num_workers == 0);
+  pool->worker_fn = worker_fn;
+  pool->workers = (char *) workers;
+  pool->worker_size = worker_size;
+  pool->next_worker = 0;
+  pool->workers_done = 0;
+  pool->num_workers = num_workers;
+  pthread_cond_broadcast (&pool->work_cond);
+  while (pool->workers_done < pool->num_workers) {
+    pthread_cond_wait (&pool->done_cond, &pool->mutex);
+  }
+  /* Mark the pool as idle again */
+  pool->num_workers = 0;
+  pool->next_worker = 0;
+  pthread_mutex_unlock (&pool->mutex);
+}
+
+#else /* !SC_ENABLE_PTHREAD */
+
+void
+t8_thread_pool_finalize (void)
+{
+}
+
+void
+t8_thread_pool_exec (void *(*worker_fn) (void *), void *workers,
+                     size_t worker_size, int num_workers)
+{
+  int                 iworker;
+
+  T8_ASSERT (worker_fn != NULL);
+  for (iworker = 0; iworker < num_workers; iworker++) {
+    worker_fn ((char *) workers + (size_t) iworker * worker_size);
+  }
+}
+
+#endif /* !SC_ENABLE_PTHREAD */
+
+/* The limit and the pinning policy are stored even without pthread
+ * support, so the setters exist unconditionally. */
+#if !defined (SC_ENABLE_PTHREAD)
+static int          t8_thread_pool_max_threads = 0;
+static t8_thread_pin_t t8_thread_pool_pin = T8_THREAD_PIN_NONE;
+#endif
+
+void
+t8_thread_pool_set_num_threads (int num_threads)
+{
+  /* A lowered limit takes effect on the next exec; shrinking eagerly
+   * here would join threads from within a possibly unrelated phase. */
+  t8_thread_pool_max_threads = num_threads;
+}
+
+void
+t8_thread_pool_set_pin_policy (t8_thread_pin_t pin_policy)
+{
+  /* The policy is applied when the pool threads are (re)created. */
+  t8_thread_pool_pin = pin_policy;
+}
+
+int
+t8_thread_pool_clamp_num_threads (int num_threads)
+{
+  T8_ASSERT (num_threads >= 1);
+  if (t8_thread_pool_max_threads > 0
+      && num_threads > t8_thread_pool_max_threads) {
+    return t8_thread_pool_max_threads;
+  }
+  return num_threads;
+}
@@ -0,0 +1,119 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_thread_pool.h
+ * A small process-wide pool of worker threads that is shared by all
+ * threaded phases of t8code (the ghost boundary walk, the uniform forest
+ * populate and the VTK serialization). The phases hand the pool an array
+ * of worker argument structs; the pool threads pull the workers from a
+ * shared counter, so the phases no longer spawn their own threads and
+ * cannot oversubscribe the cores of the host application. The pool
+ * threads persist between phases, which also removes the repeated thread
+ * spawn cost.
+ * The OpenMP based phases of t8code do not run on the pool threads, but
+ * they honor the same limit: they clamp their thread counts with
+ * \ref t8_thread_pool_clamp_num_threads, so that
+ * \ref t8_thread_pool_set_num_threads caps the threading of all phases.
+ */
+
+#ifndef T8_THREAD_POOL_H
+#define T8_THREAD_POOL_H
+
+#include <t8.h>
+
+T8_EXTERN_C_BEGIN ();
+
+/** The pinning policies for the pool threads,
+ * \see t8_thread_pool_set_pin_policy. */
+typedef enum t8_thread_pin
+{
+  T8_THREAD_PIN_NONE = 0, /**< Do not pin the pool threads (default). */
+  T8_THREAD_PIN_SPREAD    /**< Pin thread i to core i. Use this when the
+                               host application does not run its own
+                               threads on the same cores. Only effective
+                               on Linux; elsewhere it is ignored. */
+} t8_thread_pin_t;
+
+/** Set the process-wide maximum number of pool threads.
+ * If never called (or called with \a num_threads <= 0), the pool grows to
+ * the largest worker count any phase requests. With a positive value the
+ * pool never exceeds \a num_threads threads; phases that request more
+ * workers have their workers executed in turns by the available threads.
+ * Use this to make t8code's threading compose with the threading of the
+ * host application.
+ * \param [in] num_threads  The maximum number of pool threads, or <= 0
+ *                          to remove the limit.
+ * \note If the pool is already running with more threads, it is shrunk
+ * on the next \ref t8_thread_pool_exec.
+ */
+void                t8_thread_pool_set_num_threads (int num_threads);
+
+/** Clamp a worker count to the process-wide pool thread limit.
+ * The OpenMP based phases call this with their requested thread count
+ * before opening their parallel regions, so that the limit set with
+ * \ref t8_thread_pool_set_num_threads also caps the phases that do not
+ * execute on the pool threads.
+ * \param [in] num_threads  The requested number of threads, must be >= 1.
+ * \return                  \a num_threads, or the pool limit if that is
+ *                          positive and smaller.
+ */
+int                 t8_thread_pool_clamp_num_threads (int num_threads);
+
+/** Set the pinning policy for the pool threads.
+ * Takes effect when the pool threads are (re)created.
+ * \param [in] pin_policy  The policy, \see t8_thread_pin_t.
+ */
+void                t8_thread_pool_set_pin_policy (t8_thread_pin_t
+                                                   pin_policy);
+
+/** Execute a set of workers on the pool threads and wait for completion.
+ * The workers are described by an array of \a num_workers argument
+ * structs of \a worker_size bytes each; \a worker_fn is called once per
+ * struct, exactly like a pthread start routine. The calling thread
+ * blocks until all workers have finished. The pool threads pull the
+ * workers from a shared counter, so workers of uneven cost are balanced
+ * automatically; phases with large independent subtasks should submit
+ * one worker per subtask rather than one worker per thread.
+ * Without pthread support (or with a pool limit of one thread) the
+ * workers are executed serially by the calling thread.
+ * \param [in] worker_fn    The worker routine. Its return value is
+ *                          ignored.
+ * \param [in] workers      Array of \a num_workers argument structs.
+ * \param [in] worker_size  The size of one argument struct in bytes.
+ * \param [in] num_workers  The number of workers to execute.
+ * \note This function must only be called from the main thread and
+ * must not be called recursively from a worker.
+ */
+void                t8_thread_pool_exec (void *(*worker_fn) (void *),
+                                         void *workers, size_t worker_size,
+                                         int num_workers);
+
+/** Join and destroy the pool threads and free the pool.
+ * Call this before sc_finalize if any threaded phase was used, so that
+ * the allocation balance check stays clean. The pool is recreated
+ * automatically by the next \ref t8_thread_pool_exec.
+ */
+void                t8_thread_pool_finalize (void);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_THREAD_POOL_H */
@@ -0,0 +1,45 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/* Unity build translation unit, compiled in place of the individual
+ * sources below when t8code is configured with --enable-unity-build,
+ * \see doc/build_modes.txt. The groups are chosen so that the file scope
+ * identifiers and macros of the merged sources stay disjoint; the default
+ * scheme kernels are deliberately not merged, since the tri/tet and
+ * pyramid bit kernels share renamed identifiers through macro headers.
+ * When adding a source file to src/Makefile.am, add it to the matching
+ * unity unit as well. */
+
+#include <t8_cmesh/t8_cmesh.c>
+#include <t8_cmesh/t8_cmesh_triangle.c>
+#include <t8_cmesh/t8_cmesh_vtk_writer.c>
+#include <t8_cmesh/t8_cmesh_stash.c>
+#include <t8_cmesh/t8_cmesh_save.c>
+#include <t8_cmesh/t8_cmesh_netcdf.c>
+#include <t8_cmesh/t8_cmesh_trees.c>
+#include <t8_cmesh/t8_cmesh_commit.c>
+#include <t8_cmesh/t8_cmesh_partition.c>
+#include <t8_cmesh/t8_cmesh_copy.c>
+#include <t8_cmesh/t8_cmesh_examples.c>
+#include <t8_cmesh/t8_cmesh_offset.c>
+#include <t8_cmesh/t8_cmesh_testcases.c>
+#include <t8_data/t8_shmem.c>
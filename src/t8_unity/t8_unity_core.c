@@ -0,0 +1,46 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/* Unity build translation unit, compiled in place of the individual
+ * sources below when t8code is configured with --enable-unity-build,
+ * \see doc/build_modes.txt. The groups are chosen so that the file scope
+ * identifiers and macros of the merged sources stay disjoint; the default
+ * scheme kernels are deliberately not merged, since the tri/tet and
+ * pyramid bit kernels share renamed identifiers through macro headers.
+ * When adding a source file to src/Makefile.am, add it to the matching
+ * unity unit as well. */
+
+#include <t8.c>
+#include <t8_eclass.c>
+#include <t8_mesh.c>
+#include <t8_element.c>
+#include <t8_region_profile.c>
+#include <t8_refcount.c>
+#include <t8_version.c>
+#include <t8_thread_pool.c>
+#include <t8_mpi_profile.c>
+#include <t8_vtk.c>
+#include <t8_element_shape.c>
+#include <t8_netcdf.c>
+#include <t8_cpuid.c>
+#include <t8_progress.c>
+#include <t8_geometry/t8_geometry_helpers.c>
@@ -177,6 +177,130 @@ t8_vec_diff (const double vec_x[3], const double vec_y[3], double diff[3])
   }
 }
 
+/* The following _n variants operate on contiguous blocks of \a num_vecs
+ * 3D vectors. They are written as restrict-qualified flat loops so that
+ * the compiler can vectorize across the vectors, which it cannot do when
+ * the single-vector helpers above are called from an element loop. */
+
+/** Compute X_i = alpha * X_i for a block of vectors.
+ * \param [in,out] vecs_x   \a num_vecs contiguous 3D vectors.
+ *                          On output each vector is scaled by \a alpha.
+ * \param [in]     alpha    A factor.
+ * \param [in]     num_vecs The number of vectors in \a vecs_x.
+ */
+static inline void
+t8_vec_ax_n (double *t8_restrict vecs_x, const double alpha,
+             const size_t num_vecs)
+{
+  for (size_t i = 0; i < 3 * num_vecs; i++) {
+    vecs_x[i] *= alpha;
+  }
+}
+
+/** Compute Y_i = Y_i + alpha * X_i for a block of vectors.
+ * \param [in]     vecs_x   \a num_vecs contiguous 3D vectors.
+ * \param [in,out] vecs_y   \a num_vecs contiguous 3D vectors.
+ *                          On output set to \a vecs_y + \a alpha * \a vecs_x
+ *                          vector by vector.
+ * \param [in]     alpha    A factor.
+ * \param [in]     num_vecs The number of vectors in \a vecs_x and \a vecs_y.
+ * \note \a vecs_x and \a vecs_y must not overlap.
+ */
+static inline void
+t8_vec_axpy_n (const double *t8_restrict vecs_x, double *t8_restrict vecs_y,
+               const double alpha, const size_t num_vecs)
+{
+  for (size_t i = 0; i < 3 * num_vecs; i++) {
+    vecs_y[i] += alpha * vecs_x[i];
+  }
+}
+
+/** Compute Z_i = Y_i + alpha * X_i for a block of vectors.
+ * \param [in]  vecs_x   \a num_vecs contiguous 3D vectors.
+ * \param [in]  vecs_y   \a num_vecs contiguous 3D vectors.
+ * \param [out] vecs_z   \a num_vecs contiguous 3D vectors. On output set to
+ *                       \a vecs_y + \a alpha * \a vecs_x vector by vector.
+ * \param [in]  alpha    A factor.
+ * \param [in]  num_vecs The number of vectors per block.
+ * \note The blocks must not overlap.
+ */
+static inline void
+t8_vec_axpyz_n (const double *t8_restrict vecs_x,
+                const double *t8_restrict vecs_y,
+                double *t8_restrict vecs_z, const double alpha,
+                const size_t num_vecs)
+{
+  for (size_t i = 0; i < 3 * num_vecs; i++) {
+    vecs_z[i] = vecs_y[i] + alpha * vecs_x[i];
+  }
+}
+
+/** Euclidean distances of a block of vectors to a single vector.
+ * \param [in]  vecs_x   \a num_vecs contiguous 3D vectors.
+ * \param [in]  vec_y    A 3D vector.
+ * \param [out] dists    An array of \a num_vecs entries. On output the i-th
+ *                       entry is the euclidean distance of the i-th vector
+ *                       of \a vecs_x to \a vec_y.
+ * \param [in]  num_vecs The number of vectors in \a vecs_x.
+ */
+static inline void
+t8_vec_dist_n (const double *t8_restrict vecs_x,
+               const double vec_y[3], double *t8_restrict dists,
+               const size_t num_vecs)
+{
+  for (size_t i = 0; i < num_vecs; i++) {
+    const double        dx = vecs_x[3 * i] - vec_y[0];
+    const double        dy = vecs_x[3 * i + 1] - vec_y[1];
+    const double        dz = vecs_x[3 * i + 2] - vec_y[2];
+
+    dists[i] = sqrt (dx * dx + dy * dy + dz * dz);
+  }
+}
+
+/** Pairwise dot products of two blocks of vectors.
+ * \param [in]  vecs_x   \a num_vecs contiguous 3D vectors.
+ * \param [in]  vecs_y   \a num_vecs contiguous 3D vectors.
+ * \param [out] dots     An array of \a num_vecs entries. On output the i-th
+ *                       entry is the dot product of the i-th vectors of
+ *                       \a vecs_x and \a vecs_y.
+ * \param [in]  num_vecs The number of vectors per block.
+ */
+static inline void
+t8_vec_dot_n (const double *t8_restrict vecs_x,
+              const double *t8_restrict vecs_y, double *t8_restrict dots,
+              const size_t num_vecs)
+{
+  for (size_t i = 0; i < num_vecs; i++) {
+    dots[i] = vecs_x[3 * i] * vecs_y[3 * i]
+      + vecs_x[3 * i + 1] * vecs_y[3 * i + 1]
+      + vecs_x[3 * i + 2] * vecs_y[3 * i + 2];
+  }
+}
+
+/** Pairwise cross products of two blocks of vectors.
+ * \param [in]  vecs_x   \a num_vecs contiguous 3D vectors.
+ * \param [in]  vecs_y   \a num_vecs contiguous 3D vectors.
+ * \param [out] crosses  \a num_vecs contiguous 3D vectors. On output the
+ *                       i-th vector is the cross product of the i-th vectors
+ *                       of \a vecs_x and \a vecs_y.
+ * \param [in]  num_vecs The number of vectors per block.
+ * \note \a crosses must not overlap with the input blocks.
+ */
+static inline void
+t8_vec_cross_n (const double *t8_restrict vecs_x,
+                const double *t8_restrict vecs_y,
+                double *t8_restrict crosses, const size_t num_vecs)
+{
+  for (size_t i = 0; i < num_vecs; i++) {
+    crosses[3 * i] = vecs_x[3 * i + 1] * vecs_y[3 * i + 2]
+      - vecs_x[3 * i + 2] * vecs_y[3 * i + 1];
+    crosses[3 * i + 1] = vecs_x[3 * i + 2] * vecs_y[3 * i]
+      - vecs_x[3 * i] * vecs_y[3 * i + 2];
+    crosses[3 * i + 2] = vecs_x[3 * i] * vecs_y[3 * i + 1]
+      - vecs_x[3 * i + 1] * vecs_y[3 * i];
+  }
+}
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_VEC_H! */
@@ -61,37 +61,30 @@ t8_read_parallel (const char *filename, vtkSmartPointer < vtkDataSet > grid,
   mpiret = sc_MPI_Comm_rank (comm, &mpirank);
   SC_CHECK_MPI (mpiret);
 
-  /* Setup number of pieces to read on this proc. */
-  int                 last_piece = -1;
-  int                 first_piece = 0;
-  if (mpisize >= total_num_pieces) {
-    /* The first n-procs read a piece each. */
-    first_piece = mpirank;
-    last_piece = first_piece + ((mpirank < mpisize) ? 1 : 0);
-  }
-  else {
-    first_piece = total_num_pieces / mpisize * mpirank;
-    last_piece = first_piece;
-    const int           prev_proc_first_piece =
-      total_num_pieces / mpisize * (mpirank - 1);
-    last_piece +=
-      first_piece == prev_proc_first_piece ? 0 : total_num_pieces / mpisize;
-    if (first_piece == total_num_pieces / mpisize * (mpisize - 1)) {
-      /* Read the last chunk of data */
-      last_piece = total_num_pieces - first_piece;
-    }
-  }
+  /* Setup number of pieces to read on this proc.
+   * The pieces are split into contiguous ranges of (almost) equal count,
+   * so every piece is read by exactly one process and no process reads
+   * more than its share. If there are more processes than pieces the
+   * trailing processes read nothing. */
+  const int           first_piece =
+    (int) ((long long) total_num_pieces * mpirank / mpisize);
+  const int           last_piece =
+    (int) ((long long) total_num_pieces * (mpirank + 1) / mpisize);
 
   /* Read the pieces if there are any pieces to read on this proc. */
   if (first_piece < last_piece) {
     vtkNew < vtkAppendFilter > append;
+    append->MergePointsOn ();
     for (int ipiece = first_piece; ipiece < last_piece; ipiece++) {
       reader->UpdatePiece (ipiece, total_num_pieces, 0);
-      append->AddInputData (reader->GetOutput ());
+      /* The reader reuses its output object, so we take a shallow copy
+       * of each piece before reading the next one. */
+      vtkNew < vtkUnstructuredGrid > piece;
+      piece->ShallowCopy (reader->GetOutput ());
+      append->AddInputData (piece);
     }
     /* Merge all read grids together */
     append->Update ();
-    append->MergePointsOn ();
     grid->ShallowCopy (append->GetOutput ());
     t8_debugf ("[D] read %lli cells\n", grid->GetNumberOfCells ());
   }
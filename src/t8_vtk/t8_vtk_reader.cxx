@@ -127,6 +127,21 @@ t8_file_to_vtkGrid (const char *filename,
   SC_CHECK_MPI (mpiret);
   T8_ASSERT (filename != NULL);
   T8_ASSERT (0 <= main_proc && main_proc < mpisize);
+  if (partition && vtk_file_type == VTK_PARALLEL_UNSTRUCTURED_FILE) {
+    /* Distributed reading: every process reads its own range of the
+     * pieces of the parallel file, so the dataset is never resident on
+     * a single process. Processes without a piece keep an empty grid. */
+    const vtk_read_success_t local_read_successful =
+      t8_read_parallel (filename, vtkGrid, comm);
+    int                 local_success = (local_read_successful
+                                         == read_success);
+    int                 global_success;
+    /* The read only succeeded if it succeeded on every process. */
+    mpiret = sc_MPI_Allreduce (&local_success, &global_success, 1,
+                               sc_MPI_INT, sc_MPI_LAND, comm);
+    SC_CHECK_MPI (mpiret);
+    return global_success ? read_success : read_failure;
+  }
   /* Read the file and set the pointer to the vtkGrid */
   if (!partition || mpirank == main_proc) {
     switch (vtk_file_type) {
@@ -137,14 +152,9 @@ t8_file_to_vtkGrid (const char *filename,
       main_proc_read_successful = t8_read_poly (filename, vtkGrid);
       break;
     case VTK_PARALLEL_UNSTRUCTURED_FILE:
-      if (!partition) {
-        main_proc_read_successful = t8_read_unstructured (filename, vtkGrid);
-      }
-      else {
-        t8_errorf ("Distributed reading is not supported yet.\n");
-        vtkGrid = NULL;
-        break;
-      }
+      /* Without partitioning the whole parallel file is read on the
+       * main process like a serial one. */
+      main_proc_read_successful = t8_read_unstructured (filename, vtkGrid);
       break;
     default:
       vtkGrid = NULL;
@@ -203,19 +213,24 @@ t8_get_dimension (vtkSmartPointer < vtkDataSet > vtkGrid)
  * function construct a cmesh on a single process. 
  * 
  * \param[in] vtkGrid The vtkGrid that gets tranlated
- * \param[in, out] cmesh   An empty cmesh that is filled with the data. 
- * \param[in] comm        A communicator. 
- * \return  The number of elements that have been read by the process.  
+ * \param[in, out] cmesh   An empty cmesh that is filled with the data.
+ * \param[in] first_tree  The global id of the tree that the first cell of
+ *                        \a vtkGrid becomes. 0 if \a vtkGrid is the whole
+ *                        dataset; the offset of the process's cell range
+ *                        if the dataset was read distributed.
+ * \param[in] comm        A communicator.
+ * \return  The number of elements that have been read by the process.
  */
 
 t8_gloidx_t
 t8_vtk_iterate_cells (vtkSmartPointer < vtkDataSet > vtkGrid,
-                      t8_cmesh_t cmesh, sc_MPI_Comm comm)
+                      t8_cmesh_t cmesh, const t8_gloidx_t first_tree,
+                      sc_MPI_Comm comm)
 {
 
   double            **tuples = NULL;
   size_t             *data_size = NULL;
-  t8_gloidx_t         tree_id = 0;
+  t8_gloidx_t         tree_id = first_tree;
   int                 max_dim = -1;
 
   vtkCellIterator    *cell_it;
@@ -298,7 +313,7 @@ t8_vtk_iterate_cells (vtkSmartPointer < vtkDataSet > vtkGrid,
     T8_FREE (tuples);
   }
   T8_FREE (vertices);
-  return tree_id;
+  return tree_id - first_tree;
 }
 
 t8_cmesh_t
@@ -325,7 +340,7 @@ t8_vtkGrid_to_cmesh (vtkSmartPointer < vtkDataSet > vtkGrid,
 
   t8_cmesh_init (&cmesh);
   if (!partition || mpirank == main_proc) {
-    num_trees = t8_vtk_iterate_cells (vtkGrid, cmesh, comm);
+    num_trees = t8_vtk_iterate_cells (vtkGrid, cmesh, 0, comm);
     dim = t8_get_dimension (vtkGrid);
     t8_cmesh_set_dimension (cmesh, dim);
     t8_geometry_c      *linear_geom = t8_geometry_linear_new (dim);
@@ -367,6 +382,64 @@ t8_vtkGrid_to_cmesh (vtkSmartPointer < vtkDataSet > vtkGrid,
   return cmesh;
 }
 
+t8_cmesh_t
+t8_vtkGrid_to_cmesh_distributed (vtkSmartPointer < vtkDataSet > vtkGrid,
+                                 sc_MPI_Comm comm)
+{
+  t8_cmesh_t          cmesh;
+  int                 mpisize;
+  int                 mpirank;
+  int                 mpiret;
+  int                 dim_local = -1;
+  int                 dim;
+  t8_gloidx_t         first_tree = 0;
+  t8_gloidx_t         num_read;
+
+  /* Get the size of the communicator and the rank of the process. */
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  /* Every process holds its own portion of the cells. The exclusive
+   * prefix sum of the local cell counts gives the global id of the
+   * process's first tree. */
+  t8_gloidx_t         num_local_trees =
+    (t8_gloidx_t) vtkGrid->GetNumberOfCells ();
+  mpiret = sc_MPI_Exscan (&num_local_trees, &first_tree, 1, T8_MPI_GLOIDX,
+                          sc_MPI_SUM, comm);
+  SC_CHECK_MPI (mpiret);
+  if (mpirank == 0) {
+    /* Exscan leaves the result on rank 0 undefined. */
+    first_tree = 0;
+  }
+
+  /* The dimension can only be computed from processes that hold cells.
+   * We agree on the maximum over all portions. */
+  if (num_local_trees > 0) {
+    dim_local = t8_get_dimension (vtkGrid);
+  }
+  mpiret = sc_MPI_Allreduce (&dim_local, &dim, 1, sc_MPI_INT, sc_MPI_MAX,
+                             comm);
+  SC_CHECK_MPI (mpiret);
+  SC_CHECK_ABORT (dim >= 0, "Cannot read a dataset without any cells.\n");
+
+  t8_cmesh_init (&cmesh);
+  t8_cmesh_set_dimension (cmesh, dim);
+  t8_geometry_c      *linear_geom = t8_geometry_linear_new (dim);
+  t8_cmesh_register_geometry (cmesh, linear_geom);
+  /* Insert the local cells as trees with their global tree ids. */
+  num_read = t8_vtk_iterate_cells (vtkGrid, cmesh, first_tree, comm);
+  T8_ASSERT (num_read == num_local_trees);
+  /* The trees of each process form one contiguous range, so the cmesh is
+   * committed directly as partitioned and the dataset is never resident
+   * on a single process. Processes without cells get an empty part. */
+  t8_cmesh_set_partition_range (cmesh, 3, first_tree,
+                                first_tree + num_local_trees - 1);
+  t8_cmesh_commit (cmesh, comm);
+  return cmesh;
+}
+
 vtkSmartPointer < vtkPointSet >
 t8_vtkGrid_to_vtkPointSet (vtkSmartPointer < vtkDataSet > vtkGrid)
 {
@@ -480,8 +553,15 @@ t8_vtk_reader_cmesh (const char *filename, const int partition,
   vtkSmartPointer < vtkDataSet > vtkGrid =
     t8_vtk_reader (filename, partition, main_proc, comm, vtk_file_type);
   if (vtkGrid != NULL) {
-    t8_cmesh_t          cmesh =
-      t8_vtkGrid_to_cmesh (vtkGrid, partition, main_proc, comm);
+    t8_cmesh_t          cmesh;
+    if (partition && vtk_file_type == VTK_PARALLEL_UNSTRUCTURED_FILE) {
+      /* The pieces of the parallel file were read distributed, every
+       * process translates its own cells. */
+      cmesh = t8_vtkGrid_to_cmesh_distributed (vtkGrid, comm);
+    }
+    else {
+      cmesh = t8_vtkGrid_to_cmesh (vtkGrid, partition, main_proc, comm);
+    }
     T8_ASSERT (cmesh != NULL);
     return cmesh;
   }
@@ -52,6 +52,26 @@ t8_cmesh_t          t8_vtkGrid_to_cmesh (vtkSmartPointer < vtkDataSet >
                                          const int main_proc,
                                          sc_MPI_Comm comm);
 
+/**
+ * Construct a partitioned cmesh from a vtkDataSet that was read
+ * distributed, that is, every process passes its own portion of the
+ * cells (for example its range of the pieces of a parallel vtk file).
+ * The cells of each process become one contiguous range of trees, whose
+ * offsets are computed from a prefix sum of the local cell counts, and
+ * the cmesh is committed directly as partitioned via
+ * \ref t8_cmesh_set_partition_range. The dataset is never gathered on a
+ * single process. Processes without cells get an empty part.
+ * Collective over \a comm.
+ *
+ * \param[in] vtkGrid The process's portion of the dataset. May be empty,
+ *                    but not NULL.
+ * \param[in] comm The communicator.
+ * \return The committed, partitioned cmesh.
+ */
+t8_cmesh_t          t8_vtkGrid_to_cmesh_distributed (vtkSmartPointer <
+                                                     vtkDataSet > vtkGrid,
+                                                     sc_MPI_Comm comm);
+
 /**
  * Given a pointer to a vtkDataSet a vtkPointSet storing a set of points of
  * is constructed. The cell data of vtkDataSet is mapt on the points of vtkPointSet. 
@@ -0,0 +1,154 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8.h>
+#include <t8_cmesh/t8_cmesh_offset.h>
+
+/* Test the run-length compressed partition offsets against the
+ * uncompressed t8_offset_* queries on a set of offset tables covering
+ * uniform partitions, shared first trees and empty ranks. */
+
+/* Check that the compressed form of an offset table reproduces every
+ * entry, first/last tree and first owner of the uncompressed table. */
+static void
+t8_test_offset_compressed_check (const t8_gloidx_t *offset, int mpisize)
+{
+  t8_offset_compressed_t *compressed;
+  t8_gloidx_t         gtree, num_global_trees;
+  int                 proc, iproc, first_owner;
+
+  compressed = t8_offset_compressed_new (offset, mpisize);
+  /* The compressed form must never be larger than the full table */
+  EXPECT_LE (compressed->num_runs, (size_t) mpisize + 1);
+  for (proc = 0; proc <= mpisize; proc++) {
+    EXPECT_EQ (t8_offset_compressed_get (compressed, proc), offset[proc]);
+  }
+  for (proc = 0; proc < mpisize; proc++) {
+    EXPECT_EQ (t8_offset_compressed_first (compressed, proc),
+               t8_offset_first (proc, offset));
+    EXPECT_EQ (t8_offset_compressed_last (compressed, proc),
+               t8_offset_last (proc, offset));
+  }
+  /* Check the owner search for every tree of the partition */
+  num_global_trees = T8_GLOIDX_ABS (offset[mpisize]);
+  for (gtree = 0; gtree < num_global_trees; gtree++) {
+    first_owner = t8_offset_compressed_first_owner (compressed, gtree);
+    /* The returned process owns the tree */
+    EXPECT_LE (t8_offset_first (first_owner, offset), gtree);
+    EXPECT_LE (gtree, t8_offset_last (first_owner, offset));
+    /* and no smaller process does */
+    for (iproc = 0; iproc < first_owner; iproc++) {
+      EXPECT_FALSE (t8_offset_first (iproc, offset) <= gtree
+                    && gtree <= t8_offset_last (iproc, offset)
+                    && t8_offset_num_trees (iproc, offset) > 0);
+    }
+  }
+  t8_offset_compressed_destroy (&compressed);
+  EXPECT_EQ (compressed, (t8_offset_compressed_t *) NULL);
+}
+
+/* A perfectly uniform partition compresses into a single run. */
+TEST (t8_gtest_offset_compressed, uniform)
+{
+  const int           mpisize = 17;
+  t8_gloidx_t         offset[mpisize + 1];
+  t8_offset_compressed_t *compressed;
+  int                 proc;
+
+  for (proc = 0; proc <= mpisize; proc++) {
+    offset[proc] = 5 * proc;
+  }
+  compressed = t8_offset_compressed_new (offset, mpisize);
+  EXPECT_EQ (compressed->num_runs, (size_t) 1);
+  EXPECT_LT (t8_offset_compressed_bytes (compressed),
+             (mpisize + 1) * sizeof (t8_gloidx_t));
+  t8_offset_compressed_destroy (&compressed);
+  t8_test_offset_compressed_check (offset, mpisize);
+}
+
+/* An almost uniform partition whose remainder trees go to the first
+ * ranks, as the uniform partition routines produce. */
+TEST (t8_gtest_offset_compressed, uniform_with_remainder)
+{
+  const int           mpisize = 23;
+  const t8_gloidx_t   num_trees = 4 * mpisize + 7;
+  t8_gloidx_t         offset[mpisize + 1];
+  int                 proc;
+
+  for (proc = 0; proc <= mpisize; proc++) {
+    offset[proc] = (num_trees * proc) / mpisize;
+  }
+  t8_test_offset_compressed_check (offset, mpisize);
+}
+
+/* Shared first trees are stored as negative entries and must survive
+ * the compression. */
+TEST (t8_gtest_offset_compressed, shared_trees)
+{
+  const int           mpisize = 8;
+  t8_gloidx_t         offset[mpisize + 1];
+  int                 proc;
+
+  for (proc = 0; proc <= mpisize; proc++) {
+    offset[proc] = 3 * proc;
+  }
+  /* Every other rank shares its first tree with its predecessor */
+  for (proc = 1; proc < mpisize; proc += 2) {
+    offset[proc] = t8_offset_first_tree_to_entry (3 * proc - 1, 1);
+  }
+  t8_test_offset_compressed_check (offset, mpisize);
+}
+
+/* Empty ranks repeat the entry of their successor; the owner search
+ * must skip them. */
+TEST (t8_gtest_offset_compressed, empty_ranks)
+{
+  const int           mpisize = 12;
+  t8_gloidx_t         offset[mpisize + 1];
+  int                 proc;
+
+  /* Ranks 0-2 hold two trees each, ranks 3-8 are empty,
+   * ranks 9-11 hold the remaining trees. */
+  for (proc = 0; proc <= mpisize; proc++) {
+    if (proc <= 3) {
+      offset[proc] = 2 * proc;
+    }
+    else if (proc <= 9) {
+      offset[proc] = 6;
+    }
+    else {
+      offset[proc] = 6 + 2 * (proc - 9);
+    }
+  }
+  t8_test_offset_compressed_check (offset, mpisize);
+}
+
+/* A partition with no structure at all falls back to one run per
+ * breakpoint but must still answer all queries correctly. */
+TEST (t8_gtest_offset_compressed, irregular)
+{
+  const t8_gloidx_t   offset[] = { 0, 1, 5, 6, 13, 13, 14, 27, 31 };
+  const int           mpisize = 8;
+
+  t8_test_offset_compressed_check (offset, mpisize);
+}
@@ -0,0 +1,119 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/* In this test we adapt a forest once with the per-element adapt callback
+ * and once with the batched adapt callback of t8_forest_set_adapt_batched.
+ * Both callbacks encode the same criterion, hence the two adapted forests
+ * must have the same number of elements.
+ */
+
+#include <gtest/gtest.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_data/t8_containers.h>
+
+/* The refinement criterion shared by both callbacks:
+ * refine every fifth element, coarsen the elements directly after it. */
+static int
+t8_test_batched_criterion (t8_locidx_t lelement_id)
+{
+  if (lelement_id % 5 == 0) {
+    return 1;
+  }
+  if (lelement_id % 5 == 1) {
+    return -1;
+  }
+  return 0;
+}
+
+/* Per-element adapt callback evaluating the criterion. */
+static int
+t8_test_adapt_per_element (t8_forest_t forest, t8_forest_t forest_from,
+                           t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                           t8_eclass_scheme_c *ts, const int is_family,
+                           const int num_elements, t8_element_t *elements[])
+{
+  const int           refine = t8_test_batched_criterion (lelement_id);
+  if (refine == -1 && !is_family) {
+    return 0;
+  }
+  if (refine == -1 && is_family) {
+    /* Only coarsen if all family members are flagged for coarsening,
+     * mimicking the batched semantics. */
+    for (int ielem = 0; ielem < num_elements; ielem++) {
+      if (t8_test_batched_criterion (lelement_id + ielem) != -1) {
+        return 0;
+      }
+    }
+  }
+  return refine;
+}
+
+/* Batched adapt callback evaluating the criterion for a whole tree. */
+static void
+t8_test_adapt_batched (t8_forest_t forest, t8_forest_t forest_from,
+                       t8_locidx_t which_tree, t8_eclass_scheme_c *ts,
+                       const t8_locidx_t num_elements,
+                       const t8_element_array_t *elements,
+                       short *refine_flags)
+{
+  for (t8_locidx_t ielem = 0; ielem < num_elements; ielem++) {
+    refine_flags[ielem] = t8_test_batched_criterion (ielem);
+  }
+}
+
+TEST (adapt_batched, same_result_as_per_element)
+{
+  const int           level = 3;
+  t8_cmesh_t          cmesh =
+    t8_cmesh_new_hypercube (T8_ECLASS_QUAD, sc_MPI_COMM_WORLD, 0, 0, 0);
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_cmesh_ref (cmesh);
+  t8_scheme_cxx_ref (scheme);
+  t8_forest_t         forest_a =
+    t8_forest_new_uniform (cmesh, scheme, level, 0, sc_MPI_COMM_WORLD);
+  t8_forest_t         forest_b =
+    t8_forest_new_uniform (cmesh, scheme, level, 0, sc_MPI_COMM_WORLD);
+
+  /* Adapt forest_a with the per-element callback. */
+  t8_forest_t         forest_adapt_a;
+  t8_forest_init (&forest_adapt_a);
+  t8_forest_set_adapt (forest_adapt_a, forest_a, t8_test_adapt_per_element,
+                       0);
+  t8_forest_commit (forest_adapt_a);
+
+  /* Adapt forest_b with the batched callback. */
+  t8_forest_t         forest_adapt_b;
+  t8_forest_init (&forest_adapt_b);
+  t8_forest_set_adapt_batched (forest_adapt_b, forest_b,
+                               t8_test_adapt_batched);
+  t8_forest_commit (forest_adapt_b);
+
+  ASSERT_EQ (t8_forest_get_global_num_elements (forest_adapt_a),
+             t8_forest_get_global_num_elements (forest_adapt_b))
+    << "Batched and per-element adaptation disagree.";
+
+  t8_forest_unref (&forest_adapt_a);
+  t8_forest_unref (&forest_adapt_b);
+}
@@ -0,0 +1,277 @@
+/*
+This file is part of t8code.
+t8code is a C library to manage a collection (a forest) of multiple
+connected adaptive space-trees of general element classes in parallel.
+
+Copyright (C) 2015 the developers
+
+t8code is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+t8code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with t8code; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_element_cxx.hxx>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_adapt.h>
+#include <t8_forest/t8_forest_device.h>
+
+/**
+ * This file tests the device resident forest mirror. The memory
+ * operations are backed by plain host memory, so the "device" buffers
+ * can be inspected directly: the mirror of a forest must reproduce the
+ * leaf keys, tree offsets and face index of the forest, and an
+ * incremental sync after a journaled adapt must leave the buffers in
+ * the same state as a full re-upload.
+ */
+
+/* Host backed device memory operations. The user pointer counts the
+ * uploaded bytes, so tests can verify that the incremental sync
+ * transfers less than a full upload. */
+
+static void        *
+t8_test_device_alloc (size_t bytes, void *user)
+{
+  return malloc (bytes);
+}
+
+static void
+t8_test_device_free (void *ptr, void *user)
+{
+  free (ptr);
+}
+
+static void
+t8_test_device_copy_to (void *device_dst, const void *host_src, size_t bytes,
+                        void *user)
+{
+  *(size_t *) user += bytes;
+  memcpy (device_dst, host_src, bytes);
+}
+
+static void
+t8_test_device_copy_on (void *device_dst, const void *device_src,
+                        size_t bytes, void *user)
+{
+  memmove (device_dst, device_src, bytes);
+}
+
+/* Refine the element with child id 1 and no other elements */
+static int
+t8_test_device_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                      t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                      t8_eclass_scheme_c *ts, const int is_family,
+                      const int num_elements, t8_element_t *elements[])
+{
+  return ts->t8_element_child_id (elements[0]) == 1;
+}
+
+/* Keep every element unchanged */
+static int
+t8_test_device_adapt_keep (t8_forest_t forest, t8_forest_t forest_from,
+                           t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                           t8_eclass_scheme_c *ts, const int is_family,
+                           const int num_elements, t8_element_t *elements[])
+{
+  return 0;
+}
+
+/* Compare the leaf buffers and tree offsets of a mirror against a
+ * direct recomputation from the forest. */
+static void
+t8_test_device_check_mirror (t8_forest_device_mirror_t *mirror,
+                             t8_forest_t forest)
+{
+  const t8_locidx_t   num_local = t8_forest_get_local_num_elements (forest);
+  const t8_locidx_t   num_trees = t8_forest_get_num_local_trees (forest);
+
+  ASSERT_EQ (mirror->num_local_elements, num_local);
+  ASSERT_EQ (mirror->num_trees, num_trees);
+  EXPECT_EQ (mirror->generation, t8_forest_get_generation (forest));
+
+  for (t8_locidx_t ielem = 0; ielem < num_local; ielem++) {
+    t8_locidx_t         ltree;
+    t8_element_t       *leaf = t8_forest_get_element (forest, ielem, &ltree);
+    t8_eclass_scheme_c *ts =
+      t8_forest_get_eclass_scheme (forest,
+                                   t8_forest_get_tree_class (forest, ltree));
+    EXPECT_EQ (mirror->d_leaf_keys[ielem],
+               ts->t8_element_get_linear_id (leaf,
+                                             t8_forest_get_maxlevel
+                                             (forest)))
+      << "Key mismatch at element " << ielem;
+    EXPECT_EQ (mirror->d_leaf_levels[ielem],
+               (int8_t) ts->t8_element_level (leaf))
+      << "Level mismatch at element " << ielem;
+  }
+  for (t8_locidx_t itree = 0; itree < num_trees; itree++) {
+    EXPECT_EQ (mirror->d_tree_offsets[itree],
+               t8_forest_get_tree_element_offset (forest, itree));
+  }
+  EXPECT_EQ (mirror->d_tree_offsets[num_trees], num_local);
+}
+
+/* Compare the mirrored face index against direct queries */
+static void
+t8_test_device_check_faces (t8_forest_device_mirror_t *mirror,
+                            t8_forest_t forest)
+{
+  const t8_locidx_t   num_local = t8_forest_get_local_num_elements (forest);
+
+  ASSERT_NE (mirror->d_face_offsets, (t8_locidx_t *) NULL);
+  for (t8_locidx_t ielem = 0; ielem < num_local; ielem++) {
+    t8_locidx_t         ltree;
+    t8_element_t       *leaf = t8_forest_get_element (forest, ielem, &ltree);
+    t8_eclass_scheme_c *ts =
+      t8_forest_get_eclass_scheme (forest,
+                                   t8_forest_get_tree_class (forest, ltree));
+    const int           num_faces = ts->t8_element_num_faces (leaf);
+    ASSERT_EQ (mirror->d_face_offsets[ielem + 1]
+               - mirror->d_face_offsets[ielem], num_faces);
+    for (int iface = 0; iface < num_faces; iface++) {
+      int                 num_neighbors;
+      const t8_locidx_t  *neighbor_indices;
+      const int8_t       *dual_faces;
+      t8_forest_face_neighbor_index_query (forest, ielem, iface,
+                                           &num_neighbors,
+                                           &neighbor_indices, &dual_faces);
+      const t8_locidx_t   row = mirror->d_face_offsets[ielem] + iface;
+      const t8_locidx_t   first = mirror->d_entry_offsets[row];
+      ASSERT_EQ (mirror->d_entry_offsets[row + 1] - first, num_neighbors);
+      for (int ineigh = 0; ineigh < num_neighbors; ineigh++) {
+        EXPECT_EQ (mirror->d_face_neighbors[first + ineigh],
+                   neighbor_indices[ineigh]);
+        EXPECT_EQ (mirror->d_dual_faces[first + ineigh],
+                   dual_faces[ineigh]);
+      }
+    }
+  }
+}
+
+TEST (device_mirror, create_matches_forest)
+{
+  size_t              uploaded = 0;
+  t8_forest_device_memops_t memops =
+    { t8_test_device_alloc, t8_test_device_free, t8_test_device_copy_to,
+    t8_test_device_copy_on, &uploaded
+  };
+  t8_cmesh_t          cmesh =
+    t8_cmesh_new_hypercube (T8_ECLASS_QUAD, sc_MPI_COMM_WORLD, 0, 0, 0);
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest =
+    t8_forest_new_uniform (cmesh, scheme, 3, 1, sc_MPI_COMM_WORLD);
+
+  t8_forest_face_neighbor_index_create (forest);
+  t8_forest_device_mirror_t *mirror =
+    t8_forest_device_mirror_create (forest, &memops);
+
+  EXPECT_GT (uploaded, (size_t) 0);
+  t8_test_device_check_mirror (mirror, forest);
+  t8_test_device_check_faces (mirror, forest);
+
+  t8_forest_device_mirror_destroy (&mirror);
+  EXPECT_EQ (mirror, (t8_forest_device_mirror_t *) NULL);
+  t8_forest_unref (&forest);
+}
+
+TEST (device_mirror, sync_incremental_after_journaled_adapt)
+{
+  size_t              uploaded = 0;
+  t8_forest_device_memops_t memops =
+    { t8_test_device_alloc, t8_test_device_free, t8_test_device_copy_to,
+    t8_test_device_copy_on, &uploaded
+  };
+  t8_cmesh_t          cmesh =
+    t8_cmesh_new_hypercube (T8_ECLASS_QUAD, sc_MPI_COMM_WORLD, 0, 0, 0);
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest =
+    t8_forest_new_uniform (cmesh, scheme, 3, 1, sc_MPI_COMM_WORLD);
+
+  t8_forest_device_mirror_t *mirror =
+    t8_forest_device_mirror_create (forest, &memops);
+
+  /* Refine a few elements while recording the adapt journal */
+  t8_forest_ref (forest);
+  t8_forest_t         forest_adapt;
+  t8_forest_init (&forest_adapt);
+  t8_forest_set_adapt (forest_adapt, forest, t8_test_device_adapt, 0);
+  t8_forest_set_adapt_journal (forest_adapt, 1);
+  t8_forest_set_ghost (forest_adapt, 1, T8_GHOST_FACES);
+  t8_forest_commit (forest_adapt);
+
+  /* The adapt grows the forest beyond the mirrored buffers, so this
+   * first sync re-uploads fully and sizes the buffers for the adapted
+   * forest. */
+  uploaded = 0;
+  t8_forest_device_mirror_sync (mirror, forest_adapt);
+  const size_t        full_upload = uploaded;
+  t8_test_device_check_mirror (mirror, forest_adapt);
+
+  /* Adapt once more without changing any element: the delta is empty
+   * and the incremental sync must transfer almost nothing. */
+  t8_forest_ref (forest_adapt);
+  t8_forest_t         forest_same;
+  t8_forest_init (&forest_same);
+  t8_forest_set_adapt (forest_same, forest_adapt,
+                       t8_test_device_adapt_keep, 0);
+  t8_forest_set_adapt_journal (forest_same, 1);
+  t8_forest_set_ghost (forest_same, 1, T8_GHOST_FACES);
+  t8_forest_commit (forest_same);
+
+  uploaded = 0;
+  const int           incremental =
+    t8_forest_device_mirror_sync (mirror, forest_same);
+  EXPECT_TRUE (incremental);
+  EXPECT_LT (uploaded, full_upload);
+  t8_test_device_check_mirror (mirror, forest_same);
+
+  t8_forest_device_mirror_destroy (&mirror);
+  t8_forest_unref (&forest_same);
+  t8_forest_unref (&forest_adapt);
+  t8_forest_unref (&forest);
+}
+
+TEST (device_mirror, sync_full_without_journal)
+{
+  size_t              uploaded = 0;
+  t8_forest_device_memops_t memops =
+    { t8_test_device_alloc, t8_test_device_free, t8_test_device_copy_to,
+    NULL, &uploaded
+  };
+  t8_cmesh_t          cmesh =
+    t8_cmesh_new_hypercube (T8_ECLASS_HEX, sc_MPI_COMM_WORLD, 0, 0, 0);
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest =
+    t8_forest_new_uniform (cmesh, scheme, 2, 1, sc_MPI_COMM_WORLD);
+
+  t8_forest_device_mirror_t *mirror =
+    t8_forest_device_mirror_create (forest, &memops);
+
+  /* Adapt without recording the journal: the sync must fall back to a
+   * full re-upload and still reproduce the new forest. */
+  t8_forest_ref (forest);
+  t8_forest_t         forest_adapt =
+    t8_forest_new_adapt (forest, t8_test_device_adapt, 0, 0, NULL);
+
+  const int           incremental =
+    t8_forest_device_mirror_sync (mirror, forest_adapt);
+  EXPECT_FALSE (incremental);
+  t8_test_device_check_mirror (mirror, forest_adapt);
+
+  t8_forest_device_mirror_destroy (&mirror);
+  t8_forest_unref (&forest_adapt);
+  t8_forest_unref (&forest);
+}
@@ -0,0 +1,110 @@
+/*
+This file is part of t8code.
+t8code is a C library to manage a collection (a forest) of multiple
+connected adaptive space-trees of general element classes in parallel.
+
+Copyright (C) 2015 the developers
+
+t8code is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+t8code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with t8code; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_eclass.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_element_cxx.hxx>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_geometrical.h>
+
+/**
+ * This file tests t8_forest_element_coordinates_all, the batched
+ * structure-of-arrays corner coordinate computation. The coordinates of
+ * the tree-wise pass must be bitwise equal to the per corner results of
+ * t8_forest_element_coordinate.
+ */
+
+/* *INDENT-OFF* */
+class t8_forest_coordinates_all:public testing::TestWithParam <std::tuple<t8_eclass_t, int>> {
+    protected:
+        void SetUp () override{
+            eclass = std::get<0> (GetParam ());
+            level = std::get<1> (GetParam ());
+            scheme = t8_scheme_new_default_cxx ();
+            t8_cmesh_t cmesh = t8_cmesh_new_hypercube (eclass, sc_MPI_COMM_WORLD, 0, 0, 0);
+            forest = t8_forest_new_uniform (cmesh, scheme, level, 0, sc_MPI_COMM_WORLD);
+        }
+        void TearDown () override {
+            t8_forest_unref (&forest);
+        }
+    t8_forest_t forest;
+    t8_scheme_cxx * scheme;
+    t8_eclass_t eclass;
+    int level;
+};
+
+/* *INDENT-ON* */
+
+TEST_P (t8_forest_coordinates_all, compare_per_corner)
+{
+  const t8_locidx_t   local_num_trees =
+    t8_forest_get_num_local_trees (forest);
+  t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, eclass);
+
+  for (t8_locidx_t itree = 0; itree < local_num_trees; itree++) {
+    const t8_locidx_t   tree_elements =
+      t8_forest_get_tree_num_elements (forest, itree);
+    /* The number of vertices of the tree class is an upper bound for the
+     * number of corners of each element in the tree. */
+    const t8_locidx_t   max_corners =
+      tree_elements * t8_eclass_num_vertices[eclass];
+    double             *x = T8_ALLOC (double, max_corners);
+    double             *y = T8_ALLOC (double, max_corners);
+    double             *z = T8_ALLOC (double, max_corners);
+
+    const t8_locidx_t   num_written =
+      t8_forest_element_coordinates_all (forest, itree, x, y, z);
+    ASSERT_LE (num_written, max_corners);
+
+    /* Recompute every corner with the per corner routine and compare. */
+    t8_locidx_t         icoord = 0;
+    for (t8_locidx_t ielement = 0; ielement < tree_elements; ielement++) {
+      const t8_element_t *element =
+        t8_forest_get_element_in_tree (forest, itree, ielement);
+      const int           num_corners = ts->t8_element_num_corners (element);
+      for (int icorner = 0; icorner < num_corners; icorner++) {
+        double              coordinates[3];
+        t8_forest_element_coordinate (forest, itree, element, icorner,
+                                      coordinates);
+        ASSERT_LT (icoord, num_written);
+        EXPECT_EQ (x[icoord], coordinates[0]);
+        EXPECT_EQ (y[icoord], coordinates[1]);
+        EXPECT_EQ (z[icoord], coordinates[2]);
+        icoord++;
+      }
+    }
+    /* The batched routine must write exactly one entry per corner. */
+    EXPECT_EQ (icoord, num_written);
+
+    T8_FREE (x);
+    T8_FREE (y);
+    T8_FREE (z);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P (t8_gtest_element_coordinates_all,
+                          t8_forest_coordinates_all,
+                          testing::Combine (testing::Range (T8_ECLASS_ZERO,
+                                                            T8_ECLASS_COUNT),
+                                            testing::Range (0, 4)));
@@ -0,0 +1,89 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/* In this test we build the face neighbor index of a uniform forest and
+ * check that each query returns the same neighbors and dual faces as a
+ * direct call to t8_forest_leaf_face_neighbors.
+ */
+
+#include <gtest/gtest.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_element_cxx.hxx>
+
+TEST (face_neighbor_index, matches_leaf_face_neighbors)
+{
+  const int           level = 3;
+  t8_cmesh_t          cmesh =
+    t8_cmesh_new_hypercube (T8_ECLASS_QUAD, sc_MPI_COMM_WORLD, 0, 0, 0);
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  /* Create a uniform forest with a face ghost layer */
+  t8_forest_t         forest =
+    t8_forest_new_uniform (cmesh, scheme, level, 1, sc_MPI_COMM_WORLD);
+
+  t8_forest_face_neighbor_index_create (forest);
+
+  for (t8_locidx_t ielem = 0;
+       ielem < t8_forest_get_local_num_elements (forest); ielem++) {
+    t8_locidx_t         ltree;
+    t8_element_t       *leaf = t8_forest_get_element (forest, ielem, &ltree);
+    t8_eclass_scheme_c *ts =
+      t8_forest_get_eclass_scheme (forest,
+                                   t8_forest_get_tree_class (forest, ltree));
+    for (int iface = 0; iface < ts->t8_element_num_faces (leaf); iface++) {
+      /* Compute the neighbors directly */
+      t8_element_t      **neighbor_leafs;
+      t8_eclass_scheme_c *neigh_scheme;
+      t8_locidx_t        *element_indices;
+      int                *dual_faces, num_neighbors;
+      t8_forest_leaf_face_neighbors (forest, ltree, leaf, &neighbor_leafs,
+                                     iface, &dual_faces, &num_neighbors,
+                                     &element_indices, &neigh_scheme, 1);
+      /* Query the index */
+      int                 num_neighbors_index;
+      const t8_locidx_t  *neighbor_indices;
+      const int8_t       *dual_faces_index;
+      t8_forest_face_neighbor_index_query (forest, ielem, iface,
+                                           &num_neighbors_index,
+                                           &neighbor_indices,
+                                           &dual_faces_index);
+      ASSERT_EQ (num_neighbors, num_neighbors_index)
+        << "Neighbor count differs for element " << ielem << " face " <<
+        iface;
+      for (int ineigh = 0; ineigh < num_neighbors; ineigh++) {
+        EXPECT_EQ (element_indices[ineigh], neighbor_indices[ineigh]);
+        EXPECT_EQ (dual_faces[ineigh], (int) dual_faces_index[ineigh]);
+      }
+      if (num_neighbors > 0) {
+        neigh_scheme->t8_element_destroy (num_neighbors, neighbor_leafs);
+        T8_FREE (element_indices);
+        T8_FREE (neighbor_leafs);
+        T8_FREE (dual_faces);
+      }
+    }
+  }
+
+  t8_forest_face_neighbor_index_destroy (forest);
+  t8_forest_unref (&forest);
+}
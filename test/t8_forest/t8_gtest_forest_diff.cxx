@@ -0,0 +1,183 @@
+/*
+This file is part of t8code.
+t8code is a C library to manage a collection (a forest) of multiple
+connected adaptive space-trees of general element classes in parallel.
+
+Copyright (C) 2015 the developers
+
+t8code is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+t8code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with t8code; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_eclass.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_element_cxx.hxx>
+#include <t8_forest/t8_forest_general.h>
+
+/**
+ * This file tests t8_forest_diff.
+ * Two forests with the same elements must produce an empty diff, and
+ * the changed ranges of an adapted forest must agree with a brute-force
+ * per-tree prefix/suffix comparison of the element sequences.
+ */
+
+/* *INDENT-OFF* */
+class t8_forest_diff_test:public testing::TestWithParam <std::tuple<t8_eclass_t, int>> {
+    protected:
+        void SetUp () override{
+            eclass = std::get<0> (GetParam ());
+            level = std::get<1> (GetParam ());
+            scheme = t8_scheme_new_default_cxx ();
+            cmesh = t8_cmesh_new_hypercube (eclass, sc_MPI_COMM_WORLD, 0, 0, 0);
+            /* Keep cmesh and scheme alive, so that further forests can be
+             * built over the same objects. */
+            t8_cmesh_ref (cmesh);
+            t8_scheme_cxx_ref (scheme);
+            forest = t8_forest_new_uniform (cmesh, scheme, level, 0, sc_MPI_COMM_WORLD);
+        }
+        void TearDown () override {
+            t8_forest_unref (&forest);
+            t8_scheme_cxx_unref (&scheme);
+            t8_cmesh_destroy (&cmesh);
+        }
+    t8_forest_t forest;
+    t8_cmesh_t cmesh;
+    t8_scheme_cxx * scheme;
+    t8_eclass_t eclass;
+    int level;
+};
+
+/* *INDENT-ON* */
+
+/* Refine the element with child id 1 and no other elements, so that a
+ * single contiguous range inside each tree changes. */
+static int
+t8_test_diff_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                    t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                    t8_eclass_scheme_c *ts, const int is_family,
+                    const int num_elements, t8_element_t *elements[])
+{
+  return ts->t8_element_child_id (elements[0]) == 1;
+}
+
+/* Compute the changed range of a local tree by comparing the element
+ * sequences of both forests from the front and from the back. Returns
+ * true if the tree differs and fills the range entries. */
+static int
+t8_test_diff_brute_force (t8_forest_t forest_a, t8_forest_t forest_b,
+                          t8_locidx_t itree, t8_forest_diff_range_t *range)
+{
+  t8_eclass_scheme_c *ts =
+    t8_forest_get_eclass_scheme (forest_a,
+                                 t8_forest_get_tree_class (forest_a, itree));
+  const t8_locidx_t   num_a = t8_forest_get_tree_num_elements (forest_a,
+                                                               itree);
+  const t8_locidx_t   num_b = t8_forest_get_tree_num_elements (forest_b,
+                                                               itree);
+  const t8_locidx_t   num_min = SC_MIN (num_a, num_b);
+  t8_locidx_t         prefix, suffix;
+
+  for (prefix = 0; prefix < num_min; prefix++) {
+    if (ts->t8_element_compare
+        (t8_forest_get_element_in_tree (forest_a, itree, prefix),
+         t8_forest_get_element_in_tree (forest_b, itree, prefix))) {
+      break;
+    }
+  }
+  for (suffix = 0; suffix < num_min - prefix; suffix++) {
+    if (ts->t8_element_compare
+        (t8_forest_get_element_in_tree (forest_a, itree,
+                                        num_a - 1 - suffix),
+         t8_forest_get_element_in_tree (forest_b, itree,
+                                        num_b - 1 - suffix))) {
+      break;
+    }
+  }
+  if (num_a - prefix - suffix <= 0 && num_b - prefix - suffix <= 0) {
+    return 0;
+  }
+  range->ltree_id = itree;
+  range->first_a = prefix;
+  range->num_a = num_a - prefix - suffix;
+  range->first_b = prefix;
+  range->num_b = num_b - prefix - suffix;
+  return 1;
+}
+
+TEST_P (t8_forest_diff_test, equal_forests_empty_diff)
+{
+  /* Build a second forest with the same elements over the same cmesh
+   * and scheme. */
+  t8_cmesh_ref (cmesh);
+  t8_scheme_cxx_ref (scheme);
+  t8_forest_t         forest_same =
+    t8_forest_new_uniform (cmesh, scheme, level, 0, sc_MPI_COMM_WORLD);
+
+  sc_array_t         *diff_ranges =
+    sc_array_new (sizeof (t8_forest_diff_range_t));
+  EXPECT_TRUE (t8_forest_diff (forest, forest_same, diff_ranges));
+  EXPECT_EQ (diff_ranges->elem_count, (size_t) 0);
+  EXPECT_TRUE (t8_forest_is_equal (forest, forest_same));
+
+  sc_array_destroy (diff_ranges);
+  t8_forest_unref (&forest_same);
+}
+
+TEST_P (t8_forest_diff_test, adapted_forest_ranges)
+{
+  /* Adapt the forest; the original forest must stay alive to be
+   * compared against. */
+  t8_forest_ref (forest);
+  t8_forest_t         forest_adapt =
+    t8_forest_new_adapt (forest, t8_test_diff_adapt, 0, 0, NULL);
+
+  sc_array_t         *diff_ranges =
+    sc_array_new (sizeof (t8_forest_diff_range_t));
+  const int           equal = t8_forest_diff (forest, forest_adapt,
+                                              diff_ranges);
+  EXPECT_EQ (equal, t8_forest_is_equal (forest, forest_adapt));
+
+  /* Compare the reported ranges against a brute-force computation.
+   * The ranges are reported in ascending tree order. */
+  const t8_locidx_t   num_local_trees =
+    t8_forest_get_num_local_trees (forest);
+  size_t              irange = 0;
+  for (t8_locidx_t itree = 0; itree < num_local_trees; itree++) {
+    t8_forest_diff_range_t expected;
+    if (t8_test_diff_brute_force (forest, forest_adapt, itree, &expected)) {
+      ASSERT_LT (irange, diff_ranges->elem_count);
+      const t8_forest_diff_range_t *range =
+        (const t8_forest_diff_range_t *) sc_array_index (diff_ranges,
+                                                         irange);
+      EXPECT_EQ (range->ltree_id, expected.ltree_id);
+      EXPECT_EQ (range->first_a, expected.first_a);
+      EXPECT_EQ (range->num_a, expected.num_a);
+      EXPECT_EQ (range->first_b, expected.first_b);
+      EXPECT_EQ (range->num_b, expected.num_b);
+      irange++;
+    }
+  }
+  EXPECT_EQ (irange, diff_ranges->elem_count);
+
+  sc_array_destroy (diff_ranges);
+  t8_forest_unref (&forest_adapt);
+}
+
+/* *INDENT-OFF* */
+INSTANTIATE_TEST_SUITE_P (t8_gtest_forest_diff, t8_forest_diff_test,
+                          testing::Combine (testing::Range (T8_ECLASS_ZERO, T8_ECLASS_COUNT),
+                                            testing::Range (1, 4)));
+/* *INDENT-ON* */
@@ -0,0 +1,199 @@
+/*
+This file is part of t8code.
+t8code is a C library to manage a collection (a forest) of multiple
+connected adaptive space-trees of general element classes in parallel.
+
+Copyright (C) 2015 the developers
+
+t8code is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+t8code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with t8code; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_eclass.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_element_cxx.hxx>
+#include <t8_forest/t8_forest_general.h>
+
+/**
+ * This file tests the element data field registry of the forest.
+ * Registered fields must be found by name, carried over to adapted and
+ * partitioned forests and their ghost entries must be filled by the
+ * collective field exchange.
+ */
+
+/* The constant values the fields are filled with. Since a new child
+ * inherits its parent's value and a new parent its first child's value,
+ * every entry must still hold these constants after adapt and partition. */
+#define T8_TEST_FIELDS_RHO 42.5
+#define T8_TEST_FIELDS_TAG 1337
+
+/* *INDENT-OFF* */
+class t8_forest_fields_test:public testing::TestWithParam <std::tuple<t8_eclass_t, int>> {
+    protected:
+        void SetUp () override{
+            eclass = std::get<0> (GetParam ());
+            level = std::get<1> (GetParam ());
+            scheme = t8_scheme_new_default_cxx ();
+            t8_cmesh_t cmesh = t8_cmesh_new_hypercube (eclass, sc_MPI_COMM_WORLD, 0, 0, 0);
+            /* Create the forest with a ghost layer, so that the field
+             * exchange has ghost entries to fill. */
+            forest = t8_forest_new_uniform (cmesh, scheme, level, 1, sc_MPI_COMM_WORLD);
+        }
+        void TearDown () override {
+            t8_forest_unref (&forest);
+        }
+    t8_forest_t forest;
+    t8_scheme_cxx * scheme;
+    t8_eclass_t eclass;
+    int level;
+};
+/* *INDENT-ON* */
+
+/* Register the two test fields on a forest and fill their local entries
+ * with the test constants. */
+static void
+t8_test_fields_register_and_fill (t8_forest_t forest)
+{
+  const t8_locidx_t   num_elements =
+    t8_forest_get_local_num_elements (forest);
+  double             *rho;
+  int                *tag;
+  t8_locidx_t         ielem;
+  int                 rho_id, tag_id;
+
+  rho_id = t8_forest_field_register (forest, "rho", sizeof (double));
+  tag_id = t8_forest_field_register (forest, "tag", sizeof (int));
+  ASSERT_EQ (rho_id, 0);
+  ASSERT_EQ (tag_id, 1);
+  rho = (double *) t8_forest_field_data (forest, rho_id);
+  tag = (int *) t8_forest_field_data (forest, tag_id);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    rho[ielem] = T8_TEST_FIELDS_RHO;
+    tag[ielem] = T8_TEST_FIELDS_TAG;
+  }
+}
+
+/* Check that both test fields exist on a forest and that every local
+ * entry holds the test constants. */
+static void
+t8_test_fields_check (t8_forest_t forest)
+{
+  const t8_locidx_t   num_elements =
+    t8_forest_get_local_num_elements (forest);
+  const double       *rho;
+  const int          *tag;
+  t8_locidx_t         ielem;
+
+  ASSERT_EQ (t8_forest_num_fields (forest), 2);
+  ASSERT_EQ (t8_forest_field_id (forest, "rho"), 0);
+  ASSERT_EQ (t8_forest_field_id (forest, "tag"), 1);
+  ASSERT_EQ (t8_forest_field_id (forest, "nosuchfield"), -1);
+  rho = (const double *) t8_forest_field_data (forest, 0);
+  tag = (const int *) t8_forest_field_data (forest, 1);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    ASSERT_EQ (rho[ielem], T8_TEST_FIELDS_RHO);
+    ASSERT_EQ (tag[ielem], T8_TEST_FIELDS_TAG);
+  }
+}
+
+/* An adapt callback that refines every third element and coarsens every
+ * family whose first member is a fifth element. */
+static int
+t8_test_fields_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                      t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                      t8_eclass_scheme_c *ts, const int is_family,
+                      const int num_elements, t8_element_t *elements[])
+{
+  if (is_family && ts->t8_element_level (elements[0]) > 0
+      && lelement_id % 5 == 0) {
+    return -1;
+  }
+  if (lelement_id % 3 == 0) {
+    return 1;
+  }
+  return 0;
+}
+
+TEST_P (t8_forest_fields_test, registry_and_lookup)
+{
+  t8_test_fields_register_and_fill (forest);
+  t8_test_fields_check (forest);
+}
+
+TEST_P (t8_forest_fields_test, carried_across_adapt_and_partition)
+{
+  t8_forest_t         forest_adapt;
+  t8_forest_t         forest_partition;
+
+  t8_test_fields_register_and_fill (forest);
+
+  /* Adapt the forest non-recursively. The fields must be carried over by
+   * replaying the adapt journal. */
+  t8_forest_ref (forest);
+  forest_adapt = t8_forest_new_adapt (forest, t8_test_fields_adapt, 0, 1,
+                                      NULL);
+  t8_test_fields_check (forest_adapt);
+
+  /* Partition the adapted forest. The fields must be shipped with the
+   * elements. */
+  t8_forest_init (&forest_partition);
+  t8_forest_ref (forest_adapt);
+  t8_forest_set_partition (forest_partition, forest_adapt, 0);
+  t8_forest_set_ghost (forest_partition, 1, T8_GHOST_FACES);
+  t8_forest_commit (forest_partition);
+  t8_test_fields_check (forest_partition);
+
+  t8_forest_unref (&forest_adapt);
+  t8_forest_unref (&forest_partition);
+}
+
+TEST_P (t8_forest_fields_test, ghost_exchange)
+{
+  const t8_locidx_t   num_elements =
+    t8_forest_get_local_num_elements (forest);
+  const t8_locidx_t   num_ghosts = t8_forest_get_num_ghosts (forest);
+  int                 mpirank, mpisize, mpiret;
+  double             *rho;
+  t8_locidx_t         ielem;
+
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &mpisize);
+  SC_CHECK_MPI (mpiret);
+
+  (void) t8_forest_field_register (forest, "rho", sizeof (double));
+  rho = (double *) t8_forest_field_data (forest, 0);
+  /* Store the owner rank in the local entries and poison the ghosts */
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    rho[ielem] = (double) mpirank;
+  }
+  for (ielem = 0; ielem < num_ghosts; ielem++) {
+    rho[num_elements + ielem] = -1;
+  }
+  t8_forest_fields_exchange (forest);
+  /* Every ghost entry must now hold the rank of another process */
+  for (ielem = 0; ielem < num_ghosts; ielem++) {
+    ASSERT_GE (rho[num_elements + ielem], 0);
+    ASSERT_LT (rho[num_elements + ielem], (double) mpisize);
+    ASSERT_NE (rho[num_elements + ielem], (double) mpirank);
+  }
+}
+
+/* *INDENT-OFF* */
+INSTANTIATE_TEST_SUITE_P (t8_gtest_forest_fields, t8_forest_fields_test,
+                          testing::Combine (testing::Range (T8_ECLASS_ZERO, T8_ECLASS_COUNT),
+                                            testing::Range (0, 4)));
+/* *INDENT-ON* */
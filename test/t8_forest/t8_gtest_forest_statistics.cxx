@@ -0,0 +1,205 @@
+/*
+This file is part of t8code.
+t8code is a C library to manage a collection (a forest) of multiple
+connected adaptive space-trees of general element classes in parallel.
+
+Copyright (C) 2015 the developers
+
+t8code is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+t8code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with t8code; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_eclass.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_element_cxx.hxx>
+#include <t8_forest/t8_forest_general.h>
+
+/**
+ * This file tests t8_forest_compute_statistics.
+ * The statistics of the fused reduction must agree with a brute-force
+ * computation that tallies the local leafs by hand and reduces every
+ * metric in its own Allreduce.
+ */
+
+/* *INDENT-OFF* */
+class t8_forest_statistics_test:public testing::TestWithParam <std::tuple<t8_eclass_t, int>> {
+    protected:
+        void SetUp () override{
+            eclass = std::get<0> (GetParam ());
+            level = std::get<1> (GetParam ());
+            scheme = t8_scheme_new_default_cxx ();
+            cmesh = t8_cmesh_new_hypercube (eclass, sc_MPI_COMM_WORLD, 0, 0, 0);
+            /* Build with a face ghost layer so that the ghost statistics
+             * are exercised as well. */
+            forest = t8_forest_new_uniform (cmesh, scheme, level, 1, sc_MPI_COMM_WORLD);
+        }
+        void TearDown () override {
+            t8_forest_unref (&forest);
+        }
+    t8_forest_t forest;
+    t8_cmesh_t cmesh;
+    t8_scheme_cxx * scheme;
+    t8_eclass_t eclass;
+    int level;
+};
+
+/* *INDENT-ON* */
+
+/* Refine the element with child id 1 and no other elements. */
+static int
+t8_test_statistics_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                          t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                          t8_eclass_scheme_c *ts, const int is_family,
+                          const int num_elements, t8_element_t *elements[])
+{
+  return ts->t8_element_child_id (elements[0]) == 1;
+}
+
+/* Compute the expected statistics of a forest the slow way: tally the
+ * local leafs by hand and reduce the sums and maxima in separate
+ * Allreduce calls. Mirrors the arithmetic of
+ * t8_forest_compute_statistics so that the doubles match exactly. */
+static void
+t8_test_statistics_brute_force (t8_forest_t forest,
+                                t8_forest_stats_t *expected)
+{
+  long long           local_counts[T8_FOREST_STATS_MAX_LEVELS + 1];
+  long long           global_counts[T8_FOREST_STATS_MAX_LEVELS + 1];
+  long long           local_max[2], global_max[2];
+  t8_gloidx_t         global_count = 0, level_sum = 0;
+  int                 mpisize, mpiret;
+
+  memset (local_counts, 0, sizeof (local_counts));
+  const t8_locidx_t   num_local_trees =
+    t8_forest_get_num_local_trees (forest);
+  for (t8_locidx_t itree = 0; itree < num_local_trees; itree++) {
+    t8_eclass_scheme_c *ts =
+      t8_forest_get_eclass_scheme (forest,
+                                   t8_forest_get_tree_class (forest,
+                                                             itree));
+    const t8_locidx_t   num_tree_elements =
+      t8_forest_get_tree_num_elements (forest, itree);
+    for (t8_locidx_t ielement = 0; ielement < num_tree_elements; ielement++) {
+      const t8_element_t *element =
+        t8_forest_get_element_in_tree (forest, itree, ielement);
+      local_counts[ts->t8_element_level (element)]++;
+    }
+  }
+  local_counts[T8_FOREST_STATS_MAX_LEVELS] =
+    t8_forest_get_num_ghosts (forest);
+  local_max[0] = t8_forest_get_local_num_elements (forest);
+  local_max[1] = t8_forest_get_num_ghosts (forest);
+
+  mpiret = sc_MPI_Allreduce (local_counts, global_counts,
+                             T8_FOREST_STATS_MAX_LEVELS + 1,
+                             sc_MPI_LONG_LONG_INT, sc_MPI_SUM,
+                             sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Allreduce (local_max, global_max, 2,
+                             sc_MPI_LONG_LONG_INT, sc_MPI_MAX,
+                             sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &mpisize);
+  SC_CHECK_MPI (mpiret);
+
+  memset (expected, 0, sizeof (*expected));
+  expected->min_level = -1;
+  for (int ilevel = 0; ilevel < T8_FOREST_STATS_MAX_LEVELS; ilevel++) {
+    const t8_gloidx_t   level_count = (t8_gloidx_t) global_counts[ilevel];
+    expected->num_elements_per_level[ilevel] = level_count;
+    global_count += level_count;
+    level_sum += (t8_gloidx_t) ilevel *level_count;
+    if (level_count > 0) {
+      if (expected->min_level < 0) {
+        expected->min_level = ilevel;
+      }
+      expected->max_level = ilevel;
+    }
+  }
+  expected->global_num_elements = global_count;
+  expected->global_num_ghosts =
+    (t8_gloidx_t) global_counts[T8_FOREST_STATS_MAX_LEVELS];
+  expected->max_local_num_elements = (t8_locidx_t) global_max[0];
+  expected->max_local_num_ghosts = (t8_locidx_t) global_max[1];
+  if (global_count > 0) {
+    expected->mean_level = (double) level_sum / (double) global_count;
+    expected->ghost_fraction =
+      (double) expected->global_num_ghosts / (double) global_count;
+    expected->imbalance = (double) expected->max_local_num_elements
+      * (double) mpisize / (double) global_count;
+  }
+  else {
+    expected->min_level = 0;
+  }
+}
+
+/* Compare all fields of two statistics structs. */
+static void
+t8_test_statistics_compare (const t8_forest_stats_t *stats,
+                            const t8_forest_stats_t *expected)
+{
+  EXPECT_EQ (stats->global_num_elements, expected->global_num_elements);
+  EXPECT_EQ (stats->global_num_ghosts, expected->global_num_ghosts);
+  EXPECT_EQ (stats->max_local_num_elements,
+             expected->max_local_num_elements);
+  EXPECT_EQ (stats->max_local_num_ghosts, expected->max_local_num_ghosts);
+  EXPECT_EQ (stats->min_level, expected->min_level);
+  EXPECT_EQ (stats->max_level, expected->max_level);
+  EXPECT_DOUBLE_EQ (stats->mean_level, expected->mean_level);
+  EXPECT_DOUBLE_EQ (stats->imbalance, expected->imbalance);
+  EXPECT_DOUBLE_EQ (stats->ghost_fraction, expected->ghost_fraction);
+  for (int ilevel = 0; ilevel < T8_FOREST_STATS_MAX_LEVELS; ilevel++) {
+    EXPECT_EQ (stats->num_elements_per_level[ilevel],
+               expected->num_elements_per_level[ilevel]);
+  }
+}
+
+TEST_P (t8_forest_statistics_test, uniform_forest)
+{
+  t8_forest_stats_t   stats, expected;
+
+  t8_forest_compute_statistics (forest, &stats);
+  t8_test_statistics_brute_force (forest, &expected);
+  t8_test_statistics_compare (&stats, &expected);
+
+  /* A uniform forest has all leafs on one level. */
+  EXPECT_EQ (stats.min_level, level);
+  EXPECT_EQ (stats.max_level, level);
+  EXPECT_DOUBLE_EQ (stats.mean_level, (double) level);
+  EXPECT_EQ (stats.num_elements_per_level[level],
+             t8_forest_get_global_num_elements (forest));
+  EXPECT_GE (stats.imbalance, 1.0);
+}
+
+TEST_P (t8_forest_statistics_test, adapted_forest)
+{
+  t8_forest_stats_t   stats, expected;
+
+  t8_forest_t         forest_adapt =
+    t8_forest_new_adapt (forest, t8_test_statistics_adapt, 0, 0, NULL);
+  /* The fixture's TearDown still unrefs the member forest. */
+  forest = forest_adapt;
+
+  t8_forest_compute_statistics (forest_adapt, &stats);
+  t8_test_statistics_brute_force (forest_adapt, &expected);
+  t8_test_statistics_compare (&stats, &expected);
+}
+
+/* *INDENT-OFF* */
+INSTANTIATE_TEST_SUITE_P (t8_gtest_forest_statistics, t8_forest_statistics_test,
+                          testing::Combine (testing::Range (T8_ECLASS_ZERO, T8_ECLASS_COUNT),
+                                            testing::Range (1, 4)));
+/* *INDENT-ON* */
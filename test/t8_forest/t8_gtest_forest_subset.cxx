@@ -0,0 +1,170 @@
+/*
+This file is part of t8code.
+t8code is a C library to manage a collection (a forest) of multiple
+connected adaptive space-trees of general element classes in parallel.
+
+Copyright (C) 2015 the developers
+
+t8code is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+t8code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with t8code; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <vector>
+#include <t8_eclass.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_element_cxx.hxx>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_iterate.h>
+
+/**
+ * This file tests the element subset views of t8_forest_iterate.h.
+ * A subset built from a mask and a subset built from an unsorted index
+ * list with repetitions must contain the same elements, and iterating a
+ * subset must visit exactly the selected leaves in ascending order with
+ * the matching tree ids and element pointers.
+ */
+
+/* *INDENT-OFF* */
+class t8_forest_subset_test:public testing::TestWithParam <std::tuple<t8_eclass_t, int>> {
+    protected:
+        void SetUp () override{
+            eclass = std::get<0> (GetParam ());
+            level = std::get<1> (GetParam ());
+            scheme = t8_scheme_new_default_cxx ();
+            t8_cmesh_t cmesh = t8_cmesh_new_hypercube (eclass, sc_MPI_COMM_WORLD, 0, 0, 0);
+            /* Create the forest with a ghost layer, so that the built-in
+             * boundary subset is available. */
+            forest = t8_forest_new_uniform (cmesh, scheme, level, 1, sc_MPI_COMM_WORLD);
+        }
+        void TearDown () override {
+            t8_forest_unref (&forest);
+        }
+    t8_forest_t forest;
+    t8_scheme_cxx * scheme;
+    t8_eclass_t eclass;
+    int level;
+};
+
+/* *INDENT-ON* */
+
+/* Collects the visited leaf indices and checks the callback arguments. */
+static void
+t8_test_subset_collect (t8_forest_t forest, t8_locidx_t ltreeid,
+                        const t8_element_t *element, t8_locidx_t leaf_index,
+                        void *user_data)
+{
+  std::vector < t8_locidx_t > *visited =
+    (std::vector < t8_locidx_t > *)user_data;
+  const t8_locidx_t   tree_offset =
+    t8_forest_get_tree_element_offset (forest, ltreeid);
+
+  /* The leaf index must belong to the reported tree and the element must
+   * be the leaf stored at that index. */
+  ASSERT_LE (tree_offset, leaf_index);
+  ASSERT_LT (leaf_index - tree_offset,
+             t8_forest_get_tree_num_elements (forest, ltreeid));
+  ASSERT_EQ (element,
+             t8_forest_get_element_in_tree (forest, ltreeid,
+                                            leaf_index - tree_offset));
+  visited->push_back (leaf_index);
+}
+
+TEST_P (t8_forest_subset_test, mask_and_indices_agree)
+{
+  const t8_locidx_t   num_local_elements =
+    t8_forest_get_local_num_elements (forest);
+
+  /* Select every third element via a mask. */
+  std::vector < int8_t > mask (num_local_elements, 0);
+  std::vector < t8_locidx_t > selected;
+  for (t8_locidx_t ielement = 0; ielement < num_local_elements;
+       ielement += 3) {
+    mask[ielement] = 1;
+    selected.push_back (ielement);
+  }
+  t8_forest_subset_t  subset_mask =
+    t8_forest_subset_new_from_mask (forest, mask.data ());
+  ASSERT_EQ (t8_forest_subset_num_elements (subset_mask),
+             (t8_locidx_t) selected.size ());
+
+  /* Build the same subset from an index list in descending order with
+   * every entry repeated. The constructor must sort and deduplicate. */
+  std::vector < t8_locidx_t > shuffled;
+  for (t8_locidx_t ielement = (t8_locidx_t) selected.size () - 1;
+       ielement >= 0; ielement--) {
+    shuffled.push_back (selected[ielement]);
+    shuffled.push_back (selected[ielement]);
+  }
+  t8_forest_subset_t  subset_indices =
+    t8_forest_subset_new_from_indices (forest, shuffled.data (),
+                                       (t8_locidx_t) shuffled.size ());
+  ASSERT_EQ (t8_forest_subset_num_elements (subset_indices),
+             (t8_locidx_t) selected.size ());
+  for (t8_locidx_t ielement = 0;
+       ielement < t8_forest_subset_num_elements (subset_mask); ielement++) {
+    EXPECT_EQ (t8_forest_subset_index (subset_mask, ielement),
+               selected[ielement]);
+    EXPECT_EQ (t8_forest_subset_index (subset_indices, ielement),
+               selected[ielement]);
+  }
+
+  /* Iterating the subset must visit exactly the selected leaves in
+   * ascending order. */
+  std::vector < t8_locidx_t > visited;
+  t8_forest_subset_iterate (forest, subset_mask, t8_test_subset_collect,
+                            &visited);
+  EXPECT_EQ (visited, selected);
+
+  t8_forest_subset_destroy (&subset_indices);
+  t8_forest_subset_destroy (&subset_mask);
+}
+
+TEST_P (t8_forest_subset_test, boundary_subset)
+{
+  int                 mpisize, mpiret;
+
+  mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &mpisize);
+  SC_CHECK_MPI (mpiret);
+
+  t8_forest_subset_t  boundary = t8_forest_subset_new_boundary (forest);
+
+  if (mpisize == 1) {
+    /* Without remote processes there are no boundary elements. */
+    EXPECT_EQ (t8_forest_subset_num_elements (boundary), 0);
+  }
+  else {
+    /* The boundary indices must be strictly ascending and valid. */
+    const t8_locidx_t   num_boundary =
+      t8_forest_subset_num_elements (boundary);
+    for (t8_locidx_t ielement = 0; ielement < num_boundary; ielement++) {
+      const t8_locidx_t   leaf_index =
+        t8_forest_subset_index (boundary, ielement);
+      EXPECT_GE (leaf_index, 0);
+      EXPECT_LT (leaf_index, t8_forest_get_local_num_elements (forest));
+      if (ielement > 0) {
+        EXPECT_LT (t8_forest_subset_index (boundary, ielement - 1),
+                   leaf_index);
+      }
+    }
+  }
+  t8_forest_subset_destroy (&boundary);
+}
+
+/* *INDENT-OFF* */
+INSTANTIATE_TEST_SUITE_P (t8_gtest_forest_subset, t8_forest_subset_test,
+                          testing::Combine (testing::Range (T8_ECLASS_ZERO, T8_ECLASS_COUNT),
+                                            testing::Range (0, 4)));
+/* *INDENT-ON* */
@@ -0,0 +1,188 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <set>
+#include <tuple>
+#include <t8_eclass.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_ghost.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_examples.h>
+
+/* This test program tests the ghost layers of width > 1 and the edge and
+ * vertex ghost types. Both are computed by expanding the face ghost layer
+ * with rounds of local face-neighbor closure, so the resulting ghost sets
+ * must be supersets of the face ghost layer of width 1: increasing the
+ * width or switching to a larger ghost type must never lose a ghost
+ * element. We build uniform forests over hypercube meshes and compare the
+ * ghost sets element by element. In addition we check that no ghost
+ * element is owned by the local process.
+ * Note that the expansion only sees local leafs, so the layers are not
+ * checked for completeness across points where three or more partitions
+ * meet, see the note at t8_forest_set_ghost_ext. */
+
+/* A ghost element is identified by its global tree, its level and its
+ * linear id on that level. */
+typedef std::set <std::tuple <t8_gloidx_t, int, t8_linearidx_t>>
+  t8_test_ghost_set_t;
+
+/* *INDENT-OFF* */
+class forest_ghost_width:public testing::TestWithParam <t8_eclass_t> {
+protected:
+  void SetUp () override {
+    eclass = GetParam();
+
+    scheme = t8_scheme_new_default_cxx ();
+    cmesh = t8_cmesh_new_hypercube (eclass, sc_MPI_COMM_WORLD, 0, 0, 0);
+  }
+  void TearDown () override {
+    t8_cmesh_destroy (&cmesh);
+    t8_scheme_cxx_unref (&scheme);
+  }
+  t8_eclass_t         eclass;
+  t8_cmesh_t          cmesh;
+  t8_scheme_cxx_t     *scheme;
+};
+/* *INDENT-ON* */
+
+/* Build a uniform forest with the given ghost type and width. */
+static t8_forest_t
+t8_test_ghost_width_new_forest (t8_cmesh_t cmesh, t8_scheme_cxx_t *scheme,
+                                int level, t8_ghost_type_t ghost_type,
+                                int ghost_width)
+{
+  t8_forest_t         forest;
+
+  t8_cmesh_ref (cmesh);
+  t8_scheme_cxx_ref (scheme);
+  t8_forest_init (&forest);
+  t8_forest_set_cmesh (forest, cmesh, sc_MPI_COMM_WORLD);
+  t8_forest_set_scheme (forest, scheme);
+  t8_forest_set_level (forest, level);
+  t8_forest_set_ghost_ext (forest, 1, ghost_type, 0, ghost_width);
+  t8_forest_commit (forest);
+  return forest;
+}
+
+/* Collect the ghost elements of a forest into a set and check that none
+ * of them is owned by the local process. */
+static void
+t8_test_ghost_width_collect (t8_forest_t forest, t8_test_ghost_set_t &ghosts)
+{
+  const t8_locidx_t   num_ghost_trees = t8_forest_ghost_num_trees (forest);
+  int                 mpirank, mpiret;
+
+  mpiret = sc_MPI_Comm_rank (t8_forest_get_mpicomm (forest), &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  for (t8_locidx_t itree = 0; itree < num_ghost_trees; itree++) {
+    const t8_gloidx_t   gtreeid =
+      t8_forest_ghost_get_global_treeid (forest, itree);
+    const t8_eclass_t   tree_class =
+      t8_forest_ghost_get_tree_class (forest, itree);
+    t8_eclass_scheme_c *ts =
+      t8_forest_get_eclass_scheme (forest, tree_class);
+    const t8_locidx_t   num_elems_in_tree =
+      t8_forest_ghost_tree_num_elements (forest, itree);
+    for (t8_locidx_t ielem = 0; ielem < num_elems_in_tree; ielem++) {
+      t8_element_t       *element =
+        t8_forest_ghost_get_element (forest, itree, ielem);
+      const int           level = ts->t8_element_level (element);
+      const t8_linearidx_t linear_id =
+        ts->t8_element_get_linear_id (element, level);
+      const int           owner =
+        t8_forest_element_find_owner (forest, gtreeid, element, tree_class);
+      ASSERT_NE (owner, mpirank)
+        << "Ghost element is owned by the local process.";
+      ghosts.insert (std::make_tuple (gtreeid, level, linear_id));
+    }
+  }
+  ASSERT_EQ (ghosts.size (),
+             (size_t) t8_forest_get_num_ghosts (forest))
+    << "Ghost layer stores duplicate elements.";
+}
+
+/* Check that \a subset is contained in \a superset. */
+static void
+t8_test_ghost_width_check_subset (const t8_test_ghost_set_t &subset,
+                                  const t8_test_ghost_set_t &superset)
+{
+  for (const auto &ghost : subset) {
+    ASSERT_TRUE (superset.find (ghost) != superset.end ())
+      << "Ghost element of the smaller layer is missing from the larger "
+      "layer in tree " << std::get<0> (ghost) << " at level "
+      << std::get<1> (ghost) << ".";
+  }
+}
+
+TEST_P (forest_ghost_width, test_width_nested)
+{
+  const int           level = 3;
+  const int           max_width = 3;
+  t8_test_ghost_set_t ghost_sets[3];
+
+  /* The ghost layers of increasing width must be nested. */
+  for (int width = 1; width <= max_width; width++) {
+    t8_forest_t         forest =
+      t8_test_ghost_width_new_forest (cmesh, scheme, level, T8_GHOST_FACES,
+                                      width);
+    t8_test_ghost_width_collect (forest, ghost_sets[width - 1]);
+    if (width > 1) {
+      t8_test_ghost_width_check_subset (ghost_sets[width - 2],
+                                        ghost_sets[width - 1]);
+    }
+    t8_forest_unref (&forest);
+  }
+}
+
+TEST_P (forest_ghost_width, test_type_nested)
+{
+  const int           level = 3;
+  t8_test_ghost_set_t face_ghosts, edge_ghosts, vertex_ghosts;
+
+  /* The face, edge and vertex ghost layers of width 1 must be nested. */
+  t8_forest_t         forest =
+    t8_test_ghost_width_new_forest (cmesh, scheme, level, T8_GHOST_FACES, 1);
+  t8_test_ghost_width_collect (forest, face_ghosts);
+  t8_forest_unref (&forest);
+
+  forest =
+    t8_test_ghost_width_new_forest (cmesh, scheme, level, T8_GHOST_EDGES, 1);
+  t8_test_ghost_width_collect (forest, edge_ghosts);
+  t8_forest_unref (&forest);
+
+  forest =
+    t8_test_ghost_width_new_forest (cmesh, scheme, level, T8_GHOST_VERTICES,
+                                    1);
+  t8_test_ghost_width_collect (forest, vertex_ghosts);
+  t8_forest_unref (&forest);
+
+  t8_test_ghost_width_check_subset (face_ghosts, edge_ghosts);
+  t8_test_ghost_width_check_subset (edge_ghosts, vertex_ghosts);
+}
+
+/* *INDENT-OFF* */
+INSTANTIATE_TEST_SUITE_P (t8_gtest_ghost_width, forest_ghost_width, testing::Range (T8_ECLASS_QUAD, T8_ECLASS_PYRAMID));
+/* *INDENT-ON* */
@@ -0,0 +1,128 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_eclass.h>
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_iterate.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+
+/* In this test we iterate over the local leaf elements of a uniform forest
+ * with a t8_forest_leaf_iterator and check that the iterator visits every
+ * leaf exactly once, in ascending order of the local element index, and
+ * that the element, tree id and index in the tree agree with the plain
+ * forest getters. We check the full range as well as a split into
+ * subranges as a threaded element loop would use it. */
+
+/* *INDENT-OFF* */
+class forest_leaf_iterator:public testing::TestWithParam <std::tuple<t8_eclass,int>> {
+protected:
+  void SetUp () override {
+    eclass = std::get<0>(GetParam());
+    level = std::get<1>(GetParam());
+
+    default_scheme = t8_scheme_new_default_cxx();
+    /* Construct a cube coarse mesh */
+    cmesh = t8_cmesh_new_hypercube (eclass, sc_MPI_COMM_WORLD, 0, 0, 0);
+    /* Build a uniform forest */
+    forest = t8_forest_new_uniform (cmesh, default_scheme, level, 0, sc_MPI_COMM_WORLD);
+  }
+  void TearDown () override {
+    t8_forest_unref (&forest);
+  }
+  t8_eclass_t       eclass;
+  int               level;
+  t8_cmesh_t        cmesh;
+  t8_forest_t       forest;
+  t8_scheme_cxx_t   *default_scheme;
+};
+/* *INDENT-ON* */
+
+/* Iterate over the range [first,end) and check each visited leaf against
+ * t8_forest_get_element and t8_forest_get_element_in_tree. */
+static void
+t8_test_leaf_iterator_range (t8_forest_t forest, t8_locidx_t first,
+                             t8_locidx_t end)
+{
+  t8_forest_leaf_iterator_t iterator;
+  t8_locidx_t         ielement;
+
+  t8_forest_leaf_iterator_init (&iterator, forest, first, end);
+  for (ielement = first; ielement < end; ++ielement) {
+    ASSERT_FALSE (t8_forest_leaf_iterator_is_done (&iterator))
+      << "Iterator is done before the end of its range.";
+    EXPECT_EQ (iterator.ielement, ielement)
+      << "Iterator does not visit the leaves in ascending order.";
+
+    const t8_element_t *element = t8_forest_leaf_iterator_element (&iterator);
+    /* Compare with the element that the plain getters return */
+    t8_locidx_t         test_ltreeid;
+    const t8_element_t *test_element =
+      t8_forest_get_element (forest, ielement, &test_ltreeid);
+    EXPECT_EQ (iterator.itree, test_ltreeid)
+      << "Iterator tree does not match the tree of the element.";
+    const t8_eclass_t   tree_class =
+      t8_forest_get_tree_class (forest, test_ltreeid);
+    t8_eclass_scheme_c *ts =
+      t8_forest_get_eclass_scheme (forest, tree_class);
+    EXPECT_FALSE (ts->t8_element_compare (element, test_element))
+      << "Iterator element does not match the element at its index.";
+    EXPECT_EQ (element,
+               t8_forest_get_element_in_tree (forest, iterator.itree,
+                                              iterator.element_in_tree))
+      << "Iterator index in tree does not match.";
+    t8_forest_leaf_iterator_next (&iterator);
+  }
+  ASSERT_TRUE (t8_forest_leaf_iterator_is_done (&iterator))
+    << "Iterator is not done after visiting its range.";
+}
+
+TEST_P (forest_leaf_iterator, full_range)
+{
+  const t8_locidx_t   num_elements =
+    t8_forest_get_local_num_elements (forest);
+
+  t8_test_leaf_iterator_range (forest, 0, num_elements);
+}
+
+TEST_P (forest_leaf_iterator, split_ranges)
+{
+  const t8_locidx_t   num_elements =
+    t8_forest_get_local_num_elements (forest);
+  /* Split the local elements into three ranges as a threaded loop would
+   * and check each range separately. The middle bounds are chosen such
+   * that they generally do not align with tree boundaries. */
+  const t8_locidx_t   first_split = num_elements / 3;
+  const t8_locidx_t   second_split = 2 * num_elements / 3;
+
+  t8_test_leaf_iterator_range (forest, 0, first_split);
+  t8_test_leaf_iterator_range (forest, first_split, second_split);
+  t8_test_leaf_iterator_range (forest, second_split, num_elements);
+  /* An empty range must start out done */
+  t8_test_leaf_iterator_range (forest, first_split, first_split);
+}
+
+/* *INDENT-OFF* */
+INSTANTIATE_TEST_SUITE_P (t8_gtest_leaf_iterator, forest_leaf_iterator,testing::Combine(testing::Range(T8_ECLASS_VERTEX, T8_ECLASS_COUNT), testing::Range(0,6)));
+/* *INDENT-ON* */
@@ -0,0 +1,261 @@
+/*
+This file is part of t8code.
+t8code is a C library to manage a collection (a forest) of multiple
+connected adaptive space-trees of general element classes in parallel.
+
+Copyright (C) 2015 the developers
+
+t8code is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+t8code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with t8code; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_eclass.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_element_cxx.hxx>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_partition.h>
+
+/**
+ * This file tests the repartitioning of per element data.
+ * We adapt a uniform forest non-recursively so that the element counts
+ * become imbalanced, repartition it and move per element data arrays
+ * from the old to the new partition with the blocking, the split-phase
+ * and the batched multi-array data partition routines.
+ * Every element's entry is derived from its global id, so after the
+ * transfer each entry of the new partition must match the global id of
+ * its element, no matter which process it came from.
+ */
+
+/* An adapt callback that refines every third element. Non-recursively
+ * applied to a uniform forest this imbalances the element counts, so
+ * the subsequent partition moves elements between the processes. */
+static int
+t8_test_partition_data_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                              t8_locidx_t which_tree,
+                              t8_locidx_t lelement_id, t8_eclass_scheme_c *ts,
+                              const int is_family, const int num_elements,
+                              t8_element_t *elements[])
+{
+  if (lelement_id % 3 == 0) {
+    return 1;
+  }
+  return 0;
+}
+
+/* *INDENT-OFF* */
+class t8_forest_partition_data_test:public testing::TestWithParam <std::tuple<t8_eclass_t, int>> {
+    protected:
+        void SetUp () override{
+            t8_forest_t forest;
+
+            eclass = std::get<0> (GetParam ());
+            level = std::get<1> (GetParam ());
+            scheme = t8_scheme_new_default_cxx ();
+            t8_cmesh_t cmesh = t8_cmesh_new_hypercube (eclass, sc_MPI_COMM_WORLD, 0, 0, 0);
+            forest = t8_forest_new_uniform (cmesh, scheme, level, 0, sc_MPI_COMM_WORLD);
+            /* Imbalance the element counts, then repartition */
+            forest_from = t8_forest_new_adapt (forest, t8_test_partition_data_adapt, 0, 0, NULL);
+            t8_forest_init (&forest_to);
+            t8_forest_ref (forest_from);
+            t8_forest_set_partition (forest_to, forest_from, 0);
+            t8_forest_commit (forest_to);
+        }
+        void TearDown () override {
+            t8_forest_unref (&forest_from);
+            t8_forest_unref (&forest_to);
+        }
+    t8_forest_t forest_from;
+    t8_forest_t forest_to;
+    t8_scheme_cxx * scheme;
+    t8_eclass_t eclass;
+    int level;
+};
+/* *INDENT-ON* */
+
+/* Fill a data array with one entry per local element of \a forest,
+ * storing the element's global id. */
+static void
+t8_test_partition_data_fill_gid (t8_forest_t forest, sc_array_t *data)
+{
+  const t8_gloidx_t   first_gid =
+    t8_forest_get_first_local_element_id (forest);
+  const t8_locidx_t   num_elements =
+    t8_forest_get_local_num_elements (forest);
+  t8_locidx_t         ielem;
+
+  sc_array_init_size (data, sizeof (t8_gloidx_t), num_elements);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    *(t8_gloidx_t *) t8_sc_array_index_locidx (data, ielem) =
+      first_gid + ielem;
+  }
+}
+
+/* Check that the entries [first_element, first_element + num_elements)
+ * of \a data hold the global ids of the respective elements of
+ * \a forest. */
+static void
+t8_test_partition_data_check_gid (t8_forest_t forest, const sc_array_t *data,
+                                  t8_locidx_t first_element,
+                                  t8_locidx_t num_elements)
+{
+  const t8_gloidx_t   first_gid =
+    t8_forest_get_first_local_element_id (forest);
+  t8_locidx_t         ielem;
+
+  for (ielem = first_element; ielem < first_element + num_elements; ielem++) {
+    ASSERT_EQ (*(t8_gloidx_t *)
+               t8_sc_array_index_locidx ((sc_array_t *) data, ielem),
+               first_gid + ielem)
+      << "Element received wrong data after partition.";
+  }
+}
+
+TEST_P (t8_forest_partition_data_test, blocking)
+{
+  sc_array_t          data_in, data_out;
+  t8_locidx_t         ielem;
+
+  t8_test_partition_data_fill_gid (forest_from, &data_in);
+  sc_array_init_size (&data_out, sizeof (t8_gloidx_t),
+                      t8_forest_get_local_num_elements (forest_to));
+  /* Poison the output entries */
+  for (ielem = 0; ielem < (t8_locidx_t) data_out.elem_count; ielem++) {
+    *(t8_gloidx_t *) t8_sc_array_index_locidx (&data_out, ielem) = -1;
+  }
+
+  t8_forest_partition_data (forest_from, forest_to, &data_in, &data_out);
+
+  t8_test_partition_data_check_gid (forest_to, &data_out, 0,
+                                    t8_forest_get_local_num_elements
+                                    (forest_to));
+  sc_array_reset (&data_in);
+  sc_array_reset (&data_out);
+}
+
+/* Bookkeeping of the range callback of the split-phase test */
+typedef struct
+{
+  t8_locidx_t         next_first;       /* Expected start of the next range */
+  t8_locidx_t         covered;  /* Number of elements reported so far */
+} t8_test_partition_data_ranges_t;
+
+/* Range callback: the ranges must arrive in ascending order without gaps
+ * or overlaps and their entries must already be valid. */
+static void
+t8_test_partition_data_range (t8_forest_t forest_to,
+                              t8_locidx_t first_element,
+                              t8_locidx_t num_elements, sc_array_t *data_out,
+                              void *user_data)
+{
+  t8_test_partition_data_ranges_t *ranges =
+    (t8_test_partition_data_ranges_t *) user_data;
+
+  EXPECT_EQ (first_element, ranges->next_first);
+  EXPECT_GT (num_elements, 0);
+  t8_test_partition_data_check_gid (forest_to, data_out, first_element,
+                                    num_elements);
+  ranges->next_first = first_element + num_elements;
+  ranges->covered += num_elements;
+}
+
+TEST_P (t8_forest_partition_data_test, split_phase)
+{
+  t8_forest_partition_data_handle_t handle;
+  t8_test_partition_data_ranges_t ranges;
+  sc_array_t          data_in, data_out;
+
+  t8_test_partition_data_fill_gid (forest_from, &data_in);
+  sc_array_init_size (&data_out, sizeof (t8_gloidx_t),
+                      t8_forest_get_local_num_elements (forest_to));
+
+  handle =
+    t8_forest_partition_data_begin (forest_from, forest_to, &data_in,
+                                    &data_out);
+  ranges.next_first = 0;
+  ranges.covered = 0;
+  t8_forest_partition_data_end (&handle, t8_test_partition_data_range,
+                                &ranges);
+  ASSERT_EQ (handle, (t8_forest_partition_data_handle_t) NULL);
+
+  /* The ranges must have covered all local elements exactly once */
+  ASSERT_EQ (ranges.covered,
+             t8_forest_get_local_num_elements (forest_to));
+  t8_test_partition_data_check_gid (forest_to, &data_out, 0,
+                                    t8_forest_get_local_num_elements
+                                    (forest_to));
+  sc_array_reset (&data_in);
+  sc_array_reset (&data_out);
+}
+
+TEST_P (t8_forest_partition_data_test, multiple_arrays)
+{
+  const t8_locidx_t   num_from =
+    t8_forest_get_local_num_elements (forest_from);
+  const t8_locidx_t   num_to = t8_forest_get_local_num_elements (forest_to);
+  const t8_gloidx_t   first_gid_from =
+    t8_forest_get_first_local_element_id (forest_from);
+  const t8_gloidx_t   first_gid_to =
+    t8_forest_get_first_local_element_id (forest_to);
+  sc_array_t          gid_in, gid_out, rho_in, rho_out, tag_in, tag_out;
+  const sc_array_t   *data_in[3];
+  sc_array_t         *data_out[3];
+  t8_locidx_t         ielem;
+  t8_gloidx_t         gid;
+
+  /* Three arrays of different entry sizes, all derived from the global
+   * element id */
+  t8_test_partition_data_fill_gid (forest_from, &gid_in);
+  sc_array_init_size (&rho_in, sizeof (double), num_from);
+  sc_array_init_size (&tag_in, sizeof (int), num_from);
+  for (ielem = 0; ielem < num_from; ielem++) {
+    gid = first_gid_from + ielem;
+    *(double *) t8_sc_array_index_locidx (&rho_in, ielem) = 0.5 + gid;
+    *(int *) t8_sc_array_index_locidx (&tag_in, ielem) = (int) (gid % 97);
+  }
+  sc_array_init_size (&gid_out, sizeof (t8_gloidx_t), num_to);
+  sc_array_init_size (&rho_out, sizeof (double), num_to);
+  sc_array_init_size (&tag_out, sizeof (int), num_to);
+
+  data_in[0] = &gid_in;
+  data_in[1] = &rho_in;
+  data_in[2] = &tag_in;
+  data_out[0] = &gid_out;
+  data_out[1] = &rho_out;
+  data_out[2] = &tag_out;
+  t8_forest_partition_data_multiple (forest_from, forest_to, 3, data_in,
+                                     data_out);
+
+  t8_test_partition_data_check_gid (forest_to, &gid_out, 0, num_to);
+  for (ielem = 0; ielem < num_to; ielem++) {
+    gid = first_gid_to + ielem;
+    ASSERT_EQ (*(double *) t8_sc_array_index_locidx (&rho_out, ielem),
+               0.5 + gid);
+    ASSERT_EQ (*(int *) t8_sc_array_index_locidx (&tag_out, ielem),
+               (int) (gid % 97));
+  }
+  sc_array_reset (&gid_in);
+  sc_array_reset (&gid_out);
+  sc_array_reset (&rho_in);
+  sc_array_reset (&rho_out);
+  sc_array_reset (&tag_in);
+  sc_array_reset (&tag_out);
+}
+
+/* *INDENT-OFF* */
+INSTANTIATE_TEST_SUITE_P (t8_gtest_partition_data, t8_forest_partition_data_test,
+                          testing::Combine (testing::Range (T8_ECLASS_ZERO, T8_ECLASS_COUNT),
+                                            testing::Range (0, 4)));
+/* *INDENT-ON* */
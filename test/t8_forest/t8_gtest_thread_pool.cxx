@@ -0,0 +1,166 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_thread_pool.h>
+#include <t8_eclass.h>
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <t8_forest/t8_forest_general.h>
+
+/* This test program tests the process-wide thread pool that backs the
+ * threaded phases of t8code.
+ * We execute worker arrays that sum disjoint index ranges and check that
+ * every worker ran exactly once, for various worker counts and with and
+ * without a process-wide thread limit. We also build a uniform forest
+ * with t8_forest_set_num_threads and check that it matches the serial
+ * construction. Each test finalizes the pool, so the allocation balance
+ * check of sc_finalize stays clean. */
+
+typedef struct t8_test_pool_worker
+{
+  int                 begin; /* First index of this worker's range. */
+  int                 end;   /* One past the last index. */
+  long                sum;   /* The computed sum, filled by the worker. */
+  int                 runs;  /* How often the worker was executed. */
+} t8_test_pool_worker_t;
+
+static void        *
+t8_test_pool_worker_run (void *vworker)
+{
+  t8_test_pool_worker_t *worker = (t8_test_pool_worker_t *) vworker;
+  int                 i;
+
+  worker->sum = 0;
+  for (i = worker->begin; i < worker->end; i++) {
+    worker->sum += i;
+  }
+  worker->runs++;
+  return NULL;
+}
+
+/* Execute num_workers workers over [0, count) and check the results. */
+static void
+t8_test_pool_exec_check (int num_workers, int count)
+{
+  t8_test_pool_worker_t *workers;
+  long                total, expected;
+  int                 iworker;
+
+  workers = T8_ALLOC (t8_test_pool_worker_t, num_workers);
+  for (iworker = 0; iworker < num_workers; iworker++) {
+    workers[iworker].begin = count * iworker / num_workers;
+    workers[iworker].end = count * (iworker + 1) / num_workers;
+    workers[iworker].sum = -1;
+    workers[iworker].runs = 0;
+  }
+  t8_thread_pool_exec (t8_test_pool_worker_run, workers,
+                       sizeof (t8_test_pool_worker_t), num_workers);
+  total = 0;
+  for (iworker = 0; iworker < num_workers; iworker++) {
+    EXPECT_EQ (workers[iworker].runs, 1);
+    total += workers[iworker].sum;
+  }
+  expected = (long) count * (count - 1) / 2;
+  EXPECT_EQ (total, expected);
+  T8_FREE (workers);
+}
+
+TEST (thread_pool, exec_sums)
+{
+  int                 num_workers;
+
+  for (num_workers = 1; num_workers <= 8; num_workers++) {
+    t8_test_pool_exec_check (num_workers, 10000);
+  }
+  /* Repeated runs reuse the persistent pool threads */
+  t8_test_pool_exec_check (4, 10000);
+  t8_thread_pool_finalize ();
+}
+
+TEST (thread_pool, thread_limit)
+{
+  /* With a limit of one thread the workers run serially on the calling
+   * thread; with a limit below the worker count they run in turns. The
+   * results must not depend on the limit. */
+  t8_thread_pool_set_num_threads (1);
+  t8_test_pool_exec_check (6, 10000);
+  t8_thread_pool_set_num_threads (2);
+  t8_test_pool_exec_check (6, 10000);
+  t8_thread_pool_set_num_threads (0);
+  t8_test_pool_exec_check (6, 10000);
+  t8_thread_pool_finalize ();
+}
+
+TEST (thread_pool, clamp_num_threads)
+{
+  /* Without a limit the requested count passes through; with a limit it
+   * is capped. The OpenMP phases rely on this to honor the limit. */
+  t8_thread_pool_set_num_threads (0);
+  EXPECT_EQ (t8_thread_pool_clamp_num_threads (1), 1);
+  EXPECT_EQ (t8_thread_pool_clamp_num_threads (16), 16);
+  t8_thread_pool_set_num_threads (4);
+  EXPECT_EQ (t8_thread_pool_clamp_num_threads (1), 1);
+  EXPECT_EQ (t8_thread_pool_clamp_num_threads (4), 4);
+  EXPECT_EQ (t8_thread_pool_clamp_num_threads (16), 4);
+  /* Restore the default for the other tests */
+  t8_thread_pool_set_num_threads (0);
+}
+
+TEST (thread_pool, threaded_populate)
+{
+  t8_cmesh_t          cmesh;
+  t8_forest_t         forest_serial, forest_threaded;
+  t8_locidx_t         ielement, num_elements;
+
+  cmesh = t8_cmesh_new_hypercube (T8_ECLASS_HEX, sc_MPI_COMM_WORLD,
+                                  0, 0, 0);
+  t8_cmesh_ref (cmesh);
+  forest_serial =
+    t8_forest_new_uniform (cmesh, t8_scheme_new_default_cxx (), 3, 0,
+                           sc_MPI_COMM_WORLD);
+  t8_forest_init (&forest_threaded);
+  t8_forest_set_cmesh (forest_threaded, cmesh, sc_MPI_COMM_WORLD);
+  t8_forest_set_scheme (forest_threaded, t8_scheme_new_default_cxx ());
+  t8_forest_set_level (forest_threaded, 3);
+  t8_forest_set_num_threads (forest_threaded, 4);
+  t8_forest_commit (forest_threaded);
+
+  /* The threaded fill must produce the identical forest */
+  num_elements = t8_forest_get_local_num_elements (forest_serial);
+  ASSERT_EQ (t8_forest_get_local_num_elements (forest_threaded),
+             num_elements);
+  for (ielement = 0; ielement < num_elements; ielement++) {
+    const t8_element_t *elem_serial =
+      t8_forest_get_element_in_tree (forest_serial, 0, ielement);
+    const t8_element_t *elem_threaded =
+      t8_forest_get_element_in_tree (forest_threaded, 0, ielement);
+    t8_eclass_scheme_c *ts =
+      t8_forest_get_eclass_scheme (forest_serial, T8_ECLASS_HEX);
+
+    ASSERT_TRUE (!ts->t8_element_compare (elem_serial, elem_threaded));
+  }
+  t8_forest_unref (&forest_serial);
+  t8_forest_unref (&forest_threaded);
+  t8_thread_pool_finalize ();
+}
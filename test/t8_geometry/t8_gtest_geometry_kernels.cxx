@@ -0,0 +1,141 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_eclass.h>
+#include <t8_geometry/t8_geometry_helpers.h>
+#include <t8_geometry/t8_geometry_helpers_templates.hxx>
+
+/* In this file we test the compile-time specialized linear interpolation
+ * kernels from t8_geometry_helpers_templates.hxx. For every element
+ * class we evaluate a set of reference points with the specialized
+ * kernel and with the generic t8_geom_compute_linear_geometry and check
+ * that the results agree. We use skewed tree vertices so that all
+ * interpolation weights contribute.
+ */
+
+/* Deterministic skewed vertex coordinates for a tree. Both kernels
+ * interpolate whatever vertex array they are given, so arbitrary
+ * pairwise distinct coordinates exercise all interpolation weights. */
+static void
+t8_test_kernels_skewed_vertices (t8_eclass_t eclass, double *vertices)
+{
+  const int           num_corners = t8_eclass_num_vertices[eclass];
+  int                 icorner, i;
+
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    for (i = 0; i < 3; i++) {
+      vertices[3 * icorner + i] =
+        0.25 * icorner + 0.125 * i + 0.0625 * ((icorner * 3 + i) % 5);
+    }
+  }
+}
+
+/* Sample reference coordinates in [0,1]^3. The first three entries are
+ * used according to the dimension of the class. */
+static const double t8_test_kernels_ref_points[][3] = {
+  {0., 0., 0.},
+  {1., 1., 1.},
+  {0.5, 0.5, 0.5},
+  {0.25, 0.75, 0.5},
+  {0.1, 0.2, 0.9},
+  {1., 0., 0.5},
+  {0., 1., 0.25},
+  {0.33, 0.44, 0.55}
+};
+
+static const size_t t8_test_kernels_num_points =
+  sizeof (t8_test_kernels_ref_points) / sizeof (t8_test_kernels_ref_points[0]);
+
+/* *INDENT-OFF* */
+class geometry_kernels: public testing::TestWithParam<t8_eclass_t> {
+protected:
+  void SetUp () override {
+    eclass = GetParam ();
+  }
+  t8_eclass_t eclass;
+};
+/* *INDENT-ON* */
+
+/* Compare the specialized single point kernel against
+ * t8_geom_compute_linear_geometry. */
+TEST_P (geometry_kernels, point_kernel_matches_reference)
+{
+  double              vertices[T8_ECLASS_MAX_CORNERS * 3];
+  double              out_kernel[3], out_reference[3];
+  t8_geom_linear_point_fn kernel = t8_geom_linear_point_kernel (eclass);
+  size_t              ipoint;
+  int                 i;
+
+  t8_test_kernels_skewed_vertices (eclass, vertices);
+  for (ipoint = 0; ipoint < t8_test_kernels_num_points; ipoint++) {
+    const double       *ref_coords = t8_test_kernels_ref_points[ipoint];
+
+    kernel (vertices, ref_coords, out_kernel);
+    t8_geom_compute_linear_geometry (eclass, vertices, ref_coords,
+                                     out_reference);
+    for (i = 0; i < 3; i++) {
+      EXPECT_NEAR (out_kernel[i], out_reference[i], 1e-14)
+        << "Mismatch for eclass " << t8_eclass_to_string[eclass]
+        << " point " << ipoint << " coordinate " << i;
+    }
+  }
+}
+
+/* Compare the specialized batch kernel against per point evaluations of
+ * the reference. The batch reference coordinates are packed with the
+ * dimension of the class as stride. */
+TEST_P (geometry_kernels, batch_kernel_matches_reference)
+{
+  const int           dimension = t8_eclass_to_dimension[eclass];
+  double              vertices[T8_ECLASS_MAX_CORNERS * 3];
+  double              ref_batch[8 * 3];
+  double              out_batch[8 * 3];
+  double              out_reference[3];
+  t8_geom_linear_batch_fn kernel = t8_geom_linear_batch_kernel (eclass);
+  size_t              ipoint;
+  int                 i;
+
+  t8_test_kernels_skewed_vertices (eclass, vertices);
+  for (ipoint = 0; ipoint < t8_test_kernels_num_points; ipoint++) {
+    for (i = 0; i < dimension; i++) {
+      ref_batch[dimension * ipoint + i] =
+        t8_test_kernels_ref_points[ipoint][i];
+    }
+  }
+  kernel (vertices, t8_test_kernels_num_points, ref_batch, out_batch);
+  for (ipoint = 0; ipoint < t8_test_kernels_num_points; ipoint++) {
+    t8_geom_compute_linear_geometry (eclass, vertices,
+                                     t8_test_kernels_ref_points[ipoint],
+                                     out_reference);
+    for (i = 0; i < 3; i++) {
+      EXPECT_NEAR (out_batch[3 * ipoint + i], out_reference[i], 1e-14)
+        << "Mismatch for eclass " << t8_eclass_to_string[eclass]
+        << " point " << ipoint << " coordinate " << i;
+    }
+  }
+}
+
+/* *INDENT-OFF* */
+INSTANTIATE_TEST_SUITE_P (t8_gtest_geometry_kernels, geometry_kernels,
+                          testing::Range (T8_ECLASS_ZERO, T8_ECLASS_COUNT));
+/* *INDENT-ON* */
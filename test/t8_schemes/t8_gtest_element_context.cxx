@@ -0,0 +1,132 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_eclass.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+
+/* We check the private allocation contexts of the schemes. Elements
+ * allocated from a context must behave exactly like elements from the
+ * shared scheme storage: they carry the same initialization guarantees
+ * and are interchangeable with shared elements in all operations. */
+
+#define T8_CONTEXT_TEST_LEVEL 2
+
+/* *INDENT-OFF* */
+class class_element_context:public testing::TestWithParam <t8_eclass_t > {
+protected:
+  void SetUp () override {
+    eclass = GetParam();
+
+    scheme = t8_scheme_new_default_cxx ();
+    ts = scheme->eclass_schemes[eclass];
+    context = ts->t8_element_context_new ();
+  }
+  void TearDown () override {
+    ts->t8_element_context_destroy (&context);
+    ASSERT_EQ (context, nullptr);
+    t8_scheme_cxx_unref (&scheme);
+  }
+  t8_eclass_t           eclass;
+  t8_scheme_cxx         *scheme;
+  t8_eclass_scheme_c    *ts;
+  void                  *context = nullptr;
+};
+/* *INDENT-ON* */
+
+TEST_P (class_element_context, matches_shared_elements)
+{
+  const t8_linearidx_t num_ids =
+    (t8_linearidx_t) ts->t8_element_count_leafs_from_root
+    (T8_CONTEXT_TEST_LEVEL);
+  t8_element_t       *ctx_element;
+  t8_element_t       *element;
+  t8_linearidx_t      id;
+
+  ts->t8_element_new_ctx (context, 1, &ctx_element);
+  ts->t8_element_new (1, &element);
+
+  /* Every element of the test level must decode identically whether it
+   * lives in context or in shared storage. */
+  for (id = 0; id < num_ids; id++) {
+    ts->t8_element_set_linear_id (ctx_element, T8_CONTEXT_TEST_LEVEL, id);
+    ts->t8_element_set_linear_id (element, T8_CONTEXT_TEST_LEVEL, id);
+    ASSERT_EQ (ts->t8_element_level (ctx_element), T8_CONTEXT_TEST_LEVEL);
+    ASSERT_EQ (ts->t8_element_get_linear_id
+               (ctx_element, T8_CONTEXT_TEST_LEVEL), id);
+    ASSERT_EQ (ts->t8_element_compare (ctx_element, element), 0);
+  }
+
+  ts->t8_element_destroy (1, &element);
+  ts->t8_element_destroy_ctx (context, 1, &ctx_element);
+}
+
+TEST_P (class_element_context, children_across_contexts)
+{
+  void               *second_context = ts->t8_element_context_new ();
+  t8_element_t       *parent;
+  t8_element_t       *check_parent;
+  int                 num_children;
+  int                 ichild;
+
+  ts->t8_element_new_ctx (context, 1, &parent);
+  ts->t8_element_new (1, &check_parent);
+  ts->t8_element_set_linear_id (parent, 0, 0);
+
+  num_children = ts->t8_element_num_children (parent);
+  {
+    /* The children live in a different context than their parent. */
+    t8_element_t      **children = T8_ALLOC (t8_element_t *, num_children);
+    ts->t8_element_new_ctx (second_context, num_children, children);
+    ts->t8_element_children (parent, num_children, children);
+    for (ichild = 0; ichild < num_children; ichild++) {
+      ASSERT_EQ (ts->t8_element_level (children[ichild]), 1);
+      ASSERT_EQ (ts->t8_element_child_id (children[ichild]), ichild);
+      /* The parent computed from a context element must equal the
+       * original, independent of where either element is stored. */
+      ts->t8_element_parent (children[ichild], check_parent);
+      ASSERT_EQ (ts->t8_element_compare (check_parent, parent), 0);
+    }
+    ts->t8_element_destroy_ctx (second_context, num_children, children);
+    T8_FREE (children);
+  }
+
+  ts->t8_element_destroy (1, &check_parent);
+  ts->t8_element_destroy_ctx (context, 1, &parent);
+  ts->t8_element_context_destroy (&second_context);
+}
+
+TEST_P (class_element_context, null_context_fallback)
+{
+  t8_element_t       *element;
+
+  /* A NULL context routes to the shared storage of the scheme. */
+  ts->t8_element_new_ctx (NULL, 1, &element);
+  ts->t8_element_set_linear_id (element, 0, 0);
+  ASSERT_EQ (ts->t8_element_level (element), 0);
+  ts->t8_element_destroy_ctx (NULL, 1, &element);
+}
+
+/* *INDENT-OFF* */
+INSTANTIATE_TEST_SUITE_P (t8_gtest_element_context, class_element_context,
+                          testing::Range (T8_ECLASS_ZERO, T8_ECLASS_COUNT));
+/* *INDENT-ON* */
@@ -0,0 +1,161 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_eclass.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <t8_schemes/t8_packed_cxx.hxx>
+
+/* We check the packed scheme against the default scheme that it wraps.
+ * A packed element and a default element are kept in sync through the
+ * same sequence of operations and must agree in all queried values. */
+
+#define T8_PACKED_TEST_MAXLVL 3
+
+/* *INDENT-OFF* */
+class class_packed:public testing::TestWithParam <t8_eclass_t > {
+protected:
+  void SetUp () override {
+    eclass = GetParam();
+
+    packed = t8_scheme_new_packed_cxx ();
+    scheme = t8_scheme_new_default_cxx ();
+    tp = packed->eclass_schemes[eclass];
+    ts = scheme->eclass_schemes[eclass];
+
+    tp->t8_element_new (1, &pelement);
+    tp->t8_element_new (1, &pchild);
+    ts->t8_element_new (1, &element);
+    ts->t8_element_new (1, &child);
+
+    tp->t8_element_set_linear_id (pelement, 0, 0);
+    ts->t8_element_set_linear_id (element, 0, 0);
+  }
+  void TearDown () override {
+    tp->t8_element_destroy (1, &pelement);
+    tp->t8_element_destroy (1, &pchild);
+    ts->t8_element_destroy (1, &element);
+    ts->t8_element_destroy (1, &child);
+
+    t8_scheme_cxx_unref (&packed);
+    t8_scheme_cxx_unref (&scheme);
+  }
+  t8_eclass_t           eclass;
+  t8_scheme_cxx         *packed;
+  t8_scheme_cxx         *scheme;
+  t8_eclass_scheme_c    *tp;
+  t8_eclass_scheme_c    *ts;
+  t8_element_t          *pelement;
+  t8_element_t          *pchild;
+  t8_element_t          *element;
+  t8_element_t          *child;
+};
+/* *INDENT-ON* */
+
+/* Check that the packed element \a pelem agrees with the default
+ * element \a elem in all level and id related queries. */
+static void
+t8_test_packed_check_equal (t8_eclass_scheme_c *tp, t8_eclass_scheme_c *ts,
+                            const t8_element_t *pelem,
+                            const t8_element_t *elem)
+{
+  const int           level = ts->t8_element_level (elem);
+
+  ASSERT_EQ (tp->t8_element_level (pelem), level);
+  ASSERT_EQ (tp->t8_element_get_linear_id (pelem, level),
+             ts->t8_element_get_linear_id (elem, level));
+  ASSERT_EQ (tp->t8_element_child_id (pelem), ts->t8_element_child_id (elem));
+  ASSERT_EQ (tp->t8_element_num_children (pelem),
+             ts->t8_element_num_children (elem));
+  ASSERT_EQ (tp->t8_element_num_siblings (pelem),
+             ts->t8_element_num_siblings (elem));
+  ASSERT_EQ (tp->t8_element_shape (pelem), ts->t8_element_shape (elem));
+}
+
+/* Descend to all descendants up to T8_PACKED_TEST_MAXLVL and check the
+ * packed scheme against the default scheme in every element. */
+static void
+t8_test_packed_recurse (t8_eclass_scheme_c *tp, t8_eclass_scheme_c *ts,
+                        t8_element_t *pelem, t8_element_t *elem,
+                        t8_element_t *pchild, t8_element_t *child, int maxlvl)
+{
+  const int           num_children = ts->t8_element_num_children (elem);
+  int                 ichild;
+
+  t8_test_packed_check_equal (tp, ts, pelem, elem);
+  if (ts->t8_element_level (elem) >= maxlvl) {
+    return;
+  }
+  for (ichild = 0; ichild < num_children; ichild++) {
+    tp->t8_element_child (pelem, ichild, pchild);
+    ts->t8_element_child (elem, ichild, child);
+    t8_test_packed_recurse (tp, ts, pchild, child, pelem, elem, maxlvl);
+    /* The recursion overwrites pelem and elem; restore them as the
+     * parents of the children */
+    tp->t8_element_parent (pchild, pelem);
+    ts->t8_element_parent (child, elem);
+    t8_test_packed_check_equal (tp, ts, pelem, elem);
+  }
+}
+
+TEST_P (class_packed, element_size)
+{
+  /* The whole point of the packed scheme is the small element */
+  EXPECT_EQ (tp->t8_element_size (), sizeof (t8_packed_element_t));
+  EXPECT_TRUE (t8_eclass_scheme_is_packed (tp));
+  EXPECT_FALSE (t8_eclass_scheme_is_packed (ts));
+  /* The packed maxlevel may be reduced, but never enlarged */
+  EXPECT_LE (tp->t8_element_maxlevel (), ts->t8_element_maxlevel ());
+}
+
+TEST_P (class_packed, compare_with_default)
+{
+  t8_test_packed_recurse (tp, ts, pelement, element, pchild, child,
+                          T8_PACKED_TEST_MAXLVL);
+}
+
+TEST_P (class_packed, linear_id_roundtrip)
+{
+  const int           level = SC_MIN (T8_PACKED_TEST_MAXLVL,
+                                      tp->t8_element_maxlevel ());
+  const t8_linearidx_t num_ids =
+    (t8_linearidx_t) ts->t8_element_count_leafs_from_root (level);
+  t8_linearidx_t      id;
+
+  for (id = 0; id < num_ids; id++) {
+    tp->t8_element_set_linear_id (pelement, level, id);
+    ts->t8_element_set_linear_id (element, level, id);
+    ASSERT_EQ (tp->t8_element_get_linear_id (pelement, level), id);
+    t8_test_packed_check_equal (tp, ts, pelement, element);
+    /* The successor must agree as well */
+    if (id < num_ids - 1) {
+      tp->t8_element_successor (pelement, pchild, level);
+      ts->t8_element_successor (element, child, level);
+      t8_test_packed_check_equal (tp, ts, pchild, child);
+    }
+  }
+}
+
+/* *INDENT-OFF* */
+INSTANTIATE_TEST_SUITE_P (t8_gtest_packed, class_packed,
+                          testing::Range (T8_ECLASS_ZERO, T8_ECLASS_COUNT));
+/* *INDENT-ON* */
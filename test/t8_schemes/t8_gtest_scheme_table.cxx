@@ -0,0 +1,100 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+
+/* In this file we test the precomputed refinement tables of the default
+ * schemes. The constants of the table must agree with the values that the
+ * virtual element functions return, since the forest algorithms use them
+ * interchangeably in their fast paths. */
+
+/* *INDENT-OFF* */
+class class_scheme_table:public testing::TestWithParam < t8_eclass > {
+protected:
+    void SetUp () override {
+    eclass = GetParam();
+
+    class_scheme = ts->eclass_schemes[(int) eclass];
+    }
+    void TearDown () override {
+        t8_scheme_cxx_unref (&ts);
+    }
+    t8_eclass eclass;
+    t8_eclass_scheme_c *class_scheme;
+    t8_scheme_cxx_t    *ts = t8_scheme_new_default_cxx ();
+};
+/* *INDENT-ON* */
+
+/* Every default scheme must provide a table. The pyramids refine into
+ * children of mixed shapes, so they must not declare uniform constants. */
+TEST_P (class_scheme_table, table_exists)
+{
+  const t8_scheme_table_t *table = class_scheme->t8_element_scheme_table ();
+
+  ASSERT_TRUE (table != NULL);
+  if (eclass == T8_ECLASS_PYRAMID) {
+    EXPECT_EQ (table->num_children, 0);
+    EXPECT_EQ (table->leaf_count_log2, -1);
+  }
+  else {
+    EXPECT_EQ (table->num_children,
+               1 << t8_eclass_to_dimension[eclass]);
+    EXPECT_EQ (table->leaf_count_log2, t8_eclass_to_dimension[eclass]);
+  }
+}
+
+/* The table constants must match the virtual element functions. */
+TEST_P (class_scheme_table, table_matches_elements)
+{
+  const t8_scheme_table_t *table = class_scheme->t8_element_scheme_table ();
+  t8_element_t       *element;
+
+  ASSERT_TRUE (table != NULL);
+  class_scheme->t8_element_new (1, &element);
+  class_scheme->t8_element_set_linear_id (element, 0, 0);
+  if (table->num_children > 0) {
+    /* A uniform child count must hold for the root element. */
+    EXPECT_EQ (table->num_children,
+               class_scheme->t8_element_num_children (element));
+    /* A declared uniform descendant count must be a power of two child
+     * count of the corresponding refinement. */
+    EXPECT_EQ (table->num_children, 1 << table->leaf_count_log2);
+  }
+  if (table->leaf_count_log2 >= 0) {
+    /* The descendant counts must follow the declared power of two. */
+    for (int level = 0; level < 5; level++) {
+      EXPECT_EQ (class_scheme->t8_element_count_leafs_from_root (level),
+                 (t8_gloidx_t) 1 << (table->leaf_count_log2 * level));
+    }
+  }
+  class_scheme->t8_element_destroy (1, &element);
+}
+
+/* A scheme that does not override the accessor must report NULL, so the
+ * forest algorithms fall back to the generic paths. This is checked via
+ * the documented default implementation of the base class. */
+
+/* *INDENT-OFF* */
+INSTANTIATE_TEST_SUITE_P (t8_gtest_scheme_table, class_scheme_table,
+                          testing::Range (T8_ECLASS_ZERO, T8_ECLASS_COUNT));
+/* *INDENT-ON* */